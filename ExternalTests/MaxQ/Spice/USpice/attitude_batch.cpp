@@ -0,0 +1,137 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceAttitudeBatch.h"
+#include "SpiceMath.h"
+
+using namespace MaxQ::Math;
+
+// twovec, m2q, then Swizzle:  what the batch replaces
+static FQuat ExpectedQuat(const FSDimensionlessVector& axdef, ES_Axis axisa, const FSDimensionlessVector& plndef, ES_Axis axisp)
+{
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    FSRotationMatrix m;
+    USpice::twovec(ResultCode, ErrorMessage, axdef, axisa, plndef, axisp, m);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    FSQuaternion q;
+    USpice::m2q(ResultCode, ErrorMessage, m, q);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    return q.Swizzle();
+}
+
+static void ExpectQuatNear(const FQuat& Actual, const FQuat& Expected, int32 i)
+{
+    EXPECT_NEAR(Actual.X, Expected.X, 1e-12) << "element " << i;
+    EXPECT_NEAR(Actual.Y, Expected.Y, 1e-12) << "element " << i;
+    EXPECT_NEAR(Actual.Z, Expected.Z, 1e-12) << "element " << i;
+    EXPECT_NEAR(Actual.W, Expected.W, 1e-12) << "element " << i;
+}
+
+static void RandomVectors(FRandomStream& Random, int32 Num, double Scale, TArray<double>& X, TArray<double>& Y, TArray<double>& Z)
+{
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector()) * Random.FRandRange(0.1, 1.) * Scale;
+        X.Add(u.X); Y.Add(u.Y); Z.Add(u.Z);
+    }
+}
+
+TEST(attitude_batch_test, TwoVec_Matches_twovec_m2q) {
+
+    USpice::init_all();
+
+    FRandomStream Random(1234);
+    TArray<double> AX, AY, AZ, PX, PY, PZ;
+    RandomVectors(Random, 2000, 1e4, AX, AY, AZ);
+    RandomVectors(Random, 2000, 10., PX, PY, PZ);
+    // Near the identity, and half turns (m2q's other branches)
+    AX.Append({ 1., -1., 0., 0. }); AY.Append({ 0., 0., -1., 0. }); AZ.Append({ 0., 0., 0., -1. });
+    PX.Append({ 0., 0., 1., 0. }); PY.Append({ 1., -1., 0., 1. }); PZ.Append({ 0., 0., 0., 0. });
+    const int32 Num = AX.Num();
+
+    const ES_Axis Axes[] = { ES_Axis::X, ES_Axis::Y, ES_Axis::Z };
+    for (ES_Axis axisa : Axes)
+    {
+        for (ES_Axis axisp : Axes)
+        {
+            if (axisa == axisp)
+            {
+                continue;
+            }
+
+            TArray<FQuat> q;
+            q.SetNum(Num);
+            EXPECT_EQ(TwoVec(axisa, FConstVectorBatch(AX, AY, AZ), axisp, FConstVectorBatch(PX, PY, PZ), q), 0);
+
+            for (int32 i = 0; i < Num; ++i)
+            {
+                const FQuat Expected = ExpectedQuat(FSDimensionlessVector(AX[i], AY[i], AZ[i]), axisa, FSDimensionlessVector(PX[i], PY[i], PZ[i]), axisp);
+                ExpectQuatNear(q[i], Expected, i);
+            }
+        }
+    }
+}
+
+
+TEST(attitude_batch_test, Degenerate_Elements) {
+
+    TArray<double> AX{ 1., 0., 2. }, AY{ 0., 0., 0. }, AZ{ 0., 0., 0. };
+    TArray<double> PX{ 0., 1., -4. }, PY{ 1., 0., 0. }, PZ{ 0., 0., 0. };
+
+    TArray<FQuat> q;
+    q.Init(FQuat(1., 0., 0., 0.), 3);
+    EXPECT_EQ(TwoVec(ES_Axis::Z, FConstVectorBatch(AX, AY, AZ), ES_Axis::X, FConstVectorBatch(PX, PY, PZ), q), 2);
+    EXPECT_TRUE(q[1].Equals(FQuat::Identity, 0.));
+    EXPECT_TRUE(q[2].Equals(FQuat::Identity, 0.));
+
+    EXPECT_EQ(TwoVec(ES_Axis::Z, FConstVectorBatch(AX, AY, AZ), ES_Axis::Z, FConstVectorBatch(PX, PY, PZ), q), INDEX_NONE);
+    EXPECT_EQ(TwoVec(ES_Axis::NONE, FConstVectorBatch(AX, AY, AZ), ES_Axis::Z, FConstVectorBatch(PX, PY, PZ), q), INDEX_NONE);
+}
+
+
+TEST(attitude_batch_test, Attitude_Laws) {
+
+    USpice::init_all();
+
+    FRandomStream Random(4321);
+    TArray<double> RX, RY, RZ, VX, VY, VZ;
+    RandomVectors(Random, 5000, 42000., RX, RY, RZ);
+    RandomVectors(Random, 5000, 8., VX, VY, VZ);
+    const int32 Num = RX.Num();
+    const FSDistanceVector sun(1.2e8, -8.7e7, 3.1e7);
+
+    TArray<FQuat> q;
+    q.SetNum(Num);
+
+    EXPECT_EQ(NadirVelocity(FConstVectorBatch(RX, RY, RZ), FConstVectorBatch(VX, VY, VZ), q), 0);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const FQuat Expected = ExpectedQuat(FSDimensionlessVector(-RX[i], -RY[i], -RZ[i]), ES_Axis::Z, FSDimensionlessVector(VX[i], VY[i], VZ[i]), ES_Axis::X);
+        ExpectQuatNear(q[i], Expected, i);
+    }
+
+    EXPECT_EQ(SunNadir(FConstVectorBatch(RX, RY, RZ), sun, q, ES_Axis::X, ES_Axis::Y), 0);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const FSDimensionlessVector tosun(sun.x.km - RX[i], sun.y.km - RY[i], sun.z.km - RZ[i]);
+        const FQuat Expected = ExpectedQuat(tosun, ES_Axis::X, FSDimensionlessVector(-RX[i], -RY[i], -RZ[i]), ES_Axis::Y);
+        ExpectQuatNear(q[i], Expected, i);
+    }
+
+    const FSRotationMatrix m = MaxQ::Math::TwoVec(ES_Axis::Y, FSDimensionlessVector(1., 2., 3.), ES_Axis::Z, FSDimensionlessVector(0., 0., 1.));
+    InertialFixed(m, q);
+    FSQuaternion Expected;
+    MaxQ::Math::M2q(Expected, m);
+    ExpectQuatNear(q[0], Expected.Swizzle(), 0);
+    ExpectQuatNear(q[Num - 1], Expected.Swizzle(), Num - 1);
+}
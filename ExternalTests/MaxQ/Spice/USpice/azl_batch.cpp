@@ -0,0 +1,137 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMathBatch.h"
+
+using namespace MaxQ::Math;
+
+TEST(azl_batch_test, Recazl_Matches_recazl) {
+
+    USpice::init_all();
+
+    FRandomStream Random(1234);
+    TArray<double> X, Y, Z;
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector()) * Random.FRandRange(0.1, 1e6);
+        X.Add(u.X); Y.Add(u.Y); Z.Add(u.Z);
+    }
+    X.Append({ 0., 0., 5., -1. });
+    Y.Append({ 0., 0., 0., 0. });
+    Z.Append({ 0., -3., 0., 0. });
+    const int32 Num = X.Num();
+
+    for (bool azccw : { true, false })
+    {
+        for (bool elplsz : { true, false })
+        {
+            TArray<double> range, az, el;
+            range.SetNum(Num); az.SetNum(Num); el.SetNum(Num);
+            Recazl(FConstVectorBatch(X, Y, Z), azccw, elplsz, range, az, el);
+
+            for (int32 i = 0; i < Num; ++i)
+            {
+                FSDistance expectedRange;
+                FSAngle expectedAz, expectedEl;
+                USpice::recazl(expectedRange, expectedAz, expectedEl, FSDistanceVector(X[i], Y[i], Z[i]), azccw, elplsz);
+
+                EXPECT_NEAR(range[i], expectedRange.km, 1e-15 * FMath::Max(1., range[i])) << "point " << i;
+                EXPECT_NEAR(az[i], expectedAz.AsSpiceDouble(), 1e-12) << "point " << i << " azccw " << azccw;
+                EXPECT_NEAR(el[i], expectedEl.AsSpiceDouble(), 1e-12) << "point " << i << " elplsz " << elplsz;
+            }
+
+            // ...and back
+            TArray<double> X2, Y2, Z2;
+            X2.SetNum(Num); Y2.SetNum(Num); Z2.SetNum(Num);
+            Azlrec(range, az, el, azccw, elplsz, FVectorBatch{ X2, Y2, Z2 });
+            for (int32 i = 0; i < Num; ++i)
+            {
+                FSDistanceVector expected;
+                USpice::azlrec(expected, FSDistance(range[i]), FSAngle(az[i]), FSAngle(el[i]), azccw, elplsz);
+                EXPECT_NEAR(X2[i], expected.x.km, 1e-12 * FMath::Max(1., range[i])) << "point " << i;
+                EXPECT_NEAR(Y2[i], expected.y.km, 1e-12 * FMath::Max(1., range[i])) << "point " << i;
+                EXPECT_NEAR(Z2[i], expected.z.km, 1e-12 * FMath::Max(1., range[i])) << "point " << i;
+                EXPECT_NEAR(X2[i], X[i], 1e-9 * FMath::Max(1., range[i])) << "point " << i;
+            }
+        }
+    }
+}
+
+
+TEST(azl_batch_test, Azlcpo_Matches_azlcpo) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    const FString obsctr = TEXT("FAKEBODY9994");
+    const FString obsref = TEXT("IAU_FAKEBODY9994");
+    const TArray<FString> Targets{ TEXT("FAKEBODY9993"), TEXT("FAKEBODY9995") };
+
+    // Off the surface, and on both poles
+    const FSDistanceVector Stations[] = { FSDistanceVector(1000., -2000., 1500.), FSDistanceVector(0., 0., 3000.), FSDistanceVector(0., 0., -3000.) };
+
+    for (int32 Day = 0; Day < 4; ++Day)
+    {
+        const FSEphemerisTime et = et0 + Day * FSEphemerisPeriod::Day;
+
+        // Geometric states relative to obsctr, J2000
+        TArray<double> RX, RY, RZ, VX, VY, VZ;
+        for (const FString& Target : Targets)
+        {
+            FSStateVector State;
+            FSEphemerisPeriod lt;
+            USpice::spkezr(ResultCode, ErrorMessage, et, State, lt, Target, obsctr, TEXT("J2000"));
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+            RX.Add(State.r.x.km); RY.Add(State.r.y.km); RZ.Add(State.r.z.km);
+            VX.Add(State.v.dx.kmps); VY.Add(State.v.dy.kmps); VZ.Add(State.v.dz.kmps);
+        }
+        const int32 Num = RX.Num();
+
+        for (const FSDistanceVector& obspos : Stations)
+        {
+            for (bool azccw : { true, false })
+            {
+                const bool elplsz = !azccw;
+
+                FAzlObserver Observer;
+                ASSERT_TRUE(AzlObserver(et, obspos, obsctr, obsref, TEXT("J2000"), azccw, elplsz, Observer, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+
+                TArray<double> range, az, el, drange, daz, del;
+                range.SetNum(Num); az.SetNum(Num); el.SetNum(Num);
+                drange.SetNum(Num); daz.SetNum(Num); del.SetNum(Num);
+                Azlcpo(Observer, FConstVectorBatch(RX, RY, RZ), FConstVectorBatch(VX, VY, VZ), range, az, el, drange, daz, del);
+
+                for (int32 i = 0; i < Num; ++i)
+                {
+                    FSDimensionlessStateVector azlsta;
+                    FSEphemerisPeriod lt;
+                    USpice::azlcpo(ResultCode, ErrorMessage, azlsta, lt, et, obspos, obsctr, obsref, Targets[i], azccw, elplsz);
+                    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+                    EXPECT_NEAR(range[i], azlsta.r.x, 1e-12 * range[i]) << "day " << Day << ", target " << i;
+                    EXPECT_NEAR(az[i], azlsta.r.y, 1e-10) << "day " << Day << ", target " << i;
+                    EXPECT_NEAR(el[i], azlsta.r.z, 1e-10) << "day " << Day << ", target " << i;
+                    EXPECT_NEAR(drange[i], azlsta.dr.x, 1e-9 * FMath::Max(1., FMath::Abs(azlsta.dr.x))) << "day " << Day << ", target " << i;
+                    EXPECT_NEAR(daz[i], azlsta.dr.y, 1e-9 * FMath::Max(1e-6, FMath::Abs(azlsta.dr.y))) << "day " << Day << ", target " << i;
+                    EXPECT_NEAR(del[i], azlsta.dr.z, 1e-9 * FMath::Max(1e-6, FMath::Abs(azlsta.dr.z))) << "day " << Day << ", target " << i;
+                }
+            }
+        }
+    }
+
+    FAzlObserver Observer;
+    EXPECT_FALSE(AzlObserver(et0, Stations[0], TEXT("NOT_A_BODY"), obsref, TEXT("J2000"), true, true, Observer, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
@@ -0,0 +1,125 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceData.h"
+#include "SpiceBodyOrientation.h"
+
+using namespace MaxQ::Frames;
+
+// A fake satellite, with every optional piece:  quadratic terms, system
+// constants in B1950 at a non-J2000 epoch, and quadratic phase angles.
+static const char* PckKernel =
+    "KPL/PCK\n"
+    "\\begindata\n"
+    "BODY9_CONSTANTS_REF_FRAME  = 2\n"
+    "BODY9_CONSTANTS_JED_EPOCH  = 2433282.5\n"
+    "BODY9_MAX_PHASE_DEGREE     = 2\n"
+    "BODY9_NUT_PREC_ANGLES      = ( 125.045  -1935.5364525   0.001\n"
+    "                               250.089  -3871.0729050   0.0\n"
+    "                               260.008  475263.3328725 -0.002 )\n"
+    "BODY955_POLE_RA            = ( 269.9949   0.0031   0.0001 )\n"
+    "BODY955_POLE_DEC           = ( 66.5392    0.0130  -0.0002 )\n"
+    "BODY955_PM                 = ( 38.3213    13.17635815  -1.4E-12 )\n"
+    "BODY955_NUT_PREC_RA        = ( -3.8787  -0.1204   0.0700 )\n"
+    "BODY955_NUT_PREC_DEC       = (  1.5419   0.0239 )\n"
+    "BODY955_NUT_PREC_PM        = (  3.5610   0.1208  -0.0642 )\n"
+    "\\begintext\n";
+
+static void LoadPckKernel()
+{
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    TArrayView<const uint8> Contents((const uint8*)PckKernel, FCStringAnsi::Strlen(PckKernel));
+    ASSERT_TRUE(MaxQ::Data::FurnshBuffer(TEXT("body_orientation_test.tpc"), Contents, &ResultCode, &ErrorMessage));
+}
+
+static void ExpectSameAsTisbod(int32 Body)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    auto Model = GetPckOrientation(Body, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_TRUE(Model->IsValid());
+
+    for (int32 i = -20; i <= 20; ++i)
+    {
+        const FSEphemerisTime et(et0.seconds + i * 86400. * 365.25 * 3.7);
+
+        FSStateTransform Expected;
+        USpice::tisbod(ResultCode, ErrorMessage, Expected, et, Body, TEXT("J2000"));
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        FSStateTransform Actual;
+        Model->StateTransform(et, Actual);
+
+        FSRotationMatrix Rotation;
+        Model->Rotation(et, Rotation);
+
+        const double (&x)[6][6] = Actual.AsSpiceDoubleArray();
+        const double (&xe)[6][6] = Expected.AsSpiceDoubleArray();
+        const double (&r)[3][3] = Rotation.AsSpiceDoubleArray();
+
+        for (int32 j = 0; j < 6; ++j)
+        {
+            for (int32 k = 0; k < 6; ++k)
+            {
+                EXPECT_NEAR(x[j][k], xe[j][k], 1e-12) << "body " << Body << " epoch " << i;
+            }
+        }
+        for (int32 j = 0; j < 3; ++j)
+        {
+            for (int32 k = 0; k < 3; ++k)
+            {
+                EXPECT_EQ(r[j][k], x[j][k]);
+            }
+        }
+    }
+}
+
+TEST(body_orientation_test, Matches_tisbod) {
+
+    LoadPckKernel();
+
+    ExpectSameAsTisbod(9994);
+    ExpectSameAsTisbod(9995);
+    ExpectSameAsTisbod(955);
+}
+
+TEST(body_orientation_test, Missing_IsInvalid) {
+
+    LoadPckKernel();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    auto Model = GetPckOrientation(-1234, &ResultCode, &ErrorMessage);
+    EXPECT_FALSE(Model->IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+}
+
+TEST(body_orientation_test, FollowsPool) {
+
+    LoadPckKernel();
+
+    auto First = GetPckOrientation(955);
+    ASSERT_TRUE(First->IsValid());
+    EXPECT_EQ(&GetPckOrientation(955).Get(), &First.Get());
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    EXPECT_TRUE(MaxQ::Data::UnloadBuffer(TEXT("body_orientation_test.tpc"), &ResultCode, &ErrorMessage));
+    EXPECT_FALSE(GetPckOrientation(955, &ResultCode, &ErrorMessage)->IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
@@ -0,0 +1,62 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceEphemerisCache.h"
+
+TEST(chebyshev_cache_test, Cache_Matches_spkpos) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    TArray<FString> bodies{ TEXT("FAKEBODY9993"), TEXT("FAKEBODY9994") };
+    FString obs = TEXT("FAKEBODY9995");
+    FString ref = TEXT("ECLIPJ2000");
+
+    MaxQ::Ephemeris::FChebyshevCacheSettings Settings;
+    Settings.ToleranceKm = 0.1;
+    Settings.MaxBlockSeconds = FSEphemerisPeriod::Day.AsSeconds();
+
+    MaxQ::Ephemeris::FChebyshevCache Cache;
+    bool bBuilt = Cache.Build(bodies, obs, ref, et0, et0 + 4 * FSEphemerisPeriod::Day, Settings, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+
+    EXPECT_TRUE(bBuilt);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+    EXPECT_EQ(Cache.NumBodies(), 2);
+
+    for (const FString& body : bodies)
+    {
+        for (int i = 0; i <= 40; ++i)
+        {
+            FSEphemerisTime et = et0 + i * 0.1 * FSEphemerisPeriod::Day;
+
+            FSDistanceVector cached;
+            ASSERT_TRUE(Cache.Position(body, et, cached));
+
+            FSDistanceVector r;
+            FSEphemerisPeriod lt;
+            USpice::spkpos(ResultCode, ErrorMessage, et, r, lt, body, obs, ref);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+            EXPECT_NEAR(cached.x.km, r.x.km, 0.2);
+            EXPECT_NEAR(cached.y.km, r.y.km, 0.2);
+            EXPECT_NEAR(cached.z.km, r.z.km, 0.2);
+        }
+    }
+
+    FSDistanceVector outside;
+    EXPECT_FALSE(Cache.Position(TEXT("FAKEBODY9994"), et0 + 5 * FSEphemerisPeriod::Day, outside));
+    EXPECT_FALSE(Cache.Position(TEXT("MOON"), et0, outside));
+}
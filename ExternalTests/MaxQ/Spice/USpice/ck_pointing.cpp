@@ -0,0 +1,72 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCkPointing.h"
+
+using namespace MaxQ::Frames;
+
+// The unit test kernels have no CK, so these cover everything short of
+// evaluating a segment.
+
+TEST(ck_pointing_test, Open_RejectsUnknownReference) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FCkPointingCursor Cursor = FCkPointingCursor::Open(-999000, TEXT("NOT_A_FRAME"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_FALSE(Cursor.IsValid());
+
+    // Using it says so, rather than finding nothing
+    double sclkdp[] = { 0. };
+    FQuat Rotations[1];
+    EXPECT_EQ(Cursor.Pointing(sclkdp, 0., Rotations, TArrayView<FVector>(), TArrayView<double>(), TArrayView<bool>(), &ResultCode, &ErrorMessage), 0);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_TRUE(Rotations[0].Equals(FQuat::Identity, 0.));
+}
+
+
+TEST(ck_pointing_test, Pointing_NoSegmentsFindsNothing) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FCkPointingCursor Cursor = FCkPointingCursor::Open(-999000, TEXT("J2000"), &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_TRUE(Cursor.IsValid());
+    EXPECT_EQ(Cursor.GetInstrument(), -999000);
+    EXPECT_EQ(Cursor.GetSclk(), -999);
+    EXPECT_EQ(Cursor.NumSegments(), 0);
+
+    TArray<double> sclkdp = { 0., 1000., 2000. };
+    TArray<FQuat> Rotations;
+    TArray<FVector> AngularVelocities;
+    TArray<double> clkout;
+    TArray<bool> found;
+    Rotations.Init(FQuat(1., 2., 3., 4.), sclkdp.Num());
+    AngularVelocities.Init(FVector::OneVector, sclkdp.Num());
+    clkout.Init(-1., sclkdp.Num());
+    found.Init(true, sclkdp.Num());
+
+    EXPECT_EQ(Cursor.Pointing(sclkdp, 10., Rotations, AngularVelocities, clkout, found, &ResultCode, &ErrorMessage), 0);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    for (int32 i = 0; i < sclkdp.Num(); ++i)
+    {
+        EXPECT_TRUE(Rotations[i].Equals(FQuat::Identity, 0.));
+        EXPECT_EQ(AngularVelocities[i], FVector::ZeroVector);
+        EXPECT_EQ(clkout[i], 0.);
+        EXPECT_FALSE(found[i]);
+    }
+}
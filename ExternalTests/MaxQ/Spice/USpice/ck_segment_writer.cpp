@@ -0,0 +1,75 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCkWriter.h"
+
+using namespace MaxQ::Data;
+
+// As with spk_segment_writer, nothing here reaches CSPICE (no CK can be
+// opened without a project directory).
+
+TEST(ck_segment_writer_test, Add_RequiresIncreasingTicks) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FCkSegmentWriter Writer;
+
+    FSPointingType1Observation record;
+    EXPECT_FALSE(Writer.Add(record, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    FCkSegmentWriterSettings Settings;
+    Settings.MaxGapTicks = 100.;
+    ASSERT_TRUE(Writer.Begin(1, -999000, TEXT("J2000"), TEXT("TEST"), Settings, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_TRUE(Writer.IsOpen());
+
+    TArray<FSPointingType1Observation> records;
+    for (int i = 0; i < 5; ++i)
+    {
+        records.Add(record);
+        records.Last().sclkdp = 20. * i;
+    }
+    EXPECT_TRUE(Writer.Add(records, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Writer.NumBuffered(), 5);
+
+    // Out of order within the batch:  nothing is buffered
+    records[0].sclkdp = 200.;
+    records[1].sclkdp = 220.;
+    records[2].sclkdp = 210.;
+    EXPECT_FALSE(Writer.Add(records, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_EQ(Writer.NumBuffered(), 5);
+
+    // Repeats the last buffered time
+    record.sclkdp = 80.;
+    EXPECT_FALSE(Writer.Add(record, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Writer.NumBuffered(), 5);
+}
+
+
+TEST(ck_segment_writer_test, Begin_RejectsLongSegmentId) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FCkSegmentWriter Writer;
+    EXPECT_FALSE(Writer.Begin(1, -999000, TEXT("J2000"), FString::ChrN(41, TEXT('X')), FCkSegmentWriterSettings(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(Writer.IsOpen());
+
+    EXPECT_TRUE(Writer.Begin(1, -999000, TEXT("J2000"), FString::ChrN(40, TEXT('X')), FCkSegmentWriterSettings(), &ResultCode, &ErrorMessage));
+
+    // Nothing added, nothing written
+    EXPECT_TRUE(Writer.End(&ResultCode, &ErrorMessage));
+    EXPECT_EQ(Writer.NumSegments(), 0);
+    EXPECT_FALSE(Writer.IsOpen());
+}
@@ -0,0 +1,251 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceConjunction.h"
+
+using namespace MaxQ::Orbits;
+
+// A dozen objects in one ~7000 km shell, on different planes
+static TArray<FSGP4Propagator> Shell(double epoch)
+{
+    double geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+
+    TArray<FSGP4Propagator> Catalog;
+    for (int i = 0; i < 12; ++i)
+    {
+        double elems[10] = {};
+        elems[FSTwoLineElements::XINCL] = FMath::DegreesToRadians(30. + fmod(11. * i, 120.));
+        elems[FSTwoLineElements::XNODEO] = FMath::DegreesToRadians(fmod(37. * i, 360.));
+        elems[FSTwoLineElements::EO] = 0.001;
+        elems[FSTwoLineElements::XMO] = FMath::DegreesToRadians(fmod(53. * i, 360.));
+        elems[FSTwoLineElements::XNO] = 14.8 * 2. * PI / 1440.;
+        elems[FSTwoLineElements::EPOCH] = epoch;
+
+        Catalog.Emplace(FSTLEGeophysicalConstants(geophs), FSTwoLineElements(elems));
+    }
+    return Catalog;
+}
+
+
+TEST(conjunction_test, Matches_Pairwise_Sampling) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    const double Start = 0., Stop = 6. * 3600.;
+    TArray<FSGP4Propagator> Catalog = Shell(Start);
+    for (const FSGP4Propagator& Propagator : Catalog) ASSERT_TRUE(Propagator.IsValid());
+
+    FConjunctionSettings Settings;
+    Settings.Threshold = 300.;
+
+    TArray<FConjunction> Conjunctions;
+    FConjunctionStats Stats;
+    EXPECT_TRUE(ScreenConjunctions(Catalog, FSEphemerisTime(Start), FSEphemerisTime(Stop), Conjunctions, Settings, &Stats, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_GT(Stats.Steps, 0);
+
+    // Every object, every second
+    const int NumSamples = (int)(Stop - Start) + 1;
+    TArray<double> Positions;
+    Positions.SetNumZeroed(Catalog.Num() * NumSamples * 3);
+    for (int i = 0; i < Catalog.Num(); ++i)
+    {
+        for (int k = 0; k < NumSamples; ++k)
+        {
+            double state[6];
+            ASSERT_EQ(Catalog[i].Propagate(Start + k, state), ESGP4Status::Ok);
+            FMemory::Memcpy(&Positions[(i * NumSamples + k) * 3], state, 3 * sizeof(double));
+        }
+    }
+
+    auto Distance = [&](int i, int j, int k)
+    {
+        const double* a = &Positions[(i * NumSamples + k) * 3];
+        const double* b = &Positions[(j * NumSamples + k) * 3];
+        return FMath::Sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+    };
+
+    int Minima = 0;
+    for (int i = 0; i < Catalog.Num(); ++i)
+    {
+        for (int j = i + 1; j < Catalog.Num(); ++j)
+        {
+            for (int k = 1; k + 1 < NumSamples; ++k)
+            {
+                const double d = Distance(i, j, k);
+                if (d < Distance(i, j, k - 1) && d <= Distance(i, j, k + 1) && d < Settings.Threshold - 10.)
+                {
+                    ++Minima;
+                    const FConjunction* Found = Conjunctions.FindByPredicate([&](const FConjunction& c) { return c.Primary == i && c.Secondary == j && FMath::Abs(c.TCA - (Start + k)) <= 1.; });
+                    ASSERT_NE(Found, nullptr) << i << " " << j << " " << k;
+                    EXPECT_LE(Found->MissDistance, d + 1.e-6);
+                    EXPECT_GT(Found->MissDistance, d - 10.);
+                }
+            }
+        }
+    }
+
+    // ... and nothing else
+    for (const FConjunction& c : Conjunctions)
+    {
+        EXPECT_LT(c.Primary, c.Secondary);
+        EXPECT_LE(c.MissDistance, Settings.Threshold);
+        const int k = (int)FMath::RoundToDouble(c.TCA - Start);
+        EXPECT_LE(Distance(c.Primary, c.Secondary, k), c.MissDistance + 10.);
+    }
+    EXPECT_GE(Conjunctions.Num(), Minima);
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(conjunction_test, Shell_Filter_Rejects_Separated_Orbits) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    double geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+    TArray<FSGP4Propagator> Catalog;
+    for (double RevsPerDay : { 15.5, 13.0 })
+    {
+        double elems[10] = {};
+        elems[FSTwoLineElements::XINCL] = 1.;
+        elems[FSTwoLineElements::XNO] = RevsPerDay * 2. * PI / 1440.;
+        Catalog.Emplace(FSTLEGeophysicalConstants(geophs), FSTwoLineElements(elems));
+    }
+
+    // ~840 km apart radially, which is within the hash's reach
+    FConjunctionSettings Settings;
+    Settings.Threshold = 500.;
+
+    TArray<FConjunction> Conjunctions;
+    FConjunctionStats Stats;
+    EXPECT_TRUE(ScreenConjunctions(Catalog, FSEphemerisTime(0.), FSEphemerisTime(3600.), Conjunctions, Settings, &Stats));
+    EXPECT_EQ(Conjunctions.Num(), 0);
+    EXPECT_EQ(Stats.Candidates, 0);
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(conjunction_test, Sharded_Matches_Unsharded) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    const double Start = 0., Stop = 6. * 3600.;
+    TArray<FSGP4Propagator> Catalog = Shell(Start);
+
+    FConjunctionSettings Settings;
+    Settings.Threshold = 300.;
+
+    TArray<FConjunction> Expected;
+    ASSERT_TRUE(ScreenConjunctions(Catalog, FSEphemerisTime(Start), FSEphemerisTime(Stop), Expected, Settings));
+    ASSERT_GT(Expected.Num(), 0);
+
+    TArray<FConjunctionShard> Shards = MakeConjunctionShards(Catalog.Num(), FSEphemerisTime(Start), FSEphemerisTime(Stop), 4, 3, Settings);
+    EXPECT_EQ(Shards.Num(), 12);
+    EXPECT_EQ(Shards[0].PrimaryBegin, 0);
+    EXPECT_DOUBLE_EQ(Shards[0].Start, Start);
+    EXPECT_DOUBLE_EQ(Shards.Last().Stop, Stop);
+
+    // The job, run here rather than in a worker:  the request and response
+    // still go through bytes
+    int32 Dispatched = 0;
+    FConjunctionDispatcher Dispatch = [&Dispatched](FName JobName, TArray<uint8>&& Request)
+    {
+        ++Dispatched;
+        FSpiceJobResult Result;
+        const FSpiceJobHandler* Handler = FSpiceProcessPool::FindJob(JobName);
+        Result.bSuccess = Handler && (*Handler)(Request, Result.Response, Result.ErrorMessage);
+        return MakeFulfilledPromise<FSpiceJobResult>(MoveTemp(Result)).GetFuture();
+    };
+
+    for (FConjunctionDispatcher Dispatcher : { FConjunctionDispatcher(), Dispatch })
+    {
+        TArray<FConjunction> Conjunctions;
+        ES_ResultCode ResultCode = ES_ResultCode::Error;
+        FString ErrorMessage;
+        EXPECT_TRUE(ScreenConjunctionsSharded(Catalog, FSEphemerisTime(Start), FSEphemerisTime(Stop), Conjunctions, 4, 3, Settings, Dispatcher, nullptr, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        ASSERT_EQ(Conjunctions.Num(), Expected.Num());
+        for (int i = 0; i < Expected.Num(); ++i)
+        {
+            EXPECT_EQ(Conjunctions[i].Primary, Expected[i].Primary);
+            EXPECT_EQ(Conjunctions[i].Secondary, Expected[i].Secondary);
+            EXPECT_NEAR(Conjunctions[i].TCA, Expected[i].TCA, 10. * Settings.Tolerance);
+            EXPECT_NEAR(Conjunctions[i].MissDistance, Expected[i].MissDistance, 1.e-3);
+        }
+    }
+    EXPECT_EQ(Dispatched, 12);
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(conjunction_test, Streamed_Slices_Match_Screening) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    const double Start = 0., Stop = 6. * 3600.;
+    TArray<FSGP4Propagator> Catalog = Shell(Start);
+
+    FConjunctionSettings Settings;
+    Settings.Threshold = 300.;
+
+    TArray<FConjunction> Expected;
+    ASSERT_TRUE(ScreenConjunctionsSharded(Catalog, FSEphemerisTime(Start), FSEphemerisTime(Stop), Expected, 4, 3, Settings));
+    ASSERT_GT(Expected.Num(), 0);
+
+    TArray<FConjunction> Streamed;
+    TArray<double> Throughs;
+    FConjunctionPartial OnPartial = [&](const TArray<FConjunction>& Conjunctions, const FSEphemerisTime& Through)
+    {
+        for (const FConjunction& Conjunction : Conjunctions)
+        {
+            EXPECT_LT(Conjunction.TCA, Through.seconds + 1.e-9);
+            EXPECT_TRUE(Throughs.Num() == 0 || Conjunction.TCA >= Throughs.Last());
+        }
+        Streamed.Append(Conjunctions);
+        Throughs.Add(Through.seconds);
+    };
+
+    TArray<FConjunction> Conjunctions;
+    EXPECT_TRUE(ScreenConjunctionsSharded(Catalog, FSEphemerisTime(Start), FSEphemerisTime(Stop), Conjunctions, 4, 3, Settings, nullptr, nullptr, nullptr, nullptr, OnPartial));
+
+    // One per slice, in order
+    ASSERT_EQ(Throughs.Num(), 4);
+    for (int i = 1; i < Throughs.Num(); ++i)
+    {
+        EXPECT_GT(Throughs[i], Throughs[i - 1]);
+    }
+    EXPECT_DOUBLE_EQ(Throughs.Last(), Stop);
+
+    ASSERT_EQ(Streamed.Num(), Expected.Num());
+    ASSERT_EQ(Conjunctions.Num(), Expected.Num());
+    for (int i = 0; i < Expected.Num(); ++i)
+    {
+        EXPECT_EQ(Streamed[i].Primary, Expected[i].Primary);
+        EXPECT_EQ(Streamed[i].Secondary, Expected[i].Secondary);
+        EXPECT_NEAR(Streamed[i].TCA, Expected[i].TCA, 10. * Settings.Tolerance);
+        EXPECT_DOUBLE_EQ(Conjunctions[i].TCA, Streamed[i].TCA);
+    }
+
+    MaxQ::Core::ClearAll();
+}
@@ -0,0 +1,203 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMathBatch.h"
+
+using namespace MaxQ::Math;
+
+static const double re_earth = 6378.1366;
+static const double f_earth = 0.00335281066474748071984552861852;
+
+// Points from the center out past GEO, including the axis and the poles
+static void TestPoints(TArray<double>& X, TArray<double>& Y, TArray<double>& Z)
+{
+    FRandomStream Random(1234);
+    for (int32 i = 0; i < 10000; ++i)
+    {
+        const double r = i < 100 ? 6300. + i : Random.FRandRange(1., 50000.);
+        const FVector3d u = FVector3d(Random.GetUnitVector());
+        X.Add(r * u.X);
+        Y.Add(r * u.Y);
+        Z.Add(r * u.Z);
+    }
+
+    X.Append({ 0., 0., 0., 7000. });
+    Y.Append({ 0., 0., 0., -1e-9 });
+    Z.Append({ 6400., -6350., 0., 0. });
+}
+
+TEST(coordinate_batch_test, Recgeo_Matches_recgeo) {
+
+    USpice::init_all();
+
+    TArray<double> X, Y, Z;
+    TestPoints(X, Y, Z);
+    const int32 Num = X.Num();
+
+    TArray<double> lon, lat, alt;
+    lon.SetNum(Num); lat.SetNum(Num); alt.SetNum(Num);
+
+    ASSERT_TRUE(Recgeo(FConstVectorBatch(X, Y, Z), re_earth, f_earth, lon, lat, alt));
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        FSGeodeticVector expected;
+        USpice::recgeo(FSDistanceVector(X[i], Y[i], Z[i]), FSDistance(re_earth), expected, f_earth);
+
+        EXPECT_NEAR(lon[i], expected.lonlat.longitude.AsSpiceDouble(), 1e-12) << "point " << i;
+        EXPECT_NEAR(lat[i], expected.lonlat.latitude.AsSpiceDouble(), 1e-12) << "point " << i;
+        EXPECT_NEAR(alt[i], expected.alt.km, 1e-8) << "point " << i;
+    }
+
+    // ...and back
+    TArray<double> X2, Y2, Z2;
+    X2.SetNum(Num); Y2.SetNum(Num); Z2.SetNum(Num);
+    ASSERT_TRUE(Georec(lon, lat, alt, re_earth, f_earth, FVectorBatch{ X2, Y2, Z2 }));
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        EXPECT_NEAR(X2[i], X[i], 1e-8);
+        EXPECT_NEAR(Y2[i], Y[i], 1e-8);
+        EXPECT_NEAR(Z2[i], Z[i], 1e-8);
+    }
+
+    // Invalid ellipsoids
+    EXPECT_FALSE(Recgeo(FConstVectorBatch(X, Y, Z), 0., f_earth, lon, lat, alt));
+    EXPECT_FALSE(Georec(lon, lat, alt, re_earth, 1., FVectorBatch{ X2, Y2, Z2 }));
+}
+
+TEST(coordinate_batch_test, Prolate_RoundTrips) {
+
+    TArray<double> X, Y, Z;
+    TestPoints(X, Y, Z);
+    const int32 Num = X.Num();
+
+    TArray<double> lon, lat, alt, X2, Y2, Z2;
+    lon.SetNum(Num); lat.SetNum(Num); alt.SetNum(Num);
+    X2.SetNum(Num); Y2.SetNum(Num); Z2.SetNum(Num);
+
+    ASSERT_TRUE(Recgeo(FConstVectorBatch(X, Y, Z), 3000., -0.2, lon, lat, alt));
+    ASSERT_TRUE(Georec(lon, lat, alt, 3000., -0.2, FVectorBatch{ X2, Y2, Z2 }));
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        EXPECT_NEAR(X2[i], X[i], 1e-7);
+        EXPECT_NEAR(Y2[i], Y[i], 1e-7);
+        EXPECT_NEAR(Z2[i], Z[i], 1e-7);
+    }
+}
+
+TEST(coordinate_batch_test, Recpgr_Matches_recpgr) {
+
+    USpice::init_all();
+
+    TArray<double> X, Y, Z;
+    TestPoints(X, Y, Z);
+    const int32 Num = X.Num();
+
+    bool bPositiveWest = true;
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    EXPECT_TRUE(PlanetographicSense(TEXT("EARTH"), bPositiveWest, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_FALSE(bPositiveWest);
+
+    TArray<double> lon, lat, alt;
+    lon.SetNum(Num); lat.SetNum(Num); alt.SetNum(Num);
+    ASSERT_TRUE(Recpgr(FConstVectorBatch(X, Y, Z), re_earth, f_earth, bPositiveWest, lon, lat, alt));
+
+    for (int32 i = 0; i < Num; i += 7)
+    {
+        FSPlanetographicVector expected;
+        USpice::recpgr(ResultCode, ErrorMessage, FSDistanceVector(X[i], Y[i], Z[i]), FSDistance(re_earth), expected, TEXT("EARTH"), f_earth);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        EXPECT_NEAR(lon[i], expected.lonlat.longitude.AsSpiceDouble(), 1e-12) << "point " << i;
+        EXPECT_NEAR(lat[i], expected.lonlat.latitude.AsSpiceDouble(), 1e-12) << "point " << i;
+        EXPECT_NEAR(alt[i], expected.alt.km, 1e-8) << "point " << i;
+    }
+
+    // Positive west mirrors the longitudes, and round trips
+    TArray<double> west, X2, Y2, Z2;
+    west.SetNum(Num); X2.SetNum(Num); Y2.SetNum(Num); Z2.SetNum(Num);
+    ASSERT_TRUE(Recpgr(FConstVectorBatch(X, Y, Z), re_earth, f_earth, true, west, lat, alt));
+    ASSERT_TRUE(Pgrrec(west, lat, alt, re_earth, f_earth, true, FVectorBatch{ X2, Y2, Z2 }));
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        EXPECT_GE(west[i], 0.);
+        EXPECT_LE(west[i], 2. * UE_DOUBLE_PI);
+        EXPECT_NEAR(X2[i], X[i], 1e-8);
+        EXPECT_NEAR(Y2[i], Y[i], 1e-8);
+        EXPECT_NEAR(Z2[i], Z[i], 1e-8);
+    }
+}
+
+TEST(coordinate_batch_test, Spherical_Matches_CSPICE) {
+
+    USpice::init_all();
+
+    TArray<double> X, Y, Z;
+    TestPoints(X, Y, Z);
+    const int32 Num = X.Num();
+
+    TArray<double> a, b, c, X2, Y2, Z2;
+    a.SetNum(Num); b.SetNum(Num); c.SetNum(Num);
+    X2.SetNum(Num); Y2.SetNum(Num); Z2.SetNum(Num);
+    const FConstVectorBatch rectan(X, Y, Z);
+    const FVectorBatch rectan2{ X2, Y2, Z2 };
+
+    Reclat(rectan, a, b, c);
+    for (int32 i = 0; i < Num; i += 5)
+    {
+        FSLatitudinalVector expected;
+        USpice::reclat(FSDistanceVector(X[i], Y[i], Z[i]), expected);
+        EXPECT_NEAR(a[i], expected.r.km, 1e-9);
+        EXPECT_NEAR(b[i], expected.lonlat.longitude.AsSpiceDouble(), 1e-12);
+        EXPECT_NEAR(c[i], expected.lonlat.latitude.AsSpiceDouble(), 1e-12);
+    }
+    Latrec(a, b, c, rectan2);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        EXPECT_NEAR(X2[i], X[i], 1e-8);
+        EXPECT_NEAR(Z2[i], Z[i], 1e-8);
+    }
+
+    Recsph(rectan, a, b, c);
+    for (int32 i = 0; i < Num; i += 5)
+    {
+        FSSphericalVector expected;
+        USpice::recsph(FSDistanceVector(X[i], Y[i], Z[i]), expected);
+        EXPECT_NEAR(a[i], expected.r.km, 1e-9);
+        EXPECT_NEAR(b[i], expected.colat.AsSpiceDouble(), 1e-12);
+        EXPECT_NEAR(c[i], expected.lon.AsSpiceDouble(), 1e-12);
+    }
+    Sphrec(a, b, c, rectan2);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        EXPECT_NEAR(Y2[i], Y[i], 1e-8);
+        EXPECT_NEAR(Z2[i], Z[i], 1e-8);
+    }
+
+    Reccyl(rectan, a, b, c);
+    for (int32 i = 0; i < Num; i += 5)
+    {
+        FSCylindricalVector expected;
+        USpice::reccyl(FSDistanceVector(X[i], Y[i], Z[i]), expected);
+        EXPECT_NEAR(a[i], expected.r.km, 1e-9);
+        EXPECT_NEAR(b[i], expected.lon.AsSpiceDouble(), 1e-12);
+        EXPECT_NEAR(c[i], expected.z.km, 1e-9);
+    }
+    Cylrec(a, b, c, rectan2);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        EXPECT_NEAR(X2[i], X[i], 1e-8);
+        EXPECT_NEAR(Y2[i], Y[i], 1e-8);
+    }
+}
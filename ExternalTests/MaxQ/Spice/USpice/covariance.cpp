@@ -0,0 +1,216 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCovariance.h"
+#include "SpiceConjunction.h"
+
+using namespace MaxQ::Orbits;
+
+static const double gm_earth = 398600.4418;
+
+// A symmetric positive definite 6x6, different for each i
+static void TestCovariance(int32 i, double(&P)[6][6])
+{
+    double L[6][6] = {};
+    for (int32 r = 0; r < 6; ++r)
+    {
+        for (int32 c = 0; c <= r; ++c)
+        {
+            L[r][c] = r == c ? (r < 3 ? .1 : 1e-4) * (1. + .1 * i) : 1e-3 * sin(1. + r * 7 + c * 3 + i);
+        }
+    }
+    for (int32 r = 0; r < 6; ++r)
+    {
+        for (int32 c = 0; c < 6; ++c)
+        {
+            P[r][c] = 0.;
+            for (int32 k = 0; k < 6; ++k) P[r][c] += L[r][k] * L[c][k];
+        }
+    }
+}
+
+static void PhiPPhiT(const double(&Phi)[6][6], const double(&P)[6][6], double(&Out)[6][6])
+{
+    for (int32 r = 0; r < 6; ++r)
+    {
+        for (int32 c = 0; c < 6; ++c)
+        {
+            Out[r][c] = 0.;
+            for (int32 j = 0; j < 6; ++j)
+            {
+                for (int32 k = 0; k < 6; ++k) Out[r][c] += Phi[r][j] * P[j][k] * Phi[c][k];
+            }
+        }
+    }
+}
+
+TEST(covariance_test, Transform_Matches_Matrix_Product) {
+
+    // Not a multiple of the lane width
+    const int32 Num = 7;
+
+    TArray<FSStateVector> States;
+    FCovarianceBatch Batch;
+    Batch.SetNum(Num);
+    EXPECT_EQ(Batch.Num(), Num);
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        States.Add(FSStateVector(FSDistanceVector(7000. + 500. * i, 100. * i, -50. * i), FSVelocityVector(.1 * i, 7.5 - .2 * i, 1. + .1 * i)));
+
+        double P[6][6];
+        TestCovariance(i, P);
+        Batch.Set(i, P);
+    }
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        double P[6][6], Q[6][6];
+        TestCovariance(i, P);
+        Batch.Get(i, Q);
+        for (int32 r = 0; r < 6; ++r)
+        {
+            for (int32 c = 0; c < 6; ++c) EXPECT_DOUBLE_EQ(Q[r][c], P[r][c]);
+        }
+        EXPECT_DOUBLE_EQ(Batch.Column(1, 4)[i], P[1][4]);
+        EXPECT_DOUBLE_EQ(Batch.Column(4, 1)[i], P[1][4]);
+    }
+
+    // Through an hour of two-body motion
+    const FSEphemerisPeriod dt(3600.);
+    TArray<FSStateVector> Propagated;
+    TArray<FSStateTransform> Stm;
+    Propagated.SetNum(Num);
+    Stm.SetNum(Num);
+    EXPECT_EQ(Prop2bBatch(FSMassConstant(gm_earth), States, MakeArrayView(&dt, 1), Propagated, Stm), Num);
+
+    Batch.Transform(Stm);
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        double P[6][6], Q[6][6], Expected[6][6];
+        TestCovariance(i, P);
+        PhiPPhiT(Stm[i].AsSpiceDoubleArray(), P, Expected);
+        Batch.Get(i, Q);
+
+        for (int32 r = 0; r < 6; ++r)
+        {
+            for (int32 c = 0; c < 6; ++c) EXPECT_NEAR(Q[r][c], Expected[r][c], 1e-12 * FMath::Max(1., FMath::Abs(Expected[r][c]))) << i << " " << r << " " << c;
+        }
+    }
+
+    // One transform for all:  a rotation about z, then its inverse
+    double Rz[6][6] = {}, RzT[6][6] = {};
+    const double a = .3;
+    for (int32 k = 0; k < 6; k += 3)
+    {
+        Rz[k][k] = cos(a); Rz[k][k + 1] = -sin(a);
+        Rz[k + 1][k] = sin(a); Rz[k + 1][k + 1] = cos(a);
+        Rz[k + 2][k + 2] = 1.;
+    }
+    for (int32 r = 0; r < 6; ++r)
+    {
+        for (int32 c = 0; c < 6; ++c) RzT[r][c] = Rz[c][r];
+    }
+
+    TArray<double> Before;
+    for (int32 i = 0; i < Num; ++i) Before.Add(Batch.Column(0, 3)[i]);
+
+    const FSStateTransform Forward(Rz), Back(RzT);
+    Batch.Transform(MakeArrayView(&Forward, 1));
+    Batch.Transform(MakeArrayView(&Back, 1));
+    for (int32 i = 0; i < Num; ++i) EXPECT_NEAR(Batch.Column(0, 3)[i], Before[i], 1e-15);
+}
+
+TEST(covariance_test, CollisionProbability_Isotropic) {
+
+    // A direct hit, isotropic:  1 - exp(-R^2 / 2 s^2)
+    const double s = .2, R = .05;
+    const double P[3][3] = { { s * s, 0., 0. }, { 0., s * s, 0. }, { 0., 0., 4. } };
+    const double v[3] = { 0., 0., 10. };
+
+    double Pc;
+    const double hit[3] = { 0., 0., 0. };
+    EXPECT_TRUE(CollisionProbability(hit, v, P, R, Pc));
+    EXPECT_NEAR(Pc, 1. - exp(-R * R / (2. * s * s)), 1e-10);
+
+    // A small circle, off center:  about its area times the density there
+    const double r[3] = { .3, .1, 7. };
+    const double small = 1e-3;
+    EXPECT_TRUE(CollisionProbability(r, v, P, small, Pc));
+    const double d2 = .3 * .3 + .1 * .1;
+    EXPECT_NEAR(Pc, small * small / (2. * s * s) * exp(-d2 / (2. * s * s)), 1e-9);
+
+    // Singular in the encounter plane
+    const double Flat[3][3] = { { s * s, 0., 0. }, { 0., 0., 0. }, { 0., 0., 4. } };
+    EXPECT_FALSE(CollisionProbability(r, v, Flat, R, Pc));
+    EXPECT_EQ(Pc, 0.);
+
+    const double still[3] = { 0., 0., 0. };
+    EXPECT_FALSE(CollisionProbability(r, still, P, R, Pc));
+}
+
+TEST(covariance_test, ConjunctionProbabilities) {
+
+    double geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+
+    TArray<FSGP4Propagator> Catalog;
+    for (int32 i = 0; i < 2; ++i)
+    {
+        double elems[10] = {};
+        elems[FSTwoLineElements::XINCL] = FMath::DegreesToRadians(45. + 10. * i);
+        elems[FSTwoLineElements::EO] = 0.001;
+        elems[FSTwoLineElements::XNO] = 14.8 * 2. * PI / 1440.;
+        elems[FSTwoLineElements::EPOCH] = 0.;
+        Catalog.Emplace(FSTLEGeophysicalConstants(geophs), FSTwoLineElements(elems));
+    }
+
+    // Both start at the ascending node together:  a conjunction at epoch
+    FCovarianceBatch Covariances;
+    Covariances.SetNum(Catalog.Num());
+    for (int32 i = 0; i < Catalog.Num(); ++i)
+    {
+        double P[6][6];
+        TestCovariance(i, P);
+        Covariances.Set(i, P);
+    }
+
+    TArray<FConjunction> Conjunctions;
+    Conjunctions.AddDefaulted(2);
+    Conjunctions[0].Primary = 0;
+    Conjunctions[0].Secondary = 1;
+    Conjunctions[0].TCA = 0.;
+    // Not in the catalog
+    Conjunctions[1].Primary = 0;
+    Conjunctions[1].Secondary = 5;
+
+    TArray<double> Pc;
+    Pc.SetNum(Conjunctions.Num());
+    EXPECT_EQ(ConjunctionProbabilities(Catalog, Covariances, Conjunctions, .01, Pc), 1);
+    EXPECT_EQ(Pc[1], 0.);
+
+    double s1[6], s2[6], P1[6][6], P2[6][6];
+    ASSERT_EQ(Catalog[0].Propagate(0., s1), ESGP4Status::Ok);
+    ASSERT_EQ(Catalog[1].Propagate(0., s2), ESGP4Status::Ok);
+    TestCovariance(0, P1);
+    TestCovariance(1, P2);
+
+    const double r[3] = { s2[0] - s1[0], s2[1] - s1[1], s2[2] - s1[2] };
+    const double v[3] = { s2[3] - s1[3], s2[4] - s1[4], s2[5] - s1[5] };
+    double P[3][3];
+    for (int32 j = 0; j < 3; ++j)
+    {
+        for (int32 k = 0; k < 3; ++k) P[j][k] = P1[j][k] + P2[j][k];
+    }
+
+    double Expected;
+    ASSERT_TRUE(CollisionProbability(r, v, P, .01, Expected));
+    EXPECT_GT(Expected, 0.);
+    EXPECT_NEAR(Pc[0], Expected, 1e-9 * Expected);
+}
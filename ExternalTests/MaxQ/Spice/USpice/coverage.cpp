@@ -0,0 +1,155 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCoverage.h"
+
+using namespace MaxQ::Orbits;
+
+namespace
+{
+    FCoverageGrid CoarseGrid()
+    {
+        FCoverageGrid Grid;
+        Grid.Width = 36;
+        Grid.Height = 18;
+        return Grid;
+    }
+
+    int32 CellAt(const FCoverageGrid& Grid, double Longitude, double Latitude)
+    {
+        const int32 x = FMath::Clamp(int32((Longitude - Grid.MinLongitude) / (Grid.MaxLongitude - Grid.MinLongitude) * Grid.Width), 0, Grid.Width - 1);
+        const int32 y = FMath::Clamp(int32((Latitude - Grid.MinLatitude) / (Grid.MaxLatitude - Grid.MinLatitude) * Grid.Height), 0, Grid.Height - 1);
+        return y * Grid.Width + x;
+    }
+
+    // Geodetic elevation of Satellite from a cell, the slow way
+    double Elevation(const FCoverageAnalysis& Analysis, const FCoverageGrid& Grid, int32 Cell, const FSDistanceVector& Satellite)
+    {
+        const double lon = Grid.MinLongitude + (Cell % Grid.Width + .5) * (Grid.MaxLongitude - Grid.MinLongitude) / Grid.Width;
+        const double lat = Grid.MinLatitude + (Cell / Grid.Width + .5) * (Grid.MaxLatitude - Grid.MinLatitude) / Grid.Height;
+        const FVector3d Up(cos(lat) * cos(lon), cos(lat) * sin(lon), sin(lat));
+        const FSDistanceVector p = Analysis.GetCellPosition(Cell);
+        const FVector3d d(Satellite.x.km - p.x.km, Satellite.y.km - p.y.km, Satellite.z.km - p.z.km);
+        return asin(FVector3d::DotProduct(d, Up) / d.Length());
+    }
+}
+
+
+TEST(coverage_test, Geostationary_Satellite) {
+
+    const FCoverageGrid Grid = CoarseGrid();
+    FCoverageAnalysis Analysis;
+    ASSERT_TRUE(Analysis.Begin(Grid));
+    EXPECT_EQ(Analysis.Num(), 36 * 18);
+
+    // Above 0N 0E, not moving in the Earth fixed frame
+    const TArray<FSDistanceVector> Satellite{ FSDistanceVector(42164., 0., 0.) };
+    for (int32 s = 0; s < 10; ++s)
+    {
+        EXPECT_TRUE(Analysis.AddStep(s * 60., Satellite));
+    }
+    Analysis.End(600.);
+    EXPECT_EQ(Analysis.GetDuration(), 600.);
+
+    const int32 Below = CellAt(Grid, 0.05, 0.05);
+    EXPECT_DOUBLE_EQ(Analysis.FoldFraction(Below, 1), 1.);
+    EXPECT_EQ(Analysis.FoldFraction(Below, 2), 0.);
+    EXPECT_EQ(Analysis.NumGaps(Below), 0);
+
+    // The far side:  one gap, the whole window
+    const int32 Antipode = CellAt(Grid, PI - 0.05, 0.05);
+    EXPECT_EQ(Analysis.FoldFraction(Antipode, 1), 0.);
+    EXPECT_EQ(Analysis.NumGaps(Antipode), 1);
+    EXPECT_DOUBLE_EQ(Analysis.MaxGap(Antipode), 600.);
+    EXPECT_DOUBLE_EQ(Analysis.MeanRevisit(Antipode), 600.);
+
+    // Closed
+    EXPECT_FALSE(Analysis.AddStep(700., Satellite));
+}
+
+
+TEST(coverage_test, Gaps_And_Folds) {
+
+    const FCoverageGrid Grid = CoarseGrid();
+    FCoverageAnalysis Analysis;
+    ASSERT_TRUE(Analysis.Begin(Grid));
+
+    const FSDistanceVector Near(42164., 0., 0.), Far(-42164., 0., 0.);
+    const int32 Cell = CellAt(Grid, 0.05, 0.05);
+
+    // In view, out of view for 20 s, then in view twice over
+    Analysis.AddStep(0., TArray<FSDistanceVector>{ Near, Far });
+    Analysis.AddStep(10., TArray<FSDistanceVector>{ Far, Far });
+    EXPECT_FALSE(Analysis.AddStep(10., TArray<FSDistanceVector>{ Far, Far }));
+    Analysis.AddStep(30., TArray<FSDistanceVector>{ Near, Near });
+
+    // An invalid satellite isn't counted
+    const bool Valid[] = { true, false };
+    Analysis.AddStep(35., TArray<FSDistanceVector>{ Near, Near }, Valid);
+    Analysis.End(40.);
+
+    EXPECT_DOUBLE_EQ(Analysis.FoldFraction(Cell, 1), 20. / 40.);
+    EXPECT_DOUBLE_EQ(Analysis.FoldFraction(Cell, 2), 5. / 40.);
+    EXPECT_EQ(Analysis.NumGaps(Cell), 1);
+    EXPECT_DOUBLE_EQ(Analysis.MaxGap(Cell), 20.);
+}
+
+
+TEST(coverage_test, Matches_Elevations) {
+
+    const FCoverageGrid Grid = CoarseGrid();
+    FCoverageSettings Settings;
+    Settings.MinElevation = 10. * PI / 180.;
+    Settings.MaxFold = 8;
+
+    FCoverageAnalysis Analysis;
+    ASSERT_TRUE(Analysis.Begin(Grid, Settings));
+
+    TArray<FSDistanceVector> Satellites;
+    FRandomStream Random(1234);
+    for (int32 j = 0; j < 40; ++j)
+    {
+        const FVector3d u = Random.GetUnitVector();
+        const double r = Random.FRandRange(6800., 8000.);
+        Satellites.Add(FSDistanceVector(r * u.X, r * u.Y, r * u.Z));
+    }
+    Analysis.AddStep(0., Satellites);
+    Analysis.End(1.);
+
+    for (int32 Cell = 0; Cell < Analysis.Num(); Cell += 7)
+    {
+        int32 Count = 0;
+        for (const FSDistanceVector& Satellite : Satellites)
+        {
+            Count += Elevation(Analysis, Grid, Cell, Satellite) >= Settings.MinElevation ? 1 : 0;
+        }
+        for (int32 K = 1; K <= Settings.MaxFold; ++K)
+        {
+            EXPECT_EQ(Analysis.FoldFraction(Cell, K), Count >= K ? 1. : 0.) << "cell " << Cell << " K " << K;
+        }
+    }
+}
+
+
+TEST(coverage_test, Rejects_Bad_Grids) {
+
+    FCoverageAnalysis Analysis;
+    FCoverageGrid Grid = CoarseGrid();
+    Grid.Width = 0;
+    EXPECT_FALSE(Analysis.Begin(Grid));
+
+    Grid = CoarseGrid();
+    Grid.MaxLatitude = Grid.MinLatitude;
+    EXPECT_FALSE(Analysis.Begin(Grid));
+
+    FCoverageSettings Settings;
+    Settings.MaxFold = 0;
+    EXPECT_FALSE(Analysis.Begin(CoarseGrid(), Settings));
+    EXPECT_FALSE(Analysis.AddStep(0., TArray<FSDistanceVector>{ FSDistanceVector(42164., 0., 0.) }));
+}
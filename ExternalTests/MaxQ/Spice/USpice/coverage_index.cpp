@@ -0,0 +1,104 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCoverageIndex.h"
+#include "SpiceCore.h"
+#include "Misc/Paths.h"
+
+using MaxQ::Data::EKernelCoverageType;
+
+
+TEST(coverage_index_test, Answers_Coverage_Queries) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    const FString Spk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"));
+
+    MaxQ::Data::FKernelCoverageIndex Index;
+    EXPECT_TRUE(Index.Add({ Spk }, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_EQ(Index.NumFiles(), 1);
+    EXPECT_EQ(Index.FileType(0), EKernelCoverageType::SPK);
+    EXPECT_TRUE(Index.Ids(EKernelCoverageType::SPK).Contains(9994));
+
+    // Same as spkcov
+    TArray<FSWindowSegment> spkcov;
+    USpice::spkcov(ResultCode, ErrorMessage, Spk, 9994, {}, spkcov);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    const MaxQ::GeometryFinder::FSWindow& Coverage = Index.Coverage(EKernelCoverageType::SPK, 9994);
+    ASSERT_EQ(Coverage.Num(), spkcov.Num());
+    EXPECT_DOUBLE_EQ(Coverage.Start(0), spkcov[0].start);
+    EXPECT_DOUBLE_EQ(Coverage.Stop(0), spkcov[0].stop);
+
+    EXPECT_TRUE(Index.IsCovered(EKernelCoverageType::SPK, 9994, et0.seconds));
+    EXPECT_FALSE(Index.IsCovered(EKernelCoverageType::SPK, 9994, Coverage.Stop(Coverage.Num() - 1) + 1.));
+    EXPECT_FALSE(Index.IsCovered(EKernelCoverageType::SPK, 123456, et0.seconds));
+    EXPECT_FALSE(Index.IsCovered(EKernelCoverageType::CK, 9994, et0.seconds));
+
+    const MaxQ::Data::FCoverageSegment* Segment = Index.FindSegment(EKernelCoverageType::SPK, 9994, et0.seconds);
+    ASSERT_NE(Segment, nullptr);
+    EXPECT_EQ(Segment->Id, 9994);
+    EXPECT_EQ(Segment->File, 0);
+    EXPECT_LE(Segment->Start, et0.seconds);
+    EXPECT_GE(Segment->Stop, et0.seconds);
+
+    // Scrubbing clamps to the coverage
+    double Clamped = 0.;
+    EXPECT_TRUE(Index.Clamp(EKernelCoverageType::SPK, 9994, et0.seconds, Clamped));
+    EXPECT_DOUBLE_EQ(Clamped, et0.seconds);
+    EXPECT_TRUE(Index.Clamp(EKernelCoverageType::SPK, 9994, Coverage.Stop(Coverage.Num() - 1) + 1.e6, Clamped));
+    EXPECT_DOUBLE_EQ(Clamped, Coverage.Stop(Coverage.Num() - 1));
+    EXPECT_TRUE(Index.Clamp(EKernelCoverageType::SPK, 9994, Coverage.Start(0) - 1.e6, Clamped));
+    EXPECT_DOUBLE_EQ(Clamped, Coverage.Start(0));
+    EXPECT_FALSE(Index.Clamp(EKernelCoverageType::SPK, 123456, et0.seconds, Clamped));
+
+    // Round trip
+    const FString IndexPath = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test.kcov"));
+    EXPECT_TRUE(Index.Save(IndexPath, &ResultCode, &ErrorMessage));
+    MaxQ::Data::FKernelCoverageIndex Loaded;
+    EXPECT_TRUE(Loaded.Load(IndexPath, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Loaded.NumFiles(), 1);
+    EXPECT_TRUE(Loaded.Coverage(EKernelCoverageType::SPK, 9994) == Coverage);
+    EXPECT_EQ(Loaded.Segments(EKernelCoverageType::SPK, 9994).Num(), Index.Segments(EKernelCoverageType::SPK, 9994).Num());
+
+    // Twice:  built, then from the cache
+    for (int i = 0; i < 2; ++i)
+    {
+        MaxQ::Data::FKernelCoverageIndex Cached;
+        EXPECT_TRUE(Cached.AddCached({ Spk }, FString(), &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_TRUE(Cached.IsCovered(EKernelCoverageType::SPK, 9994, et0.seconds));
+    }
+}
+
+
+TEST(coverage_index_test, Indexes_Loaded_Kernels) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    // Text kernels aren't indexed
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    MaxQ::Data::FKernelCoverageIndex Index;
+    EXPECT_TRUE(Index.AddLoaded(&ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_GE(Index.NumFiles(), 1);
+    EXPECT_TRUE(Index.IsCovered(EKernelCoverageType::SPK, 9995, et0.seconds));
+
+    EXPECT_FALSE(Index.Add({ FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_lsk.tls")) }, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    MaxQ::Core::ClearAll();
+}
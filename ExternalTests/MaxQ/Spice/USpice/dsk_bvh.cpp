@@ -0,0 +1,268 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceDskBvh.h"
+
+using namespace MaxQ::Dsk;
+
+// No DSK ships with the unit test kernels, so the shapes are built here.
+
+static void Cube(TArray<double>& Vertices, TArray<int32>& Plates)
+{
+    Vertices.Reset();
+    for (int i = 0; i < 8; ++i)
+    {
+        Vertices.Append({ (i & 1) ? 1. : -1., (i & 2) ? 1. : -1., (i & 4) ? 1. : -1. });
+    }
+    // Outward (counterclockwise, seen from outside), 1-based
+    Plates = {
+        1, 3, 4,  1, 4, 2,      // -z
+        5, 6, 8,  5, 8, 7,      // +z
+        1, 2, 6,  1, 6, 5,      // -y
+        3, 7, 8,  3, 8, 4,      // +y
+        1, 5, 7,  1, 7, 3,      // -x
+        2, 4, 8,  2, 8, 6       // +x
+    };
+}
+
+static void Sphere(int Rings, int Segments, TArray<double>& Vertices, TArray<int32>& Plates)
+{
+    Vertices = { 0., 0., 1. };
+    for (int r = 1; r < Rings; ++r)
+    {
+        const double theta = PI * r / Rings;
+        for (int s = 0; s < Segments; ++s)
+        {
+            const double phi = 2. * PI * s / Segments;
+            Vertices.Append({ sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta) });
+        }
+    }
+    Vertices.Append({ 0., 0., -1. });
+
+    const int South = 2 + (Rings - 1) * Segments;
+    auto Ring = [&](int r, int s) { return 2 + (r - 1) * Segments + (s % Segments); };
+    for (int s = 0; s < Segments; ++s)
+    {
+        Plates.Append({ 1, Ring(1, s), Ring(1, s + 1) });
+        for (int r = 1; r + 1 < Rings; ++r)
+        {
+            Plates.Append({ Ring(r, s), Ring(r + 1, s), Ring(r + 1, s + 1) });
+            Plates.Append({ Ring(r, s), Ring(r + 1, s + 1), Ring(r, s + 1) });
+        }
+        Plates.Append({ Ring(Rings - 1, s), South, Ring(Rings - 1, s + 1) });
+    }
+}
+
+static bool IsNear(const FSDistanceVector& a, const FSDistanceVector& b, double tol)
+{
+    return FMath::Abs(a.x.km - b.x.km) <= tol && FMath::Abs(a.y.km - b.y.km) <= tol && FMath::Abs(a.z.km - b.z.km) <= tol;
+}
+
+static FSRay Ray(double x, double y, double z, double dx, double dy, double dz)
+{
+    FSRay Ray;
+    Ray.point = FSDistanceVector(x, y, z);
+    Ray.direction = FSDimensionlessVector(dx, dy, dz);
+    return Ray;
+}
+
+
+TEST(dsk_bvh_test, Cube_Hits_And_Normals) {
+
+    TArray<double> Vertices;
+    TArray<int32> Plates;
+    Cube(Vertices, Plates);
+
+    FDskShapeModel Model;
+    ASSERT_TRUE(Model.AddSegment(Vertices, Plates, 10013, 1));
+    EXPECT_EQ(Model.NumPlates(), 12);
+
+    FDskHit Hit;
+    EXPECT_TRUE(Model.Intersect(Ray(10., 0.25, -0.5, -1., 0., 0.), Hit));
+    EXPECT_TRUE(Hit.bFound);
+    EXPECT_TRUE(IsNear(Hit.Point, FSDistanceVector(1., 0.25, -0.5), 1e-12));
+    EXPECT_TRUE(IsNear(Hit.Normal, FSDimensionlessVector(1., 0., 0.), 1e-12));
+    EXPECT_TRUE(Hit.Plate == 11 || Hit.Plate == 12);
+    EXPECT_EQ(Hit.Surface, 1);
+
+    // Through an edge (between two plates) and a corner
+    EXPECT_TRUE(Model.Intersect(Ray(0., 0., 10., 0., 0., -1.), Hit));
+    EXPECT_TRUE(IsNear(Hit.Point, FSDistanceVector(0., 0., 1.), 1e-12));
+    EXPECT_TRUE(Model.Intersect(Ray(5., 5., 5., -1., -1., -1.), Hit));
+    EXPECT_TRUE(IsNear(Hit.Point, FSDistanceVector(1., 1., 1.), 1e-9));
+
+    // Misses, pointing away, and no direction
+    EXPECT_FALSE(Model.Intersect(Ray(10., 2., 0., -1., 0., 0.), Hit));
+    EXPECT_FALSE(Hit.bFound);
+    EXPECT_FALSE(Model.Intersect(Ray(10., 0., 0., 1., 0., 0.), Hit));
+    EXPECT_FALSE(Model.Intersect(Ray(10., 0., 0., 0., 0., 0.), Hit));
+
+    // From inside, the far wall
+    EXPECT_TRUE(Model.Intersect(Ray(0., 0., 0., 0., 1., 0.), Hit));
+    EXPECT_TRUE(IsNear(Hit.Point, FSDistanceVector(0., 1., 0.), 1e-12));
+}
+
+
+TEST(dsk_bvh_test, Sphere_Matches_Brute_Force) {
+
+    TArray<double> Vertices;
+    TArray<int32> Plates;
+    Sphere(48, 96, Vertices, Plates);
+
+    FDskShapeModel Model;
+    ASSERT_TRUE(Model.AddSegment(Vertices, Plates, 10013));
+
+    TArray<FSRay> Rays;
+    for (int i = 0; i < 2000; ++i)
+    {
+        // Looking roughly at the origin, from all around
+        const double a = 0.7 * i, b = 1.3 * i;
+        const double x = 3. * cos(a) * sin(b), y = 3. * sin(a) * sin(b), z = 3. * cos(b);
+        Rays.Add(Ray(x, y, z, -x + 0.9 * sin(3.1 * i), -y + 0.9 * cos(1.7 * i), -z + 0.9 * sin(0.3 * i)));
+    }
+
+    TArray<FDskHit> Hits;
+    Model.Intersect(Rays, Hits);
+    ASSERT_EQ(Hits.Num(), Rays.Num());
+
+    int NumHits = 0;
+    for (int i = 0; i < Rays.Num(); ++i)
+    {
+        double o[3], d[3];
+        Rays[i].CopyTo(o, d);
+
+        // Every plate
+        double tBest = 1e300;
+        int Best = 0;
+        for (int p = 0; p < Plates.Num() / 3; ++p)
+        {
+            const double* v1 = &Vertices[3 * (Plates[3 * p] - 1)];
+            const double* v2 = &Vertices[3 * (Plates[3 * p + 1] - 1)];
+            const double* v3 = &Vertices[3 * (Plates[3 * p + 2] - 1)];
+            const double e1[3] = { v2[0] - v1[0], v2[1] - v1[1], v2[2] - v1[2] };
+            const double e2[3] = { v3[0] - v1[0], v3[1] - v1[1], v3[2] - v1[2] };
+            const double pv[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+            const double det = e1[0] * pv[0] + e1[1] * pv[1] + e1[2] * pv[2];
+            if (det == 0.) continue;
+            const double s[3] = { o[0] - v1[0], o[1] - v1[1], o[2] - v1[2] };
+            const double u = (s[0] * pv[0] + s[1] * pv[1] + s[2] * pv[2]) / det;
+            const double q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+            const double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+            const double t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+            if (u >= 0. && v >= 0. && u + v <= 1. && t >= 0. && t < tBest)
+            {
+                tBest = t;
+                Best = p + 1;
+            }
+        }
+
+        EXPECT_EQ(Hits[i].bFound, Best != 0) << i;
+        if (Best != 0 && Hits[i].bFound)
+        {
+            ++NumHits;
+            const FSDistanceVector Expected(o[0] + tBest * d[0], o[1] + tBest * d[1], o[2] + tBest * d[2]);
+            EXPECT_TRUE(IsNear(Hits[i].Point, Expected, 1e-9));
+
+            // Outward
+            double n[3], x[3];
+            Hits[i].Normal.CopyTo(n);
+            Hits[i].Point.CopyTo(x);
+            EXPECT_GT(n[0] * x[0] + n[1] * x[1] + n[2] * x[2], 0.9);
+        }
+    }
+    EXPECT_GT(NumHits, 1000);
+}
+
+
+TEST(dsk_bvh_test, Rejects_Bad_Segments) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    TArray<double> Vertices;
+    TArray<int32> Plates;
+    Cube(Vertices, Plates);
+
+    FDskShapeModel Model;
+    Plates[0] = 9;
+    EXPECT_FALSE(Model.AddSegment(Vertices, Plates, 10013, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    Plates[0] = 1;
+    EXPECT_TRUE(Model.AddSegment(Vertices, Plates, 10013, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_FALSE(Model.AddSegment(Vertices, Plates, 10014, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Model.NumSegments(), 1);
+}
+
+
+TEST(dsk_bvh_test, Batch_Matches_Hits) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<double> Vertices;
+    TArray<int32> Plates;
+    Sphere(24, 48, Vertices, Plates);
+
+    FDskShapeModel Model;
+    ASSERT_TRUE(Model.AddSegment(Vertices, Plates, 10013, 7));
+    Cube(Vertices, Plates);
+    for (double& Coordinate : Vertices) Coordinate *= 0.5;
+    ASSERT_TRUE(Model.AddSegment(Vertices, Plates, 10013, 8));
+
+    TArray<FSRay> Rays;
+    for (int i = 0; i < 3000; ++i)
+    {
+        const double a = 0.7 * i, b = 1.3 * i;
+        const double x = 3. * cos(a) * sin(b), y = 3. * sin(a) * sin(b), z = 3. * cos(b);
+        Rays.Add(Ray(x, y, z, -x + 0.9 * sin(3.1 * i), -y + 0.9 * cos(1.7 * i), -z + 0.9 * sin(0.3 * i)));
+    }
+
+    TArray<FDskHit> Expected;
+    Model.Intersect(Rays, Expected);
+
+    // Reused across "frames":  a smaller batch keeps the allocation
+    FDskHitBatch Hits;
+    EXPECT_TRUE(Dskxsi(Hits, Rays, et0, TEXT("EARTH"), TEXT("IAU_EARTH"), &Model, {}, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    const double* Allocation = Hits.X.GetData();
+    EXPECT_TRUE(Dskxsi(Hits, TArrayView<const FSRay>(Rays).Slice(0, 1000), et0, TEXT("EARTH"), TEXT("IAU_EARTH"), &Model));
+    EXPECT_EQ(Hits.Num(), 1000);
+    EXPECT_EQ(Hits.X.GetData(), Allocation);
+    Model.Intersect(Rays, Hits);
+    ASSERT_EQ(Hits.Num(), Rays.Num());
+    ASSERT_EQ(Hits.Sources.Num(), 2);
+    EXPECT_EQ(Hits.Sources[0].Surface, 7);
+    EXPECT_EQ(Hits.Sources[1].Surface, 8);
+
+    int NumHits = 0;
+    for (int i = 0; i < Rays.Num(); ++i)
+    {
+        EXPECT_EQ(Hits.Found[i] != 0, Expected[i].bFound) << i;
+        EXPECT_EQ(Hits.Plates[i], Expected[i].Plate);
+        EXPECT_EQ(Hits.Segments[i], Expected[i].Segment);
+        if (Expected[i].bFound)
+        {
+            ++NumHits;
+            EXPECT_TRUE(IsNear(FSDistanceVector(Hits.X[i], Hits.Y[i], Hits.Z[i]), Expected[i].Point, 1e-12));
+            EXPECT_EQ(Hits.Sources[Hits.Segments[i]].Surface, Expected[i].Surface);
+        }
+    }
+    EXPECT_GT(NumHits, 1000);
+
+    // The model must be in fixref
+    EXPECT_FALSE(Dskxsi(Hits, Rays, et0, TEXT("EARTH"), TEXT("J2000"), &Model, {}, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    MaxQ::Core::ClearAll();
+}
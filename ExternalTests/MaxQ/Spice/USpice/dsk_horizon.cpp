@@ -0,0 +1,142 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceDskHorizon.h"
+#include "SpiceDskTerrain.h"
+
+using namespace MaxQ::Dsk;
+
+// An axis aligned box's plates (outward), as a segment
+static void AddBox(FDskShapeModel& Model, const double(&Min)[3], const double(&Max)[3])
+{
+    TArray<double> Vertices;
+    for (int i = 0; i < 8; ++i)
+    {
+        Vertices.Append({ (i & 1) ? Max[0] : Min[0], (i & 2) ? Max[1] : Min[1], (i & 4) ? Max[2] : Min[2] });
+    }
+    TArray<int32> Plates = {
+        1, 3, 4,  1, 4, 2,
+        5, 6, 8,  5, 8, 7,
+        1, 2, 6,  1, 6, 5,
+        3, 7, 8,  3, 8, 4,
+        1, 5, 7,  1, 7, 3,
+        2, 4, 8,  2, 8, 6
+    };
+    Model.AddSegment(Vertices, Plates, 10013);
+}
+
+// A unit cube with a pillar standing on its +x face, east of the face's
+// center:  x 1...1.5, y 0.2...0.4, z -0.1...0.1
+static TSharedRef<FDskShapeModel, ESPMode::ThreadSafe> PillarModel()
+{
+    TSharedRef<FDskShapeModel, ESPMode::ThreadSafe> Model = MakeShared<FDskShapeModel, ESPMode::ThreadSafe>();
+    AddBox(*Model, { -1., -1., -1. }, { 1., 1., 1. });
+    AddBox(*Model, { 1., 0.2, -0.1 }, { 1.5, 0.4, 0.1 });
+    return Model;
+}
+
+
+TEST(dsk_horizon_test, Bake_Finds_Pillar) {
+
+    TSharedRef<FDskShapeModel, ESPMode::ThreadSafe> Model = PillarModel();
+
+    // Texel 0 is at longitude 0, latitude 0:  the +x face's center, with
+    // north +z and east +y
+    FDskTerrainTile Tile;
+    ASSERT_TRUE(BakeTerrainTile(*Model, { 1, 2, 1 }, 5, Tile));
+    ASSERT_NEAR(Tile.Radii[0], 1., 1.e-6);
+
+    FDskHorizonSettings Settings;
+    Settings.NumAzimuths = 3;
+    Settings.Iterations = 20;
+
+    FDskHorizonMap Map;
+    ASSERT_TRUE(BakeHorizonMap(*Model, Tile, Settings, Map));
+    ASSERT_EQ(Map.NumAzimuths, 4);
+    ASSERT_EQ(Map.Size, 5);
+    ASSERT_EQ(Map.Elevations.Num(), 25 * 4);
+
+    // North, south and west, the face's edge (just below level, from the
+    // ray's offset above it).  East, the pillar's near top edge.
+    const double Flat = -atan(Settings.Offset);
+    const double Pillar = atan((0.5 - Settings.Offset) / 0.2);
+    EXPECT_NEAR(Map.Elevations[0], Flat, 1.e-5);
+    EXPECT_NEAR(Map.Elevations[1], Pillar, 1.e-5);
+    EXPECT_NEAR(Map.Elevations[2], Flat, 1.e-5);
+    EXPECT_NEAR(Map.Elevations[3], Flat, 1.e-5);
+
+    // Between bins, interpolated (and azimuths wrap)
+    EXPECT_NEAR(Map.Elevation(0, HALF_PI), Map.Elevations[1], 1.e-6);
+    EXPECT_NEAR(Map.Elevation(0, HALF_PI / 2.), .5 * (Map.Elevations[0] + Map.Elevations[1]), 1.e-6);
+    EXPECT_NEAR(Map.Elevation(0, -1.5 * PI), Map.Elevations[1], 1.e-6);
+
+    FDskShapeModel Empty;
+    EXPECT_FALSE(BakeHorizonMap(Empty, Tile, Settings, Map));
+}
+
+
+TEST(dsk_horizon_test, Visibility_Against_Horizon) {
+
+    TSharedRef<FDskShapeModel, ESPMode::ThreadSafe> Model = PillarModel();
+
+    FDskTerrainTile Tile;
+    ASSERT_TRUE(BakeTerrainTile(*Model, { 1, 2, 1 }, 5, Tile));
+
+    FDskHorizonSettings Settings;
+    Settings.NumAzimuths = 4;
+    Settings.Iterations = 20;
+    FDskHorizonMap Map;
+    ASSERT_TRUE(BakeHorizonMap(*Model, Tile, Settings, Map));
+
+    // A distant source east of texel 0 at Elevation, or west
+    auto Source = [](double Elevation, double Sign)
+    {
+        const double D = 1.e8;
+        return FSDistanceVector(1. + D * sin(Elevation), Sign * D * cos(Elevation), 0.);
+    };
+
+    TArray<float> Visibility;
+    Visibility.SetNum(25);
+
+    ASSERT_TRUE(HorizonVisibility(Tile, Map, Source(1.0, 1.), 0., Visibility));
+    EXPECT_EQ(Visibility[0], 0.f);
+    ASSERT_TRUE(HorizonVisibility(Tile, Map, Source(1.4, 1.), 0., Visibility));
+    EXPECT_EQ(Visibility[0], 1.f);
+    ASSERT_TRUE(HorizonVisibility(Tile, Map, Source(0.1, -1.), 0., Visibility));
+    EXPECT_EQ(Visibility[0], 1.f);
+
+    // Half the disk above the pillar's edge
+    ASSERT_TRUE(HorizonVisibility(Tile, Map, Source(Map.Elevations[1], 1.), 0.01, Visibility));
+    EXPECT_NEAR(Visibility[0], .5f, 1.e-3f);
+
+    TArray<float> Short;
+    Short.SetNum(24);
+    EXPECT_FALSE(HorizonVisibility(Tile, Map, Source(1., 1.), 0., Short));
+}
+
+
+TEST(dsk_horizon_test, Terrain_Bakes_Horizons) {
+
+    FDskTerrainSettings Settings;
+    Settings.TileSize = 5;
+    Settings.MaxLevel = 0;
+    Settings.bHorizons = true;
+    Settings.HorizonSettings.NumAzimuths = 8;
+    Settings.HorizonSettings.Iterations = 4;
+    FDskTerrain Terrain(PillarModel(), Settings);
+
+    Terrain.Update(FSDistanceVector(1000., 0., 0.));
+    Terrain.Flush();
+
+    FDskTerrain::FTilePtr Tile = Terrain.Find({ 0, 1, 0 });
+    ASSERT_TRUE(Tile.IsValid());
+    EXPECT_EQ(Tile->Horizon.Size, 5);
+    EXPECT_EQ(Tile->Horizon.NumAzimuths, 8);
+    EXPECT_EQ(Tile->Horizon.Elevations.Num(), 25 * 8);
+}
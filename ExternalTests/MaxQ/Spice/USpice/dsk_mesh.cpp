@@ -0,0 +1,146 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceDskMesh.h"
+
+using namespace MaxQ::Dsk;
+
+// Unit sphere, plates wound outward (as DSKs are), 1-based
+static void Sphere(int Rings, int Segments, TArray<double>& Vertices, TArray<int32>& Plates)
+{
+    Vertices = { 0., 0., 1. };
+    for (int r = 1; r < Rings; ++r)
+    {
+        const double theta = PI * r / Rings;
+        for (int s = 0; s < Segments; ++s)
+        {
+            const double phi = 2. * PI * s / Segments;
+            Vertices.Append({ sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta) });
+        }
+    }
+    Vertices.Append({ 0., 0., -1. });
+
+    const int South = 2 + (Rings - 1) * Segments;
+    auto Ring = [&](int r, int s) { return 2 + (r - 1) * Segments + (s % Segments); };
+    for (int s = 0; s < Segments; ++s)
+    {
+        Plates.Append({ 1, Ring(1, s), Ring(1, s + 1) });
+        for (int r = 1; r + 1 < Rings; ++r)
+        {
+            Plates.Append({ Ring(r, s), Ring(r + 1, s), Ring(r + 1, s + 1) });
+            Plates.Append({ Ring(r, s), Ring(r + 1, s + 1), Ring(r, s + 1) });
+        }
+        Plates.Append({ Ring(Rings - 1, s), South, Ring(Rings - 1, s + 1) });
+    }
+}
+
+// Clustering can fold the odd triangle over, so LODs get some slack
+static void ExpectOutward(const FDskMeshLOD& LOD, double MaxFoldedFraction)
+{
+    ASSERT_EQ(LOD.Normals.Num(), LOD.Positions.Num());
+    for (uint32 Index : LOD.Indices)
+    {
+        ASSERT_LT(Index, (uint32)LOD.Positions.Num());
+    }
+    for (int32 v = 0; v < LOD.Positions.Num(); ++v)
+    {
+        EXPECT_NEAR(LOD.Normals[v].Size(), 1.f, 1e-5f);
+        EXPECT_GT(LOD.Normals[v] | LOD.Positions[v].GetSafeNormal(), 0.8f);
+    }
+    // UE's triangle normal:  (P2 - P0) ^ (P1 - P0)
+    int32 Folded = 0;
+    for (int32 t = 0; t < LOD.NumTriangles(); ++t)
+    {
+        const FVector3f& p0 = LOD.Positions[LOD.Indices[3 * t]];
+        const FVector3f& p1 = LOD.Positions[LOD.Indices[3 * t + 1]];
+        const FVector3f& p2 = LOD.Positions[LOD.Indices[3 * t + 2]];
+        if (!((((p2 - p0) ^ (p1 - p0)) | (p0 + p1 + p2)) > 0.f)) ++Folded;
+    }
+    EXPECT_LE(Folded, MaxFoldedFraction * LOD.NumTriangles());
+}
+
+
+TEST(dsk_mesh_test, Swizzles_And_Scales) {
+
+    FDskMeshSettings Settings;
+    Settings.Scale = 100.;
+    FDskMesh Mesh(Settings);
+
+    const TArray<double> Vertices = { 1., 2., 3.,  4., 5., 6.,  7., 8., 10. };
+    const TArray<int32> Plates = { 1, 2, 3 };
+    ASSERT_TRUE(Mesh.AddSegment(Vertices, Plates, 10013));
+
+    const FDskMeshLOD& LOD = Mesh.GetLODs()[0];
+    ASSERT_EQ(LOD.Positions.Num(), 3);
+    EXPECT_EQ(LOD.Positions[0], FVector3f(200.f, 100.f, 300.f));
+    EXPECT_EQ(LOD.Positions[2], FVector3f(800.f, 700.f, 1000.f));
+    EXPECT_EQ(LOD.Indices, TArray<uint32>({ 0, 1, 2 }));
+
+    // The same normal SPICE has for the plate, swizzled
+    const FVector3d a(1., 2., 3.), b(4., 5., 6.), c(7., 8., 10.);
+    const FVector3d n = ((b - a) ^ (c - a)).GetSafeNormal();
+    EXPECT_TRUE(LOD.Normals[1].Equals(FVector3f(n.Y, n.X, n.Z), 1e-5f));
+
+    // A second segment is appended
+    ASSERT_TRUE(Mesh.AddSegment(Vertices, Plates, 10013));
+    EXPECT_EQ(Mesh.GetLODs()[0].Indices, TArray<uint32>({ 0, 1, 2, 3, 4, 5 }));
+}
+
+
+TEST(dsk_mesh_test, Generates_LODs) {
+
+    TArray<double> Vertices;
+    TArray<int32> Plates;
+    Sphere(128, 256, Vertices, Plates);
+
+    FDskMeshSettings Settings;
+    Settings.NumLODs = 4;
+    Settings.Reduction = 0.25;
+    FDskMesh Mesh(Settings);
+    ASSERT_TRUE(Mesh.AddSegment(Vertices, Plates, 10013));
+    Mesh.GenerateLODs();
+
+    const TArray<FDskMeshLOD>& LODs = Mesh.GetLODs();
+    ASSERT_EQ(LODs.Num(), 4);
+    EXPECT_EQ(LODs[0].NumTriangles(), Plates.Num() / 3);
+
+    for (int32 Level = 0; Level < LODs.Num(); ++Level)
+    {
+        ExpectOutward(LODs[Level], Level == 0 ? 0. : 0.01);
+        if (Level > 0)
+        {
+            const double Target = LODs[0].NumTriangles() * FMath::Pow(0.25, Level);
+            EXPECT_GT(LODs[Level].NumTriangles(), 0.4 * Target) << Level;
+            EXPECT_LT(LODs[Level].NumTriangles(), 1.6 * Target) << Level;
+        }
+    }
+
+    // Generating again replaces them
+    Mesh.GenerateLODs();
+    EXPECT_EQ(Mesh.GetLODs().Num(), 4);
+}
+
+
+TEST(dsk_mesh_test, Rejects_Bad_Segments) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FDskMesh Mesh;
+    const TArray<double> Vertices = { 0., 0., 0.,  1., 0., 0.,  0., 1., 0. };
+
+    EXPECT_FALSE(Mesh.AddSegment(Vertices, { 1, 2, 4 }, 10013, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    EXPECT_TRUE(Mesh.AddSegment(Vertices, { 1, 2, 3 }, 10013, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_FALSE(Mesh.AddSegment(Vertices, { 1, 2, 3 }, 10014, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Mesh.GetLODs()[0].NumTriangles(), 1);
+}
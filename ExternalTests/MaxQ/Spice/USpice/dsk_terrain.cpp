@@ -0,0 +1,148 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceDskTerrain.h"
+
+using namespace MaxQ::Dsk;
+
+// A cube's surface is known exactly:  along d, 1 / max |d_i| out, with the
+// dominant axis's normal.
+static TSharedRef<FDskShapeModel, ESPMode::ThreadSafe> CubeModel()
+{
+    TArray<double> Vertices;
+    for (int i = 0; i < 8; ++i)
+    {
+        Vertices.Append({ (i & 1) ? 1. : -1., (i & 2) ? 1. : -1., (i & 4) ? 1. : -1. });
+    }
+    TArray<int32> Plates = {
+        1, 3, 4,  1, 4, 2,
+        5, 6, 8,  5, 8, 7,
+        1, 2, 6,  1, 6, 5,
+        3, 7, 8,  3, 8, 4,
+        1, 5, 7,  1, 7, 3,
+        2, 4, 8,  2, 8, 6
+    };
+
+    TSharedRef<FDskShapeModel, ESPMode::ThreadSafe> Model = MakeShared<FDskShapeModel, ESPMode::ThreadSafe>();
+    Model->AddSegment(Vertices, Plates, 10013);
+    return Model;
+}
+
+
+TEST(dsk_terrain_test, Bake_Matches_Cube) {
+
+    TSharedRef<FDskShapeModel, ESPMode::ThreadSafe> Model = CubeModel();
+    EXPECT_NEAR(Model->BoundingRadius(), FMath::Sqrt(3.), 1.e-12);
+
+    const FDskTerrainTileKey Key = { 1, 2, 1 };
+    EXPECT_NEAR(Key.West(), 0., 1.e-12);
+    EXPECT_NEAR(Key.North(), 0., 1.e-12);
+    EXPECT_NEAR(Key.Span(), HALF_PI, 1.e-12);
+
+    FDskTerrainTile Tile;
+    ASSERT_TRUE(BakeTerrainTile(*Model, Key, 17, Tile));
+    ASSERT_EQ(Tile.Radii.Num(), 17 * 17);
+    EXPECT_EQ(Tile.Misses, 0);
+    EXPECT_NEAR(Tile.MinRadius, 1., 1.e-6);
+    EXPECT_GT(Tile.MaxRadius, 1.6);
+    EXPECT_LT(Tile.MaxRadius, FMath::Sqrt(3.) + 1.e-6);
+
+    for (int j = 0; j < Tile.Size; ++j)
+    {
+        for (int i = 0; i < Tile.Size; ++i)
+        {
+            const double Lon = Key.West() + Key.Span() * i / (Tile.Size - 1);
+            const double Lat = Key.North() - Key.Span() * j / (Tile.Size - 1);
+            double d[3] = { cos(Lat) * cos(Lon), cos(Lat) * sin(Lon), sin(Lat) };
+            double a[3] = { fabs(d[0]), fabs(d[1]), fabs(d[2]) };
+            const int Axis = a[0] >= a[1] && a[0] >= a[2] ? 0 : (a[1] >= a[2] ? 1 : 2);
+
+            const int k = j * Tile.Size + i;
+            EXPECT_NEAR(Tile.Radii[k], 1. / a[Axis], 1.e-5) << i << " " << j;
+
+            // Off the cube's edges, the face's normal
+            if (a[Axis] > FMath::Max3(a[(Axis + 1) % 3], a[(Axis + 2) % 3], 0.) + 1.e-3)
+            {
+                EXPECT_NEAR(Tile.Normals[k][Axis], d[Axis] > 0. ? 1.f : -1.f, 1.e-6f);
+            }
+        }
+    }
+
+    // Neighbors agree along their shared edge
+    FDskTerrainTile East;
+    ASSERT_TRUE(BakeTerrainTile(*Model, { 1, 3, 1 }, 17, East));
+    for (int j = 0; j < Tile.Size; ++j)
+    {
+        EXPECT_FLOAT_EQ(Tile.Radii[j * Tile.Size + Tile.Size - 1], East.Radii[j * Tile.Size]);
+    }
+
+    FDskShapeModel Empty;
+    EXPECT_FALSE(BakeTerrainTile(Empty, Key, 17, Tile));
+    EXPECT_FALSE(BakeTerrainTile(*Model, Key, 1, Tile));
+}
+
+
+TEST(dsk_terrain_test, Refines_Near_Camera_And_Drops_Old_Tiles) {
+
+    FDskTerrainSettings Settings;
+    Settings.TileSize = 5;
+    Settings.MaxLevel = 5;
+    Settings.MaxBakes = 1000;
+    Settings.MaxTiles = 2;
+    // Distances to the faces, rather than the corners
+    Settings.Radius = 1.;
+    FDskTerrain Terrain(CubeModel(), Settings);
+
+    // Just above the +x face
+    Terrain.Update(FSDistanceVector(1.1, 0.05, 0.05));
+    const TArray<FDskTerrainTileKey> Wanted = Terrain.GetWanted();
+    ASSERT_GT(Wanted.Num(), 2);
+    EXPECT_LT(Wanted[0].Level, Settings.MaxLevel);
+    for (int i = 1; i < Wanted.Num(); ++i)
+    {
+        EXPECT_LE(Wanted[i - 1].Level, Wanted[i].Level);
+    }
+
+    // The tile under the camera is the finest
+    const double Lon = atan2(0.05, 1.1), Lat = atan2(0.05, FMath::Sqrt(1.1 * 1.1 + 0.05 * 0.05));
+    const FDskTerrainTileKey* Under = Wanted.FindByPredicate([&](const FDskTerrainTileKey& Key)
+    {
+        return Key.West() <= Lon && Lon < Key.West() + Key.Span() && Key.North() - Key.Span() < Lat && Lat <= Key.North();
+    });
+    ASSERT_NE(Under, nullptr);
+    EXPECT_EQ(Under->Level, Settings.MaxLevel);
+    const FDskTerrainTileKey Finest = *Under;
+
+    EXPECT_GT(Terrain.NumBaking(), 0);
+    Terrain.Flush();
+    EXPECT_EQ(Terrain.NumBaking(), 0);
+    for (const FDskTerrainTileKey& Key : Wanted)
+    {
+        FDskTerrain::FTilePtr Tile = Terrain.Find(Key);
+        ASSERT_TRUE(Tile.IsValid());
+        EXPECT_EQ(Tile->Key, Key);
+        EXPECT_EQ(Tile->Size, 5);
+    }
+
+    // A child not baked yet falls back to its parent
+    const FDskTerrainTileKey Child = { Finest.Level + 1, 2 * Finest.X, 2 * Finest.Y };
+    EXPECT_FALSE(Terrain.Find(Child).IsValid());
+    FDskTerrain::FTilePtr Stand = Terrain.FindOrAncestor(Child);
+    ASSERT_TRUE(Stand.IsValid());
+    EXPECT_EQ(Stand->Key, Finest);
+
+    // Far away, only the hemispheres are wanted, and the rest go
+    Terrain.Update(FSDistanceVector(1000., 0., 0.));
+    EXPECT_EQ(Terrain.GetWanted().Num(), 2);
+    Terrain.Flush();
+    Terrain.Update(FSDistanceVector(1000., 0., 0.));
+    EXPECT_EQ(Terrain.NumTiles(), 2);
+    EXPECT_FALSE(Terrain.Find(Finest).IsValid());
+    EXPECT_TRUE(Terrain.Find({ 0, 1, 0 }).IsValid());
+}
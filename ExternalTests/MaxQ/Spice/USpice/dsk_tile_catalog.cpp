@@ -0,0 +1,109 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceDskTileCatalog.h"
+
+using namespace MaxQ::Data;
+
+// No DSK can be opened without a project directory, so these check the
+// coverage test against hand-made descriptors.
+
+// SPICE_DSK_LATSYS ... SPICE_DSK_PDTSYS
+static constexpr int LATSYS = 1, CYLSYS = 2, RECSYS = 3, PDTSYS = 4;
+
+static FSDSKDescr Tile(int corsys, double LonMin, double LonMax, double LatMin, double LatMax)
+{
+    FSDSKDescr Descr;
+    Descr.center = 301;
+    Descr.dtype = 2;
+    Descr.corsys = corsys;
+    Descr.co1min = LonMin;
+    Descr.co1max = LonMax;
+    Descr.co2min = LatMin;
+    Descr.co2max = LatMax;
+    return Descr;
+}
+
+static double Rad(double Degrees) { return Degrees * PI / 180.; }
+
+
+TEST(dsk_tile_catalog_test, Covers_Latitude_Longitude_Tiles) {
+
+    // 10...20 E, 30...40 N
+    const FSDSKDescr Descr = Tile(LATSYS, Rad(10.), Rad(20.), Rad(30.), Rad(40.));
+
+    EXPECT_TRUE(FDskTileCatalog::Covers(Descr, Rad(15.), Rad(35.), 0.));
+    EXPECT_FALSE(FDskTileCatalog::Covers(Descr, Rad(25.), Rad(35.), 0.));
+    EXPECT_FALSE(FDskTileCatalog::Covers(Descr, Rad(15.), Rad(45.), 0.));
+
+    // Within reach...  5 degrees of longitude at 35 N is about 4.1 of arc
+    EXPECT_TRUE(FDskTileCatalog::Covers(Descr, Rad(15.), Rad(45.), Rad(6.)));
+    EXPECT_TRUE(FDskTileCatalog::Covers(Descr, Rad(25.), Rad(35.), Rad(4.2)));
+    EXPECT_FALSE(FDskTileCatalog::Covers(Descr, Rad(25.), Rad(35.), Rad(4.)));
+
+    // A cap reaching the pole takes every longitude
+    const FSDSKDescr Polar = Tile(LATSYS, Rad(10.), Rad(20.), Rad(70.), Rad(80.));
+    EXPECT_FALSE(FDskTileCatalog::Covers(Polar, Rad(190.), Rad(82.), Rad(3.)));
+    EXPECT_TRUE(FDskTileCatalog::Covers(Polar, Rad(190.), Rad(82.), Rad(9.)));
+}
+
+
+TEST(dsk_tile_catalog_test, Covers_Across_The_Antimeridian) {
+
+    // 0...360 tiles, 350...360 E
+    const FSDSKDescr East = Tile(LATSYS, Rad(350.), Rad(360.), Rad(-10.), Rad(10.));
+    EXPECT_TRUE(FDskTileCatalog::Covers(East, Rad(-5.), 0., 0.));
+    EXPECT_TRUE(FDskTileCatalog::Covers(East, Rad(355.), 0., 0.));
+    EXPECT_TRUE(FDskTileCatalog::Covers(East, Rad(2.), 0., Rad(3.)));
+    EXPECT_FALSE(FDskTileCatalog::Covers(East, Rad(5.), 0., Rad(3.)));
+
+    // -180...180 tiles, 170...180 E
+    const FSDSKDescr West = Tile(LATSYS, Rad(170.), Rad(180.), Rad(-10.), Rad(10.));
+    EXPECT_TRUE(FDskTileCatalog::Covers(West, Rad(-178.), 0., Rad(3.)));
+    EXPECT_FALSE(FDskTileCatalog::Covers(West, Rad(-170.), 0., Rad(3.)));
+}
+
+
+TEST(dsk_tile_catalog_test, Covers_Other_Coordinate_Systems) {
+
+    // Planetodetic latitudes are widened by the flattening
+    FSDSKDescr Pdt = Tile(PDTSYS, Rad(10.), Rad(20.), Rad(30.), Rad(40.));
+    Pdt.corpar = { 3396.19, .0059 };
+    EXPECT_TRUE(FDskTileCatalog::Covers(Pdt, Rad(15.), Rad(40.3), 0.));
+    EXPECT_FALSE(FDskTileCatalog::Covers(Pdt, Rad(15.), Rad(42.), 0.));
+
+    // Cylindrical:  longitude is the second coordinate, and there's no
+    // latitude bound
+    FSDSKDescr Cyl;
+    Cyl.corsys = CYLSYS;
+    Cyl.co2min = Rad(10.);
+    Cyl.co2max = Rad(20.);
+    EXPECT_TRUE(FDskTileCatalog::Covers(Cyl, Rad(15.), Rad(85.), 0.));
+    EXPECT_FALSE(FDskTileCatalog::Covers(Cyl, Rad(30.), 0., 0.));
+
+    // Rectangular segments can't be ruled out
+    EXPECT_TRUE(FDskTileCatalog::Covers(Tile(RECSYS, -1., 1., -1., 1.), Rad(90.), 0., 0.));
+}
+
+
+TEST(dsk_tile_catalog_test, Empty_Catalog_Loads_Nothing) {
+
+    FDskTileCatalog Catalog(4);
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    EXPECT_TRUE(Catalog.EnsureAround(301, FSDistanceVector(1800., 0., 0.), Rad(5.), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Catalog.NumFiles(), 0);
+    EXPECT_EQ(Catalog.NumLoaded(), 0);
+
+    TArray<int32> Found = { 1 };
+    Catalog.FindFiles(301, 0., 0., PI, Found);
+    EXPECT_EQ(Found.Num(), 0);
+}
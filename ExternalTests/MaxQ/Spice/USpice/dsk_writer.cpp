@@ -0,0 +1,217 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceDskWriter.h"
+#include "SpiceDskMesh.h"
+
+using namespace MaxQ::Dsk;
+
+// As with spk_segment_writer, no DSK can be opened without a project
+// directory, so these check the index (and the mesh conversion) natively.
+
+// spaixi's fixed part:  7 sizes and the coarse grid (SPICE_DSK02_IXIFIX)
+static constexpr int32 IXIFIX = 100007;
+
+// Unit sphere, plates wound outward (as DSKs are), 1-based
+static void Sphere(int Rings, int Segments, TArray<double>& Vertices, TArray<int32>& Plates)
+{
+    Vertices = { 0., 0., 1. };
+    for (int r = 1; r < Rings; ++r)
+    {
+        const double theta = PI * r / Rings;
+        for (int s = 0; s < Segments; ++s)
+        {
+            const double phi = 2. * PI * s / Segments;
+            Vertices.Append({ sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta) });
+        }
+    }
+    Vertices.Append({ 0., 0., -1. });
+
+    const int South = 2 + (Rings - 1) * Segments;
+    auto Ring = [&](int r, int s) { return 2 + (r - 1) * Segments + (s % Segments); };
+    for (int s = 0; s < Segments; ++s)
+    {
+        Plates.Append({ 1, Ring(1, s), Ring(1, s + 1) });
+        for (int r = 1; r + 1 < Rings; ++r)
+        {
+            Plates.Append({ Ring(r, s), Ring(r + 1, s), Ring(r + 1, s + 1) });
+            Plates.Append({ Ring(r, s), Ring(r + 1, s + 1), Ring(r, s + 1) });
+        }
+        Plates.Append({ Ring(Rings - 1, s), South, Ring(Rings - 1, s + 1) });
+    }
+}
+
+// A list (count, then plates) must be exactly Expected, largest first
+static void ExpectList(const int32* List, TArray<int32> Expected)
+{
+    Expected.Sort(TGreater<int32>());
+    ASSERT_EQ(List[0], Expected.Num());
+    for (int32 k = 0; k < Expected.Num(); ++k)
+    {
+        EXPECT_EQ(List[1 + k], Expected[k]);
+    }
+}
+
+
+TEST(dsk_writer_test, Index_Lists_Every_Plate) {
+
+    TArray<double> Vertices;
+    TArray<int32> Plates;
+    Sphere(40, 80, Vertices, Plates);
+    const int32 NumVertices = Vertices.Num() / 3;
+    const int32 NumPlates = Plates.Num() / 3;
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FDskSpatialIndex Index;
+    ASSERT_TRUE(BuildSpatialIndex(Vertices, Plates, Index, 5., 4, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // spaixd:  the extents, origin and voxel size
+    const TArray<double>& d = Index.Doubles;
+    ASSERT_EQ(d.Num(), 10);
+    EXPECT_NEAR(d[0], -1., 1.e-12);
+    EXPECT_NEAR(d[1], 1., 1.e-12);
+    EXPECT_NEAR(d[4], -1., 1.e-12);
+    EXPECT_NEAR(d[5], 1., 1.e-12);
+    const double* Origin = &d[6];
+    const double VoxelSize = d[9];
+    EXPECT_GT(VoxelSize, 0.);
+
+    // spaixi:  the sizes, then the arrays in order
+    const TArray<int32>& i = Index.Integers;
+    const int32 NumVoxels[3] = { i[0], i[1], i[2] };
+    const int32 Scale = i[3], NumPointers = i[4], VoxelListSize = i[5], VertexListSize = i[6];
+    EXPECT_EQ(Scale, 4);
+    EXPECT_EQ(NumVoxels[0] % Scale, 0);
+    EXPECT_EQ(Index.NumCoarseVoxels() * Scale * Scale * Scale, Index.NumFineVoxels());
+    ASSERT_EQ(i.Num(), IXIFIX + NumPointers + VoxelListSize + NumVertices + VertexListSize);
+    EXPECT_EQ(VertexListSize, NumVertices + 3 * NumPlates);
+
+    const int32* CoarseGrid = &i[7];
+    const int32* VoxelPointers = &i[IXIFIX];
+    const int32* VoxelList = VoxelPointers + NumPointers;
+    const int32* VertexPointers = VoxelList + VoxelListSize;
+    const int32* VertexList = VertexPointers + NumVertices;
+
+    // Every voxel a plate's box reaches lists it
+    TArray<TArray<int32>> Expected;
+    Expected.SetNum(NumPointers);
+    const double Tolerance = VoxelSize * .001;
+    for (int32 p = 0; p < NumPlates; ++p)
+    {
+        int32 Lo[3], Hi[3];
+        for (int32 c = 0; c < 3; ++c)
+        {
+            double Min = DBL_MAX, Max = -DBL_MAX;
+            for (int32 k = 0; k < 3; ++k)
+            {
+                Min = FMath::Min(Min, Vertices[3 * (Plates[3 * p + k] - 1) + c]);
+                Max = FMath::Max(Max, Vertices[3 * (Plates[3 * p + k] - 1) + c]);
+            }
+            Lo[c] = FMath::Min((int32)((Min - Tolerance - Origin[c]) / VoxelSize), NumVoxels[c] - 1);
+            Hi[c] = FMath::Min((int32)((Max + Tolerance - Origin[c]) / VoxelSize), NumVoxels[c] - 1);
+        }
+        for (int32 z = Lo[2]; z <= Hi[2]; ++z)
+            for (int32 y = Lo[1]; y <= Hi[1]; ++y)
+                for (int32 x = Lo[0]; x <= Hi[0]; ++x)
+                {
+                    const int32 Coarse = x / Scale + (NumVoxels[0] / Scale) * (y / Scale + (z / Scale) * (NumVoxels[1] / Scale));
+                    ASSERT_GT(CoarseGrid[Coarse], 0);
+                    const int32 Slot = CoarseGrid[Coarse] - 1 + (z % Scale) * Scale * Scale + (y % Scale) * Scale + (x % Scale);
+                    ASSERT_LT(Slot, NumPointers);
+                    Expected[Slot].Add(p + 1);
+                }
+    }
+    for (int32 Slot = 0; Slot < NumPointers; ++Slot)
+    {
+        if (Expected[Slot].Num() == 0)
+        {
+            EXPECT_EQ(VoxelPointers[Slot], -1);
+        }
+        else
+        {
+            ASSERT_GT(VoxelPointers[Slot], 0);
+            ExpectList(VoxelList + VoxelPointers[Slot] - 1, Expected[Slot]);
+        }
+    }
+
+    // ...and every vertex lists the plates that use it
+    TArray<TArray<int32>> Using;
+    Using.SetNum(NumVertices);
+    for (int32 k = 0; k < Plates.Num(); ++k)
+    {
+        Using[Plates[k] - 1].Add(k / 3 + 1);
+    }
+    for (int32 v = 0; v < NumVertices; ++v)
+    {
+        ASSERT_GT(VertexPointers[v], 0);
+        ExpectList(VertexList + VertexPointers[v] - 1, Using[v]);
+    }
+
+    // Built in parallel, but always the same
+    FDskSpatialIndex Again;
+    ASSERT_TRUE(BuildSpatialIndex(Vertices, Plates, Again, 5., 4));
+    EXPECT_EQ(Again.Doubles, Index.Doubles);
+    EXPECT_EQ(Again.Integers, Index.Integers);
+}
+
+
+TEST(dsk_writer_test, Index_Rejects_Bad_Input) {
+
+    TArray<double> Vertices;
+    TArray<int32> Plates;
+    Sphere(8, 16, Vertices, Plates);
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    FDskSpatialIndex Index;
+
+    EXPECT_FALSE(BuildSpatialIndex(Vertices, Plates, Index, 0., 4, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    EXPECT_FALSE(BuildSpatialIndex(Vertices, Plates, Index, 5., 0, &ResultCode, &ErrorMessage));
+
+    TArray<int32> Bad = Plates;
+    Bad[4] = Vertices.Num() / 3 + 1;
+    EXPECT_FALSE(BuildSpatialIndex(Vertices, Bad, Index, 5., 4, &ResultCode, &ErrorMessage));
+
+    // Voxels a hundredth of a plate across:  far too many
+    EXPECT_FALSE(BuildSpatialIndex(Vertices, Plates, Index, .01, 1, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    EXPECT_TRUE(BuildSpatialIndex(Vertices, Plates, Index, 5., 4, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+}
+
+
+TEST(dsk_writer_test, Mesh_Round_Trips_Through_FDskMesh) {
+
+    TArray<double> Vertices;
+    TArray<int32> Plates;
+    Sphere(12, 24, Vertices, Plates);
+
+    FDskMeshSettings Settings;
+    Settings.Scale = 100.;
+    FDskMesh Mesh(Settings);
+    ASSERT_TRUE(Mesh.AddSegment(Vertices, Plates, 10013));
+    const FDskMeshLOD& LOD = Mesh.GetLODs()[0];
+
+    TArray<double> BackVertices;
+    TArray<int32> BackPlates;
+    MeshToVerticesAndPlates(LOD.Positions, LOD.Indices, Settings.Scale, BackVertices, BackPlates);
+
+    EXPECT_EQ(BackPlates, Plates);
+    ASSERT_EQ(BackVertices.Num(), Vertices.Num());
+    for (int32 k = 0; k < Vertices.Num(); ++k)
+    {
+        EXPECT_NEAR(BackVertices[k], Vertices[k], 1.e-6);
+    }
+}
@@ -0,0 +1,109 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceEclipseBatch.h"
+
+using namespace MaxQ::Math;
+
+// The sun on +x, 1 AU away, and a spherical Earth
+static FEclipseGeometry Geometry(double a = 6378.1366, double c = 6378.1366)
+{
+    FEclipseGeometry Geometry;
+    Geometry.Source = FSDistanceVector(1.495978707e8, 0., 0.);
+    Geometry.SourceRadius = FSDistance(696000.);
+    Geometry.OccultingRadii = FSDistanceVector(a, a, c);
+    return Geometry;
+}
+
+
+TEST(eclipse_batch_test, Sunlit_Umbra_Annular_Inside) {
+
+    TArray<double> X = { 7000., -7000., -2.e6, 1000., 0. }, Y = { 0., 0., 0., 0., 0. }, Z = { 0., 0., 0., 0., 7000. };
+    TArray<ES_OccultationType> States;
+    TArray<float> Fraction;
+    States.SetNum(5); Fraction.SetNum(5);
+    ASSERT_TRUE(EclipseStates(Geometry(), FConstVectorBatch(X, Y, Z), States, Fraction));
+
+    EXPECT_EQ(States[0], ES_OccultationType::NONE);
+    EXPECT_EQ(Fraction[0], 0.f);
+
+    EXPECT_EQ(States[1], ES_OccultationType::FULL);
+    EXPECT_EQ(Fraction[1], 1.f);
+
+    // Past the umbra's tip (~1.38e6 km), the Earth is inside the sun's disk
+    EXPECT_EQ(States[2], ES_OccultationType::ANNULAR);
+    const double ao = asin(6378.1366 / 2.e6), as = asin(696000. / (1.495978707e8 + 2.e6));
+    EXPECT_NEAR(Fraction[2], ao * ao / (as * as), 1e-5);
+
+    EXPECT_EQ(States[3], ES_OccultationType::FULL);
+
+    // Over the terminator
+    EXPECT_EQ(States[4], ES_OccultationType::NONE);
+}
+
+
+TEST(eclipse_batch_test, Penumbra_Is_Monotonic) {
+
+    // Across the shadow's edge, behind the Earth
+    TArray<double> X, Y, Z;
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        X.Add(-20000.); Y.Add(6000. + 0.5 * i); Z.Add(0.);
+    }
+    TArray<ES_OccultationType> States;
+    TArray<float> Fraction;
+    States.SetNum(X.Num()); Fraction.SetNum(X.Num());
+    ASSERT_TRUE(EclipseStates(Geometry(), FConstVectorBatch(X, Y, Z), States, Fraction));
+
+    EXPECT_EQ(States[0], ES_OccultationType::FULL);
+    EXPECT_EQ(States.Last(), ES_OccultationType::NONE);
+
+    int32 Partial = 0;
+    for (int32 i = 1; i < X.Num(); ++i)
+    {
+        EXPECT_LE(Fraction[i], Fraction[i - 1]);
+        Partial += States[i] == ES_OccultationType::PARTIAL;
+        if (States[i] == ES_OccultationType::PARTIAL)
+        {
+            EXPECT_GT(Fraction[i], 0.f);
+            EXPECT_LT(Fraction[i], 1.f);
+        }
+    }
+
+    // The penumbra's about 2 * 20000 * 0.00465 = 186 km wide here
+    EXPECT_GT(Partial, 300);
+    EXPECT_LT(Partial, 420);
+}
+
+
+TEST(eclipse_batch_test, Ellipsoid_Shadow) {
+
+    // A prolate body along z, and a nearly point source
+    FEclipseGeometry G = Geometry(1., 4.);
+    G.Source = FSDistanceVector(1.e6, 0., 0.);
+    G.SourceRadius = FSDistance(1.e-3);
+
+    TArray<double> X = { -10., -10. }, Y = { 0., 0. }, Z = { 3.5, 4.5 };
+    TArray<ES_OccultationType> States;
+    States.SetNum(2);
+    ASSERT_TRUE(EclipseStates(G, FConstVectorBatch(X, Y, Z), States, {}));
+    EXPECT_EQ(States[0], ES_OccultationType::FULL);
+    EXPECT_EQ(States[1], ES_OccultationType::NONE);
+
+    // Rotated, so the long axis is along the caller's y
+    const double ToBodyFixed[3][3] = { { 1., 0., 0. }, { 0., 0., 1. }, { 0., -1., 0. } };
+    G.ToBodyFixed = FSRotationMatrix(ToBodyFixed);
+    TArray<double> Y2 = { 3.5, 4.5 }, Z2 = { 0., 0. };
+    ASSERT_TRUE(EclipseStates(G, FConstVectorBatch(X, Y2, Z2), States, {}));
+    EXPECT_EQ(States[0], ES_OccultationType::FULL);
+    EXPECT_EQ(States[1], ES_OccultationType::NONE);
+
+    // No radii
+    EXPECT_FALSE(EclipseStates(FEclipseGeometry(), FConstVectorBatch(X, Y, Z), States, {}));
+}
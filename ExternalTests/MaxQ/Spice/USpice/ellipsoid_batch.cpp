@@ -0,0 +1,159 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMathBatch.h"
+
+using namespace MaxQ::Math;
+
+static const double a = 3.5, b = 2., c = 1.25;
+
+// Observers inside, outside and on the ellipsoid, and rays in all directions
+static void TestRays(TArray<double>& X, TArray<double>& Y, TArray<double>& Z, TArray<double>& DX, TArray<double>& DY, TArray<double>& DZ)
+{
+    FRandomStream Random(4321);
+    for (int32 i = 0; i < 5000; ++i)
+    {
+        const double r = Random.FRandRange(0., 10.);
+        const FVector3d p = r * FVector3d(Random.GetUnitVector());
+        const FVector3d d = FVector3d(Random.GetUnitVector()) * Random.FRandRange(0.1, 10.);
+        X.Add(p.X); Y.Add(p.Y); Z.Add(p.Z);
+        DX.Add(d.X); DY.Add(d.Y); DZ.Add(d.Z);
+    }
+
+    // On the surface, at the center, and straight down the axes
+    X.Append({ a, 0., 0., 10. }); Y.Append({ 0., 0., 0., 0. }); Z.Append({ 0., 0., 10., 0. });
+    DX.Append({ 1., 1., 0., -1. }); DY.Append({ 0., 0., 0., 0. }); DZ.Append({ 0., 0., -1., 0. });
+}
+
+#define DECLARE_RAYS \
+    TArray<double> X, Y, Z, DX, DY, DZ; \
+    TestRays(X, Y, Z, DX, DY, DZ); \
+    const int32 Num = X.Num(); \
+    TArray<double> OX, OY, OZ, S; \
+    OX.SetNum(Num); OY.SetNum(Num); OZ.SetNum(Num); S.SetNum(Num);
+
+
+TEST(ellipsoid_batch_test, Surfpt_Matches_surfpt) {
+
+    USpice::init_all();
+    DECLARE_RAYS
+
+    TArray<uint8> Found;
+    Found.SetNum(Num);
+    ASSERT_TRUE(Surfpt(FConstVectorBatch(X, Y, Z), FConstVectorBatch(DX, DY, DZ), a, b, c, FVectorBatch{ OX, OY, OZ }, Found));
+
+    int32 Hits = 0;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        FSDistanceVector point;
+        bool bFound = false;
+        USpice::surfpt(ResultCode, ErrorMessage, FSDistanceVector(X[i], Y[i], Z[i]), FSDimensionlessVector(DX[i], DY[i], DZ[i]), FSDistance(a), FSDistance(b), FSDistance(c), point, bFound);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        ASSERT_EQ(Found[i] != 0, bFound) << "ray " << i;
+        if (bFound)
+        {
+            ++Hits;
+            EXPECT_NEAR(OX[i], point.x.km, 1e-11) << "ray " << i;
+            EXPECT_NEAR(OY[i], point.y.km, 1e-11) << "ray " << i;
+            EXPECT_NEAR(OZ[i], point.z.km, 1e-11) << "ray " << i;
+        }
+    }
+    EXPECT_GT(Hits, Num / 10);
+
+    // The vertex, on the surface
+    EXPECT_EQ(OX[Num - 4], a);
+    // Zero directions miss
+    DX[0] = DY[0] = DZ[0] = 0.;
+    ASSERT_TRUE(Surfpt(FConstVectorBatch(X, Y, Z), FConstVectorBatch(DX, DY, DZ), a, b, c, FVectorBatch{ OX, OY, OZ }, Found));
+    EXPECT_EQ(Found[0], 0);
+
+    EXPECT_FALSE(Surfpt(FConstVectorBatch(X, Y, Z), FConstVectorBatch(DX, DY, DZ), a, 0., c, FVectorBatch{ OX, OY, OZ }, Found));
+}
+
+
+TEST(ellipsoid_batch_test, Surfnm_Matches_surfnm) {
+
+    USpice::init_all();
+    DECLARE_RAYS
+
+    // Surface points
+    FRandomStream Random(99);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector());
+        X[i] = a * u.X; Y[i] = b * u.Y; Z[i] = c * u.Z;
+    }
+
+    ASSERT_TRUE(Surfnm(a, b, c, FConstVectorBatch(X, Y, Z), FVectorBatch{ OX, OY, OZ }));
+    for (int32 i = 0; i < Num; ++i)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        FSDimensionlessVector normal;
+        USpice::surfnm(ResultCode, ErrorMessage, FSDistance(a), FSDistance(b), FSDistance(c), FSDistanceVector(X[i], Y[i], Z[i]), normal);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        EXPECT_NEAR(OX[i], normal.x, 1e-14);
+        EXPECT_NEAR(OY[i], normal.y, 1e-14);
+        EXPECT_NEAR(OZ[i], normal.z, 1e-14);
+    }
+}
+
+
+TEST(ellipsoid_batch_test, Nearpt_Matches_nearpt) {
+
+    USpice::init_all();
+    DECLARE_RAYS
+
+    ASSERT_TRUE(Nearpt(FConstVectorBatch(X, Y, Z), a, b, c, FVectorBatch{ OX, OY, OZ }, S));
+    for (int32 i = 0; i < Num; ++i)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        FSDistanceVector npoint;
+        FSDistance alt;
+        USpice::nearpt(ResultCode, ErrorMessage, FSDistanceVector(X[i], Y[i], Z[i]), FSDistance(a), FSDistance(b), FSDistance(c), npoint, alt);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        EXPECT_NEAR(S[i], alt.km, 1e-11) << "point " << i;
+        EXPECT_NEAR(OX[i], npoint.x.km, 1e-10) << "point " << i;
+        EXPECT_NEAR(OY[i], npoint.y.km, 1e-10) << "point " << i;
+        EXPECT_NEAR(OZ[i], npoint.z.km, 1e-10) << "point " << i;
+    }
+
+    // Spheres and spheroids sort their axes too
+    ASSERT_TRUE(Nearpt(FConstVectorBatch(X, Y, Z), 2., 2., 2., FVectorBatch{ OX, OY, OZ }, S));
+    EXPECT_NEAR(S[0], FVector3d(X[0], Y[0], Z[0]).Length() - 2., 1e-12);
+}
+
+
+TEST(ellipsoid_batch_test, Npedln_Matches_npedln) {
+
+    USpice::init_all();
+    DECLARE_RAYS
+
+    ASSERT_TRUE(Npedln(a, b, c, FConstVectorBatch(X, Y, Z), FConstVectorBatch(DX, DY, DZ), FVectorBatch{ OX, OY, OZ }, S));
+    for (int32 i = 0; i < Num; ++i)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        FSDistanceVector pnear;
+        FSDistance dist;
+        USpice::npedln(ResultCode, ErrorMessage, FSDistance(a), FSDistance(b), FSDistance(c), FSDistanceVector(X[i], Y[i], Z[i]), FSDimensionlessVector(DX[i], DY[i], DZ[i]), pnear, dist);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        EXPECT_NEAR(S[i], dist.km, 1e-11) << "line " << i;
+        EXPECT_NEAR(OX[i], pnear.x.km, 1e-9) << "line " << i;
+        EXPECT_NEAR(OY[i], pnear.y.km, 1e-9) << "line " << i;
+        EXPECT_NEAR(OZ[i], pnear.z.km, 1e-9) << "line " << i;
+    }
+}
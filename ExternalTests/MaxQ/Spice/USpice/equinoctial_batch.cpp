@@ -0,0 +1,83 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceEquinoctialPropagator.h"
+
+using namespace MaxQ::Orbits;
+
+static FSEquinoctialElements Equinoctial(double a, double h, double k, double l, double p, double q, double dlpdt, double dmldt, double dnodedt)
+{
+    double eqel[9] = { a, h, k, l, p, q, dlpdt, dmldt, dnodedt };
+    return FSEquinoctialElements(eqel);
+}
+
+TEST(equinoctial_batch_test, Matches_eqncpv) {
+
+    USpice::init_all();
+
+    // Earth's pole, near J2000
+    const FSAngle rapol(-1.5707963267948966), decpol(1.5707963267948966 - 1e-4);
+
+    // A GEO belt:  nearly circular, nearly equatorial, slowly drifting
+    FRandomStream Random(1234);
+    TArray<FSEquinoctialElements> Elements;
+    TArray<FSEphemerisTime> Epochs;
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        const double a = Random.FRandRange(42100., 42200.);
+        const double n = sqrt(398600.4418 / (a * a * a));
+        Elements.Add(Equinoctial(
+            a,
+            Random.FRandRange(-1e-3, 1e-3), Random.FRandRange(-1e-3, 1e-3),
+            Random.FRandRange(-3.14, 3.14),
+            Random.FRandRange(-0.05, 0.05), Random.FRandRange(-0.05, 0.05),
+            Random.FRandRange(-1e-9, 1e-9), n, Random.FRandRange(-1e-9, 0.)));
+        Epochs.Add(FSEphemerisTime(Random.FRandRange(-1e6, 1e6)));
+    }
+
+    // ...eccentric ones, where kpsolv bisects more
+    Elements.Add(Equinoctial(26600., 0.5, 0.3, 1.0, 0.4, -0.2, 1e-8, 1.45e-4, -2e-8));
+    Elements.Add(Equinoctial(24000., -0.6, -0.6, -2.0, 0.1, 0.7, 0., 1.7e-4, 0.));
+    Epochs.Add(FSEphemerisTime(0.));
+    Epochs.Add(FSEphemerisTime(5e5));
+
+    // ...and ones eqncpv rejects
+    Elements.Add(Equinoctial(-1., 0., 0., 0., 0., 0., 0., 1e-4, 0.));
+    Elements.Add(Equinoctial(30000., 0.9, 0.1, 0., 0., 0., 0., 1e-4, 0.));
+    Epochs.Add(FSEphemerisTime(0.));
+    Epochs.Add(FSEphemerisTime(0.));
+
+    FEquinoctialBatchPropagator Batch;
+    Batch.Build(Elements, Epochs, rapol, decpol);
+    ASSERT_EQ(Batch.Num(), Elements.Num());
+
+    const int32 NumValid = Elements.Num() - 2;
+    EXPECT_TRUE(Batch.IsValid(NumValid - 1));
+    EXPECT_FALSE(Batch.IsValid(NumValid));
+    EXPECT_FALSE(Batch.IsValid(NumValid + 1));
+
+    TArray<FSStateVector> States;
+    States.SetNum(Elements.Num());
+
+    for (double et : { 0., 3600., -8.6e5, 3.15e7 })
+    {
+        EXPECT_EQ(Batch.Propagate(FSEphemerisTime(et), States), NumValid);
+
+        for (int32 i = 0; i < NumValid; ++i)
+        {
+            FSStateVector expected;
+            USpice::eqncpv(FSEphemerisTime(et), Epochs[i], Elements[i], rapol, decpol, expected);
+
+            EXPECT_TRUE(IsNear(expected, States[i], 1e-7, 1e-10)) << "object " << i << " et " << et;
+        }
+
+        EXPECT_EQ(States[NumValid].r.x.km, 0.);
+        EXPECT_EQ(States[NumValid + 1].v.dz.kmps, 0.);
+    }
+}
@@ -0,0 +1,95 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceErrorBatch.h"
+
+
+TEST(error_batch_test, RecordsPerItem) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    MaxQ::Core::FSpiceErrorBatchSettings Settings;
+    Settings.MaxMessages = 2;
+    Settings.MaxLogged = 1;
+
+    {
+        MaxQ::Core::FSpiceErrorBatch Batch(10, Settings);
+        EXPECT_EQ(MaxQ::Core::FSpiceErrorBatch::Current(), &Batch);
+
+        for (int32 i = 0; i < 10; ++i)
+        {
+            Batch.SetItem(i);
+            if (i % 3 == 0)
+            {
+                USpice::raise_spice_error(TEXT("Odd one out."), TEXT("SPICE(VALUEOUTOFRANGE)"));
+            }
+            USpice::get_implied_result(ResultCode, ErrorMessage);
+
+            // Result codes are exact, whatever happens to the messages
+            EXPECT_EQ(ResultCode, i % 3 == 0 ? ES_ResultCode::Error : ES_ResultCode::Success);
+            if (i % 3 == 0)
+            {
+                EXPECT_GT(ErrorMessage.Len(), 0);
+            }
+        }
+
+        EXPECT_EQ(Batch.NumFailures(), 4);
+        EXPECT_EQ(Batch.NumFailedItems(), 4);
+        EXPECT_TRUE(Batch.Failed(0));
+        EXPECT_FALSE(Batch.Failed(1));
+        EXPECT_TRUE(Batch.Failed(9));
+        EXPECT_FALSE(Batch.Failed(10));
+
+        // Only the first two have long messages
+        ASSERT_EQ(Batch.Messages().Num(), 2);
+        EXPECT_EQ(Batch.Messages()[0].Item, 0);
+        EXPECT_EQ(Batch.Messages()[1].Item, 3);
+        EXPECT_TRUE(Batch.Messages()[0].Message.Contains(TEXT("Odd one out.")));
+
+        // ...after that, it's the short message
+        EXPECT_FALSE(ErrorMessage.Contains(TEXT("Odd one out.")));
+        EXPECT_TRUE(ErrorMessage.Contains(TEXT("VALUEOUTOFRANGE")));
+    }
+
+    EXPECT_EQ(MaxQ::Core::FSpiceErrorBatch::Current(), nullptr);
+
+    // Outside of a batch, errors are reported as usual
+    USpice::raise_spice_error(TEXT("Odd one out."), TEXT("SPICE(VALUEOUTOFRANGE)"));
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_TRUE(ErrorMessage.Contains(TEXT("Odd one out.")));
+}
+
+
+TEST(error_batch_test, Nests) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    MaxQ::Core::FSpiceErrorBatch Outer;
+    {
+        MaxQ::Core::FSpiceErrorBatch Inner;
+        Inner.SetItem(5);
+        USpice::raise_spice_error();
+        USpice::get_implied_result(ResultCode, ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+        // The per-item record grows to fit
+        EXPECT_TRUE(Inner.Failed(5));
+        EXPECT_EQ(Inner.Failures().Num(), 6);
+    }
+
+    EXPECT_EQ(MaxQ::Core::FSpiceErrorBatch::Current(), &Outer);
+    EXPECT_EQ(Outer.NumFailures(), 0);
+}
@@ -0,0 +1,102 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceData.h"
+#include "SpiceTime.h"
+
+using namespace MaxQ::Time;
+
+TEST(et_clock_test, Anchor_Advances_Monotonically) {
+
+    FEtClock Clock;
+    EXPECT_FALSE(Clock.IsAnchored());
+    EXPECT_EQ(Clock.Now(), 0.);
+
+    Clock.Anchor(et0);
+    EXPECT_TRUE(Clock.IsAnchored());
+    EXPECT_TRUE(Clock.HasLeapSeconds());
+
+    double Previous = Clock.Now();
+    EXPECT_GE(Previous, et0);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const double Next = Clock.Now();
+        EXPECT_GE(Next, Previous);
+        Previous = Next;
+    }
+    EXPECT_LT(Previous - et0, 1.);
+}
+
+TEST(et_clock_test, SetRate_DoesNotJump) {
+
+    FEtClock Clock;
+    Clock.Anchor(et0);
+
+    const double Before = Clock.Now();
+    Clock.SetRate(1000.);
+    const double After = Clock.Now();
+    EXPECT_DOUBLE_EQ(Clock.GetRate(), 1000.);
+    EXPECT_GE(After, Before);
+    EXPECT_LT(After - Before, 1.);
+
+    FPlatformProcess::Sleep(0.01f);
+    EXPECT_GT(Clock.Now() - After, 5.);
+
+    Clock.SetRate(-1.);
+    const double Reversed = Clock.Now();
+    FPlatformProcess::Sleep(0.01f);
+    EXPECT_LT(Clock.Now(), Reversed);
+}
+
+TEST(et_clock_test, BeginFrame_Publishes) {
+
+    FEtClock Clock;
+    Clock.Anchor(et0);
+
+    Clock.BeginFrame();
+    const double Frame = Clock.GetFrameEt();
+    EXPECT_EQ(Clock.GetFrameNumber(), 1);
+
+    FPlatformProcess::Sleep(0.01f);
+    EXPECT_EQ(Clock.GetFrameEt(), Frame);
+    EXPECT_GT(Clock.Now(), Frame);
+
+    Clock.BeginFrame();
+    EXPECT_GT(Clock.GetFrameEt(), Frame);
+    EXPECT_EQ(Clock.GetFrameNumber(), 2);
+}
+
+TEST(et_clock_test, AnchorToNow_Matches_str2et) {
+
+    USpice::init_all();
+    USpice::clear_all();
+
+    FEtClock Clock;
+    Clock.AnchorToNow();
+    EXPECT_FALSE(Clock.HasLeapSeconds());
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    ASSERT_TRUE(UpdateTimeSystem());
+
+    // Picks the LSK up at the next frame
+    Clock.BeginFrame();
+    EXPECT_TRUE(Clock.HasLeapSeconds());
+
+    const FDateTime UtcNow = FDateTime::UtcNow();
+    const double et = Clock.Now();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FSEphemerisTime expected;
+    USpice::str2et(ResultCode, ErrorMessage, expected, UtcNow.ToString(TEXT("%Y-%m-%dT%H:%M:%S.%s")));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    EXPECT_NEAR(et, expected.seconds, 0.05);
+    EXPECT_NEAR(MaxQ::Data::Now().seconds, expected.seconds, 0.05);
+}
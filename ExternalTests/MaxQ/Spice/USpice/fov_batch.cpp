@@ -0,0 +1,150 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceFovBatch.h"
+
+using namespace MaxQ::Math;
+
+static const FSDimensionlessVector Z(0., 0., 1.);
+
+static void Grid(TArray<double>& X, TArray<double>& Y, TArray<double>& Zs)
+{
+    for (int32 i = -30; i <= 30; ++i)
+    {
+        for (int32 j = -30; j <= 30; ++j)
+        {
+            X.Add(0.01 * i + 0.001); Y.Add(0.01 * j + 0.001); Zs.Add(1.);
+        }
+    }
+}
+
+
+TEST(fov_batch_test, Circle) {
+
+    FInstrumentFov Fov;
+    const TArray<FSDimensionlessVector> Bounds = { FSDimensionlessVector(0.1, 0., 1.) };
+    ASSERT_TRUE(Fov.Set(TEXT("CIRCLE"), TEXT("INST"), Z, Bounds));
+    EXPECT_TRUE(Fov.Frame() == TEXT("INST"));
+
+    EXPECT_TRUE(Fov.Contains(FSDimensionlessVector(0., 0.0999, 1.)));
+    EXPECT_FALSE(Fov.Contains(FSDimensionlessVector(0., 0.1001, 1.)));
+    EXPECT_FALSE(Fov.Contains(FSDimensionlessVector(0., 0., -1.)));
+    EXPECT_FALSE(Fov.Contains(FSDimensionlessVector(0., 0., 0.)));
+}
+
+
+TEST(fov_batch_test, Ellipse) {
+
+    FInstrumentFov Fov;
+    const TArray<FSDimensionlessVector> Bounds = { FSDimensionlessVector(0.2, 0., 1.), FSDimensionlessVector(0., 0.1, 1.) };
+    ASSERT_TRUE(Fov.Set(TEXT("ELLIPSE"), TEXT("INST"), Z, Bounds));
+
+    TArray<double> X, Y, Zs;
+    Grid(X, Y, Zs);
+    TArray<uint8> Visible;
+    Visible.SetNum(X.Num());
+    Fov.Visible(FConstVectorBatch(X, Y, Zs), Visible);
+
+    for (int32 i = 0; i < X.Num(); ++i)
+    {
+        const double l = FMath::Square(X[i] / 0.2) + FMath::Square(Y[i] / 0.1);
+        EXPECT_EQ(Visible[i] != 0, l <= 1.) << X[i] << ", " << Y[i];
+    }
+}
+
+
+TEST(fov_batch_test, Rectangle_And_Concave_Polygon) {
+
+    FInstrumentFov Rectangle;
+    const TArray<FSDimensionlessVector> Corners = {
+        FSDimensionlessVector(0.2, 0.1, 1.), FSDimensionlessVector(-0.2, 0.1, 1.),
+        FSDimensionlessVector(-0.2, -0.1, 1.), FSDimensionlessVector(0.2, -0.1, 1.)
+    };
+    ASSERT_TRUE(Rectangle.Set(TEXT(" rectangle "), TEXT("INST"), Z, Corners));
+
+    // A notch in the top edge, down to y = 0.05
+    FInstrumentFov Notched;
+    const TArray<FSDimensionlessVector> Notch = {
+        FSDimensionlessVector(0.2, 0.2, 1.), FSDimensionlessVector(0., 0.05, 1.), FSDimensionlessVector(-0.2, 0.2, 1.),
+        FSDimensionlessVector(-0.2, -0.2, 1.), FSDimensionlessVector(0.2, -0.2, 1.)
+    };
+    ASSERT_TRUE(Notched.Set(TEXT("POLYGON"), TEXT("INST"), Z, Notch));
+
+    TArray<double> X, Y, Zs;
+    Grid(X, Y, Zs);
+    TArray<uint8> InRectangle, InNotched;
+    InRectangle.SetNum(X.Num());
+    InNotched.SetNum(X.Num());
+    Rectangle.Visible(FConstVectorBatch(X, Y, Zs), InRectangle);
+    Notched.Visible(FConstVectorBatch(X, Y, Zs), InNotched);
+
+    for (int32 i = 0; i < X.Num(); ++i)
+    {
+        EXPECT_EQ(InRectangle[i] != 0, FMath::Abs(X[i]) < 0.2 && FMath::Abs(Y[i]) < 0.1);
+
+        const bool bInSquare = FMath::Abs(X[i]) < 0.2 && FMath::Abs(Y[i]) < 0.2;
+        const bool bInNotch = Y[i] > 0.05 + 0.75 * FMath::Abs(X[i]);
+        EXPECT_EQ(InNotched[i] != 0, bInSquare && !bInNotch) << X[i] << ", " << Y[i];
+    }
+}
+
+
+TEST(fov_batch_test, Bad_Fovs) {
+
+    FInstrumentFov Fov;
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    const TArray<FSDimensionlessVector> Wide = { FSDimensionlessVector(1., 0., 0.) };
+    EXPECT_FALSE(Fov.Set(TEXT("CIRCLE"), TEXT("INST"), Z, Wide, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+    EXPECT_FALSE(Fov.IsValid());
+
+    const TArray<FSDimensionlessVector> Two = { FSDimensionlessVector(0.1, 0., 1.), FSDimensionlessVector(0., 0.1, 1.) };
+    EXPECT_FALSE(Fov.Set(TEXT("POLYGON"), TEXT("INST"), Z, Two, &ResultCode, &ErrorMessage));
+    EXPECT_FALSE(Fov.Set(TEXT("TRIANGLE"), TEXT("INST"), Z, Two, &ResultCode, &ErrorMessage));
+}
+
+
+TEST(fov_batch_test, Masks_Across_Sensors) {
+
+    FInstrumentFov Fov;
+    const TArray<FSDimensionlessVector> Bounds = { FSDimensionlessVector(0.1, 0., 1.) };
+    ASSERT_TRUE(Fov.Set(TEXT("CIRCLE"), TEXT("INST"), Z, Bounds));
+
+    // Sensor 0 at the origin looking +z, sensor 1 at (0, 0, 10) looking -z
+    // (its +z is the world's -z), sensor 2 at the origin, looking +x
+    const double Flip[3][3] = { { 1., 0., 0. }, { 0., -1., 0. }, { 0., 0., -1. } };
+    const double ToX[3][3] = { { 0., 0., -1. }, { 0., 1., 0. }, { 1., 0., 0. } };
+    TArray<FFovSensor> Sensors;
+    Sensors.Add({ &Fov, FSDistanceVector(0., 0., 0.), FSRotationMatrix() });
+    Sensors.Add({ &Fov, FSDistanceVector(0., 0., 10.), FSRotationMatrix(Flip) });
+    Sensors.Add({ &Fov, FSDistanceVector(0., 0., 0.), FSRotationMatrix(ToX) });
+
+    // On the z axis between them, off the axis, and on the x axis
+    TArray<double> X = { 0., 0.6, 5. }, Y = { 0., 0., 0. }, Zs = { 5., 5., 0. };
+    TArray<uint64> Masks;
+    Masks.SetNum(3);
+    ASSERT_TRUE(FovVisibility(Sensors, FConstVectorBatch(X, Y, Zs), Masks));
+
+    EXPECT_EQ(Masks[0], uint64(0b011));
+    EXPECT_EQ(Masks[1], uint64(0));
+    EXPECT_EQ(Masks[2], uint64(0b100));
+
+    // The per-sensor pass agrees
+    TArray<uint8> Visible;
+    Visible.SetNum(3);
+    Fov.Visible(Sensors[1].Observer, Sensors[1].ToInstrument, FConstVectorBatch(X, Y, Zs), Visible);
+    EXPECT_EQ(Visible[0], 1);
+    EXPECT_EQ(Visible[2], 0);
+
+    Sensors.Add({ nullptr, FSDistanceVector(), FSRotationMatrix() });
+    EXPECT_FALSE(FovVisibility(Sensors, FConstVectorBatch(X, Y, Zs), Masks));
+}
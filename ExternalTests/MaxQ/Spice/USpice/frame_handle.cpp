@@ -0,0 +1,173 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceData.h"
+#include "SpiceFrameHandle.h"
+
+// Two fake TK frames mounted on the fake rotating body, one on the other
+static const char* FrameKernel =
+    "KPL/FK\n"
+    "\\begindata\n"
+    "FRAME_FAKE_SITE_9994        = 1999401\n"
+    "FRAME_1999401_NAME          = 'FAKE_SITE_9994'\n"
+    "FRAME_1999401_CLASS         = 4\n"
+    "FRAME_1999401_CLASS_ID      = 1999401\n"
+    "FRAME_1999401_CENTER        = 9994\n"
+    "TKFRAME_1999401_RELATIVE    = 'IAU_FAKEBODY9994'\n"
+    "TKFRAME_1999401_SPEC        = 'ANGLES'\n"
+    "TKFRAME_1999401_UNITS       = 'DEGREES'\n"
+    "TKFRAME_1999401_AXES        = ( 3, 2, 3 )\n"
+    "TKFRAME_1999401_ANGLES      = ( -30.0, -45.0, 180.0 )\n"
+    "FRAME_FAKE_SENSOR_9994      = 1999402\n"
+    "FRAME_1999402_NAME          = 'FAKE_SENSOR_9994'\n"
+    "FRAME_1999402_CLASS         = 4\n"
+    "FRAME_1999402_CLASS_ID      = 1999402\n"
+    "FRAME_1999402_CENTER        = 9994\n"
+    "TKFRAME_1999402_RELATIVE    = 'FAKE_SITE_9994'\n"
+    "TKFRAME_1999402_SPEC        = 'ANGLES'\n"
+    "TKFRAME_1999402_UNITS       = 'DEGREES'\n"
+    "TKFRAME_1999402_AXES        = ( 1, 2, 3 )\n"
+    "TKFRAME_1999402_ANGLES      = ( 10.0, 20.0, 30.0 )\n"
+    "\\begintext\n";
+
+static void LoadFrameKernel()
+{
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    TArrayView<const uint8> Contents((const uint8*)FrameKernel, FCStringAnsi::Strlen(FrameKernel));
+    ASSERT_TRUE(MaxQ::Data::FurnshBuffer(TEXT("frame_handle_test.tf"), Contents, &ResultCode, &ErrorMessage));
+}
+
+static void ExpectSameAsPxformSxform(const TCHAR* From, const TCHAR* To)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    auto Handle = FSpiceFrameHandle::Compile(From, To, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_TRUE(Handle.IsValid());
+
+    TArray<FSEphemerisTime> Ets;
+    for (int32 i = 0; i < 20; ++i)
+    {
+        Ets.Add(FSEphemerisTime(et0.seconds + i * 1234.5));
+    }
+
+    TArray<FSRotationMatrix> Rotations;
+    Rotations.SetNum(Ets.Num());
+    Handle.Pxform(Ets, Rotations, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    TArray<FSStateTransform> Transforms;
+    Transforms.SetNum(Ets.Num());
+    Handle.Sxform(Ets, Transforms, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    for (int32 i = 0; i < Ets.Num(); ++i)
+    {
+        FSRotationMatrix ExpectedRotation;
+        USpice::pxform(ResultCode, ErrorMessage, ExpectedRotation, Ets[i], From, To);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        FSStateTransform ExpectedTransform;
+        USpice::sxform(ResultCode, ErrorMessage, ExpectedTransform, Ets[i], From, To);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        const double (&r)[3][3] = Rotations[i].AsSpiceDoubleArray();
+        const double (&re)[3][3] = ExpectedRotation.AsSpiceDoubleArray();
+        const double (&x)[6][6] = Transforms[i].AsSpiceDoubleArray();
+        const double (&xe)[6][6] = ExpectedTransform.AsSpiceDoubleArray();
+
+        for (int32 j = 0; j < 3; ++j)
+        {
+            for (int32 k = 0; k < 3; ++k)
+            {
+                EXPECT_NEAR(r[j][k], re[j][k], 1e-12) << TCHAR_TO_ANSI(From) << "->" << TCHAR_TO_ANSI(To) << " epoch " << i;
+            }
+        }
+        for (int32 j = 0; j < 6; ++j)
+        {
+            for (int32 k = 0; k < 6; ++k)
+            {
+                EXPECT_NEAR(x[j][k], xe[j][k], 1e-12) << TCHAR_TO_ANSI(From) << "->" << TCHAR_TO_ANSI(To) << " epoch " << i;
+            }
+        }
+    }
+}
+
+TEST(frame_handle_test, Matches_pxform_sxform) {
+
+    LoadFrameKernel();
+
+    ExpectSameAsPxformSxform(TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    ExpectSameAsPxformSxform(TEXT("IAU_FAKEBODY9994"), TEXT("ECLIPJ2000"));
+    ExpectSameAsPxformSxform(TEXT("FAKE_SENSOR_9994"), TEXT("J2000"));
+    ExpectSameAsPxformSxform(TEXT("GALACTIC"), TEXT("FAKE_SITE_9994"));
+    ExpectSameAsPxformSxform(TEXT("FAKE_SENSOR_9994"), TEXT("IAU_FAKEBODY9995"));
+}
+
+TEST(frame_handle_test, Constant_Chains) {
+
+    LoadFrameKernel();
+
+    auto Inertial = FSpiceFrameHandle::Compile(TEXT("ECLIPJ2000"), TEXT("GALACTIC"));
+    ASSERT_TRUE(Inertial.IsValid());
+    EXPECT_TRUE(Inertial.IsConstant());
+    ExpectSameAsPxformSxform(TEXT("ECLIPJ2000"), TEXT("GALACTIC"));
+
+    // Both mounted on the rotating body, which never has to be evaluated
+    auto Mounted = FSpiceFrameHandle::Compile(TEXT("FAKE_SENSOR_9994"), TEXT("IAU_FAKEBODY9994"));
+    ASSERT_TRUE(Mounted.IsValid());
+    EXPECT_TRUE(Mounted.IsConstant());
+    ExpectSameAsPxformSxform(TEXT("FAKE_SENSOR_9994"), TEXT("IAU_FAKEBODY9994"));
+    ExpectSameAsPxformSxform(TEXT("FAKE_SITE_9994"), TEXT("FAKE_SENSOR_9994"));
+
+    auto Rotating = FSpiceFrameHandle::Compile(TEXT("FAKE_SENSOR_9994"), TEXT("J2000"));
+    ASSERT_TRUE(Rotating.IsValid());
+    EXPECT_FALSE(Rotating.IsConstant());
+    EXPECT_EQ(Rotating.NumVaryingLinks(), 1);
+}
+
+TEST(frame_handle_test, UnknownFrame_IsInvalid) {
+
+    LoadFrameKernel();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    auto Handle = FSpiceFrameHandle::Compile(TEXT("J2000"), TEXT("NOT_A_FRAME"), &ResultCode, &ErrorMessage);
+    EXPECT_FALSE(Handle.IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    FSRotationMatrix rotate;
+    Handle.Pxform(et0, rotate, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+TEST(frame_handle_test, FollowsPool) {
+
+    LoadFrameKernel();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    auto Handle = FSpiceFrameHandle::Compile(TEXT("FAKE_SENSOR_9994"), TEXT("J2000"), &ResultCode, &ErrorMessage);
+    ASSERT_TRUE(Handle.IsValid());
+
+    EXPECT_TRUE(MaxQ::Data::UnloadBuffer(TEXT("frame_handle_test.tf"), &ResultCode, &ErrorMessage));
+
+    FSRotationMatrix rotate;
+    Handle.Pxform(et0, rotate, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(Handle.IsValid());
+}
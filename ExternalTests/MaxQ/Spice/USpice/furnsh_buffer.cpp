@@ -0,0 +1,45 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceData.h"
+
+
+TEST(furnsh_buffer_test, Loads_And_Unloads) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    const char* Kernel =
+        "KPL/PCK\n"
+        "\\begindata\n"
+        "BODY9994_MAXQ_BUFFER_TEST = ( 7.5 )\n"
+        "\\begintext\n";
+    TArrayView<const uint8> Contents((const uint8*)Kernel, FCStringAnsi::Strlen(Kernel));
+
+    EXPECT_TRUE(MaxQ::Data::FurnshBuffer(TEXT("buffer_test.tpc"), Contents, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    double Value = MaxQ::Data::Gdpool(TEXT("BODY9994_MAXQ_BUFFER_TEST"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(Value, 7.5);
+
+    // The same contents reuse the same file
+    EXPECT_TRUE(MaxQ::Data::FurnshBuffer(TEXT("buffer_test.tpc"), Contents, &ResultCode, &ErrorMessage));
+
+    EXPECT_TRUE(MaxQ::Data::UnloadBuffer(TEXT("buffer_test.tpc"), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    MaxQ::Data::Gdpool(TEXT("BODY9994_MAXQ_BUFFER_TEST"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    EXPECT_FALSE(MaxQ::Data::UnloadBuffer(TEXT("buffer_test.tpc"), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
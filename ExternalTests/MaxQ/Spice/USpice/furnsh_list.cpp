@@ -6,6 +6,10 @@
 // GitHub:         https://github.com/Gamergenic1/MaxQ/ 
 
 #include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCore.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 
 
 TEST(furnsh_list_test, DefaultsTestCase) {
@@ -21,3 +25,72 @@ TEST(furnsh_list_test, DefaultsTestCase) {
     EXPECT_EQ(ErrorMessage.Len(), 0);
 }
 
+
+TEST(furnsh_list_test, Loads_In_Order) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<FString> Kernels {
+        FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_lsk.tls")),
+        FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_pck.tpc")),
+        FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_fk.tf")),
+        FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"))
+    };
+
+    USpice::furnsh_list(ResultCode, ErrorMessage, Kernels);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+
+    int count = 0;
+    USpice::ktotal(count, (int32)ES_KernelType::TEXT);
+    EXPECT_EQ(count, 3);
+    USpice::ktotal(count, (int32)ES_KernelType::SPK);
+    EXPECT_EQ(count, 1);
+
+    FSDistanceVector r;
+    FSEphemerisPeriod lt;
+    USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(furnsh_list_test, Skips_Bad_Kernels) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    const FString BadKernel = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_bad.tpc"));
+    FFileHelper::SaveStringToFile(TEXT("KPL/PCK\n\\begindata\nBODY399_RADII = ( 6378.1366 6378.1366\n"), *BadKernel);
+
+    TArray<FString> Kernels {
+        FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_lsk.tls")),
+        BadKernel,
+        FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_does_not_exist.bsp")),
+        FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"))
+    };
+
+    // Reported, but the rest are still loaded (and the pool isn't touched)
+    USpice::furnsh_list(ResultCode, ErrorMessage, Kernels);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    int count = 0;
+    USpice::ktotal(count, (int32)ES_KernelType::TEXT);
+    EXPECT_EQ(count, 1);
+    USpice::ktotal(count, (int32)ES_KernelType::SPK);
+    EXPECT_EQ(count, 1);
+
+    double Dvalue = 0.;
+    bool bFound = true;
+    USpice::gdpool_scalar(ResultCode, ErrorMessage, Dvalue, bFound, FString(TEXT("BODY399_RADII")));
+    EXPECT_FALSE(bFound);
+
+    MaxQ::Core::ClearAll();
+}
@@ -0,0 +1,93 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGeometryFinder.h"
+
+using namespace MaxQ::GeometryFinder;
+
+static TArray<FSEphemerisTimeWindowSegment> Days(int First, int Last)
+{
+    return { FSEphemerisTimeWindowSegment(et0 + First * FSEphemerisPeriod::Day, et0 + Last * FSEphemerisPeriod::Day) };
+}
+
+
+TEST(gf_incremental_search_test, Extending_Matches_Full_Search) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    // Half way between the range's extremes, so intervals cross day boundaries
+    FSDistanceVector r;
+    FSEphemerisPeriod lt;
+    USpice::spkpos(ResultCode, ErrorMessage, et0 + 2 * FSEphemerisPeriod::Day, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("J2000"));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    const FSDistance refval = r.Magnitude();
+
+    for (ES_RelationalOperator relate : { ES_RelationalOperator::GreaterThan, ES_RelationalOperator::LOCMAX, ES_RelationalOperator::ABSMAX })
+    {
+        TArray<FSEphemerisTimeWindowSegment> Expected;
+        USpice::gfdist(ResultCode, ErrorMessage, Expected, Days(0, 4), FSEphemerisPeriod::Hour, refval, FSDistance(0.),
+            TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), relate);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+        ASSERT_GT(Expected.Num(), 0);
+
+        FGfIncrementalSearch Search = FGfIncrementalSearch::Gfdist(FSEphemerisPeriod::Hour, refval, FSDistance(0.),
+            TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), relate);
+
+        for (int Day = 1; Day <= 4; ++Day)
+        {
+            EXPECT_TRUE(Search.Extend(Days(0, Day), &ResultCode, &ErrorMessage));
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+            // A day and two steps, at most (unless it's all searched again)
+            if (relate != ES_RelationalOperator::ABSMAX)
+            {
+                EXPECT_LE(Search.LastSearchedSeconds(), FSEphemerisPeriod::Day.AsSeconds() + 2 * FSEphemerisPeriod::Hour.AsSeconds());
+            }
+        }
+
+        // Nothing new
+        EXPECT_TRUE(Search.Extend(Days(1, 3)));
+        EXPECT_EQ(Search.LastSearchedSeconds(), 0.);
+
+        TArray<FSEphemerisTimeWindowSegment> results = Search.ToSegments();
+        ASSERT_EQ(results.Num(), Expected.Num());
+        for (int i = 0; i < results.Num(); ++i)
+        {
+            EXPECT_NEAR(results[i].start.seconds, Expected[i].start.seconds, 1.e-3);
+            EXPECT_NEAR(results[i].stop.seconds, Expected[i].stop.seconds, 1.e-3);
+        }
+    }
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(gf_incremental_search_test, Failure_Changes_Nothing) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    FGfIncrementalSearch Search = FGfIncrementalSearch::Gfdist(FSEphemerisPeriod::Hour, FSDistance(0.), FSDistance(0.),
+        TEXT("NOT_A_BODY"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_RelationalOperator::LOCMAX);
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    EXPECT_FALSE(Search.Extend(Days(0, 1), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_TRUE(Search.GetCoverage().IsEmpty());
+
+    MaxQ::Core::ClearAll();
+}
@@ -0,0 +1,91 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGeometryFinder.h"
+
+using namespace MaxQ::GeometryFinder;
+
+// No DSK ships with the unit test kernels, so the ellipsoid's bound stands in
+// for one.
+
+TEST(gf_occultation_prefilter_test, Bounding_Radii) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    double Radius = -1.;
+    EXPECT_TRUE(BoundingRadius(Radius, TEXT("FAKEBODY9994"), ES_GeometricModel::ELLIPSOID, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_DOUBLE_EQ(Radius, 123.45);
+
+    EXPECT_TRUE(BoundingRadius(Radius, TEXT("FAKEBODY9993"), ES_GeometricModel::POINT));
+    EXPECT_DOUBLE_EQ(Radius, 0.);
+
+    // No DSK is loaded
+    EXPECT_FALSE(BoundingRadius(Radius, TEXT("FAKEBODY9994"), ES_GeometricModel::DSK, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_TRUE(ErrorMessage.Contains(TEXT("NODSKSEGMENTS")));
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(gf_occultation_prefilter_test, Matches_Unfiltered_Search) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+    const FSEphemerisPeriod step(600.);
+
+    TArray<FSEphemerisTimeWindowSegment> Expected;
+    USpice::gfoclt(ResultCode, ErrorMessage, Expected, cnfine, step, {}, {}, ES_OccultationType::ANY,
+        TEXT("FAKEBODY9993"), ES_GeometricModel::POINT, FString(), TEXT("FAKEBODY9994"), ES_GeometricModel::ELLIPSOID, TEXT("IAU_FAKEBODY9994"),
+        ES_AberrationCorrectionForOccultation::None, TEXT("FAKEBODY9995"));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    TArray<FSEphemerisTimeWindowSegment> Found;
+    FGfOccultationPrefilterStats Stats;
+    EXPECT_TRUE(GfocltPrefiltered(Found, cnfine, step, {}, {}, ES_OccultationType::ANY,
+        TEXT("FAKEBODY9993"), ES_GeometricModel::POINT, FString(), TEXT("FAKEBODY9994"), ES_GeometricModel::ELLIPSOID, TEXT("IAU_FAKEBODY9994"),
+        ES_AberrationCorrectionForOccultation::None, TEXT("FAKEBODY9995"), FGfOccultationPrefilter(), &Stats, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    EXPECT_DOUBLE_EQ(Stats.BackRadius, 123.45);
+    EXPECT_GT(Stats.Samples, 0);
+    EXPECT_DOUBLE_EQ(Stats.WindowSeconds, 4 * 86400.);
+    EXPECT_LE(Stats.CandidateSeconds, Stats.WindowSeconds);
+
+    ASSERT_EQ(Found.Num(), Expected.Num());
+    for (int i = 0; i < Expected.Num(); ++i)
+    {
+        EXPECT_NEAR(Found[i].start.seconds, Expected[i].start.seconds, 1.e-3);
+        EXPECT_NEAR(Found[i].stop.seconds, Expected[i].stop.seconds, 1.e-3);
+    }
+
+    // Every occultation is inside the candidates
+    TArray<FSEphemerisTimeWindowSegment> Candidates;
+    EXPECT_TRUE(OccultationCandidates(Candidates, cnfine, step, TEXT("FAKEBODY9993"), ES_GeometricModel::POINT, TEXT("FAKEBODY9994"), ES_GeometricModel::ELLIPSOID,
+        ES_AberrationCorrectionForOccultation::None, TEXT("FAKEBODY9995")));
+    const FSWindow CandidateWindow(Candidates);
+    for (const FSEphemerisTimeWindowSegment& Segment : Expected)
+    {
+        EXPECT_TRUE(CandidateWindow.Contains(Segment.start.seconds, Segment.stop.seconds));
+    }
+
+    MaxQ::Core::ClearAll();
+}
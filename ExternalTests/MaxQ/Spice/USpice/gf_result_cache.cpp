@@ -0,0 +1,107 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGeometryFinder.h"
+#include "SpiceGfResultCache.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+using namespace MaxQ::GeometryFinder;
+
+static void Search(ES_ResultCode& ResultCode, FString& ErrorMessage, TArray<FSEphemerisTimeWindowSegment>& results, double refval = 0.)
+{
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+
+    GfdistCached(results, cnfine, FSEphemerisPeriod::Hour, FSDistance(refval), FSDistance(0.),
+        TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_RelationalOperator::LOCMAX, 1, &ResultCode, &ErrorMessage);
+}
+
+
+TEST(gf_result_cache_test, Repeat_Is_A_Hit) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FGfResultCache& Cache = FGfResultCache::Get();
+    const FGfResultCacheStats Before = Cache.GetStats();
+
+    TArray<FSEphemerisTimeWindowSegment> First;
+    Search(ResultCode, ErrorMessage, First);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_GT(First.Num(), 0);
+    EXPECT_EQ(Cache.GetStats().Misses, Before.Misses + 1);
+
+    TArray<FSEphemerisTimeWindowSegment> Second;
+    Search(ResultCode, ErrorMessage, Second);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Cache.GetStats().Hits, Before.Hits + 1);
+
+    ASSERT_EQ(Second.Num(), First.Num());
+    for (int i = 0; i < First.Num(); ++i)
+    {
+        EXPECT_EQ(Second[i].start.seconds, First[i].start.seconds);
+        EXPECT_EQ(Second[i].stop.seconds, First[i].stop.seconds);
+    }
+
+    // Any other parameter is another search
+    TArray<FSEphemerisTimeWindowSegment> Other;
+    Search(ResultCode, ErrorMessage, Other, 1.);
+    EXPECT_EQ(Cache.GetStats().Misses, Before.Misses + 2);
+
+    // ...as is the same one, once the kernels change
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    Search(ResultCode, ErrorMessage, Second);
+    EXPECT_EQ(Cache.GetStats().Misses, Before.Misses + 3);
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(gf_result_cache_test, Disk_Outlasts_Memory) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    const FString Directory = FPaths::Combine(FPlatformProcess::UserTempDir(), TEXT("MaxQGfResultCacheTest"));
+    FGfResultCache& Cache = FGfResultCache::Get();
+    Cache.SetDirectory(Directory);
+    Cache.Invalidate();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<FSEphemerisTimeWindowSegment> First;
+    Search(ResultCode, ErrorMessage, First);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // Reloading the same kernels drops what's in memory, but not the files
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    const FGfResultCacheStats Before = Cache.GetStats();
+    TArray<FSEphemerisTimeWindowSegment> Second;
+    Search(ResultCode, ErrorMessage, Second);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Cache.GetStats().DiskHits, Before.DiskHits + 1);
+    EXPECT_EQ(Second.Num(), First.Num());
+
+    Cache.Invalidate();
+    TArray<FString> Files;
+    IFileManager::Get().FindFiles(Files, *FPaths::Combine(Directory, TEXT("*.gfr")), true, false);
+    EXPECT_EQ(Files.Num(), 0);
+
+    Cache.SetDirectory(FString());
+    MaxQ::Core::ClearAll();
+}
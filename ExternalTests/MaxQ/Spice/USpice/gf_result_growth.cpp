@@ -0,0 +1,127 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGeometryFinder.h"
+
+using namespace MaxQ::GeometryFinder;
+
+// On for the first 50s of every 100s
+static bool Square(double et)
+{
+    return FMath::Fmod(et, 100.) < 50.;
+}
+
+
+TEST(gf_result_growth_test, Result_Grows_Past_Default) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    // 100 intervals fit the first time, the rest need the result to grow.
+    // The second search (fewer) reuses what the first grew to.
+    for (int Intervals : { 500, 300, 1000 })
+    {
+        TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(0., 100. * Intervals - 1.) };
+
+        TArray<FSEphemerisTimeWindowSegment> results;
+        EXPECT_TRUE(GfUserCondition(results, cnfine, FSEphemerisPeriod(10.), Square, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        ASSERT_EQ(results.Num(), Intervals);
+        for (int i = 0; i < results.Num(); ++i)
+        {
+            EXPECT_NEAR(results[i].start.seconds, 100. * i, 1.e-3);
+            EXPECT_NEAR(results[i].stop.seconds, 100. * i + 50., 1.e-3);
+        }
+    }
+}
+
+
+TEST(gf_result_growth_test, Workspace_Overflow_Is_An_Error) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+
+    TArray<FSEphemerisTimeWindowSegment> Expected;
+    USpice::gfposc(ResultCode, ErrorMessage, Expected, FSEphemerisPeriod::Hour, cnfine, TEXT("FAKEBODY9994"), TEXT("J2000"),
+        ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_CoordinateSystemInclRadec::LATITUDINAL, ES_CoordinateName::RADIUS, ES_RelationalOperator::LOCMAX);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_GT(Expected.Num(), 0);
+
+    // The rising and falling pieces around a maximum don't fit one interval
+    // of workspace.  The result isn't full, so that's reported, not retried.
+    TArray<FSEphemerisTimeWindowSegment> results{ FSEphemerisTimeWindowSegment(0., 1.) };
+    USpice::gfposc(ResultCode, ErrorMessage, results, FSEphemerisPeriod::Hour, cnfine, TEXT("FAKEBODY9994"), TEXT("J2000"),
+        ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_CoordinateSystemInclRadec::LATITUDINAL, ES_CoordinateName::RADIUS, ES_RelationalOperator::LOCMAX,
+        0., 0., 1);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+    EXPECT_EQ(results.Num(), 0);
+
+    // ...and nothing is left signalled
+    USpice::gfposc(ResultCode, ErrorMessage, results, FSEphemerisPeriod::Hour, cnfine, TEXT("FAKEBODY9994"), TEXT("J2000"),
+        ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_CoordinateSystemInclRadec::LATITUDINAL, ES_CoordinateName::RADIUS, ES_RelationalOperator::LOCMAX);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_EQ(results.Num(), Expected.Num());
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(gf_result_growth_test, Nested_Search_Is_Rejected) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    bool bNestedRan = false;
+    bool bNestedSucceeded = true;
+    ES_ResultCode NestedResultCode = ES_ResultCode::Success;
+    FString NestedErrorMessage;
+    TArray<FSEphemerisTimeWindowSegment> Nested{ FSEphemerisTimeWindowSegment(0., 1.) };
+
+    auto Condition = [&](double et)
+    {
+        if (!bNestedRan)
+        {
+            bNestedRan = true;
+            TArray<FSEphemerisTimeWindowSegment> NestedWindow{ FSEphemerisTimeWindowSegment(0., 1000.) };
+            bNestedSucceeded = GfUserCondition(Nested, NestedWindow, FSEphemerisPeriod(10.), Square, &NestedResultCode, &NestedErrorMessage);
+        }
+        return Square(et);
+    };
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(0., 19999.) };
+    TArray<FSEphemerisTimeWindowSegment> results;
+    EXPECT_TRUE(GfUserCondition(results, cnfine, FSEphemerisPeriod(10.), Condition, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    EXPECT_TRUE(bNestedRan);
+    EXPECT_FALSE(bNestedSucceeded);
+    EXPECT_EQ(NestedResultCode, ES_ResultCode::Error);
+    EXPECT_TRUE(NestedErrorMessage.Contains(TEXT("NESTEDGFSEARCH")) || NestedErrorMessage.Contains(TEXT("re-entrant"))) << TCHAR_TO_ANSI(*NestedErrorMessage);
+    EXPECT_EQ(Nested.Num(), 0);
+
+    // The outer search is untouched
+    ASSERT_EQ(results.Num(), 200);
+    for (int i = 0; i < results.Num(); ++i)
+    {
+        EXPECT_NEAR(results[i].start.seconds, 100. * i, 1.e-3);
+        EXPECT_NEAR(results[i].stop.seconds, 100. * i + 50., 1.e-3);
+    }
+}
@@ -0,0 +1,96 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGeometryFinder.h"
+
+using namespace MaxQ::GeometryFinder;
+
+static void Search(ES_ResultCode& ResultCode, FString& ErrorMessage, TArray<FSEphemerisTimeWindowSegment>& results)
+{
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+
+    USpice::gfdist(ResultCode, ErrorMessage, results, cnfine, FSEphemerisPeriod::Hour, FSDistance(0.), FSDistance(0.),
+        TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_RelationalOperator::LOCMAX);
+}
+
+
+TEST(gf_search_control_test, Controlled_Matches_Uncontrolled) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<FSEphemerisTimeWindowSegment> Expected;
+    Search(ResultCode, ErrorMessage, Expected);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    TArray<float> Reports;
+    FGfCancellationToken Token;
+    FGfSearchControl Control;
+    Control.ShouldCancel = Token.AsPredicate();
+    Control.OnProgress = [&Reports](float Fraction) { Reports.Add(Fraction); };
+
+    TArray<FSEphemerisTimeWindowSegment> results;
+    {
+        FGfSearchControlScope Scope(Control);
+        EXPECT_EQ(FGfSearchControlScope::Current(), &Control);
+        Search(ResultCode, ErrorMessage, results);
+    }
+    EXPECT_EQ(FGfSearchControlScope::Current(), nullptr);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    ASSERT_EQ(results.Num(), Expected.Num());
+    for (int i = 0; i < results.Num(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(results[i].start.seconds, Expected[i].start.seconds);
+        EXPECT_DOUBLE_EQ(results[i].stop.seconds, Expected[i].stop.seconds);
+    }
+
+    ASSERT_GT(Reports.Num(), 1);
+    for (int i = 1; i < Reports.Num(); ++i)
+    {
+        EXPECT_GT(Reports[i], Reports[i - 1]);
+    }
+    EXPECT_FLOAT_EQ(Reports.Last(), 1.f);
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(gf_search_control_test, Cancel_Stops_Search) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    // Cancelled by the first report
+    FGfCancellationToken Token;
+    FGfSearchControl Control;
+    Control.ShouldCancel = Token.AsPredicate();
+    Control.OnProgress = [Token](float Fraction) mutable { Token.Cancel(); };
+
+    TArray<FSEphemerisTimeWindowSegment> results;
+    {
+        FGfSearchControlScope Scope(Control);
+        Search(ResultCode, ErrorMessage, results);
+    }
+
+    EXPECT_TRUE(Token.IsCancelled());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_TRUE(ErrorMessage.Contains(TEXT("cancelled")));
+    EXPECT_EQ(results.Num(), 0);
+
+    MaxQ::Core::ClearAll();
+}
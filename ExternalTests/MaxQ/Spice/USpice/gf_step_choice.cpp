@@ -0,0 +1,87 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGeometryFinder.h"
+
+using namespace MaxQ::GeometryFinder;
+
+TEST(gf_step_choice_test, Step_Follows_Time_Scale) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+
+    FGfStepChoice Event, Extremum;
+    EXPECT_TRUE(ChooseGfStep(Event, cnfine, { TEXT("FAKEBODY9994") }, TEXT("FAKEBODY9995"), FString(), ES_RelationalOperator::GreaterThan, FGfStepSettings(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_TRUE(ChooseGfStep(Extremum, cnfine, { TEXT("FAKEBODY9994") }, TEXT("FAKEBODY9995"), FString(), ES_RelationalOperator::LOCMAX));
+
+    EXPECT_GT(Event.Step.seconds, 0.);
+    EXPECT_LE(Event.Step.seconds, Event.TimeScale.seconds / 20. + 1.e-6);
+    EXPECT_GT(Event.Basis.Len(), 0);
+    EXPECT_DOUBLE_EQ(Extremum.TimeScale.seconds, Event.TimeScale.seconds);
+    EXPECT_LT(Extremum.Step.seconds, Event.Step.seconds);
+
+    // Refining only ever shortens it
+    FGfStepSettings Settings;
+    Settings.MaxRefinements = 4;
+    FGfStepChoice Refined;
+    EXPECT_TRUE(ChooseGfStep(Refined, cnfine, { TEXT("FAKEBODY9994") }, TEXT("FAKEBODY9995"), FString(), ES_RelationalOperator::GreaterThan, Settings));
+    EXPECT_LE(Refined.Step.seconds, Event.Step.seconds);
+    EXPECT_LE(Refined.Refinements, 4);
+
+    // A body-fixed frame's rotation is a time scale, too
+    FGfStepChoice Framed;
+    EXPECT_TRUE(ChooseGfStep(Framed, cnfine, { TEXT("FAKEBODY9994") }, TEXT("FAKEBODY9995"), TEXT("IAU_FAKEBODY9994"), ES_RelationalOperator::GreaterThan, FGfStepSettings(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_LE(Framed.TimeScale.seconds, Event.TimeScale.seconds);
+
+    // Nothing to go on
+    FGfStepChoice Unknown;
+    EXPECT_FALSE(ChooseGfStep(Unknown, cnfine, { TEXT("NOT_A_BODY") }, TEXT("FAKEBODY9995"), FString(), ES_RelationalOperator::GreaterThan, FGfStepSettings(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(gf_step_choice_test, Zero_Step_Is_Chosen) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+
+    TArray<FSEphemerisTimeWindowSegment> Expected;
+    USpice::gfdist(ResultCode, ErrorMessage, Expected, cnfine, FSEphemerisPeriod::Hour, FSDistance(0.), FSDistance(0.),
+        TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_RelationalOperator::LOCMAX);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    TArray<FSEphemerisTimeWindowSegment> results;
+    GfdistParallel(results, cnfine, FSEphemerisPeriod::Zero, FSDistance(0.), FSDistance(0.),
+        TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_RelationalOperator::LOCMAX, 1, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    ASSERT_EQ(results.Num(), Expected.Num());
+    for (int i = 0; i < results.Num(); ++i)
+    {
+        EXPECT_NEAR(results[i].start.seconds, Expected[i].start.seconds, 1.e-3);
+    }
+
+    MaxQ::Core::ClearAll();
+}
@@ -0,0 +1,128 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceEphemerisCache.h"
+#include "SpiceGeometryFinder.h"
+
+using namespace MaxQ::GeometryFinder;
+
+static bool BuildCache(MaxQ::Ephemeris::FChebyshevCache& Cache)
+{
+    MaxQ::Ephemeris::FChebyshevCacheSettings Settings;
+    Settings.ToleranceKm = 0.01;
+    Settings.MaxBlockSeconds = FSEphemerisPeriod::Day.AsSeconds();
+
+    return Cache.Build({ TEXT("FAKEBODY9994") }, TEXT("FAKEBODY9995"), TEXT("J2000"), et0, et0 + 4 * FSEphemerisPeriod::Day, Settings);
+}
+
+
+TEST(gf_user_search_test, CachedDistance_Matches_gfdist) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    MaxQ::Ephemeris::FChebyshevCache Cache;
+    ASSERT_TRUE(BuildCache(Cache));
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+
+    TArray<FSEphemerisTimeWindowSegment> Expected;
+    USpice::gfdist(ResultCode, ErrorMessage, Expected, cnfine, FSEphemerisPeriod::Hour, FSDistance(0.), FSDistance(0.),
+        TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), ES_RelationalOperator::LOCMAX);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_GT(Expected.Num(), 0);
+
+    // With the analytic derivative, and with uddc_c's
+    FGfUserScalar Distance = CachedDistance(Cache, 0);
+    FGfUserScalar Differenced = Distance;
+    Differenced.Derivative = nullptr;
+
+    for (const FGfUserScalar& Quantity : { Distance, Differenced })
+    {
+        TArray<FSEphemerisTimeWindowSegment> results;
+        EXPECT_TRUE(GfUserScalar(results, cnfine, FSEphemerisPeriod::Hour, Quantity, ES_RelationalOperator::LOCMAX, 0., 0., &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        ASSERT_EQ(results.Num(), Expected.Num());
+        for (int i = 0; i < results.Num(); ++i)
+        {
+            EXPECT_NEAR(results[i].start.seconds, Expected[i].start.seconds, 60.);
+        }
+    }
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(gf_user_search_test, Condition_Matches_Scalar) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    MaxQ::Ephemeris::FChebyshevCache Cache;
+    ASSERT_TRUE(BuildCache(Cache));
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+    FGfUserScalar RangeRate = CachedRangeRate(Cache, 0);
+
+    // Approaching
+    TArray<FSEphemerisTimeWindowSegment> Expected;
+    ASSERT_TRUE(GfUserScalar(Expected, cnfine, FSEphemerisPeriod::Hour, RangeRate, ES_RelationalOperator::LessThan, 0.));
+    ASSERT_GT(Expected.Num(), 0);
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    TArray<FSEphemerisTimeWindowSegment> results;
+    EXPECT_TRUE(GfUserCondition(results, cnfine, FSEphemerisPeriod::Hour, [&RangeRate](double et) { return RangeRate.Value(et) < 0.; }, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    ASSERT_EQ(results.Num(), Expected.Num());
+    for (int i = 0; i < results.Num(); ++i)
+    {
+        EXPECT_NEAR(results[i].start.seconds, Expected[i].start.seconds, 1.);
+        EXPECT_NEAR(results[i].stop.seconds, Expected[i].stop.seconds, 1.);
+    }
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(gf_user_search_test, Outside_Cache_Fails) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    MaxQ::Ephemeris::FChebyshevCache Cache;
+    ASSERT_TRUE(BuildCache(Cache));
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 5 * FSEphemerisPeriod::Day) };
+    TArray<FSEphemerisTimeWindowSegment> results;
+    EXPECT_FALSE(GfUserScalar(results, cnfine, FSEphemerisPeriod::Hour, CachedDistance(Cache, 0), ES_RelationalOperator::LOCMAX, 0., 0., &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_EQ(results.Num(), 0);
+
+    // ... and the error is reported, not left behind
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FGfUserScalar Empty;
+    EXPECT_FALSE(GfUserScalar(results, cnfine, FSEphemerisPeriod::Hour, Empty, ES_RelationalOperator::LOCMAX, 0., 0., &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    MaxQ::Core::ClearAll();
+}
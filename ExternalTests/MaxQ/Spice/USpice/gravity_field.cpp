@@ -0,0 +1,216 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGravityField.h"
+
+using namespace MaxQ::Orbits;
+using namespace MaxQ::Math;
+
+static const double gm_earth = 398600.4418;
+static const double r_earth = 6378.137;
+static const double J2 = 1.08262668e-3;
+
+// A made up field, with EGM-like magnitudes
+static void RandomField(int32 degree, FGravityField& Field)
+{
+    FRandomStream Random(1234);
+    TArray<double> C, S;
+    C.SetNumZeroed(FGravityField::NumCoefficients(degree));
+    S.SetNumZeroed(FGravityField::NumCoefficients(degree));
+    C[0] = 1.;
+    for (int32 n = 2; n <= degree; ++n)
+    {
+        for (int32 m = 0; m <= n; ++m)
+        {
+            C[FGravityField::Index(n, m)] = Random.FRandRange(-1e-6, 1e-6) / n;
+            S[FGravityField::Index(n, m)] = m == 0 ? 0. : Random.FRandRange(-1e-6, 1e-6) / n;
+        }
+    }
+    C[FGravityField::Index(2, 0)] = -J2 / sqrt(5.);
+    Field.Build(gm_earth, r_earth, degree, C, S);
+}
+
+TEST(gravity_field_test, J2_Matches_Zonal) {
+
+    TArray<double> C, S;
+    C.SetNumZeroed(FGravityField::NumCoefficients(2));
+    S.SetNumZeroed(FGravityField::NumCoefficients(2));
+    C[0] = 1.;
+    C[FGravityField::Index(2, 0)] = -J2 / sqrt(5.);
+
+    FGravityField Field;
+    Field.Build(gm_earth, r_earth, 2, C, S);
+
+    const double Js[] = { J2 };
+    FZonalGravityForce Zonal(gm_earth, r_earth, Js);
+
+    for (const FVector3d& p : { FVector3d(7000., 0., 0.), FVector3d(3000., -4000., 5000.), FVector3d(0., 0., -6900.) })
+    {
+        const double r[3] = { p.X, p.Y, p.Z };
+        const double state[6] = { p.X, p.Y, p.Z, 0., 0., 0. };
+
+        double a[3], expected[3] = { 0., 0., 0. };
+        ASSERT_TRUE(Field.Acceleration(r, a, 2));
+        ASSERT_TRUE(Zonal.AddAcceleration(0, 0., state, expected));
+        for (int32 j = 0; j < 3; ++j)
+        {
+            EXPECT_NEAR(a[j], expected[j], 1e-17);
+        }
+
+        // ...and with the point mass
+        ASSERT_TRUE(Field.Acceleration(r, a));
+        const double r3 = pow(p.Length(), 3.);
+        for (int32 j = 0; j < 3; ++j)
+        {
+            EXPECT_NEAR(a[j], expected[j] - gm_earth * r[j] / r3, 1e-15);
+        }
+    }
+
+    const double origin[3] = { 0., 0., 0. };
+    double a[3];
+    EXPECT_FALSE(Field.Acceleration(origin, a));
+}
+
+TEST(gravity_field_test, Acceleration_Is_Potential_Gradient) {
+
+    FGravityField Field;
+    RandomField(40, Field);
+
+    FRandomStream Random(42);
+    for (int32 i = 0; i < 20; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector());
+        const double r[3] = { 6800. * u.X, 6800. * u.Y, 6800. * u.Z };
+
+        double a[3];
+        ASSERT_TRUE(Field.Acceleration(r, a));
+
+        for (int32 j = 0; j < 3; ++j)
+        {
+            const double h = 1e-3;
+            double rp[3] = { r[0], r[1], r[2] }, rm[3] = { r[0], r[1], r[2] };
+            rp[j] += h; rm[j] -= h;
+            double Up, Um;
+            ASSERT_TRUE(Field.Potential(rp, Up));
+            ASSERT_TRUE(Field.Potential(rm, Um));
+            EXPECT_NEAR(a[j], (Up - Um) / (2. * h), 5e-10) << "point " << i;
+        }
+    }
+}
+
+TEST(gravity_field_test, Batch_Matches_Single) {
+
+    FGravityField Field;
+    RandomField(70, Field);
+
+    FRandomStream Random(7);
+    TArray<double> X, Y, Z;
+    for (int32 i = 0; i < 1001; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector());
+        const double r = Random.FRandRange(6500., 9000.);
+        X.Add(r * u.X); Y.Add(r * u.Y); Z.Add(r * u.Z);
+    }
+    X[500] = 0.; Y[500] = 0.; Z[500] = 0.;
+
+    TArray<double> AX, AY, AZ;
+    AX.SetNum(X.Num()); AY.SetNum(X.Num()); AZ.SetNum(X.Num());
+    EXPECT_EQ(Field.Accelerations(FConstVectorBatch(X, Y, Z), FVectorBatch{ AX, AY, AZ }, 2), X.Num() - 1);
+
+    for (int32 i = 0; i < X.Num(); ++i)
+    {
+        const double r[3] = { X[i], Y[i], Z[i] };
+        double a[3];
+        Field.Acceleration(r, a, 2);
+        EXPECT_NEAR(AX[i], a[0], 1e-18) << "point " << i;
+        EXPECT_NEAR(AY[i], a[1], 1e-18) << "point " << i;
+        EXPECT_NEAR(AZ[i], a[2], 1e-18) << "point " << i;
+    }
+    EXPECT_EQ(AX[500], 0.);
+}
+
+TEST(gravity_field_test, Loads_ICGEM_And_SHADR) {
+
+    const FString Directory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MaxQTests"), TEXT("GravityField")));
+
+    // SI units, Fortran exponents, a term past max_degree
+    const FString IcgemPath = FPaths::Combine(Directory, TEXT("test.gfc"));
+    ASSERT_TRUE(FFileHelper::SaveStringToFile(TEXT(
+        "product_type              gravity_field\n"
+        "modelname                 MAXQ_TEST\n"
+        "earth_gravity_constant    0.3986004415E+15\n"
+        "radius                    0.6378136300E+07\n"
+        "max_degree                3\n"
+        "norm                      fully_normalized\n"
+        "key   L    M         C                  S\n"
+        "end_of_head ==================================\n"
+        "gfc   0    0  1.000000000000D+00  0.000000000000D+00\n"
+        "gfc   2    0 -0.484165143790D-03  0.000000000000D+00\n"
+        "gfc   2    2  0.243938357328D-05 -0.140027370385D-05\n"
+        "gfc   3    1  0.203046201047D-05  0.248200415856D-06\n"
+        "gfc   4    0  0.539965866638D-06  0.000000000000D+00\n"), *IcgemPath));
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FGravityField Field;
+    ASSERT_TRUE(LoadGravityField(IcgemPath, Field, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Field.GetDegree(), 3);
+    EXPECT_DOUBLE_EQ(Field.GetGM(), 398600.4415);
+    EXPECT_DOUBLE_EQ(Field.GetRadius(), 6378.1363);
+    EXPECT_DOUBLE_EQ(Field.GetC(2, 0), -0.484165143790e-3);
+    EXPECT_DOUBLE_EQ(Field.GetS(2, 2), -0.140027370385e-5);
+    EXPECT_DOUBLE_EQ(Field.GetC(3, 1), 0.203046201047e-5);
+
+    ASSERT_TRUE(LoadGravityField(IcgemPath, Field, 2, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Field.GetDegree(), 2);
+
+    // km, unnormalized:  C20 = -J2
+    const FString ShadrPath = FPaths::Combine(Directory, TEXT("test.tab"));
+    ASSERT_TRUE(FFileHelper::SaveStringToFile(TEXT(
+        "   1.7380000000000000E+03,   4.9028001224453001E+03,   0.0,   2,   2,   0,   0.0,   0.0\n"
+        "    2,    0,-2.0330000000000000E-04, 0.0000000000000000E+00, 0.0, 0.0\n"
+        "    2,    2, 2.2400000000000000E-05, 0.0000000000000000E+00, 0.0, 0.0\n"), *ShadrPath));
+
+    ASSERT_TRUE(LoadGravityField(ShadrPath, Field, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Field.GetDegree(), 2);
+    EXPECT_DOUBLE_EQ(Field.GetRadius(), 1738.);
+    EXPECT_DOUBLE_EQ(Field.GetC(0, 0), 1.);
+    EXPECT_NEAR(Field.GetC(2, 0), -2.033e-4 / sqrt(5.), 1e-18);
+    EXPECT_NEAR(Field.GetC(2, 2), 2.24e-5 * sqrt(24. / 10.), 1e-18);
+
+    // Neither
+    const FString BadPath = FPaths::Combine(Directory, TEXT("bad.txt"));
+    ASSERT_TRUE(FFileHelper::SaveStringToFile(TEXT("not a gravity field\n"), *BadPath));
+    EXPECT_FALSE(LoadGravityField(BadPath, Field, 0, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_TRUE(Field.IsEmpty());
+}
+
+TEST(gravity_field_test, Force_Rotates_Into_Body_Fixed) {
+
+    TSharedRef<FGravityField, ESPMode::ThreadSafe> Field = MakeShared<FGravityField, ESPMode::ThreadSafe>();
+    RandomField(8, *Field);
+
+    // A quarter turn in 1000 s
+    const double rate = UE_DOUBLE_HALF_PI / 1000.;
+    FSphericalHarmonicGravityForce Force(Field, FSRotationMatrix(), FSEphemerisTime(0.), rate);
+
+    const double state[6] = { 7000., 1000., -500., 0., 7.5, 0. };
+    double a[3] = { 0., 0., 0. };
+    ASSERT_TRUE(Force.AddAcceleration(0, 1000., state, a));
+
+    // The body's +Y is along the inertial -X then
+    const double fixed[3] = { state[1], -state[0], state[2] };
+    double expected[3];
+    ASSERT_TRUE(Field->Acceleration(fixed, expected, 1));
+    EXPECT_NEAR(a[0], -expected[1], 1e-15);
+    EXPECT_NEAR(a[1], expected[0], 1e-15);
+    EXPECT_NEAR(a[2], expected[2], 1e-15);
+}
@@ -0,0 +1,129 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGroundTrack.h"
+
+using namespace MaxQ::Orbits;
+
+static FSGP4Propagator SunSynchronous(FSEphemerisTime& epoch)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSTwoLineElements elems;
+    USpice::getelm(ResultCode, ErrorMessage, epoch, elems,
+        TEXT("1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999"),
+        TEXT("2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544"));
+
+    double geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+    return FSGP4Propagator(FSTLEGeophysicalConstants(geophs), elems, &ResultCode, &ErrorMessage);
+}
+
+static void ExpectSameTrack(const FGroundTrackCache& Cache, const TArray<FSGP4Propagator>& Catalog, double Start, double Stop)
+{
+    FGroundTrackCache Fresh;
+    Fresh.Reset(Catalog);
+    ASSERT_TRUE(Fresh.Update(FSEphemerisTime(Start), FSEphemerisTime(Stop)));
+
+    TArray<FGroundTrackPoint> Expected, Actual;
+    Fresh.Track(0, Expected);
+    Cache.Track(0, Actual);
+    ASSERT_EQ(Actual.Num(), Expected.Num());
+    for (int32 i = 0; i < Expected.Num(); ++i)
+    {
+        EXPECT_EQ(Actual[i].et, Expected[i].et);
+        EXPECT_DOUBLE_EQ(Actual[i].Latitude, Expected[i].Latitude);
+        EXPECT_DOUBLE_EQ(Actual[i].Longitude, Expected[i].Longitude);
+        EXPECT_DOUBLE_EQ(Actual[i].Altitude, Expected[i].Altitude);
+    }
+}
+
+
+TEST(ground_track_test, Update_ComputesOnlyNewSamples) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSEphemerisTime epoch;
+    TArray<FSGP4Propagator> Catalog { SunSynchronous(epoch) };
+    ASSERT_TRUE(Catalog[0].IsValid());
+
+    FGroundTrackCache Cache;
+    Cache.Reset(Catalog);
+
+    const double Start = epoch.seconds, Span = 3. * 3600.;
+    ASSERT_TRUE(Cache.Update(FSEphemerisTime(Start), FSEphemerisTime(Start + Span), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_GE(Cache.NumComputed(), 360);
+
+    // Ten minutes on:  20 new samples at the default 30 seconds
+    ASSERT_TRUE(Cache.Update(FSEphemerisTime(Start + 600.), FSEphemerisTime(Start + Span + 600.), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Cache.NumComputed(), 20);
+    ExpectSameTrack(Cache, Catalog, Start + 600., Start + Span + 600.);
+
+    // And back again, before where it started
+    ASSERT_TRUE(Cache.Update(FSEphemerisTime(Start - 600.), FSEphemerisTime(Start + Span - 600.), &ResultCode, &ErrorMessage));
+    EXPECT_LE(Cache.NumComputed(), 40);
+    ExpectSameTrack(Cache, Catalog, Start - 600., Start + Span - 600.);
+
+    // Nowhere near:  everything is new
+    ASSERT_TRUE(Cache.Update(FSEphemerisTime(Start + 86400.), FSEphemerisTime(Start + 86400. + Span), &ResultCode, &ErrorMessage));
+    EXPECT_GE(Cache.NumComputed(), 360);
+    ExpectSameTrack(Cache, Catalog, Start + 86400., Start + 86400. + Span);
+}
+
+
+TEST(ground_track_test, Revolutions_StartAtAscendingNode) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    FSEphemerisTime epoch;
+    TArray<FSGP4Propagator> Catalog { SunSynchronous(epoch) };
+    ASSERT_TRUE(Catalog[0].IsValid());
+
+    FGroundTrackCache Cache;
+    FGroundTrackSettings Settings;
+    Settings.Step = 20.;
+    Cache.Reset(Catalog, Settings);
+
+    // ~94 minute period:  parts of four or five revolutions
+    const double Start = epoch.seconds;
+    ASSERT_TRUE(Cache.Update(FSEphemerisTime(Start), FSEphemerisTime(Start + 6. * 3600.)));
+
+    TArrayView<const FGroundTrackRevolution> Revolutions = Cache.Revolutions(0);
+    ASSERT_GE(Revolutions.Num(), 4);
+    ASSERT_LE(Revolutions.Num(), 5);
+
+    // 97.3 degrees inclination
+    const double MaxLatitude = FMath::DegreesToRadians(180. - 97.2676) + 0.01;
+
+    for (int32 r = 0; r < Revolutions.Num(); ++r)
+    {
+        const FGroundTrackRevolution& Revolution = Revolutions[r];
+        ASSERT_GT(Revolution.Points.Num(), 0);
+        if (r > 0)
+        {
+            EXPECT_EQ(Revolution.Number, Revolutions[r - 1].Number + 1);
+            EXPECT_LT(Revolutions[r - 1].Points.Last().Latitude, 0.);
+            EXPECT_GE(Revolution.Points[0].Latitude, 0.);
+            EXPECT_DOUBLE_EQ(Revolution.Points[0].et - Revolutions[r - 1].Points.Last().et, Settings.Step);
+        }
+
+        for (const FGroundTrackPoint& Point : Revolution.Points)
+        {
+            EXPECT_LE(FMath::Abs(Point.Latitude), MaxLatitude);
+            EXPECT_GT(Point.Altitude, 450.);
+            EXPECT_LT(Point.Altitude, 600.);
+        }
+    }
+}
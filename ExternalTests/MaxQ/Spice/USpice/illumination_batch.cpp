@@ -0,0 +1,186 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceIlluminationBatch.h"
+#include "SpiceData.h"
+
+using namespace MaxQ::Math;
+
+static FIlluminationGeometry Geometry(double a, double b, double c)
+{
+    FIlluminationGeometry Geometry;
+    Geometry.Observer = FSDistanceVector(0., 1.e6, 0.);
+    Geometry.Source = FSDistanceVector(1.e8, 0., 0.);
+    Geometry.Radii = FSDistanceVector(a, b, c);
+    return Geometry;
+}
+
+
+TEST(illumination_batch_test, Sphere_Angles_And_Flags) {
+
+    // +x faces the source, +y the observer, -x is night
+    TArray<double> X = { 1., 0., -1., 0. }, Y = { 0., 1., 0., 0. }, Z = { 0., 0., 0., 1. };
+    TArray<float> Phase, Incidence, Emission;
+    TArray<uint8> Flags;
+    Phase.SetNum(4); Incidence.SetNum(4); Emission.SetNum(4); Flags.SetNum(4);
+
+    const FIlluminationAngleBatch Angles { Phase, Incidence, Emission, Flags };
+    ASSERT_TRUE(IlluminationAngles(Geometry(1., 1., 1.), FConstVectorBatch(X, Y, Z), Angles));
+
+    EXPECT_NEAR(Incidence[0], 0.f, 1e-6f);
+    EXPECT_NEAR(Emission[0], HALF_PI, 1e-5f);
+    EXPECT_NEAR(Phase[0], HALF_PI, 1e-5f);
+
+    EXPECT_NEAR(Incidence[1], HALF_PI, 1e-5f);
+    EXPECT_NEAR(Emission[1], 0.f, 1e-6f);
+    EXPECT_EQ(Flags[1], FIlluminationAngleBatch::Visible);
+
+    EXPECT_NEAR(Incidence[2], PI, 1e-5f);
+    EXPECT_EQ(Flags[2] & FIlluminationAngleBatch::Lit, 0);
+
+    EXPECT_NEAR(Incidence[3], HALF_PI, 1e-5f);
+    EXPECT_NEAR(Emission[3], HALF_PI, 1e-5f);
+}
+
+
+TEST(illumination_batch_test, Matches_Brute_Force) {
+
+    // An oblate ellipsoid, and a few thousand points on it
+    const double a = 3396.19, c = 3376.2;
+    const int32 Num = 5000;
+    TArray<double> X, Y, Z, NX, NY, NZ;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const double lon = 0.37 * i, lat = asin(2. * (i + 0.5) / Num - 1.);
+        X.Add(a * cos(lat) * cos(lon)); Y.Add(a * cos(lat) * sin(lon)); Z.Add(c * sin(lat));
+        const FVector3d n = FVector3d(X.Last() / (a * a), Y.Last() / (a * a), Z.Last() / (c * c)).GetSafeNormal();
+        NX.Add(n.X); NY.Add(n.Y); NZ.Add(n.Z);
+    }
+
+    TArray<float> Phase, Incidence, Emission, Phase2, Incidence2, Emission2;
+    Phase.SetNum(Num); Incidence.SetNum(Num); Emission.SetNum(Num);
+    Phase2.SetNum(Num); Incidence2.SetNum(Num); Emission2.SetNum(Num);
+
+    FIlluminationGeometry G = Geometry(a, a, c);
+    G.Observer = FSDistanceVector(4000., 9000., -2500.);
+
+    ASSERT_TRUE(IlluminationAngles(G, FConstVectorBatch(X, Y, Z), { Phase, Incidence, Emission, {} }));
+    // Explicit normals give the same answers
+    const FConstVectorBatch Normals(NX, NY, NZ);
+    ASSERT_TRUE(IlluminationAngles(G, FConstVectorBatch(X, Y, Z), { Phase2, Incidence2, Emission2, {} }, &Normals));
+
+    const FVector3d Observer(4000., 9000., -2500.), Source(1.e8, 0., 0.);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const FVector3d p(X[i], Y[i], Z[i]), n(NX[i], NY[i], NZ[i]);
+        const FVector3d s = (Source - p).GetSafeNormal(), o = (Observer - p).GetSafeNormal();
+        EXPECT_NEAR(Incidence[i], acos(FMath::Clamp(n | s, -1., 1.)), 1e-5) << i;
+        EXPECT_NEAR(Emission[i], acos(FMath::Clamp(n | o, -1., 1.)), 1e-5) << i;
+        EXPECT_NEAR(Phase[i], acos(FMath::Clamp(s | o, -1., 1.)), 1e-5) << i;
+        EXPECT_NEAR(Incidence2[i], Incidence[i], 1e-6) << i;
+        EXPECT_NEAR(Emission2[i], Emission[i], 1e-6) << i;
+    }
+}
+
+
+TEST(illumination_batch_test, Rejects_Bad_Inputs) {
+
+    TArray<double> X = { 1. }, Y = { 0. }, Z = { 0. };
+    TArray<float> Phase = { 0.f }, Incidence = { 0.f }, Emission = { 0.f }, Short;
+
+    // No radii, no normals
+    EXPECT_FALSE(IlluminationAngles(Geometry(0., 0., 0.), FConstVectorBatch(X, Y, Z), { Phase, Incidence, Emission, {} }));
+    // Lengths differ
+    EXPECT_FALSE(IlluminationAngles(Geometry(1., 1., 1.), FConstVectorBatch(X, Y, Z), { Phase, Short, Emission, {} }));
+    EXPECT_TRUE(IlluminationAngles(Geometry(1., 1., 1.), FConstVectorBatch(X, Y, Z), { Phase, Incidence, Emission, {} }));
+}
+
+
+// Ties FAKEBODY9994 to its IAU frame, for cidfrm
+static const char* BodyFrameKernel =
+    "KPL/FK\n"
+    "\\begindata\n"
+    "OBJECT_9994_FRAME = 'IAU_FAKEBODY9994'\n"
+    "\\begintext\n";
+
+static double Distance(const FSDistanceVector& a, const FSDistanceVector& b)
+{
+    double u[3], v[3];
+    a.CopyTo(u);
+    b.CopyTo(v);
+    return sqrt((u[0] - v[0]) * (u[0] - v[0]) + (u[1] - v[1]) * (u[1] - v[1]) + (u[2] - v[2]) * (u[2] - v[2]));
+}
+
+
+TEST(illumination_batch_test, PlanetLighting_Matches_Subpnt) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    TArrayView<const uint8> Contents((const uint8*)BodyFrameKernel, FCStringAnsi::Strlen(BodyFrameKernel));
+    ASSERT_TRUE(MaxQ::Data::FurnshBuffer(TEXT("illumination_batch_test.tf"), Contents, &ResultCode, &ErrorMessage));
+
+    const FString Target = TEXT("FAKEBODY9994"), Source = TEXT("FAKEBODY9993"), Observer = TEXT("FAKEBODY9995");
+    TArray<FString> Targets { Target };
+    TArray<FPlanetLighting> Lighting;
+
+    for (ES_AberrationCorrectionWithTransmissions abcorr : { ES_AberrationCorrectionWithTransmissions::None, ES_AberrationCorrectionWithTransmissions::LT_S })
+    {
+        ASSERT_TRUE(PlanetLighting(et0, Targets, Lighting, Source, TEXT("ECLIPJ2000"), abcorr, Observer, &ResultCode, &ErrorMessage)) << TCHAR_TO_ANSI(*ErrorMessage);
+        ASSERT_EQ(Lighting.Num(), 1);
+        ASSERT_TRUE(Lighting[0].bHasRadii);
+
+        FSDistanceVector spoint, srfvec;
+        FSEphemerisTime trgepc;
+        USpice::subpnt(ResultCode, ErrorMessage, spoint, trgepc, srfvec, et0, {}, ES_ComputationMethod::NEAR_POINT_ELLIPSOID, Target, TEXT("IAU_FAKEBODY9994"), abcorr, Observer);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        EXPECT_NEAR(Lighting[0].TargetEpoch.seconds, trgepc.seconds, 1.e-6);
+        EXPECT_LT(Distance(Lighting[0].SubObserver, spoint), 1.e-6);
+    }
+
+    // Uncorrected, the sub-source point is subpnt's from the source
+    ASSERT_TRUE(PlanetLighting(et0, Targets, Lighting, Source, TEXT("ECLIPJ2000"), ES_AberrationCorrectionWithTransmissions::None, Observer, &ResultCode, &ErrorMessage));
+
+    FSDistanceVector spoint, srfvec;
+    FSEphemerisTime trgepc;
+    USpice::subpnt(ResultCode, ErrorMessage, spoint, trgepc, srfvec, et0, {}, ES_ComputationMethod::NEAR_POINT_ELLIPSOID, Target, TEXT("IAU_FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, Source);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    EXPECT_LT(Distance(Lighting[0].SubSource, spoint), 1.e-6);
+
+    // The direction, in ref, points at the source
+    FSDistanceVector r;
+    FSEphemerisPeriod lt;
+    USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, Source, Target, TEXT("ECLIPJ2000"));
+    double u[3], d[3];
+    r.CopyTo(u);
+    Lighting[0].SourceDirection.CopyTo(d);
+    const double Norm = sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+    EXPECT_NEAR(d[0], u[0] / Norm, 1.e-12);
+    EXPECT_NEAR(d[1], u[1] / Norm, 1.e-12);
+    EXPECT_NEAR(d[2], u[2] / Norm, 1.e-12);
+}
+
+
+TEST(illumination_batch_test, PlanetLighting_Rejects_Non_Inertial_Reference) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    TArray<FString> Targets { TEXT("FAKEBODY9994") };
+    TArray<FPlanetLighting> Lighting;
+
+    EXPECT_FALSE(PlanetLighting(et0, Targets, Lighting, TEXT("FAKEBODY9993"), TEXT("IAU_FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_EQ(Lighting.Num(), 0);
+}
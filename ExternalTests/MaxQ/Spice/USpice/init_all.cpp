@@ -6,6 +6,9 @@
 // GitHub:         https://github.com/Gamergenic1/MaxQ/ 
 
 #include "pch.h"
+#include "SpiceCore.h"
+#include "SpiceLock.h"
+#include "SpiceTime.h"
 
 
 TEST(init_all_test, DefaultsTestCase) {
@@ -49,4 +52,16 @@ TEST(init_all_test, Execution_ClearsError) {
     EXPECT_EQ(ErrorMessage.Len(), 0);
 }
 
+TEST(init_all_test, FirstUse_Initializes) {
 
+    {
+        MaxQ::Core::FSpiceScope Scope;
+    }
+    EXPECT_TRUE(MaxQ::Core::IsInitialized());
+    EXPECT_TRUE(MaxQ::Time::GetEtClock().IsAnchored());
+
+    // Again is a no-op
+    MaxQ::Core::EnsureInitialized();
+    MaxQ::Core::WarmUp(false);
+    EXPECT_TRUE(MaxQ::Core::IsInitialized());
+}
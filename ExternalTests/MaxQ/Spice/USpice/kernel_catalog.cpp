@@ -0,0 +1,76 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceKernelCatalog.h"
+#include "SpiceData.h"
+#include "SpiceCore.h"
+#include "Misc/Paths.h"
+
+
+TEST(kernel_catalog_test, Loads_On_Demand) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    // Everything but the SPK
+    USpice::furnsh_absolute("maxq_unit_test_lsk.tls");
+    USpice::furnsh_absolute("maxq_unit_test_pck.tpc");
+    USpice::furnsh_absolute("maxq_unit_test_fk.tf");
+
+    const FString Spk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"));
+    const FString CatalogPath = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test.kcat"));
+
+    FSDistanceVector r;
+    FSEphemerisPeriod lt;
+
+    {
+        MaxQ::Data::FKernelCatalog Catalog;
+        EXPECT_TRUE(Catalog.Add({ Spk }, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_EQ(Catalog.NumFiles(), 1);
+        EXPECT_EQ(Catalog.NumLoaded(), 0);
+        EXPECT_TRUE(Catalog.Coverage(MaxQ::Data::EKernelCatalogType::SPK, 9994).Contains(et0.seconds));
+
+        // Not covered isn't an error
+        bool bCovered = true;
+        EXPECT_TRUE(Catalog.Ensure(MaxQ::Data::EKernelCatalogType::SPK, 123456, et0.seconds, &bCovered, &ResultCode, &ErrorMessage));
+        EXPECT_FALSE(bCovered);
+        EXPECT_EQ(Catalog.NumLoaded(), 0);
+
+        EXPECT_TRUE(Catalog.EnsureSpk(9994, 9995, et0.seconds, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_TRUE(Catalog.IsLoaded(Spk));
+
+        USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+        EXPECT_TRUE(Catalog.Save(CatalogPath, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+        // Unloading behind the catalog's back is noticed
+        MaxQ::Data::Unload(Spk);
+        EXPECT_TRUE(Catalog.EnsureSpk(9994, et0.seconds, &ResultCode, &ErrorMessage));
+        EXPECT_TRUE(Catalog.IsLoaded(Spk));
+    }
+
+    // ...and the catalog unloads what it loaded
+    USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // A saved catalog needs no scan
+    MaxQ::Data::FKernelCatalog Loaded;
+    EXPECT_TRUE(Loaded.Load(CatalogPath, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Loaded.NumFiles(), 1);
+    EXPECT_TRUE(Loaded.Coverage(MaxQ::Data::EKernelCatalogType::SPK, 9994).Contains(et0.seconds));
+
+    MaxQ::Core::ClearAll();
+}
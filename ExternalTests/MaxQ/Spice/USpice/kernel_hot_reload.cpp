@@ -0,0 +1,79 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceKernelHotReload.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+
+TEST(kernel_hot_reload_test, Reloads_In_Precedence_Order) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    IFileManager& FileManager = IFileManager::Get();
+    const FString Directory = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_hot_reload"));
+    const FString SpkA = FPaths::Combine(Directory, TEXT("a.bsp"));
+    const FString Fk = FPaths::Combine(Directory, TEXT("fk.tf"));
+    const FString SpkB = FPaths::Combine(Directory, TEXT("b.bsp"));
+    FileManager.Copy(*SpkA, *FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp")));
+    FileManager.Copy(*SpkB, *FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp")));
+    FileManager.Copy(*Fk, *FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_fk.tf")));
+
+    USpice::furnsh_absolute("maxq_unit_test_lsk.tls");
+    USpice::furnsh_absolute("maxq_unit_test_pck.tpc");
+    EXPECT_TRUE(MaxQ::Data::Furnsh(TArray<FString>{ SpkA, Fk, SpkB }, &ResultCode, &ErrorMessage));
+
+    MaxQ::Data::FKernelHotReload HotReload(Directory);
+    EXPECT_EQ(HotReload.NumWatched(), 3);
+
+    MaxQ::Data::FKernelReload LastReload;
+    int32 Reloads = 0;
+    HotReload.OnKernelsReloaded().AddLambda([&](const MaxQ::Data::FKernelReload& Reload)
+    {
+        LastReload = Reload;
+        ++Reloads;
+    });
+
+    // Nothing changed
+    EXPECT_TRUE(HotReload.Poll(&ResultCode, &ErrorMessage));
+    EXPECT_EQ(Reloads, 0);
+
+    // The first SPK:  it and the later SPK reload, the FK doesn't
+    FileManager.SetTimeStamp(*SpkA, FDateTime::UtcNow() + FTimespan::FromHours(1.));
+    EXPECT_TRUE(HotReload.Poll(&ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_EQ(Reloads, 1);
+    ASSERT_EQ(LastReload.Changed.Num(), 1);
+    EXPECT_TRUE(FPaths::IsSamePath(LastReload.Changed[0], SpkA));
+    ASSERT_EQ(LastReload.Reloaded.Num(), 2);
+    EXPECT_TRUE(FPaths::IsSamePath(LastReload.Reloaded[0], SpkA));
+    EXPECT_TRUE(FPaths::IsSamePath(LastReload.Reloaded[1], SpkB));
+    EXPECT_TRUE(EnumHasAnyFlags(LastReload.Kinds, ES_KernelType::SPK));
+    EXPECT_FALSE(EnumHasAnyFlags(LastReload.Kinds, ES_KernelType::TEXT));
+
+    FSDistanceVector r;
+    FSEphemerisPeriod lt;
+    USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    // A deleted kernel is unloaded
+    FileManager.Delete(*SpkB);
+    EXPECT_TRUE(HotReload.Poll(&ResultCode, &ErrorMessage));
+    ASSERT_EQ(Reloads, 2);
+    EXPECT_EQ(LastReload.Reloaded.Num(), 0);
+    EXPECT_EQ(HotReload.NumWatched(), 2);
+
+    MaxQ::Core::ClearAll();
+    FileManager.DeleteDirectory(*Directory, false, true);
+}
@@ -0,0 +1,61 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceProfiling.h"
+#include "Misc/Paths.h"
+
+
+TEST(kernel_load_timeline_test, Records_Phases_And_Types) {
+
+#if MAXQ_COUNTERS_ENABLED
+    USpice::init_all();
+    MaxQ::Data::ResetKernelLoadTimeline();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    const FString Lsk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_lsk.tls"));
+    const FString Spk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"));
+    EXPECT_TRUE(MaxQ::Data::Furnsh(TArray<FString> { Lsk, Spk }, &ResultCode, &ErrorMessage));
+    EXPECT_TRUE(MaxQ::Data::Unload(Spk, &ResultCode, &ErrorMessage));
+
+    const TArray<MaxQ::Data::FKernelLoadRecord> Timeline = MaxQ::Data::GetKernelLoadTimeline();
+    ASSERT_EQ(Timeline.Num(), 3);
+
+    // Furnsh of a list opens and validates first
+    EXPECT_EQ(Timeline[0].Type, ES_KernelType::TEXT);
+    EXPECT_FALSE(Timeline[0].bUnload);
+    EXPECT_TRUE(Timeline[0].bSuccess);
+    EXPECT_GT(Timeline[0].Size, 0);
+    EXPECT_GE(Timeline[0].Open, 0.);
+    EXPECT_GE(Timeline[0].Validate, 0.);
+    EXPECT_GT(Timeline[0].Load, 0.);
+
+    EXPECT_EQ(Timeline[1].Type, ES_KernelType::SPK);
+    EXPECT_GT(Timeline[1].Size, Timeline[0].Size);
+
+    // An unload reads only the ID word
+    EXPECT_EQ(Timeline[2].Type, ES_KernelType::SPK);
+    EXPECT_TRUE(Timeline[2].bUnload);
+    EXPECT_EQ(Timeline[2].Size, Timeline[1].Size);
+    EXPECT_EQ(Timeline[2].Open, 0.);
+
+    const FString Report = MaxQ::Data::GetKernelLoadReport(1);
+    EXPECT_TRUE(Report.Contains(TEXT("2 furnsh")));
+    EXPECT_TRUE(Report.Contains(TEXT("1 unloads")));
+    EXPECT_TRUE(Report.Contains(TEXT("Slowest 1:")));
+
+    MaxQ::Data::ResetKernelLoadTimeline();
+    EXPECT_EQ(MaxQ::Data::GetKernelLoadTimeline().Num(), 0);
+
+    MaxQ::Core::ClearAll();
+#endif
+}
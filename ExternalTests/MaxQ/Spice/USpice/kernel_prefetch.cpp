@@ -0,0 +1,77 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceKernelPrefetch.h"
+#include "SpiceCore.h"
+#include "Misc/Paths.h"
+
+using namespace MaxQ::Data;
+
+
+TEST(kernel_prefetch_test, Segment_Record_Ranges) {
+
+    // 128 records' worth of doubles over 128 seconds
+    FCoverageSegment Segment;
+    Segment.Start = 0.;
+    Segment.Stop = 128.;
+    Segment.Begin = 129;
+    Segment.End = 128 + 128 * 128;
+
+    int64 Offset = 0, Bytes = 0;
+
+    // One second:  one record, padded by one either side
+    EXPECT_TRUE(GetSegmentRecordRange(Segment, 64., 65., Offset, Bytes));
+    EXPECT_EQ(Offset, 1024 + 63 * 1024);
+    EXPECT_EQ(Bytes, 3 * 1024);
+
+    // Clamped to the segment
+    EXPECT_TRUE(GetSegmentRecordRange(Segment, -1.e9, 1.e9, Offset, Bytes));
+    EXPECT_EQ(Offset, 1024);
+    EXPECT_EQ(Bytes, 128 * 1024);
+
+    EXPECT_FALSE(GetSegmentRecordRange(Segment, 129., 130., Offset, Bytes));
+
+    // No addresses (an old index)
+    Segment.Begin = Segment.End = 0;
+    EXPECT_FALSE(GetSegmentRecordRange(Segment, 64., 65., Offset, Bytes));
+}
+
+
+TEST(kernel_prefetch_test, Prefetches_Ahead_Of_Playback) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    const FString Spk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"));
+
+    FKernelCoverageIndex Index;
+    ASSERT_TRUE(Index.Add({ Spk }, &ResultCode, &ErrorMessage));
+    const FCoverageSegment* Segment = Index.FindSegment(EKernelCoverageType::SPK, 9994, et0.seconds);
+    ASSERT_NE(Segment, nullptr);
+    EXPECT_GT(Segment->Begin, 0);
+    EXPECT_GE(Segment->End, Segment->Begin);
+
+    FKernelPagePrefetcher Prefetcher;
+    Prefetcher.Configure(Index, { 9994 });
+    EXPECT_GT(Prefetcher.NumSegments(), 0);
+
+    EXPECT_GT(Prefetcher.Update(et0, 3600.), 0);
+    // Nothing new
+    EXPECT_EQ(Prefetcher.Update(et0, 3600.), 0);
+    // Backwards is
+    EXPECT_GT(Prefetcher.Update(et0, -3600.), 0);
+    EXPECT_GT(Prefetcher.BytesPrefetched(), 0);
+
+    // Nothing covers it
+    Prefetcher.Configure(Index, { 123456 });
+    EXPECT_EQ(Prefetcher.NumSegments(), 0);
+    EXPECT_EQ(Prefetcher.Update(et0, 3600.), 0);
+}
@@ -0,0 +1,82 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceKernelSubset.h"
+#include "SpiceCoverageIndex.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+using MaxQ::Data::EKernelCoverageType;
+
+
+TEST(kernel_subset_test, Writes_Trimmed_Spk) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_lsk.tls");
+    USpice::furnsh_absolute("maxq_unit_test_pck.tpc");
+    USpice::furnsh_absolute("maxq_unit_test_fk.tf");
+
+    const FString Spk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"));
+    const FString SubsetPath = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_subset.bsp"));
+
+    FSDistanceVector r, rSubset;
+    FSEphemerisPeriod lt;
+    USpice::furnsh_absolute("maxq_unit_test_spk.bsp");
+    USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    MaxQ::Data::Unload(Spk);
+
+    // A day around et0, for 9994 (and whatever it's relative to)
+    MaxQ::Data::FKernelSubset Subset;
+    Subset.Start = et0.seconds - 43200.;
+    Subset.Stop = et0.seconds + 43200.;
+    Subset.Bodies = { 9994, 9995 };
+
+    int32 SegmentsWritten = 0;
+    EXPECT_TRUE(MaxQ::Data::SubsetKernel(Spk, SubsetPath, Subset, &SegmentsWritten, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_GT(SegmentsWritten, 0);
+
+    MaxQ::Data::FKernelCoverageIndex Source, Trimmed;
+    EXPECT_TRUE(Source.Add({ Spk }, &ResultCode, &ErrorMessage));
+    EXPECT_TRUE(Trimmed.Add({ SubsetPath }, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_TRUE(Trimmed.IsCovered(EKernelCoverageType::SPK, 9994, et0.seconds));
+    EXPECT_FALSE(Trimmed.IsCovered(EKernelCoverageType::SPK, 9994, Subset.Stop + 86400.));
+    EXPECT_LE(Trimmed.Segments(EKernelCoverageType::SPK, 9994).Num(), Source.Segments(EKernelCoverageType::SPK, 9994).Num());
+    EXPECT_LE(IFileManager::Get().FileSize(*SubsetPath), IFileManager::Get().FileSize(*Spk));
+
+    // Nothing is refit, so states are the same
+    EXPECT_TRUE(MaxQ::Data::Furnsh(SubsetPath, &ResultCode, &ErrorMessage));
+    USpice::spkpos(ResultCode, ErrorMessage, et0, rSubset, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(rSubset.x.km, r.x.km);
+    EXPECT_DOUBLE_EQ(rSubset.y.km, r.y.km);
+    EXPECT_DOUBLE_EQ(rSubset.z.km, r.z.km);
+    MaxQ::Data::Unload(SubsetPath);
+
+    // Nothing in the subset isn't an error, and writes nothing
+    Subset.Bodies = { 123456 };
+    IFileManager::Get().Delete(*SubsetPath);
+    EXPECT_TRUE(MaxQ::Data::SubsetKernel(Spk, SubsetPath, Subset, &SegmentsWritten, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(SegmentsWritten, 0);
+    EXPECT_FALSE(FPaths::FileExists(SubsetPath));
+
+    // The source can't be its own destination
+    EXPECT_FALSE(MaxQ::Data::SubsetKernel(Spk, Spk, Subset, &SegmentsWritten, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    MaxQ::Core::ClearAll();
+}
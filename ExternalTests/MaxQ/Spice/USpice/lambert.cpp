@@ -0,0 +1,160 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceLambert.h"
+
+using namespace MaxQ::Orbits;
+
+static const double gm_earth = 398600.4418;
+
+TEST(lambert_test, Lambert_Matches_prop2b) {
+
+    USpice::init_all();
+
+    struct FCase { FSDistanceVector r1, r2; double tof; };
+    const FCase Cases[] = {
+        { FSDistanceVector(7000., 0., 0.), FSDistanceVector(0., 9000., 1000.), 2000. },
+        { FSDistanceVector(7000., 0., 0.), FSDistanceVector(-8000., -100., 500.), 3000. },
+        { FSDistanceVector(7000., 100., 0.), FSDistanceVector(42000., 5000., 0.), 20000. },
+        // Hyperbolic
+        { FSDistanceVector(7000., 0., 0.), FSDistanceVector(-7000., 100., 0.), 100. },
+        // Near parabolic
+        { FSDistanceVector(7000., 0., 0.), FSDistanceVector(20000., 20000., 0.), 1e5 },
+        { FSDistanceVector(7000., 0., 0.), FSDistanceVector(-3000., -6000., 0.), 50000. }
+    };
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    for (const FCase& Case : Cases)
+    {
+        for (bool bRetrograde : { false, true })
+        {
+            FSVelocityVector v1, v2;
+            ASSERT_TRUE(Lambert(FSMassConstant(gm_earth), Case.r1, Case.r2, FSEphemerisPeriod(Case.tof), v1, v2, bRetrograde));
+
+            FSStateVector propagated;
+            USpice::prop2b(ResultCode, ErrorMessage, FSMassConstant(gm_earth), FSStateVector(Case.r1, v1), FSEphemerisPeriod(Case.tof), propagated);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            EXPECT_TRUE(IsNear(FSStateVector(Case.r2, v2), propagated, 1e-8, 1e-10)) << "tof " << Case.tof << " retrograde " << bRetrograde;
+
+            // Angular momentum along +z, or -z
+            const double hz = Case.r1.x.km * v1.dy.kmps - Case.r1.y.km * v1.dx.kmps;
+            EXPECT_EQ(hz < 0., bRetrograde);
+        }
+    }
+
+    FSVelocityVector v1, v2;
+    EXPECT_FALSE(Lambert(FSMassConstant(gm_earth), Cases[0].r1, Cases[0].r2, FSEphemerisPeriod(0.), v1, v2));
+    EXPECT_FALSE(Lambert(FSMassConstant(gm_earth), Cases[0].r1, FSDistanceVector(14000., 0., 0.), FSEphemerisPeriod(1000.), v1, v2));
+}
+
+TEST(lambert_test, SolvePorkchop_Matches_Lambert) {
+
+    // Two circular orbits, 10000 km and 15000 km
+    auto Circular = [](double r, double et)
+    {
+        const double n = sqrt(gm_earth / (r * r * r));
+        const double v = n * r;
+        return FSStateVector(FSDistanceVector(r * cos(n * et), r * sin(n * et), 0.), FSVelocityVector(-v * sin(n * et), v * cos(n * et), 0.));
+    };
+
+    TArray<double> Departures, Arrivals;
+    TArray<FSStateVector> DepartureStates, ArrivalStates;
+    for (int32 i = 0; i < 40; ++i)
+    {
+        Departures.Add(i * 300.);
+        DepartureStates.Add(Circular(10000., Departures.Last()));
+    }
+    for (int32 i = 0; i < 30; ++i)
+    {
+        Arrivals.Add(3000. + i * 400.);
+        ArrivalStates.Add(Circular(15000., Arrivals.Last()));
+    }
+
+    FPorkchopPlot Plot;
+    const int32 Solved = SolvePorkchop(Departures, DepartureStates, Arrivals, ArrivalStates, gm_earth, Plot);
+    EXPECT_EQ(Plot.NumDepartures, 40);
+    EXPECT_EQ(Plot.NumArrivals, 30);
+    EXPECT_EQ(Plot.Num(), 40 * 30);
+    EXPECT_GT(Solved, 0);
+    EXPECT_LT(Solved, Plot.Num());
+
+    // Arrival before departure
+    EXPECT_EQ(Plot.C3[Plot.Index(39, 0)], -1.f);
+    EXPECT_EQ(Plot.ArrivalVInfinity[Plot.Index(39, 0)], -1.f);
+
+    const int32 d = 3, a = 17;
+    FSVelocityVector v1, v2;
+    ASSERT_TRUE(Lambert(FSMassConstant(gm_earth), DepartureStates[d].r, ArrivalStates[a].r, FSEphemerisPeriod(Arrivals[a] - Departures[d]), v1, v2));
+
+    const double dx = v1.dx.kmps - DepartureStates[d].v.dx.kmps, dy = v1.dy.kmps - DepartureStates[d].v.dy.kmps, dz = v1.dz.kmps - DepartureStates[d].v.dz.kmps;
+    EXPECT_NEAR(Plot.C3[Plot.Index(d, a)], dx * dx + dy * dy + dz * dz, 1e-5);
+
+    const double ax = v2.dx.kmps - ArrivalStates[a].v.dx.kmps, ay = v2.dy.kmps - ArrivalStates[a].v.dy.kmps, az = v2.dz.kmps - ArrivalStates[a].v.dz.kmps;
+    EXPECT_NEAR(Plot.ArrivalVInfinity[Plot.Index(d, a)], sqrt(ax * ax + ay * ay + az * az), 1e-5);
+}
+
+TEST(lambert_test, Porkchop_Matches_spkezr) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FPorkchopSettings Settings;
+    Settings.Departure = TEXT("FAKEBODY9993");
+    Settings.Arrival = TEXT("FAKEBODY9994");
+    Settings.Center = TEXT("FAKEBODY9995");
+    Settings.GM = 1e6;
+
+    TArray<double> Departures = { et0.seconds, et0.seconds + 3600. };
+    TArray<double> Arrivals = { et0.seconds + 7200., et0.seconds + 10800., et0.seconds + 14400. };
+
+    FPorkchopPlot Plot;
+    EXPECT_TRUE(Porkchop(Departures, Arrivals, Settings, Plot, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Plot.Num(), 6);
+
+    TArray<FSStateVector> DepartureStates, ArrivalStates;
+    for (double et : Departures)
+    {
+        FSStateVector state;
+        FSEphemerisPeriod lt;
+        USpice::spkezr(ResultCode, ErrorMessage, FSEphemerisTime(et), state, lt, Settings.Departure, Settings.Center, Settings.Frame);
+        DepartureStates.Add(state);
+    }
+    for (double et : Arrivals)
+    {
+        FSStateVector state;
+        FSEphemerisPeriod lt;
+        USpice::spkezr(ResultCode, ErrorMessage, FSEphemerisTime(et), state, lt, Settings.Arrival, Settings.Center, Settings.Frame);
+        ArrivalStates.Add(state);
+    }
+
+    FPorkchopPlot Expected;
+    SolvePorkchop(Departures, DepartureStates, Arrivals, ArrivalStates, Settings.GM, Expected);
+    for (int32 i = 0; i < Plot.Num(); ++i)
+    {
+        EXPECT_FLOAT_EQ(Plot.C3[i], Expected.C3[i]);
+        EXPECT_FLOAT_EQ(Plot.ArrivalVInfinity[i], Expected.ArrivalVInfinity[i]);
+    }
+
+    // Unknown body
+    Settings.Arrival = TEXT("NOT A BODY");
+    EXPECT_FALSE(Porkchop(Departures, Arrivals, Settings, Plot, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_EQ(Plot.Num(), 0);
+}
@@ -0,0 +1,144 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceLineOfSight.h"
+#include "SpiceSpatialIndex.h"
+#include "SpiceOperators.h"
+
+using namespace MaxQ::Math;
+
+namespace
+{
+    struct FConstellation
+    {
+        TArray<double> X, Y, Z;
+
+        explicit FConstellation(int32 Num)
+        {
+            FRandomStream Random(42);
+            for (int32 i = 0; i < Num; ++i)
+            {
+                const FVector3d u = Random.GetUnitVector();
+                const double r = Random.FRandRange(6900., 8500.);
+                X.Add(r * u.X); Y.Add(r * u.Y); Z.Add(r * u.Z);
+            }
+        }
+
+        FConstVectorBatch Batch() const { return FConstVectorBatch(X, Y, Z); }
+        FSDistanceVector operator[](int32 i) const { return FSDistanceVector(X[i], Y[i], Z[i]); }
+    };
+
+    // Every link the slow way, as sorted (neighbor, range) per node
+    TArray<TArray<TPair<int32, double>>> BruteForce(const FConstellation& Nodes, const FLineOfSightSettings& Settings)
+    {
+        const int32 Num = Nodes.X.Num();
+        TArray<TArray<TPair<int32, double>>> Links;
+        Links.SetNum(Num);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            for (int32 j = 0; j < Num; ++j)
+            {
+                const double Range = (Nodes[i] - Nodes[j]).Magnitude().km;
+                if (i != j && (Settings.MaxRange <= 0. || Range <= Settings.MaxRange) && HasLineOfSight(Nodes[i], Nodes[j], Settings))
+                {
+                    Links[i].Add({ j, Range });
+                }
+            }
+        }
+        return Links;
+    }
+
+    void ExpectSame(const FLineOfSightGraph& Graph, const TArray<TArray<TPair<int32, double>>>& Expected)
+    {
+        ASSERT_EQ(Graph.Num(), Expected.Num());
+        for (int32 i = 0; i < Graph.Num(); ++i)
+        {
+            TArray<TPair<int32, double>> Actual;
+            for (int32 k = 0; k < Graph.GetNeighbors(i).Num(); ++k)
+            {
+                Actual.Add({ Graph.GetNeighbors(i)[k], Graph.GetRanges(i)[k] });
+            }
+            Actual.Sort([](const TPair<int32, double>& a, const TPair<int32, double>& b) { return a.Key < b.Key; });
+
+            ASSERT_EQ(Actual.Num(), Expected[i].Num()) << "node " << i;
+            for (int32 k = 0; k < Actual.Num(); ++k)
+            {
+                EXPECT_EQ(Actual[k].Key, Expected[i][k].Key);
+                EXPECT_NEAR(Actual[k].Value, Expected[i][k].Value, 1.e-9);
+            }
+        }
+    }
+}
+
+
+TEST(line_of_sight_test, Single_Links) {
+
+    FLineOfSightSettings Settings;
+
+    // Same side, opposite sides
+    EXPECT_TRUE(HasLineOfSight(FSDistanceVector(7000., 0., 0.), FSDistanceVector(7000., 1000., 0.), Settings));
+    EXPECT_FALSE(HasLineOfSight(FSDistanceVector(7000., 0., 0.), FSDistanceVector(-7000., 0., 0.), Settings));
+
+    // Passes 7000 km from the center:  clear, unless the margin reaches it
+    const FSDistanceVector a(7000., -3000., 0.), b(7000., 3000., 0.);
+    EXPECT_TRUE(HasLineOfSight(a, b, Settings));
+    Settings.GrazingAltitude = 700.;
+    EXPECT_FALSE(HasLineOfSight(a, b, Settings));
+
+    // Below the surface
+    Settings.GrazingAltitude = 0.;
+    EXPECT_FALSE(HasLineOfSight(FSDistanceVector(6000., 0., 0.), FSDistanceVector(9000., 0., 0.), Settings));
+}
+
+
+TEST(line_of_sight_test, Graph_Matches_Pairwise_Tests) {
+
+    const FConstellation Nodes(400);
+
+    FLineOfSightSettings Settings;
+    FLineOfSightGraph Graph;
+    ASSERT_TRUE(BuildLineOfSightGraph(Nodes.Batch(), nullptr, Graph, Settings));
+    ExpectSame(Graph, BruteForce(Nodes, Settings));
+    EXPECT_EQ(Graph.Neighbors.Num() % 2, 0);
+
+    // Within range, through the index
+    Settings.MaxRange = 4000.;
+    FSpatialIndex Index;
+    Index.Build(Nodes.Batch());
+    EXPECT_FALSE(BuildLineOfSightGraph(Nodes.Batch(), nullptr, Graph, Settings));
+    ASSERT_TRUE(BuildLineOfSightGraph(Nodes.Batch(), &Index, Graph, Settings));
+    ExpectSame(Graph, BruteForce(Nodes, Settings));
+
+    // Nearest first
+    for (int32 i = 0; i < Graph.Num(); ++i)
+    {
+        TArrayView<const double> Ranges = Graph.GetRanges(i);
+        for (int32 k = 1; k < Ranges.Num(); ++k)
+        {
+            EXPECT_LE(Ranges[k - 1], Ranges[k]);
+        }
+    }
+}
+
+
+TEST(line_of_sight_test, Invalid_Nodes_Have_No_Links) {
+
+    const FConstellation Nodes(50);
+    TArray<uint8> Valid;
+    Valid.Init(1, 50);
+    Valid[7] = 0;
+
+    FLineOfSightGraph Graph;
+    ASSERT_TRUE(BuildLineOfSightGraph(Nodes.Batch(), nullptr, Graph, FLineOfSightSettings(), Valid));
+    EXPECT_EQ(Graph.GetNeighbors(7).Num(), 0);
+    for (int32 i = 0; i < Graph.Num(); ++i)
+    {
+        EXPECT_FALSE(Graph.GetNeighbors(i).Contains(7));
+    }
+}
@@ -0,0 +1,134 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceLocalOrbitalFrame.h"
+
+using namespace MaxQ::Math;
+
+
+TEST(local_orbital_frame_test, Circular_Equatorial) {
+
+    TArray<double> RX{ 7000. }, RY{ 0. }, RZ{ 0. };
+    TArray<double> VX{ 0. }, VY{ 7.5 }, VZ{ 0. };
+    const FConstVectorBatch r(RX, RY, RZ), v(VX, VY, VZ);
+
+    TArray<FSRotationMatrix> m;
+    m.SetNum(1);
+
+    // RIC is the identity here
+    EXPECT_EQ(LocalOrbitalFrames(r, v, m, ELocalOrbitalFrame::RIC), 0);
+    const double (&ric)[3][3] = m[0].AsSpiceDoubleArray();
+    for (int32 i = 0; i < 3; ++i)
+    {
+        for (int32 j = 0; j < 3; ++j)
+        {
+            EXPECT_NEAR(ric[i][j], i == j ? 1. : 0., 1.e-15);
+        }
+    }
+
+    // LVLH:  X forward, Y opposite the orbit normal, Z down
+    EXPECT_EQ(LocalOrbitalFrames(r, v, m, ELocalOrbitalFrame::LVLH), 0);
+    const double (&lvlh)[3][3] = m[0].AsSpiceDoubleArray();
+    const double expected[3][3] = { { 0., 1., 0. }, { 0., 0., -1. }, { -1., 0., 0. } };
+    for (int32 i = 0; i < 3; ++i)
+    {
+        for (int32 j = 0; j < 3; ++j)
+        {
+            EXPECT_NEAR(lvlh[i][j], expected[i][j], 1.e-15);
+        }
+    }
+}
+
+
+TEST(local_orbital_frame_test, Orthonormal_And_Degenerate) {
+
+    TArray<double> RX{ 6800., 0., 1000. }, RY{ 1200., 0., 2000. }, RZ{ -300., 0., 3000. };
+    TArray<double> VX{ 0.5, 1., 1. }, VY{ 7.2, 0., 2. }, VZ{ 2.1, 0., 3. };
+    const FConstVectorBatch r(RX, RY, RZ), v(VX, VY, VZ);
+
+    TArray<FSRotationMatrix> m;
+    m.SetNum(3);
+
+    // The second has no position, the third's velocity is radial
+    EXPECT_EQ(LocalOrbitalFrames(r, v, m, ELocalOrbitalFrame::LVLH), 2);
+
+    double mmt[3][3];
+    const double (&a)[3][3] = m[0].AsSpiceDoubleArray();
+    for (int32 i = 0; i < 3; ++i)
+    {
+        for (int32 j = 0; j < 3; ++j)
+        {
+            mmt[i][j] = a[i][0] * a[j][0] + a[i][1] * a[j][1] + a[i][2] * a[j][2];
+            EXPECT_NEAR(mmt[i][j], i == j ? 1. : 0., 1.e-14);
+        }
+    }
+
+    // Z is down
+    const double lr = FMath::Sqrt(RX[0] * RX[0] + RY[0] * RY[0] + RZ[0] * RZ[0]);
+    EXPECT_NEAR(a[2][0], -RX[0] / lr, 1.e-14);
+    EXPECT_NEAR(a[2][1], -RY[0] / lr, 1.e-14);
+    EXPECT_NEAR(a[2][2], -RZ[0] / lr, 1.e-14);
+
+    for (int32 k = 1; k < 3; ++k)
+    {
+        const double (&d)[3][3] = m[k].AsSpiceDoubleArray();
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                EXPECT_EQ(d[i][j], i == j ? 1. : 0.);
+            }
+        }
+    }
+}
+
+
+TEST(local_orbital_frame_test, Relative_States) {
+
+    const double R = 7000., V = 7.5;
+    const FSStateVector Chief(FSDistanceVector(R, 0., 0.), FSVelocityVector(0., V, 0.));
+
+    // The same circular orbit, 0.01 rad ahead:  in track, and at rest in
+    // the rotating frame.  Then 1 km above the chief, drifting.
+    const double theta = 0.01;
+    TArray<double> RX{ R * cos(theta), R + 1. }, RY{ R * sin(theta), 0. }, RZ{ 0., 0. };
+    TArray<double> VX{ -V * sin(theta), 0. }, VY{ V * cos(theta), V }, VZ{ 0., 0. };
+
+    TArray<double> OX, OY, OZ, WX, WY, WZ;
+    for (TArray<double>* a : { &OX, &OY, &OZ, &WX, &WY, &WZ })
+    {
+        a->SetNum(2);
+    }
+
+    EXPECT_TRUE(RelativeStates(Chief, FConstVectorBatch(RX, RY, RZ), FConstVectorBatch(VX, VY, VZ), FVectorBatch{ OX, OY, OZ }, FVectorBatch{ WX, WY, WZ }, ELocalOrbitalFrame::RIC));
+
+    EXPECT_NEAR(OX[0], R * (cos(theta) - 1.), 1.e-9);
+    EXPECT_NEAR(OY[0], R * sin(theta), 1.e-9);
+    EXPECT_NEAR(OZ[0], 0., 1.e-12);
+    EXPECT_NEAR(WX[0], 0., 1.e-12);
+    EXPECT_NEAR(WY[0], 0., 1.e-12);
+    EXPECT_NEAR(WZ[0], 0., 1.e-12);
+
+    // 1 km up, with the chief's inertial velocity:  falls behind at w * 1 km
+    EXPECT_NEAR(OX[1], 1., 1.e-12);
+    EXPECT_NEAR(OY[1], 0., 1.e-12);
+    EXPECT_NEAR(WX[1], 0., 1.e-12);
+    EXPECT_NEAR(WY[1], -V / R, 1.e-12);
+
+    // LVLH:  the same state, axes permuted
+    EXPECT_TRUE(RelativeStates(Chief, FConstVectorBatch(RX, RY, RZ), FConstVectorBatch(VX, VY, VZ), FVectorBatch{ OX, OY, OZ }, FVectorBatch{ WX, WY, WZ }, ELocalOrbitalFrame::LVLH));
+    EXPECT_NEAR(OX[0], R * sin(theta), 1.e-9);
+    EXPECT_NEAR(OZ[0], -R * (cos(theta) - 1.), 1.e-9);
+    EXPECT_NEAR(OZ[1], -1., 1.e-12);
+    EXPECT_NEAR(WX[1], -V / R, 1.e-12);
+
+    // No frame
+    const FSStateVector Radial(FSDistanceVector(R, 0., 0.), FSVelocityVector(1., 0., 0.));
+    EXPECT_FALSE(RelativeStates(Radial, FConstVectorBatch(RX, RY, RZ), FConstVectorBatch(VX, VY, VZ), FVectorBatch{ OX, OY, OZ }, FVectorBatch{ WX, WY, WZ }));
+}
@@ -0,0 +1,145 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceLocalSolarTime.h"
+
+using namespace MaxQ::Time;
+
+static const double pi = 3.14159265358979323846;
+
+// The longitude east of the Sun's at which it's Seconds past local midnight
+static double LongitudeAt(double SunLon, double Seconds)
+{
+    return SunLon + Seconds / 86400. * 2. * pi - pi;
+}
+
+
+TEST(local_solar_time_test, Planetocentric_Times) {
+
+    const double SunLon = 1.;
+    const TArray<double> Seconds{ 43200.5, 64830.5, 21600.5, 0.5, 86399.5, 45296.25 };
+
+    TArray<double> Longitudes;
+    for (double s : Seconds)
+    {
+        Longitudes.Add(LongitudeAt(SunLon, s));
+    }
+    // A full turn around doesn't change the time
+    Longitudes[3] += 2. * pi;
+    Longitudes[4] -= 4. * pi;
+
+    TArray<FLocalSolarTime> Times;
+    Times.SetNum(Longitudes.Num());
+    LocalSolarTime(SunLon, Longitudes, Times);
+
+    for (int32 i = 0; i < Seconds.Num(); ++i)
+    {
+        EXPECT_NEAR(Times[i].Seconds, Seconds[i], 1.e-6);
+    }
+
+    // The subsolar point is noon
+    EXPECT_EQ(Times[0].Hour, 12);
+    EXPECT_EQ(Times[0].Minute, 0);
+    EXPECT_EQ(Times[0].Second, 0);
+
+    EXPECT_EQ(Times[1].Hour, 18);
+    EXPECT_EQ(Times[1].Minute, 0);
+    EXPECT_EQ(Times[1].Second, 30);
+
+    EXPECT_EQ(Times[4].Hour, 23);
+    EXPECT_EQ(Times[4].Minute, 59);
+    EXPECT_EQ(Times[4].Second, 59);
+
+    // 12:34:56.25
+    EXPECT_EQ(Times[5].Hour, 12);
+    EXPECT_EQ(Times[5].Minute, 34);
+    EXPECT_EQ(Times[5].Second, 56);
+}
+
+
+TEST(local_solar_time_test, Planetographic_Sense) {
+
+    const double SunLon = -0.25;
+    const TArray<double> Longitudes{ LongitudeAt(SunLon, 30000.5), LongitudeAt(SunLon, 70000.5) };
+
+    TArray<FLocalSolarTime> East, West, Centric;
+    East.SetNum(2);
+    West.SetNum(2);
+    Centric.SetNum(2);
+
+    LocalSolarTime(SunLon, Longitudes, East, ES_LongitudeType::Planetographic, false);
+    LocalSolarTime(SunLon, Longitudes, Centric, ES_LongitudeType::Planetocentric, true);
+
+    // Positive west longitudes are the planetocentric ones negated
+    TArray<double> Negated{ -Longitudes[0], -Longitudes[1] };
+    LocalSolarTime(SunLon, Negated, West, ES_LongitudeType::Planetographic, true);
+
+    for (int32 i = 0; i < 2; ++i)
+    {
+        EXPECT_NEAR(East[i].Seconds, Centric[i].Seconds, 1.e-9);
+        EXPECT_NEAR(West[i].Seconds, Centric[i].Seconds, 1.e-6);
+    }
+    EXPECT_EQ(Centric[0].Hour, 8);
+    EXPECT_EQ(Centric[0].Minute, 20);
+    EXPECT_EQ(Centric[0].Second, 0);
+}
+
+
+TEST(local_solar_time_test, Parallel_Matches_Serial) {
+
+    const int32 Count = 10000;
+    TArray<double> Longitudes;
+    for (int32 i = 0; i < Count; ++i)
+    {
+        Longitudes.Add(-pi + 2. * pi * i / Count);
+    }
+
+    TArray<FLocalSolarTime> All, One;
+    All.SetNum(Count);
+    One.SetNum(1);
+    LocalSolarTime(0.3, Longitudes, All);
+
+    for (int32 i = 0; i < Count; i += 997)
+    {
+        LocalSolarTime(0.3, TArrayView<const double>(&Longitudes[i], 1), One);
+        EXPECT_EQ(All[i].Seconds, One[0].Seconds);
+        EXPECT_EQ(All[i].Second, One[0].Second);
+    }
+}
+
+
+TEST(local_solar_time_test, Errors) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    TArray<double> Longitudes{ 0., 1. };
+    TArray<FLocalSolarTime> Times;
+    Times.SetNum(1);
+
+    // Out's the wrong size
+    EXPECT_FALSE(LocalSolarTime(0., 399, Longitudes, Times, ES_LongitudeType::Planetocentric, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+
+    // No frame for the body (nothing's loaded)
+    ResultCode = ES_ResultCode::Success;
+    ErrorMessage.Empty();
+    Times.SetNum(2);
+    EXPECT_FALSE(LocalSolarTime(0., 123456, Longitudes, Times, ES_LongitudeType::Planetocentric, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+
+    double SunLon = 0.;
+    ResultCode = ES_ResultCode::Success;
+    EXPECT_FALSE(SunLongitude(0., 123456, SunLon, &ResultCode));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
@@ -0,0 +1,43 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceData.h"
+#include "SpiceCore.h"
+
+
+TEST(mapped_kernels_test, Follows_Loaded_Kernels) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    MaxQ::Data::SetMapBinaryKernels(true);
+    EXPECT_EQ(MaxQ::Data::NumMappedKernels(), 0);
+
+    // The meta-kernel's binary kernels are mapped, not just the meta-kernel
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_GT(MaxQ::Data::NumMappedKernels(), 0);
+
+    // Reads are unaffected
+    FSDistanceVector r;
+    FSEphemerisPeriod lt;
+    USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    MaxQ::Core::ClearAll();
+    EXPECT_EQ(MaxQ::Data::NumMappedKernels(), 0);
+
+    MaxQ::Data::SetMapBinaryKernels(false);
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    EXPECT_EQ(MaxQ::Data::NumMappedKernels(), 0);
+    USpice::init_all();
+}
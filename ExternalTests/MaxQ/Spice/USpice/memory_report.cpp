@@ -0,0 +1,39 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMemory.h"
+#include "SpiceData.h"
+
+
+TEST(memory_report_test, Counts_Pool_Contents) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    MaxQ::Data::FSpiceMemoryReport Empty;
+    EXPECT_TRUE(MaxQ::Data::GetMemoryReport(Empty, &ResultCode, &ErrorMessage));
+    EXPECT_GT(Empty.StaticBytes, 0);
+    EXPECT_GT(Empty.LargestModules.Num(), 0);
+    EXPECT_EQ(Empty.MappedKernels, 0);
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    MaxQ::Data::FSpiceMemoryReport Loaded;
+    EXPECT_TRUE(MaxQ::Data::GetMemoryReport(Loaded, &ResultCode, &ErrorMessage));
+    EXPECT_GT(Loaded.PoolVariables, Empty.PoolVariables);
+    EXPECT_GT(Loaded.PoolBytes, Empty.PoolBytes);
+    EXPECT_LE(Loaded.PoolVariables, Loaded.PoolVariableCapacity);
+    EXPECT_GE(Loaded.Allocations, 0);
+
+    USpice::init_all();
+}
@@ -0,0 +1,181 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMathBatch.h"
+
+using namespace MaxQ::Math;
+
+static FSRotationMatrix TestRotation()
+{
+    FSRotationMatrix m;
+    USpice::axisar(FSDimensionlessVector(1., -2., 3.), FSAngle(0.7), m);
+    return m;
+}
+
+// A rotation and an arbitrary derivative block, like sxform_c produces
+static FSStateTransform TestTransform()
+{
+    double r[3][3];
+    TestRotation().CopyTo(r);
+
+    double m[6][6] = {};
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            m[i][j] = m[i + 3][j + 3] = r[i][j];
+            m[i + 3][j] = 1e-4 * (i - 2 * j + 1);
+        }
+    }
+
+    return FSStateTransform(m);
+}
+
+static void TestPoints(int32 Num, TArray<double>& X, TArray<double>& Y, TArray<double>& Z)
+{
+    FRandomStream Random(4321);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        X.Add(Random.FRandRange(-50000., 50000.));
+        Y.Add(Random.FRandRange(-50000., 50000.));
+        Z.Add(Random.FRandRange(-50000., 50000.));
+    }
+}
+
+TEST(mxv_batch_test, MxV_MTxV_Match_mxv) {
+
+    const FSRotationMatrix m = TestRotation();
+    const int32 Num = 10001;
+
+    TArray<double> X, Y, Z;
+    TestPoints(Num, X, Y, Z);
+
+    TArray<double> X2, Y2, Z2, X3, Y3, Z3;
+    X2.SetNum(Num); Y2.SetNum(Num); Z2.SetNum(Num);
+    X3.SetNum(Num); Y3.SetNum(Num); Z3.SetNum(Num);
+
+    MxV(m, FConstVectorBatch(X, Y, Z), FVectorBatch{ X2, Y2, Z2 });
+    MTxV(m, FConstVectorBatch(X, Y, Z), FVectorBatch{ X3, Y3, Z3 });
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        FSDistanceVector expected;
+        USpice::mxv_distance(m, FSDistanceVector(X[i], Y[i], Z[i]), expected);
+
+        EXPECT_NEAR(X2[i], expected.x.km, 1e-9) << "point " << i;
+        EXPECT_NEAR(Y2[i], expected.y.km, 1e-9) << "point " << i;
+        EXPECT_NEAR(Z2[i], expected.z.km, 1e-9) << "point " << i;
+
+        USpice::mtxv_distance(m, FSDistanceVector(X[i], Y[i], Z[i]), expected);
+
+        EXPECT_NEAR(X3[i], expected.x.km, 1e-9) << "point " << i;
+        EXPECT_NEAR(Y3[i], expected.y.km, 1e-9) << "point " << i;
+        EXPECT_NEAR(Z3[i], expected.z.km, 1e-9) << "point " << i;
+    }
+
+    // In place:  MTxV undoes MxV
+    MTxV(m, FConstVectorBatch(X2, Y2, Z2), FVectorBatch{ X2, Y2, Z2 });
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        EXPECT_NEAR(X2[i], X[i], 1e-9) << "point " << i;
+        EXPECT_NEAR(Y2[i], Y[i], 1e-9) << "point " << i;
+        EXPECT_NEAR(Z2[i], Z[i], 1e-9) << "point " << i;
+    }
+}
+
+TEST(mxv_batch_test, Interleaved_And_DistanceVectors) {
+
+    const FSRotationMatrix m = TestRotation();
+    const int32 Num = 5000;
+
+    TArray<double> X, Y, Z;
+    TestPoints(Num, X, Y, Z);
+
+    TArray<double> xyz;
+    TArray<FSDistanceVector> v;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        xyz.Append({ X[i], Y[i], Z[i] });
+        v.Add(FSDistanceVector(X[i], Y[i], Z[i]));
+    }
+
+    TArray<double> xyzout;
+    xyzout.SetNum(xyz.Num());
+    MxV(m, xyz, xyzout);
+
+    TArray<FSDistanceVector> vout;
+    vout.SetNum(Num);
+    MxV(m, v, vout);
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        FSDistanceVector expected;
+        USpice::mxv_distance(m, v[i], expected);
+
+        EXPECT_NEAR(xyzout[3 * i + 0], expected.x.km, 1e-9) << "point " << i;
+        EXPECT_NEAR(xyzout[3 * i + 1], expected.y.km, 1e-9) << "point " << i;
+        EXPECT_NEAR(xyzout[3 * i + 2], expected.z.km, 1e-9) << "point " << i;
+
+        EXPECT_NEAR(vout[i].x.km, expected.x.km, 1e-9) << "point " << i;
+        EXPECT_NEAR(vout[i].y.km, expected.y.km, 1e-9) << "point " << i;
+        EXPECT_NEAR(vout[i].z.km, expected.z.km, 1e-9) << "point " << i;
+    }
+
+    // In place, and back
+    MTxV(m, xyzout, xyzout);
+    for (int32 i = 0; i < xyz.Num(); ++i)
+    {
+        EXPECT_NEAR(xyzout[i], xyz[i], 1e-9) << "element " << i;
+    }
+}
+
+TEST(mxv_batch_test, StateTransform_Matches_mxv_state) {
+
+    const FSStateTransform m = TestTransform();
+    const int32 Num = 5000;
+
+    TArray<double> X, Y, Z, DX, DY, DZ;
+    TestPoints(Num, X, Y, Z);
+    TestPoints(Num, DX, DY, DZ);
+
+    TArray<FSStateVector> states;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        double state[6] = { X[i], Y[i], Z[i], 1e-4 * DX[i], 1e-4 * DY[i], 1e-4 * DZ[i] };
+        states.Add(FSStateVector(state));
+    }
+
+    TArray<FSStateVector> statesout;
+    statesout.SetNum(Num);
+    MxV(m, states, statesout);
+
+    TArray<double> RX, RY, RZ, VX, VY, VZ;
+    for (const FSStateVector& s : states)
+    {
+        double state[6];
+        s.CopyTo(state);
+        RX.Add(state[0]); RY.Add(state[1]); RZ.Add(state[2]);
+        VX.Add(state[3]); VY.Add(state[4]); VZ.Add(state[5]);
+    }
+
+    // In place
+    MxV(m, FConstVectorBatch(RX, RY, RZ), FConstVectorBatch(VX, VY, VZ), FVectorBatch{ RX, RY, RZ }, FVectorBatch{ VX, VY, VZ });
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        FSStateVector expected;
+        USpice::mxv_state(m, states[i], expected);
+
+        EXPECT_TRUE(IsNear(statesout[i], expected, 1e-9, 1e-12)) << "state " << i;
+
+        double state[6] = { RX[i], RY[i], RZ[i], VX[i], VY[i], VZ[i] };
+        EXPECT_TRUE(IsNear(FSStateVector(state), expected, 1e-9, 1e-12)) << "state " << i;
+    }
+}
@@ -0,0 +1,123 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceNameRegistry.h"
+#include "SpiceData.h"
+#include <thread>
+
+using namespace MaxQ::Data;
+
+static TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> LoadRegistryKernels()
+{
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    return UpdateNameRegistry();
+}
+
+TEST(name_registry_test, Matches_CSPICE) {
+
+    TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> Registry = LoadRegistryKernels();
+    EXPECT_TRUE(Registry->IsCurrent());
+
+    const TPair<const TCHAR*, int32> Bodies[] = {
+        { TEXT("EARTH"), 399 },
+        { TEXT("  earth  "), 399 },
+        { TEXT("Solar  System Barycenter"), 0 },
+        { TEXT("399"), 399 },
+        { TEXT("FAKEBODY9994"), 9994 }
+    };
+    for (const auto& Body : Bodies)
+    {
+        int32 Code = 0;
+        EXPECT_TRUE(Registry->BodyCode(FString(Body.Key), Code)) << Body.Key;
+        EXPECT_EQ(Code, Body.Value) << Body.Key;
+    }
+
+    FString BodyName;
+    EXPECT_TRUE(Registry->BodyName(399, BodyName));
+    EXPECT_EQ(BodyName, TEXT("EARTH"));
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    for (const TCHAR* Name : { TEXT("J2000"), TEXT("eclipj2000"), TEXT("IAU_EARTH"), TEXT("IAU_FAKEBODY9994") })
+    {
+        int frcode = 0;
+        USpice::namfrm(ResultCode, ErrorMessage, Name, frcode);
+        ASSERT_NE(frcode, 0) << Name;
+
+        int32 Id = 0;
+        EXPECT_TRUE(Registry->FrameId(FString(Name), Id)) << Name;
+        EXPECT_EQ(Id, frcode) << Name;
+
+        FString frname, FrameName;
+        USpice::frmnam(ResultCode, ErrorMessage, frcode, frname);
+        EXPECT_TRUE(Registry->FrameName(Id, FrameName));
+        EXPECT_EQ(FrameName, frname);
+    }
+
+    int32 Code = 12345;
+    EXPECT_FALSE(Registry->BodyCode(TEXT("NOT A BODY"), Code));
+    EXPECT_FALSE(Registry->FrameId(TEXT("NOT_A_FRAME"), Code));
+    EXPECT_EQ(Code, 12345);
+
+    // Through MaxQ::Data
+    EXPECT_TRUE(Bods2c(Code, TEXT("fakebody9995")));
+    EXPECT_EQ(Code, 9995);
+    FString Name;
+    EXPECT_TRUE(Bodc2n(Name, 9994));
+    EXPECT_EQ(Name, TEXT("FAKEBODY9994"));
+}
+
+TEST(name_registry_test, Follows_Boddef) {
+
+    LoadRegistryKernels();
+
+    Boddef(TEXT("Registry  Test Body"), -999123);
+    TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> Registry = GetNameRegistry();
+    EXPECT_TRUE(Registry->IsCurrent());
+
+    int32 Code = 0;
+    EXPECT_TRUE(Registry->BodyCode(TEXT("registry test body"), Code));
+    EXPECT_EQ(Code, -999123);
+    FString Name;
+    EXPECT_TRUE(Registry->BodyName(-999123, Name));
+    EXPECT_EQ(Name, TEXT("Registry  Test Body"));
+
+    // A second name for the code wins bodc2n
+    Boddef(TEXT("REGISTRY TEST BODY 2"), -999123);
+    EXPECT_TRUE(GetNameRegistry()->BodyName(-999123, Name));
+    EXPECT_EQ(Name, TEXT("REGISTRY TEST BODY 2"));
+    EXPECT_TRUE(GetNameRegistry()->BodyCode(TEXT("REGISTRY TEST BODY"), Code));
+
+    // Snapshots held from before don't change
+    EXPECT_TRUE(Registry->BodyName(-999123, Name));
+    EXPECT_EQ(Name, TEXT("Registry  Test Body"));
+    EXPECT_FALSE(Registry->IsCurrent());
+}
+
+TEST(name_registry_test, Other_Threads) {
+
+    LoadRegistryKernels();
+
+    int32 Code = 0;
+    FString Name;
+    bool bCode = false, bName = false;
+    std::thread Worker([&]()
+        {
+            TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> Registry = GetNameRegistry();
+            bCode = Registry->BodyCode(TEXT("FAKEBODY9993"), Code);
+            bName = Registry->FrameName(1, Name);
+        });
+    Worker.join();
+
+    EXPECT_TRUE(bCode);
+    EXPECT_EQ(Code, 9993);
+    EXPECT_TRUE(bName);
+    EXPECT_EQ(Name, TEXT("J2000"));
+}
@@ -0,0 +1,203 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceIntegrator.h"
+#include "SpiceEphemerisCache.h"
+
+using namespace MaxQ::Orbits;
+
+static const double gm_earth = 398600.4418;
+
+static TArray<FSStateVector> TestStates()
+{
+    return {
+        FSStateVector(FSDistanceVector(6778., 0., 0.), FSVelocityVector(0., 5.9, 4.9)),
+        FSStateVector(FSDistanceVector(-7000., 1200., 300.), FSVelocityVector(-1., -8.5, 2.)),
+        FSStateVector(FSDistanceVector(0., 42164., 0.), FSVelocityVector(-3.0747, 0., 0.)),
+        FSStateVector(FSDistanceVector(20000., -5000., 8000.), FSVelocityVector(.5, 3.5, -1.))
+    };
+}
+
+TEST(numerical_integrator_test, TwoBody_Matches_prop2b) {
+
+    USpice::init_all();
+
+    TArray<FSStateVector> States = TestStates();
+    FNumericalPropagator Propagator(gm_earth);
+
+    TArray<FSStateVector> Propagated;
+    Propagated.SetNum(States.Num());
+    TArray<FTrajectory> Trajectories;
+    Trajectories.SetNum(States.Num());
+    TArray<bool> valid;
+    valid.SetNum(States.Num());
+
+    const double t0 = 1e8, t1 = 1e8 + 21600.;
+    EXPECT_EQ(Propagator.Propagate(States, FSEphemerisTime(t0), FSEphemerisTime(t1), Propagated, Trajectories, valid), States.Num());
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    for (int32 i = 0; i < States.Num(); ++i)
+    {
+        EXPECT_TRUE(valid[i]);
+
+        FSStateVector expected;
+        USpice::prop2b(ResultCode, ErrorMessage, FSMassConstant(gm_earth), States[i], FSEphemerisPeriod(t1 - t0), expected);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_TRUE(IsNear(expected, Propagated[i], 1e-4, 1e-7)) << "object " << i;
+
+        // Dense output, between steps
+        EXPECT_DOUBLE_EQ(Trajectories[i].GetStart(), t0);
+        EXPECT_DOUBLE_EQ(Trajectories[i].GetStop(), t1);
+        for (double dt : { 0., 1.5, 777.7, 10000., 21599. })
+        {
+            FSStateVector dense;
+            ASSERT_TRUE(Trajectories[i].State(FSEphemerisTime(t0 + dt), dense));
+
+            USpice::prop2b(ResultCode, ErrorMessage, FSMassConstant(gm_earth), States[i], FSEphemerisPeriod(dt), expected);
+            EXPECT_TRUE(IsNear(expected, dense, 1e-4, 1e-7)) << "object " << i << " dt " << dt;
+        }
+
+        FSStateVector outside;
+        EXPECT_FALSE(Trajectories[i].State(FSEphemerisTime(t1 + 1.), outside));
+    }
+}
+
+TEST(numerical_integrator_test, Backward_Trajectory) {
+
+    TArray<FSStateVector> States = TestStates();
+    FNumericalPropagator Propagator(gm_earth);
+
+    TArray<FSStateVector> Propagated;
+    Propagated.SetNum(States.Num());
+    TArray<FTrajectory> Trajectories;
+    Trajectories.SetNum(States.Num());
+
+    const double t0 = 0., t1 = -7200.;
+    EXPECT_EQ(Propagator.Propagate(States, FSEphemerisTime(t0), FSEphemerisTime(t1), Propagated, Trajectories), States.Num());
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    for (int32 i = 0; i < States.Num(); ++i)
+    {
+        FSStateVector expected;
+        USpice::prop2b(ResultCode, ErrorMessage, FSMassConstant(gm_earth), States[i], FSEphemerisPeriod(t1 - t0), expected);
+        EXPECT_TRUE(IsNear(expected, Propagated[i], 1e-4, 1e-7)) << "object " << i;
+
+        // Steps are in increasing time either way
+        EXPECT_DOUBLE_EQ(Trajectories[i].GetStart(), t1);
+        EXPECT_DOUBLE_EQ(Trajectories[i].GetStop(), t0);
+
+        FSStateVector dense;
+        ASSERT_TRUE(Trajectories[i].State(FSEphemerisTime(-3000.), dense));
+        USpice::prop2b(ResultCode, ErrorMessage, FSMassConstant(gm_earth), States[i], FSEphemerisPeriod(-3000.), expected);
+        EXPECT_TRUE(IsNear(expected, dense, 1e-4, 1e-7)) << "object " << i;
+    }
+}
+
+TEST(numerical_integrator_test, Zonal_J2) {
+
+    const double R = 6378.137, J2 = 1.08262668e-3;
+    const double J[] = { J2 };
+    FZonalGravityForce Zonal(gm_earth, R, J);
+
+    const double state[6] = { 5000., -2000., 4500., 0., 0., 0. };
+    double a[3] = { 0., 0., 0. };
+    EXPECT_TRUE(Zonal.AddAcceleration(0, 0., state, a));
+
+    // Closed form
+    const double x = state[0], y = state[1], z = state[2];
+    const double r = sqrt(x * x + y * y + z * z);
+    const double k = -1.5 * J2 * gm_earth * R * R / pow(r, 5);
+    const double zz = 5. * z * z / (r * r);
+
+    EXPECT_NEAR(a[0], k * x * (1. - zz), 1e-15);
+    EXPECT_NEAR(a[1], k * y * (1. - zz), 1e-15);
+    EXPECT_NEAR(a[2], k * z * (3. - zz), 1e-15);
+
+    // An inclined orbit's node regresses
+    FNumericalPropagator Propagator(gm_earth);
+    Propagator.AddForce(MakeShared<FZonalGravityForce, ESPMode::ThreadSafe>(gm_earth, R, J));
+    EXPECT_EQ(Propagator.NumForces(), 1);
+
+    TArray<FSStateVector> States = { FSStateVector(FSDistanceVector(7000., 0., 0.), FSVelocityVector(0., 5.3, 5.3)) };
+    TArray<FSStateVector> Propagated;
+    Propagated.SetNum(1);
+
+    // Two orbits later (a = 6906 km), about 0.012 radians westward
+    EXPECT_EQ(Propagator.Propagate(States, FSEphemerisTime(0.), FSEphemerisTime(2 * 5711.), Propagated), 1);
+
+    const FSStateVector& p = Propagated[0];
+    const double hx = p.r.y.km * p.v.dz.kmps - p.r.z.km * p.v.dy.kmps;
+    const double hy = p.r.z.km * p.v.dx.kmps - p.r.x.km * p.v.dz.kmps;
+    const double node = atan2(hx, -hy);
+    EXPECT_LT(node, -.008);
+    EXPECT_GT(node, -.016);
+}
+
+TEST(numerical_integrator_test, ThirdBody_Matches_spkpos) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    MaxQ::Ephemeris::FChebyshevCacheSettings Settings;
+    Settings.ToleranceKm = 1e-3;
+    Settings.MaxBlockSeconds = FSEphemerisPeriod::Day.AsSeconds();
+
+    TSharedRef<MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> Cache = MakeShared<MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe>();
+    ASSERT_TRUE(Cache->Build({ TEXT("FAKEBODY9994") }, TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"), et0, et0 + FSEphemerisPeriod::Day, Settings, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage));
+
+    const double gm = 1000.;
+    FThirdBodyForce ThirdBody(Cache, TEXT("FAKEBODY9994"), gm);
+    EXPECT_TRUE(ThirdBody.IsValid());
+    EXPECT_FALSE(FThirdBodyForce(Cache, TEXT("FAKEBODY9993"), gm).IsValid());
+
+    const FSEphemerisTime et = et0 + 0.5 * FSEphemerisPeriod::Day;
+    const double state[6] = { 7000., 100., -300., 0., 0., 0. };
+    double a[3] = { 0., 0., 0. };
+    EXPECT_TRUE(ThirdBody.AddAcceleration(0, et.seconds, state, a));
+
+    FSDistanceVector s;
+    FSEphemerisPeriod lt;
+    USpice::spkpos(ResultCode, ErrorMessage, et, s, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    const double sv[3] = { s.x.km, s.y.km, s.z.km };
+    const double d[3] = { sv[0] - state[0], sv[1] - state[1], sv[2] - state[2] };
+    const double dm = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    const double sm = sqrt(sv[0] * sv[0] + sv[1] * sv[1] + sv[2] * sv[2]);
+    for (int32 j = 0; j < 3; ++j)
+    {
+        const double expected = gm * (d[j] / (dm * dm * dm) - sv[j] / (sm * sm * sm));
+        EXPECT_NEAR(a[j], expected, 1e-6 * FMath::Abs(expected) + 1e-18) << "component " << j;
+    }
+
+    // Outside the cache's span, the object fails
+    FNumericalPropagator Propagator(1.);
+    Propagator.AddForce(MakeShared<FThirdBodyForce, ESPMode::ThreadSafe>(Cache, TEXT("FAKEBODY9994"), gm));
+
+    TArray<FSStateVector> States = TestStates();
+    TArray<FSStateVector> Propagated;
+    Propagated.SetNum(States.Num());
+    TArray<bool> valid;
+    valid.SetNum(States.Num());
+    EXPECT_EQ(Propagator.Propagate(States, et0 + 2 * FSEphemerisPeriod::Day, et0 + 3 * FSEphemerisPeriod::Day, Propagated, {}, valid), 0);
+    EXPECT_FALSE(valid[0]);
+    EXPECT_EQ(Propagated[0].r.x.km, 0.);
+
+    USpice::clear_all();
+}
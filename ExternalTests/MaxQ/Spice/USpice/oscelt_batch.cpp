@@ -0,0 +1,129 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceTwoBody.h"
+
+using namespace MaxQ::Orbits;
+
+static const double gm_earth = 398600.4418;
+
+static TArray<FSStateVector> TestStates(const FSEphemerisTime& et)
+{
+    TArray<FSStateVector> States;
+
+    // rp, ecc, inc, lnode, argp, m0
+    const double elts[][6] = {
+        {  6778.,   0.001, 0.90, 1.0,  0.3, 0.2 },
+        {  7000.,   0.7,   1.10, 4.0,  4.7, 3.0 },
+        { 26600.,   0.01,  0.96, 2.5,  1.2, 5.0 },
+        {  6800.,   1.5,   0.40, 0.1,  2.0, 0.5 },
+        {  7200.,   2.2,   2.50, 5.0,  0.7, -0.3 },
+        { 42164.,   0.2,   0.,   0.,   1.,  1.0 },
+        {  8000.,   0.3,   3.14159265358979323846, 0.5,  0.5, 0.5 }
+    };
+
+    for (const auto& e : elts)
+    {
+        FSConicElements Orbit(FSDistance(e[0]), e[1], FSAngle(e[2]), FSAngle(e[3]), FSAngle(e[4]), FSAngle(e[5]), et, FSMassConstant(gm_earth));
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        FSStateVector State;
+        USpice::conics(ResultCode, ErrorMessage, Orbit, et + FSEphemerisPeriod(600.), State);
+        States.Add(State);
+    }
+
+    return States;
+}
+
+static void ExpectNearElements(const FSConicElements& expected, const FSConicElements& actual)
+{
+    double e[8]; expected.CopyTo(e);
+    double a[8]; actual.CopyTo(a);
+
+    EXPECT_NEAR(a[0], e[0], 1e-9 * e[0]);
+    for (int i = 1; i < 8; ++i)
+    {
+        EXPECT_NEAR(a[i], e[i], 1e-9 * FMath::Max(1., FMath::Abs(e[i]))) << "element " << i;
+    }
+}
+
+TEST(oscelt_batch_test, Matches_oscelt) {
+
+    USpice::init_all();
+
+    const FSEphemerisTime et(1e8);
+    TArray<FSStateVector> States = TestStates(et);
+
+    // Degenerate:  zero velocity, and radial
+    States.Add(FSStateVector(FSDistanceVector(7000., 0., 0.), FSVelocityVector()));
+    States.Add(FSStateVector(FSDistanceVector(7000., 0., 0.), FSVelocityVector(FSSpeed(1.), FSSpeed(0.), FSSpeed(0.))));
+
+    TArray<FSConicElements> Elements;
+    Elements.SetNum(States.Num());
+    TArray<bool> Valid;
+    Valid.SetNum(States.Num());
+
+    EXPECT_EQ(OsceltBatch(States, et, FSMassConstant(gm_earth), Elements, Valid), States.Num() - 2);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    for (int32 i = 0; i < States.Num() - 2; ++i)
+    {
+        EXPECT_TRUE(Valid[i]);
+
+        FSConicElements expected;
+        USpice::oscelt(ResultCode, ErrorMessage, States[i], et, FSMassConstant(gm_earth), expected);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+        ExpectNearElements(expected, Elements[i]);
+    }
+
+    EXPECT_FALSE(Valid[States.Num() - 2]);
+    EXPECT_FALSE(Valid[States.Num() - 1]);
+    EXPECT_EQ(Elements.Last().PerifocalDistance.km, 0.);
+
+    // Non-positive GM
+    EXPECT_EQ(OsceltBatch(States, et, FSMassConstant(0.), Elements), 0);
+}
+
+TEST(oscelt_batch_test, Matches_oscltx) {
+
+    USpice::init_all();
+
+    const FSEphemerisTime et(-2e8);
+    TArray<FSStateVector> States = TestStates(et);
+
+    const int32 Num = States.Num();
+    TArray<FSConicElements> Elements; Elements.SetNum(Num);
+    TArray<FSAngle> nu; nu.SetNum(Num);
+    TArray<FSDistance> a; a.SetNum(Num);
+    TArray<FSEphemerisPeriod> tau; tau.SetNum(Num);
+
+    EXPECT_EQ(OscltxBatch(States, et, FSMassConstant(gm_earth), Elements, nu, a, tau), Num);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        FSConicElements expected;
+        FSAngle expected_nu;
+        FSDistance expected_a;
+        FSEphemerisPeriod expected_tau;
+        USpice::oscltx(ResultCode, ErrorMessage, States[i], et, FSMassConstant(gm_earth), expected, expected_nu, expected_a, expected_tau);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        ExpectNearElements(expected, Elements[i]);
+        EXPECT_NEAR(nu[i].AsSpiceDouble(), expected_nu.AsSpiceDouble(), 1e-9) << "object " << i;
+        EXPECT_NEAR(a[i].km, expected_a.km, 1e-9 * FMath::Abs(expected_a.km)) << "object " << i;
+        EXPECT_NEAR(tau[i].seconds, expected_tau.seconds, 1e-9 * FMath::Max(1., expected_tau.seconds)) << "object " << i;
+    }
+
+    // Only some of the outputs
+    EXPECT_EQ(OscltxBatch(States, et, FSMassConstant(gm_earth), Elements, {}, a, {}), Num);
+}
@@ -0,0 +1,180 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// partition_window.cpp
+//
+// Purpose:  Splitting gf confinement windows into overlapping pieces, and
+// merging the pieces' results (SpiceGeometryFinder.h).
+//------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceGeometryFinder.h"
+
+TEST(partition_window_test, SingleSegment_Is_SplitWithOverlap) {
+
+    TArray<FSEphemerisTimeWindowSegment> Window{ FSEphemerisTimeWindowSegment(0., 400.) };
+
+    auto Pieces = MaxQ::GeometryFinder::PartitionWindow(Window, 4, FSEphemerisPeriod(10.));
+
+    ASSERT_EQ(Pieces.Num(), 4);
+    EXPECT_DOUBLE_EQ(Pieces[0][0].start.seconds, 0.);
+    EXPECT_DOUBLE_EQ(Pieces[0][0].stop.seconds, 110.);
+    EXPECT_DOUBLE_EQ(Pieces[1][0].start.seconds, 90.);
+    EXPECT_DOUBLE_EQ(Pieces[1][0].stop.seconds, 210.);
+    EXPECT_DOUBLE_EQ(Pieces[3][0].start.seconds, 290.);
+    EXPECT_DOUBLE_EQ(Pieces[3][0].stop.seconds, 400.);
+}
+
+
+TEST(partition_window_test, Pieces_Stay_InsideWindow) {
+
+    TArray<FSEphemerisTimeWindowSegment> Window{
+        FSEphemerisTimeWindowSegment(0., 100.),
+        FSEphemerisTimeWindowSegment(1000., 1100.)
+    };
+
+    auto Pieces = MaxQ::GeometryFinder::PartitionWindow(Window, 2, FSEphemerisPeriod(10.));
+
+    ASSERT_EQ(Pieces.Num(), 2);
+    for (const auto& Piece : Pieces)
+    {
+        for (const auto& Segment : Piece)
+        {
+            bool bInFirst = Segment.start.seconds >= 0. && Segment.stop.seconds <= 100.;
+            bool bInSecond = Segment.start.seconds >= 1000. && Segment.stop.seconds <= 1100.;
+            EXPECT_TRUE(bInFirst || bInSecond);
+        }
+    }
+}
+
+
+TEST(partition_window_test, Union_Merges_AcrossPartitions) {
+
+    TArray<TArray<FSEphemerisTimeWindowSegment>> Results{
+        { FSEphemerisTimeWindowSegment(10., 20.), FSEphemerisTimeWindowSegment(95., 110.) },
+        { FSEphemerisTimeWindowSegment(90., 130.), FSEphemerisTimeWindowSegment(150., 160.) }
+    };
+
+    auto Merged = MaxQ::GeometryFinder::UnionWindows(Results);
+
+    ASSERT_EQ(Merged.Num(), 3);
+    EXPECT_DOUBLE_EQ(Merged[0].start.seconds, 10.);
+    EXPECT_DOUBLE_EQ(Merged[0].stop.seconds, 20.);
+    EXPECT_DOUBLE_EQ(Merged[1].start.seconds, 90.);
+    EXPECT_DOUBLE_EQ(Merged[1].stop.seconds, 130.);
+    EXPECT_DOUBLE_EQ(Merged[2].start.seconds, 150.);
+    EXPECT_DOUBLE_EQ(Merged[2].stop.seconds, 160.);
+}
+
+
+TEST(partition_window_test, Union_Keeps_Points_Once) {
+
+    // The same local extremum, found by two overlapping pieces
+    TArray<TArray<FSEphemerisTimeWindowSegment>> Results{
+        { FSEphemerisTimeWindowSegment(10., 10.), FSEphemerisTimeWindowSegment(100., 100.) },
+        { FSEphemerisTimeWindowSegment(100. + 2.e-6, 100. + 2.e-6), FSEphemerisTimeWindowSegment(100.5, 100.5), FSEphemerisTimeWindowSegment(200., 200.) }
+    };
+
+    auto Merged = MaxQ::GeometryFinder::UnionWindows(Results, 1.e-5);
+
+    ASSERT_EQ(Merged.Num(), 4);
+    EXPECT_DOUBLE_EQ(Merged[0].start.seconds, 10.);
+    EXPECT_DOUBLE_EQ(Merged[1].start.seconds, 100.);
+    EXPECT_DOUBLE_EQ(Merged[1].stop.seconds, 100.);
+    EXPECT_DOUBLE_EQ(Merged[2].start.seconds, 100.5);
+    EXPECT_DOUBLE_EQ(Merged[3].start.seconds, 200.);
+
+    // Without a tolerance they're different points
+    EXPECT_EQ(MaxQ::GeometryFinder::UnionWindows(Results).Num(), 5);
+}
+
+
+TEST(partition_window_test, Parallel_Extrema_Match_Serial) {
+
+    USpice::init_all();
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    TArray<FSEphemerisTimeWindowSegment> cnfine{ FSEphemerisTimeWindowSegment(et0, et0 + 4 * FSEphemerisPeriod::Day) };
+
+    for (ES_RelationalOperator relate : { ES_RelationalOperator::LOCMAX, ES_RelationalOperator::LOCMIN, ES_RelationalOperator::ABSMAX, ES_RelationalOperator::ABSMIN })
+    {
+        TArray<FSEphemerisTimeWindowSegment> Expected;
+        USpice::gfdist(ResultCode, ErrorMessage, Expected, cnfine, FSEphemerisPeriod::Hour, FSDistance(0.), FSDistance(0.),
+            TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), relate);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        // More pieces than extrema, so some fall in an overlap.  ABSMAX and
+        // ABSMIN aren't split.
+        TArray<FSEphemerisTimeWindowSegment> results;
+        MaxQ::GeometryFinder::GfdistParallel(results, cnfine, FSEphemerisPeriod::Hour, FSDistance(0.), FSDistance(0.),
+            TEXT("FAKEBODY9994"), ES_AberrationCorrectionWithTransmissions::None, TEXT("FAKEBODY9995"), relate, 16, &ResultCode, &ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+        ASSERT_EQ(results.Num(), Expected.Num());
+        for (int i = 0; i < results.Num(); ++i)
+        {
+            EXPECT_NEAR(results[i].start.seconds, Expected[i].start.seconds, 1.e-3);
+            EXPECT_NEAR(results[i].stop.seconds, Expected[i].stop.seconds, 1.e-3);
+        }
+    }
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(partition_window_test, Partial_Results_Stream_InOrder) {
+
+    TArray<FSEphemerisTimeWindowSegment> Window{ FSEphemerisTimeWindowSegment(0., 400.) };
+    auto Pieces = MaxQ::GeometryFinder::PartitionWindow(Window, 4, FSEphemerisPeriod(10.));
+    ASSERT_EQ(Pieces.Num(), 4);
+
+    // Pieces' results, each inside its (overlapping) piece
+    TArray<TArray<FSEphemerisTimeWindowSegment>> Results{
+        { FSEphemerisTimeWindowSegment(10., 20.), FSEphemerisTimeWindowSegment(100., 110.) },
+        { FSEphemerisTimeWindowSegment(95., 130.), FSEphemerisTimeWindowSegment(150., 160.), FSEphemerisTimeWindowSegment(205., 210.) },
+        { FSEphemerisTimeWindowSegment(190., 220.) },
+        { FSEphemerisTimeWindowSegment(300., 320.), FSEphemerisTimeWindowSegment(390., 400.) }
+    };
+
+    MaxQ::GeometryFinder::FGfPartialResults Partial(Pieces);
+    TArray<FSEphemerisTimeWindowSegment> Streamed;
+
+    // Out of order:  nothing is final until the first piece is in
+    EXPECT_FALSE(Partial.Add(2, TArray<FSEphemerisTimeWindowSegment>(Results[2]), Streamed));
+    EXPECT_FALSE(Partial.Add(1, TArray<FSEphemerisTimeWindowSegment>(Results[1]), Streamed));
+    EXPECT_EQ(Streamed.Num(), 0);
+    EXPECT_DOUBLE_EQ(Partial.Through().seconds, 0.);
+
+    EXPECT_TRUE(Partial.Add(0, TArray<FSEphemerisTimeWindowSegment>(Results[0]), Streamed));
+    ASSERT_EQ(Streamed.Num(), 4);
+    EXPECT_DOUBLE_EQ(Streamed[1].start.seconds, 95.);
+    EXPECT_DOUBLE_EQ(Streamed[1].stop.seconds, 130.);
+    EXPECT_DOUBLE_EQ(Streamed[3].start.seconds, 190.);
+    EXPECT_DOUBLE_EQ(Streamed[3].stop.seconds, 220.);
+    EXPECT_DOUBLE_EQ(Partial.Through().seconds, 290.);
+    EXPECT_FALSE(Partial.IsComplete());
+
+    EXPECT_TRUE(Partial.Add(3, TArray<FSEphemerisTimeWindowSegment>(Results[3]), Streamed));
+    EXPECT_TRUE(Partial.IsComplete());
+    EXPECT_DOUBLE_EQ(Partial.Through().seconds, 400.);
+
+    // Together, the search's results:  each segment once, merged at the
+    // boundaries
+    auto Merged = MaxQ::GeometryFinder::UnionWindows(Results);
+    ASSERT_EQ(Streamed.Num(), Merged.Num());
+    for (int i = 0; i < Merged.Num(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(Streamed[i].start.seconds, Merged[i].start.seconds);
+        EXPECT_DOUBLE_EQ(Streamed[i].stop.seconds, Merged[i].stop.seconds);
+    }
+}
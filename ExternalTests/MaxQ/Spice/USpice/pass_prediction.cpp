@@ -0,0 +1,112 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpicePassPrediction.h"
+
+using namespace MaxQ::Orbits;
+
+static FSGP4Propagator SunSynchronous(FSEphemerisTime& epoch)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSTwoLineElements elems;
+    USpice::getelm(ResultCode, ErrorMessage, epoch, elems,
+        TEXT("1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999"),
+        TEXT("2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544"));
+
+    double geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+    return FSGP4Propagator(FSTLEGeophysicalConstants(geophs), elems, &ResultCode, &ErrorMessage);
+}
+
+static FGroundStation Station(double LatitudeDegrees, double LongitudeDegrees, double MinElevationDegrees)
+{
+    FGroundStation Station;
+    Station.Latitude = FMath::DegreesToRadians(LatitudeDegrees);
+    Station.Longitude = FMath::DegreesToRadians(LongitudeDegrees);
+    Station.Altitude = 0.2;
+    Station.MinElevation = FMath::DegreesToRadians(MinElevationDegrees);
+    return Station;
+}
+
+
+TEST(pass_prediction_test, Matches_Dense_Sampling) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    FSEphemerisTime epoch;
+    TArray<FSGP4Propagator> Catalog { SunSynchronous(epoch) };
+    ASSERT_TRUE(Catalog[0].IsValid());
+
+    TArray<FGroundStation> Stations { Station(64.8, -147.7, 5.), Station(-0.5, 30., 10.), Station(78.2, 15.4, 0.) };
+
+    const double Start = epoch.seconds, Stop = epoch.seconds + 86400.;
+    FPassPredictions Predictions;
+    EXPECT_TRUE(PredictPasses(Catalog, Stations, FSEphemerisTime(Start), FSEphemerisTime(Stop), Predictions, FPassPredictionSettings(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_EQ(Predictions.Windows.Num(), 3);
+    EXPECT_GT(Predictions.Passes.Num(), 0);
+
+    FSEphemerisPeriod delta;
+    USpice::deltet(ResultCode, ErrorMessage, Start, ES_EpochType::ET, delta);
+
+    for (int32 s = 0; s < Stations.Num(); ++s)
+    {
+        const MaxQ::GeometryFinder::FSWindow& Window = Predictions.Window(0, s);
+
+        // Every second that's in view is in the window (and vice versa),
+        // except within a second of AOS/LOS
+        int32 Rises = 0;
+        bool bWasUp = false;
+        for (double et = Start; et <= Stop; et += 1.)
+        {
+            const bool bUp = StationElevation(Catalog[0], Stations[s], et, delta.seconds) > Stations[s].MinElevation;
+            Rises += bUp && !bWasUp ? 1 : 0;
+            bWasUp = bUp;
+
+            if (bUp != Window.Contains(et))
+            {
+                EXPECT_TRUE(Window.Contains(et - 1.) != Window.Contains(et + 1.)) << "station " << s << " et " << et;
+            }
+        }
+        EXPECT_EQ(Window.Num(), Rises);
+    }
+
+    for (const FPass& Pass : Predictions.Passes)
+    {
+        EXPECT_LE(Pass.AOS, Pass.MaxElevationTime);
+        EXPECT_LE(Pass.MaxElevationTime, Pass.LOS);
+        EXPECT_GE(Pass.MaxElevation, Stations[Pass.Station].MinElevation);
+        EXPECT_NEAR(StationElevation(Catalog[0], Stations[Pass.Station], Pass.MaxElevationTime, delta.seconds), Pass.MaxElevation, 1.e-9);
+        EXPECT_NEAR(StationElevation(Catalog[0], Stations[Pass.Station], Pass.AOS, delta.seconds), Stations[Pass.Station].MinElevation, 1.e-5);
+    }
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(pass_prediction_test, Rejects_Bad_Settings) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FPassPredictions Predictions;
+    FPassPredictionSettings Settings;
+    Settings.Step = 0.;
+    EXPECT_FALSE(PredictPasses(TArrayView<const FSGP4Propagator>(), TArrayView<const FGroundStation>(), FSEphemerisTime(0.), FSEphemerisTime(1.), Predictions, Settings, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+
+    EXPECT_FALSE(PredictPasses(TArrayView<const FSGP4Propagator>(), TArrayView<const FGroundStation>(), FSEphemerisTime(1.), FSEphemerisTime(0.), Predictions, FPassPredictionSettings(), &ResultCode, &ErrorMessage));
+}
@@ -0,0 +1,71 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpicePhotometry.h"
+
+using namespace MaxQ::Math;
+
+
+TEST(photometry_test, Standard_Geometry) {
+
+    // 1000 km away, at 90 degrees phase:  the standard magnitude
+    EXPECT_NEAR(VisualMagnitude(4.f, 1000., HALF_PI), 4.f, 1.e-5);
+
+    // 10x the range:  5 magnitudes fainter
+    EXPECT_NEAR(VisualMagnitude(4.f, 10000., HALF_PI), 9.f, 1.e-5);
+
+    // Full phase:  pi times brighter
+    EXPECT_NEAR(VisualMagnitude(4.f, 1000., 0.), 4.f - 2.5 * log10(PI), 1.e-5);
+
+    // New, and umbra
+    EXPECT_EQ(VisualMagnitude(4.f, 1000., PI), UnlitMagnitude);
+    EXPECT_EQ(VisualMagnitude(4.f, 1000., HALF_PI, 1.f), UnlitMagnitude);
+
+    // Half the Sun hidden
+    EXPECT_NEAR(VisualMagnitude(4.f, 1000., HALF_PI, .5f), 4.f + 2.5 * log10(2.), 1.e-5);
+}
+
+
+TEST(photometry_test, Batch_Matches_Phase_Angles) {
+
+    const FSDistanceVector Sun(1.5e8, 0., 0.);
+    const FSDistanceVector Observer(6378., 0., 0.);
+
+    // Overhead toward the Sun (full), off to the side (quarter), and on the
+    // far side of the observer from the Sun (new-ish)
+    TArray<double> X{ 7378., 6378., 5378. }, Y{ 0., 1000., 0. }, Z{ 0., 0., 0. };
+    TArray<float> Phase, Range, Magnitude;
+    Phase.SetNum(3); Range.SetNum(3); Magnitude.SetNum(3);
+
+    FPhotometryBatch Out;
+    Out.Phase = Phase;
+    Out.Range = Range;
+    Out.Magnitude = Magnitude;
+
+    const TArray<float> Standards{ 4.f, 4.f, -1.8f };
+    ASSERT_TRUE(Photometry(Sun, Observer, FConstVectorBatch(X, Y, Z), Out, 4.f, Standards));
+
+    EXPECT_NEAR(Phase[0], PI, 1.e-6);
+    EXPECT_NEAR(Phase[1], HALF_PI, 1.e-5);
+    EXPECT_NEAR(Phase[2], 0., 1.e-6);
+    EXPECT_NEAR(Range[0], 1000., 1.e-3);
+    EXPECT_NEAR(Range[1], 1000., 1.e-3);
+
+    EXPECT_EQ(Magnitude[0], UnlitMagnitude);
+    EXPECT_NEAR(Magnitude[1], VisualMagnitude(4.f, Range[1], Phase[1]), 1.e-4);
+    // Its own standard magnitude, at full phase
+    EXPECT_NEAR(Magnitude[2], -1.8 - 2.5 * log10(PI), 1.e-4);
+
+    // Any output can be left out, but sizes must match
+    FPhotometryBatch PhaseOnly;
+    PhaseOnly.Phase = Phase;
+    EXPECT_TRUE(Photometry(Sun, Observer, FConstVectorBatch(X, Y, Z), PhaseOnly));
+    PhaseOnly.Phase = TArrayView<float>(Phase.GetData(), 2);
+    EXPECT_FALSE(Photometry(Sun, Observer, FConstVectorBatch(X, Y, Z), PhaseOnly));
+}
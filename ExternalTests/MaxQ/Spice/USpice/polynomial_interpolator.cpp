@@ -0,0 +1,127 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceInterpolation.h"
+
+using namespace MaxQ::Math;
+
+static const TArray<double> xvals = { -1., 0., 1.5, 2., 3.25, 5. };
+
+static double Channel(int32 c, double x) { return sin(.3 * x + c) * (1. + .1 * c) + .05 * x * x; }
+static double ChannelRate(int32 c, double x) { return .3 * cos(.3 * x + c) * (1. + .1 * c) + .1 * x; }
+
+TEST(polynomial_interpolator_test, Lagrange_Matches_lgrind) {
+
+    USpice::init_all();
+
+    const int32 NumChannels = 5;
+    TArray<double> yvals;
+    for (int32 c = 0; c < NumChannels; ++c)
+    {
+        for (double x : xvals) yvals.Add(Channel(c, x));
+    }
+
+    FPolynomialInterpolator Interpolator;
+    ASSERT_TRUE(Interpolator.BuildLagrange(xvals, yvals, NumChannels));
+    EXPECT_EQ(Interpolator.NumChannels(), NumChannels);
+    EXPECT_EQ(Interpolator.NumCoefficients(), xvals.Num());
+
+    const TArray<double> xs = { -2., -1., .3, 1.7, 2.9, 4.4, 5., 6. };
+    TArray<double> p, dp;
+    p.SetNum(xs.Num() * NumChannels);
+    dp.SetNum(xs.Num() * NumChannels);
+    Interpolator.Evaluate(xs, p, dp);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    for (int32 c = 0; c < NumChannels; ++c)
+    {
+        const TArray<double> channel(&yvals[c * xvals.Num()], xvals.Num());
+        for (int32 i = 0; i < xs.Num(); ++i)
+        {
+            double expected, dexpected;
+            USpice::lgrind(ResultCode, ErrorMessage, xvals, channel, xs[i], expected, dexpected);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            EXPECT_NEAR(p[c * xs.Num() + i], expected, 1e-12 * FMath::Max(1., FMath::Abs(expected))) << c << " " << xs[i];
+            EXPECT_NEAR(dp[c * xs.Num() + i], dexpected, 1e-12 * FMath::Max(1., FMath::Abs(dexpected))) << c << " " << xs[i];
+        }
+    }
+
+    // One point, every channel, no derivatives
+    TArray<double> one;
+    one.SetNum(NumChannels);
+    Interpolator.Evaluate(1.7, one);
+    for (int32 c = 0; c < NumChannels; ++c) EXPECT_DOUBLE_EQ(one[c], p[c * xs.Num() + 3]);
+}
+
+TEST(polynomial_interpolator_test, Hermite_Matches_hrmint) {
+
+    const int32 NumChannels = 3;
+    TArray<double> yvals;
+    for (int32 c = 0; c < NumChannels; ++c)
+    {
+        for (double x : xvals)
+        {
+            yvals.Add(Channel(c, x));
+            yvals.Add(ChannelRate(c, x));
+        }
+    }
+
+    FPolynomialInterpolator Interpolator;
+    ASSERT_TRUE(Interpolator.BuildHermite(xvals, yvals, NumChannels));
+    EXPECT_EQ(Interpolator.NumCoefficients(), 2 * xvals.Num());
+
+    const TArray<double> xs = { -1., .3, 1.7, 2.9, 4.4 };
+    TArray<double> p, dp;
+    p.SetNum(xs.Num() * NumChannels);
+    dp.SetNum(xs.Num() * NumChannels);
+    Interpolator.Evaluate(xs, p, dp);
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    for (int32 c = 0; c < NumChannels; ++c)
+    {
+        const TArray<double> channel(&yvals[c * 2 * xvals.Num()], 2 * xvals.Num());
+        for (int32 i = 0; i < xs.Num(); ++i)
+        {
+            double expected, dexpected;
+            USpice::hrmint(ResultCode, ErrorMessage, xvals, channel, xs[i], expected, dexpected);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            EXPECT_NEAR(p[c * xs.Num() + i], expected, 1e-12 * FMath::Max(1., FMath::Abs(expected))) << c << " " << xs[i];
+            EXPECT_NEAR(dp[c * xs.Num() + i], dexpected, 1e-12 * FMath::Max(1., FMath::Abs(dexpected))) << c << " " << xs[i];
+        }
+    }
+
+    // At a node, the given value and derivative
+    EXPECT_NEAR(p[1 * xs.Num() + 0], Channel(1, -1.), 1e-14);
+    EXPECT_NEAR(dp[1 * xs.Num() + 0], ChannelRate(1, -1.), 1e-13);
+}
+
+TEST(polynomial_interpolator_test, Invalid_Input) {
+
+    FPolynomialInterpolator Interpolator;
+
+    // Repeated abscissa
+    const TArray<double> repeated = { 0., 1., 1. };
+    EXPECT_FALSE(Interpolator.BuildLagrange(repeated, { 1., 2., 3. }));
+    EXPECT_FALSE(Interpolator.IsValid());
+
+    // Wrong sizes
+    EXPECT_FALSE(Interpolator.BuildLagrange(xvals, { 1., 2. }));
+    EXPECT_FALSE(Interpolator.BuildHermite(xvals, TArray<double>(xvals), 1));
+
+    EXPECT_TRUE(Interpolator.BuildLagrange({ 0., 1. }, { 1., 3. }));
+    EXPECT_TRUE(Interpolator.IsValid());
+    Interpolator.Reset();
+    EXPECT_FALSE(Interpolator.IsValid());
+}
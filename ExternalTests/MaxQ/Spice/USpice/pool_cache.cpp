@@ -0,0 +1,62 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceData.h"
+#include "SpiceCore.h"
+
+
+TEST(pool_cache_test, Bodvrd_Sees_Pool_Updates) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("BODY9994_MAXQ_CACHE_TEST"), { 1., 2., 3. });
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    // Twice, so the second comes from the cache
+    for (int i = 0; i < 2; ++i)
+    {
+        FSDimensionlessVector v = MaxQ::Data::Bodvrd<FSDimensionlessVector>(TEXT("FAKEBODY9994"), TEXT("MAXQ_CACHE_TEST"), &ResultCode, &ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_DOUBLE_EQ(v.x, 1.);
+        EXPECT_DOUBLE_EQ(v.z, 3.);
+
+        FSDimensionlessVector w = MaxQ::Data::Bodvcd<FSDimensionlessVector>(9994, TEXT("MAXQ_CACHE_TEST"), &ResultCode, &ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_DOUBLE_EQ(w.y, 2.);
+
+        FSDimensionlessVector g = MaxQ::Data::Gdpool<FSDimensionlessVector>(TEXT("BODY9994_MAXQ_CACHE_TEST"), &ResultCode, &ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_DOUBLE_EQ(g.z, 3.);
+    }
+
+    // pdpool notifies the cache
+    USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("BODY9994_MAXQ_CACHE_TEST"), { 4., 5., 6. });
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FSDimensionlessVector v = MaxQ::Data::Bodvrd<FSDimensionlessVector>(TEXT("FAKEBODY9994"), TEXT("MAXQ_CACHE_TEST"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(v.x, 4.);
+
+    double g = MaxQ::Data::Gdpool(TEXT("BODY9994_MAXQ_CACHE_TEST"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(g, 4.);
+
+    // ...and so does clearing the pool
+    MaxQ::Core::ClearAll();
+    MaxQ::Data::Bodvrd<FSDimensionlessVector>(TEXT("FAKEBODY9994"), TEXT("MAXQ_CACHE_TEST"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+}
@@ -0,0 +1,89 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpicePoolSnapshot.h"
+#include "SpiceData.h"
+#include "SpiceCore.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+
+TEST(pool_snapshot_test, Save_And_Load) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("MAXQ_SNAPSHOT_NUMBERS"), { 1., 2., 3. });
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    TArray<uint8> Snapshot;
+    EXPECT_TRUE(MaxQ::Data::SavePoolSnapshot(Snapshot, &ResultCode, &ErrorMessage));
+    EXPECT_GT(Snapshot.Num(), 0);
+
+    MaxQ::Core::ClearAll();
+    MaxQ::Data::Gdpool(TEXT("MAXQ_SNAPSHOT_NUMBERS"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    EXPECT_TRUE(MaxQ::Data::LoadPoolSnapshot(Snapshot, &ResultCode, &ErrorMessage));
+    FSDimensionlessVector v = MaxQ::Data::Gdpool<FSDimensionlessVector>(TEXT("MAXQ_SNAPSHOT_NUMBERS"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(v.z, 3.);
+
+    // Garbage is rejected
+    TArray<uint8> Garbage{ 1, 2, 3, 4, 5, 6, 7, 8 };
+    EXPECT_FALSE(MaxQ::Data::LoadPoolSnapshot(Garbage, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+
+TEST(pool_snapshot_test, FurnshWithSnapshot_Restores_Text_Kernels) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    const FString Directory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MaxQTests"), TEXT("PoolSnapshot")));
+    const FString KernelPath = FPaths::Combine(Directory, TEXT("snapshot_test.tpc"));
+    const FString Kernel = FString::Printf(
+        TEXT("KPL/PCK\n\\begindata\nBODY9994_MAXQ_SNAPSHOT = ( %d )\nMAXQ_SNAPSHOT_NAME = 'SNAPPY'\n\\begintext\n"), (int)(FDateTime::UtcNow().GetTicks() % 1000));
+    ASSERT_TRUE(FFileHelper::SaveStringToFile(Kernel, *KernelPath));
+
+    // (The value changes every run, so the first pass always builds a new
+    // snapshot.)  Once to build the snapshot, once to restore from it
+    double First = 0.;
+    for (int i = 0; i < 2; ++i)
+    {
+        MaxQ::Core::ClearAll();
+
+        EXPECT_TRUE(MaxQ::Data::FurnshWithSnapshot({ KernelPath }, Directory, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+        double Value = MaxQ::Data::Gdpool(TEXT("BODY9994_MAXQ_SNAPSHOT"), &ResultCode, &ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        if (i == 0) First = Value;
+        EXPECT_DOUBLE_EQ(Value, First);
+
+        TArray<FString> Names;
+        bool bFound = false;
+        USpice::gcpool(ResultCode, ErrorMessage, Names, bFound, TEXT("MAXQ_SNAPSHOT_NAME"), 0, 1);
+        EXPECT_TRUE(bFound);
+        ASSERT_EQ(Names.Num(), 1);
+        EXPECT_EQ(Names[0], TEXT("SNAPPY"));
+    }
+
+    // After a restore, the text kernel isn't in CSPICE's kernel list
+    int count = -1;
+    USpice::ktotal(count, (int32)ES_KernelType::TEXT);
+    EXPECT_EQ(count, 0);
+
+    USpice::init_all();
+}
@@ -0,0 +1,102 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpicePoolWatch.h"
+
+using namespace MaxQ::Data;
+
+TEST(pool_watch_test, Pool_Writes) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    int32 Calls = 0;
+    FString Changed;
+    FDelegateHandle Handle = WatchPool(TEXT("POOL_WATCH_TEST"), { TEXT("POOL_WATCH_A"), TEXT("POOL_WATCH_B") },
+        FOnPoolChanged::FDelegate::CreateLambda([&](const FString& Agent) { ++Calls; Changed = Agent; }),
+        &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_TRUE(Handle.IsValid());
+
+    // Watching isn't a change
+    NotifyPoolWatchers();
+    EXPECT_EQ(Calls, 0);
+
+    USpice::pdpool(ResultCode, ErrorMessage, TEXT("POOL_WATCH_A"), 1.);
+    EXPECT_EQ(Calls, 1);
+    EXPECT_EQ(Changed, TEXT("POOL_WATCH_TEST"));
+
+    USpice::pcpool(ResultCode, ErrorMessage, TEXT("POOL_WATCH_B"), TEXT("B"));
+    EXPECT_EQ(Calls, 2);
+
+    // Other variables aren't watched
+    USpice::pipool(ResultCode, ErrorMessage, TEXT("POOL_WATCH_C"), 1);
+    EXPECT_EQ(Calls, 2);
+
+    // Everything's deleted
+    USpice::clear_all();
+    EXPECT_EQ(Calls, 3);
+
+    UnwatchPool(TEXT("POOL_WATCH_TEST"), Handle);
+    USpice::pdpool(ResultCode, ErrorMessage, TEXT("POOL_WATCH_A"), 2.);
+    EXPECT_EQ(Calls, 3);
+}
+
+TEST(pool_watch_test, Kernel_Loads) {
+
+    USpice::init_all();
+
+    int32 Calls = 0;
+    FDelegateHandle Handle = WatchPoolVariable(TEXT("BODY9994_RADII"),
+        FOnPoolChanged::FDelegate::CreateLambda([&](const FString& Agent) { ++Calls; }));
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    EXPECT_EQ(Calls, 1);
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    USpice::pdpool(ResultCode, ErrorMessage, TEXT("BODY9994_MAXQ_WATCH_TEST"), 1.);
+    EXPECT_EQ(Calls, 1);
+
+    // Loading it again sets it again
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    EXPECT_EQ(Calls, 2);
+
+    UnwatchPool(TEXT("BODY9994_RADII"), Handle);
+}
+
+TEST(pool_watch_test, Delegates_Change_Pool) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    // A writes B, which B's watcher hears about after A's broadcast
+    int32 CallsA = 0, CallsB = 0;
+    FDelegateHandle HandleA = WatchPoolVariable(TEXT("POOL_WATCH_A"),
+        FOnPoolChanged::FDelegate::CreateLambda([&](const FString& Agent)
+            {
+                ++CallsA;
+                ES_ResultCode ResultCode;
+                FString ErrorMessage;
+                USpice::pdpool(ResultCode, ErrorMessage, TEXT("POOL_WATCH_B"), CallsA);
+            }));
+    FDelegateHandle HandleB = WatchPoolVariable(TEXT("POOL_WATCH_B"),
+        FOnPoolChanged::FDelegate::CreateLambda([&](const FString& Agent) { ++CallsB; }));
+
+    USpice::pdpool(ResultCode, ErrorMessage, TEXT("POOL_WATCH_A"), 1.);
+    EXPECT_EQ(CallsA, 1);
+    EXPECT_EQ(CallsB, 1);
+
+    UnwatchPool(TEXT("POOL_WATCH_A"), HandleA);
+    UnwatchPool(TEXT("POOL_WATCH_B"), HandleB);
+}
@@ -0,0 +1,199 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceProceduralSystem.h"
+
+using namespace MaxQ::Ephemeris;
+
+// Writing needs spkopn, which needs a project directory the test host doesn't
+// have, so these only propagate.
+
+static const double gm_star = 1.e8;
+static const double gm_planet = 5.e4;
+
+static FProceduralSystem TestSystem()
+{
+    FProceduralSystem System;
+    System.Name = TEXT("TEST_SYSTEM");
+    System.Star.Id = 9100;
+    System.Star.Name = TEXT("TEST STAR");
+    System.Star.GM = gm_star;
+
+    FProceduralBody& Planet = System.Bodies.AddDefaulted_GetRef();
+    Planet.Id = 9101;
+    Planet.Name = TEXT("TEST PLANET");
+    Planet.Center = 9100;
+    Planet.GM = gm_planet;
+    Planet.Elements = FSConicElements(FSDistance(2.e7), 0.05, FSAngle(0.1), FSAngle(0.2), FSAngle(0.3), FSAngle(0.4), FSEphemerisTime(0.), FSMassConstant(gm_star));
+
+    FProceduralBody& Moon = System.Bodies.AddDefaulted_GetRef();
+    Moon.Id = 9102;
+    Moon.Name = TEXT("TEST MOON");
+    Moon.Center = 9101;
+    Moon.Elements = FSConicElements(FSDistance(5.e4), 0.01, FSAngle(0.5), FSAngle(0.), FSAngle(0.), FSAngle(1.), FSEphemerisTime(0.), FSMassConstant(gm_planet));
+
+    return System;
+}
+
+
+TEST(procedural_system_test, Conics_Match_conics) {
+
+    const FProceduralSystem System = TestSystem();
+
+    FProceduralSystemSettings Settings;
+    Settings.Start = 0.;
+    Settings.Stop = 10. * 86400. + 100.;
+    Settings.Step = 3600.;
+    Settings.bChebyshev = false;
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FProceduralSystemStates States;
+    EXPECT_TRUE(PropagateSystem(System, Settings, States, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    // Every hour, and the end
+    ASSERT_EQ(States.Epochs.Num(), 242);
+    EXPECT_EQ(States.Epochs.Last(), Settings.Stop);
+    ASSERT_EQ(States.States.Num(), 2);
+    EXPECT_EQ(States.Segments.Num(), 0);
+
+    for (int32 e : { 0, 17, 241 })
+    {
+        for (int32 b = 0; b < 2; ++b)
+        {
+            FSStateVector Expected;
+            USpice::conics(ResultCode, ErrorMessage, System.Bodies[b].Elements, FSEphemerisTime(States.Epochs[e]), Expected);
+
+            double a[6], x[6];
+            States.States[b][e].CopyTo(a);
+            Expected.CopyTo(x);
+            for (int32 c = 0; c < 6; ++c)
+            {
+                EXPECT_NEAR(a[c], x[c], 1.e-9 * FMath::Max(1., FMath::Abs(x[c])));
+            }
+        }
+    }
+}
+
+
+TEST(procedural_system_test, NBody_Without_Masses_Is_Two_Body) {
+
+    FProceduralSystem System;
+    System.Name = TEXT("CIRCULAR");
+    System.Star.Id = 9200;
+    System.Star.GM = gm_star;
+    System.Propagation = EProceduralPropagation::NBody;
+
+    // A massless body on a circular orbit
+    const double R = 1.e7, V = FMath::Sqrt(gm_star / R), n = V / R;
+    FProceduralBody& Body = System.Bodies.AddDefaulted_GetRef();
+    Body.Id = 9201;
+    Body.Name = TEXT("CIRCULAR BODY");
+    Body.Center = 9200;
+    Body.State = FSStateVector(FSDistanceVector(R, 0., 0.), FSVelocityVector(0., V, 0.));
+
+    FProceduralSystemSettings Settings;
+    Settings.Stop = 2. * PI / n;
+    Settings.Step = Settings.Stop / 100.;
+    Settings.Substeps = 8;
+    Settings.bChebyshev = false;
+
+    FProceduralSystemStates States;
+    ASSERT_TRUE(PropagateSystem(System, Settings, States));
+
+    for (int32 e = 0; e < States.Epochs.Num(); e += 10)
+    {
+        const double t = States.Epochs[e];
+        double s[6];
+        States.States[0][e].CopyTo(s);
+        EXPECT_NEAR(s[0], R * FMath::Cos(n * t), 1.e-7 * R);
+        EXPECT_NEAR(s[1], R * FMath::Sin(n * t), 1.e-7 * R);
+        EXPECT_NEAR(s[2], 0., 1.e-9);
+    }
+}
+
+
+TEST(procedural_system_test, NBody_Moon_Is_Relative_To_Its_Center) {
+
+    FProceduralSystem System = TestSystem();
+    System.Propagation = EProceduralPropagation::NBody;
+
+    const double R = 2.e7, V = FMath::Sqrt(gm_star / R);
+    const double r = 5.e4, v = FMath::Sqrt(gm_planet / r);
+    System.Bodies[0].State = FSStateVector(FSDistanceVector(R, 0., 0.), FSVelocityVector(0., V, 0.));
+    System.Bodies[1].State = FSStateVector(FSDistanceVector(0., r, 0.), FSVelocityVector(-v, 0., 0.));
+
+    FProceduralSystemSettings Settings;
+    Settings.Stop = 5. * 86400.;
+    Settings.Step = 600.;
+
+    FProceduralSystemStates States;
+    ASSERT_TRUE(PropagateSystem(System, Settings, States));
+    ASSERT_EQ(States.Segments.Num(), 2);
+
+    double s[6];
+    States.States[1][0].CopyTo(s);
+    EXPECT_NEAR(s[1], r, 1.e-6);
+    EXPECT_NEAR(s[3], -v, 1.e-12);
+
+    // Still circling the planet, not the star
+    for (const FSStateVector& State : States.States[1])
+    {
+        State.CopyTo(s);
+        EXPECT_NEAR(FMath::Sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]), r, 0.01 * r);
+    }
+
+    // The fit reproduces the samples
+    for (int32 e : { 3, 400, 720 })
+    {
+        double rf[3], vf[3];
+        bool bFound = false;
+        for (const FSpkChebyshevSegment& Segment : States.Segments[1])
+        {
+            bFound = bFound || Segment.Evaluate(States.Epochs[e], rf, vf);
+        }
+        ASSERT_TRUE(bFound);
+        States.States[1][e].CopyTo(s);
+        EXPECT_NEAR(rf[0], s[0], 0.01);
+        EXPECT_NEAR(rf[1], s[1], 0.01);
+        EXPECT_NEAR(rf[2], s[2], 0.01);
+    }
+}
+
+
+TEST(procedural_system_test, Errors) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    FProceduralSystemStates States;
+    FProceduralSystemSettings Settings;
+
+    // A moon listed before its planet
+    FProceduralSystem System = TestSystem();
+    System.Bodies.Swap(0, 1);
+    EXPECT_FALSE(PropagateSystem(System, Settings, States, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(ErrorMessage.IsEmpty());
+
+    // An empty span
+    System = TestSystem();
+    Settings.Stop = Settings.Start;
+    ResultCode = ES_ResultCode::Success;
+    EXPECT_FALSE(PropagateSystem(System, Settings, States, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // N-body needs the star's GM
+    Settings = FProceduralSystemSettings();
+    System.Propagation = EProceduralPropagation::NBody;
+    System.Star.GM = 0.;
+    ResultCode = ES_ResultCode::Success;
+    EXPECT_FALSE(PropagateSystem(System, Settings, States, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
@@ -0,0 +1,248 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMathBatch.h"
+#include "SpiceMath.h"
+
+using namespace MaxQ::Math;
+
+static const double pi = 3.14159265358979323846;
+
+// Random rotations, and a few on m2q's other branches (half turns)
+static void TestRotations(TArray<FSRotationMatrix>& Rotations)
+{
+    FRandomStream Random(1234);
+    for (int32 i = 0; i < 2000; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector());
+        FSRotationMatrix r;
+        USpice::axisar(FSDimensionlessVector(u.X, u.Y, u.Z), FSAngle(Random.FRandRange(-pi, pi)), r);
+        Rotations.Add(r);
+    }
+    for (const FSDimensionlessVector& axis : { FSDimensionlessVector(1., 0., 0.), FSDimensionlessVector(0., 1., 0.), FSDimensionlessVector(0., 0., 1.), FSDimensionlessVector(0., 0.6, 0.8) })
+    {
+        FSRotationMatrix r;
+        USpice::axisar(axis, FSAngle(pi), r);
+        Rotations.Add(r);
+    }
+}
+
+static void ExpectQuatNear(const FSQuaternion& Actual, const FSQuaternion& Expected, double Tolerance, int32 i)
+{
+    EXPECT_NEAR(Actual.w, Expected.w, Tolerance) << "element " << i;
+    EXPECT_NEAR(Actual.x, Expected.x, Tolerance) << "element " << i;
+    EXPECT_NEAR(Actual.y, Expected.y, Tolerance) << "element " << i;
+    EXPECT_NEAR(Actual.z, Expected.z, Tolerance) << "element " << i;
+}
+
+// The same attitude (q or -q)
+static void ExpectAttitudeNear(const FSQuaternion& Actual, const FSQuaternion& Expected, double Tolerance, int32 i)
+{
+    const double d = Actual.w * Expected.w + Actual.x * Expected.x + Actual.y * Expected.y + Actual.z * Expected.z;
+    ExpectQuatNear(d < 0. ? FSQuaternion(-Actual.w, -Actual.x, -Actual.y, -Actual.z) : Actual, Expected, Tolerance, i);
+}
+
+// A constant rate rotation about a fixed axis
+static FSQuaternion Spin(double t)
+{
+    const double h = 0.5 * 0.37 * t;
+    return FSQuaternion(cos(h), 0.48 * sin(h), 0.6 * sin(h), 0.64 * sin(h));
+}
+
+TEST(quaternion_batch_test, M2q_Q2m_Match_m2q_q2m) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    TArray<FSRotationMatrix> Rotations;
+    TestRotations(Rotations);
+    const int32 Num = Rotations.Num();
+
+    TArray<FSQuaternion> q;
+    q.SetNum(Num);
+    M2q(Rotations, q);
+
+    TArray<double> m;
+    m.SetNum(9 * Num);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        FSQuaternion expected;
+        USpice::m2q(ResultCode, ErrorMessage, Rotations[i], expected);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+        ExpectQuatNear(q[i], expected, 1e-15, i);
+
+        double _m[3][3]; Rotations[i].CopyTo(_m);
+        FMemory::Memcpy(&m[9 * i], _m, sizeof(_m));
+    }
+
+    // ...from row-major doubles
+    TArray<FSQuaternion> q2;
+    q2.SetNum(Num);
+    M2q(m, q2);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        ExpectQuatNear(q2[i], q[i], 0., i);
+    }
+
+    // ...and back, including a non-unit quaternion
+    q.Add(FSQuaternion(2., -1., 0.5, 3.));
+    TArray<double> m2;
+    m2.SetNum(9 * q.Num());
+    Q2m(q, m2);
+    for (int32 i = 0; i < q.Num(); ++i)
+    {
+        FSRotationMatrix expected;
+        USpice::q2m(q[i], expected);
+        double _m[3][3]; expected.CopyTo(_m);
+        for (int32 j = 0; j < 9; ++j)
+        {
+            EXPECT_NEAR(m2[9 * i + j], _m[j / 3][j % 3], 1e-15) << "element " << i;
+        }
+    }
+}
+
+
+TEST(quaternion_batch_test, Qxq_Matches_qxq) {
+
+    FRandomStream Random(99);
+    TArray<FSQuaternion> q1, q2;
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        q1.Add(FSQuaternion(Random.FRandRange(-1., 1.), Random.FRandRange(-1., 1.), Random.FRandRange(-1., 1.), Random.FRandRange(-1., 1.)));
+        q2.Add(FSQuaternion(Random.FRandRange(-1., 1.), Random.FRandRange(-1., 1.), Random.FRandRange(-1., 1.), Random.FRandRange(-1., 1.)));
+    }
+
+    TArray<FSQuaternion> qout;
+    qout.SetNum(q1.Num());
+    Qxq(q1, q2, qout);
+
+    for (int32 i = 0; i < q1.Num(); ++i)
+    {
+        FSQuaternion expected;
+        USpice::qxq(q1[i], q2[i], expected);
+        ExpectQuatNear(qout[i], expected, 1e-15, i);
+    }
+}
+
+
+TEST(quaternion_batch_test, Slerp) {
+
+    // Along a spin, and the short way when the second sign is flipped
+    TArray<FSQuaternion> q0, q1, expected;
+    TArray<double> t;
+    for (int32 i = 0; i <= 100; ++i)
+    {
+        const double Angle = 0.05 * i;
+        const FSQuaternion b = Spin(Angle);
+        q0.Add(Spin(0.));
+        q1.Add((i % 2) ? FSQuaternion(-b.w, -b.x, -b.y, -b.z) : b);
+        t.Add(i / 100.);
+        expected.Add(Spin(Angle * i / 100.));
+    }
+    // The same attitude
+    q0.Add(Spin(1.)); q1.Add(Spin(1.)); t.Add(0.3); expected.Add(Spin(1.));
+
+    TArray<FSQuaternion> qout;
+    qout.SetNum(q0.Num());
+    Slerp(q0, q1, t, qout);
+
+    for (int32 i = 0; i < q0.Num(); ++i)
+    {
+        ExpectAttitudeNear(qout[i], expected[i], 1e-12, i);
+    }
+}
+
+
+TEST(quaternion_batch_test, InterpolateAttitude) {
+
+    // Samples of a constant rate spin, with mixed signs.  SLERP and SQUAD
+    // both reproduce it.
+    TArray<double> Times;
+    TArray<FSQuaternion> Samples;
+    double Time = 0.;
+    for (int32 i = 0; i < 20; ++i)
+    {
+        const FSQuaternion q = Spin(Time);
+        Times.Add(Time);
+        Samples.Add((i % 3) == 1 ? FSQuaternion(-q.w, -q.x, -q.y, -q.z) : q);
+        Time += 1.25;
+    }
+
+    TArray<FSQuaternion> Tangents;
+    Tangents.SetNum(Samples.Num());
+    SquadTangents(Samples, Tangents);
+
+    TArray<double> et;
+    for (double e = -1.; e < Time + 1.; e += 0.0731)
+    {
+        et.Add(e);
+    }
+    const int32 Num = et.Num();
+
+    TArray<FSQuaternion> qslerp, qsquad;
+    qslerp.SetNum(Num); qsquad.SetNum(Num);
+    InterpolateAttitude(Times, Samples, TArrayView<const FSQuaternion>(), et, qslerp);
+    InterpolateAttitude(Times, Samples, Tangents, et, qsquad);
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const double e = FMath::Clamp(et[i], Times[0], Times.Last());
+        ExpectAttitudeNear(qslerp[i], Spin(e), 1e-12, i);
+        ExpectAttitudeNear(qsquad[i], Spin(e), 1e-12, i);
+    }
+
+    // On the samples
+    TArray<FSQuaternion> qat;
+    qat.SetNum(Times.Num());
+    InterpolateAttitude(Times, Samples, Tangents, Times, qat);
+    for (int32 i = 0; i < Times.Num(); ++i)
+    {
+        ExpectAttitudeNear(qat[i], Samples[i], 1e-14, i);
+    }
+}
+
+
+TEST(quaternion_batch_test, Squad_Is_Smoother_Than_Slerp) {
+
+    // A wobble:  SLERP's angular velocity jumps at each sample, SQUAD's
+    // doesn't (much)
+    TArray<double> Times;
+    TArray<FSQuaternion> Samples;
+    for (int32 i = 0; i < 8; ++i)
+    {
+        FSRotationMatrix r;
+        USpice::axisar(FSDimensionlessVector(sin(i), cos(i), 1.), FSAngle(0.3 * i), r);
+        FSQuaternion q;
+        MaxQ::Math::M2q(q, r);
+        Times.Add(i);
+        Samples.Add(q);
+    }
+    TArray<FSQuaternion> Tangents;
+    Tangents.SetNum(Samples.Num());
+    SquadTangents(Samples, Tangents);
+
+    // Rotation angle over a small step, either side of sample 4
+    auto Jump = [&](TArrayView<const FSQuaternion> t)
+    {
+        const double dt = 1e-4;
+        TArray<double> et{ 4. - dt, 4., 4. + dt };
+        TArray<FSQuaternion> q;
+        q.SetNum(3);
+        InterpolateAttitude(Times, Samples, t, et, q);
+        auto Angle = [](const FSQuaternion& a, const FSQuaternion& b)
+        {
+            return 2. * acos(FMath::Min(FMath::Abs(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z), 1.));
+        };
+        return FMath::Abs(Angle(q[0], q[1]) - Angle(q[1], q[2])) / dt;
+    };
+
+    EXPECT_LT(Jump(Tangents), 0.1 * Jump(TArrayView<const FSQuaternion>()));
+}
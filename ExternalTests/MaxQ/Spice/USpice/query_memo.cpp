@@ -0,0 +1,117 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceQueryMemo.h"
+#include "SpiceTime.h"
+
+using namespace MaxQ::Data;
+
+static void LoadMemoKernels()
+{
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    SetQueryMemoEnabled(true);
+}
+
+TEST(query_memo_test, Repeats_Hit) {
+
+    LoadMemoKernels();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSStateVector First, Second;
+    FSEphemerisPeriod FirstLt, SecondLt;
+    USpice::spkezr(ResultCode, ErrorMessage, et0, First, FirstLt, TEXT("FAKEBODY9993"), TEXT("FAKEBODY9995"), TEXT("J2000"), ES_AberrationCorrectionWithNewtonians::LT_S);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(GetQueryMemoStats().Hits, 0);
+
+    // Same query, spelled differently
+    USpice::spkezr(ResultCode, ErrorMessage, et0, Second, SecondLt, TEXT("fakebody9993"), TEXT("FAKEBODY9995 "), TEXT("j2000"), ES_AberrationCorrectionWithNewtonians::LT_S);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(GetQueryMemoStats().Hits, 1);
+    EXPECT_EQ(First.r, Second.r);
+    EXPECT_EQ(First.v, Second.v);
+    EXPECT_EQ(FirstLt.seconds, SecondLt.seconds);
+
+    // A different correction, time or query is a miss
+    USpice::spkezr(ResultCode, ErrorMessage, et0, Second, SecondLt, TEXT("FAKEBODY9993"), TEXT("FAKEBODY9995"), TEXT("J2000"), ES_AberrationCorrectionWithNewtonians::None);
+    USpice::spkezr(ResultCode, ErrorMessage, FSEphemerisTime(et0.seconds + 1.), Second, SecondLt, TEXT("FAKEBODY9993"), TEXT("FAKEBODY9995"), TEXT("J2000"), ES_AberrationCorrectionWithNewtonians::LT_S);
+    FSDistanceVector Position;
+    USpice::spkpos(ResultCode, ErrorMessage, et0, Position, SecondLt, TEXT("FAKEBODY9993"), TEXT("FAKEBODY9995"), TEXT("J2000"), ES_AberrationCorrectionWithNewtonians::LT_S);
+    EXPECT_EQ(GetQueryMemoStats().Hits, 1);
+    EXPECT_EQ(Position, First.r);
+
+    FSRotationMatrix Rotation, MemoRotation;
+    USpice::pxform(ResultCode, ErrorMessage, Rotation, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    USpice::pxform(ResultCode, ErrorMessage, MemoRotation, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    EXPECT_EQ(GetQueryMemoStats().Hits, 2);
+    EXPECT_EQ(Rotation.m, MemoRotation.m);
+
+    FSStateTransform Transform, MemoTransform;
+    USpice::sxform(ResultCode, ErrorMessage, Transform, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    USpice::sxform(ResultCode, ErrorMessage, MemoTransform, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    EXPECT_EQ(GetQueryMemoStats().Hits, 3);
+    for (int32 i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(Transform.m[i].r, MemoTransform.m[i].r);
+        EXPECT_EQ(Transform.m[i].dr, MemoTransform.m[i].dr);
+    }
+
+    SetQueryMemoEnabled(false);
+}
+
+TEST(query_memo_test, Failures_NotRemembered) {
+
+    LoadMemoKernels();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FSRotationMatrix Rotation;
+    for (int32 i = 0; i < 2; ++i)
+    {
+        USpice::pxform(ResultCode, ErrorMessage, Rotation, et0, TEXT("J2000"), TEXT("NOT_A_FRAME"));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+        EXPECT_GT(ErrorMessage.Len(), 0);
+    }
+    EXPECT_EQ(GetQueryMemoStats().Hits, 0);
+    EXPECT_EQ(GetQueryMemoStats().Entries, 0);
+
+    SetQueryMemoEnabled(false);
+}
+
+TEST(query_memo_test, Clears_On_Frame_And_Pool) {
+
+    LoadMemoKernels();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FSRotationMatrix Rotation;
+
+    USpice::pxform(ResultCode, ErrorMessage, Rotation, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    EXPECT_EQ(GetQueryMemoStats().Entries, 1);
+
+    MaxQ::Time::GetEtClock().BeginFrame();
+    USpice::pxform(ResultCode, ErrorMessage, Rotation, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    EXPECT_EQ(GetQueryMemoStats().Hits, 0);
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::pxform(ResultCode, ErrorMessage, Rotation, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    EXPECT_EQ(GetQueryMemoStats().Hits, 0);
+
+    ClearQueryMemo();
+    EXPECT_EQ(GetQueryMemoStats().Entries, 0);
+
+    SetQueryMemoEnabled(false);
+    USpice::pxform(ResultCode, ErrorMessage, Rotation, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    USpice::pxform(ResultCode, ErrorMessage, Rotation, et0, TEXT("J2000"), TEXT("IAU_FAKEBODY9994"));
+    EXPECT_EQ(GetQueryMemoStats().Hits, 0);
+    EXPECT_EQ(GetQueryMemoStats().Entries, 0);
+}
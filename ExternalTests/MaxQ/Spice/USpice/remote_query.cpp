@@ -0,0 +1,64 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceRemote.h"
+
+
+TEST(remote_query_test, Loopback_State_And_Pxform) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    MaxQ::Ephemeris::FRemoteEphemerisServer Server;
+    ASSERT_TRUE(Server.Start(17782, &ResultCode, &ErrorMessage));
+
+    MaxQ::Ephemeris::FRemoteEphemerisSettings Settings;
+    Settings.WindowSeconds = 600.;
+    Settings.ToleranceKm = 1.e-3;
+    MaxQ::Ephemeris::FRemoteEphemerisClient Client(Settings);
+    ASSERT_TRUE(Client.Connect(TEXT("127.0.0.1"), 17782, &ResultCode, &ErrorMessage));
+
+    FSStateVector State;
+    EXPECT_FALSE(Client.State(et0, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"), ES_AberrationCorrectionWithNewtonians::None, State));
+
+    MaxQ::Ephemeris::FRemoteStateResult Result = Client.StateAsync(et0, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000")).Get();
+    ASSERT_TRUE(Result.bSuccess);
+    EXPECT_NEAR(Result.State.r.x.km, state_target_9994_center_9995_eclipj2000_et0.r.x.km, 1.e-3);
+    EXPECT_NEAR(Result.State.r.y.km, state_target_9994_center_9995_eclipj2000_et0.r.y.km, 1.e-3);
+    EXPECT_NEAR(Result.State.r.z.km, state_target_9994_center_9995_eclipj2000_et0.r.z.km, 1.e-3);
+
+    // Kept, now
+    EXPECT_TRUE(Client.State(et0, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"), ES_AberrationCorrectionWithNewtonians::None, State));
+    EXPECT_EQ(Client.NumWindows(), 1);
+
+    MaxQ::Ephemeris::FRemoteFrameResult Frames = Client.Pxform(TEXT("J2000"), TEXT("ECLIPJ2000"), { et0, et0 + FSEphemerisPeriod(60.) }).Get();
+    ASSERT_TRUE(Frames.bSuccess);
+    ASSERT_EQ(Frames.Matrices.Num(), 2);
+
+    FSRotationMatrix Expected;
+    USpice::pxform(ResultCode, ErrorMessage, Expected, et0, TEXT("J2000"), TEXT("ECLIPJ2000"));
+    EXPECT_DOUBLE_EQ(Frames.Matrices[0].m[1].y, Expected.m[1].y);
+
+    // Errors come back, and the connection survives them
+    Frames = Client.Pxform(TEXT("NOT A FRAME"), TEXT("J2000"), { et0 }).Get();
+    EXPECT_FALSE(Frames.bSuccess);
+    EXPECT_GT(Frames.ErrorMessage.Len(), 0);
+    EXPECT_TRUE(Client.IsConnected());
+
+    FSpiceJobResult Job = Client.RunJob(TEXT("NotAJob"), {}).Get();
+    EXPECT_FALSE(Job.bSuccess);
+
+    Client.Disconnect();
+    Server.Stop();
+    EXPECT_GE(Server.NumRequests(), 4ull);
+    EXPECT_EQ(Server.NumMalformed(), 0ull);
+}
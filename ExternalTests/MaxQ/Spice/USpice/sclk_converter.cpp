@@ -0,0 +1,179 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceData.h"
+#include "SpiceTime.h"
+
+using namespace MaxQ::Time;
+
+// Two fake clocks, one per parallel time system.  Partition 2 starts after
+// a jump in the count, and the rate changes between records.
+static const char* SclkKernel =
+    "KPL/SCLK\n"
+    "\\begindata\n"
+    "SCLK_KERNEL_ID            = ( @2022-01-01/00:00 )\n"
+    "SCLK_DATA_TYPE_9999       = ( 1 )\n"
+    "SCLK01_TIME_SYSTEM_9999   = ( 1 )\n"
+    "SCLK01_N_FIELDS_9999      = ( 2 )\n"
+    "SCLK01_MODULI_9999        = ( 4294967296 256 )\n"
+    "SCLK01_OFFSETS_9999       = ( 0 0 )\n"
+    "SCLK01_OUTPUT_DELIM_9999  = ( 1 )\n"
+    "SCLK_PARTITION_START_9999 = ( 0.0 5.12E+10 )\n"
+    "SCLK_PARTITION_END_9999   = ( 2.56E+10 1.0E+12 )\n"
+    "SCLK01_COEFFICIENTS_9999  = ( 0.0      6.0E+8      1.0\n"
+    "                              1.28E+10 6.5E+8      1.00001\n"
+    "                              2.56E+10 7.000005E+8 0.99999 )\n"
+    "SCLK_DATA_TYPE_9998       = ( 1 )\n"
+    "SCLK01_TIME_SYSTEM_9998   = ( 2 )\n"
+    "SCLK01_N_FIELDS_9998      = ( 2 )\n"
+    "SCLK01_MODULI_9998        = ( 4294967296 256 )\n"
+    "SCLK01_OFFSETS_9998       = ( 0 0 )\n"
+    "SCLK01_OUTPUT_DELIM_9998  = ( 1 )\n"
+    "SCLK_PARTITION_START_9998 = ( 0.0 )\n"
+    "SCLK_PARTITION_END_9998   = ( 1.0E+12 )\n"
+    "SCLK01_COEFFICIENTS_9998  = ( 0.0      6.0E+8      1.0 )\n"
+    "\\begintext\n";
+
+static void LoadSclkKernel()
+{
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    TArrayView<const uint8> Contents((const uint8*)SclkKernel, FCStringAnsi::Strlen(SclkKernel));
+    ASSERT_TRUE(MaxQ::Data::FurnshBuffer(TEXT("sclk_converter_test.tsc"), Contents, &ResultCode, &ErrorMessage));
+}
+
+static void ExpectSameAsSct2e(int32 Sc)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    auto Clock = GetSclkConverter(Sc, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+    ASSERT_TRUE(Clock->IsValid());
+
+    TArray<double> Ticks;
+    for (int32 i = 0; i <= 100; ++i)
+    {
+        Ticks.Add(Clock->GetMaxTicks() * i / 100.);
+    }
+
+    TArray<double> Ets;
+    Ets.SetNumZeroed(Ticks.Num());
+    EXPECT_EQ(Clock->TicksToEt(Ticks, Ets), Ticks.Num());
+
+    TArray<double> RoundTrip;
+    RoundTrip.SetNumZeroed(Ticks.Num());
+    EXPECT_EQ(Clock->EtToTicks(Ets, RoundTrip), Ticks.Num());
+
+    for (int32 i = 0; i < Ticks.Num(); ++i)
+    {
+        FSEphemerisTime et;
+        USpice::sct2e(ResultCode, ErrorMessage, Sc, Ticks[i], et);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_NEAR(Ets[i], et.seconds, 1e-6) << "ticks " << Ticks[i];
+
+        double sclkdp = 0.;
+        USpice::sce2c(ResultCode, ErrorMessage, Sc, et, sclkdp);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_NEAR(RoundTrip[i], sclkdp, 1e-3) << "ticks " << Ticks[i];
+    }
+}
+
+TEST(sclk_converter_test, Tdb_Matches_sct2e_sce2c) {
+
+    LoadSclkKernel();
+    ExpectSameAsSct2e(-9999);
+}
+
+TEST(sclk_converter_test, Tdt_Matches_sct2e_sce2c) {
+
+    LoadSclkKernel();
+    ExpectSameAsSct2e(-9998);
+}
+
+TEST(sclk_converter_test, ClockStrings_Match_scs2e) {
+
+    LoadSclkKernel();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    auto Clock = GetSclkConverter(-9999);
+    ASSERT_TRUE(Clock->IsValid());
+    EXPECT_EQ(Clock->NumPartitions(), 2);
+
+    const TCHAR* Strings[] = {
+        TEXT("1/0.000"),
+        TEXT("1/12345678.128"),
+        TEXT("1/ 99999999:255"),
+        TEXT("2/200000000.017"),
+        TEXT("250000000-5"),
+        TEXT("3000000000")
+    };
+
+    for (const TCHAR* Str : Strings)
+    {
+        FSEphemerisTime expected;
+        USpice::scs2e(ResultCode, ErrorMessage, -9999, Str, expected);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(Str);
+
+        double et = 0.;
+        EXPECT_TRUE(Clock->ClockToEt(Str, et)) << TCHAR_TO_ANSI(Str);
+        EXPECT_NEAR(et, expected.seconds, 1e-6) << TCHAR_TO_ANSI(Str);
+    }
+
+    double et = 0.;
+    // Partition 1 ends at count 100000000, and partition 2 starts at 200000000
+    EXPECT_FALSE(Clock->ClockToEt(TEXT("1/150000000.000"), et));
+    EXPECT_FALSE(Clock->ClockToEt(TEXT("150000000.000"), et));
+    EXPECT_FALSE(Clock->ClockToEt(TEXT("3/1.000"), et));
+    EXPECT_FALSE(Clock->ClockToEt(TEXT("1/1.2.3"), et));
+    EXPECT_FALSE(Clock->ClockToEt(TEXT("1/abc"), et));
+}
+
+TEST(sclk_converter_test, OutOfRange_LeftAlone) {
+
+    LoadSclkKernel();
+
+    auto Clock = GetSclkConverter(-9999);
+    ASSERT_TRUE(Clock->IsValid());
+
+    double et = 0.;
+    EXPECT_FALSE(Clock->TicksToEt(-1., et));
+    EXPECT_FALSE(Clock->TicksToEt(Clock->GetMaxTicks() + 1., et));
+
+    const double Ticks[] = { -1., 0., Clock->GetMaxTicks() + 1. };
+    double Ets[] = { 1., 1., 1. };
+    EXPECT_EQ(Clock->TicksToEt(Ticks, Ets), 1);
+    EXPECT_EQ(Ets[0], 1.);
+    EXPECT_NE(Ets[1], 1.);
+    EXPECT_EQ(Ets[2], 1.);
+}
+
+TEST(sclk_converter_test, FollowsPool) {
+
+    LoadSclkKernel();
+
+    auto First = GetSclkConverter(-9999);
+    ASSERT_TRUE(First->IsValid());
+    EXPECT_EQ(&GetSclkConverter(-9999).Get(), &First.Get());
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    EXPECT_TRUE(MaxQ::Data::UnloadBuffer(TEXT("sclk_converter_test.tsc"), &ResultCode, &ErrorMessage));
+    EXPECT_FALSE(GetSclkConverter(-9999, &ResultCode, &ErrorMessage)->IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    // Not an SCLK at all
+    EXPECT_FALSE(GetSclkConverter(-1234, &ResultCode, &ErrorMessage)->IsValid());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
@@ -0,0 +1,153 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMathBatch.h"
+
+using namespace MaxQ::Math;
+
+// Wrappers that size buffers by the caller's counts take them from the
+// scratch arena.  These buffers are megabytes, more than a thread's stack.
+
+static constexpr int32 NumLarge = 200000;
+
+static void PoolLarge(ES_ResultCode& ResultCode, FString& ErrorMessage)
+{
+    TArray<double> dvals;
+    for (int32 i = 0; i < NumLarge; ++i)
+    {
+        dvals.Add(0.5 * i);
+    }
+    USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("MAXQ_SCRATCH_LARGE"), dvals);
+}
+
+
+TEST(scratch_scope_test, Large_Batch_Through_Wrappers) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    PoolLarge(ResultCode, ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // 1.6MB of room, then 80MB (past what the arena keeps between calls),
+    // then the small case again, after the arena has let the big block go
+    for (int room : { NumLarge, 50 * NumLarge, 7 })
+    {
+        TArray<double> values;
+        bool bFound = false;
+        USpice::gdpool(ResultCode, ErrorMessage, values, bFound, TEXT("MAXQ_SCRATCH_LARGE"), 0, room);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+        EXPECT_TRUE(bFound);
+
+        ASSERT_EQ(values.Num(), FMath::Min(room, NumLarge));
+        for (int32 i = 0; i < values.Num(); ++i)
+        {
+            ASSERT_EQ(values[i], 0.5 * i) << i;
+        }
+    }
+
+    // A million doubles, sorted through their index
+    FRandomStream Random(2021);
+    TArray<double> Unsorted;
+    for (int32 i = 0; i < 1000000; ++i)
+    {
+        Unsorted.Add(Random.FRandRange(-1.e6, 1.e6));
+    }
+
+    TArray<int> Order;
+    USpice::shelld_ByIndex(Unsorted, Order);
+    ASSERT_EQ(Order.Num(), Unsorted.Num());
+    for (int32 i = 1; i < Order.Num(); ++i)
+    {
+        ASSERT_LE(Unsorted[Order[i - 1]], Unsorted[Order[i]]) << i;
+    }
+
+    USpice::clear_all();
+}
+
+
+TEST(scratch_scope_test, Nested_Scopes_On_One_Thread) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    PoolLarge(ResultCode, ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+
+    // Enough states for several streamed chunks
+    FRandomStream Random(1234);
+    TArray<double> s[6];
+    for (int32 i = 0; i < 150000; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector());
+        const double r = Random.FRandRange(6600., 42200.);
+        s[0].Add(r * u.X); s[1].Add(r * u.Y); s[2].Add(r * u.Z);
+        s[3].Add(Random.FRandRange(-8., 8.)); s[4].Add(Random.FRandRange(-8., 8.)); s[5].Add(Random.FRandRange(-8., 8.));
+    }
+    const int32 Num = s[0].Num();
+    const FConstVectorBatch r(s[0], s[1], s[2]), v(s[3], s[4], s[5]);
+
+    TArray<double> Expected[6];
+    for (TArray<double>& c : Expected) c.SetNum(Num);
+    ASSERT_TRUE(Xfmsta(r, v, ES_CoordinateSystem::RECTANGULAR, ES_CoordinateSystem::LATITUDINAL,
+        FVectorBatch{ Expected[0], Expected[1], Expected[2] }, FVectorBatch{ Expected[3], Expected[4], Expected[5] }));
+
+    int32 NumChunks = 0;
+    int32 NumStates = 0;
+    ASSERT_TRUE(Xfmsta(r, v, ES_CoordinateSystem::RECTANGULAR, ES_CoordinateSystem::LATITUDINAL,
+        [&](int32 First, const FConstVectorBatch& rout, const FConstVectorBatch& vout)
+        {
+            ++NumChunks;
+            NumStates += rout.Num();
+
+            // The chunk lives in the outer scope's scratch.  Inner scopes
+            // (a big gdpool buffer, then another streamed conversion) take
+            // more from the same arena, and mustn't touch it.
+            TArray<double> values;
+            bool bFound = false;
+            USpice::gdpool(ResultCode, ErrorMessage, values, bFound, TEXT("MAXQ_SCRATCH_LARGE"), 0, NumLarge);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success) << TCHAR_TO_ANSI(*ErrorMessage);
+            EXPECT_EQ(values.Num(), NumLarge);
+            EXPECT_EQ(values.Last(), 0.5 * (NumLarge - 1));
+
+            int32 InnerStates = 0;
+            EXPECT_TRUE(Xfmsta(rout, vout, ES_CoordinateSystem::LATITUDINAL, ES_CoordinateSystem::RECTANGULAR,
+                [&](int32 InnerFirst, const FConstVectorBatch& rin, const FConstVectorBatch& vin)
+                {
+                    // Back where it started
+                    for (int32 i = 0; i < rin.Num(); ++i)
+                    {
+                        const int32 j = First + InnerFirst + i;
+                        EXPECT_NEAR(rin.X[i], s[0][j], 1.e-8 * FMath::Abs(s[0][j]) + 1.e-8);
+                        EXPECT_NEAR(vin.Z[i], s[5][j], 1.e-8 * FMath::Abs(s[5][j]) + 1.e-8);
+                    }
+                    InnerStates += rin.Num();
+                }));
+            EXPECT_EQ(InnerStates, rout.Num());
+
+            for (int32 i = 0; i < rout.Num(); ++i)
+            {
+                const int32 j = First + i;
+                const double actual[6] = { rout.X[i], rout.Y[i], rout.Z[i], vout.X[i], vout.Y[i], vout.Z[i] };
+                for (int32 k = 0; k < 6; ++k)
+                {
+                    ASSERT_EQ(actual[k], Expected[k][j]) << "state " << j << " component " << k;
+                }
+            }
+        }));
+
+    EXPECT_GT(NumChunks, 1);
+    EXPECT_EQ(NumStates, Num);
+
+    USpice::clear_all();
+}
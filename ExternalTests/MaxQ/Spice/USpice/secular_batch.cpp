@@ -0,0 +1,126 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSecularPropagator.h"
+
+using namespace MaxQ::Orbits;
+
+static const double gm_earth = 398600.4418;
+
+static FSConicElements Elements(double rp, double ecc, double inc, double lnode, double argp, double m0, double t0)
+{
+    return FSConicElements(FSDistance(rp), ecc, FSAngle(inc), FSAngle(lnode), FSAngle(argp), FSAngle(m0), FSEphemerisTime(t0), FSMassConstant(gm_earth));
+}
+
+TEST(secular_batch_test, NoZonals_Matches_conics) {
+
+    USpice::init_all();
+
+    TArray<FSConicElements> Orbits = {
+        Elements(6778., .001, .90, 1.0, .3, .2, 1e8),
+        Elements(7000., .7, 1.10, 4.0, 4.7, 3.0, 2e8),
+        Elements(26600., .01, .96, 2.5, 1.2, 6.0, 0.),
+        Elements(42164., 0., 0., 0., 0., 1.0, -1e8),
+        Elements(6678., .95, 2.0, 5.0, .7, -2.0, 0.),
+        // Not closed
+        Elements(6800., 1.5, .4, .1, 2.0, .5, 3e8)
+    };
+
+    FSecularBatchPropagator Batch;
+    Batch.Build(Orbits, FZonalHarmonics());
+    ASSERT_EQ(Batch.Num(), Orbits.Num());
+    EXPECT_FALSE(Batch.IsValid(Orbits.Num() - 1));
+
+    TArray<FSStateVector> States;
+    States.SetNum(Orbits.Num());
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    for (double et : { 1e8, 1e8 + 3600., 2.5e8, 3e8 - 86400. })
+    {
+        EXPECT_EQ(Batch.Propagate(FSEphemerisTime(et), States), Orbits.Num() - 1);
+
+        for (int32 i = 0; i < Orbits.Num() - 1; ++i)
+        {
+            FSStateVector expected;
+            USpice::conics(ResultCode, ErrorMessage, Orbits[i], FSEphemerisTime(et), expected);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            EXPECT_TRUE(IsNear(expected, States[i], 1e-6, 1e-9)) << "orbit " << i << " et " << et;
+        }
+
+        EXPECT_EQ(States.Last().r.x.km, 0.);
+    }
+}
+
+TEST(secular_batch_test, SunSynchronous_Precession) {
+
+    FZonalHarmonics Earth;
+    Earth.Radius = 6378.137;
+    Earth.J2 = 1.08262668e-3;
+
+    // 800 km, sun-synchronous
+    const double inc = FMath::DegreesToRadians(98.6);
+    TArray<FSConicElements> Orbits = { Elements(7171., .001, inc, 1.0, .5, .0, 0.) };
+
+    FSecularBatchPropagator Batch;
+    Batch.Build(Orbits, Earth);
+
+    double NodeRate, PeriapsisRate, MeanAnomalyRate;
+    Batch.GetRates(0, NodeRate, PeriapsisRate, MeanAnomalyRate);
+    EXPECT_NEAR(FMath::RadiansToDegrees(NodeRate) * 86400., 360. / 365.2422, 2e-3);
+    EXPECT_LT(PeriapsisRate, 0.);
+    EXPECT_LT(MeanAnomalyRate, sqrt(gm_earth / (7178.18 * 7178.18 * 7178.18)));
+
+    // The propagated orbit plane has turned by the node rate
+    TArray<FSStateVector> States;
+    States.SetNum(1);
+    for (double dt : { 0., 86400., 86400. * 30. })
+    {
+        ASSERT_EQ(Batch.Propagate(FSEphemerisTime(dt), States), 1);
+
+        double s[6]; States[0].CopyTo(s);
+        const double h[3] = { s[1] * s[5] - s[2] * s[4], s[2] * s[3] - s[0] * s[5], s[0] * s[4] - s[1] * s[3] };
+        const double node = atan2(h[0], -h[1]);
+        const double expected = 1.0 + NodeRate * dt;
+        EXPECT_NEAR(FMath::Fmod(node - expected + 3. * PI, 2. * PI) - PI, 0., 1e-9) << "dt " << dt;
+        EXPECT_NEAR(acos(h[2] / sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2])), inc, 1e-9);
+    }
+}
+
+TEST(secular_batch_test, Zonals_FromKernelPool) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    USpice::pdpool(ResultCode, ErrorMessage, TEXT("BODY9994_J2"), 1e-3);
+
+    FZonalHarmonics Zonals;
+    ASSERT_TRUE(FZonalHarmonics::FromKernelPool(9994, Zonals, true, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(Zonals.J2, 1e-3);
+    EXPECT_EQ(Zonals.J4, 0.);
+
+    FSDistanceVector Radii;
+    USpice::bodvrd_distance_vector(ResultCode, ErrorMessage, Radii, TEXT("FAKEBODY9994"), TEXT("RADII"));
+    EXPECT_EQ(Zonals.Radius, Radii.x.km);
+
+    USpice::pdpool(ResultCode, ErrorMessage, TEXT("BODY9994_J4"), -1e-6);
+    ASSERT_TRUE(FZonalHarmonics::FromKernelPool(9994, Zonals));
+    EXPECT_EQ(Zonals.J4, -1e-6);
+    ASSERT_TRUE(FZonalHarmonics::FromKernelPool(9994, Zonals, false));
+    EXPECT_EQ(Zonals.J4, 0.);
+
+    // No J2
+    EXPECT_FALSE(FZonalHarmonics::FromKernelPool(9995, Zonals, true, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
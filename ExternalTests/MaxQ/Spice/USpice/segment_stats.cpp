@@ -0,0 +1,86 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSegmentStats.h"
+#include "SpiceCoverageIndex.h"
+#include "SpiceCore.h"
+
+
+TEST(segment_stats_test, Reports_Segment_Table_Usage) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    MaxQ::Data::FSegmentBufferReport Report;
+    EXPECT_TRUE(MaxQ::Data::GetSegmentBufferReport(Report, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Report.Spk.Files, 0);
+    EXPECT_EQ(Report.Spk.Segments, 0);
+    EXPECT_GT(Report.Spk.SegmentCapacity, 0);
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    EXPECT_TRUE(MaxQ::Data::GetSegmentBufferReport(Report, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    MaxQ::Data::FKernelCoverageIndex Index;
+    Index.AddLoaded();
+    EXPECT_GE(Report.Spk.Files, 1);
+    EXPECT_EQ(Report.Spk.Ids, Index.Ids(MaxQ::Data::EKernelCoverageType::SPK).Num());
+    EXPECT_GE(Report.Spk.Segments, Report.Spk.Ids);
+    EXPECT_GE(Report.Spk.BusiestIdSegments, 1);
+    EXPECT_FALSE(Report.Spk.MayThrash());
+    EXPECT_FALSE(Report.Spk.IsUnbuffered());
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(segment_stats_test, Reports_File_Unit_Usage) {
+
+    USpice::init_all();
+    MaxQ::Data::ResetFileUnitUsage();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    MaxQ::Data::FFileUnitUsage Usage;
+    EXPECT_TRUE(MaxQ::Data::GetFileUnitUsage(Usage, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_GE(Usage.Capacity, 23);
+    EXPECT_GE(Usage.MaxUnitNumber, Usage.Capacity);
+    EXPECT_GE(Usage.BinaryKernels, 1);
+    EXPECT_FALSE(Usage.MayThrash());
+
+    // The stock toolkit doesn't count
+    if (!Usage.bCounted)
+    {
+        EXPECT_EQ(Usage.Requests, 0);
+        MaxQ::Core::ClearAll();
+        return;
+    }
+
+    EXPECT_GE(Usage.Units, 1);
+    EXPECT_GE(Usage.PeakUnits, Usage.Units);
+
+    // Opening and reading the kernels' records asked for their units
+    EXPECT_GT(Usage.Requests, 0);
+    EXPECT_LE(Usage.Reopens, Usage.Requests);
+
+    MaxQ::Data::ResetFileUnitUsage();
+    EXPECT_TRUE(MaxQ::Data::GetFileUnitUsage(Usage));
+    EXPECT_EQ(Usage.Requests, 0);
+    EXPECT_EQ(Usage.Reopens, 0);
+    EXPECT_EQ(Usage.PeakUnits, Usage.Units);
+
+    MaxQ::Core::ClearAll();
+}
@@ -0,0 +1,84 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSession.h"
+#include "SpiceData.h"
+#include "SpiceCore.h"
+#include "SpiceTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+
+TEST(session_test, Save_And_Restore) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    const FString Directory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MaxQTests"), TEXT("Session")));
+    const FString KernelPath = FPaths::Combine(Directory, TEXT("session_test.tpc"));
+    ASSERT_TRUE(FFileHelper::SaveStringToFile(FString(TEXT("KPL/PCK\n\\begindata\nBODY9993_MAXQ_SESSION = ( 42 )\n\\begintext\n")), *KernelPath));
+
+    MaxQ::Data::Furnsh(KernelPath, &ResultCode, &ErrorMessage);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    // Runtime changes, on top of the kernel
+    USpice::pdpool_list(ResultCode, ErrorMessage, TEXT("MAXQ_SESSION_NUMBERS"), { 1., 2., 3. });
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    MaxQ::Data::Boddef(TEXT("MAXQ_SESSION_BODY"), 9993);
+
+    MaxQ::Time::FEtClock& Clock = MaxQ::Time::GetEtClock();
+    Clock.Anchor(1.e8);
+    Clock.SetRate(2.);
+
+    TArray<uint8> Session;
+    EXPECT_TRUE(MaxQ::Data::SaveSession(Session, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    MaxQ::Core::ClearAll();
+    Clock.Anchor(0.);
+    Clock.SetRate(1.);
+
+    EXPECT_TRUE(MaxQ::Data::RestoreSession(Session, true, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    double Value = MaxQ::Data::Gdpool(TEXT("BODY9993_MAXQ_SESSION"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(Value, 42.);
+
+    FSDimensionlessVector v = MaxQ::Data::Gdpool<FSDimensionlessVector>(TEXT("MAXQ_SESSION_NUMBERS"), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_DOUBLE_EQ(v.z, 3.);
+
+    ES_FoundCode Found = ES_FoundCode::NotFound;
+    int Code = 0;
+    USpice::bodn2c(Found, Code, TEXT("MAXQ_SESSION_BODY"));
+    EXPECT_EQ(Found, ES_FoundCode::Found);
+    EXPECT_EQ(Code, 9993);
+
+    // The text kernel is in the history, as if it had been loaded
+    TArray<MaxQ::Data::FKernelHistoryEntry> History;
+    MaxQ::Data::GetKernelHistory(History);
+    EXPECT_TRUE(History.ContainsByPredicate([&](const MaxQ::Data::FKernelHistoryEntry& Entry)
+    {
+        return Entry.Operation == MaxQ::Data::FKernelHistoryEntry::EOperation::Furnsh && FPaths::IsSamePath(Entry.AbsolutePath, KernelPath);
+    }));
+
+    EXPECT_DOUBLE_EQ(Clock.GetRate(), 2.);
+    EXPECT_NEAR(Clock.Now(), 1.e8, 10.);
+
+    Clock.AnchorToNow();
+    Clock.SetRate(1.);
+
+    // Garbage is rejected
+    TArray<uint8> Garbage{ 1, 2, 3, 4, 5, 6, 7, 8 };
+    EXPECT_FALSE(MaxQ::Data::RestoreSession(Garbage, true, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
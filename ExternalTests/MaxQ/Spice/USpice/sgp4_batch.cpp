@@ -0,0 +1,78 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSGP4Batch.h"
+
+using namespace MaxQ::Orbits;
+
+TEST(sgp4_batch_test, Batch_Matches_Scalar) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    double _geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+    FSTLEGeophysicalConstants geophs(_geophs);
+
+    const TCHAR* tles[][2] = {
+        // Near earth
+        { TEXT("1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999"),
+          TEXT("2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544") },
+        // Deep space (Molniya)
+        { TEXT("1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813"),
+          TEXT("2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656") },
+    };
+
+    // Mix of near earth, deep space and uninitialized, not a multiple of the lane width
+    TArray<FSGP4Propagator> Catalog;
+    FSEphemerisTime epoch;
+    for (int i = 0; i < 603; ++i)
+    {
+        FSTwoLineElements elems;
+        USpice::getelm(ResultCode, ErrorMessage, epoch, elems, tles[i % 7 == 0][0], tles[i % 7 == 0][1]);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        elems.elems[FSTwoLineElements::XMO] += i * 0.001;
+        Catalog.Emplace(geophs, elems);
+    }
+    Catalog.AddDefaulted();
+
+    FSGP4BatchPropagator Batch;
+    Batch.Build(Catalog);
+    EXPECT_EQ(Batch.Num(), Catalog.Num());
+    EXPECT_GT(Batch.NumBatched(), 0);
+
+    for (int j = 0; j < 3; ++j)
+    {
+        FSEphemerisTime et = epoch + j * FSEphemerisPeriod::Day;
+
+        FSGP4CatalogStates Expected, Actual;
+        int32 ExpectedCount = PropagateCatalog(Catalog, et, Expected, true);
+        int32 ActualCount = Batch.Propagate(et, Actual, true);
+
+        EXPECT_EQ(ActualCount, ExpectedCount);
+        ASSERT_EQ(Actual.Num(), Expected.Num());
+
+        for (int i = 0; i < Catalog.Num(); ++i)
+        {
+            EXPECT_EQ(Actual.Status[i], Expected.Status[i]);
+            EXPECT_NEAR(Actual.X[i], Expected.X[i], 1e-6);
+            EXPECT_NEAR(Actual.Y[i], Expected.Y[i], 1e-6);
+            EXPECT_NEAR(Actual.Z[i], Expected.Z[i], 1e-6);
+            EXPECT_NEAR(Actual.VX[i], Expected.VX[i], 1e-9);
+            EXPECT_NEAR(Actual.VY[i], Expected.VY[i], 1e-9);
+            EXPECT_NEAR(Actual.VZ[i], Expected.VZ[i], 1e-9);
+        }
+    }
+}
@@ -0,0 +1,173 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSGP4.h"
+
+using namespace MaxQ::Orbits;
+
+static FSTLEGeophysicalConstants WGS72()
+{
+    double geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+    return FSTLEGeophysicalConstants(geophs);
+}
+
+static void CompareToEvsgp4(const FString& line1, const FString& line2)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSEphemerisTime epoch;
+    FSTwoLineElements elems;
+    USpice::getelm(ResultCode, ErrorMessage, epoch, elems, line1, line2);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FSTLEGeophysicalConstants geophs = WGS72();
+
+    FSGP4Propagator Propagator(geophs, elems, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+    ASSERT_TRUE(Propagator.IsValid());
+    EXPECT_EQ(Propagator.GetEpoch().seconds, epoch.seconds);
+
+    for (int i = -4; i <= 8; ++i)
+    {
+        FSEphemerisTime et = epoch + i * 0.5 * FSEphemerisPeriod::Day;
+
+        FSStateVector expected;
+        USpice::evsgp4(ResultCode, ErrorMessage, expected, et, geophs, elems, false);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        FSStateVector actual;
+        Propagator.Propagate(et, actual, &ResultCode, &ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_TRUE(IsNear(expected, actual, 1e-6));
+
+        // Native
+        double state[6];
+        EXPECT_EQ(Propagator.Propagate(et.seconds, state), ESGP4Status::Ok);
+        EXPECT_TRUE(IsNear(expected, FSStateVector(state), 1e-6));
+    }
+}
+
+TEST(sgp4_propagator_test, NearEarth_Matches_evsgp4) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    CompareToEvsgp4(
+        TEXT("1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999"),
+        TEXT("2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544")
+    );
+}
+
+TEST(sgp4_propagator_test, DeepSpace_Matches_evsgp4) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    // Molniya (12 hour resonance)
+    CompareToEvsgp4(
+        TEXT("1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813"),
+        TEXT("2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656")
+    );
+
+    // GPS (deep space, but not resonant)
+    CompareToEvsgp4(
+        TEXT("1 28129U 03058A   06175.57071136 -.00000104  00000-0  10000-3 0   459"),
+        TEXT("2 28129  54.7298 324.8098 0048506 266.2640  93.1663  2.00562768 18443")
+    );
+
+    // Geosynchronous (24 hour resonance)
+    CompareToEvsgp4(
+        TEXT("1 28626U 05008A   06176.46683397 -.00000205  00000-0  10000-3 0  2190"),
+        TEXT("2 28626   0.0019 286.9433 0000335  13.7918  55.6504  1.00271328  1861")
+    );
+}
+
+TEST(sgp4_propagator_test, Uninitialized_Signals) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FSGP4Propagator Propagator;
+    EXPECT_FALSE(Propagator.IsValid());
+
+    double state[6];
+    EXPECT_EQ(Propagator.Propagate(0., state), ESGP4Status::NotInitialized);
+
+    FSStateVector sv;
+    Propagator.Propagate(FSEphemerisTime(0.), sv, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+}
+
+TEST(sgp4_propagator_test, PropagateCatalog_Matches_Propagate) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FSEphemerisTime epoch;
+    FSTwoLineElements elems;
+    USpice::getelm(ResultCode, ErrorMessage, epoch, elems,
+        TEXT("1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999"),
+        TEXT("2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544"));
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    // Enough objects to span several batches, and one uninitialized one
+    TArray<FSGP4Propagator> Catalog;
+    for (int i = 0; i < 1000; ++i)
+    {
+        FSTwoLineElements perturbed = elems;
+        perturbed.elems[FSTwoLineElements::XMO] += i * 0.001;
+        Catalog.Emplace(WGS72(), perturbed);
+    }
+    Catalog.AddDefaulted();
+
+    FSEphemerisTime et = epoch + FSEphemerisPeriod::Day;
+
+    FSGP4CatalogStates States;
+    int32 Succeeded = PropagateCatalog(Catalog, et, States, true);
+
+    EXPECT_EQ(Succeeded, 1000);
+    ASSERT_EQ(States.Num(), Catalog.Num());
+    EXPECT_TRUE(States.HasVelocities());
+    EXPECT_EQ(States.Status.Last(), ESGP4Status::NotInitialized);
+
+    for (int i = 0; i < 1000; i += 97)
+    {
+        double state[6];
+        EXPECT_EQ(Catalog[i].Propagate(et.seconds, state), ESGP4Status::Ok);
+        EXPECT_EQ(States.X[i], state[0]);
+        EXPECT_EQ(States.Y[i], state[1]);
+        EXPECT_EQ(States.Z[i], state[2]);
+        EXPECT_EQ(States.VX[i], state[3]);
+        EXPECT_EQ(States.VY[i], state[4]);
+        EXPECT_EQ(States.VZ[i], state[5]);
+    }
+}
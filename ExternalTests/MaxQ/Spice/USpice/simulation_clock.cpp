@@ -0,0 +1,97 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSimulationClock.h"
+
+using MaxQ::Time::FSimulationClock;
+
+
+TEST(simulation_clock_test, StepEpochs_DontDependOnFrames) {
+
+    const double Step = 60.;
+
+    // The same second of game time, in different frame rates
+    FSimulationClock A(et0, Step), B(et0, Step);
+    A.SetTimeScale(3600.);
+    B.SetTimeScale(3600.);
+
+    int32 StepsA = 0, StepsB = 0;
+    for (int i = 0; i < 60; ++i) StepsA += A.Advance(1. / 60., 1000);
+    for (int i = 0; i < 144; ++i) StepsB += B.Advance(1. / 144., 1000);
+
+    EXPECT_EQ(StepsA, 60);
+    EXPECT_EQ(StepsB, 60);
+    EXPECT_EQ(A.GetStep(), B.GetStep());
+
+    // Bit-identical, not just close
+    EXPECT_EQ(A.GetStepEpoch(), et0 + 60. * Step);
+    EXPECT_EQ(A.GetStepEpoch(), B.GetStepEpoch());
+}
+
+
+TEST(simulation_clock_test, RenderEpoch_IsBetweenComputedSteps) {
+
+    FSimulationClock Clock(et0, 10.);
+    Clock.SetTimeScale(1.);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        Clock.Advance(0.37);
+        const double Render = Clock.GetRenderEpoch();
+        EXPECT_GE(Render, Clock.StepEpoch(Clock.GetStep() - 1));
+        EXPECT_LT(Render, Clock.GetStepEpoch());
+        EXPECT_GE(Clock.GetAlpha(), 0.);
+        EXPECT_LT(Clock.GetAlpha(), 1.);
+    }
+}
+
+
+TEST(simulation_clock_test, Rewinds_AreExact) {
+
+    FSimulationClock Clock(et0, 0.5);
+    Clock.SetTimeScale(1.);
+    Clock.Advance(10.25, 100);
+    EXPECT_EQ(Clock.GetStep(), 20);
+
+    const double Epoch = Clock.GetStepEpoch();
+
+    // Backwards
+    Clock.SetTimeScale(-1.);
+    EXPECT_EQ(Clock.Advance(2.5, 100), -5);
+    EXPECT_EQ(Clock.GetStep(), 15);
+
+    // ...and back again
+    Clock.Seek(20);
+    EXPECT_EQ(Clock.GetStepEpoch(), Epoch);
+    EXPECT_EQ(Clock.GetAlpha(), 0.);
+
+    // A hitch is capped
+    Clock.SetTimeScale(1.);
+    EXPECT_EQ(Clock.Advance(100., 8), 8);
+    EXPECT_EQ(Clock.GetStep(), 28);
+}
+
+
+TEST(simulation_clock_test, Quantize) {
+
+    FSimulationClock Clock(et0, 30.);
+
+    EXPECT_EQ(Clock.Quantize(et0), 0);
+    EXPECT_EQ(Clock.Quantize(et0 + 29.999), 0);
+    EXPECT_EQ(Clock.Quantize(et0 + 30.), 1);
+    EXPECT_EQ(Clock.Quantize(et0 - 0.001), -1);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        const double et = et0 + i * 0.731;
+        const double q = Clock.QuantizeEpoch(et);
+        EXPECT_LE(q, et);
+        EXPECT_GT(q + 30., et);
+    }
+}
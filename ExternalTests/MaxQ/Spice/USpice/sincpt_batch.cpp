@@ -0,0 +1,177 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSincptBatch.h"
+#include "SpiceDskBvh.h"
+
+using namespace MaxQ::Math;
+
+static const double Identity[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+
+static FInterceptGeometry Geometry(double a, double b, double c, const FSDistanceVector& Observer)
+{
+    FInterceptGeometry Geometry;
+    Geometry.Observer = Observer;
+    Geometry.ToJ2000 = FSRotationMatrix(Identity);
+    Geometry.FromJ2000 = FSRotationMatrix(Identity);
+    Geometry.Radii = FSDistanceVector(a, b, c);
+    Geometry.FixRefCode = 10014;
+    return Geometry;
+}
+
+struct FBatch
+{
+    TArray<double> X, Y, Z, SX, SY, SZ;
+    TArray<uint8> Found;
+    FVectorBatch SurfaceVectors;
+
+    FBatch(int32 Num)
+    {
+        X.SetNum(Num); Y.SetNum(Num); Z.SetNum(Num);
+        SX.SetNum(Num); SY.SetNum(Num); SZ.SetNum(Num);
+        Found.SetNum(Num);
+        SurfaceVectors = { SX, SY, SZ };
+    }
+
+    FInterceptBatch Intercepts() { return { { X, Y, Z }, Found, &SurfaceVectors }; }
+};
+
+
+TEST(sincpt_batch_test, Ellipsoid_Hits_And_Misses) {
+
+    const FInterceptGeometry G = Geometry(2., 3., 4., FSDistanceVector(10., 0., 0.));
+
+    // Center, off center, miss, away, zero
+    TArray<double> DX = { -1., -10., -1., 1., 0. }, DY = { 0., 1.5, 0., 0., 0. }, DZ = { 0., 0., 1., 0., 0. };
+    FBatch Batch(5);
+    ASSERT_TRUE(SurfaceIntercepts(G, FConstVectorBatch(DX, DY, DZ), Batch.Intercepts()));
+
+    EXPECT_EQ(Batch.Found[0], 1);
+    EXPECT_NEAR(Batch.X[0], 2., 1e-12);
+    EXPECT_NEAR(Batch.SX[0], -8., 1e-12);
+
+    // The near root, on the ellipsoid
+    EXPECT_EQ(Batch.Found[1], 1);
+    const double x = Batch.X[1] / 2., y = Batch.Y[1] / 3., z = Batch.Z[1] / 4.;
+    EXPECT_NEAR(x * x + y * y + z * z, 1., 1e-12);
+    EXPECT_GT(Batch.X[1], 0.);
+
+    EXPECT_EQ(Batch.Found[2], 0);
+    EXPECT_EQ(Batch.Found[3], 0);
+    EXPECT_EQ(Batch.Found[4], 0);
+    EXPECT_EQ(Batch.X[4], 0.);
+}
+
+
+TEST(sincpt_batch_test, Inside_And_Bad_Arguments) {
+
+    TArray<double> DX = { 1. }, DY = { 0. }, DZ = { 0. };
+    FBatch Batch(1);
+
+    // sincpt signals an error from inside;  this misses
+    ASSERT_TRUE(SurfaceIntercepts(Geometry(2., 2., 2., FSDistanceVector(0.5, 0., 0.)), FConstVectorBatch(DX, DY, DZ), Batch.Intercepts()));
+    EXPECT_EQ(Batch.Found[0], 0);
+
+    // No radii
+    EXPECT_FALSE(SurfaceIntercepts(Geometry(0., 0., 0., FSDistanceVector(10., 0., 0.)), FConstVectorBatch(DX, DY, DZ), Batch.Intercepts()));
+
+    // Lengths differ
+    FBatch Short(0);
+    EXPECT_FALSE(SurfaceIntercepts(Geometry(2., 2., 2., FSDistanceVector(10., 0., 0.)), FConstVectorBatch(DX, DY, DZ), Short.Intercepts()));
+}
+
+
+TEST(sincpt_batch_test, Rotates_Into_Fixref) {
+
+    FInterceptGeometry G = Geometry(1., 1., 1., FSDistanceVector(0., 5., 0.));
+
+    // dref's +x is fixref's -y
+    const double ToFixref[3][3] = { { 0., 1., 0. }, { -1., 0., 0. }, { 0., 0., 1. } };
+    G.FromJ2000 = FSRotationMatrix(ToFixref);
+
+    TArray<double> DX = { 1. }, DY = { 0. }, DZ = { 0. };
+    FBatch Batch(1);
+    ASSERT_TRUE(SurfaceIntercepts(G, FConstVectorBatch(DX, DY, DZ), Batch.Intercepts()));
+    EXPECT_EQ(Batch.Found[0], 1);
+    EXPECT_NEAR(Batch.Y[0], 1., 1e-12);
+}
+
+
+TEST(sincpt_batch_test, Removes_Stellar_Aberration) {
+
+    // Moving +y at 1/1000 c, looking -x:  apparent directions lean toward +y,
+    // so the geometric one leans toward -y, by asin(1e-3)
+    const double Range = 1000.;
+    FInterceptGeometry G = Geometry(1., 1., 1., FSDistanceVector(Range, 0., 0.));
+    G.bStellarAberration = true;
+    G.ObserverVelocity = FSVelocityVector(0., 299.792458, 0.);
+
+    TArray<double> DX = { -1. }, DY = { 0. }, DZ = { 0. };
+    FBatch Batch(1);
+    ASSERT_TRUE(SurfaceIntercepts(G, FConstVectorBatch(DX, DY, DZ), Batch.Intercepts()));
+    ASSERT_EQ(Batch.Found[0], 1);
+
+    const FVector3d d = FVector3d(Batch.SX[0], Batch.SY[0], Batch.SZ[0]).GetSafeNormal();
+    EXPECT_LT(d.Y, 0.);
+    EXPECT_NEAR(atan2(-d.Y, -d.X), asin(1.e-3), 1e-8);
+
+    // Transmission corrects the other way
+    G.bTransmission = true;
+    ASSERT_TRUE(SurfaceIntercepts(G, FConstVectorBatch(DX, DY, DZ), Batch.Intercepts()));
+    EXPECT_GT(Batch.SY[0], 0.);
+}
+
+
+TEST(sincpt_batch_test, Dsk_Matches_Bvh) {
+
+    // A unit cube, in the same frame as the geometry
+    TArray<double> Vertices;
+    for (int i = 0; i < 8; ++i)
+    {
+        Vertices.Append({ (i & 1) ? 1. : -1., (i & 2) ? 1. : -1., (i & 4) ? 1. : -1. });
+    }
+    const TArray<int32> Plates = {
+        1, 3, 4,  1, 4, 2,   5, 6, 8,  5, 8, 7,   1, 2, 6,  1, 6, 5,
+        3, 7, 8,  3, 8, 4,   1, 5, 7,  1, 7, 3,   2, 4, 8,  2, 8, 6
+    };
+    MaxQ::Dsk::FDskShapeModel Shape;
+    ASSERT_TRUE(Shape.AddSegment(Vertices, Plates, 10014));
+
+    const FInterceptGeometry G = Geometry(1., 1., 1., FSDistanceVector(5., 0.3, -0.2));
+    TArray<double> DX, DY, DZ;
+    for (int32 i = 0; i < 500; ++i)
+    {
+        DX.Add(-1.); DY.Add(-0.3 + 0.004 * (i % 25) - 0.05); DZ.Add(0.2 + 0.01 * (i / 25) - 0.1);
+    }
+
+    FBatch Batch(DX.Num());
+    ASSERT_TRUE(SurfaceIntercepts(G, FConstVectorBatch(DX, DY, DZ), Batch.Intercepts(), &Shape));
+    for (int32 i = 0; i < DX.Num(); ++i)
+    {
+        FSRay Ray;
+        Ray.point = FSDistanceVector(5., 0.3, -0.2);
+        Ray.direction = FSDimensionlessVector(DX[i], DY[i], DZ[i]);
+        MaxQ::Dsk::FDskHit Hit;
+        const bool bFound = Shape.Intersect(Ray, Hit);
+        ASSERT_EQ(Batch.Found[i], bFound ? 1 : 0);
+        if (bFound)
+        {
+            double p[3];
+            Hit.Point.CopyTo(p);
+            EXPECT_NEAR(Batch.X[i], p[0], 1e-12);
+            EXPECT_NEAR(Batch.Y[i], p[1], 1e-12);
+            EXPECT_NEAR(Batch.Z[i], p[2], 1e-12);
+        }
+    }
+
+    // The shape's frame must be fixref
+    FInterceptGeometry Other = G;
+    Other.FixRefCode = 10020;
+    EXPECT_FALSE(SurfaceIntercepts(Other, FConstVectorBatch(DX, DY, DZ), Batch.Intercepts(), &Shape));
+}
@@ -0,0 +1,155 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSpatialIndex.h"
+
+using namespace MaxQ::Math;
+
+// Points in a LEO-ish shell, a few left out
+static void Points(int Count, TArray<double>& X, TArray<double>& Y, TArray<double>& Z, TArray<uint8>& Valid)
+{
+    FRandomStream Random(1234);
+    for (int i = 0; i < Count; ++i)
+    {
+        const FVector Direction = Random.GetUnitVector();
+        const double r = Random.FRandRange(6700., 7500.);
+        X.Add(Direction.X * r);
+        Y.Add(Direction.Y * r);
+        Z.Add(Direction.Z * r);
+        Valid.Add(i % 17 == 3 ? 0 : 1);
+    }
+}
+
+static double Distance(const TArray<double>& X, const TArray<double>& Y, const TArray<double>& Z, int i, const double(&c)[3])
+{
+    return sqrt((X[i] - c[0]) * (X[i] - c[0]) + (Y[i] - c[1]) * (Y[i] - c[1]) + (Z[i] - c[2]) * (Z[i] - c[2]));
+}
+
+
+TEST(spatial_index_test, Matches_Brute_Force) {
+
+    TArray<double> X, Y, Z;
+    TArray<uint8> Valid;
+    Points(5000, X, Y, Z, Valid);
+
+    FSpatialIndex Index;
+    Index.Build(FConstVectorBatch(X, Y, Z), Valid);
+
+    int NumValid = 0;
+    for (uint8 v : Valid) NumValid += v;
+    EXPECT_EQ(Index.Num(), NumValid);
+
+    const double c[3] = { 7000., 100., -200. };
+    const FSDistanceVector Center(c[0], c[1], c[2]);
+
+    // Within
+    TArray<FSpatialHit> Hits;
+    Index.Within(Center, 500., Hits);
+    TArray<int32> Expected;
+    for (int i = 0; i < X.Num(); ++i)
+    {
+        if (Valid[i] && Distance(X, Y, Z, i, c) <= 500.) Expected.Add(i);
+    }
+    ASSERT_EQ(Hits.Num(), Expected.Num());
+    ASSERT_GT(Hits.Num(), 0);
+    for (int i = 1; i < Hits.Num(); ++i) EXPECT_LE(Hits[i - 1].Distance, Hits[i].Distance);
+    TArray<int32> Found;
+    for (const FSpatialHit& Hit : Hits) Found.Add(Hit.Index);
+    Found.Sort();
+    EXPECT_EQ(Found, Expected);
+
+    // Nearest
+    Index.Nearest(Center, 10, Hits);
+    ASSERT_EQ(Hits.Num(), 10);
+    TArray<double> Distances;
+    for (int i = 0; i < X.Num(); ++i)
+    {
+        if (Valid[i]) Distances.Add(Distance(X, Y, Z, i, c));
+    }
+    Distances.Sort();
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_NEAR(Hits[i].Distance, Distances[i], 1.e-9);
+        EXPECT_NEAR(Distance(X, Y, Z, Hits[i].Index, c), Distances[i], 1.e-9);
+    }
+
+    // Pairs
+    TArray<TPair<int32, int32>> Pairs;
+    Index.Pairs(50., Pairs);
+    TArray<TPair<int32, int32>> ExpectedPairs;
+    for (int i = 0; i < X.Num(); ++i)
+    {
+        if (!Valid[i]) continue;
+        const double p[3] = { X[i], Y[i], Z[i] };
+        for (int j = i + 1; j < X.Num(); ++j)
+        {
+            if (Valid[j] && Distance(X, Y, Z, j, p) < 50.) ExpectedPairs.Emplace(i, j);
+        }
+    }
+    ASSERT_GT(ExpectedPairs.Num(), 0);
+    EXPECT_EQ(Pairs, ExpectedPairs);
+}
+
+
+TEST(spatial_index_test, Raycast_Picks_Nearest_In_Cone) {
+
+    TArray<double> X, Y, Z;
+    TArray<uint8> Valid;
+    Points(5000, X, Y, Z, Valid);
+
+    FSpatialIndex Index;
+    Index.Build(FConstVectorBatch(X, Y, Z), Valid);
+
+    // From well outside the shell, toward a few of the points
+    const double o[3] = { 30000., 20000., 10000. };
+    FSRay Ray;
+    Ray.point = FSDistanceVector(o[0], o[1], o[2]);
+
+    const double Angle = 2.e-3;
+    for (int Target : { 0, 100, 2500 })
+    {
+        const double d[3] = { X[Target] - o[0], Y[Target] - o[1], Z[Target] - o[2] };
+        const double Length = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        Ray.direction = FSDimensionlessVector(d[0], d[1], d[2]);
+
+        double Best = -1.;
+        int32 BestIndex = INDEX_NONE;
+        for (int i = 0; i < X.Num(); ++i)
+        {
+            if (!Valid[i]) continue;
+            const double v[3] = { X[i] - o[0], Y[i] - o[1], Z[i] - o[2] };
+            const double t = (v[0] * d[0] + v[1] * d[1] + v[2] * d[2]) / Length;
+            const double Perpendicular = sqrt(FMath::Max(0., v[0] * v[0] + v[1] * v[1] + v[2] * v[2] - t * t));
+            if (t >= 0. && Perpendicular <= tan(Angle) * t && (BestIndex == INDEX_NONE || t < Best))
+            {
+                Best = t;
+                BestIndex = i;
+            }
+        }
+
+        FSpatialHit Hit;
+        const bool bHit = Index.Raycast(Ray, 0., Angle, Hit);
+        EXPECT_EQ(bHit, BestIndex != INDEX_NONE);
+        EXPECT_EQ(Hit.Index, BestIndex);
+        if (bHit) EXPECT_NEAR(Hit.Distance, Best, 1.e-6);
+    }
+
+    // Away from everything
+    Ray.direction = FSDimensionlessVector(1., 0., 0.);
+    FSpatialHit Hit;
+    EXPECT_FALSE(Index.Raycast(Ray, 1., 0., Hit));
+
+    // Nothing indexed
+    Index.Reset();
+    EXPECT_EQ(Index.Num(), 0);
+    EXPECT_FALSE(Index.Raycast(Ray, 1., 0.1, Hit));
+    TArray<FSpatialHit> Hits;
+    Index.Nearest(FSDistanceVector(), 3, Hits);
+    EXPECT_EQ(Hits.Num(), 0);
+}
@@ -0,0 +1,109 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceCore.h"
+#include "SpiceContext.h"
+#include "Misc/Paths.h"
+
+using namespace MaxQ::Core;
+
+namespace
+{
+    int TotalKernels(ES_KernelType Type)
+    {
+        int count = 0;
+        USpice::ktotal(count, (int32)Type);
+        return count;
+    }
+}
+
+
+TEST(spice_context_test, Clear_All_Keeps_Other_Contexts_Kernels) {
+
+    USpice::init_all();
+
+    const FString Lsk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_lsk.tls"));
+    const FString Spk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"));
+
+    {
+        FSpiceContext Client1(TEXT("Client1"));
+        FSpiceContext Client2(TEXT("Client2"));
+
+        ES_ResultCode ResultCode = ES_ResultCode::Error;
+        FString ErrorMessage;
+        EXPECT_TRUE(Client1.Furnsh(TArray<FString>{ Lsk, Spk }, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_TRUE(Client2.Furnsh(Spk));
+
+        // Shared, so loaded once
+        EXPECT_EQ(TotalKernels(ES_KernelType::SPK), 1);
+        EXPECT_EQ(Client1.GetKernels().Num(), 2);
+        EXPECT_EQ(Client2.GetKernels().Num(), 1);
+
+        // Client1's Init All, through the Blueprint node
+        {
+            FSpiceContextScope Scope(&Client1);
+            EXPECT_EQ(FSpiceContext::Current(), &Client1);
+            USpice::init_all();
+        }
+        EXPECT_EQ(FSpiceContext::Current(), nullptr);
+
+        EXPECT_EQ(Client1.GetKernels().Num(), 0);
+        EXPECT_EQ(TotalKernels(ES_KernelType::TEXT), 0);
+        EXPECT_EQ(TotalKernels(ES_KernelType::SPK), 1);
+
+        FSDistanceVector r;
+        FSEphemerisPeriod lt;
+        USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+        // Only what it furnished
+        EXPECT_FALSE(Client1.Unload(Spk, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+        EXPECT_TRUE(Client2.Unload(Spk));
+        EXPECT_EQ(TotalKernels(ES_KernelType::SPK), 0);
+    }
+
+    MaxQ::Core::ClearAll();
+}
+
+
+TEST(spice_context_test, Destruction_And_Global_Clear_All) {
+
+    USpice::init_all();
+
+    const FString Lsk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_lsk.tls"));
+    const FString Spk = FPaths::ConvertRelativePathToFull(TEXT("maxq_unit_test_spk.bsp"));
+
+    FSpiceContext Server(TEXT("Server"));
+    {
+        FSpiceContext Client(TEXT("Client"));
+        {
+            FSpiceContextScope Scope(&Client);
+            ES_ResultCode ResultCode = ES_ResultCode::Error;
+            FString ErrorMessage;
+            USpice::furnsh(ResultCode, ErrorMessage, Spk);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        }
+        Server.Furnsh(Lsk);
+        EXPECT_EQ(TotalKernels(ES_KernelType::SPK), 1);
+    }
+    EXPECT_EQ(TotalKernels(ES_KernelType::SPK), 0);
+    EXPECT_EQ(TotalKernels(ES_KernelType::TEXT), 1);
+
+    // Outside any context, Clear All is everything's
+    TArray<MaxQ::Data::FKernelHistoryEntry> History;
+    const uint64 Before = Server.GetKernelHistory(History);
+    EXPECT_EQ(History.Num(), 1);
+
+    USpice::clear_all();
+    EXPECT_EQ(TotalKernels(ES_KernelType::TEXT), 0);
+    EXPECT_NE(Server.GetKernelHistory(History), Before);
+    EXPECT_EQ(History.Num(), 0);
+}
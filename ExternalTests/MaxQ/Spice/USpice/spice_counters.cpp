@@ -0,0 +1,47 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceProfiling.h"
+
+
+TEST(spice_counters_test, Counts_Lookups) {
+
+#if MAXQ_COUNTERS_ENABLED
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    MaxQ::Data::ResetSpiceCounters();
+    MaxQ::Data::FSpiceCounters Counters = MaxQ::Data::GetSpiceCounters();
+    EXPECT_EQ(Counters[MaxQ::Data::ESpiceCounter::SpkLookups], 0ull);
+    EXPECT_EQ(Counters[MaxQ::Data::ESpiceCounter::Failures], 0ull);
+
+    FSDistanceVector r;
+    FSEphemerisPeriod lt;
+    USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, TEXT("NOT A BODY"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    Counters = MaxQ::Data::GetSpiceCounters();
+    EXPECT_EQ(Counters[MaxQ::Data::ESpiceCounter::SpkLookups], 2ull);
+    EXPECT_GE(Counters[MaxQ::Data::ESpiceCounter::Failures], 1ull);
+    EXPECT_GE(Counters[MaxQ::Data::ESpiceTimer::SpkLookup], 0.);
+
+    EXPECT_EQ(MaxQ::Data::FSpiceCounters::Rate(0, 0), 0.);
+    EXPECT_EQ(MaxQ::Data::FSpiceCounters::Rate(3, 1), 0.75);
+
+    USpice::init_all();
+#endif
+}
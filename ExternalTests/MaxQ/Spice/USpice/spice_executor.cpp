@@ -0,0 +1,156 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceExecutor.h"
+#include "HAL/Event.h"
+
+
+TEST(spice_executor_test, Enqueue_Completes_On_Executor_Thread) {
+
+    USpice::init_all();
+
+    FSpiceExecutor& Executor = FSpiceExecutor::Get();
+    EXPECT_TRUE(FSpiceExecutor::IsRunning());
+    EXPECT_FALSE(FSpiceExecutor::IsInExecutorThread());
+
+    TFuture<bool> OnExecutor = Executor.Enqueue([]() { return FSpiceExecutor::IsInExecutorThread(); });
+    EXPECT_TRUE(OnExecutor.Get());
+
+    // A CSPICE call, with its result
+    TFuture<double> Dpr = Executor.Enqueue([]()
+    {
+        double value = 0.;
+        USpice::dpr(value);
+        return value;
+    });
+    EXPECT_DOUBLE_EQ(Dpr.Get(), 180. / PI);
+}
+
+
+TEST(spice_executor_test, Batches_Run_In_Order) {
+
+    FSpiceExecutor& Executor = FSpiceExecutor::Get();
+
+    constexpr int32 NumProducers = 4;
+    constexpr int32 BatchSize = 50;
+
+    // Only touched on the executor thread
+    TArray<int32> Order;
+
+    TArray<TFuture<void>> Batches;
+    FCriticalSection BatchesLock;
+
+    TArray<TFuture<void>> Producers;
+    for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+    {
+        Producers.Add(Async(EAsyncExecution::Thread, [&, Producer]()
+        {
+            TArray<FSpiceExecutor::FCommand> Commands;
+            for (int32 i = 0; i < BatchSize; ++i)
+            {
+                Commands.Add([&Order, Producer, i]() { Order.Add(Producer * BatchSize + i); });
+            }
+
+            TFuture<void> Batch = Executor.EnqueueBatch(MoveTemp(Commands));
+            FScopeLock Lock(&BatchesLock);
+            Batches.Add(MoveTemp(Batch));
+        }));
+    }
+
+    for (TFuture<void>& Producer : Producers)
+    {
+        Producer.Wait();
+    }
+    for (TFuture<void>& Batch : Batches)
+    {
+        Batch.Wait();
+    }
+
+    // Each batch back-to-back and in order, whatever order the batches ran
+    ASSERT_EQ(Order.Num(), NumProducers * BatchSize);
+    for (int32 Start = 0; Start < Order.Num(); Start += BatchSize)
+    {
+        const int32 First = Order[Start];
+        EXPECT_EQ(First % BatchSize, 0);
+        for (int32 i = 1; i < BatchSize; ++i)
+        {
+            EXPECT_EQ(Order[Start + i], First + i);
+        }
+    }
+}
+
+
+TEST(spice_executor_test, Nested_Enqueue_Runs_Inline) {
+
+    FSpiceExecutor& Executor = FSpiceExecutor::Get();
+
+    // Waiting on work enqueued from the executor thread would deadlock if
+    // it were queued behind the command waiting for it
+    TFuture<int32> Outer = Executor.Enqueue([&Executor]()
+    {
+        bool bInner = false;
+        TFuture<bool> Inner = Executor.Enqueue([&bInner]()
+        {
+            bInner = true;
+            return FSpiceExecutor::IsInExecutorThread();
+        });
+
+        // Already ran, before Enqueue returned
+        EXPECT_TRUE(bInner);
+        EXPECT_TRUE(Inner.IsReady());
+        return Inner.Get() ? 1 : 0;
+    });
+
+    EXPECT_EQ(Outer.Get(), 1);
+}
+
+
+TEST(spice_executor_test, Shutdown_Drains_Pending_Work) {
+
+    FSpiceExecutor& Executor = FSpiceExecutor::Get();
+
+    // Hold the executor while work queues up behind it
+    FEvent* Release = FPlatformProcess::GetSynchEventFromPool(true);
+    TFuture<void> Holder = Executor.Enqueue([Release]()
+    {
+        Release->Wait();
+        FPlatformProcess::Sleep(0.05f);
+    });
+
+    std::atomic<int32> Ran{ 0 };
+    TArray<TFuture<int32>> Pending;
+    for (int32 i = 0; i < 100; ++i)
+    {
+        Pending.Add(Executor.Enqueue([&Ran, i]()
+        {
+            ++Ran;
+            return i;
+        }));
+    }
+    EXPECT_EQ(Ran.load(), 0);
+
+    Release->Trigger();
+    FSpiceExecutor::Shutdown();
+    EXPECT_FALSE(FSpiceExecutor::IsRunning());
+
+    // Nothing's left waiting on a future
+    EXPECT_TRUE(Holder.IsReady());
+    EXPECT_EQ(Ran.load(), Pending.Num());
+    for (int32 i = 0; i < Pending.Num(); ++i)
+    {
+        ASSERT_TRUE(Pending[i].IsReady());
+        EXPECT_EQ(Pending[i].Get(), i);
+    }
+
+    FPlatformProcess::ReturnSynchEventToPool(Release);
+
+    // And it starts again on the next use
+    EXPECT_TRUE(FSpiceExecutor::Get().Enqueue([]() { return FSpiceExecutor::IsInExecutorThread(); }).Get());
+    EXPECT_TRUE(FSpiceExecutor::IsRunning());
+}
@@ -0,0 +1,87 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceLock.h"
+#include <thread>
+
+using MaxQ::Core::FSpiceScope;
+
+
+TEST(spice_lock_test, ErrorsStayWithTheirThread) {
+
+    USpice::init_all();
+
+    constexpr int32 NumThreads = 8;
+    constexpr int32 NumCalls = 50;
+
+    int32 Mismatches[NumThreads] = { 0 };
+    TArray<std::thread> Workers;
+    for (int32 t = 0; t < NumThreads; ++t)
+    {
+        Workers.Emplace([t, &Mismatches]()
+            {
+                for (int32 i = 0; i < NumCalls; ++i)
+                {
+                    FSpiceScope Scope;
+                    EXPECT_TRUE(FSpiceScope::IsHeld());
+
+                    const bool bFail = (t + i) % 2 == 0;
+                    if (bFail)
+                    {
+                        USpice::raise_spice_error(TEXT("Mine."), TEXT("SPICE(VALUEOUTOFRANGE)"));
+                    }
+
+                    ES_ResultCode ResultCode;
+                    FString ErrorMessage;
+                    USpice::get_implied_result(ResultCode, ErrorMessage);
+                    if ((ResultCode == ES_ResultCode::Error) != bFail)
+                    {
+                        ++Mismatches[t];
+                    }
+                }
+                EXPECT_FALSE(FSpiceScope::IsHeld());
+            });
+    }
+    for (std::thread& Worker : Workers)
+    {
+        Worker.join();
+    }
+
+    for (int32 t = 0; t < NumThreads; ++t)
+    {
+        EXPECT_EQ(Mismatches[t], 0);
+    }
+}
+
+
+TEST(spice_lock_test, UncheckedErrorsAreReset) {
+
+    USpice::init_all();
+
+    {
+        FSpiceScope Outer;
+        {
+            FSpiceScope Inner;
+            USpice::raise_spice_error(TEXT("Unchecked."), TEXT("SPICE(VALUEOUTOFRANGE)"));
+        }
+
+        // Nested scopes leave it for the outermost to check
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        USpice::get_implied_result(ResultCode, ErrorMessage);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+        USpice::raise_spice_error(TEXT("Unchecked."), TEXT("SPICE(VALUEOUTOFRANGE)"));
+    }
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+}
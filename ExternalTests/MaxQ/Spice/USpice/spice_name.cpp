@@ -0,0 +1,120 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceName.h"
+#include "SpiceEphemeris.h"
+#include "SpiceMath.h"
+
+
+TEST(spice_name_test, Interning) {
+
+    FSpiceName a(TEXT("EARTH"));
+    FSpiceName b(FString(TEXT(" earth ")));
+    FSpiceName c(TEXT("MOON"));
+
+    // Case and surrounding blanks don't matter, and the first spelling wins
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a.ToString(), TEXT("EARTH"));
+    EXPECT_STREQ(b.Ansi(), "EARTH");
+    EXPECT_STREQ(c.Ansi(), "MOON");
+
+    FSpiceName none;
+    EXPECT_TRUE(none.IsNone());
+    EXPECT_TRUE(FSpiceName(TEXT("  ")).IsNone());
+    EXPECT_STREQ(none.Ansi(), "");
+}
+
+
+TEST(spice_name_test, Matches_spkezr) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    const FSpiceName targ(TEXT("FAKEBODY9994"));
+    const FSpiceName obs(TEXT("FAKEBODY9995"));
+    const FSpiceName ref(TEXT("ECLIPJ2000"));
+
+    int Id = 0;
+    EXPECT_TRUE(targ.BodyId(Id));
+    EXPECT_EQ(Id, 9994);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        FSEphemerisTime et = et0 + i * FSEphemerisPeriod::Day;
+
+        FSStateVector expected, state;
+        FSEphemerisPeriod expectedLt, lt;
+        USpice::spkezr(ResultCode, ErrorMessage, et, expected, expectedLt, targ.ToString(), obs.ToString(), ref.ToString());
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        MaxQ::Ephemeris::Spkezr(et, state, lt, targ, obs, ref, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        EXPECT_DOUBLE_EQ(state.r.x.km, expected.r.x.km);
+        EXPECT_DOUBLE_EQ(state.r.y.km, expected.r.y.km);
+        EXPECT_DOUBLE_EQ(state.r.z.km, expected.r.z.km);
+        EXPECT_DOUBLE_EQ(state.v.dx.kmps, expected.v.dx.kmps);
+        EXPECT_DOUBLE_EQ(lt.seconds, expectedLt.seconds);
+    }
+
+    FSRotationMatrix m;
+    MaxQ::Math::Pxform(m, et0, ref, FSpiceName(TEXT("J2000")), &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    // Unknown names fail the way spkezr does
+    int Unknown = 0;
+    EXPECT_FALSE(FSpiceName(TEXT("NOT A BODY")).BodyId(Unknown));
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+}
+
+
+TEST(spice_name_test, Reresolves_after_pool_writes) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    // boddef doesn't touch the kernel history, only the pool
+    const FSpiceName body(TEXT("MAXQ NAME TEST BODY"));
+    USpice::boddef(body.ToString(), 3788041);
+
+    int Id = 0;
+    EXPECT_TRUE(body.BodyId(Id));
+    EXPECT_EQ(Id, 3788041);
+
+    USpice::boddef(body.ToString(), 3788042);
+    EXPECT_TRUE(body.BodyId(Id));
+    EXPECT_EQ(Id, 3788042);
+
+    // Nor does pipool
+    const FSpiceName frame(TEXT("MAXQ_NAME_TEST_FRAME"));
+    USpice::pipool(ResultCode, ErrorMessage, TEXT("FRAME_MAXQ_NAME_TEST_FRAME"), 1788041);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    EXPECT_TRUE(frame.FrameId(Id));
+    EXPECT_EQ(Id, 1788041);
+
+    USpice::pipool(ResultCode, ErrorMessage, TEXT("FRAME_MAXQ_NAME_TEST_FRAME"), 1788042);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    EXPECT_TRUE(frame.FrameId(Id));
+    EXPECT_EQ(Id, 1788042);
+
+    USpice::init_all();
+}
@@ -0,0 +1,99 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceScheduler.h"
+#include "HAL/Event.h"
+
+
+TEST(spice_scheduler_test, Class_Budget_Limits_Concurrency) {
+
+    USpice::init_all();
+
+    FSpiceScheduler& Scheduler = FSpiceScheduler::Get();
+    const int32 Budget = Scheduler.GetBudget(ESpiceJobClass::Background);
+    Scheduler.SetBudget(ESpiceJobClass::Background, 2);
+
+    FCriticalSection Lock;
+    int32 Concurrent = 0, Peak = 0;
+
+    TArray<TFuture<int32>> Futures;
+    for (int32 i = 0; i < 8; ++i)
+    {
+        Futures.Add(Scheduler.Launch(ESpiceJobClass::Background, [&, i]()
+        {
+            {
+                FScopeLock ScopeLock(&Lock);
+                Peak = FMath::Max(Peak, ++Concurrent);
+            }
+            FPlatformProcess::Sleep(0.01f);
+            {
+                FScopeLock ScopeLock(&Lock);
+                --Concurrent;
+            }
+            return i;
+        }));
+    }
+
+    for (int32 i = 0; i < Futures.Num(); ++i)
+    {
+        EXPECT_EQ(Futures[i].Get(), i);
+    }
+
+    EXPECT_GE(Peak, 1);
+    EXPECT_LE(Peak, 2);
+    EXPECT_EQ(Scheduler.NumRunning(ESpiceJobClass::Background), 0);
+
+    Scheduler.SetBudget(ESpiceJobClass::Background, Budget);
+}
+
+
+TEST(spice_scheduler_test, Spice_Resource_Goes_To_Highest_Class) {
+
+    USpice::init_all();
+
+    FSpiceScheduler& Scheduler = FSpiceScheduler::Get();
+
+    // Hold CSPICE while the others queue up
+    FEvent* Release = FPlatformProcess::GetSynchEventFromPool(true);
+    TFuture<void> Holder = Scheduler.Launch(ESpiceJobClass::Background, [Release]() { Release->Wait(); }, ESpiceJobResource::Spice);
+
+    while (Scheduler.NumRunning(ESpiceJobClass::Background) == 0)
+    {
+        FPlatformProcess::Sleep(0.001f);
+    }
+
+    FCriticalSection Lock;
+    TArray<ESpiceJobClass> Order;
+    auto Record = [&](ESpiceJobClass Class)
+    {
+        return [&Lock, &Order, Class]()
+        {
+            FScopeLock ScopeLock(&Lock);
+            Order.Add(Class);
+        };
+    };
+
+    TFuture<void> Background = Scheduler.Launch(ESpiceJobClass::Background, Record(ESpiceJobClass::Background), ESpiceJobResource::Spice);
+    TFuture<void> Interactive = Scheduler.Launch(ESpiceJobClass::Interactive, Record(ESpiceJobClass::Interactive), ESpiceJobResource::Spice);
+    TFuture<void> FrameCritical = Scheduler.Launch(ESpiceJobClass::FrameCritical, Record(ESpiceJobClass::FrameCritical), ESpiceJobResource::Spice);
+
+    EXPECT_EQ(Scheduler.NumQueued(ESpiceJobClass::FrameCritical), 1);
+
+    Release->Trigger();
+    Holder.Wait();
+    Background.Wait();
+    Interactive.Wait();
+    FrameCritical.Wait();
+    FPlatformProcess::ReturnSynchEventToPool(Release);
+
+    ASSERT_EQ(Order.Num(), 3);
+    EXPECT_EQ(Order[0], ESpiceJobClass::FrameCritical);
+    EXPECT_EQ(Order[1], ESpiceJobClass::Interactive);
+    EXPECT_EQ(Order[2], ESpiceJobClass::Background);
+}
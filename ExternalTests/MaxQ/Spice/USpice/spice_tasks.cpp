@@ -0,0 +1,82 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceTasks.h"
+
+
+TEST(spice_tasks_test, Chained_Stages) {
+
+    USpice::init_all();
+
+    TSpiceTask<bool> Loaded = MaxQ::Async::Furnsh(TEXT("maxq_unit_test_meta.tm"));
+
+    TSpiceTask<MaxQ::Core::TSpiceResult<FSStateVector>> State = MaxQ::Async::Spkezr(
+        et0,
+        FSpiceName(TEXT("FAKEBODY9994")),
+        FSpiceName(TEXT("FAKEBODY9995")),
+        FSpiceName(TEXT("ECLIPJ2000")),
+        ES_AberrationCorrectionWithNewtonians::None,
+        { Loaded }
+    );
+
+    // A native stage, on the task graph
+    UE::Tasks::TTask<double> Range = UE::Tasks::Launch(TEXT("Range"), [State]() mutable
+    {
+        const MaxQ::Core::TSpiceResult<FSStateVector>& Result = State.GetResult();
+        return Result.HasValue() ? Result.GetValue().r.Magnitude().km : -1.;
+    }, UE::Tasks::Prerequisites(State));
+
+    ASSERT_TRUE(Range.Wait(FTimespan::FromSeconds(30.)));
+    EXPECT_TRUE(Loaded.GetResult());
+
+    const FSDistanceVector& expected = state_target_9994_center_9995_eclipj2000_et0.r;
+    EXPECT_NEAR(Range.GetResult(), expected.Magnitude().km, 1.e-6);
+
+    // Errors come back as results
+    TSpiceTask<MaxQ::Core::TSpiceResult<FSStateVector>> Missing = MaxQ::Async::Spkezr(
+        et0,
+        FSpiceName(TEXT("NOSUCHBODY")),
+        FSpiceName(TEXT("FAKEBODY9995")),
+        FSpiceName(TEXT("ECLIPJ2000"))
+    );
+    EXPECT_TRUE(Missing.GetResult().HasError());
+
+    // ...and commands with no result
+    bool bRan = false;
+    TSpiceTask<void> Void = MaxQ::Async::Spice([&bRan]() { bRan = true; });
+    Void.Wait();
+    EXPECT_TRUE(bRan);
+}
+
+
+#if MAXQ_WITH_COROUTINES
+static FSpiceCoroutine RangePipeline(double& Range)
+{
+    bool bLoaded = co_await MaxQ::Async::Furnsh(TEXT("maxq_unit_test_meta.tm"));
+    MaxQ::Core::TSpiceResult<FSStateVector> State = co_await MaxQ::Async::Spkezr(
+        et0,
+        FSpiceName(TEXT("FAKEBODY9994")),
+        FSpiceName(TEXT("FAKEBODY9995")),
+        FSpiceName(TEXT("ECLIPJ2000"))
+    );
+    Range = bLoaded && State.HasValue() ? State.GetValue().r.Magnitude().km : -1.;
+}
+
+
+TEST(spice_tasks_test, Coroutine) {
+
+    USpice::init_all();
+
+    double Range = 0.;
+    FSpiceCoroutine Pipeline = RangePipeline(Range);
+    Pipeline.Wait();
+
+    EXPECT_NEAR(Range, state_target_9994_center_9995_eclipj2000_et0.r.Magnitude().km, 1.e-6);
+}
+#endif
@@ -0,0 +1,187 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceSpkWriter.h"
+
+using namespace MaxQ::Ephemeris;
+
+// None of these reach CSPICE (spkopn needs a project directory, which the
+// test host doesn't have), so the handle is never used.
+
+TEST(spk_segment_writer_test, Begin_RejectsBadSettings) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FSpkSegmentWriter Writer;
+
+    FSpkSegmentWriterSettings Settings;
+    Settings.Type = ESpkSegmentType::Type13;
+    Settings.Degree = 6;
+    EXPECT_FALSE(Writer.Begin(1, -999, 399, TEXT("J2000"), TEXT("TEST"), Settings, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_FALSE(Writer.IsOpen());
+
+    Settings.Type = ESpkSegmentType::Type09;
+    Settings.Degree = 28;
+    EXPECT_FALSE(Writer.Begin(1, -999, 399, TEXT("J2000"), TEXT("TEST"), Settings, &ResultCode, &ErrorMessage));
+
+    Settings.Type = ESpkSegmentType::Type05;
+    Settings.GM = 0.;
+    EXPECT_FALSE(Writer.Begin(1, -999, 399, TEXT("J2000"), TEXT("TEST"), Settings, &ResultCode, &ErrorMessage));
+
+    Settings.GM = 398600.435436;
+    EXPECT_TRUE(Writer.Begin(1, -999, 399, TEXT("J2000"), TEXT("TEST"), Settings, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+    EXPECT_TRUE(Writer.IsOpen());
+
+    // Nothing added, nothing written
+    EXPECT_TRUE(Writer.End(&ResultCode, &ErrorMessage));
+    EXPECT_EQ(Writer.NumSegments(), 0);
+    EXPECT_FALSE(Writer.IsOpen());
+}
+
+
+TEST(spk_segment_writer_test, Add_RequiresIncreasingEpochs) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FSpkSegmentWriter Writer;
+
+    FSStateVector state;
+    EXPECT_FALSE(Writer.Add(FSEphemerisTime(0.), state, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    FSpkSegmentWriterSettings Settings;
+    Settings.Degree = 7;
+    ASSERT_TRUE(Writer.Begin(1, -999, 399, TEXT("J2000"), TEXT("TEST"), Settings, &ResultCode, &ErrorMessage));
+
+    TArray<double> ets{ 0., 60., 120. };
+    TArray<FSStateVector> states;
+    states.SetNum(3);
+    EXPECT_TRUE(Writer.Add(ets, states, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Writer.NumBuffered(), 3);
+
+    // Repeated epoch:  rejected as a whole
+    TArray<double> bad{ 180., 180. };
+    TArray<FSStateVector> badStates;
+    badStates.SetNum(2);
+    EXPECT_FALSE(Writer.Add(bad, badStates, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_EQ(Writer.NumBuffered(), 3);
+
+    // Earlier than what's buffered
+    EXPECT_FALSE(Writer.Add(FSEphemerisTime(30.), state, &ResultCode, &ErrorMessage));
+
+    // Mismatched lengths
+    EXPECT_FALSE(Writer.Add(TArrayView<const double>(ets.GetData(), 2), states, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(Writer.NumBuffered(), 3);
+
+    // Degree 7 Hermite needs 4 states
+    EXPECT_FALSE(Writer.End(&ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_EQ(Writer.NumSegments(), 0);
+    EXPECT_FALSE(Writer.IsOpen());
+}
+
+
+TEST(spk_segment_writer_test, ChebyshevFit_MeetsTolerance) {
+
+    // Circular LEO, sampled once a minute for a day
+    const double mu = 398600.4418;
+    const double r0 = 7000.;
+    const double w = sqrt(mu / (r0 * r0 * r0));
+
+    auto Truth = [&](double t)
+    {
+        FSStateVector s;
+        s.r.x.km = r0 * cos(w * t);
+        s.r.y.km = r0 * sin(w * t) * 0.6;
+        s.r.z.km = r0 * sin(w * t) * 0.8;
+        s.v.dx.kmps = -r0 * w * sin(w * t);
+        s.v.dy.kmps = r0 * w * cos(w * t) * 0.6;
+        s.v.dz.kmps = r0 * w * cos(w * t) * 0.8;
+        return s;
+    };
+
+    TArray<double> ets;
+    TArray<FSStateVector> states;
+    for (int i = 0; i <= 1440; ++i)
+    {
+        ets.Add(60. * i);
+        states.Add(Truth(60. * i));
+    }
+
+    for (auto Type : { ESpkChebyshevType::Type02, ESpkChebyshevType::Type03 })
+    {
+        FSpkChebyshevFitSettings Settings;
+        Settings.Type = Type;
+
+        ES_ResultCode ResultCode = ES_ResultCode::Error;
+        FString ErrorMessage;
+
+        TArray<FSpkChebyshevSegment> Segments;
+        EXPECT_TRUE(FitChebyshevSegments(ets, states, Segments, Settings, &ResultCode, &ErrorMessage));
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        ASSERT_EQ(Segments.Num(), 1);
+
+        const FSpkChebyshevSegment& Segment = Segments[0];
+        EXPECT_DOUBLE_EQ(Segment.First, 0.);
+        EXPECT_DOUBLE_EQ(Segment.Last, 86400.);
+        EXPECT_GE(Segment.First + Segment.NumRecords() * Segment.Intlen, Segment.Last);
+        EXPECT_LE(Segment.MaxPositionErrorKm, Settings.PositionToleranceKm);
+        EXPECT_LE(Segment.MaxVelocityErrorKmps, Settings.VelocityToleranceKmps);
+
+        // Smaller than the samples
+        EXPECT_LT(Segment.Coefficients.Num(), 6 * states.Num() / 2);
+
+        // Between samples
+        for (double t = 17.; t < 86400.; t += 997.)
+        {
+            double r[3], v[3];
+            ASSERT_TRUE(Segment.Evaluate(t, r, v));
+
+            FSStateVector Expected = Truth(t);
+            EXPECT_NEAR(r[0], Expected.r.x.km, 0.001);
+            EXPECT_NEAR(r[1], Expected.r.y.km, 0.001);
+            EXPECT_NEAR(r[2], Expected.r.z.km, 0.001);
+            EXPECT_NEAR(v[0], Expected.v.dx.kmps, 0.000001);
+            EXPECT_NEAR(v[1], Expected.v.dy.kmps, 0.000001);
+            EXPECT_NEAR(v[2], Expected.v.dz.kmps, 0.000001);
+        }
+
+        double r[3], v[3];
+        EXPECT_FALSE(Segment.Evaluate(-1., r, v));
+        EXPECT_FALSE(Segment.Evaluate(86401., r, v));
+    }
+}
+
+
+TEST(spk_segment_writer_test, ChebyshevFit_RejectsBadSamples) {
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    TArray<FSpkChebyshevSegment> Segments;
+    TArray<FSStateVector> states;
+    states.SetNum(3);
+
+    TArray<double> one{ 0. };
+    EXPECT_FALSE(FitChebyshevSegments(one, TArrayView<const FSStateVector>(states.GetData(), 1), Segments, FSpkChebyshevFitSettings(), &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+
+    TArray<double> unsorted{ 0., 10., 5. };
+    EXPECT_FALSE(FitChebyshevSegments(unsorted, states, Segments, FSpkChebyshevFitSettings(), &ResultCode, &ErrorMessage));
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_EQ(Segments.Num(), 0);
+}
@@ -0,0 +1,177 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceEphemeris.h"
+
+using namespace MaxQ::Ephemeris;
+
+static const TArray<FSDistanceVector> Stations{
+    FSDistanceVector(1000., 0., 0.),
+    FSDistanceVector(0., -800., 600.),
+    FSDistanceVector(-300., 400., -900.)
+};
+
+static const auto AllCorrections = {
+    ES_AberrationCorrectionWithNewtonians::None,
+    ES_AberrationCorrectionWithNewtonians::LT,
+    ES_AberrationCorrectionWithNewtonians::CN,
+    ES_AberrationCorrectionWithNewtonians::CN_S
+};
+
+TEST(spkcpo_multi_test, Observers_Match_spkcpo) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FString target = TEXT("FAKEBODY9995");
+    FString obsctr = TEXT("FAKEBODY9994");
+    FString obsref = TEXT("IAU_FAKEBODY9994");
+
+    for (const FString& outref : { FString(TEXT("ECLIPJ2000")), FString(TEXT("IAU_FAKEBODY9994")) })
+    {
+        for (auto abcorr : AllCorrections)
+        {
+            TArray<FSStateVector> states;
+            TArray<FSEphemerisPeriod> lts;
+            states.SetNum(Stations.Num());
+            lts.SetNum(Stations.Num());
+
+            EXPECT_EQ(SpkcpoMulti(et0, Stations, states, lts, target, outref, ES_ReferenceFrameLocus::OBSERVER, obsctr, obsref, abcorr, &ResultCode, &ErrorMessage), Stations.Num());
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+            for (int i = 0; i < Stations.Num(); ++i)
+            {
+                FSStateVector expected;
+                FSEphemerisPeriod lt;
+                USpice::spkcpo(ResultCode, ErrorMessage, expected, lt, et0, Stations[i], target, outref, ES_ReferenceFrameLocus::OBSERVER, obsctr, obsref, abcorr);
+                EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+                EXPECT_TRUE(IsNear(states[i], expected)) << "station " << i;
+                EXPECT_NEAR(lts[i].seconds, lt.seconds, 1e-10) << "station " << i;
+            }
+
+            // Constant velocity:  the same stations drifting, from an epoch
+            // an hour earlier
+            TArray<FSStateVector> obssta;
+            for (const FSDistanceVector& Station : Stations)
+            {
+                obssta.Add(FSStateVector(Station, FSVelocityVector(0.01, -0.02, 0.03)));
+            }
+            const FSEphemerisTime obsepc = et0 - FSEphemerisPeriod(3600.);
+
+            EXPECT_EQ(SpkcvoMulti(et0, obssta, obsepc, states, lts, target, outref, ES_ReferenceFrameLocus::OBSERVER, obsctr, obsref, abcorr, &ResultCode, &ErrorMessage), Stations.Num());
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+            for (int i = 0; i < Stations.Num(); ++i)
+            {
+                FSStateVector expected;
+                FSEphemerisPeriod lt;
+                USpice::spkcvo(ResultCode, ErrorMessage, expected, lt, et0, obssta[i], obsepc, target, outref, ES_ReferenceFrameLocus::OBSERVER, obsctr, obsref, abcorr);
+                EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+                EXPECT_TRUE(IsNear(states[i], expected)) << "station " << i;
+            }
+        }
+    }
+}
+
+
+TEST(spkcpo_multi_test, Targets_Match_spkcpt) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FString obsrvr = TEXT("FAKEBODY9995");
+    FString trgctr = TEXT("FAKEBODY9994");
+    FString trgref = TEXT("IAU_FAKEBODY9994");
+    FString outref = TEXT("ECLIPJ2000");
+
+    for (auto abcorr : AllCorrections)
+    {
+        TArray<FSStateVector> states;
+        TArray<FSEphemerisPeriod> lts;
+        states.SetNum(Stations.Num());
+
+        EXPECT_EQ(SpkcptMulti(Stations, et0, states, lts, trgctr, trgref, outref, ES_ReferenceFrameLocus::TARGET, obsrvr, abcorr, &ResultCode, &ErrorMessage), Stations.Num());
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+        for (int i = 0; i < Stations.Num(); ++i)
+        {
+            FSStateVector expected;
+            FSEphemerisPeriod lt;
+            USpice::spkcpt(ResultCode, ErrorMessage, expected, lt, Stations[i], et0, trgctr, trgref, outref, ES_ReferenceFrameLocus::TARGET, obsrvr, abcorr);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+            EXPECT_TRUE(IsNear(states[i], expected)) << "target " << i;
+        }
+    }
+}
+
+
+TEST(spkcpo_multi_test, Batch_Matches_spkcpo) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    const int32 Count = 8;
+    TArray<double> ets, X, Y, Z, DX, DY, DZ, lt;
+    for (int32 i = 0; i < Count; ++i) ets.Add(et0.seconds + i * 3600.);
+    X.SetNum(Count); Y.SetNum(Count); Z.SetNum(Count);
+    DX.SetNum(Count); DY.SetNum(Count); DZ.SetNum(Count);
+    lt.SetNum(Count);
+    const FStateVectorBatch states{ X, Y, Z, DX, DY, DZ };
+
+    for (auto abcorr : AllCorrections)
+    {
+        EXPECT_EQ(SpkcpoBatch(ets, Stations[1], states, lt, TEXT("FAKEBODY9995"), TEXT("IAU_FAKEBODY9994"), ES_ReferenceFrameLocus::OBSERVER, TEXT("FAKEBODY9994"), TEXT("IAU_FAKEBODY9994"), abcorr, &ResultCode, &ErrorMessage), Count);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+        for (int32 i = 0; i < Count; ++i)
+        {
+            FSStateVector expected;
+            FSEphemerisPeriod expectedLt;
+            USpice::spkcpo(ResultCode, ErrorMessage, expected, expectedLt, FSEphemerisTime(ets[i]), Stations[1], TEXT("FAKEBODY9995"), TEXT("IAU_FAKEBODY9994"), ES_ReferenceFrameLocus::OBSERVER, TEXT("FAKEBODY9994"), TEXT("IAU_FAKEBODY9994"), abcorr);
+            const double state[6] = { X[i], Y[i], Z[i], DX[i], DY[i], DZ[i] };
+            EXPECT_TRUE(IsNear(FSStateVector(state), expected)) << "epoch " << i;
+        }
+
+        EXPECT_EQ(SpkcptBatch(Stations[2], ets, states, {}, TEXT("FAKEBODY9994"), TEXT("IAU_FAKEBODY9994"), TEXT("ECLIPJ2000"), ES_ReferenceFrameLocus::OBSERVER, TEXT("FAKEBODY9995"), abcorr, &ResultCode, &ErrorMessage), Count);
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+        for (int32 i = 0; i < Count; ++i)
+        {
+            FSStateVector expected;
+            FSEphemerisPeriod expectedLt;
+            USpice::spkcpt(ResultCode, ErrorMessage, expected, expectedLt, Stations[2], FSEphemerisTime(ets[i]), TEXT("FAKEBODY9994"), TEXT("IAU_FAKEBODY9994"), TEXT("ECLIPJ2000"), ES_ReferenceFrameLocus::OBSERVER, TEXT("FAKEBODY9995"), abcorr);
+            const double state[6] = { X[i], Y[i], Z[i], DX[i], DY[i], DZ[i] };
+            EXPECT_TRUE(IsNear(FSStateVector(state), expected)) << "epoch " << i;
+        }
+    }
+
+    // Unknown target:  nothing computed, and the error is reported
+    TArray<FSStateVector> states2;
+    states2.SetNum(Stations.Num());
+    EXPECT_EQ(SpkcpoMulti(et0, Stations, states2, {}, TEXT("NOT A BODY"), TEXT("ECLIPJ2000"), ES_ReferenceFrameLocus::OBSERVER, TEXT("FAKEBODY9994"), TEXT("IAU_FAKEBODY9994"), ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage), 0);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
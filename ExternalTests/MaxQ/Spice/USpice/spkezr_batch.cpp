@@ -0,0 +1,150 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceEphemeris.h"
+#include "SpiceName.h"
+
+TEST(spkezr_batch_test, Batch_Matches_spkezr) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+
+    FString targ = TEXT("FAKEBODY9994");
+    FString obs = TEXT("FAKEBODY9995");
+    FString ref = TEXT("ECLIPJ2000");
+    ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None;
+
+    TArray<FSEphemerisTime> ets;
+    for (int i = 0; i < 8; ++i)
+    {
+        ets.Add(et0 + i * FSEphemerisPeriod::Day);
+    }
+
+    TArray<FSStateVector> states;
+    TArray<FSEphemerisPeriod> lts;
+    USpice::spkezr_batch(ResultCode, ErrorMessage, ets, states, lts, targ, obs, ref, abcorr);
+
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+    ASSERT_EQ(states.Num(), ets.Num());
+    ASSERT_EQ(lts.Num(), ets.Num());
+    EXPECT_EQ(IsNear(states[0], state_target_9994_center_9995_eclipj2000_et0), true);
+
+    for (int i = 0; i < ets.Num(); ++i)
+    {
+        FSStateVector stateVector;
+        FSEphemerisPeriod lt;
+        USpice::spkezr(ResultCode, ErrorMessage, ets[i], stateVector, lt, targ, obs, ref, abcorr);
+
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_EQ(IsNear(states[i], stateVector), true);
+    }
+}
+
+
+TEST(spkezr_batch_test, Batch_Stops_AtFirstError) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    TArray<FSEphemerisTime> ets{ et0, et0 + 100 * 365.25 * FSEphemerisPeriod::Day, et0 };
+
+    TArray<FSStateVector> states;
+    TArray<FSEphemerisPeriod> lts;
+    USpice::spkezr_batch(ResultCode, ErrorMessage, ets, states, lts, TEXT("FAKEBODY9994"), TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_EQ(states.Num(), 1);
+    EXPECT_EQ(lts.Num(), 1);
+}
+
+
+TEST(spkezr_batch_test, Corrections_Match_spkezr) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    const FSpiceName targ(TEXT("FAKEBODY9994"));
+    const FSpiceName obs(TEXT("FAKEBODY9995"));
+
+    const int32 Count = 8;
+    TArray<double> ets, X, Y, Z, DX, DY, DZ, lt;
+    for (int32 i = 0; i < Count; ++i) ets.Add(et0.seconds + i * 3600.);
+    X.SetNum(Count); Y.SetNum(Count); Z.SetNum(Count);
+    DX.SetNum(Count); DY.SetNum(Count); DZ.SetNum(Count);
+    lt.SetNum(Count);
+    const MaxQ::Ephemeris::FStateVectorBatch states{ X, Y, Z, DX, DY, DZ };
+    const MaxQ::Ephemeris::FPositionBatch positions{ X, Y, Z };
+
+    // Corrected here (inertial), and by spkez (non-inertial)
+    for (const TCHAR* ref : { TEXT("ECLIPJ2000"), TEXT("IAU_FAKEBODY9994") })
+    {
+        for (auto abcorr : { ES_AberrationCorrectionWithNewtonians::None, ES_AberrationCorrectionWithNewtonians::LT, ES_AberrationCorrectionWithNewtonians::LT_S, ES_AberrationCorrectionWithNewtonians::CN, ES_AberrationCorrectionWithNewtonians::CN_S })
+        {
+            EXPECT_EQ(MaxQ::Ephemeris::SpkezrBatch(ets, states, lt, targ, obs, FSpiceName(ref), abcorr, &ResultCode, &ErrorMessage), Count);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+            for (int32 i = 0; i < Count; ++i)
+            {
+                FSStateVector expected;
+                FSEphemerisPeriod expectedLt;
+                USpice::spkezr(ResultCode, ErrorMessage, FSEphemerisTime(ets[i]), expected, expectedLt, targ.ToString(), obs.ToString(), ref, abcorr);
+                const double state[6] = { X[i], Y[i], Z[i], DX[i], DY[i], DZ[i] };
+                EXPECT_TRUE(IsNear(FSStateVector(state), expected)) << "epoch " << i;
+                EXPECT_NEAR(lt[i], expectedLt.seconds, 1.e-12);
+            }
+
+            EXPECT_EQ(MaxQ::Ephemeris::SpkposBatch(ets, positions, lt, targ, obs, FSpiceName(ref), abcorr, &ResultCode, &ErrorMessage), Count);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+            for (int32 i = 0; i < Count; ++i)
+            {
+                FSDistanceVector expected;
+                FSEphemerisPeriod expectedLt;
+                USpice::spkpos(ResultCode, ErrorMessage, FSEphemerisTime(ets[i]), expected, expectedLt, targ.ToString(), obs.ToString(), ref, abcorr);
+                EXPECT_NEAR(X[i], expected.x.km, 1.e-5) << "epoch " << i;
+                EXPECT_NEAR(Y[i], expected.y.km, 1.e-5) << "epoch " << i;
+                EXPECT_NEAR(Z[i], expected.z.km, 1.e-5) << "epoch " << i;
+            }
+        }
+    }
+
+    // The typed overload is the same code, without the dispatch
+    TArray<double> X2, Y2, Z2, DX2, DY2, DZ2;
+    X2.SetNum(Count); Y2.SetNum(Count); Z2.SetNum(Count);
+    DX2.SetNum(Count); DY2.SetNum(Count); DZ2.SetNum(Count);
+    const MaxQ::Ephemeris::FStateVectorBatch states2{ X2, Y2, Z2, DX2, DY2, DZ2 };
+
+    const FSpiceName ref(TEXT("ECLIPJ2000"));
+    EXPECT_EQ(MaxQ::Ephemeris::SpkezrBatch(ets, states, {}, targ, obs, ref, ES_AberrationCorrectionWithNewtonians::CN), Count);
+    EXPECT_EQ(MaxQ::Ephemeris::SpkezrBatch<ES_AberrationCorrectionWithNewtonians::CN>(ets, states2, {}, targ, obs, ref, &ResultCode, &ErrorMessage), Count);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(X, X2);
+    EXPECT_EQ(DZ, DZ2);
+}
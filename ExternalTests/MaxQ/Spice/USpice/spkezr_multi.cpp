@@ -0,0 +1,135 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceEphemeris.h"
+
+TEST(spkezr_multi_test, Multi_Matches_spkezr) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+
+    TArray<FString> targs{ TEXT("FAKEBODY9993"), TEXT("FAKEBODY9994") };
+    FString obs = TEXT("FAKEBODY9995");
+    FString ref = TEXT("ECLIPJ2000");
+
+    for (auto abcorr : { ES_AberrationCorrectionWithNewtonians::None, ES_AberrationCorrectionWithNewtonians::CN, ES_AberrationCorrectionWithNewtonians::CN_S })
+    {
+        TArray<FSStateVector> states;
+        TArray<FSEphemerisPeriod> lts;
+        USpice::spkezr_multi(ResultCode, ErrorMessage, et0, targs, states, lts, obs, ref, abcorr);
+
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_EQ(ErrorMessage.Len(), 0);
+        ASSERT_EQ(states.Num(), targs.Num());
+        ASSERT_EQ(lts.Num(), targs.Num());
+
+        for (int i = 0; i < targs.Num(); ++i)
+        {
+            FSStateVector stateVector;
+            FSEphemerisPeriod lt;
+            USpice::spkezr(ResultCode, ErrorMessage, et0, stateVector, lt, targs[i], obs, ref, abcorr);
+
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+            EXPECT_EQ(IsNear(states[i], stateVector), true);
+        }
+
+        TArray<FSDistanceVector> ptargs;
+        USpice::spkpos_multi(ResultCode, ErrorMessage, et0, targs, ptargs, lts, obs, ref, abcorr);
+
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        ASSERT_EQ(ptargs.Num(), targs.Num());
+
+        for (int i = 0; i < targs.Num(); ++i)
+        {
+            FSDistanceVector r;
+            FSEphemerisPeriod lt;
+            USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, targs[i], obs, ref, abcorr);
+
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+            EXPECT_NEAR(ptargs[i].x.km, r.x.km, 0.00001);
+            EXPECT_NEAR(ptargs[i].y.km, r.y.km, 0.00001);
+            EXPECT_NEAR(ptargs[i].z.km, r.z.km, 0.00001);
+        }
+    }
+}
+
+
+TEST(spkezr_multi_test, Multi_Stops_AtUnknownBody) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    TArray<FString> targs{ TEXT("FAKEBODY9994"), TEXT("NOT A BODY"), TEXT("FAKEBODY9993") };
+
+    TArray<FSDistanceVector> ptargs;
+    TArray<FSEphemerisPeriod> lts;
+    USpice::spkpos_multi(ResultCode, ErrorMessage, et0, targs, ptargs, lts, TEXT("FAKEBODY9995"), TEXT("ECLIPJ2000"));
+
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_EQ(ptargs.Num(), 1);
+    EXPECT_EQ(lts.Num(), 1);
+}
+
+
+TEST(spkezr_multi_test, BodyPoses_Match_spkpos_pxform) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    TArray<FString> targs{ TEXT("FAKEBODY9994"), TEXT("FAKEBODY9993") };
+    TArray<FString> frames{ TEXT("IAU_FAKEBODY9994"), FString() };
+    FString obs = TEXT("FAKEBODY9995");
+    FString ref = TEXT("ECLIPJ2000");
+    const double DistanceScale = 1000.;
+
+    TArray<FTransform> Poses;
+    Poses.SetNum(targs.Num());
+    EXPECT_EQ(MaxQ::Ephemeris::BodyPoses(et0, targs, frames, Poses, obs, ref, DistanceScale, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage), targs.Num());
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    for (int i = 0; i < targs.Num(); ++i)
+    {
+        FSDistanceVector r;
+        FSEphemerisPeriod lt;
+        USpice::spkpos(ResultCode, ErrorMessage, et0, r, lt, targs[i], obs, ref);
+        EXPECT_TRUE(Poses[i].GetLocation().Equals(r.Swizzle() / DistanceScale, 1.e-6));
+    }
+
+    FSRotationMatrix m;
+    USpice::pxform(ResultCode, ErrorMessage, m, et0, frames[0], ref);
+    FSQuaternion q;
+    USpice::m2q(ResultCode, ErrorMessage, m, q);
+    EXPECT_TRUE(Poses[0].GetRotation().Equals(q.Swizzle(), 1.e-9));
+    EXPECT_TRUE(Poses[1].GetRotation().Equals(FQuat::Identity));
+
+    // An unknown frame stops there
+    frames[1] = TEXT("NOT A FRAME");
+    EXPECT_EQ(MaxQ::Ephemeris::BodyPoses(et0, targs, frames, Poses, obs, ref, DistanceScale, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage), 1);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
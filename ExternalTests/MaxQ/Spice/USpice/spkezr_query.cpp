@@ -0,0 +1,165 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceProfiling.h"
+
+TEST(spkezr_query_test, Query_Matches_spkezr) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_EQ(ErrorMessage.Len(), 0);
+
+    FString targ = TEXT("FAKEBODY9994");
+    FString obs = TEXT("FAKEBODY9995");
+    FString ref = TEXT("ECLIPJ2000");
+
+    for (auto abcorr : { ES_AberrationCorrectionWithNewtonians::None, ES_AberrationCorrectionWithNewtonians::LT_S })
+    {
+        FSEphemerisQuery query;
+        USpice::spk_compile_query(ResultCode, ErrorMessage, query, targ, obs, ref, abcorr);
+
+        EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+        EXPECT_EQ(ErrorMessage.Len(), 0);
+        ASSERT_TRUE(query.IsValid());
+        EXPECT_EQ(query.targ, 9994);
+        EXPECT_EQ(query.obs, 9995);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            FSEphemerisTime et = et0 + i * FSEphemerisPeriod::Day;
+
+            FSStateVector queryState, state;
+            FSEphemerisPeriod queryLt, lt;
+            USpice::spkezr_query(ResultCode, ErrorMessage, query, et, queryState, queryLt);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+            USpice::spkezr(ResultCode, ErrorMessage, et, state, lt, targ, obs, ref, abcorr);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+            EXPECT_EQ(IsNear(queryState, state), true);
+            EXPECT_DOUBLE_EQ(queryLt.seconds, lt.seconds);
+
+            FSDistanceVector r;
+            USpice::spkpos_query(ResultCode, ErrorMessage, query, et, r, queryLt);
+            EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+            EXPECT_NEAR(r.x.km, state.r.x.km, 0.00001);
+            EXPECT_NEAR(r.y.km, state.r.y.km, 0.00001);
+            EXPECT_NEAR(r.z.km, state.r.z.km, 0.00001);
+        }
+    }
+}
+
+
+TEST(spkezr_query_test, Converged_Newtonian_WarmStart_Matches_spkezr) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FString targ = TEXT("FAKEBODY9994");
+    FString obs = TEXT("FAKEBODY9995");
+
+    for (const FString& ref : { FString(TEXT("ECLIPJ2000")), FString(TEXT("IAU_FAKEBODY9994")) })
+    {
+        for (auto abcorr : { ES_AberrationCorrectionWithNewtonians::CN, ES_AberrationCorrectionWithNewtonians::CN_S })
+        {
+            FSEphemerisQuery query;
+            USpice::spk_compile_query(ResultCode, ErrorMessage, query, targ, obs, ref, abcorr);
+            ASSERT_TRUE(query.IsValid());
+
+            // Consecutive frames, then a jump a day ahead (the stale guess
+            // has to be caught), then frames again
+            TArray<FSEphemerisTime> ets;
+            for (int i = 0; i < 10; ++i) ets.Add(et0 + FSEphemerisPeriod(i / 60.));
+            for (int i = 0; i < 10; ++i) ets.Add(et0 + FSEphemerisPeriod::Day + FSEphemerisPeriod(i / 60.));
+
+            for (const FSEphemerisTime& et : ets)
+            {
+                FSStateVector queryState, state;
+                FSEphemerisPeriod queryLt, lt;
+                USpice::spkezr(ResultCode, ErrorMessage, et, state, lt, targ, obs, ref, abcorr);
+                EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+
+                USpice::spkezr_query(ResultCode, ErrorMessage, query, et, queryState, queryLt);
+                EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+                EXPECT_NEAR(queryLt.seconds, lt.seconds, 1e-8);
+                EXPECT_NEAR(queryState.r.x.km, state.r.x.km, 1e-5);
+                EXPECT_NEAR(queryState.r.y.km, state.r.y.km, 1e-5);
+                EXPECT_NEAR(queryState.r.z.km, state.r.z.km, 1e-5);
+                EXPECT_NEAR(queryState.v.dx.kmps, state.v.dx.kmps, 1e-8);
+                EXPECT_NEAR(queryState.v.dy.kmps, state.v.dy.kmps, 1e-8);
+                EXPECT_NEAR(queryState.v.dz.kmps, state.v.dz.kmps, 1e-8);
+
+                FSDistanceVector queryR, r;
+                USpice::spkpos(ResultCode, ErrorMessage, et, r, lt, targ, obs, ref, abcorr);
+                USpice::spkpos_query(ResultCode, ErrorMessage, query, et, queryR, queryLt);
+                EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+                EXPECT_NEAR(queryLt.seconds, lt.seconds, 1e-8);
+                EXPECT_NEAR(queryR.x.km, r.x.km, 1e-5);
+                EXPECT_NEAR(queryR.y.km, r.y.km, 1e-5);
+                EXPECT_NEAR(queryR.z.km, r.z.km, 1e-5);
+            }
+        }
+    }
+
+#if MAXQ_COUNTERS_ENABLED
+    // Warm, a frame later:  the observer, and one iteration for the target.
+    // Cold it takes the geometric light time and at least one more.
+    FSEphemerisQuery query;
+    USpice::spk_compile_query(ResultCode, ErrorMessage, query, targ, obs, TEXT("ECLIPJ2000"), ES_AberrationCorrectionWithNewtonians::CN);
+    FSDistanceVector r;
+    FSEphemerisPeriod lt;
+    USpice::spkpos_query(ResultCode, ErrorMessage, query, et0, r, lt);
+
+    const int Frames = 60;
+    MaxQ::Data::ResetSpiceCounters();
+    for (int i = 1; i <= Frames; ++i)
+    {
+        USpice::spkpos_query(ResultCode, ErrorMessage, query, et0 + FSEphemerisPeriod(i / 60.), r, lt);
+    }
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    EXPECT_LT(MaxQ::Data::GetSpiceCounters()[MaxQ::Data::ESpiceCounter::SpkLookups], 3ull * Frames);
+#endif
+}
+
+
+TEST(spkezr_query_test, Compile_Fails_OnUnknownNames) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FSEphemerisQuery query;
+    USpice::spk_compile_query(ResultCode, ErrorMessage, query, TEXT("NOT A BODY"), TEXT("EARTH"), TEXT("J2000"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    EXPECT_FALSE(query.IsValid());
+
+    USpice::spk_compile_query(ResultCode, ErrorMessage, query, TEXT("MOON"), TEXT("EARTH"), TEXT("NOT A FRAME"));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_FALSE(query.IsValid());
+
+    FSStateVector state;
+    FSEphemerisPeriod lt;
+    USpice::spkezr_query(ResultCode, ErrorMessage, query, et0, state, lt);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+}
@@ -0,0 +1,215 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMathBatch.h"
+#include "SpiceStarCatalog.h"
+
+using namespace MaxQ::Math;
+using namespace MaxQ::Data;
+
+static const double pi = 3.14159265358979323846;
+static const double JulianYear = 365.25 * 86400.;
+
+// Random stars, with proper motions up to ~10"/year (Barnard's star)
+static void TestCatalog(FStarCatalog& Catalog, int32 Num)
+{
+    FRandomStream Random(4321);
+    Catalog.SetNum(Num);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        Catalog.Ra[i] = Random.FRandRange(0., 2. * pi);
+        Catalog.Dec[i] = FMath::Asin(Random.FRandRange(-1., 1.));
+        Catalog.RaPm[i] = Random.FRandRange(-5e-5, 5e-5);
+        Catalog.DecPm[i] = Random.FRandRange(-5e-5, 5e-5);
+        Catalog.Epoch[i] = -8.75 * JulianYear;
+        Catalog.CatalogNumber[i] = i + 1;
+        Catalog.VisualMagnitude[i] = Random.FRandRange(-1., 6.5);
+    }
+}
+
+TEST(star_catalog_test, Radrec_Matches_radrec) {
+
+    USpice::init_all();
+
+    FRandomStream Random(1234);
+    TArray<double> X, Y, Z;
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector()) * Random.FRandRange(0.1, 1e9);
+        X.Add(u.X); Y.Add(u.Y); Z.Add(u.Z);
+    }
+    X.Append({ 0., 0., -1. });
+    Y.Append({ 0., -1e-9, 0. });
+    Z.Append({ 0., 0., 0. });
+    const int32 Num = X.Num();
+
+    TArray<double> range, ra, dec;
+    range.SetNum(Num); ra.SetNum(Num); dec.SetNum(Num);
+    Recrad(FConstVectorBatch(X, Y, Z), range, ra, dec);
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        FSDistance expectedRange;
+        FSAngle expectedRa, expectedDec;
+        USpice::recrad(FSDistanceVector(X[i], Y[i], Z[i]), expectedRange, expectedRa, expectedDec);
+
+        EXPECT_NEAR(range[i], expectedRange.km, 1e-15 * FMath::Max(1., range[i])) << "point " << i;
+        EXPECT_NEAR(ra[i], expectedRa.AsSpiceDouble(), 1e-12) << "point " << i;
+        EXPECT_NEAR(dec[i], expectedDec.AsSpiceDouble(), 1e-12) << "point " << i;
+    }
+
+    // ...and back
+    TArray<double> X2, Y2, Z2;
+    X2.SetNum(Num); Y2.SetNum(Num); Z2.SetNum(Num);
+    Radrec(range, ra, dec, FVectorBatch{ X2, Y2, Z2 });
+    for (int32 i = 0; i < Num; ++i)
+    {
+        FSDistanceVector expected;
+        USpice::radrec(FSDistance(range[i]), FSAngle(ra[i]), FSAngle(dec[i]), expected);
+        EXPECT_NEAR(X2[i], expected.x.km, 1e-12 * FMath::Max(1., range[i])) << "point " << i;
+        EXPECT_NEAR(Y2[i], expected.y.km, 1e-12 * FMath::Max(1., range[i])) << "point " << i;
+        EXPECT_NEAR(Z2[i], expected.z.km, 1e-12 * FMath::Max(1., range[i])) << "point " << i;
+    }
+}
+
+
+TEST(star_catalog_test, Stelab_Matches_stelab) {
+
+    USpice::init_all();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    FRandomStream Random(1234);
+    TArray<double> X, Y, Z;
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector()) * Random.FRandRange(1., 1e9);
+        X.Add(u.X); Y.Add(u.Y); Z.Add(u.Z);
+    }
+    const int32 Num = X.Num();
+
+    // The Earth's orbital speed, and something much faster
+    for (const FSVelocityVector& vobs : { FSVelocityVector(-29.8, 2.1, 0.9), FSVelocityVector(1e5, -5e4, 2e4) })
+    {
+        TArray<double> X2, Y2, Z2;
+        X2.SetNum(Num); Y2.SetNum(Num); Z2.SetNum(Num);
+        ASSERT_TRUE(Stelab(FConstVectorBatch(X, Y, Z), vobs, FVectorBatch{ X2, Y2, Z2 }));
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            FSDistanceVector expected;
+            USpice::stelab(ResultCode, ErrorMessage, FSDistanceVector(X[i], Y[i], Z[i]), vobs, expected);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            const double r = FMath::Sqrt(X[i] * X[i] + Y[i] * Y[i] + Z[i] * Z[i]);
+            EXPECT_NEAR(X2[i], expected.x.km, 1e-12 * r) << "point " << i;
+            EXPECT_NEAR(Y2[i], expected.y.km, 1e-12 * r) << "point " << i;
+            EXPECT_NEAR(Z2[i], expected.z.km, 1e-12 * r) << "point " << i;
+        }
+    }
+
+    // In place
+    TArray<double> X3 = X, Y3 = Y, Z3 = Z;
+    ASSERT_TRUE(Stelab(FConstVectorBatch(X3, Y3, Z3), FSVelocityVector(-29.8, 2.1, 0.9), FVectorBatch{ X3, Y3, Z3 }));
+    FSDistanceVector expected;
+    USpice::stelab(ResultCode, ErrorMessage, FSDistanceVector(X[7], Y[7], Z[7]), FSVelocityVector(-29.8, 2.1, 0.9), expected);
+    EXPECT_NEAR(X3[7], expected.x.km, 1e-6);
+
+    // Faster than light
+    EXPECT_FALSE(Stelab(FConstVectorBatch(X, Y, Z), FSVelocityVector(3e5, 0., 0.), FVectorBatch{ X3, Y3, Z3 }));
+    USpice::stelab(ResultCode, ErrorMessage, FSDistanceVector(1., 0., 0.), FSVelocityVector(3e5, 0., 0.), expected);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
+
+
+TEST(star_catalog_test, Spectral_Classes) {
+
+    EXPECT_EQ(StarSpectralClass(TEXT("A0V")), EStarSpectralClass::A);
+    EXPECT_EQ(StarSpectralClass(TEXT("K0III")), EStarSpectralClass::K);
+    EXPECT_EQ(StarSpectralClass(TEXT("kA2hA5mA7V")), EStarSpectralClass::A);
+    EXPECT_EQ(StarSpectralClass(TEXT("sdB")), EStarSpectralClass::B);
+    EXPECT_EQ(StarSpectralClass(TEXT("O9.5Iab")), EStarSpectralClass::O);
+    EXPECT_EQ(StarSpectralClass(TEXT("M2Iab:")), EStarSpectralClass::M);
+    EXPECT_EQ(StarSpectralClass(TEXT("")), EStarSpectralClass::Unknown);
+}
+
+
+TEST(star_catalog_test, Proper_Motion) {
+
+    FStarCatalog Catalog;
+    Catalog.SetNum(2);
+    Catalog.Ra[0] = 1.; Catalog.Dec[0] = 0.5;
+    Catalog.RaPm[0] = 1e-4; Catalog.DecPm[0] = -2e-4;
+    Catalog.Epoch[0] = -8.75 * JulianYear;
+    Catalog.Ra[1] = 2.; Catalog.Dec[1] = -0.25;
+
+    EXPECT_NEAR(Catalog.MaxProperMotion(), FMath::Sqrt(FMath::Square(1e-4 * FMath::Cos(0.5)) + 4e-8), 1e-18);
+
+    FStarField Field;
+    Field.SetCatalog(MoveTemp(Catalog));
+    ASSERT_EQ(Field.Num(), 2);
+
+    // 10 years after J2000, without aberration
+    ASSERT_TRUE(Field.Update(FSEphemerisTime(10. * JulianYear)));
+    const FConstVectorBatch Directions = Field.Directions();
+
+    FSDistanceVector expected;
+    USpice::radrec(FSDistance(1.), FSAngle(1. + 1e-4 * 18.75), FSAngle(0.5 - 2e-4 * 18.75), expected);
+    EXPECT_NEAR(Directions.X[0], expected.x.km, 1e-15);
+    EXPECT_NEAR(Directions.Y[0], expected.y.km, 1e-15);
+    EXPECT_NEAR(Directions.Z[0], expected.z.km, 1e-15);
+
+    USpice::radrec(FSDistance(1.), FSAngle(2.), FSAngle(-0.25), expected);
+    EXPECT_NEAR(Directions.X[1], expected.x.km, 1e-15);
+    EXPECT_NEAR(Directions.Y[1], expected.y.km, 1e-15);
+    EXPECT_NEAR(Directions.Z[1], expected.z.km, 1e-15);
+}
+
+
+TEST(star_catalog_test, Cone_Queries_Match_Brute_Force) {
+
+    FStarCatalog Catalog;
+    TestCatalog(Catalog, 20000);
+
+    FStarField Field;
+    Field.SetCatalog(MoveTemp(Catalog));
+
+    // Indexed at J2000, then queried centuries on (proper motion beyond the
+    // rebuild slack), with aberration
+    const FSVelocityVector vobs(-29.8, 2.1, 0.9);
+    for (double Years : { 0., 3., 300. })
+    {
+        ASSERT_TRUE(Field.Update(FSEphemerisTime(Years * JulianYear), vobs));
+        const FConstVectorBatch Directions = Field.Directions();
+
+        FRandomStream Random(99);
+        for (int32 q = 0; q < 50; ++q)
+        {
+            const FVector3d Axis = FVector3d(Random.GetUnitVector());
+            const double HalfAngle = q == 0 ? pi : Random.FRandRange(0.001, 0.5);
+
+            TArray<int32> Stars;
+            Field.QueryCone(FSDimensionlessVector(Axis.X, Axis.Y, Axis.Z), HalfAngle, Stars);
+            Stars.Sort();
+
+            TArray<int32> Expected;
+            const double CosHalfAngle = FMath::Cos(HalfAngle);
+            for (int32 i = 0; i < Directions.Num(); ++i)
+            {
+                if (Directions.X[i] * Axis.X + Directions.Y[i] * Axis.Y + Directions.Z[i] * Axis.Z >= CosHalfAngle)
+                {
+                    Expected.Add(i);
+                }
+            }
+
+            EXPECT_EQ(Stars, Expected) << "years " << Years << ", query " << q;
+        }
+    }
+}
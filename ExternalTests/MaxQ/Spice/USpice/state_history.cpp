@@ -0,0 +1,190 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceStateHistory.h"
+#include "SpiceTwoBody.h"
+
+using namespace MaxQ::Orbits;
+
+namespace
+{
+    constexpr double EarthGM = 398600.435436;
+
+    // Two-body orbits, plus a wobble two-body predictions won't see
+    struct FTruth
+    {
+        FTwoBodyBatchPropagator Propagator;
+
+        explicit FTruth(int32 Num)
+        {
+            TArray<FSStateVector> States;
+            for (int32 i = 0; i < Num; ++i)
+            {
+                const double r = 6778. + 10. * i;
+                const double v = sqrt(EarthGM / r);
+                const double inc = 0.1 * i;
+                States.Add(FSStateVector(FSDistanceVector(r, 0., 0.), FSVelocityVector(0., v * cos(inc), v * sin(inc))));
+            }
+            Propagator.Build(FSMassConstant(EarthGM), States, FSEphemerisTime(0.));
+        }
+
+        TArray<FSStateVector> At(double et) const
+        {
+            TArray<FSStateVector> States;
+            States.SetNum(Propagator.Num());
+            Propagator.Propagate(FSEphemerisTime(et), States);
+            for (int32 i = 0; i < States.Num(); ++i)
+            {
+                States[i].r.x.km += 0.3 * sin(et / 100. + i);
+                States[i].v.dx.kmps += 0.003 * cos(et / 100. + i);
+            }
+            return States;
+        }
+    };
+
+    void ExpectNear(const FSStateVector& a, const FSStateVector& b, double Position, double Velocity)
+    {
+        double sa[6], sb[6];
+        a.CopyTo(sa);
+        b.CopyTo(sb);
+        for (int32 c = 0; c < 6; ++c)
+        {
+            EXPECT_NEAR(sa[c], sb[c], c < 3 ? Position : Velocity);
+        }
+    }
+}
+
+
+TEST(state_history_test, Decodes_Within_A_Quantum) {
+
+    FStateHistorySettings Settings;
+    Settings.BlockLength = 8;
+    FStateHistory History(Settings);
+    FTruth Truth(20);
+
+    for (int32 Slice = 0; Slice < 20; ++Slice)
+    {
+        const double et = Slice * Settings.Interval;
+        EXPECT_TRUE(History.IsDue(et));
+        EXPECT_TRUE(History.Record(et, Truth.At(et)));
+        EXPECT_FALSE(History.IsDue(et + 1.));
+    }
+
+    EXPECT_EQ(History.NumSlices(), 20);
+    EXPECT_EQ(History.Num(), 20);
+    EXPECT_EQ(History.NumEscapes(), 0);
+    EXPECT_EQ(History.GetStart(), 0.);
+    EXPECT_EQ(History.GetEnd(), 190.);
+    EXPECT_EQ(History.GetSliceTime(9), 90.);
+
+    // Out of order, and the wrong number of objects
+    EXPECT_FALSE(History.Record(190., Truth.At(190.)));
+    EXPECT_FALSE(History.Record(200., FTruth(3).At(200.)));
+
+    TArray<FSStateVector> Decoded;
+    Decoded.SetNum(20);
+    for (int32 Slice : { 0, 1, 7, 8, 13, 19 })
+    {
+        ASSERT_TRUE(History.DecodeSlice(Slice, Decoded));
+        const TArray<FSStateVector> Expected = Truth.At(Slice * Settings.Interval);
+        for (int32 i = 0; i < 20; ++i)
+        {
+            ExpectNear(Decoded[i], Expected[i], 0.5 * Settings.PositionQuantum + 1.e-9, 0.5 * Settings.VelocityQuantum + 1.e-12);
+        }
+    }
+    EXPECT_FALSE(History.DecodeSlice(20, Decoded));
+
+    // Compressed:  two full precision keys (and a partial third) of 48 bytes
+    // an object, the rest 12
+    EXPECT_LT(History.GetAllocatedSize(), (SIZE_T)(20 * 20 * 48 / 2));
+}
+
+
+TEST(state_history_test, Samples_Between_Slices) {
+
+    FStateHistorySettings Settings;
+    Settings.BlockLength = 4;
+    FStateHistory History(Settings);
+    FTruth Truth(10);
+
+    for (int32 Slice = 0; Slice < 10; ++Slice)
+    {
+        History.Record(Slice * Settings.Interval, Truth.At(Slice * Settings.Interval));
+    }
+
+    TArray<FSStateVector> Sampled;
+    Sampled.SetNum(10);
+
+    // Within a block, and across a block boundary
+    for (double et : { 15., 35., 42.5, 90. })
+    {
+        ASSERT_TRUE(History.Sample(et, Sampled));
+        const TArray<FSStateVector> Expected = Truth.At(et);
+        for (int32 i = 0; i < 10; ++i)
+        {
+            ExpectNear(Sampled[i], Expected[i], 1.e-3, 1.e-5);
+        }
+    }
+
+    EXPECT_FALSE(History.Sample(-1., Sampled));
+    EXPECT_FALSE(History.Sample(91., Sampled));
+}
+
+
+TEST(state_history_test, Escapes_And_Invalid_Objects) {
+
+    FStateHistory History;
+    FTruth Truth(3);
+
+    History.Record(0., Truth.At(0.));
+
+    // A maneuver:  object 1 jumps 100 km, which no residual can hold
+    TArray<FSStateVector> States = Truth.At(10.);
+    States[1].r.y.km += 100.;
+    const bool Valid[] = { true, true, false };
+    EXPECT_TRUE(History.Record(10., States, Valid));
+    EXPECT_EQ(History.NumEscapes(), 1);
+
+    TArray<FSStateVector> Decoded;
+    Decoded.SetNum(3);
+    ASSERT_TRUE(History.DecodeSlice(1, Decoded));
+    ExpectNear(Decoded[0], States[0], 1.e-4, 1.e-6);
+    ExpectNear(Decoded[1], States[1], 0., 0.);
+    ExpectNear(Decoded[2], FSStateVector(), 0., 0.);
+}
+
+
+TEST(state_history_test, Drops_The_Oldest_Blocks) {
+
+    FStateHistorySettings Settings;
+    Settings.BlockLength = 4;
+    Settings.MaxSlices = 10;
+    FStateHistory History(Settings);
+    FTruth Truth(2);
+
+    for (int32 Slice = 0; Slice < 17; ++Slice)
+    {
+        History.Record(Slice * Settings.Interval, Truth.At(Slice * Settings.Interval));
+        EXPECT_LE(History.NumSlices(), Settings.MaxSlices);
+    }
+
+    // Slices 8..16:  two full blocks and the last's key
+    EXPECT_EQ(History.NumSlices(), 9);
+    EXPECT_EQ(History.GetStart(), 80.);
+    EXPECT_EQ(History.GetSliceTime(0), 80.);
+
+    TArray<FSStateVector> Decoded;
+    Decoded.SetNum(2);
+    ASSERT_TRUE(History.DecodeSlice(5, Decoded));
+    ExpectNear(Decoded[0], Truth.At(130.)[0], 1.e-4, 1.e-6);
+
+    History.Reset();
+    EXPECT_EQ(History.NumSlices(), 0);
+    EXPECT_TRUE(History.IsDue(0.));
+}
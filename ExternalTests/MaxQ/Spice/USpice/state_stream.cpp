@@ -0,0 +1,184 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceStateStream.h"
+#include <thread>
+
+using namespace MaxQ::Ephemeris;
+
+namespace
+{
+    // A circular orbit, 7000 km, ~97 minute period
+    constexpr double Radius = 7000.;
+    constexpr double Rate = 0.00108;
+
+    void Circle(double et, double(&state)[6])
+    {
+        const double c = cos(Rate * et), s = sin(Rate * et);
+        state[0] = Radius * c;          state[1] = Radius * s;          state[2] = 0.;
+        state[3] = -Radius * Rate * s;  state[4] = Radius * Rate * c;   state[5] = 0.;
+    }
+
+    template<typename T>
+    void Append(TArray<uint8>& Packet, T Value)
+    {
+        Packet.Append((const uint8*)&Value, sizeof(T));
+    }
+}
+
+
+TEST(state_stream_test, Interpolates_Between_Samples) {
+
+    FStateRingBuffer Buffer;
+
+    // 1 Hz samples
+    for (int i = 0; i < 20; ++i)
+    {
+        double state[6];
+        Circle(i, state);
+        EXPECT_TRUE(Buffer.Push(i, state));
+    }
+
+    for (double et = 2.25; et < 17.; et += 0.5)
+    {
+        double expected[6], state[6];
+        bool bExtrapolated = true;
+        Circle(et, expected);
+        EXPECT_TRUE(Buffer.Interpolate(et, state, &bExtrapolated));
+        EXPECT_FALSE(bExtrapolated);
+        for (int c = 0; c < 3; ++c)
+        {
+            EXPECT_NEAR(state[c], expected[c], 1.e-8);
+            EXPECT_NEAR(state[3 + c], expected[3 + c], 1.e-10);
+        }
+    }
+}
+
+
+TEST(state_stream_test, Extrapolates_Only_Briefly) {
+
+    FStateStreamSettings Settings;
+    Settings.MaxExtrapolationSeconds = 0.5;
+    FStateRingBuffer Buffer(Settings);
+
+    double state[6];
+    EXPECT_FALSE(Buffer.Interpolate(0., state));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        Circle(i, state);
+        Buffer.Push(i, state);
+    }
+
+    bool bExtrapolated = false;
+    EXPECT_TRUE(Buffer.Interpolate(3.25, state, &bExtrapolated));
+    EXPECT_TRUE(bExtrapolated);
+    EXPECT_FALSE(Buffer.Interpolate(3.75, state));
+    EXPECT_FALSE(Buffer.Interpolate(-1., state));
+}
+
+
+TEST(state_stream_test, Drops_Stale_States) {
+
+    FStateStreamSettings Settings;
+    Settings.Capacity = 8;
+    FStateRingBuffer Buffer(Settings);
+
+    double state[6];
+    for (int i = 0; i < 20; ++i)
+    {
+        Circle(i, state);
+        Buffer.Push(i, state);
+    }
+
+    Circle(5., state);
+    EXPECT_FALSE(Buffer.Push(5., state));
+    EXPECT_FALSE(Buffer.Push(19., state));
+    EXPECT_EQ(Buffer.NumDropped(), 2u);
+    EXPECT_EQ(Buffer.NumPushed(), 20u);
+
+    // Only the newest Capacity (less one) are kept
+    EXPECT_FALSE(Buffer.Interpolate(11.5, state));
+    EXPECT_TRUE(Buffer.Interpolate(13.5, state));
+
+    double et = 0.;
+    EXPECT_TRUE(Buffer.Latest(et, state));
+    EXPECT_EQ(et, 19.);
+}
+
+
+TEST(state_stream_test, Ingests_Packets) {
+
+    FStateStream Stream;
+
+    TArray<uint8> Packet;
+    Append<uint32>(Packet, 'M' | ('X' << 8) | ('Q' << 16) | ('S' << 24));
+    Append<uint16>(Packet, 1);
+    Append<uint16>(Packet, 2);
+    for (int32 ObjectId : { -1001, -1002 })
+    {
+        double state[6];
+        Circle(ObjectId, state);
+        Append<int32>(Packet, ObjectId);
+        Append<double>(Packet, 10.);
+        for (double Component : state) Append<double>(Packet, Component);
+    }
+
+    EXPECT_EQ(Stream.Ingest(Packet), 2);
+    EXPECT_EQ(Stream.ObjectIds().Num(), 2);
+    EXPECT_TRUE(Stream.Find(-1001).IsValid());
+    EXPECT_FALSE(Stream.Find(-1003).IsValid());
+
+    FSStateVector state;
+    EXPECT_TRUE(Stream.Interpolate(-1002, FSEphemerisTime(10.), state));
+
+    // Resent:  well formed, but nothing new
+    EXPECT_EQ(Stream.Ingest(Packet), 0);
+
+    Packet.Pop();
+    EXPECT_EQ(Stream.Ingest(Packet), INDEX_NONE);
+}
+
+
+TEST(state_stream_test, Readers_Never_See_Torn_States) {
+
+    FStateStreamSettings Settings;
+    Settings.Capacity = 16;
+    FStateRingBuffer Buffer(Settings);
+
+    std::atomic<bool> bDone { false };
+    std::thread Writer([&]()
+    {
+        for (int i = 0; i < 200000; ++i)
+        {
+            double state[6];
+            Circle(i * 0.1, state);
+            Buffer.Push(i * 0.1, state);
+        }
+        bDone = true;
+    });
+
+    int Reads = 0;
+    while (!bDone)
+    {
+        double et = 0., latest[6], expected[6];
+        if (Buffer.Latest(et, latest))
+        {
+            Circle(et, expected);
+            for (int c = 0; c < 6; ++c)
+            {
+                ASSERT_EQ(latest[c], expected[c]);
+            }
+            ++Reads;
+        }
+    }
+    Writer.join();
+
+    EXPECT_GT(Reads, 0);
+}
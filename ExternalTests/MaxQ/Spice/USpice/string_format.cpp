@@ -0,0 +1,99 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceFormat.h"
+#include <cstdio>
+
+using namespace MaxQ::Format;
+
+TEST(string_format_test, AppendFixed_Matches_printf) {
+
+    FRandomStream Random(1234);
+    for (int32 i = 0; i < 10000; ++i)
+    {
+        const double value = Random.FRandRange(-1., 1.) * FMath::Pow(10., Random.FRandRange(-6., 9.));
+        const int32 decimals = Random.RandRange(0, 12);
+
+        char Expected[128];
+        snprintf(Expected, sizeof(Expected), "%.*f", (int)decimals, value);
+
+        TStringBuilder<64> sb;
+        AppendFixed(sb, value, decimals);
+        EXPECT_EQ(FString(sb.ToString()), FString(ANSI_TO_TCHAR(Expected))) << "value " << value << ", decimals " << decimals;
+    }
+
+    // Negative zero, and big values (the snprintf path)
+    TStringBuilder<512> sb;
+    AppendFixed(sb, -0.0001, 2);
+    sb.Append(TEXT(" "));
+    AppendFixed(sb, 1.5e20, 1);
+    EXPECT_EQ(FString(sb.ToString()), TEXT("-0.00 150000000000000000000.0"));
+}
+
+
+TEST(string_format_test, AppendDouble) {
+
+    TStringBuilder<64> sb;
+    AppendDouble(sb, 1234.5678, 6);
+    sb.Append(TEXT(" "));
+    AppendDouble(sb, 1e-20, 8);
+    sb.Append(TEXT(" "));
+    AppendDouble(sb, -0.25, 12);
+    EXPECT_EQ(FString(sb.ToString()), TEXT("1234.57 1e-20 -0.25"));
+}
+
+
+TEST(string_format_test, Angles) {
+
+    auto Format = [](double degrees, ES_AngleFormat format, int32 precision)
+    {
+        TStringBuilder<64> sb;
+        AppendAngle(sb, FSAngle::FromDegrees(degrees), format, precision);
+        return FString(sb.ToString());
+    };
+
+    EXPECT_EQ(Format(12.5, ES_AngleFormat::DD, 4), TEXT("12.5000"));
+    EXPECT_EQ(Format(-190., ES_AngleFormat::DD_180, 2), TEXT("170.00"));
+    EXPECT_EQ(Format(12.5, ES_AngleFormat::DMS, 8), TEXT("12 30'0.000\""));
+    EXPECT_EQ(Format(12.5, ES_AngleFormat::DMS, 6), TEXT("12 30'00\""));
+    EXPECT_EQ(Format(187.5, ES_AngleFormat::HMS, 8), TEXT("12h 30m 0.000s"));
+    EXPECT_EQ(Format(187.5, ES_AngleFormat::HMS, 6), TEXT("12h 30m 00s "));
+
+    TStringBuilder<64> sb;
+    FSLonLat lonlat;
+    lonlat.longitude = FSAngle::FromDegrees(-75.25);
+    lonlat.latitude = FSAngle::FromDegrees(40.5);
+    AppendLonLat(sb, lonlat, TEXT(", "), ES_AngleFormat::DD, 4);
+    EXPECT_EQ(FString(sb.ToString()), TEXT("75.2500W, 40.5000N"));
+}
+
+
+TEST(string_format_test, Matches_FString_Versions) {
+
+    const int32 precision = USpiceTypes::FloatFormatPrecision;
+
+    for (ES_AngleFormat format : { ES_AngleFormat::DD, ES_AngleFormat::DD_180, ES_AngleFormat::DD_360, ES_AngleFormat::DMS, ES_AngleFormat::HMS, ES_AngleFormat::DR_PI, ES_AngleFormat::DR_2PI })
+    {
+        for (double degrees : { 0., 12.345678, -123.456, 359.9999 })
+        {
+            TStringBuilder<64> sb;
+            AppendAngle(sb, FSAngle::FromDegrees(degrees), format, precision);
+            EXPECT_EQ(FString(sb.ToString()), USpiceTypes::FormatAngle(FSAngle::FromDegrees(degrees), format)) << "degrees " << degrees;
+        }
+    }
+
+    const FSStateVector state(FSDistanceVector(1.5, -2.25e8, 3.), FSVelocityVector(0.1, 0.2, -7.75));
+    TStringBuilder<128> sb;
+    Append(sb, state);
+    EXPECT_EQ(FString(sb.ToString()), state.ToString());
+
+    sb.Reset();
+    AppendDistance(sb, FSDistance(12345.678901234));
+    EXPECT_EQ(FString(sb.ToString()), USpiceTypes::FormatDistance(FSDistance(12345.678901234)));
+}
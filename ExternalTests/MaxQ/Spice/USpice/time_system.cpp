@@ -0,0 +1,296 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceTime.h"
+#include "SpiceData.h"
+
+using namespace MaxQ::Time;
+
+static const ES_UTCTimeFormat AllFormats[] = {
+    ES_UTCTimeFormat::Calendar,
+    ES_UTCTimeFormat::DayOfYear,
+    ES_UTCTimeFormat::JulianDate,
+    ES_UTCTimeFormat::ISOCalendar,
+    ES_UTCTimeFormat::ISODayOfYear
+};
+
+static double EtOf(const FString& Str)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FSEphemerisTime et;
+    USpice::str2et(ResultCode, ErrorMessage, et, Str);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    return et.seconds;
+}
+
+static void ExpectSameAsEt2utc(const FTimeSystem& TimeSystem, double et, int32 Precision)
+{
+    for (ES_UTCTimeFormat TimeFormat : AllFormats)
+    {
+        ES_ResultCode ResultCode = ES_ResultCode::Error;
+        FString ErrorMessage;
+        FString Expected;
+        USpice::et2utc(ResultCode, ErrorMessage, FSEphemerisTime(et), TimeFormat, Expected, Precision);
+        ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+        FString Actual;
+        EXPECT_TRUE(TimeSystem.Format(et, TimeFormat, Precision, Actual));
+        EXPECT_EQ(Actual, Expected) << "format " << (int)TimeFormat << ", precision " << Precision;
+    }
+}
+
+TEST(time_system_test, Format_Matches_et2utc) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ASSERT_TRUE(UpdateTimeSystem());
+    auto TimeSystem = GetTimeSystem();
+    ASSERT_TRUE(TimeSystem->IsValid());
+
+    const double Epochs[] = {
+        0.,
+        et0,
+        -et0,
+        EtOf(TEXT("1972-06-30T23:59:59.75")),
+        EtOf(TEXT("1999-12-31T23:59:59.9999")),
+        EtOf(TEXT("2024-02-29T06:30:00.125")),
+        EtOf(TEXT("2050-08-15T17:45:12.5"))
+    };
+
+    for (double et : Epochs)
+    {
+        for (int32 Precision : { 0, 3, 4, 8 })
+        {
+            ExpectSameAsEt2utc(*TimeSystem, et, Precision);
+        }
+    }
+}
+
+TEST(time_system_test, LeapSecond_Matches_et2utc) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ASSERT_TRUE(UpdateTimeSystem());
+    auto TimeSystem = GetTimeSystem();
+
+    double Leap = EtOf(TEXT("2016-12-31T23:59:60"));
+
+    for (double Offset : { -1.5, -0.25, 0., 0.5, 0.9999, 1., 1.25 })
+    {
+        ExpectSameAsEt2utc(*TimeSystem, Leap + Offset, 4);
+    }
+
+    FUtcCalendar Calendar;
+    ASSERT_TRUE(TimeSystem->Decompose(Leap + 0.5, 1, Calendar));
+    EXPECT_EQ(Calendar.Year, 2016);
+    EXPECT_EQ(Calendar.DayOfYear, 366);
+    EXPECT_EQ(Calendar.Second, 60);
+    EXPECT_EQ(Calendar.Fraction, 5);
+}
+
+TEST(time_system_test, Parse_Matches_str2et) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ASSERT_TRUE(UpdateTimeSystem());
+    auto TimeSystem = GetTimeSystem();
+
+    const TCHAR* Strings[] = {
+        TEXT("2022-09-23T18:45:01.500"),
+        TEXT("2022-266T18:45:01.500"),
+        TEXT("2022 SEP 23 18:45:01.500"),
+        TEXT("2022 SEP 23 18:45:01.5000 UTC"),
+        TEXT("2022-09-23T18:45:01"),
+        TEXT("2024-02-29T00:00:00.00000000000001"),
+        TEXT("1583-01-01T00:00:00"),
+        TEXT("9999-365T23:59:59.999")
+    };
+
+    for (const TCHAR* Str : Strings)
+    {
+        double et = 0.;
+        EXPECT_TRUE(TimeSystem->Parse(Str, et)) << TCHAR_TO_ANSI(Str);
+        EXPECT_NEAR(et, EtOf(Str), 1e-6) << TCHAR_TO_ANSI(Str);
+    }
+}
+
+TEST(time_system_test, Parse_LeapSecond_Matches_str2et) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ASSERT_TRUE(UpdateTimeSystem());
+    auto TimeSystem = GetTimeSystem();
+
+    // Either side of, and inside, the leap seconds at the end of 1972 JUN 30
+    // and 2016 DEC 31
+    const TCHAR* Strings[] = {
+        TEXT("1972-06-30T23:59:59"),
+        TEXT("1972-06-30T23:59:60"),
+        TEXT("1972-06-30T23:59:60.999"),
+        TEXT("1972-07-01T00:00:00"),
+        TEXT("2016-12-31T23:59:59.5"),
+        TEXT("2016-12-31T23:59:60"),
+        TEXT("2016-12-31T23:59:60.25"),
+        TEXT("2016-366T23:59:60.75"),
+        TEXT("2016 DEC 31 23:59:60.9999 UTC"),
+        TEXT("2017-01-01T00:00:00"),
+        TEXT("2017-01-01T00:00:00.001")
+    };
+
+    double Previous = -1.e30;
+    for (const TCHAR* Str : Strings)
+    {
+        double et = 0.;
+        EXPECT_TRUE(TimeSystem->Parse(Str, et)) << TCHAR_TO_ANSI(Str);
+        EXPECT_NEAR(et, EtOf(Str), 1e-6) << TCHAR_TO_ANSI(Str);
+
+        // Strictly increasing through the leap second
+        EXPECT_GT(et, Previous) << TCHAR_TO_ANSI(Str);
+        Previous = et;
+    }
+
+    // And back through et2utc_c's text
+    const double Leap = EtOf(TEXT("2016-12-31T23:59:60"));
+    for (double Offset : { -1.5, -0.25, 0., 0.5, 0.9999, 1., 1.25 })
+    {
+        for (ES_UTCTimeFormat TimeFormat : { ES_UTCTimeFormat::Calendar, ES_UTCTimeFormat::ISOCalendar, ES_UTCTimeFormat::ISODayOfYear })
+        {
+            ES_ResultCode ResultCode = ES_ResultCode::Error;
+            FString ErrorMessage;
+            FString Str;
+            USpice::et2utc(ResultCode, ErrorMessage, FSEphemerisTime(Leap + Offset), TimeFormat, Str, 6);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            double et = 0.;
+            EXPECT_TRUE(TimeSystem->Parse(*Str, et)) << TCHAR_TO_ANSI(*Str);
+            EXPECT_NEAR(et, Leap + Offset, 1e-6) << TCHAR_TO_ANSI(*Str);
+        }
+    }
+
+    // No leap second at the end of this day
+    double et = 0.;
+    EXPECT_FALSE(TimeSystem->Parse(TEXT("2022-09-23T23:59:60"), et));
+}
+
+TEST(time_system_test, Parse_Leaves_The_Rest_To_str2et) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ASSERT_TRUE(UpdateTimeSystem());
+    auto TimeSystem = GetTimeSystem();
+
+    // All fine for str2et_c, none are the native forms
+    const TCHAR* Strings[] = {
+        TEXT("2022 sep 23 18:45:01.500"),
+        TEXT("2022 SEP 23 18:45"),
+        TEXT("2022-09-23"),
+        TEXT(" 2022-09-23T18:45:01"),
+        TEXT("2022-09-23T18:45:01.500 TDB"),
+        TEXT("2022-09-23T18:45:01.500 TDT"),
+        TEXT("JD 2459846.281"),
+        TEXT("23 SEP 2022 18:45:01")
+    };
+
+    for (const TCHAR* Str : Strings)
+    {
+        double et = 0.;
+        EXPECT_FALSE(TimeSystem->Parse(Str, et)) << TCHAR_TO_ANSI(Str);
+
+        // FromString still gets there, through str2et_c
+        EXPECT_NEAR(FSEphemerisTime::FromString(Str).seconds, EtOf(Str), 1e-6) << TCHAR_TO_ANSI(Str);
+    }
+
+    double et = 0.;
+    EXPECT_FALSE(TimeSystem->Parse(TEXT("2022-09-23T18:45:60"), et));
+    EXPECT_FALSE(TimeSystem->Parse(TEXT("2022-000T00:00:00"), et));
+    EXPECT_FALSE(TimeSystem->Parse(TEXT("2022-09-23T18:45:01."), et));
+    EXPECT_FALSE(TimeSystem->Parse(TEXT("2022-09-23T18:45:01 PST"), et));
+
+    // ToString's output is the native calendar form
+    const FSEphemerisTime Epoch(et0);
+    EXPECT_TRUE(TimeSystem->Parse(*Epoch.ToString(), et));
+    EXPECT_NEAR(et, et0, 1e-4);
+}
+
+TEST(time_system_test, Now_Is_Utc_Plus_DeltaEt) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ASSERT_TRUE(UpdateTimeSystem());
+
+    auto UtcNow = []()
+    {
+        const FDateTime Now = FDateTime::UtcNow();
+        return EtOf(FString::Printf(TEXT("%04d-%02d-%02dT%02d:%02d:%02d.%03d"),
+            Now.GetYear(), Now.GetMonth(), Now.GetDay(), Now.GetHour(), Now.GetMinute(), Now.GetSecond(), Now.GetMillisecond()));
+    };
+
+    const double Before = UtcNow();
+    FSEphemerisTime Now;
+    USpice::et_now(Now);
+    const FSEphemerisTime DataNow = MaxQ::Data::Now();
+    const double After = UtcNow();
+
+    // str2et_c puts the wall clock (UTC) on ET, so this pins the TDB-UTC
+    // shift (69.18s, in 2022) and not just the epoch.  The slack is for the
+    // monotonic clock drifting from the wall clock since it was anchored.
+    EXPECT_GE(Now.seconds, Before - 0.25);
+    EXPECT_LE(Now.seconds, After + 0.25);
+    EXPECT_GE(DataNow.seconds, Before - 0.25);
+    EXPECT_LE(DataNow.seconds, After + 0.25);
+
+    // ...which plain seconds past J2000 on the wall clock would miss
+    const double WallClock = (FDateTime::UtcNow() - FDateTime::FromJulianDay(2451545.0)).GetTotalSeconds();
+    EXPECT_GT(Now.seconds - WallClock, 60.);
+}
+
+TEST(time_system_test, Conversions_RoundTrip) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ASSERT_TRUE(UpdateTimeSystem());
+    auto TimeSystem = GetTimeSystem();
+
+    for (double et : { -et0, 0., et0, 1e9 })
+    {
+        EXPECT_NEAR(TimeSystem->UtcToEt(TimeSystem->EtToUtc(et)), et, 1e-6);
+        EXPECT_NEAR(TimeSystem->TtToEt(TimeSystem->EtToTt(et)), et, 1e-9);
+        EXPECT_NEAR(TimeSystem->TaiToEt(TimeSystem->EtToTai(et)), et, 1e-9);
+    }
+
+    // TDT is TAI + 32.184s, and ET stays within a couple of ms of TDT
+    double et = EtOf(TEXT("2022-01-01T00:00:00"));
+    EXPECT_NEAR(TimeSystem->EtToTt(et) - TimeSystem->EtToTai(et), 32.184, 1e-9);
+    EXPECT_NEAR(TimeSystem->EtToTt(et), et, 2e-3);
+    EXPECT_DOUBLE_EQ(TimeSystem->DeltaAt(TimeSystem->EtToUtc(et)), 37.);
+}
+
+TEST(time_system_test, Update_FollowsPool) {
+
+    USpice::init_all();
+    USpice::clear_all();
+
+    EXPECT_FALSE(UpdateTimeSystem());
+    EXPECT_FALSE(GetTimeSystem()->IsValid());
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    EXPECT_TRUE(UpdateTimeSystem());
+
+    auto First = GetTimeSystem();
+    EXPECT_TRUE(UpdateTimeSystem());
+    EXPECT_EQ(&GetTimeSystem().Get(), &First.Get());
+}
@@ -0,0 +1,109 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceTLEBake.h"
+#include "SpiceTLECatalog.h"
+
+using namespace MaxQ::Orbits;
+
+// spkopn needs a project directory, so these stop short of writing.
+
+static FSTLEGeophysicalConstants WGS72()
+{
+    double geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+    return FSTLEGeophysicalConstants(geophs);
+}
+
+static const TCHAR* Text =
+    TEXT("LUME 1\r\n")
+    TEXT("1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999\r\n")
+    TEXT("2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544\r\n")
+    TEXT("LUME 1\r\n")
+    TEXT("1 43908U 18111AJ  20146.20805006  .00000806  00000-0  34965-4 0  9999\r\n")
+    TEXT("2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544\r\n");
+
+
+TEST(tle_bake_test, Body_Ids_And_Grouping) {
+
+    EXPECT_EQ(TLEBodyId(TEXT("43908")), -143908);
+    EXPECT_EQ(TLEBodyId(TEXT(" 25544 ")), -125544);
+    EXPECT_EQ(TLEBodyId(TEXT("A0001")), 0);
+    EXPECT_EQ(TLEBodyId(TEXT("")), 0);
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSTLECatalog Catalog;
+    ASSERT_EQ(ParseTLECatalog(Text, Catalog, ETLECatalogFormat::Auto, 1957, &ResultCode, &ErrorMessage), 2);
+
+    // Both sets are one object's, by epoch
+    TArray<FTLEBakedObject> Objects;
+    GroupTLEObjects(Catalog, Objects, &ResultCode, &ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_EQ(Objects.Num(), 1);
+    EXPECT_EQ(Objects[0].Body, -143908);
+    EXPECT_EQ(Objects[0].SegmentId, TEXT("LUME 1"));
+    ASSERT_EQ(Objects[0].Entries.Num(), 2);
+    EXPECT_EQ(Objects[0].Entries[0], 1);
+    EXPECT_EQ(Objects[0].Entries[1], 0);
+}
+
+
+TEST(tle_bake_test, Chebyshev_Fit_Follows_SGP4) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSTLECatalog Catalog;
+    ASSERT_EQ(ParseTLECatalog(Text, Catalog, ETLECatalogFormat::Auto, 1957, &ResultCode, &ErrorMessage), 2);
+
+    TArray<FTLEBakedObject> Objects;
+    GroupTLEObjects(Catalog, Objects);
+    ASSERT_EQ(Objects.Num(), 1);
+
+    const FSEphemerisTime Start = Catalog.GetEpoch(0);
+    const FSEphemerisTime Stop = Start + FSEphemerisPeriod(3. * 3600.);
+
+    FTLEBakeSettings Settings;
+    Settings.Type = ETLEBakeType::Type03;
+    Settings.SampleSeconds = 30.;
+    Settings.Fit.MaxRecordSeconds = 600.;
+    EXPECT_TRUE(FitTLEObjects(Catalog, WGS72(), Objects, Start, Stop, Settings, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_GT(Objects[0].Segments.Num(), 0);
+
+    // The rotation to J2000 keeps distances, so compare those with the
+    // closest set's TEME states
+    FSGP4Propagator Propagator(WGS72(), Catalog.GetElements(0));
+    ASSERT_TRUE(Propagator.IsValid());
+    for (double t = Start.seconds; t <= Stop.seconds; t += 417.)
+    {
+        double teme[6];
+        ASSERT_EQ(Propagator.Propagate(t, teme), ESGP4Status::Ok);
+
+        double r[3], v[3];
+        const MaxQ::Ephemeris::FSpkChebyshevSegment* Segment = Objects[0].Segments.FindByPredicate([t](const auto& s) { return s.First <= t && t <= s.Last; });
+        ASSERT_NE(Segment, nullptr);
+        ASSERT_TRUE(Segment->Evaluate(t, r, v));
+
+        EXPECT_NEAR(FMath::Sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]), FMath::Sqrt(teme[0] * teme[0] + teme[1] * teme[1] + teme[2] * teme[2]), 0.01);
+        EXPECT_NEAR(FMath::Sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]), FMath::Sqrt(teme[3] * teme[3] + teme[4] * teme[4] + teme[5] * teme[5]), 1.e-4);
+    }
+
+    // Type 10 isn't fit
+    Settings.Type = ETLEBakeType::Type10;
+    EXPECT_FALSE(FitTLEObjects(Catalog, WGS72(), Objects, Start, Stop, Settings, &ResultCode, &ErrorMessage));
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+}
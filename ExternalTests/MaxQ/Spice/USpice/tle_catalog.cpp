@@ -0,0 +1,120 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceTLECatalog.h"
+
+using namespace MaxQ::Orbits;
+
+static const TCHAR* lume1[] = {
+    TEXT("1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999"),
+    TEXT("2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544")
+};
+
+static const TCHAR* molniya[] = {
+    TEXT("1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813"),
+    TEXT("2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656")
+};
+
+static void ExpectSameAsGetelm(const FSTLECatalog& Catalog, int32 Index, const TCHAR* line1, const TCHAR* line2)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+
+    FSEphemerisTime epoch;
+    FSTwoLineElements expected;
+    USpice::getelm(ResultCode, ErrorMessage, epoch, expected, line1, line2);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    FSTwoLineElements actual = Catalog.GetElements(Index);
+    for (int i = 0; i < FSTwoLineElements::EPOCH; ++i)
+    {
+        EXPECT_NEAR(actual.elems[i], expected.elems[i], 1e-12 * FMath::Max(1., FMath::Abs(expected.elems[i])));
+    }
+
+    EXPECT_NEAR(Catalog.GetEpoch(Index).seconds, epoch.seconds, 1e-4);
+}
+
+TEST(tle_catalog_test, ThreeLineText_Matches_getelm) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    FString Text = FString::Printf(TEXT("LUME 1\r\n%s\r\n%s\r\n0 MOLNIYA 1-29\r\n%s\r\n%s\r\n"), lume1[0], lume1[1], molniya[0], molniya[1]);
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FSTLECatalog Catalog;
+
+    EXPECT_EQ(ParseTLECatalog(Text, Catalog, ETLECatalogFormat::Auto, 1957, &ResultCode, &ErrorMessage), 2);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_EQ(Catalog.Num(), 2);
+
+    EXPECT_EQ(Catalog.ObjectIds[0], TEXT("43908"));
+    EXPECT_EQ(Catalog.ObjectNames[0], TEXT("LUME 1"));
+    EXPECT_EQ(Catalog.ObjectNames[1], TEXT("MOLNIYA 1-29"));
+
+    ExpectSameAsGetelm(Catalog, 0, lume1[0], lume1[1]);
+    ExpectSameAsGetelm(Catalog, 1, molniya[0], molniya[1]);
+
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+}
+
+TEST(tle_catalog_test, OMMJson_Matches_getelm) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    FString Text = TEXT(R"([{"OBJECT_NAME":"LUME 1","OBJECT_ID":"2018-111AJ","EPOCH":"2020-05-25T14:35:35.525184",)"
+        TEXT(R"("MEAN_MOTION":15.24999521,"ECCENTRICITY":0.0020001,"INCLINATION":97.2676,"RA_OF_ASC_NODE":47.2136,)")
+        TEXT(R"("ARG_OF_PERICENTER":220.605,"MEAN_ANOMALY":139.3698,"EPHEMERIS_TYPE":0,"CLASSIFICATION_TYPE":"U",)")
+        TEXT(R"("NORAD_CAT_ID":43908,"ELEMENT_SET_NO":999,"REV_AT_EPOCH":7854,"BSTAR":3.4965e-5,)")
+        TEXT(R"("MEAN_MOTION_DOT":8.06e-6,"MEAN_MOTION_DDOT":0}])");
+
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FSTLECatalog Catalog;
+
+    EXPECT_EQ(ParseTLECatalog(Text, Catalog, ETLECatalogFormat::Auto, 1957, &ResultCode, &ErrorMessage), 1);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    ASSERT_EQ(Catalog.Num(), 1);
+    EXPECT_EQ(Catalog.ObjectIds[0], TEXT("43908"));
+    EXPECT_EQ(Catalog.ObjectNames[0], TEXT("LUME 1"));
+
+    ExpectSameAsGetelm(Catalog, 0, lume1[0], lume1[1]);
+
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+}
+
+TEST(tle_catalog_test, BadElementSet_Skipped) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+    // Mean anomaly out of range
+    FString Text = FString::Printf(TEXT("%s\n%s\n%s\n%s\n"),
+        lume1[0], TEXT("2 43908  97.2676  47.2136 0020001 220.6050 739.3698 15.24999521 78544"),
+        molniya[0], molniya[1]);
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    FSTLECatalog Catalog;
+
+    EXPECT_EQ(ParseTLECatalog(Text, Catalog, ETLECatalogFormat::TLE, 1957, &ResultCode, &ErrorMessage), 1);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Error);
+    EXPECT_GT(ErrorMessage.Len(), 0);
+    ASSERT_EQ(Catalog.Num(), 1);
+    EXPECT_EQ(Catalog.ObjectNames[0], TEXT("08195"));
+
+    ExpectSameAsGetelm(Catalog, 0, molniya[0], molniya[1]);
+
+    USpice::get_implied_result(ResultCode, ErrorMessage);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+}
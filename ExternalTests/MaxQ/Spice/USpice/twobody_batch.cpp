@@ -0,0 +1,241 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceTwoBody.h"
+
+using namespace MaxQ::Orbits;
+
+static const double gm_earth = 398600.4418;
+
+static TArray<FSConicElements> TestOrbits()
+{
+    TArray<FSConicElements> Orbits;
+
+    // rp, ecc, inc, lnode, argp, m0, t0
+    const double elts[][7] = {
+        {  6778.,   0.001, 0.90, 1.0,  0.3, 0.2,  1e8 },
+        {  7000.,   0.7,   1.10, 4.0,  4.7, 3.0,  2e8 },
+        { 26600.,   0.01,  0.96, 2.5,  1.2, 6.0,  0. },
+        {  6800.,   1.5,   0.40, 0.1,  2.0, 0.5,  3e8 },
+        {  7200.,   1.0,   2.50, 5.0,  0.7, 0.1,  1e8 },
+        { 42164.,   0.,    0.,   0.,   0.,  1.0, -1e8 },
+        {  6378.,   0.3,   0.5,  0.5,  0.5, 0.5,  0. }
+    };
+
+    for (const auto& e : elts)
+    {
+        Orbits.Add(FSConicElements(FSDistance(e[0]), e[1], FSAngle(e[2]), FSAngle(e[3]), FSAngle(e[4]), FSAngle(e[5]), FSEphemerisTime(e[6]), FSMassConstant(gm_earth)));
+    }
+
+    // Invalid:  non-positive periapsis
+    Orbits.Add(FSConicElements(FSDistance(0.), 0.1, FSAngle(0.), FSAngle(0.), FSAngle(0.), FSAngle(0.), FSEphemerisTime(0.), FSMassConstant(gm_earth)));
+
+    return Orbits;
+}
+
+TEST(twobody_batch_test, Conics_Matches_conics) {
+
+    USpice::init_all();
+
+    TArray<FSConicElements> Orbits = TestOrbits();
+
+    FTwoBodyBatchPropagator Batch;
+    Batch.Build(Orbits);
+    ASSERT_EQ(Batch.Num(), Orbits.Num());
+    EXPECT_FALSE(Batch.IsValid(Orbits.Num() - 1));
+
+    TArray<FSStateVector> States;
+    States.SetNum(Orbits.Num());
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    for (double et : { 1e8, 1e8 + 3600., 2.5e8, 3e8 - 86400., 6e8 })
+    {
+        EXPECT_EQ(Batch.Propagate(FSEphemerisTime(et), States), Orbits.Num() - 1);
+
+        for (int32 i = 0; i < Orbits.Num() - 1; ++i)
+        {
+            FSStateVector expected;
+            USpice::conics(ResultCode, ErrorMessage, Orbits[i], FSEphemerisTime(et), expected);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            // Hyperbolic/parabolic are far away after years
+            const double scale = FMath::Max(1., expected.r.Magnitude().km / 1e5);
+            EXPECT_TRUE(IsNear(expected, States[i], 1e-6 * scale, 1e-9 * scale)) << "orbit " << i << " et " << et;
+        }
+
+        EXPECT_EQ(States.Last().r.x.km, 0.);
+    }
+}
+
+TEST(twobody_batch_test, States_Matches_prop2b) {
+
+    USpice::init_all();
+
+    TArray<FSConicElements> Orbits = TestOrbits();
+    Orbits.Pop();
+
+    // "Ghosts":  perturbations of one state, all at the same epoch
+    const FSEphemerisTime epoch(1e8);
+    FSStateVector base;
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    USpice::conics(ResultCode, ErrorMessage, Orbits[1], epoch, base);
+    ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+    TArray<FSStateVector> Ghosts;
+    for (int32 i = 0; i < 37; ++i)
+    {
+        double s[6]; base.CopyTo(s);
+        s[3] += 0.05 * (i - 18);
+        s[5] += 0.01 * (i % 5);
+        Ghosts.Add(FSStateVector(s));
+    }
+
+    FTwoBodyBatchPropagator Batch;
+    Batch.Build(FSMassConstant(gm_earth), Ghosts, epoch);
+
+    // Rotate by 30 degrees about z
+    const double c = cos(FMath::DegreesToRadians(30.)), s = sin(FMath::DegreesToRadians(30.));
+    const double m[3][3] = { { c, -s, 0. }, { s, c, 0. }, { 0., 0., 1. } };
+    const FSRotationMatrix Rotation(m);
+
+    TArray<FSStateVector> States;
+    States.SetNum(Ghosts.Num());
+
+    for (double dt : { 0., 60., -5400., 86400. * 3 })
+    {
+        EXPECT_EQ(Batch.Propagate(epoch + FSEphemerisPeriod(dt), States, &Rotation), Ghosts.Num());
+
+        for (int32 i = 0; i < Ghosts.Num(); ++i)
+        {
+            FSStateVector propagated;
+            USpice::prop2b(ResultCode, ErrorMessage, FSMassConstant(gm_earth), Ghosts[i], FSEphemerisPeriod(dt), propagated);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            double p[6]; propagated.CopyTo(p);
+            double e[6];
+            for (int32 j = 0; j < 3; ++j)
+            {
+                e[j] = m[j][0] * p[0] + m[j][1] * p[1] + m[j][2] * p[2];
+                e[j + 3] = m[j][0] * p[3] + m[j][1] * p[4] + m[j][2] * p[5];
+            }
+
+            const double scale = FMath::Max(1., propagated.r.Magnitude().km / 1e5);
+            EXPECT_TRUE(IsNear(FSStateVector(e), States[i], 1e-6 * scale, 1e-9 * scale)) << "ghost " << i << " dt " << dt;
+        }
+    }
+}
+
+TEST(twobody_batch_test, Prop2bBatch_Matches_prop2b) {
+
+    USpice::init_all();
+
+    const double states[][6] = {
+        { 7000., 100., -200., 1., 7.4, .5 },
+        { -20000., 5000., 3000., -1., -3., .4 },
+        { 6800., 0., 0., 0., 10.9, .3 },
+        // Invalid:  zero velocity
+        { 7000., 0., 0., 0., 0., 0. }
+    };
+    TArray<FSStateVector> States;
+    for (const auto& s : states)
+    {
+        States.Add(FSStateVector(s));
+    }
+
+    const TArray<FSEphemerisPeriod> Offsets = { 0., 60., -5400., 86400. * 3.3, 1e6, -7e5, 1., 2., 3. };
+
+    TArray<FSStateVector> Propagated;
+    Propagated.SetNum(States.Num() * Offsets.Num());
+    TArray<bool> Valid;
+    Valid.SetNum(States.Num());
+    EXPECT_EQ(Prop2bBatch(FSMassConstant(gm_earth), States, Offsets, Propagated, {}, Valid), States.Num() - 1);
+    EXPECT_FALSE(Valid.Last());
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    for (int32 i = 0; i < States.Num() - 1; ++i)
+    {
+        EXPECT_TRUE(Valid[i]);
+        for (int32 j = 0; j < Offsets.Num(); ++j)
+        {
+            FSStateVector expected;
+            USpice::prop2b(ResultCode, ErrorMessage, FSMassConstant(gm_earth), States[i], Offsets[j], expected);
+            ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+            const double scale = FMath::Max(1., expected.r.Magnitude().km / 1e5);
+            EXPECT_TRUE(IsNear(expected, Propagated[i * Offsets.Num() + j], 1e-6 * scale, 1e-9 * scale)) << "state " << i << " dt " << Offsets[j].seconds;
+        }
+    }
+
+    EXPECT_EQ(Propagated.Last().r.x.km, 0.);
+}
+
+TEST(twobody_batch_test, Prop2bBatch_Stm) {
+
+    const double states[][6] = {
+        { 7000., 100., -200., 1., 7.4, .5 },
+        { 6800., 0., 0., 0., 11.5, 1. },
+        { -20000., 5000., 3000., -1., -3., .4 }
+    };
+    const TArray<FSEphemerisPeriod> Offsets = { 0., 60., -5400., 86400. * 3.3, 1e6 };
+
+    for (const auto& s : states)
+    {
+        TArray<FSStateVector> Propagated;
+        TArray<FSStateTransform> Stm;
+        Propagated.SetNum(Offsets.Num());
+        Stm.SetNum(Offsets.Num());
+        ASSERT_EQ(Prop2bBatch(FSMassConstant(gm_earth), { FSStateVector(s) }, Offsets, Propagated, Stm), 1);
+
+        // Central differences
+        for (int32 k = 0; k < 6; ++k)
+        {
+            const double h = k < 3 ? 1e-3 : 1e-6;
+            double plus[6], minus[6];
+            FMemory::Memcpy(plus, s);
+            FMemory::Memcpy(minus, s);
+            plus[k] += h;
+            minus[k] -= h;
+
+            TArray<FSStateVector> Plus, Minus;
+            Plus.SetNum(Offsets.Num());
+            Minus.SetNum(Offsets.Num());
+            Prop2bBatch(FSMassConstant(gm_earth), { FSStateVector(plus) }, Offsets, Plus);
+            Prop2bBatch(FSMassConstant(gm_earth), { FSStateVector(minus) }, Offsets, Minus);
+
+            for (int32 j = 0; j < Offsets.Num(); ++j)
+            {
+                double p[6], m[6], phi[6][6];
+                Plus[j].CopyTo(p);
+                Minus[j].CopyTo(m);
+                Stm[j].CopyTo(phi);
+
+                for (int32 Row = 0; Row < 6; ++Row)
+                {
+                    const double fd = (p[Row] - m[Row]) / (2. * h);
+                    EXPECT_NEAR(phi[Row][k], fd, 1e-4 * FMath::Max(1., FMath::Abs(fd))) << "dt " << Offsets[j].seconds << " row " << Row << " col " << k;
+                }
+            }
+        }
+
+        // At dt = 0 it's the identity
+        double phi0[6][6];
+        Stm[0].CopyTo(phi0);
+        for (int32 Row = 0; Row < 6; ++Row)
+        {
+            for (int32 Col = 0; Col < 6; ++Col)
+            {
+                EXPECT_NEAR(phi0[Row][Col], Row == Col ? 1. : 0., 1e-12);
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceTime.h"
+
+using namespace MaxQ::Time;
+
+static double EtOf(const FString& Str)
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Error;
+    FString ErrorMessage;
+    FSEphemerisTime et;
+    USpice::str2et(ResultCode, ErrorMessage, et, Str);
+    EXPECT_EQ(ResultCode, ES_ResultCode::Success);
+    return et.seconds;
+}
+
+// Steps a clock from et by Step, checking every frame against a full Format
+static void ExpectSameAsFormat(ES_UTCTimeFormat TimeFormat, int32 Precision, double et, double Step, int32 Frames)
+{
+    FUtcClock Clock(TimeFormat, Precision);
+    auto TimeSystem = GetTimeSystem();
+
+    FString Previous;
+    for (int32 i = 0; i < Frames; ++i)
+    {
+        const double t = et + i * Step;
+
+        FString Expected;
+        ASSERT_TRUE(TimeSystem->Format(t, TimeFormat, Precision, Expected));
+
+        const bool bChanged = Clock.Update(t);
+        EXPECT_EQ(Clock.ToString(), Expected) << "frame " << i;
+        EXPECT_EQ(Clock.Len(), Expected.Len());
+        EXPECT_EQ(bChanged, Expected != Previous) << "frame " << i;
+
+        Previous = Expected;
+    }
+}
+
+TEST(utc_clock_test, Frames_Match_Format) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    ASSERT_TRUE(UpdateTimeSystem());
+
+    // 60Hz frames across a minute, an hour and a day boundary
+    const double Midnight = EtOf(TEXT("2022-03-31T23:59:58"));
+
+    for (ES_UTCTimeFormat TimeFormat : { ES_UTCTimeFormat::Calendar, ES_UTCTimeFormat::DayOfYear, ES_UTCTimeFormat::ISOCalendar, ES_UTCTimeFormat::ISODayOfYear })
+    {
+        for (int32 Precision : { 0, 1, 4, 9 })
+        {
+            ExpectSameAsFormat(TimeFormat, Precision, Midnight, 1. / 60., 300);
+        }
+    }
+
+    // Time-lapse steps
+    ExpectSameAsFormat(ES_UTCTimeFormat::ISOCalendar, 3, Midnight, 0.999, 200);
+    ExpectSameAsFormat(ES_UTCTimeFormat::ISOCalendar, 3, Midnight, 3599.9, 50);
+    ExpectSameAsFormat(ES_UTCTimeFormat::ISOCalendar, 3, Midnight, -86400. * 3.1, 50);
+    ExpectSameAsFormat(ES_UTCTimeFormat::JulianDate, 6, Midnight, 1. / 60., 100);
+}
+
+TEST(utc_clock_test, LeapSecond_Matches_Format) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    ASSERT_TRUE(UpdateTimeSystem());
+
+    const double Leap = EtOf(TEXT("2016-12-31T23:59:60"));
+
+    ExpectSameAsFormat(ES_UTCTimeFormat::ISOCalendar, 2, Leap - 2., 1. / 60., 300);
+    ExpectSameAsFormat(ES_UTCTimeFormat::Calendar, 0, Leap - 2., 0.1, 50);
+
+    FUtcClock Clock(ES_UTCTimeFormat::ISOCalendar, 1);
+    Clock.Update(Leap + 0.5);
+    EXPECT_STREQ(TCHAR_TO_ANSI(Clock.GetText()), "2016-12-31T23:59:60.5");
+}
+
+TEST(utc_clock_test, SetFormat_Rerenders) {
+
+    USpice::init_all();
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    ASSERT_TRUE(UpdateTimeSystem());
+
+    FUtcClock Clock;
+    EXPECT_TRUE(Clock.Update(et0));
+    EXPECT_FALSE(Clock.Update(et0));
+
+    FString Expected;
+    ASSERT_TRUE(GetTimeSystem()->Format(et0, ES_UTCTimeFormat::Calendar, 4, Expected));
+    EXPECT_EQ(Clock.ToString(), Expected);
+
+    Clock.SetFormat(ES_UTCTimeFormat::ISODayOfYear, 2);
+    EXPECT_EQ(Clock.Len(), 0);
+    EXPECT_TRUE(Clock.Update(et0));
+    ASSERT_TRUE(GetTimeSystem()->Format(et0, ES_UTCTimeFormat::ISODayOfYear, 2, Expected));
+    EXPECT_EQ(Clock.ToString(), Expected);
+}
+
+TEST(utc_clock_test, FollowsPool) {
+
+    USpice::init_all();
+    USpice::clear_all();
+
+    FUtcClock Clock;
+    EXPECT_FALSE(Clock.Update(et0));
+    EXPECT_EQ(Clock.Len(), 0);
+
+    USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+    EXPECT_TRUE(Clock.Update(et0));
+    EXPECT_GT(Clock.Len(), 0);
+
+    USpice::clear_all();
+    EXPECT_TRUE(Clock.Update(et0));
+    EXPECT_EQ(Clock.Len(), 0);
+}
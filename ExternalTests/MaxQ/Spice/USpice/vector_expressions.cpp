@@ -0,0 +1,55 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceOperators.h"
+
+using MaxQ::Math::Lazy;
+using MaxQ::Math::Eval;
+
+TEST(vector_expressions_test, Matches_Eager_Operators) {
+
+    const FSDistanceVector r1(7000., -12., 300.), r2(-1., 2., 3.);
+    const FSVelocityVector v(1.5, 7.2, -0.3);
+    const FSEphemerisPeriod dt(60.);
+
+    const FSDistanceVector expected = r1 + v * dt - r2;
+    const FSDistanceVector r = Lazy(r1) + Lazy(v) * dt - r2;
+
+    EXPECT_DOUBLE_EQ(r.x.km, expected.x.km);
+    EXPECT_DOUBLE_EQ(r.y.km, expected.y.km);
+    EXPECT_DOUBLE_EQ(r.z.km, expected.z.km);
+
+    const FSDistanceVector r3 = Eval(2. * (Lazy(r1) - r2) / 4. + dt * Lazy(v));
+    const FSDistanceVector expected3 = 0.5 * (r1 - r2) + dt * v;
+
+    EXPECT_DOUBLE_EQ(r3.x.km, expected3.x.km);
+    EXPECT_DOUBLE_EQ(r3.y.km, expected3.y.km);
+    EXPECT_DOUBLE_EQ(r3.z.km, expected3.z.km);
+}
+
+TEST(vector_expressions_test, StateVectors_And_Units) {
+
+    const double s1[6] = { 1., 2., 3., 0.1, 0.2, 0.3 };
+    const double s2[6] = { 6., 5., 4., 0.6, 0.5, 0.4 };
+
+    const FSStateVector state = -(Lazy(FSStateVector(s1)) - Lazy(FSStateVector(s2)) * 2.);
+    double out[6];  state.CopyTo(out);
+    for (int i = 0; i < 6; ++i) EXPECT_DOUBLE_EQ(out[i], 2. * s2[i] - s1[i]);
+
+    // Dimensionless * units
+    const FSDimensionlessVector u(0., 0.6, 0.8);
+    const FSVelocityVector v = Lazy(u) * FSSpeed(10.);
+    EXPECT_DOUBLE_EQ(v.dy.kmps, 6.);
+    EXPECT_DOUBLE_EQ(v.dz.kmps, 8.);
+
+    const FSDistanceVector r = Lazy(u) * FSDistance(100.) + FSDistanceVector(1., 1., 1.);
+    EXPECT_DOUBLE_EQ(r.x.km, 1.);
+    EXPECT_DOUBLE_EQ(r.y.km, 61.);
+    EXPECT_DOUBLE_EQ(r.z.km, 81.);
+}
@@ -0,0 +1,71 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMath.h"
+
+using namespace MaxQ::Math;
+
+TEST(vector_math_test, Vcrss_Matches_vcrss_c) {
+
+    FRandomStream Random(2468);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const FSDimensionlessVector v1(Random.FRandRange(-1e4, 1e4), Random.FRandRange(-1e4, 1e4), Random.FRandRange(-1e4, 1e4));
+        const FSDimensionlessVector v2(Random.FRandRange(-1., 1.), Random.FRandRange(-1., 1.), Random.FRandRange(-1., 1.));
+
+        FSDimensionlessVector expected;
+        USpice::vcrss(v1, v2, expected);
+
+        EXPECT_TRUE(IsNear(Vcrss(v1, v2), expected, 1e-10)) << "case " << i;
+
+        // The output may alias either input
+        FSDimensionlessVector v = v1;
+        Vcrss(v, v, v2);
+        EXPECT_TRUE(IsNear(v, expected, 1e-10)) << "case " << i;
+    }
+}
+
+TEST(vector_math_test, Distance_And_State_Vectors) {
+
+    const FSDistanceVector r1(1., 2., 3.), r2(-4., 5., 0.5);
+
+    const FSDistanceVector sum = Vadd(r1, r2);
+    EXPECT_DOUBLE_EQ(sum.x.km, -3.);
+    EXPECT_DOUBLE_EQ(sum.y.km, 7.);
+    EXPECT_DOUBLE_EQ(sum.z.km, 3.5);
+
+    const FSDistanceVector difference = Vsub(r1, r2);
+    EXPECT_DOUBLE_EQ(difference.x.km, 5.);
+    EXPECT_DOUBLE_EQ(difference.y.km, -3.);
+    EXPECT_DOUBLE_EQ(difference.z.km, 2.5);
+
+    EXPECT_DOUBLE_EQ(Vdot<FSDistance>(r1, r2).km, 7.5);
+
+    const FSDistanceVector lcom = Vlcom3(2., r1, -1., r2, 0.5, Vminus(r1));
+    EXPECT_DOUBLE_EQ(lcom.x.km, 5.5);
+    EXPECT_DOUBLE_EQ(lcom.y.km, -2.);
+    EXPECT_DOUBLE_EQ(lcom.z.km, 4.);
+
+    const double s1[6] = { 1., 2., 3., 0.1, 0.2, 0.3 };
+    const double s2[6] = { 6., 5., 4., 0.6, 0.5, 0.4 };
+    const FSStateVector state1(s1), state2(s2);
+
+    double out[6];
+    Vadd(state1, state2).CopyTo(out);
+    for (int i = 0; i < 6; ++i) EXPECT_DOUBLE_EQ(out[i], s1[i] + s2[i]);
+
+    Vsub(state1, state2).CopyTo(out);
+    for (int i = 0; i < 6; ++i) EXPECT_DOUBLE_EQ(out[i], s1[i] - s2[i]);
+
+    Vlcom(3., state1, -2., state2).CopyTo(out);
+    for (int i = 0; i < 6; ++i) EXPECT_DOUBLE_EQ(out[i], 3. * s1[i] - 2. * s2[i]);
+
+    Vscl(-0.5, state1).CopyTo(out);
+    for (int i = 0; i < 6; ++i) EXPECT_DOUBLE_EQ(out[i], -0.5 * s1[i]);
+}
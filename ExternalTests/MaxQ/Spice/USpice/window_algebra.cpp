@@ -0,0 +1,114 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceWindow.h"
+
+using namespace MaxQ::GeometryFinder;
+
+// Expected values are the examples from the wn* routine headers.
+
+namespace
+{
+    FSWindow MakeWindow(std::initializer_list<double> Endpoints)
+    {
+        TArray<FSEphemerisTimeWindowSegment> Segments;
+        const double* e = Endpoints.begin();
+        for (size_t i = 0; i + 1 < Endpoints.size(); i += 2)
+        {
+            Segments.Add(FSEphemerisTimeWindowSegment(e[i], e[i + 1]));
+        }
+        return FSWindow(Segments);
+    }
+}
+
+
+TEST(window_algebra_test, Insert_MergesOverlaps) {
+
+    // wninsd
+    FSWindow Window = MakeWindow({ 1., 3., 7., 11., 23., 27. });
+    Window.Insert(5., 5.);
+    EXPECT_EQ(Window, MakeWindow({ 1., 3., 5., 5., 7., 11., 23., 27. }));
+    Window.Insert(4., 8.);
+    EXPECT_EQ(Window, MakeWindow({ 1., 3., 4., 11., 23., 27. }));
+    Window.Insert(0., 30.);
+    EXPECT_EQ(Window, MakeWindow({ 0., 30. }));
+
+    // Unsorted, overlapping input normalizes
+    FSWindow Unsorted = MakeWindow({ 23., 27., 1., 3., 2., 5., 5., 6. });
+    EXPECT_EQ(Unsorted, MakeWindow({ 1., 6., 23., 27. }));
+    EXPECT_EQ(Unsorted.Num(), 2);
+    EXPECT_DOUBLE_EQ(Unsorted.Measure(), 9.);
+
+    EXPECT_TRUE(Unsorted.Contains(6.));
+    EXPECT_FALSE(Unsorted.Contains(6.5));
+    EXPECT_TRUE(Unsorted.Contains(24., 27.));
+    EXPECT_FALSE(Unsorted.Contains(5., 24.));
+
+    TArray<FSEphemerisTimeWindowSegment> Segments = Unsorted.ToSegments();
+    ASSERT_EQ(Segments.Num(), 2);
+    EXPECT_DOUBLE_EQ(Segments[1].start.seconds, 23.);
+    EXPECT_DOUBLE_EQ(Segments[1].stop.seconds, 27.);
+
+    // Into an array that's already big enough:  no reallocation
+    TArray<FSEphemerisTimeWindowSegment> Reused;
+    Reused.SetNum(5);
+    const FSEphemerisTimeWindowSegment* Data = Reused.GetData();
+    Unsorted.ToSegments(Reused);
+    ASSERT_EQ(Reused.Num(), 2);
+    EXPECT_EQ(Reused.GetData(), Data);
+    EXPECT_DOUBLE_EQ(Reused[0].start.seconds, 1.);
+    EXPECT_DOUBLE_EQ(Reused[1].stop.seconds, 27.);
+}
+
+
+TEST(window_algebra_test, SetOperations) {
+
+    FSWindow a = MakeWindow({ 1., 3., 7., 11., 23., 27. });
+    FSWindow b = MakeWindow({ 2., 6., 8., 10., 16., 18. });
+
+    // wnunid, wnintd, wndifd
+    EXPECT_EQ(a | b, MakeWindow({ 1., 6., 7., 11., 16., 18., 23., 27. }));
+    EXPECT_EQ(a & b, MakeWindow({ 2., 3., 8., 10. }));
+    EXPECT_EQ(a - b, MakeWindow({ 1., 2., 7., 8., 10., 11., 23., 27. }));
+
+    // Removing a point removes nothing
+    EXPECT_EQ(a - MakeWindow({ 9., 9. }), a);
+
+    // wncomd
+    EXPECT_EQ(a.Complement(2., 20.), MakeWindow({ 3., 7., 11., 20. }));
+    EXPECT_EQ(FSWindow().Complement(0., 10.), MakeWindow({ 0., 10. }));
+}
+
+
+TEST(window_algebra_test, ContractExpandFilterFill) {
+
+    FSWindow a = MakeWindow({ 1., 3., 7., 11., 23., 27., 29., 29. });
+
+    // wncond
+    FSWindow Contracted = a;
+    Contracted.Contract(2., 1.);
+    EXPECT_EQ(Contracted, MakeWindow({ 9., 10., 25., 26. }));
+
+    // wnexpd
+    FSWindow Expanded = a;
+    Expanded.Expand(2., 1.);
+    EXPECT_EQ(Expanded, MakeWindow({ -1., 4., 5., 12., 21., 30. }));
+
+    // wnfltd
+    FSWindow Filtered = a;
+    Filtered.FilterSmall(3.);
+    EXPECT_EQ(Filtered, MakeWindow({ 7., 11., 23., 27. }));
+
+    // wnfild
+    FSWindow Filled = a;
+    Filled.FillSmall(2.);
+    EXPECT_EQ(Filled, MakeWindow({ 1., 3., 7., 11., 23., 29. }));
+    Filled.FillSmall(12.);
+    EXPECT_EQ(Filled, MakeWindow({ 1., 29. }));
+}
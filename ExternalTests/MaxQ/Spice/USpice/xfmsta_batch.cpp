@@ -0,0 +1,153 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+#include "pch.h"
+#include "MaxQTestDefinitions.h"
+#include "SpiceMathBatch.h"
+
+using namespace MaxQ::Math;
+
+static const double re_earth = 6378.1366;
+static const double f_earth = (6378.1366 - 6356.7519) / 6378.1366;
+
+static const auto AllSystems = {
+    ES_CoordinateSystem::RECTANGULAR,
+    ES_CoordinateSystem::CYLINDRICAL,
+    ES_CoordinateSystem::LATITUDINAL,
+    ES_CoordinateSystem::SPHERICAL,
+    ES_CoordinateSystem::GEODETIC,
+    ES_CoordinateSystem::PLANETOGRAPHIC
+};
+
+// LEO to GEO states, off the z axis
+static void TestStates(TArray<double> (&s)[6])
+{
+    FRandomStream Random(1234);
+    for (int32 i = 0; i < 500; ++i)
+    {
+        const FVector3d u = FVector3d(Random.GetUnitVector());
+        const FVector3d w = FVector3d(Random.GetUnitVector());
+        const double r = Random.FRandRange(6600., 42200.);
+        const double speed = Random.FRandRange(0.1, 8.);
+        s[0].Add(r * u.X); s[1].Add(r * u.Y); s[2].Add(r * u.Z);
+        s[3].Add(speed * w.X); s[4].Add(speed * w.Y); s[5].Add(speed * w.Z);
+    }
+}
+
+static void ExpectNearState(const double (&actual)[6], const double (&expected)[6], int32 i)
+{
+    for (int32 j = 0; j < 6; ++j)
+    {
+        EXPECT_NEAR(actual[j], expected[j], 1e-9 * FMath::Max(1., FMath::Abs(expected[j]))) << "state " << i << " component " << j;
+    }
+}
+
+TEST(xfmsta_batch_test, Matches_xfmsta) {
+
+    USpice::init_all();
+
+    TArray<double> rect[6];
+    TestStates(rect);
+    const int32 Num = rect[0].Num();
+
+    bool bPositiveWest = true;
+    EXPECT_TRUE(PlanetographicSense(TEXT("EARTH"), bPositiveWest));
+
+    for (ES_CoordinateSystem input : AllSystems)
+    {
+        // The test states, in the input system
+        TArray<double> in[6];
+        for (TArray<double>& c : in) c.SetNum(Num);
+        ASSERT_TRUE(Xfmsta(FConstVectorBatch(rect[0], rect[1], rect[2]), FConstVectorBatch(rect[3], rect[4], rect[5]),
+            ES_CoordinateSystem::RECTANGULAR, input, FVectorBatch{ in[0], in[1], in[2] }, FVectorBatch{ in[3], in[4], in[5] },
+            re_earth, f_earth, bPositiveWest));
+
+        for (ES_CoordinateSystem output : AllSystems)
+        {
+            TArray<double> out[6];
+            for (TArray<double>& c : out) c.SetNum(Num);
+            ASSERT_TRUE(Xfmsta(FConstVectorBatch(in[0], in[1], in[2]), FConstVectorBatch(in[3], in[4], in[5]),
+                input, output, FVectorBatch{ out[0], out[1], out[2] }, FVectorBatch{ out[3], out[4], out[5] },
+                re_earth, f_earth, bPositiveWest));
+
+            for (int32 i = 0; i < Num; i += 13)
+            {
+                const double state[6] = { in[0][i], in[1][i], in[2][i], in[3][i], in[4][i], in[5][i] };
+                ES_ResultCode ResultCode;
+                FString ErrorMessage;
+                FSDimensionlessStateVector expected;
+                USpice::xfmsta(ResultCode, ErrorMessage, FSDimensionlessStateVector(state), expected, input, output, TEXT("EARTH"));
+                ASSERT_EQ(ResultCode, ES_ResultCode::Success);
+
+                double _expected[6];
+                expected.CopyTo(_expected);
+                const double actual[6] = { out[0][i], out[1][i], out[2][i], out[3][i], out[4][i], out[5][i] };
+                ExpectNearState(actual, _expected, i);
+            }
+        }
+    }
+
+    // Systems that need the body, without it
+    TArray<double> out[6];
+    for (TArray<double>& c : out) c.SetNum(Num);
+    EXPECT_FALSE(Xfmsta(FConstVectorBatch(rect[0], rect[1], rect[2]), FConstVectorBatch(rect[3], rect[4], rect[5]),
+        ES_CoordinateSystem::RECTANGULAR, ES_CoordinateSystem::GEODETIC, FVectorBatch{ out[0], out[1], out[2] }, FVectorBatch{ out[3], out[4], out[5] }));
+}
+
+TEST(xfmsta_batch_test, Axis_And_InPlace) {
+
+    // On the z axis:  no longitude or latitude rates, where xfmsta would
+    // signal an error
+    TArray<double> s[6] = { { 0. }, { 0. }, { 7000. }, { 1. }, { 2. }, { 3. } };
+    ASSERT_TRUE(Xfmsta(FConstVectorBatch(s[0], s[1], s[2]), FConstVectorBatch(s[3], s[4], s[5]),
+        ES_CoordinateSystem::RECTANGULAR, ES_CoordinateSystem::LATITUDINAL, FVectorBatch{ s[0], s[1], s[2] }, FVectorBatch{ s[3], s[4], s[5] }));
+
+    EXPECT_DOUBLE_EQ(s[0][0], 7000.);
+    EXPECT_DOUBLE_EQ(s[2][0], UE_DOUBLE_HALF_PI);
+    EXPECT_DOUBLE_EQ(s[3][0], 3.);
+    EXPECT_EQ(s[4][0], 0.);
+    EXPECT_EQ(s[5][0], 0.);
+}
+
+TEST(xfmsta_batch_test, Streamed_Matches_Buffered) {
+
+    USpice::init_all();
+
+    // More than one streamed chunk
+    TArray<double> rect[6];
+    for (int32 i = 0; i < 150; ++i)
+    {
+        TestStates(rect);
+    }
+    const int32 Num = rect[0].Num();
+    const FConstVectorBatch r(rect[0], rect[1], rect[2]), v(rect[3], rect[4], rect[5]);
+
+    TArray<double> out[6];
+    for (TArray<double>& c : out) c.SetNum(Num);
+    ASSERT_TRUE(Xfmsta(r, v, ES_CoordinateSystem::RECTANGULAR, ES_CoordinateSystem::PLANETOGRAPHIC,
+        FVectorBatch{ out[0], out[1], out[2] }, FVectorBatch{ out[3], out[4], out[5] }, re_earth, f_earth, true));
+
+    int32 Expected = 0;
+    int32 Chunks = 0;
+    ASSERT_TRUE(Xfmsta(r, v, ES_CoordinateSystem::RECTANGULAR, ES_CoordinateSystem::PLANETOGRAPHIC,
+        [&](int32 First, const FConstVectorBatch& cr, const FConstVectorBatch& cv)
+        {
+            EXPECT_EQ(First, Expected);
+            for (int32 i = 0; i < cr.Num(); ++i)
+            {
+                EXPECT_EQ(cr.X[i], out[0][First + i]);
+                EXPECT_EQ(cr.Z[i], out[2][First + i]);
+                EXPECT_EQ(cv.X[i], out[3][First + i]);
+                EXPECT_EQ(cv.Z[i], out[5][First + i]);
+            }
+            Expected += cr.Num();
+            ++Chunks;
+        }, re_earth, f_earth, true));
+
+    EXPECT_EQ(Expected, Num);
+    EXPECT_GT(Chunks, 1);
+}
@@ -115,3 +115,18 @@ TEST(FSRotationMatrixTest, Assignment_Is_Correct) {
 }
 
 
+
+
+TEST(FSRotationMatrixTest, AsSpiceDoubleArray_Is_InPlace) {
+
+    FSRotationMatrix m(FSDimensionlessVector(1.1, 2.2, 3.3), FSDimensionlessVector(4.4, 5.5, 6.6), FSDimensionlessVector(7.7, 8.8, 9.9));
+
+    double(&_m)[3][3] = m.AsSpiceDoubleArray();
+
+    EXPECT_DOUBLE_EQ(_m[0][0], 1.1);
+    EXPECT_DOUBLE_EQ(_m[1][2], 6.6);
+    EXPECT_DOUBLE_EQ(_m[2][1], 8.8);
+
+    _m[2][0] = -1.;
+    EXPECT_DOUBLE_EQ(m.m[2].x, -1.);
+}
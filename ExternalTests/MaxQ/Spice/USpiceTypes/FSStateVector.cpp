@@ -277,3 +277,35 @@ TEST(FSStateVectorTest, OneMinusEqualsTwo_Is_NegativeOne) {
     EXPECT_DOUBLE_EQ(stateVector1.v.dy.kmps, 1.4 - 2.3);
     EXPECT_DOUBLE_EQ(stateVector1.v.dz.kmps, -1.2 - -2.2);
 }
+
+
+TEST(FSStateVectorTest, AsSpiceDoubleArray_Is_InPlace) {
+
+    FSStateVector stateVector(FSDistanceVector(1.2, -2.3, 3.4), FSVelocityVector(4.5, 5.6, -6.7));
+
+    double(&state)[6] = stateVector.AsSpiceDoubleArray();
+
+    EXPECT_EQ((void*)state, (void*)&stateVector);
+    EXPECT_DOUBLE_EQ(state[0], 1.2);
+    EXPECT_DOUBLE_EQ(state[5], -6.7);
+
+    state[3] = 9.;
+    EXPECT_DOUBLE_EQ(stateVector.v.dx.kmps, 9.);
+}
+
+
+TEST(FSStateVectorTest, ViewAs_SpiceDoubleBuffer) {
+
+    double states[2][6] = { { 1., 2., 3., 4., 5., 6. }, { 7., 8., 9., 10., 11., 12. } };
+
+    TArrayView<FSStateVector> view = MaxQ::Core::ViewAs<FSStateVector>(MakeArrayView(&states[0][0], 12));
+
+    EXPECT_EQ(view.Num(), 2);
+    EXPECT_DOUBLE_EQ(view[0].v.dz.kmps, 6.);
+    EXPECT_DOUBLE_EQ(view[1].r.x.km, 7.);
+    EXPECT_DOUBLE_EQ(view[1].v.dx.kmps, 10.);
+
+    TArrayView<double> doubles = MaxQ::Core::AsSpiceDoubles(view);
+    EXPECT_EQ(doubles.Num(), 12);
+    EXPECT_EQ(doubles.GetData(), &states[0][0]);
+}
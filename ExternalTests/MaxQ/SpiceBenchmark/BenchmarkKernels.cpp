@@ -0,0 +1,41 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+
+const FString BenchmarkTarget = TEXT("FAKEBODY9994");
+const FString BenchmarkObserver = TEXT("FAKEBODY9995");
+const char* BenchmarkTargetAnsi = "FAKEBODY9994";
+const char* BenchmarkObserverAnsi = "FAKEBODY9995";
+
+const FString BenchmarkFrom = TEXT("J2000");
+const FString BenchmarkTo = TEXT("ECLIPJ2000");
+const char* BenchmarkFromAnsi = "J2000";
+const char* BenchmarkToAnsi = "ECLIPJ2000";
+
+void LoadBenchmarkKernels()
+{
+    static const bool bLoaded = []()
+    {
+        USpice::init_all();
+        USpice::furnsh_absolute("maxq_unit_test_meta.tm");
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        USpice::get_implied_result(ResultCode, ErrorMessage);
+        check(ResultCode == ES_ResultCode::Success);
+
+        erract_c("SET", 0, (SpiceChar*)"RETURN");
+        errprt_c("SET", 0, (SpiceChar*)"NONE");
+        furnsh_c("maxq_unit_test_meta.tm");
+        check(!failed_c());
+
+        return true;
+    }();
+    (void)bLoaded;
+}
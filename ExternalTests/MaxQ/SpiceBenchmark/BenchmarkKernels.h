@@ -0,0 +1,36 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#pragma once
+
+#include "MaxQTestDefinitions.h"
+
+// Each benchmark comes in two flavors:
+// * USpice_*:  the MaxQ wrapper, as a Blueprint or game code would call it.
+// * cspice_*:  the bare *_c call, for a baseline.
+// The difference between the two is the wrapper's cost.
+//
+// UnrealEditor-Spice.dll links CSPICE statically, and so does this
+// executable (for the baselines).  So there are two copies of CSPICE, each
+// with its own kernel pool.  LoadBenchmarkKernels furnishes both.
+
+// Loads the unit test kernels (once), into both copies of CSPICE
+void LoadBenchmarkKernels();
+
+// et0 (MaxQTestDefinitions.h) is inside the unit test SPK's coverage
+
+// Bodies in the unit test SPK:  9993 orbits 9994, which orbits 9995
+extern const FString BenchmarkTarget;
+extern const FString BenchmarkObserver;
+extern const char* BenchmarkTargetAnsi;
+extern const char* BenchmarkObserverAnsi;
+
+// Built-in inertial frames, so frame lookups don't depend on a kernel
+extern const FString BenchmarkFrom;
+extern const FString BenchmarkTo;
+extern const char* BenchmarkFromAnsi;
+extern const char* BenchmarkToAnsi;
@@ -0,0 +1,49 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+
+// A low earth orbit:  rp, ecc, inc, lnode, argp, m0, t0, mu
+static double Elts[8] = { 6778., 0.001, 0.9, 0.3, 1.2, 0.1, 0., 398600.435436 };
+
+static void USpice_conics(benchmark::State& State)
+{
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    const FSConicElements Elements(FSDistance(Elts[0]), Elts[1], FSAngle(Elts[2]), FSAngle(Elts[3]), FSAngle(Elts[4]), FSAngle(Elts[5]), FSEphemerisTime(Elts[6]), FSMassConstant(Elts[7]));
+    FSStateVector StateVector;
+    int64 i = 0;
+
+    for (auto _ : State)
+    {
+        FSEphemerisTime et = FSEphemerisTime(60. * (i++ & 1023));
+        USpice::conics(ResultCode, ErrorMessage, Elements, et, StateVector);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("conics failed");
+}
+BENCHMARK(USpice_conics);
+
+static void cspice_conics(benchmark::State& State)
+{
+    SpiceDouble StateVector[6];
+    int64 i = 0;
+
+    for (auto _ : State)
+    {
+        SpiceDouble et = 60. * (i++ & 1023);
+        conics_c(Elts, et, StateVector);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("conics_c failed"); }
+}
+BENCHMARK(cspice_conics);
@@ -0,0 +1,67 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+
+// WGS-72, as evsgp4_c's examples use
+static double Geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+
+static SpiceChar Lines[2][70] =
+{
+    "1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999",
+    "2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544"
+};
+
+static void USpice_evsgp4(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSEphemerisTime Epoch;
+    FSTwoLineElements Elems;
+    USpice::getelm(ResultCode, ErrorMessage, Epoch, Elems, Lines[0], Lines[1]);
+
+    const FSTLEGeophysicalConstants Constants(Geophs);
+    FSStateVector StateVector;
+    int64 i = 0;
+
+    for (auto _ : State)
+    {
+        FSEphemerisTime et = Epoch + FSEphemerisPeriod(60. * (i++ & 1023));
+        USpice::evsgp4(ResultCode, ErrorMessage, StateVector, et, Constants, Elems);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("evsgp4 failed");
+}
+BENCHMARK(USpice_evsgp4);
+
+static void cspice_evsgp4(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    SpiceDouble Epoch;
+    SpiceDouble Elems[10];
+    getelm_c(1957, 70, Lines, &Epoch, Elems);
+
+    SpiceDouble StateVector[6];
+    int64 i = 0;
+
+    for (auto _ : State)
+    {
+        SpiceDouble et = Epoch + 60. * (i++ & 1023);
+        evsgp4_c(et, Geophs, Elems, StateVector);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("evsgp4_c failed"); }
+}
+BENCHMARK(cspice_evsgp4);
@@ -0,0 +1,56 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+
+// Local maxima of 9994's distance from 9995, over ten days in one hour steps
+static const double Span = 10. * spd_c();
+static const double Step = 3600.;
+
+static void USpice_gfdist(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    TArray<FSEphemerisTimeWindowSegment> cnfine;
+    cnfine.Add(FSEphemerisTimeWindowSegment(et0, et0 + FSEphemerisPeriod(Span)));
+    TArray<FSEphemerisTimeWindowSegment> results;
+
+    for (auto _ : State)
+    {
+        USpice::gfdist(ResultCode, ErrorMessage, results, cnfine, FSEphemerisPeriod(Step), FSDistance(0.), FSDistance(0.), BenchmarkTarget, ES_AberrationCorrectionWithTransmissions::None, BenchmarkObserver, ES_RelationalOperator::LOCMAX);
+        benchmark::DoNotOptimize(results);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("gfdist failed");
+}
+BENCHMARK(USpice_gfdist)->Unit(benchmark::kMillisecond);
+
+static void cspice_gfdist(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    SPICEDOUBLE_CELL(cnfine, 2);
+    SPICEDOUBLE_CELL(result, 2 * 1024);
+    wninsd_c(et0.seconds, et0.seconds + Span, &cnfine);
+
+    const SpiceInt nintvls = (SpiceInt)(Span / Step) + 4;
+
+    for (auto _ : State)
+    {
+        scard_c(0, &result);
+        gfdist_c(BenchmarkTargetAnsi, "NONE", BenchmarkObserverAnsi, "LOCMAX", 0., 0., Step, nintvls, &cnfine, &result);
+        benchmark::DoNotOptimize(result);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("gfdist_c failed"); }
+}
+BENCHMARK(cspice_gfdist)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,45 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+
+static void USpice_pxform(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSRotationMatrix Rotation;
+
+    for (auto _ : State)
+    {
+        USpice::pxform(ResultCode, ErrorMessage, Rotation, et0, BenchmarkFrom, BenchmarkTo);
+        benchmark::DoNotOptimize(Rotation);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("pxform failed");
+}
+BENCHMARK(USpice_pxform);
+
+static void cspice_pxform(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    SpiceDouble Rotation[3][3];
+
+    for (auto _ : State)
+    {
+        pxform_c(BenchmarkFromAnsi, BenchmarkToAnsi, et0.seconds, Rotation);
+        benchmark::DoNotOptimize(Rotation);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("pxform_c failed"); }
+}
+BENCHMARK(cspice_pxform);
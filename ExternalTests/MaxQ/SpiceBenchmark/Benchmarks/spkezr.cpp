@@ -0,0 +1,129 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+
+static void USpice_spkezr(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSStateVector StateVector;
+    FSEphemerisPeriod lt;
+
+    for (auto _ : State)
+    {
+        USpice::spkezr(ResultCode, ErrorMessage, et0, StateVector, lt, BenchmarkTarget, BenchmarkObserver, BenchmarkTo, ES_AberrationCorrectionWithNewtonians::None);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("spkezr failed");
+}
+BENCHMARK(USpice_spkezr);
+
+static void USpice_spkezr_lt(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSStateVector StateVector;
+    FSEphemerisPeriod lt;
+
+    for (auto _ : State)
+    {
+        USpice::spkezr(ResultCode, ErrorMessage, et0, StateVector, lt, BenchmarkTarget, BenchmarkObserver, BenchmarkTo, ES_AberrationCorrectionWithNewtonians::LT_S);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("spkezr failed");
+}
+BENCHMARK(USpice_spkezr_lt);
+
+static void cspice_spkezr(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    SpiceDouble StateVector[6];
+    SpiceDouble lt;
+
+    for (auto _ : State)
+    {
+        spkezr_c(BenchmarkTargetAnsi, et0.seconds, BenchmarkToAnsi, "NONE", BenchmarkObserverAnsi, StateVector, &lt);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("spkezr_c failed"); }
+}
+BENCHMARK(cspice_spkezr);
+
+static void cspice_spkezr_lt(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    SpiceDouble StateVector[6];
+    SpiceDouble lt;
+
+    for (auto _ : State)
+    {
+        spkezr_c(BenchmarkTargetAnsi, et0.seconds, BenchmarkToAnsi, "LT+S", BenchmarkObserverAnsi, StateVector, &lt);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("spkezr_c failed"); }
+}
+BENCHMARK(cspice_spkezr_lt);
+
+// Walks the epoch across the coverage, so segment lookups don't all hit
+// the same cached record
+static void USpice_spkezr_sweep(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSStateVector StateVector;
+    FSEphemerisPeriod lt;
+    int64 i = 0;
+
+    for (auto _ : State)
+    {
+        FSEphemerisTime et = et0 + FSEphemerisPeriod(60. * (i++ & 1023));
+        USpice::spkezr(ResultCode, ErrorMessage, et, StateVector, lt, BenchmarkTarget, BenchmarkObserver, BenchmarkTo, ES_AberrationCorrectionWithNewtonians::None);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("spkezr failed");
+}
+BENCHMARK(USpice_spkezr_sweep);
+
+static void cspice_spkezr_sweep(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    SpiceDouble StateVector[6];
+    SpiceDouble lt;
+    int64 i = 0;
+
+    for (auto _ : State)
+    {
+        SpiceDouble et = et0.seconds + 60. * (i++ & 1023);
+        spkezr_c(BenchmarkTargetAnsi, et, BenchmarkToAnsi, "NONE", BenchmarkObserverAnsi, StateVector, &lt);
+        benchmark::DoNotOptimize(StateVector);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("spkezr_c failed"); }
+}
+BENCHMARK(cspice_spkezr_sweep);
@@ -0,0 +1,47 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+
+static void USpice_spkpos(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSDistanceVector Position;
+    FSEphemerisPeriod lt;
+
+    for (auto _ : State)
+    {
+        USpice::spkpos(ResultCode, ErrorMessage, et0, Position, lt, BenchmarkTarget, BenchmarkObserver, BenchmarkTo, ES_AberrationCorrectionWithNewtonians::None);
+        benchmark::DoNotOptimize(Position);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("spkpos failed");
+}
+BENCHMARK(USpice_spkpos);
+
+static void cspice_spkpos(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    SpiceDouble Position[3];
+    SpiceDouble lt;
+
+    for (auto _ : State)
+    {
+        spkpos_c(BenchmarkTargetAnsi, et0.seconds, BenchmarkToAnsi, "NONE", BenchmarkObserverAnsi, Position, &lt);
+        benchmark::DoNotOptimize(Position);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("spkpos_c failed"); }
+}
+BENCHMARK(cspice_spkpos);
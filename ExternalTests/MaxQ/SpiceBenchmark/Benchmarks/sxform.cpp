@@ -0,0 +1,45 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+
+static void USpice_sxform(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    FSStateTransform Transform;
+
+    for (auto _ : State)
+    {
+        USpice::sxform(ResultCode, ErrorMessage, Transform, et0, BenchmarkFrom, BenchmarkTo);
+        benchmark::DoNotOptimize(Transform);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (ResultCode != ES_ResultCode::Success) State.SkipWithError("sxform failed");
+}
+BENCHMARK(USpice_sxform);
+
+static void cspice_sxform(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    SpiceDouble Transform[6][6];
+
+    for (auto _ : State)
+    {
+        sxform_c(BenchmarkFromAnsi, BenchmarkToAnsi, et0.seconds, Transform);
+        benchmark::DoNotOptimize(Transform);
+    }
+
+    State.SetItemsProcessed(State.iterations());
+    if (failed_c()) { reset_c(); State.SkipWithError("sxform_c failed"); }
+}
+BENCHMARK(cspice_sxform);
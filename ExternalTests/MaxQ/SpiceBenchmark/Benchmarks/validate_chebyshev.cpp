@@ -0,0 +1,105 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+#include "Validation.h"
+#include "SpiceEphemerisCache.h"
+
+// FChebyshevCache vs spkezr_c, over four days of both unit test bodies.
+// The argument is the cache's tolerance, in meters.
+
+static const char* Bodies[] = { "FAKEBODY9993", "FAKEBODY9994" };
+static constexpr int NumBodies = sizeof(Bodies) / sizeof(Bodies[0]);
+static constexpr int NumEpochs = 2000;
+static const double Span = 4. * spd_c();
+
+static double Epoch(int i)
+{
+    // Off the fit nodes (mostly), which is where the error is
+    return et0.seconds + Span * (i + 0.37) / NumEpochs;
+}
+
+static void Validate_ChebyshevCache(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    MaxQ::Ephemeris::FChebyshevCacheSettings Settings;
+    Settings.ToleranceKm = State.range(0) / 1000.;
+
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    MaxQ::Ephemeris::FChebyshevCache Cache;
+    if (!Cache.Build({ FString(Bodies[0]), FString(Bodies[1]) }, BenchmarkObserver, BenchmarkTo, et0, et0 + FSEphemerisPeriod(Span), Settings, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage))
+    {
+        State.SkipWithError("FChebyshevCache::Build failed");
+        return;
+    }
+
+    int32 BodyIndex[NumBodies];
+    for (int b = 0; b < NumBodies; ++b)
+    {
+        BodyIndex[b] = Cache.FindBody(FString(Bodies[b]));
+    }
+
+    FValidationStats Stats;
+    for (int b = 0; b < NumBodies; ++b)
+    {
+        for (int i = 0; i < NumEpochs; ++i)
+        {
+            double Canonical[6], lt;
+            spkezr_c(Bodies[b], Epoch(i), BenchmarkToAnsi, "NONE", BenchmarkObserverAnsi, Canonical, &lt);
+
+            double r[3], v[3];
+            if (!Cache.Evaluate(BodyIndex[b], Epoch(i), r, v) || failed_c())
+            {
+                reset_c();
+                Stats.AddMismatch();
+                continue;
+            }
+
+            Stats.AddPosition(r, *reinterpret_cast<double(*)[3]>(&Canonical[0]));
+            Stats.AddVelocity(v, *reinterpret_cast<double(*)[3]>(&Canonical[3]));
+        }
+    }
+
+    auto CanonicalSweep = [&]()
+    {
+        double Canonical[6], lt;
+        for (int b = 0; b < NumBodies; ++b)
+        {
+            for (int i = 0; i < NumEpochs; ++i)
+            {
+                spkezr_c(Bodies[b], Epoch(i), BenchmarkToAnsi, "NONE", BenchmarkObserverAnsi, Canonical, &lt);
+                benchmark::DoNotOptimize(Canonical);
+            }
+        }
+    };
+
+    auto FastSweep = [&]()
+    {
+        double r[3], v[3];
+        for (int b = 0; b < NumBodies; ++b)
+        {
+            for (int i = 0; i < NumEpochs; ++i)
+            {
+                Cache.Evaluate(BodyIndex[b], Epoch(i), r, v);
+                benchmark::DoNotOptimize(r);
+                benchmark::DoNotOptimize(v);
+            }
+        }
+    };
+
+    for (auto _ : State)
+    {
+        FastSweep();
+    }
+
+    State.SetItemsProcessed(State.iterations() * NumBodies * NumEpochs);
+    Stats.Report(State, TimeSweep(CanonicalSweep), TimeSweep(FastSweep));
+}
+BENCHMARK(Validate_ChebyshevCache)->ArgName("tol_m")->Arg(1)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
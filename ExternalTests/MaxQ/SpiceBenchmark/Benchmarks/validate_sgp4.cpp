@@ -0,0 +1,130 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "BenchmarkKernels.h"
+#include "Validation.h"
+#include "SpiceSGP4.h"
+
+// FSGP4Propagator vs evsgp4_c, over a week either side of each element
+// set's epoch:  near earth, and deep space (Molniya, GPS, geosynchronous).
+
+static SpiceChar Lines[][2][70] =
+{
+    {
+        "1 43908U 18111AJ  20146.60805006  .00000806  00000-0  34965-4 0  9999",
+        "2 43908  97.2676  47.2136 0020001 220.6050 139.3698 15.24999521 78544"
+    },
+    {
+        "1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813",
+        "2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656"
+    },
+    {
+        "1 28129U 03058A   06175.57071136 -.00000104  00000-0  10000-3 0   459",
+        "2 28129  54.7298 324.8098 0048506 266.2640  93.1663  2.00562768 18443"
+    },
+    {
+        "1 28626U 05008A   06176.46683397 -.00000205  00000-0  10000-3 0  2190",
+        "2 28626   0.0019 286.9433 0000335  13.7918  55.6504  1.00271328  1861"
+    }
+};
+static constexpr int NumElements = sizeof(Lines) / sizeof(Lines[0]);
+static constexpr int NumEpochs = 2000;
+
+// WGS-72
+static double Geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+
+static double Epoch(double ElementEpoch, int i)
+{
+    return ElementEpoch + 7. * spd_c() * (2. * i / NumEpochs - 1.);
+}
+
+static void Validate_SGP4(benchmark::State& State)
+{
+    LoadBenchmarkKernels();
+
+    double Epochs[NumElements];
+    double Elems[NumElements][10];
+    TArray<MaxQ::Orbits::FSGP4Propagator> Propagators;
+
+    for (int e = 0; e < NumElements; ++e)
+    {
+        getelm_c(1957, 70, Lines[e], &Epochs[e], Elems[e]);
+
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+        Propagators.Emplace(FSTLEGeophysicalConstants(Geophs), FSTwoLineElements(Elems[e]), &ResultCode, &ErrorMessage);
+    }
+
+    if (failed_c())
+    {
+        reset_c();
+        State.SkipWithError("getelm_c failed");
+        return;
+    }
+
+    FValidationStats Stats;
+    for (int e = 0; e < NumElements; ++e)
+    {
+        for (int i = 0; i < NumEpochs; ++i)
+        {
+            double Canonical[6];
+            evsgp4_c(Epoch(Epochs[e], i), Geophs, Elems[e], Canonical);
+            const bool bCanonical = !failed_c();
+            reset_c();
+
+            double Fast[6];
+            const bool bFast = Propagators[e].Propagate(Epoch(Epochs[e], i), Fast) == MaxQ::Orbits::ESGP4Status::Ok;
+
+            if (bCanonical != bFast)
+            {
+                Stats.AddMismatch();
+            }
+            else if (bFast)
+            {
+                Stats.AddPosition(*reinterpret_cast<double(*)[3]>(&Fast[0]), *reinterpret_cast<double(*)[3]>(&Canonical[0]));
+                Stats.AddVelocity(*reinterpret_cast<double(*)[3]>(&Fast[3]), *reinterpret_cast<double(*)[3]>(&Canonical[3]));
+            }
+        }
+    }
+
+    auto CanonicalSweep = [&]()
+    {
+        double Canonical[6];
+        for (int e = 0; e < NumElements; ++e)
+        {
+            for (int i = 0; i < NumEpochs; ++i)
+            {
+                evsgp4_c(Epoch(Epochs[e], i), Geophs, Elems[e], Canonical);
+                benchmark::DoNotOptimize(Canonical);
+            }
+        }
+        reset_c();
+    };
+
+    auto FastSweep = [&]()
+    {
+        double Fast[6];
+        for (int e = 0; e < NumElements; ++e)
+        {
+            for (int i = 0; i < NumEpochs; ++i)
+            {
+                benchmark::DoNotOptimize(Propagators[e].Propagate(Epoch(Epochs[e], i), Fast));
+                benchmark::DoNotOptimize(Fast);
+            }
+        }
+    };
+
+    for (auto _ : State)
+    {
+        FastSweep();
+    }
+
+    State.SetItemsProcessed(State.iterations() * NumElements * NumEpochs);
+    Stats.Report(State, TimeSweep(CanonicalSweep), TimeSweep(FastSweep));
+}
+BENCHMARK(Validate_SGP4)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,104 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "Validation.h"
+#include "SpiceMathBatch.h"
+
+#include <random>
+
+// MaxQ::Math::Surfpt vs surfpt_c, for rays from around a triaxial ellipsoid
+// (Earth-ish, made triaxial) aimed near its center.  About half the rays
+// hit.  The argument is the number of rays per batch.
+
+static const double a = 6378.137, b = 6370.0, c = 6356.752;
+
+static void Validate_Surfpt(benchmark::State& State)
+{
+    const int32 Num = (int32)State.range(0);
+
+    TArray<double> PX, PY, PZ, UX, UY, UZ;
+    for (TArray<double>* Component : { &PX, &PY, &PZ, &UX, &UY, &UZ })
+    {
+        Component->SetNumUninitialized(Num);
+    }
+
+    std::mt19937 Random(42);
+    std::uniform_real_distribution<double> Unit(-1., 1.);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        // From 1.1 to 10 radii out, toward a point within ~1.4 radii of center
+        double p[3] = { Unit(Random), Unit(Random), Unit(Random) };
+        const double Scale = a * (1.1 + 4.45 * (Unit(Random) + 1.)) / vnorm_c(p);
+        PX[i] = p[0] * Scale; PY[i] = p[1] * Scale; PZ[i] = p[2] * Scale;
+
+        UX[i] = a * 0.8 * Unit(Random) - PX[i];
+        UY[i] = a * 0.8 * Unit(Random) - PY[i];
+        UZ[i] = a * 0.8 * Unit(Random) - PZ[i];
+    }
+
+    TArray<double> X, Y, Z;
+    X.SetNumUninitialized(Num);
+    Y.SetNumUninitialized(Num);
+    Z.SetNumUninitialized(Num);
+    TArray<uint8> Found;
+    Found.SetNumUninitialized(Num);
+
+    const MaxQ::Math::FConstVectorBatch positn(PX, PY, PZ);
+    const MaxQ::Math::FConstVectorBatch u(UX, UY, UZ);
+    const MaxQ::Math::FVectorBatch point{ X, Y, Z };
+
+    MaxQ::Math::Surfpt(positn, u, a, b, c, point, Found);
+
+    FValidationStats Stats;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        double p[3] = { PX[i], PY[i], PZ[i] };
+        double d[3] = { UX[i], UY[i], UZ[i] };
+        double Canonical[3];
+        SpiceBoolean bFound;
+        surfpt_c(p, d, a, b, c, Canonical, &bFound);
+
+        if ((bFound != SPICEFALSE) != (Found[i] != 0))
+        {
+            Stats.AddMismatch();
+        }
+        else if (bFound)
+        {
+            double Fast[3] = { X[i], Y[i], Z[i] };
+            Stats.AddPosition(Fast, Canonical);
+        }
+    }
+
+    auto CanonicalSweep = [&]()
+    {
+        for (int32 i = 0; i < Num; ++i)
+        {
+            double p[3] = { PX[i], PY[i], PZ[i] };
+            double d[3] = { UX[i], UY[i], UZ[i] };
+            double Canonical[3];
+            SpiceBoolean bFound;
+            surfpt_c(p, d, a, b, c, Canonical, &bFound);
+            benchmark::DoNotOptimize(Canonical);
+        }
+    };
+
+    auto FastSweep = [&]()
+    {
+        MaxQ::Math::Surfpt(positn, u, a, b, c, point, Found);
+        benchmark::ClobberMemory();
+    };
+
+    for (auto _ : State)
+    {
+        FastSweep();
+    }
+
+    State.SetItemsProcessed(State.iterations() * Num);
+    Stats.Report(State, TimeSweep(CanonicalSweep), TimeSweep(FastSweep));
+}
+BENCHMARK(Validate_Surfpt)->ArgName("rays")->Arg(256)->Arg(64 * 1024)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,48 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+#include "Validation.h"
+
+#include <cmath>
+
+static double Distance(const double (&a)[3], const double (&b)[3])
+{
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+void FValidationStats::AddPosition(const double (&Fast)[3], const double (&Canonical)[3])
+{
+    const double Error = Distance(Fast, Canonical);
+    MaxR = Error > MaxR ? Error : MaxR;
+    SumR2 += Error * Error;
+    ++NumR;
+}
+
+void FValidationStats::AddVelocity(const double (&Fast)[3], const double (&Canonical)[3])
+{
+    const double Error = Distance(Fast, Canonical);
+    MaxV = Error > MaxV ? Error : MaxV;
+    SumV2 += Error * Error;
+    ++NumV;
+}
+
+void FValidationStats::Report(benchmark::State& State, double CanonicalSeconds, double FastSeconds) const
+{
+    State.counters["max_r_err"] = MaxR;
+    State.counters["rms_r_err"] = NumR ? std::sqrt(SumR2 / NumR) : 0.;
+    if (NumV)
+    {
+        State.counters["max_v_err"] = MaxV;
+        State.counters["rms_v_err"] = std::sqrt(SumV2 / NumV);
+    }
+    State.counters["mismatches"] = (double)Mismatches;
+    State.counters["speedup"] = FastSeconds > 0. ? CanonicalSeconds / FastSeconds : 0.;
+}
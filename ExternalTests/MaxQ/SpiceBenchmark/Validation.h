@@ -0,0 +1,51 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#pragma once
+
+#include <chrono>
+
+// Accuracy vs speed, for the fast paths (Chebyshev cache, native SGP4,
+// batched ellipsoid math).
+//
+// A Validate_* benchmark sweeps epochs/bodies/rays, and compares each fast
+// path result to the canonical CSPICE call.  Its time is the fast path's
+// sweep, and it reports (as counters, so they land in the JSON too):
+// * max_r_err, rms_r_err:  position error (km)
+// * max_v_err, rms_v_err:  velocity error (km/s), where there is one
+// * speedup:  canonical sweep time / fast path sweep time
+// * mismatches:  samples where one side found a result and the other didn't
+
+struct FValidationStats
+{
+    void AddPosition(const double (&Fast)[3], const double (&Canonical)[3]);
+    void AddVelocity(const double (&Fast)[3], const double (&Canonical)[3]);
+    void AddMismatch() { ++Mismatches; }
+
+    void Report(benchmark::State& State, double CanonicalSeconds, double FastSeconds) const;
+
+    double MaxR = 0., SumR2 = 0.;
+    double MaxV = 0., SumV2 = 0.;
+    int64 NumR = 0, NumV = 0;
+    int64 Mismatches = 0;
+};
+
+// Best of Repeats runs of Sweep, in seconds.  (Best of, so a context switch
+// doesn't skew the speedup.)
+template<class SweepType>
+double TimeSweep(SweepType&& Sweep, int Repeats = 5)
+{
+    double Best = 0.;
+    for (int i = 0; i < Repeats; ++i)
+    {
+        auto Start = std::chrono::steady_clock::now();
+        Sweep();
+        double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+        Best = (i == 0 || Seconds < Best) ? Seconds : Best;
+    }
+    return Best;
+}
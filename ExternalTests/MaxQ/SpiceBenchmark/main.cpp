@@ -0,0 +1,46 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "pch.h"
+
+#include <string>
+#include <vector>
+
+// Same as BENCHMARK_MAIN, except results are also written as JSON (to
+// SpiceBenchmark.json) unless --benchmark_out says otherwise.  Compare two
+// runs with Google Benchmark's tools/compare.py.
+int main(int argc, char** argv)
+{
+    std::vector<char*> args(argv, argv + argc);
+
+    bool bHasOut = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        bHasOut |= std::string(argv[i]).rfind("--benchmark_out=", 0) == 0;
+    }
+
+    static char DefaultOut[] = "--benchmark_out=SpiceBenchmark.json";
+    static char DefaultFormat[] = "--benchmark_out_format=json";
+    if (!bHasOut)
+    {
+        args.push_back(DefaultOut);
+        args.push_back(DefaultFormat);
+    }
+
+    int Argc = (int)args.size();
+    benchmark::Initialize(&Argc, args.data());
+    if (benchmark::ReportUnrecognizedArguments(Argc, args.data()))
+    {
+        return 1;
+    }
+
+    benchmark::AddCustomContext("kernels", "maxq_unit_test_meta.tm");
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -46,7 +46,7 @@ void UGetTelemetryFromServer_AsyncExecution::Activate()
     // https://celestrak.com/NORAD/elements/gp.php?GROUP=STATIONS&FORMAT=TLE
     // https://celestrak.com/NORAD/elements/gp.php?NAME=MICROSAT-R&FORMAT=JSON
     // https://celestrak.com/NORAD/elements/gp.php?INTDES=2020-025&FORMAT=JSON-PRETTY
-    FString uriQuery = FString::Printf(TEXT(CELESTRAK_URL_BASE "/NORAD/elements/gp.php?%s&FORMAT%s"), *ObjectIdArg, *FormatArg);
+    FString uriQuery = FString::Printf(TEXT(CELESTRAK_URL_BASE "/NORAD/elements/gp.php?%s&FORMAT=%s"), *ObjectIdArg, *FormatArg);
 
     // Requires inclusion of Http module.
     // (MaxQCppSamples.Build.cs: PrivateDependencyModuleNames.Add("HTTP");)
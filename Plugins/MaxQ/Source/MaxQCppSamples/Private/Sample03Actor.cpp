@@ -561,10 +561,10 @@ void ASample03Actor::UpdateSolarSystem(FSamplesSolarSystemState& State, float De
     SolarSystemState.CurrentTime += DeltaTime * SolarSystemState.TimeScale;
 
     // Intermediate outputs:
-    // r: sun's position relative to earth
-    // lt: the light travel time from sun to earth
-    FSDistanceVector r;
-    FSEphemerisPeriod lt;
+    // r: each body's position relative to the origin
+    // lt: the light travel time from each body to the origin
+    TArray<FSDistanceVector> r;
+    TArray<FSEphemerisPeriod> lt;
 
     ES_ResultCode ResultCode;
     FString ErrorMessage;
@@ -584,45 +584,50 @@ void ASample03Actor::UpdateSolarSystem(FSamplesSolarSystemState& State, float De
     // the light arriving here now left the sun.  'lt' time ago.
     ES_AberrationCorrectionWithNewtonians abscorr = ES_AberrationCorrectionWithNewtonians::CN;
 
+    // Targ = NaifName = Map Key
+    TArray<FString> targs;
+    TArray<AActor*> Actors;
     for (const auto& [BodyNaifName, BodyActor] : SolarSystemState.SolarSystemBodyMap)
     {
-        AActor* Actor = BodyActor.Get();
+        if (AActor* Actor = BodyActor.Get())
+        {
+            targs.Add(BodyNaifName.ToString());
+            Actors.Add(Actor);
+        }
+    }
+
+    // Call SPICE once for every body, get the positions in rectangular coordinates...
+    // (The observer's state is the same for every body, so spkpos_multi only computes it once.)
+    USpice::spkpos_multi(ResultCode, ErrorMessage, et, targs, r, lt, obs, ref, abscorr);
 
-        if (Actor)
+    if (ResultCode == ES_ResultCode::Success)
+    {
+        for (int32 i = 0; i < Actors.Num(); ++i)
         {
-            // Targ = NaifName = Map Key
-            FString targ = BodyNaifName.ToString();
+            // IMPORTANT NOTE:
+            // Positional data (vectors, quaternions, should only be exchanged through USpiceTypes::Swizzle*
+            // SPICE coordinate systems are Right-Handed, and Unreal Engine is Left-Handed.
+            // The USpiceTypes conversions understand this, and how to convert.
+            FVector BodyLocation = r[i].Swizzle();
 
-            // Call SPICE, get the position in rectangular coordinates...
-            USpice::spkpos(ResultCode, ErrorMessage, et, r, lt, targ, obs, ref, abscorr);
+            // Scale and set the body location
+            BodyLocation /= DistanceScale;
+            Actors[i]->SetActorLocation(BodyLocation);
 
-            if (ResultCode == ES_ResultCode::Success)
-            {
-                // IMPORTANT NOTE:
-                // Positional data (vectors, quaternions, should only be exchanged through USpiceTypes::Swizzle*
-                // SPICE coordinate systems are Right-Handed, and Unreal Engine is Left-Handed.
-                // The USpiceTypes conversions understand this, and how to convert.
-                FVector BodyLocation = r.Swizzle();
-
-                // Scale and set the body location
-                BodyLocation /= DistanceScale;
-                Actor->SetActorLocation(BodyLocation);
-
-                if (GEngine)
-                {
-                    GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("%s r=: %s kilometers"), *targ, *r.Magnitude().ToString()));
-                }
-            }
-            else
+            if (GEngine)
             {
-                // If the call failed, there's insufficient SPK data for this time, so reset the clock.
-                Restart();
-
-                // Slow the timescale down each time it repeats...
-                SlowerSpeed();
+                GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("%s r=: %s kilometers"), *targs[i], *r[i].Magnitude().ToString()));
             }
         }
     }
+    else
+    {
+        // If the call failed, there's insufficient SPK data for this time, so reset the clock.
+        Restart();
+
+        // Slow the timescale down each time it repeats...
+        SlowerSpeed();
+    }
 
     if (GEngine)
     {
@@ -630,7 +635,8 @@ void ASample03Actor::UpdateSolarSystem(FSamplesSolarSystemState& State, float De
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale SUN : 1/%s (1/100 of PLANET/MOON scale)"), *USpiceTypes::FormatDoublePrecisely(BodyScale * UE_Units_Per_KM * 100, 0)));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale PLANETS/MOON : 1/%s"), *USpiceTypes::FormatDoublePrecisely(BodyScale * UE_Units_Per_KM, 0)));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Scale Solar System Distances : 1/%s"), *USpiceTypes::FormatDoublePrecisely(DistanceScale * UE_Units_Per_KM, 0)));
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *SolarSystemState.CurrentTime.ToString()));
+        SolarSystemState.DisplayClock.Update(SolarSystemState.CurrentTime.AsSpiceDouble());
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s UTC"), SolarSystemState.DisplayClock.GetText()));
     }
 }
 
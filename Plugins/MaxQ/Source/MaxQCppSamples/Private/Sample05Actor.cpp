@@ -11,7 +11,8 @@
 #include "SampleUtilities.h"
 #include "Sample05TelemetryActor.h"
 #include "SpiceOrbits.h"
-#include "GetTelemetryFromServer.h"
+#include "SpiceTLECatalog.h"
+#include "TelemetryFetcher.h"
 
 using MaxQSamples::Log;
 using namespace MaxQ::Data;
@@ -93,14 +94,16 @@ void ASample05Actor::Tick(float DeltaSeconds)
     SolarSystemState.CurrentTime += DeltaSeconds * SolarSystemState.TimeScale;
 
     bool success = true;
-    success &= MaxQSamples::UpdateBodyPositions(OriginNaifName, OriginReferenceFrame, DistanceScale, SolarSystemState);
-    success &= MaxQSamples::UpdateBodyOrientations(OriginReferenceFrame, SolarSystemState);
+    success &= MaxQSamples::UpdateBodyPoses(OriginNaifName, OriginReferenceFrame, DistanceScale, SolarSystemState);
     success &= MaxQSamples::UpdateSunDirection(OriginNaifName, OriginReferenceFrame, SolarSystemState.CurrentTime, SunNaifName, SunDirectionalLight);
 
+    PropagateCatalog();
+
     if (GEngine)
     {
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Time Scale: %f x"), SolarSystemState.TimeScale.AsSeconds()));
-        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s"), *SolarSystemState.CurrentTime.ToString()));
+        SolarSystemState.DisplayClock.Update(SolarSystemState.CurrentTime.AsSpiceDouble());
+        GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Display Time: %s UTC"), SolarSystemState.DisplayClock.GetText()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Origin Reference Frame: %s"), *OriginReferenceFrame.ToString()));
         GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::White, *FString::Printf(TEXT("Origin Observer Naif Name: %s"), *OriginNaifName.ToString()));
     }
@@ -327,16 +330,14 @@ void ASample05Actor::RequestTelemetryByHttp()
 {
     Log(TEXT("RequestTelemetryByHttp sending telemetry request to server by http"));
 
-    // Uses the Http module to send request by http
-    UGetTelemetryFromServer_AsyncExecution* Request = UGetTelemetryFromServer_AsyncExecution::IssueTelemetryRequest(GetWorld(), TelemetryObjectId, TEXT("TLE"));
-    if (ensure(IsValid(Request)))
+    // One request per group query (not per object), cached on disk between
+    // runs, and parsed off the game thread.
+    if (!TelemetryFetcher.IsValid())
     {
-        Request->OnSuccess.AddDynamic(this, &ASample05Actor::ProcessTelemetryResponseAsTLE);
-        Request->OnError.AddDynamic(this, &ASample05Actor::ProcessTelemetryResponseError);
+        TelemetryFetcher = MakeShared<MaxQSamples::FTelemetryFetcher>();
     }
 
-    // Now that the delegates are bound the request can be triggered.
-    Request->Activate();
+    TelemetryFetcher->Fetch({ TelemetryObjectId }, MaxQSamples::FOnTelemetryFetched::CreateUObject(this, &ASample05Actor::ProcessTelemetryCatalog));
 }
 
 
@@ -354,41 +355,53 @@ void ASample05Actor::ProcessTelemetryResponseAsTLE(const FString& ObjectId, cons
     Log(TEXT("ProcessTelemetryResponseAsTLE Telemetry response received from server"));
     Log(FString::Printf(TEXT("ProcessTelemetryResponseAsTLE Telemetry : %s"), *(Telemetry.Left(750) + TEXT("..."))), FColor::Green, 15.f);
 
-    TArray<FString> TLEArray;
-    if (0 == (Telemetry.ParseIntoArrayLines(TLEArray, true) % 3))
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    // ParseTLECatalog parses the whole response in one go (in parallel), and
+    // skips any element sets that don't parse.
+    FSTLECatalog TLECatalog;
+    MaxQ::Orbits::ParseTLECatalog(Telemetry, TLECatalog, MaxQ::Orbits::ETLECatalogFormat::TLE, 1957, &ResultCode, &ErrorMessage);
+
+    if (ResultCode != ES_ResultCode::Success)
     {
-        ES_ResultCode ResultCode;
-        FString ErrorMessage;
+        Log(FString::Printf(TEXT("ProcessTelemetryResponse ParseTLECatalog Spice Error %s"), *ErrorMessage), ResultCode);
+    }
 
-        FSEphemerisTime et;
-        FSTwoLineElements elems;
+    ProcessTelemetryCatalog(TLECatalog, FString());
+}
 
-        for (int i = 0; i < TLEArray.Num(); i += 3)
-        {
-            // 'getelm' parses TLE strings into a useable form.  So, process the strings
-            // from the server.
-            USpice::getelm(ResultCode, ErrorMessage, et, elems, TLEArray[i + 1], TLEArray[i + 2]);
 
-            // If the object's TLEs parsed successfully, create an actor for it.
-            if (ResultCode == ES_ResultCode::Success)
-            {
-                AddTelemetryObject(ObjectId, TLEArray[i + 0].TrimStartAndEnd(), elems);
-            }
-            else
-            {
-                Log(FString::Printf(TEXT("ProcessTelemetryResponse getelem Spice Error %s"), *ErrorMessage), ResultCode);
-            }
+// ============================================================================
+//
+//-----------------------------------------------------------------------------
+// Name: ProcessTelemetryCatalog
+// Desc: Create an actor for each object in a parsed response
+//-----------------------------------------------------------------------------
 
-            // Dump a few object names to the log.
-            if (i < 10)
-            {
-                Log(FString::Printf(TEXT("** Please also see %s in Scene 'In Orbit' folder for button controls (details panel) **"), *(TLEArray[i].TrimStartAndEnd())), FColor::Orange);
-            }
-        }
+void ASample05Actor::ProcessTelemetryCatalog(const FSTLECatalog& TLECatalog, const FString& Error)
+{
+    if (!Error.IsEmpty())
+    {
+        Log(FString::Printf(TEXT("ProcessTelemetryCatalog telemetry error: %s"), *Error), FColor::Red);
     }
-    else
+
+    if (TLECatalog.IsEmpty())
     {
-        Log(TEXT("ProcessTelemetryResponseAsTLE TLE Response is nonsense (expected 3 lines including obj name line)"), FColor::Red);
+        Log(TEXT("ProcessTelemetryCatalog TLE Response is nonsense (no element sets found)"), FColor::Red);
+        return;
+    }
+
+    for (int i = 0; i < TLECatalog.Num(); ++i)
+    {
+        // If the object's TLEs parsed successfully, create an actor for it.
+        AddTelemetryObject(TLECatalog.ObjectIds[i], TLECatalog.ObjectNames[i], TLECatalog.GetElements(i));
+
+        // Dump a few object names to the log.
+        if (i < 4)
+        {
+            Log(FString::Printf(TEXT("** Please also see %s in Scene 'In Orbit' folder for button controls (details panel) **"), *TLECatalog.ObjectNames[i]), FColor::Orange);
+        }
     }
 }
 
@@ -437,7 +450,7 @@ void ASample05Actor::AddTelemetryObject(const FString& ObjectId, const FString&
             // There's several ways this could have been done, obviously.
             // Is this the best?
             // Hey, there's no right or wrong solutions, only solutions optimized to different criteria.
-            TelemetryObject->PropagateByTLEs.BindUObject(this, &ASample05Actor::PropagateTLE);
+            TelemetryObject->PropagateByTLEs.BindUObject(this, &ASample05Actor::PropagateSGP4);
             TelemetryObject->XformPositionCallback.BindUObject(this, &ASample05Actor::TransformPosition);
 
             TelemetryObject->ComputeConic.BindUObject(this, &ASample05Actor::ComputeConic);
@@ -449,7 +462,17 @@ void ASample05Actor::AddTelemetryObject(const FString& ObjectId, const FString&
             // By default only render debug orbits for ISS-related objects
             bool bShouldRenderOrbit = ObjectName.StartsWith(TEXT("ISS"));
 
-            TelemetryObject->Init(ObjectId, ObjectName, Elements, bShouldRenderOrbit);
+            TelemetryObject->Init(ObjectId, ObjectName, Elements, EarthConstants, bShouldRenderOrbit);
+
+            if (bPropagateAsCatalog)
+            {
+                // We'll propagate it, so make sure we tick first.
+                TelemetryObject->bPropagatedByCatalog = true;
+                TelemetryObject->AddTickPrerequisiteActor(this);
+                TelemetryObjects.Add(TelemetryObject);
+                Catalog.Add(TelemetryObject->GetPropagator());
+                bBatchCatalogDirty = true;
+            }
         }
     }
 }
@@ -475,6 +498,64 @@ bool ASample05Actor::PropagateTLE(const FSTwoLineElements& TLEs, FSStateVector&
 }
 
 
+// ============================================================================
+//
+//-----------------------------------------------------------------------------
+// Name: PropagateSGP4
+// Desc:
+// Same as PropagateTLE, but the SGP4 model was already initialized from the
+// TLEs.  With thousands of objects in the sky, this is much cheaper than
+// evsgp4, which re-initializes the model on every call.
+//-----------------------------------------------------------------------------
+
+bool ASample05Actor::PropagateSGP4(const MaxQ::Orbits::FSGP4Propagator& Propagator, FSStateVector& StateVector)
+{
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+
+    Propagator.Propagate(SolarSystemState.CurrentTime, StateVector, &ResultCode, &ErrorMessage);
+
+    return ResultCode == ES_ResultCode::Success;
+}
+
+
+// ============================================================================
+//
+//-----------------------------------------------------------------------------
+// Name: PropagateCatalog
+// Desc:
+// Propagate every TLE object at once, across all cores, then place the
+// actors.  This is what scales to tens of thousands of objects.
+//-----------------------------------------------------------------------------
+
+void ASample05Actor::PropagateCatalog()
+{
+    if (Catalog.Num() == 0)
+    {
+        return;
+    }
+
+    if (bBatchCatalogDirty)
+    {
+        BatchCatalog.Build(Catalog);
+        bBatchCatalogDirty = false;
+    }
+
+    BatchCatalog.Propagate(SolarSystemState.CurrentTime, CatalogStates);
+
+    for (int32 i = 0; i < TelemetryObjects.Num(); ++i)
+    {
+        ASample05TelemetryActor* TelemetryObject = TelemetryObjects[i].Get();
+
+        // Objects that went Keplerian propagate themselves
+        if (TelemetryObject && TelemetryObject->IsPropagatingByTLEs() && CatalogStates.Status[i] == MaxQ::Orbits::ESGP4Status::Ok)
+        {
+            TelemetryObject->SetTLEPosition(CatalogStates.Position(i));
+        }
+    }
+}
+
+
 // ============================================================================
 //
 //-----------------------------------------------------------------------------
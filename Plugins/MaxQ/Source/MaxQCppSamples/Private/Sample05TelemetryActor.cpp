@@ -46,11 +46,20 @@ void ASample05TelemetryActor::BeginPlay()
 // Name: Init
 // Desc: Initialize this object with data (it's name, etc.)
 //-----------------------------------------------------------------------------
-void ASample05TelemetryActor::Init(const FString& NewObjectId, const FString& NewObjectName, const FSTwoLineElements& NewTLEs, bool bNewShouldRenderOrbit)
+void ASample05TelemetryActor::Init(const FString& NewObjectId, const FString& NewObjectName, const FSTwoLineElements& NewTLEs, const FSTLEGeophysicalConstants& NewGeophysicalConstants, bool bNewShouldRenderOrbit)
 {
     ObjectId = NewObjectId;
     ObjectName = NewObjectName;
     TLElements = NewTLEs;
+    GeophysicalConstants = NewGeophysicalConstants;
+
+    // Run the SGP4 initialization once, up front.
+    ES_ResultCode ResultCode;
+    FString ErrorMessage;
+    if (!Propagator.Init(GeophysicalConstants, TLElements, &ResultCode, &ErrorMessage))
+    {
+        UE_LOG(LogMaxQSamples, Warning, TEXT("ASample05TelemetryActor::Init %s SGP4 init failed: %s"), *ObjectName, *ErrorMessage);
+    }
     bShouldRenderOrbit = false;
 
     // Create the Nametag UI-widget.
@@ -78,7 +87,7 @@ void ASample05TelemetryActor::Init(const FString& NewObjectId, const FString& Ne
             
             // Compute the shape of the orbit (conic: ellipse or hyperbola)
             // This will be used to render the orbit if desired.
-            if (PropagateByTLEs.Execute(TLElements, StateVector))
+            if (PropagateByTLEs.Execute(Propagator, StateVector))
             {
                 if (ComputeConic.Execute(StateVector, OrbitalConic, bIsHyperbolic))
                 {
@@ -99,7 +108,10 @@ void ASample05TelemetryActor::Tick(float DeltaSeconds)
     // Which mode are we in?  Propagate accordingly
     if (PropagateStateByTLEs)
     {
-        PropagateTLE();
+        if (!bPropagatedByCatalog)
+        {
+            PropagateTLE();
+        }
     }
     else
     {
@@ -156,22 +168,32 @@ void ASample05TelemetryActor::PropagateTLE()
     if (PropagateByTLEs.IsBound() && XformPositionCallback.IsBound())
     {
         FSStateVector StateVector;
-        bool bResult = PropagateByTLEs.Execute(TLElements, StateVector);
-
-        // We got an orbital state vector (location etc)
-        // So transform it to a UE position and place the actor.
-        FVector UEScenegraphVector;
-        bResult &= XformPositionCallback.Execute(StateVector.r, UEScenegraphVector);
-
-        if (bResult)
+        if (PropagateByTLEs.Execute(Propagator, StateVector))
         {
-            SetActorLocation(UEScenegraphVector);
-            PositionUpdate.ExecuteIfBound(UEScenegraphVector);
+            SetTLEPosition(StateVector.r);
         }
     }
 }
 
 
+//-----------------------------------------------------------------------------
+// Name: SetTLEPosition
+// Desc:
+// We got an orbital position (by TLE, from here or from the catalog)
+// So transform it to a UE position and place the actor.
+//-----------------------------------------------------------------------------
+
+void ASample05TelemetryActor::SetTLEPosition(const FSDistanceVector& r)
+{
+    FVector UEScenegraphVector;
+    if (XformPositionCallback.IsBound() && XformPositionCallback.Execute(r, UEScenegraphVector))
+    {
+        SetActorLocation(UEScenegraphVector);
+        PositionUpdate.ExecuteIfBound(UEScenegraphVector);
+    }
+}
+
+
 // ============================================================================
 //
 //-----------------------------------------------------------------------------
@@ -216,7 +238,7 @@ void ASample05TelemetryActor::GoKeplerian()
     if (PropagateStateByTLEs && PropagateByTLEs.IsBound())
     {
         FSStateVector StateVector;
-        bool bResult = PropagateByTLEs.Execute(TLElements, StateVector);
+        bool bResult = PropagateByTLEs.Execute(Propagator, StateVector);
 
         if (bResult)
         {
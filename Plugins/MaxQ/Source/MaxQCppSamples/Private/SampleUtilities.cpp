@@ -10,6 +10,7 @@
 #include "Interfaces/IHttpRequest.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Spice.h"
+#include "SpiceEphemeris.h"
 
 #if WITH_EDITOR
 #include "Interfaces/IPluginManager.h"
@@ -293,6 +294,46 @@ namespace MaxQSamples
     }
 
 
+    //-----------------------------------------------------------------------------
+    // Name: UpdateBodyPoses
+    // Desc:
+    // Positions and orientations of the solar system bodies, together.
+    // One pass over the bodies:  the observer's state is looked up once, and
+    // each body gets its location and rotation in one SetActorTransform.
+    //-----------------------------------------------------------------------------
+    bool UpdateBodyPoses(const FName& OriginNaifName, const FName& OriginReferenceFrame, float DistanceScale, const FSamplesSolarSystemState& SolarSystemState)
+    {
+        ES_ResultCode ResultCode;
+        FString ErrorMessage;
+
+        // Only the bodies with actors
+        TArray<AActor*> Actors;
+        TArray<FString> Targets;
+        TArray<FString> BodyFrames;
+        for (const auto& [BodyNaifName, BodyActor] : SolarSystemState.SolarSystemBodyMap)
+        {
+            if (AActor* Actor = BodyActor.Get())
+            {
+                Actors.Add(Actor);
+                Targets.Add(BodyNaifName.ToString());
+                BodyFrames.Add(TEXT("IAU_") + Targets.Last());
+            }
+        }
+
+        TArray<FTransform> Poses;
+        Poses.SetNum(Actors.Num());
+        const int32 NumPoses = MaxQ::Ephemeris::BodyPoses(SolarSystemState.CurrentTime, Targets, BodyFrames, Poses, OriginNaifName.ToString(), OriginReferenceFrame.ToString(), DistanceScale, ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+
+        for (int32 i = 0; i < NumPoses; ++i)
+        {
+            // Keep the scale InitBodyScales gave it
+            Actors[i]->SetActorLocationAndRotation(Poses[i].GetLocation(), Poses[i].GetRotation());
+        }
+
+        return ResultCode == ES_ResultCode::Success;
+    }
+
+
     //-----------------------------------------------------------------------------
     // Name: UpdateSunDirection
     // Desc:
@@ -0,0 +1,287 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#include "TelemetryFetcher.h"
+#include "Async/Async.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "SpiceExecutor.h"
+#include "SpiceTLECatalog.h"
+#include "SampleUtilities.h"
+
+// telemetry will use the celestrak server.
+#define CELESTRAK_URL_BASE "https://celestrak.com"
+
+
+namespace MaxQSamples
+{
+    struct FTelemetryFetcher::FBatch
+    {
+        TArray<FString> Queries;
+        TArray<FSTLECatalog> Catalogs;
+        TArray<FString> Errors;
+        int32 Remaining = 0;
+        FOnTelemetryFetched OnFetched;
+    };
+
+
+    FTelemetryFetcher::FTelemetryFetcher(const FString& _CacheDirectory, int32 _MaxConcurrentRequests)
+        : CacheDirectory(_CacheDirectory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MaxQ"), TEXT("Telemetry")) : _CacheDirectory)
+        , MaxConcurrentRequests(FMath::Max(_MaxConcurrentRequests, 1))
+    {
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: Fetch
+    // Desc:
+    // Responses that are fresh enough come straight from the cache, the rest
+    // are queued for the server.
+    //-----------------------------------------------------------------------------
+    void FTelemetryFetcher::Fetch(const TArray<FString>& Queries, FOnTelemetryFetched OnFetched)
+    {
+        check(IsInGameThread());
+
+        if (Queries.Num() == 0)
+        {
+            OnFetched.ExecuteIfBound(FSTLECatalog(), FString());
+            return;
+        }
+
+        TSharedRef<FBatch> Batch = MakeShared<FBatch>();
+        Batch->Queries = Queries;
+        Batch->Catalogs.SetNum(Queries.Num());
+        Batch->Errors.SetNum(Queries.Num());
+        Batch->Remaining = Queries.Num();
+        Batch->OnFetched = MoveTemp(OnFetched);
+
+        for (int32 Query = 0; Query < Queries.Num(); ++Query)
+        {
+            FCacheMetadata Metadata;
+            if (ReadMetadata(Queries[Query], Metadata) && FDateTime::UtcNow() - Metadata.Fetched < MinRefreshInterval)
+            {
+                Parse(Batch, Query, FString(), FString(), TOptional<FCacheMetadata>());
+            }
+            else
+            {
+                Pending.Add(TPair<TSharedRef<FBatch>, int32>(Batch, Query));
+            }
+        }
+
+        StartRequests();
+    }
+
+
+    void FTelemetryFetcher::StartRequests()
+    {
+        while (InFlight < MaxConcurrentRequests && Pending.Num() > 0)
+        {
+            TPair<TSharedRef<FBatch>, int32> Next = Pending[0];
+            Pending.RemoveAt(0);
+
+            ++InFlight;
+            Request(Next.Key, Next.Value);
+        }
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: Request
+    // Desc:
+    // A conditional GET, if we have a cached copy to validate.
+    //-----------------------------------------------------------------------------
+    void FTelemetryFetcher::Request(const TSharedRef<FBatch>& Batch, int32 Query)
+    {
+        const FString& QueryString = Batch->Queries[Query];
+        FString uriQuery = FString::Printf(TEXT(CELESTRAK_URL_BASE "/NORAD/elements/gp.php?%s&FORMAT=JSON"), *QueryString);
+
+        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> pRequest = FHttpModule::Get().CreateRequest();
+        pRequest->SetVerb(TEXT("GET"));
+        pRequest->SetURL(uriQuery);
+
+        FCacheMetadata Cached;
+        if (ReadMetadata(QueryString, Cached))
+        {
+            if (!Cached.ETag.IsEmpty()) pRequest->SetHeader(TEXT("If-None-Match"), Cached.ETag);
+            if (!Cached.LastModified.IsEmpty()) pRequest->SetHeader(TEXT("If-Modified-Since"), Cached.LastModified);
+        }
+
+        // The fetcher stays alive until its callbacks are done
+        pRequest->OnProcessRequestComplete().BindLambda(
+            [This = AsShared(), Batch, Query, Cached](FHttpRequestPtr, FHttpResponsePtr pResponse, bool connectedSuccessfully) mutable
+            {
+                check(IsInGameThread());
+
+                --This->InFlight;
+                This->StartRequests();
+
+                const int32 ResponseCode = connectedSuccessfully && pResponse.IsValid() ? pResponse->GetResponseCode() : 0;
+
+                if (ResponseCode == EHttpResponseCodes::Ok)
+                {
+                    FCacheMetadata Metadata;
+                    Metadata.ETag = pResponse->GetHeader(TEXT("ETag"));
+                    Metadata.LastModified = pResponse->GetHeader(TEXT("Last-Modified"));
+                    Metadata.Fetched = FDateTime::UtcNow();
+                    This->Parse(Batch, Query, pResponse->GetContentAsString(), FString(), TOptional<FCacheMetadata>(MoveTemp(Metadata)));
+                }
+                else if (ResponseCode == EHttpResponseCodes::NotModified)
+                {
+                    Cached.Fetched = FDateTime::UtcNow();
+                    This->Parse(Batch, Query, FString(), FString(), TOptional<FCacheMetadata>(MoveTemp(Cached)));
+                }
+                else
+                {
+                    const FString Error = ResponseCode != 0
+                        ? FString::Printf(TEXT("%s: HTTP %d"), *Batch->Queries[Query], ResponseCode)
+                        : FString::Printf(TEXT("%s: request failed"), *Batch->Queries[Query]);
+                    This->Parse(Batch, Query, FString(), Error, TOptional<FCacheMetadata>());
+                }
+            });
+
+        UE_LOG(LogMaxQSamples, Log, TEXT("FTelemetryFetcher request: %s"), *uriQuery);
+
+        pRequest->ProcessRequest();
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: Parse
+    // Desc:
+    // Off the game thread:  the cache file I/O, and the parse.  ParseTLECatalog
+    // converts epochs with CSPICE, so this runs on the SPICE executor thread.
+    //-----------------------------------------------------------------------------
+    void FTelemetryFetcher::Parse(const TSharedRef<FBatch>& Batch, int32 Query, FString&& Body, const FString& Error, TOptional<FCacheMetadata>&& Metadata)
+    {
+        const FString Path = CachePath(Batch->Queries[Query]);
+
+        FSpiceExecutor::Get().EnqueueCommand(
+            [This = AsShared(), Batch, Query, Path, Body = MoveTemp(Body), Error, Metadata = MoveTemp(Metadata)]() mutable
+            {
+                FString ParseError = Error;
+
+                if (Body.IsEmpty())
+                {
+                    if (FFileHelper::LoadFileToString(Body, *Path))
+                    {
+                        if (!ParseError.IsEmpty())
+                        {
+                            UE_LOG(LogMaxQSamples, Warning, TEXT("FTelemetryFetcher %s;  using the cached response"), *ParseError);
+                            ParseError.Empty();
+                        }
+                    }
+                    else if (ParseError.IsEmpty())
+                    {
+                        ParseError = FString::Printf(TEXT("%s: the cached response is missing"), *Batch->Queries[Query]);
+                    }
+                }
+                else
+                {
+                    FFileHelper::SaveStringToFile(Body, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+                }
+
+                if (Metadata.IsSet())
+                {
+                    TArray<FString> Lines { Metadata->ETag, Metadata->LastModified, Metadata->Fetched.ToIso8601() };
+                    FFileHelper::SaveStringArrayToFile(Lines, *(Path + TEXT(".meta")));
+                }
+
+                FSTLECatalog Catalog;
+                if (!Body.IsEmpty())
+                {
+                    ES_ResultCode ResultCode = ES_ResultCode::Success;
+                    FString ErrorMessage;
+                    MaxQ::Orbits::ParseTLECatalog(Body, Catalog, MaxQ::Orbits::ETLECatalogFormat::Auto, 1957, &ResultCode, &ErrorMessage);
+
+                    if (Catalog.IsEmpty() && ParseError.IsEmpty())
+                    {
+                        ParseError = FString::Printf(TEXT("%s: no element sets (%s)"), *Batch->Queries[Query], *ErrorMessage);
+                    }
+                }
+
+                AsyncTask(ENamedThreads::GameThread, [This, Batch, Query, Catalog = MoveTemp(Catalog), ParseError]() mutable
+                {
+                    This->Parsed(Batch, Query, MoveTemp(Catalog), ParseError);
+                });
+            });
+    }
+
+
+    //-----------------------------------------------------------------------------
+    // Name: Parsed
+    // Desc:
+    // Once every query is in, merge them (in query order).
+    //-----------------------------------------------------------------------------
+    void FTelemetryFetcher::Parsed(const TSharedRef<FBatch>& Batch, int32 Query, FSTLECatalog&& Catalog, const FString& Error)
+    {
+        check(IsInGameThread());
+
+        Batch->Catalogs[Query] = MoveTemp(Catalog);
+        Batch->Errors[Query] = Error;
+
+        if (--Batch->Remaining > 0)
+        {
+            return;
+        }
+
+        FSTLECatalog Merged;
+        FString FirstError;
+        TSet<FString> Seen;
+        for (int32 i = 0; i < Batch->Catalogs.Num(); ++i)
+        {
+            const FSTLECatalog& Response = Batch->Catalogs[i];
+            Merged.Reserve(Merged.Num() + Response.Num());
+            for (int32 Object = 0; Object < Response.Num(); ++Object)
+            {
+                bool bAlreadyInSet = false;
+                Seen.Add(Response.ObjectIds[Object], &bAlreadyInSet);
+                if (!bAlreadyInSet)
+                {
+                    double Elements[10];
+                    Response.CopyTo(Object, Elements);
+                    Merged.Add(Response.ObjectIds[Object], Response.ObjectNames[Object], Elements);
+                }
+            }
+
+            if (FirstError.IsEmpty())
+            {
+                FirstError = Batch->Errors[i];
+            }
+        }
+
+        UE_LOG(LogMaxQSamples, Log, TEXT("FTelemetryFetcher fetched %d objects from %d queries"), Merged.Num(), Batch->Queries.Num());
+        Batch->OnFetched.ExecuteIfBound(Merged, FirstError);
+    }
+
+
+    FString FTelemetryFetcher::CachePath(const FString& Query) const
+    {
+        return FPaths::Combine(CacheDirectory, FPaths::MakeValidFileName(Query, TCHAR('_')) + TEXT(".json"));
+    }
+
+
+    bool FTelemetryFetcher::ReadMetadata(const FString& Query, FCacheMetadata& Metadata) const
+    {
+        const FString Path = CachePath(Query);
+
+        TArray<FString> Lines;
+        if (!FPaths::FileExists(Path) || !FFileHelper::LoadFileToStringArray(Lines, *(Path + TEXT(".meta"))) || Lines.Num() < 3)
+        {
+            return false;
+        }
+
+        Metadata.ETag = Lines[0];
+        Metadata.LastModified = Lines[1];
+        return FDateTime::ParseIso8601(*Lines[2], Metadata.Fetched);
+    }
+}
+
+
+#undef CELESTRAK_URL_BASE
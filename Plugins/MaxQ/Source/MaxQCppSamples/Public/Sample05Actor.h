@@ -9,6 +9,7 @@
 
 #include "CoreMinimal.h"
 #include "SampleUtilities.h"
+#include "SpiceSGP4Batch.h"
 #include "Sample05Actor.generated.h"
 
 
@@ -49,6 +50,7 @@
 
 
 class ASample05TelemetryActor;
+namespace MaxQSamples { class FTelemetryFetcher; }
 
 UCLASS(Blueprintable, HideCategories = (Transform, Rendering, Replication, Collision, HLOD, Input, Actor, Advanced, Cooking))
 class MAXQCPPSAMPLES_API ASample05Actor : public AActor
@@ -91,12 +93,29 @@ public:
     UPROPERTY(EditInstanceOnly, Transient, Category = "MaxQ|Samples")
     FSMassConstant gm;
 
+    // Propagate all TLE objects in one parallel pass, instead of each
+    // telemetry actor propagating itself on the game thread.
+    UPROPERTY(EditAnywhere, Category = "MaxQ|Samples")
+    bool bPropagateAsCatalog = true;
+
+    // Catalog[i] is TelemetryObjects[i]'s propagator
+    TArray<TWeakObjectPtr<ASample05TelemetryActor>> TelemetryObjects;
+    TArray<MaxQ::Orbits::FSGP4Propagator> Catalog;
+
+    // Catalog, in SIMD lanes (rebuilt when objects are added)
+    MaxQ::Orbits::FSGP4BatchPropagator BatchCatalog;
+    bool bBatchCatalogDirty = false;
+    MaxQ::Orbits::FSGP4CatalogStates CatalogStates;
+
+    TSharedPtr<MaxQSamples::FTelemetryFetcher> TelemetryFetcher;
+
 public:
     ASample05Actor();
 
     void BeginPlay() override;
     void Tick(float DeltaSeconds) override;
     void InitAnimation();
+    void PropagateCatalog();
 
 
     // This is what you came for...
@@ -111,11 +130,14 @@ private:
     UFUNCTION()
     void ProcessTelemetryResponseError(const FString& ObjectId, const FString& Telemetry);
 
+    void ProcessTelemetryCatalog(const FSTLECatalog& TLECatalog, const FString& Error);
+
     void AddTelemetryObject(const FString& ObjectId, const FString& ObjectName, const FSTwoLineElements& Elements);
 
     // This is what you came for...
     UFUNCTION(BlueprintCallable, Category = "MaxQ|Samples")
     bool PropagateTLE(const FSTwoLineElements& TLEs, FSStateVector& StateVector);
+    bool PropagateSGP4(const MaxQ::Orbits::FSGP4Propagator& Propagator, FSStateVector& StateVector);
 
     UFUNCTION(BlueprintCallable, Category = "MaxQ|Samples")
     bool TransformPosition(const FSDistanceVector& RHSPosition, FVector& UEVector);
@@ -53,6 +53,9 @@ public:
     UPROPERTY(EditInstanceOnly, Transient, Category = "MaxQ|Samples")
     FSTLEGeophysicalConstants GeophysicalConstants;
 
+    // Initialized once from the TLEs, instead of on every evsgp4 call
+    MaxQ::Orbits::FSGP4Propagator Propagator;
+
     UPROPERTY(EditInstanceOnly, Transient, Category = "MaxQ|Samples")
     bool PropagateStateByTLEs = true;
 
@@ -83,11 +86,18 @@ public:
     ASample05TelemetryActor();
 
     void BeginPlay() override;
-    void Init(const FString& NewObjectId, const FString& NewObjectName, const FSTwoLineElements& NewTLEs, bool bNewShouldRenderOrbit);
+    void Init(const FString& NewObjectId, const FString& NewObjectName, const FSTwoLineElements& NewTLEs, const FSTLEGeophysicalConstants& NewGeophysicalConstants, bool bNewShouldRenderOrbit);
     void Tick(float DeltaSeconds) override;
     void PropagateTLE();
     void PropagateKepler();
 
+    // The owning actor may propagate all TLE objects at once instead
+    // (see ASample05Actor::PropagateCatalog).
+    bool bPropagatedByCatalog = false;
+    bool IsPropagatingByTLEs() const { return PropagateStateByTLEs; }
+    const MaxQ::Orbits::FSGP4Propagator& GetPropagator() const { return Propagator; }
+    void SetTLEPosition(const FSDistanceVector& r);
+
     void GoKeplerian();
     void BumpVelocity(const FSVelocityVector& Direction);
 
@@ -9,6 +9,8 @@
 
 #include "CoreMinimal.h"
 #include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+#include "SpiceTime.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Kismet/BlueprintAsyncActionBase.h"
 #include "UObject/WeakObjectPtrTemplates.h"
@@ -48,6 +50,9 @@ struct MAXQCPPSAMPLES_API FSamplesSolarSystemState
     UPROPERTY(EditInstanceOnly, Category = "MaxQ|Samples")
     TMap<FName, TWeakObjectPtr<AActor> > SolarSystemBodyMap;
 
+    // Formats CurrentTime for the on-screen display
+    MaxQ::Time::FUtcClock DisplayClock;
+
     FSamplesSolarSystemState()
     {
         InitializeTimeToNow = true;
@@ -69,7 +74,7 @@ DECLARE_DYNAMIC_DELEGATE_OneParam(FPositionUpdate, const FVector&, Position);
 DECLARE_DYNAMIC_DELEGATE_OneParam(FVisibilityUpdate, bool, bIsVisible);
 DECLARE_DELEGATE_RetVal_ThreeParams(bool, FComputeConic, const FSStateVector&, FSEllipse&, bool&);
 DECLARE_DELEGATE_FourParams(FRenderDebugOrbit, const FSEllipse&, bool, const FColor&, float);
-DECLARE_DELEGATE_RetVal_TwoParams(bool, FTLEGetStateVectorCallback, const FSTwoLineElements&, FSStateVector&);
+DECLARE_DELEGATE_RetVal_TwoParams(bool, FTLEGetStateVectorCallback, const MaxQ::Orbits::FSGP4Propagator&, FSStateVector&);
 DECLARE_DELEGATE_RetVal_TwoParams(bool, FXformPositionCallback, const FSDistanceVector&, FVector&);
 DECLARE_DELEGATE_RetVal_TwoParams(bool, FEvaluateOrbitalElements, const FSConicElements&, FSStateVector&);
 DECLARE_DELEGATE_RetVal_TwoParams(bool, FGetOrbitalElements, const FSStateVector&, FSConicElements&);
@@ -134,5 +139,7 @@ namespace MaxQSamples
     bool InitBodyScales(float BodyScale, const FSamplesSolarSystemState& SolarSystemState);
     bool UpdateBodyPositions(const FName& OriginNaifName, const FName& OriginReferenceFrame, float DistanceScale, const FSamplesSolarSystemState& SolarSystemState);
     bool UpdateBodyOrientations(const FName& OriginReferenceFrame, const FSamplesSolarSystemState& SolarSystemState);
+    // UpdateBodyPositions + UpdateBodyOrientations in one pass
+    bool UpdateBodyPoses(const FName& OriginNaifName, const FName& OriginReferenceFrame, float DistanceScale, const FSamplesSolarSystemState& SolarSystemState);
     bool UpdateSunDirection(const FName& OriginNaifName, const FName& OriginReferenceFrame, const FSEphemerisTime& et, const FName& SunNaifName, const TWeakObjectPtr<AActor>& SunDirectionalLight);
 }
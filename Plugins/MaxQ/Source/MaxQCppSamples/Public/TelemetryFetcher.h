@@ -0,0 +1,81 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "Misc/Optional.h"
+#include "Templates/SharedPointer.h"
+
+
+//-----------------------------------------------------------------------------
+// FTelemetryFetcher
+// Batched, cached Celestrak GP queries, straight into an FSTLECatalog
+//-----------------------------------------------------------------------------
+//
+// A group query ("GROUP=active") returns thousands of element sets in one
+// response, so there's no need for a request per object.
+//
+// Each query's response is kept on disk (Saved/MaxQ/Telemetry) with its
+// ETag/Last-Modified, so:
+// * A response younger than MinRefreshInterval isn't requested at all
+//   (Celestrak updates GP data a few times a day, and asks clients not to
+//   poll faster than that)
+// * Otherwise it's a conditional request, and a 304 reuses the cached copy
+// * If the server can't be reached, the cached copy is used
+//
+// At most MaxConcurrentRequests are in flight at a time.  Responses are
+// parsed (OMM JSON, ParseTLECatalog) on the SPICE executor thread, not on
+// the game thread.  Create it with MakeShared, and call Fetch from the game
+// thread;  it stays alive until its requests are done.
+//-----------------------------------------------------------------------------
+
+namespace MaxQSamples
+{
+    // On the game thread.  ErrorMessage names the first query that failed
+    // (the catalog has the rest).
+    DECLARE_DELEGATE_TwoParams(FOnTelemetryFetched, const FSTLECatalog& /*Catalog*/, const FString& /*ErrorMessage*/);
+
+    class MAXQCPPSAMPLES_API FTelemetryFetcher : public TSharedFromThis<FTelemetryFetcher>
+    {
+    public:
+        // CacheDirectory:  empty for Saved/MaxQ/Telemetry
+        explicit FTelemetryFetcher(const FString& CacheDirectory = FString(), int32 MaxConcurrentRequests = 4);
+
+        // Celestrak GP queries ("GROUP=active", "CATNR=25544", ...), merged
+        // into one catalog in query order (an object in more than one
+        // response is only added once)
+        void Fetch(const TArray<FString>& Queries, FOnTelemetryFetched OnFetched);
+
+        FTimespan MinRefreshInterval = FTimespan::FromHours(2.);
+
+    private:
+        struct FBatch;
+
+        struct FCacheMetadata
+        {
+            FString ETag;
+            FString LastModified;
+            FDateTime Fetched;
+        };
+
+        void StartRequests();
+        void Request(const TSharedRef<FBatch>& Batch, int32 Query);
+        // Body empty:  use the cached response.  Metadata:  to (re)write.
+        void Parse(const TSharedRef<FBatch>& Batch, int32 Query, FString&& Body, const FString& Error, TOptional<FCacheMetadata>&& Metadata);
+        void Parsed(const TSharedRef<FBatch>& Batch, int32 Query, FSTLECatalog&& Catalog, const FString& Error);
+
+        FString CachePath(const FString& Query) const;
+        bool ReadMetadata(const FString& Query, FCacheMetadata& Metadata) const;
+
+        FString CacheDirectory;
+        int32 MaxConcurrentRequests = 4;
+        int32 InFlight = 0;
+        TArray<TPair<TSharedRef<FBatch>, int32>> Pending;
+    };
+}
@@ -58,6 +58,11 @@
 #include "SpicePlatformDefs.h"
 #include "SpiceUtilities.h"
 #include "SpiceMath.h"
+#include "SpiceEphemeris.h"
+#include "SpiceQueryHandle.h"
+#include "SpicePoolWatch.h"
+#include "SpiceLock.h"
+#include "SpiceContext.h"
 #include "algorithm"
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
@@ -65,7 +70,7 @@ extern "C"
 {
 #include "SpiceUsr.h"
 
-// for ev2lin, dpspce
+// for ev2lin, dpspce, stcf01, stcg01, stcl01
 #include "SpiceZfc.h"
 }
 PRAGMA_POP_PLATFORM_DEFAULT_PACKING
@@ -98,7 +103,7 @@ void USpice::enumerate_kernels(
     }
 
 
-    kernelFilePaths.Empty();
+    kernelFilePaths.Reset();
 
     TArray<FString> foundFiles;
     IFileManager::Get().FindFiles(foundFiles, *FileDirectory);
@@ -143,6 +148,11 @@ void USpice::furnsh(
     const FString& file
 )
 {
+    if (MaxQ::Core::FSpiceContext* Context = MaxQ::Core::FSpiceContext::Current())
+    {
+        Context->Furnsh(file, &ResultCode, &ErrorMessage);
+        return;
+    }
     MaxQ::Data::Furnsh(file, &ResultCode, &ErrorMessage);
 }
 
@@ -153,6 +163,11 @@ void USpice::furnsh_list(
     const TArray<FString>& files
 )
 {
+    if (MaxQ::Core::FSpiceContext* Context = MaxQ::Core::FSpiceContext::Current())
+    {
+        Context->Furnsh(files, &ResultCode, &ErrorMessage);
+        return;
+    }
     MaxQ::Data::Furnsh(files, &ResultCode, &ErrorMessage);
 }
 
@@ -163,7 +178,7 @@ void USpice::combine_paths(
     TArray<FString>& joinedPaths
 )
 {
-    joinedPaths.Empty();
+    joinedPaths.Reset();
 
     for (FString relativePath : relativePaths)
     {
@@ -174,8 +189,17 @@ void USpice::combine_paths(
 
 void USpice::clear_all()
 {
+    // Just this world's kernels (SpiceContext.h)
+    if (MaxQ::Core::FSpiceContext* Context = MaxQ::Core::FSpiceContext::Current())
+    {
+        Context->ClearAll();
+        return;
+    }
+
+    MaxQ::Core::FSpiceScope Scope;
     kclear_c();
     clpool_c();
+    ClearKernelHistory();
 
     UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Clear All' cleared kernel memory & pool") );
 }
@@ -187,12 +211,25 @@ void USpice::unload(
     const FString& relativeDirectory
 )
 {
+    if (MaxQ::Core::FSpiceContext* Context = MaxQ::Core::FSpiceContext::Current())
+    {
+        Context->Unload(relativeDirectory, &ResultCode, &ErrorMessage);
+        return;
+    }
+
     FString absolutePath = toPath(relativeDirectory);
-    unload_c(TCHAR_TO_ANSI(*absolutePath));
+    MaxQ::Core::FSpiceScope Scope;
+    FKernelLoadTiming Timing(absolutePath, true);
+    {
+        MAXQ_TRACE_SCOPE_TEXT(TEXT("unload %s"), *Timing.Describe());
+        unload_c(TCHAR_TO_ANSI(*absolutePath));
+    }
+    Timing.Finish(!failed_c());
 
     if (!ErrorCheck(ResultCode, ErrorMessage))
     {
         UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Unload' unloaded kernel : %s"), *absolutePath);
+        RecordKernelOperation(MaxQ::Data::FKernelHistoryEntry::EOperation::Unload, absolutePath);
     }
 }
 
@@ -1276,6 +1313,7 @@ void USpice::ckgp(
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
+    MAXQ_FRAME_LOOKUP_SCOPE();
     ckgp_c(_inst, _sclkdp, _tol, _ref.Get(), _cmat, &_clkout, &_found);
 
     // Return Values
@@ -1312,6 +1350,7 @@ void USpice::ckgpav(
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
+    MAXQ_FRAME_LOOKUP_SCOPE();
     ckgpav_c(_inst, _sclkdp, _tol, _ref.Get(), _cmat, _av, &_clkout, &_found);
 
     // Return Values
@@ -1471,6 +1510,8 @@ void USpice::ckw01(
     const TArray<FSPointingType1Observation>& records
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt        _handle = handle;
     SpiceDouble     _begtim = begtim;
@@ -1480,9 +1521,9 @@ void USpice::ckw01(
     SpiceBoolean    _avflag = avflag ? SPICETRUE : SPICEFALSE;
     auto            _segid = StringCast<ANSICHAR>(*segid);
     SpiceInt        _nrec = records.Num();
-    SpiceDouble* _sclkdp = (SpiceDouble*)StackAlloc(_nrec * sizeof(SpiceDouble));
-    SpiceDouble(*_quats)[4] = (SpiceDouble(*)[4])StackAlloc(_nrec * sizeof(SpiceDouble[4]));
-    SpiceDouble(*_avvs)[3] = (SpiceDouble(*)[3])StackAlloc(_nrec * sizeof(SpiceDouble[3]));
+    SpiceDouble* _sclkdp = (SpiceDouble*)Scratch.Alloc(_nrec * sizeof(SpiceDouble));
+    SpiceDouble(*_quats)[4] = (SpiceDouble(*)[4])Scratch.Alloc(_nrec * sizeof(SpiceDouble[4]));
+    SpiceDouble(*_avvs)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_nrec * sizeof(SpiceDouble[3]));
 
     for (int i = 0; i < records.Num(); ++i)
     {
@@ -1511,6 +1552,8 @@ void USpice::ckw02(
     const TArray<FSPointingType2Observation>& records
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt        _handle = handle;
     SpiceDouble     _begtim = begtim;
@@ -1519,11 +1562,11 @@ void USpice::ckw02(
     auto            _ref = StringCast<ANSICHAR>(*ref);
     auto            _segid = StringCast<ANSICHAR>(*segid);
     SpiceInt        _nrec = records.Num();
-    SpiceDouble* _start = (SpiceDouble*)StackAlloc(_nrec * sizeof(SpiceDouble));
-    SpiceDouble* _stop = (SpiceDouble*)StackAlloc(_nrec * sizeof(SpiceDouble));
-    SpiceDouble(*_quats)[4] = (SpiceDouble(*)[4])StackAlloc(_nrec * sizeof(SpiceDouble[4]));
-    SpiceDouble(*_avvs)[3] = (SpiceDouble(*)[3])StackAlloc(_nrec * sizeof(SpiceDouble[3]));
-    SpiceDouble* _rates = (SpiceDouble*)StackAlloc(_nrec * sizeof(SpiceDouble));
+    SpiceDouble* _start = (SpiceDouble*)Scratch.Alloc(_nrec * sizeof(SpiceDouble));
+    SpiceDouble* _stop = (SpiceDouble*)Scratch.Alloc(_nrec * sizeof(SpiceDouble));
+    SpiceDouble(*_quats)[4] = (SpiceDouble(*)[4])Scratch.Alloc(_nrec * sizeof(SpiceDouble[4]));
+    SpiceDouble(*_avvs)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_nrec * sizeof(SpiceDouble[3]));
+    SpiceDouble* _rates = (SpiceDouble*)Scratch.Alloc(_nrec * sizeof(SpiceDouble));
 
     for (int i = 0; i < records.Num(); ++i)
     {
@@ -1554,6 +1597,8 @@ void USpice::ckw03(
     const TArray<double>& starts
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt        _handle = handle;
     SpiceDouble     _begtim = begtim;
@@ -1563,9 +1608,9 @@ void USpice::ckw03(
     SpiceBoolean    _avflag = avflag ? SPICETRUE : SPICEFALSE;
     auto            _segid = StringCast<ANSICHAR>(*segid);
     SpiceInt        _nrec = records.Num();
-    SpiceDouble* _sclkdp = (SpiceDouble*)StackAlloc(_nrec * sizeof(SpiceDouble));
-    SpiceDouble(*_quats)[4] = (SpiceDouble(*)[4])StackAlloc(_nrec * sizeof(SpiceDouble[4]));
-    SpiceDouble(*_avvs)[3] = (SpiceDouble(*)[3])StackAlloc(_nrec * sizeof(SpiceDouble[3]));
+    SpiceDouble* _sclkdp = (SpiceDouble*)Scratch.Alloc(_nrec * sizeof(SpiceDouble));
+    SpiceDouble(*_quats)[4] = (SpiceDouble(*)[4])Scratch.Alloc(_nrec * sizeof(SpiceDouble[4]));
+    SpiceDouble(*_avvs)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_nrec * sizeof(SpiceDouble[3]));
 
     for (int i = 0; i < _nrec; ++i)
     {
@@ -1575,7 +1620,7 @@ void USpice::ckw03(
     }
 
     SpiceInt        _nints = starts.Num();
-    SpiceDouble* _starts = (SpiceDouble*)StackAlloc(_nints * sizeof(SpiceDouble));
+    SpiceDouble* _starts = (SpiceDouble*)Scratch.Alloc(_nints * sizeof(SpiceDouble));
     for (int i = 0; i < _nints; ++i)
     {
         _starts[i] = starts[i];
@@ -1605,6 +1650,8 @@ void USpice::ckw05(
     const TArray<double>& starts
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt        _handle = handle;
     SpiceCK05Subtype    _subtyp = (SpiceCK05Subtype)subtyp;
@@ -1618,18 +1665,18 @@ void USpice::ckw05(
     SpiceDouble         _rate = rate;
 
     SpiceInt        _nints = starts.Num();
-    SpiceDouble* _starts = (SpiceDouble*)StackAlloc(_nints * sizeof(SpiceDouble));
+    SpiceDouble* _starts = (SpiceDouble*)Scratch.Alloc(_nints * sizeof(SpiceDouble));
     for (int i = 0; i < _nints; ++i)
     {
         _starts[i] = starts[i];
     }
 
     SpiceInt        _n = records.Num();
-    SpiceDouble* _sclkdp = (SpiceDouble*)StackAlloc(_n * sizeof(SpiceDouble));
+    SpiceDouble* _sclkdp = (SpiceDouble*)Scratch.Alloc(_n * sizeof(SpiceDouble));
     const void* _packts = nullptr;
     if (subtyp == ES_CK05Subtype::Hermite8)
     {
-        SpiceDouble(*__packts)[8] = (SpiceDouble(*)[8])StackAlloc(_n * sizeof(SpiceDouble[8]));
+        SpiceDouble(*__packts)[8] = (SpiceDouble(*)[8])Scratch.Alloc(_n * sizeof(SpiceDouble[8]));
         for (int i = 0; i < _n; i++)
         {
             records[i].CopyToSubtype1(_sclkdp[i], __packts[i]);
@@ -1638,7 +1685,7 @@ void USpice::ckw05(
     }
     else if (subtyp == ES_CK05Subtype::Lagrange4)
     {
-        SpiceDouble(*__packts)[4] = (SpiceDouble(*)[4])StackAlloc(_n * sizeof(SpiceDouble[4]));
+        SpiceDouble(*__packts)[4] = (SpiceDouble(*)[4])Scratch.Alloc(_n * sizeof(SpiceDouble[4]));
         for (int i = 0; i < _n; i++)
         {
             records[i].CopyToSubtype2(_sclkdp[i], __packts[i]);
@@ -1647,7 +1694,7 @@ void USpice::ckw05(
     }
     else if (subtyp == ES_CK05Subtype::Hermite14)
     {
-        SpiceDouble(*__packts)[14] = (SpiceDouble(*)[14])StackAlloc(_n * sizeof(SpiceDouble[14]));
+        SpiceDouble(*__packts)[14] = (SpiceDouble(*)[14])Scratch.Alloc(_n * sizeof(SpiceDouble[14]));
         for (int i = 0; i < _n; i++)
         {
             records[i].CopyToSubtype3(_sclkdp[i], __packts[i]);
@@ -1656,7 +1703,7 @@ void USpice::ckw05(
     }
     else if (subtyp == ES_CK05Subtype::Lagrange7)
     {
-        SpiceDouble(*__packts)[7] = (SpiceDouble(*)[7])StackAlloc(_n * sizeof(SpiceDouble[7]));
+        SpiceDouble(*__packts)[7] = (SpiceDouble(*)[7])Scratch.Alloc(_n * sizeof(SpiceDouble[7]));
         for (int i = 0; i < _n; i++)
         {
             records[i].CopyToSubtype4(_sclkdp[i], __packts[i]);
@@ -1877,6 +1924,8 @@ void USpice::dafac(
     const TArray<FString>& comments
 )
 {
+    FScratchScope Scratch;
+
     // Buffers
     int32 maxCommentLineLength = 0;
     for (int32 i = 0; i < comments.Num(); ++i)
@@ -1885,7 +1934,7 @@ void USpice::dafac(
     }
     size_t bytesPerLine = maxCommentLineLength * sizeof(SpiceChar);
     size_t totalBytes = comments.Num() * bytesPerLine;
-    SpiceChar* _buffer = (SpiceChar*)StackAlloc(totalBytes);
+    SpiceChar* _buffer = (SpiceChar*)Scratch.Alloc(totalBytes);
     FMemory::Memset(_buffer, 0, totalBytes);
 
     for (int32 i = 0; i < comments.Num(); ++i)
@@ -1969,6 +2018,8 @@ void USpice::dafec(
     TArray<FString>& comments
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt _handle = handle;
 
@@ -1986,7 +2037,7 @@ void USpice::dafec(
     SpiceBoolean _done = SPICEFALSE;
 
     size_t chafBufferSize = _bufsiz * _lenout * sizeof(SpiceChar);
-    _buffer = (SpiceChar*)StackAlloc(chafBufferSize);
+    _buffer = (SpiceChar*)Scratch.Alloc(chafBufferSize);
 
     while (!_done)
     {
@@ -2445,6 +2496,8 @@ void USpice::dskp02(
     int               start
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt      _handle = (SpiceInt)handle;
     SpiceDLADescr _dladsc;  dladsc.CopyTo(&_dladsc);
@@ -2457,7 +2510,7 @@ void USpice::dskp02(
     // Can consider filling straight into TArray if the following holds true.
     check(sizeof(SpiceInt[3]) == sizeof(FSPlateIndices));
 
-    SpiceInt      (*_plates)[3] = (SpiceInt(*)[3])new SpiceInt[count][3];
+    SpiceInt      (*_plates)[3] = (SpiceInt(*)[3])Scratch.Alloc(count * sizeof(SpiceInt[3]));
 
 
     // Invocation
@@ -2471,14 +2524,12 @@ void USpice::dskp02(
     );
 
     // Pack output
-    plates.Init(FSPlateIndices(), _n);
+    ReuseOutput(plates, _n);
     for (int i = 0; i < _n; ++i)
     {
         plates[i] = FSPlateIndices(_plates[i][0], _plates[i][1], _plates[i][2]);
     }
 
-    delete[] _plates;
-
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
 }
@@ -2494,6 +2545,8 @@ void USpice::dskv02(
     int               start
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt      _handle = (SpiceInt)handle;
     SpiceDLADescr _dladsc;  dladsc.CopyTo(&_dladsc);
@@ -2507,7 +2560,7 @@ void USpice::dskv02(
     check(sizeof(SpiceDouble[3]) == sizeof(FSDistanceVector));
 
     // Don't use stack memory, it's an unbounded request and could be enough verts to blow the stack
-    SpiceDouble   (*_vrtces)[3] = (SpiceDouble(*)[3])new SpiceDouble[count][3];
+    SpiceDouble   (*_vrtces)[3] = (SpiceDouble(*)[3])Scratch.Alloc(count * sizeof(SpiceDouble[3]));
 
     // Invocation
     dskv02_c(
@@ -2521,14 +2574,12 @@ void USpice::dskv02(
 
 
     // Pack output
-    vrtces.Init(FSDistanceVector(), _n);
+    ReuseOutput(vrtces, _n);
     for (int i = 0; i < _n; ++i)
     {
         vrtces[i] = FSDistanceVector(_vrtces[i]);
     }
 
-    delete[] _vrtces;
-
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
 }
@@ -2657,6 +2708,8 @@ void USpice::dskxv(
     const FString& fixref
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     // pri - "In the N0066 SPICE Toolkit, this is the only allowed value"
     SpiceBoolean        _pri = SPICEFALSE;
@@ -2666,8 +2719,8 @@ void USpice::dskxv(
     SpiceDouble         _et = et.AsSpiceDouble();
     auto                _fixref = StringCast<ANSICHAR>(*fixref);
     SpiceInt            _nrays = rayarray.Num();
-    SpiceDouble(*_vtxarr)[3] = (SpiceDouble(*)[3])StackAlloc(_nrays * sizeof(SpiceDouble[3]));
-    SpiceDouble(*_dirarr)[3] = (SpiceDouble(*)[3])StackAlloc(_nrays * sizeof(SpiceDouble[3]));
+    SpiceDouble(*_vtxarr)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_nrays * sizeof(SpiceDouble[3]));
+    SpiceDouble(*_dirarr)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_nrays * sizeof(SpiceDouble[3]));
 
     for (int i = 0; i < rayarray.Num(); ++i)
     {
@@ -2675,8 +2728,8 @@ void USpice::dskxv(
     }
 
     // Outputs
-    SpiceDouble(*_xptarr)[3] = (SpiceDouble(*)[3])StackAlloc(_nrays * sizeof(SpiceDouble[3]));
-    SpiceBoolean    *_fndarr = (SpiceBoolean*)StackAlloc(_nrays * sizeof(SpiceBoolean));
+    SpiceDouble(*_xptarr)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_nrays * sizeof(SpiceDouble[3]));
+    SpiceBoolean    *_fndarr = (SpiceBoolean*)Scratch.Alloc(_nrays * sizeof(SpiceBoolean));
 
     // Invocation
     dskxv_c(
@@ -2694,16 +2747,13 @@ void USpice::dskxv(
     );
 
     // Pack up the outputs...
-    xptarr.Init(FSDistanceVector(), _nrays);
-    fndarr.Init(false, _nrays);
+    ReuseOutput(xptarr, _nrays);
+    ReuseOutput(fndarr, _nrays);
 
     for(int i = 0; i < _nrays; ++i)
     {
         fndarr[i] = (_fndarr[i] == SPICETRUE ? true : false);
-        if (fndarr[i])
-        {
-            xptarr[i] = FSDistanceVector(_xptarr[i]);
-        }
+        xptarr[i] = fndarr[i] ? FSDistanceVector(_xptarr[i]) : FSDistanceVector();
     }
 
     // Error Handling
@@ -3075,7 +3125,7 @@ void USpice::getgeophs(FSTLEGeophysicalConstants& geophs, const FString& body)
 
     for (int i = 0; i < 8; ++i)
     {
-        bodvrd_c(TCHAR_TO_ANSI(*body), Items[i], 1, &dim, &_geophs[i]);
+        CachedBodvrd(TCHAR_TO_ANSI(*body), Items[i], 1, &dim, &_geophs[i]);
 
         if (failed_c() == SPICETRUE)
         {
@@ -3149,7 +3199,10 @@ void USpice::evsgp4(
     SpiceDouble _state[6]; state.CopyTo(_state);
 
     // Invocation
-    evsgp4_c(_et, _geophs, _elems, _state);
+    {
+        MAXQ_SGP4_SCOPE(1);
+        evsgp4_c(_et, _geophs, _elems, _state);
+    }
 
     // Bundle up the output
     state = FSStateVector(_state);
@@ -3278,6 +3331,8 @@ void USpice::gcpool(
     int                 room
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt        _start = start;
     SpiceInt        _room = room;
@@ -3285,7 +3340,7 @@ void USpice::gcpool(
     // Outputs
     SpiceInt        _n = 0;
     size_t buffer_size = _lenout * _room * sizeof(SpiceChar);
-    void* _cvals = StackAlloc(buffer_size);
+    void* _cvals = Scratch.Alloc(buffer_size);
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
@@ -3478,18 +3533,20 @@ void USpice::gdpool(
     int                 room
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt        _start = start;
     SpiceInt        _room = room;
     // Outputs
     SpiceInt        _n = 0;
     size_t buffer_size = _room * sizeof(SpiceDouble);
-    SpiceDouble* _values = (SpiceDouble*)StackAlloc(buffer_size);
+    SpiceDouble* _values = (SpiceDouble*)Scratch.Alloc(buffer_size);
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
     FMemory::Memset(_values, 0, buffer_size);
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
+    CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
 
     // Return values
     values = TArray<double>();
@@ -3520,7 +3577,7 @@ void USpice::gdpool_scalar(
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
+    CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
 
     // Return values
     value = _value;
@@ -3547,7 +3604,7 @@ void USpice::gdpool_distance(
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
+    CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
 
     // Return values
     value = FSDistance(_value);
@@ -3574,7 +3631,7 @@ void USpice::gdpool_vector(
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, _value, &_found);
+    CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, _value, &_found);
 
     // Return values
     value = FSDistanceVector(_value);
@@ -3602,7 +3659,7 @@ void USpice::gdpool_mass(
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
+    CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
 
     // Return values
     value = FSMassConstant(_value);
@@ -3805,19 +3862,6 @@ void USpice::gfdist(
     ES_RelationalOperator relate
     )
 {
-    const int MAXWIN = 200;
-    if (2 * cnfine.Num() > MAXWIN)
-    {
-        setmsg_c("[cnfine] Window Segment count = #; maximum allowed value is #");
-        errdp_c("#", cnfine.Num());
-        errdp_c("#", MAXWIN / 2);
-        sigerr_c("SPICE(VALUEOUTOFRANGE)");
-
-        // Error Handling
-        ErrorCheck(ResultCode, ErrorMessage);
-        return;
-    }
-
     // Inputs
     auto            _target = StringCast<ANSICHAR>(*target);
     ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
@@ -3830,11 +3874,6 @@ void USpice::gfdist(
     // Unpack the confinement window array..
     FSEphemerisPeriod maxWindow = FSEphemerisPeriod::Zero;
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-
     for (auto It = cnfine.CreateConstIterator(); It; ++It)
     {
         FSEphemerisTime et0 = (*It).start;
@@ -3845,39 +3884,33 @@ void USpice::gfdist(
         {
             maxWindow = thisWindow;
         }
-        
-        wninsd_c(et0.AsSpiceDouble(), et1.AsSpiceDouble(), &_cnfine);
     }
     // 
     SpiceInt _nintvls = 2 * cnfine.Num() + (maxWindow.AsSpiceDouble() / step.AsSpiceDouble()) + 2;
 
-    // Output
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
     // Invocation
-    gfdist_c(
-        _target.Get(),
-        _abcorr,
-        _obsrvr.Get(),
-        _relate,
-        _refval,
-        _adjust,
-        _step,
-        _nintvls,
-        &_cnfine,
-        &_result    
-    );
-
-    // Pack up the output...
-    results.Empty();
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            GfEvent(FGfQuantity("DISTANCE").Param("TARGET", _target.Get()).Param("OBSERVER", _obsrvr.Get()).Param("ABCORR", _abcorr),
+                _relate, _refval, _adjust, _step, _nintvls, _cnfine, _result);
+            return;
+        }
+
+        gfdist_c(
+            _target.Get(),
+            _abcorr,
+            _obsrvr.Get(),
+            _relate,
+            _refval,
+            _adjust,
+            _step,
+            _nintvls,
+            _cnfine,
+            _result    
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -3902,19 +3935,6 @@ void USpice::gfilum(
     ES_RelationalOperator relate
 )
 {
-    const int MAXWIN = 200;
-    if (2 * cnfine.Num() > MAXWIN)
-    {
-        setmsg_c("[cnfine] Window Segment count = #; maximum allowed value is #");
-        errdp_c("#", cnfine.Num());
-        errdp_c("#", MAXWIN / 2);
-        sigerr_c("SPICE(VALUEOUTOFRANGE)");
-
-        // Error Handling
-        ErrorCheck(ResultCode, ErrorMessage);
-        return;
-    }
-
     // The docs:
     // "The only choice currently supported is 'Ellipsoid'"
     ConstSpiceChar* _method = "Ellipsoid";
@@ -3930,15 +3950,9 @@ void USpice::gfilum(
     SpiceDouble     _adjust = adjust.AsSpiceDouble();
     SpiceDouble     _step   = step.AsSpiceDouble();
 
-
     // Unpack the confinement window array..
     FSEphemerisPeriod maxWindow = FSEphemerisPeriod::Zero;
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-
     for (auto It = cnfine.CreateConstIterator(); It; ++It)
     {
         FSEphemerisTime et0 = (*It).start;
@@ -3949,46 +3963,39 @@ void USpice::gfilum(
         {
             maxWindow = thisWindow;
         }
-
-        wninsd_c(et0.AsSpiceDouble(), et1.AsSpiceDouble(), &_cnfine);
     }
 
-
     // 
     SpiceInt _nintvls = 2 * cnfine.Num() + (maxWindow.AsSpiceDouble() / step.AsSpiceDouble()) + 2;
 
-    // Output
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
-    gfilum_c(
-        _method,
-        _angtyp,
-        _target.Get(),
-        _illmn.Get(),
-        _fixref.Get(),
-        _abcorr,
-        _obsrvr.Get(),
-        _spoint,
-        _relate,
-        _refval,
-        _adjust,
-        _step,
-        _nintvls,
-        &_cnfine,
-        &_result
-    );
-
-    // Pack the results...
-    results.Empty();
-
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            GfEvent(FGfQuantity("ILLUMINATION ANGLE").Param("TARGET", _target.Get()).Param("ILLUM", _illmn.Get()).Param("OBSERVER", _obsrvr.Get()).Param("ABCORR", _abcorr)
+                .Param("REFERENCE FRAME", _fixref.Get()).Param("ANGTYP", _angtyp).Param("METHOD", _method).Param("SPOINT", _spoint),
+                _relate, _refval, _adjust, _step, _nintvls, _cnfine, _result);
+            return;
+        }
+
+        gfilum_c(
+            _method,
+            _angtyp,
+            _target.Get(),
+            _illmn.Get(),
+            _fixref.Get(),
+            _abcorr,
+            _obsrvr.Get(),
+            _spoint,
+            _relate,
+            _refval,
+            _adjust,
+            _step,
+            _nintvls,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4014,19 +4021,6 @@ void USpice::gfoclt(
     const FString& obsrvr
 )
 {
-    const int MAXWIN = 200;
-    if (2 * cnfine.Num() > MAXWIN)
-    {
-        setmsg_c("[cnfine] Window Segment count = #; maximum allowed value is #");
-        errdp_c("#", cnfine.Num());
-        errdp_c("#", MAXWIN / 2);
-        sigerr_c("SPICE(VALUEOUTOFRANGE)");
-
-        // Error Handling
-        ErrorCheck(ResultCode, ErrorMessage);
-        return;
-    }
-
     ConstSpiceChar* _occtyp;
     auto            _front = StringCast<ANSICHAR>(*front);
     auto            _fshape = StringCast<ANSICHAR>(*MaxQ::Core::ToString(frontShape, frontShapeSurfaces));
@@ -4037,17 +4031,6 @@ void USpice::gfoclt(
     ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
     auto            _obsrvr = StringCast<ANSICHAR>(*obsrvr);
     SpiceDouble     _step = step.AsSpiceDouble();
-    
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-
-    for (auto It = cnfine.CreateConstIterator(); It; ++It)
-    {
-        wninsd_c((*It).start.AsSpiceDouble(), (*It).stop.AsSpiceDouble(), &_cnfine);
-    }
-   
 
     switch (occtyp)
     {
@@ -4066,35 +4049,30 @@ void USpice::gfoclt(
         break;
     };
 
-    // Outputs
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
-    // Invocation
-    gfoclt_c(
-        _occtyp,
-        _front.Get(),
-        _fshape.Get(),
-        _fframe.Get(),
-        _back.Get(),
-        _bshape.Get(),
-        _bframe.Get(),
-        _abcorr,
-        _obsrvr.Get(),
-        _step,
-        &_cnfine,
-        &_result
-    );
-
-    results.Empty();
-
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    // Invocation
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            GfOccultation(_occtyp, _front.Get(), _fshape.Get(), _fframe.Get(), _back.Get(), _bshape.Get(), _bframe.Get(), _abcorr, _obsrvr.Get(), _step, _cnfine, _result);
+            return;
+        }
+
+        gfoclt_c(
+            _occtyp,
+            _front.Get(),
+            _fshape.Get(),
+            _fframe.Get(),
+            _back.Get(),
+            _bshape.Get(),
+            _bframe.Get(),
+            _abcorr,
+            _obsrvr.Get(),
+            _step,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4117,19 +4095,6 @@ void USpice::gfpa(
     ES_RelationalOperator relate
 )
 {
-    const int MAXWIN = 200;
-    if (2 * cnfine.Num() > MAXWIN)
-    {
-        setmsg_c("[cnfine] Window Segment count = #; maximum allowed value is #");
-        errdp_c("#", cnfine.Num());
-        errdp_c("#", MAXWIN / 2);
-        sigerr_c("SPICE(VALUEOUTOFRANGE)");
-
-        // Error Handling
-        ErrorCheck(ResultCode, ErrorMessage);
-        return;
-    }
-
     auto            _target = StringCast<ANSICHAR>(*target);
     auto            _illmn  = StringCast<ANSICHAR>(*illmn);
     ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
@@ -4142,10 +4107,6 @@ void USpice::gfpa(
     // Unpack the confinement window array..
     FSEphemerisPeriod maxWindow = FSEphemerisPeriod::Zero;
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
     for (auto It = cnfine.CreateConstIterator(); It; ++It)
     {
         FSEphemerisTime et0 = (*It).start;
@@ -4156,41 +4117,34 @@ void USpice::gfpa(
         {
             maxWindow = thisWindow;
         }
-
-        wninsd_c(et0.AsSpiceDouble(), et1.AsSpiceDouble(), &_cnfine);
     }
 
     // 
     SpiceInt _nintvls = 2 * cnfine.Num() + (maxWindow.AsSpiceDouble() / step.AsSpiceDouble()) + 2;
 
-    // Output
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
-    gfpa_c(
-        _target.Get(),
-        _illmn.Get(),
-        _abcorr,
-        _obsrvr.Get(),
-        _relate,
-        _refval,
-        _adjust,
-        _step,
-        _nintvls,
-        &_cnfine,
-        &_result
-    );
-
-
-    results.Empty();
-
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            GfEvent(FGfQuantity("PHASE ANGLE").Param("TARGET", _target.Get()).Param("OBSERVER", _obsrvr.Get()).Param("ILLUM", _illmn.Get()).Param("ABCORR", _abcorr),
+                _relate, _refval, _adjust, _step, _nintvls, _cnfine, _result);
+            return;
+        }
+
+        gfpa_c(
+            _target.Get(),
+            _illmn.Get(),
+            _abcorr,
+            _obsrvr.Get(),
+            _relate,
+            _refval,
+            _adjust,
+            _step,
+            _nintvls,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4215,20 +4169,6 @@ void USpice::gfposc(
     int nintvls
 )
 {
-    const int MAXWIN = 200;
-    if (2 * cnfine.Num() > MAXWIN)
-    {
-        setmsg_c("[cnfine] Window Segment count = #; maximum allowed value is #");
-        errdp_c("#", cnfine.Num());
-        errdp_c("#", MAXWIN / 2);
-        sigerr_c("SPICE(VALUEOUTOFRANGE)");
-
-        // Error Handling
-        ErrorCheck(ResultCode, ErrorMessage);
-        return;
-    }
-
-
     // Inputs
     auto            _target = StringCast<ANSICHAR>(*target);
     auto            _frame  = StringCast<ANSICHAR>(*frame);
@@ -4242,47 +4182,35 @@ void USpice::gfposc(
     SpiceDouble     _step   = step.AsSpiceDouble();
     SpiceInt        _nintvls = (SpiceInt)nintvls;
 
-
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-    for (auto It = cnfine.CreateConstIterator(); It; ++It)
-    {
-        wninsd_c((*It).start.AsSpiceDouble(), (*It).stop.AsSpiceDouble(), &_cnfine);
-    }
-
-    // Outputs
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
     // Invocation
-    gfposc_c(
-        _target.Get(),
-        _frame.Get(),
-        _abcorr,
-        _obsrvr.Get(),
-        _crdsys,
-        _coord,
-        _relate,
-        _refval,
-        _adjust,
-        _step,
-        _nintvls,
-        &_cnfine,
-        &_result
-    );
-
-    // Pack output
-    results.Empty();
-
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            const SpiceDouble _dvec[3] = { 0., 0., 0. };
+            GfEvent(FGfQuantity("COORDINATE").Param("TARGET", _target.Get()).Param("OBSERVER", _obsrvr.Get()).Param("ABCORR", _abcorr)
+                .Param("COORDINATE SYSTEM", _crdsys).Param("COORDINATE", _coord).Param("REFERENCE FRAME", _frame.Get())
+                .Param("VECTOR DEFINITION", "POSITION").Param("METHOD", " ").Param("DREF", " ").Param("DVEC", _dvec),
+                _relate, _refval, _adjust, _step, _nintvls, _cnfine, _result);
+            return;
+        }
+
+        gfposc_c(
+            _target.Get(),
+            _frame.Get(),
+            _abcorr,
+            _obsrvr.Get(),
+            _crdsys,
+            _coord,
+            _relate,
+            _refval,
+            _adjust,
+            _step,
+            _nintvls,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4301,8 +4229,6 @@ void USpice::gfrfov(
     const FString& obsrvr
     )
 {
-    const int MAXWIN = 200;
-
     auto            _inst   = StringCast<ANSICHAR>(*inst);
     SpiceDouble     _raydir[3];  raydir.CopyTo(_raydir);
     auto            _rframe = StringCast<ANSICHAR>(*rframe);
@@ -4310,41 +4236,26 @@ void USpice::gfrfov(
     auto            _obsrvr = StringCast<ANSICHAR>(*obsrvr);
     SpiceDouble     _step   = step.AsSpiceDouble();
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-    for (auto It = cnfine.CreateConstIterator(); It; ++It)
-    {
-        wninsd_c((*It).start.AsSpiceDouble(), (*It).stop.AsSpiceDouble(), &_cnfine);
-    }
-
-    // Outputs
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
     // Invocation
-    gfrfov_c(
-        _inst.Get(),
-        _raydir,
-        _rframe.Get(),
-        _abcorr,
-        _obsrvr.Get(),
-        _step,
-        &_cnfine,
-        &_result
-    );
-
-    // Pack output
-    results.Empty();
-
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            GfFieldOfView(_inst.Get(), "RAY", _raydir, " ", _rframe.Get(), _abcorr, _obsrvr.Get(), _step, _cnfine, _result);
+            return;
+        }
+
+        gfrfov_c(
+            _inst.Get(),
+            _raydir,
+            _rframe.Get(),
+            _abcorr,
+            _obsrvr.Get(),
+            _step,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4365,19 +4276,6 @@ void USpice::gfrr(
     ES_RelationalOperator relate
 )
 {
-    const int MAXWIN = 200;
-    if (2 * cnfine.Num() > MAXWIN)
-    {
-        setmsg_c("[cnfine] Window Segment count = #; maximum allowed value is #");
-        errdp_c("#", cnfine.Num());
-        errdp_c("#", MAXWIN / 2);
-        sigerr_c("SPICE(VALUEOUTOFRANGE)");
-
-        // Error Handling
-        ErrorCheck(ResultCode, ErrorMessage);
-        return;
-    }
-
     // Inputs
     auto            _target = StringCast<ANSICHAR>(*target);
     ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
@@ -4390,11 +4288,6 @@ void USpice::gfrr(
     // Unpack the confinement window array..
     FSEphemerisPeriod maxWindow = FSEphemerisPeriod::Zero;
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-
     for (auto It = cnfine.CreateConstIterator(); It; ++It)
     {
         FSEphemerisTime et0 = (*It).start;
@@ -4405,40 +4298,34 @@ void USpice::gfrr(
         {
             maxWindow = thisWindow;
         }
-
-        wninsd_c(et0.AsSpiceDouble(), et1.AsSpiceDouble(), &_cnfine);
     }
 
     // 
     SpiceInt _nintvls = 2 * cnfine.Num() + (maxWindow.AsSpiceDouble() / step.AsSpiceDouble()) + 2;
 
-    // Output
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
     // Invocation
-    gfrr_c(
-        _target.Get(),
-        _abcorr,
-        _obsrvr.Get(),
-        _relate,
-        _refval,
-        _adjust,
-        _step,
-        _nintvls,
-        &_cnfine,
-        &_result
-    );
-
-    // Pack up the output...
-    results.Empty();
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            GfEvent(FGfQuantity("RANGE RATE").Param("TARGET", _target.Get()).Param("OBSERVER", _obsrvr.Get()).Param("ABCORR", _abcorr),
+                _relate, _refval, _adjust, _step, _nintvls, _cnfine, _result);
+            return;
+        }
+
+        gfrr_c(
+            _target.Get(),
+            _abcorr,
+            _obsrvr.Get(),
+            _relate,
+            _refval,
+            _adjust,
+            _step,
+            _nintvls,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4469,19 +4356,6 @@ void USpice::gfsep(
     // Like,
     // 1. Query Full Moon events over the next 101 months
     // 2. gfsep using the results of 1.
-    const int MAXWIN = 200;
-    if (2 * cnfine.Num() > MAXWIN)
-    {
-        setmsg_c("[cnfine] Window Segment count = #; maximum allowed value is #");
-        errdp_c("#", cnfine.Num());
-        errdp_c("#", MAXWIN / 2);
-        sigerr_c("SPICE(VALUEOUTOFRANGE)");
-
-        // Error Handling
-        ErrorCheck(ResultCode, ErrorMessage);
-        return;
-    }
-
     auto            _targ1 = StringCast<ANSICHAR>(*targ1);
     ConstSpiceChar* _shape1 = MaxQ::Core::ToANSIString(shape1);
     /*
@@ -4508,11 +4382,6 @@ void USpice::gfsep(
     // Unpack the confinement window array..
     FSEphemerisPeriod maxWindow = FSEphemerisPeriod::Zero;
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-
     for (auto It = cnfine.CreateConstIterator(); It; ++It)
     {
         FSEphemerisTime et0 = (*It).start;
@@ -4523,45 +4392,40 @@ void USpice::gfsep(
         {
             maxWindow = thisWindow;
         }
-
-        wninsd_c(et0.AsSpiceDouble(), et1.AsSpiceDouble(), &_cnfine);
     }
 
     // 
     SpiceInt _nintvls = 2 * cnfine.Num() + (maxWindow.AsSpiceDouble() / step.AsSpiceDouble()) + 2;
 
-    // Output
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
     // Invocation
-    gfsep_c(
-        _targ1.Get(),
-        _shape1,
-        _frame1,
-        _targ2.Get(),
-        _shape2,
-        _frame2,
-        _abcorr,
-        _obsrvr.Get(),
-        _relate,
-        _refval,
-        _adjust,
-        _step,
-        _nintvls,
-        &_cnfine,
-        &_result
-    );
-
-    // Pack up the output...
-    result.Empty();
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, result, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        result.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            GfEvent(FGfQuantity("ANGULAR SEPARATION").Param("TARGET1", _targ1.Get()).Param("FRAME1", _frame1).Param("SHAPE1", _shape1)
+                .Param("TARGET2", _targ2.Get()).Param("FRAME2", _frame2).Param("SHAPE2", _shape2).Param("OBSERVER", _obsrvr.Get()).Param("ABCORR", _abcorr),
+                _relate, _refval, _adjust, _step, _nintvls, _cnfine, _result);
+            return;
+        }
+
+        gfsep_c(
+            _targ1.Get(),
+            _shape1,
+            _frame1,
+            _targ2.Get(),
+            _shape2,
+            _frame2,
+            _abcorr,
+            _obsrvr.Get(),
+            _relate,
+            _refval,
+            _adjust,
+            _step,
+            _nintvls,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4587,19 +4451,6 @@ void USpice::gfsntc(
     ES_RelationalOperator relate
 )
 {
-    const int MAXWIN = 200;
-    if (2 * cnfine.Num() > MAXWIN)
-    {
-        setmsg_c("[cnfine] Window Segment count = #; maximum allowed value is #");
-        errdp_c("#", cnfine.Num());
-        errdp_c("#", MAXWIN / 2);
-        sigerr_c("SPICE(VALUEOUTOFRANGE)");
-
-        // Error Handling
-        ErrorCheck(ResultCode, ErrorMessage);
-        return;
-    }
-    
     auto            _target = StringCast<ANSICHAR>(*target);
     auto            _fixref = StringCast<ANSICHAR>(*fixref);
     // The docs list "Ellipsoid" as the only accepted value.
@@ -4618,11 +4469,6 @@ void USpice::gfsntc(
     // Unpack the confinement window array..
     FSEphemerisPeriod maxWindow = FSEphemerisPeriod::Zero;
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-
     for (auto It = cnfine.CreateConstIterator(); It; ++It)
     {
         FSEphemerisTime et0 = (*It).start;
@@ -4633,48 +4479,44 @@ void USpice::gfsntc(
         {
             maxWindow = thisWindow;
         }
-
-        wninsd_c(et0.AsSpiceDouble(), et1.AsSpiceDouble(), &_cnfine);
     }
 
     // 
     SpiceInt _nintvls = 2 * cnfine.Num() + (maxWindow.AsSpiceDouble() / step.AsSpiceDouble()) + 2;
 
-    // Output
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
     // Invocation
-    gfsntc_c(
-        _target.Get(),
-        _fixref.Get(),
-        _method,
-        _abcorr,
-        _obsrvr.Get(),
-        _dref.Get(),
-        _dvec,
-        _crdsys,
-        _coord,
-        _relate,
-        _refval,
-        _adjust,
-        _step,
-        _nintvls,
-        &_cnfine,
-        &_result
-    );
-
-    // Pack up the output...
-    results.Empty();
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            GfEvent(FGfQuantity("COORDINATE").Param("TARGET", _target.Get()).Param("OBSERVER", _obsrvr.Get()).Param("ABCORR", _abcorr)
+                .Param("COORDINATE SYSTEM", _crdsys).Param("COORDINATE", _coord).Param("REFERENCE FRAME", _fixref.Get())
+                .Param("VECTOR DEFINITION", "SURFACE INTERCEPT POINT").Param("METHOD", _method).Param("DREF", _dref.Get()).Param("DVEC", _dvec),
+                _relate, _refval, _adjust, _step, _nintvls, _cnfine, _result);
+            return;
+        }
 
-    // Error Handling
+        gfsntc_c(
+            _target.Get(),
+            _fixref.Get(),
+            _method,
+            _abcorr,
+            _obsrvr.Get(),
+            _dref.Get(),
+            _dvec,
+            _crdsys,
+            _coord,
+            _relate,
+            _refval,
+            _adjust,
+            _step,
+            _nintvls,
+            _cnfine,
+            _result
+        );
+    });
+
+    // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
 }
 
@@ -4697,8 +4539,6 @@ void USpice::gftfov(
     const FString& obsrvr
     )
 {
-    const int MAXWIN = 200;
-
     // Inputs
     auto            _inst   = StringCast<ANSICHAR>(*inst);
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -4708,42 +4548,28 @@ void USpice::gftfov(
     auto            _obsrvr = StringCast<ANSICHAR>(*obsrvr);
     SpiceDouble     _step = step.AsSpiceDouble();
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-    for (auto It = cnfine.CreateConstIterator(); It; ++It)
-    {
-        wninsd_c((*It).start.AsSpiceDouble(), (*It).stop.AsSpiceDouble(), &_cnfine);
-    }
-
-    // Outputs
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
     // Invocation
-    gftfov_c(
-        _inst.Get(),
-        _target.Get(),
-        _tshape,
-        _tframe.Get(),
-        _abcorr,
-        _obsrvr.Get(),
-        _step,
-        &_cnfine,
-        &_result
-    );
-
-    // Pack output
-    results.Empty();
-
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            const SpiceDouble _raydir[3] = { 0., 0., 0. };
+            GfFieldOfView(_inst.Get(), _tshape, _raydir, _target.Get(), _tframe.Get(), _abcorr, _obsrvr.Get(), _step, _cnfine, _result);
+            return;
+        }
+
+        gftfov_c(
+            _inst.Get(),
+            _target.Get(),
+            _tshape,
+            _tframe.Get(),
+            _abcorr,
+            _obsrvr.Get(),
+            _step,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4759,6 +4585,11 @@ Exceptions
 void USpice::gfstol(double value)
 {
     gfstol_c((SpiceDouble)value);
+    if (!failed_c())
+    {
+        // For the mid-level searches (IsGfSearchControlled)
+        SetGfTolerance(value);
+    }
 
     // Error Handling
     UnexpectedErrorCheck(false);
@@ -4784,8 +4615,6 @@ void USpice::gfsubc(
     int nintvls
 )
 {
-    const int MAXWIN = 200;
-
     // Inputs
     auto            _target = StringCast<ANSICHAR>(*target);
     auto            _fixref = StringCast<ANSICHAR>(*fixref);
@@ -4800,48 +4629,36 @@ void USpice::gfsubc(
     SpiceDouble     _step = step.AsSpiceDouble();
     SpiceInt        _nintvls = (SpiceInt)nintvls;
 
-    SPICEDOUBLE_CELL(_cnfine, MAXWIN);
-    // Spice Cells are static.  They must reinitialized on every use or they
-    // may have data sticking around.
-    scard_c(0, &_cnfine);
-
-    for (auto It = cnfine.CreateConstIterator(); It; ++It)
-    {
-        wninsd_c((*It).start.AsSpiceDouble(), (*It).stop.AsSpiceDouble(), &_cnfine);
-    }
-
-    // Outputs
-    SPICEDOUBLE_CELL(_result, MAXWIN);
-    scard_c(0, &_result);
-
     // Invocation
-    gfsubc_c(
-        _target.Get(),
-        _fixref.Get(),
-        _method,
-        _abcorr,
-        _obsrvr.Get(),
-        _crdsys,
-        _coord,
-        _relate,
-        _refval,
-        _adjust,
-        _step,
-        _nintvls,
-        &_cnfine,
-        &_result
-    );
-
-    // Pack output
-    results.Empty();
-
-    int resultsCount = wncard_c(&_result);
-    for (int i = 0; i < resultsCount; ++i)
+    GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
     {
-        double et1, et2;
-        wnfetd_c(&_result, i, &et1, &et2);
-        results.Add(FSEphemerisTimeWindowSegment(et1, et2));
-    }
+        if (IsGfSearchControlled())
+        {
+            const SpiceDouble _dvec[3] = { 0., 0., 0. };
+            GfEvent(FGfQuantity("COORDINATE").Param("TARGET", _target.Get()).Param("OBSERVER", _obsrvr.Get()).Param("ABCORR", _abcorr)
+                .Param("COORDINATE SYSTEM", _crdsys).Param("COORDINATE", _coord).Param("REFERENCE FRAME", _fixref.Get())
+                .Param("VECTOR DEFINITION", "SUB-OBSERVER POINT").Param("METHOD", _method).Param("DREF", " ").Param("DVEC", _dvec),
+                _relate, _refval, _adjust, _step, _nintvls, _cnfine, _result);
+            return;
+        }
+
+        gfsubc_c(
+            _target.Get(),
+            _fixref.Get(),
+            _method,
+            _abcorr,
+            _obsrvr.Get(),
+            _crdsys,
+            _coord,
+            _relate,
+            _refval,
+            _adjust,
+            _step,
+            _nintvls,
+            _cnfine,
+            _result
+        );
+    });
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -4857,13 +4674,15 @@ void USpice::gipool(
     int             room
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt        _start = start;
     SpiceInt        _room = room;
     // Outputs
     SpiceInt        _n = 0;
     size_t buffer_size = _room * sizeof(SpiceInt);
-    SpiceInt* _ivals = (SpiceInt*)StackAlloc(buffer_size);
+    SpiceInt* _ivals = (SpiceInt*)Scratch.Alloc(buffer_size);
     SpiceBoolean    _found = SPICEFALSE;
 
     // invocation
@@ -4892,6 +4711,8 @@ void USpice::gnpool(
     int                 room
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt        _start = start;
     SpiceInt        _room = room;
@@ -4899,7 +4720,7 @@ void USpice::gnpool(
     // Outputs
     SpiceInt        _n = 0;
     size_t buffer_size = _lenout * _room * sizeof(SpiceChar);
-    void* _kvars = StackAlloc(buffer_size);
+    void* _kvars = Scratch.Alloc(buffer_size);
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
@@ -5353,11 +5174,7 @@ void USpice::tparse(
 
 void USpice::et_now(FSEphemerisTime& Now)
 {
-    auto now = FDateTime::UtcNow();
-    auto j2000 = FDateTime::FromJulianDay(2451545.0);
-    auto now_j2000 = now - j2000;
-
-    Now = FSEphemerisTime(now_j2000.GetTotalSeconds());
+    Now = MaxQ::Data::Now();
 }
 
 
@@ -5695,6 +5512,8 @@ void USpice::latsrf(
 
     )
 {
+    FScratchScope Scratch;
+
     // Input
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, shapeSurfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -5703,9 +5522,9 @@ void USpice::latsrf(
 
     // lonlat.GetData() would work if the ONLY data in the SLonLat structures are the members we declared.
     // But, even if that were to be true now, it may not always be.  So, we copy.
-    // Use heap mem not stack mem as this is an unbounded request for a lengthy operation
+    // Use scratch mem not stack mem as this is an unbounded request for a lengthy operation
     SpiceInt        _npts = lonlat.Num();
-    SpiceDouble     (*_lonlat)[2] = (SpiceDouble(*)[2]) new uint8[_npts * sizeof(SpiceDouble[2])];
+    SpiceDouble     (*_lonlat)[2] = (SpiceDouble(*)[2])Scratch.Alloc(_npts * sizeof(SpiceDouble[2]));
     for (int i = 0; i < _npts; ++i)
     {
         _lonlat[i][0] = lonlat[i].longitude.AsSpiceDouble();
@@ -5713,7 +5532,7 @@ void USpice::latsrf(
     }
 
     // Output
-    SpiceDouble     (*_srfpts)[3] = (SpiceDouble(*)[3]) new uint8[_npts * sizeof(SpiceDouble[3])];
+    SpiceDouble     (*_srfpts)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_npts * sizeof(SpiceDouble[3]));
     FMemory::Memset(_srfpts, 0, _npts * sizeof(SpiceDouble[3]));
 
     // Invocation
@@ -5728,15 +5547,12 @@ void USpice::latsrf(
     );
 
     // Copy output
-    srfpts.Init(FSDistanceVector::Zero, _npts);
+    ReuseOutput(srfpts, _npts);
     for (int i = 0; i < _npts; ++i)
     {
         srfpts[i] = FSDistanceVector(_srfpts[i][0], _srfpts[i][1], _srfpts[i][2]);
     }
 
-    delete[] _lonlat;
-    delete[] _srfpts;
-
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
 }
@@ -5766,6 +5582,8 @@ void USpice::limbpt(
     int maxn
     )
 {
+    FScratchScope Scratch;
+
     // Inputs
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, shapeSurfaces));
     auto            _target = StringCast<ANSICHAR>(*target);
@@ -5782,11 +5600,11 @@ void USpice::limbpt(
 
     // Outputs
     SpiceInt        _maxn = maxn;
-    // Use heap, not stack.  It's unbounded, it's a long operation, etc etc.
-    SpiceInt*       _npts = new SpiceInt[_ncuts];
-    SpiceDouble     (*_points)[3] = new SpiceDouble[maxn][3];
-    SpiceDouble*     _epochs = new SpiceDouble[maxn];
-    SpiceDouble     (*_tangts)[3] = new SpiceDouble[maxn][3];
+    // Use scratch, not stack.  It's unbounded, it's a long operation, etc etc.
+    SpiceInt*       _npts = (SpiceInt*)Scratch.Alloc(_ncuts * sizeof(SpiceInt));
+    SpiceDouble     (*_points)[3] = (SpiceDouble(*)[3])Scratch.Alloc(maxn * sizeof(SpiceDouble[3]));
+    SpiceDouble*     _epochs = (SpiceDouble*)Scratch.Alloc(maxn * sizeof(SpiceDouble));
+    SpiceDouble     (*_tangts)[3] = (SpiceDouble(*)[3])Scratch.Alloc(maxn * sizeof(SpiceDouble[3]));
 
     //SpiceDouble(*_srfpts)[3] = (SpiceDouble(*)[3]) new uint8[_npts * sizeof(SpiceDouble[3])];
 
@@ -5811,37 +5629,26 @@ void USpice::limbpt(
         _tangts
     );
 
-    // Bundle up output
+    // Bundle up output, into the caller's cuts (and their points), keeping
+    // their allocations.  Nothing was written if it failed.
+    const int cutCount = failed_c() ? 0 : FMath::Max(ncuts, 0);
+    ReuseOutput(cuts, cutCount);
     int pointIndex = 0;
-    for (int cut = 0; cut < ncuts; ++cut)
+    for (int cut = 0; cut < cutCount; ++cut)
     {
-        FSLimptCut cutrecord = FSLimptCut();
+        FSLimptCut& cutrecord = cuts[cut];
 
-        // How many poins are part of this cut?
-        int pointCount = _npts[cut];
+        // How many points are part of this cut?  (No more than were read.)
+        int pointCount = FMath::Clamp((int)_npts[cut], 0, maxn - pointIndex);
+        ReuseOutput(cutrecord.points, pointCount);
 
-        // Great!  Initialize the point array to the right # of points
-        cutrecord.points.Init(FSLimptPoint(), pointCount);
-        
-        // Add each point from the arrays of results...
         for (int point = 0; point < pointCount; ++point)
         {
-            // But only add if we haven't overflowed the read buffers.
-            if (pointIndex < maxn)
-            {
-                cutrecord.points[point] = FSLimptPoint(_points[pointIndex], _epochs[pointIndex], _tangts[pointIndex]);
-                pointIndex++;
-            }
+            cutrecord.points[point] = FSLimptPoint(_points[pointIndex], _epochs[pointIndex], _tangts[pointIndex]);
+            pointIndex++;
         }
-
-        cuts.Add(cutrecord);
     }
 
-    delete[] _npts;
-    delete[] _points;
-    delete[] _epochs;
-    delete[] _tangts;
-
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
 }
@@ -6108,12 +5915,14 @@ void USpice::hrmint(
     double& df
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt		_n = xvals.Num();
-    SpiceDouble* _xvals = (SpiceDouble*)StackAlloc(xvals.Num() * sizeof(SpiceDouble));
-    SpiceDouble* _yvals = (SpiceDouble*)StackAlloc(yvals.Num() * sizeof(SpiceDouble));
+    SpiceDouble* _xvals = (SpiceDouble*)Scratch.Alloc(xvals.Num() * sizeof(SpiceDouble));
+    SpiceDouble* _yvals = (SpiceDouble*)Scratch.Alloc(yvals.Num() * sizeof(SpiceDouble));
     SpiceDouble		_x = x;
-    SpiceDouble* _work = (SpiceDouble*)StackAlloc(4 * _n * sizeof(SpiceDouble));
+    SpiceDouble* _work = (SpiceDouble*)Scratch.Alloc(4 * _n * sizeof(SpiceDouble));
     for (int i = 0; i < xvals.Num(); i++) _xvals[i] = xvals[i];
     for (int i = 0; i < yvals.Num(); i++) _yvals[i] = yvals[i];
     // Outputs
@@ -6456,11 +6265,13 @@ void USpice::lgrind(
     double& dp
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt		_n = xvals.Num();
-    SpiceDouble* _xvals = (SpiceDouble*)StackAlloc(xvals.Num() * sizeof(SpiceDouble));
-    SpiceDouble* _yvals = (SpiceDouble*)StackAlloc(xvals.Num() * sizeof(SpiceDouble));
-    SpiceDouble* _work = (SpiceDouble*)StackAlloc(2 * xvals.Num() * sizeof(SpiceDouble));
+    SpiceDouble* _xvals = (SpiceDouble*)Scratch.Alloc(xvals.Num() * sizeof(SpiceDouble));
+    SpiceDouble* _yvals = (SpiceDouble*)Scratch.Alloc(xvals.Num() * sizeof(SpiceDouble));
+    SpiceDouble* _work = (SpiceDouble*)Scratch.Alloc(2 * xvals.Num() * sizeof(SpiceDouble));
     SpiceDouble		_x = x;
     for (int i = 0; i < xvals.Num(); i++) _xvals[i] = xvals[i];
     for (int i = 0; i < yvals.Num(); i++) _yvals[i] = yvals[i];
@@ -7260,6 +7071,8 @@ void USpice::pcpool_list(
     const TArray<FString>&  cvals
 )
 {
+    FScratchScope Scratch;
+
     int32 maxLen = 1;
     for (auto It = cvals.CreateConstIterator(); It; ++It)
     {
@@ -7270,7 +7083,7 @@ void USpice::pcpool_list(
     int count = cvals.Num();
     size_t string_size = maxLen * sizeof(SpiceChar);
     size_t buffer_size = count * string_size;
-    void* buffer = StackAlloc(buffer_size);
+    void* buffer = Scratch.Alloc(buffer_size);
     FMemory::Memset(buffer, 0, buffer_size);
 
     for (int i = 0; i < count; ++i)
@@ -7286,6 +7099,8 @@ void USpice::pcpool_list(
     const void*     _cvals = buffer;
 
     pcpool_c(TCHAR_TO_ANSI(*name), _n, _lenvals, _cvals);
+    BumpPoolGeneration();
+    MaxQ::Data::NotifyPoolWatchers();
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -7305,6 +7120,8 @@ void USpice::pcpool(
     auto        _cvals = StringCast<ANSICHAR>(*cval);
 
     pcpool_c(_name.Get(), _n, _lenvals, _cvals.Get());
+    BumpPoolGeneration();
+    MaxQ::Data::NotifyPoolWatchers();
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -7350,6 +7167,8 @@ void USpice::pdpool_list(
 
         // Invocation
         pdpool_c(TCHAR_TO_ANSI(*name), _n, _dvals);
+        BumpPoolGeneration();
+        MaxQ::Data::NotifyPoolWatchers();
     }
     else
     {
@@ -7379,6 +7198,8 @@ void USpice::pdpool(
 
     // Invocation
     pdpool_c(TCHAR_TO_ANSI(*name), _n, &_dval);
+    BumpPoolGeneration();
+    MaxQ::Data::NotifyPoolWatchers();
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -7539,6 +7360,8 @@ void USpice::pipool_list(
 
         // Invocation
         pipool_c(TCHAR_TO_ANSI(*name), _n, _ivals);
+        BumpPoolGeneration();
+        MaxQ::Data::NotifyPoolWatchers();
     }
     else
     {
@@ -7569,6 +7392,8 @@ void USpice::pipool(
 
     // Invocation
     pipool_c(TCHAR_TO_ANSI(*name), _n, &_ival);
+    BumpPoolGeneration();
+    MaxQ::Data::NotifyPoolWatchers();
 
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
@@ -7800,13 +7625,24 @@ void USpice::pxform(
     const FString& to
 )
 {
-    SpiceDouble _rotate[3][3]; rotate.CopyTo(_rotate);
+    FQueryMemoKey MemoKey;
+    const bool bMemo = MakeQueryMemoKey(EQueryMemo::Pxform, from, to, FString(), 0, et.seconds, MemoKey);
+    if (bMemo && FindMemoizedQuery(MemoKey, &rotate.AsSpiceDoubleArray()[0][0], 9))
+    {
+        ErrorCheck(ResultCode, ErrorMessage);
+        return;
+    }
+
     auto _from = StringCast<ANSICHAR>(*from);
     auto _to = StringCast<ANSICHAR>(*to);
-    pxform_c(_from.Get(), _to.Get(), et.seconds, _rotate);
-    rotate = FSRotationMatrix(_rotate);
+    MAXQ_FRAME_LOOKUP_SCOPE();
+    MAXQ_TRACE_SCOPE_TEXT(TEXT("pxform %s to %s"), *from, *to);
+    pxform_c(_from.Get(), _to.Get(), et.seconds, rotate.AsSpiceDoubleArray());
 
-    ErrorCheck(ResultCode, ErrorMessage);
+    if (!ErrorCheck(ResultCode, ErrorMessage) && bMemo)
+    {
+        MemoizeQuery(MemoKey, &rotate.AsSpiceDoubleArray()[0][0], 9);
+    }
 }
 
 void USpice::pxfrm2(
@@ -8838,12 +8674,14 @@ void USpice::shelld_ByIndex(
     TArray<int>& Order
 )
 {
+    FScratchScope Scratch;
+
     check(sizeof(double) == sizeof(SpiceDouble));
 
     SpiceInt ndim = DoubleArray.Num();
     
     // And a sorted clone...
-    SpiceDouble* sortedArray = (SpiceDouble*)StackAlloc(ndim * sizeof(SpiceDouble));
+    SpiceDouble* sortedArray = (SpiceDouble*)Scratch.Alloc(ndim * sizeof(SpiceDouble));
     FMemory::Memcpy(sortedArray, DoubleArray.GetData(), ndim * sizeof(SpiceDouble));
 
     shelld_c(ndim, sortedArray);
@@ -9232,6 +9070,7 @@ void USpice::spkcpo(
 
 
     // Invocation
+    MAXQ_SPK_LOOKUP_SCOPE();
     spkcpo_c(
         _target.Get(),
         _et,
@@ -9319,6 +9158,7 @@ void USpice::spkcpt(
 
 
     // Invocation
+    MAXQ_SPK_LOOKUP_SCOPE();
     spkcpt_c(
         _trgpos,
         _trgctr.Get(),
@@ -9407,6 +9247,7 @@ void USpice::spkcvo(
     SpiceDouble     _lt = 0;
 
     // Invocation
+    MAXQ_SPK_LOOKUP_SCOPE();
     spkcvo_c(
         _target.Get(),
         _et,
@@ -9496,6 +9337,7 @@ void USpice::spkcvt(
     SpiceDouble     _lt = lt.AsSpiceDouble();
 
     // Invocation
+    MAXQ_SPK_LOOKUP_SCOPE();
     spkcvt_c(
         _trgsta,
         _trgepc,
@@ -9594,8 +9436,17 @@ void USpice::spkezr(
     // #Note (USpice, in general)
     // Outputs, but initialize the values to whatever the caller passed in.
     // We want to return whatever spice returns.  But if Spice doesn't change the value, we don't want to, either
+    // (state is written in place, see AsSpiceDoubleArray)
     SpiceDouble _lt = lt.AsSpiceDouble();
-    SpiceDouble _state[6];  state.CopyTo(_state);
+
+    FQueryMemoKey MemoKey;
+    const bool bMemo = MakeQueryMemoKey(EQueryMemo::Spkezr, targ, obs, ref, (uint8)abcorr, et.seconds, MemoKey);
+    if (bMemo && FindMemoizedQuery(MemoKey, state.AsSpiceDoubleArray(), 6, &_lt))
+    {
+        ErrorCheck(ResultCode, ErrorMessage);
+        lt = FSEphemerisPeriod(_lt);
+        return;
+    }
 
     ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
 
@@ -9603,12 +9454,16 @@ void USpice::spkezr(
     auto _ref = StringCast<ANSICHAR>(*ref);
     auto _obs = StringCast<ANSICHAR>(*obs);
 
-    spkezr_c(_targ.Get(), et.seconds, _ref.Get(), _abcorr, _obs.Get(), _state, &_lt);
+    MAXQ_SPK_LOOKUP_SCOPE();
+    MAXQ_TRACE_SCOPE_TEXT(TEXT("spkezr %s wrt %s in %s"), *targ, *obs, *ref);
+    spkezr_c(_targ.Get(), et.seconds, _ref.Get(), _abcorr, _obs.Get(), state.AsSpiceDoubleArray(), &_lt);
 
-    ErrorCheck(ResultCode, ErrorMessage);
+    if (!ErrorCheck(ResultCode, ErrorMessage) && bMemo)
+    {
+        MemoizeQuery(MemoKey, state.AsSpiceDoubleArray(), 6, _lt);
+    }
 
     lt = FSEphemerisPeriod(_lt);
-    state = FSStateVector(_state);
 }
 
 
@@ -9631,13 +9486,12 @@ void USpice::spkgeo(
 )
 {
     SpiceDouble _lt = 0;
-    SpiceDouble _state[6];
-    ZeroOut(_state);
+    state = FSStateVector();
 
-    spkgeo_c(targ, et.seconds, TCHAR_TO_ANSI(*ref), obs, _state, &_lt);
+    MAXQ_SPK_LOOKUP_SCOPE();
+    spkgeo_c(targ, et.seconds, TCHAR_TO_ANSI(*ref), obs, state.AsSpiceDoubleArray(), &_lt);
 
     lt = FSEphemerisPeriod(_lt);
-    state = FSStateVector(_state);
 
     ErrorCheck(ResultCode, ErrorMessage);
 }
@@ -9661,13 +9515,12 @@ void USpice::spkgps(
 )
 {
     SpiceDouble _lt = 0;
-    SpiceDouble _pos[3];
-    ZeroOut(_pos);
+    pos = FSDistanceVector();
 
-    spkgps_c(targ, et.seconds, TCHAR_TO_ANSI(*ref), obs, _pos, &_lt);
+    MAXQ_SPK_LOOKUP_SCOPE();
+    spkgps_c(targ, et.seconds, TCHAR_TO_ANSI(*ref), obs, pos.AsSpiceDoubleArray(), &_lt);
 
     lt = FSEphemerisPeriod(_lt);
-    pos = FSDistanceVector(_pos);
 
     ErrorCheck(ResultCode, ErrorMessage);
 }
@@ -9703,8 +9556,16 @@ void USpice::spkpos(
 )
 {
     SpiceDouble _lt = lt.AsSpiceDouble();
-    SpiceDouble _ptarg[3];  ptarg.CopyTo(_ptarg);
-    ZeroOut(_ptarg);
+    ptarg = FSDistanceVector();
+
+    FQueryMemoKey MemoKey;
+    const bool bMemo = MakeQueryMemoKey(EQueryMemo::Spkpos, targ, obs, ref, (uint8)abcorr, et.seconds, MemoKey);
+    if (bMemo && FindMemoizedQuery(MemoKey, ptarg.AsSpiceDoubleArray(), 3, &_lt))
+    {
+        lt = FSEphemerisPeriod(_lt);
+        ErrorCheck(ResultCode, ErrorMessage);
+        return;
+    }
 
     ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
 
@@ -9712,15 +9573,223 @@ void USpice::spkpos(
     auto _ref = StringCast<ANSICHAR>(*ref);
     auto _obs = StringCast<ANSICHAR>(*obs);
 
-    spkpos_c(_targ.Get(), et.seconds, _ref.Get(), _abcorr, _obs.Get(), _ptarg, &_lt);
+    MAXQ_SPK_LOOKUP_SCOPE();
+    MAXQ_TRACE_SCOPE_TEXT(TEXT("spkpos %s wrt %s in %s"), *targ, *obs, *ref);
+    spkpos_c(_targ.Get(), et.seconds, _ref.Get(), _abcorr, _obs.Get(), ptarg.AsSpiceDoubleArray(), &_lt);
 
     lt = FSEphemerisPeriod(_lt);
-    ptarg = FSDistanceVector(_ptarg);
+
+    if (!ErrorCheck(ResultCode, ErrorMessage) && bMemo)
+    {
+        MemoizeQuery(MemoKey, ptarg.AsSpiceDoubleArray(), 3, _lt);
+    }
+}
+
+
+void USpice::spkezr_batch(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const TArray<FSEphemerisTime>& ets,
+    TArray<FSStateVector>& states,
+    TArray<FSEphemerisPeriod>& lts,
+    const FString& targ,
+    const FString& obs,
+    const FString& ref,
+    ES_AberrationCorrectionWithNewtonians abcorr
+)
+{
+    states.SetNum(ets.Num());
+    lts.SetNum(ets.Num());
+
+    // Once per batch, not once per epoch
+    ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+
+    auto _targ = StringCast<ANSICHAR>(*targ);
+    auto _ref = StringCast<ANSICHAR>(*ref);
+    auto _obs = StringCast<ANSICHAR>(*obs);
+
+    int32 i = 0;
+    for (; i < ets.Num(); ++i)
+    {
+        // Written in place.  On failure, entry i is dropped below.
+        MAXQ_SPK_LOOKUP_SCOPE();
+        spkezr_c(_targ.Get(), ets[i].seconds, _ref.Get(), _abcorr, _obs.Get(), states[i].AsSpiceDoubleArray(), &lts[i].seconds);
+
+        if (failed_c())
+        {
+            break;
+        }
+    }
+
+    // On failure, only return what was computed
+    states.SetNum(i);
+    lts.SetNum(i);
+
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
+
+void USpice::spkpos_batch(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const TArray<FSEphemerisTime>& ets,
+    TArray<FSDistanceVector>& ptargs,
+    TArray<FSEphemerisPeriod>& lts,
+    const FString& targ,
+    const FString& obs,
+    const FString& ref,
+    ES_AberrationCorrectionWithNewtonians abcorr
+)
+{
+    ptargs.SetNum(ets.Num());
+    lts.SetNum(ets.Num());
+
+    ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+
+    auto _targ = StringCast<ANSICHAR>(*targ);
+    auto _ref = StringCast<ANSICHAR>(*ref);
+    auto _obs = StringCast<ANSICHAR>(*obs);
+
+    int32 i = 0;
+    for (; i < ets.Num(); ++i)
+    {
+        MAXQ_SPK_LOOKUP_SCOPE();
+        spkpos_c(_targ.Get(), ets[i].seconds, _ref.Get(), _abcorr, _obs.Get(), ptargs[i].AsSpiceDoubleArray(), &lts[i].seconds);
+
+        if (failed_c())
+        {
+            break;
+        }
+    }
+
+    ptargs.SetNum(i);
+    lts.SetNum(i);
 
     ErrorCheck(ResultCode, ErrorMessage);
 }
 
 
+void USpice::spkezr_multi(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const FSEphemerisTime& et,
+    const TArray<FString>& targs,
+    TArray<FSStateVector>& states,
+    TArray<FSEphemerisPeriod>& lts,
+    const FString& obs,
+    const FString& ref,
+    ES_AberrationCorrectionWithNewtonians abcorr
+)
+{
+    states.SetNum(targs.Num());
+    lts.SetNum(targs.Num());
+
+    int32 Count = MaxQ::Ephemeris::SpkezrMulti(et, targs, states, lts, obs, ref, abcorr, &ResultCode, &ErrorMessage);
+
+    // On failure, only return what was computed
+    states.SetNum(Count);
+    lts.SetNum(Count);
+}
+
+
+void USpice::spkpos_multi(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const FSEphemerisTime& et,
+    const TArray<FString>& targs,
+    TArray<FSDistanceVector>& ptargs,
+    TArray<FSEphemerisPeriod>& lts,
+    const FString& obs,
+    const FString& ref,
+    ES_AberrationCorrectionWithNewtonians abcorr
+)
+{
+    ptargs.SetNum(targs.Num());
+    lts.SetNum(targs.Num());
+
+    int32 Count = MaxQ::Ephemeris::SpkposMulti(et, targs, ptargs, lts, obs, ref, abcorr, &ResultCode, &ErrorMessage);
+
+    ptargs.SetNum(Count);
+    lts.SetNum(Count);
+}
+
+
+void USpice::spk_compile_query(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    FSEphemerisQuery& query,
+    const FString& targ,
+    const FString& obs,
+    const FString& ref,
+    ES_AberrationCorrectionWithNewtonians abcorr
+)
+{
+    FSpiceQueryHandle Handle = FSpiceQueryHandle::Compile(targ, obs, ref, abcorr, &ResultCode, &ErrorMessage);
+
+    query = FSEphemerisQuery();
+    if (Handle.IsValid())
+    {
+        query.targ = Handle.GetTargetId();
+        query.obs = Handle.GetObserverId();
+        query.ref = Handle.GetFrame();
+        query.abcorr = Handle.GetAberrationCorrection();
+        query.Handle = MakeShared<const FSpiceQueryHandle>(MoveTemp(Handle));
+    }
+}
+
+
+static bool CheckQuery(const FSEphemerisQuery& query)
+{
+    if (!query.IsValid())
+    {
+        setmsg_c("The ephemeris query has not been compiled (see spk_compile_query).");
+        sigerr_c("SPICE(INVALIDQUERY)");
+    }
+
+    return query.IsValid();
+}
+
+
+void USpice::spkezr_query(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const FSEphemerisQuery& query,
+    const FSEphemerisTime& et,
+    FSStateVector& state,
+    FSEphemerisPeriod& lt
+)
+{
+    if (CheckQuery(query))
+    {
+        query.Handle->Spkezr(et, state, lt, &ResultCode, &ErrorMessage);
+    }
+    else
+    {
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+}
+
+
+void USpice::spkpos_query(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const FSEphemerisQuery& query,
+    const FSEphemerisTime& et,
+    FSDistanceVector& ptarg,
+    FSEphemerisPeriod& lt
+)
+{
+    if (CheckQuery(query))
+    {
+        query.Handle->Spkpos(et, ptarg, lt, &ResultCode, &ErrorMessage);
+    }
+    else
+    {
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+}
+
+
 /*
 Exceptions
    The parameter FTSIZE referenced below is defined in the header file
@@ -9930,6 +9999,8 @@ void USpice::spkw05(
     const TArray<FSPKType5Observation>& states
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     SpiceInt         _handle = handle;
     SpiceInt         _body = body;
@@ -9941,8 +10012,8 @@ void USpice::spkw05(
     SpiceDouble      _gm = gm.AsSpiceDouble();
     SpiceInt         _n = states.Num();
 
-    SpiceDouble(*_states)[6] = (SpiceDouble(*)[6])StackAlloc(_n * sizeof(SpiceDouble[6]));
-    SpiceDouble* _epochs = (SpiceDouble*)StackAlloc(_n * sizeof(SpiceDouble));
+    SpiceDouble(*_states)[6] = (SpiceDouble(*)[6])Scratch.Alloc(_n * sizeof(SpiceDouble[6]));
+    SpiceDouble* _epochs = (SpiceDouble*)Scratch.Alloc(_n * sizeof(SpiceDouble));
 
     for (int i = 0; i < states.Num(); ++i)
     {
@@ -9969,6 +10040,81 @@ void USpice::spkw05(
     ErrorCheck(ResultCode, ErrorMessage);
 }
 
+void USpice::spkw10(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    int handle,
+    int body,
+    int center,
+    const FString& frame,
+    const FSEphemerisTime& first,
+    const FSEphemerisTime& last,
+    const FString& segid,
+    const FSTLEGeophysicalConstants& consts,
+    const TArray<FSTwoLineElements>& elems
+)
+{
+    if (consts.geophs.Num() != 8)
+    {
+        setmsg_c("Expected 8 geophysical constants, got #");
+        errint_c("#", consts.geophs.Num());
+        sigerr_c("SPICE(BADARRAYSIZE)");
+        ErrorCheck(ResultCode, ErrorMessage);
+        return;
+    }
+
+    FScratchScope Scratch;
+
+    // Inputs
+    SpiceInt         _handle = handle;
+    SpiceInt         _body = body;
+    SpiceInt         _center = center;
+    auto             _frame = StringCast<ANSICHAR>(*frame);
+    SpiceDouble      _first = first.AsSpiceDouble();
+    SpiceDouble      _last = last.AsSpiceDouble();
+    auto             _segid = StringCast<ANSICHAR>(*segid);
+    SpiceDouble      _consts[8];
+    SpiceInt         _n = elems.Num();
+
+    FMemory::Memcpy(_consts, consts.geophs.GetData(), sizeof(_consts));
+
+    SpiceDouble(*_elems)[10] = (SpiceDouble(*)[10])Scratch.Alloc(_n * sizeof(SpiceDouble[10]));
+    SpiceDouble* _epochs = (SpiceDouble*)Scratch.Alloc(_n * sizeof(SpiceDouble));
+
+    for (int i = 0; i < elems.Num(); ++i)
+    {
+        if (elems[i].elems.Num() != 10)
+        {
+            setmsg_c("Element set # has # elements; expected 10");
+            errint_c("#", i);
+            errint_c("#", elems[i].elems.Num());
+            sigerr_c("SPICE(BADARRAYSIZE)");
+            ErrorCheck(ResultCode, ErrorMessage);
+            return;
+        }
+        FMemory::Memcpy(_elems[i], elems[i].elems.GetData(), sizeof(_elems[i]));
+        _epochs[i] = _elems[i][FSTwoLineElements::EPOCH];
+    }
+
+    // Invocation
+    spkw10_c(
+        _handle,
+        _body,
+        _center,
+        _frame.Get(),
+        _first,
+        _last,
+        _segid.Get(),
+        _consts,
+        _n,
+        (ConstSpiceDouble*)_elems,
+        _epochs
+    );
+
+    // Error handling
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
 void USpice::spkw15(
     ES_ResultCode& ResultCode,
     FString& ErrorMessage,
@@ -10183,6 +10329,8 @@ void USpice::srfnrm(
     const FString& fixref
     )
 {
+    FScratchScope Scratch;
+
     // Input
     auto        _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(method, shapeSurfaces));
     auto        _target = StringCast<ANSICHAR>(*target);
@@ -10190,10 +10338,10 @@ void USpice::srfnrm(
     auto        _fixref = StringCast<ANSICHAR>(*fixref);
     SpiceInt    _npts = srfpts.Num();
 
-    // Use the heap instead of a stack alloc... This is an unbounded memory request for a very lengthy operation.
+    // Use scratch memory instead of a stack alloc... This is an unbounded memory request for a very lengthy operation.
     // It would be better if we could avoid the intermediate buffers of course and just work the the array buffers
     // directly, but we can't control whether or not UE stuffs additional members/data in between the structs.
-    SpiceDouble(*_srfpts)[3] = (SpiceDouble(*)[3]) new uint8[_npts * sizeof(SpiceDouble[3])];
+    SpiceDouble(*_srfpts)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_npts * sizeof(SpiceDouble[3]));
     for (int i = 0; i < _npts; ++i)
     {
         _srfpts[i][0] = srfpts[i].x.AsSpiceDouble();
@@ -10202,7 +10350,7 @@ void USpice::srfnrm(
     }
 
     // Output
-    SpiceDouble(*_normls)[3] = (SpiceDouble(*)[3]) new uint8[_npts * sizeof(SpiceDouble[3])];
+    SpiceDouble(*_normls)[3] = (SpiceDouble(*)[3])Scratch.Alloc(_npts * sizeof(SpiceDouble[3]));
     FMemory::Memset(_normls, 0, _npts * sizeof(SpiceDouble[3]));
 
     // Invocation
@@ -10217,16 +10365,12 @@ void USpice::srfnrm(
     );
 
     // Copy output
-    normls.Init(FSDimensionlessVector::Zero, _npts);
+    ReuseOutput(normls, _npts);
     for (int i = 0; i < _npts; ++i)
     {
         normls[i] = FSDimensionlessVector(_normls[i][0], _normls[i][1], _normls[i][2]);
     }
 
-    // Go ahead and release the buffers instead of caching the workspaces.
-    delete[] _srfpts;
-    delete[] _normls;
-
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
 }
@@ -10329,6 +10473,160 @@ void USpice::srfscc(
     UnexpectedErrorCheck(true);
 }
 
+/*
+Exceptions
+
+   1)  If no star catalog has been loaded, an error is signaled by a
+       routine in the call tree of this routine.
+
+   2)  If the catalog query fails for any reason, the error
+       SPICE(QUERYFAILURE) is signaled.
+*/
+void USpice::stcf01(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const FString& catnam,
+    const FSAngle& westra,
+    const FSAngle& eastra,
+    const FSAngle& sthdec,
+    const FSAngle& nthdec,
+    int& nstars
+)
+{
+    // Inputs
+    auto        _catnam = StringCast<ANSICHAR>(*catnam);
+    doublereal  _westra = westra.AsSpiceDouble();
+    doublereal  _eastra = eastra.AsSpiceDouble();
+    doublereal  _sthdec = sthdec.AsSpiceDouble();
+    doublereal  _nthdec = nthdec.AsSpiceDouble();
+    // Outputs
+    integer     _nstars = 0;
+
+    // Invocation (no CSPICE wrapper)
+    stcf01_((char*)_catnam.Get(), &_westra, &_eastra, &_sthdec, &_nthdec, &_nstars, (ftnlen)_catnam.Length());
+
+    // Return Value
+    nstars = (int)_nstars;
+
+    // Error Handling
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
+
+/*
+Exceptions
+
+   1)  If the specified index is less than 0 (1, to stcg01_) or
+       greater than the number of stars found by the last stcf01, the
+       error SPICE(INVALIDINDEX) is signaled.
+
+   2)  If the star's data can't be fetched, the error
+       SPICE(BADSTARINDEX) is signaled.
+*/
+void USpice::stcg01(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    int index,
+    FSAngle& ra,
+    FSAngle& dec,
+    FSAngle& rasig,
+    FSAngle& decsig,
+    int& catnum,
+    FString& sptype,
+    double& vmag
+)
+{
+    // Inputs (Fortran counts from 1)
+    integer     _index = index + 1;
+    // Outputs
+    doublereal  _ra = 0., _dec = 0., _rasig = 0., _decsig = 0., _vmag = 0.;
+    integer     _catnum = 0;
+    ANSICHAR    _sptype[64];
+    FMemory::Memset(_sptype, ' ', sizeof(_sptype));
+
+    // Invocation
+    stcg01_(&_index, &_ra, &_dec, &_rasig, &_decsig, &_catnum, _sptype, &_vmag, (ftnlen)(sizeof(_sptype) - 1));
+    _sptype[sizeof(_sptype) - 1] = '\0';
+
+    // Return Values
+    ra = FSAngle(_ra);
+    dec = FSAngle(_dec);
+    rasig = FSAngle(_rasig);
+    decsig = FSAngle(_decsig);
+    catnum = (int)_catnum;
+    sptype = FString(ANSI_TO_TCHAR(_sptype)).TrimEnd();
+    vmag = _vmag;
+
+    // Error Handling
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
+
+/*
+Exceptions
+
+   1)  If the catalog isn't a type 1 star catalog, the error
+       SPICE(BADCATALOGFILE) is signaled.
+
+   2)  If the catalog can't be loaded, an error is signaled by a
+       routine in the call tree of this routine.
+*/
+void USpice::stcl01(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const FString& relativePath,
+    FString& tabnam,
+    int& handle
+)
+{
+    // Inputs
+    auto        _catfnm = StringCast<ANSICHAR>(*toPath(relativePath));
+    // Outputs
+    ANSICHAR    _tabnam[SPICE_EK_TSTRLN];
+    integer     _handle = 0;
+    FMemory::Memset(_tabnam, ' ', sizeof(_tabnam));
+
+    // Invocation
+    stcl01_((char*)_catfnm.Get(), _tabnam, &_handle, (ftnlen)_catfnm.Length(), (ftnlen)(sizeof(_tabnam) - 1));
+    _tabnam[sizeof(_tabnam) - 1] = '\0';
+
+    // Return Values
+    tabnam = FString(ANSI_TO_TCHAR(_tabnam)).TrimEnd();
+    handle = (int)_handle;
+
+    // Error Handling
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
+
+/*
+Exceptions
+
+   1)  If the velocity of the observer is greater than or equal
+       to the speed of light, the error SPICE(VALUEOUTOFRANGE)
+       is signaled.
+*/
+void USpice::stelab(
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage,
+    const FSDistanceVector& pobj,
+    const FSVelocityVector& vobs,
+    FSDistanceVector& appobj
+)
+{
+    // Output
+    SpiceDouble _appobj[3];
+
+    // Invocation
+    stelab_c(pobj.AsSpiceDoubleArray(), vobs.AsSpiceDoubleArray(), _appobj);
+
+    // Return Value
+    appobj = FSDistanceVector(_appobj);
+
+    // Error Handling
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
 
 /*
 Exceptions
@@ -10538,16 +10836,26 @@ void USpice::sxform(
     auto _from = StringCast<ANSICHAR>(*from);
     auto _to   = StringCast<ANSICHAR>(*to);
     SpiceDouble _et = et.AsSpiceDouble();
-    // Output
-    SpiceDouble _xform[6][6];  xform.CopyTo(_xform);
 
-    // Invocation
-    sxform_c(_from.Get(), _to.Get(), _et, _xform);
+    // Same frames, same ET, earlier this frame?
+    FQueryMemoKey MemoKey;
+    const bool bMemo = MakeQueryMemoKey(EQueryMemo::Sxform, from, to, FString(), 0, _et, MemoKey);
+    if (bMemo && FindMemoizedQuery(MemoKey, &xform.AsSpiceDoubleArray()[0][0], 36))
+    {
+        ErrorCheck(ResultCode, ErrorMessage);
+        return;
+    }
 
-    // Error Handling
-    ErrorCheck(ResultCode, ErrorMessage);
+    // Invocation (output written in place)
+    MAXQ_FRAME_LOOKUP_SCOPE();
+    MAXQ_TRACE_SCOPE_TEXT(TEXT("sxform %s to %s"), *from, *to);
+    sxform_c(_from.Get(), _to.Get(), _et, xform.AsSpiceDoubleArray());
 
-    xform = FSStateTransform(_xform);
+    // Error Handling
+    if (!ErrorCheck(ResultCode, ErrorMessage) && bMemo)
+    {
+        MemoizeQuery(MemoKey, &xform.AsSpiceDoubleArray()[0][0], 36);
+    }
 }
 
 
@@ -10579,6 +10887,8 @@ void USpice::termpt(
     int              maxn
 )
 {
+    FScratchScope Scratch;
+
     // Inputs
     auto            _method = StringCast<ANSICHAR>(*MaxQ::Core::ToString(shadow, curveType, method, shapeSurfaces));
     auto            _ilusrc = StringCast<ANSICHAR>(*ilusrc);
@@ -10586,7 +10896,7 @@ void USpice::termpt(
     SpiceDouble     _et = et.AsSpiceDouble();
     auto            _fixref = StringCast<ANSICHAR>(*fixref);
     ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
-    ConstSpiceChar* _corloc = MaxQ::Core::ToANSIString(abcorr);;
+    ConstSpiceChar* _corloc = MaxQ::Core::ToANSIString(corloc);
     auto            _obsrvr = StringCast<ANSICHAR>(*obsrvr);
     SpiceDouble     _refvec[3];  refvec.CopyTo(_refvec);
     SpiceDouble     _rolstp = rolstp.AsSpiceDouble();
@@ -10596,11 +10906,11 @@ void USpice::termpt(
     SpiceInt        _maxn = maxn;
 
     // Outputs
-    // Use heap, not stack.  It's unbounded, it's a long operation, etc etc.
-    SpiceInt* _npts = new SpiceInt[_ncuts];
-    SpiceDouble(*_points)[3] = new SpiceDouble[maxn][3];
-    SpiceDouble* _epochs = new SpiceDouble[maxn];
-    SpiceDouble(*_trmvcs)[3] = new SpiceDouble[maxn][3];
+    // Use scratch, not stack.  It's unbounded, it's a long operation, etc etc.
+    SpiceInt* _npts = (SpiceInt*)Scratch.Alloc(_ncuts * sizeof(SpiceInt));
+    SpiceDouble(*_points)[3] = (SpiceDouble(*)[3])Scratch.Alloc(maxn * sizeof(SpiceDouble[3]));
+    SpiceDouble* _epochs = (SpiceDouble*)Scratch.Alloc(maxn * sizeof(SpiceDouble));
+    SpiceDouble(*_trmvcs)[3] = (SpiceDouble(*)[3])Scratch.Alloc(maxn * sizeof(SpiceDouble[3]));
 
     // Invocation
     termpt_c(
@@ -10624,38 +10934,26 @@ void USpice::termpt(
         _trmvcs
     );
 
-    // Bundle up output
+    // Bundle up output, into the caller's cuts (and their points), keeping
+    // their allocations.  Nothing was written if it failed.
+    const int cutCount = failed_c() ? 0 : FMath::Max(ncuts, 0);
+    ReuseOutput(cuts, cutCount);
     int pointIndex = 0;
-    for (int cut = 0; cut < ncuts; ++cut)
+    for (int cut = 0; cut < cutCount; ++cut)
     {
-        FSTermptCut cutrecord = FSTermptCut();
+        FSTermptCut& cutrecord = cuts[cut];
 
-        // How many poins are part of this cut?
-        int pointCount = _npts[cut];
+        // How many points are part of this cut?  (No more than were read.)
+        int pointCount = FMath::Clamp((int)_npts[cut], 0, maxn - pointIndex);
+        ReuseOutput(cutrecord.points, pointCount);
 
-        // Great!  Initialize the point array to the right # of points
-        cutrecord.points.Init(FSTermptPoint(), pointCount);
-
-        // Add each point from the arrays of results...
         for (int point = 0; point < pointCount; ++point)
         {
-            // But only add if we haven't overflowed the read buffers.
-            if (pointIndex < maxn)
-            {
-                cutrecord.points[point] = FSTermptPoint(_points[pointIndex], _epochs[pointIndex], _trmvcs[pointIndex]);
-                pointIndex++;
-            }
+            cutrecord.points[point] = FSTermptPoint(_points[pointIndex], _epochs[pointIndex], _trmvcs[pointIndex]);
+            pointIndex++;
         }
-
-        cuts.Add(cutrecord);
     }
 
-
-    delete[] _npts;
-    delete[] _points;
-    delete[] _epochs;
-    delete[] _trmvcs;
-
     // Error Handling
     ErrorCheck(ResultCode, ErrorMessage);
 }
@@ -12111,7 +12409,18 @@ void USpice::furnsh_absolute(
     const FString& absolutePath
 )
 {
-    furnsh_c(TCHAR_TO_ANSI(*absolutePath));
+    FKernelLoadTiming Timing(absolutePath, false);
+    {
+        MAXQ_FURNSH_SCOPE();
+        MAXQ_TRACE_SCOPE_TEXT(TEXT("furnsh %s"), *Timing.Describe());
+        furnsh_c(TCHAR_TO_ANSI(*absolutePath));
+    }
+    Timing.Finish(!failed_c());
+
+    if (!failed_c())
+    {
+        RecordKernelOperation(MaxQ::Data::FKernelHistoryEntry::EOperation::Furnsh, absolutePath);
+    }
 }
 
 
@@ -0,0 +1,240 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceAttitudeBatch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Pointing-constrained attitudes for many objects at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceAttitudeBatch.cpp is part of the "refined C++ API".
+//
+// twovec's matrix is unique, so it's built directly:  the unit primary
+// axis, the third axis from a cross product with the secondary direction,
+// and the secondary axis from the other two.  Which order the cross
+// products go in depends on whether axisp follows axisa cyclically.
+//
+// The quaternion is m2q's (MaxQ::Private::M2q), then the Swizzle to UE.
+//------------------------------------------------------------------------------
+
+#include "SpiceAttitudeBatch.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    template<typename Fn>
+    void ForEachChunk(int32 Num, Fn&& Body)
+    {
+        const int32 NumChunks = (Num + ChunkSize - 1) / ChunkSize;
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            const int32 First = Chunk * ChunkSize;
+            Body(First, FMath::Min(First + ChunkSize, Num));
+        }, NumChunks <= 1);
+    }
+
+    // twovec's axis indices, 0 based
+    struct FAxes
+    {
+        int32 a = 0, p = 1, c = 2;
+        // axisp follows axisa (X->Y, Y->Z, Z->X)
+        bool bCyclic = true;
+
+        bool Set(ES_Axis axisa, ES_Axis axisp)
+        {
+            if (axisa == ES_Axis::NONE || axisp == ES_Axis::NONE || axisa == axisp)
+            {
+                return false;
+            }
+            a = (int32)axisa - 1;
+            p = (int32)axisp - 1;
+            c = 3 - a - p;
+            bCyclic = p == (a + 1) % 3;
+            return true;
+        }
+    };
+
+    // As m2q_c, then Swizzle
+    inline FQuat ToQuat(const double (&m)[3][3])
+    {
+        double q[4];
+        M2q(m, q);
+        return FQuat((FQuat::FReal)-q[2], (FQuat::FReal)-q[1], (FQuat::FReal)-q[3], (FQuat::FReal)q[0]);
+    }
+
+    // One element of TwoVec.  False if axdef and plndef are parallel (or
+    // either is zero).
+    inline bool TwoVecQuat(const FAxes& Axes, double ax, double ay, double az, double px, double py, double pz, FQuat& q)
+    {
+        const double la = sqrt(ax * ax + ay * ay + az * az);
+        if (la == 0.)
+        {
+            q = FQuat::Identity;
+            return false;
+        }
+        const double ua[3] = { ax / la, ay / la, az / la };
+
+        // The third axis:  ua x plndef, or plndef x ua
+        const double sense = Axes.bCyclic ? 1. : -1.;
+        double c[3] = {
+            sense * (ua[1] * pz - ua[2] * py),
+            sense * (ua[2] * px - ua[0] * pz),
+            sense * (ua[0] * py - ua[1] * px)
+        };
+        const double lc = sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+        if (lc == 0.)
+        {
+            q = FQuat::Identity;
+            return false;
+        }
+        c[0] /= lc; c[1] /= lc; c[2] /= lc;
+
+        // The secondary axis:  c x ua, or ua x c
+        const double up[3] = {
+            sense * (c[1] * ua[2] - c[2] * ua[1]),
+            sense * (c[2] * ua[0] - c[0] * ua[2]),
+            sense * (c[0] * ua[1] - c[1] * ua[0])
+        };
+
+        double m[3][3];
+        m[Axes.a][0] = ua[0]; m[Axes.a][1] = ua[1]; m[Axes.a][2] = ua[2];
+        m[Axes.p][0] = up[0]; m[Axes.p][1] = up[1]; m[Axes.p][2] = up[2];
+        m[Axes.c][0] = c[0]; m[Axes.c][1] = c[1]; m[Axes.c][2] = c[2];
+
+        q = ToQuat(m);
+        return true;
+    }
+
+    // Runs Element(i, q) over every index, and counts the degenerate ones
+    template<typename Fn>
+    int32 ForEachQuat(int32 Num, FQuat* Q, Fn&& Element)
+    {
+        std::atomic<int32> NumDegenerate{ 0 };
+
+        ForEachChunk(Num, [&](int32 First, int32 Last)
+        {
+            int32 Degenerate = 0;
+            for (int32 i = First; i < Last; ++i)
+            {
+                Degenerate += Element(i, Q[i]) ? 0 : 1;
+            }
+            NumDegenerate += Degenerate;
+        });
+
+        return NumDegenerate.load();
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    int32 TwoVec(
+        ES_Axis axisa,
+        const FConstVectorBatch& axdef,
+        ES_Axis axisp,
+        const FConstVectorBatch& plndef,
+        TArrayView<FQuat> q
+    )
+    {
+        FAxes Axes;
+        if (!Axes.Set(axisa, axisp))
+        {
+            return INDEX_NONE;
+        }
+
+        const int32 Num = axdef.Num();
+        check(plndef.Num() >= Num && q.Num() >= Num);
+
+        const double* AX = axdef.X.GetData(); const double* AY = axdef.Y.GetData(); const double* AZ = axdef.Z.GetData();
+        const double* PX = plndef.X.GetData(); const double* PY = plndef.Y.GetData(); const double* PZ = plndef.Z.GetData();
+
+        return ForEachQuat(Num, q.GetData(), [=](int32 i, FQuat& Out)
+        {
+            return TwoVecQuat(Axes, AX[i], AY[i], AZ[i], PX[i], PY[i], PZ[i], Out);
+        });
+    }
+
+
+    int32 NadirVelocity(
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        TArrayView<FQuat> q,
+        ES_Axis nadirAxis,
+        ES_Axis velocityAxis
+    )
+    {
+        FAxes Axes;
+        if (!Axes.Set(nadirAxis, velocityAxis))
+        {
+            return INDEX_NONE;
+        }
+
+        const int32 Num = r.Num();
+        check(v.Num() >= Num && q.Num() >= Num);
+
+        const double* RX = r.X.GetData(); const double* RY = r.Y.GetData(); const double* RZ = r.Z.GetData();
+        const double* VX = v.X.GetData(); const double* VY = v.Y.GetData(); const double* VZ = v.Z.GetData();
+
+        return ForEachQuat(Num, q.GetData(), [=](int32 i, FQuat& Out)
+        {
+            return TwoVecQuat(Axes, -RX[i], -RY[i], -RZ[i], VX[i], VY[i], VZ[i], Out);
+        });
+    }
+
+
+    int32 SunNadir(
+        const FConstVectorBatch& r,
+        const FSDistanceVector& sun,
+        TArrayView<FQuat> q,
+        ES_Axis sunAxis,
+        ES_Axis nadirAxis
+    )
+    {
+        FAxes Axes;
+        if (!Axes.Set(sunAxis, nadirAxis))
+        {
+            return INDEX_NONE;
+        }
+
+        const int32 Num = r.Num();
+        check(q.Num() >= Num);
+
+        const double* RX = r.X.GetData(); const double* RY = r.Y.GetData(); const double* RZ = r.Z.GetData();
+        const double sx = sun.x.km, sy = sun.y.km, sz = sun.z.km;
+
+        return ForEachQuat(Num, q.GetData(), [=](int32 i, FQuat& Out)
+        {
+            return TwoVecQuat(Axes, sx - RX[i], sy - RY[i], sz - RZ[i], -RX[i], -RY[i], -RZ[i], Out);
+        });
+    }
+
+
+    void InertialFixed(const FSRotationMatrix& m, TArrayView<FQuat> q)
+    {
+        double _m[3][3]; m.CopyTo(_m);
+        const FQuat Q = ToQuat(_m);
+
+        for (FQuat& Out : q)
+        {
+            Out = Q;
+        }
+    }
+}
@@ -0,0 +1,197 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceBenchmark.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Catalog scale benchmark scenarios, and what they measure.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceBenchmark.cpp is part of the "refined C++ API".
+//
+// SPICE time and calls are the differences in the running totals from one
+// sample to the next, summed over every family.  The JSON is written by hand
+// (flat objects of numbers and strings), rather than adding a Json module
+// dependency for it.
+//------------------------------------------------------------------------------
+
+#include "SpiceBenchmark.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/DateTime.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    constexpr double BytesPerMB = 1024. * 1024.;
+
+    double TotalSeconds(const MaxQ::Data::FSpiceCounters& Counters)
+    {
+        double Seconds = 0.;
+        for (double s : Counters.Seconds)
+        {
+            Seconds += s;
+        }
+        return Seconds;
+    }
+
+    uint64 TotalCalls(const MaxQ::Data::FSpiceCounters& Counters)
+    {
+        using namespace MaxQ::Data;
+        return Counters[ESpiceCounter::SpkLookups] + Counters[ESpiceCounter::FrameLookups] + Counters[ESpiceCounter::GfSearches] + Counters[ESpiceCounter::KernelLoads] + Counters[ESpiceCounter::Sgp4Evaluations];
+    }
+
+    // Nearest rank, of sorted values
+    double Percentile(const TArray<double>& Sorted, double p)
+    {
+        if (Sorted.Num() == 0)
+        {
+            return 0.;
+        }
+        const int32 Rank = FMath::Clamp(FMath::CeilToInt(p * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+        return Sorted[Rank];
+    }
+}
+
+
+FString FMaxQBenchmarkScenario::GetName() const
+{
+    if (!Name.IsEmpty())
+    {
+        return Name;
+    }
+
+    const TCHAR* Kind = Propagation == EMaxQPropagation::SGP4 ? TEXT("SGP4") : Propagation == EMaxQPropagation::TwoBody ? TEXT("TwoBody") : TEXT("SPK");
+    FString Result = FString::Printf(TEXT("%s_%d"), Kind, Objects);
+    if (bEclipse) Result += TEXT("_Eclipse");
+    if (bLabels) Result += TEXT("_Labels");
+    if (bOrbits) Result += TEXT("_Orbits");
+    return Result;
+}
+
+
+namespace MaxQ::Data
+{
+    void FBenchmarkRecorder::Begin()
+    {
+        Frames.Reset();
+        Last = GetSpiceCounters();
+    }
+
+
+    void FBenchmarkRecorder::Sample(double FrameSeconds, double GameThreadSeconds)
+    {
+        const FSpiceCounters Now = GetSpiceCounters();
+
+        FFrame& Frame = Frames.AddDefaulted_GetRef();
+        Frame.FrameSeconds = FrameSeconds;
+        Frame.GameThreadSeconds = GameThreadSeconds;
+        Frame.SpiceSeconds = FMath::Max(0., TotalSeconds(Now) - TotalSeconds(Last));
+        Frame.SpiceCalls = TotalCalls(Now) - FMath::Min(TotalCalls(Now), TotalCalls(Last));
+        Frame.UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+
+        Last = Now;
+    }
+
+
+    FMaxQBenchmarkSummary FBenchmarkRecorder::Summarize(const FMaxQBenchmarkScenario& Scenario) const
+    {
+        FMaxQBenchmarkSummary Summary;
+        Summary.Name = Scenario.GetName();
+        Summary.Objects = Scenario.Objects;
+        Summary.Frames = Frames.Num();
+        if (Frames.Num() == 0)
+        {
+            return Summary;
+        }
+
+        TArray<double> FrameMs;
+        FrameMs.Reserve(Frames.Num());
+        double GameThread = 0., Spice = 0., Calls = 0.;
+        uint64 Peak = 0;
+        for (const FFrame& Frame : Frames)
+        {
+            FrameMs.Add(Frame.FrameSeconds * 1.e3);
+            GameThread += Frame.GameThreadSeconds * 1.e3;
+            Spice += Frame.SpiceSeconds * 1.e3;
+            Calls += (double)Frame.SpiceCalls;
+            Peak = FMath::Max(Peak, Frame.UsedPhysical);
+        }
+
+        const double n = (double)Frames.Num();
+        double Total = 0.;
+        for (double ms : FrameMs)
+        {
+            Total += ms;
+        }
+        FrameMs.Sort();
+
+        Summary.FrameMean = Total / n;
+        Summary.FrameP50 = Percentile(FrameMs, 0.50);
+        Summary.FrameP95 = Percentile(FrameMs, 0.95);
+        Summary.FrameP99 = Percentile(FrameMs, 0.99);
+        Summary.FrameMax = FrameMs.Last();
+        Summary.GameThreadMean = GameThread / n;
+        Summary.SpiceMean = Spice / n;
+        Summary.SpiceCallsPerFrame = Calls / n;
+        Summary.PeakMemory = (double)Peak / BytesPerMB;
+        Summary.MemoryGrowth = ((double)Frames.Last().UsedPhysical - (double)Frames[0].UsedPhysical) / BytesPerMB;
+        return Summary;
+    }
+
+
+    bool FBenchmarkRecorder::WriteCsv(const FString& Path) const
+    {
+        TArray<FString> Lines;
+        Lines.Reserve(Frames.Num() + 1);
+        Lines.Add(TEXT("Frame,FrameMs,GameThreadMs,SpiceMs,SpiceCalls,UsedPhysicalMB"));
+        for (int32 i = 0; i < Frames.Num(); ++i)
+        {
+            const FFrame& Frame = Frames[i];
+            Lines.Add(FString::Printf(TEXT("%d,%.4f,%.4f,%.4f,%llu,%.2f"), i, Frame.FrameSeconds * 1.e3, Frame.GameThreadSeconds * 1.e3, Frame.SpiceSeconds * 1.e3, Frame.SpiceCalls, (double)Frame.UsedPhysical / BytesPerMB));
+        }
+        return FFileHelper::SaveStringArrayToFile(Lines, *Path);
+    }
+
+
+    bool FBenchmarkRecorder::WriteJson(const FString& Path, TArrayView<const FMaxQBenchmarkSummary> Summaries)
+    {
+        FString Json = TEXT("{\n");
+        Json += FString::Printf(TEXT("  \"engine\": \"%s\",\n"), *FEngineVersion::Current().ToString());
+        Json += FString::Printf(TEXT("  \"platform\": \"%s\",\n"), ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName()));
+        Json += FString::Printf(TEXT("  \"cpu\": \"%s\",\n"), *FPlatformMisc::GetCPUBrand().TrimStartAndEnd().ReplaceCharWithEscapedChar());
+        Json += FString::Printf(TEXT("  \"cores\": %d,\n"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+        Json += FString::Printf(TEXT("  \"date\": \"%s\",\n"), *FDateTime::UtcNow().ToIso8601());
+        Json += TEXT("  \"scenarios\": [\n");
+        for (int32 i = 0; i < Summaries.Num(); ++i)
+        {
+            const FMaxQBenchmarkSummary& s = Summaries[i];
+            Json += FString::Printf(
+                TEXT("    { \"name\": \"%s\", \"objects\": %d, \"frames\": %d, \"frame_ms_mean\": %.4f, \"frame_ms_p50\": %.4f, \"frame_ms_p95\": %.4f, \"frame_ms_p99\": %.4f, \"frame_ms_max\": %.4f, \"game_thread_ms_mean\": %.4f, \"spice_ms_mean\": %.4f, \"spice_calls_per_frame\": %.2f, \"peak_memory_mb\": %.2f, \"memory_growth_mb\": %.2f }%s\n"),
+                *s.Name.ReplaceCharWithEscapedChar(), s.Objects, s.Frames, s.FrameMean, s.FrameP50, s.FrameP95, s.FrameP99, s.FrameMax, s.GameThreadMean, s.SpiceMean, s.SpiceCallsPerFrame, s.PeakMemory, s.MemoryGrowth,
+                i + 1 < Summaries.Num() ? TEXT(",") : TEXT("")
+            );
+        }
+        Json += TEXT("  ]\n}\n");
+
+        return FFileHelper::SaveStringToFile(Json, *Path);
+    }
+
+
+    FString FBenchmarkRecorder::DefaultDirectory()
+    {
+        return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MaxQBenchmarks"));
+    }
+}
@@ -0,0 +1,361 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceBenchmarkActor.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Spawns a benchmark scenario into a map, and records it.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceBenchmarkActor.cpp is part of the "Blueprints API".
+//
+// The actor ticks in TG_PostUpdateWork, after the subsystem's pass and the
+// components it places, so the frame it records includes them.  Its own
+// per frame work (gathering label positions, eclipse states) is the work a
+// game would do for the same features, so it's part of the measurement.
+//
+// The population is random but seeded:  a low Earth orbit shell, 6700 to
+// 7500 km periapsis, eccentricity under 0.02, any inclination.  SGP4 gets the
+// same orbits as mean elements, so the scenarios are comparable.
+//------------------------------------------------------------------------------
+
+#include "SpiceBenchmarkActor.h"
+#include "SpiceCatalogComponent.h"
+#include "SpiceCatalogLabelsComponent.h"
+#include "SpiceOrbitPathComponent.h"
+#include "SpiceEclipseBatch.h"
+#include "SpiceSGP4.h"
+#include "SpiceData.h"
+#include "Spice.h"
+#include "Components/SceneComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Misc/App.h"
+
+namespace
+{
+    constexpr double EarthGM = 398600.4418;
+
+    // WGS-72, as the SGP4 unit tests use them
+    FSTLEGeophysicalConstants Wgs72()
+    {
+        double geophs[8] = { 1.082616e-3, -2.53881e-6, -1.65597e-6, 7.43669161e-2, 120.0, 78.0, 6378.135, 1.0 };
+        return FSTLEGeophysicalConstants(geophs);
+    }
+
+    FSConicElements RandomOrbit(FRandomStream& Random, const FSEphemerisTime& Epoch)
+    {
+        return FSConicElements(
+            FSDistance(Random.FRandRange(6700., 7500.)),
+            Random.FRandRange(0., 0.02),
+            FSAngle(FMath::DegreesToRadians(Random.FRandRange(0., 100.))),
+            FSAngle(FMath::DegreesToRadians(Random.FRandRange(0., 360.))),
+            FSAngle(FMath::DegreesToRadians(Random.FRandRange(0., 360.))),
+            FSAngle(FMath::DegreesToRadians(Random.FRandRange(0., 360.))),
+            Epoch,
+            FSMassConstant(EarthGM)
+        );
+    }
+
+    FSTwoLineElements MeanElements(const FSConicElements& Orbit)
+    {
+        const double a = Orbit.PerifocalDistance.km / (1. - Orbit.Eccentricity);
+
+        double elems[10] = {};
+        elems[FSTwoLineElements::XINCL] = Orbit.Inclination.AsRadians();
+        elems[FSTwoLineElements::XNODEO] = Orbit.LongitudeOfAscendingNode.AsRadians();
+        elems[FSTwoLineElements::EO] = Orbit.Eccentricity;
+        elems[FSTwoLineElements::OMEGAO] = Orbit.ArgumentOfPeriapse.AsRadians();
+        elems[FSTwoLineElements::XMO] = Orbit.MeanAnomalyAtEpoch.AsRadians();
+        // Radians per minute
+        elems[FSTwoLineElements::XNO] = FMath::Sqrt(EarthGM / (a * a * a)) * 60.;
+        elems[FSTwoLineElements::EPOCH] = Orbit.Epoch.AsSpiceDouble();
+        return FSTwoLineElements(elems);
+    }
+}
+
+
+AMaxQBenchmarkActor::AMaxQBenchmarkActor()
+{
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+    RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+
+void AMaxQBenchmarkActor::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (Kernels.Num() > 0)
+    {
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        if (!MaxQ::Data::Furnsh(Kernels, &ResultCode, &ErrorMessage))
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ Benchmark %s: %s"), *Scenario.GetName(), *ErrorMessage);
+        }
+    }
+
+    Populate();
+
+    Frame = 0;
+    bFinished = false;
+}
+
+
+void AMaxQBenchmarkActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UMaxQEphemerisSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr)
+    {
+        for (FMaxQEphemerisHandle& Handle : Handles)
+        {
+            Subsystem->Unregister(Handle);
+        }
+    }
+    Handles.Empty();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+void AMaxQBenchmarkActor::Populate()
+{
+    UWorld* World = GetWorld();
+    UMaxQEphemerisSubsystem* Subsystem = World ? World->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr;
+    if (Subsystem)
+    {
+        Subsystem->Epoch = Scenario.Epoch;
+        Subsystem->TimeScale = Scenario.TimeScale;
+        Subsystem->Scale = Scenario.Scale;
+    }
+
+    FRandomStream Random(Scenario.Seed);
+    const int32 Count = FMath::Max(0, Scenario.Objects);
+
+    TArray<FSConicElements> Orbits;
+    Orbits.Reserve(Count);
+    for (int32 i = 0; i < Count; ++i)
+    {
+        Orbits.Add(RandomOrbit(Random, Scenario.Epoch));
+    }
+
+    if (Scenario.Propagation == EMaxQPropagation::SGP4)
+    {
+        TArray<MaxQ::Orbits::FSGP4Propagator> Propagators;
+        Propagators.Reserve(Count);
+        const FSTLEGeophysicalConstants Constants = Wgs72();
+        for (const FSConicElements& Orbit : Orbits)
+        {
+            Propagators.Emplace(Constants, MeanElements(Orbit));
+        }
+
+        Catalog = NewObject<UMaxQCatalogComponent>(this, TEXT("Catalog"));
+        Catalog->SetupAttachment(RootComponent);
+        Catalog->Scale = Scenario.Scale;
+        Catalog->bShadows = Scenario.bEclipse;
+        Catalog->SetStaticMesh(Mesh ? Mesh.Get() : LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere")));
+        Catalog->RegisterComponent();
+        Catalog->SetPropagators(Propagators);
+    }
+    else if (Subsystem)
+    {
+        Handles.Reserve(Count);
+        Placed.Reserve(Scenario.bComponents ? Count : 0);
+        for (int32 i = 0; i < Count; ++i)
+        {
+            FMaxQEphemerisSubscription Subscription;
+            Subscription.Propagation = Scenario.Propagation;
+            Subscription.Frame = Scenario.Frame;
+            if (Scenario.Propagation == EMaxQPropagation::TwoBody)
+            {
+                Subscription.ConicElements = Orbits[i];
+            }
+            else
+            {
+                Subscription.Target = Scenario.SpkTargets.Num() > 0 ? Scenario.SpkTargets[i % Scenario.SpkTargets.Num()] : TEXT("MOON");
+                Subscription.Observer = Scenario.Observer;
+            }
+
+            USceneComponent* Component = nullptr;
+            if (Scenario.bComponents)
+            {
+                Component = NewObject<USceneComponent>(this);
+                Component->SetupAttachment(RootComponent);
+                Component->SetMobility(EComponentMobility::Movable);
+                Component->RegisterComponent();
+                Placed.Add(Component);
+            }
+
+            Handles.Add(Subsystem->Register(Subscription, Component, FMaxQEphemerisPlacement()));
+        }
+    }
+
+    if (Scenario.bLabels)
+    {
+        TArray<FString> Names;
+        TArray<float> Priorities;
+        Names.Reserve(Count);
+        Priorities.Reserve(Count);
+        for (int32 i = 0; i < Count; ++i)
+        {
+            Names.Add(FString::Printf(TEXT("OBJECT %05d"), i));
+            Priorities.Add(Random.FRand());
+        }
+
+        Labels = NewObject<UMaxQCatalogLabelsComponent>(this, TEXT("Labels"));
+        Labels->RegisterComponent();
+        Labels->SetLabels(Names, Priorities);
+        if (Catalog)
+        {
+            Labels->SetCatalog(Catalog);
+        }
+    }
+
+    if (Scenario.bOrbits)
+    {
+        const int32 NumOrbits = FMath::Min(Count, FMath::Max(0, Scenario.MaxOrbits));
+        for (int32 i = 0; i < NumOrbits; ++i)
+        {
+            UMaxQOrbitPathComponent* Path = NewObject<UMaxQOrbitPathComponent>(this);
+            Path->SetupAttachment(RootComponent);
+            Path->Frame = Scenario.Frame;
+            Path->Scale = Scenario.Scale;
+            if (Scenario.Propagation == EMaxQPropagation::Spk)
+            {
+                Path->Source = EMaxQOrbitPathSource::Trajectory;
+                Path->Target = Scenario.SpkTargets.Num() > 0 ? Scenario.SpkTargets[i % Scenario.SpkTargets.Num()] : TEXT("MOON");
+                Path->Observer = Scenario.Observer;
+                Path->Epoch = Scenario.Epoch;
+            }
+            else
+            {
+                Path->Source = EMaxQOrbitPathSource::ConicElements;
+                Path->Elements = Orbits[i];
+                Path->ElementsFrame = Scenario.Frame;
+            }
+            Path->RegisterComponent();
+        }
+    }
+}
+
+
+void AMaxQBenchmarkActor::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    UpdateEphemerisExtras();
+
+    if (!bExternalClock)
+    {
+        Record(FApp::GetDeltaTime(), FPlatformTime::ToSeconds(GGameThreadTime));
+    }
+}
+
+
+void AMaxQBenchmarkActor::UpdateEphemerisExtras()
+{
+    if (Handles.Num() == 0 || (!Labels && !Scenario.bEclipse))
+    {
+        return;
+    }
+
+    const UMaxQEphemerisSubsystem* Subsystem = GetWorld()->GetSubsystem<UMaxQEphemerisSubsystem>();
+    const FMaxQEphemerisSnapshotPtr Snapshot = Subsystem ? Subsystem->GetSnapshot() : nullptr;
+    if (!Snapshot.IsValid())
+    {
+        return;
+    }
+
+    if (Labels)
+    {
+        LabelPositions.SetNum(Handles.Num(), false);
+        LabelValid.SetNum(Handles.Num(), false);
+        for (int32 i = 0; i < Handles.Num(); ++i)
+        {
+            FSDistanceVector Position;
+            LabelValid[i] = Snapshot->GetPosition(Handles[i], Position) ? 1 : 0;
+            LabelPositions[i] = LabelValid[i] ? GetActorTransform().TransformPosition(Subsystem->ToWorld(Position)) : FVector::ZeroVector;
+        }
+        Labels->SetWorldPositions(LabelPositions, LabelValid);
+    }
+
+    if (Scenario.bEclipse)
+    {
+        MaxQ::Math::FEclipseGeometry Geometry;
+        if (MaxQ::Math::EclipseGeometry(Snapshot->Epoch, Geometry, Scenario.Frame))
+        {
+            Shadows.SetNum(Snapshot->Num(), false);
+            MaxQ::Math::EclipseStates(Geometry, Snapshot->Positions(), {}, Shadows);
+        }
+    }
+}
+
+
+void AMaxQBenchmarkActor::Record(double FrameSeconds, double GameThreadSeconds)
+{
+    if (bFinished)
+    {
+        return;
+    }
+
+    ++Frame;
+    if (Frame == Scenario.WarmupFrames + 1)
+    {
+        Recorder.Begin();
+    }
+    if (Frame <= Scenario.WarmupFrames)
+    {
+        return;
+    }
+
+    Recorder.Sample(FrameSeconds, GameThreadSeconds);
+    if (Recorder.Num() >= Scenario.Frames)
+    {
+        Finish();
+    }
+}
+
+
+void AMaxQBenchmarkActor::Finish()
+{
+    bFinished = true;
+    Summary = Recorder.Summarize(Scenario);
+
+    const FString Directory = OutputDirectory.IsEmpty() ? MaxQ::Data::FBenchmarkRecorder::DefaultDirectory() : OutputDirectory;
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*Directory);
+
+    const FString Name = Scenario.GetName();
+    const FString CsvPath = FPaths::Combine(Directory, Name + TEXT(".csv"));
+    const FString JsonPath = FPaths::Combine(Directory, Name + TEXT(".json"));
+    if (!Recorder.WriteCsv(CsvPath) || !MaxQ::Data::FBenchmarkRecorder::WriteJson(JsonPath, MakeArrayView(&Summary, 1)))
+    {
+        UE_LOG(LogSpice, Warning, TEXT("MaxQ Benchmark %s: could not write to %s"), *Name, *Directory);
+    }
+
+    UE_LOG(LogSpice, Display, TEXT("MaxQ Benchmark %s: %d frames, %.3f ms mean (p95 %.3f, p99 %.3f), game thread %.3f ms, SPICE %.3f ms, %.0f calls/frame, peak %.1f MB"),
+        *Name, Summary.Frames, Summary.FrameMean, Summary.FrameP95, Summary.FrameP99, Summary.GameThreadMean, Summary.SpiceMean, Summary.SpiceCallsPerFrame, Summary.PeakMemory);
+
+    OnFinished.Broadcast(Summary);
+
+    if (bQuitWhenDone || FParse::Param(FCommandLine::Get(), TEXT("MaxQBenchmarkQuit")))
+    {
+        FPlatformMisc::RequestExit(false);
+    }
+}
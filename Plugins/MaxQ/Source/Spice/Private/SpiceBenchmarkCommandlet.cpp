@@ -0,0 +1,181 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceBenchmarkCommandlet.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Runs a matrix of benchmark scenarios headless.
+//------------------------------------------------------------------------------
+
+#include "SpiceBenchmarkCommandlet.h"
+#include "SpiceBenchmarkActor.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+USpiceBenchmarkCommandlet::USpiceBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+
+static TArray<FString> ParseList(const FString& Params, const TCHAR* Name, const TCHAR* Default)
+{
+    FString Value = Default;
+    FParse::Value(*Params, Name, Value, false);
+
+    TArray<FString> Tokens;
+    Value.ParseIntoArray(Tokens, TEXT(","));
+    for (FString& Token : Tokens)
+    {
+        Token.TrimStartAndEndInline();
+    }
+    return Tokens;
+}
+
+
+int32 USpiceBenchmarkCommandlet::Main(const FString& Params)
+{
+    MaxQ::Core::InitAll();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FString Kernels;
+    if (FParse::Value(*Params, TEXT("Kernels="), Kernels, false))
+    {
+        TArray<FString> KernelPaths;
+        Kernels.ParseIntoArray(KernelPaths, TEXT("+"));
+        if (!MaxQ::Data::Furnsh(KernelPaths, &ResultCode, &ErrorMessage))
+        {
+            UE_LOG(LogSpice, Error, TEXT("MaxQ Benchmark: %s"), *ErrorMessage);
+            return 1;
+        }
+    }
+
+    FMaxQBenchmarkScenario Base;
+    Base.bEclipse = FParse::Param(*Params, TEXT("Eclipse"));
+    Base.bLabels = FParse::Param(*Params, TEXT("Labels"));
+    Base.bOrbits = FParse::Param(*Params, TEXT("Orbits"));
+    FParse::Value(*Params, TEXT("Frames="), Base.Frames);
+    FParse::Value(*Params, TEXT("Warmup="), Base.WarmupFrames);
+    FParse::Value(*Params, TEXT("TimeScale="), Base.TimeScale);
+
+    FString Epoch;
+    if (FParse::Value(*Params, TEXT("Epoch="), Epoch, false))
+    {
+        double et = 0.;
+        str2et_c(TCHAR_TO_ANSI(*Epoch), &et);
+        if (ErrorCheck(&ResultCode, &ErrorMessage))
+        {
+            UE_LOG(LogSpice, Error, TEXT("MaxQ Benchmark: could not parse -Epoch=%s (%s)"), *Epoch, *ErrorMessage);
+            return 1;
+        }
+        Base.Epoch = FSEphemerisTime(et);
+    }
+
+    float DeltaTime = 1.f / 60.f;
+    FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+
+    FString Out = MaxQ::Data::FBenchmarkRecorder::DefaultDirectory();
+    FParse::Value(*Params, TEXT("Out="), Out, false);
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*Out);
+
+    // The matrix
+    TArray<FMaxQBenchmarkScenario> Scenarios;
+    for (const FString& Propagation : ParseList(Params, TEXT("Propagation="), TEXT("SGP4,TwoBody,Spk")))
+    {
+        FMaxQBenchmarkScenario Scenario = Base;
+        if (Propagation.Equals(TEXT("SGP4"), ESearchCase::IgnoreCase))
+        {
+            Scenario.Propagation = EMaxQPropagation::SGP4;
+        }
+        else if (Propagation.Equals(TEXT("TwoBody"), ESearchCase::IgnoreCase))
+        {
+            Scenario.Propagation = EMaxQPropagation::TwoBody;
+        }
+        else if (Propagation.Equals(TEXT("Spk"), ESearchCase::IgnoreCase))
+        {
+            Scenario.Propagation = EMaxQPropagation::Spk;
+        }
+        else
+        {
+            UE_LOG(LogSpice, Error, TEXT("MaxQ Benchmark: unknown propagation %s"), *Propagation);
+            return 1;
+        }
+
+        for (const FString& Count : ParseList(Params, TEXT("Counts="), TEXT("1000,10000,100000")))
+        {
+            Scenario.Objects = FCString::Atoi(*Count);
+            Scenarios.Add(Scenario);
+        }
+    }
+
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("MaxQBenchmark"));
+    FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+    Context.SetCurrentWorld(World);
+    World->InitializeActorsForPlay(FURL());
+    World->BeginPlay();
+
+    TArray<FMaxQBenchmarkSummary> Summaries;
+    for (const FMaxQBenchmarkScenario& Scenario : Scenarios)
+    {
+        UE_LOG(LogSpice, Display, TEXT("MaxQ Benchmark: %s"), *Scenario.GetName());
+
+        AMaxQBenchmarkActor* Actor = World->SpawnActorDeferred<AMaxQBenchmarkActor>(AMaxQBenchmarkActor::StaticClass(), FTransform::Identity);
+        Actor->Scenario = Scenario;
+        Actor->OutputDirectory = Out;
+        Actor->bExternalClock = true;
+        Actor->FinishSpawning(FTransform::Identity);
+
+        while (!Actor->IsFinished())
+        {
+            const double Start = FPlatformTime::Seconds();
+            World->Tick(LEVELTICK_All, DeltaTime);
+            ++GFrameCounter;
+            const double Seconds = FPlatformTime::Seconds() - Start;
+
+            Actor->Record(Seconds, Seconds);
+        }
+
+        Summaries.Add(Actor->GetSummary());
+        Actor->Destroy();
+        CollectGarbage(RF_NoFlags);
+    }
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+
+    const FString Path = FPaths::Combine(Out, TEXT("MaxQBenchmark.json"));
+    if (!MaxQ::Data::FBenchmarkRecorder::WriteJson(Path, Summaries))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ Benchmark: could not write %s"), *Path);
+        return 1;
+    }
+    UE_LOG(LogSpice, Display, TEXT("MaxQ Benchmark: %d scenarios written to %s"), Summaries.Num(), *Out);
+
+    return 0;
+}
@@ -0,0 +1,41 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceBenchmarkCommandlet.h
+//
+// Private API Comments
+//
+// Purpose:  Runs a matrix of benchmark scenarios headless.
+//    <exe> [project] -run=SpiceBenchmark -Kernels=<a>+<b>+...
+//        [-Counts=1000,10000,100000] [-Propagation=SGP4,TwoBody,Spk]
+//        [-Eclipse] [-Labels] [-Orbits] [-Frames=600] [-Warmup=60]
+//        [-DeltaTime=0.016667] [-TimeScale=60] [-Epoch=<time>] [-Out=<dir>]
+// Every count with every propagation is one scenario, with the extras given.
+// Each is spawned (an AMaxQBenchmarkActor) into a game world of its own
+// making, which is ticked at DeltaTime:  the frame time is the world tick's
+// wall clock time, with no rendering (so labels cost their setup, not their
+// drawing).  Writes each scenario's CSV and JSON, and MaxQBenchmark.json
+// with every summary, to Out (default Saved/MaxQBenchmarks).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SpiceBenchmarkCommandlet.generated.h"
+
+UCLASS()
+class USpiceBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    USpiceBenchmarkCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,429 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceBodyOrientation.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Native evaluation of text PCK body orientation (IAU_ frames).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceBodyOrientation.cpp is part of the "refined C++ API".
+//
+// Follows tisbod_c:  the reference frame and epoch of the constants, and the
+// nutation/precession angles, belong to the system barycenter for planets
+// and satellites (body / 100 for 100..999), and to the body itself
+// otherwise.  The Euler angles are (W, pi/2 - DEC, pi/2 + RA) about
+// (3, 1, 3).
+//
+// eul2m_c/eul2xf_c use CSPICE's (unsynchronized) trace stack, so the matrix
+// and its derivative are expanded here.
+//------------------------------------------------------------------------------
+
+#include "SpiceBodyOrientation.h"
+#include "SpiceUtilities.h"
+#include "Misc/ScopeLock.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double SecondsPerDay = 86400.;
+    constexpr double SecondsPerCentury = 36525. * SecondsPerDay;
+    constexpr double J2000JulianDate = 2451545.;
+    constexpr double RadiansPerDegree = UE_DOUBLE_PI / 180.;
+    constexpr double HalfPi = UE_DOUBLE_PI / 2.;
+
+    FCriticalSection OrientationLock;
+
+    TMap<int32, TSharedRef<const MaxQ::Frames::FPckOrientation, ESPMode::ThreadSafe>>& Orientations()
+    {
+        static TMap<int32, TSharedRef<const MaxQ::Frames::FPckOrientation, ESPMode::ThreadSafe>> Models;
+        return Models;
+    }
+
+    // As zzbodbry
+    int32 SystemOf(int32 Body)
+    {
+        return Body >= 100 && Body <= 999 ? Body / 100 : Body;
+    }
+
+    // Does a loaded binary PCK have data for frame class ID Body?
+    bool InBinaryPck(int32 Body)
+    {
+        constexpr SpiceInt FILLEN = 1024;
+        constexpr SpiceInt TYPLEN = 33;
+        constexpr SpiceInt SRCLEN = 1024;
+        constexpr SpiceInt MAXIDS = 1000;
+        SPICEINT_CELL(_ids, MAXIDS);
+
+        SpiceInt _count = 0;
+        ktotal_c("PCK", &_count);
+        for (SpiceInt i = 0; i < _count && !failed_c(); ++i)
+        {
+            SpiceChar _file[FILLEN];
+            SpiceChar _filtyp[TYPLEN];
+            SpiceChar _srcfil[SRCLEN];
+            SpiceInt _handle = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            kdata_c(i, "PCK", FILLEN, TYPLEN, SRCLEN, _file, _filtyp, _srcfil, &_handle, &_found);
+            if (!_found)
+            {
+                continue;
+            }
+
+            scard_c(0, &_ids);
+            pckfrm_c(_file, &_ids);
+            if (!failed_c() && elemi_c(Body, &_ids))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Rows of M = [W]3 [Delta]1 [Phi]3
+    void EulerToMatrix(double W, double Delta, double Phi, double (&m)[3][3])
+    {
+        const double cw = FMath::Cos(W), sw = FMath::Sin(W);
+        const double cd = FMath::Cos(Delta), sd = FMath::Sin(Delta);
+        const double cp = FMath::Cos(Phi), sp = FMath::Sin(Phi);
+
+        m[0][0] = cw * cp - sw * cd * sp;
+        m[0][1] = cw * sp + sw * cd * cp;
+        m[0][2] = sw * sd;
+        m[1][0] = -sw * cp - cw * cd * sp;
+        m[1][1] = -sw * sp + cw * cd * cp;
+        m[1][2] = cw * sd;
+        m[2][0] = sd * sp;
+        m[2][1] = -sd * cp;
+        m[2][2] = cd;
+    }
+
+    // M and dM/dt
+    void EulerToTransform(double W, double Delta, double Phi, double dW, double dDelta, double dPhi, double (&m)[3][3], double (&dm)[3][3])
+    {
+        EulerToMatrix(W, Delta, Phi, m);
+
+        const double cw = FMath::Cos(W), sw = FMath::Sin(W);
+        const double cd = FMath::Cos(Delta), sd = FMath::Sin(Delta);
+        const double cp = FMath::Cos(Phi), sp = FMath::Sin(Phi);
+
+        // [Delta]1 [Phi]3's rows, and their derivatives by Phi
+        const double r1[3] = { -cd * sp, cd * cp, sd };
+        const double r2[3] = { sd * sp, -sd * cp, cd };
+        const double p0[3] = { -sp, cp, 0. };
+        const double p1[3] = { -cd * cp, -cd * sp, 0. };
+        const double p2[3] = { sd * cp, sd * sp, 0. };
+
+        for (int32 j = 0; j < 3; ++j)
+        {
+            // By W, by Delta, by Phi
+            dm[0][j] = m[1][j] * dW + sw * r2[j] * dDelta + (cw * p0[j] + sw * p1[j]) * dPhi;
+            dm[1][j] = -m[0][j] * dW + cw * r2[j] * dDelta + (-sw * p0[j] + cw * p1[j]) * dPhi;
+            dm[2][j] = -r1[j] * dDelta + p2[j] * dPhi;
+        }
+    }
+
+    void Multiply(const double (&a)[3][3], const double (&b)[3][3], double (&ab)[3][3])
+    {
+        double t[3][3];
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                t[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+            }
+        }
+        FMemory::Memcpy(ab, t, sizeof(t));
+    }
+}
+
+namespace MaxQ::Frames
+{
+    TSharedRef<const FPckOrientation, ESPMode::ThreadSafe> FPckOrientation::FromKernelPool(int32 Body, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        TSharedRef<FPckOrientation, ESPMode::ThreadSafe> Model = MakeShared<FPckOrientation, ESPMode::ThreadSafe>();
+        Model->Body = Body;
+        Model->PoolGeneration = MaxQ::Private::PoolGeneration();
+
+        ANSICHAR Name[64];
+        auto Read = [&Name](int32 Id, const ANSICHAR* Variable, TArray<double>& Values, bool bRequired)
+        {
+            FCStringAnsi::Snprintf(Name, sizeof(Name), "BODY%d_%s", Id, Variable);
+
+            SpiceBoolean found = SPICEFALSE;
+            SpiceInt n = 0;
+            SpiceChar type = 0;
+            dtpool_c(Name, &found, &n, &type);
+            if (found && type == 'N' && n > 0)
+            {
+                Values.SetNumUninitialized(n);
+                gdpool_c(Name, 0, n, &n, Values.GetData(), &found);
+                return found && !failed_c();
+            }
+
+            if (bRequired && !failed_c())
+            {
+                setmsg_c("PCK kernel variable # is missing or isn't numeric.");
+                errch_c("#", Name);
+                sigerr_c("SPICE(FRAMEDATANOTFOUND)");
+            }
+            return false;
+        };
+
+        const int32 System = SystemOf(Body);
+        TArray<double> Ra, Dec, Pm, RefFrame, JedEpoch, MaxPhaseDegree;
+
+        // Not an error:  CSPICE has it, but there's nothing to read
+        if (InBinaryPck(Body))
+        {
+            ErrorCheck(ResultCode, ErrorMessage);
+            return Model;
+        }
+
+        bool bOk = !failed_c()
+            && Read(Body, "POLE_RA", Ra, true)
+            && Read(Body, "POLE_DEC", Dec, true)
+            && Read(Body, "PM", Pm, true);
+
+        if (bOk && (Ra.Num() > 3 || Dec.Num() > 3 || Pm.Num() > 3))
+        {
+            setmsg_c("Body # has orientation polynomials of more than 3 terms.");
+            errint_c("#", Body);
+            sigerr_c("SPICE(INVALIDCOUNT)");
+            bOk = false;
+        }
+
+        if (bOk)
+        {
+            for (int32 i = 0; i < 3; ++i)
+            {
+                Model->RaCoefficients[i] = Ra.IsValidIndex(i) ? Ra[i] : 0.;
+                Model->DecCoefficients[i] = Dec.IsValidIndex(i) ? Dec[i] : 0.;
+                Model->PmCoefficients[i] = Pm.IsValidIndex(i) ? Pm[i] : 0.;
+            }
+
+            if (Read(System, "MAX_PHASE_DEGREE", MaxPhaseDegree, false))
+            {
+                Model->PhaseDegree = (int32)MaxPhaseDegree[0];
+            }
+
+            Read(Body, "NUT_PREC_RA", Model->RaAmplitudes, false);
+            Read(Body, "NUT_PREC_DEC", Model->DecAmplitudes, false);
+            Read(Body, "NUT_PREC_PM", Model->PmAmplitudes, false);
+
+            const int32 MaxTerms = FMath::Max3(Model->RaAmplitudes.Num(), Model->DecAmplitudes.Num(), Model->PmAmplitudes.Num());
+            if (MaxTerms > 0)
+            {
+                Read(System, "NUT_PREC_ANGLES", Model->Phases, true);
+
+                const int32 Stride = Model->PhaseDegree + 1;
+                if (!failed_c() && (Model->PhaseDegree < 1 || Model->Phases.Num() < MaxTerms * Stride))
+                {
+                    setmsg_c("Body # has # nutation/precession terms, but there are only # angles of degree #.");
+                    errint_c("#", Body);
+                    errint_c("#", MaxTerms);
+                    errint_c("#", Model->Phases.Num() / FMath::Max(Stride, 1));
+                    errint_c("#", Model->PhaseDegree);
+                    sigerr_c("SPICE(INSUFFICIENTANGLES)");
+                }
+
+                // Only the angles something uses
+                Model->Phases.SetNum(FMath::Min(Model->Phases.Num(), MaxTerms * Stride));
+                Model->RaAmplitudes.SetNumZeroed(MaxTerms);
+                Model->DecAmplitudes.SetNumZeroed(MaxTerms);
+                Model->PmAmplitudes.SetNumZeroed(MaxTerms);
+            }
+
+            if (Read(System, "CONSTANTS_JED_EPOCH", JedEpoch, false))
+            {
+                Model->Epoch = (JedEpoch[0] - J2000JulianDate) * SecondsPerDay;
+            }
+
+            if (Read(System, "CONSTANTS_REF_FRAME", RefFrame, false) && (int32)RefFrame[0] != 1)
+            {
+                SpiceChar _ref[64];
+                frmnam_c((SpiceInt)RefFrame[0], sizeof(_ref), _ref);
+                if (!failed_c() && !_ref[0])
+                {
+                    setmsg_c("Body # constants are in unknown inertial frame #.");
+                    errint_c("#", Body);
+                    errdp_c("#", RefFrame[0]);
+                    sigerr_c("SPICE(INVALIDFRAMEDEF)");
+                }
+                if (!failed_c())
+                {
+                    pxform_c("J2000", _ref, 0., Model->ToReference);
+                    Model->bRotated = true;
+                }
+            }
+
+            Model->bValid = !failed_c();
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+
+        return Model;
+    }
+
+
+    void FPckOrientation::Angles(double et, double& Ra, double& Dec, double& W) const
+    {
+        double dRa, dDec, dW;
+        Angles(et, Ra, Dec, W, dRa, dDec, dW);
+    }
+
+
+    void FPckOrientation::Angles(double et, double& Ra, double& Dec, double& W, double& dRa, double& dDec, double& dW) const
+    {
+        const double d = (et - Epoch) / SecondsPerDay;
+        const double T = d / 36525.;
+
+        // Degrees, and degrees per second
+        Ra = RaCoefficients[0] + T * (RaCoefficients[1] + T * RaCoefficients[2]);
+        Dec = DecCoefficients[0] + T * (DecCoefficients[1] + T * DecCoefficients[2]);
+        W = PmCoefficients[0] + d * (PmCoefficients[1] + d * PmCoefficients[2]);
+
+        dRa = (RaCoefficients[1] + 2. * T * RaCoefficients[2]) / SecondsPerCentury;
+        dDec = (DecCoefficients[1] + 2. * T * DecCoefficients[2]) / SecondsPerCentury;
+        dW = (PmCoefficients[1] + 2. * d * PmCoefficients[2]) / SecondsPerDay;
+
+        const int32 Stride = PhaseDegree + 1;
+        for (int32 i = 0; i < RaAmplitudes.Num(); ++i)
+        {
+            const double* Phase = &Phases[i * Stride];
+
+            // theta (radians) and dtheta/dt (radians per second)
+            double Theta = 0., dTheta = 0.;
+            for (int32 j = PhaseDegree; j >= 0; --j)
+            {
+                Theta = Theta * T + Phase[j];
+                if (j > 0)
+                {
+                    dTheta = dTheta * T + j * Phase[j];
+                }
+            }
+            Theta *= RadiansPerDegree;
+            dTheta *= RadiansPerDegree / SecondsPerCentury;
+
+            const double s = FMath::Sin(Theta), c = FMath::Cos(Theta);
+            Ra += RaAmplitudes[i] * s;
+            Dec += DecAmplitudes[i] * c;
+            W += PmAmplitudes[i] * s;
+            dRa += RaAmplitudes[i] * c * dTheta;
+            dDec -= DecAmplitudes[i] * s * dTheta;
+            dW += PmAmplitudes[i] * c * dTheta;
+        }
+
+        W = FMath::Fmod(W, 360.);
+
+        Ra *= RadiansPerDegree;
+        Dec *= RadiansPerDegree;
+        W *= RadiansPerDegree;
+        dRa *= RadiansPerDegree;
+        dDec *= RadiansPerDegree;
+        dW *= RadiansPerDegree;
+    }
+
+
+    void FPckOrientation::Rotation(double et, double (&tipm)[3][3]) const
+    {
+        double Ra, Dec, W;
+        Angles(et, Ra, Dec, W);
+        EulerToMatrix(W, HalfPi - Dec, HalfPi + Ra, tipm);
+
+        if (bRotated)
+        {
+            Multiply(tipm, ToReference, tipm);
+        }
+    }
+
+
+    void FPckOrientation::StateTransform(double et, double (&tsipm)[6][6]) const
+    {
+        double Ra, Dec, W, dRa, dDec, dW;
+        Angles(et, Ra, Dec, W, dRa, dDec, dW);
+
+        double m[3][3], dm[3][3];
+        EulerToTransform(W, HalfPi - Dec, HalfPi + Ra, dW, -dDec, dRa, m, dm);
+
+        if (bRotated)
+        {
+            Multiply(m, ToReference, m);
+            Multiply(dm, ToReference, dm);
+        }
+
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                tsipm[i][j] = tsipm[i + 3][j + 3] = m[i][j];
+                tsipm[i + 3][j] = dm[i][j];
+                tsipm[i][j + 3] = 0.;
+            }
+        }
+    }
+
+
+    void FPckOrientation::Rotation(const FSEphemerisTime& et, FSRotationMatrix& tipm) const
+    {
+        Rotation(et.AsSpiceDouble(), tipm.AsSpiceDoubleArray());
+    }
+
+
+    void FPckOrientation::StateTransform(const FSEphemerisTime& et, FSStateTransform& tsipm) const
+    {
+        StateTransform(et.AsSpiceDouble(), tsipm.AsSpiceDoubleArray());
+    }
+
+
+    SPICE_API TSharedRef<const FPckOrientation, ESPMode::ThreadSafe> GetPckOrientation(int32 Body, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        {
+            FScopeLock Lock(&OrientationLock);
+            const TSharedRef<const FPckOrientation, ESPMode::ThreadSafe>* Found = Orientations().Find(Body);
+            if (Found && (*Found)->GetPoolGeneration() == MaxQ::Private::PoolGeneration())
+            {
+                MAXQ_CACHE_EVENT(PoolCacheHits);
+                if (ResultCode) *ResultCode = ES_ResultCode::Success;
+                if (ErrorMessage) ErrorMessage->Empty();
+                return *Found;
+            }
+        }
+
+        MAXQ_CACHE_EVENT(PoolCacheRebuilds);
+        TSharedRef<const FPckOrientation, ESPMode::ThreadSafe> Model = FPckOrientation::FromKernelPool(Body, ResultCode, ErrorMessage);
+
+        FScopeLock Lock(&OrientationLock);
+        if (Model->IsValid())
+        {
+            Orientations().Add(Body, Model);
+        }
+        else
+        {
+            Orientations().Remove(Body);
+        }
+        return Model;
+    }
+}
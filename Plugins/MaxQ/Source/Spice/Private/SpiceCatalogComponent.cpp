@@ -0,0 +1,339 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCatalogComponent.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A whole TLE catalog, drawn as instances of one mesh.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCatalogComponent.cpp is part of the "Blueprints API".
+//
+// The worker only touches the back buffer and the (const) batch propagator.
+// Anything that rebuilds the propagator waits for it first.  The eclipse
+// geometry needs CSPICE, so it's computed on the game thread when the job is
+// launched, and copied into the job.
+//
+// Custom data is only written for instances whose shadow (to 1/256) or
+// class changed, and the render state is marked dirty once.
+//------------------------------------------------------------------------------
+
+#include "SpiceCatalogComponent.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceEclipseBatch.h"
+#include "SpicePhotometry.h"
+#include "SpiceTLECatalog.h"
+#include "SpiceMath.h"
+#include "Spice.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+namespace
+{
+    // Instances per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    constexpr float ShadowTolerance = 1.f / 256.f;
+    constexpr float MagnitudeTolerance = 1.f / 32.f;
+
+    enum ECustomData : int32
+    {
+        Shadow,
+        ObjectClass,
+        Magnitude,
+        NumCustomData
+    };
+}
+
+
+UMaxQCatalogComponent::UMaxQCatalogComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    // After the ephemeris subsystem has advanced its Epoch
+    PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+    Mobility = EComponentMobility::Movable;
+    NumCustomDataFloats = NumCustomData;
+    SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    SetGenerateOverlapEvents(false);
+    CastShadow = false;
+
+    Front = MakeShared<FBuffer, ESPMode::ThreadSafe>();
+    Back = MakeShared<FBuffer, ESPMode::ThreadSafe>();
+}
+
+
+int32 UMaxQCatalogComponent::SetCatalog(const FSTLECatalog& Catalog, const FSTLEGeophysicalConstants& geophs)
+{
+    FSTLEGeophysicalConstants _geophs = geophs;
+    if (_geophs.geophs.Num() != 8)
+    {
+        USpice::getgeophs(_geophs, TEXT("EARTH"));
+    }
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    TArray<MaxQ::Orbits::FSGP4Propagator> Propagators;
+    MaxQ::Orbits::InitPropagators(Catalog, _geophs, Propagators, &ResultCode, &ErrorMessage);
+
+    if (ResultCode != ES_ResultCode::Success)
+    {
+        // Objects that failed are still instances, drawn at zero scale
+        OnError.Broadcast(ErrorMessage);
+    }
+
+    return SetPropagators(Propagators);
+}
+
+
+int32 UMaxQCatalogComponent::SetPropagators(TArrayView<const MaxQ::Orbits::FSGP4Propagator> Propagators)
+{
+    check(IsInGameThread());
+
+    Wait();
+
+    Batch.Build(Propagators);
+    const int32 Num = Batch.Num();
+
+    Classes.Init(0.f, Num);
+    WrittenShadows.Init(-1.f, Num);
+    WrittenClasses.Init(-1.f, Num);
+    WrittenMagnitudes.Init(-1.f, Num);
+    StandardMagnitudes.Reset();
+    Front = MakeShared<FBuffer, ESPMode::ThreadSafe>();
+    Back = MakeShared<FBuffer, ESPMode::ThreadSafe>();
+
+    ClearInstances();
+    SetNumCustomDataFloats(NumCustomData);
+
+    TArray<FTransform> Hidden;
+    Hidden.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), Num);
+    AddInstances(Hidden, false);
+
+    return Num;
+}
+
+
+void UMaxQCatalogComponent::SetObjectClass(int32 Index, float ObjectClass)
+{
+    if (Classes.IsValidIndex(Index))
+    {
+        Classes[Index] = ObjectClass;
+    }
+}
+
+
+void UMaxQCatalogComponent::SetStandardMagnitude(int32 Index, float NewMagnitude)
+{
+    if (Classes.IsValidIndex(Index))
+    {
+        if (StandardMagnitudes.Num() != Classes.Num())
+        {
+            StandardMagnitudes.Init(StandardMagnitude, Classes.Num());
+        }
+        StandardMagnitudes[Index] = NewMagnitude;
+    }
+}
+
+
+void UMaxQCatalogComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (InFlight.IsValid())
+    {
+        if (!InFlight.IsReady())
+        {
+            // Still on the last epoch:  keep drawing the front buffer
+            return;
+        }
+        InFlight.Reset();
+        Apply();
+    }
+
+    if (Batch.Num() == 0)
+    {
+        return;
+    }
+
+    FSEphemerisTime et = Epoch;
+    double TimeScale = 0.;
+    if (bFollowSubsystem)
+    {
+        if (const UMaxQEphemerisSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr)
+        {
+            et = Subsystem->Epoch;
+            TimeScale = Subsystem->TimeScale;
+        }
+    }
+    if (bPredict)
+    {
+        et = et + FSEphemerisPeriod(DeltaTime * TimeScale);
+    }
+
+    Launch(et);
+}
+
+
+void UMaxQCatalogComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    Wait();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+void UMaxQCatalogComponent::BeginDestroy()
+{
+    Wait();
+
+    Super::BeginDestroy();
+}
+
+
+void UMaxQCatalogComponent::Launch(const FSEphemerisTime& et)
+{
+    // The observer:  the first player's camera, in the catalog's TEME km
+    FSDistanceVector Observer;
+    bool bPhotometric = false;
+    if (bPhotometry && Scale > 0.)
+    {
+        const APlayerController* Player = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+        if (Player && Player->PlayerCameraManager)
+        {
+            const FVector Local = GetComponentTransform().InverseTransformPosition(Player->PlayerCameraManager->GetCameraLocation());
+            MaxQ::Math::Swizzle(Local / Scale, Observer);
+            bPhotometric = true;
+        }
+    }
+
+    // The Sun's position comes with the shadow geometry
+    MaxQ::Math::FEclipseGeometry Geometry;
+    bool bShadow = bShadows;
+    if (bShadow || bPhotometric)
+    {
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        if (!MaxQ::Math::EclipseGeometry(et, Geometry, TEXT("J2000"), TEXT("SUN"), TEXT("EARTH"), TEXT("IAU_EARTH"), ES_AberrationCorrectionWithNewtonians::LT_S, &ResultCode, &ErrorMessage))
+        {
+            OnError.Broadcast(ErrorMessage);
+            bShadow = false;
+            bPhotometric = false;
+        }
+    }
+
+    Back->Epoch = et;
+    Back->StandardMagnitudes = StandardMagnitudes;
+
+    InFlight = Async(EAsyncExecution::TaskGraph, [this, Buffer = Back, Geometry, bShadow, bPhotometric, Observer, Standard = StandardMagnitude, et, _Scale = Scale, _InstanceScale = InstanceScale]()
+    {
+        FBuffer& b = *Buffer;
+        Batch.Propagate(et, b.States, false);
+
+        const int32 Num = b.States.Num();
+        b.Transforms.SetNum(Num, false);
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                if (b.States.Status[i] == MaxQ::Orbits::ESGP4Status::Ok)
+                {
+                    const FVector Location = MaxQ::Math::Swizzle(b.States.Position(i)) * _Scale;
+                    b.Transforms[i] = FTransform(FQuat::Identity, Location, _InstanceScale);
+                }
+                else
+                {
+                    b.Transforms[i] = FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+                }
+            }
+        }, Num <= ChunkSize);
+
+        if (bShadow)
+        {
+            b.Shadows.SetNum(Num, false);
+            MaxQ::Math::EclipseStates(Geometry, MaxQ::Math::FConstVectorBatch(b.States.X, b.States.Y, b.States.Z), {}, b.Shadows);
+        }
+        else
+        {
+            b.Shadows.Reset();
+        }
+
+        if (bPhotometric)
+        {
+            b.Magnitudes.SetNum(Num, false);
+            const bool bStandards = b.StandardMagnitudes.Num() == Num;
+            MaxQ::Math::FPhotometryBatch Out;
+            Out.Magnitude = b.Magnitudes;
+            MaxQ::Math::Photometry(Geometry.Source, Observer, MaxQ::Math::FConstVectorBatch(b.States.X, b.States.Y, b.States.Z), Out, Standard,
+                bStandards ? TArrayView<const float>(b.StandardMagnitudes) : TArrayView<const float>(), b.Shadows);
+        }
+        else
+        {
+            b.Magnitudes.Reset();
+        }
+    });
+}
+
+
+void UMaxQCatalogComponent::Apply()
+{
+    Swap(Front, Back);
+    DisplayedEpoch = Front->Epoch;
+
+    const int32 Num = Front->Transforms.Num();
+    if (Num != GetInstanceCount() || Num != Classes.Num())
+    {
+        return;
+    }
+
+    BatchUpdateInstancesTransforms(0, Front->Transforms, false, false, true);
+
+    TArray<float> CustomData;
+    CustomData.SetNumZeroed(NumCustomData);
+    const bool bHasShadows = Front->Shadows.Num() == Num;
+    const bool bHasMagnitudes = Front->Magnitudes.Num() == Num;
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const float ShadowFraction = bHasShadows ? Front->Shadows[i] : 0.f;
+        const float VisualMagnitude = bHasMagnitudes ? Front->Magnitudes[i] : 0.f;
+        if (FMath::Abs(ShadowFraction - WrittenShadows[i]) > ShadowTolerance || Classes[i] != WrittenClasses[i] || FMath::Abs(VisualMagnitude - WrittenMagnitudes[i]) > MagnitudeTolerance)
+        {
+            CustomData[Shadow] = ShadowFraction;
+            CustomData[ObjectClass] = Classes[i];
+            CustomData[Magnitude] = VisualMagnitude;
+            SetCustomData(i, CustomData, false);
+
+            WrittenShadows[i] = ShadowFraction;
+            WrittenClasses[i] = Classes[i];
+            WrittenMagnitudes[i] = VisualMagnitude;
+        }
+    }
+
+    MarkRenderStateDirty();
+    OnUpdated.Broadcast();
+}
+
+
+void UMaxQCatalogComponent::Wait()
+{
+    if (InFlight.IsValid())
+    {
+        InFlight.Wait();
+        InFlight.Reset();
+    }
+}
@@ -0,0 +1,284 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCatalogLabelsComponent.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Labels for a whole catalog, decluttered and drawn in one batch.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCatalogLabelsComponent.cpp is part of the "Blueprints API".
+//
+// Labels are drawn from the debug draw service's "Game" channel, which every
+// game viewport draws after the scene, with a canvas set up for the view:  so
+// there's nothing to tick, and split screen views each get their own pass.
+// The canvas only flushes when the texture changes, so every label in one
+// font (one font page) goes out in the same batch.
+//
+// Labels are measured (the canvas's TextSize) when they or the font change,
+// not per frame.
+//------------------------------------------------------------------------------
+
+#include "SpiceCatalogLabelsComponent.h"
+#include "SpiceCatalogComponent.h"
+#include "SpiceMath.h"
+#include "Async/ParallelFor.h"
+#include "Debug/DebugDrawService.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "Engine/Font.h"
+#include "Engine/World.h"
+#include "SceneView.h"
+
+namespace
+{
+    // Labels per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+}
+
+
+UMaxQCatalogLabelsComponent::UMaxQCatalogLabelsComponent()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+}
+
+
+void UMaxQCatalogLabelsComponent::OnRegister()
+{
+    Super::OnRegister();
+
+    if (!DrawHandle.IsValid())
+    {
+        DrawHandle = UDebugDrawService::Register(TEXT("Game"), FDebugDrawDelegate::CreateUObject(this, &UMaxQCatalogLabelsComponent::Draw));
+    }
+}
+
+
+void UMaxQCatalogLabelsComponent::OnUnregister()
+{
+    if (DrawHandle.IsValid())
+    {
+        UDebugDrawService::Unregister(DrawHandle);
+        DrawHandle.Reset();
+    }
+
+    Super::OnUnregister();
+}
+
+
+void UMaxQCatalogLabelsComponent::SetCatalog(UMaxQCatalogComponent* NewCatalog)
+{
+    Catalog = NewCatalog;
+}
+
+
+void UMaxQCatalogLabelsComponent::SetLabels(const TArray<FString>& NewLabels, const TArray<float>& NewPriorities)
+{
+    Labels = NewLabels;
+    if (NewPriorities.Num() == Labels.Num())
+    {
+        Priorities = NewPriorities;
+    }
+    else
+    {
+        Priorities.Init(1.f, Labels.Num());
+    }
+
+    // Measured on the next draw
+    Sizes.Reset();
+}
+
+
+void UMaxQCatalogLabelsComponent::SetPriority(int32 Index, float Priority)
+{
+    if (Priorities.IsValidIndex(Index))
+    {
+        Priorities[Index] = Priority;
+    }
+}
+
+
+void UMaxQCatalogLabelsComponent::SetWorldPositions(TArrayView<const FVector> Positions, TArrayView<const uint8> Valid)
+{
+    check(Valid.Num() == 0 || Valid.Num() == Positions.Num());
+
+    WorldPositions.Reset(Positions.Num());
+    WorldPositions.Append(Positions.GetData(), Positions.Num());
+    WorldValid.Reset(Valid.Num());
+    WorldValid.Append(Valid.GetData(), Valid.Num());
+}
+
+
+void UMaxQCatalogLabelsComponent::Draw(UCanvas* Canvas, APlayerController* PlayerController)
+{
+    Drawn = 0;
+
+    const FSceneView* View = Canvas ? Canvas->SceneView : nullptr;
+    const UWorld* World = GetWorld();
+    if (!View || !World || (View->Family && View->Family->Scene != World->Scene) || Labels.Num() == 0 || MaxLabels <= 0)
+    {
+        return;
+    }
+
+    const UFont* DrawFont = Font ? Font.Get() : GEngine->GetSmallFont();
+    if (!DrawFont)
+    {
+        return;
+    }
+
+    if (Sizes.Num() != Labels.Num() || MeasuredFont.Get() != DrawFont)
+    {
+        Sizes.SetNumUninitialized(Labels.Num());
+        for (int32 i = 0; i < Labels.Num(); ++i)
+        {
+            float Width = 0.f, Height = 0.f;
+            Canvas->TextSize(DrawFont, Labels[i], Width, Height);
+            Sizes[i] = FVector2f(Width, Height);
+        }
+        MeasuredFont = DrawFont;
+    }
+
+    // Where the positions come from
+    const UMaxQCatalogComponent* Source = Catalog.Get();
+    const MaxQ::Orbits::FSGP4CatalogStates* States = Source ? &Source->GetStates() : nullptr;
+    const FTransform SourceTransform = Source ? Source->GetComponentTransform() : FTransform::Identity;
+    const double SourceScale = Source ? Source->Scale : 1.;
+
+    const int32 Num = FMath::Min(Labels.Num(), States ? States->Num() : WorldPositions.Num());
+    if (Num <= 0)
+    {
+        return;
+    }
+
+    // Project and cull, across all cores
+    const FIntRect ViewRect(0, 0, FMath::CeilToInt(Canvas->ClipX), FMath::CeilToInt(Canvas->ClipY));
+    const FMatrix ViewProjection = View->ViewMatrices.GetViewProjectionMatrix();
+    const FVector ViewOrigin = View->ViewMatrices.GetViewOrigin();
+    const double MaxDistanceSquared = MaxDistance > 0. ? FMath::Square(MaxDistance) : TNumericLimits<double>::Max();
+    const float _MinPriority = MinPriority;
+    const FVector2f _Offset(Offset);
+
+    Screen.SetNumUninitialized(Num, false);
+    Depths.SetNumUninitialized(Num, false);
+    Visible.SetNumUninitialized(Num, false);
+
+    ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+    {
+        const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+        for (int32 i = Chunk * ChunkSize; i < End; ++i)
+        {
+            Visible[i] = 0;
+
+            FVector Location;
+            if (States)
+            {
+                if (States->Status[i] != MaxQ::Orbits::ESGP4Status::Ok)
+                {
+                    continue;
+                }
+                Location = SourceTransform.TransformPosition(MaxQ::Math::Swizzle(States->Position(i)) * SourceScale);
+            }
+            else
+            {
+                if (WorldValid.Num() > 0 && !WorldValid[i])
+                {
+                    continue;
+                }
+                Location = WorldPositions[i];
+            }
+
+            const double DistanceSquared = FVector::DistSquared(Location, ViewOrigin);
+            FVector2D Projected;
+            if (Priorities[i] < _MinPriority || DistanceSquared > MaxDistanceSquared || !FSceneView::ProjectWorldToScreen(Location, ViewRect, ViewProjection, Projected))
+            {
+                continue;
+            }
+
+            // Some of the label on screen
+            const FVector2f TopLeft = FVector2f(Projected) + _Offset;
+            const FVector2f& Size = Sizes[i];
+            if (TopLeft.X + Size.X < 0.f || TopLeft.Y + Size.Y < 0.f || TopLeft.X >= ViewRect.Max.X || TopLeft.Y >= ViewRect.Max.Y)
+            {
+                continue;
+            }
+
+            Screen[i] = TopLeft;
+            Depths[i] = (float)DistanceSquared;
+            Visible[i] = 1;
+        }
+    }, Num <= ChunkSize);
+
+    Candidates.Reset();
+    for (int32 i = 0; i < Num; ++i)
+    {
+        if (Visible[i])
+        {
+            Candidates.Add(i);
+        }
+    }
+
+    Candidates.Sort([this](int32 a, int32 b)
+    {
+        return Priorities[a] != Priorities[b] ? Priorities[a] > Priorities[b] : Depths[a] < Depths[b];
+    });
+
+    // Declutter:  first come (highest priority) first served, by grid cell
+    const float Cell = FMath::Max(CellSize, 1.f);
+    const int32 Columns = FMath::Max(1, FMath::CeilToInt(ViewRect.Max.X / Cell));
+    const int32 Rows = FMath::Max(1, FMath::CeilToInt(ViewRect.Max.Y / Cell));
+    Occupied.Init(false, Columns * Rows);
+
+    Canvas->SetDrawColor(Color.ToFColor(true));
+    FFontRenderInfo RenderInfo;
+    RenderInfo.bClipText = true;
+    RenderInfo.bEnableShadow = bShadow;
+
+    for (int32 i : Candidates)
+    {
+        const FVector2f& TopLeft = Screen[i];
+        const FVector2f& Size = Sizes[i];
+        const int32 c0 = FMath::Clamp(FMath::FloorToInt(TopLeft.X / Cell), 0, Columns - 1);
+        const int32 c1 = FMath::Clamp(FMath::FloorToInt((TopLeft.X + Size.X) / Cell), 0, Columns - 1);
+        const int32 r0 = FMath::Clamp(FMath::FloorToInt(TopLeft.Y / Cell), 0, Rows - 1);
+        const int32 r1 = FMath::Clamp(FMath::FloorToInt((TopLeft.Y + Size.Y) / Cell), 0, Rows - 1);
+
+        bool bFree = true;
+        for (int32 r = r0; r <= r1 && bFree; ++r)
+        {
+            for (int32 c = c0; c <= c1; ++c)
+            {
+                if (Occupied[r * Columns + c])
+                {
+                    bFree = false;
+                    break;
+                }
+            }
+        }
+        if (!bFree)
+        {
+            continue;
+        }
+
+        for (int32 r = r0; r <= r1; ++r)
+        {
+            Occupied.SetRange(r * Columns + c0, c1 - c0 + 1, true);
+        }
+
+        Canvas->DrawText(DrawFont, Labels[i], TopLeft.X, TopLeft.Y, 1.f, 1.f, RenderInfo);
+        if (++Drawn >= MaxLabels)
+        {
+            break;
+        }
+    }
+}
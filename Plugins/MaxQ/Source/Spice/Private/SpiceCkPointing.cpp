@@ -0,0 +1,464 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCkPointing.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Batched CK attitude lookups (ckgp/ckgpav over many epochs and
+// instruments).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCkPointing.cpp is part of the "refined C++ API".
+//
+// This is ckgpav.f with the segment search (ckbss/cksns) replaced:  segments
+// come from walking each loaded CK's DAF summaries backwards, files in
+// reverse load order, which is cksns's priority.  A segment applies if
+// [start, stop] meets [sclkdp - tol, sclkdp + tol] (and it has angular
+// velocity, if that's needed), and ckpfs evaluates it, moving on to the next
+// when it has no data there.  Frame changes are ckgpav's:  cmat * ROT and
+// OMEGA + ROT^T * av, with ROT/OMEGA from reference to the segment's frame at
+// the clkout's ET (or at 0, when both are inertial).
+//
+// ckpfs/refchg/frmchg are Fortran:  matrices come back column major.
+//------------------------------------------------------------------------------
+
+#include "SpiceCkPointing.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+
+// for ckpfs_, refchg_, frmchg_
+#include "SpiceZfc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr SpiceInt InertialClass = 1;
+
+    bool IsInertial(SpiceInt Frame)
+    {
+        SpiceInt _cent = 0, _frclss = 0, _clssid = 0;
+        SpiceBoolean _found = SPICEFALSE;
+        frinfo_c(Frame, &_cent, &_frclss, &_clssid, &_found);
+        return _found && _frclss == InertialClass;
+    }
+
+    // As USpice::m2q, then Swizzle
+    FQuat ToQuat(const double (&cmat)[3][3])
+    {
+        double q[4];
+        m2q_c(cmat, q);
+        return FQuat((FQuat::FReal)-q[2], (FQuat::FReal)-q[1], (FQuat::FReal)-q[3], (FQuat::FReal)q[0]);
+    }
+
+    // As MaxQ::Math::Swizzle(FSAngularVelocity)
+    FVector ToVector(const double (&av)[3])
+    {
+        return FVector(-(FVector::FReal)av[1], -(FVector::FReal)av[0], -(FVector::FReal)av[2]);
+    }
+}
+
+namespace MaxQ::Frames
+{
+    FCkPointingCursor FCkPointingCursor::Open(int32 inst, const FString& ref, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        FCkPointingCursor Result;
+        Result.Instrument = inst;
+        Result.Reference = ref;
+        Result.Resolve();
+        ErrorCheck(ResultCode, ErrorMessage);
+        return Result;
+    }
+
+
+    bool FCkPointingCursor::Resolve()
+    {
+        bValid = false;
+        Cursor = INDEX_NONE;
+        Segments.Reset();
+        PoolGeneration = MaxQ::Data::GetPoolGeneration();
+
+        auto _ref = StringCast<ANSICHAR>(*Reference);
+        SpiceInt _refid = 0;
+        namfrm_c(_ref.Get(), &_refid);
+        if (_refid == 0 && !failed_c())
+        {
+            setmsg_c("The reference frame # is not recognized.");
+            errch_c("#", _ref.Get());
+            sigerr_c("SPICE(UNKNOWNFRAME)");
+        }
+
+        SpiceInt _sclk = 0;
+        ckmeta_c(Instrument, "SCLK", &_sclk);
+        if (failed_c())
+        {
+            return false;
+        }
+        ReferenceId = _refid;
+        Sclk = _sclk;
+
+        constexpr SpiceInt FILLEN = 1024;
+        constexpr SpiceInt TYPLEN = 33;
+        constexpr SpiceInt SRCLEN = 1024;
+
+        // Later files first
+        SpiceInt _count = 0;
+        ktotal_c("CK", &_count);
+        for (SpiceInt i = _count - 1; i >= 0 && !failed_c(); --i)
+        {
+            SpiceChar _file[FILLEN];
+            SpiceChar _filtyp[TYPLEN];
+            SpiceChar _srcfil[SRCLEN];
+            SpiceInt _handle = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            kdata_c(i, "CK", FILLEN, TYPLEN, SRCLEN, _file, _filtyp, _srcfil, &_handle, &_found);
+            if (!_found)
+            {
+                continue;
+            }
+
+            // Later segments first
+            dafbbs_c(_handle);
+            daffpa_c(&_found);
+            while (_found && !failed_c())
+            {
+                SpiceDouble _sum[5];
+                SpiceDouble _dc[2];
+                SpiceInt _ic[6];
+                dafgs_c(_sum);
+                dafus_c(_sum, 2, 6, _dc, _ic);
+
+                if (_ic[0] == Instrument)
+                {
+                    FSegment& Segment = Segments.AddDefaulted_GetRef();
+                    Segment.Handle = _handle;
+                    FMemory::Memcpy(Segment.Descriptor, _sum, sizeof(_sum));
+                    Segment.Start = _dc[0];
+                    Segment.Stop = _dc[1];
+                    Segment.Frame = _ic[1];
+                    Segment.bHasAv = _ic[3] != 0;
+                    Segment.bRotated = Segment.Frame != ReferenceId;
+                }
+
+                daffpa_c(&_found);
+            }
+        }
+
+        // Inertial to inertial doesn't depend on time
+        const bool bInertialReference = IsInertial(ReferenceId);
+        for (FSegment& Segment : Segments)
+        {
+            if (Segment.bRotated && bInertialReference && !failed_c() && IsInertial(Segment.Frame))
+            {
+                integer _from = ReferenceId, _to = Segment.Frame;
+                doublereal _et = 0.;
+                double _rotate[3][3];
+                refchg_(&_from, &_to, &_et, (doublereal*)_rotate);
+                xpose_c(_rotate, Segment.Rotation);
+                Segment.bConstant = true;
+            }
+        }
+
+        bValid = !failed_c();
+        return bValid;
+    }
+
+
+    bool FCkPointingCursor::Refresh()
+    {
+        if (failed_c())
+        {
+            return false;
+        }
+
+        // Kernels changed, segments may have come or gone
+        if (PoolGeneration != MaxQ::Data::GetPoolGeneration())
+        {
+            return Resolve();
+        }
+
+        if (!bValid)
+        {
+            setmsg_c("CK pointing for instrument # relative to # was not successfully opened.");
+            errint_c("#", Instrument);
+            errch_c("#", StringCast<ANSICHAR>(*Reference).Get());
+            sigerr_c("SPICE(INVALIDQUERY)");
+        }
+
+        return bValid;
+    }
+
+
+    bool FCkPointingCursor::Evaluate(int32 Index, double sclkdp, double tol, double (&cmat)[3][3], double& clkout, double* av) const
+    {
+        const FSegment& Segment = Segments[Index];
+
+        integer _handle = Segment.Handle;
+        doublereal _descr[5];
+        FMemory::Memcpy(_descr, Segment.Descriptor, sizeof(_descr));
+        doublereal _sclkdp = sclkdp;
+        doublereal _tol = tol;
+        logical _needav = av != nullptr;
+        double _cmat[3][3];
+        doublereal _av[3] = { 0. };
+        doublereal _clkout = 0.;
+        logical _found = 0;
+        ckpfs_(&_handle, _descr, &_sclkdp, &_tol, &_needav, (doublereal*)_cmat, _av, &_clkout, &_found);
+        if (!_found || failed_c())
+        {
+            return false;
+        }
+
+        xpose_c(_cmat, cmat);
+        clkout = _clkout;
+        if (av)
+        {
+            vequ_c(_av, av);
+        }
+
+        if (!Segment.bRotated)
+        {
+            return true;
+        }
+
+        if (Segment.bConstant)
+        {
+            mxm_c(cmat, Segment.Rotation, cmat);
+            if (av)
+            {
+                mtxv_c(Segment.Rotation, av, av);
+            }
+            return true;
+        }
+
+        integer _from = ReferenceId, _to = Segment.Frame;
+        doublereal _et = 0.;
+        sct2e_c(Sclk, _clkout, &_et);
+
+        if (!av)
+        {
+            double _rotate[3][3], rotate[3][3];
+            refchg_(&_from, &_to, &_et, (doublereal*)_rotate);
+            xpose_c(_rotate, rotate);
+            mxm_c(cmat, rotate, cmat);
+        }
+        else
+        {
+            double _xform[6][6], xform[6][6];
+            frmchg_(&_from, &_to, &_et, (doublereal*)_xform);
+            xpose6_c(_xform, xform);
+
+            double rotate[3][3], omega[3];
+            xf2rav_c(xform, rotate, omega);
+            mxm_c(cmat, rotate, cmat);
+            mtxv_c(rotate, av, av);
+            vadd_c(omega, av, av);
+        }
+
+        return !failed_c();
+    }
+
+
+    void FCkPointingCursor::MoveCursor(int32 Index, double sclkdp, bool bNeedAv)
+    {
+        Cursor = Index;
+        bCursorAv = bNeedAv;
+        CursorLo = -DBL_MAX;
+        CursorHi = DBL_MAX;
+
+        // Higher priority segments have to be kept out of the window
+        for (int32 i = 0; i < Index; ++i)
+        {
+            const FSegment& Segment = Segments[i];
+            if (bNeedAv && !Segment.bHasAv)
+            {
+                continue;
+            }
+
+            if (Segment.Stop < sclkdp)
+            {
+                CursorLo = FMath::Max(CursorLo, Segment.Stop);
+            }
+            else if (Segment.Start > sclkdp)
+            {
+                CursorHi = FMath::Min(CursorHi, Segment.Start);
+            }
+            else
+            {
+                // It covers sclkdp, but has a gap there
+                CursorLo = CursorHi = sclkdp;
+                break;
+            }
+        }
+    }
+
+
+    bool FCkPointingCursor::Pointing(double sclkdp, double tol, double (&cmat)[3][3], double& clkout, double* av)
+    {
+        if (!Refresh())
+        {
+            return false;
+        }
+
+        const bool bNeedAv = av != nullptr;
+
+        int32 Tried = INDEX_NONE;
+        if (Cursor != INDEX_NONE && bCursorAv == bNeedAv && sclkdp - tol > CursorLo && sclkdp + tol < CursorHi)
+        {
+            const FSegment& Segment = Segments[Cursor];
+            if (Segment.Start <= sclkdp + tol && Segment.Stop >= sclkdp - tol)
+            {
+                if (Evaluate(Cursor, sclkdp, tol, cmat, clkout, av))
+                {
+                    return true;
+                }
+                Tried = Cursor;
+            }
+        }
+
+        for (int32 i = 0; i < Segments.Num() && !failed_c(); ++i)
+        {
+            const FSegment& Segment = Segments[i];
+            if (i == Tried || (bNeedAv && !Segment.bHasAv) || Segment.Start > sclkdp + tol || Segment.Stop < sclkdp - tol)
+            {
+                continue;
+            }
+
+            if (Evaluate(i, sclkdp, tol, cmat, clkout, av))
+            {
+                MoveCursor(i, sclkdp, bNeedAv);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    int32 FCkPointingCursor::Pointing(
+        TArrayView<const double> sclkdp,
+        double tol,
+        TArrayView<FQuat> Rotations,
+        TArrayView<FVector> AngularVelocities,
+        TArrayView<double> clkout,
+        TArrayView<bool> found,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        check(Rotations.Num() >= sclkdp.Num());
+        check(AngularVelocities.Num() == 0 || AngularVelocities.Num() >= sclkdp.Num());
+        check(clkout.Num() == 0 || clkout.Num() >= sclkdp.Num());
+        check(found.Num() == 0 || found.Num() >= sclkdp.Num());
+
+        const bool bNeedAv = AngularVelocities.Num() > 0;
+
+        for (int32 i = 0; i < sclkdp.Num(); ++i)
+        {
+            Rotations[i] = FQuat::Identity;
+            if (bNeedAv) AngularVelocities[i] = FVector::ZeroVector;
+            if (clkout.Num()) clkout[i] = 0.;
+            if (found.Num()) found[i] = false;
+        }
+
+        int32 NumFound = 0;
+        {
+            MAXQ_FRAME_LOOKUP_SCOPE();
+
+            for (int32 i = 0; i < sclkdp.Num() && !failed_c(); ++i)
+            {
+                double cmat[3][3], av[3], _clkout = 0.;
+                if (!Pointing(sclkdp[i], tol, cmat, _clkout, bNeedAv ? av : nullptr) || failed_c())
+                {
+                    continue;
+                }
+
+                Rotations[i] = ToQuat(cmat);
+                if (bNeedAv) AngularVelocities[i] = ToVector(av);
+                if (clkout.Num()) clkout[i] = _clkout;
+                if (found.Num()) found[i] = true;
+                ++NumFound;
+            }
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return NumFound;
+    }
+
+
+    SPICE_API int32 Pointing(
+        TArrayView<FCkPointingCursor> Cursors,
+        double et,
+        double tol,
+        TArrayView<FQuat> Rotations,
+        TArrayView<FVector> AngularVelocities,
+        TArrayView<bool> found,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        check(Rotations.Num() >= Cursors.Num());
+        check(AngularVelocities.Num() == 0 || AngularVelocities.Num() >= Cursors.Num());
+        check(found.Num() == 0 || found.Num() >= Cursors.Num());
+
+        const bool bNeedAv = AngularVelocities.Num() > 0;
+
+        int32 NumFound = 0;
+        for (int32 i = 0; i < Cursors.Num(); ++i)
+        {
+            Rotations[i] = FQuat::Identity;
+            if (bNeedAv) AngularVelocities[i] = FVector::ZeroVector;
+            if (found.Num()) found[i] = false;
+
+            if (failed_c())
+            {
+                continue;
+            }
+
+            FCkPointingCursor& Cursor = Cursors[i];
+            double sclkdp = 0., sclktol = 0.;
+            if (Cursor.Refresh())
+            {
+                sce2c_c(Cursor.GetSclk(), et, &sclkdp);
+                sce2c_c(Cursor.GetSclk(), et + tol, &sclktol);
+                sclktol -= sclkdp;
+            }
+            if (failed_c())
+            {
+                continue;
+            }
+
+            MAXQ_FRAME_LOOKUP_SCOPE();
+
+            double cmat[3][3], av[3], clkout = 0.;
+            if (Cursor.Pointing(sclkdp, sclktol, cmat, clkout, bNeedAv ? av : nullptr) && !failed_c())
+            {
+                Rotations[i] = ToQuat(cmat);
+                if (bNeedAv) AngularVelocities[i] = ToVector(av);
+                if (found.Num()) found[i] = true;
+                ++NumFound;
+            }
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return NumFound;
+    }
+}
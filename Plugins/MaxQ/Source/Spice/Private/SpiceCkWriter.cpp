@@ -0,0 +1,335 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCkWriter.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Writes C-kernel (attitude) segments incrementally.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCkWriter.cpp is part of the "refined C++ API".
+//
+// Records are buffered in the layout ckw01_c/ckw03_c take (parallel sclkdp,
+// quats and avvs arrays), so a flush moves the buffers into the segment
+// instead of copying them.
+//------------------------------------------------------------------------------
+
+#include "SpiceCkWriter.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace MaxQ::Data
+{
+    struct FCkSegmentWriter::FSegment
+    {
+        FCkSegmentWriterSettings Settings;
+        int Handle = 0;
+        int Inst = 0;
+        FString Ref;
+        FString SegId;
+        TArray<double> Sclkdp;
+        TArray<double> Quats;
+        TArray<double> Avvs;
+        TArray<double> Starts;
+
+        bool Write(ES_ResultCode* ResultCode, FString* ErrorMessage) const
+        {
+            auto _ref = StringCast<ANSICHAR>(*Ref);
+            auto _segid = StringCast<ANSICHAR>(*SegId);
+            SpiceBoolean _avflag = Settings.bAngularVelocity ? SPICETRUE : SPICEFALSE;
+            SpiceInt _nrec = Sclkdp.Num();
+            ConstSpiceDouble(*_quats)[4] = (ConstSpiceDouble(*)[4])Quats.GetData();
+            ConstSpiceDouble(*_avvs)[3] = (ConstSpiceDouble(*)[3])Avvs.GetData();
+
+            if (Settings.Type == ECkSegmentType::Type03)
+            {
+                ckw03_c(Handle, Sclkdp[0], Sclkdp.Last(), Inst, _ref.Get(), _avflag, _segid.Get(), _nrec, Sclkdp.GetData(), _quats, _avvs, Starts.Num(), Starts.GetData());
+            }
+            else
+            {
+                ckw01_c(Handle, Sclkdp[0], Sclkdp.Last(), Inst, _ref.Get(), _avflag, _segid.Get(), _nrec, Sclkdp.GetData(), _quats, _avvs);
+            }
+
+            return !ErrorCheck(ResultCode, ErrorMessage);
+        }
+    };
+
+
+    FCkSegmentWriter::FCkSegmentWriter()
+    {
+    }
+
+    FCkSegmentWriter::~FCkSegmentWriter()
+    {
+        // Anything still buffered is discarded; End() writes it.  The write
+        // queue waits for anything in flight.
+    }
+
+
+    bool FCkSegmentWriter::Begin(
+        int handle,
+        int inst,
+        const FString& ref,
+        const FString& segid,
+        const FCkSegmentWriterSettings& _Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (bOpen)
+        {
+            return Fail(TEXT("FCkSegmentWriter::Begin: already open; call End() first"), ResultCode, ErrorMessage);
+        }
+
+        if (_Settings.Type != ECkSegmentType::Type01 && _Settings.Type != ECkSegmentType::Type03)
+        {
+            return Fail(TEXT("FCkSegmentWriter::Begin: unsupported segment type"), ResultCode, ErrorMessage);
+        }
+
+        if (segid.Len() > 40)
+        {
+            return Fail(FString::Printf(TEXT("FCkSegmentWriter::Begin: segment id '%s' is longer than 40 characters"), *segid), ResultCode, ErrorMessage);
+        }
+
+        Settings = _Settings;
+        Settings.RecordsPerSegment = FMath::Max(Settings.RecordsPerSegment, 2);
+        Settings.MaxGapTicks = FMath::Max(Settings.MaxGapTicks, 0.);
+
+        Handle = handle;
+        Inst = inst;
+        Ref = ref;
+        SegId = segid;
+
+        Sclkdp.Reset();
+        Quats.Reset();
+        Avvs.Reset();
+        Starts.Reset();
+        Reserve();
+        bCarried = false;
+        SegmentsWritten = 0;
+
+        WriteQueue.Reset();
+        if (Settings.bUseExecutor)
+        {
+            WriteQueue = MakeUnique<FSegmentWriteQueue>();
+        }
+
+        bOpen = true;
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FCkSegmentWriter::Add(
+        TArrayView<const FSPointingType1Observation> records,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (!bOpen)
+        {
+            return Fail(TEXT("FCkSegmentWriter::Add: not open; call Begin() first"), ResultCode, ErrorMessage);
+        }
+
+        FString AsyncError;
+        if (WriteQueue.IsValid() && WriteQueue->Failed(&AsyncError))
+        {
+            return Fail(AsyncError, ResultCode, ErrorMessage);
+        }
+
+        // Validate everything before buffering anything, so a failed Add
+        // leaves the writer as it was.
+        for (int32 i = 0; i < records.Num(); ++i)
+        {
+            const bool bHavePrevious = i > 0 || Sclkdp.Num() > 0;
+            const double Previous = i > 0 ? records[i - 1].sclkdp : (Sclkdp.Num() > 0 ? Sclkdp.Last() : 0.);
+            if (bHavePrevious && !(records[i].sclkdp > Previous))
+            {
+                return Fail(FString::Printf(TEXT("FCkSegmentWriter::Add: record %d (%.17g) does not follow %.17g"), i, records[i].sclkdp, Previous), ResultCode, ErrorMessage);
+            }
+        }
+
+        for (const FSPointingType1Observation& record : records)
+        {
+            if (Settings.Type == ECkSegmentType::Type03)
+            {
+                if (Sclkdp.Num() == 0 || (Settings.MaxGapTicks > 0. && record.sclkdp - Sclkdp.Last() > Settings.MaxGapTicks))
+                {
+                    Starts.Add(record.sclkdp);
+                }
+            }
+
+            double _quat[4], _avv[3];
+            record.quat.CopyTo(_quat);
+            record.avv.CopyTo(_avv);
+
+            Sclkdp.Add(record.sclkdp);
+            Quats.Append(_quat, 4);
+            Avvs.Append(_avv, 3);
+
+            if (Sclkdp.Num() >= Settings.RecordsPerSegment)
+            {
+                if (!Flush(false, ResultCode, ErrorMessage))
+                {
+                    return false;
+                }
+            }
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FCkSegmentWriter::Add(
+        const FSPointingType1Observation& record,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        return Add(TArrayView<const FSPointingType1Observation>(&record, 1), ResultCode, ErrorMessage);
+    }
+
+
+    bool FCkSegmentWriter::End(
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (!bOpen)
+        {
+            return Fail(TEXT("FCkSegmentWriter::End: not open"), ResultCode, ErrorMessage);
+        }
+
+        bool bSuccess = Flush(true, ResultCode, ErrorMessage);
+
+        FString AsyncError;
+        if (WriteQueue.IsValid())
+        {
+            WriteQueue->Wait();
+            if (bSuccess && WriteQueue->Failed(&AsyncError))
+            {
+                bSuccess = Fail(AsyncError, ResultCode, ErrorMessage);
+            }
+        }
+
+        Sclkdp.Empty();
+        Quats.Empty();
+        Avvs.Empty();
+        Starts.Empty();
+        WriteQueue.Reset();
+        bOpen = false;
+
+        if (bSuccess)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Success;
+            if (ErrorMessage) ErrorMessage->Empty();
+        }
+        return bSuccess;
+    }
+
+
+    bool FCkSegmentWriter::Flush(bool bFinal, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        // Nothing new since the last segment
+        if (Sclkdp.Num() <= (bCarried ? 1 : 0))
+        {
+            return true;
+        }
+
+        TUniquePtr<FSegment> Segment = MakeUnique<FSegment>();
+        Segment->Settings = Settings;
+        Segment->Handle = Handle;
+        Segment->Inst = Inst;
+        Segment->Ref = Ref;
+        Segment->SegId = SegId;
+
+        // Type 03 starts the next segment with this one's last record
+        const bool bCarry = !bFinal && Settings.Type == ECkSegmentType::Type03;
+
+        double _quat[4], _avv[3];
+        const double _sclkdp = Sclkdp.Last();
+        FMemory::Memcpy(_quat, &Quats[Quats.Num() - 4], sizeof(_quat));
+        FMemory::Memcpy(_avv, &Avvs[Avvs.Num() - 3], sizeof(_avv));
+
+        Segment->Sclkdp = MoveTemp(Sclkdp);
+        Segment->Quats = MoveTemp(Quats);
+        Segment->Avvs = MoveTemp(Avvs);
+        Segment->Starts = MoveTemp(Starts);
+
+        Sclkdp.Reset();
+        Quats.Reset();
+        Avvs.Reset();
+        Starts.Reset();
+        bCarried = false;
+
+        if (bCarry)
+        {
+            Reserve();
+            Sclkdp.Add(_sclkdp);
+            Quats.Append(_quat, 4);
+            Avvs.Append(_avv, 3);
+            Starts.Add(_sclkdp);
+            bCarried = true;
+        }
+
+        if (!WriteQueue.IsValid())
+        {
+            if (!Segment->Write(ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+
+            ++SegmentsWritten;
+            return true;
+        }
+
+        WriteQueue->Submit(
+            [Segment = MoveTemp(Segment)](ES_ResultCode* SegmentResult, FString* SegmentError)
+            {
+                return Segment->Write(SegmentResult, SegmentError);
+            }
+        );
+
+        ++SegmentsWritten;
+        return true;
+    }
+
+
+    bool FCkSegmentWriter::Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+
+    void FCkSegmentWriter::Reserve()
+    {
+        Sclkdp.Reserve(Settings.RecordsPerSegment);
+        Quats.Reserve(4 * Settings.RecordsPerSegment);
+        Avvs.Reserve(3 * Settings.RecordsPerSegment);
+    }
+}
@@ -0,0 +1,735 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceConjunction.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Close approach (conjunction) screening of whole SGP4 catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceConjunction.cpp is part of the "refined C++ API".
+//
+// The spatial hash is a sorted array of (cell key, object) pairs, rebuilt
+// every step:  sorting 25k keys is cheaper than maintaining buckets, and
+// each object's neighbors are then 27 binary searches away.  A pair is only
+// examined by its lower indexed object, so it's examined once per step.
+//
+// A conjunction is usually found at two consecutive steps (its TCA sits
+// near the half step boundary), and refines to the same root from both.
+// Refined approaches of a pair within a step of each other are merged.
+//
+// A shard still hashes every object (its primaries' neighbors can be any
+// of them), and only examines pairs from its own primaries.  Models cross
+// to the shard job as raw bytes:  they're plain data, and both ends are the
+// same build.
+//------------------------------------------------------------------------------
+
+#include "SpiceConjunction.h"
+#include "SpiceSGP4Batch.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include <atomic>
+
+namespace
+{
+    using namespace MaxQ::Orbits;
+
+    constexpr int32 MaxIterations = 100;
+
+    // How fast two objects' relative velocity can turn, km/s^2 (LEO gravity
+    // is ~0.01):  the linearized miss distance is off by at most
+    // 1/2 a t^2 of it
+    constexpr double MaxRelativeAcceleration = 0.02;
+
+    constexpr int64 CellBias = 1 << 20;
+    constexpr uint64 CellMask = (1 << 21) - 1;
+
+    typedef TPair<uint64, int32> FCellEntry;
+
+    struct FShell
+    {
+        double Perigee = 0.;
+        double Apogee = 0.;
+        bool bValid = false;
+    };
+
+    FShell MakeShell(const FSGP4Propagator& Propagator, double Pad)
+    {
+        FShell Shell;
+        const FSGP4Model& Model = Propagator.GetModel();
+        if (Propagator.IsValid() && Model.no > 0.)
+        {
+            const double a = FMath::Pow(Model.xke / Model.no, 2. / 3.) * Model.er;
+            Shell.Perigee = a * (1. - Model.ecco) - Pad;
+            Shell.Apogee = a * (1. + Model.ecco) + Pad;
+            Shell.bValid = true;
+        }
+        return Shell;
+    }
+
+    inline bool ShellsMeet(const FShell& a, const FShell& b, double Threshold)
+    {
+        return FMath::Max(a.Perigee, b.Perigee) - FMath::Min(a.Apogee, b.Apogee) <= Threshold;
+    }
+
+    inline int64 Cell(double x, double CellSize)
+    {
+        return FMath::Clamp<int64>((int64)FMath::FloorToDouble(x / CellSize), 2 - CellBias, CellBias - 2);
+    }
+
+    inline uint64 CellKey(int64 x, int64 y, int64 z)
+    {
+        return (((uint64)(x + CellBias) & CellMask) << 42) | (((uint64)(y + CellBias) & CellMask) << 21) | ((uint64)(z + CellBias) & CellMask);
+    }
+
+    inline double Dot(const double* a, const double* b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    struct FCandidate
+    {
+        int32 Primary;
+        int32 Secondary;
+        double et;
+    };
+
+    struct FPairRange
+    {
+        const FSGP4Propagator& Primary;
+        const FSGP4Propagator& Secondary;
+
+        // dr . dv (range times range rate), range and relative speed
+        bool operator()(double et, double& g, double& Range, double& Speed) const
+        {
+            double a[6], b[6];
+            if (Primary.Propagate(et, a) != ESGP4Status::Ok || Secondary.Propagate(et, b) != ESGP4Status::Ok)
+            {
+                return false;
+            }
+            const double dr[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const double dv[3] = { b[3] - a[3], b[4] - a[4], b[5] - a[5] };
+            g = Dot(dr, dv);
+            Range = FMath::Sqrt(Dot(dr, dr));
+            Speed = FMath::Sqrt(Dot(dv, dv));
+            return true;
+        }
+
+        // g(a) < 0 < g(b).  Illinois false position.
+        bool Root(double a, double b, double ga, double gb, double Tolerance, double& TCA) const
+        {
+            int32 Side = 0;
+            for (int32 i = 0; i < MaxIterations && b - a > Tolerance; ++i)
+            {
+                double c = (a * gb - b * ga) / (gb - ga);
+                if (!(c > a && c < b))
+                {
+                    c = 0.5 * (a + b);
+                }
+
+                double gc, Range, Speed;
+                if (!(*this)(c, gc, Range, Speed))
+                {
+                    return false;
+                }
+
+                if (gc > 0.)
+                {
+                    b = c; gb = gc;
+                    if (Side == -1) ga *= 0.5;
+                    Side = -1;
+                }
+                else
+                {
+                    a = c; ga = gc;
+                    if (Side == 1) gb *= 0.5;
+                    Side = 1;
+                }
+            }
+            TCA = 0.5 * (a + b);
+            return true;
+        }
+    };
+
+    // Keeps the closest of a pair's approaches within MergeSeconds of each
+    // other, sorted by TCA
+    void MergeApproaches(TArray<FConjunction>& Found, double MergeSeconds, TArray<FConjunction>& Conjunctions)
+    {
+        Found.Sort([](const FConjunction& a, const FConjunction& b)
+        {
+            return a.Primary != b.Primary ? a.Primary < b.Primary : a.Secondary != b.Secondary ? a.Secondary < b.Secondary : a.TCA < b.TCA;
+        });
+
+        Conjunctions.Reset();
+        for (const FConjunction& Conjunction : Found)
+        {
+            FConjunction* Last = Conjunctions.Num() > 0 ? &Conjunctions.Last() : nullptr;
+            if (Last && Last->Primary == Conjunction.Primary && Last->Secondary == Conjunction.Secondary && Conjunction.TCA - Last->TCA < MergeSeconds)
+            {
+                if (Conjunction.MissDistance < Last->MissDistance)
+                {
+                    *Last = Conjunction;
+                }
+                continue;
+            }
+            Conjunctions.Add(Conjunction);
+        }
+
+        Conjunctions.Sort([](const FConjunction& a, const FConjunction& b) { return a.TCA < b.TCA; });
+    }
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    bool SettingsAreValid(const FConjunctionSettings& Settings)
+    {
+        return Settings.Step > 0. && Settings.Threshold > 0. && Settings.Tolerance > 0. && Settings.MaxRelativeSpeed >= 0.;
+    }
+
+
+    // Shard jobs.  Request:  settings, shard, catalog (count, then a bool
+    // and, if valid, the model for each).  Response:  stats, conjunctions.
+    constexpr TCHAR ScreenJobName[] = TEXT("MaxQ.ScreenConjunctions");
+
+    constexpr int64 ConjunctionBytes = 2 * sizeof(int32) + 3 * sizeof(double);
+
+    void SerializeHeader(FArchive& Ar, FConjunctionSettings& Settings, FConjunctionShard& Shard)
+    {
+        Ar << Settings.Threshold << Settings.Step << Settings.Tolerance << Settings.MaxRelativeSpeed << Settings.ShellPad;
+        Ar << Shard.PrimaryBegin << Shard.PrimaryEnd << Shard.Start << Shard.Stop;
+    }
+
+    void SaveCatalog(FArchive& Ar, TArrayView<const FSGP4Propagator> Catalog)
+    {
+        int32 Count = Catalog.Num();
+        Ar << Count;
+        for (const FSGP4Propagator& Propagator : Catalog)
+        {
+            bool bValid = Propagator.IsValid();
+            Ar << bValid;
+            if (bValid)
+            {
+                FSGP4Model Model = Propagator.GetModel();
+                Ar.Serialize(&Model, sizeof(Model));
+            }
+        }
+    }
+
+    bool LoadCatalog(FArchive& Ar, TArray<FSGP4Propagator>& Catalog)
+    {
+        int32 Count = 0;
+        Ar << Count;
+        if (Ar.IsError() || Count < 0 || Count > Ar.TotalSize() - Ar.Tell())
+        {
+            return false;
+        }
+
+        Catalog.Reset(Count);
+        for (int32 i = 0; i < Count && !Ar.IsError(); ++i)
+        {
+            bool bValid = false;
+            Ar << bValid;
+            if (bValid)
+            {
+                FSGP4Model Model;
+                Ar.Serialize(&Model, sizeof(Model));
+                Catalog.Emplace(Model);
+            }
+            else
+            {
+                Catalog.Emplace();
+            }
+        }
+        return !Ar.IsError();
+    }
+
+    void SerializeResponse(FArchive& Ar, FConjunctionStats& Stats, TArray<FConjunction>& Conjunctions)
+    {
+        Ar << Stats.Steps << Stats.Candidates << Stats.Refined;
+
+        int32 Count = Conjunctions.Num();
+        Ar << Count;
+        if (Ar.IsLoading())
+        {
+            if (Ar.IsError() || Count < 0 || Count * ConjunctionBytes > Ar.TotalSize() - Ar.Tell())
+            {
+                Ar.SetError();
+                return;
+            }
+            Conjunctions.SetNum(Count);
+        }
+
+        for (FConjunction& Conjunction : Conjunctions)
+        {
+            Ar << Conjunction.Primary << Conjunction.Secondary << Conjunction.TCA << Conjunction.MissDistance << Conjunction.RelativeSpeed;
+        }
+    }
+
+    bool RunScreenJob(const TArray<uint8>& Request, TArray<uint8>& Response, FString& ErrorMessage)
+    {
+        FMemoryReader Reader(Request);
+        FConjunctionSettings Settings;
+        FConjunctionShard Shard;
+        TArray<FSGP4Propagator> Catalog;
+        SerializeHeader(Reader, Settings, Shard);
+        if (Reader.IsError() || !LoadCatalog(Reader, Catalog))
+        {
+            ErrorMessage = TEXT("ScreenConjunctions: malformed shard request");
+            return false;
+        }
+
+        FConjunctionStats Stats;
+        TArray<FConjunction> Conjunctions;
+        if (!ScreenConjunctions(Catalog, Shard, Conjunctions, Settings, &Stats, nullptr, &ErrorMessage))
+        {
+            return false;
+        }
+
+        FMemoryWriter Writer(Response);
+        SerializeResponse(Writer, Stats, Conjunctions);
+        return true;
+    }
+
+    FSpiceJobRegistration ScreenJob(ScreenJobName, &RunScreenJob);
+}
+
+
+namespace MaxQ::Orbits
+{
+    bool ScreenConjunctions(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        TArray<FConjunction>& Conjunctions,
+        const FConjunctionSettings& Settings,
+        FConjunctionStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FConjunctionShard Everything;
+        Everything.Start = Start.AsSpiceDouble();
+        Everything.Stop = Stop.AsSpiceDouble();
+        return ScreenConjunctions(Catalog, Everything, Conjunctions, Settings, Stats, ResultCode, ErrorMessage);
+    }
+
+
+    bool ScreenConjunctions(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FConjunctionShard& Shard,
+        TArray<FConjunction>& Conjunctions,
+        const FConjunctionSettings& Settings,
+        FConjunctionStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Conjunctions.Reset();
+        if (Stats) *Stats = FConjunctionStats();
+
+        const double Begin = Shard.Start;
+        const double End = Shard.Stop;
+        if (!(End >= Begin) || !SettingsAreValid(Settings))
+        {
+            return Fail(FString::Printf(TEXT("ScreenConjunctions: bad window [%f, %f] or settings (step %f, threshold %f, tolerance %f)"), Begin, End, Settings.Step, Settings.Threshold, Settings.Tolerance), ResultCode, ErrorMessage);
+        }
+
+        const int32 NumObjects = Catalog.Num();
+
+        TArray<FShell> Shells;
+        Shells.Reserve(NumObjects);
+        for (const FSGP4Propagator& Propagator : Catalog)
+        {
+            Shells.Add(MakeShell(Propagator, Settings.ShellPad));
+        }
+
+        FSGP4BatchPropagator Batch;
+        Batch.Build(Catalog);
+
+        const int32 NumSteps = FMath::Max(1, FMath::CeilToInt((End - Begin) / Settings.Step));
+        const double Step = (End - Begin) / NumSteps;
+        const double HalfStep = 0.5 * Step;
+        const double Screen = Settings.Threshold + Settings.MaxRelativeSpeed * HalfStep;
+        const double Margin = Settings.Threshold + 0.5 * MaxRelativeAcceleration * HalfStep * HalfStep;
+
+        FSGP4CatalogStates States;
+        TArray<FCellEntry> Cells;
+        TArray<FCandidate> Candidates;
+        FCriticalSection CandidatesLock;
+        std::atomic<int64> NumCandidates { 0 };
+
+        for (int32 k = 0; k <= NumSteps; ++k)
+        {
+            const double et = Begin + k * Step;
+            Batch.Propagate(FSEphemerisTime(et), States, true);
+
+            Cells.Reset();
+            for (int32 i = 0; i < NumObjects; ++i)
+            {
+                if (Shells[i].bValid && States.Status[i] == ESGP4Status::Ok)
+                {
+                    Cells.Add(FCellEntry(CellKey(Cell(States.X[i], Screen), Cell(States.Y[i], Screen), Cell(States.Z[i], Screen)), i));
+                }
+            }
+            Cells.Sort([](const FCellEntry& a, const FCellEntry& b) { return a.Key < b.Key; });
+
+            ParallelFor(Cells.Num(), [&](int32 c)
+            {
+                const int32 i = Cells[c].Value;
+                if (i < Shard.PrimaryBegin || i >= Shard.PrimaryEnd)
+                {
+                    return;
+                }
+                const double ri[3] = { States.X[i], States.Y[i], States.Z[i] };
+                const double vi[3] = { States.VX[i], States.VY[i], States.VZ[i] };
+                const int64 cx = Cell(ri[0], Screen), cy = Cell(ri[1], Screen), cz = Cell(ri[2], Screen);
+
+                int64 Tested = 0;
+                TArray<FCandidate, TInlineAllocator<8>> Found;
+
+                for (int64 dx = -1; dx <= 1; ++dx)
+                for (int64 dy = -1; dy <= 1; ++dy)
+                for (int64 dz = -1; dz <= 1; ++dz)
+                {
+                    const uint64 Key = CellKey(cx + dx, cy + dy, cz + dz);
+                    for (int32 n = Algo::LowerBound(Cells, Key, [](const FCellEntry& Entry, uint64 _Key) { return Entry.Key < _Key; }); n < Cells.Num() && Cells[n].Key == Key; ++n)
+                    {
+                        const int32 j = Cells[n].Value;
+                        if (j <= i || !ShellsMeet(Shells[i], Shells[j], Settings.Threshold))
+                        {
+                            continue;
+                        }
+                        ++Tested;
+
+                        const double dr[3] = { States.X[j] - ri[0], States.Y[j] - ri[1], States.Z[j] - ri[2] };
+                        if (Dot(dr, dr) > Screen * Screen)
+                        {
+                            continue;
+                        }
+
+                        // Linearized closest approach
+                        const double dv[3] = { States.VX[j] - vi[0], States.VY[j] - vi[1], States.VZ[j] - vi[2] };
+                        const double dv2 = Dot(dv, dv);
+                        const double t = dv2 > 0. ? -Dot(dr, dv) / dv2 : 0.;
+                        if (FMath::Abs(t) > HalfStep * (1. + 1.e-9))
+                        {
+                            continue;
+                        }
+                        const double miss[3] = { dr[0] + t * dv[0], dr[1] + t * dv[1], dr[2] + t * dv[2] };
+                        if (Dot(miss, miss) > Margin * Margin)
+                        {
+                            continue;
+                        }
+
+                        Found.Add(FCandidate { i, j, et + t });
+                    }
+                }
+
+                NumCandidates.fetch_add(Tested, std::memory_order_relaxed);
+                if (Found.Num() > 0)
+                {
+                    FScopeLock ScopeLock(&CandidatesLock);
+                    Candidates.Append(Found);
+                }
+            });
+        }
+
+        // Refine
+        TArray<FConjunction> Refined;
+        TArray<bool> bFound;
+        Refined.SetNum(Candidates.Num());
+        bFound.SetNumZeroed(Candidates.Num());
+
+        ParallelFor(Candidates.Num(), [&](int32 c)
+        {
+            const FCandidate& Candidate = Candidates[c];
+            const FPairRange Pair { Catalog[Candidate.Primary], Catalog[Candidate.Secondary] };
+
+            const double a = FMath::Max(Begin, Candidate.et - Step);
+            const double b = FMath::Min(End, Candidate.et + Step);
+            double ga, gb, Range, Speed;
+            if (!Pair(a, ga, Range, Speed) || !Pair(b, gb, Range, Speed) || !(ga < 0. && gb > 0.))
+            {
+                return;
+            }
+
+            FConjunction& Conjunction = Refined[c];
+            double g;
+            if (Pair.Root(a, b, ga, gb, Settings.Tolerance, Conjunction.TCA) && Pair(Conjunction.TCA, g, Range, Speed) && Range <= Settings.Threshold)
+            {
+                Conjunction.Primary = Candidate.Primary;
+                Conjunction.Secondary = Candidate.Secondary;
+                Conjunction.MissDistance = Range;
+                Conjunction.RelativeSpeed = Speed;
+                bFound[c] = true;
+            }
+        });
+
+        TArray<FConjunction> Found;
+        for (int32 c = 0; c < Refined.Num(); ++c)
+        {
+            if (bFound[c])
+            {
+                Found.Add(Refined[c]);
+            }
+        }
+
+        MergeApproaches(Found, Step, Conjunctions);
+
+        if (Stats)
+        {
+            Stats->Steps = NumSteps + 1;
+            Stats->Candidates = NumCandidates.load();
+            Stats->Refined = Candidates.Num();
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    TArray<FConjunctionShard> MakeConjunctionShards(
+        int32 NumObjects,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        int32 TimeSlices,
+        int32 ObjectRanges,
+        const FConjunctionSettings& Settings
+    )
+    {
+        TimeSlices = FMath::Max(1, TimeSlices);
+        ObjectRanges = FMath::Clamp(ObjectRanges, 1, FMath::Max(1, NumObjects));
+
+        // Primary i has N - 1 - i partners, so the first k/R of the pairs
+        // end at N (1 - sqrt(1 - k/R))
+        TArray<int32> Bounds;
+        Bounds.Add(0);
+        for (int32 k = 1; k < ObjectRanges; ++k)
+        {
+            const int32 Bound = FMath::RoundToInt(NumObjects * (1. - FMath::Sqrt(1. - double(k) / ObjectRanges)));
+            if (Bound > Bounds.Last() && Bound < NumObjects)
+            {
+                Bounds.Add(Bound);
+            }
+        }
+        Bounds.Add(MAX_int32);
+
+        // Slices overlap by a step, so an approach near a boundary is
+        // bracketed by one of them (MergeConjunctions drops the repeat)
+        const double Begin = Start.AsSpiceDouble();
+        const double End = Stop.AsSpiceDouble();
+        const double Slice = (End - Begin) / TimeSlices;
+        const double Pad = Settings.Step > 0. ? Settings.Step : 0.;
+
+        TArray<FConjunctionShard> Shards;
+        Shards.Reserve(TimeSlices * (Bounds.Num() - 1));
+        for (int32 t = 0; t < TimeSlices; ++t)
+        {
+            const double SliceStart = t == 0 ? Begin : FMath::Max(Begin, Begin + t * Slice - Pad);
+            const double SliceStop = t == TimeSlices - 1 ? End : FMath::Min(End, Begin + (t + 1) * Slice + Pad);
+            for (int32 r = 0; r + 1 < Bounds.Num(); ++r)
+            {
+                FConjunctionShard& Shard = Shards.AddDefaulted_GetRef();
+                Shard.PrimaryBegin = Bounds[r];
+                Shard.PrimaryEnd = Bounds[r + 1];
+                Shard.Start = SliceStart;
+                Shard.Stop = SliceStop;
+            }
+        }
+        return Shards;
+    }
+
+
+    void MergeConjunctions(
+        TArray<FConjunction>& Conjunctions,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        const FConjunctionSettings& Settings
+    )
+    {
+        const double Begin = Start.AsSpiceDouble();
+        const double End = Stop.AsSpiceDouble();
+
+        TArray<FConjunction> Found = MoveTemp(Conjunctions);
+        Found.RemoveAllSwap([Begin, End](const FConjunction& Conjunction) { return Conjunction.TCA < Begin || Conjunction.TCA > End; });
+        MergeApproaches(Found, Settings.Step, Conjunctions);
+    }
+
+
+    bool ScreenConjunctionsSharded(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        TArray<FConjunction>& Conjunctions,
+        int32 TimeSlices,
+        int32 ObjectRanges,
+        const FConjunctionSettings& Settings,
+        FConjunctionDispatcher Dispatch,
+        FConjunctionStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage,
+        FConjunctionPartial OnPartial
+    )
+    {
+        Conjunctions.Reset();
+        if (Stats) *Stats = FConjunctionStats();
+
+        const double Begin = Start.AsSpiceDouble();
+        const double End = Stop.AsSpiceDouble();
+        if (!(End >= Begin) || !SettingsAreValid(Settings))
+        {
+            return Fail(FString::Printf(TEXT("ScreenConjunctionsSharded: bad window [%f, %f] or settings (step %f, threshold %f, tolerance %f)"), Begin, End, Settings.Step, Settings.Threshold, Settings.Tolerance), ResultCode, ErrorMessage);
+        }
+
+        const TArray<FConjunctionShard> Shards = MakeConjunctionShards(Catalog.Num(), Start, Stop, TimeSlices, ObjectRanges, Settings);
+
+        if (!Dispatch && FSpiceProcessPool::Get().IsStarted())
+        {
+            Dispatch = [](FName JobName, TArray<uint8>&& Request)
+            {
+                return FSpiceProcessPool::Get().Dispatch(JobName, MoveTemp(Request));
+            };
+        }
+
+        FConjunctionStats Total;
+        TArray<FConjunction> Found;
+
+        // Shards come in slice by slice.  When a slice's are all in, what's
+        // left of Found before the next slice's reach is final.
+        TArray<FConjunction> Streamed;
+        double Through = Begin;
+        auto ShardDone = [&](int32 s)
+        {
+            const bool bLast = s == Shards.Num() - 1;
+            if (!OnPartial || (!bLast && Shards[s + 1].Start == Shards[s].Start))
+            {
+                return;
+            }
+
+            MergeConjunctions(Found, Start, Stop, Settings);
+            Through = bLast ? End : FMath::Max(Through, Shards[s + 1].Start - Settings.Step);
+
+            int32 NumFinal = Found.Num();
+            if (!bLast)
+            {
+                NumFinal = Algo::LowerBoundBy(Found, Through, [](const FConjunction& Conjunction) { return Conjunction.TCA; });
+            }
+
+            TArray<FConjunction> Final(Found.GetData(), NumFinal);
+            Found.RemoveAt(0, NumFinal);
+            Streamed.Append(Final);
+            OnPartial(Final, FSEphemerisTime(Through));
+        };
+
+        if (!Dispatch)
+        {
+            // Here, one after another
+            for (int32 s = 0; s < Shards.Num(); ++s)
+            {
+                FConjunctionStats ShardStats;
+                TArray<FConjunction> ShardConjunctions;
+                if (!ScreenConjunctions(Catalog, Shards[s], ShardConjunctions, Settings, &ShardStats, ResultCode, ErrorMessage))
+                {
+                    return false;
+                }
+                Total.Steps += ShardStats.Steps;
+                Total.Candidates += ShardStats.Candidates;
+                Total.Refined += ShardStats.Refined;
+                Found.Append(ShardConjunctions);
+                ShardDone(s);
+            }
+        }
+        else
+        {
+            // The catalog is the same for every shard
+            TArray<uint8> CatalogBytes;
+            {
+                FMemoryWriter Writer(CatalogBytes);
+                SaveCatalog(Writer, Catalog);
+            }
+
+            TArray<TFuture<FSpiceJobResult>> Futures;
+            Futures.Reserve(Shards.Num());
+            for (const FConjunctionShard& Shard : Shards)
+            {
+                TArray<uint8> Request;
+                FMemoryWriter Writer(Request);
+                FConjunctionSettings ShardSettings = Settings;
+                FConjunctionShard ShardCopy = Shard;
+                SerializeHeader(Writer, ShardSettings, ShardCopy);
+                Request.Append(CatalogBytes);
+                Futures.Add(Dispatch(FName(ScreenJobName), MoveTemp(Request)));
+            }
+
+            // Every future is waited on, failed or not.  In order, so the
+            // slices finish in order.
+            FString FirstError;
+            for (int32 s = 0; s < Futures.Num(); ++s)
+            {
+                FSpiceJobResult Result = Futures[s].Get();
+                if (!FirstError.IsEmpty())
+                {
+                    continue;
+                }
+                if (!Result.bSuccess)
+                {
+                    FirstError = Result.ErrorMessage.IsEmpty() ? FString(TEXT("ScreenConjunctionsSharded: a shard failed")) : Result.ErrorMessage;
+                    continue;
+                }
+
+                FConjunctionStats ShardStats;
+                TArray<FConjunction> ShardConjunctions;
+                FMemoryReader Reader(Result.Response);
+                SerializeResponse(Reader, ShardStats, ShardConjunctions);
+                if (Reader.IsError())
+                {
+                    FirstError = TEXT("ScreenConjunctionsSharded: malformed shard response");
+                    continue;
+                }
+                Total.Steps += ShardStats.Steps;
+                Total.Candidates += ShardStats.Candidates;
+                Total.Refined += ShardStats.Refined;
+                Found.Append(ShardConjunctions);
+                ShardDone(s);
+            }
+
+            if (!FirstError.IsEmpty())
+            {
+                return Fail(FirstError, ResultCode, ErrorMessage);
+            }
+        }
+
+        if (OnPartial)
+        {
+            Conjunctions = MoveTemp(Streamed);
+        }
+        else
+        {
+            Conjunctions = MoveTemp(Found);
+            MergeConjunctions(Conjunctions, Start, Stop, Settings);
+        }
+
+        if (Stats) *Stats = Total;
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+}
@@ -0,0 +1,281 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceContext.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Kernel sets that share one CSPICE image without interfering.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceContext.cpp is part of the "refined C++ API".
+//
+// The reference counts are process wide, under their own lock (never held
+// while calling CSPICE).  A global ClearAll bumps ClearGeneration rather than
+// reaching into every context;  each context notices on its next use.
+//------------------------------------------------------------------------------
+
+#include "SpiceContext.h"
+#include "SpiceCore.h"
+#include "SpiceLock.h"
+#include "SpiceUtilities.h"
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    FCriticalSection ContextLock;
+    // Absolute path -> how many contexts hold it
+    TMap<FString, int32> RefCounts;
+    uint64 GlobalClearGeneration = 0;
+    // 0 is the process's own kernel history (FSpiceProcessPool)
+    uint64 NextId = 1;
+
+    thread_local MaxQ::Core::FSpiceContext* CurrentContext = nullptr;
+
+    void SetError(ES_ResultCode* ResultCode, FString* ErrorMessage, const FString& Message)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+    }
+}
+
+namespace MaxQ::Private
+{
+    void ForgetContextKernels()
+    {
+        FScopeLock Lock(&ContextLock);
+        RefCounts.Empty();
+        ++GlobalClearGeneration;
+    }
+}
+
+namespace MaxQ::Core
+{
+    FSpiceContext::FSpiceContext(const FString& InName)
+        : Name(InName)
+    {
+        FScopeLock Lock(&ContextLock);
+        Id = NextId++;
+        ClearGeneration = GlobalClearGeneration;
+    }
+
+
+    FSpiceContext::~FSpiceContext()
+    {
+        ClearAll();
+        check(CurrentContext != this);
+    }
+
+
+    void FSpiceContext::Sync() const
+    {
+        FScopeLock Lock(&ContextLock);
+        if (ClearGeneration != GlobalClearGeneration)
+        {
+            ClearGeneration = GlobalClearGeneration;
+            Kernels.Empty();
+            ++Generation;
+        }
+    }
+
+
+    bool FSpiceContext::Furnsh(const FString& RelativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        return Furnsh(TArray<FString>{ RelativePath }, ResultCode, ErrorMessage);
+    }
+
+
+    bool FSpiceContext::Furnsh(const TArray<FString>& RelativePaths, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Sync();
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+
+        // Only what no context holds yet is loaded
+        TArray<FString> ToLoad;
+        {
+            FScopeLock Lock(&ContextLock);
+            for (const FString& RelativePath : RelativePaths)
+            {
+                const FString Path = toPath(RelativePath);
+                if (Kernels.Contains(Path))
+                {
+                    continue;
+                }
+                if (int32* Count = RefCounts.Find(Path))
+                {
+                    ++*Count;
+                    Kernels.Add(Path);
+                    ++Generation;
+                }
+                else
+                {
+                    ToLoad.AddUnique(Path);
+                }
+            }
+        }
+
+        if (ToLoad.Num() == 0)
+        {
+            return true;
+        }
+
+        // The list Furnsh skips the files that fail, so what loaded is read
+        // back from the history it appended to
+        TArray<MaxQ::Data::FKernelHistoryEntry> Before;
+        MaxQ::Data::GetKernelHistory(Before);
+        const bool bSuccess = MaxQ::Data::Furnsh(ToLoad, ResultCode, ErrorMessage);
+        TArray<MaxQ::Data::FKernelHistoryEntry> After;
+        MaxQ::Data::GetKernelHistory(After);
+
+        FScopeLock Lock(&ContextLock);
+        for (int32 i = After.Num() >= Before.Num() ? Before.Num() : 0; i < After.Num(); ++i)
+        {
+            const MaxQ::Data::FKernelHistoryEntry& Entry = After[i];
+            if (Entry.Operation == MaxQ::Data::FKernelHistoryEntry::EOperation::Furnsh && ToLoad.Contains(Entry.AbsolutePath) && !Kernels.Contains(Entry.AbsolutePath))
+            {
+                ++RefCounts.FindOrAdd(Entry.AbsolutePath);
+                Kernels.Add(Entry.AbsolutePath);
+                ++Generation;
+            }
+        }
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE Context '%s' holds %d kernels"), *Name, Kernels.Num());
+        return bSuccess;
+    }
+
+
+    bool FSpiceContext::Unload(const FString& RelativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Sync();
+        const FString Path = toPath(RelativePath);
+
+        bool bLast = false;
+        {
+            FScopeLock Lock(&ContextLock);
+            if (Kernels.Remove(Path) == 0)
+            {
+                SetError(ResultCode, ErrorMessage, FString::Printf(TEXT("MaxQ SPICE Context '%s' did not furnish %s"), *Name, *Path));
+                return false;
+            }
+            ++Generation;
+
+            int32& Count = RefCounts.FindOrAdd(Path);
+            bLast = --Count <= 0;
+            if (bLast)
+            {
+                RefCounts.Remove(Path);
+            }
+        }
+
+        if (!bLast)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Success;
+            return true;
+        }
+        return MaxQ::Data::Unload(Path, ResultCode, ErrorMessage);
+    }
+
+
+    void FSpiceContext::ClearAll()
+    {
+        Sync();
+
+        TArray<FString> Unloading;
+        {
+            FScopeLock Lock(&ContextLock);
+            for (const FString& Path : Kernels)
+            {
+                int32& Count = RefCounts.FindOrAdd(Path);
+                if (--Count <= 0)
+                {
+                    RefCounts.Remove(Path);
+                    Unloading.Add(Path);
+                }
+            }
+            Kernels.Empty();
+            ++Generation;
+        }
+
+        // Last loaded, first unloaded
+        for (int32 i = Unloading.Num() - 1; i >= 0; --i)
+        {
+            MaxQ::Data::Unload(Unloading[i]);
+        }
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE Context '%s' 'Clear All' unloaded %d kernels"), *Name, Unloading.Num());
+    }
+
+
+    void FSpiceContext::InitAll()
+    {
+        ClearAll();
+
+        FSpiceScope Scope;
+        Reset();
+    }
+
+
+    TArray<FString> FSpiceContext::GetKernels() const
+    {
+        Sync();
+        FScopeLock Lock(&ContextLock);
+        return Kernels;
+    }
+
+
+    uint64 FSpiceContext::GetKernelHistory(TArray<MaxQ::Data::FKernelHistoryEntry>& History) const
+    {
+        Sync();
+        FScopeLock Lock(&ContextLock);
+        History.Reset(Kernels.Num());
+        for (const FString& Path : Kernels)
+        {
+            History.Add(MaxQ::Data::FKernelHistoryEntry{ MaxQ::Data::FKernelHistoryEntry::EOperation::Furnsh, Path });
+        }
+        return Generation;
+    }
+
+
+    TFuture<FSpiceJobResult> FSpiceContext::Dispatch(FName JobName, TArray<uint8>&& Request) const
+    {
+        TArray<MaxQ::Data::FKernelHistoryEntry> History;
+        const uint64 KernelGeneration = GetKernelHistory(History);
+        return FSpiceProcessPool::Get().Dispatch(JobName, MoveTemp(Request), Id, MoveTemp(History), KernelGeneration);
+    }
+
+
+    FSpiceContext* FSpiceContext::Current()
+    {
+        return CurrentContext;
+    }
+
+
+    void FSpiceContext::SetCurrent(FSpiceContext* Context)
+    {
+        CurrentContext = Context;
+    }
+
+
+    FSpiceContextScope::FSpiceContextScope(FSpiceContext* Context)
+        : Previous(CurrentContext)
+    {
+        CurrentContext = Context;
+    }
+
+
+    FSpiceContextScope::~FSpiceContextScope()
+    {
+        CurrentContext = Previous;
+    }
+}
@@ -0,0 +1,106 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceContextSubsystem.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A SPICE context (kernel set) per PIE world.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceContextSubsystem.cpp is part of the "Blueprints API".
+//
+// Every instance sees every world's tick start:  the ticking world's
+// instance makes its context current, and the others only clear theirs, so
+// a world without one (the editor's) runs with none.
+//------------------------------------------------------------------------------
+
+#include "SpiceContextSubsystem.h"
+#include "Engine/World.h"
+#include "SpiceContext.h"
+
+using MaxQ::Core::FSpiceContext;
+
+
+UMaxQSpiceContextSubsystem::UMaxQSpiceContextSubsystem()
+{
+}
+
+
+UMaxQSpiceContextSubsystem::~UMaxQSpiceContextSubsystem()
+{
+}
+
+
+bool UMaxQSpiceContextSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    const UWorld* World = Cast<UWorld>(Outer);
+    if (!World || !Super::ShouldCreateSubsystem(Outer))
+    {
+        return false;
+    }
+
+    const UMaxQSpiceContextSubsystem* Defaults = GetDefault<UMaxQSpiceContextSubsystem>();
+    return (World->WorldType == EWorldType::PIE && Defaults->bInPIE) || (World->WorldType == EWorldType::Game && Defaults->bInGame);
+}
+
+
+void UMaxQSpiceContextSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    Context = MakeUnique<FSpiceContext>(GetWorld()->GetName());
+    TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UMaxQSpiceContextSubsystem::OnWorldTickStart);
+}
+
+
+void UMaxQSpiceContextSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // Actors' BeginPlay comes next, and that's where Init All usually is
+    FSpiceContext::SetCurrent(Context.Get());
+}
+
+
+void UMaxQSpiceContextSubsystem::OnWorldTickStart(UWorld* TickingWorld, ELevelTick TickType, float DeltaSeconds)
+{
+    if (TickingWorld == GetWorld())
+    {
+        FSpiceContext::SetCurrent(Context.Get());
+    }
+    else if (FSpiceContext::Current() == Context.Get())
+    {
+        FSpiceContext::SetCurrent(nullptr);
+    }
+}
+
+
+TArray<FString> UMaxQSpiceContextSubsystem::GetKernels() const
+{
+    return Context ? Context->GetKernels() : TArray<FString>();
+}
+
+
+void UMaxQSpiceContextSubsystem::Deinitialize()
+{
+    FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+
+    if (FSpiceContext::Current() == Context.Get())
+    {
+        FSpiceContext::SetCurrent(nullptr);
+    }
+    Context.Reset();
+
+    Super::Deinitialize();
+}
@@ -19,10 +19,20 @@
 //    * Blueprints
 //
 // SpiceCore.cpp is part of the "refined C++ API".
+//
+// EnsureInitialized marks itself done before it anchors the clock, because
+// anchoring takes an FSpiceScope, which calls back into it.  The error
+// settings are made first, so no thread gets past the flag before them.
 //------------------------------------------------------------------------------
 
 #include "SpiceCore.h"
+#include "SpiceExecutor.h"
+#include "SpiceMemory.h"
+#include "SpiceNameRegistry.h"
+#include "SpiceTime.h"
 #include "SpiceUtilities.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 extern "C"
@@ -33,10 +43,18 @@ PRAGMA_POP_PLATFORM_DEFAULT_PACKING
 
 using namespace MaxQ::Private;
 
+namespace
+{
+    std::atomic<bool> bInitialized{ false };
+    FCriticalSection InitLock;
+}
+
 namespace MaxQ::Core
 {
     SPICE_API void InitAll(bool PrintCallstack)
     {
+        EnsureInitialized();
+
         Reset();
         ClearAll();
         char szBuffer[SpiceLongMessageMaxLength];
@@ -86,7 +104,63 @@ namespace MaxQ::Core
     {
         kclear_c();
         clpool_c();
+        ClearKernelHistory();
 
         UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Clear All' cleared kernel memory & pool"));
     }
+
+
+    SPICE_API void EnsureInitialized()
+    {
+        if (bInitialized.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        FScopeLock Lock(&InitLock);
+        if (bInitialized.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        char szBuffer[SpiceLongMessageMaxLength];
+
+        SpiceStringCopy(szBuffer, "SHORT,LONG");
+        errprt_c("SET", sizeof(szBuffer), szBuffer);
+
+        SpiceStringCopy(szBuffer, "REPORT");
+        erract_c("SET", sizeof(szBuffer), szBuffer);
+
+        SpiceStringCopy(szBuffer, "NULL");
+        errdev_c("SET", sizeof(szBuffer), szBuffer);
+
+        bInitialized.store(true, std::memory_order_release);
+
+        // The engine-wide ET clock
+        MaxQ::Time::GetEtClock().AnchorToNow();
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ initialized on first use"));
+    }
+
+
+    SPICE_API bool IsInitialized()
+    {
+        return bInitialized.load(std::memory_order_acquire);
+    }
+
+
+    SPICE_API void WarmUp(bool bStartExecutor)
+    {
+        MAXQ_LLM_SCOPE();
+
+        EnsureInitialized();
+
+        MaxQ::Time::UpdateTimeSystem();
+        MaxQ::Data::UpdateNameRegistry();
+
+        if (bStartExecutor)
+        {
+            FSpiceExecutor::Get();
+        }
+    }
 }
@@ -0,0 +1,374 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCovariance.cpp
+//
+// Implementation Comments
+//
+// Purpose:  State covariance propagation and collision probability.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCovariance.cpp is part of the "refined C++ API".
+//
+// Transform works a block of W objects at a time, with the lane index
+// innermost, so each multiply-add is a W wide vector operation.
+//
+// Collision probability:  in the encounter plane, x is along the miss
+// vector and y = v x x.  The 2x2 covariance is diagonalized (sx, sy), and
+// the hard body circle, center (mx, my), is swept in x as
+// x = mx + R sin(phi).  Across the circle at x, y runs my +/- R cos(phi),
+// and the Gaussian's integral over that is
+//    (erf((my + R cos(phi)) / (sqrt(2) sy)) - erf((my - R cos(phi)) / (sqrt(2) sy))) / 2
+// which leaves a smooth integral over phi in [-pi/2, pi/2] (Simpson's rule).
+//------------------------------------------------------------------------------
+
+#include "SpiceCovariance.h"
+#include "SpiceSGP4.h"
+#include "SpiceConjunction.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    using namespace MaxQ::Orbits;
+
+    constexpr int32 W = FCovarianceBatch::Lanes;
+    constexpr double pi = 3.14159265358979323846;
+
+    // Rows per ParallelFor task
+    constexpr int32 BatchRows = 256;
+    static_assert(BatchRows % W == 0, "BatchRows must be a multiple of the lane width");
+
+    // Simpson intervals across the hard body circle (even)
+    constexpr int32 Intervals = 64;
+
+    // P = Phi P Phi^T, one object
+    void TransformCovariance(const double(&Phi)[6][6], double(&P)[6][6])
+    {
+        double T[6][6];
+        for (int32 r = 0; r < 6; ++r)
+        {
+            for (int32 c = 0; c < 6; ++c)
+            {
+                double s = 0.;
+                for (int32 k = 0; k < 6; ++k) s += Phi[r][k] * P[k][c];
+                T[r][c] = s;
+            }
+        }
+        for (int32 r = 0; r < 6; ++r)
+        {
+            for (int32 c = r; c < 6; ++c)
+            {
+                double s = 0.;
+                for (int32 k = 0; k < 6; ++k) s += T[r][k] * Phi[c][k];
+                P[r][c] = P[c][r] = s;
+            }
+        }
+    }
+
+    inline double Dot(const double(&a)[3], const double(&b)[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+}
+
+namespace MaxQ::Orbits
+{
+    void FCovarianceBatch::SetNum(int32 Num)
+    {
+        NumObjects = Num;
+        Rows = (Num + W - 1) / W * W;
+        Columns.SetNumZeroed(NumElements * Rows);
+    }
+
+
+    void FCovarianceBatch::Reset()
+    {
+        Columns.Empty();
+        Rows = 0;
+        NumObjects = 0;
+    }
+
+
+    SIZE_T FCovarianceBatch::GetAllocatedSize() const
+    {
+        return Columns.GetAllocatedSize();
+    }
+
+
+    void FCovarianceBatch::Set(int32 i, const double(&P)[6][6])
+    {
+        check(i >= 0 && i < NumObjects);
+        for (int32 r = 0; r < 6; ++r)
+        {
+            for (int32 c = r; c < 6; ++c)
+            {
+                Columns[Element(r, c) * Rows + i] = P[r][c];
+            }
+        }
+    }
+
+
+    void FCovarianceBatch::Get(int32 i, double(&P)[6][6]) const
+    {
+        check(i >= 0 && i < NumObjects);
+        for (int32 r = 0; r < 6; ++r)
+        {
+            for (int32 c = r; c < 6; ++c)
+            {
+                P[r][c] = P[c][r] = Columns[Element(r, c) * Rows + i];
+            }
+        }
+    }
+
+
+    void FCovarianceBatch::Transform(TArrayView<const FSStateTransform> Phi)
+    {
+        check(Phi.Num() == 1 || Phi.Num() >= NumObjects);
+        if (NumObjects == 0)
+        {
+            return;
+        }
+
+        const int32 NumTasks = (Rows + BatchRows - 1) / BatchRows;
+
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 First = Task * BatchRows;
+            const int32 Last = FMath::Min(First + BatchRows, Rows);
+
+            for (int32 Row = First; Row < Last; Row += W)
+            {
+                // Padding lanes reuse the last object's transform, of zeros
+                double F[6][6][W], P[6][6][W], T[6][6][W];
+                for (int32 l = 0; l < W; ++l)
+                {
+                    const int32 i = Phi.Num() == 1 ? 0 : FMath::Min(Row + l, NumObjects - 1);
+                    const double(&f)[6][6] = Phi[i].AsSpiceDoubleArray();
+                    for (int32 r = 0; r < 6; ++r)
+                    {
+                        for (int32 c = 0; c < 6; ++c)
+                        {
+                            F[r][c][l] = f[r][c];
+                        }
+                    }
+                }
+
+                for (int32 r = 0; r < 6; ++r)
+                {
+                    for (int32 c = r; c < 6; ++c)
+                    {
+                        const double* p = &Columns[Element(r, c) * Rows + Row];
+                        for (int32 l = 0; l < W; ++l)
+                        {
+                            P[r][c][l] = P[c][r][l] = p[l];
+                        }
+                    }
+                }
+
+                // T = F P
+                for (int32 r = 0; r < 6; ++r)
+                {
+                    for (int32 c = 0; c < 6; ++c)
+                    {
+                        double s[W] = { 0. };
+                        for (int32 k = 0; k < 6; ++k)
+                        {
+                            for (int32 l = 0; l < W; ++l) s[l] += F[r][k][l] * P[k][c][l];
+                        }
+                        for (int32 l = 0; l < W; ++l) T[r][c][l] = s[l];
+                    }
+                }
+
+                // P = T F^T (upper triangle)
+                for (int32 r = 0; r < 6; ++r)
+                {
+                    for (int32 c = r; c < 6; ++c)
+                    {
+                        double s[W] = { 0. };
+                        for (int32 k = 0; k < 6; ++k)
+                        {
+                            for (int32 l = 0; l < W; ++l) s[l] += T[r][k][l] * F[c][k][l];
+                        }
+
+                        double* p = &Columns[Element(r, c) * Rows + Row];
+                        for (int32 l = 0; l < W; ++l) p[l] = s[l];
+                    }
+                }
+            }
+        }, NumTasks == 1);
+    }
+
+
+    bool CollisionProbability(const double(&r)[3], const double(&v)[3], const double(&P)[3][3], double HardBodyRadius, double& Pc)
+    {
+        Pc = 0.;
+
+        const double vm = sqrt(Dot(v, v));
+        if (vm == 0. || !(HardBodyRadius > 0.))
+        {
+            return false;
+        }
+        const double vhat[3] = { v[0] / vm, v[1] / vm, v[2] / vm };
+
+        // Encounter plane basis:  x along the miss (or anything normal to v,
+        // for a direct hit), y = v x x
+        const double along = Dot(r, vhat);
+        double x[3] = { r[0] - along * vhat[0], r[1] - along * vhat[1], r[2] - along * vhat[2] };
+        double miss = sqrt(Dot(x, x));
+        if (miss == 0.)
+        {
+            const int32 k = FMath::Abs(vhat[0]) < .9 ? 0 : 1;
+            const double e[3] = { k == 0 ? 1. : 0., k == 1 ? 1. : 0., 0. };
+            const double d = Dot(e, vhat);
+            x[0] = e[0] - d * vhat[0]; x[1] = e[1] - d * vhat[1]; x[2] = e[2] - d * vhat[2];
+            const double m = sqrt(Dot(x, x));
+            x[0] /= m; x[1] /= m; x[2] /= m;
+        }
+        else
+        {
+            x[0] /= miss; x[1] /= miss; x[2] /= miss;
+        }
+        const double y[3] = {
+            vhat[1] * x[2] - vhat[2] * x[1],
+            vhat[2] * x[0] - vhat[0] * x[2],
+            vhat[0] * x[1] - vhat[1] * x[0]
+        };
+
+        // C = B^T P B
+        double Px[3], Py[3];
+        for (int32 j = 0; j < 3; ++j)
+        {
+            Px[j] = P[j][0] * x[0] + P[j][1] * x[1] + P[j][2] * x[2];
+            Py[j] = P[j][0] * y[0] + P[j][1] * y[1] + P[j][2] * y[2];
+        }
+        const double cxx = Dot(x, Px), cyy = Dot(y, Py), cxy = Dot(x, Py);
+
+        // Principal axes
+        const double mean = (cxx + cyy) / 2.;
+        const double radius = sqrt(((cxx - cyy) / 2.) * ((cxx - cyy) / 2.) + cxy * cxy);
+        const double l1 = mean + radius, l2 = mean - radius;
+        if (!(l2 > 0.) || !FMath::IsFinite(l1))
+        {
+            return false;
+        }
+        const double theta = .5 * atan2(2. * cxy, cxx - cyy);
+        const double ct = cos(theta), st = sin(theta);
+        const double mx = miss * ct;
+        const double my = -miss * st;
+        const double sx = sqrt(l1), sy = sqrt(l2);
+
+        const double R = HardBodyRadius;
+        const double root2sy = sqrt(2.) * sy;
+        auto Integrand = [&](double phi)
+        {
+            const double u = mx + R * sin(phi);
+            const double h = R * cos(phi);
+            const double across = .5 * (erf((my + h) / root2sy) - erf((my - h) / root2sy));
+            return h * exp(-.5 * (u / sx) * (u / sx)) / (sqrt(2. * pi) * sx) * across;
+        };
+
+        const double step = pi / Intervals;
+        double sum = Integrand(-pi / 2.) + Integrand(pi / 2.);
+        for (int32 i = 1; i < Intervals; ++i)
+        {
+            sum += (i % 2 ? 4. : 2.) * Integrand(-pi / 2. + i * step);
+        }
+
+        Pc = FMath::Clamp(sum * step / 3., 0., 1.);
+        return true;
+    }
+
+
+    int32 ConjunctionProbabilities(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FCovarianceBatch& Covariances,
+        TArrayView<const FConjunction> Conjunctions,
+        double HardBodyRadius,
+        TArrayView<double> Pc
+    )
+    {
+        check(Covariances.Num() >= Catalog.Num());
+        check(Pc.Num() >= Conjunctions.Num());
+
+        // An object's state at TCA, and its covariance carried there
+        auto AtTca = [&](int32 Object, double tca, double(&state)[6], double(&P)[6][6]) -> bool
+        {
+            if (!Catalog.IsValidIndex(Object) || !Catalog[Object].IsValid())
+            {
+                return false;
+            }
+
+            const FSGP4Propagator& Propagator = Catalog[Object];
+            const FSGP4Model& Model = Propagator.GetModel();
+
+            double s0[6];
+            if (Propagator.Propagate(Model.Epoch, s0) != ESGP4Status::Ok || Propagator.Propagate(tca, state) != ESGP4Status::Ok)
+            {
+                return false;
+            }
+
+            // xke is sqrt(mu), in earth radii^1.5 per minute
+            const double gm = FMath::Square(Model.xke / 60.) * Model.er * Model.er * Model.er;
+
+            FSStateVector propagated;
+            FSStateTransform stm;
+            bool bValid = false;
+            const FSStateVector initial(s0);
+            const FSEphemerisPeriod offset(tca - Model.Epoch);
+            Prop2bBatch(FSMassConstant(gm), MakeArrayView(&initial, 1), MakeArrayView(&offset, 1), MakeArrayView(&propagated, 1), MakeArrayView(&stm, 1), MakeArrayView(&bValid, 1));
+            if (!bValid)
+            {
+                return false;
+            }
+
+            Covariances.Get(Object, P);
+            TransformCovariance(stm.AsSpiceDoubleArray(), P);
+            return true;
+        };
+
+        TArray<bool> Evaluated;
+        Evaluated.SetNumZeroed(Conjunctions.Num());
+
+        ParallelFor(Conjunctions.Num(), [&](int32 i)
+        {
+            const FConjunction& Conjunction = Conjunctions[i];
+            Pc[i] = 0.;
+
+            double s1[6], s2[6], P1[6][6], P2[6][6];
+            if (!AtTca(Conjunction.Primary, Conjunction.TCA, s1, P1) || !AtTca(Conjunction.Secondary, Conjunction.TCA, s2, P2))
+            {
+                return;
+            }
+
+            const double r[3] = { s2[0] - s1[0], s2[1] - s1[1], s2[2] - s1[2] };
+            const double v[3] = { s2[3] - s1[3], s2[4] - s1[4], s2[5] - s1[5] };
+            double P[3][3];
+            for (int32 j = 0; j < 3; ++j)
+            {
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    P[j][k] = P1[j][k] + P2[j][k];
+                }
+            }
+
+            Evaluated[i] = CollisionProbability(r, v, P, HardBodyRadius, Pc[i]);
+        });
+
+        int32 Total = 0;
+        for (bool bEvaluated : Evaluated)
+        {
+            Total += bEvaluated;
+        }
+        return Total;
+    }
+}
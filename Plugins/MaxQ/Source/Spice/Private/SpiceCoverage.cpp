@@ -0,0 +1,362 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCoverage.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Constellation coverage statistics over a ground grid.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCoverage.cpp is part of the "refined C++ API".
+//
+// Visibility is tested without trig or a square root:  with d the cell to
+// satellite vector and h its zenith component, the satellite's above a mask
+// m >= 0 when h >= 0 and h^2 >= sin^2(m) |d|^2.  The test is a branch free
+// sum over the satellites' coordinate arrays.
+//------------------------------------------------------------------------------
+
+#include "SpiceCoverage.h"
+#include "SpiceMathBatch.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // Cells per task:  each is a pass over every satellite
+    constexpr int32 ChunkSize = 256;
+    // Satellites per step, at most (Counts are uint16)
+    constexpr int32 MaxSatellites = MAX_uint16;
+
+    // Satellites above the mask from one cell
+    template<bool bNegativeMask>
+    int32 CountVisible(const double* SatX, const double* SatY, const double* SatZ, int32 Num, double px, double py, double pz, double zx, double zy, double zz, double SinMask2)
+    {
+        int32 Count = 0;
+        for (int32 j = 0; j < Num; ++j)
+        {
+            const double dx = SatX[j] - px, dy = SatY[j] - py, dz = SatZ[j] - pz;
+            const double h = dx * zx + dy * zy + dz * zz;
+            const double dd = dx * dx + dy * dy + dz * dz;
+            if constexpr (bNegativeMask)
+            {
+                Count += int32((h >= 0.) | (h * h <= SinMask2 * dd));
+            }
+            else
+            {
+                Count += int32((h >= 0.) & (h * h >= SinMask2 * dd));
+            }
+        }
+        return Count;
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    bool FCoverageAnalysis::Begin(const FCoverageGrid& InGrid, const FCoverageSettings& InSettings)
+    {
+        X.Reset(); Y.Reset(); Z.Reset();
+        Zenith.Reset();
+        Counts.Reset();
+        FoldSeconds.Reset();
+        GapStart.Reset();
+        GapSeconds.Reset();
+        LongestGap.Reset();
+        Gaps.Reset();
+        Duration = 0.;
+        bHasStep = false;
+        bEnded = false;
+
+        if (InGrid.Width <= 0 || InGrid.Height <= 0 || !(InGrid.MaxLongitude > InGrid.MinLongitude) || !(InGrid.MaxLatitude > InGrid.MinLatitude)
+            || InSettings.MaxFold < 1 || !(FMath::Abs(InSettings.MinElevation) <= HALF_PI))
+        {
+            return false;
+        }
+        Grid = InGrid;
+        Settings = InSettings;
+
+        const int32 Num = Grid.Width * Grid.Height;
+        TArray<double> Lon, Lat, Alt;
+        Lon.SetNumUninitialized(Num);
+        Lat.SetNumUninitialized(Num);
+        Alt.Init(Grid.Altitude, Num);
+        const double dLon = (Grid.MaxLongitude - Grid.MinLongitude) / Grid.Width;
+        const double dLat = (Grid.MaxLatitude - Grid.MinLatitude) / Grid.Height;
+        for (int32 y = 0; y < Grid.Height; ++y)
+        {
+            for (int32 x = 0; x < Grid.Width; ++x)
+            {
+                Lon[y * Grid.Width + x] = Grid.MinLongitude + (x + .5) * dLon;
+                Lat[y * Grid.Width + x] = Grid.MinLatitude + (y + .5) * dLat;
+            }
+        }
+
+        X.SetNumUninitialized(Num); Y.SetNumUninitialized(Num); Z.SetNumUninitialized(Num);
+        if (!MaxQ::Math::Georec(Lon, Lat, Alt, Grid.Re, Grid.F, MaxQ::Math::FVectorBatch{ X, Y, Z }))
+        {
+            X.Reset(); Y.Reset(); Z.Reset();
+            return false;
+        }
+
+        // Geodetic up
+        Zenith.SetNumUninitialized(Num);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const double coslat = FMath::Cos(Lat[i]);
+            Zenith[i] = FVector3d(coslat * FMath::Cos(Lon[i]), coslat * FMath::Sin(Lon[i]), FMath::Sin(Lat[i]));
+        }
+
+        Counts.SetNumZeroed(Num);
+        FoldSeconds.SetNumZeroed(Num * Settings.MaxFold);
+        GapStart.SetNumZeroed(Num);
+        GapSeconds.SetNumZeroed(Num);
+        LongestGap.SetNumZeroed(Num);
+        Gaps.SetNumZeroed(Num);
+        return true;
+    }
+
+
+    void FCoverageAnalysis::Accumulate(double et)
+    {
+        const double dt = et - LastStep;
+        const int32 MaxFold = Settings.MaxFold;
+        ParallelFor((Num() + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num());
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const int32 Fold = FMath::Min<int32>(Counts[i], MaxFold);
+                double* Seconds = &FoldSeconds[i * MaxFold];
+                for (int32 k = 0; k < Fold; ++k)
+                {
+                    Seconds[k] += dt;
+                }
+            }
+        }, Num() <= ChunkSize);
+        Duration += dt;
+    }
+
+
+    bool FCoverageAnalysis::AddStep(double et, TArrayView<const FSDistanceVector> Positions, TArrayView<const bool> Valid)
+    {
+        if (Num() == 0 || bEnded || (bHasStep && !(et > LastStep)) || (Valid.Num() > 0 && Valid.Num() != Positions.Num()))
+        {
+            return false;
+        }
+
+        SatX.Reset(Positions.Num()); SatY.Reset(Positions.Num()); SatZ.Reset(Positions.Num());
+        for (int32 j = 0; j < Positions.Num() && SatX.Num() < MaxSatellites; ++j)
+        {
+            if (Valid.Num() == 0 || Valid[j])
+            {
+                SatX.Add(Positions[j].x.km);
+                SatY.Add(Positions[j].y.km);
+                SatZ.Add(Positions[j].z.km);
+            }
+        }
+
+        if (bHasStep)
+        {
+            Accumulate(et);
+        }
+
+        const bool bFirst = !bHasStep;
+        const double sinmask = FMath::Sin(Settings.MinElevation);
+        const double SinMask2 = sinmask * sinmask;
+        const bool bNegativeMask = Settings.MinElevation < 0.;
+        const int32 NumSatellites = SatX.Num();
+
+        ParallelFor((Num() + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num());
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const FVector3d& z = Zenith[i];
+                const int32 Count = bNegativeMask
+                    ? CountVisible<true>(SatX.GetData(), SatY.GetData(), SatZ.GetData(), NumSatellites, X[i], Y[i], Z[i], z.X, z.Y, z.Z, SinMask2)
+                    : CountVisible<false>(SatX.GetData(), SatY.GetData(), SatZ.GetData(), NumSatellites, X[i], Y[i], Z[i], z.X, z.Y, z.Z, SinMask2);
+
+                // Gap edges
+                const bool bWasCovered = !bFirst && Counts[i] > 0;
+                if (Count > 0 && !bWasCovered && !bFirst)
+                {
+                    const double Gap = et - GapStart[i];
+                    GapSeconds[i] += Gap;
+                    LongestGap[i] = FMath::Max(LongestGap[i], Gap);
+                    ++Gaps[i];
+                }
+                else if (Count == 0 && (bWasCovered || bFirst))
+                {
+                    GapStart[i] = et;
+                }
+                Counts[i] = uint16(Count);
+            }
+        }, Num() <= ChunkSize);
+
+        LastStep = et;
+        bHasStep = true;
+        return true;
+    }
+
+
+    void FCoverageAnalysis::End(double et)
+    {
+        if (!bHasStep || bEnded || !(et >= LastStep))
+        {
+            return;
+        }
+        Accumulate(et);
+
+        for (int32 i = 0; i < Num(); ++i)
+        {
+            if (Counts[i] == 0)
+            {
+                const double Gap = et - GapStart[i];
+                GapSeconds[i] += Gap;
+                LongestGap[i] = FMath::Max(LongestGap[i], Gap);
+                ++Gaps[i];
+            }
+        }
+        LastStep = et;
+        bEnded = true;
+    }
+
+
+    FSDistanceVector FCoverageAnalysis::GetCellPosition(int32 Cell) const
+    {
+        return FSDistanceVector(X[Cell], Y[Cell], Z[Cell]);
+    }
+
+
+    double FCoverageAnalysis::FoldFraction(int32 Cell, int32 K) const
+    {
+        if (K < 1 || K > Settings.MaxFold || !(Duration > 0.))
+        {
+            return 0.;
+        }
+        return FoldSeconds[Cell * Settings.MaxFold + K - 1] / Duration;
+    }
+
+
+    SIZE_T FCoverageAnalysis::GetAllocatedSize() const
+    {
+        return X.GetAllocatedSize() + Y.GetAllocatedSize() + Z.GetAllocatedSize() + Zenith.GetAllocatedSize() + Counts.GetAllocatedSize()
+            + FoldSeconds.GetAllocatedSize() + GapStart.GetAllocatedSize() + GapSeconds.GetAllocatedSize() + LongestGap.GetAllocatedSize() + Gaps.GetAllocatedSize()
+            + SatX.GetAllocatedSize() + SatY.GetAllocatedSize() + SatZ.GetAllocatedSize();
+    }
+
+
+    bool AnalyzeCoverage(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        double Step,
+        FCoverageAnalysis& Analysis,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const double Begin = Start.AsSpiceDouble();
+        const double End = Stop.AsSpiceDouble();
+        if (!(End >= Begin) || !(Step > 0.) || Analysis.Num() == 0)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("AnalyzeCoverage: bad window [%f, %f], step %f, or the analysis wasn't begun"), Begin, End, Step);
+            return false;
+        }
+
+        // As PredictPasses:  one leapsecond, mid-window, is ~15 arcseconds
+        SpiceDouble DeltaUtc = 0.;
+        deltet_c(Begin, "ET", &DeltaUtc);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        const int32 Num = Catalog.Num();
+        TArray<FSDistanceVector> Positions;
+        TArray<bool> Valid;
+        Positions.SetNum(Num);
+        Valid.SetNum(Num);
+
+        const int64 Steps = (int64)FMath::FloorToDouble((End - Begin) / Step);
+        for (int64 s = 0; s <= Steps; ++s)
+        {
+            const double et = Begin + s * Step;
+            const double gmst = GreenwichMeanSiderealTime(et - DeltaUtc);
+            const double c = FMath::Cos(gmst), sn = FMath::Sin(gmst);
+
+            // TEME -> pseudo Earth fixed
+            ParallelFor(Num, [&](int32 j)
+            {
+                double state[6];
+                Valid[j] = Catalog[j].Propagate(et, state) == ESGP4Status::Ok;
+                Positions[j] = Valid[j] ? FSDistanceVector(c * state[0] + sn * state[1], -sn * state[0] + c * state[1], state[2]) : FSDistanceVector();
+            }, Num < 64);
+
+            Analysis.AddStep(et, Positions, Valid);
+        }
+        Analysis.End(End);
+
+        return true;
+    }
+
+
+    UTexture2D* CreateCoverageTexture(const FCoverageAnalysis& Analysis, int32 Fold)
+    {
+        check(IsInGameThread());
+
+        const int32 Width = Analysis.GetWidth();
+        const int32 Height = Analysis.GetHeight();
+        if (Analysis.Num() == 0 || Fold < 1 || Fold > Analysis.GetMaxFold())
+        {
+            return nullptr;
+        }
+
+        UTexture2D* Texture = UTexture2D::CreateTransient(Width, Height, PF_A32B32G32R32F);
+        if (!Texture)
+        {
+            return nullptr;
+        }
+        Texture->SRGB = false;
+        Texture->CompressionSettings = TC_HDR;
+        Texture->Filter = TF_Bilinear;
+        Texture->AddressX = TA_Wrap;
+        Texture->AddressY = TA_Clamp;
+
+        FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+        float* Texels = static_cast<float*>(Mip.BulkData.Lock(LOCK_READ_WRITE));
+        for (int32 i = 0; i < Analysis.Num(); ++i)
+        {
+            Texels[4 * i + 0] = float(Analysis.FoldFraction(i, 1));
+            Texels[4 * i + 1] = float(Analysis.FoldFraction(i, Fold));
+            Texels[4 * i + 2] = float(Analysis.MeanRevisit(i));
+            Texels[4 * i + 3] = float(Analysis.MaxGap(i));
+        }
+        Mip.BulkData.Unlock();
+
+        Texture->UpdateResource();
+        return Texture;
+    }
+}
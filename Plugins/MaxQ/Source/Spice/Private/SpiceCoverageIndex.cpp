@@ -0,0 +1,632 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCoverageIndex.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A queryable index of binary kernel coverage.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCoverageIndex.cpp is part of the "refined C++ API".
+//
+// Segments come from walking each file's DAF summaries (dafbfs/daffna/dafgs/
+// dafus), which is what spkcov/pckcov do internally, once per file instead of
+// once per object.  Only CK coverage needs more than the summaries:  CK
+// segments can have gaps between interpolation intervals, so ckcov is run for
+// each of the file's objects.
+//
+// Only the per-file data is saved;  the per-object lookup is rebuilt from it
+// whenever the set of files changes.
+//------------------------------------------------------------------------------
+
+#include "SpiceCoverageIndex.h"
+#include "SpiceUtilities.h"
+#include "HAL/FileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+using MaxQ::GeometryFinder::FSWindow;
+
+namespace
+{
+    constexpr uint32 IndexMagic = 0x564F434B;  // "KCOV"
+    constexpr int32 IndexVersion = 2;
+
+    // Windows start small and grow when CSPICE runs out of room, up to this
+    constexpr SpiceInt MaxCellSize = 1 << 24;
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    bool Succeed(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+    bool IsWindowOverflow()
+    {
+        char szBuffer[SpiceLongMessageMaxLength];
+        szBuffer[0] = '\0';
+        getmsg_c("SHORT", sizeof(szBuffer), szBuffer);
+
+        return
+            !SpiceStringCompare(szBuffer, "SPICE(WINDOWEXCESS)") ||
+            !SpiceStringCompare(szBuffer, "SPICE(CELLTOOSMALL)");
+    }
+
+    // ckcov_c into an unbounded window
+    void CkCoverage(ConstSpiceChar* _ck, SpiceInt _id, FSWindow& Window)
+    {
+        FWindowCell Cell(Window, 32);
+        for (;;)
+        {
+            scard_c(0, Cell.Get());
+            ckcov_c(_ck, _id, SPICEFALSE, "INTERVAL", 0., "TDB", Cell.Get());
+
+            if (!failed_c() || !IsWindowOverflow() || Cell.Size() >= MaxCellSize)
+            {
+                break;
+            }
+            reset_c();
+            Cell.Reserve(Cell.Size());
+        }
+    }
+
+    void SerializeWindow(FArchive& Ar, FSWindow& Window)
+    {
+        TArray<double> Endpoints;
+        if (Ar.IsSaving())
+        {
+            Endpoints.Append(Window.Endpoints().GetData(), Window.Endpoints().Num());
+        }
+        Ar << Endpoints;
+        if (Ar.IsLoading())
+        {
+            Window.Reset();
+            Window.Reserve(Endpoints.Num() / 2);
+            for (int32 i = 0; i + 1 < Endpoints.Num(); i += 2)
+            {
+                Window.Insert(Endpoints[i], Endpoints[i + 1]);
+            }
+        }
+    }
+}
+
+namespace MaxQ::Data
+{
+    bool FKernelCoverageIndex::Add(const TArray<FString>& relativePaths, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        bool bSuccess = true;
+        for (const FString& relativePath : relativePaths)
+        {
+            const FString Path = toPath(relativePath);
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*Path);
+            if (!Stat.bIsValid)
+            {
+                bSuccess = Fail(FString::Printf(TEXT("FKernelCoverageIndex: could not find %s"), *Path), ResultCode, ErrorMessage);
+                continue;
+            }
+
+            const int32 Existing = FindFile(Path);
+            if (Existing != INDEX_NONE && Files[Existing].Size == Stat.FileSize && Files[Existing].Timestamp == Stat.ModificationTime)
+            {
+                continue;
+            }
+
+            FIndexedFile File;
+            File.Path = Path;
+            File.Size = Stat.FileSize;
+            File.Timestamp = Stat.ModificationTime;
+            if (!Scan(File, ResultCode, ErrorMessage))
+            {
+                bSuccess = false;
+                continue;
+            }
+
+            if (Existing != INDEX_NONE)
+            {
+                Files[Existing] = MoveTemp(File);
+            }
+            else
+            {
+                Files.Add(MoveTemp(File));
+            }
+        }
+
+        RebuildObjects();
+        return bSuccess && Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    bool FKernelCoverageIndex::AddLoaded(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        constexpr SpiceInt FILLEN = 1024;
+        constexpr SpiceInt TYPLEN = 33;
+        constexpr SpiceInt SRCLEN = 1024;
+        ConstSpiceChar* _kind = "SPK CK PCK";
+
+        TArray<FString> Paths;
+        SpiceInt _count = 0;
+        ktotal_c(_kind, &_count);
+        for (SpiceInt i = 0; i < _count && !failed_c(); ++i)
+        {
+            SpiceChar _file[FILLEN];
+            SpiceChar _filtyp[TYPLEN];
+            SpiceChar _srcfil[SRCLEN];
+            SpiceInt _handle = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            kdata_c(i, _kind, FILLEN, TYPLEN, SRCLEN, _file, _filtyp, _srcfil, &_handle, &_found);
+            if (_found)
+            {
+                Paths.Add(FString(_file));
+            }
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        return Add(Paths, ResultCode, ErrorMessage);
+    }
+
+
+    void FKernelCoverageIndex::Reset()
+    {
+        Files.Reset();
+        RebuildObjects();
+    }
+
+
+    bool FKernelCoverageIndex::Scan(FIndexedFile& File, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        auto _file = StringCast<ANSICHAR>(*File.Path);
+
+        SpiceChar _arch[8];
+        SpiceChar _type[8];
+        getfat_c(_file.Get(), sizeof(_arch), sizeof(_type), _arch, _type);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        // Summary shapes (ND, NI) are fixed per kernel type
+        SpiceInt _ni = 6;
+        if (!SpiceStringCompare(_arch, "DAF") && !SpiceStringCompare(_type, "SPK"))
+        {
+            File.Type = EKernelCoverageType::SPK;
+        }
+        else if (!SpiceStringCompare(_arch, "DAF") && !SpiceStringCompare(_type, "CK"))
+        {
+            File.Type = EKernelCoverageType::CK;
+        }
+        else if (!SpiceStringCompare(_arch, "DAF") && !SpiceStringCompare(_type, "PCK"))
+        {
+            File.Type = EKernelCoverageType::PCK;
+            _ni = 5;
+        }
+        else
+        {
+            return Fail(FString::Printf(TEXT("FKernelCoverageIndex: %s is not a binary SPK, CK or PCK (%s/%s)"), *File.Path, ANSI_TO_TCHAR(_arch), ANSI_TO_TCHAR(_type)), ResultCode, ErrorMessage);
+        }
+
+        File.Segments.Reset();
+        File.Intervals.Reset();
+
+        SpiceInt _handle = 0;
+        dafopr_c(_file.Get(), &_handle);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        SpiceBoolean _found = SPICEFALSE;
+        dafbfs_c(_handle);
+        daffna_c(&_found);
+        while (_found && !failed_c())
+        {
+            // ND + (NI + 1) / 2 doubles
+            SpiceDouble _sum[5];
+            SpiceDouble _dc[2];
+            SpiceInt _ic[6];
+            dafgs_c(_sum);
+            dafus_c(_sum, 2, _ni, _dc, _ic);
+
+            FCoverageSegment& Segment = File.Segments.AddDefaulted_GetRef();
+            Segment.Start = _dc[0];
+            Segment.Stop = _dc[1];
+            Segment.Id = _ic[0];
+            Segment.File = INDEX_NONE;
+            Segment.Segment = File.Segments.Num() - 1;
+            switch (File.Type)
+            {
+            case EKernelCoverageType::SPK:
+                Segment.Center = _ic[1];
+                Segment.Frame = _ic[2];
+                Segment.DataType = _ic[3];
+                break;
+            default:
+                Segment.Frame = _ic[1];
+                Segment.DataType = _ic[2];
+                break;
+            }
+            // The last two integers, whatever the type
+            Segment.Begin = _ic[_ni - 2];
+            Segment.End = _ic[_ni - 1];
+
+            daffna_c(&_found);
+        }
+        CloseDaf(_handle);
+
+        if (File.Type == EKernelCoverageType::CK && !failed_c())
+        {
+            // Segment bounds are in ticks
+            TSet<int32> Ids;
+            for (FCoverageSegment& Segment : File.Segments)
+            {
+                SpiceInt _sclk = 0;
+                ckmeta_c(Segment.Id, "SCLK", &_sclk);
+                sct2e_c(_sclk, Segment.Start, &Segment.Start);
+                sct2e_c(_sclk, Segment.Stop, &Segment.Stop);
+                Ids.Add(Segment.Id);
+            }
+
+            for (int32 Id : Ids)
+            {
+                if (failed_c())
+                {
+                    break;
+                }
+                FObjectWindow& Intervals = File.Intervals.AddDefaulted_GetRef();
+                Intervals.Id = Id;
+                CkCoverage(_file.Get(), Id, Intervals.Window);
+            }
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    void FKernelCoverageIndex::RebuildObjects()
+    {
+        for (TMap<int32, FObject>& TypeObjects : Objects)
+        {
+            TypeObjects.Reset();
+        }
+
+        for (int32 f = 0; f < Files.Num(); ++f)
+        {
+            FIndexedFile& File = Files[f];
+            TMap<int32, FObject>& TypeObjects = Objects[(int32)File.Type];
+
+            for (int32 s = 0; s < File.Segments.Num(); ++s)
+            {
+                FCoverageSegment& Segment = File.Segments[s];
+                Segment.File = f;
+                Segment.Segment = s;
+
+                FObject& Object = TypeObjects.FindOrAdd(Segment.Id);
+                Object.Segments.Emplace(f, s);
+                if (File.Type != EKernelCoverageType::CK)
+                {
+                    Object.Coverage.Insert(Segment.Start, Segment.Stop);
+                }
+            }
+
+            for (const FObjectWindow& Intervals : File.Intervals)
+            {
+                FObject& Object = TypeObjects.FindOrAdd(Intervals.Id);
+                Object.Coverage = Object.Coverage | Intervals.Window;
+            }
+        }
+    }
+
+
+    void FKernelCoverageIndex::Serialize(FArchive& Ar, TArray<FIndexedFile>& Files)
+    {
+        uint32 Magic = IndexMagic;
+        int32 Version = IndexVersion;
+        int32 NumFiles = Files.Num();
+        Ar << Magic << Version << NumFiles;
+        if (Ar.IsLoading())
+        {
+            if (Magic != IndexMagic || Version != IndexVersion || NumFiles < 0)
+            {
+                Ar.SetError();
+                return;
+            }
+            Files.SetNum(NumFiles);
+        }
+
+        for (FIndexedFile& File : Files)
+        {
+            uint8 Type = (uint8)File.Type;
+            int32 NumSegments = File.Segments.Num();
+            int32 NumIntervals = File.Intervals.Num();
+            Ar << File.Path << Type << File.Size << File.Timestamp << NumSegments << NumIntervals;
+            if (Ar.IsError() || NumSegments < 0 || NumIntervals < 0 || Type >= (uint8)EKernelCoverageType::Count)
+            {
+                Ar.SetError();
+                return;
+            }
+
+            if (Ar.IsLoading())
+            {
+                File.Type = (EKernelCoverageType)Type;
+                File.Segments.SetNum(NumSegments);
+                File.Intervals.SetNum(NumIntervals);
+            }
+
+            for (FCoverageSegment& Segment : File.Segments)
+            {
+                Ar << Segment.Start << Segment.Stop << Segment.Id << Segment.Center << Segment.Frame << Segment.DataType << Segment.Begin << Segment.End;
+            }
+
+            for (FObjectWindow& Intervals : File.Intervals)
+            {
+                Ar << Intervals.Id;
+                SerializeWindow(Ar, Intervals.Window);
+            }
+        }
+    }
+
+
+    bool FKernelCoverageIndex::Save(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage) const
+    {
+        TArray<uint8> Bytes;
+        FMemoryWriter Writer(Bytes);
+        Serialize(Writer, const_cast<TArray<FIndexedFile>&>(Files));
+
+        // Write, then move into place (another process may be reading it)
+        const FString Path = toPath(relativePath);
+        const FString TempPath = FString::Printf(TEXT("%s.%u.tmp"), *Path, FPlatformProcess::GetCurrentProcessId());
+        if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+        {
+            IFileManager::Get().Delete(*TempPath, false, false, true);
+            return Fail(FString::Printf(TEXT("FKernelCoverageIndex: could not write %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        return Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    bool FKernelCoverageIndex::Load(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        const FString Path = toPath(relativePath);
+        TArray<uint8> Bytes;
+        if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+        {
+            return Fail(FString::Printf(TEXT("FKernelCoverageIndex: could not read %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        TArray<FIndexedFile> Loaded;
+        FMemoryReader Reader(Bytes);
+        Serialize(Reader, Loaded);
+        if (Reader.IsError())
+        {
+            return Fail(FString::Printf(TEXT("FKernelCoverageIndex: %s is not a coverage index, or is from another version"), *Path), ResultCode, ErrorMessage);
+        }
+
+        bool bSuccess = true;
+        for (int32 i = 0; i < Loaded.Num(); ++i)
+        {
+            FIndexedFile& File = Loaded[i];
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*File.Path);
+            if (!Stat.bIsValid)
+            {
+                UE_LOG(LogSpice, Warning, TEXT("FKernelCoverageIndex: %s is indexed in %s, but no longer exists"), *File.Path, *Path);
+                Loaded.RemoveAt(i--);
+            }
+            else if (Stat.FileSize != File.Size || Stat.ModificationTime != File.Timestamp)
+            {
+                UE_LOG(LogSpice, Log, TEXT("FKernelCoverageIndex: %s changed since %s was saved, rescanning"), *File.Path, *Path);
+                File.Size = Stat.FileSize;
+                File.Timestamp = Stat.ModificationTime;
+                if (!Scan(File, ResultCode, ErrorMessage))
+                {
+                    bSuccess = false;
+                    Loaded.RemoveAt(i--);
+                }
+            }
+        }
+
+        Files = MoveTemp(Loaded);
+        RebuildObjects();
+        return bSuccess && Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    bool FKernelCoverageIndex::AddCached(const TArray<FString>& relativePaths, const FString& cacheDirectory, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        uint64 Hash = IndexVersion;
+        for (const FString& relativePath : relativePaths)
+        {
+            const FString Path = toPath(relativePath);
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*Path);
+            int64 Key[2] = { Stat.FileSize, Stat.ModificationTime.GetTicks() };
+
+            auto _path = StringCast<ANSICHAR>(*Path);
+            Hash = CityHash64WithSeed(_path.Get(), _path.Length(), Hash);
+            Hash = CityHash64WithSeed((const char*)Key, sizeof(Key), Hash);
+        }
+
+        const FString Directory = cacheDirectory.IsEmpty()
+            ? SavedPath(TEXT("CoverageIndex"))
+            : toPath(cacheDirectory);
+        const FString CachePath = FPaths::Combine(Directory, FString::Printf(TEXT("%016llx.kcov"), Hash));
+
+        FKernelCoverageIndex Cached;
+        if (!Cached.Load(CachePath, nullptr, nullptr) || Cached.NumFiles() != relativePaths.Num())
+        {
+            Cached.Reset();
+            if (!Cached.Add(relativePaths, ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+            IFileManager::Get().MakeDirectory(*Directory, true);
+            Cached.Save(CachePath, nullptr, nullptr);
+        }
+
+        // Merge, keeping the priority order
+        for (FIndexedFile& File : Cached.Files)
+        {
+            const int32 Existing = FindFile(File.Path);
+            if (Existing != INDEX_NONE)
+            {
+                Files[Existing] = MoveTemp(File);
+            }
+            else
+            {
+                Files.Add(MoveTemp(File));
+            }
+        }
+
+        RebuildObjects();
+        return Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    const FKernelCoverageIndex::FObject* FKernelCoverageIndex::FindObject(EKernelCoverageType Type, int Id) const
+    {
+        return Objects[(int32)Type].Find(Id);
+    }
+
+
+    bool FKernelCoverageIndex::IsCovered(EKernelCoverageType Type, int Id, double et) const
+    {
+        const FObject* Object = FindObject(Type, Id);
+        return Object && Object->Coverage.Contains(et);
+    }
+
+
+    bool FKernelCoverageIndex::IsCovered(EKernelCoverageType Type, int Id, double Start, double Stop) const
+    {
+        const FObject* Object = FindObject(Type, Id);
+        return Object && Object->Coverage.Contains(Start, Stop);
+    }
+
+
+    bool FKernelCoverageIndex::Clamp(EKernelCoverageType Type, int Id, double et, double& Clamped) const
+    {
+        const FObject* Object = FindObject(Type, Id);
+        if (!Object || Object->Coverage.IsEmpty())
+        {
+            return false;
+        }
+
+        const FSWindow& Window = Object->Coverage;
+
+        // The first interval that starts after et
+        int32 Lo = 0, Hi = Window.Num();
+        while (Lo < Hi)
+        {
+            const int32 Mid = (Lo + Hi) / 2;
+            if (Window.Start(Mid) <= et) Lo = Mid + 1; else Hi = Mid;
+        }
+
+        if (Lo > 0 && et <= Window.Stop(Lo - 1))
+        {
+            Clamped = et;
+        }
+        else if (Lo == 0)
+        {
+            Clamped = Window.Start(0);
+        }
+        else if (Lo == Window.Num())
+        {
+            Clamped = Window.Stop(Lo - 1);
+        }
+        else
+        {
+            Clamped = et - Window.Stop(Lo - 1) <= Window.Start(Lo) - et ? Window.Stop(Lo - 1) : Window.Start(Lo);
+        }
+        return true;
+    }
+
+
+    const FCoverageSegment* FKernelCoverageIndex::FindSegment(EKernelCoverageType Type, int Id, double et) const
+    {
+        if (const FObject* Object = FindObject(Type, Id))
+        {
+            for (int32 i = Object->Segments.Num() - 1; i >= 0; --i)
+            {
+                const FCoverageSegment& Segment = Files[Object->Segments[i].Key].Segments[Object->Segments[i].Value];
+                if (Segment.Start <= et && et <= Segment.Stop)
+                {
+                    return &Segment;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+
+    const FSWindow& FKernelCoverageIndex::Coverage(EKernelCoverageType Type, int Id) const
+    {
+        static const FSWindow Empty;
+        const FObject* Object = FindObject(Type, Id);
+        return Object ? Object->Coverage : Empty;
+    }
+
+
+    TArray<int32> FKernelCoverageIndex::Ids(EKernelCoverageType Type) const
+    {
+        TArray<int32> Result;
+        Objects[(int32)Type].GetKeys(Result);
+        Result.Sort();
+        return Result;
+    }
+
+
+    TArray<const FCoverageSegment*> FKernelCoverageIndex::Segments(EKernelCoverageType Type, int Id) const
+    {
+        TArray<const FCoverageSegment*> Result;
+        if (const FObject* Object = FindObject(Type, Id))
+        {
+            for (const TPair<int32, int32>& Ref : Object->Segments)
+            {
+                Result.Add(&Files[Ref.Key].Segments[Ref.Value]);
+            }
+        }
+        return Result;
+    }
+
+
+    int32 FKernelCoverageIndex::FindFile(const FString& relativePath) const
+    {
+        const FString Path = toPath(relativePath);
+        return Files.IndexOfByPredicate([&Path](const FIndexedFile& File) { return File.Path == Path; });
+    }
+}
@@ -23,6 +23,24 @@
 
 #include "SpiceData.h"
 #include "SpiceUtilities.h"
+#include "SpiceTime.h"
+#include "SpiceNameRegistry.h"
+#include "SpicePoolWatch.h"
+#include "SpiceLock.h"
+#include "Misc/ScopeLock.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/CommandLine.h"
+#include "Misc/ScopeExit.h"
+#include "String/Find.h"
+#include "Hash/CityHash.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include "Misc/ByteSwap.h"
+#include <atomic>
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 extern "C"
@@ -33,6 +51,277 @@ PRAGMA_POP_PLATFORM_DEFAULT_PACKING
 
 using namespace MaxQ::Private;
 
+namespace MaxQ::Data
+{
+    namespace
+    {
+        FCriticalSection KernelHistoryLock;
+        TArray<FKernelHistoryEntry> KernelHistory;
+        uint64 KernelHistoryGeneration = 0;
+    }
+
+    SPICE_API uint64 GetKernelHistory(TArray<FKernelHistoryEntry>& History)
+    {
+        FScopeLock Lock(&KernelHistoryLock);
+        History = KernelHistory;
+        return KernelHistoryGeneration;
+    }
+
+    SPICE_API uint64 GetKernelHistoryGeneration()
+    {
+        FScopeLock Lock(&KernelHistoryLock);
+        return KernelHistoryGeneration;
+    }
+
+    SPICE_API uint64 GetPoolGeneration()
+    {
+        return PoolGeneration();
+    }
+
+    namespace
+    {
+        FCriticalSection KernelRootLock;
+        FString KernelRoot;
+    }
+
+    SPICE_API void SetKernelRoot(const FString& AbsoluteDirectory)
+    {
+        FScopeLock Lock(&KernelRootLock);
+        KernelRoot = AbsoluteDirectory;
+    }
+
+    SPICE_API FString GetKernelRoot()
+    {
+        {
+            FScopeLock Lock(&KernelRootLock);
+            if (!KernelRoot.IsEmpty())
+            {
+                return KernelRoot;
+            }
+        }
+
+        // ProjectContentDir asks FCommandLine, which asserts if the engine
+        // hasn't initialized it
+        if (FCommandLine::IsInitialized())
+        {
+            return FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
+        }
+        return FString();
+    }
+}
+
+namespace MaxQ::Data
+{
+    namespace
+    {
+        // Binary kernels that are mapped, by the path CSPICE loaded them by
+        struct FMappedKernel
+        {
+            // (Declared in this order so the region is released first)
+            TUniquePtr<IMappedFileHandle> Handle;
+            TUniquePtr<IMappedFileRegion> Region;
+        };
+
+        std::atomic<bool> bMapBinaryKernels { false };
+        FCriticalSection MappedKernelsLock;
+        TMap<FString, TUniquePtr<FMappedKernel>> MappedKernels;
+
+        // Every loaded binary kernel (including those loaded by meta-kernels)
+        // is mapped, and nothing else is.
+        void SyncMappedKernels()
+        {
+            TSet<FString> Loaded;
+
+            if (bMapBinaryKernels && !failed_c())
+            {
+                ConstSpiceChar* _kinds = "SPK CK PCK DSK EK";
+                SpiceInt _count = 0;
+                ktotal_c(_kinds, &_count);
+
+                for (SpiceInt i = 0; i < _count && !failed_c(); ++i)
+                {
+                    SpiceChar _file[SPICE_MAX_PATH];
+                    SpiceChar _filtyp[32];
+                    SpiceChar _source[SPICE_MAX_PATH];
+                    SpiceInt _handle = 0;
+                    SpiceBoolean _found = SPICEFALSE;
+                    kdata_c(i, _kinds, sizeof(_file), sizeof(_filtyp), sizeof(_source), _file, _filtyp, _source, &_handle, &_found);
+                    if (_found)
+                    {
+                        Loaded.Add(FString(_file));
+                    }
+                }
+
+                UnexpectedErrorCheck(true);
+            }
+
+            FScopeLock Lock(&MappedKernelsLock);
+
+            for (auto It = MappedKernels.CreateIterator(); It; ++It)
+            {
+                if (!Loaded.Contains(It.Key()))
+                {
+                    It.RemoveCurrent();
+                }
+            }
+
+            for (const FString& Path : Loaded)
+            {
+                if (MappedKernels.Contains(Path))
+                {
+                    continue;
+                }
+
+                TUniquePtr<FMappedKernel> Mapped = MakeUnique<FMappedKernel>();
+                Mapped->Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+                if (Mapped->Handle.IsValid())
+                {
+                    // The preload hint asks the OS to page the whole file in,
+                    // ahead of CSPICE's record reads
+                    Mapped->Region.Reset(Mapped->Handle->MapRegion(0, MAX_int64, true));
+                }
+
+                if (!Mapped->Region.IsValid())
+                {
+                    UE_LOG(LogSpice, Verbose, TEXT("MaxQ SPICE could not map kernel %s"), *Path);
+                    continue;
+                }
+
+                MappedKernels.Add(Path, MoveTemp(Mapped));
+            }
+        }
+
+        void UpdateLoadedKernelsStat()
+        {
+#if STATS
+            SpiceInt _count = 0;
+            if (!failed_c())
+            {
+                ktotal_c("ALL", &_count);
+            }
+            SET_DWORD_STAT(STAT_MaxQ_LoadedKernels, _count);
+#endif
+        }
+    }
+
+    SPICE_API void SetMapBinaryKernels(bool bEnable)
+    {
+        bMapBinaryKernels = bEnable;
+        SyncMappedKernels();
+    }
+
+    SPICE_API bool GetMapBinaryKernels()
+    {
+        return bMapBinaryKernels;
+    }
+
+    SPICE_API int32 NumMappedKernels()
+    {
+        FScopeLock Lock(&MappedKernelsLock);
+        return MappedKernels.Num();
+    }
+
+    SPICE_API int64 MappedKernelBytes()
+    {
+        FScopeLock Lock(&MappedKernelsLock);
+        int64 Bytes = 0;
+        for (const auto& Mapped : MappedKernels)
+        {
+            Bytes += Mapped.Value->Region->GetMappedSize();
+        }
+        return Bytes;
+    }
+
+    SPICE_API bool PrefetchKernelRange(const FString& Path, int64 Offset, int64 Bytes)
+    {
+        if (Bytes <= 0)
+        {
+            return false;
+        }
+        Offset = FMath::Max<int64>(Offset, 0);
+
+        {
+            FScopeLock Lock(&MappedKernelsLock);
+            if (const TUniquePtr<FMappedKernel>* Mapped = MappedKernels.Find(Path))
+            {
+                IMappedFileRegion& Region = *(*Mapped)->Region;
+                const int64 Size = Region.GetMappedSize();
+                if (Offset < Size)
+                {
+                    Region.PreloadHint(Offset, FMath::Min(Bytes, Size - Offset));
+                }
+                return true;
+            }
+        }
+
+        // Reading it is the portable hint.  The OS keeps the pages, and
+        // CSPICE's reads then don't wait on the disk.
+        Async(EAsyncExecution::ThreadPool, [Path, Offset, Bytes]()
+        {
+            TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+            if (!File.IsValid() || Offset >= File->Size() || !File->Seek(Offset))
+            {
+                return;
+            }
+
+            const int64 Length = FMath::Min(Bytes, File->Size() - Offset);
+            TArray<uint8> Scratch;
+            Scratch.SetNumUninitialized((int32)FMath::Min<int64>(Length, 256 * 1024));
+            for (int64 Left = Length; Left > 0;)
+            {
+                const int64 Chunk = FMath::Min<int64>(Left, Scratch.Num());
+                if (!File->Read(Scratch.GetData(), Chunk))
+                {
+                    break;
+                }
+                Left -= Chunk;
+            }
+        });
+        return true;
+    }
+}
+
+namespace MaxQ::Private
+{
+    void RecordKernelOperation(MaxQ::Data::FKernelHistoryEntry::EOperation Operation, const FString& AbsolutePath, bool bSyncMappedKernels)
+    {
+        using namespace MaxQ::Data;
+
+        {
+            FScopeLock Lock(&KernelHistoryLock);
+            KernelHistory.Add(FKernelHistoryEntry{ Operation, AbsolutePath });
+            ++KernelHistoryGeneration;
+        }
+        BumpPoolGeneration();
+        MaxQ::Data::UpdateLoadedKernelsStat();
+
+        if (bSyncMappedKernels)
+        {
+            SyncMappedKernels();
+            MaxQ::Data::UpdateNameRegistry();
+            MaxQ::Data::NotifyPoolWatchers();
+        }
+    }
+
+    void ClearKernelHistory()
+    {
+        using namespace MaxQ::Data;
+
+        {
+            FScopeLock Lock(&KernelHistoryLock);
+            KernelHistory.Empty();
+            ++KernelHistoryGeneration;
+        }
+        ForgetContextKernels();
+        BumpPoolGeneration();
+        MaxQ::Data::UpdateLoadedKernelsStat();
+
+        SyncMappedKernels();
+        MaxQ::Data::UpdateNameRegistry();
+        MaxQ::Data::NotifyPoolWatchers();
+    }
+}
+
 namespace MaxQ::Data
 {
     SPICE_API TArray<FString> EnumerateDirectory(const FString& relativeDirectory, bool ErrorIfNoFilesFound, ES_ResultCode* pResultCode, FString* pErrorMessage)
@@ -94,53 +383,387 @@ namespace MaxQ::Data
         return kernelFilePaths;
     }
 
-    SPICE_API bool Furnsh(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    namespace
     {
-        FString fullPathToFile {toPath(relativePath)};
-
+        bool FurnshAbsolute(const FString& fullPathToFile, ES_ResultCode* ResultCode, FString* ErrorMessage, bool bSyncMappedKernels, const FKernelLoadRecord* Prepared = nullptr)
+        {
 #ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-        // Get the current working directory...
-        TCHAR buffer[SPICE_MAX_PATH];
-        TCHAR* oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
+            // Get the current working directory...
+            TCHAR buffer[SPICE_MAX_PATH];
+            TCHAR* oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
 
-        // Trim the file name to just the full directory path...
-        // (There isn't a guarantee SPICE will handle the other separator)
-        FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
-        fullPathToDirectory.ReplaceCharInline('/', '\\');
+            // Trim the file name to just the full directory path...
+            // (There isn't a guarantee SPICE will handle the other separator)
+            FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
+            fullPathToDirectory.ReplaceCharInline('/', '\\');
 
-        if (FPaths::DirectoryExists(fullPathToDirectory))
-        {
-            // Set the current working directory
-            _tchdir(*fullPathToDirectory);
-        }
+            if (FPaths::DirectoryExists(fullPathToDirectory))
+            {
+                // Set the current working directory
+                _tchdir(*fullPathToDirectory);
+            }
 #endif
 
-        furnsh_c(TCHAR_TO_ANSI(*fullPathToFile));
+            MaxQ::Core::FSpiceScope Scope;
+            FKernelLoadTiming Timing(fullPathToFile, false, Prepared);
+            {
+                MAXQ_FURNSH_SCOPE();
+                MAXQ_TRACE_SCOPE_TEXT(TEXT("furnsh %s"), *Timing.Describe());
+                furnsh_c(TCHAR_TO_ANSI(*fullPathToFile));
+            }
+            Timing.Finish(!failed_c());
 
 #ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-        // Reset the working directory to prior state...
-        if (oldWorkingDirectory)
+            // Reset the working directory to prior state...
+            if (oldWorkingDirectory)
+            {
+                _tchdir(oldWorkingDirectory);
+            }
+#endif
+
+            bool bSuccess = !ErrorCheck(ResultCode, ErrorMessage);
+            if (bSuccess)
+            {
+                UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Furnsh' loaded kernel: %s"), *fullPathToFile);
+                RecordKernelOperation(FKernelHistoryEntry::EOperation::Furnsh, fullPathToFile, bSyncMappedKernels);
+            }
+            return bSuccess;
+        }
+
+        // A kernel, opened and checked ahead of furnsh.  None of this touches
+        // CSPICE, so a whole list can be prepared in parallel.
+        struct FPreparedKernel
         {
-            _tchdir(oldWorkingDirectory);
+            FString Path;
+            // Empty if the kernel looks loadable
+            FString Error;
+            // Type, size, and the open and validate times
+            FKernelLoadRecord Timing;
+        };
+
+        // DAF file record layout (see the DAF Required Reading)
+        constexpr int32 DafRecordLength = 1024;
+        constexpr int32 DafNdOffset = 8;
+        constexpr int32 DafNiOffset = 12;
+        constexpr int32 DafFwardOffset = 76;
+        constexpr int32 DafBffOffset = 88;
+        constexpr int32 DafFtpOffset = 699;
+
+        // What FTP's ASCII mode would mangle, written to every new DAF
+        constexpr ANSICHAR DafFtpString[] = "FTPSTR:\r:\n:\r\n:\r\0:\x81:\x10\xCE:ENDFTP";
+        constexpr int32 DafFtpLength = sizeof(DafFtpString) - 1;
+
+        // Longest kernel pool variable name
+        constexpr int32 MaxPoolNameLength = 32;
+
+        bool CheckDafRecord(const uint8* Record, FString& Error)
+        {
+            // Old "NAIF/DAF" files predate the BFF and FTP fields
+            if (FMemory::Memcmp(Record, "DAF/", 4))
+            {
+                return true;
+            }
+
+            auto ReadInt = [Record](int32 Offset, bool bSwap)
+            {
+                int32 Value;
+                FMemory::Memcpy(&Value, Record + Offset, sizeof(Value));
+                return bSwap ? (int32)BYTESWAP_ORDER32((uint32)Value) : Value;
+            };
+
+            // Files older than the BFF field are native (as CSPICE assumes)
+            const bool bBig = !FMemory::Memcmp(Record + DafBffOffset, "BIG-IEEE", 8);
+            const bool bLittle = !FMemory::Memcmp(Record + DafBffOffset, "LTL-IEEE", 8);
+            const bool bSwap = PLATFORM_LITTLE_ENDIAN ? bBig : bLittle;
+            const int32 ND = ReadInt(DafNdOffset, bSwap);
+            const int32 NI = ReadInt(DafNiOffset, bSwap);
+            const int32 Fward = ReadInt(DafFwardOffset, bSwap);
+            if (ND < 0 || ND > 124 || NI < 2 || NI > 250 || ND + (NI + 1) / 2 > 125 || Fward < 2)
+            {
+                Error = FString::Printf(TEXT("corrupt DAF file record (ND=%d NI=%d FWARD=%d)"), ND, NI, Fward);
+                return false;
+            }
+
+            if (!FMemory::Memcmp(Record + DafFtpOffset, DafFtpString, 7) && FMemory::Memcmp(Record + DafFtpOffset, DafFtpString, DafFtpLength))
+            {
+                Error = TEXT("the file was damaged by an ASCII mode FTP transfer");
+                return false;
+            }
+
+            return true;
         }
-#endif
 
-        bool bSuccess = !ErrorCheck(ResultCode, ErrorMessage);
-        if (bSuccess)
+        // Just enough of the text kernel grammar to catch what the pool's
+        // parser would reject (so it's found before anything is loaded).
+        bool CheckTextKernel(const uint8* Text, int64 Length, FString& Error)
         {
-            UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Furnsh' loaded kernel: %s"), *fullPathToFile);
+            enum class EExpect { Name, Operator, Value, Element };
+
+            const ANSICHAR* Cursor = (const ANSICHAR*)Text;
+            const ANSICHAR* End = Cursor + Length;
+            EExpect Expect = EExpect::Name;
+            bool bData = false;
+
+            for (int32 Line = 1; Cursor < End; ++Line)
+            {
+                const ANSICHAR* LineEnd = Cursor;
+                while (LineEnd < End && *LineEnd != '\n')
+                {
+                    if (*LineEnd == '\0')
+                    {
+                        Error = FString::Printf(TEXT("line %d:  not a text kernel (binary data)"), Line);
+                        return false;
+                    }
+                    ++LineEnd;
+                }
+                const ANSICHAR* Next = LineEnd + 1;
+
+                const ANSICHAR* First = Cursor;
+                while (First < LineEnd && FCharAnsi::IsWhitespace(*First)) ++First;
+                const ANSICHAR* Last = LineEnd;
+                while (Last > First && FCharAnsi::IsWhitespace(Last[-1])) --Last;
+                const int32 Trimmed = int32(Last - First);
+
+                if (Trimmed == 10 && !FCStringAnsi::Strncmp(First, "\\begindata", 10))
+                {
+                    bData = true;
+                }
+                else if (Trimmed == 10 && !FCStringAnsi::Strncmp(First, "\\begintext", 10))
+                {
+                    if (bData && Expect != EExpect::Name)
+                    {
+                        Error = FString::Printf(TEXT("line %d:  \\begintext inside an assignment"), Line);
+                        return false;
+                    }
+                    bData = false;
+                }
+                else if (bData)
+                {
+                    const ANSICHAR* c = First;
+                    while (c < Last)
+                    {
+                        if (FCharAnsi::IsWhitespace(*c) || *c == ',')
+                        {
+                            ++c;
+                            continue;
+                        }
+
+                        if (Expect == EExpect::Name)
+                        {
+                            const ANSICHAR* NameStart = c;
+                            while (c < Last && !FCharAnsi::IsWhitespace(*c) && *c != '=' && *c != '(' && *c != ')' && !(c[0] == '+' && c + 1 < Last && c[1] == '='))
+                            {
+                                ++c;
+                            }
+                            if (c == NameStart || c - NameStart > MaxPoolNameLength)
+                            {
+                                Error = FString::Printf(TEXT("line %d:  expected a variable name of up to %d characters"), Line, MaxPoolNameLength);
+                                return false;
+                            }
+                            Expect = EExpect::Operator;
+                        }
+                        else if (Expect == EExpect::Operator)
+                        {
+                            if (*c == '=')
+                            {
+                                ++c;
+                            }
+                            else if (c[0] == '+' && c + 1 < Last && c[1] == '=')
+                            {
+                                c += 2;
+                            }
+                            else
+                            {
+                                Error = FString::Printf(TEXT("line %d:  expected '=' or '+='"), Line);
+                                return false;
+                            }
+                            Expect = EExpect::Value;
+                        }
+                        else if (*c == '(' && Expect == EExpect::Value)
+                        {
+                            ++c;
+                            Expect = EExpect::Element;
+                        }
+                        else if (*c == ')' && Expect == EExpect::Element)
+                        {
+                            ++c;
+                            Expect = EExpect::Name;
+                        }
+                        else if (*c == '(' || *c == ')')
+                        {
+                            Error = FString::Printf(TEXT("line %d:  unbalanced parentheses"), Line);
+                            return false;
+                        }
+                        else
+                        {
+                            if (*c == '\'')
+                            {
+                                // Quotes are escaped by doubling them
+                                for (++c; ; ++c)
+                                {
+                                    if (c >= Last)
+                                    {
+                                        Error = FString::Printf(TEXT("line %d:  unterminated string"), Line);
+                                        return false;
+                                    }
+                                    if (*c == '\'' && (c + 1 >= Last || c[1] != '\''))
+                                    {
+                                        ++c;
+                                        break;
+                                    }
+                                    if (*c == '\'')
+                                    {
+                                        ++c;
+                                    }
+                                }
+                            }
+                            else
+                            {
+                                while (c < Last && !FCharAnsi::IsWhitespace(*c) && *c != ',' && *c != '(' && *c != ')')
+                                {
+                                    ++c;
+                                }
+                            }
+
+                            if (Expect == EExpect::Value)
+                            {
+                                Expect = EExpect::Name;
+                            }
+                        }
+                    }
+                }
+
+                Cursor = Next;
+            }
+
+            if (bData && Expect != EExpect::Name)
+            {
+                Error = TEXT("the last assignment is not finished");
+                return false;
+            }
+
+            return true;
         }
-        return bSuccess;
+
+        void PrepareKernel(FPreparedKernel& Kernel)
+        {
+            IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+            const double Start = FPlatformTime::Seconds();
+            const FString Name = FPaths::GetCleanFilename(Kernel.Path);
+
+            TUniquePtr<IFileHandle> Handle;
+            int64 Size = 0;
+            uint8 Record[DafRecordLength] {};
+            {
+                MAXQ_TRACE_SCOPE_TEXT(TEXT("open %s"), *Name);
+                Handle.Reset(PlatformFile.OpenRead(*Kernel.Path));
+                if (!Handle.IsValid())
+                {
+                    Kernel.Error = TEXT("the file does not exist or can't be read");
+                    return;
+                }
+
+                Size = Handle->Size();
+                if (Size <= 0 || !Handle->Read(Record, FMath::Min<int64>(Size, DafRecordLength)))
+                {
+                    Kernel.Error = TEXT("the file is empty or can't be read");
+                    return;
+                }
+            }
+
+            const double Opened = FPlatformTime::Seconds();
+            Kernel.Timing.Size = Size;
+            Kernel.Timing.Type = KernelTypeOf(Record, FMath::Min<int64>(Size, DafRecordLength));
+            Kernel.Timing.Open = Opened - Start;
+            ON_SCOPE_EXIT { Kernel.Timing.Validate = FPlatformTime::Seconds() - Opened; };
+            MAXQ_TRACE_SCOPE_TEXT(TEXT("validate %s (%s)"), *Name, Kernel.Timing.Type == ES_KernelType::TEXT || Kernel.Timing.Type == ES_KernelType::META ? TEXT("text") : TEXT("binary"));
+
+            const bool bDaf = !FMemory::Memcmp(Record, "DAF/", 4) || !FMemory::Memcmp(Record, "NAIF/DAF", 8);
+            const bool bDas = !FMemory::Memcmp(Record, "DAS/", 4) || !FMemory::Memcmp(Record, "NAIF/DAS", 8);
+            if (bDaf || bDas)
+            {
+                if (Size < DafRecordLength)
+                {
+                    Kernel.Error = TEXT("the file is truncated");
+                }
+                else if (bDaf)
+                {
+                    CheckDafRecord(Record, Kernel.Error);
+                }
+                return;
+            }
+
+            if (!FMemory::Memcmp(Record, "DAFETF", 6) || !FMemory::Memcmp(Record, "DASETF", 6))
+            {
+                Kernel.Error = TEXT("transfer format kernels must be converted to binary (tobin) before they're loaded");
+                return;
+            }
+
+            // A text kernel (or meta-kernel):  read the rest, and parse it
+            TArray<uint8> Text;
+            Text.SetNumUninitialized(Size);
+            if (!Handle->Seek(0) || !Handle->Read(Text.GetData(), Size))
+            {
+                Kernel.Error = TEXT("the file can't be read");
+                return;
+            }
+
+            // Meta-kernels without the KPL/MK ID word
+            if (Kernel.Timing.Type == ES_KernelType::TEXT && UE::String::FindFirst(FAnsiStringView((const ANSICHAR*)Text.GetData(), Text.Num()), "KERNELS_TO_LOAD") != INDEX_NONE)
+            {
+                Kernel.Timing.Type = ES_KernelType::META;
+            }
+
+            CheckTextKernel(Text.GetData(), Text.Num(), Kernel.Error);
+        }
+    }
+
+    SPICE_API bool Furnsh(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        return FurnshAbsolute(toPath(relativePath), ResultCode, ErrorMessage, true);
     }
 
     SPICE_API bool Furnsh(const TArray<FString>& relativePaths, ES_ResultCode* ResultCode, FString* ErrorMessage)
     {
+        if (relativePaths.Num() == 0)
+        {
+            return true;
+        }
+
+        // The file I/O and checks are parallel.  CSPICE's pool and kernel
+        // tables aren't thread safe, and the load order is the precedence
+        // order, so furnsh itself is serial.
+        TArray<FPreparedKernel> Kernels;
+        Kernels.SetNum(relativePaths.Num());
+        for (int32 i = 0; i < Kernels.Num(); ++i)
+        {
+            Kernels[i].Path = toPath(relativePaths[i]);
+        }
+
+        ParallelFor(Kernels.Num(), [&Kernels](int32 i)
+        {
+            PrepareKernel(Kernels[i]);
+        });
+
         bool bSuccess = true;
-        for (auto file : relativePaths)
+        for (const FPreparedKernel& Kernel : Kernels)
         {
-            ES_ResultCode LocalResultCode;
+            ES_ResultCode LocalResultCode = ES_ResultCode::Success;
             FString LocalErrorMessage;
-            bool bLocalSuccess = Furnsh(file, &LocalResultCode, &LocalErrorMessage);
+            bool bLocalSuccess = Kernel.Error.IsEmpty();
+            if (bLocalSuccess)
+            {
+                // The mapped kernels are synced once, after the whole list
+                bLocalSuccess = FurnshAbsolute(Kernel.Path, &LocalResultCode, &LocalErrorMessage, false, &Kernel.Timing);
+            }
+            else
+            {
+                LocalResultCode = ES_ResultCode::Error;
+                LocalErrorMessage = FString::Printf(TEXT("Could not load kernel %s: %s"), *Kernel.Path, *Kernel.Error);
+                UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE 'Furnsh' %s"), *LocalErrorMessage);
+            }
+
             if (!bLocalSuccess)
             {
                 if (ResultCode) *ResultCode = LocalResultCode;
@@ -148,20 +771,30 @@ namespace MaxQ::Data
             }
             bSuccess &= bLocalSuccess;
         }
+
+        SyncMappedKernels();
+        UpdateNameRegistry();
+        NotifyPoolWatchers();
+
+        if (bSuccess)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Success;
+            if (ErrorMessage) ErrorMessage->Empty();
+        }
         return bSuccess;
     }
 
 
-    SPICE_API bool FurnshDirectory(const FString& relativeDirectory, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    SPICE_API bool FurnshDirectory(const FString& relativeDirectory, bool ErrorIfNoFilesFound, ES_ResultCode* ResultCode, FString* ErrorMessage)
     {
-        TArray<FString> relativePaths { EnumerateDirectory(relativeDirectory, true, ResultCode, ErrorMessage) };
+        TArray<FString> relativePaths { EnumerateDirectory(relativeDirectory, ErrorIfNoFilesFound, ResultCode, ErrorMessage) };
 
         if (relativePaths.Num() > 0)
         {
             return Furnsh(relativePaths, ResultCode, ErrorMessage);
         }
 
-        return false;
+        return !ErrorIfNoFilesFound && FPaths::DirectoryExists(toPath(relativeDirectory));
     }
 
 
@@ -170,23 +803,126 @@ namespace MaxQ::Data
     {
         FString absolutePath = toPath(relativePath);
 
-        unload_c(TCHAR_TO_ANSI(*absolutePath));
+        MaxQ::Core::FSpiceScope Scope;
+        FKernelLoadTiming Timing(absolutePath, true);
+        {
+            MAXQ_TRACE_SCOPE_TEXT(TEXT("unload %s"), *Timing.Describe());
+            unload_c(TCHAR_TO_ANSI(*absolutePath));
+        }
+        Timing.Finish(!failed_c());
 
         bool bSuccess = !ErrorCheck(ResultCode, ErrorMessage);
         if (bSuccess)
         {
             UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'Unload' unloaded kernel : %s"), *absolutePath);
+            RecordKernelOperation(FKernelHistoryEntry::EOperation::Unload, absolutePath);
         }
         return bSuccess;
     }
 
+    namespace
+    {
+        // Buffer name -> the file it was extracted to
+        FCriticalSection ExtractedKernelsLock;
+        TMap<FString, FString> ExtractedKernels;
+
+        // Files are named by content, so they're only written once, and
+        // concurrent processes agree on them.
+        bool ExtractKernel(const FString& Name, TArrayView<const uint8> Contents, FString& Path, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            const uint64 Hash = CityHash64((const char*)Contents.GetData(), Contents.Num());
+            const FString Directory = SavedPath(TEXT("Kernels"));
+            Path = FPaths::Combine(Directory, FString::Printf(TEXT("%s-%016llx.%s"), *FPaths::GetBaseFilename(Name), Hash, *FPaths::GetExtension(Name)));
+
+            IFileManager& FileManager = IFileManager::Get();
+            if (FileManager.FileSize(*Path) == Contents.Num())
+            {
+                return true;
+            }
+
+            // Write, then move into place, so nobody furnshes a partial file
+            const FString TempPath = FString::Printf(TEXT("%s.%u.tmp"), *Path, FPlatformProcess::GetCurrentProcessId());
+            bool bWritten = FFileHelper::SaveArrayToFile(Contents, *TempPath);
+            if (bWritten)
+            {
+                bWritten = FileManager.Move(*Path, *TempPath, true, true) || FileManager.FileSize(*Path) == Contents.Num();
+                FileManager.Delete(*TempPath, false, false, true);
+            }
+
+            if (!bWritten)
+            {
+                if (ResultCode) *ResultCode = ES_ResultCode::Error;
+                if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Could not extract kernel %s to %s"), *Name, *Path);
+                return false;
+            }
+
+            return true;
+        }
+    }
+
+    SPICE_API bool FurnshBuffer(const FString& Name, TArrayView<const uint8> Contents, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        FString Path;
+        if (!ExtractKernel(Name, Contents, Path, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        if (!Furnsh(Path, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        FScopeLock Lock(&ExtractedKernelsLock);
+        ExtractedKernels.Add(Name, Path);
+        return true;
+    }
+
+    SPICE_API bool FurnshPackaged(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        // Through the platform file chain (pak, IoStore...), so not the
+        // absolute path toPath would give.
+        const FString PackagePath = FPaths::Combine(FPaths::ProjectContentDir(), relativePath);
+
+        TArray<uint8> Contents;
+        if (!FFileHelper::LoadFileToArray(Contents, *PackagePath, FILEREAD_Silent))
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Could not read kernel %s (%s)"), *relativePath, *PackagePath);
+            return false;
+        }
+
+        return FurnshBuffer(relativePath, Contents, ResultCode, ErrorMessage);
+    }
+
+    SPICE_API bool UnloadBuffer(const FString& Name, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        FString Path;
+        {
+            FScopeLock Lock(&ExtractedKernelsLock);
+            if (!ExtractedKernels.RemoveAndCopyValue(Name, Path))
+            {
+                if (ResultCode) *ResultCode = ES_ResultCode::Error;
+                if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("Kernel %s was not loaded from a buffer"), *Name);
+                return false;
+            }
+        }
+
+        return Unload(Path, ResultCode, ErrorMessage);
+    }
+
     SPICE_API FSEphemerisTime Now()
     {
-        auto now = FDateTime::UtcNow();
-        auto j2000 = FDateTime::FromJulianDay(2451545.0);
-        auto now_j2000 = now - j2000;
+        // Anchored to the wall clock once (again when an LSK turns up),
+        // monotonic after that
+        static MaxQ::Time::FEtClock Clock;
 
-        return FSEphemerisTime(now_j2000.GetTotalSeconds());
+        if (!Clock.IsAnchored() || (!Clock.HasLeapSeconds() && MaxQ::Time::UpdateTimeSystem()))
+        {
+            Clock.AnchorToNow();
+        }
+
+        return FSEphemerisTime(Clock.Now());
     }
 
     // Size of FSAngle != sizeof double, ...
@@ -220,7 +956,7 @@ namespace MaxQ::Data
 
         auto _bodynm = StringCast<ANSICHAR>(*bodynm);
         auto _item = StringCast<ANSICHAR>(*item);
-        bodvrd_c(_bodynm.Get(), _item.Get(), N, &n_actual, _result);
+        CachedBodvrd(_bodynm.Get(), _item.Get(), N, &n_actual, _result);
 
         Value = _result[0];
 
@@ -248,7 +984,7 @@ namespace MaxQ::Data
 
         auto _bodynm = StringCast<ANSICHAR>(*bodynm);
         auto _item = StringCast<ANSICHAR>(*item);
-        bodvrd_c(_bodynm.Get(), _item.Get(), n_expected, &n_actual, _result);
+        CachedBodvrd(_bodynm.Get(), _item.Get(), n_expected, &n_actual, _result);
 
         if (!ErrorCheck(ResultCode, ErrorMessage) && n_actual != n_expected)
         {
@@ -273,7 +1009,7 @@ namespace MaxQ::Data
         auto _bodynm = StringCast<ANSICHAR>(*bodynm);
         auto _item = StringCast<ANSICHAR>(*item);
 
-        bodvrd_c(_bodynm.Get(), _item.Get(), N, &n_actual, _result);
+        CachedBodvrd(_bodynm.Get(), _item.Get(), N, &n_actual, _result);
 
         Value = ValueType{ _result };
 
@@ -323,7 +1059,7 @@ namespace MaxQ::Data
         SpiceInt n_actual, n_expected = Values.Num();
         Values.Init(0, n_expected);
 
-        bodvcd_c(bodyid, TCHAR_TO_ANSI(*item), n_expected, &n_actual, _result);
+        CachedBodvcd(bodyid, TCHAR_TO_ANSI(*item), n_expected, &n_actual, _result);
 
         if (!ErrorCheck(ResultCode, ErrorMessage) && n_actual != n_expected)
         {
@@ -347,7 +1083,7 @@ namespace MaxQ::Data
         SpiceDouble _result[N]; ZeroOut(Value);
         SpiceInt n_actual = 0;
 
-        bodvcd_c(bodyid, TCHAR_TO_ANSI(*item), N, &n_actual, _result);
+        CachedBodvcd(bodyid, TCHAR_TO_ANSI(*item), N, &n_actual, _result);
 
         Value = _result[0];
 
@@ -371,7 +1107,7 @@ namespace MaxQ::Data
         SpiceDouble _result[N]; ZeroOut(Value);
         SpiceInt n_actual = 0;
 
-        bodvcd_c(bodyid, TCHAR_TO_ANSI(*item), N, &n_actual, _result);
+        CachedBodvcd(bodyid, TCHAR_TO_ANSI(*item), N, &n_actual, _result);
 
         Value = ValueType{ _result };
 
@@ -404,7 +1140,7 @@ namespace MaxQ::Data
         SpiceDouble     _value { 0 };
         SpiceBoolean    _found = SPICEFALSE;
 
-        gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
+        CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, &_value, &_found);
 
         Value = double{ _value };
 
@@ -447,7 +1183,7 @@ namespace MaxQ::Data
 
         Values.Init(0, _room);
 
-        gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
+        CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
 
         if (!ErrorCheck(ResultCode, ErrorMessage) && !_found)
         {
@@ -470,7 +1206,7 @@ namespace MaxQ::Data
         SpiceDouble     _values[sizeof (ValueType) / sizeof (SpiceDouble) ];
         SpiceBoolean    _found = SPICEFALSE;
 
-        gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
+        CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
 
         Value = ValueType{ _values };
 
@@ -491,6 +1227,13 @@ namespace MaxQ::Data
 
      SPICE_API bool Bodc2n(FString& name, int code /*= 399 */)
     {
+        // No need to ask CSPICE
+        TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> Registry = GetNameRegistry();
+        if (Registry->IsCurrent())
+        {
+            return Registry->BodyName(code, name);
+        }
+
         SpiceChar szBuffer[SPICE_MAX_PATH];
         ZeroOut(szBuffer);
 
@@ -508,6 +1251,12 @@ namespace MaxQ::Data
 
     SPICE_API bool Bods2c(int& code, const FString& name /*= TEXT("EARTH") */)
     {
+        TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> Registry = GetNameRegistry();
+        if (Registry->IsCurrent())
+        {
+            return Registry->BodyCode(name, code);
+        }
+
         SpiceInt _code = code;
         SpiceBoolean _found = SPICEFALSE;
         bods2c_c(TCHAR_TO_ANSI(*name), &_code, &_found);
@@ -533,7 +1282,13 @@ namespace MaxQ::Data
     SPICE_API void Boddef(const FString& name, int code /*= 3788040 */)
     {
         boddef_c(TCHAR_TO_ANSI(*name), (SpiceInt)code);
+        RecordBoddef(name);
+
+        // bodvrd values are looked up by name
+        InvalidatePoolCache();
 
         UnexpectedErrorCheck(true);
+
+        UpdateNameRegistry();
     }
 }
@@ -20,6 +20,7 @@
 #include "Containers/StringFwd.h"
 #include "Spice.h"
 #include "SpiceUtilities.h"
+#include "SpiceCoverageIndex.h"
 
 #include <iomanip>
 #include <sstream>
@@ -39,365 +40,166 @@ using namespace MaxQ::Private;
 
 DEFINE_LOG_CATEGORY(LogSpiceDiagnostics);
 
-void USpiceDiagnostics::DumpSpkSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath, const FString& relativeSpkPath)
+namespace
 {
-    LogString.Empty();
-    FString fullPathToFile = toPath(relativeSpkPath);
-
+    // The kernel's directory is the working directory while it's read, as
+    // Furnsh does it (relative paths inside a kernel resolve against it).
+    // Restored however the dump returns.
+    struct FKernelWorkingDirectory
+    {
 #ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Get the current working directory...
-    TCHAR buffer[WINDOWS_MAX_PATH];
-    TCHAR* oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
+        TCHAR buffer[SPICE_MAX_PATH];
+        TCHAR* oldWorkingDirectory = nullptr;
 
-    // Trim the file name to just the full directory path...
-    FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
-    fullPathToDirectory.ReplaceCharInline('/', '\\');
+        FKernelWorkingDirectory(const FString& fullPathToFile)
+        {
+            // Get the current working directory...
+            oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
+
+            // Trim the file name to just the full directory path...
+            FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
+            fullPathToDirectory.ReplaceCharInline('/', '\\');
+
+            if (FPaths::DirectoryExists(fullPathToDirectory))
+            {
+                // Set the current working directory
+                _tchdir(*fullPathToDirectory);
+            }
+        }
 
-    if (FPaths::DirectoryExists(fullPathToDirectory))
-    {
-        // Set the current working directory
-        _tchdir(*fullPathToDirectory);
-    }
+        ~FKernelWorkingDirectory()
+        {
+            // Reset the working directory to prior state...
+            if (oldWorkingDirectory)
+            {
+                _tchdir(oldWorkingDirectory);
+            }
+        }
+#else
+        FKernelWorkingDirectory(const FString& fullPathToFile) {}
 #endif
+    };
 
-    // Implementation from:
-    // https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/spkcov_c.html
-    constexpr int32  MAXIV{ 1000 };
-    constexpr int32  WINSIZ{ (2 * MAXIV) };
-    constexpr int32  TIMLEN{ 51 };
-    constexpr int32  MAXOBJ{ 1000 };
-
-    /*
-        Local variables
-    */
-
-    SPICEDOUBLE_CELL(cover, WINSIZ);
-    SPICEINT_CELL(ids, MAXOBJ);
-
-    SpiceChar               timstr[TIMLEN];
+    // One banner per object, then its coverage intervals as TDB calendar
+    // strings
+    void AppendCoverage(FString& LogString, const Data::FKernelCoverageIndex& Index, Data::EKernelCoverageType Type, ConstSpiceChar* TimeFormat)
+    {
+        constexpr int32  TIMLEN{ 51 };
+        SpiceChar        timstr[TIMLEN];
 
-    SpiceDouble             b;
-    SpiceDouble             e;
+        for (int32 obj : Index.Ids(Type))
+        {
+            LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
+
+            switch (Type)
+            {
+            case Data::EKernelCoverageType::SPK:
+            {
+                SpiceBoolean found;
+                char szBodyName[256];
+                bodc2n_c(obj, sizeof(szBodyName) - 1, szBodyName, &found);
+
+                LogString += FString::Printf(TEXT("Coverage for object %d (%s)\n"), (int)obj, found ? *FString(szBodyName) : TEXT("NAIF ID not found"));
+                break;
+            }
+            case Data::EKernelCoverageType::PCK:
+                LogString += FString::Printf(TEXT("Coverage for frame %d\n"), (int)obj);
+                break;
+            default:
+                LogString += FString::Printf(TEXT("Coverage for object %d\n"), (int)obj);
+                break;
+            }
+
+            const GeometryFinder::FSWindow& cover = Index.Coverage(Type, obj);
+            for (int32 j = 0; j < cover.Num(); j++)
+            {
+                timout_c(cover.Start(j), TimeFormat, TIMLEN, timstr);
+
+                LogString += FString::Printf(TEXT("\n")
+                    TEXT("Interval:  %d\n")
+                    TEXT("Start:     %s\n"),
+                    (int)j,
+                    *FString(timstr));
+
+                timout_c(cover.Stop(j), TimeFormat, TIMLEN, timstr);
+                LogString += FString::Printf(TEXT("Stop:      %s\n"), *FString(timstr));
+            }
+        }
 
-    SpiceInt                i;
-    SpiceInt                j;
-    SpiceInt                niv;
-    SpiceInt                obj;
+        LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
+    }
+}
 
+void USpiceDiagnostics::DumpSpkSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath, const FString& relativeSpkPath)
+{
+    LogString.Empty();
+    FKernelWorkingDirectory WorkingDirectory(toPath(relativeSpkPath));
 
     /*
     Load a leapseconds kernel for output time conversion.
-    spkcov_c itself does not require a leapseconds kernel.
+    The coverage index itself does not require a leapseconds kernel.
     */
     furnsh_c(TCHAR_TO_ANSI(*toPath(relativeLskPath)));
 
     if (ErrorCheck(ResultCode, ErrorMessage)) return;
 
-    /*
-    Get name of SPK file.
-    */
     LogString += FString::Printf(TEXT("Name of LSK file > %s\n"), *relativeLskPath);
 
     /*
-    Find the set of objects in the SPK file.
+    Index the objects in the SPK file, and their coverage.
     */
-    spkobj_c(TCHAR_TO_ANSI(*toPath(relativeSpkPath)), &ids);
-
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
+    Data::FKernelCoverageIndex Index;
+    if (!Index.Add({ relativeSpkPath }, &ResultCode, &ErrorMessage)) return;
 
     LogString += FString::Printf(TEXT("Name of SPK file > %s\n"), *relativeSpkPath);
 
-    /*
-    We want to display the coverage for each object.Loop over
-    the contents of the ID code set, find the coverage for
-    each item in the set, and display the coverage.
-    */
-    for (i = 0; i < card_c(&ids); i++)
-    {
-        /*
-        Find the coverage window for the current object.
-        Empty the coverage window each time so we don't
-        include data for the previous object.
-        */
-        obj = SPICE_CELL_ELEM_I(&ids, i);
-
-        scard_c(0, &cover);
-        spkcov_c(TCHAR_TO_ANSI(*toPath(relativeSpkPath)), obj, &cover);
-
-        if (ErrorCheck(ResultCode, ErrorMessage)) return;
-
-        /*
-        Get the number of intervals in the coverage window.
-        */
-        niv = wncard_c(&cover);
-
-        /*
-        Display a simple banner.
-        */
-        LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
-        SpiceBoolean found;
-        char szBodyName[256];
-        bodc2n_c(obj, sizeof(szBodyName) - 1, szBodyName, &found);
-
-        LogString += FString::Printf(TEXT("Coverage for object %d (%s)\n"), (int)obj, found ? *FString(szBodyName) : TEXT("NAIF ID not found"));
-
-        /*
-        Convert the coverage interval start and stop times to TDB
-        calendar strings.
-        */
-        for (j = 0; j < niv; j++)
-        {
-            /*
-            Get the endpoints of the jth interval.
-            */
-            wnfetd_c(&cover, j, &b, &e);
-
-            /*
-            Convert the endpoints to TDB calendar
-            format time strings and display them.
-            */
-            timout_c(b,
-                "YYYY MON DD HR:MN:SC.### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-
-            LogString += FString::Printf(TEXT("\n")
-                TEXT("Interval:  %d\n")
-                TEXT("Start:     %s\n"),
-                (int)j,
-                *FString(timstr));
-
-            timout_c(e,
-                "YYYY MON DD HR:MN:SC.### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-            LogString += FString::Printf(TEXT("Stop:      %s\n"), *FString(timstr));
-
-        }
-    }
-
-    LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
+    AppendCoverage(LogString, Index, Data::EKernelCoverageType::SPK, "YYYY MON DD HR:MN:SC.### (TDB) ::TDB");
 
     UE_LOG(LogSpiceDiagnostics, Log, TEXT("Spice SPK Coverage diagnostic:\n%s"), *LogString);
 
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Reset the working directory to prior state...
-    if (oldWorkingDirectory)
-    {
-        _tchdir(oldWorkingDirectory);
-    }
-#endif
-
     ErrorCheck(ResultCode, ErrorMessage);
 }
 
 void USpiceDiagnostics::DumpPckSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath /*= TEXT("NonAssetData/naif/kernels/Generic/LSK/naif0012.tls")*/, const FString& relativePckPath /*= TEXT("NonAssetData/naif/kernels/Generic/PCK/earth_200101_990628_predict.bpc") */)
 {
     LogString.Empty();
-    FString fullPathToFile = toPath(relativePckPath);
-
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Get the current working directory...
-    TCHAR buffer[WINDOWS_MAX_PATH];
-    TCHAR* oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
-
-    // Trim the file name to just the full directory path...
-    FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
-    fullPathToDirectory.ReplaceCharInline('/', '\\');
-
-    if (FPaths::DirectoryExists(fullPathToDirectory))
-    {
-        // Set the current working directory
-        _tchdir(*fullPathToDirectory);
-    }
-#endif
-
-    // Implementation from:
-    // https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/pckfrm_c.html
-
-    /*
-        Local parameters
-    */
-    constexpr int32  FILSIZ{ 256 };
-    constexpr int32  MAXIV{ 1000 };
-    constexpr int32  WINSIZ{ (2 * MAXIV) };
-    constexpr int32  TIMLEN{ 51 };
-    constexpr int32  MAXOBJ{ 1000 };
+    FKernelWorkingDirectory WorkingDirectory(toPath(relativePckPath));
 
     /*
-    Local variables
+    Load a leapseconds kernel for output time conversion.
+    The coverage index itself does not require a leapseconds kernel.
     */
-    SPICEDOUBLE_CELL(cover, WINSIZ);
-    SPICEINT_CELL(ids, MAXOBJ);
-
-    SpiceChar               timstr[TIMLEN];
-
-    SpiceDouble             b{ 0. };
-    SpiceDouble             e{ 0. };
-
-    SpiceInt                i;
-    SpiceInt                j;
-    SpiceInt                niv;
-    SpiceInt                obj;
-
-
-    /*
-        Load a leapseconds kernel for output time conversion.
-        pckcov_c itself does not require a leapseconds kernel.
-        */
-
     furnsh_c(TCHAR_TO_ANSI(*toPath(relativeLskPath)));
 
     if (ErrorCheck(ResultCode, ErrorMessage)) return;
 
     LogString += FString::Printf(TEXT("Name of LSK file > %s\n"), *relativeLskPath);
 
-
     /*
-        Find the set of frames in the PCK file.
-        */
-    pckfrm_c(TCHAR_TO_ANSI(*toPath(relativePckPath)), &ids);
-
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
+    Index the frames in the PCK file, and their coverage.
+    */
+    Data::FKernelCoverageIndex Index;
+    if (!Index.Add({ relativePckPath }, &ResultCode, &ErrorMessage)) return;
 
     LogString += FString::Printf(TEXT("Name of PCK file > %s\n"), *relativePckPath);
 
-    /*
-        We want to display the coverage for each frame.Loop over
-        the contents of the ID code set, find the coverage for
-        each item in the set, and display the coverage.
-        */
-    for (i = 0; i < card_c(&ids); i++)
-    {
-        /*
-            Find the coverage window for the current frame.
-            Empty the coverage window each time so we don't
-            include data for the previous frame.
-            */
-        obj = SPICE_CELL_ELEM_I(&ids, i);
-
-        scard_c(0, &cover);
-        pckcov_c(TCHAR_TO_ANSI(*toPath(relativePckPath)), obj, &cover);
-
-        if (ErrorCheck(ResultCode, ErrorMessage)) return;
-
-        /*
-            Get the number of intervals in the coverage window.
-            */
-        niv = wncard_c(&cover);
-
-        /*
-            Display a simple banner.
-            */
-        LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
-        LogString += FString::Printf(TEXT("Coverage for frame %d\n"), (int)obj);
-
-        /*
-            Convert the coverage interval start and stop times to TDB
-            calendar strings.
-            */
-        for (j = 0; j < niv; j++)
-        {
-            /*
-                Get the endpoints of the jth interval.
-                . /
-                wnfetd_c(&cover, j, &b, &e);
-
-            */
-            timout_c(b,
-                "YYYY MON DD HR:MN:SC.### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-
-            LogString += FString::Printf(TEXT("\n")
-                TEXT("Interval:  %d\n")
-                TEXT("Start:     %s\n"),
-                (int)j,
-                *FString(timstr));
-
-            timout_c(e,
-                "YYYY MON DD HR:MN:SC.### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-            LogString += FString::Printf(TEXT("Stop:      %s\n"), *FString(timstr));
-        }
-    }
-
-    LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
+    AppendCoverage(LogString, Index, Data::EKernelCoverageType::PCK, "YYYY MON DD HR:MN:SC.### (TDB) ::TDB");
 
     UE_LOG(LogSpiceDiagnostics, Log, TEXT("Spice Binary PCK Coverage diagnostic:\n%s"), *LogString);
 
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Reset the working directory to prior state...
-    if (oldWorkingDirectory)
-    {
-        _tchdir(oldWorkingDirectory);
-    }
-#endif
-
     ErrorCheck(ResultCode, ErrorMessage);
 }
 
 void USpiceDiagnostics::DumpCkSummary(ES_ResultCode& ResultCode, FString& ErrorMessage, FString& LogString, const FString& relativeLskPath /*= TEXT("NonAssetData/naif/kernels/Generic/LSK/naif0012.tls")*/, const FString& relativeSclkPath /*= TEXT("NonAssetData/naif/kernels/INSIGHT/SCLK/NSY_SCLKSCET.00023.tsc")*/, const FString& relativeCkPath /*= TEXT("NonAssetData/naif/kernels/INSIGHT/CK/ckckck") */)
 {
     LogString.Empty();
-    FString fullPathToFile = toPath(relativeCkPath);
-
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Get the current working directory...
-    TCHAR buffer[WINDOWS_MAX_PATH];
-    TCHAR* oldWorkingDirectory = _tgetcwd(buffer, sizeof(buffer) / sizeof(buffer[0]));
-
-    // Trim the file name to just the full directory path...
-    FString fullPathToDirectory = FPaths::GetPath(fullPathToFile);
-    fullPathToDirectory.ReplaceCharInline('/', '\\');
-
-    if (FPaths::DirectoryExists(fullPathToDirectory))
-    {
-        // Set the current working directory
-        _tchdir(*fullPathToDirectory);
-    }
-#endif
-
-
-    // Implementation from:
-    // https://naif.jpl.nasa.gov/pub/naif/toolkit_docs/C/cspice/ckcov_c.html
+    FKernelWorkingDirectory WorkingDirectory(toPath(relativeCkPath));
 
     /*
-        Local parameters
-        */
-    constexpr int32  FILSIZ{ 256 };
-    constexpr int32  MAXIV{ 100000 };
-    constexpr int32  WINSIZ{ (2 * MAXIV) };
-    constexpr int32  TIMLEN{ 51 };
-    constexpr int32  MAXOBJ{ 1000 };
-
-    /*
-            Local variables
-            */
-    SPICEDOUBLE_CELL(cover, WINSIZ);
-    SPICEINT_CELL(ids, MAXOBJ);
-
-    SpiceChar               timstr[TIMLEN];
-
-    SpiceDouble             b;
-    SpiceDouble             e;
-
-    SpiceInt                i;
-    SpiceInt                j;
-    SpiceInt                niv;
-    SpiceInt                obj;
-
-
-    /*
-        Load a leapseconds kernel and SCLK kernel for output time
-        conversion.Note that we assume a single spacecraft clock is
-        associated with all of the objects in the CK.
-        */
-
+    Load a leapseconds kernel and SCLK kernel:  CK coverage is indexed
+    in TDB.  Note that we assume a single spacecraft clock is
+    associated with all of the objects in the CK.
+    */
     furnsh_c(TCHAR_TO_ANSI(*toPath(relativeLskPath)));
 
     if (ErrorCheck(ResultCode, ErrorMessage)) return;
@@ -408,90 +210,15 @@ void USpiceDiagnostics::DumpCkSummary(ES_ResultCode& ResultCode, FString& ErrorM
     LogString += FString::Printf(TEXT("Name of SCLK file > %s\n"), *relativeSclkPath);
 
     /*
-        Find the set of objects in the CK file.
-        */
-    ckobj_c(TCHAR_TO_ANSI(*toPath(relativeCkPath)), &ids);
-
-    if (ErrorCheck(ResultCode, ErrorMessage)) return;
-
-    /*
-        We want to display the coverage for each object.Loop over
-        the contents of the ID code set, find the coverage for
-        each item in the set, and display the coverage.
-        */
-    for (i = 0; i < card_c(&ids); i++)
-    {
-        /*
-            Find the coverage window for the current object.
-            Empty the coverage window each time so we don't
-            include data for the previous object.
-            */
-        obj = SPICE_CELL_ELEM_I(&ids, i);
-
-        scard_c(0, &cover);
-        ckcov_c(TCHAR_TO_ANSI(*toPath(relativeCkPath)), obj, SPICEFALSE,
-            "INTERVAL", 0.0, "TDB", &cover);
-
-        if (ErrorCheck(ResultCode, ErrorMessage)) return;
-        /*
-            Get the number of intervals in the coverage window.
-            */
-        niv = wncard_c(&cover);
-
-        /*
-            Display a simple banner.
-            */
-        LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
-
-        LogString += FString::Printf(TEXT("Coverage for object %d\n"), (int)obj);
-
-        /*
-            Convert the coverage interval start and stop times to TDB
-            calendar strings.
-            */
-        for (j = 0; j < niv; j++)
-        {
-            /*
-                Get the endpoints of the jth interval.
-                */
-            wnfetd_c(&cover, j, &b, &e);
-
-            /*
-                Convert the endpoints to TDB calendar
-                format time strings and display them.
-                */
-            timout_c(b,
-                "YYYY MON DD HR:MN:SC.###### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-
-            LogString += FString::Printf(TEXT("\n")
-                TEXT("Interval:  %d\n")
-                TEXT("Start:     %s\n"),
-                (int)j,
-                *FString(timstr));
-
-            timout_c(e,
-                "YYYY MON DD HR:MN:SC.###### (TDB) ::TDB",
-                TIMLEN,
-                timstr);
-            LogString += FString::Printf(TEXT("Stop:      %s\n"), *FString(timstr));
-
-        }
-    }
+    Index the objects in the CK file, and their coverage.
+    */
+    Data::FKernelCoverageIndex Index;
+    if (!Index.Add({ relativeCkPath }, &ResultCode, &ErrorMessage)) return;
 
-    LogString += FString::Printf(TEXT("%s\n"), TEXT("========================================"));
+    AppendCoverage(LogString, Index, Data::EKernelCoverageType::CK, "YYYY MON DD HR:MN:SC.###### (TDB) ::TDB");
 
     UE_LOG(LogSpiceDiagnostics, Log, TEXT("Spice CK Coverage diagnostic:\n%s"), *LogString);
 
-#ifdef SET_WORKING_DIRECTORY_IN_FURNSH
-    // Reset the working directory to prior state...
-    if (oldWorkingDirectory)
-    {
-        _tchdir(oldWorkingDirectory);
-    }
-#endif
-
     ErrorCheck(ResultCode, ErrorMessage);
 }
 
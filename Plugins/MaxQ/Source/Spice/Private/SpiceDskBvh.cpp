@@ -0,0 +1,728 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskBvh.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Native, multithreaded ray casting against DSK type 2 shape models.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskBvh.cpp is part of the "refined C++ API".
+//
+// The hierarchy is built top down, splitting each node along its longest
+// centroid axis at the cheapest of 16 binned surface area heuristic splits
+// (or the median, if binning can't separate the plates).  Nodes are stored
+// depth first, so a node's left child is the next node.
+//
+// Traversal visits the nearer child first, and skips any node whose box is
+// entered beyond the nearest hit so far.  Plates are tested with
+// Moller-Trumbore, in double precision, against barycentric bounds widened
+// by CSPICE's plate expansion fraction.
+//------------------------------------------------------------------------------
+
+#include "SpiceDskBvh.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+#include <algorithm>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr int32 NumBins = 16;
+    constexpr int32 MaxLeafPlates = 4;
+    constexpr int32 MaxDepth = 96;
+    constexpr int32 RaysPerTask = 1024;
+
+    // CSPICE's plate expansion fraction (dsktol XFRACT)
+    constexpr double PlateExpansion = 1.e-10;
+
+    struct FBox
+    {
+        double Min[3] = { TNumericLimits<double>::Max(), TNumericLimits<double>::Max(), TNumericLimits<double>::Max() };
+        double Max[3] = { TNumericLimits<double>::Lowest(), TNumericLimits<double>::Lowest(), TNumericLimits<double>::Lowest() };
+
+        void Add(const double* p)
+        {
+            for (int32 c = 0; c < 3; ++c)
+            {
+                Min[c] = FMath::Min(Min[c], p[c]);
+                Max[c] = FMath::Max(Max[c], p[c]);
+            }
+        }
+
+        void Add(const FBox& b)
+        {
+            for (int32 c = 0; c < 3; ++c)
+            {
+                Min[c] = FMath::Min(Min[c], b.Min[c]);
+                Max[c] = FMath::Max(Max[c], b.Max[c]);
+            }
+        }
+
+        double HalfArea() const
+        {
+            if (Min[0] > Max[0]) return 0.;
+            const double x = Max[0] - Min[0], y = Max[1] - Min[1], z = Max[2] - Min[2];
+            return x * y + y * z + z * x;
+        }
+    };
+
+    struct FPlateBounds
+    {
+        FBox Box;
+        double Centroid[3];
+    };
+
+    inline void Sub(const double* a, const double* b, double(&out)[3])
+    {
+        out[0] = a[0] - b[0]; out[1] = a[1] - b[1]; out[2] = a[2] - b[2];
+    }
+
+    inline void Cross(const double(&a)[3], const double(&b)[3], double(&out)[3])
+    {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    inline double Dot(const double(&a)[3], const double(&b)[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    // Slab test.  Entry distance, if the box is entered before tMax.
+    inline bool HitBox(const double* Min, const double* Max, const double(&Origin)[3], const double(&InvDirection)[3], double tMax, double& tEnter)
+    {
+        double t0 = 0., t1 = tMax;
+        for (int32 c = 0; c < 3; ++c)
+        {
+            double tNear = (Min[c] - Origin[c]) * InvDirection[c];
+            double tFar = (Max[c] - Origin[c]) * InvDirection[c];
+            if (tNear > tFar) Swap(tNear, tFar);
+            // NaN (0 * inf, a ray in a slab's plane) leaves the bounds alone
+            t0 = tNear > t0 ? tNear : t0;
+            t1 = tFar < t1 ? tFar : t1;
+            if (t0 > t1 * (1. + 1.e-15))
+            {
+                return false;
+            }
+        }
+        tEnter = t0;
+        return true;
+    }
+
+    // Moller-Trumbore, with the barycentric bounds widened
+    inline bool HitPlate(const double* v1, const double* v2, const double* v3, const double(&Origin)[3], const double(&Direction)[3], double& t)
+    {
+        double e1[3], e2[3], p[3], s[3], q[3];
+        Sub(v2, v1, e1);
+        Sub(v3, v1, e2);
+        Cross(Direction, e2, p);
+        const double det = Dot(e1, p);
+        if (det == 0.)
+        {
+            return false;
+        }
+        const double inv = 1. / det;
+        Sub(Origin, v1, s);
+        const double u = Dot(s, p) * inv;
+        if (u < -PlateExpansion || u > 1. + PlateExpansion)
+        {
+            return false;
+        }
+        Cross(s, e1, q);
+        const double v = Dot(Direction, q) * inv;
+        if (v < -PlateExpansion || u + v > 1. + PlateExpansion)
+        {
+            return false;
+        }
+        t = Dot(e2, q) * inv;
+        return t >= 0.;
+    }
+
+    bool ReadSegments(MaxQ::Dsk::FDskShapeModel& Model, SpiceInt _handle, int Body, TArrayView<const int32> Surfaces)
+    {
+        return ReadDskType2Segments(_handle, Body, Surfaces, [&](const SpiceDSKDescr& _dskdsc, TArray<double>& Vertices, TArray<int32>& Plates)
+        {
+            FString Error;
+            if (!Model.AddSegment(Vertices, Plates, _dskdsc.frmcde, _dskdsc.surfce, nullptr, &Error))
+            {
+                setmsg_c("#");
+                errch_c("#", StringCast<ANSICHAR>(*Error).Get());
+                sigerr_c("SPICE(BADDSKSEGMENT)");
+                return false;
+            }
+            return true;
+        });
+    }
+}
+
+
+namespace MaxQ::Dsk
+{
+    bool FDskShapeModel::AddSegment(TArrayView<const double> Vertices, TArrayView<const int32> Plates, int32 Frame, int32 Surface, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        auto Fail = [&](const FString& Message)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = Message;
+            return false;
+        };
+
+        if (Segments.Num() > 0 && Frame != FrameCode)
+        {
+            return Fail(FString::Printf(TEXT("FDskShapeModel::AddSegment: frame %d, but the model is in %d"), Frame, FrameCode));
+        }
+        if (Vertices.Num() % 3 != 0 || Plates.Num() % 3 != 0)
+        {
+            return Fail(TEXT("FDskShapeModel::AddSegment: vertices and plates come in threes"));
+        }
+
+        const int32 NumVertices = Vertices.Num() / 3;
+        for (int32 Index : Plates)
+        {
+            if (Index < 1 || Index > NumVertices)
+            {
+                return Fail(FString::Printf(TEXT("FDskShapeModel::AddSegment: vertex %d is outside [1, %d]"), Index, NumVertices));
+            }
+        }
+
+        FSegment& Segment = Segments.AddDefaulted_GetRef();
+        Segment.Vertices = Vertices;
+        Segment.Plates.SetNumUninitialized(Plates.Num());
+        for (int32 i = 0; i < Plates.Num(); ++i)
+        {
+            Segment.Plates[i] = Plates[i] - 1;
+        }
+        Segment.Surface = Surface;
+        FrameCode = Frame;
+
+        Build(Segment);
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FDskShapeModel::AddFile(const FString& relativePath, int Body, TArrayView<const int32> Surfaces, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        SpiceInt _handle = 0;
+        dasopr_c(StringCast<ANSICHAR>(*toPath(relativePath)).Get(), &_handle);
+        if (!failed_c())
+        {
+            ReadSegments(*this, _handle, Body, Surfaces);
+            CloseDas(_handle);
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    bool FDskShapeModel::AddLoaded(int Body, TArrayView<const int32> Surfaces, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        TArray<SpiceInt> Handles;
+        LoadedDskHandles(Handles);
+
+        for (int32 i = 0; i < Handles.Num() && !failed_c(); ++i)
+        {
+            ReadSegments(*this, Handles[i], Body, Surfaces);
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    void FDskShapeModel::Reset()
+    {
+        Segments.Empty();
+        FrameCode = 0;
+    }
+
+
+    int32 FDskShapeModel::NumPlates() const
+    {
+        int32 Count = 0;
+        for (const FSegment& Segment : Segments)
+        {
+            Count += Segment.Plates.Num() / 3;
+        }
+        return Count;
+    }
+
+
+    double FDskShapeModel::BoundingRadius() const
+    {
+        double MaxSquared = 0.;
+        for (const FSegment& Segment : Segments)
+        {
+            const TArray<double>& v = Segment.Vertices;
+            for (int32 i = 0; i + 2 < v.Num(); i += 3)
+            {
+                MaxSquared = FMath::Max(MaxSquared, v[i] * v[i] + v[i + 1] * v[i + 1] + v[i + 2] * v[i + 2]);
+            }
+        }
+        return FMath::Sqrt(MaxSquared);
+    }
+
+
+    SIZE_T FDskShapeModel::GetAllocatedSize() const
+    {
+        SIZE_T Size = Segments.GetAllocatedSize();
+        for (const FSegment& Segment : Segments)
+        {
+            Size += Segment.Vertices.GetAllocatedSize() + Segment.Plates.GetAllocatedSize() + Segment.Nodes.GetAllocatedSize() + Segment.Order.GetAllocatedSize();
+        }
+        return Size;
+    }
+
+
+    void FDskShapeModel::Build(FSegment& Segment)
+    {
+        const int32 NumPlates = Segment.Plates.Num() / 3;
+
+        TArray<FPlateBounds> Bounds;
+        Bounds.SetNumUninitialized(NumPlates);
+        for (int32 i = 0; i < NumPlates; ++i)
+        {
+            FPlateBounds& b = Bounds[i];
+            b.Box = FBox();
+            for (int32 k = 0; k < 3; ++k)
+            {
+                b.Box.Add(&Segment.Vertices[3 * Segment.Plates[3 * i + k]]);
+            }
+            for (int32 c = 0; c < 3; ++c)
+            {
+                b.Centroid[c] = 0.5 * (b.Box.Min[c] + b.Box.Max[c]);
+            }
+        }
+
+        Segment.Order.SetNumUninitialized(NumPlates);
+        for (int32 i = 0; i < NumPlates; ++i)
+        {
+            Segment.Order[i] = i;
+        }
+        Segment.Nodes.Reset();
+        Segment.Nodes.Reserve(FMath::Max(1, 2 * NumPlates / MaxLeafPlates));
+
+        TArray<FNode>& Nodes = Segment.Nodes;
+        TArray<int32>& Order = Segment.Order;
+
+        TFunction<void(int32, int32, int32)> Split = [&](int32 Begin, int32 End, int32 Depth)
+        {
+            const int32 NodeIndex = Nodes.AddUninitialized();
+
+            FBox Box, Centroids;
+            for (int32 i = Begin; i < End; ++i)
+            {
+                Box.Add(Bounds[Order[i]].Box);
+                Centroids.Add(Bounds[Order[i]].Centroid);
+            }
+            FNode Node;
+            for (int32 c = 0; c < 3; ++c)
+            {
+                Node.Min[c] = Box.Min[c];
+                Node.Max[c] = Box.Max[c];
+            }
+            Node.Start = Begin;
+            Node.Count = End - Begin;
+
+            const int32 Count = End - Begin;
+            int32 Axis = 0;
+            for (int32 c = 1; c < 3; ++c)
+            {
+                if (Centroids.Max[c] - Centroids.Min[c] > Centroids.Max[Axis] - Centroids.Min[Axis]) Axis = c;
+            }
+            const double Extent = Centroids.Max[Axis] - Centroids.Min[Axis];
+
+            if (Count <= MaxLeafPlates || Depth >= MaxDepth || !(Extent > 0.))
+            {
+                Nodes[NodeIndex] = Node;
+                return;
+            }
+
+            // Binned SAH
+            FBox BinBoxes[NumBins];
+            int32 BinCounts[NumBins] = {};
+            const double Scale = NumBins / Extent;
+            auto BinOf = [&](int32 Plate) { return FMath::Min(NumBins - 1, (int32)((Bounds[Plate].Centroid[Axis] - Centroids.Min[Axis]) * Scale)); };
+            for (int32 i = Begin; i < End; ++i)
+            {
+                const int32 Bin = BinOf(Order[i]);
+                BinBoxes[Bin].Add(Bounds[Order[i]].Box);
+                ++BinCounts[Bin];
+            }
+
+            double RightArea[NumBins];
+            int32 RightCount[NumBins];
+            FBox Accumulated;
+            int32 Accumulator = 0;
+            for (int32 b = NumBins - 1; b > 0; --b)
+            {
+                Accumulated.Add(BinBoxes[b]);
+                Accumulator += BinCounts[b];
+                RightArea[b] = Accumulated.HalfArea();
+                RightCount[b] = Accumulator;
+            }
+
+            int32 BestSplit = INDEX_NONE;
+            double BestCost = TNumericLimits<double>::Max();
+            Accumulated = FBox();
+            Accumulator = 0;
+            for (int32 b = 1; b < NumBins; ++b)
+            {
+                Accumulated.Add(BinBoxes[b - 1]);
+                Accumulator += BinCounts[b - 1];
+                if (Accumulator == 0 || RightCount[b] == 0) continue;
+                const double Cost = Accumulated.HalfArea() * Accumulator + RightArea[b] * RightCount[b];
+                if (Cost < BestCost)
+                {
+                    BestCost = Cost;
+                    BestSplit = b;
+                }
+            }
+
+            int32 Mid = Begin + Count / 2;
+            if (BestSplit != INDEX_NONE)
+            {
+                Mid = (int32)(std::partition(Order.GetData() + Begin, Order.GetData() + End, [&](int32 Plate) { return BinOf(Plate) < BestSplit; }) - Order.GetData());
+            }
+            if (Mid == Begin || Mid == End)
+            {
+                Mid = Begin + Count / 2;
+                std::nth_element(Order.GetData() + Begin, Order.GetData() + Mid, Order.GetData() + End,
+                    [&](int32 a, int32 b) { return Bounds[a].Centroid[Axis] < Bounds[b].Centroid[Axis]; });
+            }
+
+            Split(Begin, Mid, Depth + 1);
+            Node.Start = Nodes.Num();
+            Node.Count = 0;
+            Split(Mid, End, Depth + 1);
+            Nodes[NodeIndex] = Node;
+        };
+
+        if (NumPlates > 0)
+        {
+            Split(0, NumPlates, 0);
+        }
+    }
+
+
+    bool FDskShapeModel::Intersect(const FSegment& Segment, const double(&Origin)[3], const double(&Direction)[3], double& tBest, int32& BestPlate)
+    {
+        if (Segment.Nodes.Num() == 0)
+        {
+            return false;
+        }
+
+        double InvDirection[3];
+        for (int32 c = 0; c < 3; ++c)
+        {
+            InvDirection[c] = 1. / Direction[c];
+        }
+
+        bool bHit = false;
+        int32 Stack[2 * MaxDepth + 2];
+        int32 Top = 0;
+        Stack[Top++] = 0;
+
+        while (Top > 0)
+        {
+            const FNode& Node = Segment.Nodes[Stack[--Top]];
+            double tEnter;
+            if (!HitBox(Node.Min, Node.Max, Origin, InvDirection, tBest, tEnter))
+            {
+                continue;
+            }
+
+            if (Node.Count > 0)
+            {
+                for (int32 i = Node.Start; i < Node.Start + Node.Count; ++i)
+                {
+                    const int32 Plate = Segment.Order[i];
+                    const int32* p = &Segment.Plates[3 * Plate];
+                    double t;
+                    if (HitPlate(&Segment.Vertices[3 * p[0]], &Segment.Vertices[3 * p[1]], &Segment.Vertices[3 * p[2]], Origin, Direction, t) && t < tBest)
+                    {
+                        tBest = t;
+                        BestPlate = Plate;
+                        bHit = true;
+                    }
+                }
+                continue;
+            }
+
+            // Nearer child on top
+            const int32 Left = (int32)(&Node - Segment.Nodes.GetData()) + 1;
+            const int32 Right = Node.Start;
+            double tLeft = 0., tRight = 0.;
+            const bool bLeft = HitBox(Segment.Nodes[Left].Min, Segment.Nodes[Left].Max, Origin, InvDirection, tBest, tLeft);
+            const bool bRight = HitBox(Segment.Nodes[Right].Min, Segment.Nodes[Right].Max, Origin, InvDirection, tBest, tRight);
+            if (bLeft && bRight)
+            {
+                Stack[Top++] = tLeft < tRight ? Right : Left;
+                Stack[Top++] = tLeft < tRight ? Left : Right;
+            }
+            else if (bLeft)
+            {
+                Stack[Top++] = Left;
+            }
+            else if (bRight)
+            {
+                Stack[Top++] = Right;
+            }
+        }
+
+        return bHit;
+    }
+
+
+    bool FDskShapeModel::Cast(const double(&Origin)[3], const double(&Direction)[3], double& t, int32& Segment, int32& Plate) const
+    {
+        Segment = INDEX_NONE;
+        if (Direction[0] == 0. && Direction[1] == 0. && Direction[2] == 0.)
+        {
+            return false;
+        }
+
+        t = TNumericLimits<double>::Max();
+        for (int32 s = 0; s < Segments.Num(); ++s)
+        {
+            int32 SegmentPlate = INDEX_NONE;
+            if (Intersect(Segments[s], Origin, Direction, t, SegmentPlate))
+            {
+                Segment = s;
+                Plate = SegmentPlate;
+            }
+        }
+
+        return Segment != INDEX_NONE;
+    }
+
+
+    bool FDskShapeModel::Intersect(const FSRay& Ray, FDskHit& Hit) const
+    {
+        Hit = FDskHit();
+
+        double Origin[3], Direction[3];
+        Ray.CopyTo(Origin, Direction);
+
+        double tBest = 0.;
+        int32 Plate = INDEX_NONE;
+        if (!Cast(Origin, Direction, tBest, Hit.Segment, Plate))
+        {
+            return false;
+        }
+        Hit.Plate = Plate + 1;
+
+        const FSegment& Segment = Segments[Hit.Segment];
+        Hit.bFound = true;
+        Hit.Surface = Segment.Surface;
+
+        double Point[3];
+        for (int32 c = 0; c < 3; ++c)
+        {
+            Point[c] = Origin[c] + tBest * Direction[c];
+        }
+        Hit.Point = FSDistanceVector(Point);
+
+        // dskn02
+        const int32* p = &Segment.Plates[3 * (Hit.Plate - 1)];
+        double e1[3], e2[3], n[3];
+        Sub(&Segment.Vertices[3 * p[1]], &Segment.Vertices[3 * p[0]], e1);
+        Sub(&Segment.Vertices[3 * p[2]], &Segment.Vertices[3 * p[1]], e2);
+        Cross(e1, e2, n);
+        const double Length = FMath::Sqrt(Dot(n, n));
+        if (Length > 0.)
+        {
+            for (double& Component : n) Component /= Length;
+        }
+        Hit.Normal = FSDimensionlessVector(n);
+        return true;
+    }
+
+
+    void FDskShapeModel::Intersect(TArrayView<const FSRay> Rays, TArray<FDskHit>& Hits) const
+    {
+        Hits.SetNum(Rays.Num());
+
+        const int32 NumTasks = FMath::DivideAndRoundUp(Rays.Num(), RaysPerTask);
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 End = FMath::Min(Rays.Num(), (Task + 1) * RaysPerTask);
+            for (int32 i = Task * RaysPerTask; i < End; ++i)
+            {
+                Intersect(Rays[i], Hits[i]);
+            }
+        });
+    }
+
+
+    void FDskShapeModel::Intersect(TArrayView<const FSRay> Rays, FDskHitBatch& Hits) const
+    {
+        Hits.SetNum(Rays.Num());
+
+        Hits.Sources.Reset();
+        for (const FSegment& Segment : Segments)
+        {
+            FDskHitBatch::FSource& Source = Hits.Sources.AddDefaulted_GetRef();
+            Source.Surface = Segment.Surface;
+            Source.Frame = FrameCode;
+        }
+
+        const int32 NumTasks = FMath::DivideAndRoundUp(Rays.Num(), RaysPerTask);
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 End = FMath::Min(Rays.Num(), (Task + 1) * RaysPerTask);
+            for (int32 i = Task * RaysPerTask; i < End; ++i)
+            {
+                double Origin[3], Direction[3];
+                Rays[i].CopyTo(Origin, Direction);
+
+                double t = 0.;
+                int32 Segment = INDEX_NONE, Plate = INDEX_NONE;
+                const bool bHit = Cast(Origin, Direction, t, Segment, Plate);
+
+                Hits.Found[i] = bHit ? 1 : 0;
+                Hits.X[i] = bHit ? Origin[0] + t * Direction[0] : 0.;
+                Hits.Y[i] = bHit ? Origin[1] + t * Direction[1] : 0.;
+                Hits.Z[i] = bHit ? Origin[2] + t * Direction[2] : 0.;
+                Hits.Plates[i] = bHit ? Plate + 1 : 0;
+                Hits.Segments[i] = Segment;
+            }
+        });
+    }
+
+
+    void FDskHitBatch::SetNum(int32 NumRays)
+    {
+        Found.SetNum(NumRays, false);
+        X.SetNum(NumRays, false);
+        Y.SetNum(NumRays, false);
+        Z.SetNum(NumRays, false);
+        Plates.SetNum(NumRays, false);
+        Segments.SetNum(NumRays, false);
+    }
+
+
+    SPICE_API bool Dskxsi(
+        FDskHitBatch& Hits,
+        TArrayView<const FSRay> Rays,
+        const FSEphemerisTime& et,
+        const FString& target,
+        const FString& fixref,
+        const FDskShapeModel* Model,
+        TArrayView<const int32> Surfaces,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_LLM_SCOPE();
+
+        auto _target = StringCast<ANSICHAR>(*target);
+        auto _fixref = StringCast<ANSICHAR>(*fixref);
+
+        if (Model)
+        {
+            SpiceInt _frcode = 0;
+            namfrm_c(_fixref.Get(), &_frcode);
+            if (!failed_c() && _frcode != Model->Frame())
+            {
+                setmsg_c("The shape model is in frame #, not # (#).");
+                errint_c("#", Model->Frame());
+                errch_c("#", _fixref.Get());
+                errint_c("#", _frcode);
+                sigerr_c("SPICE(FRAMEMISMATCH)");
+            }
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+
+            Model->Intersect(Rays, Hits);
+            return true;
+        }
+
+        Hits.SetNum(Rays.Num());
+        Hits.Sources.Reset();
+
+        // Sources, by handle and the segment's DLA base addresses
+        TMap<TTuple<SpiceInt, SpiceInt, SpiceInt>, int32> SourceIndex;
+
+        static_assert(sizeof(SpiceInt) == sizeof(int32), "surfaces are passed in place");
+        const SpiceInt _nsurf = Surfaces.Num();
+        SpiceInt* _srflst = (SpiceInt*)Surfaces.GetData();
+
+        for (int32 i = 0; i < Rays.Num(); ++i)
+        {
+            Hits.Found[i] = 0;
+            Hits.X[i] = Hits.Y[i] = Hits.Z[i] = 0.;
+            Hits.Plates[i] = 0;
+            Hits.Segments[i] = INDEX_NONE;
+
+            if (failed_c())
+            {
+                continue;
+            }
+
+            SpiceDouble _vertex[3], _raydir[3];
+            Rays[i].CopyTo(_vertex, _raydir);
+
+            SpiceDouble   _xpt[3];
+            SpiceInt      _handle = 0;
+            SpiceDLADescr _dladsc;
+            SpiceDSKDescr _dskdsc;
+            SpiceDouble   _dc[SPICE_DSKXSI_DCSIZE];
+            SpiceInt      _ic[SPICE_DSKXSI_ICSIZE];
+            SpiceBoolean  _found = SPICEFALSE;
+            dskxsi_c(SPICEFALSE, _target.Get(), _nsurf, _srflst, et.AsSpiceDouble(), _fixref.Get(), _vertex, _raydir, SPICE_DSKXSI_DCSIZE, SPICE_DSKXSI_ICSIZE, _xpt, &_handle, &_dladsc, &_dskdsc, _dc, _ic, &_found);
+
+            if (failed_c() || !_found)
+            {
+                continue;
+            }
+
+            int32& Source = SourceIndex.FindOrAdd(MakeTuple(_handle, _dladsc.ibase, _dladsc.dbase), INDEX_NONE);
+            if (Source == INDEX_NONE)
+            {
+                Source = Hits.Sources.Num();
+                FDskHitBatch::FSource& NewSource = Hits.Sources.AddDefaulted_GetRef();
+                NewSource.Surface = _dskdsc.surfce;
+                NewSource.Frame = _dskdsc.frmcde;
+                NewSource.Handle = _handle;
+                NewSource.Dla = FSDLADescr(&_dladsc);
+            }
+
+            Hits.Found[i] = 1;
+            Hits.X[i] = _xpt[0];
+            Hits.Y[i] = _xpt[1];
+            Hits.Z[i] = _xpt[2];
+            // Type 2 segments' plate ID
+            Hits.Plates[i] = _ic[0];
+            Hits.Segments[i] = Source;
+        }
+
+        return ErrorCheck(ResultCode, ErrorMessage) == 0;
+    }
+}
@@ -0,0 +1,239 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskHorizon.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Horizon maps baked from DSK shape models, for surface shadowing.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskHorizon.cpp is part of the "refined C++ API".
+//
+// A bin's horizon is bisected on the assumption that a ray that hits the
+// terrain at one elevation hits it at every lower one, which holds for
+// terrain that's a height field around the texel.  A ray at MinElevation
+// that misses ends the search early (open ground, or a rim).  Each step is
+// one ray, through FDskShapeModel's thread-safe single ray Intersect, with
+// a chunk of texels per ParallelFor task.
+//------------------------------------------------------------------------------
+
+#include "SpiceDskHorizon.h"
+#include "SpiceDskTerrain.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+
+namespace
+{
+    // Texels per ParallelFor task (each is NumAzimuths * Iterations rays)
+    constexpr int32 BakeChunkSize = 16;
+    // Texels per ParallelFor task, for lookups
+    constexpr int32 ChunkSize = 4096;
+
+    // The texel's radial (up), east and north unit vectors
+    void LocalFrame(const MaxQ::Dsk::FDskTerrainTileKey& Key, int32 Size, int32 Texel, double(&Up)[3], double(&East)[3], double(&North)[3])
+    {
+        const double Step = Key.Span() / (Size - 1);
+        const double Lon = Key.West() + Step * (Texel % Size);
+        const double Lat = Key.North() - Step * (Texel / Size);
+        const double cLat = cos(Lat), sLat = sin(Lat), cLon = cos(Lon), sLon = sin(Lon);
+
+        Up[0] = cLat * cLon; Up[1] = cLat * sLon; Up[2] = sLat;
+        East[0] = -sLon; East[1] = cLon; East[2] = 0.;
+        North[0] = -sLat * cLon; North[1] = -sLat * sLon; North[2] = cLat;
+    }
+}
+
+
+namespace MaxQ::Dsk
+{
+    float FDskHorizonMap::Elevation(int32 Texel, double Azimuth) const
+    {
+        // In bins, [0, NumAzimuths)
+        double x = FMath::Fmod(Azimuth / TWO_PI, 1.);
+        x = (x < 0. ? x + 1. : x) * NumAzimuths;
+
+        const int32 a0 = FMath::Min(int32(x), NumAzimuths - 1);
+        const int32 a1 = (a0 + 1) % NumAzimuths;
+        const double f = x - a0;
+
+        const float* e = &Elevations[Texel * NumAzimuths];
+        return float((1. - f) * e[a0] + f * e[a1]);
+    }
+
+
+    SPICE_API bool BakeHorizonMap(const FDskShapeModel& Model, const FDskTerrainTile& Tile, const FDskHorizonSettings& Settings, FDskHorizonMap& Map)
+    {
+        const int32 NumTexels = Tile.Size * Tile.Size;
+        if (Tile.Size < 2 || Tile.Radii.Num() != NumTexels || Model.NumPlates() == 0)
+        {
+            return false;
+        }
+
+        const int32 NumAzimuths = Align(FMath::Max(Settings.NumAzimuths, 4), 4);
+        const int32 Iterations = FMath::Max(Settings.Iterations, 0);
+        const double MinElevation = FMath::Clamp(Settings.MinElevation, -HALF_PI, HALF_PI);
+
+        Map.Size = Tile.Size;
+        Map.NumAzimuths = NumAzimuths;
+        Map.Elevations.SetNumUninitialized(NumTexels * NumAzimuths);
+
+        ParallelFor((NumTexels + BakeChunkSize - 1) / BakeChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * BakeChunkSize, NumTexels);
+            for (int32 k = Chunk * BakeChunkSize; k < End; ++k)
+            {
+                float* Elevations = &Map.Elevations[k * NumAzimuths];
+                if (Tile.Radii[k] <= 0.f)
+                {
+                    for (int32 a = 0; a < NumAzimuths; ++a)
+                    {
+                        Elevations[a] = float(MinElevation);
+                    }
+                    continue;
+                }
+
+                double u[3], e[3], n[3];
+                LocalFrame(Tile.Key, Tile.Size, k, u, e, n);
+
+                const double r = Tile.Radii[k] + Settings.Offset;
+                FSRay Ray;
+                Ray.point = FSDistanceVector(r * u[0], r * u[1], r * u[2]);
+                FDskHit Hit;
+
+                for (int32 a = 0; a < NumAzimuths; ++a)
+                {
+                    const double Azimuth = TWO_PI * a / NumAzimuths;
+                    const double h[3] = {
+                        cos(Azimuth) * n[0] + sin(Azimuth) * e[0],
+                        cos(Azimuth) * n[1] + sin(Azimuth) * e[1],
+                        cos(Azimuth) * n[2] + sin(Azimuth) * e[2]
+                    };
+
+                    auto Blocked = [&](double Elevation)
+                    {
+                        const double c = cos(Elevation), s = sin(Elevation);
+                        Ray.direction = FSDimensionlessVector(c * h[0] + s * u[0], c * h[1] + s * u[1], c * h[2] + s * u[2]);
+                        return Model.Intersect(Ray, Hit);
+                    };
+
+                    if (!Blocked(MinElevation))
+                    {
+                        Elevations[a] = float(MinElevation);
+                        continue;
+                    }
+
+                    double Lo = MinElevation, Hi = HALF_PI;
+                    for (int32 i = 0; i < Iterations; ++i)
+                    {
+                        const double Mid = .5 * (Lo + Hi);
+                        if (Blocked(Mid))
+                        {
+                            Lo = Mid;
+                        }
+                        else
+                        {
+                            Hi = Mid;
+                        }
+                    }
+                    Elevations[a] = float(.5 * (Lo + Hi));
+                }
+            }
+        }, NumTexels <= BakeChunkSize);
+
+        return true;
+    }
+
+
+    SPICE_API bool HorizonVisibility(const FDskTerrainTile& Tile, const FDskHorizonMap& Map, const FSDistanceVector& Source, double AngularRadius, TArrayView<float> Visibility)
+    {
+        const int32 NumTexels = Tile.Size * Tile.Size;
+        if (Map.Size != Tile.Size || Map.NumAzimuths <= 0 || Map.Elevations.Num() != NumTexels * Map.NumAzimuths
+            || Tile.Radii.Num() != NumTexels || Visibility.Num() < NumTexels)
+        {
+            return false;
+        }
+
+        double s[3];
+        Source.CopyTo(s);
+
+        ParallelFor((NumTexels + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, NumTexels);
+            for (int32 k = Chunk * ChunkSize; k < End; ++k)
+            {
+                double u[3], e[3], n[3];
+                LocalFrame(Tile.Key, Tile.Size, k, u, e, n);
+
+                const double r = Tile.Radii[k];
+                const double d[3] = { s[0] - r * u[0], s[1] - r * u[1], s[2] - r * u[2] };
+                const double Up = d[0] * u[0] + d[1] * u[1] + d[2] * u[2];
+                const double Horizontal = FMath::Sqrt(FMath::Max(d[0] * d[0] + d[1] * d[1] + d[2] * d[2] - Up * Up, 0.));
+
+                const double Elevation = atan2(Up, Horizontal);
+                const double Azimuth = atan2(d[0] * e[0] + d[1] * e[1] + d[2] * e[2], d[0] * n[0] + d[1] * n[1] + d[2] * n[2]);
+                const double Horizon = Map.Elevation(k, Azimuth);
+
+                if (AngularRadius > 0.)
+                {
+                    Visibility[k] = float(FMath::Clamp((Elevation - Horizon) / (2. * AngularRadius) + .5, 0., 1.));
+                }
+                else
+                {
+                    Visibility[k] = Elevation >= Horizon ? 1.f : 0.f;
+                }
+            }
+        }, NumTexels <= ChunkSize);
+
+        return true;
+    }
+
+
+    SPICE_API UTexture2D* CreateHorizonTexture(const FDskHorizonMap& Map)
+    {
+        check(IsInGameThread());
+
+        const int32 NumTexels = Map.Size * Map.Size;
+        if (Map.Size < 2 || Map.NumAzimuths <= 0 || Map.NumAzimuths % 4 != 0 || Map.Elevations.Num() != NumTexels * Map.NumAzimuths)
+        {
+            return nullptr;
+        }
+
+        const int32 Pages = Map.NumAzimuths / 4;
+        UTexture2D* Texture = UTexture2D::CreateTransient(Map.Size, Map.Size * Pages, PF_A32B32G32R32F);
+        if (!Texture)
+        {
+            return nullptr;
+        }
+        Texture->SRGB = false;
+        Texture->Filter = TF_Nearest;
+        Texture->AddressX = TA_Clamp;
+        Texture->AddressY = TA_Clamp;
+        Texture->CompressionSettings = TC_HDR;
+
+        FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+        FLinearColor* Texels = static_cast<FLinearColor*>(Mip.BulkData.Lock(LOCK_READ_WRITE));
+        for (int32 Page = 0; Page < Pages; ++Page)
+        {
+            for (int32 k = 0; k < NumTexels; ++k)
+            {
+                const float* e = &Map.Elevations[k * Map.NumAzimuths + 4 * Page];
+                Texels[Page * NumTexels + k] = FLinearColor(e[0], e[1], e[2], e[3]);
+            }
+        }
+        Mip.BulkData.Unlock();
+
+        Texture->UpdateResource();
+        return Texture;
+    }
+}
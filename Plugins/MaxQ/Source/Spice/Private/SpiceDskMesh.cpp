@@ -0,0 +1,569 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskMesh.cpp
+//
+// Implementation Comments
+//
+// Purpose:  DSK shape models as UE static meshes, with generated LODs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskMesh.cpp is part of the "refined C++ API".
+//
+// Swizzle mirrors (it swaps x and y), so a plate keeps its vertex order:  a
+// plate wound outward in SPICE's right handed frame is wound outward in UE's
+// left handed one (as UE's FBX import does it).
+//
+// LODs are vertex clustered:  LOD 0's vertices are snapped to a grid, each
+// cell's vertices merge to their mean, and plates that collapse (two
+// corners in one cell) or duplicate another are dropped.  The cell size is
+// picked from the surface area for the LOD's triangle budget, and corrected
+// once if the budget is missed badly.  It's not as pretty as edge collapse,
+// but it's linear (besides a sort) and a multi-million plate model reduces
+// in well under a second.
+//------------------------------------------------------------------------------
+
+#include "SpiceDskMesh.h"
+#include "SpiceUtilities.h"
+#include "SpiceExecutor.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "StaticMeshAttributes.h"
+#include "MeshDescription.h"
+#include "Materials/MaterialInterface.h"
+#include <algorithm>
+
+#if WITH_EDITOR
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "Misc/PackageName.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#endif
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr int32 VerticesPerTask = 16384;
+    constexpr int32 CellBits = 21;
+    constexpr int64 MaxCell = (int64(1) << CellBits) - 1;
+    const FName SlotName(TEXT("Surface"));
+
+    // Area weighted, from FirstIndex's triangle on, for FirstVertex's
+    // vertices on.  UE's triangle normal is (P2 - P0) ^ (P1 - P0).
+    void ComputeNormals(MaxQ::Dsk::FDskMeshLOD& LOD, int32 FirstVertex, int32 FirstIndex)
+    {
+        const int32 NumVertices = LOD.Positions.Num();
+
+        TArray<FVector3d> Sums;
+        Sums.SetNumZeroed(NumVertices - FirstVertex);
+
+        for (int32 i = FirstIndex; i + 2 < LOD.Indices.Num(); i += 3)
+        {
+            const uint32 i0 = LOD.Indices[i], i1 = LOD.Indices[i + 1], i2 = LOD.Indices[i + 2];
+            const FVector3d p0(LOD.Positions[i0]);
+            const FVector3d Normal = (FVector3d(LOD.Positions[i2]) - p0) ^ (FVector3d(LOD.Positions[i1]) - p0);
+            Sums[i0 - FirstVertex] += Normal;
+            Sums[i1 - FirstVertex] += Normal;
+            Sums[i2 - FirstVertex] += Normal;
+        }
+
+        LOD.Normals.SetNumUninitialized(NumVertices);
+        for (int32 v = FirstVertex; v < NumVertices; ++v)
+        {
+            // Unreferenced vertices point away from the origin
+            const FVector3d Fallback = FVector3d(LOD.Positions[v]).GetSafeNormal(0., FVector3d::UpVector);
+            LOD.Normals[v] = FVector3f(Sums[v - FirstVertex].GetSafeNormal(0., Fallback));
+        }
+    }
+
+    double SurfaceArea(const MaxQ::Dsk::FDskMeshLOD& LOD)
+    {
+        double Area = 0.;
+        for (int32 i = 0; i + 2 < LOD.Indices.Num(); i += 3)
+        {
+            const FVector3d p0(LOD.Positions[LOD.Indices[i]]);
+            Area += 0.5 * ((FVector3d(LOD.Positions[LOD.Indices[i + 1]]) - p0) ^ (FVector3d(LOD.Positions[LOD.Indices[i + 2]]) - p0)).Size();
+        }
+        return Area;
+    }
+
+    struct FClusterKey
+    {
+        uint64 Cell;
+        int32 Vertex;
+
+        bool operator<(const FClusterKey& Other) const { return Cell < Other.Cell; }
+    };
+
+    struct FTriangle
+    {
+        uint32 i[3];
+
+        bool operator<(const FTriangle& Other) const
+        {
+            return i[0] != Other.i[0] ? i[0] < Other.i[0] : i[1] != Other.i[1] ? i[1] < Other.i[1] : i[2] < Other.i[2];
+        }
+        bool operator==(const FTriangle& Other) const
+        {
+            return i[0] == Other.i[0] && i[1] == Other.i[1] && i[2] == Other.i[2];
+        }
+    };
+
+    void Cluster(const MaxQ::Dsk::FDskMeshLOD& Source, const FVector3d& Min, double CellSize, MaxQ::Dsk::FDskMeshLOD& Out)
+    {
+        const int32 NumVertices = Source.Positions.Num();
+
+        TArray<FClusterKey> Keys;
+        Keys.SetNumUninitialized(NumVertices);
+        const int32 NumTasks = FMath::DivideAndRoundUp(NumVertices, VerticesPerTask);
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 End = FMath::Min(NumVertices, (Task + 1) * VerticesPerTask);
+            for (int32 v = Task * VerticesPerTask; v < End; ++v)
+            {
+                const FVector3d Cell = (FVector3d(Source.Positions[v]) - Min) / CellSize;
+                const uint64 x = (uint64)FMath::Clamp<int64>(FMath::FloorToInt64(Cell.X), 0, MaxCell);
+                const uint64 y = (uint64)FMath::Clamp<int64>(FMath::FloorToInt64(Cell.Y), 0, MaxCell);
+                const uint64 z = (uint64)FMath::Clamp<int64>(FMath::FloorToInt64(Cell.Z), 0, MaxCell);
+                Keys[v] = { (x << (2 * CellBits)) | (y << CellBits) | z, v };
+            }
+        });
+        std::sort(Keys.GetData(), Keys.GetData() + Keys.Num());
+
+        // Every cell's mean
+        TArray<uint32> Remap;
+        Remap.SetNumUninitialized(NumVertices);
+        TArray<FVector3d> Sums;
+        TArray<int32> Counts;
+        for (int32 k = 0; k < Keys.Num(); ++k)
+        {
+            if (k == 0 || Keys[k].Cell != Keys[k - 1].Cell)
+            {
+                Sums.Add(FVector3d::ZeroVector);
+                Counts.Add(0);
+            }
+            Remap[Keys[k].Vertex] = Sums.Num() - 1;
+            Sums.Last() += FVector3d(Source.Positions[Keys[k].Vertex]);
+            ++Counts.Last();
+        }
+
+        TArray<FTriangle> Triangles;
+        Triangles.Reserve(Source.NumTriangles());
+        for (int32 i = 0; i + 2 < Source.Indices.Num(); i += 3)
+        {
+            FTriangle Triangle { { Remap[Source.Indices[i]], Remap[Source.Indices[i + 1]], Remap[Source.Indices[i + 2]] } };
+            if (Triangle.i[0] == Triangle.i[1] || Triangle.i[1] == Triangle.i[2] || Triangle.i[2] == Triangle.i[0])
+            {
+                continue;
+            }
+            // Smallest first, keeping the winding
+            while (Triangle.i[0] > Triangle.i[1] || Triangle.i[0] > Triangle.i[2])
+            {
+                Triangle = { { Triangle.i[1], Triangle.i[2], Triangle.i[0] } };
+            }
+            Triangles.Add(Triangle);
+        }
+        std::sort(Triangles.GetData(), Triangles.GetData() + Triangles.Num());
+        const int32 NumTriangles = int32(std::unique(Triangles.GetData(), Triangles.GetData() + Triangles.Num()) - Triangles.GetData());
+
+        // Only the cells a triangle still uses
+        TArray<uint32> Compact;
+        Compact.Init(MAX_uint32, Sums.Num());
+        Out.Positions.Reset();
+        Out.Indices.SetNumUninitialized(3 * NumTriangles);
+        for (int32 t = 0; t < NumTriangles; ++t)
+        {
+            for (int32 c = 0; c < 3; ++c)
+            {
+                const uint32 Index = Triangles[t].i[c];
+                if (Compact[Index] == MAX_uint32)
+                {
+                    Compact[Index] = Out.Positions.Add(FVector3f(Sums[Index] / Counts[Index]));
+                }
+                Out.Indices[3 * t + c] = Compact[Index];
+            }
+        }
+
+        ComputeNormals(Out, 0, 0);
+    }
+
+    void FillMeshDescription(FMeshDescription& Description, const MaxQ::Dsk::FDskMeshLOD& LOD)
+    {
+        FStaticMeshAttributes Attributes(Description);
+        Attributes.Register();
+
+        const int32 NumVertices = LOD.Positions.Num();
+        const int32 NumTriangles = LOD.NumTriangles();
+
+        Description.ReserveNewVertices(NumVertices);
+        Description.ReserveNewVertexInstances(NumVertices);
+        Description.ReserveNewTriangles(NumTriangles);
+        Description.ReserveNewPolygons(NumTriangles);
+        Description.ReserveNewEdges(NumTriangles * 3 / 2);
+
+        const FPolygonGroupID Group = Description.CreatePolygonGroup();
+        Attributes.GetPolygonGroupMaterialSlotNames()[Group] = SlotName;
+
+        TVertexAttributesRef<FVector3f> Positions = Attributes.GetVertexPositions();
+        TVertexInstanceAttributesRef<FVector3f> Normals = Attributes.GetVertexInstanceNormals();
+        TVertexInstanceAttributesRef<FVector3f> Tangents = Attributes.GetVertexInstanceTangents();
+        TVertexInstanceAttributesRef<float> BinormalSigns = Attributes.GetVertexInstanceBinormalSigns();
+
+        // One instance per vertex (the normals are shared), so the IDs match
+        // the vertex indices.
+        for (int32 v = 0; v < NumVertices; ++v)
+        {
+            const FVertexID Vertex = Description.CreateVertex();
+            Positions[Vertex] = LOD.Positions[v];
+
+            const FVertexInstanceID Instance = Description.CreateVertexInstance(Vertex);
+            const FVector3f& Normal = LOD.Normals[v];
+            const FVector3f Axis = FMath::Abs(Normal.Z) < 0.9f ? FVector3f::UpVector : FVector3f::ForwardVector;
+            Normals[Instance] = Normal;
+            Tangents[Instance] = (Axis ^ Normal).GetSafeNormal();
+            BinormalSigns[Instance] = 1.f;
+        }
+
+        for (int32 t = 0; t < NumTriangles; ++t)
+        {
+            const FVertexInstanceID Corners[3] = {
+                FVertexInstanceID(int32(LOD.Indices[3 * t])),
+                FVertexInstanceID(int32(LOD.Indices[3 * t + 1])),
+                FVertexInstanceID(int32(LOD.Indices[3 * t + 2]))
+            };
+            Description.CreateTriangle(Group, Corners);
+        }
+    }
+
+    bool ReadSegments(MaxQ::Dsk::FDskMesh& Mesh, SpiceInt _handle, int Body, TArrayView<const int32> Surfaces)
+    {
+        return ReadDskType2Segments(_handle, Body, Surfaces, [&](const SpiceDSKDescr& _dskdsc, TArray<double>& Vertices, TArray<int32>& Plates)
+        {
+            FString Error;
+            if (!Mesh.AddSegment(Vertices, Plates, _dskdsc.frmcde, nullptr, &Error))
+            {
+                setmsg_c("#");
+                errch_c("#", StringCast<ANSICHAR>(*Error).Get());
+                sigerr_c("SPICE(BADDSKSEGMENT)");
+                return false;
+            }
+            return true;
+        });
+    }
+}
+
+
+namespace MaxQ::Dsk
+{
+    bool FDskMesh::AddSegment(TArrayView<const double> Vertices, TArrayView<const int32> Plates, int32 Frame, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        auto Fail = [&](const FString& Message)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = Message;
+            return false;
+        };
+
+        if (LODs.Num() > 0 && Frame != FrameCode)
+        {
+            return Fail(FString::Printf(TEXT("FDskMesh::AddSegment: frame %d, but the mesh is in %d"), Frame, FrameCode));
+        }
+        if (Vertices.Num() % 3 != 0 || Plates.Num() % 3 != 0)
+        {
+            return Fail(TEXT("FDskMesh::AddSegment: vertices and plates come in threes"));
+        }
+
+        const int32 NumVertices = Vertices.Num() / 3;
+        for (int32 Index : Plates)
+        {
+            if (Index < 1 || Index > NumVertices)
+            {
+                return Fail(FString::Printf(TEXT("FDskMesh::AddSegment: vertex %d is outside [1, %d]"), Index, NumVertices));
+            }
+        }
+
+        // Generated LODs would be stale
+        LODs.SetNum(1);
+        FrameCode = Frame;
+
+        FDskMeshLOD& LOD = LODs[0];
+        const int32 FirstVertex = LOD.Positions.Num();
+        const int32 FirstIndex = LOD.Indices.Num();
+
+        LOD.Positions.SetNumUninitialized(FirstVertex + NumVertices);
+        const double Scale = Settings.Scale;
+        for (int32 v = 0; v < NumVertices; ++v)
+        {
+            // Swizzle
+            LOD.Positions[FirstVertex + v] = FVector3f(float(Vertices[3 * v + 1] * Scale), float(Vertices[3 * v] * Scale), float(Vertices[3 * v + 2] * Scale));
+        }
+
+        LOD.Indices.SetNumUninitialized(FirstIndex + Plates.Num());
+        for (int32 i = 0; i < Plates.Num(); ++i)
+        {
+            LOD.Indices[FirstIndex + i] = uint32(FirstVertex + Plates[i] - 1);
+        }
+
+        ComputeNormals(LOD, FirstVertex, FirstIndex);
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FDskMesh::AddFile(const FString& relativePath, int Body, TArrayView<const int32> Surfaces, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        SpiceInt _handle = 0;
+        dasopr_c(StringCast<ANSICHAR>(*toPath(relativePath)).Get(), &_handle);
+        if (!failed_c())
+        {
+            ReadSegments(*this, _handle, Body, Surfaces);
+            CloseDas(_handle);
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    bool FDskMesh::AddLoaded(int Body, TArrayView<const int32> Surfaces, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        TArray<SpiceInt> Handles;
+        LoadedDskHandles(Handles);
+
+        for (int32 i = 0; i < Handles.Num() && !failed_c(); ++i)
+        {
+            ReadSegments(*this, Handles[i], Body, Surfaces);
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    void FDskMesh::GenerateLODs()
+    {
+        if (LODs.Num() == 0)
+        {
+            return;
+        }
+        LODs.SetNum(1);
+
+        const FDskMeshLOD& Source = LODs[0];
+        const int32 NumLODs = FMath::Clamp(Settings.NumLODs, 1, MAX_STATIC_MESH_LODS);
+        const double Area = SurfaceArea(Source);
+        if (!(Area > 0.))
+        {
+            return;
+        }
+
+        FVector3d Min(TNumericLimits<double>::Max()), Max(TNumericLimits<double>::Lowest());
+        for (const FVector3f& Position : Source.Positions)
+        {
+            Min = Min.ComponentMin(FVector3d(Position));
+            Max = Max.ComponentMax(FVector3d(Position));
+        }
+        const double MinCellSize = (Max - Min).GetMax() / double(MaxCell - 1);
+
+        double Target = Source.NumTriangles();
+        for (int32 Level = 1; Level < NumLODs; ++Level)
+        {
+            Target *= Settings.Reduction;
+            if (Target < 4.)
+            {
+                break;
+            }
+
+            // A closed surface clustered into cells of size h keeps about
+            // 2 * Area / h^2 triangles.
+            double CellSize = FMath::Max(MinCellSize, FMath::Sqrt(2. * Area / Target));
+
+            FDskMeshLOD LOD;
+            Cluster(Source, Min, CellSize, LOD);
+            const double Ratio = LOD.NumTriangles() / Target;
+            if (Ratio > 1.5 || Ratio < 0.5)
+            {
+                CellSize = FMath::Max(MinCellSize, CellSize * FMath::Sqrt(Ratio));
+                Cluster(Source, Min, CellSize, LOD);
+            }
+
+            if (LOD.NumTriangles() == 0 || LOD.NumTriangles() >= LODs.Last().NumTriangles())
+            {
+                break;
+            }
+            LODs.Add(MoveTemp(LOD));
+        }
+    }
+
+
+    UStaticMesh* FDskMesh::CreateStaticMesh(UObject* Outer, FName Name, UMaterialInterface* Material, EObjectFlags Flags) const
+    {
+        return Build(Outer, Name, Material, Flags, false);
+    }
+
+
+    UStaticMesh* FDskMesh::Build(UObject* Outer, FName Name, UMaterialInterface* Material, EObjectFlags Flags, bool bCommitMeshDescription) const
+    {
+        check(IsInGameThread());
+
+        if (LODs.Num() == 0 || LODs[0].NumTriangles() == 0)
+        {
+            return nullptr;
+        }
+
+        const int32 NumLODs = FMath::Min(LODs.Num(), MAX_STATIC_MESH_LODS);
+
+        TArray<FMeshDescription> Descriptions;
+        Descriptions.SetNum(NumLODs);
+        ParallelFor(NumLODs, [&](int32 Level)
+        {
+            FillMeshDescription(Descriptions[Level], LODs[Level]);
+        });
+
+        TArray<const FMeshDescription*> DescriptionPointers;
+        for (const FMeshDescription& Description : Descriptions)
+        {
+            DescriptionPointers.Add(&Description);
+        }
+
+        UStaticMesh* StaticMesh = NewObject<UStaticMesh>(Outer ? Outer : GetTransientPackage(), Name, Flags);
+        StaticMesh->GetStaticMaterials().Add(FStaticMaterial(Material, SlotName, SlotName));
+
+        UStaticMesh::FBuildMeshDescriptionsParams Params;
+        Params.bBuildSimpleCollision = false;
+        Params.bCommitMeshDescription = bCommitMeshDescription;
+        Params.bMarkPackageDirty = bCommitMeshDescription;
+        StaticMesh->BuildFromMeshDescriptions(DescriptionPointers, Params);
+
+        float ScreenSize = 1.f;
+        for (int32 Level = 0; Level < NumLODs; ++Level)
+        {
+            if (Level == 1) ScreenSize = Settings.LOD1ScreenSize;
+            else if (Level > 1) ScreenSize *= FMath::Sqrt(float(Settings.Reduction));
+
+            if (FStaticMeshRenderData* RenderData = StaticMesh->GetRenderData())
+            {
+                RenderData->ScreenSize[Level].Default = ScreenSize;
+            }
+#if WITH_EDITOR
+            if (Level < StaticMesh->GetNumSourceModels())
+            {
+                StaticMesh->GetSourceModel(Level).ScreenSize.Default = ScreenSize;
+            }
+#endif
+        }
+#if WITH_EDITOR
+        StaticMesh->bAutoComputeLODScreenSize = false;
+#endif
+
+        return StaticMesh;
+    }
+
+
+#if WITH_EDITOR
+    UStaticMesh* FDskMesh::CreateStaticMeshAsset(const FString& PackageName, UMaterialInterface* Material, ES_ResultCode* ResultCode, FString* ErrorMessage) const
+    {
+        auto Fail = [&](const FString& Message) -> UStaticMesh*
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = Message;
+            return nullptr;
+        };
+
+        FText Reason;
+        if (!FPackageName::IsValidLongPackageName(PackageName, false, &Reason))
+        {
+            return Fail(FString::Printf(TEXT("FDskMesh::CreateStaticMeshAsset: %s"), *Reason.ToString()));
+        }
+
+        UPackage* Package = CreatePackage(*PackageName);
+        UStaticMesh* StaticMesh = Build(Package, FName(*FPackageName::GetShortName(PackageName)), Material, RF_Public | RF_Standalone, true);
+        if (!StaticMesh)
+        {
+            return Fail(TEXT("FDskMesh::CreateStaticMeshAsset: the mesh is empty"));
+        }
+        FAssetRegistryModule::AssetCreated(StaticMesh);
+
+        const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+        FSavePackageArgs SaveArgs;
+        SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+        SaveArgs.SaveFlags = SAVE_NoError;
+        if (!UPackage::SavePackage(Package, StaticMesh, *Filename, SaveArgs))
+        {
+            return Fail(FString::Printf(TEXT("FDskMesh::CreateStaticMeshAsset: couldn't save %s"), *Filename));
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return StaticMesh;
+    }
+#endif
+
+
+    void FDskMesh::Reset()
+    {
+        LODs.Empty();
+        FrameCode = 0;
+    }
+
+
+    SIZE_T FDskMesh::GetAllocatedSize() const
+    {
+        SIZE_T Size = LODs.GetAllocatedSize();
+        for (const FDskMeshLOD& LOD : LODs)
+        {
+            Size += LOD.Positions.GetAllocatedSize() + LOD.Normals.GetAllocatedSize() + LOD.Indices.GetAllocatedSize();
+        }
+        return Size;
+    }
+
+
+    SPICE_API TFuture<FDskMeshAsyncResult> LoadDskMeshAsync(const FString& relativePath, int Body, const FDskMeshSettings& Settings, const TArray<int32>& Surfaces)
+    {
+        TSharedRef<TPromise<FDskMeshAsyncResult>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<FDskMeshAsyncResult>, ESPMode::ThreadSafe>();
+        TFuture<FDskMeshAsyncResult> Future = Promise->GetFuture();
+
+        FSpiceExecutor::Get().EnqueueCommand(
+            [Promise, relativePath, Body, Settings, Surfaces]()
+            {
+                FDskMeshAsyncResult Result;
+                Result.Mesh = MakeShared<FDskMesh, ESPMode::ThreadSafe>(Settings);
+                if (!Result.Mesh->AddFile(relativePath, Body, Surfaces, &Result.ResultCode, &Result.ErrorMessage))
+                {
+                    Result.Mesh.Reset();
+                    Promise->SetValue(MoveTemp(Result));
+                    return;
+                }
+
+                // Off the executor, so other SPICE work isn't held up
+                Async(EAsyncExecution::ThreadPool, [Promise, Result = MoveTemp(Result)]() mutable
+                {
+                    Result.Mesh->GenerateLODs();
+                    Promise->SetValue(MoveTemp(Result));
+                });
+            });
+
+        return Future;
+    }
+}
@@ -0,0 +1,344 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskTerrain.cpp
+//
+// Implementation Comments
+//
+// Purpose:  DSK shape models baked into tiled height and normal maps, at
+// levels of detail streamed around a camera.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskTerrain.cpp is part of the "refined C++ API".
+//
+// A tile's rays start at twice the model's bounding radius, so the nearest
+// hit FDskShapeModel finds is the outermost surface along the ray, which is
+// latsrf's.  Normals are the hit plates' (as srfnrm's are, for DSKs).
+//
+// A bake holds a reference to the model, so dropping the terrain with bakes
+// running is safe.  The destructor waits for them all the same, rather than
+// leave the thread pool busy with tiles nobody will collect.
+//------------------------------------------------------------------------------
+
+#include "SpiceDskTerrain.h"
+#include "Async/Async.h"
+#include "Engine/Texture2D.h"
+
+namespace MaxQ::Dsk
+{
+    double FDskTerrainTileKey::West() const
+    {
+        return -PI + X * Span();
+    }
+
+
+    double FDskTerrainTileKey::North() const
+    {
+        return HALF_PI - Y * Span();
+    }
+
+
+    double FDskTerrainTileKey::Span() const
+    {
+        return PI / double(1 << Level);
+    }
+
+
+    SPICE_API bool BakeTerrainTile(const FDskShapeModel& Model, const FDskTerrainTileKey& Key, int32 Size, FDskTerrainTile& Tile)
+    {
+        if (Size < 2 || Model.NumPlates() == 0)
+        {
+            return false;
+        }
+
+        const int32 NumTexels = Size * Size;
+        const double Far = 2. * Model.BoundingRadius() + 1.;
+        const double Step = Key.Span() / (Size - 1);
+
+        TArray<FSRay> Rays;
+        Rays.SetNum(NumTexels);
+        for (int32 j = 0; j < Size; ++j)
+        {
+            const double Lat = Key.North() - Step * j;
+            for (int32 i = 0; i < Size; ++i)
+            {
+                const double Lon = Key.West() + Step * i;
+                const double d[3] = { cos(Lat) * cos(Lon), cos(Lat) * sin(Lon), sin(Lat) };
+
+                FSRay& Ray = Rays[j * Size + i];
+                Ray.point = FSDistanceVector(Far * d[0], Far * d[1], Far * d[2]);
+                Ray.direction = FSDimensionlessVector(-d[0], -d[1], -d[2]);
+            }
+        }
+
+        TArray<FDskHit> Hits;
+        Model.Intersect(Rays, Hits);
+
+        Tile.Key = Key;
+        Tile.Size = Size;
+        Tile.Radii.SetNumUninitialized(NumTexels);
+        Tile.Normals.SetNumUninitialized(NumTexels);
+        Tile.MinRadius = FLT_MAX;
+        Tile.MaxRadius = 0.f;
+        Tile.Misses = 0;
+
+        for (int32 k = 0; k < NumTexels; ++k)
+        {
+            const FDskHit& Hit = Hits[k];
+            if (!Hit.bFound)
+            {
+                double d[3];
+                Rays[k].direction.CopyTo(d);
+                Tile.Radii[k] = 0.f;
+                Tile.Normals[k] = FVector3f(float(-d[0]), float(-d[1]), float(-d[2]));
+                ++Tile.Misses;
+                continue;
+            }
+
+            double p[3], n[3];
+            Hit.Point.CopyTo(p);
+            Hit.Normal.CopyTo(n);
+            const float Radius = float(FMath::Sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]));
+            Tile.Radii[k] = Radius;
+            Tile.Normals[k] = FVector3f(float(n[0]), float(n[1]), float(n[2]));
+            Tile.MinRadius = FMath::Min(Tile.MinRadius, Radius);
+            Tile.MaxRadius = FMath::Max(Tile.MaxRadius, Radius);
+        }
+
+        if (Tile.Misses == NumTexels)
+        {
+            Tile.MinRadius = 0.f;
+        }
+        return true;
+    }
+
+
+    FDskTerrain::FDskTerrain(TSharedRef<const FDskShapeModel, ESPMode::ThreadSafe> _Model, const FDskTerrainSettings& _Settings)
+        : Model(_Model)
+        , Settings(_Settings)
+    {
+        Settings.TileSize = FMath::Max(Settings.TileSize, 2);
+        Settings.MaxLevel = FMath::Clamp(Settings.MaxLevel, 0, 20);
+        Settings.MaxBakes = FMath::Max(Settings.MaxBakes, 1);
+        Radius = Settings.Radius > 0. ? Settings.Radius : Model->BoundingRadius();
+    }
+
+
+    FDskTerrain::~FDskTerrain()
+    {
+        for (TPair<FDskTerrainTileKey, TFuture<FTilePtr>>& Bake : Bakes)
+        {
+            Bake.Value.Wait();
+        }
+    }
+
+
+    void FDskTerrain::Select(const double(&Camera)[3], const FDskTerrainTileKey& Key, TArray<FDskTerrainTileKey>& Leaves) const
+    {
+        if (Key.Level < Settings.MaxLevel)
+        {
+            const double Lon = Key.West() + .5 * Key.Span();
+            const double Lat = Key.North() - .5 * Key.Span();
+            const double Center[3] = { Radius * cos(Lat) * cos(Lon), Radius * cos(Lat) * sin(Lon), Radius * sin(Lat) };
+            const double Distance = FMath::Sqrt(FMath::Square(Camera[0] - Center[0]) + FMath::Square(Camera[1] - Center[1]) + FMath::Square(Camera[2] - Center[2]));
+
+            if (Distance < Settings.SplitDistance * Radius * Key.Span())
+            {
+                for (int32 dy = 0; dy < 2; ++dy)
+                {
+                    for (int32 dx = 0; dx < 2; ++dx)
+                    {
+                        Select(Camera, { Key.Level + 1, 2 * Key.X + dx, 2 * Key.Y + dy }, Leaves);
+                    }
+                }
+                return;
+            }
+        }
+        Leaves.Add(Key);
+    }
+
+
+    void FDskTerrain::Collect(bool bWait)
+    {
+        for (auto It = Bakes.CreateIterator(); It; ++It)
+        {
+            if (bWait || It.Value().IsReady())
+            {
+                // A failed bake is kept (as null), so it isn't retried
+                FEntry& Entry = Tiles.Add(It.Key());
+                Entry.Tile = It.Value().Get();
+                Entry.LastWanted = Updates;
+                It.RemoveCurrent();
+            }
+        }
+    }
+
+
+    void FDskTerrain::Update(const FSDistanceVector& Camera)
+    {
+        Collect(false);
+        ++Updates;
+
+        double c[3];
+        Camera.CopyTo(c);
+
+        Wanted.Reset();
+        Select(c, { 0, 0, 0 }, Wanted);
+        Select(c, { 0, 1, 0 }, Wanted);
+        Wanted.StableSort([](const FDskTerrainTileKey& A, const FDskTerrainTileKey& B) { return A.Level < B.Level; });
+
+        // The leaves and their ancestors (which stand in for them)
+        TSet<FDskTerrainTileKey> Missing;
+        for (const FDskTerrainTileKey& Leaf : Wanted)
+        {
+            for (FDskTerrainTileKey Key = Leaf; Key.Level >= 0; Key = Key.Parent())
+            {
+                if (FEntry* Entry = Tiles.Find(Key))
+                {
+                    Entry->LastWanted = Updates;
+                }
+                else if (!Bakes.Contains(Key))
+                {
+                    Missing.Add(Key);
+                }
+            }
+        }
+
+        TArray<FDskTerrainTileKey> ToBake = Missing.Array();
+        ToBake.StableSort([](const FDskTerrainTileKey& A, const FDskTerrainTileKey& B) { return A.Level < B.Level; });
+
+        const int32 TileSize = Settings.TileSize;
+        const bool bHorizons = Settings.bHorizons;
+        const FDskHorizonSettings HorizonSettings = Settings.HorizonSettings;
+        for (int32 i = 0; i < ToBake.Num() && Bakes.Num() < Settings.MaxBakes; ++i)
+        {
+            const FDskTerrainTileKey Key = ToBake[i];
+            TSharedRef<const FDskShapeModel, ESPMode::ThreadSafe> BakeModel = Model;
+            Bakes.Add(Key, Async(EAsyncExecution::ThreadPool, [BakeModel, Key, TileSize, bHorizons, HorizonSettings]() -> FTilePtr
+            {
+                TSharedPtr<FDskTerrainTile, ESPMode::ThreadSafe> Tile = MakeShared<FDskTerrainTile, ESPMode::ThreadSafe>();
+                if (!BakeTerrainTile(*BakeModel, Key, TileSize, *Tile))
+                {
+                    return nullptr;
+                }
+                if (bHorizons)
+                {
+                    BakeHorizonMap(*BakeModel, *Tile, HorizonSettings, Tile->Horizon);
+                }
+                return Tile;
+            }));
+        }
+
+        // The least recently wanted go first
+        if (Tiles.Num() > Settings.MaxTiles)
+        {
+            TArray<TPair<uint64, FDskTerrainTileKey>> Unwanted;
+            for (const TPair<FDskTerrainTileKey, FEntry>& Tile : Tiles)
+            {
+                if (Tile.Value.LastWanted < Updates)
+                {
+                    Unwanted.Emplace(Tile.Value.LastWanted, Tile.Key);
+                }
+            }
+            Unwanted.Sort([](const TPair<uint64, FDskTerrainTileKey>& A, const TPair<uint64, FDskTerrainTileKey>& B) { return A.Key < B.Key; });
+
+            for (int32 i = 0; i < Unwanted.Num() && Tiles.Num() > Settings.MaxTiles; ++i)
+            {
+                Tiles.Remove(Unwanted[i].Value);
+            }
+        }
+    }
+
+
+    FDskTerrain::FTilePtr FDskTerrain::Find(const FDskTerrainTileKey& Key) const
+    {
+        const FEntry* Entry = Tiles.Find(Key);
+        return Entry ? Entry->Tile : nullptr;
+    }
+
+
+    FDskTerrain::FTilePtr FDskTerrain::FindOrAncestor(const FDskTerrainTileKey& Key) const
+    {
+        for (FDskTerrainTileKey Ancestor = Key; Ancestor.Level >= 0; Ancestor = Ancestor.Parent())
+        {
+            if (FTilePtr Tile = Find(Ancestor))
+            {
+                return Tile;
+            }
+        }
+        return nullptr;
+    }
+
+
+    void FDskTerrain::Flush()
+    {
+        Collect(true);
+    }
+
+
+    SPICE_API bool CreateTerrainTextures(const FDskTerrainTile& Tile, UTexture2D*& Heights, UTexture2D*& Normals)
+    {
+        check(IsInGameThread());
+
+        Heights = nullptr;
+        Normals = nullptr;
+
+        const int32 NumTexels = Tile.Size * Tile.Size;
+        if (Tile.Size < 2 || Tile.Radii.Num() != NumTexels || Tile.Normals.Num() != NumTexels)
+        {
+            return false;
+        }
+
+        auto Create = [&Tile](EPixelFormat Format)
+        {
+            UTexture2D* Texture = UTexture2D::CreateTransient(Tile.Size, Tile.Size, Format);
+            if (Texture)
+            {
+                Texture->SRGB = false;
+                Texture->Filter = TF_Bilinear;
+                Texture->AddressX = TA_Clamp;
+                Texture->AddressY = TA_Clamp;
+            }
+            return Texture;
+        };
+
+        Heights = Create(PF_R32_FLOAT);
+        Normals = Create(PF_B8G8R8A8);
+        if (!Heights || !Normals)
+        {
+            Heights = Normals = nullptr;
+            return false;
+        }
+        Heights->CompressionSettings = TC_HDR;
+        Normals->CompressionSettings = TC_Normalmap;
+
+        FTexture2DMipMap& HeightMip = Heights->GetPlatformData()->Mips[0];
+        FMemory::Memcpy(HeightMip.BulkData.Lock(LOCK_READ_WRITE), Tile.Radii.GetData(), NumTexels * sizeof(float));
+        HeightMip.BulkData.Unlock();
+
+        FTexture2DMipMap& NormalMip = Normals->GetPlatformData()->Mips[0];
+        FColor* Texels = static_cast<FColor*>(NormalMip.BulkData.Lock(LOCK_READ_WRITE));
+        auto Quantize = [](float Component) { return uint8(FMath::Clamp(FMath::RoundToInt(Component * 127.5f + 127.5f), 0, 255)); };
+        for (int32 k = 0; k < NumTexels; ++k)
+        {
+            // Swizzle
+            const FVector3f& n = Tile.Normals[k];
+            Texels[k] = FColor(Quantize(n.Y), Quantize(n.X), Quantize(n.Z), 255);
+        }
+        NormalMip.BulkData.Unlock();
+
+        Heights->UpdateResource();
+        Normals->UpdateResource();
+        return true;
+    }
+}
@@ -0,0 +1,548 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskTileCatalog.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Region-indexed, on demand loading of tiled DSK kernels.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskTileCatalog.cpp is part of the "refined C++ API".
+//
+// Descriptors come from walking each file's DLA segments (dlabfs/dlafns/
+// dskgd), without reading any plates.  A query's neighborhood is a cap on
+// the unit sphere;  a segment is near it if their latitude ranges overlap
+// and their longitude ranges do, with the cap's longitude half-width
+// asin(sin r / cos lat) (every longitude, if the cap reaches a pole).
+//
+// Loading and unloading go through MaxQ::Data::Furnsh/Unload, as
+// FKernelCatalog's do.
+//------------------------------------------------------------------------------
+
+#include "SpiceDskTileCatalog.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr uint32 CatalogMagic = 0x4C495444;  // "DTIL"
+    constexpr int32 CatalogVersion = 1;
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    bool Succeed(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+    // Whether [Min, Max] overlaps Longitude +/- HalfWidth, whichever way the
+    // segment's longitudes are expressed (-pi...pi, or 0...2pi)
+    bool LongitudesOverlap(double Min, double Max, double Longitude, double HalfWidth)
+    {
+        if (HalfWidth >= PI || Max - Min >= TWO_PI)
+        {
+            return true;
+        }
+
+        for (int32 k = -1; k <= 1; ++k)
+        {
+            const double Shifted = Longitude + k * TWO_PI;
+            if (Shifted + HalfWidth >= Min && Shifted - HalfWidth <= Max)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+namespace MaxQ::Data
+{
+    FDskTileCatalog::FDskTileCatalog(int32 _MaxLoaded)
+        : MaxLoaded(FMath::Max(_MaxLoaded, 0))
+    {
+    }
+
+    FDskTileCatalog::~FDskTileCatalog()
+    {
+        UnloadAll();
+    }
+
+
+    bool FDskTileCatalog::Add(const TArray<FString>& relativePaths, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        bool bSuccess = true;
+        for (const FString& relativePath : relativePaths)
+        {
+            const FString Path = toPath(relativePath);
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*Path);
+            if (!Stat.bIsValid)
+            {
+                bSuccess = Fail(FString::Printf(TEXT("FDskTileCatalog: could not find %s"), *Path), ResultCode, ErrorMessage);
+                continue;
+            }
+
+            const int32 Existing = FindFile(Path);
+            if (Existing != INDEX_NONE && Files[Existing].Size == Stat.FileSize && Files[Existing].Timestamp == Stat.ModificationTime)
+            {
+                continue;
+            }
+
+            FTileFile File;
+            File.Path = Path;
+            File.Size = Stat.FileSize;
+            File.Timestamp = Stat.ModificationTime;
+            if (!Scan(File, ResultCode, ErrorMessage))
+            {
+                bSuccess = false;
+                continue;
+            }
+
+            // Files keep their place, and their load state
+            if (Existing != INDEX_NONE)
+            {
+                File.bLoaded = Files[Existing].bLoaded;
+                File.LastUsed = Files[Existing].LastUsed;
+                Files[Existing] = MoveTemp(File);
+            }
+            else
+            {
+                Files.Add(MoveTemp(File));
+            }
+        }
+
+        return bSuccess && Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    bool FDskTileCatalog::Scan(FTileFile& File, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        auto _file = StringCast<ANSICHAR>(*File.Path);
+
+        SpiceChar _arch[8];
+        SpiceChar _type[8];
+        getfat_c(_file.Get(), sizeof(_arch), sizeof(_type), _arch, _type);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        if (SpiceStringCompare(_arch, "DAS") || SpiceStringCompare(_type, "DSK"))
+        {
+            return Fail(FString::Printf(TEXT("FDskTileCatalog: %s is not a DSK"), *File.Path), ResultCode, ErrorMessage);
+        }
+
+        SpiceInt _handle = 0;
+        dasopr_c(_file.Get(), &_handle);
+        if (!failed_c())
+        {
+            File.Segments.Reset();
+
+            SpiceDLADescr _dladsc;
+            SpiceBoolean _found = SPICEFALSE;
+            dlabfs_c(_handle, &_dladsc, &_found);
+            while (_found && !failed_c())
+            {
+                SpiceDSKDescr _dskdsc;
+                dskgd_c(_handle, &_dladsc, &_dskdsc);
+                if (!failed_c())
+                {
+                    File.Segments.Emplace(&_dskdsc);
+                }
+
+                SpiceDLADescr _nxtdsc;
+                dlafns_c(_handle, &_dladsc, &_nxtdsc, &_found);
+                _dladsc = _nxtdsc;
+            }
+
+            CloseDas(_handle);
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    void FDskTileCatalog::Serialize(FArchive& Ar, TArray<FTileFile>& TileFiles)
+    {
+        uint32 Magic = CatalogMagic;
+        int32 Version = CatalogVersion;
+        int32 NumFiles = TileFiles.Num();
+        Ar << Magic << Version << NumFiles;
+        if (Ar.IsLoading())
+        {
+            if (Magic != CatalogMagic || Version != CatalogVersion || NumFiles < 0)
+            {
+                Ar.SetError();
+                return;
+            }
+            TileFiles.SetNum(NumFiles);
+        }
+
+        for (FTileFile& File : TileFiles)
+        {
+            int32 NumSegments = File.Segments.Num();
+            Ar << File.Path << File.Size << File.Timestamp << NumSegments;
+            if (Ar.IsError() || NumSegments < 0)
+            {
+                Ar.SetError();
+                return;
+            }
+
+            if (Ar.IsLoading())
+            {
+                File.Segments.SetNum(NumSegments);
+            }
+
+            for (FSDSKDescr& Descr : File.Segments)
+            {
+                Ar << Descr.surfce << Descr.center << Descr.dclass << Descr.dtype << Descr.frmcde << Descr.corsys << Descr.corpar;
+                Ar << Descr.co1min << Descr.co1max << Descr.co2min << Descr.co2max << Descr.co3min << Descr.co3max;
+                Ar << Descr.start << Descr.stop;
+            }
+        }
+    }
+
+
+    bool FDskTileCatalog::Save(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage) const
+    {
+        TArray<uint8> Bytes;
+        FMemoryWriter Writer(Bytes);
+        Serialize(Writer, const_cast<TArray<FTileFile>&>(Files));
+
+        // Write, then move into place (another process may be reading it)
+        const FString Path = toPath(relativePath);
+        const FString TempPath = FString::Printf(TEXT("%s.%u.tmp"), *Path, FPlatformProcess::GetCurrentProcessId());
+        if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+        {
+            IFileManager::Get().Delete(*TempPath, false, false, true);
+            return Fail(FString::Printf(TEXT("FDskTileCatalog: could not write %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        return Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    bool FDskTileCatalog::Load(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        const FString Path = toPath(relativePath);
+        TArray<uint8> Bytes;
+        if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+        {
+            return Fail(FString::Printf(TEXT("FDskTileCatalog: could not read %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        TArray<FTileFile> Loaded;
+        FMemoryReader Reader(Bytes);
+        Serialize(Reader, Loaded);
+        if (Reader.IsError())
+        {
+            return Fail(FString::Printf(TEXT("FDskTileCatalog: %s is not a tile catalog, or is from another version"), *Path), ResultCode, ErrorMessage);
+        }
+
+        bool bSuccess = true;
+        for (int32 i = 0; i < Loaded.Num(); ++i)
+        {
+            FTileFile& File = Loaded[i];
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*File.Path);
+            if (!Stat.bIsValid)
+            {
+                UE_LOG(LogSpice, Warning, TEXT("FDskTileCatalog: %s is catalogued in %s, but no longer exists"), *File.Path, *Path);
+                Loaded.RemoveAt(i--);
+            }
+            else if (Stat.FileSize != File.Size || Stat.ModificationTime != File.Timestamp)
+            {
+                UE_LOG(LogSpice, Log, TEXT("FDskTileCatalog: %s changed since %s was saved, rescanning"), *File.Path, *Path);
+                File.Size = Stat.FileSize;
+                File.Timestamp = Stat.ModificationTime;
+                if (!Scan(File, ResultCode, ErrorMessage))
+                {
+                    bSuccess = false;
+                    Loaded.RemoveAt(i--);
+                }
+            }
+        }
+
+        // Files loaded by the catalog keep their state if they're still
+        // catalogued;  the rest can't be tracked any more
+        SyncLoaded();
+        for (const FTileFile& File : Files)
+        {
+            if (File.bLoaded)
+            {
+                FTileFile* Same = Loaded.FindByPredicate([&File](const FTileFile& Other) { return Other.Path == File.Path; });
+                if (Same)
+                {
+                    Same->bLoaded = true;
+                    Same->LastUsed = File.LastUsed;
+                }
+                else
+                {
+                    Unload(File.Path);
+                }
+            }
+        }
+
+        Files = MoveTemp(Loaded);
+        KernelGeneration = GetKernelHistoryGeneration();
+        return bSuccess && Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    bool FDskTileCatalog::Covers(const FSDSKDescr& Descr, double Longitude, double Latitude, double AngularRadius)
+    {
+        const double r = FMath::Max(AngularRadius, 0.);
+        Longitude = atan2(sin(Longitude), cos(Longitude));
+
+        double LonMin, LonMax;
+        switch (Descr.corsys)
+        {
+        case SPICE_DSK_LATSYS:
+        case SPICE_DSK_PDTSYS:
+        {
+            // Planetodetic latitudes differ from planetocentric ones by
+            // about the flattening at most
+            const double Margin = Descr.corsys == SPICE_DSK_PDTSYS && Descr.corpar.Num() > 1 ? 2. * fabs(Descr.corpar[1]) : 0.;
+            if (Latitude + r + Margin < Descr.co2min || Latitude - r - Margin > Descr.co2max)
+            {
+                return false;
+            }
+            LonMin = Descr.co1min;
+            LonMax = Descr.co1max;
+            break;
+        }
+        case SPICE_DSK_CYLSYS:
+            LonMin = Descr.co2min;
+            LonMax = Descr.co2max;
+            break;
+        default:
+            return true;
+        }
+
+        const double c = cos(Latitude);
+        const double s = sin(FMath::Min(r, HALF_PI));
+        const double HalfWidth = r >= HALF_PI || s >= c ? PI : asin(s / c);
+        return LongitudesOverlap(LonMin, LonMax, Longitude, HalfWidth);
+    }
+
+
+    void FDskTileCatalog::FindFiles(int Body, double Longitude, double Latitude, double AngularRadius, TArray<int32>& Found) const
+    {
+        Found.Reset();
+        for (int32 i = 0; i < Files.Num(); ++i)
+        {
+            for (const FSDSKDescr& Descr : Files[i].Segments)
+            {
+                if ((Body == 0 || Descr.center == Body) && Covers(Descr, Longitude, Latitude, AngularRadius))
+                {
+                    Found.Add(i);
+                    break;
+                }
+            }
+        }
+    }
+
+
+    bool FDskTileCatalog::EnsureAround(int Body, const FSDistanceVector& Position, double AngularRadius, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        return EnsurePoints(Body, MakeArrayView(&Position, 1), AngularRadius, ResultCode, ErrorMessage);
+    }
+
+
+    bool FDskTileCatalog::EnsurePoints(int Body, TArrayView<const FSDistanceVector> Points, double AngularRadius, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        TArray<int32> Needed;
+        TArray<int32> Found;
+        for (const FSDistanceVector& Point : Points)
+        {
+            double p[3];
+            Point.CopyTo(p);
+            const double Horizontal = FMath::Sqrt(p[0] * p[0] + p[1] * p[1]);
+
+            // The body's center has no direction
+            if (Horizontal == 0. && p[2] == 0.)
+            {
+                continue;
+            }
+
+            FindFiles(Body, atan2(p[1], p[0]), atan2(p[2], Horizontal), AngularRadius, Found);
+            for (int32 File : Found)
+            {
+                Needed.AddUnique(File);
+            }
+        }
+
+        if (Needed.Num() > 0 && !EnsureFiles(Needed, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        return Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    bool FDskTileCatalog::EnsureFiles(TArrayView<const int32> Needed, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        SyncLoaded();
+
+        bool bLoadedAny = false;
+        for (int32 i : Needed)
+        {
+            FTileFile& File = Files[i];
+            File.LastUsed = ++UseCount;
+
+            if (!File.bLoaded)
+            {
+                if (!Furnsh(File.Path, ResultCode, ErrorMessage))
+                {
+                    return false;
+                }
+                File.bLoaded = true;
+                bLoadedAny = true;
+            }
+        }
+
+        KernelGeneration = GetKernelHistoryGeneration();
+        return !bLoadedAny || Evict(Needed, ResultCode, ErrorMessage);
+    }
+
+
+    bool FDskTileCatalog::Evict(TArrayView<const int32> Keep, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (MaxLoaded <= 0)
+        {
+            return true;
+        }
+
+        bool bSuccess = true;
+        for (int32 Loaded = NumLoaded(); Loaded > MaxLoaded && bSuccess; --Loaded)
+        {
+            int32 Coldest = INDEX_NONE;
+            for (int32 i = 0; i < Files.Num(); ++i)
+            {
+                if (Files[i].bLoaded && !Keep.Contains(i) && (Coldest == INDEX_NONE || Files[i].LastUsed < Files[Coldest].LastUsed))
+                {
+                    Coldest = i;
+                }
+            }
+
+            // Everything loaded is wanted now
+            if (Coldest == INDEX_NONE)
+            {
+                break;
+            }
+
+            Files[Coldest].bLoaded = false;
+            bSuccess = Unload(Files[Coldest].Path, ResultCode, ErrorMessage);
+        }
+
+        KernelGeneration = GetKernelHistoryGeneration();
+        return bSuccess;
+    }
+
+
+    void FDskTileCatalog::SyncLoaded()
+    {
+        const uint64 Generation = GetKernelHistoryGeneration();
+        if (Generation == KernelGeneration)
+        {
+            return;
+        }
+        KernelGeneration = Generation;
+
+        for (FTileFile& File : Files)
+        {
+            if (File.bLoaded)
+            {
+                SpiceChar _filtyp[8];
+                SpiceChar _source[8];
+                SpiceInt _handle = 0;
+                SpiceBoolean _found = SPICEFALSE;
+                kinfo_c(StringCast<ANSICHAR>(*File.Path).Get(), sizeof(_filtyp), sizeof(_source), _filtyp, _source, &_handle, &_found);
+                File.bLoaded = _found != SPICEFALSE;
+            }
+        }
+    }
+
+
+    void FDskTileCatalog::SetMaxLoaded(int32 _MaxLoaded)
+    {
+        MaxLoaded = FMath::Max(_MaxLoaded, 0);
+        SyncLoaded();
+        Evict(TArrayView<const int32>(), nullptr, nullptr);
+    }
+
+
+    int32 FDskTileCatalog::NumLoaded() const
+    {
+        int32 Count = 0;
+        for (const FTileFile& File : Files)
+        {
+            Count += File.bLoaded ? 1 : 0;
+        }
+        return Count;
+    }
+
+
+    int32 FDskTileCatalog::FindFile(const FString& relativePath) const
+    {
+        const FString Path = toPath(relativePath);
+        return Files.IndexOfByPredicate([&Path](const FTileFile& File) { return File.Path == Path; });
+    }
+
+
+    bool FDskTileCatalog::IsLoaded(const FString& relativePath) const
+    {
+        const int32 File = FindFile(relativePath);
+        return File != INDEX_NONE && Files[File].bLoaded;
+    }
+
+
+    void FDskTileCatalog::UnloadAll()
+    {
+        SyncLoaded();
+        for (FTileFile& File : Files)
+        {
+            if (File.bLoaded)
+            {
+                File.bLoaded = false;
+                Unload(File.Path);
+            }
+        }
+        KernelGeneration = GetKernelHistoryGeneration();
+    }
+}
@@ -0,0 +1,582 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskWriter.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Writes DSK type 2 segments from procedural meshes, with the
+// spatial index built across all cores.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskWriter.cpp is part of the "refined C++ API".
+//
+// dskmi2_c (zzmkspin, zzuntngl, zzvrtplt) builds its lists by prepending to
+// linked lists, plate by plate, so each voxel's and vertex's plates come out
+// largest ID first.  Here every list is counted (atomics), laid out (a
+// prefix sum, in slot order, as zzuntngl unwinds them), scattered into, and
+// sorted.  The coarse grid's pointers are handed out in the order plates
+// first touch coarse voxels, which only a pass in plate order reproduces:
+// for each plate, its coarse voxels in z, y, x order.
+//------------------------------------------------------------------------------
+
+#include "SpiceDskWriter.h"
+#include "SpiceUtilities.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include <algorithm>
+#include <functional>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr int32 PlatesPerTask = 8192;
+    constexpr int32 ListsPerTask = 16384;
+
+    // Fortran's NINT (d_nint), which rounds halves away from zero
+    double NearestInt(double x)
+    {
+        return x >= 0. ? floor(x + .5) : -floor(.5 - x);
+    }
+
+    // Counts each slot's plates.  ForEachSlot(i, Visit) visits every
+    // (0-based) slot plate i (0-based) is in, once per membership.  Returns
+    // the lists' total length (zzuntngl's:  a count and the plates, for every
+    // slot that has any).
+    template<typename ForEachSlotType>
+    int64 CountLists(int32 NumPlates, int32 NumSlots, ForEachSlotType ForEachSlot, TArray<int32>& Counts)
+    {
+        Counts.SetNumZeroed(NumSlots);
+        int32* CountData = Counts.GetData();
+
+        const int32 NumTasks = FMath::DivideAndRoundUp(NumPlates, PlatesPerTask);
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 End = FMath::Min(NumPlates, (Task + 1) * PlatesPerTask);
+            for (int32 i = Task * PlatesPerTask; i < End; ++i)
+            {
+                ForEachSlot(i, [CountData](int32 Slot) { FPlatformAtomics::InterlockedIncrement(&CountData[Slot]); });
+            }
+        });
+
+        int64 Total = 0;
+        for (int32 Count : Counts)
+        {
+            Total += Count > 0 ? Count + 1 : 0;
+        }
+        return Total;
+    }
+
+    // Pointers[s]:  the 1-based index into List of slot s's count, followed
+    // by its plates (1-based, largest first), or -1 if it has none.
+    template<typename ForEachSlotType>
+    void FillLists(int32 NumPlates, ForEachSlotType ForEachSlot, const TArray<int32>& Counts, int32* Pointers, int32* List)
+    {
+        const int32 NumSlots = Counts.Num();
+
+        // Where each slot's next plate goes
+        TArray<int32> Cursors;
+        Cursors.SetNumUninitialized(NumSlots);
+        int32 Next = 0;
+        for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+        {
+            if (Counts[Slot] > 0)
+            {
+                Pointers[Slot] = Next + 1;
+                List[Next] = Counts[Slot];
+                Cursors[Slot] = Next + 1;
+                Next += Counts[Slot] + 1;
+            }
+            else
+            {
+                Pointers[Slot] = -1;
+                Cursors[Slot] = 0;
+            }
+        }
+
+        int32* CursorData = Cursors.GetData();
+        const int32 NumTasks = FMath::DivideAndRoundUp(NumPlates, PlatesPerTask);
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 End = FMath::Min(NumPlates, (Task + 1) * PlatesPerTask);
+            for (int32 i = Task * PlatesPerTask; i < End; ++i)
+            {
+                ForEachSlot(i, [CursorData, List, i](int32 Slot) { List[FPlatformAtomics::InterlockedIncrement(&CursorData[Slot]) - 1] = i + 1; });
+            }
+        });
+
+        const int32 NumSortTasks = FMath::DivideAndRoundUp(NumSlots, ListsPerTask);
+        ParallelFor(NumSortTasks, [&](int32 Task)
+        {
+            const int32 End = FMath::Min(NumSlots, (Task + 1) * ListsPerTask);
+            for (int32 Slot = Task * ListsPerTask; Slot < End; ++Slot)
+            {
+                if (Counts[Slot] > 1)
+                {
+                    int32* First = List + Pointers[Slot];
+                    std::sort(First, First + Counts[Slot], std::greater<int32>());
+                }
+            }
+        });
+    }
+
+
+    // One segment's worth of a mesh
+    struct FChunk
+    {
+        // Views into the mesh (if it's written whole), or into the copies
+        TArrayView<const double> Vertices;
+        TArrayView<const int32> Plates;
+        TArray<double> VertexCopy;
+        TArray<int32> PlateCopy;
+
+        MaxQ::Dsk::FDskSpatialIndex Index;
+        bool bValid = false;
+        FString ErrorMessage;
+    };
+
+    // The chunk's plates, renumbered to just the vertices they use (in the
+    // order they're first used), and its index.  Any thread.
+    TSharedPtr<FChunk> MakeChunk(TArrayView<const double> Vertices, TArrayView<const int32> Plates, int32 FirstPlate, int32 NumPlates, double FineVoxelScale, int32 CoarseVoxelScale)
+    {
+        TSharedPtr<FChunk> Chunk = MakeShared<FChunk>();
+
+        if (FirstPlate == 0 && 3 * NumPlates == Plates.Num())
+        {
+            Chunk->Vertices = Vertices;
+            Chunk->Plates = Plates;
+        }
+        else
+        {
+            TArray<int32> Renumbered;
+            Renumbered.SetNumZeroed(Vertices.Num() / 3);
+
+            Chunk->PlateCopy.SetNumUninitialized(3 * NumPlates);
+            for (int32 i = 0; i < 3 * NumPlates; ++i)
+            {
+                const int32 Vertex = Plates[3 * FirstPlate + i] - 1;
+                if (Renumbered[Vertex] == 0)
+                {
+                    Chunk->VertexCopy.Append(&Vertices[3 * Vertex], 3);
+                    Renumbered[Vertex] = Chunk->VertexCopy.Num() / 3;
+                }
+                Chunk->PlateCopy[i] = Renumbered[Vertex];
+            }
+
+            Chunk->Vertices = Chunk->VertexCopy;
+            Chunk->Plates = Chunk->PlateCopy;
+        }
+
+        Chunk->bValid = MaxQ::Dsk::BuildSpatialIndex(Chunk->Vertices, Chunk->Plates, Chunk->Index, FineVoxelScale, CoarseVoxelScale, nullptr, &Chunk->ErrorMessage);
+        return Chunk;
+    }
+}
+
+
+namespace MaxQ::Dsk
+{
+    int32 FDskSpatialIndex::NumFineVoxels() const
+    {
+        return Integers.Num() > SPICE_DSK02_SIVGRX + 2 ? Integers[SPICE_DSK02_SIVGRX] * Integers[SPICE_DSK02_SIVGRX + 1] * Integers[SPICE_DSK02_SIVGRX + 2] : 0;
+    }
+
+
+    int32 FDskSpatialIndex::NumCoarseVoxels() const
+    {
+        const int32 Scale = Integers.Num() > SPICE_DSK02_SICGSC ? Integers[SPICE_DSK02_SICGSC] : 0;
+        return Scale > 0 ? NumFineVoxels() / (Scale * Scale * Scale) : 0;
+    }
+
+
+    SPICE_API bool BuildSpatialIndex(TArrayView<const double> Vertices, TArrayView<const int32> Plates, FDskSpatialIndex& Index, double FineVoxelScale, int32 CoarseVoxelScale, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        auto Fail = [&](const FString& Message)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = Message;
+            return false;
+        };
+
+        if (Vertices.Num() % 3 != 0 || Plates.Num() % 3 != 0)
+        {
+            return Fail(TEXT("BuildSpatialIndex: vertices and plates come in threes"));
+        }
+
+        const int32 NumVertices = Vertices.Num() / 3;
+        const int32 NumPlates = Plates.Num() / 3;
+        if (NumVertices < 3 || NumVertices > SPICE_DSK02_MAXVRT)
+        {
+            return Fail(FString::Printf(TEXT("BuildSpatialIndex: %d vertices, outside [3, %d]"), NumVertices, SPICE_DSK02_MAXVRT));
+        }
+        if (NumPlates < 1 || NumPlates > SPICE_DSK02_MAXPLT)
+        {
+            return Fail(FString::Printf(TEXT("BuildSpatialIndex: %d plates, outside [1, %d]"), NumPlates, SPICE_DSK02_MAXPLT));
+        }
+        if (!(FineVoxelScale > 0.) || CoarseVoxelScale < 1)
+        {
+            return Fail(FString::Printf(TEXT("BuildSpatialIndex: voxel scales %g and %d must be positive"), FineVoxelScale, CoarseVoxelScale));
+        }
+        for (int32 Vertex : Plates)
+        {
+            if (Vertex < 1 || Vertex > NumVertices)
+            {
+                return Fail(FString::Printf(TEXT("BuildSpatialIndex: vertex %d is outside [1, %d]"), Vertex, NumVertices));
+            }
+        }
+
+        const double* v = Vertices.GetData();
+        const int32* p = Plates.GetData();
+
+        // Plate i's (0-based) k'th vertex's coordinate c
+        auto Coordinate = [v, p](int32 i, int32 k, int32 c) { return v[3 * (p[3 * i + k] - 1) + c]; };
+
+        // The model's extents and the average plate extent, in plate order
+        // (so the sum rounds as zzmkspin's does)
+        double Extent[6] = { DBL_MAX, -DBL_MAX, DBL_MAX, -DBL_MAX, DBL_MAX, -DBL_MAX };
+        double AverageExtent = 0.;
+        for (int32 i = 0; i < NumPlates; ++i)
+        {
+            double Span[3];
+            for (int32 c = 0; c < 3; ++c)
+            {
+                const double Min = FMath::Min3(Coordinate(i, 0, c), Coordinate(i, 1, c), Coordinate(i, 2, c));
+                const double Max = FMath::Max3(Coordinate(i, 0, c), Coordinate(i, 1, c), Coordinate(i, 2, c));
+                Extent[2 * c] = FMath::Min(Extent[2 * c], Min);
+                Extent[2 * c + 1] = FMath::Max(Extent[2 * c + 1], Max);
+                Span[c] = fabs(Max - Min);
+            }
+            AverageExtent = AverageExtent + Span[0] + Span[1] + Span[2];
+        }
+        AverageExtent /= (double)(NumPlates * 3);
+
+        const double VoxelSize = FineVoxelScale * AverageExtent;
+        if (!(VoxelSize > 0.))
+        {
+            return Fail(TEXT("BuildSpatialIndex: the plates have no extent"));
+        }
+        const double Tolerance = VoxelSize * .001;
+        const double CoarseSize = VoxelSize * CoarseVoxelScale;
+
+        double Bounds[6];
+        double Origin[3];
+        int32 NumVoxels[3];
+        for (int32 c = 0; c < 3; ++c)
+        {
+            Bounds[2 * c] = Extent[2 * c] - Tolerance;
+            Bounds[2 * c + 1] = Extent[2 * c + 1] + Tolerance;
+
+            const double Min = NearestInt(Extent[2 * c] / CoarseSize - 1.);
+            const double Max = NearestInt(Extent[2 * c + 1] / CoarseSize + 1.);
+            Origin[c] = Min * CoarseSize;
+            NumVoxels[c] = (int32)NearestInt(Max - Min) * CoarseVoxelScale;
+        }
+
+        const int64 NumFine = (int64)NumVoxels[0] * NumVoxels[1] * NumVoxels[2];
+        if (NumFine > SPICE_DSK02_MAXVOX)
+        {
+            return Fail(FString::Printf(TEXT("BuildSpatialIndex: %lld fine voxels, more than %d.  Increase the fine voxel scale."), NumFine, SPICE_DSK02_MAXVOX));
+        }
+
+        const int32 Scale = CoarseVoxelScale;
+        const int32 PerCoarse = Scale * Scale * Scale;
+        const int32 NumCoarse = (int32)NumFine / PerCoarse;
+        if (NumCoarse > SPICE_DSK02_MAXCGR)
+        {
+            return Fail(FString::Printf(TEXT("BuildSpatialIndex: %d coarse voxels, more than %d.  Increase the coarse voxel scale, fine voxel scale, or both."), NumCoarse, SPICE_DSK02_MAXCGR));
+        }
+        const int32 CoarseDims[3] = { NumVoxels[0] / Scale, NumVoxels[1] / Scale, NumVoxels[2] / Scale };
+
+        // The 1-based voxel coordinates of plate i's bounding box (expanded
+        // by the model tolerance), as zzgetvox.  False if it's off the grid,
+        // which only NaNs can do.
+        auto VoxelBox = [&](int32 i, int32(&Lo)[3], int32(&Hi)[3])
+        {
+            for (int32 c = 0; c < 3; ++c)
+            {
+                const double Min = FMath::Clamp(FMath::Min3(Coordinate(i, 0, c), Coordinate(i, 1, c), Coordinate(i, 2, c)) - Tolerance, Bounds[2 * c], Bounds[2 * c + 1]);
+                const double Max = FMath::Clamp(FMath::Max3(Coordinate(i, 0, c), Coordinate(i, 1, c), Coordinate(i, 2, c)) + Tolerance, Bounds[2 * c], Bounds[2 * c + 1]);
+
+                const double MinTerm = (Min - Origin[c]) / VoxelSize;
+                const double MaxTerm = (Max - Origin[c]) / VoxelSize;
+                if (!(MinTerm >= 0. && MinTerm <= NumVoxels[c]) || !(MaxTerm >= 0. && MaxTerm <= NumVoxels[c]))
+                {
+                    return false;
+                }
+                Lo[c] = (int32)MinTerm < NumVoxels[c] ? (int32)MinTerm + 1 : NumVoxels[c];
+                Hi[c] = (int32)MaxTerm < NumVoxels[c] ? (int32)MaxTerm + 1 : NumVoxels[c];
+            }
+            return true;
+        };
+
+        // Each coarse voxel's first pointer (1-based, 0:  empty), handed out
+        // in the order plates first reach them
+        TArray<int32> CoarsePointers;
+        CoarsePointers.SetNumZeroed(NumCoarse);
+        int32 To = 1;
+        for (int32 i = 0; i < NumPlates; ++i)
+        {
+            int32 Lo[3], Hi[3];
+            if (!VoxelBox(i, Lo, Hi))
+            {
+                return Fail(FString::Printf(TEXT("BuildSpatialIndex: plate %d's bounding box is outside the voxel grid"), i + 1));
+            }
+
+            for (int32 cz = (Lo[2] - 1) / Scale; cz <= (Hi[2] - 1) / Scale; ++cz)
+            {
+                for (int32 cy = (Lo[1] - 1) / Scale; cy <= (Hi[1] - 1) / Scale; ++cy)
+                {
+                    for (int32 cx = (Lo[0] - 1) / Scale; cx <= (Hi[0] - 1) / Scale; ++cx)
+                    {
+                        int32& Pointer = CoarsePointers[cx + CoarseDims[0] * (cy + cz * CoarseDims[1])];
+                        if (Pointer == 0)
+                        {
+                            Pointer = To;
+                            To += PerCoarse;
+                        }
+                    }
+                }
+            }
+        }
+        const int32 NumVoxelPointers = To - 1;
+
+        // Every fine voxel plate i's box covers, as its (0-based) slot in the
+        // voxel pointer array
+        auto ForEachVoxel = [&](int32 i, auto&& Visit)
+        {
+            int32 Lo[3], Hi[3];
+            VoxelBox(i, Lo, Hi);
+            for (int32 iz = Lo[2]; iz <= Hi[2]; ++iz)
+            {
+                const int32 cz = (iz - 1) / Scale;
+                for (int32 iy = Lo[1]; iy <= Hi[1]; ++iy)
+                {
+                    const int32 cy = (iy - 1) / Scale;
+                    for (int32 ix = Lo[0]; ix <= Hi[0]; ++ix)
+                    {
+                        const int32 cx = (ix - 1) / Scale;
+                        const int32 Offset = (iz - Scale * cz - 1) * Scale * Scale + (iy - Scale * cy - 1) * Scale + (ix - Scale * cx);
+                        Visit(CoarsePointers[cx + CoarseDims[0] * (cy + cz * CoarseDims[1])] - 2 + Offset);
+                    }
+                }
+            }
+        };
+
+        auto ForEachVertex = [p](int32 i, auto&& Visit)
+        {
+            Visit(p[3 * i] - 1);
+            Visit(p[3 * i + 1] - 1);
+            Visit(p[3 * i + 2] - 1);
+        };
+
+        TArray<int32> VoxelCounts, VertexCounts;
+        const int64 VoxelListSize = CountLists(NumPlates, NumVoxelPointers, ForEachVoxel, VoxelCounts);
+        const int64 VertexListSize = CountLists(NumPlates, NumVertices, ForEachVertex, VertexCounts);
+        if (NumVoxelPointers > SPICE_DSK02_MAXVXP || VoxelListSize > SPICE_DSK02_MXNVLS)
+        {
+            return Fail(FString::Printf(TEXT("BuildSpatialIndex: %d voxel pointers and %lld voxel-plate list entries, more than %d and %d.  Increase the fine voxel scale."), NumVoxelPointers, VoxelListSize, SPICE_DSK02_MAXVXP, SPICE_DSK02_MXNVLS));
+        }
+
+        // spaixd
+        Index.Doubles.SetNumUninitialized(SPICE_DSK02_SPADSZ);
+        FMemory::Memcpy(&Index.Doubles[SPICE_DSK02_SIVTBD], Extent, sizeof(Extent));
+        FMemory::Memcpy(&Index.Doubles[SPICE_DSK02_SIVXOR], Origin, sizeof(Origin));
+        Index.Doubles[SPICE_DSK02_SIVXSZ] = VoxelSize;
+
+        // spaixi:  the fixed part (sizes, coarse grid), the voxel pointers
+        // and their lists, then the vertex pointers and theirs
+        const int32 VoxelPointersAt = SPICE_DSK02_IXIFIX;
+        const int32 VoxelListAt = VoxelPointersAt + NumVoxelPointers;
+        const int32 VertexPointersAt = VoxelListAt + (int32)VoxelListSize;
+        const int32 VertexListAt = VertexPointersAt + NumVertices;
+
+        Index.Integers.SetNumUninitialized(VertexListAt + (int32)VertexListSize);
+        int32* Integers = Index.Integers.GetData();
+        Integers[SPICE_DSK02_SIVGRX] = NumVoxels[0];
+        Integers[SPICE_DSK02_SIVGRX + 1] = NumVoxels[1];
+        Integers[SPICE_DSK02_SIVGRX + 2] = NumVoxels[2];
+        Integers[SPICE_DSK02_SICGSC] = Scale;
+        Integers[SPICE_DSK02_SIVXNP] = NumVoxelPointers;
+        Integers[SPICE_DSK02_SIVXNL] = (int32)VoxelListSize;
+        Integers[SPICE_DSK02_SIVTNL] = (int32)VertexListSize;
+        FMemory::Memzero(&Integers[SPICE_DSK02_SICGRD], SPICE_DSK02_MAXCGR * sizeof(int32));
+        FMemory::Memcpy(&Integers[SPICE_DSK02_SICGRD], CoarsePointers.GetData(), NumCoarse * sizeof(int32));
+
+        FillLists(NumPlates, ForEachVoxel, VoxelCounts, Integers + VoxelPointersAt, Integers + VoxelListAt);
+        FillLists(NumPlates, ForEachVertex, VertexCounts, Integers + VertexPointersAt, Integers + VertexListAt);
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API void MeshToVerticesAndPlates(TArrayView<const FVector3f> Positions, TArrayView<const uint32> Indices, double Scale, TArray<double>& Vertices, TArray<int32>& Plates)
+    {
+        // FDskMesh's Swizzle (x and y swapped) mirrors, so a triangle wound
+        // for UE is a plate wound for SPICE
+        Vertices.SetNumUninitialized(3 * Positions.Num());
+        for (int32 i = 0; i < Positions.Num(); ++i)
+        {
+            Vertices[3 * i] = Positions[i].Y / Scale;
+            Vertices[3 * i + 1] = Positions[i].X / Scale;
+            Vertices[3 * i + 2] = Positions[i].Z / Scale;
+        }
+
+        Plates.SetNumUninitialized(Indices.Num());
+        for (int32 i = 0; i < Indices.Num(); ++i)
+        {
+            Plates[i] = (int32)Indices[i] + 1;
+        }
+    }
+
+
+    SPICE_API bool DskOpen(const FString& relativePath, const FString& ifname, int ncomch, int& handle, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        SpiceInt _handle = 0;
+        dskopn_c(StringCast<ANSICHAR>(*toPath(relativePath)).Get(), StringCast<ANSICHAR>(*ifname).Get(), ncomch, &_handle);
+        handle = (int)_handle;
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API bool DskClose(int handle, bool bOptimize, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        dskcls_c(handle, bOptimize ? SPICETRUE : SPICEFALSE);
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API bool WriteDskType2(int handle, int center, int surfid, const FString& frame, TArrayView<const double> Vertices, TArrayView<const int32> Plates, const FDskWriterSettings& Settings, int32* SegmentsWritten, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        auto Fail = [&](const FString& Message)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = Message;
+            return false;
+        };
+
+        if (SegmentsWritten) *SegmentsWritten = 0;
+
+        if (Vertices.Num() % 3 != 0 || Plates.Num() % 3 != 0 || Plates.Num() == 0)
+        {
+            return Fail(TEXT("WriteDskType2: vertices and plates come in threes, and there must be plates"));
+        }
+        if (Settings.MaxPlatesPerSegment < 1)
+        {
+            return Fail(TEXT("WriteDskType2: MaxPlatesPerSegment must be positive"));
+        }
+        const int32 NumVertices = Vertices.Num() / 3;
+        for (int32 Vertex : Plates)
+        {
+            if (Vertex < 1 || Vertex > NumVertices)
+            {
+                return Fail(FString::Printf(TEXT("WriteDskType2: vertex %d is outside [1, %d]"), Vertex, NumVertices));
+            }
+        }
+
+        const int32 NumPlates = Plates.Num() / 3;
+        const int32 PerChunk = Settings.MaxPlatesPerSegment;
+        const int32 NumChunks = FMath::DivideAndRoundUp(NumPlates, PerChunk);
+        const double FineVoxelScale = Settings.FineVoxelScale;
+        const int32 CoarseVoxelScale = Settings.CoarseVoxelScale;
+
+        auto StartChunk = [=](int32 c)
+        {
+            return Async(EAsyncExecution::ThreadPool, [=]()
+            {
+                return MakeChunk(Vertices, Plates, c * PerChunk, FMath::Min(PerChunk, NumPlates - c * PerChunk), FineVoxelScale, CoarseVoxelScale);
+            });
+        };
+
+        auto _frame = StringCast<ANSICHAR>(*frame);
+        const SpiceDouble* _corpar = Settings.CoordinateParameters;
+
+        // While CSPICE writes one segment, the next one's index is built
+        TFuture<TSharedPtr<FChunk>> Next = StartChunk(0);
+        for (int32 c = 0; c < NumChunks; ++c)
+        {
+            const TSharedPtr<FChunk> Chunk = Next.Get();
+            if (c + 1 < NumChunks)
+            {
+                Next = StartChunk(c + 1);
+            }
+
+            if (!Chunk->bValid)
+            {
+                Next.Wait();
+                return Fail(FString::Printf(TEXT("WriteDskType2: segment %d:  %s"), c, *Chunk->ErrorMessage));
+            }
+
+            const SpiceInt _nv = Chunk->Vertices.Num() / 3;
+            const SpiceInt _np = Chunk->Plates.Num() / 3;
+            const SpiceDouble(*_vrtces)[3] = reinterpret_cast<const SpiceDouble(*)[3]>(Chunk->Vertices.GetData());
+            const SpiceInt(*_plates)[3] = reinterpret_cast<const SpiceInt(*)[3]>(Chunk->Plates.GetData());
+
+            double _mncor1 = Settings.MinCoordinate1, _mxcor1 = Settings.MaxCoordinate1;
+            double _mncor2 = Settings.MinCoordinate2, _mxcor2 = Settings.MaxCoordinate2;
+            if (Settings.CoordinateSystem == SPICE_DSK_RECSYS)
+            {
+                const TArray<double>& Extent = Chunk->Index.Doubles;
+                _mncor1 = Extent[0];
+                _mxcor1 = Extent[1];
+                _mncor2 = Extent[2];
+                _mxcor2 = Extent[3];
+            }
+
+            SpiceDouble _mncor3 = 0., _mxcor3 = 0.;
+            dskrb2_c(_nv, _vrtces, _np, _plates, Settings.CoordinateSystem, _corpar, &_mncor3, &_mxcor3);
+
+            dskw02_c(
+                handle, center, surfid, Settings.DataClass, _frame.Get(),
+                Settings.CoordinateSystem, _corpar,
+                _mncor1, _mxcor1, _mncor2, _mxcor2, _mncor3, _mxcor3,
+                Settings.First, Settings.Last,
+                _nv, _vrtces, _np, _plates,
+                Chunk->Index.Doubles.GetData(), Chunk->Index.Integers.GetData()
+            );
+
+            if (failed_c())
+            {
+                Next.Wait();
+                break;
+            }
+            if (SegmentsWritten) ++*SegmentsWritten;
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API bool WriteDskType2(int handle, int center, int surfid, const FString& frame, TArrayView<const FVector3f> Positions, TArrayView<const uint32> Indices, double Scale, const FDskWriterSettings& Settings, int32* SegmentsWritten, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        TArray<double> Vertices;
+        TArray<int32> Plates;
+        MeshToVerticesAndPlates(Positions, Indices, Scale, Vertices, Plates);
+
+        return WriteDskType2(handle, center, surfid, frame, Vertices, Plates, Settings, SegmentsWritten, ResultCode, ErrorMessage);
+    }
+}
@@ -0,0 +1,228 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEclipseBatch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Eclipse state and shadow fraction for whole catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEclipseBatch.cpp is part of the "refined C++ API".
+//
+// Everything is done in the occulting body's frame, scaled so its ellipsoid
+// is a sphere of its largest radius.  From each position, the source and the
+// occulter are disks of angular radius asin(R / distance), and the state
+// follows from their separation, as zzocced's for spheres.  The hidden
+// fraction is the area of the disks' overlap (the lens formula) over the
+// source disk's area.
+//------------------------------------------------------------------------------
+
+#include "SpiceEclipseBatch.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    // Area of the intersection of disks of radius r1, r2, d apart, where
+    // |r1 - r2| < d < r1 + r2
+    inline double Lens(double r1, double r2, double d)
+    {
+        const double c1 = FMath::Clamp((d * d + r1 * r1 - r2 * r2) / (2. * d * r1), -1., 1.);
+        const double c2 = FMath::Clamp((d * d + r2 * r2 - r1 * r1) / (2. * d * r2), -1., 1.);
+        const double k = (-d + r1 + r2) * (d + r1 - r2) * (d - r1 + r2) * (d + r1 + r2);
+        return r1 * r1 * acos(c1) + r2 * r2 * acos(c2) - 0.5 * sqrt(FMath::Max(k, 0.));
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    bool EclipseGeometry(
+        const FSEphemerisTime& et,
+        FEclipseGeometry& Geometry,
+        const FString& frame,
+        const FString& source,
+        const FString& occulter,
+        const FString& fixref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto            _frame = StringCast<ANSICHAR>(*frame);
+        auto            _source = StringCast<ANSICHAR>(*source);
+        auto            _occulter = StringCast<ANSICHAR>(*occulter);
+        auto            _fixref = StringCast<ANSICHAR>(*fixref);
+        ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+        SpiceDouble     _et = et.AsSpiceDouble();
+
+        SpiceDouble _psrc[3] = {}, _lt = 0.;
+        spkpos_c(_source.Get(), _et, _frame.Get(), _abcorr, _occulter.Get(), _psrc, &_lt);
+
+        SpiceDouble _rotate[3][3];
+        pxform_c(_frame.Get(), _fixref.Get(), _et, _rotate);
+
+        SpiceDouble _srcradii[3] = {}, _occradii[3] = {};
+        SpiceInt _code = 0, _dim = 0;
+        if (!failed_c() && ResolveBody(_source.Get(), _code))
+        {
+            CachedBodvcd(_code, "RADII", 3, &_dim, _srcradii);
+        }
+        if (!failed_c() && ResolveBody(_occulter.Get(), _code))
+        {
+            CachedBodvcd(_code, "RADII", 3, &_dim, _occradii);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        Geometry.Epoch = et;
+        Geometry.Source = FSDistanceVector(_psrc);
+        Geometry.SourceRadius = FSDistance(FMath::Max3(_srcradii[0], _srcradii[1], _srcradii[2]));
+        Geometry.ToBodyFixed = FSRotationMatrix(_rotate);
+        Geometry.OccultingRadii = FSDistanceVector(_occradii);
+        return true;
+    }
+
+
+    bool EclipseStates(
+        const FEclipseGeometry& Geometry,
+        const FConstVectorBatch& Positions,
+        TArrayView<ES_OccultationType> States,
+        TArrayView<float> ShadowFraction
+    )
+    {
+        const int32 Num = Positions.Num();
+        if (Positions.Y.Num() != Num || Positions.Z.Num() != Num)
+        {
+            return false;
+        }
+        if ((States.Num() != 0 && States.Num() != Num) || (ShadowFraction.Num() != 0 && ShadowFraction.Num() != Num))
+        {
+            return false;
+        }
+
+        double Radii[3];
+        Geometry.OccultingRadii.CopyTo(Radii);
+        const double SourceRadius = Geometry.SourceRadius.AsSpiceDouble();
+        if (!(Radii[0] > 0. && Radii[1] > 0. && Radii[2] > 0. && SourceRadius > 0.))
+        {
+            return false;
+        }
+
+        // The caller's frame to the scaled body fixed frame:  diag(R / radii) * m
+        const double R = FMath::Max3(Radii[0], Radii[1], Radii[2]);
+        double m[3][3];
+        Geometry.ToBodyFixed.CopyTo(m);
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                m[i][j] *= R / Radii[i];
+            }
+        }
+
+        double s0[3];
+        Geometry.Source.CopyTo(s0);
+        const double Source[3] = {
+            m[0][0] * s0[0] + m[0][1] * s0[1] + m[0][2] * s0[2],
+            m[1][0] * s0[0] + m[1][1] * s0[1] + m[1][2] * s0[2],
+            m[2][0] * s0[0] + m[2][1] * s0[1] + m[2][2] * s0[2]
+        };
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const double x = Positions.X[i], y = Positions.Y[i], z = Positions.Z[i];
+                const double p[3] = {
+                    m[0][0] * x + m[0][1] * y + m[0][2] * z,
+                    m[1][0] * x + m[1][1] * y + m[1][2] * z,
+                    m[2][0] * x + m[2][1] * y + m[2][2] * z
+                };
+
+                // To the source, and to the occulter's center
+                const double s[3] = { Source[0] - p[0], Source[1] - p[1], Source[2] - p[2] };
+                const double ls = sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+                const double lo = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+
+                ES_OccultationType State = ES_OccultationType::NONE;
+                double Fraction = 0.;
+
+                if (lo <= R)
+                {
+                    State = ES_OccultationType::FULL;
+                    Fraction = 1.;
+                }
+                else if (lo < ls)
+                {
+                    const double as = asin(FMath::Min(SourceRadius / ls, 1.));
+                    const double ao = asin(R / lo);
+
+                    // vsep(s, -p)
+                    const double cx = -(s[1] * p[2] - s[2] * p[1]), cy = -(s[2] * p[0] - s[0] * p[2]), cz = -(s[0] * p[1] - s[1] * p[0]);
+                    const double Separation = atan2(sqrt(cx * cx + cy * cy + cz * cz), -(s[0] * p[0] + s[1] * p[1] + s[2] * p[2]));
+
+                    if (Separation >= as + ao)
+                    {
+                        // NONE
+                    }
+                    else if (Separation <= ao - as)
+                    {
+                        State = ES_OccultationType::FULL;
+                        Fraction = 1.;
+                    }
+                    else if (Separation <= as - ao)
+                    {
+                        State = ES_OccultationType::ANNULAR;
+                        Fraction = (ao * ao) / (as * as);
+                    }
+                    else
+                    {
+                        State = ES_OccultationType::PARTIAL;
+                        Fraction = FMath::Clamp(Lens(as, ao, Separation) / (pi * as * as), 0., 1.);
+                    }
+                }
+
+                if (States.Num() > 0)
+                {
+                    States[i] = State;
+                }
+                if (ShadowFraction.Num() > 0)
+                {
+                    ShadowFraction[i] = float(Fraction);
+                }
+            }
+        }, Num <= ChunkSize);
+
+        return true;
+    }
+}
@@ -0,0 +1,1274 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemeris.cpp
+//
+// Implementation Comments
+//
+// Purpose:  C++ Ephemeris queries (SPK) for many epochs/targets at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemeris.cpp is part of the "refined C++ API".
+//
+// spkcvo gets the observer's state relative to the SSB (its center's, plus
+// the point's own, rotated by sxform), then corrects the target's state for
+// light time with that (spkltc, through zzspkfzo).  FConstantPointQuery does
+// the same, but with the center's state and the transform looked up once per
+// epoch for every point.  Geometric states skip the SSB:  the target's state
+// relative to the center, less the point's.
+//------------------------------------------------------------------------------
+
+#include "SpiceEphemeris.h"
+#include "SpiceName.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Ephemeris;
+
+    // km/s, clight_c
+    constexpr double SpeedOfLight = 299792.458;
+
+    // spkltc's:  up to 5 iterations for CN (1 for LT), converged when the
+    // light time changes by less than 1e-17 of the epoch
+    constexpr double LightTimeTolerance = 1e-17;
+
+    // The aberration correction, decided at compile time.  spkez, spkltc and
+    // spkapo parse their abcorr string (zzvalcor) on every call, and only
+    // remember the last one, so mixing corrections parses every time.
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    struct TAbcorr
+    {
+        static constexpr bool bGeometric = Abcorr == ES_AberrationCorrectionWithNewtonians::None;
+        static constexpr bool bConverged = Abcorr == ES_AberrationCorrectionWithNewtonians::CN || Abcorr == ES_AberrationCorrectionWithNewtonians::CN_S;
+        static constexpr bool bStellar = Abcorr == ES_AberrationCorrectionWithNewtonians::LT_S || Abcorr == ES_AberrationCorrectionWithNewtonians::CN_S;
+        static constexpr int32 Iterations = bConverged ? 5 : 1;
+    };
+
+    // spkltc's reception case:  the target's light time corrected state
+    // relative to an observer at sobs (relative to the SSB, in ref).
+    // bVelocity:  whether starg's velocity is wanted (positions skip dlt).
+    template<ES_AberrationCorrectionWithNewtonians Abcorr, bool bVelocity>
+    void LightTime(SpiceInt targ, SpiceDouble et, ConstSpiceChar* ref, const SpiceDouble(&sobs)[6], SpiceDouble(&starg)[6], SpiceDouble& lt)
+    {
+        SpiceDouble _ssbtrg[6];
+        {
+            MAXQ_SPK_LOOKUP_SCOPE();
+            spkssb_c(targ, et, ref, _ssbtrg);
+        }
+        if (failed_c())
+        {
+            return;
+        }
+        vsubg_c(_ssbtrg, sobs, 6, starg);
+        lt = vnorm_c(starg) / SpeedOfLight;
+        if (lt == 0.)
+        {
+            // The observer is the target
+            return;
+        }
+
+        double LtErr = 1.;
+        for (int32 i = 0; i < TAbcorr<Abcorr>::Iterations && LtErr > LightTimeTolerance; ++i)
+        {
+            const SpiceDouble _epoch = et - lt;
+            {
+                MAXQ_SPK_LOOKUP_SCOPE();
+                spkssb_c(targ, _epoch, ref, _ssbtrg);
+            }
+            if (failed_c())
+            {
+                return;
+            }
+            vsubg_c(_ssbtrg, sobs, 6, starg);
+            const SpiceDouble _prvlt = lt;
+            lt = vnorm_c(starg) / SpeedOfLight;
+            LtErr = FMath::Abs(lt - _prvlt) / FMath::Max(1., FMath::Abs(_epoch));
+        }
+
+        if constexpr (bVelocity)
+        {
+            // dlt/dt = A*B / (1 + A*C),  A = 1/(c*|r|), B = <r, v>, C = <r, vtarg>
+            // v' = vtarg * (1 - dlt) - vobs
+            const SpiceDouble A = 1. / (SpeedOfLight * vnorm_c(starg));
+            const SpiceDouble B = vdot_c(starg, &starg[3]);
+            const SpiceDouble C = vdot_c(starg, &_ssbtrg[3]);
+            if (-A * C > .99999999989999999)
+            {
+                setmsg_c("Target range rate magnitude is approximately the speed of light. The light time derivative cannot be computed.");
+                sigerr_c("SPICE(DIVIDEBYZERO)");
+                return;
+            }
+            const SpiceDouble _dlt = A * B / (1. + A * C);
+            starg[3] = _ssbtrg[3] * (1. - _dlt) - sobs[3];
+            starg[4] = _ssbtrg[4] * (1. - _dlt) - sobs[4];
+            starg[5] = _ssbtrg[5] * (1. - _dlt) - sobs[5];
+        }
+    }
+
+    // spkez, one epoch.  Light time in an inertial frame is done here
+    // (bInertial, checked once per batch);  stellar aberration of a state
+    // needs the observer's acceleration (spkaps), so that, and frames whose
+    // orientation depends on the light time, still go to spkez.
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    void Spkez(SpiceInt targ, SpiceDouble et, ConstSpiceChar* ref, SpiceInt obs, bool bInertial, SpiceDouble(&state)[6], SpiceDouble& lt)
+    {
+        if constexpr (TAbcorr<Abcorr>::bGeometric)
+        {
+            MAXQ_SPK_LOOKUP_SCOPE();
+            spkgeo_c(targ, et, ref, obs, state, &lt);
+        }
+        else
+        {
+            if (!TAbcorr<Abcorr>::bStellar && bInertial)
+            {
+                SpiceDouble _sobs[6];
+                {
+                    MAXQ_SPK_LOOKUP_SCOPE();
+                    spkssb_c(obs, et, ref, _sobs);
+                }
+                if (!failed_c())
+                {
+                    LightTime<Abcorr, true>(targ, et, ref, _sobs, state, lt);
+                }
+                return;
+            }
+
+            MAXQ_SPK_LOOKUP_SCOPE();
+            spkez_c(targ, et, ref, MaxQ::Core::ToANSIString(Abcorr), obs, state, &lt);
+        }
+    }
+
+    // spkezp, one epoch.  Positions only need the observer's velocity for
+    // stellar aberration (stelab), so in an inertial frame every correction
+    // is done here.
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    void Spkezp(SpiceInt targ, SpiceDouble et, ConstSpiceChar* ref, SpiceInt obs, bool bInertial, SpiceDouble(&ptarg)[3], SpiceDouble& lt)
+    {
+        if constexpr (TAbcorr<Abcorr>::bGeometric)
+        {
+            MAXQ_SPK_LOOKUP_SCOPE();
+            spkgps_c(targ, et, ref, obs, ptarg, &lt);
+        }
+        else
+        {
+            if (bInertial)
+            {
+                SpiceDouble _sobs[6], _starg[6];
+                {
+                    MAXQ_SPK_LOOKUP_SCOPE();
+                    spkssb_c(obs, et, ref, _sobs);
+                }
+                if (!failed_c())
+                {
+                    LightTime<Abcorr, false>(targ, et, ref, _sobs, _starg, lt);
+                }
+                if (failed_c())
+                {
+                    return;
+                }
+                if constexpr (TAbcorr<Abcorr>::bStellar)
+                {
+                    stelab_c(_starg, &_sobs[3], ptarg);
+                }
+                else
+                {
+                    vequ_c(_starg, ptarg);
+                }
+                return;
+            }
+
+            spkezp_c(targ, et, ref, MaxQ::Core::ToANSIString(Abcorr), obs, ptarg, &lt);
+        }
+    }
+
+    // spkezr/spkpos resolve the names with bods2c, then call spkez/spkezp.
+    // The batches resolve them once, and the correction is a template
+    // argument, so the loop doesn't branch on it.
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    int32 TypedSpkezBatch(
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        SpiceInt targ,
+        SpiceInt obs,
+        ConstSpiceChar* ref
+    )
+    {
+        const int32 Count = ets.Num();
+        check(states.X.Num() >= Count && states.Y.Num() >= Count && states.Z.Num() >= Count);
+        check(states.DX.Num() >= Count && states.DY.Num() >= Count && states.DZ.Num() >= Count);
+        check(lt.Num() == 0 || lt.Num() >= Count);
+
+        const bool bInertial = !TAbcorr<Abcorr>::bGeometric && IsInertialFrame(ref);
+
+        int32 i = 0;
+        for (; i < Count; ++i)
+        {
+            SpiceDouble _state[6];
+            SpiceDouble _lt = 0.;
+            Spkez<Abcorr>(targ, ets[i], ref, obs, bInertial, _state, _lt);
+
+            if (failed_c())
+            {
+                break;
+            }
+
+            states.X[i] = _state[0];
+            states.Y[i] = _state[1];
+            states.Z[i] = _state[2];
+            states.DX[i] = _state[3];
+            states.DY[i] = _state[4];
+            states.DZ[i] = _state[5];
+            if (lt.Num() > 0) lt[i] = _lt;
+        }
+
+        return i;
+    }
+
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    int32 TypedSpkezpBatch(
+        TArrayView<const double> ets,
+        const FPositionBatch& positions,
+        TArrayView<double> lt,
+        SpiceInt targ,
+        SpiceInt obs,
+        ConstSpiceChar* ref
+    )
+    {
+        const int32 Count = ets.Num();
+        check(positions.X.Num() >= Count && positions.Y.Num() >= Count && positions.Z.Num() >= Count);
+        check(lt.Num() == 0 || lt.Num() >= Count);
+
+        const bool bInertial = !TAbcorr<Abcorr>::bGeometric && IsInertialFrame(ref);
+
+        int32 i = 0;
+        for (; i < Count; ++i)
+        {
+            SpiceDouble _ptarg[3];
+            SpiceDouble _lt = 0.;
+            Spkezp<Abcorr>(targ, ets[i], ref, obs, bInertial, _ptarg, _lt);
+
+            if (failed_c())
+            {
+                break;
+            }
+
+            positions.X[i] = _ptarg[0];
+            positions.Y[i] = _ptarg[1];
+            positions.Z[i] = _ptarg[2];
+            if (lt.Num() > 0) lt[i] = _lt;
+        }
+
+        return i;
+    }
+
+    // The runtime correction, dispatched once per batch
+    int32 SpkezBatch(
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        SpiceInt targ,
+        SpiceInt obs,
+        ConstSpiceChar* ref,
+        ES_AberrationCorrectionWithNewtonians abcorr
+    )
+    {
+        switch (abcorr)
+        {
+        case ES_AberrationCorrectionWithNewtonians::LT:   return TypedSpkezBatch<ES_AberrationCorrectionWithNewtonians::LT>(ets, states, lt, targ, obs, ref);
+        case ES_AberrationCorrectionWithNewtonians::LT_S: return TypedSpkezBatch<ES_AberrationCorrectionWithNewtonians::LT_S>(ets, states, lt, targ, obs, ref);
+        case ES_AberrationCorrectionWithNewtonians::CN:   return TypedSpkezBatch<ES_AberrationCorrectionWithNewtonians::CN>(ets, states, lt, targ, obs, ref);
+        case ES_AberrationCorrectionWithNewtonians::CN_S: return TypedSpkezBatch<ES_AberrationCorrectionWithNewtonians::CN_S>(ets, states, lt, targ, obs, ref);
+        default: break;
+        }
+        return TypedSpkezBatch<ES_AberrationCorrectionWithNewtonians::None>(ets, states, lt, targ, obs, ref);
+    }
+
+    int32 SpkezpBatch(
+        TArrayView<const double> ets,
+        const FPositionBatch& positions,
+        TArrayView<double> lt,
+        SpiceInt targ,
+        SpiceInt obs,
+        ConstSpiceChar* ref,
+        ES_AberrationCorrectionWithNewtonians abcorr
+    )
+    {
+        switch (abcorr)
+        {
+        case ES_AberrationCorrectionWithNewtonians::LT:   return TypedSpkezpBatch<ES_AberrationCorrectionWithNewtonians::LT>(ets, positions, lt, targ, obs, ref);
+        case ES_AberrationCorrectionWithNewtonians::LT_S: return TypedSpkezpBatch<ES_AberrationCorrectionWithNewtonians::LT_S>(ets, positions, lt, targ, obs, ref);
+        case ES_AberrationCorrectionWithNewtonians::CN:   return TypedSpkezpBatch<ES_AberrationCorrectionWithNewtonians::CN>(ets, positions, lt, targ, obs, ref);
+        case ES_AberrationCorrectionWithNewtonians::CN_S: return TypedSpkezpBatch<ES_AberrationCorrectionWithNewtonians::CN_S>(ets, positions, lt, targ, obs, ref);
+        default: break;
+        }
+        return TypedSpkezpBatch<ES_AberrationCorrectionWithNewtonians::None>(ets, positions, lt, targ, obs, ref);
+    }
+
+    // Points with constant positions or velocities.  spkcpo/spkcpt are
+    // spkcvo/spkcvt with zero velocity (CSPICE implements them that way, too)
+    struct FConstantPoints
+    {
+        // One or the other
+        TArrayView<const FSStateVector> States;
+        TArrayView<const FSDistanceVector> Positions;
+        SpiceDouble Epoch = 0.;
+
+        int32 Num() const { return States.Num() > 0 ? States.Num() : Positions.Num(); }
+
+        // The point's state at Epoch (spkcvo's obssta)
+        void Get(int32 i, SpiceDouble(&sta)[6]) const
+        {
+            if (States.Num() > 0)
+            {
+                States[i].CopyTo(sta);
+            }
+            else
+            {
+                SpiceDouble pos[3];
+                Positions[i].CopyTo(pos);
+                sta[0] = pos[0]; sta[1] = pos[1]; sta[2] = pos[2];
+                sta[3] = sta[4] = sta[5] = 0.;
+            }
+        }
+
+        // ...and at et, as zzcvxsta
+        void At(int32 i, SpiceDouble et, SpiceDouble(&sta)[6]) const
+        {
+            Get(i, sta);
+            const SpiceDouble dt = et - Epoch;
+            sta[0] += dt * sta[3];
+            sta[1] += dt * sta[4];
+            sta[2] += dt * sta[5];
+        }
+    };
+
+    // spkcvo (the points observe Other) or spkcvt (Other observes the
+    // points), with the names converted once
+    struct FConstantPointQuery
+    {
+        FConstantPoints Points;
+        bool bObserver = true;
+        ConstSpiceChar* Other = nullptr;
+        ConstSpiceChar* Center = nullptr;
+        ConstSpiceChar* PointRef = nullptr;
+        ConstSpiceChar* OutRef = nullptr;
+        ConstSpiceChar* RefLoc = nullptr;
+        ES_AberrationCorrectionWithNewtonians Abcorr = ES_AberrationCorrectionWithNewtonians::None;
+
+        SpiceInt OtherId = 0;
+        SpiceInt CenterId = 0;
+        bool bGeometric = true;
+        bool bShared = true;
+
+        // Whether the points can share lookups:  geometric states, or light
+        // time without stellar aberration in an inertial frame (where refloc
+        // makes no difference).  Anything else goes to CSPICE per point.
+        bool Prepare()
+        {
+            bGeometric = Abcorr == ES_AberrationCorrectionWithNewtonians::None;
+            const bool bLightTimeOnly = Abcorr == ES_AberrationCorrectionWithNewtonians::LT || Abcorr == ES_AberrationCorrectionWithNewtonians::CN;
+            bShared = bGeometric || (bObserver && bLightTimeOnly && IsInertialFrame(OutRef));
+
+            return !bShared || (ResolveBody(Other, OtherId) && ResolveBody(Center, CenterId));
+        }
+
+        // Points [First, First + Count) at et, through Write(i, state, lt).
+        // Returns the number written, stopping at the first failure.
+        template<typename WriteFn>
+        int32 Evaluate(SpiceDouble et, int32 First, int32 Count, WriteFn&& Write) const
+        {
+            ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(Abcorr);
+            SpiceDouble _sta[6], _state[6], _lt;
+
+            int32 n = 0;
+
+            if (!bShared)
+            {
+                for (; n < Count; ++n)
+                {
+                    Points.Get(First + n, _sta);
+                    const SpiceDouble _epc = Points.States.Num() > 0 ? Points.Epoch : et;
+                    {
+                        MAXQ_SPK_LOOKUP_SCOPE();
+                        if (bObserver)
+                        {
+                            spkcvo_c(Other, et, OutRef, RefLoc, _abcorr, _sta, _epc, Center, PointRef, _state, &_lt);
+                        }
+                        else
+                        {
+                            spkcvt_c(_sta, _epc, Center, PointRef, et, OutRef, RefLoc, _abcorr, Other, _state, &_lt);
+                        }
+                    }
+                    if (failed_c())
+                    {
+                        break;
+                    }
+                    Write(First + n, _state, _lt);
+                }
+                return n;
+            }
+
+            // Shared by every point:  their frame's transform, and their
+            // center's state (relative to the SSB when correcting for light
+            // time, otherwise relative to the other body)
+            SpiceDouble _xform[6][6];
+            SpiceDouble _center[6];
+            {
+                MAXQ_FRAME_LOOKUP_SCOPE();
+                sxform_c(PointRef, OutRef, et, _xform);
+            }
+            {
+                MAXQ_SPK_LOOKUP_SCOPE();
+                if (!bGeometric)
+                {
+                    spkssb_c(CenterId, et, OutRef, _center);
+                }
+                else if (bObserver)
+                {
+                    spkgeo_c(OtherId, et, OutRef, CenterId, _center, &_lt);
+                }
+                else
+                {
+                    spkgeo_c(CenterId, et, OutRef, OtherId, _center, &_lt);
+                }
+            }
+            if (failed_c())
+            {
+                return 0;
+            }
+
+            for (; n < Count; ++n)
+            {
+                SpiceDouble _offset[6];
+                Points.At(First + n, et, _sta);
+                mxvg_c(_xform, _sta, 6, 6, _offset);
+
+                if (bGeometric)
+                {
+                    if (bObserver)
+                    {
+                        vsubg_c(_center, _offset, 6, _state);
+                    }
+                    else
+                    {
+                        vaddg_c(_center, _offset, 6, _state);
+                    }
+                    _lt = vnorm_c(_state) / SpeedOfLight;
+                }
+                else
+                {
+                    SpiceDouble _sobs[6];
+                    SpiceDouble _dlt;
+                    vaddg_c(_center, _offset, 6, _sobs);
+
+                    MAXQ_SPK_LOOKUP_SCOPE();
+                    spkltc_c(OtherId, et, OutRef, _abcorr, _sobs, _state, &_lt, &_dlt);
+                    if (failed_c())
+                    {
+                        break;
+                    }
+                }
+
+                Write(First + n, _state, _lt);
+            }
+
+            return n;
+        }
+    };
+
+    int32 ConstantPointsMulti(
+        FConstantPointQuery& Query,
+        const FSEphemerisTime& et,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const int32 Count = Query.Points.Num();
+        check(states.Num() >= Count);
+        check(lts.Num() == 0 || lts.Num() >= Count);
+
+        int32 i = 0;
+        if (Query.Prepare())
+        {
+            i = Query.Evaluate(et.AsSpiceDouble(), 0, Count, [&](int32 n, const SpiceDouble(&_state)[6], SpiceDouble _lt)
+            {
+                states[n] = FSStateVector(_state);
+                if (lts.Num() > 0) lts[n] = FSEphemerisPeriod(_lt);
+            });
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+    int32 ConstantPointBatch(
+        FConstantPointQuery& Query,
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const int32 Count = ets.Num();
+        check(states.X.Num() >= Count && states.Y.Num() >= Count && states.Z.Num() >= Count);
+        check(states.DX.Num() >= Count && states.DY.Num() >= Count && states.DZ.Num() >= Count);
+        check(lt.Num() == 0 || lt.Num() >= Count);
+
+        int32 i = 0;
+        if (Query.Prepare())
+        {
+            for (; i < Count; ++i)
+            {
+                const int32 Written = Query.Evaluate(ets[i], 0, 1, [&](int32, const SpiceDouble(&_state)[6], SpiceDouble _lt)
+                {
+                    states.X[i] = _state[0];
+                    states.Y[i] = _state[1];
+                    states.Z[i] = _state[2];
+                    states.DX[i] = _state[3];
+                    states.DY[i] = _state[4];
+                    states.DZ[i] = _state[5];
+                    if (lt.Num() > 0) lt[i] = _lt;
+                });
+
+                if (Written == 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+}
+
+namespace MaxQ::Ephemeris
+{
+    SPICE_API int32 SpkposMulti(
+        const FSEphemerisTime& et,
+        TArrayView<const FString> targs,
+        TArrayView<FSDistanceVector> ptargs,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const int32 Count = targs.Num();
+        check(ptargs.Num() >= Count);
+        check(lts.Num() == 0 || lts.Num() >= Count);
+
+        ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+        auto _ref = StringCast<ANSICHAR>(*ref);
+        auto _obs = StringCast<ANSICHAR>(*obs);
+        SpiceDouble _et = et.AsSpiceDouble();
+
+        int32 i = 0;
+
+        if (IsInertialFrame(_ref.Get()))
+        {
+            // Observer state relative to the SSB, once.
+            SpiceInt _obsid;
+            SpiceDouble _sobs[6];
+            if (ResolveBody(_obs.Get(), _obsid))
+            {
+                spkssb_c(_obsid, _et, _ref.Get(), _sobs);
+            }
+
+            for (; i < Count && !failed_c(); ++i)
+            {
+                auto _targ = StringCast<ANSICHAR>(*targs[i]);
+                SpiceInt _targid;
+                if (!ResolveBody(_targ.Get(), _targid))
+                {
+                    break;
+                }
+
+                SpiceDouble _ptarg[3];
+                SpiceDouble _lt;
+                spkapo_c(_targid, _et, _ref.Get(), _sobs, _abcorr, _ptarg, &_lt);
+
+                if (failed_c())
+                {
+                    break;
+                }
+
+                ptargs[i] = FSDistanceVector(_ptarg);
+                if (lts.Num() > 0) lts[i] = FSEphemerisPeriod(_lt);
+            }
+        }
+        else
+        {
+            // Non-inertial frames (IAU_EARTH, etc) need the frame orientation
+            // at the light-time corrected epoch of each target.  Let spkpos do it.
+            for (; i < Count; ++i)
+            {
+                auto _targ = StringCast<ANSICHAR>(*targs[i]);
+
+                SpiceDouble _ptarg[3];
+                SpiceDouble _lt;
+                MAXQ_SPK_LOOKUP_SCOPE();
+                spkpos_c(_targ.Get(), _et, _ref.Get(), _abcorr, _obs.Get(), _ptarg, &_lt);
+
+                if (failed_c())
+                {
+                    break;
+                }
+
+                ptargs[i] = FSDistanceVector(_ptarg);
+                if (lts.Num() > 0) lts[i] = FSEphemerisPeriod(_lt);
+            }
+        }
+
+        if (failed_c() && i < Count)
+        {
+            // Say which target failed, in addition to SPICE's reason
+            UE_LOG(LogSpice, Verbose, TEXT("MaxQ SPICE SpkposMulti failed for target %s"), *targs[i]);
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+
+    SPICE_API int32 SpkezrMulti(
+        const FSEphemerisTime& et,
+        TArrayView<const FString> targs,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const int32 Count = targs.Num();
+        check(states.Num() >= Count);
+        check(lts.Num() == 0 || lts.Num() >= Count);
+
+        ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+        auto _ref = StringCast<ANSICHAR>(*ref);
+        auto _obs = StringCast<ANSICHAR>(*obs);
+        SpiceDouble _et = et.AsSpiceDouble();
+
+        // spkltc handles light time, but silently ignores stellar aberration.
+        // States with stellar aberration need the observer's acceleration,
+        // so leave those to spkezr.
+        const bool bStellar = strstr(_abcorr, "+S") != nullptr;
+
+        int32 i = 0;
+
+        if (!bStellar && IsInertialFrame(_ref.Get()))
+        {
+            SpiceInt _obsid;
+            SpiceDouble _sobs[6];
+            if (ResolveBody(_obs.Get(), _obsid))
+            {
+                spkssb_c(_obsid, _et, _ref.Get(), _sobs);
+            }
+
+            for (; i < Count && !failed_c(); ++i)
+            {
+                auto _targ = StringCast<ANSICHAR>(*targs[i]);
+                SpiceInt _targid;
+                if (!ResolveBody(_targ.Get(), _targid))
+                {
+                    break;
+                }
+
+                SpiceDouble _starg[6];
+                SpiceDouble _lt, _dlt;
+                spkltc_c(_targid, _et, _ref.Get(), _abcorr, _sobs, _starg, &_lt, &_dlt);
+
+                if (failed_c())
+                {
+                    break;
+                }
+
+                states[i] = FSStateVector(_starg);
+                if (lts.Num() > 0) lts[i] = FSEphemerisPeriod(_lt);
+            }
+        }
+        else
+        {
+            for (; i < Count; ++i)
+            {
+                auto _targ = StringCast<ANSICHAR>(*targs[i]);
+
+                SpiceDouble _starg[6];
+                SpiceDouble _lt;
+                MAXQ_SPK_LOOKUP_SCOPE();
+                spkezr_c(_targ.Get(), _et, _ref.Get(), _abcorr, _obs.Get(), _starg, &_lt);
+
+                if (failed_c())
+                {
+                    break;
+                }
+
+                states[i] = FSStateVector(_starg);
+                if (lts.Num() > 0) lts[i] = FSEphemerisPeriod(_lt);
+            }
+        }
+
+        if (failed_c() && i < Count)
+        {
+            UE_LOG(LogSpice, Verbose, TEXT("MaxQ SPICE SpkezrMulti failed for target %s"), *targs[i]);
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+
+    SPICE_API int32 BodyPoses(
+        const FSEphemerisTime& et,
+        TArrayView<const FString> targs,
+        TArrayView<const FString> frames,
+        TArrayView<FTransform> Poses,
+        const FString& obs,
+        const FString& ref,
+        double DistanceScale,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const int32 Count = targs.Num();
+        check(frames.Num() == Count);
+        check(Poses.Num() >= Count);
+
+        TArray<FSDistanceVector> Positions;
+        Positions.SetNumUninitialized(Count);
+        const int32 NumPositions = SpkposMulti(et, targs, Positions, TArrayView<FSEphemerisPeriod>(), obs, ref, abcorr, ResultCode, ErrorMessage);
+
+        auto _ref = StringCast<ANSICHAR>(*ref);
+        SpiceDouble _et = et.AsSpiceDouble();
+
+        int32 i = 0;
+        for (; i < NumPositions; ++i)
+        {
+            FQuat Rotation = FQuat::Identity;
+            if (!frames[i].IsEmpty())
+            {
+                SpiceDouble _m[3][3];
+                SpiceDouble _q[4];
+                {
+                    MAXQ_FRAME_LOOKUP_SCOPE();
+                    pxform_c(TCHAR_TO_ANSI(*frames[i]), _ref.Get(), _et, _m);
+                }
+                if (failed_c())
+                {
+                    UE_LOG(LogSpice, Verbose, TEXT("MaxQ SPICE BodyPoses failed for frame %s"), *frames[i]);
+                    break;
+                }
+                m2q_c(_m, _q);
+                Rotation = FQuat(-_q[2], -_q[1], -_q[3], _q[0]);
+            }
+
+            Poses[i] = FTransform(Rotation, Positions[i].Swizzle() / DistanceScale);
+        }
+
+        if (NumPositions < Count)
+        {
+            return NumPositions;
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+    SPICE_API int32 SpkezrBatch(
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FString& targ,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        // Once per batch, not once per epoch
+        auto _targ = StringCast<ANSICHAR>(*targ);
+        auto _ref = StringCast<ANSICHAR>(*ref);
+        auto _obs = StringCast<ANSICHAR>(*obs);
+
+        int32 i = 0;
+        SpiceInt _targid, _obsid;
+        if (ResolveBody(_targ.Get(), _targid) && ResolveBody(_obs.Get(), _obsid))
+        {
+            i = SpkezBatch(ets, states, lt, _targid, _obsid, _ref.Get(), abcorr);
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+    SPICE_API int32 SpkezrBatch(
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        int32 i = 0;
+        int _targid, _obsid;
+        if (targ.BodyId(_targid) && obs.BodyId(_obsid))
+        {
+            i = SpkezBatch(ets, states, lt, _targid, _obsid, ref.Ansi(), abcorr);
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+
+    SPICE_API int32 SpkposBatch(
+        TArrayView<const double> ets,
+        const FPositionBatch& positions,
+        TArrayView<double> lt,
+        const FString& targ,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto _targ = StringCast<ANSICHAR>(*targ);
+        auto _ref = StringCast<ANSICHAR>(*ref);
+        auto _obs = StringCast<ANSICHAR>(*obs);
+
+        int32 i = 0;
+        SpiceInt _targid, _obsid;
+        if (ResolveBody(_targ.Get(), _targid) && ResolveBody(_obs.Get(), _obsid))
+        {
+            i = SpkezpBatch(ets, positions, lt, _targid, _obsid, _ref.Get(), abcorr);
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+    SPICE_API int32 SpkposBatch(
+        TArrayView<const double> ets,
+        const FPositionBatch& positions,
+        TArrayView<double> lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        int32 i = 0;
+        int _targid, _obsid;
+        if (targ.BodyId(_targid) && obs.BodyId(_obsid))
+        {
+            i = SpkezpBatch(ets, positions, lt, _targid, _obsid, ref.Ansi(), abcorr);
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    SPICE_API int32 SpkezrBatch(
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        int32 i = 0;
+        int _targid, _obsid;
+        if (targ.BodyId(_targid) && obs.BodyId(_obsid))
+        {
+            i = TypedSpkezBatch<Abcorr>(ets, states, lt, _targid, _obsid, ref.Ansi());
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+    template SPICE_API int32 SpkezrBatch<ES_AberrationCorrectionWithNewtonians::None>(TArrayView<const double>, const FStateVectorBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+    template SPICE_API int32 SpkezrBatch<ES_AberrationCorrectionWithNewtonians::LT>(TArrayView<const double>, const FStateVectorBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+    template SPICE_API int32 SpkezrBatch<ES_AberrationCorrectionWithNewtonians::LT_S>(TArrayView<const double>, const FStateVectorBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+    template SPICE_API int32 SpkezrBatch<ES_AberrationCorrectionWithNewtonians::CN>(TArrayView<const double>, const FStateVectorBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+    template SPICE_API int32 SpkezrBatch<ES_AberrationCorrectionWithNewtonians::CN_S>(TArrayView<const double>, const FStateVectorBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+
+
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    SPICE_API int32 SpkposBatch(
+        TArrayView<const double> ets,
+        const FPositionBatch& positions,
+        TArrayView<double> lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        int32 i = 0;
+        int _targid, _obsid;
+        if (targ.BodyId(_targid) && obs.BodyId(_obsid))
+        {
+            i = TypedSpkezpBatch<Abcorr>(ets, positions, lt, _targid, _obsid, ref.Ansi());
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return i;
+    }
+
+    template SPICE_API int32 SpkposBatch<ES_AberrationCorrectionWithNewtonians::None>(TArrayView<const double>, const FPositionBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+    template SPICE_API int32 SpkposBatch<ES_AberrationCorrectionWithNewtonians::LT>(TArrayView<const double>, const FPositionBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+    template SPICE_API int32 SpkposBatch<ES_AberrationCorrectionWithNewtonians::LT_S>(TArrayView<const double>, const FPositionBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+    template SPICE_API int32 SpkposBatch<ES_AberrationCorrectionWithNewtonians::CN>(TArrayView<const double>, const FPositionBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+    template SPICE_API int32 SpkposBatch<ES_AberrationCorrectionWithNewtonians::CN_S>(TArrayView<const double>, const FPositionBatch&, TArrayView<double>, const FSpiceName&, const FSpiceName&, const FSpiceName&, ES_ResultCode*, FString*);
+
+
+    // The CSPICE calls, leaving any error for the caller to check
+    static void SpkezrUnchecked(
+        const FSEphemerisTime& et,
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr
+    )
+    {
+        int _targid, _obsid;
+        if (targ.BodyId(_targid) && obs.BodyId(_obsid))
+        {
+            SpiceDouble _lt = lt.AsSpiceDouble();
+            MAXQ_SPK_LOOKUP_SCOPE();
+            MAXQ_TRACE_SCOPE_TEXT(TEXT("spkezr %s wrt %s in %s"), ANSI_TO_TCHAR(targ.Ansi()), ANSI_TO_TCHAR(obs.Ansi()), ANSI_TO_TCHAR(ref.Ansi()));
+            spkez_c(_targid, et.AsSpiceDouble(), ref.Ansi(), MaxQ::Core::ToANSIString(abcorr), _obsid, state.AsSpiceDoubleArray(), &_lt);
+            lt = FSEphemerisPeriod(_lt);
+        }
+    }
+
+    static void SpkposUnchecked(
+        const FSEphemerisTime& et,
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr
+    )
+    {
+        int _targid, _obsid;
+        if (targ.BodyId(_targid) && obs.BodyId(_obsid))
+        {
+            SpiceDouble _lt = lt.AsSpiceDouble();
+            MAXQ_SPK_LOOKUP_SCOPE();
+            MAXQ_TRACE_SCOPE_TEXT(TEXT("spkpos %s wrt %s in %s"), ANSI_TO_TCHAR(targ.Ansi()), ANSI_TO_TCHAR(obs.Ansi()), ANSI_TO_TCHAR(ref.Ansi()));
+            spkezp_c(_targid, et.AsSpiceDouble(), ref.Ansi(), MaxQ::Core::ToANSIString(abcorr), _obsid, ptarg.AsSpiceDoubleArray(), &_lt);
+            lt = FSEphemerisPeriod(_lt);
+        }
+    }
+
+    SPICE_API void Spkezr(
+        const FSEphemerisTime& et,
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        SpkezrUnchecked(et, state, lt, targ, obs, ref, abcorr);
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+    SPICE_API void Spkpos(
+        const FSEphemerisTime& et,
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        SpkposUnchecked(et, ptarg, lt, targ, obs, ref, abcorr);
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+    SPICE_API MaxQ::Core::TSpiceResult<void> TrySpkezr(
+        const FSEphemerisTime& et,
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr
+    )
+    {
+        SpkezrUnchecked(et, state, lt, targ, obs, ref, abcorr);
+        return MaxQ::Core::TakeResult();
+    }
+
+    SPICE_API MaxQ::Core::TSpiceResult<void> TrySpkpos(
+        const FSEphemerisTime& et,
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr
+    )
+    {
+        SpkposUnchecked(et, ptarg, lt, targ, obs, ref, abcorr);
+        return MaxQ::Core::TakeResult();
+    }
+
+    SPICE_API int32 SpkcvoMulti(
+        const FSEphemerisTime& et,
+        TArrayView<const FSStateVector> obssta,
+        const FSEphemerisTime& obsepc,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& target,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsctr,
+        const FString& obsref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto _target = StringCast<ANSICHAR>(*target);
+        auto _outref = StringCast<ANSICHAR>(*outref);
+        auto _obsctr = StringCast<ANSICHAR>(*obsctr);
+        auto _obsref = StringCast<ANSICHAR>(*obsref);
+
+        FConstantPointQuery Query;
+        Query.Points.States = obssta;
+        Query.Points.Epoch = obsepc.AsSpiceDouble();
+        Query.bObserver = true;
+        Query.Other = _target.Get();
+        Query.Center = _obsctr.Get();
+        Query.PointRef = _obsref.Get();
+        Query.OutRef = _outref.Get();
+        Query.RefLoc = MaxQ::Core::ToANSIString(refloc);
+        Query.Abcorr = abcorr;
+
+        return ConstantPointsMulti(Query, et, states, lts, ResultCode, ErrorMessage);
+    }
+
+    SPICE_API int32 SpkcpoMulti(
+        const FSEphemerisTime& et,
+        TArrayView<const FSDistanceVector> obspos,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& target,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsctr,
+        const FString& obsref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto _target = StringCast<ANSICHAR>(*target);
+        auto _outref = StringCast<ANSICHAR>(*outref);
+        auto _obsctr = StringCast<ANSICHAR>(*obsctr);
+        auto _obsref = StringCast<ANSICHAR>(*obsref);
+
+        FConstantPointQuery Query;
+        Query.Points.Positions = obspos;
+        Query.bObserver = true;
+        Query.Other = _target.Get();
+        Query.Center = _obsctr.Get();
+        Query.PointRef = _obsref.Get();
+        Query.OutRef = _outref.Get();
+        Query.RefLoc = MaxQ::Core::ToANSIString(refloc);
+        Query.Abcorr = abcorr;
+
+        return ConstantPointsMulti(Query, et, states, lts, ResultCode, ErrorMessage);
+    }
+
+    SPICE_API int32 SpkcvtMulti(
+        TArrayView<const FSStateVector> trgsta,
+        const FSEphemerisTime& trgepc,
+        const FSEphemerisTime& et,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& trgctr,
+        const FString& trgref,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsrvr,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto _trgctr = StringCast<ANSICHAR>(*trgctr);
+        auto _trgref = StringCast<ANSICHAR>(*trgref);
+        auto _outref = StringCast<ANSICHAR>(*outref);
+        auto _obsrvr = StringCast<ANSICHAR>(*obsrvr);
+
+        FConstantPointQuery Query;
+        Query.Points.States = trgsta;
+        Query.Points.Epoch = trgepc.AsSpiceDouble();
+        Query.bObserver = false;
+        Query.Other = _obsrvr.Get();
+        Query.Center = _trgctr.Get();
+        Query.PointRef = _trgref.Get();
+        Query.OutRef = _outref.Get();
+        Query.RefLoc = MaxQ::Core::ToANSIString(refloc);
+        Query.Abcorr = abcorr;
+
+        return ConstantPointsMulti(Query, et, states, lts, ResultCode, ErrorMessage);
+    }
+
+    SPICE_API int32 SpkcptMulti(
+        TArrayView<const FSDistanceVector> trgpos,
+        const FSEphemerisTime& et,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& trgctr,
+        const FString& trgref,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsrvr,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto _trgctr = StringCast<ANSICHAR>(*trgctr);
+        auto _trgref = StringCast<ANSICHAR>(*trgref);
+        auto _outref = StringCast<ANSICHAR>(*outref);
+        auto _obsrvr = StringCast<ANSICHAR>(*obsrvr);
+
+        FConstantPointQuery Query;
+        Query.Points.Positions = trgpos;
+        Query.bObserver = false;
+        Query.Other = _obsrvr.Get();
+        Query.Center = _trgctr.Get();
+        Query.PointRef = _trgref.Get();
+        Query.OutRef = _outref.Get();
+        Query.RefLoc = MaxQ::Core::ToANSIString(refloc);
+        Query.Abcorr = abcorr;
+
+        return ConstantPointsMulti(Query, et, states, lts, ResultCode, ErrorMessage);
+    }
+
+    SPICE_API int32 SpkcpoBatch(
+        TArrayView<const double> ets,
+        const FSDistanceVector& obspos,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FString& target,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsctr,
+        const FString& obsref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto _target = StringCast<ANSICHAR>(*target);
+        auto _outref = StringCast<ANSICHAR>(*outref);
+        auto _obsctr = StringCast<ANSICHAR>(*obsctr);
+        auto _obsref = StringCast<ANSICHAR>(*obsref);
+
+        FConstantPointQuery Query;
+        Query.Points.Positions = MakeArrayView(&obspos, 1);
+        Query.bObserver = true;
+        Query.Other = _target.Get();
+        Query.Center = _obsctr.Get();
+        Query.PointRef = _obsref.Get();
+        Query.OutRef = _outref.Get();
+        Query.RefLoc = MaxQ::Core::ToANSIString(refloc);
+        Query.Abcorr = abcorr;
+
+        return ConstantPointBatch(Query, ets, states, lt, ResultCode, ErrorMessage);
+    }
+
+    SPICE_API int32 SpkcptBatch(
+        const FSDistanceVector& trgpos,
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FString& trgctr,
+        const FString& trgref,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsrvr,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto _trgctr = StringCast<ANSICHAR>(*trgctr);
+        auto _trgref = StringCast<ANSICHAR>(*trgref);
+        auto _outref = StringCast<ANSICHAR>(*outref);
+        auto _obsrvr = StringCast<ANSICHAR>(*obsrvr);
+
+        FConstantPointQuery Query;
+        Query.Points.Positions = MakeArrayView(&trgpos, 1);
+        Query.bObserver = false;
+        Query.Other = _obsrvr.Get();
+        Query.Center = _trgctr.Get();
+        Query.PointRef = _trgref.Get();
+        Query.OutRef = _outref.Get();
+        Query.RefLoc = MaxQ::Core::ToANSIString(refloc);
+        Query.Abcorr = abcorr;
+
+        return ConstantPointBatch(Query, ets, states, lt, ResultCode, ErrorMessage);
+    }
+}
@@ -0,0 +1,346 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisCache.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Native Chebyshev fits of SPK positions, for frame-rate queries.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisCache.cpp is part of the "refined C++ API".
+//
+// Blocks are fit by interpolating at the Chebyshev nodes (same scheme as SPK
+// type 2/3 records), then checked against SPICE halfway between the nodes and
+// at both ends.  A block that misses the tolerance is split in half.
+//------------------------------------------------------------------------------
+
+#include "SpiceEphemerisCache.h"
+#include "SpiceUtilities.h"
+#include "Algo/BinarySearch.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr int32 MaxDegree = 63;
+}
+
+namespace MaxQ::Ephemeris
+{
+    bool FChebyshevCache::Build(
+        const TArray<FString>& bodies,
+        const FString& obs,
+        const FString& ref,
+        const FSEphemerisTime& start,
+        const FSEphemerisTime& stop,
+        const FChebyshevCacheSettings& Settings,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_LLM_SCOPE();
+
+        Reset();
+
+        // (Coefficients are fit into a fixed-size scratch array)
+        const int32 N = FMath::Clamp(Settings.Degree, 1, MaxDegree) + 1;
+        const double MinBlock = FMath::Max(Settings.MinBlockSeconds, 1.);
+        const double MaxBlock = FMath::Max(Settings.MaxBlockSeconds, MinBlock);
+
+        if (stop.seconds <= start.seconds)
+        {
+            setmsg_c("Cache span is empty (start # >= stop #).");
+            errdp_c("#", start.seconds);
+            errdp_c("#", stop.seconds);
+            sigerr_c("SPICE(INVALIDTIMESPAN)");
+            ErrorCheck(ResultCode, ErrorMessage);
+            return false;
+        }
+
+        Start = start.seconds;
+        Stop = stop.seconds;
+        Stride = 3 * N;
+
+        // Chebyshev nodes, and the points halfway between them (plus the ends)
+        TArray<double> Nodes, Checks;
+        for (int32 k = 0; k < N; ++k)
+        {
+            Nodes.Add(FMath::Cos(PI * (k + 0.5) / N));
+        }
+        Checks.Add(1.);
+        for (int32 k = 1; k < N; ++k)
+        {
+            Checks.Add(FMath::Cos(PI * k / N));
+        }
+        Checks.Add(-1.);
+
+        ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+        auto _ref = StringCast<ANSICHAR>(*ref);
+        auto _obs = StringCast<ANSICHAR>(*obs);
+
+        TArray<double> Samples;
+        Samples.SetNumUninitialized(Stride);
+
+        for (const FString& body : bodies)
+        {
+            FBody& Body = Bodies.AddDefaulted_GetRef();
+            Body.Name = body;
+            BodyIndex.Add(body, Bodies.Num() - 1);
+
+            auto _targ = StringCast<ANSICHAR>(*body);
+
+            auto Sample = [&](double et, double (&p)[3]) -> bool
+            {
+                SpiceDouble _lt;
+                MAXQ_SPK_LOOKUP_SCOPE();
+                spkpos_c(_targ.Get(), et, _ref.Get(), _abcorr, _obs.Get(), p, &_lt);
+                return !failed_c();
+            };
+
+            // Fit [a, b], splitting as necessary.  Blocks are appended in order.
+            TFunction<bool(double, double)> FitBlock;
+            FitBlock = [&](double a, double b) -> bool
+            {
+                const double Mid = 0.5 * (a + b);
+                const double Radius = 0.5 * (b - a);
+
+                // Samples, component-major
+                for (int32 k = 0; k < N; ++k)
+                {
+                    double p[3];
+                    if (!Sample(Mid + Radius * Nodes[k], p)) return false;
+                    Samples[k] = p[0];
+                    Samples[N + k] = p[1];
+                    Samples[2 * N + k] = p[2];
+                }
+
+                double c[3][MaxDegree + 1];
+                for (int32 i = 0; i < 3; ++i)
+                {
+                    for (int32 j = 0; j < N; ++j)
+                    {
+                        double Sum = 0.;
+                        for (int32 k = 0; k < N; ++k)
+                        {
+                            Sum += Samples[i * N + k] * FMath::Cos(PI * j * (k + 0.5) / N);
+                        }
+                        c[i][j] = 2. * Sum / N;
+                    }
+                    c[i][0] *= 0.5;
+                }
+
+                double MaxError = 0.;
+                for (double x : Checks)
+                {
+                    double p[3];
+                    if (!Sample(Mid + Radius * x, p)) return false;
+
+                    double dx = Clenshaw(c[0], N, x) - p[0];
+                    double dy = Clenshaw(c[1], N, x) - p[1];
+                    double dz = Clenshaw(c[2], N, x) - p[2];
+                    MaxError = FMath::Max(MaxError, FMath::Sqrt(dx * dx + dy * dy + dz * dz));
+                }
+
+                if (MaxError > Settings.ToleranceKm)
+                {
+                    if (b - a >= 2. * MinBlock)
+                    {
+                        return FitBlock(a, Mid) && FitBlock(Mid, b);
+                    }
+
+                    UE_LOG(LogSpice, Verbose, TEXT("MaxQ Chebyshev cache: %s misses tolerance by %f km at the minimum block length"), *Body.Name, MaxError - Settings.ToleranceKm);
+                }
+
+                Body.BlockStart.Add(a);
+                Body.BlockMid.Add(Mid);
+                Body.BlockRadius.Add(Radius);
+
+                const int32 Offset = Body.Coefficients.AddUninitialized(Stride);
+                Body.Derivatives.AddUninitialized(Stride);
+                for (int32 i = 0; i < 3; ++i)
+                {
+                    FMemory::Memcpy(&Body.Coefficients[Offset + i * N], c[i], N * sizeof(double));
+                    Differentiate(c[i], &Body.Derivatives[Offset + i * N], N);
+                }
+
+                return true;
+            };
+
+            bool bOk = true;
+            for (double a = Start; bOk && a < Stop; a += MaxBlock)
+            {
+                bOk = FitBlock(a, FMath::Min(a + MaxBlock, Stop));
+            }
+
+            if (!bOk)
+            {
+                break;
+            }
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage) != 0)
+        {
+            Reset();
+            return false;
+        }
+
+        return true;
+    }
+
+
+    void FChebyshevCache::Reset()
+    {
+        Bodies.Empty();
+        BodyIndex.Empty();
+        Start = Stop = 0.;
+        Stride = 0;
+    }
+
+
+    SIZE_T FChebyshevCache::GetAllocatedSize() const
+    {
+        SIZE_T Size = Bodies.GetAllocatedSize() + BodyIndex.GetAllocatedSize();
+        for (const FBody& Body : Bodies)
+        {
+            Size += Body.BlockStart.GetAllocatedSize() + Body.BlockMid.GetAllocatedSize() + Body.BlockRadius.GetAllocatedSize();
+            Size += Body.Coefficients.GetAllocatedSize() + Body.Derivatives.GetAllocatedSize();
+        }
+        return Size;
+    }
+
+
+    int32 FChebyshevCache::FindBody(const FString& body) const
+    {
+        const int32* Index = BodyIndex.Find(body);
+        return Index ? *Index : INDEX_NONE;
+    }
+
+
+    int32 FChebyshevCache::FindBlock(const FBody& Body, double et) const
+    {
+        if (et < Start || et > Stop || Body.BlockStart.Num() == 0)
+        {
+            return INDEX_NONE;
+        }
+
+        // Last block starting at or before et
+        return FMath::Max(Algo::UpperBound(Body.BlockStart, et) - 1, 0);
+    }
+
+
+    bool FChebyshevCache::Evaluate(int32 Index, double et, double (&r)[3]) const
+    {
+        if (!Bodies.IsValidIndex(Index))
+        {
+            MAXQ_CACHE_EVENT(ChebyshevMisses);
+            return false;
+        }
+
+        const FBody& Body = Bodies[Index];
+        const int32 Block = FindBlock(Body, et);
+        if (Block == INDEX_NONE)
+        {
+            MAXQ_CACHE_EVENT(ChebyshevMisses);
+            return false;
+        }
+        MAXQ_CACHE_EVENT(ChebyshevHits);
+
+        const int32 N = Stride / 3;
+        const double x = FMath::Clamp((et - Body.BlockMid[Block]) / Body.BlockRadius[Block], -1., 1.);
+        const double* c = &Body.Coefficients[Block * Stride];
+
+        r[0] = Clenshaw(c, N, x);
+        r[1] = Clenshaw(c + N, N, x);
+        r[2] = Clenshaw(c + 2 * N, N, x);
+        return true;
+    }
+
+
+    bool FChebyshevCache::Evaluate(int32 Index, double et, double (&r)[3], double (&v)[3]) const
+    {
+        if (!Bodies.IsValidIndex(Index))
+        {
+            MAXQ_CACHE_EVENT(ChebyshevMisses);
+            return false;
+        }
+
+        const FBody& Body = Bodies[Index];
+        const int32 Block = FindBlock(Body, et);
+        if (Block == INDEX_NONE)
+        {
+            MAXQ_CACHE_EVENT(ChebyshevMisses);
+            return false;
+        }
+        MAXQ_CACHE_EVENT(ChebyshevHits);
+
+        const int32 N = Stride / 3;
+        const double Radius = Body.BlockRadius[Block];
+        const double x = FMath::Clamp((et - Body.BlockMid[Block]) / Radius, -1., 1.);
+        const double* c = &Body.Coefficients[Block * Stride];
+        const double* d = &Body.Derivatives[Block * Stride];
+
+        for (int32 i = 0; i < 3; ++i)
+        {
+            r[i] = Clenshaw(c + i * N, N, x);
+            v[i] = Clenshaw(d + i * N, N, x) / Radius;
+        }
+        return true;
+    }
+
+
+    int32 FChebyshevCache::NumBlocks(int32 Index) const
+    {
+        return Bodies.IsValidIndex(Index) ? Bodies[Index].BlockStart.Num() : 0;
+    }
+
+
+    bool FChebyshevCache::GetBlock(int32 Index, int32 Block, double& Mid, double& Radius, TArrayView<const double>& Coefficients) const
+    {
+        if (!Bodies.IsValidIndex(Index) || !Bodies[Index].BlockStart.IsValidIndex(Block)) return false;
+
+        const FBody& Body = Bodies[Index];
+        Mid = Body.BlockMid[Block];
+        Radius = Body.BlockRadius[Block];
+        Coefficients = TArrayView<const double>(Body.Coefficients).Slice(Block * Stride, Stride);
+        return true;
+    }
+
+
+    bool FChebyshevCache::Position(const FString& body, const FSEphemerisTime& et, FSDistanceVector& r) const
+    {
+        double _r[3];
+        if (!Evaluate(FindBody(body), et.seconds, _r)) return false;
+
+        r = FSDistanceVector(_r);
+        return true;
+    }
+
+
+    bool FChebyshevCache::State(const FString& body, const FSEphemerisTime& et, FSStateVector& state) const
+    {
+        double _r[3], _v[3];
+        if (!Evaluate(FindBody(body), et.seconds, _r, _v)) return false;
+
+        state = FSStateVector(FSDistanceVector(_r), FSVelocityVector(_v));
+        return true;
+    }
+}
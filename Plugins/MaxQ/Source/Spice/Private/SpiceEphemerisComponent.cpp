@@ -0,0 +1,129 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisComponent.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A scene component placed by the ephemeris subsystem.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisComponent.cpp is part of the "Blueprints API".
+//------------------------------------------------------------------------------
+
+#include "SpiceEphemerisComponent.h"
+#include "Engine/World.h"
+
+
+UMaxQEphemerisComponent::UMaxQEphemerisComponent()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+
+    // Moved every frame
+    Mobility = EComponentMobility::Movable;
+}
+
+
+void UMaxQEphemerisComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    Subscribe();
+}
+
+
+void UMaxQEphemerisComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    Unsubscribe();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+void UMaxQEphemerisComponent::OnRegister()
+{
+    Super::OnRegister();
+
+    if (IsInEditorWorld())
+    {
+        Subscribe();
+    }
+}
+
+
+void UMaxQEphemerisComponent::OnUnregister()
+{
+    if (IsInEditorWorld())
+    {
+        Unsubscribe();
+    }
+
+    Super::OnUnregister();
+}
+
+
+void UMaxQEphemerisComponent::Refresh()
+{
+    if (HasBegunPlay() || IsInEditorWorld())
+    {
+        Unsubscribe();
+        Subscribe();
+    }
+}
+
+
+bool UMaxQEphemerisComponent::GetState(FSStateVector& State) const
+{
+    const UWorld* World = GetWorld();
+    const UMaxQEphemerisSubsystem* Subsystem = World ? World->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr;
+
+    return Subsystem && Subsystem->GetState(Handle, State);
+}
+
+
+void UMaxQEphemerisComponent::Subscribe()
+{
+    UWorld* World = GetWorld();
+    if (UMaxQEphemerisSubsystem* Subsystem = World ? World->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr)
+    {
+        Handle = Subsystem->Register(Ephemeris, this, Placement);
+    }
+}
+
+
+bool UMaxQEphemerisComponent::IsInEditorWorld() const
+{
+    const UWorld* World = GetWorld();
+    return World && World->WorldType == EWorldType::Editor;
+}
+
+
+void UMaxQEphemerisComponent::Unsubscribe()
+{
+    UWorld* World = GetWorld();
+    if (UMaxQEphemerisSubsystem* Subsystem = World ? World->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr)
+    {
+        Subsystem->Unregister(Handle);
+    }
+    Handle.Reset();
+}
+
+
+#if WITH_EDITOR
+void UMaxQEphemerisComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    Refresh();
+}
+#endif
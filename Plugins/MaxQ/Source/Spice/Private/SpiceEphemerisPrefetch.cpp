@@ -0,0 +1,246 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisPrefetch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Chebyshev cache windows, built ahead of time-warped playback.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisPrefetch.cpp is part of the "refined C++ API".
+//
+// The build command captures copies of everything it needs, not the
+// prefetcher, so a prefetcher can be destroyed (or reconfigured) with a build
+// in flight:  the result lands in a future nobody reads, or is dropped for
+// its stale generation.
+//
+// Consecutive windows overlap by a little, so there's no epoch between the
+// end of one and the start of the next that neither covers.
+//------------------------------------------------------------------------------
+
+#include "SpiceEphemerisPrefetch.h"
+#include "SpiceExecutor.h"
+#include "SpiceMemory.h"
+
+namespace
+{
+    // Overlap between consecutive windows, as a fraction of a window
+    constexpr double Overlap = 0.01;
+
+    // Behind playback, as a fraction of a window, in case it turns around
+    constexpr double Behind = 0.1;
+}
+
+namespace MaxQ::Ephemeris
+{
+    void FEphemerisPrefetcher::Configure(
+        const TArray<FString>& bodies,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr,
+        const FEphemerisPrefetchSettings& _Settings
+    )
+    {
+        Reset();
+
+        Bodies = bodies;
+        Observer = obs;
+        Frame = ref;
+        AberrationCorrection = abcorr;
+        Settings = _Settings;
+    }
+
+
+    void FEphemerisPrefetcher::Reset()
+    {
+        ++Generation;
+        InFlight.Reset();
+        Current.Reset();
+        Next.Reset();
+        FailedStart = 0.;
+        FailedStop = -1.;
+    }
+
+
+    bool FEphemerisPrefetcher::Update(const FSEphemerisTime& et, double Rate, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        check(IsInGameThread());
+
+        const double _et = et.AsSpiceDouble();
+        bool bSuccess = true;
+
+        if (InFlight.IsValid() && InFlight.IsReady())
+        {
+            FBuildResult Result = InFlight.Get();
+            InFlight.Reset();
+
+            if (Result.Generation == Generation)
+            {
+                if (Result.Cache.IsValid())
+                {
+                    Next = Result.Cache;
+                    FailedStart = 0.;
+                    FailedStop = -1.;
+                }
+                else
+                {
+                    bSuccess = false;
+                    if (ErrorMessage)
+                    {
+                        *ErrorMessage = Result.ErrorMessage;
+                    }
+                }
+            }
+        }
+
+        // Playback has reached the next window
+        if (!Covers(Current, _et) && Covers(Next, _et))
+        {
+            Current = Next;
+            Next.Reset();
+        }
+
+        if (Bodies.Num() == 0 || InFlight.IsValid())
+        {
+            return bSuccess;
+        }
+
+        const double Span = FMath::Clamp(FMath::Abs(Rate) * Settings.LookaheadSeconds, Settings.MinWindowSeconds, FMath::Max(Settings.MinWindowSeconds, Settings.MaxWindowSeconds));
+        const bool bForwards = Rate >= 0.;
+
+        if (!Covers(Current, _et))
+        {
+            // Jumped (or outran the prefetch):  a window starting here
+            if (bForwards)
+            {
+                Launch(_et - Behind * Span, _et + Span);
+            }
+            else
+            {
+                Launch(_et - Span, _et + Behind * Span);
+            }
+            return bSuccess;
+        }
+
+        const double Start = Current->GetStart().AsSpiceDouble();
+        const double Stop = Current->GetStop().AsSpiceDouble();
+        const double Left = bForwards ? Stop - _et : _et - Start;
+
+        // A next window on the wrong side (playback turned around) is no use
+        if (Next.IsValid())
+        {
+            const bool bAhead = bForwards ? Next->GetStop().AsSpiceDouble() > Stop : Next->GetStart().AsSpiceDouble() < Start;
+            if (bAhead)
+            {
+                return bSuccess;
+            }
+            Next.Reset();
+        }
+
+        if (Rate != 0. && Left < Settings.RefillFraction * (Stop - Start))
+        {
+            if (bForwards)
+            {
+                Launch(Stop - Overlap * Span, Stop + Span);
+            }
+            else
+            {
+                Launch(Start - Span, Start + Overlap * Span);
+            }
+        }
+
+        return bSuccess;
+    }
+
+
+    void FEphemerisPrefetcher::Launch(double Start, double Stop)
+    {
+        if (Start < FailedStop && Stop > FailedStart)
+        {
+            // Overlaps one that failed (no coverage there, probably)
+            return;
+        }
+
+        TFuture<FBuildResult> Future = FSpiceExecutor::Get().Enqueue(
+            [_Generation = Generation, _Bodies = Bodies, _Observer = Observer, _Frame = Frame, _AberrationCorrection = AberrationCorrection, _Settings = Settings.Cache, Start, Stop]()
+            {
+                FBuildResult Result;
+                Result.Generation = _Generation;
+
+                TSharedPtr<FChebyshevCache, ESPMode::ThreadSafe> Cache = MakeShared<FChebyshevCache, ESPMode::ThreadSafe>();
+                ES_ResultCode ResultCode = ES_ResultCode::Success;
+                if (Cache->Build(_Bodies, _Observer, _Frame, FSEphemerisTime(Start), FSEphemerisTime(Stop), _Settings, _AberrationCorrection, &ResultCode, &Result.ErrorMessage))
+                {
+                    Result.Cache = Cache;
+                }
+
+                return Result;
+            });
+
+        // Assume it fails until it doesn't:  a failure is remembered, a
+        // success clears it
+        FailedStart = Start;
+        FailedStop = Stop;
+        InFlight = MoveTemp(Future);
+    }
+
+
+    bool FEphemerisPrefetcher::Covers(const FWindow& Window, double et)
+    {
+        return Window.IsValid() && et >= Window->GetStart().AsSpiceDouble() && et <= Window->GetStop().AsSpiceDouble();
+    }
+
+
+    const FChebyshevCache* FEphemerisPrefetcher::Find(double et) const
+    {
+        if (Covers(Current, et))
+        {
+            return Current.Get();
+        }
+        if (Covers(Next, et))
+        {
+            return Next.Get();
+        }
+        return nullptr;
+    }
+
+
+    bool FEphemerisPrefetcher::IsReady(double et) const
+    {
+        return Find(et) != nullptr;
+    }
+
+
+    bool FEphemerisPrefetcher::Evaluate(int32 BodyIndex, double et, double (&r)[3], double (&v)[3]) const
+    {
+        const FChebyshevCache* Cache = Find(et);
+        return Cache && Cache->Evaluate(BodyIndex, et, r, v);
+    }
+
+
+    bool FEphemerisPrefetcher::Position(const FString& body, const FSEphemerisTime& et, FSDistanceVector& r) const
+    {
+        const FChebyshevCache* Cache = Find(et.AsSpiceDouble());
+        return Cache && Cache->Position(body, et, r);
+    }
+
+
+    bool FEphemerisPrefetcher::State(const FString& body, const FSEphemerisTime& et, FSStateVector& state) const
+    {
+        const FChebyshevCache* Cache = Find(et.AsSpiceDouble());
+        return Cache && Cache->State(body, et, state);
+    }
+}
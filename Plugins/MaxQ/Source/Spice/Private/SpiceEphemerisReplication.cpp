@@ -0,0 +1,370 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisReplication.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Server-fitted ephemerides, replicated to clients as Chebyshev
+//           blocks.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisReplication.cpp is part of the "Blueprints API".
+//
+// A received window is checked against hard limits (degree, number of
+// blocks, edges in order) before anything is allocated for it, since it
+// comes off the wire.  A window that fails the checks is dropped, and the
+// last good one is kept.
+//------------------------------------------------------------------------------
+
+#include "SpiceEphemerisReplication.h"
+#include "SpiceEphemerisCache.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceUtilities.h"
+#include "SpiceLog.h"
+#include "Algo/BinarySearch.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/GameStateBase.h"
+#include "Net/UnrealNetwork.h"
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // Limits on what's accepted off the wire
+    constexpr int32 MaxDegree = 63;
+    constexpr int32 MaxBlocks = 4096;
+
+    // A new window starts this fraction of a window behind the epoch
+    constexpr double Behind = 0.1;
+
+    // The clock is resent when it's off by more than this (ephemeris seconds,
+    // plus this much world time at the time scale)
+    constexpr double ClockTolerance = 1.e-3;
+    constexpr double ClockWorldTolerance = 1.e-2;
+
+    FORCEINLINE uint64 ZigZag(int64 Value)
+    {
+        return (uint64(Value) << 1) ^ uint64(Value >> 63);
+    }
+
+    FORCEINLINE int64 UnZigZag(uint64 Value)
+    {
+        return int64(Value >> 1) ^ -int64(Value & 1);
+    }
+}
+
+
+void FMaxQEphemerisWindow::Quantize()
+{
+    if (Quantum <= 0.)
+    {
+        return;
+    }
+
+    for (double& c : Coefficients)
+    {
+        c = FMath::RoundToDouble(c / Quantum) * Quantum;
+    }
+}
+
+
+bool FMaxQEphemerisWindow::Evaluate(double et, double (&r)[3], double (&v)[3]) const
+{
+    if (!Covers(et))
+    {
+        return false;
+    }
+
+    const int32 N = Degree + 1;
+    const int32 Block = FMath::Clamp(Algo::UpperBound(Edges, et) - 1, 0, Edges.Num() - 2);
+    const double Mid = 0.5 * (Edges[Block] + Edges[Block + 1]);
+    const double Radius = 0.5 * (Edges[Block + 1] - Edges[Block]);
+    const double x = FMath::Clamp((et - Mid) / Radius, -1., 1.);
+    const double* c = &Coefficients[Block * 3 * N];
+
+    double d[MaxDegree + 1];
+    for (int32 i = 0; i < 3; ++i)
+    {
+        Differentiate(c + i * N, d, N);
+        r[i] = Clenshaw(c + i * N, N, x);
+        v[i] = Clenshaw(d, N, x) / Radius;
+    }
+    return true;
+}
+
+
+bool FMaxQEphemerisWindow::Fit(
+    const FString& Target,
+    const FString& Observer,
+    const FString& Frame,
+    ES_AberrationCorrectionWithNewtonians AberrationCorrection,
+    double Start,
+    double Stop,
+    double ToleranceKm,
+    int32 FitDegree,
+    FString& ErrorMessage
+)
+{
+    MaxQ::Ephemeris::FChebyshevCacheSettings Settings;
+    Settings.Degree = FMath::Clamp(FitDegree, 1, 31);
+    // Half the tolerance for the fit, half for the quantization
+    Settings.ToleranceKm = 0.5 * ToleranceKm;
+    Settings.MaxBlockSeconds = Stop - Start;
+
+    MaxQ::Ephemeris::FChebyshevCache Cache;
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    if (!Cache.Build({ Target }, Observer, Frame, FSEphemerisTime(Start), FSEphemerisTime(Stop), Settings, AberrationCorrection, &ResultCode, &ErrorMessage)
+        || Cache.NumBlocks(0) > MaxBlocks)
+    {
+        if (ErrorMessage.IsEmpty())
+        {
+            ErrorMessage = FString::Printf(TEXT("%s needs more than %d blocks over the window"), *Target, MaxBlocks);
+        }
+        return false;
+    }
+
+    Edges.Reset();
+    Coefficients.Reset();
+    Degree = Cache.GetDegree();
+    Quantum = ToleranceKm / (Degree + 1);
+
+    for (int32 Block = 0; Block < Cache.NumBlocks(0); ++Block)
+    {
+        double Mid, Radius;
+        TArrayView<const double> BlockCoefficients;
+        Cache.GetBlock(0, Block, Mid, Radius, BlockCoefficients);
+
+        if (Block == 0)
+        {
+            Edges.Add(Mid - Radius);
+        }
+        Edges.Add(Mid + Radius);
+        Coefficients.Append(BlockCoefficients.GetData(), BlockCoefficients.Num());
+    }
+
+    // The server evaluates exactly what the clients will
+    Quantize();
+    return true;
+}
+
+
+bool FMaxQEphemerisWindow::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    Ar << Serial;
+
+    uint32 _Degree = Degree;
+    uint32 NumBlocks = IsEmpty() ? 0 : Edges.Num() - 1;
+    Ar.SerializeIntPacked(_Degree);
+    Ar.SerializeIntPacked(NumBlocks);
+
+    FMaxQEphemerisWindow Loaded;
+    FMaxQEphemerisWindow& Target = Ar.IsLoading() ? Loaded : *this;
+
+    if (Ar.IsLoading())
+    {
+        if (_Degree > MaxDegree || NumBlocks > MaxBlocks)
+        {
+            Ar.SetError();
+            bOutSuccess = false;
+            return true;
+        }
+
+        Loaded.Serial = Serial;
+        Loaded.Degree = _Degree;
+        Loaded.Edges.SetNumUninitialized(NumBlocks > 0 ? NumBlocks + 1 : 0);
+        Loaded.Coefficients.SetNumUninitialized(NumBlocks * 3 * (_Degree + 1));
+    }
+
+    if (NumBlocks > 0)
+    {
+        Ar << Target.Quantum;
+
+        // The edges in full (they're epochs), the coefficients in quanta
+        for (double& Edge : Target.Edges)
+        {
+            Ar << Edge;
+        }
+
+        for (double& c : Target.Coefficients)
+        {
+            uint64 Packed = Ar.IsSaving() ? ZigZag(FMath::RoundToInt64(c / Target.Quantum)) : 0;
+            Ar.SerializeIntPacked64(Packed);
+            if (Ar.IsLoading())
+            {
+                c = double(UnZigZag(Packed)) * Target.Quantum;
+            }
+        }
+    }
+
+    if (Ar.IsLoading())
+    {
+        bool bValid = !Ar.IsError() && (NumBlocks == 0 || Loaded.Quantum > 0.);
+        for (int32 i = 1; bValid && i < Loaded.Edges.Num(); ++i)
+        {
+            bValid = Loaded.Edges[i] > Loaded.Edges[i - 1];
+        }
+
+        if (!bValid)
+        {
+            bOutSuccess = false;
+            return true;
+        }
+
+        *this = MoveTemp(Loaded);
+    }
+
+    bOutSuccess = !Ar.IsError();
+    return true;
+}
+
+
+UMaxQEphemerisReplicationComponent::UMaxQEphemerisReplicationComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.TickGroup = TG_PrePhysics;
+    SetIsReplicatedByDefault(true);
+}
+
+
+void UMaxQEphemerisReplicationComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(UMaxQEphemerisReplicationComponent, Window);
+    DOREPLIFETIME(UMaxQEphemerisReplicationComponent, Clock);
+}
+
+
+double UMaxQEphemerisReplicationComponent::GetServerWorldTime() const
+{
+    const UWorld* World = GetWorld();
+    if (!World)
+    {
+        return 0.;
+    }
+
+    const AGameStateBase* GameState = World->GetGameState();
+    return GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+
+FSEphemerisTime UMaxQEphemerisReplicationComponent::GetEpoch() const
+{
+    return FSEphemerisTime(Clock.At(GetServerWorldTime()));
+}
+
+
+bool UMaxQEphemerisReplicationComponent::GetState(FSStateVector& State) const
+{
+    double r[3], v[3];
+    if (!Window.Evaluate(GetEpoch().AsSpiceDouble(), r, v))
+    {
+        return false;
+    }
+
+    State = FSStateVector(FSDistanceVector(r), FSVelocityVector(v));
+    return true;
+}
+
+
+void UMaxQEphemerisReplicationComponent::Invalidate()
+{
+    const int32 Serial = Window.Serial + 1;
+    Window = FMaxQEphemerisWindow();
+    Window.Serial = Serial;
+    FailedStart = 0.;
+    FailedStop = -1.;
+}
+
+
+void UMaxQEphemerisReplicationComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (GetOwnerRole() == ROLE_Authority)
+    {
+        Publish();
+    }
+
+    FSStateVector State;
+    USceneComponent* Root = GetOwner() ? GetOwner()->GetRootComponent() : nullptr;
+    if (bPlaceOwner && Root && GetState(State))
+    {
+        Root->SetRelativeLocation(State.r.Swizzle() * Scale, false, nullptr, ETeleportType::TeleportPhysics);
+    }
+}
+
+
+void UMaxQEphemerisReplicationComponent::Publish()
+{
+    const UWorld* World = GetWorld();
+    const UMaxQEphemerisSubsystem* Subsystem = World ? World->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr;
+    if (!Subsystem)
+    {
+        return;
+    }
+
+    // The clock, if the server's epoch has jumped (or the scale changed)
+    const double WorldTime = GetServerWorldTime();
+    const double et = Subsystem->Epoch.AsSpiceDouble();
+    const double Drift = FMath::Abs(Clock.At(WorldTime) - et);
+    if (Clock.TimeScale != Subsystem->TimeScale || Drift > ClockTolerance + ClockWorldTolerance * FMath::Abs(Subsystem->TimeScale))
+    {
+        Clock.Epoch = et;
+        Clock.WorldTime = WorldTime;
+        Clock.TimeScale = Subsystem->TimeScale;
+    }
+
+    // The window, if the epoch is running out of it
+    const double Span = FMath::Max(WindowSeconds.AsSeconds(), 1.);
+    const bool bForwards = Subsystem->TimeScale >= 0.;
+    if (!Window.Covers(et))
+    {
+        Fit(bForwards ? et - Behind * Span : et - Span, bForwards ? et + Span : et + Behind * Span);
+        return;
+    }
+
+    const double Left = bForwards ? Window.Edges.Last() - et : et - Window.Edges[0];
+    if (Subsystem->TimeScale != 0. && Left < RefillFraction * Span)
+    {
+        Fit(bForwards ? et - Behind * Span : et - Span, bForwards ? et + Span : et + Behind * Span);
+    }
+}
+
+
+void UMaxQEphemerisReplicationComponent::Fit(double Start, double Stop)
+{
+    if (Start < FailedStop && Stop > FailedStart)
+    {
+        // Overlaps one that failed (no coverage there, probably)
+        return;
+    }
+
+    FMaxQEphemerisWindow Fitted;
+    FString ErrorMessage;
+    if (!Fitted.Fit(Target, Observer, Frame, AberrationCorrection, Start, Stop, ToleranceKm, Degree, ErrorMessage))
+    {
+        FailedStart = Start;
+        FailedStop = Stop;
+        UE_LOG(LogSpice, Warning, TEXT("UMaxQEphemerisReplicationComponent %s: %s"), *GetName(), *ErrorMessage);
+        OnError.Broadcast(ErrorMessage);
+        return;
+    }
+
+    Fitted.Serial = Window.Serial + 1;
+    Window = MoveTemp(Fitted);
+    FailedStart = 0.;
+    FailedStop = -1.;
+}
@@ -0,0 +1,1634 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisSubsystem.cpp
+//
+// Implementation Comments
+//
+// Purpose:  One batched ephemeris pass per frame, for everything in the world.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisSubsystem.cpp is part of the "Blueprints API".
+//
+// Slots are assigned SPK groups first, then interpolated SPK subscriptions,
+// then SGP4, then two body, so each group writes one contiguous range of
+// States.  The native propagators write their own ranges from a worker, while
+// the game thread writes the SPK ranges, and the game thread waits for the
+// worker before scattering.
+//
+// The scheduler doesn't sort:  priorities go into power-of-two buckets, and
+// whole buckets are taken from the top until the next doesn't fit, then the
+// first slots of that one.  Anything passed over gets staler, so it moves up
+// a bucket each time its staleness doubles.  The cost per update is measured
+// over the whole pass (including waiting for the native worker) and the
+// scatter, wherever the pass ran, so the budget is what the work really costs.
+//
+// Async passes write the back buffer (Back) from the executor thread.  The
+// game thread only touches it in Update, after waiting for the pass, and in
+// Register and Unregister, which wait too:  so the tables the pass reads
+// (groups, slots, Due) never change under it.
+//
+// A group that fails part way through (a target without SPK coverage, say)
+// picks up again after the target that failed, so one bad subscription
+// doesn't blank out the rest of its group.  Components of failed slots keep
+// their last transform.
+//
+// The anchor is checked after propagation and before the scatter, so a
+// rebase and the moves it causes land in the same frame.
+//
+// Snapshots are filled from the front buffer after the scatter, so Origin is
+// the one this frame's placements used.  A pooled snapshot is reused only
+// when the pool holds the last reference to it:  nothing else can get one
+// from there, so nobody sees it change.  The render thread's snapshot is
+// only written by render commands, and only read on the render thread.
+//
+// The spatial index is built on the thread pool from a snapshot, which
+// nothing writes, so the build needs no lock and the pass never waits for it.
+// One build at a time:  if one's still running when the next is due, the
+// next waits for the frame after it's done.
+//
+// Previewed slots are evaluated first, in parallel, and are skipped by the
+// SPK groups and interpolation after them, so a group that's only partly
+// cached sends just the rest to SpkposMulti.  The slots point into
+// PreviewCaches, which only changes in BeginPreview and EndPreview:  both wait
+// for the pass in flight and rebuild the slots.
+//------------------------------------------------------------------------------
+
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceEphemeris.h"
+#include "SpiceExecutor.h"
+#include "SpiceSimulationClock.h"
+#include "SpiceMath.h"
+#include "SpiceUtilities.h"
+#include "Spice.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Algo/StableSort.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SceneComponent.h"
+#include "Components/DirectionalLightComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "RenderingThread.h"
+#include <atomic>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // Components per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+    // Snapshots kept for reuse (more are allocated while consumers hold them)
+    constexpr int32 MaxPooledSnapshots = 4;
+
+    // Rotations closer than this (FQuat::Equals) aren't written
+    constexpr double RotationTolerance = 1.e-9;
+
+    // Interpolated subscriptions' knot spacing never shrinks below this
+    // fraction of their Interval...
+    constexpr double MinIntervalFraction = 1. / 1024.;
+    // ...and grows back once the error estimate is under this fraction of
+    // Tolerance (doubling h multiplies the error by 16)
+    constexpr double GrowFraction = 1. / 32.;
+
+    // Bucket b holds priorities in [2^(b - 32), 2^(b - 31))
+    constexpr int32 NumBuckets = 64;
+    // Overdue slots' priorities are multiplied by this (2^20), above any
+    // that aren't
+    constexpr double OverdueBoost = 1048576.;
+    // Nothing is less significant than this, however far away
+    constexpr double MinSignificance = 1.e-3;
+    // Seconds a primitive counts as rendered for after its last frame
+    constexpr float RenderedTolerance = 0.2f;
+    // The measured cost per update's smoothing, and its floor (microseconds)
+    constexpr double CostSmoothing = 0.1;
+    constexpr double MinCost = 0.01;
+
+    // Cubic Hermite through (0, r0, v0) and (h, r1, v1), at t
+    void Hermite(const double(&s0)[6], const double(&s1)[6], double h, double t, double(&state)[6])
+    {
+        const double s = t / h, s2 = s * s, s3 = s2 * s;
+        const double h00 = 2. * s3 - 3. * s2 + 1., h10 = s3 - 2. * s2 + s, h01 = 3. * s2 - 2. * s3, h11 = s3 - s2;
+        const double d00 = 6. * s2 - 6. * s, d10 = 3. * s2 - 4. * s + 1., d01 = 6. * s - 6. * s2, d11 = 3. * s2 - 2. * s;
+        for (int32 k = 0; k < 3; ++k)
+        {
+            state[k] = h00 * s0[k] + h10 * h * s0[k + 3] + h01 * s1[k] + h11 * h * s1[k + 3];
+            state[k + 3] = (d00 * s0[k] + d01 * s1[k]) / h + d10 * s0[k + 3] + d11 * s1[k + 3];
+        }
+    }
+
+    // SPK subscriptions with the same key share a group (and a preview fit)
+    FString GroupKey(const FMaxQEphemerisSubscription& s)
+    {
+        return FString::Printf(TEXT("%s|%s|%d"), *s.Observer.ToUpper(), *s.Frame.ToUpper(), int32(s.AberrationCorrection));
+    }
+
+    // "MaxQ.Preview <start> <stop>", "MaxQ.Preview <0..1>", "MaxQ.Preview off"
+    void PreviewCommand(const TArray<FString>& Args, UWorld* World)
+    {
+        UMaxQEphemerisSubsystem* Subsystem = World ? World->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr;
+        if (!Subsystem)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ.Preview:  this world has no ephemeris subsystem"));
+            return;
+        }
+
+        if (Args.Num() == 1 && Args[0].Equals(TEXT("off"), ESearchCase::IgnoreCase))
+        {
+            Subsystem->EndPreview();
+        }
+        else if (Args.Num() == 1 && Args[0].IsNumeric())
+        {
+            if (!Subsystem->IsPreviewing())
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ.Preview:  no preview (\"MaxQ.Preview <start> <stop>\" begins one)"));
+                return;
+            }
+            Subsystem->SetPreviewTime(FCString::Atod(*Args[0]));
+        }
+        else if (Args.Num() == 2)
+        {
+            FSEphemerisTime Span[2];
+            for (int32 i = 0; i < 2; ++i)
+            {
+                ES_ResultCode ResultCode = ES_ResultCode::Success;
+                FString ErrorMessage;
+                USpice::str2et(ResultCode, ErrorMessage, Span[i], Args[i]);
+                if (ResultCode != ES_ResultCode::Success)
+                {
+                    UE_LOG(LogSpice, Warning, TEXT("MaxQ.Preview:  %s"), *ErrorMessage);
+                    return;
+                }
+            }
+
+            if (Subsystem->BeginPreview(Span[0], Span[1]))
+            {
+                UE_LOG(LogSpice, Log, TEXT("MaxQ.Preview:  %d subscriptions, %s to %s"), Subsystem->Num(), *Args[0], *Args[1]);
+            }
+            else
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ.Preview:  the fits failed (see OnError)"));
+            }
+        }
+        else
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ.Preview <start> <stop> | <0..1> | off"));
+        }
+    }
+
+    FAutoConsoleCommandWithWorldAndArgs PreviewConsoleCommand(
+        TEXT("MaxQ.Preview"),
+        TEXT("Previews the world's ephemeris subsystem (editor worlds too) from fits over a span:  \"MaxQ.Preview <start> <stop>\" (str2et strings without spaces) fits it, \"MaxQ.Preview <0..1>\" scrubs, \"MaxQ.Preview off\" ends it."),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PreviewCommand)
+    );
+
+    int32 AttachDepth(const USceneComponent* Component)
+    {
+        int32 Depth = 0;
+        for (const USceneComponent* Parent = Component->GetAttachParent(); Parent; Parent = Parent->GetAttachParent())
+        {
+            ++Depth;
+        }
+        return Depth;
+    }
+}
+
+
+void FMaxQEphemerisTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+    // Editor worlds tick viewports only:  that's the preview's tick
+    if (Subsystem && (TickType != LEVELTICK_ViewportsOnly || Subsystem->IsPreviewing()))
+    {
+        Subsystem->Update(DeltaTime);
+    }
+}
+
+
+FString FMaxQEphemerisTickFunction::DiagnosticMessage()
+{
+    return TEXT("FMaxQEphemerisTickFunction");
+}
+
+
+FName FMaxQEphemerisTickFunction::DiagnosticContext(bool bDetailed)
+{
+    return FName(TEXT("MaxQEphemerisSubsystem"));
+}
+
+
+FMaxQEphemerisHandle UMaxQEphemerisSubsystem::Register(const FMaxQEphemerisSubscription& Subscription, USceneComponent* Component, const FMaxQEphemerisPlacement& Placement)
+{
+    check(IsInGameThread());
+    WaitForPass();
+
+    FEntry Entry;
+    Entry.Subscription = Subscription;
+    Entry.Component = Component;
+    Entry.Placement = Placement;
+
+    if (Subscription.Propagation == EMaxQPropagation::Spk && Subscription.Interval.AsSeconds() > 0.)
+    {
+        Entry.Decimation.Target = FSpiceName(Subscription.Target);
+        Entry.Decimation.Observer = FSpiceName(Subscription.Observer);
+        Entry.Decimation.Frame = FSpiceName(Subscription.Frame);
+    }
+
+    if (Subscription.Propagation == EMaxQPropagation::SGP4)
+    {
+        FSTLEGeophysicalConstants geophs = Subscription.GeophysicalConstants;
+        if (geophs.geophs.Num() != 8)
+        {
+            USpice::getgeophs(geophs, TEXT("EARTH"));
+        }
+
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        if (!Entry.Propagator.Init(geophs, Subscription.TwoLineElements, &ResultCode, &ErrorMessage))
+        {
+            // Still registered:  it just never has a state
+            OnError.Broadcast(ErrorMessage);
+        }
+    }
+
+    FMaxQEphemerisHandle Handle;
+    Handle.Id = NextId++;
+    Subscriptions.Add(Handle.Id, MoveTemp(Entry));
+    bDirty = true;
+
+    return Handle;
+}
+
+
+void UMaxQEphemerisSubsystem::Unregister(FMaxQEphemerisHandle& Handle)
+{
+    check(IsInGameThread());
+    WaitForPass();
+
+    if (Handle.IsValid() && Subscriptions.Remove(Handle.Id) > 0)
+    {
+        bDirty = true;
+    }
+    Handle.Reset();
+}
+
+
+int32 FMaxQEphemerisSnapshot::Find(const FMaxQEphemerisHandle& Handle) const
+{
+    const int32* Slot = Slots.IsValid() ? Slots->Find(Handle.Id) : nullptr;
+    return Slot && Valid.IsValidIndex(*Slot) ? *Slot : INDEX_NONE;
+}
+
+
+bool FMaxQEphemerisSnapshot::GetPosition(const FMaxQEphemerisHandle& Handle, FSDistanceVector& Position) const
+{
+    const int32 Slot = Find(Handle);
+    if (Slot == INDEX_NONE || !Valid[Slot])
+    {
+        return false;
+    }
+
+    Position = FSDistanceVector(X[Slot], Y[Slot], Z[Slot]);
+    return true;
+}
+
+
+FMaxQEphemerisSnapshotPtr FMaxQEphemerisSnapshotChannel::GetRenderThreadSnapshot() const
+{
+    check(IsInRenderingThread());
+    return RenderThreadSnapshot;
+}
+
+
+bool UMaxQEphemerisSubsystem::GetState(const FMaxQEphemerisHandle& Handle, FSStateVector& State) const
+{
+    const FEntry* Entry = Subscriptions.Find(Handle.Id);
+    if (!Entry || !Valid.IsValidIndex(Entry->Slot) || !Valid[Entry->Slot])
+    {
+        return false;
+    }
+
+    State = States[Entry->Slot];
+    return true;
+}
+
+
+bool UMaxQEphemerisSubsystem::GetOrientation(const FMaxQEphemerisHandle& Handle, FSRotationMatrix& Orientation) const
+{
+    const FEntry* Entry = Subscriptions.Find(Handle.Id);
+    if (!Entry || !Valid.IsValidIndex(Entry->Slot) || !Valid[Entry->Slot])
+    {
+        return false;
+    }
+
+    Orientation = Rotations[Entry->Slot];
+    return true;
+}
+
+
+void UMaxQEphemerisSubsystem::SetTickGroup(ETickingGroup NewTickGroup)
+{
+    TickGroup = NewTickGroup;
+
+    if (TickFunction.IsTickFunctionRegistered())
+    {
+        ULevel* Level = GetWorld() ? GetWorld()->PersistentLevel : nullptr;
+        TickFunction.UnRegisterTickFunction();
+        TickFunction.TickGroup = TickGroup;
+        TickFunction.RegisterTickFunction(Level);
+    }
+    else
+    {
+        TickFunction.TickGroup = TickGroup;
+    }
+}
+
+
+void UMaxQEphemerisSubsystem::SetLightSource(const FString& Source, const FString& Observer, const FString& Frame, ES_AberrationCorrectionWithNewtonians AberrationCorrection, UDirectionalLightComponent* Light)
+{
+    ClearLightSource();
+
+    FMaxQEphemerisSubscription Subscription;
+    Subscription.Propagation = EMaxQPropagation::Spk;
+    Subscription.Target = Source;
+    Subscription.Observer = Observer;
+    Subscription.Frame = Frame;
+    Subscription.AberrationCorrection = AberrationCorrection;
+
+    LightSource = Register(Subscription, nullptr, FMaxQEphemerisPlacement());
+    DirectionalLight = Light;
+}
+
+
+void UMaxQEphemerisSubsystem::ClearLightSource()
+{
+    Unregister(LightSource);
+    DirectionalLight.Reset();
+}
+
+
+bool UMaxQEphemerisSubsystem::GetLightSourcePosition(FSDistanceVector& Position) const
+{
+    FSStateVector State;
+    if (!GetState(LightSource, State))
+    {
+        return false;
+    }
+
+    Position = State.r;
+    return true;
+}
+
+
+bool UMaxQEphemerisSubsystem::GetLightDirection(const FMaxQEphemerisHandle& Handle, FVector& Direction, FSDistance& Distance) const
+{
+    FSDistanceVector Source;
+    if (!GetLightSourcePosition(Source))
+    {
+        return false;
+    }
+
+    FSDistanceVector Object;
+    if (Handle.IsValid())
+    {
+        const FEntry* Entry = Subscriptions.Find(Handle.Id);
+        const FMaxQEphemerisSubscription& Light = Subscriptions[LightSource.Id].Subscription;
+        FSStateVector State;
+        if (!Entry
+            || Entry->Subscription.Propagation != EMaxQPropagation::Spk
+            || !Entry->Subscription.Observer.Equals(Light.Observer, ESearchCase::IgnoreCase)
+            || !Entry->Subscription.Frame.Equals(Light.Frame, ESearchCase::IgnoreCase)
+            || !GetState(Handle, State))
+        {
+            return false;
+        }
+        Object = State.r;
+    }
+
+    const FSDistanceVector Path = Object - Source;
+    Distance = Path.Magnitude();
+    Direction = Path.Swizzle().GetSafeNormal();
+    return true;
+}
+
+
+void UMaxQEphemerisSubsystem::AimLight()
+{
+    UDirectionalLightComponent* Light = DirectionalLight.Get();
+    FVector Direction;
+    FSDistance Distance;
+    if (Light && GetLightDirection(FMaxQEphemerisHandle(), Direction, Distance) && !Direction.IsNearlyZero())
+    {
+        const FQuat Rotation = Direction.ToOrientationQuat();
+        if (!Rotation.Equals(Light->GetComponentQuat(), RotationTolerance))
+        {
+            Light->SetWorldRotation(Rotation);
+        }
+    }
+}
+
+
+bool UMaxQEphemerisSubsystem::BeginPreview(const FSEphemerisTime& Start, const FSEphemerisTime& Stop)
+{
+    check(IsInGameThread());
+    WaitForPass();
+
+    // The SPK subscriptions' targets, by group
+    TMap<FString, TArray<FString>> GroupTargets;
+    TMap<FString, const FMaxQEphemerisSubscription*> Groups;
+    for (const auto& [Id, Entry] : Subscriptions)
+    {
+        const FMaxQEphemerisSubscription& s = Entry.Subscription;
+        if (s.Propagation == EMaxQPropagation::Spk)
+        {
+            const FString Key = GroupKey(s);
+            Groups.Add(Key, &s);
+            GroupTargets.FindOrAdd(Key).AddUnique(s.Target);
+        }
+    }
+
+    MaxQ::Ephemeris::FChebyshevCacheSettings Settings;
+    Settings.ToleranceKm = PreviewTolerance.km;
+
+    TMap<FString, MaxQ::Ephemeris::FChebyshevCache> Caches;
+    for (const auto& [Key, Targets] : GroupTargets)
+    {
+        const FMaxQEphemerisSubscription& s = *Groups[Key];
+
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        if (!Caches.Add(Key).Build(Targets, s.Observer, s.Frame, Start, Stop, Settings, s.AberrationCorrection, &ResultCode, &ErrorMessage))
+        {
+            OnError.Broadcast(ErrorMessage);
+            return false;
+        }
+    }
+
+    PreviewCaches = MoveTemp(Caches);
+    PreviewStart = Start;
+    PreviewStop = Stop;
+    bPreviewing = true;
+    bDirty = true;
+
+    if (Epoch.AsSpiceDouble() < Start.AsSpiceDouble() || Epoch.AsSpiceDouble() > Stop.AsSpiceDouble())
+    {
+        Epoch = Start;
+    }
+
+    // Editor worlds don't begin play
+    if (UWorld* World = GetWorld(); World && !World->IsGameWorld())
+    {
+        RegisterTickFunction(*World);
+    }
+    return true;
+}
+
+
+void UMaxQEphemerisSubsystem::EndPreview()
+{
+    check(IsInGameThread());
+    WaitForPass();
+
+    PreviewCaches.Empty();
+    bPreviewing = false;
+    bDirty = true;
+
+    const UWorld* World = GetWorld();
+    if (World && !World->IsGameWorld() && TickFunction.IsTickFunctionRegistered())
+    {
+        TickFunction.UnRegisterTickFunction();
+    }
+}
+
+
+void UMaxQEphemerisSubsystem::SetPreviewTime(double Alpha)
+{
+    if (bPreviewing)
+    {
+        const double Span = PreviewStop.AsSpiceDouble() - PreviewStart.AsSpiceDouble();
+        Epoch = PreviewStart + FSEphemerisPeriod(FMath::Clamp(Alpha, 0., 1.) * Span);
+    }
+}
+
+
+void UMaxQEphemerisSubsystem::SetOriginAnchor(USceneComponent* Anchor)
+{
+    OriginAnchor = Anchor;
+}
+
+
+void UMaxQEphemerisSubsystem::SetSignificanceViewer(USceneComponent* Viewer)
+{
+    SignificanceViewer = Viewer;
+}
+
+
+void UMaxQEphemerisSubsystem::Rebase(const FVector& Location)
+{
+    Origin = FromWorld(Location);
+    bRebased = true;
+
+    if (USceneComponent* Anchor = OriginAnchor.Get())
+    {
+        if (AActor* Owner = Anchor->GetOwner())
+        {
+            Owner->SetActorLocation(Owner->GetActorLocation() - Location, false, nullptr, ETeleportType::TeleportPhysics);
+        }
+        else
+        {
+            Anchor->SetWorldLocation(Anchor->GetComponentLocation() - Location, false, nullptr, ETeleportType::TeleportPhysics);
+        }
+    }
+
+    OnOriginRebased.Broadcast(Location);
+}
+
+
+FVector UMaxQEphemerisSubsystem::ToWorld(const FSDistanceVector& Position) const
+{
+    return (Position - Origin).Swizzle() * Scale;
+}
+
+
+FSDistanceVector UMaxQEphemerisSubsystem::FromWorld(const FVector& Location) const
+{
+    return Origin + FSDistanceVector::Swizzle(Scale != 0. ? Location / Scale : FVector::ZeroVector);
+}
+
+
+void UMaxQEphemerisSubsystem::FollowAnchor()
+{
+    const USceneComponent* Anchor = OriginAnchor.Get();
+    if (!Anchor || RebaseDistance <= 0.)
+    {
+        return;
+    }
+
+    const FVector Location = Anchor->GetComponentLocation();
+    if (Location.SizeSquared() > FMath::Square(RebaseDistance))
+    {
+        Rebase(Location);
+    }
+}
+
+
+bool UMaxQEphemerisSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+#if WITH_EDITOR
+    // For the preview
+    if (WorldType == EWorldType::Editor)
+    {
+        return true;
+    }
+#endif
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+
+void UMaxQEphemerisSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    RegisterTickFunction(InWorld);
+}
+
+
+void UMaxQEphemerisSubsystem::RegisterTickFunction(UWorld& InWorld)
+{
+    if (TickFunction.IsTickFunctionRegistered())
+    {
+        return;
+    }
+
+    TickFunction.Subsystem = this;
+    TickFunction.bCanEverTick = true;
+    TickFunction.bStartWithTickEnabled = true;
+    TickFunction.bTickEvenWhenPaused = false;
+    TickFunction.TickGroup = TickGroup;
+    TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+
+    // After the clock's step, whichever subsystem began play first
+    if (UMaxQSimulationClockSubsystem* SimulationClock = InWorld.GetSubsystem<UMaxQSimulationClockSubsystem>())
+    {
+        TickFunction.AddPrerequisite(SimulationClock, SimulationClock->GetTickFunction());
+    }
+}
+
+
+void UMaxQEphemerisSubsystem::Deinitialize()
+{
+    if (TickFunction.IsTickFunctionRegistered())
+    {
+        TickFunction.UnRegisterTickFunction();
+    }
+    TickFunction.Subsystem = nullptr;
+    WaitForPass();
+    bAhead = false;
+
+    Subscriptions.Empty();
+    LightSource.Reset();
+    DirectionalLight.Reset();
+    PreviewCaches.Empty();
+    bPreviewing = false;
+    bDirty = true;
+    Rebuild();
+
+    if (SpatialIndexInFlight.IsValid())
+    {
+        SpatialIndexInFlight.Wait();
+        SpatialIndexInFlight.Reset();
+    }
+    SpatialIndex.Reset();
+
+    Snapshot.Reset();
+    SnapshotPool.Empty();
+    ENQUEUE_RENDER_COMMAND(MaxQClearEphemerisSnapshot)([Channel = SnapshotChannel](FRHICommandListImmediate&)
+    {
+        Channel->RenderThreadSnapshot.Reset();
+    });
+
+    Super::Deinitialize();
+}
+
+
+void UMaxQEphemerisSubsystem::Update(float DeltaTime)
+{
+    check(IsInGameThread());
+
+    // Async, the epoch advances by the last frame's time, so it was known
+    // when the last frame started this frame's pass
+    Clock += DeltaTime;
+    const UMaxQSimulationClockSubsystem* SimulationClock = bFollowSimulationClock && GetWorld() ? GetWorld()->GetSubsystem<UMaxQSimulationClockSubsystem>() : nullptr;
+    if (SimulationClock)
+    {
+        Epoch = SimulationClock->GetStepEpoch();
+    }
+    else if (TimeScale != 0.)
+    {
+        Epoch = Epoch + FSEphemerisPeriod((bAsync ? LastDeltaTime : DeltaTime) * TimeScale);
+    }
+    LastDeltaTime = DeltaTime;
+
+    // This frame's pass, if it was started last frame (and is still for this
+    // epoch)
+    WaitForPass();
+    const bool bOverlapped = bAhead && !bDirty && AheadEpoch.AsSpiceDouble() == Epoch.AsSpiceDouble();
+    bAhead = false;
+
+    if (bDirty)
+    {
+        Rebuild();
+    }
+
+    PassError.Empty();
+
+    if (States.Num() > 0)
+    {
+        if (!bOverlapped)
+        {
+            Schedule();
+            Propagate(Epoch);
+        }
+        Present();
+
+        const double Start = FPlatformTime::Seconds();
+        FollowAnchor();
+        Scatter();
+        AimLight();
+
+        if (NumDue > 0)
+        {
+            const double Cost = (Back.Seconds + FPlatformTime::Seconds() - Start) * 1.e6 / NumDue;
+            CostPerUpdate += CostSmoothing * (Cost - CostPerUpdate);
+        }
+
+        // The next frame's pass, now that its epoch is known
+        if (bAsync)
+        {
+            Schedule();
+            // Following the clock, a step usually spans several frames
+            AheadEpoch = !SimulationClock && TimeScale != 0. ? Epoch + FSEphemerisPeriod(DeltaTime * TimeScale) : Epoch;
+            bAhead = true;
+            InFlight = FSpiceExecutor::Get().Enqueue([this, et = AheadEpoch]() { Propagate(et); });
+        }
+    }
+
+    if (bPublishSnapshots)
+    {
+        Publish();
+    }
+    UpdateSpatialIndex();
+
+    if (!PassError.IsEmpty())
+    {
+        OnError.Broadcast(PassError);
+    }
+    OnUpdated.Broadcast();
+}
+
+
+void UMaxQEphemerisSubsystem::Publish()
+{
+    // One nothing else holds any more, if there is one
+    TSharedPtr<FMaxQEphemerisSnapshot, ESPMode::ThreadSafe> Next;
+    for (const TSharedPtr<FMaxQEphemerisSnapshot, ESPMode::ThreadSafe>& Pooled : SnapshotPool)
+    {
+        if (Pooled.GetSharedReferenceCount() == 1)
+        {
+            Next = Pooled;
+            break;
+        }
+    }
+    if (!Next.IsValid())
+    {
+        Next = MakeShared<FMaxQEphemerisSnapshot, ESPMode::ThreadSafe>();
+        if (SnapshotPool.Num() < MaxPooledSnapshots)
+        {
+            SnapshotPool.Add(Next);
+        }
+    }
+
+    FMaxQEphemerisSnapshot& s = *Next;
+    s.Epoch = Epoch;
+    s.Frame = GFrameCounter;
+    s.Origin = Origin;
+    s.Scale = Scale;
+    s.Slots = SnapshotSlots;
+
+    const int32 NumSlots = States.Num();
+    s.X.SetNumUninitialized(NumSlots, false);
+    s.Y.SetNumUninitialized(NumSlots, false);
+    s.Z.SetNumUninitialized(NumSlots, false);
+    s.Valid.SetNumUninitialized(NumSlots, false);
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        const FSDistanceVector& r = States[Slot].r;
+        s.X[Slot] = r.x.km;
+        s.Y[Slot] = r.y.km;
+        s.Z[Slot] = r.z.km;
+        s.Valid[Slot] = Valid[Slot] ? 1 : 0;
+    }
+    s.Orientations = Quats;
+
+    Snapshot = Next;
+
+    ENQUEUE_RENDER_COMMAND(MaxQPublishEphemerisSnapshot)([Channel = SnapshotChannel, Published = Snapshot](FRHICommandListImmediate&)
+    {
+        Channel->RenderThreadSnapshot = Published;
+    });
+}
+
+
+FMaxQEphemerisHandle FMaxQEphemerisSpatialIndex::GetHandle(int32 Slot) const
+{
+    FMaxQEphemerisHandle Handle;
+    if (HandleIds.IsValidIndex(Slot))
+    {
+        Handle.Id = HandleIds[Slot];
+    }
+    return Handle;
+}
+
+
+void UMaxQEphemerisSubsystem::UpdateSpatialIndex()
+{
+    if (SpatialIndexInFlight.IsValid() && SpatialIndexInFlight.IsReady())
+    {
+        SpatialIndex = SpatialIndexInFlight.Get();
+        SpatialIndexInFlight.Reset();
+    }
+
+    if (SpatialIndexInterval <= 0)
+    {
+        SpatialIndex.Reset();
+        FramesSinceSpatialIndex = 0;
+        return;
+    }
+
+    ++FramesSinceSpatialIndex;
+    if (!Snapshot.IsValid() || SpatialIndexInFlight.IsValid() || (SpatialIndex.IsValid() && FramesSinceSpatialIndex < SpatialIndexInterval))
+    {
+        return;
+    }
+    FramesSinceSpatialIndex = 0;
+
+    SpatialIndexInFlight = Async(EAsyncExecution::ThreadPool, [Published = Snapshot]() -> FMaxQEphemerisSpatialIndexPtr
+    {
+        TSharedPtr<FMaxQEphemerisSpatialIndex, ESPMode::ThreadSafe> Built = MakeShared<FMaxQEphemerisSpatialIndex, ESPMode::ThreadSafe>();
+        Built->Snapshot = Published;
+        Built->Index.Build(Published->Positions(), Published->Valid);
+
+        Built->HandleIds.Init(INDEX_NONE, Published->Num());
+        if (Published->Slots.IsValid())
+        {
+            for (const TPair<int32, int32>& Slot : *Published->Slots)
+            {
+                if (Built->HandleIds.IsValidIndex(Slot.Value))
+                {
+                    Built->HandleIds[Slot.Value] = Slot.Key;
+                }
+            }
+        }
+        return Built;
+    });
+}
+
+
+bool UMaxQEphemerisSubsystem::PickRay(const FVector& WorldOrigin, const FVector& WorldDirection, double AngleTolerance, FMaxQEphemerisHandle& Handle, FSDistance& Distance) const
+{
+    Handle.Reset();
+    if (!SpatialIndex.IsValid())
+    {
+        return false;
+    }
+
+    FSRay Ray;
+    Ray.point = FromWorld(WorldOrigin);
+    Ray.direction = FSDimensionlessVector::Swizzle(WorldDirection);
+
+    MaxQ::Math::FSpatialHit Hit;
+    if (!SpatialIndex->Index.Raycast(Ray, 0., AngleTolerance, Hit))
+    {
+        return false;
+    }
+
+    Handle = SpatialIndex->GetHandle(Hit.Index);
+    Distance = FSDistance(Hit.Distance);
+    return Handle.IsValid();
+}
+
+
+bool UMaxQEphemerisSubsystem::FindWithin(const FSDistanceVector& Center, const FSDistance& Radius, TArray<FMaxQEphemerisHandle>& Handles) const
+{
+    Handles.Reset();
+    if (!SpatialIndex.IsValid())
+    {
+        return false;
+    }
+
+    TArray<MaxQ::Math::FSpatialHit> Hits;
+    SpatialIndex->Index.Within(Center, Radius.km, Hits);
+    for (const MaxQ::Math::FSpatialHit& Hit : Hits)
+    {
+        Handles.Add(SpatialIndex->GetHandle(Hit.Index));
+    }
+    return true;
+}
+
+
+bool UMaxQEphemerisSubsystem::FindNearest(const FSDistanceVector& Center, int32 Count, TArray<FMaxQEphemerisHandle>& Handles) const
+{
+    Handles.Reset();
+    if (!SpatialIndex.IsValid())
+    {
+        return false;
+    }
+
+    TArray<MaxQ::Math::FSpatialHit> Hits;
+    SpatialIndex->Index.Nearest(Center, Count, Hits);
+    for (const MaxQ::Math::FSpatialHit& Hit : Hits)
+    {
+        Handles.Add(SpatialIndex->GetHandle(Hit.Index));
+    }
+    return true;
+}
+
+
+void UMaxQEphemerisSubsystem::Rebuild()
+{
+    MAXQ_LLM_SCOPE();
+
+    bDirty = false;
+
+    SpkGroups.Empty();
+    Interpolated.Empty();
+    PreviewSlots.Empty();
+    Orientations.Empty();
+    Components.Empty();
+    Placements.Empty();
+    ScatterOrder.Empty();
+
+    // Group the SPK subscriptions
+    TMap<FString, int32> GroupIndex;
+    TArray<FEntry*> SGP4Entries, TwoBodyEntries, InterpolatedEntries;
+    TArray<TArray<FEntry*>> GroupEntries;
+
+    for (auto& [Id, Entry] : Subscriptions)
+    {
+        const FMaxQEphemerisSubscription& s = Entry.Subscription;
+        switch (s.Propagation)
+        {
+        case EMaxQPropagation::SGP4:
+            SGP4Entries.Add(&Entry);
+            break;
+        case EMaxQPropagation::TwoBody:
+            TwoBodyEntries.Add(&Entry);
+            break;
+        default:
+        {
+            if (s.Interval.AsSeconds() > 0.)
+            {
+                // Not batched:  each has its own knots
+                InterpolatedEntries.Add(&Entry);
+                break;
+            }
+
+            const FString Key = GroupKey(s);
+            int32* Index = GroupIndex.Find(Key);
+            if (!Index)
+            {
+                Index = &GroupIndex.Add(Key, SpkGroups.Num());
+
+                FSpkGroup& Group = SpkGroups.AddDefaulted_GetRef();
+                Group.Observer = s.Observer;
+                Group.Frame = s.Frame;
+                Group.AberrationCorrection = s.AberrationCorrection;
+                GroupEntries.AddDefaulted();
+            }
+            SpkGroups[*Index].bVelocity |= s.bVelocity;
+            GroupEntries[*Index].Add(&Entry);
+        }
+        }
+    }
+
+    // Assign the slots, group by group
+    int32 NumSlots = 0;
+    auto AddSlot = [&](FEntry& Entry)
+    {
+        Entry.Slot = NumSlots++;
+        Components.Add(Entry.Component);
+        Placements.Add(Entry.Placement);
+
+        const FMaxQEphemerisSubscription& s = Entry.Subscription;
+        if (!s.OrientationFrame.IsEmpty())
+        {
+            Orientations.Add({ Entry.Slot, s.OrientationFrame, s.Frame });
+        }
+
+        if (s.Propagation == EMaxQPropagation::Spk && PreviewCaches.Num() > 0)
+        {
+            const MaxQ::Ephemeris::FChebyshevCache* Cache = PreviewCaches.Find(GroupKey(s));
+            const int32 Body = Cache ? Cache->FindBody(s.Target) : INDEX_NONE;
+            if (Body != INDEX_NONE)
+            {
+                PreviewSlots.Add({ Entry.Slot, Cache, Body });
+            }
+        }
+    };
+
+    for (int32 g = 0; g < SpkGroups.Num(); ++g)
+    {
+        SpkGroups[g].Begin = NumSlots;
+        for (FEntry* Entry : GroupEntries[g])
+        {
+            SpkGroups[g].Targets.Add(Entry->Subscription.Target);
+            AddSlot(*Entry);
+        }
+    }
+
+    for (FEntry* Entry : InterpolatedEntries)
+    {
+        Interpolated.Add(Entry);
+        AddSlot(*Entry);
+    }
+
+    SGP4Begin = NumSlots;
+    TArray<MaxQ::Orbits::FSGP4Propagator> Catalog;
+    Catalog.Reserve(SGP4Entries.Num());
+    for (FEntry* Entry : SGP4Entries)
+    {
+        Catalog.Add(Entry->Propagator);
+        AddSlot(*Entry);
+    }
+    SGP4.Build(Catalog);
+
+    TwoBodyBegin = NumSlots;
+    TArray<FSConicElements> Conics;
+    Conics.Reserve(TwoBodyEntries.Num());
+    for (FEntry* Entry : TwoBodyEntries)
+    {
+        Conics.Add(Entry->Subscription.ConicElements);
+        AddSlot(*Entry);
+    }
+    TwoBody.Build(Conics);
+
+    States.SetNum(NumSlots);
+    Rotations.Init(FSRotationMatrix(), NumSlots);
+    Quats.Init(FQuat::Identity, NumSlots);
+    Valid.Init(false, NumSlots);
+    Back.States.SetNum(NumSlots);
+    Back.Rotations.Init(FSRotationMatrix(), NumSlots);
+    Back.Quats.Init(FQuat::Identity, NumSlots);
+    Back.Valid.Init(false, NumSlots);
+    Oriented.Init(false, NumSlots);
+    Previewed.Init(0, NumSlots);
+    for (const FPreviewSlot& Preview : PreviewSlots)
+    {
+        Previewed[Preview.Slot] = 1;
+    }
+    // Never updated counts as overdue
+    LastUpdated.Init(Clock - FMath::Max(MaxStaleness, 1.), NumSlots);
+    Buckets.SetNumZeroed(NumSlots);
+    Due.Init(1, NumSlots);
+    NumDue = NumSlots;
+    for (const FOrientation& Orientation : Orientations)
+    {
+        Oriented[Orientation.Slot] = true;
+    }
+
+    // Parents before children
+    TArray<TPair<int32, int32>> Depths;
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        if (const USceneComponent* Component = Components[Slot].Get())
+        {
+            Depths.Add({ AttachDepth(Component), Slot });
+        }
+    }
+    Algo::StableSortBy(Depths, [](const TPair<int32, int32>& Depth) { return Depth.Key; });
+
+    ScatterOrder.Reserve(Depths.Num());
+    for (const TPair<int32, int32>& Depth : Depths)
+    {
+        ScatterOrder.Add(Depth.Value);
+    }
+
+    // Nothing's been written yet, so the first pass writes everything
+    WrittenLocations.Init(FVector(TNumericLimits<double>::Max()), ScatterOrder.Num());
+    WrittenRotations.Init(FQuat::Identity, ScatterOrder.Num());
+    PendingLocations.SetNum(ScatterOrder.Num());
+    PendingRotations.SetNum(ScatterOrder.Num());
+    Pending.SetNumZeroed(ScatterOrder.Num());
+
+    // Snapshots already published keep the map they were published with
+    TSharedPtr<TMap<int32, int32>, ESPMode::ThreadSafe> Slots = MakeShared<TMap<int32, int32>, ESPMode::ThreadSafe>();
+    Slots->Reserve(Subscriptions.Num());
+    for (const auto& [Id, Entry] : Subscriptions)
+    {
+        Slots->Add(Id, Entry.Slot);
+    }
+    SnapshotSlots = Slots;
+}
+
+
+void UMaxQEphemerisSubsystem::Schedule()
+{
+    const int32 NumSlots = States.Num();
+    if (UpdateBudget <= 0.)
+    {
+        Due.Init(1, NumSlots);
+        NumDue = NumSlots;
+        return;
+    }
+
+    FVector ViewLocation;
+    const bool bViewer = GetViewLocation(ViewLocation);
+
+    // Every slot's priority, in parallel...
+    ParallelFor((NumSlots + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+    {
+        const int32 End = FMath::Min((Chunk + 1) * ChunkSize, NumSlots);
+        for (int32 Slot = Chunk * ChunkSize; Slot < End; ++Slot)
+        {
+            double Significance = 1.;
+
+            const FMaxQEphemerisPlacement& Placement = Placements[Slot];
+            const USceneComponent* Component = Components[Slot].Get();
+            if (Component && Placement.Radius.km > 0.)
+            {
+                const UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component);
+                const AActor* Owner = Component->GetOwner();
+                const bool bRendered = Primitive ? Primitive->WasRecentlyRendered(RenderedTolerance) : Owner && Owner->WasRecentlyRendered(RenderedTolerance);
+
+                if (!bRendered)
+                {
+                    Significance = HiddenSignificance;
+                }
+                else if (bViewer)
+                {
+                    const double Radius = Placement.Radius.km * (Placement.ScalePolicy == EMaxQScalePolicy::Subsystem ? Scale : Placement.Scale);
+                    const double Distance = FVector::Distance(Component->GetComponentLocation(), ViewLocation);
+                    Significance = Distance > Radius ? Radius / (Distance * SignificantAngle) : 1.;
+                }
+                Significance = FMath::Clamp(Significance, MinSignificance, 1.);
+            }
+
+            const double Staleness = Clock - LastUpdated[Slot];
+            double Priority = Significance * Staleness;
+            if (Staleness >= MaxStaleness)
+            {
+                Priority *= OverdueBoost;
+            }
+            Buckets[Slot] = Priority > 0. ? uint8(FMath::Clamp(FMath::FloorToInt32(FMath::Log2(Priority)) + 32, 0, NumBuckets - 1)) : 0;
+        }
+    }, NumSlots <= ChunkSize);
+
+    // ...then as many as the budget buys, best first
+    const int32 Budgeted = FMath::Max(1, int32(FMath::Min(UpdateBudget / FMath::Max(CostPerUpdate, MinCost), double(NumSlots))));
+
+    int32 Counts[NumBuckets] = {};
+    for (uint8 Bucket : Buckets)
+    {
+        ++Counts[Bucket];
+    }
+
+    // Whole buckets from the top...
+    int32 Threshold = NumBuckets;
+    int32 Remaining = Budgeted;
+    while (Threshold > 0 && Counts[Threshold - 1] <= Remaining)
+    {
+        Remaining -= Counts[--Threshold];
+    }
+
+    // ...and the first Remaining of the next.  The light source is lit every
+    // frame, whatever it costs.
+    const FEntry* Light = Subscriptions.Find(LightSource.Id);
+    const int32 LightSlot = Light ? Light->Slot : INDEX_NONE;
+    NumDue = 0;
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        const bool bDue = Buckets[Slot] >= Threshold || (Buckets[Slot] == Threshold - 1 && Remaining-- > 0) || Slot == LightSlot;
+        Due[Slot] = bDue;
+        if (bDue)
+        {
+            LastUpdated[Slot] = Clock;
+            ++NumDue;
+        }
+    }
+}
+
+
+bool UMaxQEphemerisSubsystem::GetViewLocation(FVector& Location) const
+{
+    if (const USceneComponent* Viewer = SignificanceViewer.Get())
+    {
+        Location = Viewer->GetComponentLocation();
+        return true;
+    }
+
+    const APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+    if (PlayerController && PlayerController->PlayerCameraManager)
+    {
+        Location = PlayerController->PlayerCameraManager->GetCameraLocation();
+        return true;
+    }
+
+    return false;
+}
+
+
+void UMaxQEphemerisSubsystem::Propagate(const FSEphemerisTime& et)
+{
+    const double Start = FPlatformTime::Seconds();
+    Back.Error.Empty();
+
+    // The native propagators, on a worker...
+    TFuture<void> Native;
+    if (SGP4.Num() > 0 || TwoBody.Num() > 0)
+    {
+        Native = Async(EAsyncExecution::TaskGraph, [this, et]()
+        {
+            if (SGP4.Num() > 0)
+            {
+                SGP4.Propagate(et, SGP4States, true);
+                for (int32 i = 0; i < SGP4States.Num(); ++i)
+                {
+                    const int32 Slot = SGP4Begin + i;
+                    Back.Valid[Slot] = SGP4States.Status[i] == MaxQ::Orbits::ESGP4Status::Ok;
+                    if (Back.Valid[Slot])
+                    {
+                        Back.States[Slot] = FSStateVector(
+                            FSDistanceVector(SGP4States.X[i], SGP4States.Y[i], SGP4States.Z[i]),
+                            FSVelocityVector(SGP4States.VX[i], SGP4States.VY[i], SGP4States.VZ[i])
+                        );
+                    }
+                }
+            }
+
+            if (TwoBody.Num() > 0)
+            {
+                TwoBody.Propagate(et, TArrayView<FSStateVector>(Back.States).Slice(TwoBodyBegin, TwoBody.Num()));
+                for (int32 i = 0; i < TwoBody.Num(); ++i)
+                {
+                    Back.Valid[TwoBodyBegin + i] = TwoBody.IsValid(i);
+                }
+            }
+        });
+    }
+
+    // ...while the game thread evaluates the previewed slots' fits...
+    const int32 NumPreview = PreviewSlots.Num();
+    std::atomic<int32> OutsidePreview{ 0 };
+    ParallelFor((NumPreview + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+    {
+        int32 Outside = 0;
+        const int32 End = FMath::Min((Chunk + 1) * ChunkSize, NumPreview);
+        for (int32 i = Chunk * ChunkSize; i < End; ++i)
+        {
+            const FPreviewSlot& Preview = PreviewSlots[i];
+            if (!Due[Preview.Slot])
+            {
+                continue;
+            }
+
+            double r[3], v[3];
+            Back.Valid[Preview.Slot] = Preview.Cache->Evaluate(Preview.Body, et.AsSpiceDouble(), r, v);
+            if (Back.Valid[Preview.Slot])
+            {
+                Back.States[Preview.Slot] = FSStateVector(FSDistanceVector(r[0], r[1], r[2]), FSVelocityVector(v[0], v[1], v[2]));
+            }
+            else
+            {
+                ++Outside;
+            }
+        }
+        OutsidePreview += Outside;
+    }, NumPreview <= ChunkSize);
+
+    if (OutsidePreview.load() > 0)
+    {
+        ReportError(FString::Printf(TEXT("ET %.3f is outside the preview span"), et.AsSpiceDouble()));
+    }
+
+    // ...and the SPK groups' due targets that aren't previewed (all of them,
+    // without a budget)
+    TArray<FSDistanceVector> Positions;
+    for (const FSpkGroup& Group : SpkGroups)
+    {
+        DueSlots.Reset();
+        for (int32 i = 0; i < Group.Targets.Num(); ++i)
+        {
+            if (Due[Group.Begin + i] && !Previewed[Group.Begin + i])
+            {
+                DueSlots.Add(Group.Begin + i);
+            }
+        }
+
+        const int32 Count = DueSlots.Num();
+        TArrayView<const FString> GroupTargets = Group.Targets;
+        if (Count < Group.Targets.Num())
+        {
+            DueTargets.Reset();
+            for (int32 Slot : DueSlots)
+            {
+                DueTargets.Add(Group.Targets[Slot - Group.Begin]);
+            }
+            GroupTargets = DueTargets;
+        }
+
+        DueStates.SetNum(Count, false);
+        if (!Group.bVelocity)
+        {
+            Positions.SetNum(Count, false);
+        }
+
+        int32 Done = 0;
+        while (Done < Count)
+        {
+            ES_ResultCode ResultCode = ES_ResultCode::Success;
+            FString ErrorMessage;
+
+            TArrayView<const FString> Targets = GroupTargets.Slice(Done, Count - Done);
+            int32 Computed = 0;
+            if (Group.bVelocity)
+            {
+                Computed = MaxQ::Ephemeris::SpkezrMulti(
+                    et, Targets, TArrayView<FSStateVector>(DueStates).Slice(Done, Count - Done), {},
+                    Group.Observer, Group.Frame, Group.AberrationCorrection, &ResultCode, &ErrorMessage);
+            }
+            else
+            {
+                Computed = MaxQ::Ephemeris::SpkposMulti(
+                    et, Targets, TArrayView<FSDistanceVector>(Positions).Slice(Done, Count - Done), {},
+                    Group.Observer, Group.Frame, Group.AberrationCorrection, &ResultCode, &ErrorMessage);
+
+                for (int32 i = Done; i < Done + Computed; ++i)
+                {
+                    DueStates[i] = FSStateVector(Positions[i], FSVelocityVector());
+                }
+            }
+
+            for (int32 i = Done; i < Done + Computed; ++i)
+            {
+                Back.States[DueSlots[i]] = DueStates[i];
+                Back.Valid[DueSlots[i]] = true;
+            }
+            Done += Computed;
+
+            if (Done < Count)
+            {
+                // Skip the one that failed
+                Back.Valid[DueSlots[Done]] = false;
+                ReportError(ErrorMessage);
+                ++Done;
+            }
+        }
+    }
+
+    // Interpolated SPK subscriptions (CSPICE only at new knots)
+    for (FEntry* Entry : Interpolated)
+    {
+        if (!Due[Entry->Slot] || Previewed[Entry->Slot])
+        {
+            continue;
+        }
+
+        FString ErrorMessage;
+        Back.Valid[Entry->Slot] = Interpolate(*Entry, et.AsSpiceDouble(), ErrorMessage);
+        if (!Back.Valid[Entry->Slot])
+        {
+            ReportError(ErrorMessage);
+        }
+    }
+
+    // Orientations (CSPICE too)
+    for (const FOrientation& Orientation : Orientations)
+    {
+        if (!Due[Orientation.Slot])
+        {
+            continue;
+        }
+
+        auto _from = StringCast<ANSICHAR>(*Orientation.From);
+        auto _to = StringCast<ANSICHAR>(*Orientation.To);
+
+        SpiceDouble _rotate[3][3];
+        pxform_c(_from.Get(), _to.Get(), et.AsSpiceDouble(), _rotate);
+
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        if (ErrorCheck(&ResultCode, &ErrorMessage))
+        {
+            ReportError(ErrorMessage);
+            Back.Rotations[Orientation.Slot] = FSRotationMatrix();
+        }
+        else
+        {
+            Back.Rotations[Orientation.Slot] = FSRotationMatrix(_rotate);
+        }
+
+        FSQuaternion q;
+        MaxQ::Math::M2q(q, Back.Rotations[Orientation.Slot]);
+        Back.Quats[Orientation.Slot] = q.Swizzle();
+    }
+
+    if (Native.IsValid())
+    {
+        Native.Wait();
+    }
+
+    Back.Seconds = FPlatformTime::Seconds() - Start;
+}
+
+
+void UMaxQEphemerisSubsystem::Present()
+{
+    // Slots the pass skipped (over budget) keep their last state.  The native
+    // ranges are always propagated whole, but not always oriented.
+    for (int32 Slot = 0; NumDue < States.Num() && Slot < States.Num(); ++Slot)
+    {
+        if (!Due[Slot])
+        {
+            if (Slot < SGP4Begin)
+            {
+                Back.States[Slot] = States[Slot];
+                Back.Valid[Slot] = Valid[Slot];
+            }
+            Back.Rotations[Slot] = Rotations[Slot];
+            Back.Quats[Slot] = Quats[Slot];
+        }
+    }
+
+    Swap(States, Back.States);
+    Swap(Rotations, Back.Rotations);
+    Swap(Quats, Back.Quats);
+    Swap(Valid, Back.Valid);
+    PassError = MoveTemp(Back.Error);
+    Back.Error.Empty();
+}
+
+
+void UMaxQEphemerisSubsystem::WaitForPass()
+{
+    if (InFlight.IsValid())
+    {
+        InFlight.Wait();
+        InFlight.Reset();
+    }
+}
+
+
+bool UMaxQEphemerisSubsystem::Interpolate(FEntry& Entry, double et, FString& ErrorMessage)
+{
+    FDecimation& d = Entry.Decimation;
+    const FMaxQEphemerisSubscription& s = Entry.Subscription;
+
+    const double MaxInterval = s.Interval.AsSeconds();
+    if (d.Interval <= 0. || d.Interval > MaxInterval)
+    {
+        d.Interval = MaxInterval;
+    }
+
+    auto Fetch = [&](double t, FSStateVector& State)
+    {
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FSEphemerisPeriod lt;
+        MaxQ::Ephemeris::Spkezr(FSEphemerisTime(t), State, lt, d.Target, d.Observer, d.Frame, s.AberrationCorrection, &ResultCode, &ErrorMessage);
+        return ResultCode == ES_ResultCode::Success;
+    };
+
+    if (!d.bKnots || et < d.t0 || et > d.t1)
+    {
+        bool bStepped = false;
+        bool bFetched = false;
+        if (d.bKnots && et > d.t1 && et <= d.t1 + d.Interval)
+        {
+            // The next knot interval
+            d.t0 = d.t1;
+            d.s0 = d.s1;
+            d.t1 = d.t0 + d.Interval;
+            bFetched = Fetch(d.t1, d.s1);
+            bStepped = true;
+        }
+        else if (d.bKnots && et < d.t0 && et >= d.t0 - d.Interval)
+        {
+            // The previous one (playing backwards)
+            d.t1 = d.t0;
+            d.s1 = d.s0;
+            d.t0 = d.t1 - d.Interval;
+            bFetched = Fetch(d.t0, d.s0);
+            bStepped = true;
+        }
+        else
+        {
+            // A jump:  knots on the interval's grid around et
+            d.t0 = FMath::FloorToDouble(et / d.Interval) * d.Interval;
+            d.t1 = d.t0 + d.Interval;
+            bFetched = Fetch(d.t0, d.s0) && Fetch(d.t1, d.s1);
+        }
+
+        d.bKnots = bFetched;
+        if (!bFetched)
+        {
+            d.bJerk = false;
+            return false;
+        }
+
+        // The third derivative over these knots, and the estimate of the
+        // fourth from how it's changed since the last knots
+        const double h = d.t1 - d.t0;
+        double s0[6], s1[6];
+        d.s0.CopyTo(s0);
+        d.s1.CopyTo(s1);
+
+        double Jerk[3], Change = 0.;
+        for (int32 k = 0; k < 3; ++k)
+        {
+            Jerk[k] = 6. * (h * (s0[k + 3] + s1[k + 3]) - 2. * (s1[k] - s0[k])) / (h * h * h);
+            Change += FMath::Square(Jerk[k] - d.Jerk[k]);
+        }
+
+        if (bStepped && d.bJerk)
+        {
+            const double Error = FMath::Pow(h, 4.) / 384. * FMath::Sqrt(Change) / h;
+            const double Tolerance = s.Tolerance.AsSpiceDouble();
+            if (Error > Tolerance)
+            {
+                d.Interval = FMath::Max(0.5 * d.Interval, MinIntervalFraction * MaxInterval);
+            }
+            else if (Error < GrowFraction * Tolerance)
+            {
+                d.Interval = FMath::Min(2. * d.Interval, MaxInterval);
+            }
+        }
+
+        FMemory::Memcpy(d.Jerk, Jerk, sizeof(Jerk));
+        d.bJerk = true;
+    }
+
+    double s0[6], s1[6], state[6];
+    d.s0.CopyTo(s0);
+    d.s1.CopyTo(s1);
+    Hermite(s0, s1, d.t1 - d.t0, et - d.t0, state);
+    Back.States[Entry.Slot] = FSStateVector(state);
+
+    return true;
+}
+
+
+void UMaxQEphemerisSubsystem::Scatter()
+{
+    // Where everything goes, in parallel...
+    const int32 Num = ScatterOrder.Num();
+    ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+    {
+        const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+        for (int32 i = Chunk * ChunkSize; i < End; ++i)
+        {
+            const int32 Slot = ScatterOrder[i];
+            const FMaxQEphemerisPlacement& Placement = Placements[Slot];
+            Pending[i] = 0;
+            if (!Valid[Slot] || !(Due[Slot] || (bRebased && Placement.bFloatingOrigin)))
+            {
+                continue;
+            }
+
+            FVector Location = (Placement.bFloatingOrigin ? States[Slot].r - Origin : States[Slot].r).Swizzle();
+            switch (Placement.ScalePolicy)
+            {
+            case EMaxQScalePolicy::Linear:
+                Location *= Placement.Scale;
+                break;
+            case EMaxQScalePolicy::Logarithmic:
+            {
+                const double Distance = Location.Size();
+                const double Reference = Placement.ReferenceDistance.km;
+                if (Distance > 0. && Reference > 0.)
+                {
+                    Location *= Placement.Scale * Reference * FMath::Loge(1. + Distance / Reference) / Distance;
+                }
+                break;
+            }
+            default:
+                Location *= Scale;
+            }
+
+            const bool bMoved = !Location.Equals(WrittenLocations[i], Placement.LocationTolerance);
+            const bool bTurned = Oriented[Slot] && !Quats[Slot].Equals(WrittenRotations[i], RotationTolerance);
+            if (bMoved || bTurned)
+            {
+                Pending[i] = 1;
+                PendingLocations[i] = Location;
+                PendingRotations[i] = Quats[Slot];
+            }
+        }
+    }, Num <= ChunkSize);
+
+    // ...then the writes that change something, in order
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const int32 Slot = ScatterOrder[i];
+        USceneComponent* Component = Pending[i] ? Components[Slot].Get() : nullptr;
+        if (!Component)
+        {
+            continue;
+        }
+
+        const FMaxQEphemerisPlacement& Placement = Placements[Slot];
+        const ETeleportType Teleport = Placement.bUpdatePhysics ? ETeleportType::None : ETeleportType::TeleportPhysics;
+
+        if (Placement.bUpdateOverlaps)
+        {
+            if (Oriented[Slot])
+            {
+                Component->SetRelativeLocationAndRotation(PendingLocations[i], PendingRotations[i], false, nullptr, Teleport);
+            }
+            else
+            {
+                Component->SetRelativeLocation(PendingLocations[i], false, nullptr, Teleport);
+            }
+        }
+        else
+        {
+            // No MoveComponent, so no overlap tests
+            Component->SetRelativeLocation_Direct(PendingLocations[i]);
+            if (Oriented[Slot])
+            {
+                Component->SetRelativeRotation_Direct(PendingRotations[i].Rotator());
+            }
+            Component->UpdateComponentToWorld(Placement.bUpdatePhysics ? EUpdateTransformFlags::None : EUpdateTransformFlags::SkipPhysicsUpdate, Teleport);
+        }
+
+        WrittenLocations[i] = PendingLocations[i];
+        WrittenRotations[i] = PendingRotations[i];
+    }
+
+    bRebased = false;
+}
+
+
+void UMaxQEphemerisSubsystem::ReportError(const FString& ErrorMessage)
+{
+    if (Back.Error.IsEmpty())
+    {
+        Back.Error = ErrorMessage;
+    }
+}
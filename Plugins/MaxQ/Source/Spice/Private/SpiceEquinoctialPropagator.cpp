@@ -0,0 +1,285 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEquinoctialPropagator.cpp
+//
+// Implementation Comments
+//
+// Purpose:  eqncpv (equinoctial element) propagation of many objects at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEquinoctialPropagator.cpp is part of the "refined C++ API".
+//
+// The arithmetic is eqncpv's, in its order.  kepleq reduces the equinoctial
+// Kepler equation (ml = F + h cos F - k sin F) to x = h' cos x + k' sin x,
+// F = ml + x, with (h', k') the eccentricity vector rotated by ml.  kpsolv
+// brackets x in [-e, 0] or [0, e], bisects min(32, max(1, nint(1/(1-e))))
+// times, then takes five Newton steps.  Each lane does its own number of
+// bisections (lanes past theirs hold), so every lane's result is kpsolv's.
+//------------------------------------------------------------------------------
+
+#include "SpiceEquinoctialPropagator.h"
+#include "SpiceMemory.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    using namespace MaxQ::Orbits;
+
+    constexpr int32 W = FEquinoctialBatchPropagator::Lanes;
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double twopi = 2. * pi;
+
+    // Rows per ParallelFor task
+    constexpr int32 BatchRows = 256;
+    static_assert(BatchRows % W == 0, "BatchRows must be a multiple of the lane width");
+
+    // kpsolv's limits
+    constexpr int32 MaxBisections = 32;
+    constexpr int32 NewtonSteps = 5;
+}
+
+namespace MaxQ::Orbits
+{
+    void FEquinoctialBatchPropagator::Reset()
+    {
+        Columns.Empty();
+        Valid.Empty();
+        Rows = 0;
+        NumObjects = 0;
+    }
+
+
+    SIZE_T FEquinoctialBatchPropagator::GetAllocatedSize() const
+    {
+        return Columns.GetAllocatedSize() + Valid.GetAllocatedSize();
+    }
+
+
+    void FEquinoctialBatchPropagator::Build(
+        TArrayView<const FSEquinoctialElements> Elements,
+        TArrayView<const FSEphemerisTime> Epochs,
+        const FSAngle& rapol,
+        const FSAngle& decpol
+    )
+    {
+        MAXQ_LLM_SCOPE();
+        check(Epochs.Num() >= Elements.Num());
+
+        const double sa = sin(rapol.AsSpiceDouble()), ca = cos(rapol.AsSpiceDouble());
+        const double sd = sin(decpol.AsSpiceDouble()), cd = cos(decpol.AsSpiceDouble());
+        Trans[0][0] = -sa; Trans[0][1] = -ca * sd; Trans[0][2] = ca * cd;
+        Trans[1][0] = ca;  Trans[1][1] = -sa * sd; Trans[1][2] = sa * cd;
+        Trans[2][0] = 0.;  Trans[2][1] = cd;       Trans[2][2] = sd;
+
+        NumObjects = Elements.Num();
+        Rows = (NumObjects + W - 1) / W * W;
+        Columns.SetNumZeroed(NumColumns * Rows);
+        Valid.SetNumZeroed(NumObjects);
+
+        for (int32 Row = 0; Row < Rows; ++Row)
+        {
+            double eqel[9] = { 0. };
+            if (Row < NumObjects)
+            {
+                Elements[Row].CopyTo(eqel);
+            }
+            const double ecc2 = eqel[1] * eqel[1] + eqel[2] * eqel[2];
+
+            // (as eqncpv and kepleq)
+            const bool bValid = Row < NumObjects && eqel[0] > 0. && ecc2 < .81;
+            if (!bValid)
+            {
+                // Padding (and invalid entries) get a harmless unit circular
+                // orbit
+                Column(EColumn::sma)[Row] = 1.;
+                Column(EColumn::mlrate)[Row] = 1.;
+                continue;
+            }
+
+            Column(EColumn::sma)[Row] = eqel[0];
+            Column(EColumn::h0)[Row] = eqel[1];
+            Column(EColumn::k0)[Row] = eqel[2];
+            Column(EColumn::meanlong0)[Row] = eqel[3];
+            Column(EColumn::p0)[Row] = eqel[4];
+            Column(EColumn::q0)[Row] = eqel[5];
+            Column(EColumn::lprate)[Row] = eqel[6];
+            Column(EColumn::mlrate)[Row] = eqel[7];
+            Column(EColumn::noderate)[Row] = eqel[8];
+            Column(EColumn::epoch)[Row] = Epochs[Row].AsSpiceDouble();
+
+            Valid[Row] = true;
+        }
+    }
+
+
+    int32 FEquinoctialBatchPropagator::Propagate(const FSEphemerisTime& et, TArrayView<FSStateVector> OutStates) const
+    {
+        check(OutStates.Num() >= NumObjects);
+
+        const double _et = et.AsSpiceDouble();
+        const int32 NumTasks = (Rows + BatchRows - 1) / BatchRows;
+
+        TArray<int32> Succeeded;
+        Succeeded.SetNumZeroed(NumTasks);
+
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 First = Task * BatchRows;
+            const int32 Last = FMath::Min(First + BatchRows, Rows);
+            int32 Count = 0;
+
+            for (int32 Row = First; Row < Last; Row += W)
+            {
+                const double* a = Column(EColumn::sma) + Row;
+                const double* eh = Column(EColumn::h0) + Row;
+                const double* ek = Column(EColumn::k0) + Row;
+                const double* l0 = Column(EColumn::meanlong0) + Row;
+                const double* ep = Column(EColumn::p0) + Row;
+                const double* eq = Column(EColumn::q0) + Row;
+                const double* dlpdt = Column(EColumn::lprate) + Row;
+                const double* mldt = Column(EColumn::mlrate) + Row;
+                const double* nodedt = Column(EColumn::noderate) + Row;
+                const double* tp = Column(EColumn::epoch) + Row;
+
+                // Elements at et, and kepleq's reduced problem
+                double h[W], k[W], p[W], q[W], ml[W];
+                double eh2[W], ek2[W], xl[W], xu[W], xm[W];
+                int32 nbisect[W];
+                bool bZero[W];
+                int32 Bisections = 0;
+                for (int32 l = 0; l < W; ++l)
+                {
+                    const double dt = _et - tp[l];
+                    const double dlp = dt * dlpdt[l];
+                    const double can = cos(dlp), san = sin(dlp);
+                    h[l] = eh[l] * can + ek[l] * san;
+                    k[l] = ek[l] * can - eh[l] * san;
+
+                    const double node = dt * nodedt[l];
+                    const double cn = cos(node), sn = sin(node);
+                    p[l] = ep[l] * cn + eq[l] * sn;
+                    q[l] = eq[l] * cn - ep[l] * sn;
+
+                    ml[l] = l0[l] + fmod(mldt[l] * dt, twopi);
+
+                    // (kepleq)
+                    eh2[l] = -h[l] * cos(ml[l]) + k[l] * sin(ml[l]);
+                    ek2[l] = h[l] * sin(ml[l]) + k[l] * cos(ml[l]);
+
+                    // (kpsolv)
+                    const double y0 = -eh2[l];
+                    const double ecc = sqrt(eh2[l] * eh2[l] + ek2[l] * ek2[l]);
+                    xl[l] = y0 > 0. ? -ecc : 0.;
+                    xu[l] = y0 > 0. ? 0. : ecc;
+                    xm[l] = 0.;
+                    bZero[l] = y0 == 0.;
+                    nbisect[l] = FMath::Min(MaxBisections, FMath::Max(1, FMath::RoundToInt(1. / (1. - ecc))));
+                    Bisections = FMath::Max(Bisections, nbisect[l]);
+                }
+
+                for (int32 i = 0; i < Bisections; ++i)
+                {
+                    for (int32 l = 0; l < W; ++l)
+                    {
+                        if (i < nbisect[l])
+                        {
+                            xm[l] = FMath::Max(xl[l], FMath::Min(xu[l], (xl[l] + xu[l]) * .5));
+                            const double yxm = xm[l] - eh2[l] * cos(xm[l]) - ek2[l] * sin(xm[l]);
+                            (yxm > 0. ? xu[l] : xl[l]) = xm[l];
+                        }
+                    }
+                }
+
+                for (int32 i = 0; i < NewtonSteps; ++i)
+                {
+                    for (int32 l = 0; l < W; ++l)
+                    {
+                        const double cosx = cos(xm[l]), sinx = sin(xm[l]);
+                        const double yx = xm[l] - eh2[l] * cosx - ek2[l] * sinx;
+                        const double ypx = eh2[l] * sinx + 1. - ek2[l] * cosx;
+                        xm[l] -= yx / ypx;
+                    }
+                }
+
+                double state[6][W];
+                for (int32 l = 0; l < W; ++l)
+                {
+                    const double eecan = ml[l] + (bZero[l] ? 0. : xm[l]);
+                    const double prate = dlpdt[l] - nodedt[l];
+
+                    double b = sqrt(1. - h[l] * h[l] - k[l] * k[l]);
+                    b = 1. / (b + 1.);
+
+                    const double di = 1. / (p[l] * p[l] + 1. + q[l] * q[l]);
+                    const double vf[3] = { (1. - p[l] * p[l] + q[l] * q[l]) * di, p[l] * 2. * q[l] * di, p[l] * -2. * di };
+                    const double vg[3] = { p[l] * 2. * q[l] * di, (p[l] * p[l] + 1. - q[l] * q[l]) * di, q[l] * 2. * di };
+
+                    const double sf = sin(eecan), cf = cos(eecan);
+                    const double x1 = a[l] * ((1. - b * (h[l] * h[l])) * cf + (h[l] * k[l] * b * sf - k[l]));
+                    const double y1 = a[l] * ((1. - b * (k[l] * k[l])) * sf + (h[l] * k[l] * b * cf - h[l]));
+
+                    const double rb = h[l] * sf + k[l] * cf;
+                    const double r = a[l] * (1. - rb);
+                    const double ra = mldt[l] * a[l] * a[l] / r;
+                    const double dx1 = ra * (-sf + h[l] * b * rb);
+                    const double dy1 = ra * (cf - k[l] * b * rb);
+
+                    const double nfac = 1. - dlpdt[l] / mldt[l];
+                    const double dx = nfac * dx1 - prate * y1;
+                    const double dy = nfac * dy1 + prate * x1;
+
+                    // (vlcom, vlcom3)
+                    const double xhold[6] = {
+                        x1 * vf[0] + y1 * vg[0],
+                        x1 * vf[1] + y1 * vg[1],
+                        x1 * vf[2] + y1 * vg[2],
+                        -nodedt[l] * (x1 * vf[1] + y1 * vg[1]) + dx * vf[0] + dy * vg[0],
+                        nodedt[l] * (x1 * vf[0] + y1 * vg[0]) + dx * vf[1] + dy * vg[1],
+                        dx * vf[2] + dy * vg[2]
+                    };
+
+                    // (mxv, twice)
+                    for (int32 j = 0; j < 3; ++j)
+                    {
+                        state[j][l] = Trans[j][0] * xhold[0] + Trans[j][1] * xhold[1] + Trans[j][2] * xhold[2];
+                        state[j + 3][l] = Trans[j][0] * xhold[3] + Trans[j][1] * xhold[4] + Trans[j][2] * xhold[5];
+                    }
+                }
+
+                for (int32 l = 0; l < W && Row + l < NumObjects; ++l)
+                {
+                    const int32 i = Row + l;
+                    if (!Valid[i])
+                    {
+                        OutStates[i] = FSStateVector();
+                        continue;
+                    }
+
+                    const double s[6] = { state[0][l], state[1][l], state[2][l], state[3][l], state[4][l], state[5][l] };
+                    OutStates[i] = FSStateVector(s);
+                    ++Count;
+                }
+            }
+
+            Succeeded[Task] = Count;
+        });
+
+        int32 Total = 0;
+        for (int32 Count : Succeeded)
+        {
+            Total += Count;
+        }
+        return Total;
+    }
+}
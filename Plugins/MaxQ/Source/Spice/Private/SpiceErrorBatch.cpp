@@ -0,0 +1,138 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceErrorBatch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Scoped error accumulation for loops over many SPICE calls.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceErrorBatch.cpp is part of the "refined C++ API".
+//
+// MaxQ::Private::ErrorCheck hands failures to the current batch, if there is
+// one.  The batch takes care of the reset_c.
+//------------------------------------------------------------------------------
+
+#include "SpiceErrorBatch.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    thread_local MaxQ::Core::FSpiceErrorBatch* CurrentBatch = nullptr;
+}
+
+namespace MaxQ::Core
+{
+    FSpiceErrorBatch::FSpiceErrorBatch(int32 NumItems, const FSpiceErrorBatchSettings& _Settings)
+        : Settings(_Settings)
+        , Outer(CurrentBatch)
+    {
+        Settings.MaxMessages = FMath::Max(Settings.MaxMessages, 0);
+        Settings.MaxLogged = FMath::Max(Settings.MaxLogged, 0);
+
+        FailedItems.Init(false, FMath::Max(NumItems, 0));
+        FirstFailures.Reserve(Settings.MaxMessages);
+
+        CurrentBatch = this;
+    }
+
+    FSpiceErrorBatch::~FSpiceErrorBatch()
+    {
+        check(CurrentBatch == this);
+        CurrentBatch = Outer;
+
+        if (UnloggedCount > 0)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("USpice Runtime Error: %d more failures in batch were not logged (%d failures, %d items)"), UnloggedCount, FailureCount, NumFailedItems());
+        }
+    }
+
+
+    void FSpiceErrorBatch::SetItem(int32 Index)
+    {
+        Item = Index;
+    }
+
+
+    FSpiceErrorBatch* FSpiceErrorBatch::Current()
+    {
+        return CurrentBatch;
+    }
+
+
+    void FSpiceErrorBatch::Record(FString& ErrorMessage, bool BeQuiet)
+    {
+        ++FailureCount;
+
+        if (Item >= 0)
+        {
+            if (Item >= FailedItems.Num())
+            {
+                FailedItems.Add(false, Item + 1 - FailedItems.Num());
+            }
+            FailedItems[Item] = true;
+        }
+
+        char szBuffer[SpiceLongMessageMaxLength];
+        szBuffer[0] = '\0';
+
+        const bool bLongMessage = FirstFailures.Num() < Settings.MaxMessages;
+        if (bLongMessage)
+        {
+            getmsg_c("LONG", sizeof(szBuffer), szBuffer);
+        }
+
+        if (!SpiceStringLengthN(szBuffer, sizeof(szBuffer)))
+        {
+            szBuffer[0] = '\0';
+            getmsg_c("SHORT", sizeof(szBuffer), szBuffer);
+        }
+
+        ErrorMessage = szBuffer;
+
+        if (bLongMessage)
+        {
+            FirstFailures.Add(FFailure{ Item, ErrorMessage });
+        }
+
+        if (!BeQuiet)
+        {
+            if (LoggedCount < Settings.MaxLogged)
+            {
+                UE_LOG(LogSpice, Warning, TEXT("USpice Runtime Error: %s"), *ErrorMessage);
+
+                if (LoggedCount == 0)
+                {
+                    PrintScriptCallstack();
+                }
+                ++LoggedCount;
+            }
+            else
+            {
+                ++UnloggedCount;
+            }
+        }
+
+        reset_c();
+    }
+}
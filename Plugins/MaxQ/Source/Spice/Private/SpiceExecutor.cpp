@@ -0,0 +1,221 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceExecutor.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Runs CSPICE work on one dedicated worker thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceExecutor.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceExecutor.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "Misc/ScopeLock.h"
+#include "SpiceUtilities.h"
+#include "SpiceLock.h"
+
+using namespace MaxQ::Private;
+
+std::atomic<FSpiceExecutor*> FSpiceExecutor::Instance{ nullptr };
+FCriticalSection FSpiceExecutor::InstanceLock;
+
+
+FSpiceExecutor& FSpiceExecutor::Get()
+{
+    // Double checked, so the common case doesn't take the lock.  The
+    // acquire pairs with the release that publishes a started executor.
+    FSpiceExecutor* Executor = Instance.load(std::memory_order_acquire);
+    if (Executor == nullptr)
+    {
+        FScopeLock Lock(&InstanceLock);
+        Executor = Instance.load(std::memory_order_relaxed);
+        if (Executor == nullptr)
+        {
+            Executor = new FSpiceExecutor();
+            Executor->Start();
+            Instance.store(Executor, std::memory_order_release);
+        }
+    }
+
+    return *Executor;
+}
+
+
+void FSpiceExecutor::Shutdown()
+{
+    FScopeLock Lock(&InstanceLock);
+
+    FSpiceExecutor* Executor = Instance.load(std::memory_order_relaxed);
+    if (Executor != nullptr)
+    {
+        // Still published while the queue drains, so commands that enqueue
+        // more work run it inline rather than starting another executor.
+        Executor->StopThread();
+        Instance.store(nullptr, std::memory_order_release);
+        delete Executor;
+    }
+}
+
+
+bool FSpiceExecutor::IsRunning()
+{
+    return Instance.load(std::memory_order_acquire) != nullptr;
+}
+
+
+bool FSpiceExecutor::IsInExecutorThread()
+{
+    FSpiceExecutor* Executor = Instance.load(std::memory_order_acquire);
+    return Executor != nullptr && FPlatformTLS::GetCurrentThreadId() == Executor->ThreadId.load(std::memory_order_acquire);
+}
+
+
+FSpiceExecutor::FSpiceExecutor()
+    : WorkAvailable(FPlatformProcess::GetSynchEventFromPool(false))
+    , Thread(nullptr)
+    , bStopRequested(false)
+    , ThreadId(0)
+{
+}
+
+
+FSpiceExecutor::~FSpiceExecutor()
+{
+    StopThread();
+
+    FPlatformProcess::ReturnSynchEventToPool(WorkAvailable);
+    WorkAvailable = nullptr;
+}
+
+
+void FSpiceExecutor::Start()
+{
+    Thread = FRunnableThread::Create(this, TEXT("MaxQ Spice Executor"), 0, TPri_Normal);
+    check(Thread);
+}
+
+
+void FSpiceExecutor::StopThread()
+{
+    if (Thread != nullptr)
+    {
+        // Kill(true) calls Stop() and waits for Run() to return.
+        Thread->Kill(true);
+        delete Thread;
+        Thread = nullptr;
+
+        // A producer that checked bStopRequested just before Stop set it
+        // can enqueue after Run's last drain.  The thread's gone, so this
+        // is the only consumer now.
+        DrainQueue();
+    }
+}
+
+
+TFuture<void> FSpiceExecutor::EnqueueBatch(TArray<FCommand>&& Commands)
+{
+    TSharedRef<TPromise<void>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<void>, ESPMode::ThreadSafe>();
+    TFuture<void> Future = Promise->GetFuture();
+
+    EnqueueCommand(
+        [Promise, Commands = MoveTemp(Commands)]() mutable
+        {
+            for (FCommand& Command : Commands)
+            {
+                Command();
+            }
+            Promise->SetValue();
+        }
+    );
+
+    return Future;
+}
+
+
+void FSpiceExecutor::EnqueueCommand(FCommand&& Command)
+{
+    if (IsInExecutorThread())
+    {
+        // A command that enqueues more work and then waits on it would
+        // deadlock.  Run it inline.
+        MaxQ::Core::FSpiceScope Scope;
+        Command();
+        return;
+    }
+
+    if (bStopRequested)
+    {
+        // The queue may already have had its last drain.  Run it here
+        // rather than leave its future unfulfilled.
+        MaxQ::Core::FSpiceScope Scope;
+        Command();
+        return;
+    }
+
+    CommandQueue.Enqueue(MoveTemp(Command));
+    WorkAvailable->Trigger();
+}
+
+
+bool FSpiceExecutor::Init()
+{
+    // On the executor thread, so the id is right before the first command
+    // (Thread->GetThreadID() in Start would race the thread starting).
+    ThreadId.store(FPlatformTLS::GetCurrentThreadId(), std::memory_order_release);
+    return true;
+}
+
+
+uint32 FSpiceExecutor::Run()
+{
+    while (!bStopRequested)
+    {
+        DrainQueue();
+        WorkAvailable->Wait();
+    }
+
+    // Don't leave anyone waiting on a future.
+    DrainQueue();
+
+    return 0;
+}
+
+
+void FSpiceExecutor::DrainQueue()
+{
+    FCommand Command;
+    while (CommandQueue.Dequeue(Command))
+    {
+        // A command that leaves CSPICE in an error state didn't check for
+        // it.  The scope clears it, so it doesn't poison the next command.
+        MaxQ::Core::FSpiceScope Scope;
+        Command();
+        Command.Reset();
+    }
+}
+
+
+void FSpiceExecutor::Stop()
+{
+    bStopRequested = true;
+    WorkAvailable->Trigger();
+}
+
+
+void FSpiceExecutor::Exit()
+{
+}
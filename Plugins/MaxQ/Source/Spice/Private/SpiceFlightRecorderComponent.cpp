@@ -0,0 +1,452 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFlightRecorderComponent.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Records an actor's trajectory and attitude to SPK and CK files.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFlightRecorderComponent.cpp is part of the "Blueprints API".
+//
+// A recording is a session object shared with the executor commands that
+// open, write and close its files.  The component only hands it copies of
+// samples, so it can be destroyed with commands still queued.  The executor
+// runs commands in order, so a session's writes always land between its
+// open and its close.  A failure is kept (the first one) and turns the
+// rest of the session's commands into no-ops, except closing the files.
+//------------------------------------------------------------------------------
+
+#include "SpiceFlightRecorderComponent.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceExecutor.h"
+#include "SpiceSpkWriter.h"
+#include "SpiceCkWriter.h"
+#include "SpiceUtilities.h"
+#include "SpiceMath.h"
+#include "Spice.h"
+#include "HAL/FileManager.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include <atomic>
+
+using namespace MaxQ::Private;
+
+
+struct UMaxQFlightRecorderComponent::FSession
+{
+    // Set before the session is queued, then read-only
+    FString SpkPath;
+    FString CkPath;
+    bool bOverwrite = true;
+    int32 Body = 0;
+    int32 Center = 0;
+    int32 Instrument = 0;
+    int32 SclkId = 0;
+    FString Frame;
+    FString SegmentId;
+    MaxQ::Ephemeris::FSpkSegmentWriterSettings SpkSettings;
+    MaxQ::Data::FCkSegmentWriterSettings CkSettings;
+
+    // Executor thread only
+    int SpkHandle = 0;
+    int CkHandle = 0;
+    bool bSpkOpen = false;
+    bool bCkOpen = false;
+    MaxQ::Ephemeris::FSpkSegmentWriter Spk;
+    MaxQ::Data::FCkSegmentWriter Ck;
+
+    std::atomic<bool> bFailed{ false };
+    std::atomic<bool> bClosed{ false };
+    // Whether OnError has been broadcast (game thread)
+    bool bReported = false;
+
+    bool GetError(FString& Message)
+    {
+        FScopeLock Lock(&ErrorLock);
+        Message = Error;
+        return bFailed;
+    }
+
+    void Open();
+    void Write(const TArray<FMaxQFlightSample>& Samples);
+    void Close();
+
+private:
+    bool Check(ES_ResultCode ResultCode, const FString& ErrorMessage)
+    {
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            FScopeLock Lock(&ErrorLock);
+            if (!bFailed)
+            {
+                Error = ErrorMessage;
+                bFailed = true;
+            }
+        }
+        return !bFailed;
+    }
+
+    FCriticalSection ErrorLock;
+    FString Error;
+};
+
+
+void UMaxQFlightRecorderComponent::FSession::Open()
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    if (bOverwrite)
+    {
+        IFileManager::Get().Delete(*toPath(SpkPath), false, true, true);
+        if (!CkPath.IsEmpty())
+        {
+            IFileManager::Get().Delete(*toPath(CkPath), false, true, true);
+        }
+    }
+
+    USpice::spkopn(ResultCode, ErrorMessage, SpkPath, SegmentId, 0, SpkHandle);
+    if (!Check(ResultCode, ErrorMessage))
+    {
+        return;
+    }
+    bSpkOpen = true;
+    Spk.Begin(SpkHandle, Body, Center, Frame, SegmentId, SpkSettings, &ResultCode, &ErrorMessage);
+    if (!Check(ResultCode, ErrorMessage) || CkPath.IsEmpty())
+    {
+        return;
+    }
+
+    USpice::ckopn(ResultCode, ErrorMessage, CkPath, SegmentId, 0, CkHandle);
+    if (!Check(ResultCode, ErrorMessage))
+    {
+        return;
+    }
+    bCkOpen = true;
+    Ck.Begin(CkHandle, Instrument, Frame, SegmentId, CkSettings, &ResultCode, &ErrorMessage);
+    Check(ResultCode, ErrorMessage);
+}
+
+
+void UMaxQFlightRecorderComponent::FSession::Write(const TArray<FMaxQFlightSample>& Samples)
+{
+    if (bFailed)
+    {
+        return;
+    }
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    TArray<double> ets;
+    TArray<FSStateVector> States;
+    ets.Reserve(Samples.Num());
+    States.Reserve(Samples.Num());
+    for (const FMaxQFlightSample& Sample : Samples)
+    {
+        ets.Add(Sample.et.seconds);
+        States.Add(Sample.State);
+    }
+
+    Spk.Add(ets, States, &ResultCode, &ErrorMessage);
+    if (!Check(ResultCode, ErrorMessage) || !bCkOpen)
+    {
+        return;
+    }
+
+    TArray<FSPointingType1Observation> Records;
+    Records.SetNum(Samples.Num());
+    for (int32 i = 0; i < Samples.Num(); ++i)
+    {
+        USpice::sce2c(ResultCode, ErrorMessage, SclkId, Samples[i].et, Records[i].sclkdp);
+        if (!Check(ResultCode, ErrorMessage))
+        {
+            return;
+        }
+        Records[i].quat = Samples[i].Orientation;
+    }
+
+    Ck.Add(Records, &ResultCode, &ErrorMessage);
+    Check(ResultCode, ErrorMessage);
+}
+
+
+void UMaxQFlightRecorderComponent::FSession::Close()
+{
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    // Even after a failure, so the handles aren't leaked
+    if (Spk.IsOpen())
+    {
+        Spk.End(&ResultCode, &ErrorMessage);
+        Check(ResultCode, ErrorMessage);
+    }
+    if (bSpkOpen)
+    {
+        USpice::spkcls(ResultCode, ErrorMessage, SpkHandle);
+        Check(ResultCode, ErrorMessage);
+    }
+    if (Ck.IsOpen())
+    {
+        Ck.End(&ResultCode, &ErrorMessage);
+        Check(ResultCode, ErrorMessage);
+    }
+    if (bCkOpen)
+    {
+        USpice::ckcls(ResultCode, ErrorMessage, CkHandle);
+        Check(ResultCode, ErrorMessage);
+    }
+
+    bSpkOpen = bCkOpen = false;
+    bClosed = true;
+}
+
+
+UMaxQFlightRecorderComponent::UMaxQFlightRecorderComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    // After the ephemeris subsystem has advanced its Epoch, and placed things
+    PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+
+void UMaxQFlightRecorderComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (bRecordOnBeginPlay)
+    {
+        StartRecording();
+    }
+}
+
+
+void UMaxQFlightRecorderComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // The files are closed on the executor, after the component's gone
+    StopRecording();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+bool UMaxQFlightRecorderComponent::StartRecording()
+{
+    check(IsInGameThread());
+
+    if (bRecording)
+    {
+        return false;
+    }
+
+    TSharedPtr<FSession, ESPMode::ThreadSafe> NewSession = MakeShared<FSession, ESPMode::ThreadSafe>();
+    NewSession->SpkPath = SpkPath;
+    NewSession->CkPath = CkPath;
+    NewSession->bOverwrite = bOverwrite;
+    NewSession->Body = Body;
+    NewSession->Center = Center;
+    NewSession->Instrument = Instrument;
+    NewSession->SclkId = SclkId;
+    NewSession->Frame = Frame;
+    NewSession->SegmentId = SegmentId;
+    NewSession->SpkSettings.Type = bHermite ? MaxQ::Ephemeris::ESpkSegmentType::Type13 : MaxQ::Ephemeris::ESpkSegmentType::Type09;
+    NewSession->SpkSettings.Degree = Degree;
+    NewSession->CkSettings.Type = MaxQ::Data::ECkSegmentType::Type03;
+    NewSession->CkSettings.bAngularVelocity = false;
+
+    FSpiceExecutor::Get().EnqueueCommand([NewSession]() { NewSession->Open(); });
+
+    Session = NewSession;
+    Ring.SetNum(FMath::Max(RingCapacity, 1));
+    RingStart = RingNum = Unsent = 0;
+    Recorded = 0;
+    bRecording = true;
+    return true;
+}
+
+
+void UMaxQFlightRecorderComponent::StopRecording()
+{
+    check(IsInGameThread());
+
+    if (!bRecording)
+    {
+        return;
+    }
+
+    Send();
+    TSharedPtr<FSession, ESPMode::ThreadSafe> Stopped = Session;
+    FSpiceExecutor::Get().EnqueueCommand([Stopped]() { Stopped->Close(); });
+
+    Closing.Add(Stopped);
+    Session.Reset();
+    bRecording = false;
+}
+
+
+bool UMaxQFlightRecorderComponent::Record(const FSEphemerisTime& et, const FSStateVector& State, const FSQuaternion& Orientation)
+{
+    if (!bRecording || (RingNum > 0 && et.seconds <= Ring[(RingStart + RingNum - 1) % Ring.Num()].et.seconds))
+    {
+        return false;
+    }
+
+    // The oldest sample is overwritten once the ring is full.  It's been sent
+    // by then:  FlushSamples <= RingCapacity.
+    const int32 Slot = (RingStart + RingNum) % Ring.Num();
+    if (RingNum < Ring.Num())
+    {
+        ++RingNum;
+    }
+    else
+    {
+        RingStart = (RingStart + 1) % Ring.Num();
+    }
+
+    FMaxQFlightSample& Sample = Ring[Slot];
+    Sample.et = et;
+    Sample.State = State;
+    Sample.Orientation = Orientation;
+
+    ++Recorded;
+    if (++Unsent >= FMath::Clamp(FlushSamples, 1, Ring.Num()))
+    {
+        Send();
+    }
+    return true;
+}
+
+
+void UMaxQFlightRecorderComponent::Flush()
+{
+    Send();
+}
+
+
+void UMaxQFlightRecorderComponent::GetRecentSamples(TArray<FMaxQFlightSample>& Samples) const
+{
+    Samples.Reset(RingNum);
+    for (int32 i = 0; i < RingNum; ++i)
+    {
+        Samples.Add(Ring[(RingStart + i) % Ring.Num()]);
+    }
+}
+
+
+void UMaxQFlightRecorderComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (bRecording && bSampleOwner)
+    {
+        FSEphemerisTime et = Epoch;
+        if (bFollowSubsystem)
+        {
+            if (const UMaxQEphemerisSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr)
+            {
+                et = Subsystem->Epoch;
+            }
+        }
+
+        if (RingNum == 0 || et.seconds >= Ring[(RingStart + RingNum - 1) % Ring.Num()].et.seconds + SampleInterval)
+        {
+            SampleOwner(et);
+        }
+    }
+
+    Poll();
+}
+
+
+void UMaxQFlightRecorderComponent::SampleOwner(const FSEphemerisTime& et)
+{
+    const USceneComponent* Root = GetOwner() ? GetOwner()->GetRootComponent() : nullptr;
+    if (!Root || Scale <= 0.)
+    {
+        return;
+    }
+
+    FSStateVector State;
+    State.r = MaxQ::Math::Swizzle<FSDistanceVector>(Root->GetRelativeLocation() / Scale);
+
+    // From the previous sample
+    if (RingNum > 0)
+    {
+        const FMaxQFlightSample& Previous = Ring[(RingStart + RingNum - 1) % Ring.Num()];
+        const double dt = et.seconds - Previous.et.seconds;
+        if (dt > 0.)
+        {
+            double r[3], r0[3];
+            State.r.CopyTo(r);
+            Previous.State.r.CopyTo(r0);
+            State.v = FSVelocityVector((r[0] - r0[0]) / dt, (r[1] - r0[1]) / dt, (r[2] - r0[2]) / dt);
+        }
+    }
+
+    // The actor's rotation takes it to its parent's frame;  the C-matrix goes
+    // the other way
+    const FSQuaternion Orientation = MaxQ::Math::Swizzle(Root->GetRelativeRotation().Quaternion().Inverse());
+
+    Record(et, State, Orientation);
+}
+
+
+void UMaxQFlightRecorderComponent::Send()
+{
+    if (!bRecording || Unsent == 0)
+    {
+        return;
+    }
+
+    TArray<FMaxQFlightSample> Samples;
+    Samples.Reserve(Unsent);
+    for (int32 i = RingNum - Unsent; i < RingNum; ++i)
+    {
+        Samples.Add(Ring[(RingStart + i) % Ring.Num()]);
+    }
+    Unsent = 0;
+
+    FSpiceExecutor::Get().EnqueueCommand([Writing = Session, Samples = MoveTemp(Samples)]() { Writing->Write(Samples); });
+}
+
+
+void UMaxQFlightRecorderComponent::Poll()
+{
+    auto Report = [this](FSession& Reporting)
+    {
+        FString ErrorMessage;
+        if (!Reporting.bReported && Reporting.GetError(ErrorMessage))
+        {
+            Reporting.bReported = true;
+            OnError.Broadcast(ErrorMessage);
+        }
+    };
+
+    if (Session.IsValid())
+    {
+        Report(*Session);
+    }
+
+    for (int32 i = Closing.Num() - 1; i >= 0; --i)
+    {
+        if (Closing[i]->bClosed)
+        {
+            Report(*Closing[i]);
+            Closing.RemoveAt(i);
+            OnFinished.Broadcast();
+        }
+    }
+}
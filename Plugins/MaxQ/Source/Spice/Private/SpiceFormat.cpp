@@ -0,0 +1,354 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFormat.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Formatting values into caller owned string builders.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFormat.cpp is part of the "refined C++ API".
+//
+// The angle formats reproduce what USpiceTypes::formatAngle's stream did,
+// quirks included (HMS's trailing space without fractional seconds, etc).
+// Its setw(precision + 2) never padded anything:  a fixed value with
+// precision decimals is at least that long.
+//
+// AppendDouble goes through snprintf into a stack buffer, which is what the
+// stream did underneath.  AppendFixed rounds |value| * 10^decimals to an
+// integer when that's below 2^53, and prints the integer and fractional
+// parts.  The product is rounded itself, so fma checks what's left over:
+// within a thousandth of a tie, the rounding could go either way, and that
+// (like anything larger, or not finite) goes to snprintf.
+//------------------------------------------------------------------------------
+
+#include "SpiceFormat.h"
+#include "SpiceUtilities.h"
+#include "SpiceTime.h"
+#include "Spice.h"
+#include <cmath>
+#include <cstdio>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double Pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    constexpr double MaxExact = 9007199254740992.;  // 2^53
+
+    inline void AppendAnsi(FStringBuilderBase& sb, const char* s, int32 Len)
+    {
+        for (int32 i = 0; i < Len; ++i)
+        {
+            sb.AppendChar((TCHAR)s[i]);
+        }
+    }
+
+    // Digits of n, zero padded to MinDigits
+    inline void AppendUnsigned(FStringBuilderBase& sb, uint64 n, int32 MinDigits = 1)
+    {
+        TCHAR Digits[24];
+        int32 Len = 0;
+        do
+        {
+            Digits[Len++] = TCHAR('0' + n % 10);
+            n /= 10;
+        } while (n > 0 || Len < MinDigits);
+
+        while (Len > 0)
+        {
+            sb.AppendChar(Digits[--Len]);
+        }
+    }
+
+    // printf's %ld, and %02ld
+    inline void AppendInteger(FStringBuilderBase& sb, long n, int32 MinDigits = 1)
+    {
+        if (n < 0)
+        {
+            sb.AppendChar(TCHAR('-'));
+        }
+        AppendUnsigned(sb, n < 0 ? 0ull - (uint64)n : (uint64)n, MinDigits);
+    }
+
+    void AppendAngleDegrees(FStringBuilderBase& sb, double degrees, ES_AngleFormat format, int32 precision)
+    {
+        using namespace MaxQ::Format;
+
+        switch (format)
+        {
+        case ES_AngleFormat::DD:
+            AppendFixed(sb, degrees, precision);
+            break;
+        case ES_AngleFormat::DD_180:
+            AppendFixed(sb, USpiceTypes::normalize180to180(degrees), precision);
+            break;
+        case ES_AngleFormat::DD_360:
+            AppendFixed(sb, USpiceTypes::normalize0to360(degrees), precision);
+            break;
+        case ES_AngleFormat::DMS:
+        case ES_AngleFormat::HMS:
+        {
+            const bool bHours = format == ES_AngleFormat::HMS;
+            const int32 frac_precision = precision - 7;
+            double frac = FMath::Abs(bHours ? degrees / 360. * 24 : degrees);
+
+            long whole = (long)floor(frac);
+            frac -= (double)whole;
+            if (degrees < 0.) whole *= -1;
+            AppendInteger(sb, whole);
+            sb.Append(bHours ? TEXT("h ") : TEXT(" "));
+
+            frac *= 60.;
+            const long minutes = (long)floor(frac);
+            frac -= (double)minutes;
+            AppendInteger(sb, minutes, 2);
+            sb.Append(bHours ? TEXT("m ") : TEXT("'"));
+
+            frac *= 60;
+            if (frac_precision <= 0)
+            {
+                AppendInteger(sb, lround(frac), 2);
+                sb.Append(bHours ? TEXT("s ") : TEXT("\""));
+            }
+            else
+            {
+                AppendFixed(sb, frac, frac_precision + 2);
+                sb.Append(bHours ? TEXT("s") : TEXT("\""));
+            }
+            break;
+        }
+        case ES_AngleFormat::DR_PI:
+            AppendFixed(sb, USpiceTypes::normalizePiToPi(degrees / 360. * FSAngle::twopi), precision);
+            break;
+        case ES_AngleFormat::DR_2PI:
+            AppendFixed(sb, USpiceTypes::normalizeZeroToTwoPi(degrees / 360. * FSAngle::twopi), precision);
+            break;
+        default:
+            AppendFixed(sb, degrees / 360. * FSAngle::twopi, precision);
+            break;
+        }
+    }
+
+    inline double Convert(double value, ES_Units From, ES_Units To)
+    {
+        if (To != From)
+        {
+            convrt_c(value, MaxQ::Core::ToANSIString(From), MaxQ::Core::ToANSIString(To), &value);
+            UnexpectedErrorCheck(false);
+        }
+        return value;
+    }
+}
+
+
+namespace MaxQ::Format
+{
+    void AppendDouble(FStringBuilderBase& sb, double value, int32 precision)
+    {
+        char Buffer[64];
+        const int Len = snprintf(Buffer, sizeof(Buffer), "%.*g", (int)precision, value);
+        AppendAnsi(sb, Buffer, FMath::Clamp(Len, 0, (int)sizeof(Buffer) - 1));
+    }
+
+
+    void AppendFixed(FStringBuilderBase& sb, double value, int32 decimals)
+    {
+        decimals = FMath::Max(decimals, 0);
+
+        const double Magnitude = FMath::Abs(value);
+        const double Scaled = decimals < (int32)UE_ARRAY_COUNT(Pow10) ? Magnitude * Pow10[decimals] : MaxExact;
+        const double Rounded = nearbyint(Scaled);
+
+        // What rounding left over, without the product's own rounding error
+        const double Residual = Scaled < MaxExact ? std::fma(Magnitude, Pow10[decimals], -Rounded) : 0.;
+
+        if (!(Scaled < MaxExact) || FMath::Abs(Residual) > 0.5 - 1.e-3)
+        {
+            // Big, NaN, infinite, or too close to a tie to be sure:  up to 309
+            // integer digits
+            char Buffer[400];
+            const int Len = snprintf(Buffer, sizeof(Buffer), "%.*f", (int)FMath::Min(decimals, 64), value);
+            AppendAnsi(sb, Buffer, FMath::Clamp(Len, 0, (int)sizeof(Buffer) - 1));
+            return;
+        }
+
+        const uint64 n = (uint64)Rounded;
+        const uint64 Scale = (uint64)Pow10[decimals];
+
+        if (std::signbit(value))
+        {
+            sb.AppendChar(TCHAR('-'));
+        }
+        AppendUnsigned(sb, n / Scale);
+        if (decimals > 0)
+        {
+            sb.AppendChar(TCHAR('.'));
+            AppendUnsigned(sb, n % Scale, decimals);
+        }
+    }
+
+
+    void AppendAngle(FStringBuilderBase& sb, const FSAngle& value, ES_AngleFormat format, int32 precision)
+    {
+        AppendAngleDegrees(sb, value.degrees, format, precision);
+    }
+
+
+    void AppendLonLat(FStringBuilderBase& sb, const FSLonLat& value, FStringView separator, ES_AngleFormat format, int32 precision)
+    {
+        double longitude = value.longitude.degrees;
+        double latitude = USpiceTypes::normalize180to180(value.latitude.degrees);
+
+        // Latitudes past the poles come down the other side
+        if (latitude > 90.)
+        {
+            longitude += 180.;
+            latitude = 180. - latitude;
+        }
+        else if (latitude < -90.)
+        {
+            longitude -= 180.;
+            latitude = -180. + latitude;
+        }
+
+        longitude = USpiceTypes::normalize180to180(longitude);
+
+        AppendAngleDegrees(sb, FMath::Abs(longitude), format, precision);
+        sb.AppendChar(longitude < 0 ? TCHAR('W') : TCHAR('E'));
+        sb.Append(separator);
+        AppendAngleDegrees(sb, FMath::Abs(latitude), format, precision);
+        sb.AppendChar(latitude < 0 ? TCHAR('S') : TCHAR('N'));
+    }
+
+
+    void AppendRADec(FStringBuilderBase& sb, const FSAngle& rightAscension, const FSAngle& declination, FStringView separator, int32 precision)
+    {
+        double ra = rightAscension.degrees;
+        double dec = USpiceTypes::normalize180to180(declination.degrees);
+
+        if (dec > 90.)
+        {
+            ra += 180.;
+            dec = 180 - dec;
+        }
+        else if (dec < -90.)
+        {
+            ra -= 180.;
+            dec = -180 + dec;
+        }
+
+        ra = USpiceTypes::normalize0to360(ra);
+
+        AppendAngleDegrees(sb, ra, ES_AngleFormat::HMS, precision);
+        sb.Append(separator);
+        AppendAngleDegrees(sb, dec, ES_AngleFormat::DMS, precision);
+    }
+
+
+    void AppendDistance(FStringBuilderBase& sb, const FSDistance& distance, ES_Units Units, int32 precision)
+    {
+        AppendDouble(sb, Convert(distance.AsKilometers(), ES_Units::KILOMETERS, Units), precision);
+    }
+
+
+    void AppendPeriod(FStringBuilderBase& sb, const FSEphemerisPeriod& period, ES_Units Units, int32 precision)
+    {
+        AppendDouble(sb, Convert(period.AsSeconds(), ES_Units::SECONDS, Units), precision);
+    }
+
+
+    void AppendSpeed(FStringBuilderBase& sb, const FSSpeed& speed, ES_Units NumeratorUnits, ES_Units DenominatorUnits, int32 precision)
+    {
+        double value = Convert(speed.AsKilometersPerSecond(), ES_Units::KILOMETERS, NumeratorUnits);
+        if (DenominatorUnits != ES_Units::SECONDS)
+        {
+            double denominator = 1.;
+            convrt_c(denominator, MaxQ::Core::ToANSIString(ES_Units::SECONDS), MaxQ::Core::ToANSIString(DenominatorUnits), &denominator);
+            value *= denominator;
+        }
+        AppendDouble(sb, value, precision);
+    }
+
+
+    void AppendUtcTime(FStringBuilderBase& sb, const FSEphemerisTime& et, ES_UTCTimeFormat TimeFormat, int32 precision)
+    {
+        if (MaxQ::Time::UpdateTimeSystem())
+        {
+            TCHAR Buffer[64];
+            const int32 Len = MaxQ::Time::GetTimeSystem()->Format(et.AsSpiceDouble(), TimeFormat, precision, Buffer, UE_ARRAY_COUNT(Buffer));
+            if (Len)
+            {
+                sb.Append(Buffer, Len);
+                return;
+            }
+        }
+
+        // Outside the time system's calendar range
+        sb.Append(USpiceTypes::FormatUtcTime(et, TimeFormat, precision));
+    }
+
+
+    void Append(FStringBuilderBase& sb, const FSDistanceVector& value)
+    {
+        sb.AppendChar(TCHAR('('));
+        AppendDouble(sb, value.x.km);
+        sb.Append(TEXT(", "));
+        AppendDouble(sb, value.y.km);
+        sb.Append(TEXT(", "));
+        AppendDouble(sb, value.z.km);
+        sb.AppendChar(TCHAR(')'));
+    }
+
+
+    void Append(FStringBuilderBase& sb, const FSVelocityVector& value)
+    {
+        sb.AppendChar(TCHAR('('));
+        AppendDouble(sb, value.dx.kmps);
+        sb.Append(TEXT(", "));
+        AppendDouble(sb, value.dy.kmps);
+        sb.Append(TEXT(", "));
+        AppendDouble(sb, value.dz.kmps);
+        sb.AppendChar(TCHAR(')'));
+    }
+
+
+    void Append(FStringBuilderBase& sb, const FSDimensionlessVector& value)
+    {
+        sb.AppendChar(TCHAR('('));
+        AppendDouble(sb, value.x);
+        sb.Append(TEXT(", "));
+        AppendDouble(sb, value.y);
+        sb.Append(TEXT(", "));
+        AppendDouble(sb, value.z);
+        sb.AppendChar(TCHAR(')'));
+    }
+
+
+    void Append(FStringBuilderBase& sb, const FSStateVector& value)
+    {
+        sb.AppendChar(TCHAR('['));
+        Append(sb, value.r);
+        sb.Append(TEXT("; "));
+        Append(sb, value.v);
+        sb.AppendChar(TCHAR(']'));
+    }
+}
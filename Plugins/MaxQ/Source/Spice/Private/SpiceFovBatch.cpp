@@ -0,0 +1,483 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFovBatch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Field of view tests for many targets, against many instruments.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFovBatch.cpp is part of the "refined C++ API".
+//
+// The setup follows zzgffvin:  the FOV axis is the boresight for circles
+// and ellipses, and the mean of the unit boundary vectors for polygons
+// (zzfovaxi).  The bounding cone's angle is the largest separation of a
+// boundary vector from the axis, and FOVs wider than pi/2 - 1e-6 are
+// rejected, as there.  The FOV plane is the plane at unit distance along
+// the axis;  ellipses' semi-axes are where their boundary vectors meet it.
+//
+// A convex polygon's cone is the intersection of the half-spaces on the
+// inside of each edge's plane, and that's the same answer as zzwind2d's
+// non-zero winding number there, without projecting.
+//------------------------------------------------------------------------------
+
+#include "SpiceFovBatch.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double halfpi = 3.14159265358979323846 / 2.;
+
+    // getfov_c's room, and string sizes
+    constexpr SpiceInt MaxBounds = 1000;
+    constexpr SpiceInt WordSize = 81;
+
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    bool Fail(const TCHAR* Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = FString(TEXT("FInstrumentFov: ")) + Message;
+        return false;
+    }
+
+    inline double Dot(const double(&a)[3], const double(&b)[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    inline void Cross(const double(&a)[3], const double(&b)[3], double(&r)[3])
+    {
+        r[0] = a[1] * b[2] - a[2] * b[1];
+        r[1] = a[2] * b[0] - a[0] * b[2];
+        r[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    inline bool Normalize(double(&v)[3])
+    {
+        const double l = sqrt(Dot(v, v));
+        if (l == 0.)
+        {
+            return false;
+        }
+        v[0] /= l; v[1] /= l; v[2] /= l;
+        return true;
+    }
+
+    // vsep
+    inline double Separation(const double(&a)[3], const double(&b)[3])
+    {
+        double c[3];
+        Cross(a, b, c);
+        return atan2(sqrt(Dot(c, c)), Dot(a, b));
+    }
+
+    // zzwind2d:  the winding number of a polygon (u, v per vertex) about a
+    // point
+    int32 Winding(TArrayView<const double> Vertices, double u, double v)
+    {
+        const int32 Num = Vertices.Num() / 2;
+        int32 w = 0;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const int32 j = (i + 1) % Num;
+            const double u0 = Vertices[2 * i] - u, v0 = Vertices[2 * i + 1] - v;
+            const double u1 = Vertices[2 * j] - u, v1 = Vertices[2 * j + 1] - v;
+            const double Side = u0 * v1 - u1 * v0;
+            if (v0 <= 0.)
+            {
+                if (v1 > 0. && Side > 0.) ++w;
+            }
+            else if (v1 <= 0. && Side < 0.)
+            {
+                --w;
+            }
+        }
+        return w;
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    bool FInstrumentFov::Load(int instid, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        SpiceChar   _shape[WordSize] = {};
+        SpiceChar   _frame[WordSize] = {};
+        SpiceDouble _bsight[3] = {};
+        SpiceInt    _n = 0;
+        TArray<SpiceDouble> _bounds;
+        _bounds.SetNumZeroed(3 * MaxBounds);
+
+        getfov_c(instid, MaxBounds, WordSize, WordSize, _shape, _frame, _bsight, &_n, reinterpret_cast<SpiceDouble(*)[3]>(_bounds.GetData()));
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            Shape = EShape::None;
+            return false;
+        }
+
+        TArray<FSDimensionlessVector> bounds;
+        bounds.Reserve(_n);
+        for (int32 i = 0; i < _n; ++i)
+        {
+            bounds.Emplace(_bounds[3 * i], _bounds[3 * i + 1], _bounds[3 * i + 2]);
+        }
+
+        return Set(FString(_shape), FString(_frame), FSDimensionlessVector(_bsight), bounds, ResultCode, ErrorMessage);
+    }
+
+
+    bool FInstrumentFov::Load(const FString& inst, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        SpiceInt _instid = 0;
+        if (!ResolveBody(TCHAR_TO_ANSI(*inst), _instid))
+        {
+            ErrorCheck(ResultCode, ErrorMessage);
+            Shape = EShape::None;
+            return false;
+        }
+        return Load(_instid, ResultCode, ErrorMessage);
+    }
+
+
+    bool FInstrumentFov::Set(
+        const FString& shape,
+        const FString& frame,
+        const FSDimensionlessVector& bsight,
+        TArrayView<const FSDimensionlessVector> bounds,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Shape = EShape::None;
+        Planes.Reset();
+        Vertices.Reset();
+
+        const FString Name = shape.TrimStartAndEnd().ToUpper();
+        const bool bPolygon = Name == TEXT("POLYGON") || Name == TEXT("RECTANGLE");
+        if (!bPolygon && Name != TEXT("CIRCLE") && Name != TEXT("ELLIPSE"))
+        {
+            return Fail(TEXT("the only supported shapes are CIRCLE, ELLIPSE, RECTANGLE and POLYGON"), ResultCode, ErrorMessage);
+        }
+
+        const int32 MinBounds = bPolygon ? 3 : Name == TEXT("ELLIPSE") ? 2 : 1;
+        if (bounds.Num() < MinBounds)
+        {
+            return Fail(TEXT("too few boundary vectors for the FOV's shape"), ResultCode, ErrorMessage);
+        }
+
+        TArray<double> Unit;
+        Unit.SetNumUninitialized(3 * bounds.Num());
+        for (int32 i = 0; i < bounds.Num(); ++i)
+        {
+            double b[3];
+            bounds[i].CopyTo(b);
+            if (!Normalize(b))
+            {
+                return Fail(TEXT("boundary vectors must be non-zero"), ResultCode, ErrorMessage);
+            }
+            Unit[3 * i] = b[0]; Unit[3 * i + 1] = b[1]; Unit[3 * i + 2] = b[2];
+        }
+        auto Bound = [&Unit](int32 i, double(&b)[3]) { b[0] = Unit[3 * i]; b[1] = Unit[3 * i + 1]; b[2] = Unit[3 * i + 2]; };
+
+        // zzfovaxi
+        double a[3] = { 0., 0., 0. };
+        if (bPolygon)
+        {
+            for (int32 i = 0; i < bounds.Num(); ++i)
+            {
+                a[0] += Unit[3 * i]; a[1] += Unit[3 * i + 1]; a[2] += Unit[3 * i + 2];
+            }
+        }
+        else
+        {
+            bsight.CopyTo(a);
+        }
+        if (!Normalize(a))
+        {
+            return Fail(TEXT("the FOV axis is the zero vector"), ResultCode, ErrorMessage);
+        }
+
+        double Radius = 0.;
+        for (int32 i = 0; i < bounds.Num(); ++i)
+        {
+            double b[3];
+            Bound(i, b);
+            Radius = FMath::Max(Radius, Separation(b, a));
+        }
+        if (Radius > halfpi - 1.e-6)
+        {
+            return Fail(TEXT("the FOV's angular radius exceeds 90 degrees"), ResultCode, ErrorMessage);
+        }
+
+        FMemory::Memcpy(Axis, a, sizeof(Axis));
+        CosRadius = cos(Radius);
+
+        // An orthonormal basis for the FOV plane
+        double e[3] = { 0., 0., 0. };
+        e[FMath::Abs(a[0]) < FMath::Abs(a[1]) ? (FMath::Abs(a[0]) < FMath::Abs(a[2]) ? 0 : 2) : (FMath::Abs(a[1]) < FMath::Abs(a[2]) ? 1 : 2)] = 1.;
+        Cross(a, e, U);
+        Normalize(U);
+        Cross(a, U, V);
+
+        if (Name == TEXT("CIRCLE"))
+        {
+            Shape = EShape::Circle;
+        }
+        else if (Name == TEXT("ELLIPSE"))
+        {
+            // Where the boundary vectors meet the FOV plane, relative to its
+            // center
+            double s[2][3];
+            for (int32 k = 0; k < 2; ++k)
+            {
+                double b[3];
+                Bound(k, b);
+                const double d = Dot(b, a);
+                for (int32 j = 0; j < 3; ++j)
+                {
+                    s[k][j] = b[j] / d - a[j];
+                }
+            }
+            SemiU = sqrt(Dot(s[0], s[0]));
+            SemiV = sqrt(Dot(s[1], s[1]));
+            if (SemiU == 0. || SemiV == 0.)
+            {
+                return Fail(TEXT("an ellipse's semi-axes must be non-zero"), ResultCode, ErrorMessage);
+            }
+            for (int32 j = 0; j < 3; ++j)
+            {
+                U[j] = s[0][j] / SemiU;
+                V[j] = s[1][j] / SemiV;
+            }
+            Shape = EShape::Ellipse;
+        }
+        else
+        {
+            // Convex if every edge has the other vertices on the axis' side
+            const int32 Num = bounds.Num();
+            bool bConvex = true;
+            Planes.SetNumUninitialized(3 * Num);
+            for (int32 i = 0; i < Num && bConvex; ++i)
+            {
+                double b0[3], b1[3], n[3];
+                Bound(i, b0);
+                Bound((i + 1) % Num, b1);
+                Cross(b0, b1, n);
+                if (Dot(n, a) < 0.)
+                {
+                    n[0] = -n[0]; n[1] = -n[1]; n[2] = -n[2];
+                }
+                bConvex = Normalize(n);
+                for (int32 j = 0; j < Num && bConvex; ++j)
+                {
+                    double b[3];
+                    Bound(j, b);
+                    bConvex = Dot(n, b) >= -1.e-12;
+                }
+                Planes[3 * i] = n[0]; Planes[3 * i + 1] = n[1]; Planes[3 * i + 2] = n[2];
+            }
+
+            if (bConvex)
+            {
+                Shape = EShape::ConvexPolygon;
+            }
+            else
+            {
+                Planes.Reset();
+                Vertices.SetNumUninitialized(2 * Num);
+                for (int32 i = 0; i < Num; ++i)
+                {
+                    double b[3];
+                    Bound(i, b);
+                    const double d = Dot(b, a);
+                    Vertices[2 * i] = Dot(b, U) / d;
+                    Vertices[2 * i + 1] = Dot(b, V) / d;
+                }
+                Shape = EShape::Polygon;
+            }
+        }
+
+        FrameName = frame;
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FInstrumentFov::Contains(double x, double y, double z) const
+    {
+        // The bounding cone first
+        const double Length = sqrt(x * x + y * y + z * z);
+        const double Along = x * Axis[0] + y * Axis[1] + z * Axis[2];
+        if (Length == 0. || Along < CosRadius * Length)
+        {
+            return false;
+        }
+
+        switch (Shape)
+        {
+        case EShape::Circle:
+            return true;
+
+        case EShape::Ellipse:
+        {
+            // Where the direction meets the FOV plane.  Along > 0:  the cone
+            // is narrower than pi/2.
+            const double s = 1. / Along;
+            const double cu = (s * (x * U[0] + y * U[1] + z * U[2])) / SemiU;
+            const double cv = (s * (x * V[0] + y * V[1] + z * V[2])) / SemiV;
+            return cu * cu + cv * cv <= 1.;
+        }
+
+        case EShape::ConvexPolygon:
+        {
+            const double* n = Planes.GetData();
+            for (int32 i = 0; i < Planes.Num(); i += 3)
+            {
+                if (n[i] * x + n[i + 1] * y + n[i + 2] * z < 0.)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        case EShape::Polygon:
+        {
+            const double s = 1. / Along;
+            return Winding(Vertices, s * (x * U[0] + y * U[1] + z * U[2]), s * (x * V[0] + y * V[1] + z * V[2])) != 0;
+        }
+
+        default:
+            return false;
+        }
+    }
+
+
+    void FInstrumentFov::Visible(const FConstVectorBatch& Directions, TArrayView<uint8> bVisible) const
+    {
+        const int32 Num = Directions.Num();
+        check(Directions.Y.Num() >= Num && Directions.Z.Num() >= Num && bVisible.Num() >= Num);
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                bVisible[i] = Contains(Directions.X[i], Directions.Y[i], Directions.Z[i]) ? 1 : 0;
+            }
+        }, Num <= ChunkSize);
+    }
+
+
+    void FInstrumentFov::Visible(
+        const FSDistanceVector& Observer,
+        const FSRotationMatrix& ToInstrument,
+        const FConstVectorBatch& Targets,
+        TArrayView<uint8> bVisible
+    ) const
+    {
+        const int32 Num = Targets.Num();
+        check(Targets.Y.Num() >= Num && Targets.Z.Num() >= Num && bVisible.Num() >= Num);
+
+        double o[3], m[3][3];
+        Observer.CopyTo(o);
+        ToInstrument.CopyTo(m);
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const double x = Targets.X[i] - o[0], y = Targets.Y[i] - o[1], z = Targets.Z[i] - o[2];
+                bVisible[i] = Contains(
+                    m[0][0] * x + m[0][1] * y + m[0][2] * z,
+                    m[1][0] * x + m[1][1] * y + m[1][2] * z,
+                    m[2][0] * x + m[2][1] * y + m[2][2] * z) ? 1 : 0;
+            }
+        }, Num <= ChunkSize);
+    }
+
+
+    bool FovVisibility(
+        TArrayView<const FFovSensor> Sensors,
+        const FConstVectorBatch& Targets,
+        TArrayView<uint64> Masks
+    )
+    {
+        const int32 Num = Targets.Num();
+        if (Sensors.Num() > 64 || Targets.Y.Num() != Num || Targets.Z.Num() != Num || Masks.Num() < Num)
+        {
+            return false;
+        }
+
+        struct FUnpacked
+        {
+            const FInstrumentFov* Fov;
+            double o[3];
+            double m[3][3];
+        };
+        TArray<FUnpacked, TInlineAllocator<64>> Unpacked;
+        for (const FFovSensor& Sensor : Sensors)
+        {
+            if (!Sensor.Fov || !Sensor.Fov->IsValid())
+            {
+                return false;
+            }
+            FUnpacked& u = Unpacked.AddDefaulted_GetRef();
+            u.Fov = Sensor.Fov;
+            Sensor.Observer.CopyTo(u.o);
+            Sensor.ToInstrument.CopyTo(u.m);
+        }
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const double t[3] = { Targets.X[i], Targets.Y[i], Targets.Z[i] };
+
+                uint64 Mask = 0;
+                for (int32 s = 0; s < Unpacked.Num(); ++s)
+                {
+                    const FUnpacked& u = Unpacked[s];
+                    const double x = t[0] - u.o[0], y = t[1] - u.o[1], z = t[2] - u.o[2];
+                    if (u.Fov->Contains(
+                        u.m[0][0] * x + u.m[0][1] * y + u.m[0][2] * z,
+                        u.m[1][0] * x + u.m[1][1] * y + u.m[1][2] * z,
+                        u.m[2][0] * x + u.m[2][1] * y + u.m[2][2] * z))
+                    {
+                        Mask |= uint64(1) << s;
+                    }
+                }
+                Masks[i] = Mask;
+            }
+        }, Num <= ChunkSize);
+
+        return true;
+    }
+}
@@ -0,0 +1,749 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFrameHandle.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Precompiled (from, to) frame transformations.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFrameHandle.cpp is part of the "refined C++ API".
+//
+// Each link maps its frame towards J2000, as frmchg does:  fixed links
+// with tkfram (or pxform at any epoch, for inertial frames), PCK links with
+// the transpose of tipbod's J2000->body-fixed matrix (or FPckOrientation's,
+// which is the same, for bodies with text PCK constants).  A chain's result is
+// the product of its links, and from->to is (to->end)^T * (from->end).
+//
+// State transformations are [R 0; D R], so links are composed as (R, D)
+// pairs:  (R2, D2) * (R1, D1) = (R2 R1, D2 R1 + R2 D1), and the inverse of
+// (R, D) is (R^T, D^T).
+//
+// Dynamic and switch frames ("Other" links) cost pxform/sxform a trip
+// through CSPICE's dynamic frame machinery, nested SPK lookups included.
+// Their rotation to J2000 depends on nothing but the frame, the epoch and
+// the loaded kernels, so every handle shares one memo of them:  the last
+// epoch each frame was evaluated at, forgotten when the pool generation
+// moves.  Many objects in GSE or an LVLH frame at one epoch evaluate it once.
+//------------------------------------------------------------------------------
+
+#include "SpiceFrameHandle.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr SpiceInt J2000Id = 1;
+
+    // Frame classes (frinfo_c)
+    constexpr SpiceInt InertialClass = 1;
+    constexpr SpiceInt PckClass = 2;
+    constexpr SpiceInt CkClass = 3;
+    constexpr SpiceInt TkClass = 4;
+
+    // No real frame tree is this deep.  A cycle in TK definitions would be.
+    constexpr int32 MaxHops = 32;
+
+    constexpr int32 MaxCkDepth = 8;
+
+    void Identity(double (&m)[3][3])
+    {
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                m[i][j] = i == j ? 1. : 0.;
+            }
+        }
+    }
+
+    void Copy(const double (&from)[3][3], double (&to)[3][3])
+    {
+        FMemory::Memcpy(to, from, sizeof(to));
+    }
+
+    // The R and D blocks of a 6x6 state transformation
+    void Split(const double (&x)[6][6], double (&r)[3][3], double (&d)[3][3])
+    {
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                r[i][j] = x[i][j];
+                d[i][j] = x[i + 3][j];
+            }
+        }
+    }
+
+    void Join(const double (&r)[3][3], const double (&d)[3][3], double (&x)[6][6])
+    {
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                x[i][j] = x[i + 3][j + 3] = r[i][j];
+                x[i + 3][j] = d[i][j];
+                x[i][j + 3] = 0.;
+            }
+        }
+    }
+
+    // (r, d) = (lr, ld) * (r, d)
+    void Compose(const double (&lr)[3][3], const double (&ld)[3][3], double (&r)[3][3], double (&d)[3][3])
+    {
+        double dr[3][3], rd[3][3];
+        mxm_c(ld, r, dr);
+        mxm_c(lr, d, rd);
+        mxm_c(lr, r, r);
+        vaddg_c(&dr[0][0], &rd[0][0], 9, &d[0][0]);
+    }
+
+    // An "Other" link's frame to J2000, at the last epoch it was evaluated
+    struct FDynamicFrameEntry
+    {
+        double et = 0.;
+        // d is only set if the entry came from sxform
+        bool bState = false;
+        double r[3][3];
+        double d[3][3];
+    };
+
+    struct FDynamicFrameMemo
+    {
+        uint64 PoolGeneration = 0;
+        TMap<int32, FDynamicFrameEntry> Entries;
+    };
+
+    // Like the handles, only used from the thread that makes SPICE calls
+    FDynamicFrameMemo& DynamicFrames()
+    {
+        static FDynamicFrameMemo Instance;
+
+        const uint64 PoolGeneration = MaxQ::Data::GetPoolGeneration();
+        if (Instance.PoolGeneration != PoolGeneration)
+        {
+            Instance.Entries.Reset();
+            Instance.PoolGeneration = PoolGeneration;
+        }
+        return Instance;
+    }
+
+    // pxform(name, "J2000", et), memoized
+    void DynamicRotation(int32 Frame, const ANSICHAR* Name, double et, double (&r)[3][3])
+    {
+        FDynamicFrameMemo& Memo = DynamicFrames();
+        if (const FDynamicFrameEntry* Found = Memo.Entries.Find(Frame); Found && Found->et == et)
+        {
+            MAXQ_CACHE_EVENT(DynamicFrameHits);
+            Copy(Found->r, r);
+            return;
+        }
+
+        MAXQ_CACHE_EVENT(DynamicFrameMisses);
+        pxform_c(Name, "J2000", et, r);
+        if (!failed_c())
+        {
+            FDynamicFrameEntry& Entry = Memo.Entries.FindOrAdd(Frame);
+            Entry.et = et;
+            Entry.bState = false;
+            Copy(r, Entry.r);
+        }
+    }
+
+    // sxform(name, "J2000", et), as (R, D), memoized
+    void DynamicTransform(int32 Frame, const ANSICHAR* Name, double et, double (&r)[3][3], double (&d)[3][3])
+    {
+        FDynamicFrameMemo& Memo = DynamicFrames();
+        if (const FDynamicFrameEntry* Found = Memo.Entries.Find(Frame); Found && Found->et == et && Found->bState)
+        {
+            MAXQ_CACHE_EVENT(DynamicFrameHits);
+            Copy(Found->r, r);
+            Copy(Found->d, d);
+            return;
+        }
+
+        MAXQ_CACHE_EVENT(DynamicFrameMisses);
+        double x[6][6];
+        sxform_c(Name, "J2000", et, x);
+        Split(x, r, d);
+        if (!failed_c())
+        {
+            FDynamicFrameEntry& Entry = Memo.Entries.FindOrAdd(Frame);
+            Entry.et = et;
+            Entry.bState = true;
+            Copy(r, Entry.r);
+            Copy(d, Entry.d);
+        }
+    }
+}
+
+
+FSpiceFrameHandle FSpiceFrameHandle::Compile(
+    const FString& from,
+    const FString& to,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+)
+{
+    FSpiceFrameHandle Handle;
+    Handle.From = from;
+    Handle.To = to;
+
+    Handle.Resolve();
+
+    ErrorCheck(ResultCode, ErrorMessage);
+    return Handle;
+}
+
+
+bool FSpiceFrameHandle::CompileChain(int32 Frame, FChain& Chain)
+{
+    Chain.Reset();
+
+    SpiceChar _name[64];
+    SpiceInt _current = Frame;
+
+    for (int32 Hops = 0; _current != J2000Id; ++Hops)
+    {
+        if (Hops == MaxHops)
+        {
+            setmsg_c("Frame # is more than # links from J2000.");
+            errint_c("#", Frame);
+            errint_c("#", MaxHops);
+            sigerr_c("SPICE(TOOMANYHOPS)");
+            return false;
+        }
+
+        SpiceInt _cent = 0, _frclss = 0, _clssid = 0;
+        SpiceBoolean _found = SPICEFALSE;
+        frinfo_c(_current, &_cent, &_frclss, &_clssid, &_found);
+        if (!_found && !failed_c())
+        {
+            setmsg_c("The reference frame # is not recognized.");
+            errint_c("#", _current);
+            sigerr_c("SPICE(UNKNOWNFRAME)");
+        }
+        if (failed_c())
+        {
+            return false;
+        }
+
+        FLink& Link = Chain.AddDefaulted_GetRef();
+        Link.Frame = _current;
+
+        switch (_frclss)
+        {
+        case InertialClass:
+            // Inertial frames don't move with respect to each other
+            frmnam_c(_current, sizeof(_name), _name);
+            pxform_c(_name, "J2000", 0., Link.Rotation);
+            _current = J2000Id;
+            break;
+        case TkClass:
+        {
+            SpiceInt _base = 0;
+            tkfram_c(_current, Link.Rotation, &_base, &_found);
+            if (!_found && !failed_c())
+            {
+                setmsg_c("TK frame # has no definition in the kernel pool.");
+                errint_c("#", _current);
+                sigerr_c("SPICE(NOFRAMECONNECT)");
+            }
+            _current = _base;
+            break;
+        }
+        case PckClass:
+            Link.Type = ELinkType::Pck;
+            Link.Id = _clssid;
+            if (bodfnd_c(_clssid, "PM"))
+            {
+                auto Orientation = MaxQ::Frames::GetPckOrientation(_clssid);
+                if (Orientation->IsValid())
+                {
+                    Link.Orientation = Orientation;
+                }
+            }
+            _current = J2000Id;
+            break;
+        case CkClass:
+            // The base comes with the data
+            Link.Type = ELinkType::Ck;
+            Link.Id = _clssid;
+            return !failed_c();
+        default:
+            frmnam_c(_current, sizeof(_name), _name);
+            Link.Type = ELinkType::Other;
+            Link.Name = FSpiceName(ANSI_TO_TCHAR(_name));
+            _current = J2000Id;
+            break;
+        }
+
+        if (failed_c())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void FSpiceFrameHandle::MergeFixedLinks(FChain& Chain)
+{
+    FChain Merged;
+    for (const FLink& Link : Chain)
+    {
+        if (Link.Type == ELinkType::Fixed && Merged.Num() > 0 && Merged.Last().Type == ELinkType::Fixed)
+        {
+            mxm_c(Link.Rotation, Merged.Last().Rotation, Merged.Last().Rotation);
+        }
+        else
+        {
+            Merged.Add(Link);
+        }
+    }
+    Chain = MoveTemp(Merged);
+}
+
+
+const FSpiceFrameHandle::FChain* FSpiceFrameHandle::BaseChain(int32 Frame) const
+{
+    if (const FChain* Found = BaseChains.Find(Frame))
+    {
+        return Found;
+    }
+
+    FChain Chain;
+    if (!CompileChain(Frame, Chain))
+    {
+        return nullptr;
+    }
+
+    MergeFixedLinks(Chain);
+    return &BaseChains.Add(Frame, MoveTemp(Chain));
+}
+
+
+bool FSpiceFrameHandle::Resolve() const
+{
+    bValid = false;
+    PoolGeneration = MaxQ::Data::GetPoolGeneration();
+    BaseChains.Reset();
+    NumVarying = 0;
+
+    auto _from = StringCast<ANSICHAR>(*From);
+    auto _to = StringCast<ANSICHAR>(*To);
+
+    SpiceInt _fromid = 0, _toid = 0;
+    namfrm_c(_from.Get(), &_fromid);
+    namfrm_c(_to.Get(), &_toid);
+
+    for (SpiceInt _id : { _fromid, _toid })
+    {
+        if (_id == 0 && !failed_c())
+        {
+            setmsg_c("The reference frame # is not recognized.");
+            errch_c("#", _id == _fromid ? _from.Get() : _to.Get());
+            sigerr_c("SPICE(UNKNOWNFRAME)");
+        }
+    }
+
+    if (failed_c() || !CompileChain(_fromid, FromChain) || !CompileChain(_toid, ToChain))
+    {
+        return false;
+    }
+
+    FromId = _fromid;
+    ToId = _toid;
+
+    // The frames each chain passes through.  A chain that doesn't end at a
+    // CK ends at J2000.
+    auto Frames = [](const FChain& Chain, TArray<int32, TInlineAllocator<8>>& Out)
+    {
+        for (const FLink& Link : Chain)
+        {
+            Out.Add(Link.Frame);
+        }
+        if (Chain.Num() == 0 || Chain.Last().Type != ELinkType::Ck)
+        {
+            Out.Add(J2000Id);
+        }
+    };
+
+    TArray<int32, TInlineAllocator<8>> FromFrames, ToFrames;
+    Frames(FromChain, FromFrames);
+    Frames(ToChain, ToFrames);
+
+    // Stop both at the first frame they share
+    for (int32 i = 0; i < FromFrames.Num(); ++i)
+    {
+        const int32 j = ToFrames.Find(FromFrames[i]);
+        if (j != INDEX_NONE)
+        {
+            FromChain.SetNum(FMath::Min(i, FromChain.Num()));
+            ToChain.SetNum(FMath::Min(j, ToChain.Num()));
+            break;
+        }
+    }
+
+    MergeFixedLinks(FromChain);
+    MergeFixedLinks(ToChain);
+
+    for (const FChain* Chain : { &FromChain, &ToChain })
+    {
+        for (const FLink& Link : *Chain)
+        {
+            NumVarying += Link.Type != ELinkType::Fixed;
+        }
+    }
+
+    if (NumVarying == 0)
+    {
+        double rf[3][3], rt[3][3];
+        Rotate(FromChain, 0., rf, 0);
+        Rotate(ToChain, 0., rt, 0);
+        mtxm_c(rt, rf, Constant);
+    }
+
+    bValid = !failed_c();
+
+    return bValid;
+}
+
+
+bool FSpiceFrameHandle::RefreshIfStale() const
+{
+    if (failed_c())
+    {
+        return false;
+    }
+
+    // Kernels changed, frames may be defined differently now
+    if (PoolGeneration != MaxQ::Data::GetPoolGeneration())
+    {
+        MAXQ_CACHE_EVENT(FrameChainRecompiles);
+        return Resolve();
+    }
+
+    if (!bValid)
+    {
+        setmsg_c("Frame transformation from # to # was not successfully compiled.");
+        errch_c("#", StringCast<ANSICHAR>(*From).Get());
+        errch_c("#", StringCast<ANSICHAR>(*To).Get());
+        sigerr_c("SPICE(INVALIDQUERY)");
+    }
+    else
+    {
+        MAXQ_CACHE_EVENT(FrameChainHits);
+    }
+
+    return bValid;
+}
+
+
+bool FSpiceFrameHandle::Rotate(const FChain& Chain, double et, double (&m)[3][3], int32 Depth) const
+{
+    Identity(m);
+
+    for (const FLink& Link : Chain)
+    {
+        double l[3][3];
+
+        switch (Link.Type)
+        {
+        case ELinkType::Fixed:
+            Copy(Link.Rotation, l);
+            break;
+        case ELinkType::Pck:
+            if (Link.Orientation.IsValid())
+            {
+                Link.Orientation->Rotation(et, l);
+            }
+            else
+            {
+                tipbod_c("J2000", Link.Id, et, l);
+            }
+            xpose_c(l, l);
+            break;
+        case ELinkType::Other:
+            DynamicRotation(Link.Frame, Link.Name.Ansi(), et, l);
+            break;
+        case ELinkType::Ck:
+        {
+            SpiceInt _ref = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            ckfrot_c(Link.Id, et, l, &_ref, &_found);
+            if (!_found && !failed_c())
+            {
+                setmsg_c("No CK data for frame # at ET #.");
+                errint_c("#", Link.Frame);
+                errdp_c("#", et);
+                sigerr_c("SPICE(NOFRAMECONNECT)");
+            }
+            if (failed_c())
+            {
+                return false;
+            }
+
+            mxm_c(l, m, m);
+
+            // The CK link is always last.  Chain may live in BaseChains,
+            // which BaseChain can grow, so it isn't touched after this.
+            const FChain* Base = Depth < MaxCkDepth ? BaseChain(_ref) : nullptr;
+            if (!Base)
+            {
+                if (!failed_c())
+                {
+                    setmsg_c("Frame # is more than # CK frames from J2000.");
+                    errint_c("#", _ref);
+                    errint_c("#", MaxCkDepth);
+                    sigerr_c("SPICE(TOOMANYHOPS)");
+                }
+                return false;
+            }
+
+            double b[3][3];
+            if (!Rotate(*Base, et, b, Depth + 1))
+            {
+                return false;
+            }
+            mxm_c(b, m, m);
+            return true;
+        }
+        }
+
+        if (failed_c())
+        {
+            return false;
+        }
+
+        mxm_c(l, m, m);
+    }
+
+    return true;
+}
+
+
+bool FSpiceFrameHandle::Transform(const FChain& Chain, double et, double (&r)[3][3], double (&d)[3][3], int32 Depth) const
+{
+    Identity(r);
+    FMemory::Memzero(d);
+
+    for (const FLink& Link : Chain)
+    {
+        double lr[3][3], ld[3][3], x[6][6];
+
+        switch (Link.Type)
+        {
+        case ELinkType::Fixed:
+            Copy(Link.Rotation, lr);
+            FMemory::Memzero(ld);
+            break;
+        case ELinkType::Pck:
+        {
+            // J2000->body-fixed, inverted
+            double br[3][3], bd[3][3];
+            if (Link.Orientation.IsValid())
+            {
+                Link.Orientation->StateTransform(et, x);
+            }
+            else
+            {
+                tisbod_c("J2000", Link.Id, et, x);
+            }
+            Split(x, br, bd);
+            xpose_c(br, lr);
+            xpose_c(bd, ld);
+            break;
+        }
+        case ELinkType::Other:
+            DynamicTransform(Link.Frame, Link.Name.Ansi(), et, lr, ld);
+            break;
+        case ELinkType::Ck:
+        {
+            SpiceInt _ref = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            ckfxfm_c(Link.Id, et, x, &_ref, &_found);
+            if (!_found && !failed_c())
+            {
+                setmsg_c("No CK data for frame # at ET #.");
+                errint_c("#", Link.Frame);
+                errdp_c("#", et);
+                sigerr_c("SPICE(NOFRAMECONNECT)");
+            }
+            if (failed_c())
+            {
+                return false;
+            }
+
+            Split(x, lr, ld);
+            Compose(lr, ld, r, d);
+
+            // As in Rotate, Chain isn't touched after this
+            const FChain* Base = Depth < MaxCkDepth ? BaseChain(_ref) : nullptr;
+            if (!Base)
+            {
+                if (!failed_c())
+                {
+                    setmsg_c("Frame # is more than # CK frames from J2000.");
+                    errint_c("#", _ref);
+                    errint_c("#", MaxCkDepth);
+                    sigerr_c("SPICE(TOOMANYHOPS)");
+                }
+                return false;
+            }
+
+            double br[3][3], bd[3][3];
+            if (!Transform(*Base, et, br, bd, Depth + 1))
+            {
+                return false;
+            }
+            Compose(br, bd, r, d);
+            return true;
+        }
+        }
+
+        if (failed_c())
+        {
+            return false;
+        }
+
+        Compose(lr, ld, r, d);
+    }
+
+    return true;
+}
+
+
+void FSpiceFrameHandle::Pxform(double et, double (&rotate)[3][3]) const
+{
+    if (!RefreshIfStale())
+    {
+        return;
+    }
+
+    if (NumVarying == 0)
+    {
+        Copy(Constant, rotate);
+        return;
+    }
+
+    MAXQ_FRAME_LOOKUP_SCOPE();
+
+    double rf[3][3], rt[3][3];
+    if (Rotate(FromChain, et, rf, 0) && Rotate(ToChain, et, rt, 0))
+    {
+        mtxm_c(rt, rf, rotate);
+    }
+}
+
+
+void FSpiceFrameHandle::Sxform(double et, double (&xform)[6][6]) const
+{
+    if (!RefreshIfStale())
+    {
+        return;
+    }
+
+    if (NumVarying == 0)
+    {
+        double zero[3][3];
+        FMemory::Memzero(zero);
+        Join(Constant, zero, xform);
+        return;
+    }
+
+    MAXQ_FRAME_LOOKUP_SCOPE();
+
+    double rf[3][3], df[3][3], rt[3][3], dt[3][3];
+    if (Transform(FromChain, et, rf, df, 0) && Transform(ToChain, et, rt, dt, 0))
+    {
+        // (rt, dt)^-1 * (rf, df)
+        double r[3][3], d[3][3], a[3][3], b[3][3];
+        mtxm_c(rt, rf, r);
+        mtxm_c(dt, rf, a);
+        mtxm_c(rt, df, b);
+        vaddg_c(&a[0][0], &b[0][0], 9, &d[0][0]);
+        Join(r, d, xform);
+    }
+}
+
+
+void FSpiceFrameHandle::Pxform(
+    const FSEphemerisTime& et,
+    FSRotationMatrix& rotate,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+) const
+{
+    Pxform(et.AsSpiceDouble(), rotate.AsSpiceDoubleArray());
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
+
+void FSpiceFrameHandle::Sxform(
+    const FSEphemerisTime& et,
+    FSStateTransform& xform,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+) const
+{
+    Sxform(et.AsSpiceDouble(), xform.AsSpiceDoubleArray());
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
+
+void FSpiceFrameHandle::Pxform(
+    TArrayView<const FSEphemerisTime> ets,
+    TArrayView<FSRotationMatrix> rotate,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+) const
+{
+    check(rotate.Num() >= ets.Num());
+
+    for (int32 i = 0; i < ets.Num() && !failed_c(); ++i)
+    {
+        Pxform(ets[i].AsSpiceDouble(), rotate[i].AsSpiceDoubleArray());
+    }
+
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
+
+void FSpiceFrameHandle::Sxform(
+    TArrayView<const FSEphemerisTime> ets,
+    TArrayView<FSStateTransform> xform,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+) const
+{
+    check(xform.Num() >= ets.Num());
+
+    for (int32 i = 0; i < ets.Num() && !failed_c(); ++i)
+    {
+        Sxform(ets[i].AsSpiceDouble(), xform[i].AsSpiceDoubleArray());
+    }
+
+    ErrorCheck(ResultCode, ErrorMessage);
+}
@@ -0,0 +1,183 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFurnshAsync.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Kernel loading off the game thread, with progress and cancel.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFurnshAsync.cpp is part of the "refined C++ API" and "Blueprints API".
+//
+// Each file is its own executor command, rather than the whole list being
+// one:  a long load doesn't hold off other executor work, and a cancel only
+// waits for the file that's loading.  Commands from one producer run in the
+// order they're enqueued, so the files still load in list order.
+//------------------------------------------------------------------------------
+
+#include "SpiceFurnshAsync.h"
+#include "Async/Async.h"
+#include "SpiceData.h"
+#include "SpiceExecutor.h"
+#include "SpiceLog.h"
+
+namespace MaxQ::Data
+{
+    // One load's state, shared by its per-file commands
+    struct FFurnshAsyncLoad
+    {
+        TArray<FString> Paths;
+        TSharedPtr<FFurnshAsyncHandle, ESPMode::ThreadSafe> Handle;
+        FFurnshAsyncProgress OnProgress;
+        FFurnshAsyncResult Result;
+        TPromise<FFurnshAsyncResult> Promise;
+
+        // On the executor thread
+        void Load(int32 File)
+        {
+            if (Handle->IsCancelRequested())
+            {
+                Result.bCancelled = true;
+            }
+            else
+            {
+                ES_ResultCode ResultCode = ES_ResultCode::Success;
+                FString ErrorMessage;
+                if (Furnsh(Paths[File], &ResultCode, &ErrorMessage))
+                {
+                    ++Result.NumLoaded;
+                }
+                else
+                {
+                    Result.ResultCode = ResultCode;
+                    Result.ErrorMessage = ErrorMessage;
+                }
+
+                const int32 Done = ++Handle->Done;
+                if (OnProgress)
+                {
+                    AsyncTask(ENamedThreads::GameThread, [OnProgress = OnProgress, Done, Num = Paths.Num(), Path = Paths[File]]()
+                    {
+                        OnProgress(Done, Num, Path);
+                    });
+                }
+            }
+
+            if (File == Paths.Num() - 1)
+            {
+                if (Result.bCancelled)
+                {
+                    UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE 'FurnshAsync' cancelled after %d of %d kernels"), Result.NumLoaded, Paths.Num());
+                }
+                Promise.SetValue(Result);
+            }
+        }
+    };
+
+
+    SPICE_API TFuture<FFurnshAsyncResult> FurnshAsync(
+        const TArray<FString>& relativePaths,
+        TSharedPtr<FFurnshAsyncHandle, ESPMode::ThreadSafe>* Handle,
+        FFurnshAsyncProgress&& OnProgress
+    )
+    {
+        TSharedRef<FFurnshAsyncLoad, ESPMode::ThreadSafe> Load = MakeShared<FFurnshAsyncLoad, ESPMode::ThreadSafe>();
+        Load->Paths = relativePaths;
+        Load->Handle = MakeShared<FFurnshAsyncHandle, ESPMode::ThreadSafe>(relativePaths.Num());
+        Load->OnProgress = MoveTemp(OnProgress);
+        if (Handle) *Handle = Load->Handle;
+
+        TFuture<FFurnshAsyncResult> Future = Load->Promise.GetFuture();
+
+        if (relativePaths.Num() == 0)
+        {
+            Load->Promise.SetValue(Load->Result);
+            return Future;
+        }
+
+        FSpiceExecutor& Executor = FSpiceExecutor::Get();
+        for (int32 File = 0; File < relativePaths.Num(); ++File)
+        {
+            Executor.EnqueueCommand([Load, File]()
+            {
+                Load->Load(File);
+            });
+        }
+
+        return Future;
+    }
+}
+
+
+USpiceFurnshAsync* USpiceFurnshAsync::furnsh_list_async(UObject* WorldContextObject, const TArray<FString>& files)
+{
+    USpiceFurnshAsync* Action = NewObject<USpiceFurnshAsync>();
+    Action->FilesArg = files;
+    Action->RegisterWithGameInstance(WorldContextObject);
+
+    return Action;
+}
+
+
+void USpiceFurnshAsync::Activate()
+{
+    using namespace MaxQ::Data;
+
+    TWeakObjectPtr<USpiceFurnshAsync> WeakThis(this);
+
+    FurnshAsync(FilesArg, &Handle, [WeakThis](int32 Done, int32 Num, const FString& relativePath)
+    {
+        if (USpiceFurnshAsync* This = WeakThis.Get())
+        {
+            This->OnProgress.Broadcast(Done, Num, relativePath);
+        }
+    })
+    .Next([WeakThis](const FFurnshAsyncResult& Result)
+    {
+        // Behind the last progress callback, on the game thread
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, Result]()
+        {
+            USpiceFurnshAsync* This = WeakThis.Get();
+            if (!This)
+            {
+                return;
+            }
+
+            if (Result.bCancelled)
+            {
+                This->OnCancelled.Broadcast(Result.NumLoaded, Result.ErrorMessage);
+            }
+            else if (Result.ResultCode == ES_ResultCode::Success)
+            {
+                This->OnSuccess.Broadcast(Result.NumLoaded, Result.ErrorMessage);
+            }
+            else
+            {
+                This->OnError.Broadcast(Result.NumLoaded, Result.ErrorMessage);
+            }
+
+            // Allow the UE Garbage Collector to free this object.
+            This->SetReadyToDestroy();
+        });
+    });
+}
+
+
+void USpiceFurnshAsync::Cancel()
+{
+    if (Handle.IsValid())
+    {
+        Handle->Cancel();
+    }
+}
@@ -0,0 +1,2058 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGeometryFinder.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Geometry Finder (gf*) helpers: parallel searches, window math.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGeometryFinder.cpp is part of the "refined C++ API".
+//
+// Each parallel search has an "Args" struct that knows how to serialize
+// itself and how to run the search (via the USpice base API).  The same code
+// runs in the parent (to serialize) and in the worker (to run), and the
+// worker-side job is registered at static init time in both.
+//
+// An async search is an FGeometryFinderSearch shared by its pieces.  On the
+// process pool only NumWorkers pieces are in flight at a time (each one that
+// finishes dispatches the next), so a cancel doesn't wait behind pieces
+// already handed to workers.
+//
+// The occultation pre-filter samples positions itself (spkezr_c), rather
+// than through a gf search of its own:  it's a bound, not an event, so it
+// only needs each step's endpoints.
+//
+// gfuds_c's and gfudb_c's callbacks are plain C functions with no user data,
+// so the user-defined searches reach their TFunctions through a thread_local
+// (the search in progress on this thread).
+//------------------------------------------------------------------------------
+
+#include "SpiceGeometryFinder.h"
+#include "Spice.h"
+#include "SpiceEphemerisCache.h"
+#include "SpiceExecutor.h"
+#include "SpiceGfResultCache.h"
+#include "SpiceLock.h"
+#include "SpiceProcessPool.h"
+#include "SpiceUtilities.h"
+#include "Async/Async.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include <limits>
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    typedef TArray<FSEphemerisTimeWindowSegment> FWindow;
+
+    template<typename EnumType>
+    void SerializeEnum(FArchive& Ar, EnumType& Value)
+    {
+        uint8 Byte = (uint8)Value;
+        Ar << Byte;
+        Value = (EnumType)Byte;
+    }
+
+    void SerializeWindow(FArchive& Ar, FWindow& Window)
+    {
+        int32 Count = Window.Num();
+        Ar << Count;
+        if (Ar.IsLoading())
+        {
+            Window.SetNum(Count);
+        }
+        for (FSEphemerisTimeWindowSegment& Segment : Window)
+        {
+            Ar << Segment.start.seconds;
+            Ar << Segment.stop.seconds;
+        }
+    }
+
+    void SerializeAngle(FArchive& Ar, FSAngle& Angle)
+    {
+        Ar << Angle.degrees;
+    }
+
+    // A piece's absolute extremum isn't the window's
+    bool IsPartitionable(ES_RelationalOperator relate)
+    {
+        return relate != ES_RelationalOperator::ABSMAX && relate != ES_RelationalOperator::ABSMIN;
+    }
+
+    // Local extrema are points.  One in the overlap between two pieces is
+    // found by both, each to within the convergence tolerance, so the two
+    // times can differ by up to twice that.
+    double DuplicatePointTolerance(ES_RelationalOperator relate)
+    {
+        const bool bPoints = relate == ES_RelationalOperator::LOCMAX || relate == ES_RelationalOperator::LOCMIN;
+        return bPoints ? 4. * GetGfTolerance() : 0.;
+    }
+
+    // Steps <= 0 are chosen from the geometry
+    bool ChooseStepFor(
+        FSEphemerisPeriod& step,
+        const FWindow& cnfine,
+        const TArray<FString>& targets,
+        const FString& obsrvr,
+        const FString& frame,
+        ES_RelationalOperator relate,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (step.seconds > 0.)
+        {
+            return true;
+        }
+
+        MaxQ::GeometryFinder::FGfStepChoice Choice;
+        if (!MaxQ::GeometryFinder::ChooseGfStep(Choice, cnfine, targets, obsrvr, frame, relate, MaxQ::GeometryFinder::FGfStepSettings(), ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        step = Choice.Step;
+        return true;
+    }
+
+    struct FGfdistArgs
+    {
+        static constexpr TCHAR JobName[] = TEXT("MaxQ.gfdist");
+
+        FSEphemerisPeriod step;
+        FSDistance refval;
+        FSDistance adjust;
+        FString target;
+        ES_AberrationCorrectionWithTransmissions abcorr;
+        FString obsrvr;
+        ES_RelationalOperator relate;
+
+        const FSEphemerisPeriod& Step() const { return step; }
+        bool CanPartition() const { return IsPartitionable(relate); }
+        double PointTolerance() const { return DuplicatePointTolerance(relate); }
+
+        bool ChooseStep(const FWindow& cnfine, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            return ChooseStepFor(step, cnfine, { target }, obsrvr, FString(), relate, ResultCode, ErrorMessage);
+        }
+
+        void Serialize(FArchive& Ar)
+        {
+            Ar << step.seconds << refval.km << adjust.km << target;
+            SerializeEnum(Ar, abcorr);
+            Ar << obsrvr;
+            SerializeEnum(Ar, relate);
+        }
+
+        void Run(ES_ResultCode& ResultCode, FString& ErrorMessage, FWindow& results, const FWindow& cnfine) const
+        {
+            USpice::gfdist(ResultCode, ErrorMessage, results, cnfine, step, refval, adjust, target, abcorr, obsrvr, relate);
+        }
+    };
+
+    struct FGfocltArgs
+    {
+        static constexpr TCHAR JobName[] = TEXT("MaxQ.gfoclt");
+
+        FSEphemerisPeriod step;
+        TArray<FString> frontShapeSurfaces;
+        TArray<FString> backShapeSurfaces;
+        ES_OccultationType occtyp;
+        FString front;
+        ES_GeometricModel frontShape;
+        FString frontframe;
+        FString back;
+        ES_GeometricModel backShape;
+        FString backFrame;
+        ES_AberrationCorrectionForOccultation abcorr;
+        FString obsrvr;
+
+        const FSEphemerisPeriod& Step() const { return step; }
+        bool CanPartition() const { return true; }
+        double PointTolerance() const { return 0.; }
+
+        bool ChooseStep(const FWindow& cnfine, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            return ChooseStepFor(step, cnfine, { front, back }, obsrvr, FString(), ES_RelationalOperator::Equal, ResultCode, ErrorMessage);
+        }
+
+        void Serialize(FArchive& Ar)
+        {
+            Ar << step.seconds << frontShapeSurfaces << backShapeSurfaces;
+            SerializeEnum(Ar, occtyp);
+            Ar << front;
+            SerializeEnum(Ar, frontShape);
+            Ar << frontframe << back;
+            SerializeEnum(Ar, backShape);
+            Ar << backFrame;
+            SerializeEnum(Ar, abcorr);
+            Ar << obsrvr;
+        }
+
+        void Run(ES_ResultCode& ResultCode, FString& ErrorMessage, FWindow& results, const FWindow& cnfine) const
+        {
+            USpice::gfoclt(ResultCode, ErrorMessage, results, cnfine, step, frontShapeSurfaces, backShapeSurfaces, occtyp, front, frontShape, frontframe, back, backShape, backFrame, abcorr, obsrvr);
+        }
+    };
+
+    struct FGfposcArgs
+    {
+        static constexpr TCHAR JobName[] = TEXT("MaxQ.gfposc");
+
+        FSEphemerisPeriod step;
+        FString target;
+        FString frame;
+        ES_AberrationCorrectionWithTransmissions abcorr;
+        FString obsrvr;
+        ES_CoordinateSystemInclRadec crdsys;
+        ES_CoordinateName coord;
+        ES_RelationalOperator relate;
+        double refval;
+        double adjust;
+        int32 nintvls;
+
+        const FSEphemerisPeriod& Step() const { return step; }
+        bool CanPartition() const { return IsPartitionable(relate); }
+        double PointTolerance() const { return DuplicatePointTolerance(relate); }
+
+        bool ChooseStep(const FWindow& cnfine, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            return ChooseStepFor(step, cnfine, { target }, obsrvr, frame, relate, ResultCode, ErrorMessage);
+        }
+
+        void Serialize(FArchive& Ar)
+        {
+            Ar << step.seconds << target << frame;
+            SerializeEnum(Ar, abcorr);
+            Ar << obsrvr;
+            SerializeEnum(Ar, crdsys);
+            SerializeEnum(Ar, coord);
+            SerializeEnum(Ar, relate);
+            Ar << refval << adjust << nintvls;
+        }
+
+        void Run(ES_ResultCode& ResultCode, FString& ErrorMessage, FWindow& results, const FWindow& cnfine) const
+        {
+            USpice::gfposc(ResultCode, ErrorMessage, results, step, cnfine, target, frame, abcorr, obsrvr, crdsys, coord, relate, refval, adjust, nintvls);
+        }
+    };
+
+    struct FGfsepArgs
+    {
+        static constexpr TCHAR JobName[] = TEXT("MaxQ.gfsep");
+
+        FSAngle refval;
+        FSAngle adjust;
+        FSEphemerisPeriod step;
+        FString targ1;
+        ES_OtherGeometricModel shape1;
+        FString targ2;
+        ES_OtherGeometricModel shape2;
+        ES_AberrationCorrectionWithTransmissions abcorr;
+        FString obsrvr;
+        ES_RelationalOperator relate;
+
+        const FSEphemerisPeriod& Step() const { return step; }
+        bool CanPartition() const { return IsPartitionable(relate); }
+        double PointTolerance() const { return DuplicatePointTolerance(relate); }
+
+        bool ChooseStep(const FWindow& cnfine, ES_ResultCode* ResultCode, FString* ErrorMessage)
+        {
+            return ChooseStepFor(step, cnfine, { targ1, targ2 }, obsrvr, FString(), relate, ResultCode, ErrorMessage);
+        }
+
+        void Serialize(FArchive& Ar)
+        {
+            SerializeAngle(Ar, refval);
+            SerializeAngle(Ar, adjust);
+            Ar << step.seconds << targ1;
+            SerializeEnum(Ar, shape1);
+            Ar << targ2;
+            SerializeEnum(Ar, shape2);
+            SerializeEnum(Ar, abcorr);
+            Ar << obsrvr;
+            SerializeEnum(Ar, relate);
+        }
+
+        void Run(ES_ResultCode& ResultCode, FString& ErrorMessage, FWindow& results, const FWindow& cnfine) const
+        {
+            USpice::gfsep(ResultCode, ErrorMessage, results, cnfine, refval, adjust, step, targ1, shape1, targ2, shape2, abcorr, obsrvr, relate);
+        }
+    };
+
+
+    // Worker side
+    template<class ArgsType>
+    bool RunJob(const TArray<uint8>& Request, TArray<uint8>& Response, FString& ErrorMessage)
+    {
+        FMemoryReader Reader(Request);
+        FWindow cnfine;
+        ArgsType Args;
+        SerializeWindow(Reader, cnfine);
+        Args.Serialize(Reader);
+
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FWindow results;
+        Args.Run(ResultCode, ErrorMessage, results, cnfine);
+
+        FMemoryWriter Writer(Response);
+        SerializeWindow(Writer, results);
+
+        return ResultCode == ES_ResultCode::Success;
+    }
+
+    FSpiceJobRegistration GfdistJob(FGfdistArgs::JobName, &RunJob<FGfdistArgs>);
+    FSpiceJobRegistration GfocltJob(FGfocltArgs::JobName, &RunJob<FGfocltArgs>);
+    FSpiceJobRegistration GfposcJob(FGfposcArgs::JobName, &RunJob<FGfposcArgs>);
+    FSpiceJobRegistration GfsepJob(FGfsepArgs::JobName, &RunJob<FGfsepArgs>);
+
+
+    // Parent side
+    template<class ArgsType>
+    void RunParallel(
+        ArgsType& Args,
+        FWindow& results,
+        const FWindow& cnfine,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+        results.Reset();
+
+        if (!Args.ChooseStep(cnfine, ResultCode, ErrorMessage))
+        {
+            return;
+        }
+
+        FSpiceProcessPool* Pool = FSpiceProcessPool::GetStarted();
+
+        if (Partitions <= 0)
+        {
+            Partitions = Pool ? Pool->NumWorkers() : 1;
+        }
+        if (!Args.CanPartition())
+        {
+            Partitions = 1;
+        }
+
+        TArray<FWindow> Pieces = MaxQ::GeometryFinder::PartitionWindow(cnfine, Partitions, Args.Step());
+        TArray<FWindow> PieceResults;
+        PieceResults.SetNum(Pieces.Num());
+
+        if (Pool)
+        {
+            TArray<TFuture<FSpiceJobResult>> Futures;
+            for (FWindow& Piece : Pieces)
+            {
+                TArray<uint8> Request;
+                FMemoryWriter Writer(Request);
+                SerializeWindow(Writer, Piece);
+                Args.Serialize(Writer);
+                Futures.Add(Pool->Dispatch(ArgsType::JobName, MoveTemp(Request)));
+            }
+
+            for (int32 i = 0; i < Futures.Num(); ++i)
+            {
+                FSpiceJobResult Result = Futures[i].Get();
+                if (!Result.bSuccess)
+                {
+                    *ResultCode = ES_ResultCode::Error;
+                    *ErrorMessage = Result.ErrorMessage;
+                    continue;
+                }
+
+                FMemoryReader Reader(Result.Response);
+                SerializeWindow(Reader, PieceResults[i]);
+            }
+        }
+        else
+        {
+            UE_LOG(LogSpice, Verbose, TEXT("MaxQ SPICE %s: process pool not started, searching serially"), ArgsType::JobName);
+
+            for (int32 i = 0; i < Pieces.Num(); ++i)
+            {
+                ES_ResultCode PieceResultCode;
+                FString PieceErrorMessage;
+                Args.Run(PieceResultCode, PieceErrorMessage, PieceResults[i], Pieces[i]);
+                if (PieceResultCode != ES_ResultCode::Success)
+                {
+                    *ResultCode = PieceResultCode;
+                    *ErrorMessage = PieceErrorMessage;
+                    break;
+                }
+            }
+        }
+
+        if (*ResultCode == ES_ResultCode::Success)
+        {
+            results = MaxQ::GeometryFinder::UnionWindows(PieceResults, Args.PointTolerance());
+        }
+    }
+
+
+    // RunParallel, unless the cache has the result.  The key is the request a
+    // worker would get for the whole window (and the tolerance).
+    template<class ArgsType>
+    void RunCached(
+        ArgsType& Args,
+        FWindow& results,
+        const FWindow& cnfine,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        results.Reset();
+
+        // (So the key has the step a search would use)
+        if (!Args.ChooseStep(cnfine, ResultCode, ErrorMessage))
+        {
+            return;
+        }
+
+        TArray<uint8> Request;
+        FMemoryWriter Writer(Request);
+        FString JobName(ArgsType::JobName);
+        double Tolerance = GetGfTolerance();
+        FWindow Window = cnfine;
+        Writer << JobName << Tolerance;
+        SerializeWindow(Writer, Window);
+        Args.Serialize(Writer);
+
+        MaxQ::GeometryFinder::FGfResultCache& Cache = MaxQ::GeometryFinder::FGfResultCache::Get();
+        if (Cache.Find(Request, results))
+        {
+            *ResultCode = ES_ResultCode::Success;
+            ErrorMessage->Empty();
+            return;
+        }
+
+        RunParallel(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+        if (*ResultCode == ES_ResultCode::Success)
+        {
+            Cache.Add(Request, results);
+        }
+    }
+
+
+    template<class ArgsType>
+    MaxQ::GeometryFinder::FGfIncrementalSearch MakeIncremental(const ArgsType& Args)
+    {
+        return MaxQ::GeometryFinder::FGfIncrementalSearch([Args](ES_ResultCode& ResultCode, FString& ErrorMessage, FWindow& results, const FWindow& cnfine)
+        {
+            Args.Run(ResultCode, ErrorMessage, results, cnfine);
+        }, Args.Step(), Args.CanPartition());
+    }
+}
+
+
+namespace MaxQ::GeometryFinder
+{
+    static thread_local const FGfSearchControl* CurrentControl = nullptr;
+
+    FGfSearchControlScope::FGfSearchControlScope(const FGfSearchControl& Control)
+        : Previous(CurrentControl)
+    {
+        CurrentControl = &Control;
+    }
+
+    FGfSearchControlScope::~FGfSearchControlScope()
+    {
+        CurrentControl = Previous;
+    }
+
+    const FGfSearchControl* FGfSearchControlScope::Current()
+    {
+        return CurrentControl;
+    }
+
+
+    // One async search's state, shared by its pieces
+    struct FGeometryFinderSearch : public TSharedFromThis<FGeometryFinderSearch, ESPMode::ThreadSafe>
+    {
+        typedef TFunction<void(ES_ResultCode&, FString&, FWindow&, const FWindow&)> FRun;
+
+        const TCHAR* JobName = nullptr;
+        FRun Run;
+        // Serialized args, for the process pool
+        TArray<uint8> ArgBytes;
+
+        TArray<FWindow> Pieces;
+        TArray<FWindow> PieceResults;
+        // UnionWindows' PointTolerance
+        double PointTolerance = 0.;
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe> Handle;
+        FGeometryFinderAsyncProgress OnProgress;
+        FGeometryFinderAsyncPartial OnPartial;
+        TPromise<FGeometryFinderAsyncResult> Promise;
+
+        FCriticalSection ResultLock;
+        FGeometryFinderAsyncResult Result;
+        TOptional<FGfPartialResults> Partial;
+
+        std::atomic<int32> NextPiece { 0 };
+        std::atomic<int32> Finished { 0 };
+        std::atomic<bool> bFailed { false };
+        std::atomic<bool> bSkipped { false };
+
+        // Once a piece fails, or a cancel is requested, the rest are skipped
+        bool Skip()
+        {
+            if (bFailed || Handle->IsCancelRequested())
+            {
+                bSkipped = true;
+                return true;
+            }
+            return false;
+        }
+
+        // Pieces write their own results, so only failures (and the stream)
+        // need the lock
+        void Record(int32 Piece, ES_ResultCode ResultCode, const FString& ErrorMessage, FWindow&& Window)
+        {
+            if (ResultCode == ES_ResultCode::Success)
+            {
+                if (OnPartial)
+                {
+                    Stream(Piece, FWindow(Window));
+                }
+                PieceResults[Piece] = MoveTemp(Window);
+                return;
+            }
+
+            FScopeLock Lock(&ResultLock);
+            if (!bFailed.exchange(true))
+            {
+                Result.ResultCode = ResultCode;
+                Result.ErrorMessage = ErrorMessage;
+            }
+        }
+
+        // Posted under the lock, so the game thread hears in time order
+        void Stream(int32 Piece, FWindow&& Window)
+        {
+            FScopeLock Lock(&ResultLock);
+            if (bFailed)
+            {
+                return;
+            }
+
+            FWindow Final;
+            if (Partial->Add(Piece, MoveTemp(Window), Final))
+            {
+                AsyncTask(ENamedThreads::GameThread, [OnPartial = OnPartial, Final = MoveTemp(Final), Through = Partial->Through()]()
+                {
+                    OnPartial(Final, Through);
+                });
+            }
+        }
+
+        void Finish(bool bSearched)
+        {
+            if (bSearched)
+            {
+                const int32 Done = ++Handle->Done;
+                if (OnProgress)
+                {
+                    AsyncTask(ENamedThreads::GameThread, [OnProgress = OnProgress, Done, Num = Pieces.Num()]()
+                    {
+                        OnProgress(Done, Num);
+                    });
+                }
+            }
+
+            if (++Finished < Pieces.Num())
+            {
+                return;
+            }
+
+            FScopeLock Lock(&ResultLock);
+            if (!bFailed && bSkipped)
+            {
+                Result.bCancelled = true;
+                UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE %s cancelled after %d of %d pieces"), JobName, Handle->NumDone(), Pieces.Num());
+            }
+            else if (!bFailed)
+            {
+                Result.results = UnionWindows(PieceResults, PointTolerance);
+            }
+            Promise.SetValue(Result);
+        }
+
+        // On the executor thread
+        void SearchPiece(int32 Piece)
+        {
+            if (Skip())
+            {
+                Finish(false);
+                return;
+            }
+
+            // A cancel stops the piece, too
+            FGfSearchControl Control;
+            Control.ShouldCancel = [this]() { return Handle->IsCancelRequested(); };
+
+            ES_ResultCode ResultCode = ES_ResultCode::Success;
+            FString ErrorMessage;
+            FWindow Window;
+            {
+                FGfSearchControlScope Scope(Control);
+                Run(ResultCode, ErrorMessage, Window, Pieces[Piece]);
+            }
+
+            if (ResultCode != ES_ResultCode::Success && Handle->IsCancelRequested())
+            {
+                bSkipped = true;
+                Finish(false);
+                return;
+            }
+            Record(Piece, ResultCode, ErrorMessage, MoveTemp(Window));
+            Finish(true);
+        }
+
+        // Any thread.  Dispatches the next piece that isn't skipped.
+        void DispatchNext()
+        {
+            for (;;)
+            {
+                const int32 Piece = NextPiece++;
+                if (Piece >= Pieces.Num())
+                {
+                    return;
+                }
+                if (Skip())
+                {
+                    Finish(false);
+                    continue;
+                }
+
+                TArray<uint8> Request;
+                FMemoryWriter Writer(Request);
+                SerializeWindow(Writer, Pieces[Piece]);
+                Writer.Serialize(ArgBytes.GetData(), ArgBytes.Num());
+
+                FSpiceProcessPool::Get().Dispatch(JobName, MoveTemp(Request))
+                .Next([Search = AsShared(), Piece](const FSpiceJobResult& JobResult)
+                {
+                    FWindow Window;
+                    if (JobResult.bSuccess)
+                    {
+                        FMemoryReader Reader(JobResult.Response);
+                        SerializeWindow(Reader, Window);
+                    }
+                    Search->Record(Piece, JobResult.bSuccess ? ES_ResultCode::Success : ES_ResultCode::Error, JobResult.ErrorMessage, MoveTemp(Window));
+                    Search->Finish(true);
+                    Search->DispatchNext();
+                });
+                return;
+            }
+        }
+    };
+}
+
+
+namespace
+{
+    using namespace MaxQ::GeometryFinder;
+
+    constexpr int32 PiecesPerWorker = 4;
+    constexpr int32 ExecutorPieces = 16;
+
+    template<class ArgsType>
+    TFuture<FGeometryFinderAsyncResult> RunAsync(
+        const ArgsType& _Args,
+        const FWindow& cnfine,
+        int32 Partitions,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle,
+        FGeometryFinderAsyncProgress&& OnProgress,
+        FGeometryFinderAsyncPartial&& OnPartial
+    )
+    {
+        ArgsType Args = _Args;
+        if (Args.Step().seconds <= 0.)
+        {
+            MaxQ::Core::FSpiceScope Scope;
+
+            FGeometryFinderAsyncResult Result;
+            if (!Args.ChooseStep(cnfine, &Result.ResultCode, &Result.ErrorMessage))
+            {
+                if (Handle) *Handle = MakeShared<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>(0);
+                return MakeFulfilledPromise<FGeometryFinderAsyncResult>(MoveTemp(Result)).GetFuture();
+            }
+        }
+
+        const bool bPool = FSpiceProcessPool::GetStarted() != nullptr;
+        if (Partitions <= 0)
+        {
+            Partitions = bPool ? PiecesPerWorker * FSpiceProcessPool::Get().NumWorkers() : ExecutorPieces;
+        }
+        if (!Args.CanPartition())
+        {
+            Partitions = 1;
+        }
+
+        TSharedRef<FGeometryFinderSearch, ESPMode::ThreadSafe> Search = MakeShared<FGeometryFinderSearch, ESPMode::ThreadSafe>();
+        Search->JobName = ArgsType::JobName;
+        Search->Run = [Args](ES_ResultCode& ResultCode, FString& ErrorMessage, FWindow& results, const FWindow& Piece)
+        {
+            Args.Run(ResultCode, ErrorMessage, results, Piece);
+        };
+        Search->Pieces = PartitionWindow(cnfine, Partitions, Args.Step());
+        Search->PieceResults.SetNum(Search->Pieces.Num());
+        Search->PointTolerance = Args.PointTolerance();
+        Search->Handle = MakeShared<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>(Search->Pieces.Num());
+        Search->OnProgress = MoveTemp(OnProgress);
+        Search->OnPartial = MoveTemp(OnPartial);
+        if (Search->OnPartial)
+        {
+            Search->Partial.Emplace(Search->Pieces, Search->PointTolerance);
+        }
+        if (Handle) *Handle = Search->Handle;
+
+        TFuture<FGeometryFinderAsyncResult> Future = Search->Promise.GetFuture();
+
+        if (bPool)
+        {
+            ArgsType Copy = Args;
+            FMemoryWriter Writer(Search->ArgBytes);
+            Copy.Serialize(Writer);
+
+            const int32 InFlight = FMath::Min(FSpiceProcessPool::Get().NumWorkers(), Search->Pieces.Num());
+            for (int32 i = 0; i < InFlight; ++i)
+            {
+                Search->DispatchNext();
+            }
+        }
+        else
+        {
+            FSpiceExecutor& Executor = FSpiceExecutor::Get();
+            for (int32 Piece = 0; Piece < Search->Pieces.Num(); ++Piece)
+            {
+                Executor.EnqueueCommand([Search, Piece]()
+                {
+                    Search->SearchPiece(Piece);
+                });
+            }
+        }
+
+        return Future;
+    }
+}
+
+
+namespace MaxQ::GeometryFinder
+{
+    SPICE_API bool ChooseGfStep(
+        FGfStepChoice& Choice,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const TArray<FString>& targets,
+        const FString& obsrvr,
+        const FString& frame,
+        ES_RelationalOperator relate,
+        const FGfStepSettings& Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Choice = FGfStepChoice();
+
+        const FSWindow Window(cnfine);
+        if (Window.IsEmpty() || targets.Num() == 0)
+        {
+            setmsg_c("A step can't be chosen without a window and at least one target.");
+            sigerr_c("SPICE(INVALIDARGUMENT)");
+            ErrorCheck(ResultCode, ErrorMessage);
+            return false;
+        }
+
+        const double Start = Window.Start(0);
+        const double Stop = Window.Stop(Window.Num() - 1);
+        const double Span = Stop - Start;
+
+        auto _obsrvr = StringCast<ANSICHAR>(*obsrvr);
+        auto _frame = StringCast<ANSICHAR>(*frame);
+
+        // The observer's GM, if it has one, for the targets' orbits about it
+        SpiceInt _obscode = 0;
+        SpiceDouble _mu = 0.;
+        if (ResolveBody(_obsrvr.Get(), _obscode) && bodfnd_c(_obscode, "GM"))
+        {
+            SpiceInt _n = 0;
+            bodvcd_c(_obscode, "GM", 1, &_n, &_mu);
+        }
+
+        const bool bFramed = !frame.IsEmpty() && !failed_c() && !IsInertialFrame(_frame.Get());
+
+        double TimeScale = Span;
+        FString Basis = TEXT("the window's length");
+        auto Consider = [&](double Seconds, TFunctionRef<FString()> What)
+        {
+            if (Seconds > 0. && Seconds < TimeScale)
+            {
+                TimeScale = Seconds;
+                Basis = What();
+            }
+        };
+
+        const int32 Samples = FMath::Max(Settings.Samples, 1);
+        for (int32 i = 0; i < Samples && !failed_c(); ++i)
+        {
+            const double et = Samples > 1 ? Start + Span * i / (Samples - 1) : Start;
+
+            for (int32 t = 0; t < targets.Num() && !failed_c(); ++t)
+            {
+                auto _target = StringCast<ANSICHAR>(*targets[t]);
+                SpiceDouble _state[6], _lt;
+                spkezr_c(_target.Get(), et, "J2000", "NONE", _obsrvr.Get(), _state, &_lt);
+                if (failed_c())
+                {
+                    break;
+                }
+
+                const double r = vnorm_c(_state);
+                const double v = vnorm_c(_state + 3);
+                if (v > 0.)
+                {
+                    Consider(2. * PI * r / v, [&]() { return FString::Printf(TEXT("%s's motion relative to %s"), *targets[t], *obsrvr); });
+                }
+
+                if (_mu > 0. && r > 0.)
+                {
+                    SpiceDouble _elts[8];
+                    oscelt_c(_state, et, _mu, _elts);
+                    if (!failed_c() && _elts[1] < 1.)
+                    {
+                        const double a = _elts[0] / (1. - _elts[1]);
+                        Consider(2. * PI * FMath::Sqrt(a * a * a / _mu), [&]() { return FString::Printf(TEXT("%s's orbit about %s"), *targets[t], *obsrvr); });
+                    }
+                }
+            }
+
+            if (bFramed && !failed_c())
+            {
+                SpiceDouble _xform[6][6], _rot[3][3], _av[3];
+                sxform_c("J2000", _frame.Get(), et, _xform);
+                xf2rav_c(_xform, _rot, _av);
+                const double w = vnorm_c(_av);
+                if (!failed_c() && w > 0.)
+                {
+                    Consider(2. * PI / w, [&]() { return FString::Printf(TEXT("%s's rotation"), *frame); });
+                }
+            }
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        // Extrema need the quantity's derivative bracketed, not just its value
+        const bool bExtremum = relate == ES_RelationalOperator::LOCMAX || relate == ES_RelationalOperator::LOCMIN
+            || relate == ES_RelationalOperator::ABSMAX || relate == ES_RelationalOperator::ABSMIN;
+        const double StepsPerCycle = FMath::Max(Settings.StepsPerCycle, 1.) * (bExtremum ? 2. : 1.);
+        const double MinSeconds = FMath::Max(Settings.MinSeconds, 0.);
+        double Step = FMath::Max(FMath::Min(TimeScale / StepsPerCycle, Span), MinSeconds);
+
+        // Halve while any target turns more than a step's share of a cycle
+        const double MaxAngle = 2. * PI / StepsPerCycle;
+        while (Choice.Refinements < Settings.MaxRefinements && Step / 2. >= MinSeconds && Step > 0.)
+        {
+            double Worst = 0.;
+            for (int32 t = 0; t < targets.Num() && !failed_c(); ++t)
+            {
+                auto _target = StringCast<ANSICHAR>(*targets[t]);
+                SpiceDouble _previous[3] = {};
+                for (int32 k = 0; k <= Settings.MaxRefineSteps && !failed_c(); ++k)
+                {
+                    const double et = Start + k * Step;
+                    if (et > Stop)
+                    {
+                        break;
+                    }
+
+                    SpiceDouble _r[3], _lt;
+                    spkpos_c(_target.Get(), et, "J2000", "NONE", _obsrvr.Get(), _r, &_lt);
+                    if (k > 0 && !failed_c())
+                    {
+                        Worst = FMath::Max(Worst, vsep_c(_previous, _r));
+                    }
+                    vequ_c(_r, _previous);
+                }
+            }
+
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+            if (Worst <= MaxAngle)
+            {
+                break;
+            }
+
+            Step /= 2.;
+            ++Choice.Refinements;
+        }
+
+        Choice.Step = FSEphemerisPeriod(Step);
+        Choice.TimeScale = FSEphemerisPeriod(TimeScale);
+        Choice.Basis = Basis;
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE gf step: %.3f s, from %s (%.3f s), %d refinement(s)"), Step, *Basis, TimeScale, Choice.Refinements);
+        return true;
+    }
+
+
+    SPICE_API TArray<TArray<FSEphemerisTimeWindowSegment>> PartitionWindow(
+        const TArray<FSEphemerisTimeWindowSegment>& Window,
+        int32 Partitions,
+        const FSEphemerisPeriod& Overlap
+    )
+    {
+        TArray<FWindow> Pieces;
+
+        // Total measure of the window
+        double Measure = 0.;
+        for (const FSEphemerisTimeWindowSegment& Segment : Window)
+        {
+            Measure += FMath::Max(0., Segment.stop.seconds - Segment.start.seconds);
+        }
+
+        Partitions = FMath::Max(1, Partitions);
+        if (Partitions == 1 || Measure <= 0.)
+        {
+            Pieces.Add(Window);
+            return Pieces;
+        }
+
+        // Find the partition boundaries, in window-time, then grow each piece
+        // by the overlap and clip it against the window.
+        const double PieceMeasure = Measure / Partitions;
+        TArray<double> Boundaries;
+        Boundaries.Add(Window[0].start.seconds);
+
+        double Accumulated = 0.;
+        for (const FSEphemerisTimeWindowSegment& Segment : Window)
+        {
+            double SegmentMeasure = FMath::Max(0., Segment.stop.seconds - Segment.start.seconds);
+            while (Boundaries.Num() < Partitions && Accumulated + SegmentMeasure >= PieceMeasure * Boundaries.Num())
+            {
+                Boundaries.Add(Segment.start.seconds + (PieceMeasure * Boundaries.Num() - Accumulated));
+            }
+            Accumulated += SegmentMeasure;
+        }
+        Boundaries.Add(Window.Last().stop.seconds);
+
+        for (int32 p = 0; p + 1 < Boundaries.Num(); ++p)
+        {
+            const double Lo = Boundaries[p] - Overlap.seconds;
+            const double Hi = Boundaries[p + 1] + Overlap.seconds;
+
+            FWindow Piece;
+            for (const FSEphemerisTimeWindowSegment& Segment : Window)
+            {
+                double Start = FMath::Max(Lo, Segment.start.seconds);
+                double Stop = FMath::Min(Hi, Segment.stop.seconds);
+                if (Start < Stop)
+                {
+                    Piece.Add(FSEphemerisTimeWindowSegment(Start, Stop));
+                }
+            }
+
+            if (Piece.Num() > 0)
+            {
+                Pieces.Add(MoveTemp(Piece));
+            }
+        }
+
+        return Pieces;
+    }
+
+
+    SPICE_API TArray<FSEphemerisTimeWindowSegment> UnionWindows(
+        const TArray<TArray<FSEphemerisTimeWindowSegment>>& Windows,
+        double PointTolerance
+    )
+    {
+        FWindow All;
+        for (const FWindow& Window : Windows)
+        {
+            All.Append(Window);
+        }
+
+        All.Sort([](const FSEphemerisTimeWindowSegment& A, const FSEphemerisTimeWindowSegment& B)
+        {
+            return A.start.seconds < B.start.seconds;
+        });
+
+        auto IsPoint = [](const FSEphemerisTimeWindowSegment& Segment) { return Segment.start.seconds == Segment.stop.seconds; };
+
+        FWindow Merged;
+        for (const FSEphemerisTimeWindowSegment& Segment : All)
+        {
+            if (Merged.Num() > 0 && IsPoint(Segment) && IsPoint(Merged.Last()) && Segment.start.seconds - Merged.Last().stop.seconds <= PointTolerance)
+            {
+                continue;
+            }
+
+            if (Merged.Num() > 0 && Segment.start.seconds <= Merged.Last().stop.seconds)
+            {
+                Merged.Last().stop.seconds = FMath::Max(Merged.Last().stop.seconds, Segment.stop.seconds);
+            }
+            else
+            {
+                Merged.Add(Segment);
+            }
+        }
+
+        return Merged;
+    }
+
+
+    FGfPartialResults::FGfPartialResults(const TArray<TArray<FSEphemerisTimeWindowSegment>>& Pieces, double _PointTolerance)
+        : PointTolerance(_PointTolerance)
+    {
+        Received.SetNum(Pieces.Num());
+        Cutoffs.SetNum(Pieces.Num());
+
+        // Empty pieces don't bound anything:  a piece's cutoff is the next
+        // non-empty piece's start
+        bool bAny = false;
+        for (const FWindow& Piece : Pieces)
+        {
+            if (Piece.Num() > 0)
+            {
+                Begin = bAny ? FMath::Min(Begin, Piece[0].start.seconds) : Piece[0].start.seconds;
+                End = bAny ? FMath::Max(End, Piece.Last().stop.seconds) : Piece.Last().stop.seconds;
+                bAny = true;
+            }
+        }
+
+        double Cutoff = End;
+        for (int32 p = Pieces.Num() - 1; p >= 0; --p)
+        {
+            Cutoffs[p] = Cutoff;
+            if (Pieces[p].Num() > 0)
+            {
+                Cutoff = Pieces[p][0].start.seconds;
+            }
+        }
+    }
+
+
+    bool FGfPartialResults::Add(int32 Piece, TArray<FSEphemerisTimeWindowSegment>&& Results, TArray<FSEphemerisTimeWindowSegment>& Final)
+    {
+        check(Received.IsValidIndex(Piece));
+        Received[Piece].Emplace(MoveTemp(Results));
+
+        const int32 First = Next;
+        while (Next < Received.Num() && Received[Next].IsSet())
+        {
+            const FWindow Merged = UnionWindows({ Held, Received[Next].GetValue() }, PointTolerance);
+            Received[Next].Reset();
+            Held.Reset();
+
+            const bool bLast = Next == Received.Num() - 1;
+            for (const FSEphemerisTimeWindowSegment& Segment : Merged)
+            {
+                if (bLast || Segment.stop.seconds < Cutoffs[Next])
+                {
+                    Final.Add(Segment);
+                }
+                else
+                {
+                    Held.Add(Segment);
+                }
+            }
+            ++Next;
+        }
+
+        return Next > First;
+    }
+
+
+    FSEphemerisTime FGfPartialResults::Through() const
+    {
+        if (Next == 0)
+        {
+            return FSEphemerisTime(Begin);
+        }
+        if (IsComplete())
+        {
+            return FSEphemerisTime(End);
+        }
+        return FSEphemerisTime(Held.Num() > 0 ? FMath::Min(Cutoffs[Next - 1], Held[0].start.seconds) : Cutoffs[Next - 1]);
+    }
+
+
+    SPICE_API void GfdistParallel(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FSDistance& refval,
+        const FSDistance& adjust,
+        const FString& target,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FGfdistArgs Args{ step, refval, adjust, target, abcorr, obsrvr, relate };
+        RunParallel(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void GfocltParallel(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FGfocltArgs Args{ step, frontShapeSurfaces, backShapeSurfaces, occtyp, front, frontShape, frontframe, back, backShape, backFrame, abcorr, obsrvr };
+        RunParallel(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void GfposcParallel(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const FSEphemerisPeriod& step,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FString& target,
+        const FString& frame,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_CoordinateSystemInclRadec crdsys,
+        ES_CoordinateName coord,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust,
+        int nintvls,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FGfposcArgs Args{ step, target, frame, abcorr, obsrvr, crdsys, coord, relate, refval, adjust, nintvls };
+        RunParallel(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void GfsepParallel(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSAngle& refval,
+        const FSAngle& adjust,
+        const FSEphemerisPeriod& step,
+        const FString& targ1,
+        ES_OtherGeometricModel shape1,
+        const FString& targ2,
+        ES_OtherGeometricModel shape2,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FGfsepArgs Args{ refval, adjust, step, targ1, shape1, targ2, shape2, abcorr, obsrvr, relate };
+        RunParallel(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void GfdistCached(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FSDistance& refval,
+        const FSDistance& adjust,
+        const FString& target,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FGfdistArgs Args{ step, refval, adjust, target, abcorr, obsrvr, relate };
+        RunCached(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void GfocltCached(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FGfocltArgs Args{ step, frontShapeSurfaces, backShapeSurfaces, occtyp, front, frontShape, frontframe, back, backShape, backFrame, abcorr, obsrvr };
+        RunCached(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void GfposcCached(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const FSEphemerisPeriod& step,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FString& target,
+        const FString& frame,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_CoordinateSystemInclRadec crdsys,
+        ES_CoordinateName coord,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust,
+        int nintvls,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FGfposcArgs Args{ step, target, frame, abcorr, obsrvr, crdsys, coord, relate, refval, adjust, nintvls };
+        RunCached(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void GfsepCached(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSAngle& refval,
+        const FSAngle& adjust,
+        const FSEphemerisPeriod& step,
+        const FString& targ1,
+        ES_OtherGeometricModel shape1,
+        const FString& targ2,
+        ES_OtherGeometricModel shape2,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FGfsepArgs Args{ refval, adjust, step, targ1, shape1, targ2, shape2, abcorr, obsrvr, relate };
+        RunCached(Args, results, cnfine, Partitions, ResultCode, ErrorMessage);
+    }
+
+
+    FGfIncrementalSearch::FGfIncrementalSearch(FSearch&& _Search, const FSEphemerisPeriod& _Step, bool _bIncremental)
+        : Search(MoveTemp(_Search))
+        , Step(_Step.seconds)
+        , bIncremental(_bIncremental)
+    {
+    }
+
+
+    FGfIncrementalSearch FGfIncrementalSearch::Gfdist(
+        const FSEphemerisPeriod& step,
+        const FSDistance& refval,
+        const FSDistance& adjust,
+        const FString& target,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate
+    )
+    {
+        return MakeIncremental(FGfdistArgs{ step, refval, adjust, target, abcorr, obsrvr, relate });
+    }
+
+
+    FGfIncrementalSearch FGfIncrementalSearch::Gfoclt(
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr
+    )
+    {
+        return MakeIncremental(FGfocltArgs{ step, frontShapeSurfaces, backShapeSurfaces, occtyp, front, frontShape, frontframe, back, backShape, backFrame, abcorr, obsrvr });
+    }
+
+
+    FGfIncrementalSearch FGfIncrementalSearch::Gfposc(
+        const FSEphemerisPeriod& step,
+        const FString& target,
+        const FString& frame,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_CoordinateSystemInclRadec crdsys,
+        ES_CoordinateName coord,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust,
+        int nintvls
+    )
+    {
+        return MakeIncremental(FGfposcArgs{ step, target, frame, abcorr, obsrvr, crdsys, coord, relate, refval, adjust, nintvls });
+    }
+
+
+    FGfIncrementalSearch FGfIncrementalSearch::Gfsep(
+        const FSAngle& refval,
+        const FSAngle& adjust,
+        const FSEphemerisPeriod& step,
+        const FString& targ1,
+        ES_OtherGeometricModel shape1,
+        const FString& targ2,
+        ES_OtherGeometricModel shape2,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate
+    )
+    {
+        return MakeIncremental(FGfsepArgs{ refval, adjust, step, targ1, shape1, targ2, shape2, abcorr, obsrvr, relate });
+    }
+
+
+    bool FGfIncrementalSearch::Extend(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MakeErrorGutter(ResultCode, ErrorMessage);
+        *ResultCode = ES_ResultCode::Success;
+        ErrorMessage->Empty();
+        LastSearched = 0.;
+
+        const FSWindow Extended = Coverage | FSWindow(cnfine);
+        const FSWindow Uncovered = Extended - Coverage;
+        if (Uncovered.Measure() <= 0.)
+        {
+            return true;
+        }
+
+        // Absolute extrema:  the whole window, again
+        if (!bIncremental)
+        {
+            FWindow Found;
+            const FWindow Window = Extended.ToSegments();
+            Search(*ResultCode, *ErrorMessage, Found, Window);
+            if (*ResultCode != ES_ResultCode::Success)
+            {
+                return false;
+            }
+
+            LastSearched = Extended.Measure();
+            Coverage = Extended;
+            Results = FSWindow(Found);
+            return true;
+        }
+
+        // The new part, plus a step of what was already searched on each
+        // side.  Only what's found in the new part is kept:  an interval that
+        // was cut off at the old boundary then abuts its continuation, and
+        // merges with it.
+        FSWindow Grown = Uncovered;
+        Grown.Expand(Step, Step);
+        Grown = Grown & Extended;
+
+        FWindow Found;
+        const FWindow Window = Grown.ToSegments();
+        Search(*ResultCode, *ErrorMessage, Found, Window);
+        if (*ResultCode != ES_ResultCode::Success)
+        {
+            return false;
+        }
+
+        LastSearched = Grown.Measure();
+        Coverage = Extended;
+        Results = Results | (FSWindow(Found) & Uncovered);
+        return true;
+    }
+
+
+    void FGfIncrementalSearch::Reset()
+    {
+        Coverage.Reset();
+        Results.Reset();
+        LastSearched = 0.;
+    }
+
+
+    SPICE_API TFuture<FGeometryFinderAsyncResult> GfdistAsync(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FSDistance& refval,
+        const FSDistance& adjust,
+        const FString& target,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle,
+        FGeometryFinderAsyncProgress&& OnProgress,
+        FGeometryFinderAsyncPartial&& OnPartial
+    )
+    {
+        FGfdistArgs Args{ step, refval, adjust, target, abcorr, obsrvr, relate };
+        return RunAsync(Args, cnfine, Partitions, Handle, MoveTemp(OnProgress), MoveTemp(OnPartial));
+    }
+
+
+    SPICE_API TFuture<FGeometryFinderAsyncResult> GfocltAsync(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        int32 Partitions,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle,
+        FGeometryFinderAsyncProgress&& OnProgress,
+        FGeometryFinderAsyncPartial&& OnPartial
+    )
+    {
+        FGfocltArgs Args{ step, frontShapeSurfaces, backShapeSurfaces, occtyp, front, frontShape, frontframe, back, backShape, backFrame, abcorr, obsrvr };
+        return RunAsync(Args, cnfine, Partitions, Handle, MoveTemp(OnProgress), MoveTemp(OnPartial));
+    }
+
+
+    SPICE_API TFuture<FGeometryFinderAsyncResult> GfposcAsync(
+        const FSEphemerisPeriod& step,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FString& target,
+        const FString& frame,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_CoordinateSystemInclRadec crdsys,
+        ES_CoordinateName coord,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust,
+        int nintvls,
+        int32 Partitions,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle,
+        FGeometryFinderAsyncProgress&& OnProgress,
+        FGeometryFinderAsyncPartial&& OnPartial
+    )
+    {
+        FGfposcArgs Args{ step, target, frame, abcorr, obsrvr, crdsys, coord, relate, refval, adjust, nintvls };
+        return RunAsync(Args, cnfine, Partitions, Handle, MoveTemp(OnProgress), MoveTemp(OnPartial));
+    }
+
+
+    SPICE_API TFuture<FGeometryFinderAsyncResult> GfsepAsync(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSAngle& refval,
+        const FSAngle& adjust,
+        const FSEphemerisPeriod& step,
+        const FString& targ1,
+        ES_OtherGeometricModel shape1,
+        const FString& targ2,
+        ES_OtherGeometricModel shape2,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle,
+        FGeometryFinderAsyncProgress&& OnProgress,
+        FGeometryFinderAsyncPartial&& OnPartial
+    )
+    {
+        FGfsepArgs Args{ refval, adjust, step, targ1, shape1, targ2, shape2, abcorr, obsrvr, relate };
+        return RunAsync(Args, cnfine, Partitions, Handle, MoveTemp(OnProgress), MoveTemp(OnPartial));
+    }
+}
+
+
+namespace
+{
+    using namespace MaxQ::GeometryFinder;
+
+    struct FGfUserSearch
+    {
+        const FGfUserScalar* Quantity = nullptr;
+        const TFunction<bool(double)>* Condition = nullptr;
+        const FGfSearchControl* Control = FGfSearchControlScope::Current();
+    };
+    thread_local const FGfUserSearch* CurrentUserSearch = nullptr;
+
+    bool UserSearchCancelled()
+    {
+        const FGfSearchControl* Control = CurrentUserSearch->Control;
+        if (!Control || !Control->ShouldCancel || !Control->ShouldCancel())
+        {
+            return false;
+        }
+
+        setmsg_c("The search was cancelled.");
+        sigerr_c("SPICE(CANCELLED)");
+        return true;
+    }
+
+    void UserValue(SpiceDouble et, SpiceDouble* value)
+    {
+        *value = 0.;
+        if (failed_c() || UserSearchCancelled())
+        {
+            return;
+        }
+
+        const double Value = CurrentUserSearch->Quantity->Value(et);
+        if (FMath::IsNaN(Value))
+        {
+            setmsg_c("The user-defined quantity has no value at ET #.");
+            errdp_c("#", et);
+            sigerr_c("SPICE(NOTCOMPUTABLE)");
+            return;
+        }
+        *value = Value;
+    }
+
+    void UserIsDecreasing(void (*udfuns)(SpiceDouble, SpiceDouble*), SpiceDouble et, SpiceBoolean* isdecr)
+    {
+        *isdecr = SPICEFALSE;
+        if (failed_c() || UserSearchCancelled())
+        {
+            return;
+        }
+
+        const FGfUserScalar& Quantity = *CurrentUserSearch->Quantity;
+        if (Quantity.IsDecreasing)
+        {
+            *isdecr = Quantity.IsDecreasing(et) ? SPICETRUE : SPICEFALSE;
+        }
+        else if (Quantity.Derivative)
+        {
+            *isdecr = Quantity.Derivative(et) < 0. ? SPICETRUE : SPICEFALSE;
+        }
+        else
+        {
+            uddc_c(udfuns, et, Quantity.DerivativeStep, isdecr);
+        }
+    }
+
+    // gfudb_c wants a scalar function too, which the condition doesn't use
+    void NoValue(SpiceDouble et, SpiceDouble* value)
+    {
+        *value = 0.;
+    }
+
+    void UserCondition(void (*udfuns)(SpiceDouble, SpiceDouble*), SpiceDouble et, SpiceBoolean* xbool)
+    {
+        *xbool = SPICEFALSE;
+        if (failed_c() || UserSearchCancelled())
+        {
+            return;
+        }
+
+        *xbool = (*CurrentUserSearch->Condition)(et) ? SPICETRUE : SPICEFALSE;
+    }
+
+    // Makes Search the current one on this thread (restoring the previous,
+    // should a user function search, too)
+    struct FGfUserSearchScope
+    {
+        explicit FGfUserSearchScope(const FGfUserSearch& Search) : Previous(CurrentUserSearch) { CurrentUserSearch = &Search; }
+        ~FGfUserSearchScope() { CurrentUserSearch = Previous; }
+
+        const FGfUserSearch* Previous;
+    };
+
+    double Norm(const double (&r)[3])
+    {
+        return FMath::Sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+    }
+}
+
+
+namespace MaxQ::GeometryFinder
+{
+    SPICE_API bool GfUserScalar(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FGfUserScalar& Quantity,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        results.Reset();
+
+        if (!Quantity.Value)
+        {
+            setmsg_c("The user-defined quantity has no Value function.");
+            sigerr_c("SPICE(NULLPOINTER)");
+            ErrorCheck(ResultCode, ErrorMessage);
+            return false;
+        }
+
+        // Room for the intervals, as USpice::gfdist allows
+        double MaxWindow = 0.;
+        for (const FSEphemerisTimeWindowSegment& Segment : cnfine)
+        {
+            MaxWindow = FMath::Max(MaxWindow, Segment.stop.seconds - Segment.start.seconds);
+        }
+        const SpiceDouble _step = step.AsSpiceDouble();
+        const SpiceInt _nintvls = 2 * cnfine.Num() + (_step > 0. ? SpiceInt(MaxWindow / _step) : 0) + 2;
+        ConstSpiceChar* _relate = MaxQ::Core::ToANSIString(relate);
+
+        FGfUserSearch Search;
+        Search.Quantity = &Quantity;
+        FGfUserSearchScope Scope(Search);
+
+        GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
+        {
+            gfuds_c(UserValue, UserIsDecreasing, _relate, refval, adjust, _step, _nintvls, _cnfine, _result);
+        });
+
+        return ErrorCheck(ResultCode, ErrorMessage) == 0;
+    }
+
+
+    SPICE_API bool GfUserCondition(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        TFunction<bool(double et)> Condition,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        results.Reset();
+
+        if (!Condition)
+        {
+            setmsg_c("The user-defined condition is null.");
+            sigerr_c("SPICE(NULLPOINTER)");
+            ErrorCheck(ResultCode, ErrorMessage);
+            return false;
+        }
+
+        FGfUserSearch Search;
+        Search.Condition = &Condition;
+        FGfUserSearchScope Scope(Search);
+
+        GfSearch(cnfine, results, [&](SpiceCell* _cnfine, SpiceCell* _result)
+        {
+            gfudb_c(NoValue, UserCondition, step.AsSpiceDouble(), _cnfine, _result);
+        });
+
+        return ErrorCheck(ResultCode, ErrorMessage) == 0;
+    }
+
+
+    SPICE_API FGfUserScalar CachedDistance(const MaxQ::Ephemeris::FChebyshevCache& Cache, int32 BodyIndex)
+    {
+        const MaxQ::Ephemeris::FChebyshevCache* CachePtr = &Cache;
+
+        FGfUserScalar Quantity;
+        Quantity.Value = [CachePtr, BodyIndex](double et)
+        {
+            double r[3];
+            return CachePtr->Evaluate(BodyIndex, et, r) ? Norm(r) : std::numeric_limits<double>::quiet_NaN();
+        };
+        // d|r|/dt = r.v / |r|, which has the sign of r.v
+        Quantity.Derivative = [CachePtr, BodyIndex](double et)
+        {
+            double r[3], v[3];
+            return CachePtr->Evaluate(BodyIndex, et, r, v) ? r[0] * v[0] + r[1] * v[1] + r[2] * v[2] : 0.;
+        };
+        return Quantity;
+    }
+
+
+    SPICE_API FGfUserScalar CachedRangeRate(const MaxQ::Ephemeris::FChebyshevCache& Cache, int32 BodyIndex)
+    {
+        const MaxQ::Ephemeris::FChebyshevCache* CachePtr = &Cache;
+
+        FGfUserScalar Quantity;
+        Quantity.Value = [CachePtr, BodyIndex](double et)
+        {
+            double r[3], v[3];
+            if (!CachePtr->Evaluate(BodyIndex, et, r, v))
+            {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            const double Range = Norm(r);
+            return Range > 0. ? (r[0] * v[0] + r[1] * v[1] + r[2] * v[2]) / Range : 0.;
+        };
+        return Quantity;
+    }
+}
+
+
+namespace
+{
+    // A body's bounding sphere, as obsrvr sees it
+    struct FBoundingSphere
+    {
+        // Angular radius and its rate of change (bounded)
+        double AngularRadius = 0.;
+        double AngularRadiusRate = 0.;
+        // Rate the direction to its center turns
+        double TurnRate = 0.;
+        SpiceDouble Direction[3] = {};
+    };
+
+    void SeeBoundingSphere(const SpiceDouble (&_state)[6], double Radius, FBoundingSphere& Sphere)
+    {
+        const double d = vnorm_c(_state);
+        vequ_c(_state, Sphere.Direction);
+
+        if (d <= Radius)
+        {
+            // The observer is inside it:  it covers the sky
+            Sphere.AngularRadius = PI;
+            Sphere.AngularRadiusRate = 0.;
+            Sphere.TurnRate = 0.;
+            return;
+        }
+
+        SpiceDouble _cross[3];
+        vcrss_c(_state, _state + 3, _cross);
+        Sphere.TurnRate = vnorm_c(_cross) / (d * d);
+        Sphere.AngularRadius = FMath::Asin(Radius / d);
+        // d(asin(R/d))/dt = -R d' / (d sqrt(d^2 - R^2)), d' = r.v / d
+        Sphere.AngularRadiusRate = Radius > 0. ? Radius * FMath::Abs(vdot_c(_state, _state + 3) / d) / (d * FMath::Sqrt(d * d - Radius * Radius)) : 0.;
+    }
+
+    // The largest radius a DSK segment's coordinate bounds reach
+    bool SegmentBoundingRadius(const SpiceDSKDescr& _dskdsc, double& Radius)
+    {
+        auto Larger = [](double a, double b) { return FMath::Max(a * a, b * b); };
+
+        switch (_dskdsc.corsys)
+        {
+        case SPICE_DSK_LATSYS:
+            Radius = _dskdsc.co3max;
+            return true;
+        case SPICE_DSK_CYLSYS:
+            Radius = FMath::Sqrt(_dskdsc.co1max * _dskdsc.co1max + Larger(_dskdsc.co3min, _dskdsc.co3max));
+            return true;
+        case SPICE_DSK_RECSYS:
+            Radius = FMath::Sqrt(Larger(_dskdsc.co1min, _dskdsc.co1max) + Larger(_dskdsc.co2min, _dskdsc.co2max) + Larger(_dskdsc.co3min, _dskdsc.co3max));
+            return true;
+        case SPICE_DSK_PDTSYS:
+        {
+            // Altitude above a spheroid (equatorial radius, flattening)
+            const double re = _dskdsc.corpar[0];
+            const double rp = re * (1. - _dskdsc.corpar[1]);
+            Radius = FMath::Max(re, rp) + FMath::Max(_dskdsc.co3max, 0.);
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+}
+
+
+namespace MaxQ::GeometryFinder
+{
+    SPICE_API bool BoundingRadius(
+        double& Radius,
+        const FString& body,
+        ES_GeometricModel shape,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Radius = 0.;
+
+        auto _body = StringCast<ANSICHAR>(*body);
+        SpiceInt _code = 0;
+
+        switch (shape)
+        {
+        case ES_GeometricModel::POINT:
+            break;
+
+        case ES_GeometricModel::ELLIPSOID:
+            if (ResolveBody(_body.Get(), _code))
+            {
+                SpiceInt _n = 0;
+                SpiceDouble _radii[3] = {};
+                bodvcd_c(_code, "RADII", 3, &_n, _radii);
+                Radius = FMath::Max3(_radii[0], _radii[1], _radii[2]);
+            }
+            break;
+
+        case ES_GeometricModel::DSK:
+        {
+            if (!ResolveBody(_body.Get(), _code))
+            {
+                break;
+            }
+
+            TArray<SpiceInt> Handles;
+            LoadedDskHandles(Handles);
+
+            bool bFound = false;
+            for (int32 i = 0; i < Handles.Num() && !failed_c(); ++i)
+            {
+                SpiceDLADescr _dladsc;
+                SpiceBoolean _found = SPICEFALSE;
+                dlabfs_c(Handles[i], &_dladsc, &_found);
+
+                while (_found && !failed_c())
+                {
+                    SpiceDSKDescr _dskdsc;
+                    dskgd_c(Handles[i], &_dladsc, &_dskdsc);
+
+                    double SegmentRadius = 0.;
+                    if (!failed_c() && _dskdsc.center == _code)
+                    {
+                        if (SegmentBoundingRadius(_dskdsc, SegmentRadius))
+                        {
+                            Radius = FMath::Max(Radius, SegmentRadius);
+                            bFound = true;
+                        }
+                        else
+                        {
+                            setmsg_c("A DSK segment for # uses coordinate system #, which has no bounding radius.");
+                            errch_c("#", _body.Get());
+                            errint_c("#", _dskdsc.corsys);
+                            sigerr_c("SPICE(NOTSUPPORTED)");
+                        }
+                    }
+
+                    SpiceDLADescr _nxtdsc;
+                    dlafns_c(Handles[i], &_dladsc, &_nxtdsc, &_found);
+                    _dladsc = _nxtdsc;
+                }
+            }
+
+            if (!bFound && !failed_c())
+            {
+                setmsg_c("No loaded DSK segment has a shape for #.");
+                errch_c("#", _body.Get());
+                sigerr_c("SPICE(NODSKSEGMENTS)");
+            }
+            break;
+        }
+
+        default:
+            setmsg_c("# has no shape model to bound.");
+            errch_c("#", _body.Get());
+            sigerr_c("SPICE(INVALIDSHAPE)");
+            break;
+        }
+
+        return ErrorCheck(ResultCode, ErrorMessage) == 0;
+    }
+
+
+    SPICE_API bool OccultationCandidates(
+        TArray<FSEphemerisTimeWindowSegment>& candidates,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& back,
+        ES_GeometricModel backShape,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        const FGfOccultationPrefilter& Prefilter,
+        FGfOccultationPrefilterStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        candidates.Empty();
+
+        FGfOccultationPrefilterStats LocalStats;
+        FGfOccultationPrefilterStats& Out = Stats ? *Stats : LocalStats;
+        Out = FGfOccultationPrefilterStats();
+
+        const double h = Prefilter.SampleStep.seconds > 0. ? Prefilter.SampleStep.seconds : step.seconds;
+        if (h <= 0.)
+        {
+            setmsg_c("The pre-filter's sample step (#) must be positive.");
+            errdp_c("#", h);
+            sigerr_c("SPICE(INVALIDSTEP)");
+            ErrorCheck(ResultCode, ErrorMessage);
+            return false;
+        }
+
+        if (!BoundingRadius(Out.FrontRadius, front, frontShape, ResultCode, ErrorMessage)
+            || !BoundingRadius(Out.BackRadius, back, backShape, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        auto _front = StringCast<ANSICHAR>(*front);
+        auto _back = StringCast<ANSICHAR>(*back);
+        auto _obsrvr = StringCast<ANSICHAR>(*obsrvr);
+        ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+        const double Safety = FMath::Max(Prefilter.Safety, 1.);
+
+        // The spheres' angular separation less their angular radii (which
+        // must reach zero for any occultation), and a bound on how fast it
+        // can fall
+        auto Sample = [&](double et, double& Margin, double& Rate)
+        {
+            SpiceDouble _state[6], _lt;
+            FBoundingSphere Front, Back;
+            spkezr_c(_front.Get(), et, "J2000", _abcorr, _obsrvr.Get(), _state, &_lt);
+            SeeBoundingSphere(_state, Out.FrontRadius, Front);
+            spkezr_c(_back.Get(), et, "J2000", _abcorr, _obsrvr.Get(), _state, &_lt);
+            SeeBoundingSphere(_state, Out.BackRadius, Back);
+
+            Margin = vsep_c(Front.Direction, Back.Direction) - Front.AngularRadius - Back.AngularRadius;
+            Rate = Front.TurnRate + Back.TurnRate + Front.AngularRadiusRate + Back.AngularRadiusRate;
+            ++Out.Samples;
+        };
+
+        FSWindow Candidates;
+        for (const FSEphemerisTimeWindowSegment& Segment : cnfine)
+        {
+            const double Start = Segment.start.seconds;
+            const double Stop = Segment.stop.seconds;
+            Out.WindowSeconds += FMath::Max(Stop - Start, 0.);
+
+            double t0 = Start, m0 = 0., w0 = 0.;
+            Sample(t0, m0, w0);
+            if (Stop <= Start && m0 <= 0.)
+            {
+                Candidates.Insert(Start, Stop);
+            }
+
+            while (t0 < Stop && !failed_c())
+            {
+                const double t1 = FMath::Min(t0 + h, Stop);
+                double m1 = 0., w1 = 0.;
+                Sample(t1, m1, w1);
+
+                // Falling from both ends at the fastest rate seen, the margin
+                // stays above (m0 + m1 - w (t1 - t0)) / 2 in between
+                if (m0 + m1 <= Safety * FMath::Max(w0, w1) * (t1 - t0))
+                {
+                    Candidates.Insert(t0, t1);
+                }
+
+                t0 = t1;
+                m0 = m1;
+                w0 = w1;
+            }
+
+            if (failed_c())
+            {
+                break;
+            }
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        Out.CandidateSeconds = Candidates.Measure();
+        candidates = Candidates.ToSegments();
+        return true;
+    }
+
+
+    SPICE_API bool GfocltPrefiltered(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        const FGfOccultationPrefilter& Prefilter,
+        FGfOccultationPrefilterStats* Stats,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        results.Reset();
+
+        FWindow candidates;
+        if (!OccultationCandidates(candidates, cnfine, step, front, frontShape, back, backShape, abcorr, obsrvr, Prefilter, Stats, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        // Nowhere close:  nothing to search
+        if (candidates.Num() == 0)
+        {
+            return true;
+        }
+
+        ES_ResultCode _ResultCode = ES_ResultCode::Success;
+        FString _ErrorMessage;
+        USpice::gfoclt(_ResultCode, _ErrorMessage, results, candidates, step, frontShapeSurfaces, backShapeSurfaces, occtyp, front, frontShape, frontframe, back, backShape, backFrame, abcorr, obsrvr);
+
+        if (ResultCode) *ResultCode = _ResultCode;
+        if (ErrorMessage) *ErrorMessage = _ErrorMessage;
+        return _ResultCode == ES_ResultCode::Success;
+    }
+}
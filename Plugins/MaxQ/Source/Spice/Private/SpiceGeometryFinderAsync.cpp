@@ -0,0 +1,189 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGeometryFinderAsync.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Blueprint nodes for geometry finder searches that don't block
+// the game thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGeometryFinderAsync.cpp is part of the "Blueprints API".
+//
+// Each factory binds its arguments into a search that Activate starts, so
+// one node class serves every search.
+//------------------------------------------------------------------------------
+
+#include "SpiceGeometryFinderAsync.h"
+#include "Async/Async.h"
+
+using namespace MaxQ::GeometryFinder;
+
+
+USpiceGeometryFinderAsync* USpiceGeometryFinderAsync::Create(UObject* WorldContextObject, FSearch&& _Search)
+{
+    USpiceGeometryFinderAsync* Action = NewObject<USpiceGeometryFinderAsync>();
+    Action->Search = MoveTemp(_Search);
+    Action->RegisterWithGameInstance(WorldContextObject);
+
+    return Action;
+}
+
+
+USpiceGeometryFinderAsync* USpiceGeometryFinderAsync::gfdist_async(
+    UObject* WorldContextObject,
+    const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+    const FSEphemerisPeriod& step,
+    const FSDistance& refval,
+    const FSDistance& adjust,
+    const FString& target,
+    ES_AberrationCorrectionWithTransmissions abcorr,
+    const FString& obsrvr,
+    ES_RelationalOperator relate
+)
+{
+    return Create(WorldContextObject, [=](FHandle* _Handle, FGeometryFinderAsyncProgress&& Progress, FGeometryFinderAsyncPartial&& Partial)
+    {
+        return GfdistAsync(cnfine, step, refval, adjust, target, abcorr, obsrvr, relate, 0, _Handle, MoveTemp(Progress), MoveTemp(Partial));
+    });
+}
+
+
+USpiceGeometryFinderAsync* USpiceGeometryFinderAsync::gfoclt_async(
+    UObject* WorldContextObject,
+    const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+    const FSEphemerisPeriod& step,
+    const TArray<FString>& frontShapeSurfaces,
+    const TArray<FString>& backShapeSurfaces,
+    ES_OccultationType occtyp,
+    const FString& front,
+    ES_GeometricModel frontShape,
+    const FString& frontframe,
+    const FString& back,
+    ES_GeometricModel backShape,
+    const FString& backFrame,
+    ES_AberrationCorrectionForOccultation abcorr,
+    const FString& obsrvr
+)
+{
+    return Create(WorldContextObject, [=](FHandle* _Handle, FGeometryFinderAsyncProgress&& Progress, FGeometryFinderAsyncPartial&& Partial)
+    {
+        return GfocltAsync(cnfine, step, frontShapeSurfaces, backShapeSurfaces, occtyp, front, frontShape, frontframe, back, backShape, backFrame, abcorr, obsrvr, 0, _Handle, MoveTemp(Progress), MoveTemp(Partial));
+    });
+}
+
+
+USpiceGeometryFinderAsync* USpiceGeometryFinderAsync::gfposc_async(
+    UObject* WorldContextObject,
+    const FSEphemerisPeriod& step,
+    const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+    const FString& target,
+    const FString& frame,
+    ES_AberrationCorrectionWithTransmissions abcorr,
+    const FString& obsrvr,
+    ES_CoordinateSystemInclRadec crdsys,
+    ES_CoordinateName coord,
+    ES_RelationalOperator relate,
+    double refval,
+    double adjust,
+    int nintvls
+)
+{
+    return Create(WorldContextObject, [=](FHandle* _Handle, FGeometryFinderAsyncProgress&& Progress, FGeometryFinderAsyncPartial&& Partial)
+    {
+        return GfposcAsync(step, cnfine, target, frame, abcorr, obsrvr, crdsys, coord, relate, refval, adjust, nintvls, 0, _Handle, MoveTemp(Progress), MoveTemp(Partial));
+    });
+}
+
+
+USpiceGeometryFinderAsync* USpiceGeometryFinderAsync::gfsep_async(
+    UObject* WorldContextObject,
+    const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+    const FSAngle& refval,
+    const FSAngle& adjust,
+    const FSEphemerisPeriod& step,
+    const FString& targ1,
+    ES_OtherGeometricModel shape1,
+    const FString& targ2,
+    ES_OtherGeometricModel shape2,
+    ES_AberrationCorrectionWithTransmissions abcorr,
+    const FString& obsrvr,
+    ES_RelationalOperator relate
+)
+{
+    return Create(WorldContextObject, [=](FHandle* _Handle, FGeometryFinderAsyncProgress&& Progress, FGeometryFinderAsyncPartial&& Partial)
+    {
+        return GfsepAsync(cnfine, refval, adjust, step, targ1, shape1, targ2, shape2, abcorr, obsrvr, relate, 0, _Handle, MoveTemp(Progress), MoveTemp(Partial));
+    });
+}
+
+
+void USpiceGeometryFinderAsync::Activate()
+{
+    TWeakObjectPtr<USpiceGeometryFinderAsync> WeakThis(this);
+
+    Search(&Handle, [WeakThis](int32 Done, int32 Num)
+    {
+        if (USpiceGeometryFinderAsync* This = WeakThis.Get())
+        {
+            This->OnProgress.Broadcast(Done, Num);
+        }
+    },
+    [WeakThis](const TArray<FSEphemerisTimeWindowSegment>& Segments, const FSEphemerisTime& Through)
+    {
+        if (USpiceGeometryFinderAsync* This = WeakThis.Get())
+        {
+            This->OnPartial.Broadcast(Segments, Through);
+        }
+    })
+    .Next([WeakThis](const FGeometryFinderAsyncResult& Result)
+    {
+        // Behind the last progress callback, on the game thread
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, Result]()
+        {
+            USpiceGeometryFinderAsync* This = WeakThis.Get();
+            if (!This)
+            {
+                return;
+            }
+
+            if (Result.bCancelled)
+            {
+                This->OnCancelled.Broadcast(Result.results, Result.ErrorMessage);
+            }
+            else if (Result.ResultCode == ES_ResultCode::Success)
+            {
+                This->OnSuccess.Broadcast(Result.results, Result.ErrorMessage);
+            }
+            else
+            {
+                This->OnFailure.Broadcast(Result.results, Result.ErrorMessage);
+            }
+
+            // Allow the UE Garbage Collector to free this object.
+            This->SetReadyToDestroy();
+        });
+    });
+
+    Search = nullptr;
+}
+
+
+void USpiceGeometryFinderAsync::Cancel()
+{
+    if (Handle.IsValid())
+    {
+        Handle->Cancel();
+    }
+}
@@ -0,0 +1,294 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGfResultCache.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Geometry finder results, kept for searches made again.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGfResultCache.cpp is part of the "refined C++ API".
+//
+// The fingerprint is only recomputed when the pool generation moves, so a
+// hit is a hash of the request and a map lookup.  An entry's key folds in
+// the fingerprint, which is also its file name on disk:  entries for other
+// kernel sets are never read, just left behind (Invalidate removes them).
+//------------------------------------------------------------------------------
+
+#include "SpiceGfResultCache.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+#include "HAL/FileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr uint32 EntryMagic = 0x43524647;  // "GFRC"
+    constexpr int32 EntryVersion = 1;
+
+    bool SerializeEntry(FArchive& Ar, TArray<FSEphemerisTimeWindowSegment>& results)
+    {
+        uint32 Magic = EntryMagic;
+        int32 Version = EntryVersion;
+        int32 Count = results.Num();
+        Ar << Magic << Version << Count;
+        if (Ar.IsLoading())
+        {
+            if (Ar.IsError() || Magic != EntryMagic || Version != EntryVersion || Count < 0 || Count > Ar.TotalSize() / (2 * sizeof(double)))
+            {
+                return false;
+            }
+            results.SetNum(Count);
+        }
+
+        for (FSEphemerisTimeWindowSegment& Segment : results)
+        {
+            Ar << Segment.start.seconds << Segment.stop.seconds;
+        }
+        return !Ar.IsError();
+    }
+}
+
+
+namespace MaxQ::GeometryFinder
+{
+    FGfResultCache& FGfResultCache::Get()
+    {
+        static FGfResultCache Instance;
+        return Instance;
+    }
+
+
+    void FGfResultCache::SetDirectory(const FString& relativeDirectory)
+    {
+        FScopeLock ScopeLock(&Lock);
+        Directory = relativeDirectory.IsEmpty() ? FString() : toPath(relativeDirectory);
+        if (!Directory.IsEmpty())
+        {
+            IFileManager::Get().MakeDirectory(*Directory, true);
+        }
+    }
+
+
+    FString FGfResultCache::GetDirectory() const
+    {
+        FScopeLock ScopeLock(&Lock);
+        return Directory;
+    }
+
+
+    void FGfResultCache::SetMaxEntries(int32 _MaxEntries)
+    {
+        FScopeLock ScopeLock(&Lock);
+        MaxEntries = FMath::Max(_MaxEntries, 1);
+        while (Order.Num() > MaxEntries)
+        {
+            Entries.Remove(Order[0]);
+            Order.RemoveAt(0);
+        }
+        Stats.Entries = Entries.Num();
+    }
+
+
+    uint64 FGfResultCache::KernelFingerprint()
+    {
+        FScopeLock ScopeLock(&Lock);
+
+        const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+        if (bFingerprinted && Generation == PoolGeneration)
+        {
+            return Fingerprint;
+        }
+
+        // What's in memory was found with the pool as it was
+        Entries.Empty();
+        Order.Empty();
+        Stats.Entries = 0;
+
+        constexpr SpiceInt FILLEN = 1024;
+        constexpr SpiceInt TYPLEN = 33;
+        constexpr SpiceInt SRCLEN = 1024;
+
+        uint64 Hash = EntryVersion;
+        SpiceInt _count = 0;
+        ktotal_c("ALL", &_count);
+        for (SpiceInt i = 0; i < _count && !failed_c(); ++i)
+        {
+            SpiceChar _file[FILLEN];
+            SpiceChar _filtyp[TYPLEN];
+            SpiceChar _srcfil[SRCLEN];
+            SpiceInt _handle = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            kdata_c(i, "ALL", FILLEN, TYPLEN, SRCLEN, _file, _filtyp, _srcfil, &_handle, &_found);
+            if (!_found)
+            {
+                continue;
+            }
+
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*FString(_file));
+            int64 Stamp[2] = { Stat.FileSize, Stat.ModificationTime.GetTicks() };
+
+            Hash = CityHash64WithSeed(_file, FCStringAnsi::Strlen(_file), Hash);
+            Hash = CityHash64WithSeed((const char*)Stamp, sizeof(Stamp), Hash);
+        }
+
+        // (Not remembered if kdata_c failed, so the next call tries again)
+        bFingerprinted = !failed_c();
+        PoolGeneration = Generation;
+        Fingerprint = Hash;
+        return Fingerprint;
+    }
+
+
+    uint64 FGfResultCache::Key(const TArray<uint8>& Request)
+    {
+        return CityHash64WithSeed((const char*)Request.GetData(), Request.Num(), KernelFingerprint());
+    }
+
+
+    FString FGfResultCache::EntryPath(uint64 EntryKey) const
+    {
+        return FPaths::Combine(Directory, FString::Printf(TEXT("%016llx.gfr"), EntryKey));
+    }
+
+
+    void FGfResultCache::Remember(uint64 EntryKey, const TArray<FSEphemerisTimeWindowSegment>& results)
+    {
+        if (!Entries.Contains(EntryKey))
+        {
+            Order.Add(EntryKey);
+        }
+        Entries.Add(EntryKey, results);
+
+        while (Order.Num() > MaxEntries)
+        {
+            Entries.Remove(Order[0]);
+            Order.RemoveAt(0);
+        }
+        Stats.Entries = Entries.Num();
+    }
+
+
+    bool FGfResultCache::Find(const TArray<uint8>& Request, TArray<FSEphemerisTimeWindowSegment>& results)
+    {
+        FScopeLock ScopeLock(&Lock);
+
+        if (failed_c())
+        {
+            return false;
+        }
+
+        const uint64 EntryKey = Key(Request);
+
+        if (const TArray<FSEphemerisTimeWindowSegment>* Found = Entries.Find(EntryKey))
+        {
+            results = *Found;
+            ++Stats.Hits;
+            return true;
+        }
+
+        if (!Directory.IsEmpty())
+        {
+            TArray<uint8> Bytes;
+            if (FFileHelper::LoadFileToArray(Bytes, *EntryPath(EntryKey), FILEREAD_Silent))
+            {
+                FMemoryReader Reader(Bytes);
+                TArray<FSEphemerisTimeWindowSegment> Loaded;
+                if (SerializeEntry(Reader, Loaded))
+                {
+                    Remember(EntryKey, Loaded);
+                    results = MoveTemp(Loaded);
+                    ++Stats.Hits;
+                    ++Stats.DiskHits;
+                    return true;
+                }
+                UE_LOG(LogSpice, Warning, TEXT("FGfResultCache: %s is not a cached result, or is from another version"), *EntryPath(EntryKey));
+            }
+        }
+
+        ++Stats.Misses;
+        return false;
+    }
+
+
+    void FGfResultCache::Add(const TArray<uint8>& Request, const TArray<FSEphemerisTimeWindowSegment>& results)
+    {
+        FScopeLock ScopeLock(&Lock);
+
+        if (failed_c())
+        {
+            return;
+        }
+
+        const uint64 EntryKey = Key(Request);
+        Remember(EntryKey, results);
+
+        if (!Directory.IsEmpty())
+        {
+            TArray<uint8> Bytes;
+            FMemoryWriter Writer(Bytes);
+            SerializeEntry(Writer, const_cast<TArray<FSEphemerisTimeWindowSegment>&>(results));
+
+            // Write, then move into place (another process may be reading it)
+            const FString Path = EntryPath(EntryKey);
+            const FString TempPath = FString::Printf(TEXT("%s.%u.tmp"), *Path, FPlatformProcess::GetCurrentProcessId());
+            if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+            {
+                IFileManager::Get().Delete(*TempPath, false, false, true);
+                UE_LOG(LogSpice, Warning, TEXT("FGfResultCache: could not write %s"), *Path);
+            }
+        }
+    }
+
+
+    void FGfResultCache::Invalidate()
+    {
+        FScopeLock ScopeLock(&Lock);
+
+        Entries.Empty();
+        Order.Empty();
+        Stats.Entries = 0;
+
+        if (!Directory.IsEmpty())
+        {
+            TArray<FString> Files;
+            IFileManager::Get().FindFiles(Files, *FPaths::Combine(Directory, TEXT("*.gfr")), true, false);
+            for (const FString& File : Files)
+            {
+                IFileManager::Get().Delete(*FPaths::Combine(Directory, File), false, false, true);
+            }
+        }
+    }
+
+
+    FGfResultCacheStats FGfResultCache::GetStats() const
+    {
+        FScopeLock ScopeLock(&Lock);
+        return Stats;
+    }
+}
@@ -0,0 +1,534 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGravityField.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Spherical harmonic gravity fields (EGM, GRAIL, etc).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGravityField.cpp is part of the "refined C++ API".
+//
+// Cunningham's recursion (Montenbruck & Gill, Satellite Orbits, 3.2.4) on
+// V(n,m) = (R/r)^(n+1) P(n,m)(sin lat) cos(m lon), and W with sin, scaled by
+// the same normalization N(n,m) as the coefficients, so C(n,m) V(n,m) is
+// unchanged, and nothing over- or underflows until degree ~2000.  The
+// factors between neighboring N(n,m) are folded into the recursion's
+// coefficients (Alpha, Beta, Diagonal) and the acceleration's (KPlus,
+// KMinus, KZero), once, in Build.
+//
+// The acceleration of degree n, order m needs V(n+1, m-1..m+1), so V is
+// built a column (order) at a time, to degree + 1, and order m is summed as
+// soon as column m+1 is done.  Only three columns are kept.  Each column is
+// laid out degree by lane, so the lanes' loops are independent.
+//
+// ICGEM files are in SI units (m, m^3/s^2);  SHADR files are in km.
+//------------------------------------------------------------------------------
+
+#include "SpiceGravityField.h"
+#include "SpiceUtilities.h"
+#include "SpiceMemory.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // Positions per ParallelFor task
+    constexpr int32 BatchRows = 256;
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    // Fortran style exponents (1.0D-06) too
+    double ParseNumber(FString Token)
+    {
+        Token.ReplaceCharInline(TEXT('D'), TEXT('E'));
+        Token.ReplaceCharInline(TEXT('d'), TEXT('E'));
+        return FCString::Atod(*Token);
+    }
+
+    // N(n,m):  unnormalized = N * normalized
+    double Normalization(int32 n, int32 m)
+    {
+        const double k = m == 0 ? 1. : 2.;
+        return exp(0.5 * (log(k * (2. * n + 1.)) + lgamma(n - m + 1.) - lgamma(n + m + 1.)));
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    void FGravityField::Reset()
+    {
+        GM = 0.;
+        Radius = 0.;
+        Degree = -1;
+        C.Empty(); S.Empty();
+        KPlus.Empty(); KMinus.Empty(); KZero.Empty();
+        Alpha.Empty(); Beta.Empty();
+        Diagonal.Empty();
+    }
+
+
+    SIZE_T FGravityField::GetAllocatedSize() const
+    {
+        return C.GetAllocatedSize() + S.GetAllocatedSize()
+            + KPlus.GetAllocatedSize() + KMinus.GetAllocatedSize() + KZero.GetAllocatedSize()
+            + Alpha.GetAllocatedSize() + Beta.GetAllocatedSize() + Diagonal.GetAllocatedSize();
+    }
+
+
+    void FGravityField::Build(double gm, double radius, int32 degree, TArrayView<const double> _C, TArrayView<const double> _S)
+    {
+        MAXQ_LLM_SCOPE();
+        check(degree >= 0 && radius > 0.);
+        check(_C.Num() >= NumCoefficients(degree) && _S.Num() >= NumCoefficients(degree));
+
+        Reset();
+
+        GM = gm;
+        Radius = radius;
+        Degree = degree;
+
+        const int32 Num = NumCoefficients(degree);
+        C = TArray<double>(_C.GetData(), Num);
+        S = TArray<double>(_S.GetData(), Num);
+
+        KPlus.SetNumZeroed(Num);
+        KMinus.SetNumZeroed(Num);
+        KZero.SetNumZeroed(Num);
+        for (int32 n = 0; n <= degree; ++n)
+        {
+            const double np = n;
+            for (int32 m = 0; m <= n; ++m)
+            {
+                const int32 i = Index(n, m);
+                const double mp = m;
+                if (m == 0)
+                {
+                    KPlus[i] = sqrt((2. * np + 1.) * (np + 1.) * (np + 2.) / (2. * (2. * np + 3.)));
+                }
+                else
+                {
+                    KPlus[i] = 0.5 * sqrt((2. * np + 1.) * (np + mp + 1.) * (np + mp + 2.) / (2. * np + 3.));
+                    KMinus[i] = 0.5 * sqrt((m == 1 ? 2. : 1.) * (2. * np + 1.) * (np - mp + 1.) * (np - mp + 2.) / (2. * np + 3.));
+                }
+                KZero[i] = sqrt((2. * np + 1.) * (np + mp + 1.) * (np - mp + 1.) / (2. * np + 3.));
+            }
+        }
+
+        const int32 Outer = degree + 1;
+        Alpha.SetNumZeroed(NumCoefficients(Outer));
+        Beta.SetNumZeroed(NumCoefficients(Outer));
+        Diagonal.SetNumZeroed(Outer + 1);
+        for (int32 n = 1; n <= Outer; ++n)
+        {
+            const double np = n;
+            for (int32 m = 0; m < n; ++m)
+            {
+                const double mp = m;
+                Alpha[Index(n, m)] = sqrt((2. * np + 1.) * (2. * np - 1.) / ((np - mp) * (np + mp)));
+                if (n >= m + 2)
+                {
+                    Beta[Index(n, m)] = sqrt((2. * np + 1.) * (np + mp - 1.) * (np - mp - 1.) / ((2. * np - 3.) * (np + mp) * (np - mp)));
+                }
+            }
+            Diagonal[n] = n == 1 ? sqrt(3.) : sqrt((2. * np + 1.) / (2. * np));
+        }
+    }
+
+
+    template<int32 W>
+    void FGravityField::Evaluate(const double* x, const double* y, const double* z, double* ax, double* ay, double* az, double* U, int32 MinDegree) const
+    {
+        const int32 Rows = Degree + 2;
+        const int32 ColumnSize = 2 * Rows * W;
+
+        FScratchScope Scratch;
+        double* Columns = static_cast<double*>(Scratch.Alloc(3 * ColumnSize * sizeof(double)));
+        auto V = [&](int32 m) { return Columns + (m % 3) * ColumnSize; };
+
+        double a[W], b[W], c[W], d[W];
+        double sx[W], sy[W], sz[W], su[W];
+        for (int32 l = 0; l < W; ++l)
+        {
+            const double rho = Radius / (x[l] * x[l] + y[l] * y[l] + z[l] * z[l]);
+            a[l] = x[l] * rho;
+            b[l] = y[l] * rho;
+            c[l] = z[l] * rho;
+            d[l] = Radius * rho;
+            sx[l] = 0.; sy[l] = 0.; sz[l] = 0.; su[l] = 0.;
+        }
+
+        for (int32 k = 0; k <= Degree + 1; ++k)
+        {
+            double* Vk = V(k);
+            double* Wk = Vk + Rows * W;
+
+            // Along the diagonal
+            if (k == 0)
+            {
+                for (int32 l = 0; l < W; ++l)
+                {
+                    Vk[l] = sqrt(d[l]);
+                    Wk[l] = 0.;
+                }
+            }
+            else
+            {
+                const double* Vp = V(k - 1) + (k - 1) * W;
+                const double* Wp = V(k - 1) + Rows * W + (k - 1) * W;
+                const double f = Diagonal[k];
+                for (int32 l = 0; l < W; ++l)
+                {
+                    Vk[k * W + l] = f * (a[l] * Vp[l] - b[l] * Wp[l]);
+                    Wk[k * W + l] = f * (a[l] * Wp[l] + b[l] * Vp[l]);
+                }
+            }
+
+            // ...and down the column
+            for (int32 n = k + 1; n <= Degree + 1; ++n)
+            {
+                const double al = Alpha[Index(n, k)];
+                const double be = Beta[Index(n, k)];
+                const double* V1 = Vk + (n - 1) * W; const double* W1 = Wk + (n - 1) * W;
+                const double* V2 = n >= k + 2 ? Vk + (n - 2) * W : V1;
+                const double* W2 = n >= k + 2 ? Wk + (n - 2) * W : W1;
+                for (int32 l = 0; l < W; ++l)
+                {
+                    Vk[n * W + l] = al * c[l] * V1[l] - be * d[l] * V2[l];
+                    Wk[n * W + l] = al * c[l] * W1[l] - be * d[l] * W2[l];
+                }
+            }
+
+            if (k == 0)
+            {
+                continue;
+            }
+
+            // Order m = k - 1 has its neighbors now
+            const int32 m = k - 1;
+            const double* V0 = V(m);
+            const double* W0 = V0 + Rows * W;
+            const double* VPlus = V(m + 1);
+            const double* WPlus = VPlus + Rows * W;
+            // (KMinus is zero for m = 0)
+            const double* VMinus = m > 0 ? V(m - 1) : V0;
+            const double* WMinus = VMinus + Rows * W;
+
+            for (int32 n = FMath::Max(m, MinDegree); n <= Degree; ++n)
+            {
+                const int32 i = Index(n, m);
+                const double Cnm = C[i], Snm = S[i];
+                const double kp = KPlus[i], km = KMinus[i], k0 = KZero[i];
+                const int32 j = (n + 1) * W;
+                for (int32 l = 0; l < W; ++l)
+                {
+                    sx[l] += kp * (-Cnm * VPlus[j + l] - Snm * WPlus[j + l]) + km * (Cnm * VMinus[j + l] + Snm * WMinus[j + l]);
+                    sy[l] += kp * (-Cnm * WPlus[j + l] + Snm * VPlus[j + l]) + km * (-Cnm * WMinus[j + l] + Snm * VMinus[j + l]);
+                    sz[l] += k0 * (-Cnm * V0[j + l] - Snm * W0[j + l]);
+                    su[l] += Cnm * V0[n * W + l] + Snm * W0[n * W + l];
+                }
+            }
+        }
+
+        const double scale = GM / (Radius * Radius);
+        for (int32 l = 0; l < W; ++l)
+        {
+            ax[l] = scale * sx[l];
+            ay[l] = scale * sy[l];
+            az[l] = scale * sz[l];
+            if (U)
+            {
+                U[l] = GM / Radius * su[l];
+            }
+        }
+    }
+
+
+    bool FGravityField::Acceleration(const double(&r)[3], double(&a)[3], int32 MinDegree) const
+    {
+        if (IsEmpty() || (r[0] == 0. && r[1] == 0. && r[2] == 0.))
+        {
+            a[0] = 0.; a[1] = 0.; a[2] = 0.;
+            return false;
+        }
+
+        Evaluate<1>(&r[0], &r[1], &r[2], &a[0], &a[1], &a[2], nullptr, MinDegree);
+        return true;
+    }
+
+
+    bool FGravityField::Acceleration(const FSDistanceVector& r, FSDimensionlessVector& a, int32 MinDegree) const
+    {
+        double _r[3]; r.CopyTo(_r);
+        double _a[3];
+        const bool bEvaluated = Acceleration(_r, _a, MinDegree);
+        a = FSDimensionlessVector(_a);
+        return bEvaluated;
+    }
+
+
+    bool FGravityField::Potential(const double(&r)[3], double& U, int32 MinDegree) const
+    {
+        U = 0.;
+        if (IsEmpty() || (r[0] == 0. && r[1] == 0. && r[2] == 0.))
+        {
+            return false;
+        }
+
+        double a[3];
+        Evaluate<1>(&r[0], &r[1], &r[2], &a[0], &a[1], &a[2], &U, MinDegree);
+        return true;
+    }
+
+
+    int32 FGravityField::Accelerations(const MaxQ::Math::FConstVectorBatch& r, const MaxQ::Math::FVectorBatch& a, int32 MinDegree) const
+    {
+        const int32 Num = r.Num();
+        check(r.Y.Num() >= Num && r.Z.Num() >= Num);
+        check(a.X.Num() >= Num && a.Y.Num() >= Num && a.Z.Num() >= Num);
+
+        if (IsEmpty())
+        {
+            return 0;
+        }
+
+        constexpr int32 W = Lanes;
+        const int32 NumTasks = (Num + BatchRows - 1) / BatchRows;
+
+        TArray<int32> Succeeded;
+        Succeeded.SetNumZeroed(NumTasks);
+
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 First = Task * BatchRows;
+            const int32 Last = FMath::Min(First + BatchRows, Num);
+            int32 Count = 0;
+
+            for (int32 Row = First; Row < Last; Row += W)
+            {
+                // Padding, and positions at the origin, get a harmless one
+                // on the reference sphere
+                double x[W], y[W], z[W], ax[W], ay[W], az[W];
+                bool bValid[W];
+                for (int32 l = 0; l < W; ++l)
+                {
+                    const int32 i = Row + l;
+                    bValid[l] = i < Last && (r.X[i] != 0. || r.Y[i] != 0. || r.Z[i] != 0.);
+                    x[l] = bValid[l] ? r.X[i] : Radius;
+                    y[l] = bValid[l] ? r.Y[i] : 0.;
+                    z[l] = bValid[l] ? r.Z[i] : 0.;
+                }
+
+                Evaluate<W>(x, y, z, ax, ay, az, nullptr, MinDegree);
+
+                for (int32 l = 0; l < W && Row + l < Last; ++l)
+                {
+                    const int32 i = Row + l;
+                    a.X[i] = bValid[l] ? ax[l] : 0.;
+                    a.Y[i] = bValid[l] ? ay[l] : 0.;
+                    a.Z[i] = bValid[l] ? az[l] : 0.;
+                    Count += bValid[l] ? 1 : 0;
+                }
+            }
+
+            Succeeded[Task] = Count;
+        }, NumTasks <= 1);
+
+        int32 Total = 0;
+        for (int32 Count : Succeeded)
+        {
+            Total += Count;
+        }
+        return Total;
+    }
+
+
+    bool LoadGravityField(
+        const FString& Path,
+        FGravityField& Field,
+        int32 maxDegree,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_LLM_SCOPE();
+
+        Field.Reset();
+
+        FString Contents;
+        if (!FFileHelper::LoadFileToString(Contents, *toPath(Path)))
+        {
+            return Fail(FString::Printf(TEXT("LoadGravityField: can't read %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        TArray<FString> Lines;
+        Contents.ParseIntoArrayLines(Lines);
+        Contents.Empty();
+
+        double gm = 0., radius = 0.;
+        int32 FileDegree = -1;
+        bool bNormalized = true;
+        int32 FirstData = 0;
+
+        const bool bIcgem = Lines.ContainsByPredicate([](const FString& Line) { return Line.StartsWith(TEXT("end_of_head")); });
+        TArray<FString> Tokens;
+        if (bIcgem)
+        {
+            // Keyword value pairs, to end_of_head
+            for (; FirstData < Lines.Num(); ++FirstData)
+            {
+                const FString& Line = Lines[FirstData];
+                if (Line.StartsWith(TEXT("end_of_head")))
+                {
+                    ++FirstData;
+                    break;
+                }
+
+                Line.ParseIntoArrayWS(Tokens);
+                if (Tokens.Num() < 2)
+                {
+                    continue;
+                }
+                if (Tokens[0] == TEXT("earth_gravity_constant") || Tokens[0] == TEXT("gravity_constant"))
+                {
+                    gm = ParseNumber(Tokens[1]) * 1e-9;
+                }
+                else if (Tokens[0] == TEXT("radius"))
+                {
+                    radius = ParseNumber(Tokens[1]) * 1e-3;
+                }
+                else if (Tokens[0] == TEXT("max_degree"))
+                {
+                    FileDegree = FCString::Atoi(*Tokens[1]);
+                }
+                else if (Tokens[0] == TEXT("norm"))
+                {
+                    bNormalized = Tokens[1] != TEXT("unnormalized");
+                }
+            }
+        }
+        else if (Lines.Num() > 0)
+        {
+            // SHADR:  reference radius, GM, its uncertainty, degree, order,
+            // normalization, reference longitude and latitude
+            Lines[0].Replace(TEXT(","), TEXT(" ")).ParseIntoArrayWS(Tokens);
+            if (Tokens.Num() >= 6)
+            {
+                radius = ParseNumber(Tokens[0]);
+                gm = ParseNumber(Tokens[1]);
+                FileDegree = FCString::Atoi(*Tokens[3]);
+                bNormalized = FCString::Atoi(*Tokens[5]) == 1;
+            }
+            FirstData = 1;
+        }
+
+        if (gm <= 0. || radius <= 0. || FileDegree < 0)
+        {
+            return Fail(FString::Printf(TEXT("LoadGravityField: %s doesn't have an ICGEM or SHADR header"), *Path), ResultCode, ErrorMessage);
+        }
+
+        const int32 degree = maxDegree > 0 ? FMath::Min(maxDegree, FileDegree) : FileDegree;
+        TArray<double> C, S;
+        C.SetNumZeroed(FGravityField::NumCoefficients(degree));
+        S.SetNumZeroed(FGravityField::NumCoefficients(degree));
+        C[0] = 1.;
+
+        for (int32 i = FirstData; i < Lines.Num(); ++i)
+        {
+            Lines[i].Replace(TEXT(","), TEXT(" ")).ParseIntoArrayWS(Tokens);
+
+            // ICGEM:  gfc (or gfct, with its reference epoch after) n m C S
+            // ...;  SHADR:  n m C S ...
+            int32 First = 0;
+            if (bIcgem)
+            {
+                if (Tokens.Num() == 0 || (Tokens[0] != TEXT("gfc") && Tokens[0] != TEXT("gfct")))
+                {
+                    continue;
+                }
+                First = 1;
+            }
+            if (Tokens.Num() < First + 4)
+            {
+                continue;
+            }
+
+            const int32 n = FCString::Atoi(*Tokens[First]);
+            const int32 m = FCString::Atoi(*Tokens[First + 1]);
+            if (n < 0 || m < 0 || m > n || n > degree)
+            {
+                continue;
+            }
+
+            const double scale = bNormalized ? 1. : 1. / Normalization(n, m);
+            C[FGravityField::Index(n, m)] = scale * ParseNumber(Tokens[First + 2]);
+            S[FGravityField::Index(n, m)] = scale * ParseNumber(Tokens[First + 3]);
+        }
+
+        Field.Build(gm, radius, degree, C, S);
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    FSphericalHarmonicGravityForce::FSphericalHarmonicGravityForce(
+        TSharedRef<const FGravityField, ESPMode::ThreadSafe> _Field,
+        const FSRotationMatrix& InertialToFixed,
+        const FSEphemerisTime& epoch,
+        double rotationRate
+    )
+        : Field(_Field), Epoch(epoch.AsSpiceDouble()), RotationRate(rotationRate)
+    {
+        InertialToFixed.CopyTo(Rotation);
+    }
+
+
+    bool FSphericalHarmonicGravityForce::AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const
+    {
+        // Into the body-fixed frame at et:  Rz(theta) * Rotation
+        const double theta = RotationRate * (et - Epoch);
+        const double ct = cos(theta), st = sin(theta);
+
+        double r0[3];
+        for (int32 j = 0; j < 3; ++j)
+        {
+            r0[j] = Rotation[j][0] * state[0] + Rotation[j][1] * state[1] + Rotation[j][2] * state[2];
+        }
+        const double r[3] = { ct * r0[0] + st * r0[1], -st * r0[0] + ct * r0[1], r0[2] };
+
+        double af[3];
+        if (!Field->Acceleration(r, af, 1))
+        {
+            return false;
+        }
+
+        // ...and back
+        const double a0[3] = { ct * af[0] - st * af[1], st * af[0] + ct * af[1], af[2] };
+        for (int32 j = 0; j < 3; ++j)
+        {
+            a[j] += Rotation[0][j] * a0[0] + Rotation[1][j] * a0[1] + Rotation[2][j] * a0[2];
+        }
+        return true;
+    }
+}
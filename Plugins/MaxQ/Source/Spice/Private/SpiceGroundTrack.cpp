@@ -0,0 +1,310 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGroundTrack.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Incrementally extended ground tracks for satellite catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGroundTrack.cpp is part of the "refined C++ API".
+//
+// Each object's new samples (before its track, after it, or all of them if
+// the span no longer overlaps) are laid out in one structure-of-arrays
+// buffer.  Objects are propagated into it in parallel, the whole buffer goes
+// through MaxQ::Math::Recgeo at once, and then each object's points are split
+// at ascending node crossings and joined to the ends of its track.
+//------------------------------------------------------------------------------
+
+#include "SpiceGroundTrack.h"
+#include "SpiceMathBatch.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Orbits;
+
+    // WGS-84
+    constexpr double EarthRadius = 6378.137;
+    constexpr double EarthFlattening = 1. / 298.257223563;
+
+    // An object's new samples:  [First, Last] sample indices, at Offset in
+    // the buffers
+    struct FSampleRange
+    {
+        int64 First = 0;
+        int64 Last = -1;
+        int32 Offset = 0;
+
+        int32 Num() const { return (int32)(Last - First + 1); }
+    };
+
+    // The track goes from south to north between a and b
+    bool CrossesAscendingNode(const FGroundTrackPoint& a, const FGroundTrackPoint& b)
+    {
+        return a.Latitude < 0. && b.Latitude >= 0.;
+    }
+
+    // Points, in time order, split into revolutions
+    void Split(TArray<FGroundTrackPoint>&& Points, TArray<TArray<FGroundTrackPoint>>& Chunks)
+    {
+        int32 Begin = 0;
+        for (int32 i = 1; i <= Points.Num(); ++i)
+        {
+            if (i == Points.Num() || CrossesAscendingNode(Points[i - 1], Points[i]))
+            {
+                if (Begin == 0 && i == Points.Num())
+                {
+                    Chunks.Add(MoveTemp(Points));
+                    return;
+                }
+                Chunks.Emplace(&Points[Begin], i - Begin);
+                Begin = i;
+            }
+        }
+    }
+
+    void Append(TArray<FGroundTrackRevolution>& Revolutions, TArray<TArray<FGroundTrackPoint>>&& Chunks)
+    {
+        int32 i = 0;
+        if (Revolutions.Num() > 0 && Chunks.Num() > 0 && !CrossesAscendingNode(Revolutions.Last().Points.Last(), Chunks[0][0]))
+        {
+            Revolutions.Last().Points.Append(MoveTemp(Chunks[0]));
+            ++i;
+        }
+        for (; i < Chunks.Num(); ++i)
+        {
+            const int32 Number = Revolutions.Num() > 0 ? Revolutions.Last().Number + 1 : 0;
+            FGroundTrackRevolution& Revolution = Revolutions.AddDefaulted_GetRef();
+            Revolution.Number = Number;
+            Revolution.Points = MoveTemp(Chunks[i]);
+        }
+    }
+
+    void Prepend(TArray<FGroundTrackRevolution>& Revolutions, TArray<TArray<FGroundTrackPoint>>&& Chunks)
+    {
+        int32 i = Chunks.Num() - 1;
+        if (Revolutions.Num() > 0 && i >= 0 && !CrossesAscendingNode(Chunks[i].Last(), Revolutions[0].Points[0]))
+        {
+            Revolutions[0].Points.Insert(Chunks[i], 0);
+            --i;
+        }
+        for (; i >= 0; --i)
+        {
+            const int32 Number = Revolutions.Num() > 0 ? Revolutions[0].Number - 1 : 0;
+            FGroundTrackRevolution Revolution;
+            Revolution.Number = Number;
+            Revolution.Points = MoveTemp(Chunks[i]);
+            Revolutions.Insert(MoveTemp(Revolution), 0);
+        }
+    }
+}
+
+namespace MaxQ::Orbits
+{
+    void FGroundTrackCache::Reset(TArrayView<const FSGP4Propagator> Catalog, const FGroundTrackSettings& _Settings)
+    {
+        Propagators = TArray<FSGP4Propagator>(Catalog.GetData(), Catalog.Num());
+        Settings = _Settings;
+        Tracks.Reset();
+        Tracks.SetNum(Catalog.Num());
+        SpanStart = SpanStop = 0.;
+        Computed = 0;
+    }
+
+
+    bool FGroundTrackCache::Update(const FSEphemerisTime& Start, const FSEphemerisTime& Stop, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        Computed = 0;
+
+        const double Begin = Start.AsSpiceDouble();
+        const double End = Stop.AsSpiceDouble();
+        const double Step = Settings.Step;
+        if (!(End >= Begin) || !(Step > 0.))
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("FGroundTrackCache: bad span [%f, %f] or step %f"), Begin, End, Step);
+            return false;
+        }
+
+        SpiceDouble DeltaUtc = 0.;
+        deltet_c(Begin, "ET", &DeltaUtc);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        SpanStart = Begin;
+        SpanStop = End;
+
+        const int64 First = (int64)FMath::FloorToDouble(Begin / Step);
+        const int64 Last = (int64)FMath::CeilToDouble(End / Step);
+        const int32 NumObjects = Tracks.Num();
+
+        // What each track is missing
+        TArray<FSampleRange> Before, After;
+        Before.SetNum(NumObjects);
+        After.SetNum(NumObjects);
+        int32 Total = 0;
+        for (int32 Object = 0; Object < NumObjects; ++Object)
+        {
+            FTrack& Entry = Tracks[Object];
+            if (Entry.First > Entry.Last || Last < Entry.First || First > Entry.Last)
+            {
+                Entry.Revolutions.Reset();
+                Entry.First = First;
+                Entry.Last = First - 1;
+            }
+
+            Before[Object].First = First;
+            Before[Object].Last = FMath::Min(Entry.First - 1, Last);
+            After[Object].First = FMath::Max(Entry.Last + 1, First);
+            After[Object].Last = Last;
+
+            for (FSampleRange* Range : { &Before[Object], &After[Object] })
+            {
+                Range->Last = FMath::Max(Range->Last, Range->First - 1);
+                Range->Offset = Total;
+                Total += Range->Num();
+            }
+        }
+
+        TArray<double> X, Y, Z, Lon, Lat, Alt;
+        TArray<bool> Valid;
+        for (TArray<double>* Buffer : { &X, &Y, &Z, &Lon, &Lat, &Alt })
+        {
+            Buffer->SetNumUninitialized(Total);
+        }
+        Valid.SetNumUninitialized(Total);
+
+        {
+            MAXQ_SGP4_SCOPE(Total);
+
+            ParallelFor(NumObjects, [&](int32 Object)
+            {
+                const FSGP4Propagator& Propagator = Propagators[Object];
+                for (const FSampleRange* Range : { &Before[Object], &After[Object] })
+                {
+                    for (int32 i = 0; i < Range->Num(); ++i)
+                    {
+                        const int32 j = Range->Offset + i;
+                        const double et = (Range->First + i) * Step;
+
+                        double state[6];
+                        Valid[j] = Propagator.IsValid() && Propagator.Propagate(et, state) == ESGP4Status::Ok;
+                        if (!Valid[j])
+                        {
+                            X[j] = Y[j] = 0.;
+                            Z[j] = EarthRadius;
+                            continue;
+                        }
+
+                        // TEME -> pseudo Earth fixed
+                        const double gmst = GreenwichMeanSiderealTime(et - DeltaUtc);
+                        const double c = FMath::Cos(gmst), s = FMath::Sin(gmst);
+                        X[j] = c * state[0] + s * state[1];
+                        Y[j] = -s * state[0] + c * state[1];
+                        Z[j] = state[2];
+                    }
+                }
+            });
+        }
+
+        MaxQ::Math::Recgeo(MaxQ::Math::FConstVectorBatch(X, Y, Z), EarthRadius, EarthFlattening, Lon, Lat, Alt);
+
+        ParallelFor(NumObjects, [&](int32 Object)
+        {
+            FTrack& Entry = Tracks[Object];
+
+            auto Gather = [&](const FSampleRange& Range)
+            {
+                TArray<FGroundTrackPoint> Points;
+                Points.Reserve(Range.Num());
+                for (int32 i = 0; i < Range.Num(); ++i)
+                {
+                    const int32 j = Range.Offset + i;
+                    if (Valid[j])
+                    {
+                        Points.Add({ (Range.First + i) * Step, Lat[j], Lon[j], Alt[j] });
+                    }
+                }
+
+                TArray<TArray<FGroundTrackPoint>> Chunks;
+                if (Points.Num() > 0)
+                {
+                    Split(MoveTemp(Points), Chunks);
+                }
+                return Chunks;
+            };
+
+            Prepend(Entry.Revolutions, Gather(Before[Object]));
+            Append(Entry.Revolutions, Gather(After[Object]));
+            Entry.First = FMath::Min(Entry.First, Before[Object].First);
+            Entry.Last = FMath::Max(Entry.Last, After[Object].Last);
+
+            // Drop revolutions wholly outside the span
+            int32 Drop = 0;
+            while (Drop < Entry.Revolutions.Num() - 1 && Entry.Revolutions[Drop].Points.Last().et < Begin)
+            {
+                ++Drop;
+            }
+            if (Drop > 0)
+            {
+                Entry.Revolutions.RemoveAt(0, Drop);
+                Entry.First = (int64)FMath::RoundToDouble(Entry.Revolutions[0].Points[0].et / Step);
+            }
+
+            int32 Keep = Entry.Revolutions.Num();
+            while (Keep > 1 && Entry.Revolutions[Keep - 1].Points[0].et > End)
+            {
+                --Keep;
+            }
+            if (Keep < Entry.Revolutions.Num())
+            {
+                Entry.Revolutions.SetNum(Keep);
+                Entry.Last = (int64)FMath::RoundToDouble(Entry.Revolutions.Last().Points.Last().et / Step);
+            }
+        });
+
+        Computed = Total;
+        return true;
+    }
+
+
+    void FGroundTrackCache::Track(int32 Object, TArray<FGroundTrackPoint>& Points) const
+    {
+        for (const FGroundTrackRevolution& Revolution : Tracks[Object].Revolutions)
+        {
+            for (const FGroundTrackPoint& Point : Revolution.Points)
+            {
+                if (Point.et >= SpanStart && Point.et <= SpanStop)
+                {
+                    Points.Add(Point);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,440 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceIlluminationBatch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Illumination angles over whole surface grids.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceIlluminationBatch.cpp is part of the "refined C++ API".
+//
+// The observer's position comes from spkpos for the target as seen by the
+// observer, in the body fixed frame (which SPICE evaluates at the target's
+// epoch), negated.  The source's is spkpos for the source as seen by the
+// target at that epoch, with the reception version of abcorr.
+//
+// Angles are vsep's, as atan2(|a x b|, a . b), which holds its precision
+// near 0 and pi.
+//
+// PlanetLighting does the same per target, in ref:  spkapo from the
+// observer's SSB state (spkssb, once), then spkpos for the source at the
+// target's epoch, rotated to body fixed with one pxform.  That's spkpos's
+// answer in the body fixed frame, since a frame centered on the target is
+// evaluated at the target's epoch.
+//------------------------------------------------------------------------------
+
+#include "SpiceIlluminationBatch.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+#include "SpiceMath.h"
+#include "Engine/Engine.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "Materials/MaterialParameterCollection.h"
+#include "Materials/MaterialParameterCollectionInstance.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double halfpi = 3.14159265358979323846 / 2.;
+
+    // Frame names are 32 characters at most
+    constexpr SpiceInt FrameNameLength = 33;
+
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    inline double Separation(const double(&a)[3], const double(&b)[3])
+    {
+        const double cx = a[1] * b[2] - a[2] * b[1];
+        const double cy = a[2] * b[0] - a[0] * b[2];
+        const double cz = a[0] * b[1] - a[1] * b[0];
+        return atan2(sqrt(cx * cx + cy * cy + cz * cz), a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+    }
+
+    bool ValidAngles(const MaxQ::Math::FIlluminationAngleBatch& Angles)
+    {
+        return Angles.Incidence.Num() == Angles.Num() && Angles.Emission.Num() == Angles.Num() && (Angles.Flags.Num() == 0 || Angles.Flags.Num() == Angles.Num());
+    }
+
+    // RGBA32F texels
+    void Pack(const MaxQ::Math::FIlluminationAngleBatch& Angles, float* Texels)
+    {
+        const int32 Num = Angles.Num();
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                float* Texel = Texels + 4 * i;
+                Texel[0] = Angles.Phase[i];
+                Texel[1] = Angles.Incidence[i];
+                Texel[2] = Angles.Emission[i];
+                Texel[3] = Angles.Flags.Num() > 0 ? float(Angles.Flags[i]) : 3.f;
+            }
+        });
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    bool IlluminationGeometry(
+        const FSEphemerisTime& et,
+        FIlluminationGeometry& Geometry,
+        const FString& target,
+        const FString& ilusrc,
+        const FString& fixref,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto            _target = StringCast<ANSICHAR>(*target);
+        auto            _ilusrc = StringCast<ANSICHAR>(*ilusrc);
+        auto            _fixref = StringCast<ANSICHAR>(*fixref);
+        auto            _obsrvr = StringCast<ANSICHAR>(*obsrvr);
+        ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+        SpiceDouble     _et = et.AsSpiceDouble();
+
+        // Light from the source is received at the target:  XCN+S -> CN+S
+        const bool bTransmission = _abcorr[0] == 'X';
+        ConstSpiceChar* _srccor = bTransmission ? _abcorr + 1 : _abcorr;
+
+        SpiceDouble _ptarg[3] = {}, _lt = 0.;
+        spkpos_c(_target.Get(), _et, _fixref.Get(), _abcorr, _obsrvr.Get(), _ptarg, &_lt);
+        const SpiceDouble _trgepc = bTransmission ? _et + _lt : _et - _lt;
+
+        SpiceDouble _psrc[3] = {}, _srclt = 0.;
+        spkpos_c(_ilusrc.Get(), _trgepc, _fixref.Get(), _srccor, _target.Get(), _psrc, &_srclt);
+
+        SpiceDouble _radii[3] = {};
+        SpiceInt _code = 0;
+        if (!failed_c() && ResolveBody(_target.Get(), _code) && bodfnd_c(_code, "RADII"))
+        {
+            SpiceInt _dim = 0;
+            CachedBodvcd(_code, "RADII", 3, &_dim, _radii);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        vminus_c(_ptarg, _ptarg);
+        Geometry.TargetEpoch = FSEphemerisTime(_trgepc);
+        Geometry.Observer = FSDistanceVector(_ptarg);
+        Geometry.Source = FSDistanceVector(_psrc);
+        Geometry.Radii = FSDistanceVector(_radii);
+        return true;
+    }
+
+
+    bool IlluminationAngles(
+        const FIlluminationGeometry& Geometry,
+        const FConstVectorBatch& Points,
+        const FIlluminationAngleBatch& Angles,
+        const FConstVectorBatch* Normals
+    )
+    {
+        const int32 Num = Points.Num();
+        if (Points.Y.Num() != Num || Points.Z.Num() != Num || Angles.Num() != Num || !ValidAngles(Angles))
+        {
+            return false;
+        }
+        if (Normals && (Normals->X.Num() != Num || Normals->Y.Num() != Num || Normals->Z.Num() != Num))
+        {
+            return false;
+        }
+
+        double Radii[3];
+        Geometry.Radii.CopyTo(Radii);
+        if (!Normals && !(Radii[0] > 0. && Radii[1] > 0. && Radii[2] > 0.))
+        {
+            return false;
+        }
+        // surfnm's normal:  the gradient, (x/a^2, y/b^2, z/c^2)
+        const double InvSquared[3] = { 1. / (Radii[0] * Radii[0]), 1. / (Radii[1] * Radii[1]), 1. / (Radii[2] * Radii[2]) };
+
+        double Observer[3], Source[3];
+        Geometry.Observer.CopyTo(Observer);
+        Geometry.Source.CopyTo(Source);
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const double p[3] = { Points.X[i], Points.Y[i], Points.Z[i] };
+                const double n[3] = {
+                    Normals ? Normals->X[i] : p[0] * InvSquared[0],
+                    Normals ? Normals->Y[i] : p[1] * InvSquared[1],
+                    Normals ? Normals->Z[i] : p[2] * InvSquared[2]
+                };
+                const double s[3] = { Source[0] - p[0], Source[1] - p[1], Source[2] - p[2] };
+                const double o[3] = { Observer[0] - p[0], Observer[1] - p[1], Observer[2] - p[2] };
+
+                const double Incidence = Separation(n, s);
+                const double Emission = Separation(n, o);
+                Angles.Phase[i] = float(Separation(s, o));
+                Angles.Incidence[i] = float(Incidence);
+                Angles.Emission[i] = float(Emission);
+
+                // illumf's flags
+                if (Angles.Flags.Num() > 0)
+                {
+                    Angles.Flags[i] = uint8((Emission < halfpi ? FIlluminationAngleBatch::Visible : 0) | (Incidence < halfpi ? FIlluminationAngleBatch::Lit : 0));
+                }
+            }
+        }, Num <= ChunkSize);
+
+        return true;
+    }
+
+
+    UTexture2D* CreateIlluminationTexture(int32 Width, int32 Height, const FIlluminationAngleBatch& Angles)
+    {
+        check(IsInGameThread());
+
+        if (Width <= 0 || Height <= 0 || Angles.Num() != Width * Height || !ValidAngles(Angles))
+        {
+            return nullptr;
+        }
+
+        UTexture2D* Texture = UTexture2D::CreateTransient(Width, Height, PF_A32B32G32R32F);
+        if (!Texture)
+        {
+            return nullptr;
+        }
+        Texture->SRGB = false;
+        Texture->CompressionSettings = TC_HDR;
+        Texture->Filter = TF_Bilinear;
+        Texture->AddressX = TA_Wrap;
+        Texture->AddressY = TA_Clamp;
+
+        FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+        float* Texels = static_cast<float*>(Mip.BulkData.Lock(LOCK_READ_WRITE));
+        Pack(Angles, Texels);
+        Mip.BulkData.Unlock();
+
+        Texture->UpdateResource();
+        return Texture;
+    }
+
+
+    bool UpdateIlluminationTexture(UTexture2D* Texture, const FIlluminationAngleBatch& Angles)
+    {
+        check(IsInGameThread());
+
+        if (!Texture || Texture->GetPixelFormat() != PF_A32B32G32R32F || Angles.Num() != Texture->GetSizeX() * Texture->GetSizeY() || !ValidAngles(Angles))
+        {
+            return false;
+        }
+
+        const int32 Width = Texture->GetSizeX();
+        const int32 Height = Texture->GetSizeY();
+
+        // Both are freed once the render thread has uploaded them
+        float* Texels = new float[4 * SIZE_T(Width) * Height];
+        Pack(Angles, Texels);
+        FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, 0, 0, 0, Width, Height);
+
+        Texture->UpdateTextureRegions(0, 1, Region, 4 * sizeof(float) * Width, 4 * sizeof(float), (uint8*)Texels,
+            [](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+            {
+                delete[] (float*)SrcData;
+                delete Regions;
+            });
+
+        return true;
+    }
+
+
+    bool PlanetLighting(
+        const FSEphemerisTime& et,
+        TArrayView<const FString> Targets,
+        TArray<FPlanetLighting>& Lighting,
+        const FString& ilusrc,
+        const FString& ref,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Lighting.Reset();
+
+        auto            _ilusrc = StringCast<ANSICHAR>(*ilusrc);
+        auto            _ref = StringCast<ANSICHAR>(*ref);
+        auto            _obsrvr = StringCast<ANSICHAR>(*obsrvr);
+        ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+        SpiceDouble     _et = et.AsSpiceDouble();
+
+        const bool bTransmission = _abcorr[0] == 'X';
+        ConstSpiceChar* _srccor = bTransmission ? _abcorr + 1 : _abcorr;
+
+        if (!IsInertialFrame(_ref.Get()) && !failed_c())
+        {
+            setmsg_c("PlanetLighting needs an inertial reference frame;  # isn't one.");
+            errch_c("#", _ref.Get());
+            sigerr_c("SPICE(BADFRAMECLASS)");
+        }
+
+        // Observer state relative to the SSB, once
+        SpiceInt _obsid = 0;
+        SpiceDouble _sobs[6] = {};
+        if (!failed_c() && ResolveBody(_obsrvr.Get(), _obsid))
+        {
+            spkssb_c(_obsid, _et, _ref.Get(), _sobs);
+        }
+
+        Lighting.Reserve(Targets.Num());
+        for (int32 i = 0; i < Targets.Num() && !failed_c(); ++i)
+        {
+            auto _target = StringCast<ANSICHAR>(*Targets[i]);
+            SpiceInt _targid = 0;
+            if (!ResolveBody(_target.Get(), _targid))
+            {
+                break;
+            }
+
+            SpiceInt _frcode = 0;
+            SpiceChar _frname[FrameNameLength];
+            SpiceBoolean _found = SPICEFALSE;
+            cidfrm_c(_targid, sizeof(_frname), &_frcode, _frname, &_found);
+            if (!_found && !failed_c())
+            {
+                setmsg_c("No body fixed frame is associated with #.");
+                errch_c("#", _target.Get());
+                sigerr_c("SPICE(NOFRAME)");
+            }
+
+            SpiceDouble _ptarg[3] = {}, _lt = 0.;
+            {
+                MAXQ_SPK_LOOKUP_SCOPE();
+                spkapo_c(_targid, _et, _ref.Get(), _sobs, _abcorr, _ptarg, &_lt);
+            }
+            const SpiceDouble _trgepc = bTransmission ? _et + _lt : _et - _lt;
+
+            SpiceDouble _psrc[3] = {}, _srclt = 0.;
+            {
+                MAXQ_SPK_LOOKUP_SCOPE();
+                spkpos_c(_ilusrc.Get(), _trgepc, _ref.Get(), _srccor, _target.Get(), _psrc, &_srclt);
+            }
+
+            SpiceDouble _rotate[3][3];
+            pxform_c(_frname, _ref.Get(), _trgepc, _rotate);
+
+            SpiceDouble _radii[3] = {};
+            if (!failed_c() && bodfnd_c(_targid, "RADII"))
+            {
+                SpiceInt _dim = 0;
+                CachedBodvcd(_targid, "RADII", 3, &_dim, _radii);
+            }
+
+            if (failed_c())
+            {
+                break;
+            }
+
+            SpiceDouble _obspos[3], _srcpos[3];
+            vminus_c(_ptarg, _ptarg);
+            mtxv_c(_rotate, _ptarg, _obspos);
+            mtxv_c(_rotate, _psrc, _srcpos);
+            vhat_c(_psrc, _psrc);
+
+            FPlanetLighting& Entry = Lighting.AddDefaulted_GetRef();
+            Entry.TargetEpoch = FSEphemerisTime(_trgepc);
+            Entry.Observer = FSDistanceVector(_obspos);
+            Entry.Source = FSDistanceVector(_srcpos);
+            Entry.SourceDirection = FSDimensionlessVector(_psrc);
+            Entry.BodyToRef = FSRotationMatrix(_rotate);
+
+            Entry.bHasRadii = _radii[0] > 0. && _radii[1] > 0. && _radii[2] > 0.;
+            if (Entry.bHasRadii)
+            {
+                double X[2] = { _obspos[0], _srcpos[0] }, Y[2] = { _obspos[1], _srcpos[1] }, Z[2] = { _obspos[2], _srcpos[2] };
+                double NX[2], NY[2], NZ[2], Alt[2];
+                Nearpt(FConstVectorBatch(X, Y, Z), _radii[0], _radii[1], _radii[2], FVectorBatch{ NX, NY, NZ }, Alt);
+                Entry.SubObserver = FSDistanceVector(NX[0], NY[0], NZ[0]);
+                Entry.SubSource = FSDistanceVector(NX[1], NY[1], NZ[1]);
+            }
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        return true;
+    }
+
+
+    int32 SetPlanetLightingParameters(
+        const UObject* WorldContextObject,
+        UMaterialParameterCollection* Collection,
+        TArrayView<const FName> Prefixes,
+        TArrayView<const FPlanetLighting> Lighting
+    )
+    {
+        check(IsInGameThread());
+
+        UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr;
+        UMaterialParameterCollectionInstance* Instance = World && Collection ? World->GetParameterCollectionInstance(Collection) : nullptr;
+        if (!Instance)
+        {
+            return 0;
+        }
+
+        // Planetocentric (lon, lat) of the point, and the distance to it
+        auto PointParameter = [](const FSDistanceVector& Point, const FSDistanceVector& From)
+        {
+            double p[3], f[3];
+            Point.CopyTo(p);
+            From.CopyTo(f);
+            const double lon = atan2(p[1], p[0]);
+            const double lat = atan2(p[2], sqrt(p[0] * p[0] + p[1] * p[1]));
+            const double alt = sqrt((f[0] - p[0]) * (f[0] - p[0]) + (f[1] - p[1]) * (f[1] - p[1]) + (f[2] - p[2]) * (f[2] - p[2]));
+            return FLinearColor(float(lon), float(lat), float(alt), 0.f);
+        };
+
+        int32 NumSet = 0;
+        const int32 Num = FMath::Min(Prefixes.Num(), Lighting.Num());
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const FString Prefix = Prefixes[i].ToString();
+            const FPlanetLighting& Entry = Lighting[i];
+
+            const FVector Direction = MaxQ::Math::Swizzle(Entry.SourceDirection);
+            NumSet += Instance->SetVectorParameterValue(FName(Prefix + TEXT("SourceDirection")), FLinearColor(float(Direction.X), float(Direction.Y), float(Direction.Z), 0.f)) ? 1 : 0;
+
+            if (Entry.bHasRadii)
+            {
+                NumSet += Instance->SetVectorParameterValue(FName(Prefix + TEXT("SubSource")), PointParameter(Entry.SubSource, Entry.Source)) ? 1 : 0;
+                NumSet += Instance->SetVectorParameterValue(FName(Prefix + TEXT("SubObserver")), PointParameter(Entry.SubObserver, Entry.Observer)) ? 1 : 0;
+            }
+        }
+
+        return NumSet;
+    }
+}
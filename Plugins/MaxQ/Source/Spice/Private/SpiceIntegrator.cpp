@@ -0,0 +1,536 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceIntegrator.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Numerical orbit propagation of many objects at once, with
+// pluggable force models.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceIntegrator.cpp is part of the "refined C++ API".
+//
+// The integrator is DOPRI5 (Hairer, Norsett & Wanner, Solving Ordinary
+// Differential Equations I, II.5):  seven stages with the last reused as the
+// next step's first, the 4th order embedded solution for the error
+// estimate, and its continuous extension for dense output.
+//
+// Zonal harmonics:  with u = r.pole / |r|, each Jn adds
+//    (mu / r^2) Jn (R/r)^n [((n+1) Pn(u) + u Pn'(u)) r/|r| - Pn'(u) pole]
+// (the gradient of -mu/r Jn (R/r)^n Pn(u)), with Pn and Pn' by recurrence.
+//------------------------------------------------------------------------------
+
+#include "SpiceIntegrator.h"
+#include "SpiceEphemerisCache.h"
+#include "SpiceSpkWriter.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Dormand-Prince 5(4)
+    constexpr double c2 = 1. / 5., c3 = 3. / 10., c4 = 4. / 5., c5 = 8. / 9.;
+    constexpr double a21 = 1. / 5.;
+    constexpr double a31 = 3. / 40., a32 = 9. / 40.;
+    constexpr double a41 = 44. / 45., a42 = -56. / 15., a43 = 32. / 9.;
+    constexpr double a51 = 19372. / 6561., a52 = -25360. / 2187., a53 = 64448. / 6561., a54 = -212. / 729.;
+    constexpr double a61 = 9017. / 3168., a62 = -355. / 33., a63 = 46732. / 5247., a64 = 49. / 176., a65 = -5103. / 18656.;
+    constexpr double a71 = 35. / 384., a73 = 500. / 1113., a74 = 125. / 192., a75 = -2187. / 6784., a76 = 11. / 84.;
+    // 5th order less 4th order
+    constexpr double e1 = 71. / 57600., e3 = -71. / 16695., e4 = 71. / 1920., e5 = -17253. / 339200., e6 = 22. / 525., e7 = -1. / 40.;
+    // Continuous extension
+    constexpr double d1 = -12715105075. / 11282082432., d3 = 87487479700. / 32700410799., d4 = -10690763975. / 1880347072.;
+    constexpr double d5 = 701980252875. / 199316789632., d6 = -1453857185. / 822651844., d7 = 69997945. / 29380423.;
+
+    constexpr int32 NumCoefficients = 5 * 6;
+
+    // Solar radiation pressure at 1 AU (N/m^2), and the AU (km)
+    constexpr double SolarPressure = 4.56e-6;
+    constexpr double AU = 149597870.7;
+
+    inline double Dot(const double* a, const double* b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    // One coefficient per object, or one for all of them
+    inline bool Coefficient(const TArray<double>& Coefficients, int32 Object, double& Value)
+    {
+        if (Coefficients.Num() == 1)
+        {
+            Value = Coefficients[0];
+            return true;
+        }
+        if (Coefficients.IsValidIndex(Object))
+        {
+            Value = Coefficients[Object];
+            return true;
+        }
+        return false;
+    }
+}
+
+namespace MaxQ::Orbits
+{
+    FThirdBodyForce::FThirdBodyForce(TSharedRef<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> _Cache, const FString& body, double gm)
+        : Cache(_Cache), BodyIndex(_Cache->FindBody(body)), GM(gm)
+    {
+    }
+
+
+    bool FThirdBodyForce::AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const
+    {
+        double s[3];
+        if (BodyIndex == INDEX_NONE || !Cache->Evaluate(BodyIndex, et, s))
+        {
+            return false;
+        }
+
+        const double d[3] = { s[0] - state[0], s[1] - state[1], s[2] - state[2] };
+        const double d2 = Dot(d, d), s2 = Dot(s, s);
+        const double dk = GM / (d2 * sqrt(d2));
+        const double sk = GM / (s2 * sqrt(s2));
+
+        for (int32 j = 0; j < 3; ++j)
+        {
+            a[j] += dk * d[j] - sk * s[j];
+        }
+        return true;
+    }
+
+
+    FZonalGravityForce::FZonalGravityForce(double gm, double radius, TArrayView<const double> _J, const FSDimensionlessVector& pole)
+        : GM(gm), Radius(radius), J(_J)
+    {
+        pole.CopyTo(Pole);
+        const double m = sqrt(Dot(Pole, Pole));
+        if (m > 0.)
+        {
+            Pole[0] /= m; Pole[1] /= m; Pole[2] /= m;
+        }
+    }
+
+
+    bool FZonalGravityForce::AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const
+    {
+        const double r = sqrt(Dot(state, state));
+        if (r == 0.)
+        {
+            return false;
+        }
+
+        const double rhat[3] = { state[0] / r, state[1] / r, state[2] / r };
+        const double u = Dot(rhat, Pole);
+
+        // P(n-1), P(n), and their derivatives, from n = 1
+        double Pm = 1., P = u, dPm = 0., dP = 1.;
+        double ratio = Radius / r;
+        double scale = 1.;
+
+        double radial = 0., polar = 0.;
+        for (int32 n = 2; n < J.Num() + 2; ++n)
+        {
+            const double Pn = ((2 * n - 1) * u * P - (n - 1) * Pm) / n;
+            const double dPn = dPm + (2 * n - 1) * P;
+            Pm = P; P = Pn;
+            dPm = dP; dP = dPn;
+
+            scale = n == 2 ? ratio * ratio : scale * ratio;
+            const double Jn = J[n - 2] * scale;
+            radial += Jn * ((n + 1) * P + u * dP);
+            polar += Jn * dP;
+        }
+
+        const double k = GM / (r * r);
+        for (int32 j = 0; j < 3; ++j)
+        {
+            a[j] += k * (radial * rhat[j] - polar * Pole[j]);
+        }
+        return true;
+    }
+
+
+    FExponentialDragForce::FExponentialDragForce(const FAtmosphere& _Atmosphere, TArrayView<const double> BallisticCoefficients)
+        : Atmosphere(_Atmosphere), Coefficients(BallisticCoefficients)
+    {
+    }
+
+
+    bool FExponentialDragForce::AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const
+    {
+        double B;
+        if (!Coefficient(Coefficients, Object, B))
+        {
+            return false;
+        }
+
+        const double altitude = sqrt(Dot(state, state)) - Atmosphere.Radius;
+        if (altitude > Atmosphere.MaxAltitude)
+        {
+            return true;
+        }
+        const double rho = Atmosphere.ReferenceDensity * exp(-(altitude - Atmosphere.ReferenceAltitude) / Atmosphere.ScaleHeight);
+
+        // Relative to the atmosphere:  v - w x r
+        double w[3]; Atmosphere.AngularVelocity.CopyTo(w);
+        const double v[3] = {
+            state[3] - (w[1] * state[2] - w[2] * state[1]),
+            state[4] - (w[2] * state[0] - w[0] * state[2]),
+            state[5] - (w[0] * state[1] - w[1] * state[0])
+        };
+        const double speed = sqrt(Dot(v, v));
+
+        // B rho is per meter;  per km is 1000 times that
+        const double k = -.5 * B * rho * 1000. * speed;
+        for (int32 j = 0; j < 3; ++j)
+        {
+            a[j] += k * v[j];
+        }
+        return true;
+    }
+
+
+    FSolarRadiationPressureForce::FSolarRadiationPressureForce(TSharedRef<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> _Cache, const FString& sun, TArrayView<const double> ReflectivityCoefficients, double shadowRadius)
+        : Cache(_Cache), SunIndex(_Cache->FindBody(sun)), Coefficients(ReflectivityCoefficients), ShadowRadius(shadowRadius)
+    {
+    }
+
+
+    bool FSolarRadiationPressureForce::AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const
+    {
+        double CrAm, s[3];
+        if (SunIndex == INDEX_NONE || !Coefficient(Coefficients, Object, CrAm) || !Cache->Evaluate(SunIndex, et, s))
+        {
+            return false;
+        }
+
+        // Behind the body, within its radius of the Sun line
+        if (ShadowRadius > 0.)
+        {
+            const double sm = sqrt(Dot(s, s));
+            const double along = Dot(state, s) / sm;
+            const double across[3] = { state[0] - along * s[0] / sm, state[1] - along * s[1] / sm, state[2] - along * s[2] / sm };
+            if (along < 0. && Dot(across, across) < ShadowRadius * ShadowRadius)
+            {
+                return true;
+            }
+        }
+
+        // Away from the Sun.  N/m^2 * m^2/kg is m/s^2.
+        const double d[3] = { state[0] - s[0], state[1] - s[1], state[2] - s[2] };
+        const double dm = sqrt(Dot(d, d));
+        const double k = SolarPressure * CrAm * (AU / dm) * (AU / dm) / 1000. / dm;
+        for (int32 j = 0; j < 3; ++j)
+        {
+            a[j] += k * d[j];
+        }
+        return true;
+    }
+
+
+    double FTrajectory::GetStart() const
+    {
+        return Steps.Num() ? FMath::Min(Steps[0].Start, Steps[0].Start + Steps[0].Length) : 0.;
+    }
+
+
+    double FTrajectory::GetStop() const
+    {
+        return Steps.Num() ? FMath::Max(Steps.Last().Start, Steps.Last().Start + Steps.Last().Length) : 0.;
+    }
+
+
+    bool FTrajectory::Evaluate(double et, double(&state)[6]) const
+    {
+        if (Steps.Num() == 0 || et < GetStart() || et > GetStop())
+        {
+            return false;
+        }
+
+        // The last step starting at or before et
+        const int32 i = FMath::Max(0, Algo::UpperBoundBy(Steps, et, [](const FStep& Step) { return FMath::Min(Step.Start, Step.Start + Step.Length); }) - 1);
+        const FStep& Step = Steps[i];
+        const double* r = &Coefficients[i * NumCoefficients];
+
+        // (contd5)
+        const double theta = Step.Length != 0. ? (et - Step.Start) / Step.Length : 0.;
+        const double theta1 = 1. - theta;
+        for (int32 j = 0; j < 6; ++j)
+        {
+            state[j] = r[j] + theta * (r[6 + j] + theta1 * (r[12 + j] + theta * (r[18 + j] + theta1 * r[24 + j])));
+        }
+        return true;
+    }
+
+
+    bool FTrajectory::State(const FSEphemerisTime& et, FSStateVector& state) const
+    {
+        double s[6];
+        if (!Evaluate(et.seconds, s))
+        {
+            return false;
+        }
+        state = FSStateVector(s);
+        return true;
+    }
+
+
+    bool FTrajectory::Write(MaxQ::Ephemeris::FSpkSegmentWriter& Writer, double step, ES_ResultCode* ResultCode, FString* ErrorMessage) const
+    {
+        if (Steps.Num() == 0 || step <= 0.)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = Steps.Num() ? TEXT("Sample step must be positive") : TEXT("Trajectory is empty");
+            return false;
+        }
+
+        constexpr int32 Chunk = 1024;
+        TArray<double> ets;
+        TArray<FSStateVector> states;
+        ets.Reserve(Chunk);
+        states.Reserve(Chunk);
+
+        const double start = GetStart(), stop = GetStop();
+        for (int64 i = 0; ; ++i)
+        {
+            const double et = FMath::Min(start + i * step, stop);
+
+            double s[6];
+            Evaluate(et, s);
+            ets.Add(et);
+            states.Add(FSStateVector(s));
+
+            const bool bLast = et >= stop;
+            if (ets.Num() == Chunk || bLast)
+            {
+                if (!Writer.Add(ets, states, ResultCode, ErrorMessage))
+                {
+                    return false;
+                }
+                ets.Reset();
+                states.Reset();
+            }
+
+            if (bLast)
+            {
+                return true;
+            }
+        }
+    }
+
+
+    FNumericalPropagator::FNumericalPropagator(double gm, const FIntegratorSettings& _Settings)
+        : GM(gm), Settings(_Settings)
+    {
+    }
+
+
+    void FNumericalPropagator::AddForce(TSharedRef<const IForceModel, ESPMode::ThreadSafe> Force)
+    {
+        Forces.Add(Force);
+    }
+
+
+    bool FNumericalPropagator::Derivative(int32 Object, double et, const double(&y)[6], double(&dy)[6]) const
+    {
+        const double r2 = Dot(y, y);
+        const double k = -GM / (r2 * sqrt(r2));
+
+        double a[3] = { k * y[0], k * y[1], k * y[2] };
+        for (const auto& Force : Forces)
+        {
+            if (!Force->AddAcceleration(Object, et, y, a))
+            {
+                return false;
+            }
+        }
+
+        dy[0] = y[3]; dy[1] = y[4]; dy[2] = y[5];
+        dy[3] = a[0]; dy[4] = a[1]; dy[5] = a[2];
+        return FMath::IsFinite(a[0]) && FMath::IsFinite(a[1]) && FMath::IsFinite(a[2]);
+    }
+
+
+    bool FNumericalPropagator::Integrate(int32 Object, double et0, const double(&y0)[6], double et1, double(&y1)[6], FTrajectory* Trajectory) const
+    {
+        double y[6], k1[6], k2[6], k3[6], k4[6], k5[6], k6[6], k7[6], yt[6], ynew[6];
+        FMemory::Memcpy(y, y0);
+
+        if (Trajectory)
+        {
+            Trajectory->Reset();
+        }
+
+        if (et1 == et0)
+        {
+            FMemory::Memcpy(y1, y0);
+            return true;
+        }
+
+        const double Direction = et1 > et0 ? 1. : -1.;
+        double t = et0;
+        double h = Direction * FMath::Min(Settings.InitialStep, FMath::Abs(et1 - et0));
+
+        if (!Derivative(Object, t, y, k1))
+        {
+            return false;
+        }
+
+        auto Stage = [&](double dt, double(&k)[6]) { return Derivative(Object, t + dt, yt, k); };
+
+        for (int32 Step = 0; Step < Settings.MaxSteps; ++Step)
+        {
+            // Land on et1 exactly
+            bool bLast = false;
+            if (Direction * (t + h - et1) >= 0.)
+            {
+                h = et1 - t;
+                bLast = true;
+            }
+
+            bool bOk = true;
+            for (int32 j = 0; j < 6; ++j) yt[j] = y[j] + h * a21 * k1[j];
+            bOk = bOk && Stage(c2 * h, k2);
+            for (int32 j = 0; j < 6; ++j) yt[j] = y[j] + h * (a31 * k1[j] + a32 * k2[j]);
+            bOk = bOk && Stage(c3 * h, k3);
+            for (int32 j = 0; j < 6; ++j) yt[j] = y[j] + h * (a41 * k1[j] + a42 * k2[j] + a43 * k3[j]);
+            bOk = bOk && Stage(c4 * h, k4);
+            for (int32 j = 0; j < 6; ++j) yt[j] = y[j] + h * (a51 * k1[j] + a52 * k2[j] + a53 * k3[j] + a54 * k4[j]);
+            bOk = bOk && Stage(c5 * h, k5);
+            for (int32 j = 0; j < 6; ++j) yt[j] = y[j] + h * (a61 * k1[j] + a62 * k2[j] + a63 * k3[j] + a64 * k4[j] + a65 * k5[j]);
+            bOk = bOk && Stage(h, k6);
+            for (int32 j = 0; j < 6; ++j) ynew[j] = y[j] + h * (a71 * k1[j] + a73 * k3[j] + a74 * k4[j] + a75 * k5[j] + a76 * k6[j]);
+            FMemory::Memcpy(yt, ynew);
+            bOk = bOk && Stage(h, k7);
+            if (!bOk)
+            {
+                return false;
+            }
+
+            double err = 0.;
+            for (int32 j = 0; j < 6; ++j)
+            {
+                const double e = h * (e1 * k1[j] + e3 * k3[j] + e4 * k4[j] + e5 * k5[j] + e6 * k6[j] + e7 * k7[j]);
+                const double sk = Settings.AbsoluteTolerance + Settings.RelativeTolerance * FMath::Max(FMath::Abs(y[j]), FMath::Abs(ynew[j]));
+                err += (e / sk) * (e / sk);
+            }
+            err = sqrt(err / 6.);
+
+            if (err <= 1.)
+            {
+                if (Trajectory)
+                {
+                    Trajectory->Steps.Add(FTrajectory::FStep{ t, h });
+                    double* r = &Trajectory->Coefficients[Trajectory->Coefficients.AddUninitialized(NumCoefficients)];
+                    for (int32 j = 0; j < 6; ++j)
+                    {
+                        const double ydiff = ynew[j] - y[j];
+                        const double bspl = h * k1[j] - ydiff;
+                        r[j] = y[j];
+                        r[6 + j] = ydiff;
+                        r[12 + j] = bspl;
+                        r[18 + j] = ydiff - h * k7[j] - bspl;
+                        r[24 + j] = h * (d1 * k1[j] + d3 * k3[j] + d4 * k4[j] + d5 * k5[j] + d6 * k6[j] + d7 * k7[j]);
+                    }
+                }
+
+                FMemory::Memcpy(y, ynew);
+                FMemory::Memcpy(k1, k7);
+                t = bLast ? et1 : t + h;
+
+                if (bLast)
+                {
+                    FMemory::Memcpy(y1, y);
+                    return true;
+                }
+            }
+
+            // (err^-1/5, safety factor .9, limited to [.2, 5], and no growth
+            // right after a rejection)
+            double factor = err > 0. ? .9 * pow(err, -.2) : 5.;
+            factor = FMath::Clamp(factor, .2, err <= 1. ? 5. : 1.);
+            h = Direction * FMath::Min(FMath::Abs(h * factor), Settings.MaxStep);
+
+            if (FMath::Abs(h) < Settings.MinStep)
+            {
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+
+    int32 FNumericalPropagator::Propagate(
+        TArrayView<const FSStateVector> States,
+        const FSEphemerisTime& et0,
+        const FSEphemerisTime& et1,
+        TArrayView<FSStateVector> OutStates,
+        TArrayView<FTrajectory> OutTrajectories,
+        TArrayView<bool> valid
+    ) const
+    {
+        const int32 Num = States.Num();
+        check(OutStates.Num() == 0 || OutStates.Num() >= Num);
+        check(OutTrajectories.Num() == 0 || OutTrajectories.Num() >= Num);
+        check(valid.Num() == 0 || valid.Num() >= Num);
+
+        TArray<bool> Succeeded;
+        Succeeded.SetNumZeroed(Num);
+
+        // Objects take wildly different numbers of steps;  one per task
+        ParallelFor(Num, [&](int32 i)
+        {
+            double y0[6], y1[6];
+            States[i].CopyTo(y0);
+
+            FTrajectory* Trajectory = OutTrajectories.Num() ? &OutTrajectories[i] : nullptr;
+            const bool bValid = GM > 0. && Integrate(i, et0.seconds, y0, et1.seconds, y1, Trajectory);
+
+            if (!bValid)
+            {
+                FMemory::Memzero(y1);
+                if (Trajectory)
+                {
+                    Trajectory->Reset();
+                }
+            }
+            else if (Trajectory && et1.seconds < et0.seconds)
+            {
+                // Increasing time, for lookups
+                const int32 NumSteps = Trajectory->Steps.Num();
+                for (int32 Step = 0; Step < NumSteps / 2; ++Step)
+                {
+                    const int32 Other = NumSteps - 1 - Step;
+                    Trajectory->Steps.Swap(Step, Other);
+                    for (int32 c = 0; c < NumCoefficients; ++c)
+                    {
+                        Trajectory->Coefficients.Swap(Step * NumCoefficients + c, Other * NumCoefficients + c);
+                    }
+                }
+            }
+
+            if (OutStates.Num()) OutStates[i] = FSStateVector(y1);
+            if (valid.Num()) valid[i] = bValid;
+            Succeeded[i] = bValid;
+        });
+
+        int32 Total = 0;
+        for (bool bSucceeded : Succeeded)
+        {
+            Total += bSucceeded;
+        }
+        return Total;
+    }
+}
@@ -0,0 +1,244 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceInterpolation.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Lagrange and Hermite interpolation of many channels at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceInterpolation.cpp is part of the "refined C++ API".
+//
+// Divided differences are computed in place, one level at a time, from the
+// end of the table back, so each entry still holds the previous level's
+// value when it's needed.  For Hermite data the nodes are doubled
+// (z0 z0 z1 z1 ...), and a first difference over a repeated node is the
+// given derivative.
+//
+// Evaluation is Horner's rule on the Newton form, carrying the derivative:
+//    dp = dp (x - z_k) + p,   p = p (x - z_k) + c_k
+//------------------------------------------------------------------------------
+
+#include "SpiceInterpolation.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Points per ParallelFor task
+    constexpr int32 ChunkSize = 1024;
+}
+
+namespace MaxQ::Math
+{
+    bool FPolynomialInterpolator::Allocate(TArrayView<const double> xvals, int32 NumNodes, int32 numChannels)
+    {
+        Reset();
+
+        if (xvals.Num() == 0 || numChannels <= 0)
+        {
+            return false;
+        }
+
+        for (int32 i = 0; i < xvals.Num(); ++i)
+        {
+            for (int32 j = 0; j < i; ++j)
+            {
+                if (xvals[i] == xvals[j])
+                {
+                    return false;
+                }
+            }
+        }
+
+        Nodes.SetNumUninitialized(NumNodes);
+        Coefficients.SetNumUninitialized(NumNodes * numChannels);
+        Channels = numChannels;
+        return true;
+    }
+
+
+    bool FPolynomialInterpolator::BuildLagrange(TArrayView<const double> xvals, TArrayView<const double> yvals, int32 numChannels)
+    {
+        const int32 n = xvals.Num();
+        if (yvals.Num() != n * numChannels || !Allocate(xvals, n, numChannels))
+        {
+            Reset();
+            return false;
+        }
+
+        for (int32 i = 0; i < n; ++i)
+        {
+            Nodes[i] = xvals[i];
+        }
+
+        TArray<double> d;
+        d.SetNumUninitialized(n);
+        for (int32 c = 0; c < Channels; ++c)
+        {
+            for (int32 i = 0; i < n; ++i)
+            {
+                d[i] = yvals[c * n + i];
+            }
+
+            for (int32 k = 1; k < n; ++k)
+            {
+                for (int32 j = n - 1; j >= k; --j)
+                {
+                    d[j] = (d[j] - d[j - 1]) / (Nodes[j] - Nodes[j - k]);
+                }
+            }
+
+            for (int32 k = 0; k < n; ++k)
+            {
+                Coefficients[k * Channels + c] = d[k];
+            }
+        }
+        return true;
+    }
+
+
+    bool FPolynomialInterpolator::BuildHermite(TArrayView<const double> xvals, TArrayView<const double> yvals, int32 numChannels)
+    {
+        const int32 n = xvals.Num();
+        const int32 m = 2 * n;
+        if (yvals.Num() != m * numChannels || !Allocate(xvals, m, numChannels))
+        {
+            Reset();
+            return false;
+        }
+
+        for (int32 i = 0; i < n; ++i)
+        {
+            Nodes[2 * i] = Nodes[2 * i + 1] = xvals[i];
+        }
+
+        TArray<double> d;
+        d.SetNumUninitialized(m);
+        for (int32 c = 0; c < Channels; ++c)
+        {
+            const double* f = &yvals[c * m];
+            for (int32 i = 0; i < n; ++i)
+            {
+                d[2 * i] = d[2 * i + 1] = f[2 * i];
+            }
+
+            for (int32 k = 1; k < m; ++k)
+            {
+                for (int32 j = m - 1; j >= k; --j)
+                {
+                    d[j] = k == 1 && (j & 1) ? f[j] : (d[j] - d[j - 1]) / (Nodes[j] - Nodes[j - k]);
+                }
+            }
+
+            for (int32 k = 0; k < m; ++k)
+            {
+                Coefficients[k * Channels + c] = d[k];
+            }
+        }
+        return true;
+    }
+
+
+    void FPolynomialInterpolator::Reset()
+    {
+        Nodes.Empty();
+        Coefficients.Empty();
+        Channels = 0;
+    }
+
+
+    void FPolynomialInterpolator::Evaluate(double x, TArrayView<double> p, TArrayView<double> dp) const
+    {
+        check(p.Num() >= Channels);
+        check(dp.Num() == 0 || dp.Num() >= Channels);
+
+        const int32 m = Nodes.Num();
+        if (m == 0)
+        {
+            return;
+        }
+
+        const double* Last = &Coefficients[(m - 1) * Channels];
+        for (int32 c = 0; c < Channels; ++c)
+        {
+            p[c] = Last[c];
+        }
+
+        if (dp.Num())
+        {
+            for (int32 c = 0; c < Channels; ++c)
+            {
+                dp[c] = 0.;
+            }
+
+            for (int32 k = m - 2; k >= 0; --k)
+            {
+                const double t = x - Nodes[k];
+                const double* Coefficient = &Coefficients[k * Channels];
+                for (int32 c = 0; c < Channels; ++c)
+                {
+                    dp[c] = dp[c] * t + p[c];
+                    p[c] = p[c] * t + Coefficient[c];
+                }
+            }
+        }
+        else
+        {
+            for (int32 k = m - 2; k >= 0; --k)
+            {
+                const double t = x - Nodes[k];
+                const double* Coefficient = &Coefficients[k * Channels];
+                for (int32 c = 0; c < Channels; ++c)
+                {
+                    p[c] = p[c] * t + Coefficient[c];
+                }
+            }
+        }
+    }
+
+
+    void FPolynomialInterpolator::Evaluate(TArrayView<const double> xs, TArrayView<double> p, TArrayView<double> dp) const
+    {
+        const int32 Num = xs.Num();
+        check(p.Num() >= Num * Channels);
+        check(dp.Num() == 0 || dp.Num() >= Num * Channels);
+
+        if (Channels == 0)
+        {
+            return;
+        }
+
+        const int32 NumChunks = (Num + ChunkSize - 1) / ChunkSize;
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            TArray<double, TInlineAllocator<64>> Values, Derivatives;
+            Values.SetNumUninitialized(Channels);
+            Derivatives.SetNumUninitialized(dp.Num() ? Channels : 0);
+
+            const int32 Last = FMath::Min(Num, (Chunk + 1) * ChunkSize);
+            for (int32 i = Chunk * ChunkSize; i < Last; ++i)
+            {
+                Evaluate(xs[i], Values, Derivatives);
+                for (int32 c = 0; c < Channels; ++c)
+                {
+                    p[c * Num + i] = Values[c];
+                }
+                for (int32 c = 0; c < Derivatives.Num(); ++c)
+                {
+                    dp[c * Num + i] = Derivatives[c];
+                }
+            }
+        }, NumChunks == 1);
+    }
+}
@@ -24,6 +24,7 @@
 #include "Spice.h"
 #include "SpiceUtilities.h"
 #include "SpiceMath.h"
+#include "SpiceMathBatch.h"
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 extern "C"
@@ -35,6 +36,40 @@ PRAGMA_POP_PLATFORM_DEFAULT_PACKING
 using namespace MaxQ;
 using namespace MaxQ::Private;
 
+namespace
+{
+    bool IsCached(const FSPoolValueCache& cache, const FString& name, const FString& item, int32 index)
+    {
+        return cache.Generation == MaxQ::Data::GetPoolGeneration()
+            && cache.Index == index
+            && cache.Name.Equals(name, ESearchCase::CaseSensitive)
+            && cache.Item.Equals(item, ESearchCase::CaseSensitive);
+    }
+
+    // Generation is from before the lookup, so a change during it isn't missed
+    void Remember(FSPoolValueCache& cache, uint64 Generation, ES_ResultCode ResultCode, const FString& name, const FString& item, int32 index, TArrayView<const double> values)
+    {
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            cache.Generation = 0;
+            return;
+        }
+
+        cache.Generation = Generation;
+        cache.Name = name;
+        cache.Item = item;
+        cache.Index = index;
+        cache.Values = values;
+    }
+
+    void Hit(ES_ResultCode& ResultCode, FString& ErrorMessage)
+    {
+        ResultCode = ES_ResultCode::Success;
+        ErrorMessage.Empty();
+    }
+}
+
+
 double USpiceK2::bodvrd_double_K2(
     ES_ResultCode& ResultCode,
     FString& ErrorMessage,
@@ -103,6 +138,8 @@ TArray<double> USpiceK2::gdpool_array_K2(
     int start
 )
 {
+    FScratchScope Scratch;
+
     // Not implemented by MaxQ::Data
 
     // Inputs
@@ -111,13 +148,13 @@ TArray<double> USpiceK2::gdpool_array_K2(
     // Outputs
     SpiceInt        _n = 0;
     size_t buffer_size = _room * sizeof(SpiceDouble);
-    SpiceDouble* _values = (SpiceDouble*)StackAlloc(buffer_size);
+    SpiceDouble* _values = (SpiceDouble*)Scratch.Alloc(buffer_size);
     SpiceBoolean    _found = SPICEFALSE;
 
     // Invocation
     memset(_values, 0, buffer_size);
 
-    gdpool_c(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
+    CachedGdpool(TCHAR_TO_ANSI(*name), _start, _room, &_n, _values, &_found);
 
     // Return values
     TArray<double> value = TArray<double>();
@@ -191,6 +228,42 @@ FSDimensionlessStateVector USpiceK2::mxv_state_vector_K2(const FSStateTransform&
     return MaxQ::Math::MxV(m, v);
 }
 
+FSDistanceVector USpiceK2::mxv_SDistanceVector_K2(const FSRotationMatrix& m, const FSDistanceVector& v)
+{
+    return FSDistanceVector(MaxQ::Math::MxV(m, v.AsDimensionlessVector()));
+}
+
+FSVelocityVector USpiceK2::mxv_SVelocityVector_K2(const FSRotationMatrix& m, const FSVelocityVector& v)
+{
+    return FSVelocityVector(MaxQ::Math::MxV(m, v.AsDimensionlessVector()));
+}
+
+FSAngularVelocity USpiceK2::mxv_SAngularVelocity_K2(const FSRotationMatrix& m, const FSAngularVelocity& v)
+{
+    return FSAngularVelocity(MaxQ::Math::MxV(m, v.AsDimensionlessVector()));
+}
+
+FSStateVector USpiceK2::mxv_SStateVector_K2(const FSStateTransform& m, const FSStateVector& v)
+{
+    return FSStateVector(MaxQ::Math::MxV(m, v.AsDimensionlessVector()));
+}
+
+TArray<FSDimensionlessVector> USpiceK2::mxv_vector_array_K2(const FSRotationMatrix& m, const TArray<FSDimensionlessVector>& v)
+{
+    TArray<FSDimensionlessVector> vout;
+    vout.SetNumUninitialized(v.Num());
+    MaxQ::Math::MxV(m, v, vout);
+    return vout;
+}
+
+TArray<FSDimensionlessStateVector> USpiceK2::mxv_state_vector_array_K2(const FSStateTransform& m, const TArray<FSDimensionlessStateVector>& v)
+{
+    TArray<FSDimensionlessStateVector> vout;
+    vout.SetNumUninitialized(v.Num());
+    MaxQ::Math::MxV(m, v, vout);
+    return vout;
+}
+
 FSDimensionlessVector USpiceK2::qderiv_vector_K2(const FSDimensionlessVector& f0, const FSDimensionlessVector& f2, double delta)
 {
     return MaxQ::Math::Qderiv<FSDimensionlessVector, FSDimensionlessVector>(f0, f2, delta);
@@ -216,6 +289,13 @@ void USpiceK2::unorm_vector_K2(const FSDimensionlessVector& v1, FSDimensionlessV
     MaxQ::Math::Unorm(vout, vmag, v1);
 }
 
+void USpiceK2::unorm_vector_array_K2(const TArray<FSDimensionlessVector>& v, TArray<FSDimensionlessVector>& vout, TArray<double>& vmag)
+{
+    vout.SetNumUninitialized(v.Num());
+    vmag.SetNumUninitialized(v.Num());
+    MaxQ::Math::Unorm(v, vout, vmag);
+}
+
 FSDimensionlessVector USpiceK2::vadd_vector_K2(const FSDimensionlessVector& v1, const FSDimensionlessVector& v2)
 {
     return MaxQ::Math::Vadd(v1, v2);
@@ -226,6 +306,44 @@ FSDimensionlessStateVector USpiceK2::vadd_state_vector_K2(const FSDimensionlessS
     return MaxQ::Math::Vadd(v1, v2);
 }
 
+FSDistanceVector USpiceK2::vadd_SDistanceVector_K2(const FSDistanceVector& v1, const FSDistanceVector& v2)
+{
+    return FSDistanceVector(MaxQ::Math::Vadd(v1.AsDimensionlessVector(), v2.AsDimensionlessVector()));
+}
+
+FSVelocityVector USpiceK2::vadd_SVelocityVector_K2(const FSVelocityVector& v1, const FSVelocityVector& v2)
+{
+    return FSVelocityVector(MaxQ::Math::Vadd(v1.AsDimensionlessVector(), v2.AsDimensionlessVector()));
+}
+
+FSAngularVelocity USpiceK2::vadd_SAngularVelocity_K2(const FSAngularVelocity& v1, const FSAngularVelocity& v2)
+{
+    return FSAngularVelocity(MaxQ::Math::Vadd(v1.AsDimensionlessVector(), v2.AsDimensionlessVector()));
+}
+
+FSStateVector USpiceK2::vadd_SStateVector_K2(const FSStateVector& v1, const FSStateVector& v2)
+{
+    return FSStateVector(MaxQ::Math::Vadd(v1.AsDimensionlessVector(), v2.AsDimensionlessVector()));
+}
+
+TArray<FSDimensionlessVector> USpiceK2::vadd_vector_array_K2(const TArray<FSDimensionlessVector>& v1, const TArray<FSDimensionlessVector>& v2)
+{
+    const int32 Num = FMath::Min(v1.Num(), v2.Num());
+    TArray<FSDimensionlessVector> vout;
+    vout.SetNumUninitialized(Num);
+    MaxQ::Math::Vadd(MakeArrayView(v1.GetData(), Num), MakeArrayView(v2.GetData(), Num), vout);
+    return vout;
+}
+
+TArray<FSDimensionlessStateVector> USpiceK2::vadd_state_vector_array_K2(const TArray<FSDimensionlessStateVector>& v1, const TArray<FSDimensionlessStateVector>& v2)
+{
+    const int32 Num = FMath::Min(v1.Num(), v2.Num());
+    TArray<FSDimensionlessStateVector> vout;
+    vout.SetNumUninitialized(Num);
+    MaxQ::Math::Vadd(MakeArrayView(v1.GetData(), Num), MakeArrayView(v2.GetData(), Num), vout);
+    return vout;
+}
+
 FSDimensionlessVector USpiceK2::vcrss_vector_K2(const FSDimensionlessVector& v1, const FSDimensionlessVector& v2)
 {
     return MaxQ::Math::Vcrss(v1, v2);
@@ -283,6 +401,29 @@ double USpiceK2::vnorm_vector_K2(const FSDimensionlessVector& v)
     return MaxQ::Math::Vnorm(v);
 }
 
+FSDistance USpiceK2::vnorm_SDistanceVector_K2(const FSDistanceVector& v)
+{
+    return MaxQ::Math::Vnorm(v);
+}
+
+FSSpeed USpiceK2::vnorm_SVelocityVector_K2(const FSVelocityVector& v)
+{
+    return MaxQ::Math::Vnorm(v);
+}
+
+FSAngularRate USpiceK2::vnorm_SAngularVelocity_K2(const FSAngularVelocity& v)
+{
+    return MaxQ::Math::Vnorm(v);
+}
+
+TArray<double> USpiceK2::vnorm_vector_array_K2(const TArray<FSDimensionlessVector>& v)
+{
+    TArray<double> vmag;
+    vmag.SetNumUninitialized(v.Num());
+    MaxQ::Math::Vnorm(v, vmag);
+    return vmag;
+}
+
 FSDimensionlessVector USpiceK2::vpack_vector_K2(double x, double y, double z)
 {
     // Trivial, so not implemented by MaxQ::Math
@@ -357,6 +498,44 @@ FSDimensionlessStateVector USpiceK2::vsub_state_vector_K2(const FSDimensionlessS
     return MaxQ::Math::Vsub(v1, v2);
 }
 
+FSDistanceVector USpiceK2::vsub_SDistanceVector_K2(const FSDistanceVector& v1, const FSDistanceVector& v2)
+{
+    return FSDistanceVector(MaxQ::Math::Vsub(v1.AsDimensionlessVector(), v2.AsDimensionlessVector()));
+}
+
+FSVelocityVector USpiceK2::vsub_SVelocityVector_K2(const FSVelocityVector& v1, const FSVelocityVector& v2)
+{
+    return FSVelocityVector(MaxQ::Math::Vsub(v1.AsDimensionlessVector(), v2.AsDimensionlessVector()));
+}
+
+FSAngularVelocity USpiceK2::vsub_SAngularVelocity_K2(const FSAngularVelocity& v1, const FSAngularVelocity& v2)
+{
+    return FSAngularVelocity(MaxQ::Math::Vsub(v1.AsDimensionlessVector(), v2.AsDimensionlessVector()));
+}
+
+FSStateVector USpiceK2::vsub_SStateVector_K2(const FSStateVector& v1, const FSStateVector& v2)
+{
+    return FSStateVector(MaxQ::Math::Vsub(v1.AsDimensionlessVector(), v2.AsDimensionlessVector()));
+}
+
+TArray<FSDimensionlessVector> USpiceK2::vsub_vector_array_K2(const TArray<FSDimensionlessVector>& v1, const TArray<FSDimensionlessVector>& v2)
+{
+    const int32 Num = FMath::Min(v1.Num(), v2.Num());
+    TArray<FSDimensionlessVector> vout;
+    vout.SetNumUninitialized(Num);
+    MaxQ::Math::Vsub(MakeArrayView(v1.GetData(), Num), MakeArrayView(v2.GetData(), Num), vout);
+    return vout;
+}
+
+TArray<FSDimensionlessStateVector> USpiceK2::vsub_state_vector_array_K2(const TArray<FSDimensionlessStateVector>& v1, const TArray<FSDimensionlessStateVector>& v2)
+{
+    const int32 Num = FMath::Min(v1.Num(), v2.Num());
+    TArray<FSDimensionlessStateVector> vout;
+    vout.SetNumUninitialized(Num);
+    MaxQ::Math::Vsub(MakeArrayView(v1.GetData(), Num), MakeArrayView(v2.GetData(), Num), vout);
+    return vout;
+}
+
 void USpiceK2::vupack_vector_K2(const FSDimensionlessVector& v, double& x, double& y, double& z)
 {
     // Trivial, so not implemented by MaxQ::Math
@@ -454,6 +633,133 @@ double USpiceK2::gdpool_double_K2(
 }
 
 
+double USpiceK2::bodvrd_double_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& bodynm, const FString& item, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, bodynm, item, 0))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return cache.Values[0];
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const double Value = bodvrd_double_K2(ResultCode, ErrorMessage, bodynm, item);
+    Remember(cache, Generation, ResultCode, bodynm, item, 0, { Value });
+    return Value;
+}
+
+FSDimensionlessVector USpiceK2::bodvrd_vector_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& bodynm, const FString& item, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, bodynm, item, 0))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return FSDimensionlessVector(cache.Values[0], cache.Values[1], cache.Values[2]);
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const FSDimensionlessVector Value = bodvrd_vector_K2(ResultCode, ErrorMessage, bodynm, item);
+    Remember(cache, Generation, ResultCode, bodynm, item, 0, { Value.x, Value.y, Value.z });
+    return Value;
+}
+
+TArray<double> USpiceK2::bodvrd_array_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& bodynm, const FString& item, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, bodynm, item, 0))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return cache.Values;
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const TArray<double> Value = bodvrd_array_K2(ResultCode, ErrorMessage, bodynm, item);
+    Remember(cache, Generation, ResultCode, bodynm, item, 0, Value);
+    return Value;
+}
+
+double USpiceK2::bodvcd_double_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, int bodyid, const FString& item, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, FString(), item, bodyid))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return cache.Values[0];
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const double Value = bodvcd_double_K2(ResultCode, ErrorMessage, bodyid, item);
+    Remember(cache, Generation, ResultCode, FString(), item, bodyid, { Value });
+    return Value;
+}
+
+FSDimensionlessVector USpiceK2::bodvcd_vector_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, int bodyid, const FString& item, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, FString(), item, bodyid))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return FSDimensionlessVector(cache.Values[0], cache.Values[1], cache.Values[2]);
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const FSDimensionlessVector Value = bodvcd_vector_K2(ResultCode, ErrorMessage, bodyid, item);
+    Remember(cache, Generation, ResultCode, FString(), item, bodyid, { Value.x, Value.y, Value.z });
+    return Value;
+}
+
+TArray<double> USpiceK2::bodvcd_array_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, int bodyid, const FString& item, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, FString(), item, bodyid))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return cache.Values;
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const TArray<double> Value = bodvcd_array_K2(ResultCode, ErrorMessage, bodyid, item);
+    Remember(cache, Generation, ResultCode, FString(), item, bodyid, Value);
+    return Value;
+}
+
+double USpiceK2::gdpool_double_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& name, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, name, FString(), 0))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return cache.Values[0];
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const double Value = gdpool_double_K2(ResultCode, ErrorMessage, name);
+    Remember(cache, Generation, ResultCode, name, FString(), 0, { Value });
+    return Value;
+}
+
+FSDimensionlessVector USpiceK2::gdpool_vector_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& name, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, name, FString(), 0))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return FSDimensionlessVector(cache.Values[0], cache.Values[1], cache.Values[2]);
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const FSDimensionlessVector Value = gdpool_vector_K2(ResultCode, ErrorMessage, name);
+    Remember(cache, Generation, ResultCode, name, FString(), 0, { Value.x, Value.y, Value.z });
+    return Value;
+}
+
+TArray<double> USpiceK2::gdpool_array_cached_K2(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& name, int start, FSPoolValueCache& cache)
+{
+    if (IsCached(cache, name, FString(), start))
+    {
+        Hit(ResultCode, ErrorMessage);
+        return cache.Values;
+    }
+
+    const uint64 Generation = MaxQ::Data::GetPoolGeneration();
+    const TArray<double> Value = gdpool_array_K2(ResultCode, ErrorMessage, name, start);
+    Remember(cache, Generation, ResultCode, name, FString(), start, Value);
+    return Value;
+}
+
+
 FSEphemerisTime USpiceK2::Conv_DoubleToSEphemerisTime_K2(double value)
 {
     return FSEphemerisTime(value);
@@ -564,3 +870,123 @@ FSDistance USpiceK2::Conv_SDimensionlessVector_Z_ToSDistance_K2(const FSDimensio
     return value.z;
 }
 
+TArray<FSDistance> USpiceK2::Conv_DoubleArrayToSDistanceArray_K2(const TArray<double>& value)
+{
+    TArray<FSDistance> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(FSDistance(value[i]));
+    }
+    return out;
+}
+
+TArray<FSSpeed> USpiceK2::Conv_DoubleArrayToSSpeedArray_K2(const TArray<double>& value)
+{
+    TArray<FSSpeed> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(FSSpeed(value[i]));
+    }
+    return out;
+}
+
+TArray<FSAngularRate> USpiceK2::Conv_DoubleArrayToSAngularRateArray_K2(const TArray<double>& value)
+{
+    TArray<FSAngularRate> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(FSAngularRate(value[i]));
+    }
+    return out;
+}
+
+TArray<FSDistanceVector> USpiceK2::Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2(const TArray<FSDimensionlessVector>& value)
+{
+    TArray<FSDistanceVector> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(FSDistanceVector(value[i]));
+    }
+    return out;
+}
+
+TArray<FSVelocityVector> USpiceK2::Conv_SDimensionlessVectorArrayToSVelocityVectorArray_K2(const TArray<FSDimensionlessVector>& value)
+{
+    TArray<FSVelocityVector> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(FSVelocityVector(value[i]));
+    }
+    return out;
+}
+
+TArray<FSAngularVelocity> USpiceK2::Conv_SDimensionlessVectorArrayToSAngularVelocityArray_K2(const TArray<FSDimensionlessVector>& value)
+{
+    TArray<FSAngularVelocity> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(FSAngularVelocity(value[i]));
+    }
+    return out;
+}
+
+TArray<FSDimensionlessVector> USpiceK2::Conv_SDistanceVectorArrayToSDimensionlessVectorArray_K2(const TArray<FSDistanceVector>& value)
+{
+    TArray<FSDimensionlessVector> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(value[i].AsDimensionlessVector());
+    }
+    return out;
+}
+
+TArray<FSDimensionlessVector> USpiceK2::Conv_SVelocityVectorArrayToSDimensionlessVectorArray_K2(const TArray<FSVelocityVector>& value)
+{
+    TArray<FSDimensionlessVector> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(value[i].AsDimensionlessVector());
+    }
+    return out;
+}
+
+TArray<FSDimensionlessVector> USpiceK2::Conv_SAngularVelocityArrayToSDimensionlessVectorArray_K2(const TArray<FSAngularVelocity>& value)
+{
+    TArray<FSDimensionlessVector> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(value[i].AsDimensionlessVector());
+    }
+    return out;
+}
+
+TArray<FSStateVector> USpiceK2::Conv_SDimensionlessStateVectorArrayToSStateVectorArray_K2(const TArray<FSDimensionlessStateVector>& value)
+{
+    TArray<FSStateVector> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(FSStateVector(value[i]));
+    }
+    return out;
+}
+
+TArray<FSDimensionlessStateVector> USpiceK2::Conv_SStateVectorArrayToSDimensionlessStateVectorArray_K2(const TArray<FSStateVector>& value)
+{
+    TArray<FSDimensionlessStateVector> out;
+    out.Reserve(value.Num());
+    for (int32 i = 0; i < value.Num(); ++i)
+    {
+        out.Add(value[i].AsDimensionlessVector());
+    }
+    return out;
+}
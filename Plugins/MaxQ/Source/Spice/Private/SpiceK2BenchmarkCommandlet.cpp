@@ -0,0 +1,338 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceK2BenchmarkCommandlet.cpp
+//
+// Implementation Comments
+//
+// Purpose:  What the K2 nodes cost, over calling MaxQ directly.
+//
+// The VM graphs' nodes each own a parameter buffer, with inputs set once:  a
+// compiled Blueprint copies pin values between nodes' locals the same way
+// ProcessEvent copies them in and out of the buffer, so the values don't
+// need to flow for the timing to be representative.
+//------------------------------------------------------------------------------
+
+#include "SpiceK2BenchmarkCommandlet.h"
+#include "SpiceBenchmark.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceK2.h"
+#include "SpiceMath.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    constexpr int32 WarmupIterations = 1000;
+
+    // One K2 node:  a USpiceK2 UFunction, and its parameters
+    class FVmGraph
+    {
+    public:
+        ~FVmGraph()
+        {
+            for (FNode& Node : Nodes)
+            {
+                Node.Function->DestroyStruct(Node.Params);
+                FMemory::Free(Node.Params);
+            }
+        }
+
+        // The node's index, or INDEX_NONE if USpiceK2 has no such function
+        int32 Add(FName FunctionName)
+        {
+            UFunction* Function = USpiceK2::StaticClass()->FindFunctionByName(FunctionName);
+            if (!Function)
+            {
+                bValid = false;
+                return INDEX_NONE;
+            }
+
+            uint8* Params = (uint8*)FMemory::Malloc(FMath::Max<int32>(Function->ParmsSize, 1), Function->GetMinAlignment());
+            Function->InitializeStruct(Params);
+            return Nodes.Add({ Function, Params });
+        }
+
+        template<class ValueType>
+        void Set(int32 Node, FName Param, const ValueType& Value)
+        {
+            FProperty* Property = Nodes.IsValidIndex(Node) ? Nodes[Node].Function->FindPropertyByName(Param) : nullptr;
+            if (!Property || Property->GetSize() != sizeof(ValueType))
+            {
+                bValid = false;
+                return;
+            }
+            *Property->ContainerPtrToValuePtr<ValueType>(Nodes[Node].Params) = Value;
+        }
+
+        void Run(UObject* Context)
+        {
+            for (FNode& Node : Nodes)
+            {
+                Context->ProcessEvent(Node.Function, Node.Params);
+            }
+        }
+
+        int32 Num() const { return Nodes.Num(); }
+        bool IsValid() const { return bValid && Nodes.Num() > 0; }
+
+    private:
+        struct FNode
+        {
+            UFunction* Function;
+            uint8* Params;
+        };
+
+        TArray<FNode> Nodes;
+        bool bValid = true;
+    };
+
+    // Nanoseconds per call, after a warm up
+    template<typename CallType>
+    double NanosecondsPer(int32 Iterations, CallType&& Call)
+    {
+        for (int32 i = 0; i < WarmupIterations; ++i)
+        {
+            Call();
+        }
+
+        const double Start = FPlatformTime::Seconds();
+        for (int32 i = 0; i < Iterations; ++i)
+        {
+            Call();
+        }
+        return (FPlatformTime::Seconds() - Start) * 1.e9 / Iterations;
+    }
+}
+
+
+USpiceK2BenchmarkCommandlet::USpiceK2BenchmarkCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+
+int32 USpiceK2BenchmarkCommandlet::Main(const FString& Params)
+{
+    using namespace MaxQ::Math;
+
+    MaxQ::Core::InitAll();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    FString Kernels;
+    if (FParse::Value(*Params, TEXT("Kernels="), Kernels, false))
+    {
+        TArray<FString> KernelPaths;
+        Kernels.ParseIntoArray(KernelPaths, TEXT("+"));
+        if (!MaxQ::Data::Furnsh(KernelPaths, &ResultCode, &ErrorMessage))
+        {
+            UE_LOG(LogSpice, Error, TEXT("MaxQ K2 Benchmark: %s"), *ErrorMessage);
+            return 1;
+        }
+    }
+
+    int32 Iterations = 100000;
+    FParse::Value(*Params, TEXT("Iterations="), Iterations);
+    Iterations = FMath::Max(Iterations, 1);
+
+    FString Out = MaxQ::Data::FBenchmarkRecorder::DefaultDirectory();
+    FParse::Value(*Params, TEXT("Out="), Out, false);
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*Out);
+
+    MaxQ::Data::Bodvrd<FSDistanceVector>(TEXT("EARTH"), TEXT("RADII"), &ResultCode, &ErrorMessage);
+    const bool bHaveRadii = ResultCode == ES_ResultCode::Success;
+    if (!bHaveRadii)
+    {
+        UE_LOG(LogSpice, Warning, TEXT("MaxQ K2 Benchmark: no EARTH RADII (%s), skipping bodvrd"), *ErrorMessage);
+    }
+
+    UObject* Context = GetMutableDefault<USpiceK2>();
+    const FName ToDimensionless(USpiceK2::Conv_SDistanceVectorToSDimensionlessVector);
+    const FName ToDistance(USpiceK2::Conv_SDimensionlessVectorToSDistanceVector);
+
+    const FSDistanceVector r1(7000., 100., -250.);
+    const FSDistanceVector r2(-30., 6500., 1200.);
+    const FSDimensionlessVector d1 = r1.AsDimensionlessVector();
+    const FSDimensionlessVector d2 = r2.AsDimensionlessVector();
+    const FSRotationMatrix m = FSRotationMatrix::Identity;
+    const FString Body = TEXT("EARTH"), Item = TEXT("RADII");
+    FSPoolValueCache Cache;
+
+    // Keeps the optimizer from discarding the native and thunk results
+    double Sink = 0.;
+
+    TArray<FString> Lines;
+    Lines.Add(TEXT("Graph,Nodes,NativeNs,ThunksNs,VmNs,ThunkOverheadNs,VmOverheadPerNodeNs"));
+    UE_LOG(LogSpice, Display, TEXT("MaxQ K2 Benchmark: %d iterations"), Iterations);
+    UE_LOG(LogSpice, Display, TEXT("%-16s %5s %10s %10s %10s %14s"), TEXT("Graph"), TEXT("Nodes"), TEXT("Native ns"), TEXT("Thunks ns"), TEXT("VM ns"), TEXT("VM ns / node"));
+
+    auto Report = [&](const TCHAR* Name, FVmGraph& Graph, double Native, double Thunks)
+    {
+        if (!Graph.IsValid())
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ K2 Benchmark: %s's micro-ops didn't resolve, skipped"), Name);
+            return;
+        }
+
+        const double Vm = NanosecondsPer(Iterations, [&] { Graph.Run(Context); });
+        const double PerNode = (Vm - Thunks) / Graph.Num();
+        UE_LOG(LogSpice, Display, TEXT("%-16s %5d %10.1f %10.1f %10.1f %14.1f"), Name, Graph.Num(), Native, Thunks, Vm, PerNode);
+        Lines.Add(FString::Printf(TEXT("%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f"), Name, Graph.Num(), Native, Thunks, Vm, Thunks - Native, PerNode));
+    };
+
+    // vadd, on distance vectors:  two conversions in, one out
+    {
+        FVmGraph Graph;
+        Graph.Set(Graph.Add(ToDimensionless), TEXT("value"), r1);
+        Graph.Set(Graph.Add(ToDimensionless), TEXT("value"), r2);
+        const int32 Op = Graph.Add(USpiceK2::vadd_vector);
+        Graph.Set(Op, USpiceK2::vadd_input1, d1);
+        Graph.Set(Op, USpiceK2::vadd_input2, d2);
+        Graph.Set(Graph.Add(ToDistance), TEXT("value"), d1);
+
+        const double Native = NanosecondsPer(Iterations, [&] { Sink += Vadd(r1, r2).x.km; });
+        const double Thunks = NanosecondsPer(Iterations, [&]
+        {
+            const FSDimensionlessVector v = USpiceK2::vadd_vector_K2(USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(r1), USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(r2));
+            Sink += USpiceK2::Conv_SDimensionlessVectorToSDistanceVector_K2(v).x.km;
+        });
+        Report(TEXT("vadd"), Graph, Native, Thunks);
+    }
+
+    // mxv, generic:  through dimensionless vectors
+    {
+        FVmGraph Graph;
+        Graph.Set(Graph.Add(ToDimensionless), TEXT("value"), r1);
+        const int32 Op = Graph.Add(USpiceK2::mxv_vector);
+        Graph.Set(Op, USpiceK2::mxv_m, m);
+        Graph.Set(Op, USpiceK2::mxv_vin, d1);
+        Graph.Set(Graph.Add(ToDistance), TEXT("value"), d1);
+
+        const double Native = NanosecondsPer(Iterations, [&] { Sink += MxV(m, r1).x.km; });
+        const double Thunks = NanosecondsPer(Iterations, [&]
+        {
+            const FSDimensionlessVector v = USpiceK2::mxv_vector_K2(m, USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(r1));
+            Sink += USpiceK2::Conv_SDimensionlessVectorToSDistanceVector_K2(v).x.km;
+        });
+        Report(TEXT("mxv"), Graph, Native, Thunks);
+    }
+
+    // mxv, fused:  the distance vector micro-op
+    {
+        FVmGraph Graph;
+        const int32 Op = Graph.Add(USpiceK2::mxv_SDistanceVector);
+        Graph.Set(Op, USpiceK2::mxv_m, m);
+        Graph.Set(Op, USpiceK2::mxv_vin, r1);
+
+        const double Native = NanosecondsPer(Iterations, [&] { Sink += MxV(m, r1).x.km; });
+        const double Thunks = NanosecondsPer(Iterations, [&] { Sink += USpiceK2::mxv_SDistanceVector_K2(m, r1).x.km; });
+        Report(TEXT("mxv fused"), Graph, Native, Thunks);
+    }
+
+    // unorm, of a distance vector
+    {
+        FVmGraph Graph;
+        Graph.Set(Graph.Add(ToDimensionless), TEXT("value"), r1);
+        Graph.Set(Graph.Add(USpiceK2::unorm_vector), USpiceK2::unorm_vector_input, d1);
+
+        const double Native = NanosecondsPer(Iterations, [&] { Sink += Vnorm(r1).km + Vhat(r1).x; });
+        const double Thunks = NanosecondsPer(Iterations, [&]
+        {
+            FSDimensionlessVector vout;
+            double vmag;
+            USpiceK2::unorm_vector_K2(USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(r1), vout, vmag);
+            Sink += vmag + vout.x;
+        });
+        Report(TEXT("unorm"), Graph, Native, Thunks);
+    }
+
+    // vadd -> mxv (fused) -> unorm, as one graph
+    {
+        FVmGraph Graph;
+        Graph.Set(Graph.Add(ToDimensionless), TEXT("value"), r1);
+        Graph.Set(Graph.Add(ToDimensionless), TEXT("value"), r2);
+        const int32 Add = Graph.Add(USpiceK2::vadd_vector);
+        Graph.Set(Add, USpiceK2::vadd_input1, d1);
+        Graph.Set(Add, USpiceK2::vadd_input2, d2);
+        Graph.Set(Graph.Add(ToDistance), TEXT("value"), d1);
+        const int32 Mxv = Graph.Add(USpiceK2::mxv_SDistanceVector);
+        Graph.Set(Mxv, USpiceK2::mxv_m, m);
+        Graph.Set(Mxv, USpiceK2::mxv_vin, r1);
+        Graph.Set(Graph.Add(ToDimensionless), TEXT("value"), r1);
+        Graph.Set(Graph.Add(USpiceK2::unorm_vector), USpiceK2::unorm_vector_input, d1);
+
+        const double Native = NanosecondsPer(Iterations, [&] { Sink += Vnorm(MxV(m, Vadd(r1, r2))).km; });
+        const double Thunks = NanosecondsPer(Iterations, [&]
+        {
+            const FSDimensionlessVector Sum = USpiceK2::vadd_vector_K2(USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(r1), USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(r2));
+            const FSDistanceVector Rotated = USpiceK2::mxv_SDistanceVector_K2(m, USpiceK2::Conv_SDimensionlessVectorToSDistanceVector_K2(Sum));
+            FSDimensionlessVector vout;
+            double vmag;
+            USpiceK2::unorm_vector_K2(USpiceK2::Conv_SDistanceVectorToSDimensionlessVector_K2(Rotated), vout, vmag);
+            Sink += vmag;
+        });
+        Report(TEXT("vadd-mxv-unorm"), Graph, Native, Thunks);
+    }
+
+    if (bHaveRadii)
+    {
+        // bodvrd, uncached:  every call goes to the kernel pool
+        {
+            FVmGraph Graph;
+            const int32 Op = Graph.Add(USpiceK2::bodvrd_vector);
+            Graph.Set(Op, TEXT("bodynm"), Body);
+            Graph.Set(Op, TEXT("item"), Item);
+            Graph.Set(Graph.Add(ToDistance), TEXT("value"), d1);
+
+            const double Native = NanosecondsPer(Iterations, [&] { Sink += MaxQ::Data::Bodvrd<FSDistanceVector>(Body, Item).x.km; });
+            const double Thunks = NanosecondsPer(Iterations, [&]
+            {
+                const FSDimensionlessVector v = USpiceK2::bodvrd_vector_K2(ResultCode, ErrorMessage, Body, Item);
+                Sink += USpiceK2::Conv_SDimensionlessVectorToSDistanceVector_K2(v).x.km;
+            });
+            Report(TEXT("bodvrd"), Graph, Native, Thunks);
+        }
+
+        // bodvrd, with the node's cache
+        {
+            FVmGraph Graph;
+            const int32 Op = Graph.Add(USpiceK2::bodvrd_vector_cached);
+            Graph.Set(Op, TEXT("bodynm"), Body);
+            Graph.Set(Op, TEXT("item"), Item);
+            Graph.Set(Graph.Add(ToDistance), TEXT("value"), d1);
+
+            const double Native = NanosecondsPer(Iterations, [&] { Sink += MaxQ::Data::Bodvrd<FSDistanceVector>(Body, Item).x.km; });
+            const double Thunks = NanosecondsPer(Iterations, [&]
+            {
+                const FSDimensionlessVector v = USpiceK2::bodvrd_vector_cached_K2(ResultCode, ErrorMessage, Body, Item, Cache);
+                Sink += USpiceK2::Conv_SDimensionlessVectorToSDistanceVector_K2(v).x.km;
+            });
+            Report(TEXT("bodvrd cached"), Graph, Native, Thunks);
+        }
+    }
+
+    UE_LOG(LogSpice, Verbose, TEXT("MaxQ K2 Benchmark: sink %f"), Sink);
+
+    const FString Path = FPaths::Combine(Out, TEXT("K2Overhead.csv"));
+    if (!FFileHelper::SaveStringArrayToFile(Lines, *Path))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ K2 Benchmark: could not write %s"), *Path);
+        return 1;
+    }
+    UE_LOG(LogSpice, Display, TEXT("MaxQ K2 Benchmark: written to %s"), *Path);
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceK2BenchmarkCommandlet.h
+//
+// Private API Comments
+//
+// Purpose:  What the K2 nodes cost, over calling MaxQ directly.
+//    <exe> [project] -run=SpiceK2Benchmark [-Kernels=<a>+<b>+...]
+//        [-Iterations=100000] [-Out=<dir>]
+// Each graph (vadd, mxv, unorm and bodvrd, alone and chained) runs three
+// ways, Iterations times:
+// * Native:  MaxQ::Math / MaxQ::Data, as game code would call them.
+// * Thunks:  the USpiceK2 micro-ops a K2 node compiles to (SpiceK2.h), called
+//   from C++:  the conversions and copies the wildcard nodes add.
+// * VM:  the same micro-ops, each invoked through its UFunction (ProcessEvent
+//   on USpiceK2's CDO), the way the Blueprint VM calls a native node.
+// VM - Thunks, per node, is the VM's per node overhead;  Thunks - Native is
+// the cost of the node's generality.  Graphs where either dominates are the
+// ones worth a fused micro-op (like mxv_SDistanceVector_K2) or a batched
+// node.  The bodvrd graphs need a PCK with EARTH's RADII, and are skipped
+// without one.  Logs a table, and writes K2Overhead.csv to Out (default
+// Saved/MaxQBenchmarks).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SpiceK2BenchmarkCommandlet.generated.h"
+
+UCLASS()
+class USpiceK2BenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    USpiceK2BenchmarkCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,294 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelAsset.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Kernels as assets, loaded with the levels that use them.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelAsset.cpp is part of the "refined C++ API".
+//
+// The payload is inline bulk data, so it's read (and decompressed) with the
+// package by the async loader, rather than by a blocking read when Furnsh
+// asks for it.
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelAsset.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/FileHelper.h"
+#include "SpiceCoverageIndex.h"
+#include "SpiceData.h"
+#include "SpiceLock.h"
+#include "SpiceUtilities.h"
+
+using namespace MaxQ::Private;
+
+
+bool USpiceKernelAsset::Furnsh(ES_ResultCode* ResultCode, FString* ErrorMessage)
+{
+    if (LoadCount == 0)
+    {
+        if (Payload.GetBulkDataSize() <= 0)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("USpiceKernelAsset %s has no kernel (import one)"), *GetPathName());
+            return false;
+        }
+
+        const uint8* Data = static_cast<const uint8*>(Payload.LockReadOnly());
+        const bool bSuccess = MaxQ::Data::FurnshBuffer(BufferName(), TArrayView<const uint8>(Data, (int32)Payload.GetBulkDataSize()), ResultCode, ErrorMessage);
+        Payload.Unlock();
+
+        if (!bSuccess)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+    }
+
+    ++LoadCount;
+    return true;
+}
+
+
+bool USpiceKernelAsset::Unload(ES_ResultCode* ResultCode, FString* ErrorMessage)
+{
+    if (LoadCount <= 0)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("USpiceKernelAsset %s isn't loaded"), *GetPathName());
+        return false;
+    }
+
+    if (--LoadCount > 0)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+    return MaxQ::Data::UnloadBuffer(BufferName(), ResultCode, ErrorMessage);
+}
+
+
+void USpiceKernelAsset::K2_Furnsh(ES_ResultCode& ResultCode, FString& ErrorMessage)
+{
+    Furnsh(&ResultCode, &ErrorMessage);
+}
+
+
+void USpiceKernelAsset::K2_Unload(ES_ResultCode& ResultCode, FString& ErrorMessage)
+{
+    Unload(&ResultCode, &ErrorMessage);
+}
+
+
+void USpiceKernelAsset::Serialize(FArchive& Ar)
+{
+    Super::Serialize(Ar);
+    Payload.Serialize(Ar, this);
+}
+
+
+FString USpiceKernelAsset::BufferName() const
+{
+    return FString::Printf(TEXT("%s/%s"), *GetPathName(), *FileName);
+}
+
+
+#if WITH_EDITOR
+bool USpiceKernelAsset::ImportFile(const FString& AbsolutePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+{
+    if (LoadCount > 0)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("USpiceKernelAsset %s is loaded;  unload it before reimporting"), *GetPathName());
+        return false;
+    }
+
+    TArray<uint8> Contents;
+    if (!FFileHelper::LoadFileToArray(Contents, *AbsolutePath))
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("USpiceKernelAsset could not read %s"), *AbsolutePath);
+        return false;
+    }
+
+    FString Architecture, Type;
+    {
+        MaxQ::Core::FSpiceScope Scope;
+
+        SpiceChar _arch[8];
+        SpiceChar _type[8];
+        getfat_c(TCHAR_TO_ANSI(*AbsolutePath), sizeof(_arch), sizeof(_type), _arch, _type);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        Architecture = _arch;
+        Type = _type;
+    }
+
+    if (Type == TEXT("MK"))
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("USpiceKernelAsset: %s is a meta-kernel;  import the kernels it lists instead"), *AbsolutePath);
+        return false;
+    }
+
+    // Coverage is a convenience:  a kernel that can't be indexed (a CK
+    // without its SCLK, say) still imports
+    TArray<FSpiceKernelAssetCoverage> NewCoverage;
+    if (Architecture == TEXT("DAF") && (Type == TEXT("SPK") || Type == TEXT("CK") || Type == TEXT("PCK")))
+    {
+        using namespace MaxQ::Data;
+
+        FKernelCoverageIndex Index;
+        FString IndexError;
+        bool bIndexed = false;
+        {
+            MaxQ::Core::FSpiceScope Scope;
+            bIndexed = Index.Add({ AbsolutePath }, nullptr, &IndexError);
+        }
+
+        const EKernelCoverageType CoverageType = Type == TEXT("SPK") ? EKernelCoverageType::SPK : Type == TEXT("CK") ? EKernelCoverageType::CK : EKernelCoverageType::PCK;
+        if (bIndexed)
+        {
+            for (int32 Id : Index.Ids(CoverageType))
+            {
+                FSpiceKernelAssetCoverage& Entry = NewCoverage.AddDefaulted_GetRef();
+                Entry.Id = Id;
+                Entry.Intervals = Index.Coverage(CoverageType, Id).ToSegments();
+            }
+        }
+        else
+        {
+            UE_LOG(LogSpice, Warning, TEXT("USpiceKernelAsset: no coverage for %s: %s"), *AbsolutePath, *IndexError);
+        }
+    }
+
+    Modify();
+
+    FileName = FPaths::GetCleanFilename(AbsolutePath);
+    KernelType = Type;
+    Size = Contents.Num();
+    Coverage = MoveTemp(NewCoverage);
+    SourceFile.FilePath = AbsolutePath;
+
+    Payload.SetBulkDataFlags(BULKDATA_ForceInlinePayload);
+    Payload.Lock(LOCK_READ_WRITE);
+    FMemory::Memcpy(Payload.Realloc(Contents.Num()), Contents.GetData(), Contents.Num());
+    Payload.Unlock();
+
+    MarkPackageDirty();
+
+    if (ResultCode) *ResultCode = ES_ResultCode::Success;
+    if (ErrorMessage) ErrorMessage->Empty();
+    return true;
+}
+
+
+void USpiceKernelAsset::Reimport()
+{
+    FString ErrorMessage;
+    if (!ImportFile(FPaths::ConvertRelativePathToFull(SourceFile.FilePath), nullptr, &ErrorMessage))
+    {
+        UE_LOG(LogSpice, Error, TEXT("%s"), *ErrorMessage);
+    }
+}
+#endif
+
+
+void UMaxQKernelSetComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    TArray<FSoftObjectPath> Paths;
+    for (const TSoftObjectPtr<USpiceKernelAsset>& Kernel : Kernels)
+    {
+        if (!Kernel.IsNull())
+        {
+            Paths.Add(Kernel.ToSoftObjectPath());
+        }
+    }
+
+    Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Paths, FStreamableDelegate::CreateUObject(this, &UMaxQKernelSetComponent::OnStreamed));
+}
+
+
+void UMaxQKernelSetComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (Handle.IsValid())
+    {
+        Handle->CancelHandle();
+        Handle.Reset();
+    }
+
+    UnloadKernels();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+void UMaxQKernelSetComponent::OnStreamed()
+{
+    for (const TSoftObjectPtr<USpiceKernelAsset>& Kernel : Kernels)
+    {
+        USpiceKernelAsset* Asset = Kernel.Get();
+        if (!Asset)
+        {
+            if (!Kernel.IsNull())
+            {
+                OnError.Broadcast(FString::Printf(TEXT("UMaxQKernelSetComponent could not load %s"), *Kernel.ToString()));
+            }
+            continue;
+        }
+
+        FString ErrorMessage;
+        if (Asset->Furnsh(nullptr, &ErrorMessage))
+        {
+            Furnshed.Add(Asset);
+        }
+        else
+        {
+            OnError.Broadcast(ErrorMessage);
+        }
+    }
+
+    // The assets are held by Furnshed now
+    Handle.Reset();
+    bLoaded = true;
+    OnLoaded.Broadcast();
+}
+
+
+void UMaxQKernelSetComponent::UnloadKernels()
+{
+    // Reverse order, so precedence unwinds as it was built
+    for (int32 i = Furnshed.Num() - 1; i >= 0; --i)
+    {
+        if (Furnshed[i])
+        {
+            Furnshed[i]->Unload();
+        }
+    }
+    Furnshed.Reset();
+    bLoaded = false;
+}
@@ -0,0 +1,578 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelCatalog.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Coverage-indexed, on demand kernel loading.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelCatalog.cpp is part of the "refined C++ API".
+//
+// The catalog loads and unloads through MaxQ::Data::Furnsh/Unload, so the
+// kernel history (and everything keyed off it) sees the same operations it
+// would if the files had been loaded by hand.
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelCatalog.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+using MaxQ::GeometryFinder::FSWindow;
+
+namespace
+{
+    constexpr uint32 CatalogMagic = 0x5441434B;  // "KCAT"
+    constexpr int32 CatalogVersion = 1;
+
+    // Cells start small and grow when CSPICE runs out of room, up to this
+    constexpr SpiceInt MaxCellSize = 1 << 24;
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    // True if SPICE failed because a cell was too small
+    bool CellOverflowed()
+    {
+        char szBuffer[SpiceLongMessageMaxLength];
+        szBuffer[0] = '\0';
+        getmsg_c("SHORT", sizeof(szBuffer), szBuffer);
+
+        return
+            !SpiceStringCompare(szBuffer, "SPICE(SETEXCESS)") ||
+            !SpiceStringCompare(szBuffer, "SPICE(WINDOWEXCESS)") ||
+            !SpiceStringCompare(szBuffer, "SPICE(CELLTOOSMALL)");
+    }
+
+    // spkobj_c, ckobj_c, pckfrm_c
+    bool ScanIds(TArray<SpiceInt>& Ids, TFunctionRef<void(SpiceCell* _ids)> Objects)
+    {
+        TArray<SpiceInt> Storage;
+        for (SpiceInt Size = 64; ; Size *= 4)
+        {
+            Storage.SetNumUninitialized(SPICE_CELL_CTRLSZ + Size);
+
+            // As SPICEINT_CELL, on the heap
+            SpiceCell _ids;
+            _ids.dtype = SPICE_INT;
+            _ids.length = 0;
+            _ids.size = Size;
+            _ids.card = 0;
+            _ids.isSet = SPICETRUE;
+            _ids.adjust = SPICEFALSE;
+            _ids.init = SPICEFALSE;
+            _ids.base = (void*)Storage.GetData();
+            _ids.data = (void*)(Storage.GetData() + SPICE_CELL_CTRLSZ);
+
+            Objects(&_ids);
+
+            if (!failed_c())
+            {
+                Ids = TArray<SpiceInt>(Storage.GetData() + SPICE_CELL_CTRLSZ, card_c(&_ids));
+                return true;
+            }
+            if (!CellOverflowed() || Size >= MaxCellSize)
+            {
+                return false;
+            }
+            reset_c();
+        }
+    }
+
+    // spkcov_c, ckcov_c, pckcov_c
+    bool ScanCoverage(FSWindow& Window, TFunctionRef<void(SpiceCell* _cover)> Coverage)
+    {
+        FWindowCell Cell(Window, 32);
+        for (;;)
+        {
+            scard_c(0, Cell.Get());
+            Coverage(Cell.Get());
+
+            if (!failed_c())
+            {
+                return true;
+            }
+            if (!CellOverflowed() || Cell.Size() >= MaxCellSize)
+            {
+                return false;
+            }
+            reset_c();
+            Cell.Reserve(Cell.Size());
+        }
+    }
+}
+
+namespace MaxQ::Data
+{
+    FKernelCatalog::FKernelCatalog(int32 _MaxLoaded)
+        : MaxLoaded(FMath::Max(_MaxLoaded, 0))
+    {
+    }
+
+    FKernelCatalog::~FKernelCatalog()
+    {
+        UnloadAll();
+    }
+
+
+    bool FKernelCatalog::Add(const TArray<FString>& relativePaths, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        bool bSuccess = true;
+        for (const FString& relativePath : relativePaths)
+        {
+            const FString Path = toPath(relativePath);
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*Path);
+            if (!Stat.bIsValid)
+            {
+                bSuccess = Fail(FString::Printf(TEXT("FKernelCatalog: could not find %s"), *Path), ResultCode, ErrorMessage);
+                continue;
+            }
+
+            FFile* File = Files.FindByPredicate([&Path](const FFile& Other) { return Other.Path == Path; });
+            if (File && File->Size == Stat.FileSize && File->Timestamp == Stat.ModificationTime)
+            {
+                continue;
+            }
+
+            FFile Scanned;
+            Scanned.Path = Path;
+            Scanned.Size = Stat.FileSize;
+            Scanned.Timestamp = Stat.ModificationTime;
+            if (!Scan(Scanned, ResultCode, ErrorMessage))
+            {
+                bSuccess = false;
+                continue;
+            }
+
+            if (File)
+            {
+                Scanned.bLoaded = File->bLoaded;
+                Scanned.LastUsed = File->LastUsed;
+                *File = MoveTemp(Scanned);
+            }
+            else
+            {
+                Files.Add(MoveTemp(Scanned));
+            }
+        }
+
+        RebuildIndex();
+
+        if (bSuccess)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Success;
+            if (ErrorMessage) ErrorMessage->Empty();
+        }
+        return bSuccess;
+    }
+
+
+    bool FKernelCatalog::Scan(FFile& File, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        auto _file = StringCast<ANSICHAR>(*File.Path);
+
+        SpiceChar _arch[8];
+        SpiceChar _type[8];
+        getfat_c(_file.Get(), sizeof(_arch), sizeof(_type), _arch, _type);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        if (!FCStringAnsi::Strcmp(_arch, "DAF") && !FCStringAnsi::Strcmp(_type, "SPK"))
+        {
+            File.Type = EKernelCatalogType::SPK;
+        }
+        else if (!FCStringAnsi::Strcmp(_arch, "DAF") && !FCStringAnsi::Strcmp(_type, "CK"))
+        {
+            File.Type = EKernelCatalogType::CK;
+        }
+        else if (!FCStringAnsi::Strcmp(_arch, "DAF") && !FCStringAnsi::Strcmp(_type, "PCK"))
+        {
+            File.Type = EKernelCatalogType::PCK;
+        }
+        else
+        {
+            return Fail(FString::Printf(TEXT("FKernelCatalog: %s is not a binary SPK, CK or PCK (%s/%s)"), *File.Path, ANSI_TO_TCHAR(_arch), ANSI_TO_TCHAR(_type)), ResultCode, ErrorMessage);
+        }
+
+        TArray<SpiceInt> Ids;
+        ScanIds(Ids, [&](SpiceCell* _ids)
+        {
+            switch (File.Type)
+            {
+            case EKernelCatalogType::SPK: spkobj_c(_file.Get(), _ids); break;
+            case EKernelCatalogType::CK: ckobj_c(_file.Get(), _ids); break;
+            default: pckfrm_c(_file.Get(), _ids); break;
+            }
+        });
+
+        File.Objects.Reset(Ids.Num());
+        for (SpiceInt _id : Ids)
+        {
+            if (failed_c())
+            {
+                break;
+            }
+
+            FObjectCoverage& Object = File.Objects.AddDefaulted_GetRef();
+            Object.Id = _id;
+            ScanCoverage(Object.Window, [&](SpiceCell* _cover)
+            {
+                switch (File.Type)
+                {
+                case EKernelCatalogType::SPK: spkcov_c(_file.Get(), _id, _cover); break;
+                case EKernelCatalogType::CK: ckcov_c(_file.Get(), _id, SPICEFALSE, "INTERVAL", 0., "TDB", _cover); break;
+                default: pckcov_c(_file.Get(), _id, _cover); break;
+                }
+            });
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    void FKernelCatalog::RebuildIndex()
+    {
+        for (TMap<int32, TArray<int32>>& TypeIndex : Index)
+        {
+            TypeIndex.Reset();
+        }
+
+        for (int32 i = 0; i < Files.Num(); ++i)
+        {
+            for (const FObjectCoverage& Object : Files[i].Objects)
+            {
+                Index[(int32)Files[i].Type].FindOrAdd(Object.Id).Add(i);
+            }
+        }
+    }
+
+
+    bool FKernelCatalog::Save(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage) const
+    {
+        TArray<uint8> Bytes;
+        FMemoryWriter Ar(Bytes);
+
+        uint32 Magic = CatalogMagic;
+        int32 Version = CatalogVersion;
+        int32 Count = Files.Num();
+        Ar << Magic << Version << Count;
+
+        for (const FFile& File : Files)
+        {
+            FString Path = File.Path;
+            uint8 Type = (uint8)File.Type;
+            int64 Size = File.Size;
+            FDateTime Timestamp = File.Timestamp;
+            int32 NumObjects = File.Objects.Num();
+            Ar << Path << Type << Size << Timestamp << NumObjects;
+
+            for (const FObjectCoverage& Object : File.Objects)
+            {
+                int32 Id = Object.Id;
+                const TArrayView<const double> View = Object.Window.Endpoints();
+                TArray<double> Endpoints(View.GetData(), View.Num());
+                Ar << Id << Endpoints;
+            }
+        }
+
+        const FString Path = toPath(relativePath);
+        if (!FFileHelper::SaveArrayToFile(Bytes, *Path))
+        {
+            return Fail(FString::Printf(TEXT("FKernelCatalog: could not write %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FKernelCatalog::Load(const FString& relativePath, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        MAXQ_LLM_SCOPE();
+
+        const FString Path = toPath(relativePath);
+        TArray<uint8> Bytes;
+        if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+        {
+            return Fail(FString::Printf(TEXT("FKernelCatalog: could not read %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        FMemoryReader Ar(Bytes);
+        uint32 Magic = 0;
+        int32 Version = 0;
+        int32 Count = 0;
+        Ar << Magic << Version << Count;
+        if (Ar.IsError() || Magic != CatalogMagic || Version != CatalogVersion || Count < 0)
+        {
+            return Fail(FString::Printf(TEXT("FKernelCatalog: %s is not a kernel catalog, or is from another version"), *Path), ResultCode, ErrorMessage);
+        }
+
+        TArray<FFile> Loaded;
+        for (int32 i = 0; i < Count && !Ar.IsError(); ++i)
+        {
+            FFile& File = Loaded.AddDefaulted_GetRef();
+            uint8 Type = 0;
+            int32 NumObjects = 0;
+            Ar << File.Path << Type << File.Size << File.Timestamp << NumObjects;
+            File.Type = (EKernelCatalogType)FMath::Min(Type, (uint8)EKernelCatalogType::PCK);
+
+            for (int32 j = 0; j < NumObjects && !Ar.IsError(); ++j)
+            {
+                FObjectCoverage& Object = File.Objects.AddDefaulted_GetRef();
+                TArray<double> Endpoints;
+                Ar << Object.Id << Endpoints;
+                Object.Window.Reserve(Endpoints.Num() / 2);
+                for (int32 k = 0; k + 1 < Endpoints.Num(); k += 2)
+                {
+                    Object.Window.Insert(Endpoints[k], Endpoints[k + 1]);
+                }
+            }
+        }
+
+        if (Ar.IsError())
+        {
+            return Fail(FString::Printf(TEXT("FKernelCatalog: %s is truncated"), *Path), ResultCode, ErrorMessage);
+        }
+
+        // Whatever changed since, or isn't already catalogued, goes through Add
+        TArray<FString> Rescan;
+        for (FFile& File : Loaded)
+        {
+            const FFileStatData Stat = IFileManager::Get().GetStatData(*File.Path);
+            if (!Stat.bIsValid)
+            {
+                UE_LOG(LogSpice, Warning, TEXT("FKernelCatalog: %s is catalogued in %s, but no longer exists"), *File.Path, *Path);
+                continue;
+            }
+
+            FFile* Existing = Files.FindByPredicate([&File](const FFile& Other) { return Other.Path == File.Path; });
+            if (Stat.FileSize != File.Size || Stat.ModificationTime != File.Timestamp)
+            {
+                Rescan.Add(File.Path);
+            }
+            else if (Existing)
+            {
+                Existing->Objects = MoveTemp(File.Objects);
+                Existing->Size = File.Size;
+                Existing->Timestamp = File.Timestamp;
+                Existing->Type = File.Type;
+            }
+            else
+            {
+                Files.Add(MoveTemp(File));
+            }
+        }
+
+        RebuildIndex();
+
+        if (Rescan.Num() > 0)
+        {
+            UE_LOG(LogSpice, Log, TEXT("FKernelCatalog: rescanning %d changed kernels from %s"), Rescan.Num(), *Path);
+            return Add(Rescan, ResultCode, ErrorMessage);
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FKernelCatalog::Ensure(EKernelCatalogType Type, int Id, double et, bool* bCovered, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (bCovered) *bCovered = false;
+
+        if (const TArray<int32>* Candidates = Index[(int32)Type].Find(Id))
+        {
+            SyncLoaded();
+
+            // The last added wins
+            for (int32 i = Candidates->Num() - 1; i >= 0; --i)
+            {
+                const int32 FileIndex = (*Candidates)[i];
+                FFile& File = Files[FileIndex];
+
+                const FObjectCoverage* Object = File.Objects.FindByPredicate([Id](const FObjectCoverage& Other) { return Other.Id == Id; });
+                if (!Object || !Object->Window.Contains(et))
+                {
+                    continue;
+                }
+
+                if (bCovered) *bCovered = true;
+                File.LastUsed = ++UseCount;
+
+                if (!File.bLoaded)
+                {
+                    if (!Furnsh(File.Path, ResultCode, ErrorMessage))
+                    {
+                        return false;
+                    }
+                    File.bLoaded = true;
+                    KernelGeneration = GetKernelHistoryGeneration();
+
+                    if (!Evict(FileIndex, ResultCode, ErrorMessage))
+                    {
+                        return false;
+                    }
+                }
+                break;
+            }
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FKernelCatalog::Evict(int32 Keep, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (MaxLoaded <= 0)
+        {
+            return true;
+        }
+
+        for (int32 Loaded = NumLoaded(); Loaded > MaxLoaded; --Loaded)
+        {
+            int32 Coldest = INDEX_NONE;
+            for (int32 i = 0; i < Files.Num(); ++i)
+            {
+                if (Files[i].bLoaded && i != Keep && (Coldest == INDEX_NONE || Files[i].LastUsed < Files[Coldest].LastUsed))
+                {
+                    Coldest = i;
+                }
+            }
+
+            if (Coldest == INDEX_NONE)
+            {
+                break;
+            }
+
+            Files[Coldest].bLoaded = false;
+            if (!Unload(Files[Coldest].Path, ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+        }
+
+        KernelGeneration = GetKernelHistoryGeneration();
+        return true;
+    }
+
+
+    void FKernelCatalog::SyncLoaded()
+    {
+        const uint64 Generation = GetKernelHistoryGeneration();
+        if (Generation == KernelGeneration)
+        {
+            return;
+        }
+        KernelGeneration = Generation;
+
+        for (FFile& File : Files)
+        {
+            if (File.bLoaded)
+            {
+                SpiceChar _filtyp[8];
+                SpiceChar _source[8];
+                SpiceInt _handle = 0;
+                SpiceBoolean _found = SPICEFALSE;
+                kinfo_c(StringCast<ANSICHAR>(*File.Path).Get(), sizeof(_filtyp), sizeof(_source), _filtyp, _source, &_handle, &_found);
+                File.bLoaded = _found != SPICEFALSE;
+            }
+        }
+    }
+
+
+    FSWindow FKernelCatalog::Coverage(EKernelCatalogType Type, int Id) const
+    {
+        FSWindow Result;
+        if (const TArray<int32>* Candidates = Index[(int32)Type].Find(Id))
+        {
+            for (int32 FileIndex : *Candidates)
+            {
+                for (const FObjectCoverage& Object : Files[FileIndex].Objects)
+                {
+                    if (Object.Id == Id)
+                    {
+                        Result = Result | Object.Window;
+                    }
+                }
+            }
+        }
+        return Result;
+    }
+
+
+    void FKernelCatalog::SetMaxLoaded(int32 _MaxLoaded)
+    {
+        MaxLoaded = FMath::Max(_MaxLoaded, 0);
+        SyncLoaded();
+        Evict(INDEX_NONE, nullptr, nullptr);
+    }
+
+
+    int32 FKernelCatalog::NumLoaded() const
+    {
+        int32 Count = 0;
+        for (const FFile& File : Files)
+        {
+            Count += File.bLoaded ? 1 : 0;
+        }
+        return Count;
+    }
+
+
+    bool FKernelCatalog::IsLoaded(const FString& relativePath) const
+    {
+        const FString Path = toPath(relativePath);
+        const FFile* File = Files.FindByPredicate([&Path](const FFile& Other) { return Other.Path == Path; });
+        return File && File->bLoaded;
+    }
+
+
+    void FKernelCatalog::UnloadAll()
+    {
+        SyncLoaded();
+        for (FFile& File : Files)
+        {
+            if (File.bLoaded)
+            {
+                File.bLoaded = false;
+                Unload(File.Path);
+            }
+        }
+        KernelGeneration = GetKernelHistoryGeneration();
+    }
+}
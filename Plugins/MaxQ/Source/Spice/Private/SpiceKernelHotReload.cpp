@@ -0,0 +1,310 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelHotReload.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Reload kernels that change on disk, without a clear_all.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelHotReload.cpp is part of the "refined C++ API".
+//
+// The load order comes from CSPICE's own kernel table (kdata "ALL"), so
+// kernels furnsh'd any way at all (USpice::furnsh, meta-kernels, etc) are
+// reloaded in the right place.  Reloads go through MaxQ::Data::Furnsh and
+// Unload, so the kernel history sees them.
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelHotReload.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+#if WITH_EDITOR
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
+#include "Modules/ModuleManager.h"
+#endif
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    struct FLoadedKernel
+    {
+        FString Path;
+        ES_KernelType Type = ES_KernelType::NONE;
+        // The meta-kernel that loaded it, if any
+        FString Source;
+    };
+
+    ES_KernelType ToKernelType(ConstSpiceChar* _filtyp)
+    {
+        static const TPair<const ANSICHAR*, ES_KernelType> Types[] {
+            { "SPK", ES_KernelType::SPK },
+            { "CK", ES_KernelType::CK },
+            { "PCK", ES_KernelType::PCK },
+            { "DSK", ES_KernelType::DSK },
+            { "EK", ES_KernelType::EK },
+            { "TEXT", ES_KernelType::TEXT },
+            { "META", ES_KernelType::META }
+        };
+
+        for (const auto& [Name, Type] : Types)
+        {
+            if (!SpiceStringCompare(_filtyp, Name))
+            {
+                return Type;
+            }
+        }
+        return ES_KernelType::NONE;
+    }
+
+    void GetLoadedKernels(TArray<FLoadedKernel>& Kernels)
+    {
+        ConstSpiceChar* _kinds = "ALL";
+        SpiceInt _count = 0;
+        ktotal_c(_kinds, &_count);
+
+        for (SpiceInt i = 0; i < _count && !failed_c(); ++i)
+        {
+            SpiceChar _file[SPICE_MAX_PATH];
+            SpiceChar _filtyp[32];
+            SpiceChar _source[SPICE_MAX_PATH];
+            SpiceInt _handle = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            kdata_c(i, _kinds, sizeof(_file), sizeof(_filtyp), sizeof(_source), _file, _filtyp, _source, &_handle, &_found);
+            if (_found)
+            {
+                Kernels.Add(FLoadedKernel{ FString(_file), ToKernelType(_filtyp), FString(_source) });
+            }
+        }
+    }
+}
+
+namespace MaxQ::Data
+{
+    FKernelHotReload::FKernelHotReload(const FString& relativeDirectory)
+        : Directory(relativeDirectory.IsEmpty() ? FString() : toPath(relativeDirectory))
+    {
+        FPaths::NormalizeDirectoryName(Directory);
+        StampLoaded();
+        UnexpectedErrorCheck(true);
+
+#if WITH_EDITOR
+        if (!Directory.IsEmpty())
+        {
+            FDirectoryWatcherModule& Module = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+            if (IDirectoryWatcher* Watcher = Module.Get())
+            {
+                Watcher->RegisterDirectoryChangedCallback_Handle(
+                    Directory,
+                    IDirectoryWatcher::FDirectoryChanged::CreateLambda([this](const TArray<FFileChangeData>&) { Poll(); }),
+                    WatcherHandle
+                );
+            }
+        }
+#endif
+    }
+
+
+    FKernelHotReload::~FKernelHotReload()
+    {
+#if WITH_EDITOR
+        if (WatcherHandle.IsValid())
+        {
+            if (FDirectoryWatcherModule* Module = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")))
+            {
+                if (IDirectoryWatcher* Watcher = Module->Get())
+                {
+                    Watcher->UnregisterDirectoryChangedCallback_Handle(Directory, WatcherHandle);
+                }
+            }
+        }
+#endif
+    }
+
+
+    bool FKernelHotReload::Poll(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        TArray<FLoadedKernel> Kernels;
+        GetLoadedKernels(Kernels);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        FKernelReload Reload;
+
+        // Top level files (those not loaded by a meta-kernel), in load order,
+        // with the kinds of kernel each brought in
+        TArray<FString> TopLevel;
+        TMap<FString, ES_KernelType> Kinds;
+        TSet<FString> ChangedTopLevel;
+        TSet<FString> Missing;
+
+        for (const FLoadedKernel& Kernel : Kernels)
+        {
+            const FString& Top = Kernel.Source.IsEmpty() ? Kernel.Path : Kernel.Source;
+            if (Kernel.Source.IsEmpty())
+            {
+                TopLevel.Add(Kernel.Path);
+            }
+            if (Kernel.Type != ES_KernelType::META)
+            {
+                Kinds.FindOrAdd(Top) |= Kernel.Type;
+            }
+
+            const FStamp* Stamp = Stamps.Find(Kernel.Path);
+            if (Stamp)
+            {
+                const FStamp Current = ReadStamp(Kernel.Path);
+                if (!(Current == *Stamp))
+                {
+                    Reload.Changed.Add(Kernel.Path);
+                    ChangedTopLevel.Add(Top);
+                    Stamps.Remove(Kernel.Path);
+                    if (Current.Size < 0 && Kernel.Source.IsEmpty())
+                    {
+                        Missing.Add(Kernel.Path);
+                    }
+                }
+            }
+        }
+
+        // From the first changed file on, everything that competes with a
+        // reloaded file for precedence is reloaded too
+        TArray<FString> ToReload;
+        for (const FString& Path : TopLevel)
+        {
+            const ES_KernelType PathKinds = Kinds.FindRef(Path);
+            if (ChangedTopLevel.Contains(Path) || EnumHasAnyFlags(Reload.Kinds, PathKinds))
+            {
+                ToReload.Add(Path);
+                Reload.Kinds |= PathKinds;
+            }
+        }
+
+        bool bSuccess = true;
+        for (int32 i = ToReload.Num() - 1; i >= 0; --i)
+        {
+            bSuccess &= Unload(ToReload[i], ResultCode, ErrorMessage);
+        }
+
+        for (const FString& Path : ToReload)
+        {
+            if (Missing.Contains(Path))
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ SPICE hot reload:  %s is gone, and stays unloaded"), *Path);
+                continue;
+            }
+
+            if (Furnsh(Path, ResultCode, ErrorMessage))
+            {
+                Reload.Reloaded.Add(Path);
+            }
+            else
+            {
+                // Likely still being written.  Retried when it changes again.
+                Pending.Add(Path, ReadStamp(Path));
+                bSuccess = false;
+            }
+        }
+
+        // Files that failed before, and have changed since (these can't get
+        // their old place back, so they load last)
+        for (auto It = Pending.CreateIterator(); It; ++It)
+        {
+            if (ToReload.Contains(It.Key()) || ReadStamp(It.Key()) == It.Value())
+            {
+                continue;
+            }
+
+            Reload.Changed.AddUnique(It.Key());
+            if (Furnsh(It.Key(), ResultCode, ErrorMessage))
+            {
+                Reload.Reloaded.Add(It.Key());
+                It.RemoveCurrent();
+            }
+            else
+            {
+                It.Value() = ReadStamp(It.Key());
+                bSuccess = false;
+            }
+        }
+
+        for (const FString& Path : Reload.Reloaded)
+        {
+            Pending.Remove(Path);
+        }
+
+        StampLoaded();
+
+        if (Reload.Reloaded.Num() > 0 || Reload.Changed.Num() > 0)
+        {
+            UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE hot reload:  %d changed, %d reloaded (%s)"), Reload.Changed.Num(), Reload.Reloaded.Num(), *MaxQ::Core::ToString(Reload.Kinds));
+            KernelsReloaded.Broadcast(Reload);
+        }
+
+        if (bSuccess)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Success;
+            if (ErrorMessage) ErrorMessage->Empty();
+        }
+        return bSuccess;
+    }
+
+
+    bool FKernelHotReload::IsWatched(const FString& Path) const
+    {
+        return Directory.IsEmpty() || FPaths::IsUnderDirectory(Path, Directory);
+    }
+
+
+    FKernelHotReload::FStamp FKernelHotReload::ReadStamp(const FString& Path) const
+    {
+        IFileManager& FileManager = IFileManager::Get();
+
+        FStamp Stamp;
+        Stamp.Size = FileManager.FileSize(*Path);
+        Stamp.Timestamp = FileManager.GetTimeStamp(*Path);
+        return Stamp;
+    }
+
+
+    void FKernelHotReload::StampLoaded()
+    {
+        TArray<FLoadedKernel> Kernels;
+        GetLoadedKernels(Kernels);
+
+        // (Files unloaded since are dropped)
+        TMap<FString, FStamp> Loaded;
+        for (const FLoadedKernel& Kernel : Kernels)
+        {
+            if (IsWatched(Kernel.Path))
+            {
+                const FStamp* Stamp = Stamps.Find(Kernel.Path);
+                Loaded.Add(Kernel.Path, Stamp ? *Stamp : ReadStamp(Kernel.Path));
+            }
+        }
+        Stamps = MoveTemp(Loaded);
+    }
+}
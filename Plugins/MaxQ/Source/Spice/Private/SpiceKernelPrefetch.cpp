@@ -0,0 +1,234 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelPrefetch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Binary kernel pages made resident ahead of playback.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelPrefetch.cpp is part of the "refined C++ API".
+//
+// Each Update's ranges are merged per file before they're handed over, so
+// a span crossing many small segments is one hint (or one read), not one
+// per segment.
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelPrefetch.h"
+#include "SpiceData.h"
+#include "SpiceMemory.h"
+
+using MaxQ::GeometryFinder::FSWindow;
+
+namespace
+{
+    // DAF records are 128 doubles
+    constexpr int64 DafRecordBytes = 1024;
+
+    // Directories, epochs, trailers...  at the end of a segment
+    constexpr int64 TailBytes = 16 * DafRecordBytes;
+
+    // Ranges this close together are read as one
+    constexpr int64 MergeGapBytes = 64 * 1024;
+
+    typedef TPair<int64, int64> FByteRange;
+
+    void AddTail(const MaxQ::Data::FCoverageSegment& Segment, TArray<FByteRange>& Ranges)
+    {
+        const int64 First = int64(Segment.Begin - 1) * 8;
+        const int64 Last = int64(Segment.End) * 8;
+        Ranges.Emplace(FMath::Max(First, Last - TailBytes), Last);
+    }
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API bool GetSegmentRecordRange(const FCoverageSegment& Segment, double Start, double Stop, int64& Offset, int64& Bytes)
+    {
+        Offset = Bytes = 0;
+
+        const double Lo = FMath::Max(Start, Segment.Start);
+        const double Hi = FMath::Min(Stop, Segment.Stop);
+        if (Segment.Begin <= 0 || Segment.End < Segment.Begin || Lo > Hi)
+        {
+            return false;
+        }
+
+        const int64 First = int64(Segment.Begin - 1) * 8;
+        const int64 Last = int64(Segment.End) * 8;
+        const double Length = Segment.Stop - Segment.Start;
+
+        double f0 = 0., f1 = 1.;
+        if (Length > 0.)
+        {
+            f0 = (Lo - Segment.Start) / Length;
+            f1 = (Hi - Segment.Start) / Length;
+        }
+
+        const int64 From = FMath::Max(First, First + int64(f0 * (Last - First)) - DafRecordBytes);
+        const int64 To = FMath::Min(Last, First + int64(FMath::CeilToDouble(f1 * (Last - First))) + DafRecordBytes);
+
+        Offset = From;
+        Bytes = To - From;
+        return Bytes > 0;
+    }
+
+
+    void FKernelPagePrefetcher::Configure(
+        const FKernelCoverageIndex& Index,
+        const TArray<int>& SpkBodies,
+        const TArray<int>& CkIds,
+        const TArray<int>& PckFrames,
+        const FKernelPrefetchSettings& _Settings
+    )
+    {
+        Reset();
+        Settings = _Settings;
+
+        // Bodies' states are chained through their centers
+        TArray<int> Spk = SpkBodies;
+        for (int32 i = 0; i < Spk.Num(); ++i)
+        {
+            for (const FCoverageSegment* Segment : Index.Segments(EKernelCoverageType::SPK, Spk[i]))
+            {
+                Spk.AddUnique(Segment->Center);
+            }
+        }
+
+        TMap<int32, int32> FileMap;
+        auto AddObject = [&](EKernelCoverageType Type, int Id)
+        {
+            // Highest priority first, each masking what it serves
+            const TArray<const FCoverageSegment*> ObjectSegments = Index.Segments(Type, Id);
+            FSWindow Masked;
+            for (int32 i = ObjectSegments.Num() - 1; i >= 0; --i)
+            {
+                const FCoverageSegment& Segment = *ObjectSegments[i];
+                const FSWindow Coverage(Segment.Start, Segment.Stop);
+                FSWindow Serves = Coverage - Masked;
+                Masked = Masked | Coverage;
+                if (Serves.IsEmpty() || Segment.Begin <= 0)
+                {
+                    continue;
+                }
+
+                int32* File = FileMap.Find(Segment.File);
+                if (!File)
+                {
+                    File = &FileMap.Add(Segment.File, Paths.Add(Index.FilePath(Segment.File)));
+                }
+
+                FPrefetchSegment& Prefetch = Segments.AddDefaulted_GetRef();
+                Prefetch.File = *File;
+                Prefetch.Segment = Segment;
+                Prefetch.Serves = MoveTemp(Serves);
+            }
+        };
+
+        for (int Id : Spk)
+        {
+            AddObject(EKernelCoverageType::SPK, Id);
+        }
+        for (int Id : CkIds)
+        {
+            AddObject(EKernelCoverageType::CK, Id);
+        }
+        for (int Id : PckFrames)
+        {
+            AddObject(EKernelCoverageType::PCK, Id);
+        }
+    }
+
+
+    void FKernelPagePrefetcher::Reset()
+    {
+        Paths.Reset();
+        Segments.Reset();
+        Done.Reset();
+        TotalBytes = 0;
+    }
+
+
+    int64 FKernelPagePrefetcher::Update(const FSEphemerisTime& et, double Rate)
+    {
+        MAXQ_LLM_SCOPE();
+
+        const double _et = et.AsSpiceDouble();
+        const double Span = FMath::Clamp(FMath::Abs(Rate) * Settings.LookaheadSeconds, Settings.MinSpanSeconds, FMath::Max(Settings.MinSpanSeconds, Settings.MaxSpanSeconds));
+        const FSWindow Ahead = Rate < 0. ? FSWindow(_et - Span, _et) : FSWindow(_et, _et + Span);
+
+        const FSWindow New = Ahead - Done;
+        // What's behind playback is forgotten, so a jump (or a reversal)
+        // starts over
+        Done = (Done | Ahead) & FSWindow(_et - Span, _et + Span);
+        if (New.IsEmpty())
+        {
+            return 0;
+        }
+
+        TArray<TArray<FByteRange>> Ranges;
+        Ranges.SetNum(Paths.Num());
+        for (FPrefetchSegment& Prefetch : Segments)
+        {
+            const FSWindow Pieces = New & Prefetch.Serves;
+            for (int32 i = 0; i < Pieces.Num(); ++i)
+            {
+                int64 Offset, Bytes;
+                if (GetSegmentRecordRange(Prefetch.Segment, Pieces.Start(i), Pieces.Stop(i), Offset, Bytes))
+                {
+                    Ranges[Prefetch.File].Emplace(Offset, Offset + Bytes);
+                }
+            }
+
+            if (!Pieces.IsEmpty() && !Prefetch.bTailDone)
+            {
+                AddTail(Prefetch.Segment, Ranges[Prefetch.File]);
+                Prefetch.bTailDone = true;
+            }
+        }
+
+        int64 Total = 0;
+        for (int32 File = 0; File < Ranges.Num(); ++File)
+        {
+            TArray<FByteRange>& FileRanges = Ranges[File];
+            if (FileRanges.IsEmpty())
+            {
+                continue;
+            }
+
+            FileRanges.Sort([](const FByteRange& A, const FByteRange& B) { return A.Key < B.Key; });
+            FByteRange Merged = FileRanges[0];
+            for (int32 i = 1; i <= FileRanges.Num(); ++i)
+            {
+                if (i < FileRanges.Num() && FileRanges[i].Key <= Merged.Value + MergeGapBytes)
+                {
+                    Merged.Value = FMath::Max(Merged.Value, FileRanges[i].Value);
+                    continue;
+                }
+
+                if (PrefetchKernelRange(Paths[File], Merged.Key, Merged.Value - Merged.Key))
+                {
+                    Total += Merged.Value - Merged.Key;
+                }
+                if (i < FileRanges.Num())
+                {
+                    Merged = FileRanges[i];
+                }
+            }
+        }
+
+        TotalBytes += Total;
+        return Total;
+    }
+}
@@ -0,0 +1,352 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelPreprocess.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Getting kernels into the form that loads fastest, before they
+// ship.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelPreprocess.cpp is part of the "refined C++ API".
+//
+// The conversions are the toolkit's own (daftb/dastb, as tobin, and dafbt,
+// as toxfr), on Fortran logical units from txtopr/txtopn.  Outputs are
+// written beside their destination and moved into place, so a failure never
+// leaves half a kernel behind.
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelPreprocess.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "SpiceLock.h"
+#include "SpicePoolSnapshot.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+
+// for txtopr_, txtopn_, daftb_, dastb_, dafbt_
+#include "SpiceZfc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    bool Succeed(ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+    // The file record's binary format label (SPICE's "BFF" string)
+    constexpr int32 DafFormatOffset = 88;
+    constexpr int32 DasFormatOffset = 84;
+    constexpr int32 FormatLength = 8;
+
+    const TCHAR* NativeFormat()
+    {
+        return PLATFORM_LITTLE_ENDIAN ? TEXT("LTL-IEEE") : TEXT("BIG-IEEE");
+    }
+
+    FString TempPathFor(const FString& Path)
+    {
+        return FString::Printf(TEXT("%s.%u.tmp"), *Path, FPlatformProcess::GetCurrentProcessId());
+    }
+
+    // Transfer file -> binary file, both absolute.  Path must not exist.
+    void TransferToBinary(const FString& TransferPath, const FString& BinaryPath, bool bDas)
+    {
+        auto _xfr = StringCast<ANSICHAR>(*TransferPath);
+        auto _bin = StringCast<ANSICHAR>(*BinaryPath);
+
+        integer _unit = 0;
+        txtopr_((char*)_xfr.Get(), &_unit, (ftnlen)_xfr.Length());
+        if (failed_c())
+        {
+            return;
+        }
+
+        if (bDas)
+        {
+            dastb_(&_unit, (char*)_bin.Get(), (ftnlen)_bin.Length());
+        }
+        else
+        {
+            daftb_(&_unit, (char*)_bin.Get(), (ftnlen)_bin.Length());
+        }
+
+        ftncls_c(_unit);
+    }
+
+    // Binary DAF -> transfer file, both absolute.  Path must not exist.
+    void DafToTransfer(const FString& BinaryPath, const FString& TransferPath)
+    {
+        auto _bin = StringCast<ANSICHAR>(*BinaryPath);
+        auto _xfr = StringCast<ANSICHAR>(*TransferPath);
+
+        integer _unit = 0;
+        txtopn_((char*)_xfr.Get(), &_unit, (ftnlen)_xfr.Length());
+        if (failed_c())
+        {
+            return;
+        }
+
+        dafbt_((char*)_bin.Get(), &_unit, (ftnlen)_bin.Length());
+        ftncls_c(_unit);
+    }
+
+    bool MoveIntoPlace(const FString& TempPath, const FString& Path, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (!IFileManager::Get().Move(*Path, *TempPath, true, true))
+        {
+            IFileManager::Get().Delete(*TempPath, false, false, true);
+            return Fail(FString::Printf(TEXT("Could not replace %s"), *Path), ResultCode, ErrorMessage);
+        }
+        return Succeed(ResultCode, ErrorMessage);
+    }
+}
+
+namespace MaxQ::Data
+{
+    bool FKernelFormat::IsNative() const
+    {
+        return IsBinary() && (BinaryFormat.IsEmpty() || BinaryFormat == NativeFormat());
+    }
+
+
+    SPICE_API bool GetKernelFormat(const FString& relativePath, FKernelFormat& Format, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        const FString Path = toPath(relativePath);
+        Format = FKernelFormat();
+
+        {
+            MaxQ::Core::FSpiceScope Scope;
+
+            SpiceChar _arch[8];
+            SpiceChar _type[8];
+            getfat_c(TCHAR_TO_ANSI(*Path), sizeof(_arch), sizeof(_type), _arch, _type);
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+            Format.Architecture = _arch;
+            Format.Type = _type;
+        }
+
+        if (Format.IsBinary())
+        {
+            TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path, FILEREAD_Silent));
+            const int32 Offset = Format.Architecture == TEXT("DAF") ? DafFormatOffset : DasFormatOffset;
+            if (!Reader || Reader->TotalSize() < Offset + FormatLength)
+            {
+                return Fail(FString::Printf(TEXT("GetKernelFormat: could not read %s's file record"), *Path), ResultCode, ErrorMessage);
+            }
+
+            ANSICHAR Label[FormatLength + 1] = {};
+            Reader->Seek(Offset);
+            Reader->Serialize(Label, FormatLength);
+            Format.BinaryFormat = FString(ANSI_TO_TCHAR(Label)).TrimStartAndEnd();
+
+            // Files from before the label have blanks (or nulls) there
+            if (Format.BinaryFormat != TEXT("LTL-IEEE") && Format.BinaryFormat != TEXT("BIG-IEEE"))
+            {
+                Format.BinaryFormat.Empty();
+            }
+        }
+
+        return Succeed(ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API bool ConvertTransferKernel(const FString& relativeSource, const FString& relativeDestination, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        FKernelFormat Format;
+        if (!GetKernelFormat(relativeSource, Format, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        if (!Format.IsTransfer())
+        {
+            return Fail(FString::Printf(TEXT("ConvertTransferKernel: %s is not a transfer file (%s/%s)"), *relativeSource, *Format.Architecture, *Format.Type), ResultCode, ErrorMessage);
+        }
+
+        const FString Destination = toPath(relativeDestination);
+        const FString TempPath = TempPathFor(Destination);
+        IFileManager::Get().Delete(*TempPath, false, false, true);
+
+        {
+            MaxQ::Core::FSpiceScope Scope;
+
+            TransferToBinary(toPath(relativeSource), TempPath, Format.Type == TEXT("DAS"));
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                IFileManager::Get().Delete(*TempPath, false, false, true);
+                return false;
+            }
+        }
+
+        return MoveIntoPlace(TempPath, Destination, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API bool ConvertDafToNative(const FString& relativeSource, const FString& relativeDestination, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        FKernelFormat Format;
+        if (!GetKernelFormat(relativeSource, Format, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        if (Format.Architecture != TEXT("DAF"))
+        {
+            return Fail(FString::Printf(TEXT("ConvertDafToNative: %s is not a binary DAF (%s/%s)"), *relativeSource, *Format.Architecture, *Format.Type), ResultCode, ErrorMessage);
+        }
+
+        const FString Destination = toPath(relativeDestination);
+        const FString TransferPath = TempPathFor(FPaths::Combine(SavedPath(TEXT("Preprocess")), FPaths::GetCleanFilename(Destination) + TEXT(".xfr")));
+        const FString TempPath = TempPathFor(Destination);
+        IFileManager::Get().MakeDirectory(*FPaths::GetPath(TransferPath), true);
+        IFileManager::Get().Delete(*TransferPath, false, false, true);
+        IFileManager::Get().Delete(*TempPath, false, false, true);
+
+        {
+            MaxQ::Core::FSpiceScope Scope;
+
+            DafToTransfer(toPath(relativeSource), TransferPath);
+            if (!failed_c())
+            {
+                TransferToBinary(TransferPath, TempPath, false);
+            }
+
+            IFileManager::Get().Delete(*TransferPath, false, false, true);
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                IFileManager::Get().Delete(*TempPath, false, false, true);
+                return false;
+            }
+        }
+
+        return MoveIntoPlace(TempPath, Destination, ResultCode, ErrorMessage);
+    }
+}
+
+
+UMaxQPreprocessKernelsCommandlet::UMaxQPreprocessKernelsCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+
+int32 UMaxQPreprocessKernelsCommandlet::Main(const FString& Params)
+{
+    using namespace MaxQ::Data;
+
+    FString Directory = TEXT("NonAssetData/kernels");
+    FParse::Value(*Params, TEXT("Dir="), Directory);
+
+    int32 Converted = 0;
+    int32 Failures = 0;
+
+    TArray<FString> Files;
+    IFileManager::Get().FindFilesRecursive(Files, *toPath(Directory), TEXT("*"), true, false);
+    Files.Sort();
+
+    for (const FString& File : Files)
+    {
+        FKernelFormat Format;
+        if (!GetKernelFormat(File, Format) || !(Format.IsTransfer() || Format.IsBinary()))
+        {
+            // Text kernels, and files that aren't kernels
+            continue;
+        }
+
+        FString ErrorMessage;
+        if (Format.IsTransfer())
+        {
+            const FString Extension = FPaths::GetExtension(File);
+            if (!Extension.StartsWith(TEXT("x"), ESearchCase::IgnoreCase))
+            {
+                UE_LOG(LogSpice, Error, TEXT("MaxQPreprocessKernels: %s is a transfer file, but its extension doesn't say what to call the binary"), *File);
+                ++Failures;
+                continue;
+            }
+
+            const FString Destination = FPaths::ChangeExtension(File, TEXT("b") + Extension.Mid(1));
+            if (ConvertTransferKernel(File, Destination, nullptr, &ErrorMessage))
+            {
+                UE_LOG(LogSpice, Display, TEXT("MaxQPreprocessKernels: %s -> %s"), *File, *Destination);
+                ++Converted;
+            }
+            else
+            {
+                UE_LOG(LogSpice, Error, TEXT("MaxQPreprocessKernels: %s"), *ErrorMessage);
+                ++Failures;
+            }
+        }
+        else if (!Format.IsNative())
+        {
+            if (Format.Architecture != TEXT("DAF"))
+            {
+                UE_LOG(LogSpice, Error, TEXT("MaxQPreprocessKernels: %s is a %s DAS, which CSPICE can't read here"), *File, *Format.BinaryFormat);
+                ++Failures;
+            }
+            else if (ConvertDafToNative(File, File, nullptr, &ErrorMessage))
+            {
+                UE_LOG(LogSpice, Display, TEXT("MaxQPreprocessKernels: %s %s -> %s"), *File, *Format.BinaryFormat, NativeFormat());
+                ++Converted;
+            }
+            else
+            {
+                UE_LOG(LogSpice, Error, TEXT("MaxQPreprocessKernels: %s"), *ErrorMessage);
+                ++Failures;
+            }
+        }
+    }
+
+    FString Text, Snapshot;
+    if (FParse::Value(*Params, TEXT("Text="), Text, false) && FParse::Value(*Params, TEXT("Snapshot="), Snapshot))
+    {
+        TArray<FString> TextKernels;
+        Text.ParseIntoArray(TextKernels, TEXT(","));
+
+        FString ErrorMessage;
+        if (BakePoolSnapshot(TextKernels, Snapshot, nullptr, &ErrorMessage))
+        {
+            ++Converted;
+        }
+        else
+        {
+            UE_LOG(LogSpice, Error, TEXT("MaxQPreprocessKernels: %s"), *ErrorMessage);
+            ++Failures;
+        }
+    }
+
+    UE_LOG(LogSpice, Display, TEXT("MaxQPreprocessKernels: %d files checked, %d converted, %d failed"), Files.Num(), Converted, Failures);
+    return Failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,399 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelSubset.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Slim kernels for shipping, cut from bigger ones.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelSubset.cpp is part of the "refined C++ API".
+//
+// CSPICE has no C wrappers for writing arbitrary DAF arrays, so whole
+// segments are copied with the f2c'd DAF writer (dafonw_, dafbna_, dafada_,
+// dafena_).  dafena_ fills in the new segment's addresses, so the source's
+// summary can be reused as is.
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelSubset.h"
+#include "SpiceUtilities.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+
+// for dafonw_, dafbna_, dafada_, dafena_
+#include "SpiceZfc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    enum class EKernelType : uint8
+    {
+        SPK,
+        CK,
+        PCK
+    };
+
+    struct FSourceSegment
+    {
+        // ND + (NI + 1) / 2 doubles, for every type here
+        SpiceDouble Sum[5];
+        // 8 * (ND + (NI + 1) / 2) characters, plus the terminator
+        SpiceChar Name[41];
+
+        // TDB
+        double Start = 0.;
+        double Stop = 0.;
+        int32 Id = 0;
+        int32 Center = 0;
+        int32 DataType = 0;
+        // DAF addresses of the segment's data
+        int32 Begin = 0;
+        int32 End = 0;
+    };
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    // The SPK types spksub can subset.  Others are copied whole.
+    bool CanSubset(int32 DataType)
+    {
+        switch (DataType)
+        {
+        case 1: case 2: case 3: case 5: case 8: case 9: case 10: case 12:
+        case 13: case 14: case 15: case 17: case 18: case 19: case 20: case 21:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void ReadSegments(SpiceInt _handle, EKernelType Type, TArray<FSourceSegment>& Segments)
+    {
+        const SpiceInt _ni = Type == EKernelType::PCK ? 5 : 6;
+
+        SpiceBoolean _found = SPICEFALSE;
+        dafbfs_c(_handle);
+        daffna_c(&_found);
+        while (_found && !failed_c())
+        {
+            FSourceSegment& Segment = Segments.AddDefaulted_GetRef();
+            FMemory::Memzero(Segment.Sum);
+            dafgs_c(Segment.Sum);
+            dafgn_c(sizeof(Segment.Name), Segment.Name);
+
+            SpiceDouble _dc[2];
+            SpiceInt _ic[6];
+            dafus_c(Segment.Sum, 2, _ni, _dc, _ic);
+
+            Segment.Start = _dc[0];
+            Segment.Stop = _dc[1];
+            Segment.Id = _ic[0];
+            switch (Type)
+            {
+            case EKernelType::SPK:
+                Segment.Center = _ic[1];
+                Segment.DataType = _ic[3];
+                break;
+            case EKernelType::CK:
+                Segment.DataType = _ic[2];
+                break;
+            case EKernelType::PCK:
+                Segment.DataType = _ic[2];
+                break;
+            }
+            Segment.Begin = _ic[_ni - 2];
+            Segment.End = _ic[_ni - 1];
+
+            daffna_c(&_found);
+        }
+
+        // CK segment bounds are in ticks
+        if (Type == EKernelType::CK)
+        {
+            for (FSourceSegment& Segment : Segments)
+            {
+                SpiceInt _sclk = 0;
+                ckmeta_c(Segment.Id, "SCLK", &_sclk);
+                sct2e_c(_sclk, Segment.Start, &Segment.Start);
+                sct2e_c(_sclk, Segment.Stop, &Segment.Stop);
+            }
+        }
+    }
+
+    // The segment's data, whole, into the DAF open for write
+    void CopySegment(SpiceInt _source, SpiceInt _destination, FSourceSegment& Segment)
+    {
+        integer _handle = _destination;
+        SpiceChar* _name = Segment.Name;
+        ftnlen _namelen = (ftnlen)FCStringAnsi::Strlen(_name);
+        if (_namelen == 0)
+        {
+            _name = (SpiceChar*)" ";
+            _namelen = 1;
+        }
+
+        dafbna_(&_handle, Segment.Sum, _name, _namelen);
+
+        constexpr SpiceInt Chunk = 1024;
+        SpiceDouble _data[Chunk];
+        for (SpiceInt _begin = Segment.Begin; _begin <= Segment.End && !failed_c(); _begin += Chunk)
+        {
+            const SpiceInt _end = FMath::Min(_begin + Chunk - 1, (SpiceInt)Segment.End);
+            dafgda_c(_source, _begin, _end, _data);
+
+            integer _n = _end - _begin + 1;
+            dafada_(_data, &_n);
+        }
+
+        dafena_();
+    }
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API bool SubsetKernel(
+        const FString& sourcePath,
+        const FString& destinationPath,
+        const FKernelSubset& Subset,
+        int32* SegmentsWritten,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (SegmentsWritten) *SegmentsWritten = 0;
+
+        const FString Source = toPath(sourcePath);
+        const FString Destination = toPath(destinationPath);
+        if (FPaths::IsSamePath(Source, Destination))
+        {
+            return Fail(FString::Printf(TEXT("SubsetKernel: the destination is the source (%s)"), *Source), ResultCode, ErrorMessage);
+        }
+
+        auto _source = StringCast<ANSICHAR>(*Source);
+        auto _destination = StringCast<ANSICHAR>(*Destination);
+
+        SpiceChar _arch[8];
+        SpiceChar _type[8];
+        getfat_c(_source.Get(), sizeof(_arch), sizeof(_type), _arch, _type);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        EKernelType Type = EKernelType::SPK;
+        const TArray<int32>* Ids = &Subset.Bodies;
+        if (!SpiceStringCompare(_arch, "DAF") && !SpiceStringCompare(_type, "SPK"))
+        {
+            Type = EKernelType::SPK;
+        }
+        else if (!SpiceStringCompare(_arch, "DAF") && !SpiceStringCompare(_type, "CK"))
+        {
+            Type = EKernelType::CK;
+            Ids = &Subset.Instruments;
+        }
+        else if (!SpiceStringCompare(_arch, "DAF") && !SpiceStringCompare(_type, "PCK"))
+        {
+            Type = EKernelType::PCK;
+            Ids = &Subset.Frames;
+        }
+        else
+        {
+            return Fail(FString::Printf(TEXT("SubsetKernel: %s is not a binary SPK, CK or PCK (%s/%s)"), *Source, ANSI_TO_TCHAR(_arch), ANSI_TO_TCHAR(_type)), ResultCode, ErrorMessage);
+        }
+
+        SpiceInt _source_handle = 0;
+        dafopr_c(_source.Get(), &_source_handle);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        TArray<FSourceSegment> Segments;
+        ReadSegments(_source_handle, Type, Segments);
+
+        // What's in the window and wanted
+        TSet<int32> Wanted;
+        Wanted.Append(*Ids);
+        auto InWindow = [&Subset](const FSourceSegment& Segment)
+        {
+            return FMath::Max(Segment.Start, Subset.Start) < FMath::Min(Segment.Stop, Subset.Stop);
+        };
+
+        if (Type == EKernelType::SPK && Subset.bIncludeCenters && Wanted.Num() > 0)
+        {
+            for (int32 Num = -1; Num != Wanted.Num(); )
+            {
+                Num = Wanted.Num();
+                for (const FSourceSegment& Segment : Segments)
+                {
+                    if (Wanted.Contains(Segment.Id) && InWindow(Segment))
+                    {
+                        Wanted.Add(Segment.Center);
+                    }
+                }
+            }
+        }
+
+        TArray<FSourceSegment*> Selected;
+        for (FSourceSegment& Segment : Segments)
+        {
+            if ((Wanted.Num() == 0 || Wanted.Contains(Segment.Id)) && InWindow(Segment))
+            {
+                Selected.Add(&Segment);
+            }
+        }
+
+        if (failed_c() || Selected.Num() == 0)
+        {
+            CloseDaf(_source_handle);
+            return !ErrorCheck(ResultCode, ErrorMessage);
+        }
+
+        IFileManager::Get().Delete(*Destination, false, true, true);
+        IFileManager::Get().MakeDirectory(*FPaths::GetPath(Destination), true);
+
+        auto _ifname = StringCast<ANSICHAR>(*Subset.InternalFileName.Left(60));
+        SpiceInt _destination_handle = 0;
+        if (Type == EKernelType::SPK)
+        {
+            spkopn_c(_destination.Get(), _ifname.Get(), 0, &_destination_handle);
+        }
+        else
+        {
+            integer _nd = 2;
+            integer _ni = Type == EKernelType::PCK ? 5 : 6;
+            integer _resv = 0;
+            integer _handle = 0;
+            dafonw_((char*)_destination.Get(), (char*)_type, &_nd, &_ni, (char*)_ifname.Get(), &_resv, &_handle, _destination.Length(), FCStringAnsi::Strlen(_type), _ifname.Length());
+            _destination_handle = _handle;
+        }
+
+        int32 Written = 0;
+        if (!failed_c())
+        {
+            for (FSourceSegment* Segment : Selected)
+            {
+                if (Type == EKernelType::SPK && CanSubset(Segment->DataType))
+                {
+                    const double Begin = FMath::Max(Segment->Start, Subset.Start);
+                    const double End = FMath::Min(Segment->Stop, Subset.Stop);
+                    spksub_c(_source_handle, Segment->Sum, Segment->Name, Begin, End, _destination_handle);
+                }
+                else
+                {
+                    CopySegment(_source_handle, _destination_handle, *Segment);
+                }
+
+                if (failed_c())
+                {
+                    break;
+                }
+                ++Written;
+            }
+
+            CloseDaf(_destination_handle);
+        }
+
+        CloseDaf(_source_handle);
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            IFileManager::Get().Delete(*Destination, false, true, true);
+            return false;
+        }
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE SubsetKernel wrote %d of %d segments from %s to %s"), Written, Segments.Num(), *Source, *Destination);
+        if (SegmentsWritten) *SegmentsWritten = Written;
+        return true;
+    }
+
+
+    SPICE_API bool SubsetLoadedKernels(
+        const FString& destinationDirectory,
+        const FKernelSubset& Subset,
+        TArray<FString>* WrittenPaths,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (WrittenPaths) WrittenPaths->Reset();
+
+        constexpr SpiceInt FILLEN = 1024;
+        constexpr SpiceInt TYPLEN = 33;
+        constexpr SpiceInt SRCLEN = 1024;
+        ConstSpiceChar* _kind = "SPK CK PCK";
+
+        TArray<FString> Sources;
+        SpiceInt _count = 0;
+        ktotal_c(_kind, &_count);
+        for (SpiceInt i = 0; i < _count && !failed_c(); ++i)
+        {
+            SpiceChar _file[FILLEN];
+            SpiceChar _filtyp[TYPLEN];
+            SpiceChar _srcfil[SRCLEN];
+            SpiceInt _handle = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            kdata_c(i, _kind, FILLEN, TYPLEN, SRCLEN, _file, _filtyp, _srcfil, &_handle, &_found);
+            if (_found)
+            {
+                Sources.Add(FString(_file));
+            }
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        const FString Directory = toPath(destinationDirectory);
+        TSet<FString> Names;
+        for (const FString& Source : Sources)
+        {
+            const FString Name = FPaths::GetCleanFilename(Source);
+            bool bAlreadyInSet = false;
+            Names.Add(Name, &bAlreadyInSet);
+            if (bAlreadyInSet)
+            {
+                return Fail(FString::Printf(TEXT("SubsetLoadedKernels: more than one loaded kernel is named %s"), *Name), ResultCode, ErrorMessage);
+            }
+
+            const FString Destination = FPaths::Combine(Directory, Name);
+            int32 Written = 0;
+            if (!SubsetKernel(Source, Destination, Subset, &Written, ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+            if (Written > 0 && WrittenPaths)
+            {
+                WrittenPaths->Add(Destination);
+            }
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+}
@@ -0,0 +1,124 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelSubsetCommandlet.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Writes slim shipping kernels (MaxQ::Data::SubsetLoadedKernels).
+//------------------------------------------------------------------------------
+
+#include "SpiceKernelSubsetCommandlet.h"
+#include "HAL/FileManager.h"
+#include "Misc/Parse.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceKernelSubset.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+USpiceKernelSubsetCommandlet::USpiceKernelSubsetCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+
+static void ParseIds(const FString& Params, const TCHAR* Name, TArray<int32>& Ids)
+{
+    FString Value;
+    if (FParse::Value(*Params, Name, Value, false))
+    {
+        TArray<FString> Tokens;
+        Value.ParseIntoArray(Tokens, TEXT(","));
+        for (const FString& Token : Tokens)
+        {
+            Ids.Add(FCString::Atoi(*Token.TrimStartAndEnd()));
+        }
+    }
+}
+
+
+static bool ParseTime(const FString& Params, const TCHAR* Name, double& et)
+{
+    FString Value;
+    if (!FParse::Value(*Params, Name, Value, false))
+    {
+        return true;
+    }
+
+    str2et_c(TCHAR_TO_ANSI(*Value), &et);
+
+    FString ErrorMessage;
+    if (ErrorCheck(nullptr, &ErrorMessage))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Kernel Subset: could not parse %s%s (%s)"), Name, *Value, *ErrorMessage);
+        return false;
+    }
+    return true;
+}
+
+
+int32 USpiceKernelSubsetCommandlet::Main(const FString& Params)
+{
+    FString Kernels;
+    FString Out;
+    if (!FParse::Value(*Params, TEXT("Kernels="), Kernels, false) || !FParse::Value(*Params, TEXT("Out="), Out, false))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Kernel Subset: missing -Kernels/-Out"));
+        return 1;
+    }
+
+    MaxQ::Core::InitAll();
+
+    TArray<FString> KernelPaths;
+    Kernels.ParseIntoArray(KernelPaths, TEXT("+"));
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    if (!MaxQ::Data::Furnsh(KernelPaths, &ResultCode, &ErrorMessage))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Kernel Subset: %s"), *ErrorMessage);
+        return 1;
+    }
+
+    MaxQ::Data::FKernelSubset Subset;
+    if (!ParseTime(Params, TEXT("Start="), Subset.Start) || !ParseTime(Params, TEXT("Stop="), Subset.Stop))
+    {
+        return 1;
+    }
+    ParseIds(Params, TEXT("Bodies="), Subset.Bodies);
+    ParseIds(Params, TEXT("Instruments="), Subset.Instruments);
+    ParseIds(Params, TEXT("Frames="), Subset.Frames);
+    Subset.bIncludeCenters = !FParse::Param(*Params, TEXT("NoCenters"));
+
+    TArray<FString> Written;
+    if (!MaxQ::Data::SubsetLoadedKernels(Out, Subset, &Written, &ResultCode, &ErrorMessage))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Kernel Subset: %s"), *ErrorMessage);
+        return 1;
+    }
+
+    for (const FString& Path : Written)
+    {
+        UE_LOG(LogSpice, Display, TEXT("MaxQ SPICE Kernel Subset: wrote %s (%lld bytes)"), *Path, IFileManager::Get().FileSize(*Path));
+    }
+    UE_LOG(LogSpice, Display, TEXT("MaxQ SPICE Kernel Subset: %d kernels written to %s"), Written.Num(), *Out);
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelSubsetCommandlet.h
+//
+// Private API Comments
+//
+// Purpose:  Writes slim shipping kernels (MaxQ::Data::SubsetLoadedKernels).
+//    <exe> [project] -run=SpiceKernelSubset -Kernels=<a>+<b>+... -Out=<dir>
+//        [-Start=<time>] [-Stop=<time>] [-Bodies=<id>,<id>,...]
+//        [-Instruments=<id>,...] [-Frames=<id>,...] [-NoCenters]
+// Kernels are loaded as Furnsh (meta-kernels are fine), and should include
+// an LSK for the times (any string str2et takes) and the SCLKs for CKs.
+// Every binary SPK, CK and PCK that ends up loaded is subset into Out.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SpiceKernelSubsetCommandlet.generated.h"
+
+UCLASS()
+class USpiceKernelSubsetCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    USpiceKernelSubsetCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
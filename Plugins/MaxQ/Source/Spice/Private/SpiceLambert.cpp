@@ -0,0 +1,427 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLambert.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Lambert's problem, and porkchop plots made of it.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLambert.cpp is part of the "refined C++ API".
+//
+// Izzo's variables:  lambda (-1...1) is the geometry, T the nondimensional
+// time of flight, and x the unknown (-1 < x < 1 elliptic, x > 1
+// hyperbolic).  T(x) is evaluated three ways, as Izzo does:  Battin's
+// hypergeometric series very close to x = 1 (parabolic), Lagrange's
+// equation near it, and Lancaster's expression elsewhere.
+//------------------------------------------------------------------------------
+
+#include "SpiceLambert.h"
+#include "SpiceEphemeris.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Texture2D.h"
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    constexpr int32 MaxIterations = 32;
+    constexpr double Tolerance = 1e-13;
+
+    // Cells per ParallelFor task
+    constexpr int32 ChunkSize = 1024;
+
+    inline void Cross(const double(&a)[3], const double(&b)[3], double(&c)[3])
+    {
+        c[0] = a[1] * b[2] - a[2] * b[1];
+        c[1] = a[2] * b[0] - a[0] * b[2];
+        c[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    inline double Norm(const double(&a)[3])
+    {
+        return sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    }
+
+    // 2F1(3, 1, 5/2, z)
+    double Hypergeometric(double z)
+    {
+        double Sum = 1., Term = 1.;
+        for (int32 j = 0; j < 1000 && FMath::Abs(Term) > 1e-14; ++j)
+        {
+            Term *= (3. + j) * (1. + j) / (2.5 + j) * z / (j + 1.);
+            Sum += Term;
+        }
+        return Sum;
+    }
+
+    // Lagrange
+    double TimeOfFlightLagrange(double x, double lambda)
+    {
+        const double a = 1. / (1. - x * x);
+        if (a > 0.)
+        {
+            const double alfa = 2. * acos(x);
+            double beta = 2. * asin(sqrt(lambda * lambda / a));
+            if (lambda < 0.) beta = -beta;
+            return a * sqrt(a) * ((alfa - sin(alfa)) - (beta - sin(beta))) / 2.;
+        }
+        else
+        {
+            const double alfa = 2. * acosh(x);
+            double beta = 2. * asinh(sqrt(-lambda * lambda / a));
+            if (lambda < 0.) beta = -beta;
+            return -a * sqrt(-a) * ((beta - sinh(beta)) - (alfa - sinh(alfa))) / 2.;
+        }
+    }
+
+    double TimeOfFlight(double x, double lambda)
+    {
+        const double distance = FMath::Abs(x - 1.);
+        if (distance < .2 && distance > .01)
+        {
+            return TimeOfFlightLagrange(x, lambda);
+        }
+
+        const double E = x * x - 1.;
+        const double z = sqrt(1. + lambda * lambda * E);
+
+        if (distance <= .01)
+        {
+            // Battin
+            const double eta = z - lambda * x;
+            const double S1 = .5 * (1. - lambda - x * eta);
+            const double Q = 4. / 3. * Hypergeometric(S1);
+            return (eta * eta * eta * Q + 4. * lambda * eta) / 2.;
+        }
+
+        // Lancaster
+        const double y = sqrt(FMath::Abs(E));
+        const double g = x * z - lambda * E;
+        double d;
+        if (E < 0.)
+        {
+            d = acos(FMath::Clamp(g, -1., 1.));
+        }
+        else
+        {
+            const double f = y * (z - lambda * x);
+            d = log(f + g);
+        }
+        return (x - lambda * z - d / y) / E;
+    }
+
+    // dT/dx and the next two derivatives
+    void Derivatives(double x, double T, double lambda, double& dT, double& ddT, double& dddT)
+    {
+        const double l2 = lambda * lambda;
+        const double l3 = l2 * lambda;
+        const double umx2 = 1. - x * x;
+        const double y = sqrt(1. - l2 * umx2);
+        const double y2 = y * y;
+        const double y3 = y2 * y;
+        dT = 1. / umx2 * (3. * T * x - 2. + 2. * l3 * x / y);
+        ddT = 1. / umx2 * (3. * T + 5. * x * dT + 2. * (1. - l2) * l3 / y3);
+        dddT = 1. / umx2 * (7. * x * ddT + 8. * dT - 6. * (1. - l2) * l2 * l3 * x / y3 / y2);
+    }
+
+    bool FindX(double lambda, double T, double& x)
+    {
+        // Izzo's initial guesses
+        const double T0 = acos(lambda) + lambda * sqrt(1. - lambda * lambda);
+        const double T1 = 2. / 3. * (1. - lambda * lambda * lambda);
+        if (T >= T0)
+        {
+            x = pow(T0 / T, 2. / 3.) - 1.;
+        }
+        else if (T < T1)
+        {
+            x = 2.5 * T1 / T * (T1 - T) / (1. - pow(lambda, 5)) + 1.;
+        }
+        else
+        {
+            x = pow(T / T0, log(2.) / log(T1 / T0)) - 1.;
+        }
+
+        // Householder (third order)
+        for (int32 i = 0; i < MaxIterations; ++i)
+        {
+            const double tof = TimeOfFlight(x, lambda);
+            double dT, ddT, dddT;
+            Derivatives(x, tof, lambda, dT, ddT, dddT);
+
+            const double delta = tof - T;
+            const double dT2 = dT * dT;
+            const double next = x - delta * (dT2 - delta * ddT / 2.) / (dT * (dT2 - delta * ddT) + dddT * delta * delta / 6.);
+            if (!FMath::IsFinite(next) || next <= -1.)
+            {
+                return false;
+            }
+
+            const bool bConverged = FMath::Abs(next - x) < Tolerance;
+            x = next;
+            if (bConverged)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+namespace MaxQ::Orbits
+{
+    bool Lambert(double gm, const double(&r1)[3], const double(&r2)[3], double tof, double(&v1)[3], double(&v2)[3], bool bRetrograde)
+    {
+        if (!(gm > 0.) || !(tof > 0.))
+        {
+            return false;
+        }
+
+        const double c[3] = { r2[0] - r1[0], r2[1] - r1[1], r2[2] - r1[2] };
+        const double cn = Norm(c), r1n = Norm(r1), r2n = Norm(r2);
+        if (cn == 0. || r1n == 0. || r2n == 0.)
+        {
+            return false;
+        }
+        const double s = (r1n + r2n + cn) / 2.;
+
+        const double ir1[3] = { r1[0] / r1n, r1[1] / r1n, r1[2] / r1n };
+        const double ir2[3] = { r2[0] / r2n, r2[1] / r2n, r2[2] / r2n };
+        double ih[3];
+        Cross(ir1, ir2, ih);
+        const double hn = Norm(ih);
+        if (hn < 1e-12)
+        {
+            return false;
+        }
+        ih[0] /= hn; ih[1] /= hn; ih[2] /= hn;
+
+        // Transfers of more than pi have negative lambda
+        double lambda = sqrt(FMath::Max(0., 1. - cn / s));
+        double it1[3], it2[3];
+        if (ih[2] < 0.)
+        {
+            lambda = -lambda;
+            Cross(ir1, ih, it1);
+            Cross(ir2, ih, it2);
+        }
+        else
+        {
+            Cross(ih, ir1, it1);
+            Cross(ih, ir2, it2);
+        }
+        if (bRetrograde)
+        {
+            lambda = -lambda;
+            for (int32 j = 0; j < 3; ++j)
+            {
+                it1[j] = -it1[j];
+                it2[j] = -it2[j];
+            }
+        }
+
+        const double T = sqrt(2. * gm / (s * s * s)) * tof;
+
+        double x;
+        if (!FindX(lambda, T, x))
+        {
+            return false;
+        }
+        const double y = sqrt(1. - lambda * lambda * (1. - x * x));
+
+        const double gamma = sqrt(gm * s / 2.);
+        const double rho = (r1n - r2n) / cn;
+        const double sigma = sqrt(FMath::Max(0., 1. - rho * rho));
+
+        const double vr1 = gamma * ((lambda * y - x) - rho * (lambda * y + x)) / r1n;
+        const double vr2 = -gamma * ((lambda * y - x) + rho * (lambda * y + x)) / r2n;
+        const double vt = gamma * sigma * (y + lambda * x);
+        const double vt1 = vt / r1n;
+        const double vt2 = vt / r2n;
+
+        for (int32 j = 0; j < 3; ++j)
+        {
+            v1[j] = vr1 * ir1[j] + vt1 * it1[j];
+            v2[j] = vr2 * ir2[j] + vt2 * it2[j];
+        }
+        return true;
+    }
+
+
+    bool Lambert(const FSMassConstant& gm, const FSDistanceVector& r1, const FSDistanceVector& r2, const FSEphemerisPeriod& tof, FSVelocityVector& v1, FSVelocityVector& v2, bool bRetrograde)
+    {
+        double _r1[3], _r2[3], _v1[3], _v2[3];
+        r1.CopyTo(_r1);
+        r2.CopyTo(_r2);
+
+        if (!Lambert(gm.GM, _r1, _r2, tof.AsSeconds(), _v1, _v2, bRetrograde))
+        {
+            return false;
+        }
+
+        v1 = FSVelocityVector(_v1);
+        v2 = FSVelocityVector(_v2);
+        return true;
+    }
+
+
+    int32 SolvePorkchop(
+        TArrayView<const double> DepartureEts,
+        TArrayView<const FSStateVector> DepartureStates,
+        TArrayView<const double> ArrivalEts,
+        TArrayView<const FSStateVector> ArrivalStates,
+        double gm,
+        FPorkchopPlot& Plot,
+        bool bRetrograde
+    )
+    {
+        check(DepartureStates.Num() >= DepartureEts.Num());
+        check(ArrivalStates.Num() >= ArrivalEts.Num());
+
+        Plot.NumDepartures = DepartureEts.Num();
+        Plot.NumArrivals = ArrivalEts.Num();
+        const int32 Cells = Plot.NumDepartures * Plot.NumArrivals;
+        Plot.C3.SetNumUninitialized(Cells);
+        Plot.ArrivalVInfinity.SetNumUninitialized(Cells);
+
+        const int32 NumChunks = (Cells + ChunkSize - 1) / ChunkSize;
+        TArray<int32> Solved;
+        Solved.SetNumZeroed(NumChunks);
+
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            const int32 Last = FMath::Min(Cells, (Chunk + 1) * ChunkSize);
+            for (int32 Cell = Chunk * ChunkSize; Cell < Last; ++Cell)
+            {
+                const int32 d = Cell % Plot.NumDepartures;
+                const int32 a = Cell / Plot.NumDepartures;
+
+                Plot.C3[Cell] = -1.f;
+                Plot.ArrivalVInfinity[Cell] = -1.f;
+
+                double s1[6], s2[6];
+                DepartureStates[d].CopyTo(s1);
+                ArrivalStates[a].CopyTo(s2);
+
+                const double r1[3] = { s1[0], s1[1], s1[2] };
+                const double r2[3] = { s2[0], s2[1], s2[2] };
+                double v1[3], v2[3];
+                if (!Lambert(gm, r1, r2, ArrivalEts[a] - DepartureEts[d], v1, v2, bRetrograde))
+                {
+                    continue;
+                }
+
+                const double d1[3] = { v1[0] - s1[3], v1[1] - s1[4], v1[2] - s1[5] };
+                const double d2[3] = { v2[0] - s2[3], v2[1] - s2[4], v2[2] - s2[5] };
+                const double vinf1 = Norm(d1);
+                Plot.C3[Cell] = (float)(vinf1 * vinf1);
+                Plot.ArrivalVInfinity[Cell] = (float)Norm(d2);
+                ++Solved[Chunk];
+            }
+        }, NumChunks == 1);
+
+        int32 Total = 0;
+        for (int32 n : Solved)
+        {
+            Total += n;
+        }
+        return Total;
+    }
+
+
+    bool Porkchop(
+        TArrayView<const double> DepartureEts,
+        TArrayView<const double> ArrivalEts,
+        const FPorkchopSettings& Settings,
+        FPorkchopPlot& Plot,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        using namespace MaxQ::Ephemeris;
+
+        // SoA from the batch, then AoS for the solver
+        auto Fetch = [&](TArrayView<const double> ets, const FString& Body, TArray<FSStateVector>& States) -> bool
+        {
+            TArray<double> Columns;
+            const int32 Num = ets.Num();
+            Columns.SetNumUninitialized(6 * Num);
+            const FStateVectorBatch Batch{
+                TArrayView<double>(&Columns[0 * Num], Num), TArrayView<double>(&Columns[1 * Num], Num), TArrayView<double>(&Columns[2 * Num], Num),
+                TArrayView<double>(&Columns[3 * Num], Num), TArrayView<double>(&Columns[4 * Num], Num), TArrayView<double>(&Columns[5 * Num], Num)
+            };
+
+            if (Num > 0 && SpkezrBatch(ets, Batch, {}, Body, Settings.Center, Settings.Frame, ES_AberrationCorrectionWithNewtonians::None, ResultCode, ErrorMessage) != Num)
+            {
+                return false;
+            }
+
+            States.SetNumUninitialized(Num);
+            for (int32 i = 0; i < Num; ++i)
+            {
+                const double s[6] = { Batch.X[i], Batch.Y[i], Batch.Z[i], Batch.DX[i], Batch.DY[i], Batch.DZ[i] };
+                States[i] = FSStateVector(s);
+            }
+            return true;
+        };
+
+        TArray<FSStateVector> DepartureStates, ArrivalStates;
+        if (!Fetch(DepartureEts, Settings.Departure, DepartureStates) || !Fetch(ArrivalEts, Settings.Arrival, ArrivalStates))
+        {
+            Plot = FPorkchopPlot();
+            return false;
+        }
+
+        SolvePorkchop(DepartureEts, DepartureStates, ArrivalEts, ArrivalStates, Settings.GM, Plot, Settings.bRetrograde);
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    UTexture2D* CreatePorkchopTexture(const FPorkchopPlot& Plot)
+    {
+        check(IsInGameThread());
+
+        if (Plot.NumDepartures <= 0 || Plot.NumArrivals <= 0 || Plot.C3.Num() != Plot.NumDepartures * Plot.NumArrivals || Plot.ArrivalVInfinity.Num() != Plot.C3.Num())
+        {
+            return nullptr;
+        }
+
+        UTexture2D* Texture = UTexture2D::CreateTransient(Plot.NumDepartures, Plot.NumArrivals, PF_G32R32F);
+        if (!Texture)
+        {
+            return nullptr;
+        }
+        Texture->SRGB = false;
+        Texture->CompressionSettings = TC_HDR;
+        Texture->Filter = TF_Bilinear;
+        Texture->AddressX = TA_Clamp;
+        Texture->AddressY = TA_Clamp;
+
+        FTexture2DMipMap& Mip = Texture->GetPlatformData()->Mips[0];
+        float* Texels = static_cast<float*>(Mip.BulkData.Lock(LOCK_READ_WRITE));
+        for (int32 i = 0; i < Plot.C3.Num(); ++i)
+        {
+            Texels[2 * i] = Plot.C3[i];
+            Texels[2 * i + 1] = Plot.ArrivalVInfinity[i];
+        }
+        Mip.BulkData.Unlock();
+
+        Texture->UpdateResource();
+        return Texture;
+    }
+}
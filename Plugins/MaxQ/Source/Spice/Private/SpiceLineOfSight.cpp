@@ -0,0 +1,213 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLineOfSight.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Which satellites can see each other, for a whole catalog.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLineOfSight.cpp is part of the "refined C++ API".
+//
+// Every link is tested from both ends, so each node's list is built
+// independently of every other's:  chunks of nodes fill their own buffers,
+// and a prefix sum over the chunks' counts places them in the graph.  That's
+// twice the occlusion tests of visiting each pair once, and they're the
+// cheap part;  in exchange there's no serial mirroring pass.
+//
+// In scaled coordinates (p / radii), the segment p + t d, t in [0, 1], is
+// blocked when |p + t* d|^2 < 1 at t* = clamp(-p.d / d.d, 0, 1).  Comparing
+// p.d against 0 and -d.d gives the clamp without a division.
+//------------------------------------------------------------------------------
+
+#include "SpiceLineOfSight.h"
+#include "SpiceSpatialIndex.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Nodes per task
+    constexpr int32 ChunkSize = 64;
+
+    struct FScale
+    {
+        double x, y, z;
+    };
+
+    inline bool Clear(double px, double py, double pz, double qx, double qy, double qz)
+    {
+        const double dx = qx - px, dy = qy - py, dz = qz - pz;
+        const double pd = px * dx + py * dy + pz * dz;
+        const double dd = dx * dx + dy * dy + dz * dz;
+        const double pp = px * px + py * py + pz * pz;
+
+        // Closest point:  p (pd >= 0), q (pd <= -dd), or between, where
+        // |p + t* d|^2 = pp - pd^2 / dd
+        const double qq = qx * qx + qy * qy + qz * qz;
+        const bool bNearP = pd >= 0.;
+        const bool bNearQ = pd <= -dd;
+        const bool bBetween = !bNearP & !bNearQ;
+        return (!bNearP | (pp >= 1.)) & (!bNearQ | (qq >= 1.)) & (!bBetween | ((pp * dd - pd * pd) >= dd));
+    }
+
+    struct FChunk
+    {
+        TArray<int32> Counts;
+        TArray<int32> Neighbors;
+        TArray<double> Ranges;
+    };
+}
+
+
+namespace MaxQ::Math
+{
+    bool HasLineOfSight(const FSDistanceVector& a, const FSDistanceVector& b, const FLineOfSightSettings& Settings)
+    {
+        const double rx = Settings.Radii.x.km + Settings.GrazingAltitude;
+        const double ry = Settings.Radii.y.km + Settings.GrazingAltitude;
+        const double rz = Settings.Radii.z.km + Settings.GrazingAltitude;
+        if (!(rx > 0. && ry > 0. && rz > 0.))
+        {
+            return false;
+        }
+        return Clear(a.x.km / rx, a.y.km / ry, a.z.km / rz, b.x.km / rx, b.y.km / ry, b.z.km / rz);
+    }
+
+
+    bool BuildLineOfSightGraph(
+        const FConstVectorBatch& Positions,
+        const FSpatialIndex* Index,
+        FLineOfSightGraph& Graph,
+        const FLineOfSightSettings& Settings,
+        TArrayView<const uint8> Valid
+    )
+    {
+        Graph.Offsets.Reset();
+        Graph.Neighbors.Reset();
+        Graph.Ranges.Reset();
+
+        const FScale Scale{ 1. / (Settings.Radii.x.km + Settings.GrazingAltitude), 1. / (Settings.Radii.y.km + Settings.GrazingAltitude), 1. / (Settings.Radii.z.km + Settings.GrazingAltitude) };
+        const bool bIndexed = Settings.MaxRange > 0.;
+        const int32 Num = Positions.Num();
+        if (!(Scale.x > 0. && Scale.y > 0. && Scale.z > 0.) || (bIndexed && !Index) || (Valid.Num() > 0 && Valid.Num() != Num))
+        {
+            return false;
+        }
+
+        // Scaled once, for every test
+        TArray<double> SX, SY, SZ;
+        SX.SetNumUninitialized(Num); SY.SetNumUninitialized(Num); SZ.SetNumUninitialized(Num);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            SX[i] = Positions.X[i] * Scale.x;
+            SY[i] = Positions.Y[i] * Scale.y;
+            SZ[i] = Positions.Z[i] * Scale.z;
+        }
+
+        const int32 NumChunks = (Num + ChunkSize - 1) / ChunkSize;
+        TArray<FChunk> Chunks;
+        Chunks.SetNum(NumChunks);
+
+        ParallelFor(NumChunks, [&](int32 c)
+        {
+            FChunk& Chunk = Chunks[c];
+            const int32 First = c * ChunkSize;
+            const int32 Last = FMath::Min(First + ChunkSize, Num);
+            Chunk.Counts.SetNumZeroed(Last - First);
+
+            TArray<FSpatialHit> Hits;
+            TArray<int32> Candidates;
+            TArray<uint8> bClear;
+
+            for (int32 i = First; i < Last; ++i)
+            {
+                if (Valid.Num() > 0 && !Valid[i])
+                {
+                    continue;
+                }
+
+                // Candidates, nearest first when indexed
+                Candidates.Reset();
+                if (bIndexed)
+                {
+                    Index->Within(FSDistanceVector(Positions.X[i], Positions.Y[i], Positions.Z[i]), Settings.MaxRange, Hits);
+                    for (const FSpatialHit& Hit : Hits)
+                    {
+                        if (Hit.Index != i)
+                        {
+                            Candidates.Add(Hit.Index);
+                        }
+                    }
+                }
+                else
+                {
+                    for (int32 j = 0; j < Num; ++j)
+                    {
+                        if (j != i && (Valid.Num() == 0 || Valid[j]))
+                        {
+                            Candidates.Add(j);
+                        }
+                    }
+                }
+
+                const int32 NumCandidates = Candidates.Num();
+                bClear.SetNumUninitialized(NumCandidates, false);
+                const double px = SX[i], py = SY[i], pz = SZ[i];
+                const int32* Ids = Candidates.GetData();
+                uint8* Out = bClear.GetData();
+                for (int32 k = 0; k < NumCandidates; ++k)
+                {
+                    Out[k] = uint8(Clear(px, py, pz, SX[Ids[k]], SY[Ids[k]], SZ[Ids[k]]));
+                }
+
+                int32 Count = 0;
+                for (int32 k = 0; k < NumCandidates; ++k)
+                {
+                    if (Out[k])
+                    {
+                        const int32 j = Ids[k];
+                        Chunk.Neighbors.Add(j);
+                        Chunk.Ranges.Add(FMath::Sqrt(FMath::Square(Positions.X[j] - Positions.X[i]) + FMath::Square(Positions.Y[j] - Positions.Y[i]) + FMath::Square(Positions.Z[j] - Positions.Z[i])));
+                        ++Count;
+                    }
+                }
+                Chunk.Counts[i - First] = Count;
+            }
+        }, Num <= ChunkSize);
+
+        // Placement
+        Graph.Offsets.SetNumUninitialized(Num + 1);
+        Graph.Offsets[0] = 0;
+        for (int32 c = 0; c < NumChunks; ++c)
+        {
+            const int32 First = c * ChunkSize;
+            for (int32 k = 0; k < Chunks[c].Counts.Num(); ++k)
+            {
+                Graph.Offsets[First + k + 1] = Graph.Offsets[First + k] + Chunks[c].Counts[k];
+            }
+        }
+        Graph.Neighbors.SetNumUninitialized(Graph.Offsets[Num]);
+        Graph.Ranges.SetNumUninitialized(Graph.Offsets[Num]);
+
+        ParallelFor(NumChunks, [&](int32 c)
+        {
+            const int32 At = Graph.Offsets[c * ChunkSize];
+            FChunk& Chunk = Chunks[c];
+            FMemory::Memcpy(Graph.Neighbors.GetData() + At, Chunk.Neighbors.GetData(), Chunk.Neighbors.Num() * sizeof(int32));
+            FMemory::Memcpy(Graph.Ranges.GetData() + At, Chunk.Ranges.GetData(), Chunk.Ranges.Num() * sizeof(double));
+        }, Num <= ChunkSize);
+
+        return true;
+    }
+}
@@ -0,0 +1,180 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLocalOrbitalFrame.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Objects' local orbital frames (RIC, LVLH), from their states.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLocalOrbitalFrame.cpp is part of the "refined C++ API".
+//
+// Both frames come from the same two unit vectors, r^ and h^ (along r x v):
+// RIC's rows are (r^, h^ x r^, h^), LVLH's are (h^ x r^, -h^, -r^).
+//
+// A relative state in the rotating frame is M (dr) and M (dv - w x dr),
+// where M is the chief's matrix and w its frame's inertial rate.
+//------------------------------------------------------------------------------
+
+#include "SpiceLocalOrbitalFrame.h"
+#include "Async/ParallelFor.h"
+#include <atomic>
+
+namespace
+{
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    // The frame of (r, v).  False if it's degenerate (m is left alone).
+    inline bool Build(MaxQ::Math::ELocalOrbitalFrame Frame, const double (&r)[3], const double (&v)[3], double (&m)[3][3])
+    {
+        const double lr = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+        double h[3] = {
+            r[1] * v[2] - r[2] * v[1],
+            r[2] * v[0] - r[0] * v[2],
+            r[0] * v[1] - r[1] * v[0]
+        };
+        const double lh = sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]);
+        if (lr == 0. || lh == 0.)
+        {
+            return false;
+        }
+
+        const double u[3] = { r[0] / lr, r[1] / lr, r[2] / lr };
+        h[0] /= lh; h[1] /= lh; h[2] /= lh;
+
+        // h^ x r^
+        const double t[3] = {
+            h[1] * u[2] - h[2] * u[1],
+            h[2] * u[0] - h[0] * u[2],
+            h[0] * u[1] - h[1] * u[0]
+        };
+
+        if (Frame == MaxQ::Math::ELocalOrbitalFrame::LVLH)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                m[0][j] = t[j];
+                m[1][j] = -h[j];
+                m[2][j] = -u[j];
+            }
+        }
+        else
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                m[0][j] = u[j];
+                m[1][j] = t[j];
+                m[2][j] = h[j];
+            }
+        }
+        return true;
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    int32 LocalOrbitalFrames(
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        TArrayView<FSRotationMatrix> m,
+        ELocalOrbitalFrame Frame
+    )
+    {
+        const int32 Num = r.Num();
+        check(v.Num() >= Num && m.Num() >= Num);
+
+        std::atomic<int32> NumDegenerate{ 0 };
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            int32 Degenerate = 0;
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const double ri[3] = { r.X[i], r.Y[i], r.Z[i] };
+                const double vi[3] = { v.X[i], v.Y[i], v.Z[i] };
+
+                double (&mi)[3][3] = m[i].AsSpiceDoubleArray();
+                if (!Build(Frame, ri, vi, mi))
+                {
+                    mi[0][0] = 1.; mi[0][1] = 0.; mi[0][2] = 0.;
+                    mi[1][0] = 0.; mi[1][1] = 1.; mi[1][2] = 0.;
+                    mi[2][0] = 0.; mi[2][1] = 0.; mi[2][2] = 1.;
+                    ++Degenerate;
+                }
+            }
+            NumDegenerate += Degenerate;
+        }, Num <= ChunkSize);
+
+        return NumDegenerate.load();
+    }
+
+
+    bool RelativeStates(
+        const FSStateVector& Chief,
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        const FVectorBatch& OutR,
+        const FVectorBatch& OutV,
+        ELocalOrbitalFrame Frame
+    )
+    {
+        const int32 Num = r.Num();
+        check(v.Num() >= Num && OutR.Num() >= Num && OutV.Num() >= Num);
+
+        double s[6];
+        Chief.CopyTo(s);
+        const double rc[3] = { s[0], s[1], s[2] };
+        const double vc[3] = { s[3], s[4], s[5] };
+
+        double m[3][3];
+        if (!Build(Frame, rc, vc, m))
+        {
+            return false;
+        }
+
+        // The frame's rate, (r x v) / |r|^2
+        const double r2 = rc[0] * rc[0] + rc[1] * rc[1] + rc[2] * rc[2];
+        const double w[3] = {
+            (rc[1] * vc[2] - rc[2] * vc[1]) / r2,
+            (rc[2] * vc[0] - rc[0] * vc[2]) / r2,
+            (rc[0] * vc[1] - rc[1] * vc[0]) / r2
+        };
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const double dr[3] = { r.X[i] - rc[0], r.Y[i] - rc[1], r.Z[i] - rc[2] };
+                const double dv[3] = {
+                    v.X[i] - vc[0] - (w[1] * dr[2] - w[2] * dr[1]),
+                    v.Y[i] - vc[1] - (w[2] * dr[0] - w[0] * dr[2]),
+                    v.Z[i] - vc[2] - (w[0] * dr[1] - w[1] * dr[0])
+                };
+
+                OutR.X[i] = m[0][0] * dr[0] + m[0][1] * dr[1] + m[0][2] * dr[2];
+                OutR.Y[i] = m[1][0] * dr[0] + m[1][1] * dr[1] + m[1][2] * dr[2];
+                OutR.Z[i] = m[2][0] * dr[0] + m[2][1] * dr[1] + m[2][2] * dr[2];
+                OutV.X[i] = m[0][0] * dv[0] + m[0][1] * dv[1] + m[0][2] * dv[2];
+                OutV.Y[i] = m[1][0] * dv[0] + m[1][1] * dv[1] + m[1][2] * dv[2];
+                OutV.Z[i] = m[2][0] * dv[0] + m[2][1] * dv[1] + m[2][2] * dv[2];
+            }
+        }, Num <= ChunkSize);
+
+        return true;
+    }
+}
@@ -0,0 +1,167 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLocalSolarTime.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Local solar time for many sites on a body, at one epoch.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLocalSolarTime.cpp is part of the "refined C++ API".
+//
+// Follows et2lst_c:  the Sun's position is spkez from the body, LT+S, in the
+// frame cidfrm names for it, and its longitude is reclat's.  A site's angle
+// past local midnight is its longitude less the Sun's, plus pi, mod 2 pi.
+// Planetographic longitudes are negated for positive west bodies first (the
+// sense recpgr_c uses, through PlanetographicSense).
+//------------------------------------------------------------------------------
+
+#include "SpiceLocalSolarTime.h"
+#include "SpiceUtilities.h"
+#include "SpiceMathBatch.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double twopi = 2. * pi;
+    constexpr double SecondsPerDay = 86400.;
+
+    constexpr SpiceInt Sun = 10;
+
+    // Frame names are 32 characters at most
+    constexpr SpiceInt FrameNameLength = 33;
+
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+}
+
+
+namespace MaxQ::Time
+{
+    bool SunLongitude(
+        double et,
+        int32 body,
+        double& SunLon,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        SpiceInt _frcode = 0;
+        SpiceChar _frname[FrameNameLength];
+        ZeroOut(_frname);
+        SpiceBoolean _found = SPICEFALSE;
+        cidfrm_c(body, sizeof(_frname), &_frcode, _frname, &_found);
+        if (!_found && !failed_c())
+        {
+            setmsg_c("No body fixed frame is associated with #.");
+            errint_c("#", body);
+            sigerr_c("SPICE(CANTFINDFRAME)");
+        }
+
+        SpiceDouble _state[6] = {}, _lt = 0.;
+        if (!failed_c())
+        {
+            MAXQ_SPK_LOOKUP_SCOPE();
+            spkez_c(Sun, et, _frname, "LT+S", body, _state, &_lt);
+        }
+
+        SpiceDouble _range = 0., _lon = 0., _lat = 0.;
+        reclat_c(_state, &_range, &_lon, &_lat);
+        SunLon = _lon;
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    void LocalSolarTime(
+        double SunLon,
+        TArrayView<const double> Longitudes,
+        TArrayView<FLocalSolarTime> Out,
+        ES_LongitudeType Type,
+        bool bPositiveWest
+    )
+    {
+        check(Out.Num() == Longitudes.Num());
+
+        const int32 Num = Longitudes.Num();
+        const double Sense = Type == ES_LongitudeType::Planetographic && bPositiveWest ? -1. : 1.;
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                double Angle = fmod(Sense * Longitudes[i] - SunLon + pi, twopi);
+                if (Angle < 0.)
+                {
+                    Angle += twopi;
+                }
+
+                const double Seconds = FMath::Min(Angle * (SecondsPerDay / twopi), SecondsPerDay - 1.e-9);
+                const int32 Hour = (int32)(Seconds / 3600.);
+                const int32 Minute = (int32)((Seconds - Hour * 3600.) / 60.);
+
+                FLocalSolarTime& Time = Out[i];
+                Time.Seconds = Seconds;
+                Time.Hour = Hour;
+                Time.Minute = Minute;
+                Time.Second = (int32)(Seconds - Hour * 3600. - Minute * 60.);
+            }
+        }, Num <= ChunkSize);
+    }
+
+
+    bool LocalSolarTime(
+        double et,
+        int32 body,
+        TArrayView<const double> Longitudes,
+        TArrayView<FLocalSolarTime> Out,
+        ES_LongitudeType Type,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (Out.Num() != Longitudes.Num())
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = TEXT("LocalSolarTime: Out must have as many elements as Longitudes");
+            return false;
+        }
+
+        double SunLon = 0.;
+        if (!SunLongitude(et, body, SunLon, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        bool bPositiveWest = false;
+        if (Type == ES_LongitudeType::Planetographic && !MaxQ::Math::PlanetographicSense(FString::FromInt(body), bPositiveWest, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        LocalSolarTime(SunLon, Longitudes, Out, Type, bPositiveWest);
+        return true;
+    }
+}
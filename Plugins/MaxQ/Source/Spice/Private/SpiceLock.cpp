@@ -0,0 +1,70 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLock.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Exclusive access to CSPICE from any thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLock.cpp is part of the "refined C++ API".
+//
+// FCriticalSection is recursive on every platform UE supports, but the error
+// reset must only happen when a thread's outermost scope ends, so the depth
+// is counted per thread.
+//------------------------------------------------------------------------------
+
+#include "SpiceLock.h"
+#include "SpiceCore.h"
+#include "SpiceUtilities.h"
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    FCriticalSection& SpiceLock()
+    {
+        static FCriticalSection Lock;
+        return Lock;
+    }
+
+    thread_local int32 Depth = 0;
+}
+
+namespace MaxQ::Core
+{
+    FSpiceScope::FSpiceScope()
+    {
+        EnsureInitialized();
+        SpiceLock().Lock();
+        ++Depth;
+    }
+
+
+    FSpiceScope::~FSpiceScope()
+    {
+        if (--Depth == 0)
+        {
+            // Unchecked errors stay with the scope that made them
+            UnexpectedErrorCheck(true);
+        }
+        SpiceLock().Unlock();
+    }
+
+
+    bool FSpiceScope::IsHeld()
+    {
+        return Depth > 0;
+    }
+}
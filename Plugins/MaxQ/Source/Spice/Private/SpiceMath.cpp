@@ -21,9 +21,13 @@
 //    * Blueprints
 //
 // SpiceMath.cpp is part of the "refined C++ API".
+//
+// The trivial vector operations (Vadd, Vsub, Vcrss, MxV, ...) are inline, in
+// SpiceMath.h.  What's left here goes through CSPICE.
 //------------------------------------------------------------------------------
 
 #include "SpiceMath.h"
+#include "SpiceName.h"
 #include "SpiceUtilities.h"
 #include <cmath>
 
@@ -44,120 +48,6 @@ namespace MaxQ::Math
     SPICE_API const double dpr = (double)dpr_c();
     SPICE_API const double rpd = (double)rpd_c();
 
-    template<typename VectorType, auto func>
-    inline void xV(
-        VectorType& vout,
-        const FSRotationMatrix& m,
-        const VectorType& vin
-    )
-    {
-        // Inputs
-        SpiceDouble    _m1[3][3];	m.CopyTo(_m1);
-        SpiceDouble    _vin[3];		vin.CopyTo(_vin);
-
-        // Outputs
-        SpiceDouble    _vout[3];
-
-        // Invocation
-        func(_m1, _vin, _vout);
-
-        // Return Value
-        vout = { _vout };
-    }
-
-    template<typename VectorType>
-    SPICE_API void MxV(
-        VectorType& vout,
-        const FSRotationMatrix& m,
-        const VectorType& vin)
-    {
-        xV<VectorType,mxv_c>(vout, m, vin);
-    }
-
-    
-    template SPICE_API void MxV<FSAngularVelocity>(FSAngularVelocity& vout, const FSRotationMatrix& m, const FSAngularVelocity& vin);
-    template SPICE_API void MxV<FSDistanceVector>(FSDistanceVector& vout, const FSRotationMatrix& m, const FSDistanceVector& vin);
-    template SPICE_API void MxV<FSVelocityVector>(FSVelocityVector& vout, const FSRotationMatrix& m, const FSVelocityVector& vin);
-    template SPICE_API void MxV<FSDimensionlessVector>(FSDimensionlessVector& vout, const FSRotationMatrix& m, const FSDimensionlessVector& vin);
-
-    template<typename VectorType, class MatrixType, SpiceInt _nrow1, auto func>
-    inline void xV(
-        VectorType& vout,
-        const MatrixType& m,
-        const VectorType& vin
-    )
-    {
-        constexpr SpiceInt _nc1r2 = sizeof(VectorType) / sizeof (SpiceDouble);
-        /*
-        * Not cool, according to the compiler.
-        constexpr SpiceInt _nrow1 = sizeof MatrixType / sizeof VectorType;
-        */
-
-        // Input
-        double _m1[_nrow1][_nc1r2];  m.CopyTo(_m1);
-        double _v2[_nc1r2];          vin.CopyTo(_v2);
-
-        // Output
-        double _vout[_nrow1];
-
-        // Invocation
-        func(_m1, _v2, _nrow1, _nc1r2, _vout);
-
-        // Pack outputs
-        vout = { _vout };
-    }
-
-    template<typename VectorType, auto func>
-    inline void xV(
-        VectorType& vout,
-        const FSStateTransform& m,
-        const VectorType& vin
-    )
-    {
-        return xV<VectorType, FSStateTransform, 6, func>(vout, m, vin);
-    }
-
-    template<class VectorType>
-    SPICE_API void MxV(
-        VectorType& vout,
-        const FSStateTransform& m,
-        const VectorType& vin
-    )
-    {
-        return xV<VectorType, mxvg_c>(vout, m, vin);
-    }
-
-    template SPICE_API void MxV<FSDimensionlessStateVector>(FSDimensionlessStateVector& vout, const FSStateTransform& m, const FSDimensionlessStateVector& vin);
-    template SPICE_API void MxV<FSStateVector>(FSStateVector& vout, const FSStateTransform& m, const FSStateVector& vin);
-
-    template<typename VectorType>
-    SPICE_API void MTxV(
-        VectorType& vout,
-        const FSRotationMatrix& m,
-        const VectorType& vin
-    )
-    {
-        xV<VectorType, mtxv_c>(vout, m, vin);
-    }
-
-    template SPICE_API void MTxV<FSAngularVelocity>(FSAngularVelocity& vout, const FSRotationMatrix& m, const FSAngularVelocity& vin);
-    template SPICE_API void MTxV<FSDistanceVector>(FSDistanceVector& vout, const FSRotationMatrix& m, const FSDistanceVector& vin);
-    template SPICE_API void MTxV<FSVelocityVector>(FSVelocityVector& vout, const FSRotationMatrix& m, const FSVelocityVector& vin);
-    template SPICE_API void MTxV<FSDimensionlessVector>(FSDimensionlessVector& vout, const FSRotationMatrix& m, const FSDimensionlessVector& vin);
-
-    template<class VectorType>
-    SPICE_API void MTxV(
-        VectorType& vout,
-        const FSStateTransform& m,
-        const VectorType& vin
-    )
-    {
-        xV<VectorType, mtxvg_c>(vout, m, vin);
-    }
-
-    template SPICE_API void MTxV<FSDimensionlessStateVector>(FSDimensionlessStateVector& vout, const FSStateTransform& m, const FSDimensionlessStateVector& vin);
-    template SPICE_API void MTxV<FSStateVector>(FSStateVector& vout, const FSStateTransform& m, const FSStateVector& vin);
-
     template<auto func>
     inline void xM(FSRotationMatrix& mout, const FSRotationMatrix& m1, const FSRotationMatrix& m2)
     {
@@ -274,72 +164,12 @@ namespace MaxQ::Math
     }
 
 
-    template<class VectorType, auto func>
-    inline void v6op(VectorType& vout, const VectorType& v)
-    {
-        // Inputs
-        constexpr SpiceInt _ndim = 6;
-        SpiceDouble    _v[_ndim];  v.CopyTo(_v);
-
-        // Outputs
-        SpiceDouble    _vout[_ndim];  vout.CopyTo(_vout);
-
-        // Invocation
-        func(_v, _ndim, _vout);
-
-        // Return Value
-        vout = VectorType{ _vout };
-    }
-
-    template<class VectorType, auto func>
-    inline void v6op(VectorType& sum, const VectorType& v1, const VectorType& v2)
-    {
-        // Inputs
-        constexpr SpiceInt _ndim = 6;
-        SpiceDouble    _v1[_ndim];  v1.CopyTo(_v1);
-        SpiceDouble    _v2[_ndim];  v2.CopyTo(_v2);
-
-        // Outputs
-        SpiceDouble    _sum[_ndim];  sum.CopyTo(_sum);
-
-        // Invocation
-        func(_v1, _v2, _ndim, _sum);
-
-        // Return Value
-        sum = VectorType{ _sum };
-    }
-
     template<class VectorType, auto func>
     inline void v3op(VectorType& vout, const VectorType& v1, const VectorType& v2)
     {
         v3op<VectorType,VectorType,VectorType,func>(vout, v1, v2);
     }
 
-    template<class VectorType>
-    SPICE_API void Vadd(VectorType& vsum, const VectorType& v1, const VectorType& v2)
-    {
-        v3op<VectorType,vadd_c>(vsum, v1, v2);
-    }
-
-
-    template SPICE_API void Vadd<FSAngularVelocity>(FSAngularVelocity&, const FSAngularVelocity&, const FSAngularVelocity&);
-    template SPICE_API void Vadd<FSDistanceVector>(FSDistanceVector&, const FSDistanceVector&, const FSDistanceVector&);
-    template SPICE_API void Vadd<FSVelocityVector>(FSVelocityVector&, const FSVelocityVector&, const FSVelocityVector&);
-    template SPICE_API void Vadd<FSDimensionlessVector>(FSDimensionlessVector&, const FSDimensionlessVector&, const FSDimensionlessVector&);
-
-    template<>
-    SPICE_API void Vadd(FSStateVector& sum, const FSStateVector& v1, const FSStateVector& v2)
-    {
-        v6op<FSStateVector,vaddg_c>(sum, v1, v2);
-    }
-
-    template<>
-    SPICE_API void Vadd(FSDimensionlessStateVector& sum, const FSDimensionlessStateVector& v1, const FSDimensionlessStateVector& v2)
-    {
-        v6op<FSDimensionlessStateVector, vaddg_c>(sum, v1, v2);
-    }
-
-
     template<class VectorType>
     SPICE_API void Vhat(FSDimensionlessVector& vhat, const VectorType& v)
     {
@@ -359,76 +189,12 @@ namespace MaxQ::Math
         vnorm = vrel_c(_v1, _v2);
     }
 
-    template<class VectorType>
-    SPICE_API void Vscl(VectorType& vscaled, double s, const VectorType& v)
-    {
-        ConstSpiceDouble _s = s;
-        SpiceDouble _v[3]; v.CopyTo(_v);
-        SpiceDouble _vscaled[3]; vscaled.CopyTo(_vscaled);
-
-        vscl_c(s, _v, _vscaled);
-
-        vscaled = { _vscaled };
-    }
-    template SPICE_API void Vscl<FSAngularVelocity>(FSAngularVelocity&, double s, const FSAngularVelocity&);
-    template SPICE_API void Vscl<FSDistanceVector>(FSDistanceVector&, double s, const FSDistanceVector&);
-    template SPICE_API void Vscl<FSVelocityVector>(FSVelocityVector&, double s, const FSVelocityVector&);
-    template SPICE_API void Vscl<FSDimensionlessVector>(FSDimensionlessVector&, double s, const FSDimensionlessVector&);
-
-
-    template<class VectorType>
-    SPICE_API void Vsub(VectorType& vdifference, const VectorType& v1, const VectorType& v2)
-    {
-        v3op<VectorType, vsub_c>(vdifference, v1, v2);
-    }
-
-
-    template SPICE_API void Vsub<FSAngularVelocity>(FSAngularVelocity&, const FSAngularVelocity&, const FSAngularVelocity&);
-    template SPICE_API void Vsub<FSDistanceVector>(FSDistanceVector&, const FSDistanceVector&, const FSDistanceVector&);
-    template SPICE_API void Vsub<FSVelocityVector>(FSVelocityVector&, const FSVelocityVector&, const FSVelocityVector&);
-    template SPICE_API void Vsub<FSDimensionlessVector>(FSDimensionlessVector&, const FSDimensionlessVector&, const FSDimensionlessVector&);
-    
     template<class VectorType>
     SPICE_API void Vrel(VectorType& vdifference, const VectorType& v1, const VectorType& v2)
     {
         v3sop<VectorType, vrel_c>(vdifference, v1, v2);
     }
 
-    template<>
-    SPICE_API void Vsub(FSStateVector& vdifference, const FSStateVector& v1, const FSStateVector& v2)
-    {
-        v6op<FSStateVector, vsubg_c>(vdifference, v1, v2);
-    }
-
-    template<>
-    SPICE_API void Vsub(FSDimensionlessStateVector& vdifference, const FSDimensionlessStateVector& v1, const FSDimensionlessStateVector& v2)
-    {
-        v6op<FSDimensionlessStateVector, vsubg_c>(vdifference, v1, v2);
-    }
-
-    template<class VectorType>
-    SPICE_API void Vminus(VectorType& vminus, const VectorType& v)
-    {
-        v3op<VectorType, vminus_c>(vminus, v);
-    }
-
-    template SPICE_API void Vminus<FSAngularVelocity>(FSAngularVelocity&, const FSAngularVelocity&);
-    template SPICE_API void Vminus<FSDistanceVector>(FSDistanceVector&, const FSDistanceVector&);
-    template SPICE_API void Vminus<FSVelocityVector>(FSVelocityVector&, const FSVelocityVector&);
-    template SPICE_API void Vminus<FSDimensionlessVector>(FSDimensionlessVector&, const FSDimensionlessVector&);
-
-    template<>
-    SPICE_API void Vminus(FSStateVector& vminus, const FSStateVector& v)
-    {
-        v6op<FSStateVector, vminug_c>(vminus, v);
-    }
-
-    template<>
-    SPICE_API void Vminus(FSDimensionlessStateVector& vminus, const FSDimensionlessStateVector& v)
-    {
-        v6op<FSDimensionlessStateVector, vminug_c>(vminus, v);
-    }
-
     template<class ParamRateType, class ParamType>
     SPICE_API void Qderiv(ParamRateType& dfdt, const ParamType& f0, const ParamType& f2, double delta)
     {
@@ -535,6 +301,71 @@ namespace MaxQ::Math
         ErrorCheck(ResultCode, ErrorMessage);
     }
 
+
+    SPICE_API void Pxform(
+        FSRotationMatrix& rotate,
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_FRAME_LOOKUP_SCOPE();
+        MAXQ_TRACE_SCOPE_TEXT(TEXT("pxform %s to %s"), ANSI_TO_TCHAR(from.Ansi()), ANSI_TO_TCHAR(to.Ansi()));
+        pxform_c(from.Ansi(), to.Ansi(), et.AsSpiceDouble(), rotate.AsSpiceDoubleArray());
+
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+    SPICE_API void Sxform(
+        FSStateTransform& xform,
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_FRAME_LOOKUP_SCOPE();
+        MAXQ_TRACE_SCOPE_TEXT(TEXT("sxform %s to %s"), ANSI_TO_TCHAR(from.Ansi()), ANSI_TO_TCHAR(to.Ansi()));
+        sxform_c(from.Ansi(), to.Ansi(), et.AsSpiceDouble(), xform.AsSpiceDoubleArray());
+
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+    SPICE_API MaxQ::Core::TSpiceResult<FSRotationMatrix> TryPxform(
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to
+    )
+    {
+        FSRotationMatrix rotate;
+        {
+            MAXQ_FRAME_LOOKUP_SCOPE();
+            MAXQ_TRACE_SCOPE_TEXT(TEXT("pxform %s to %s"), ANSI_TO_TCHAR(from.Ansi()), ANSI_TO_TCHAR(to.Ansi()));
+            pxform_c(from.Ansi(), to.Ansi(), et.AsSpiceDouble(), rotate.AsSpiceDoubleArray());
+        }
+
+        return MaxQ::Core::TakeResult(MoveTemp(rotate));
+    }
+
+    SPICE_API MaxQ::Core::TSpiceResult<FSStateTransform> TrySxform(
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to
+    )
+    {
+        FSStateTransform xform;
+        {
+            MAXQ_FRAME_LOOKUP_SCOPE();
+            MAXQ_TRACE_SCOPE_TEXT(TEXT("sxform %s to %s"), ANSI_TO_TCHAR(from.Ansi()), ANSI_TO_TCHAR(to.Ansi()));
+            sxform_c(from.Ansi(), to.Ansi(), et.AsSpiceDouble(), xform.AsSpiceDoubleArray());
+        }
+
+        return MaxQ::Core::TakeResult(MoveTemp(xform));
+    }
+
     template<class VectorType>
     SPICE_API void Ucrss(VectorType& vout, const VectorType& v1, const VectorType& v2)
     {
@@ -551,22 +382,6 @@ namespace MaxQ::Math
         return v3op<FSDimensionlessVector, FSDistanceVector, FSVelocityVector, ucrss_c>(vout, v1, v2);
     }
 
-    template<class VectorType>
-    SPICE_API void Vcrss(VectorType& vout, const VectorType& v1, const VectorType& v2)
-    {
-        return v3op<VectorType, vcrss_c>(vout, v1, v2);
-    }
-
-    template SPICE_API void Vcrss<FSAngularVelocity>(FSAngularVelocity&, const FSAngularVelocity&, const FSAngularVelocity&);
-    template SPICE_API void Vcrss<FSDistanceVector>(FSDistanceVector&, const FSDistanceVector&, const FSDistanceVector&);
-    template SPICE_API void Vcrss<FSVelocityVector>(FSVelocityVector&, const FSVelocityVector&, const FSVelocityVector&);
-    template SPICE_API void Vcrss<FSDimensionlessVector>(FSDimensionlessVector&, const FSDimensionlessVector&, const FSDimensionlessVector&);
-
-    SPICE_API void Vcrss(FSDimensionlessVector& vout, const FSDistanceVector& v1, const FSVelocityVector& v2)
-    {
-        return v3op<FSDimensionlessVector, FSDistanceVector, FSVelocityVector, vcrss_c>(vout, v1, v2);
-    }
-
     template<class VectorType>
     SPICE_API void Vperp(VectorType& vout, const VectorType& v1, const VectorType& v2)
     {
@@ -632,99 +447,6 @@ namespace MaxQ::Math
     SPICE_API void Unorm(FSDimensionlessVector& vout, FSAngularRate& vmag, const FSAngularVelocity& v) { Unorm<FSAngularRate, FSAngularVelocity>(vout, vmag, v); }
     SPICE_API void Unorm(FSDimensionlessVector& vout, double& vmag, const FSDimensionlessVector& v) { Unorm<double, FSDimensionlessVector>(vout, vmag, v); };
 
-    template<class VectorType>
-    SPICE_API void Vlcom(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2)
-    {
-        ConstSpiceDouble _a{ a };
-        SpiceDouble _v1[3]; v1.CopyTo(_v1);
-        ConstSpiceDouble _b{ b };
-        SpiceDouble _v2[3]; v2.CopyTo(_v2);
-        SpiceDouble _sum[3]; sum.CopyTo(_sum);
-
-        vlcom_c(_a, _v1, _b, _v2, _sum);
-
-        sum = { _sum };
-    }
-
-    template SPICE_API void Vlcom<FSAngularVelocity>(FSAngularVelocity&, double, const FSAngularVelocity&, double, const FSAngularVelocity&);
-    template SPICE_API void Vlcom<FSDistanceVector>(FSDistanceVector&, double, const FSDistanceVector&, double, const FSDistanceVector&);
-    template SPICE_API void Vlcom<FSVelocityVector>(FSVelocityVector&, double, const FSVelocityVector&, double, const FSVelocityVector&);
-    template SPICE_API void Vlcom<FSDimensionlessVector>(FSDimensionlessVector&, double, const FSDimensionlessVector&, double, const FSDimensionlessVector&);
-
-    template<class VectorType, SpiceInt N>
-    inline void vlcomN(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2)
-    {
-        ConstSpiceDouble _a{ a };
-        SpiceDouble _v1[N]; v1.CopyTo(_v1);
-        ConstSpiceDouble _b{ b };
-        SpiceDouble _v2[N]; v2.CopyTo(_v2);
-        SpiceDouble _sum[N]; sum.CopyTo(_sum);
-
-        vlcomg_c(N, _a, _v1, _b, _v2, _sum);
-
-        sum = { _sum };
-    }
-
-    template<>
-    SPICE_API void Vlcom(FSDimensionlessStateVector& sum, double a, const FSDimensionlessStateVector& v1, double b, const FSDimensionlessStateVector& v2)
-    {
-        return vlcomN<FSDimensionlessStateVector,6>(sum, a, v1, b, v2);
-    }
-
-    template<>
-    SPICE_API void Vlcom(FSStateVector& sum, double a, const FSStateVector& v1, double b, const FSStateVector& v2)
-    {
-        return vlcomN<FSStateVector, 6>(sum, a, v1, b, v2);
-    }
-
-    template<class VectorType>
-    SPICE_API void Vlcom3(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2, double c, const VectorType& v3)
-    {
-        ConstSpiceDouble _a{ a };
-        SpiceDouble _v1[3]; v1.CopyTo(_v1);
-        ConstSpiceDouble _b{ b };
-        SpiceDouble _v2[3]; v2.CopyTo(_v2);
-        ConstSpiceDouble _c{ c };
-        SpiceDouble _v3[3]; v3.CopyTo(_v3);
-        SpiceDouble _sum[3]; sum.CopyTo(_sum);
-
-        vlcom3_c(_a, _v1, _b, _v2, _c, _v3, _sum);
-
-        sum = { _sum };
-    }
-
-    template SPICE_API void Vlcom3<FSAngularVelocity>(FSAngularVelocity&, double, const FSAngularVelocity&, double, const FSAngularVelocity&, double, const FSAngularVelocity&);
-    template SPICE_API void Vlcom3<FSDistanceVector>(FSDistanceVector&, double, const FSDistanceVector&, double, const FSDistanceVector&, double, const FSDistanceVector&);
-    template SPICE_API void Vlcom3<FSVelocityVector>(FSVelocityVector&, double, const FSVelocityVector&, double, const FSVelocityVector&, double, const FSVelocityVector&);
-    template SPICE_API void Vlcom3<FSDimensionlessVector>(FSDimensionlessVector&, double, const FSDimensionlessVector&, double, const FSDimensionlessVector&, double, const FSDimensionlessVector&);
-
-
-    template<class OutputType, class VectorType>
-    SPICE_API void Vdot(
-        OutputType& dot,
-        const VectorType& v1,
-        const VectorType& v2
-    )
-    {
-        v3sop<OutputType, VectorType, VectorType, vdot_c>(dot, v1, v2);
-    }
-
-    template SPICE_API void Vdot<double, FSDimensionlessVector>(double&, const FSDimensionlessVector&, const FSDimensionlessVector&);
-    template SPICE_API void Vdot<FSDistance, FSDistanceVector>(FSDistance&, const FSDistanceVector&, const FSDistanceVector&);
-    template SPICE_API void Vdot<FSSpeed, FSVelocityVector>(FSSpeed&, const FSVelocityVector&, const FSVelocityVector&);
-    template SPICE_API void Vdot<FSAngularRate, FSAngularVelocity>(FSAngularRate&, const FSAngularVelocity&, const FSAngularVelocity&);
-
-
-    SPICE_API void Vdot(
-        double& dot,
-        const FSDimensionlessVector& v1,
-        const FSDimensionlessVector& v2
-    )
-
-    {
-        Vdot<double,FSDimensionlessVector>(dot, v1, v2);
-    }
-
     SPICE_API void Vdist(
         double& dist,
         const FSDimensionlessVector& v1,
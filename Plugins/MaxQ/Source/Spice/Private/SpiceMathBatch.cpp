@@ -0,0 +1,2087 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceMathBatch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Math over large arrays (coordinate conversions, etc).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceMathBatch.cpp is part of the "refined C++ API".
+//
+// The loops are written to be simple enough for the compiler to vectorize
+// (no calls other than the math library, no aliasing between the columns).
+//
+// The rotations copy the matrix into locals first, so the compiler knows the
+// outputs can't alias it.
+//
+// Recgeo solves for geodetic latitude with Bowring's iteration on the reduced
+// latitude instead of nearpt's ellipsoid search.  It's a fixed point of the
+// exact relation, so it converges to the same answer (to ~1e-15 rad,
+// usually in 2 or 3 iterations), for oblate and prolate ellipsoids.
+//
+// The quaternion functions are the CSPICE routines' formulas (M2q is
+// MaxQ::Private::M2q), on SPICE style quaternions.  SQUAD is Shoemake's,
+// with the inner control points from the neighboring samples.
+//
+// Stelab rotates without trig:  the rotation axis is normal to the vector,
+// so vrotv's rotation reduces to a scale and a cross product.
+//
+// Nearpt is Eberly's "Distance from a Point to an Ellipse, an Ellipsoid, or
+// a Hyperellipsoid":  bisection on the Lagrange multiplier, which can't
+// diverge, in the first octant with the axes sorted.  Npedln is npedln's
+// method:  the nearest point to a line that misses is on the "limb" where
+// the normal is orthogonal to the line.  That's an ellipse, and projected
+// along the line it's a plane ellipse, so the rest is Eberly's 2D case.
+//
+// Xfmsta goes through rectangular, as xfmsta does, one state at a time in
+// registers.  The geodetic Jacobian's columns are orthogonal (east, north
+// and up, scaled by the radii of curvature), so dgeodr's matrix inversion
+// reduces to dot products.  Each input/output pair is its own instantiation,
+// so the loops have no switch in them.
+//------------------------------------------------------------------------------
+
+#include "SpiceMathBatch.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+#include "Algo/BinarySearch.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double halfpi = pi / 2.;
+    constexpr double twopi = 2. * pi;
+
+    // km/s (clight_c)
+    constexpr double clight = 299792.458;
+
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    template<typename Fn>
+    void ForEachChunk(int32 Num, Fn&& Body)
+    {
+        const int32 NumChunks = (Num + ChunkSize - 1) / ChunkSize;
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            const int32 First = Chunk * ChunkSize;
+            Body(First, FMath::Min(First + ChunkSize, Num));
+        }, NumChunks <= 1);
+    }
+
+    bool ValidEllipsoid(double re, double f)
+    {
+        return re > 0. && f < 1.;
+    }
+
+    // (recgeo_, without the nearpt_)
+    inline void Geodetic(double x, double y, double z, double re, double f, double& lon, double& lat, double& alt)
+    {
+        lon = (x == 0. && y == 0.) ? 0. : atan2(y, x);
+
+        const double p = sqrt(x * x + y * y);
+        const double b = re * (1. - f);
+        const double e2 = f * (2. - f);
+
+        if (p == 0.)
+        {
+            lat = z >= 0. ? halfpi : -halfpi;
+            alt = FMath::Abs(z) - b;
+            return;
+        }
+
+        const double ep2 = e2 / (1. - e2);
+
+        // Reduced latitude, first guess
+        double beta = atan2(z * re, p * b);
+        lat = atan2(z + ep2 * b * pow(sin(beta), 3.), p - e2 * re * pow(cos(beta), 3.));
+        for (int32 i = 0; i < 16; ++i)
+        {
+            beta = atan2((1. - f) * sin(lat), cos(lat));
+            const double next = atan2(z + ep2 * b * pow(sin(beta), 3.), p - e2 * re * pow(cos(beta), 3.));
+            const bool bConverged = FMath::Abs(next - lat) < 1e-15;
+            lat = next;
+            if (bConverged)
+            {
+                break;
+            }
+        }
+
+        const double sinlat = sin(lat);
+        alt = p * cos(lat) + z * sinlat - re * sqrt(1. - e2 * sinlat * sinlat);
+    }
+
+    // (georec_)
+    inline void Rectangular(double lon, double lat, double alt, double re, double f, double& x, double& y, double& z)
+    {
+        const double e2 = f * (2. - f);
+        const double sinlat = sin(lat);
+        const double coslat = cos(lat);
+        const double n = re / sqrt(1. - e2 * sinlat * sinlat);
+
+        x = (n + alt) * coslat * cos(lon);
+        y = (n + alt) * coslat * sin(lon);
+        z = (n * (1. - e2) + alt) * sinlat;
+    }
+
+    void CheckSizes(int32 Num, TArrayView<const double> a, TArrayView<const double> b, TArrayView<const double> c)
+    {
+        check(a.Num() >= Num && b.Num() >= Num && c.Num() >= Num);
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    void Reclat(const FConstVectorBatch& rectan, TArrayView<double> radius, TArrayView<double> lon, TArrayView<double> lat)
+    {
+        const int32 Num = rectan.Num();
+        CheckSizes(Num, radius, lon, lat);
+
+        const double* X = rectan.X.GetData(); const double* Y = rectan.Y.GetData(); const double* Z = rectan.Z.GetData();
+        double* R = radius.GetData(); double* Lon = lon.GetData(); double* Lat = lat.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double p2 = X[i] * X[i] + Y[i] * Y[i];
+                R[i] = sqrt(p2 + Z[i] * Z[i]);
+                Lon[i] = (X[i] == 0. && Y[i] == 0.) ? 0. : atan2(Y[i], X[i]);
+                Lat[i] = R[i] == 0. ? 0. : atan2(Z[i], sqrt(p2));
+            }
+        });
+    }
+
+
+    void Latrec(TArrayView<const double> radius, TArrayView<const double> lon, TArrayView<const double> lat, const FVectorBatch& rectan)
+    {
+        const int32 Num = radius.Num();
+        CheckSizes(Num, rectan.X, rectan.Y, rectan.Z);
+
+        const double* R = radius.GetData(); const double* Lon = lon.GetData(); const double* Lat = lat.GetData();
+        double* X = rectan.X.GetData(); double* Y = rectan.Y.GetData(); double* Z = rectan.Z.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double coslat = cos(Lat[i]);
+                X[i] = R[i] * cos(Lon[i]) * coslat;
+                Y[i] = R[i] * sin(Lon[i]) * coslat;
+                Z[i] = R[i] * sin(Lat[i]);
+            }
+        });
+    }
+
+
+    void Recsph(const FConstVectorBatch& rectan, TArrayView<double> r, TArrayView<double> colat, TArrayView<double> lon)
+    {
+        const int32 Num = rectan.Num();
+        CheckSizes(Num, r, colat, lon);
+
+        const double* X = rectan.X.GetData(); const double* Y = rectan.Y.GetData(); const double* Z = rectan.Z.GetData();
+        double* R = r.GetData(); double* Colat = colat.GetData(); double* Lon = lon.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double p = sqrt(X[i] * X[i] + Y[i] * Y[i]);
+                R[i] = sqrt(p * p + Z[i] * Z[i]);
+                Colat[i] = R[i] == 0. ? 0. : atan2(p, Z[i]);
+                Lon[i] = (X[i] == 0. && Y[i] == 0.) ? 0. : atan2(Y[i], X[i]);
+            }
+        });
+    }
+
+
+    void Sphrec(TArrayView<const double> r, TArrayView<const double> colat, TArrayView<const double> lon, const FVectorBatch& rectan)
+    {
+        const int32 Num = r.Num();
+        CheckSizes(Num, rectan.X, rectan.Y, rectan.Z);
+
+        const double* R = r.GetData(); const double* Colat = colat.GetData(); const double* Lon = lon.GetData();
+        double* X = rectan.X.GetData(); double* Y = rectan.Y.GetData(); double* Z = rectan.Z.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double sincolat = sin(Colat[i]);
+                X[i] = R[i] * cos(Lon[i]) * sincolat;
+                Y[i] = R[i] * sin(Lon[i]) * sincolat;
+                Z[i] = R[i] * cos(Colat[i]);
+            }
+        });
+    }
+
+
+    void Reccyl(const FConstVectorBatch& rectan, TArrayView<double> r, TArrayView<double> clon, TArrayView<double> z)
+    {
+        const int32 Num = rectan.Num();
+        CheckSizes(Num, r, clon, z);
+
+        const double* X = rectan.X.GetData(); const double* Y = rectan.Y.GetData(); const double* Z = rectan.Z.GetData();
+        double* R = r.GetData(); double* Clon = clon.GetData(); double* Zout = z.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                R[i] = sqrt(X[i] * X[i] + Y[i] * Y[i]);
+                const double c = (X[i] == 0. && Y[i] == 0.) ? 0. : atan2(Y[i], X[i]);
+                Clon[i] = c < 0. ? c + twopi : c;
+                Zout[i] = Z[i];
+            }
+        });
+    }
+
+
+    void Cylrec(TArrayView<const double> r, TArrayView<const double> clon, TArrayView<const double> z, const FVectorBatch& rectan)
+    {
+        const int32 Num = r.Num();
+        CheckSizes(Num, rectan.X, rectan.Y, rectan.Z);
+
+        const double* R = r.GetData(); const double* Clon = clon.GetData(); const double* Zin = z.GetData();
+        double* X = rectan.X.GetData(); double* Y = rectan.Y.GetData(); double* Z = rectan.Z.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                X[i] = R[i] * cos(Clon[i]);
+                Y[i] = R[i] * sin(Clon[i]);
+                Z[i] = Zin[i];
+            }
+        });
+    }
+
+
+    void Recrad(const FConstVectorBatch& rectan, TArrayView<double> range, TArrayView<double> ra, TArrayView<double> dec)
+    {
+        const int32 Num = rectan.Num();
+        CheckSizes(Num, range, ra, dec);
+
+        const double* X = rectan.X.GetData(); const double* Y = rectan.Y.GetData(); const double* Z = rectan.Z.GetData();
+        double* R = range.GetData(); double* Ra = ra.GetData(); double* Dec = dec.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double p2 = X[i] * X[i] + Y[i] * Y[i];
+                R[i] = sqrt(p2 + Z[i] * Z[i]);
+                const double a = (X[i] == 0. && Y[i] == 0.) ? 0. : atan2(Y[i], X[i]);
+                Ra[i] = a < 0. ? a + twopi : a;
+                Dec[i] = R[i] == 0. ? 0. : atan2(Z[i], sqrt(p2));
+            }
+        });
+    }
+
+
+    void Radrec(TArrayView<const double> range, TArrayView<const double> ra, TArrayView<const double> dec, const FVectorBatch& rectan)
+    {
+        // radrec is latrec, with the angles renamed
+        Latrec(range, ra, dec, rectan);
+    }
+
+
+    void Recazl(const FConstVectorBatch& rectan, bool azccw, bool elplsz, TArrayView<double> range, TArrayView<double> az, TArrayView<double> el)
+    {
+        const int32 Num = rectan.Num();
+        CheckSizes(Num, range, az, el);
+
+        const double* X = rectan.X.GetData(); const double* Y = rectan.Y.GetData(); const double* Z = rectan.Z.GetData();
+        double* R = range.GetData(); double* Az = az.GetData(); double* El = el.GetData();
+        const double elsense = elplsz ? 1. : -1.;
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double p2 = X[i] * X[i] + Y[i] * Y[i];
+                R[i] = sqrt(p2 + Z[i] * Z[i]);
+                double a = (X[i] == 0. && Y[i] == 0.) ? 0. : atan2(Y[i], X[i]);
+                a = a < 0. ? a + twopi : a;
+                // (recazl's clockwise azimuth)
+                Az[i] = (azccw || a == 0.) ? a : FMath::Max(twopi - a, 0.);
+                El[i] = R[i] == 0. ? 0. : elsense * atan2(Z[i], sqrt(p2));
+            }
+        });
+    }
+
+
+    void Azlrec(TArrayView<const double> range, TArrayView<const double> az, TArrayView<const double> el, bool azccw, bool elplsz, const FVectorBatch& rectan)
+    {
+        const int32 Num = range.Num();
+        CheckSizes(Num, rectan.X, rectan.Y, rectan.Z);
+        check(az.Num() >= Num && el.Num() >= Num);
+
+        const double* R = range.GetData(); const double* Az = az.GetData(); const double* El = el.GetData();
+        double* X = rectan.X.GetData(); double* Y = rectan.Y.GetData(); double* Z = rectan.Z.GetData();
+        const double azsense = azccw ? 1. : -1.;
+        const double elsense = elplsz ? 1. : -1.;
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double a = azsense * Az[i], e = elsense * El[i];
+                const double p = R[i] * cos(e);
+                X[i] = p * cos(a);
+                Y[i] = p * sin(a);
+                Z[i] = R[i] * sin(e);
+            }
+        });
+    }
+
+
+    bool Recgeo(const FConstVectorBatch& rectan, double re, double f, TArrayView<double> lon, TArrayView<double> lat, TArrayView<double> alt)
+    {
+        if (!ValidEllipsoid(re, f))
+        {
+            return false;
+        }
+
+        const int32 Num = rectan.Num();
+        CheckSizes(Num, lon, lat, alt);
+
+        const double* X = rectan.X.GetData(); const double* Y = rectan.Y.GetData(); const double* Z = rectan.Z.GetData();
+        double* Lon = lon.GetData(); double* Lat = lat.GetData(); double* Alt = alt.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Geodetic(X[i], Y[i], Z[i], re, f, Lon[i], Lat[i], Alt[i]);
+            }
+        });
+
+        return true;
+    }
+
+
+    bool Georec(TArrayView<const double> lon, TArrayView<const double> lat, TArrayView<const double> alt, double re, double f, const FVectorBatch& rectan)
+    {
+        if (!ValidEllipsoid(re, f))
+        {
+            return false;
+        }
+
+        const int32 Num = lon.Num();
+        CheckSizes(Num, rectan.X, rectan.Y, rectan.Z);
+
+        const double* Lon = lon.GetData(); const double* Lat = lat.GetData(); const double* Alt = alt.GetData();
+        double* X = rectan.X.GetData(); double* Y = rectan.Y.GetData(); double* Z = rectan.Z.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Rectangular(Lon[i], Lat[i], Alt[i], re, f, X[i], Y[i], Z[i]);
+            }
+        });
+
+        return true;
+    }
+
+
+    bool Recpgr(const FConstVectorBatch& rectan, double re, double f, bool bPositiveWest, TArrayView<double> lon, TArrayView<double> lat, TArrayView<double> alt)
+    {
+        if (!ValidEllipsoid(re, f))
+        {
+            return false;
+        }
+
+        const int32 Num = rectan.Num();
+        CheckSizes(Num, lon, lat, alt);
+
+        const double sense = bPositiveWest ? -1. : 1.;
+        const double* X = rectan.X.GetData(); const double* Y = rectan.Y.GetData(); const double* Z = rectan.Z.GetData();
+        double* Lon = lon.GetData(); double* Lat = lat.GetData(); double* Alt = alt.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                double l;
+                Geodetic(X[i], Y[i], Z[i], re, f, l, Lat[i], Alt[i]);
+
+                // (as recpgr_)
+                l *= sense;
+                l = l < 0. ? l + twopi : l;
+                Lon[i] = FMath::Clamp(l, 0., twopi);
+            }
+        });
+
+        return true;
+    }
+
+
+    bool Pgrrec(TArrayView<const double> lon, TArrayView<const double> lat, TArrayView<const double> alt, double re, double f, bool bPositiveWest, const FVectorBatch& rectan)
+    {
+        if (!ValidEllipsoid(re, f))
+        {
+            return false;
+        }
+
+        const int32 Num = lon.Num();
+        CheckSizes(Num, rectan.X, rectan.Y, rectan.Z);
+
+        const double sense = bPositiveWest ? -1. : 1.;
+        const double* Lon = lon.GetData(); const double* Lat = lat.GetData(); const double* Alt = alt.GetData();
+        double* X = rectan.X.GetData(); double* Y = rectan.Y.GetData(); double* Z = rectan.Z.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Rectangular(sense * Lon[i], Lat[i], Alt[i], re, f, X[i], Y[i], Z[i]);
+            }
+        });
+
+        return true;
+    }
+
+
+    bool PlanetographicSense(
+        const FString& body,
+        bool& bPositiveWest,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        // Let recpgr_c decide:  +Y on a unit sphere is 90 degrees east, or
+        // 270 degrees west.
+        SpiceDouble rectan[3] = { 0., 1., 0. };
+        SpiceDouble lon = 0., lat = 0., alt = 0.;
+        recpgr_c(TCHAR_TO_ANSI(*body), rectan, 1., 0., &lon, &lat, &alt);
+
+        bPositiveWest = lon > pi;
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    namespace
+    {
+        // States per streamed chunk
+        constexpr int32 StreamChunkSize = 16 * ChunkSize;
+
+        struct FStateEllipsoid
+        {
+            double re, f, e2;
+            // Planetographic longitude sense
+            double sense;
+        };
+
+        // (latrec, drdlat;  cylrec, drdcyl;  etc)
+        template<ES_CoordinateSystem Sys>
+        inline void ToRectangular(const FStateEllipsoid& e, double (&s)[6])
+        {
+            if constexpr (Sys == ES_CoordinateSystem::CYLINDRICAL)
+            {
+                const double r = s[0], dr = s[3], dlon = s[4];
+                const double clon = cos(s[1]), slon = sin(s[1]);
+                s[0] = r * clon;
+                s[1] = r * slon;
+                s[3] = dr * clon - r * slon * dlon;
+                s[4] = dr * slon + r * clon * dlon;
+            }
+            else if constexpr (Sys == ES_CoordinateSystem::LATITUDINAL)
+            {
+                const double r = s[0], dr = s[3], dlon = s[4], dlat = s[5];
+                const double clon = cos(s[1]), slon = sin(s[1]);
+                const double clat = cos(s[2]), slat = sin(s[2]);
+                s[0] = r * clat * clon;
+                s[1] = r * clat * slon;
+                s[2] = r * slat;
+                s[3] = dr * clat * clon - r * slat * clon * dlat - r * clat * slon * dlon;
+                s[4] = dr * clat * slon - r * slat * slon * dlat + r * clat * clon * dlon;
+                s[5] = dr * slat + r * clat * dlat;
+            }
+            else if constexpr (Sys == ES_CoordinateSystem::SPHERICAL)
+            {
+                const double r = s[0], dr = s[3], dcolat = s[4], dlon = s[5];
+                const double ccolat = cos(s[1]), scolat = sin(s[1]);
+                const double clon = cos(s[2]), slon = sin(s[2]);
+                s[0] = r * scolat * clon;
+                s[1] = r * scolat * slon;
+                s[2] = r * ccolat;
+                s[3] = dr * scolat * clon + r * ccolat * clon * dcolat - r * scolat * slon * dlon;
+                s[4] = dr * scolat * slon + r * ccolat * slon * dcolat + r * scolat * clon * dlon;
+                s[5] = dr * ccolat - r * scolat * dcolat;
+            }
+            else if constexpr (Sys == ES_CoordinateSystem::GEODETIC || Sys == ES_CoordinateSystem::PLANETOGRAPHIC)
+            {
+                // The Jacobian's columns are the east, north and up unit
+                // vectors, scaled by the radii of curvature
+                const double sense = Sys == ES_CoordinateSystem::PLANETOGRAPHIC ? e.sense : 1.;
+                const double lon = sense * s[0], lat = s[1], alt = s[2];
+                const double dlon = sense * s[3], dlat = s[4], dalt = s[5];
+                const double clon = cos(lon), slon = sin(lon);
+                const double clat = cos(lat), slat = sin(lat);
+                const double w = 1. - e.e2 * slat * slat;
+                const double n = e.re / sqrt(w);
+                const double m = n * (1. - e.e2) / w;
+                s[0] = (n + alt) * clat * clon;
+                s[1] = (n + alt) * clat * slon;
+                s[2] = (n * (1. - e.e2) + alt) * slat;
+                s[3] = -(n + alt) * clat * slon * dlon - (m + alt) * slat * clon * dlat + clat * clon * dalt;
+                s[4] = (n + alt) * clat * clon * dlon - (m + alt) * slat * slon * dlat + clat * slon * dalt;
+                s[5] = (m + alt) * clat * dlat + slat * dalt;
+            }
+        }
+
+        // (reclat, dlatdr;  reccyl, dcyldr;  etc)
+        template<ES_CoordinateSystem Sys>
+        inline void FromRectangular(const FStateEllipsoid& e, double (&s)[6])
+        {
+            if constexpr (Sys == ES_CoordinateSystem::RECTANGULAR)
+            {
+                return;
+            }
+
+            const double x = s[0], y = s[1], z = s[2];
+            const double vx = s[3], vy = s[4], vz = s[5];
+            const double p2 = x * x + y * y;
+            const double p = sqrt(p2);
+            const double r2 = p2 + z * z;
+            const double r = sqrt(r2);
+            const double lon = p2 == 0. ? 0. : atan2(y, x);
+            const double dlon = p2 == 0. ? 0. : (x * vy - y * vx) / p2;
+
+            if constexpr (Sys == ES_CoordinateSystem::CYLINDRICAL)
+            {
+                s[0] = p;
+                s[1] = lon < 0. ? lon + twopi : lon;
+                s[3] = p2 == 0. ? 0. : (x * vx + y * vy) / p;
+                s[4] = dlon;
+            }
+            else if constexpr (Sys == ES_CoordinateSystem::LATITUDINAL || Sys == ES_CoordinateSystem::SPHERICAL)
+            {
+                const double dr = r == 0. ? 0. : (x * vx + y * vy + z * vz) / r;
+                const double dlat = p2 == 0. ? 0. : (p2 * vz - z * (x * vx + y * vy)) / (r2 * p);
+                if constexpr (Sys == ES_CoordinateSystem::LATITUDINAL)
+                {
+                    s[0] = r; s[1] = lon; s[2] = r == 0. ? 0. : atan2(z, p);
+                    s[3] = dr; s[4] = dlon; s[5] = dlat;
+                }
+                else
+                {
+                    s[0] = r; s[1] = r == 0. ? 0. : atan2(p, z); s[2] = lon;
+                    s[3] = dr; s[4] = -dlat; s[5] = dlon;
+                }
+            }
+            else if constexpr (Sys == ES_CoordinateSystem::GEODETIC || Sys == ES_CoordinateSystem::PLANETOGRAPHIC)
+            {
+                double glon, lat, alt;
+                Geodetic(x, y, z, e.re, e.f, glon, lat, alt);
+
+                // The Jacobian's columns are orthogonal (see ToRectangular),
+                // so its inverse is their transpose, each over its length
+                const double clon = cos(glon), slon = sin(glon);
+                const double clat = cos(lat), slat = sin(lat);
+                const double w = 1. - e.e2 * slat * slat;
+                const double n = e.re / sqrt(w);
+                const double m = n * (1. - e.e2) / w;
+                const double dglon = p2 == 0. ? 0. : (-slon * vx + clon * vy) / ((n + alt) * clat);
+                const double dlat = p2 == 0. ? 0. : (-slat * clon * vx - slat * slon * vy + clat * vz) / (m + alt);
+                const double dalt = clat * clon * vx + clat * slon * vy + slat * vz;
+
+                if constexpr (Sys == ES_CoordinateSystem::PLANETOGRAPHIC)
+                {
+                    // (as recpgr_)
+                    double l = e.sense * glon;
+                    l = l < 0. ? l + twopi : l;
+                    s[0] = FMath::Clamp(l, 0., twopi);
+                    s[3] = e.sense * dglon;
+                }
+                else
+                {
+                    s[0] = glon;
+                    s[3] = dglon;
+                }
+                s[1] = lat; s[2] = alt;
+                s[4] = dlat; s[5] = dalt;
+            }
+        }
+
+        struct FStateColumns
+        {
+            const double* In[6];
+            double* Out[6];
+        };
+
+        template<ES_CoordinateSystem Input, ES_CoordinateSystem Output>
+        void ConvertStates(const FStateColumns& c, const FStateEllipsoid& e, int32 Num)
+        {
+            ForEachChunk(Num, [&](int32 First, int32 Last)
+            {
+                const FStateColumns cc = c;
+                const FStateEllipsoid ee = e;
+                for (int32 i = First; i < Last; ++i)
+                {
+                    double s[6] = { cc.In[0][i], cc.In[1][i], cc.In[2][i], cc.In[3][i], cc.In[4][i], cc.In[5][i] };
+                    ToRectangular<Input>(ee, s);
+                    FromRectangular<Output>(ee, s);
+                    for (int32 j = 0; j < 6; ++j)
+                    {
+                        cc.Out[j][i] = s[j];
+                    }
+                }
+            });
+        }
+
+        template<ES_CoordinateSystem Input>
+        void ConvertStatesTo(ES_CoordinateSystem output, const FStateColumns& c, const FStateEllipsoid& e, int32 Num)
+        {
+            switch (output)
+            {
+            case ES_CoordinateSystem::RECTANGULAR:    ConvertStates<Input, ES_CoordinateSystem::RECTANGULAR>(c, e, Num); break;
+            case ES_CoordinateSystem::CYLINDRICAL:    ConvertStates<Input, ES_CoordinateSystem::CYLINDRICAL>(c, e, Num); break;
+            case ES_CoordinateSystem::LATITUDINAL:    ConvertStates<Input, ES_CoordinateSystem::LATITUDINAL>(c, e, Num); break;
+            case ES_CoordinateSystem::SPHERICAL:      ConvertStates<Input, ES_CoordinateSystem::SPHERICAL>(c, e, Num); break;
+            case ES_CoordinateSystem::GEODETIC:       ConvertStates<Input, ES_CoordinateSystem::GEODETIC>(c, e, Num); break;
+            case ES_CoordinateSystem::PLANETOGRAPHIC: ConvertStates<Input, ES_CoordinateSystem::PLANETOGRAPHIC>(c, e, Num); break;
+            default: break;
+            }
+        }
+
+        bool IsEllipsoidal(ES_CoordinateSystem sys)
+        {
+            return sys == ES_CoordinateSystem::GEODETIC || sys == ES_CoordinateSystem::PLANETOGRAPHIC;
+        }
+
+        bool CanConvertStates(ES_CoordinateSystem input, ES_CoordinateSystem output, double re, double f)
+        {
+            if (input == ES_CoordinateSystem::NONE || output == ES_CoordinateSystem::NONE)
+            {
+                return false;
+            }
+            // xfmsta doesn't look up the body when the systems are the same
+            return input == output || !(IsEllipsoidal(input) || IsEllipsoidal(output)) || ValidEllipsoid(re, f);
+        }
+
+        // (Already checked with CanConvertStates)
+        void ConvertStates(
+            const FConstVectorBatch& r,
+            const FConstVectorBatch& v,
+            ES_CoordinateSystem input,
+            ES_CoordinateSystem output,
+            const FVectorBatch& rout,
+            const FVectorBatch& vout,
+            double re,
+            double f,
+            bool bPositiveWest
+        )
+        {
+            const int32 Num = r.Num();
+            CheckSizes(Num, r.Y, r.Z, v.X);
+            CheckSizes(Num, v.X, v.Y, v.Z);
+            CheckSizes(Num, rout.X, rout.Y, rout.Z);
+            CheckSizes(Num, vout.X, vout.Y, vout.Z);
+
+            const FStateColumns c = {
+                { r.X.GetData(), r.Y.GetData(), r.Z.GetData(), v.X.GetData(), v.Y.GetData(), v.Z.GetData() },
+                { rout.X.GetData(), rout.Y.GetData(), rout.Z.GetData(), vout.X.GetData(), vout.Y.GetData(), vout.Z.GetData() }
+            };
+
+            // (as xfmsta)
+            if (input == output)
+            {
+                for (int32 j = 0; j < 6; ++j)
+                {
+                    FMemory::Memmove(c.Out[j], c.In[j], Num * sizeof(double));
+                }
+                return;
+            }
+
+            const FStateEllipsoid e = { re, f, f * (2. - f), bPositiveWest ? -1. : 1. };
+
+            switch (input)
+            {
+            case ES_CoordinateSystem::RECTANGULAR:    ConvertStatesTo<ES_CoordinateSystem::RECTANGULAR>(output, c, e, Num); break;
+            case ES_CoordinateSystem::CYLINDRICAL:    ConvertStatesTo<ES_CoordinateSystem::CYLINDRICAL>(output, c, e, Num); break;
+            case ES_CoordinateSystem::LATITUDINAL:    ConvertStatesTo<ES_CoordinateSystem::LATITUDINAL>(output, c, e, Num); break;
+            case ES_CoordinateSystem::SPHERICAL:      ConvertStatesTo<ES_CoordinateSystem::SPHERICAL>(output, c, e, Num); break;
+            case ES_CoordinateSystem::GEODETIC:       ConvertStatesTo<ES_CoordinateSystem::GEODETIC>(output, c, e, Num); break;
+            case ES_CoordinateSystem::PLANETOGRAPHIC: ConvertStatesTo<ES_CoordinateSystem::PLANETOGRAPHIC>(output, c, e, Num); break;
+            default: break;
+            }
+        }
+    }
+
+
+    bool Xfmsta(
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        ES_CoordinateSystem input,
+        ES_CoordinateSystem output,
+        const FVectorBatch& rout,
+        const FVectorBatch& vout,
+        double re,
+        double f,
+        bool bPositiveWest
+    )
+    {
+        if (!CanConvertStates(input, output, re, f))
+        {
+            return false;
+        }
+
+        ConvertStates(r, v, input, output, rout, vout, re, f, bPositiveWest);
+        return true;
+    }
+
+
+    bool Xfmsta(
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        ES_CoordinateSystem input,
+        ES_CoordinateSystem output,
+        FStateBatchSink Sink,
+        double re,
+        double f,
+        bool bPositiveWest
+    )
+    {
+        if (!CanConvertStates(input, output, re, f))
+        {
+            return false;
+        }
+
+        const int32 Num = r.Num();
+        const int32 Stride = FMath::Min(Num, StreamChunkSize);
+
+        FScratchScope Scratch;
+        double* Buffer = static_cast<double*>(Scratch.Alloc(6 * Stride * sizeof(double)));
+
+        for (int32 First = 0; First < Num; First += StreamChunkSize)
+        {
+            const int32 Count = FMath::Min(StreamChunkSize, Num - First);
+            const FVectorBatch rout{ MakeArrayView(Buffer, Count), MakeArrayView(Buffer + Stride, Count), MakeArrayView(Buffer + 2 * Stride, Count) };
+            const FVectorBatch vout{ MakeArrayView(Buffer + 3 * Stride, Count), MakeArrayView(Buffer + 4 * Stride, Count), MakeArrayView(Buffer + 5 * Stride, Count) };
+
+            ConvertStates(
+                FConstVectorBatch(r.X.Slice(First, Count), r.Y.Slice(First, Count), r.Z.Slice(First, Count)),
+                FConstVectorBatch(v.X.Slice(First, Count), v.Y.Slice(First, Count), v.Z.Slice(First, Count)),
+                input, output, rout, vout, re, f, bPositiveWest);
+
+            Sink(First, rout, vout);
+        }
+
+        return true;
+    }
+
+
+    bool AzlObserver(
+        const FSEphemerisTime& et,
+        const FSDistanceVector& obspos,
+        const FString& obsctr,
+        const FString& obsref,
+        const FString& ref,
+        bool azccw,
+        bool elplsz,
+        FAzlObserver& Observer,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        SpiceDouble xform[6][6];
+        sxform_c(TCHAR_TO_ANSI(*ref), TCHAR_TO_ANSI(*obsref), et.AsSpiceDouble(), xform);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        // azlcpo's ELLIPSOID topocentric frame
+        SpiceDouble p[3]; obspos.CopyTo(p);
+        SpiceDouble xftopo[3][3];
+        if (p[0] == 0. && p[1] == 0.)
+        {
+            // On the pole:  +X is the body-fixed +X, and +Z up (rotated pi
+            // about X, on the south pole)
+            ident_c(xftopo);
+            if (p[2] < 0.)
+            {
+                xftopo[1][1] = xftopo[2][2] = -1.;
+            }
+        }
+        else
+        {
+            SpiceInt n = 0;
+            SpiceDouble radii[3];
+            bodvrd_c(TCHAR_TO_ANSI(*obsctr), "RADII", 3, &n, radii);
+            SpiceDouble npoint[3], alt, normal[3];
+            nearpt_c(p, radii[0], radii[1], radii[2], npoint, &alt);
+            surfnm_c(radii[0], radii[1], radii[2], npoint, normal);
+            const SpiceDouble z[3] = { 0., 0., 1. };
+            twovec_c(normal, 3, z, 1, xftopo);
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+        }
+
+        // diag(xftopo, xftopo) * xform.  xform's upper right block is zero.
+        SpiceDouble m[6][6] = {};
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                double r = 0., dr = 0.;
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    r += xftopo[i][k] * xform[k][j];
+                    dr += xftopo[i][k] * xform[k + 3][j];
+                }
+                m[i][j] = m[i + 3][j + 3] = r;
+                m[i + 3][j] = dr;
+            }
+        }
+
+        SpiceDouble topo[3];
+        mxv_c(xftopo, p, topo);
+
+        SpiceDouble rotation[3][3];
+        for (int32 i = 0; i < 3; ++i)
+        {
+            for (int32 j = 0; j < 3; ++j)
+            {
+                rotation[i][j] = m[i][j];
+            }
+        }
+
+        Observer.Transform = FSStateTransform(m);
+        Observer.Rotation = FSRotationMatrix(rotation);
+        Observer.Position = FSDistanceVector(topo);
+        Observer.azccw = azccw;
+        Observer.elplsz = elplsz;
+
+        return true;
+    }
+
+
+    void Azlcpo(
+        const FAzlObserver& Observer,
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        TArrayView<double> range,
+        TArrayView<double> az,
+        TArrayView<double> el,
+        TArrayView<double> rangeRate,
+        TArrayView<double> azRate,
+        TArrayView<double> elRate
+    )
+    {
+        const int32 Num = r.Num();
+        check(v.Num() >= Num);
+        CheckSizes(Num, range, az, el);
+        CheckSizes(Num, rangeRate, azRate, elRate);
+
+        double _m[6][6]; Observer.Transform.CopyTo(_m);
+        double _o[3]; Observer.Position.CopyTo(_o);
+        const double azsense = Observer.azccw ? 1. : -1.;
+        const double elsense = Observer.elplsz ? 1. : -1.;
+        const bool azccw = Observer.azccw;
+
+        const double* R[3] = { r.X.GetData(), r.Y.GetData(), r.Z.GetData() };
+        const double* V[3] = { v.X.GetData(), v.Y.GetData(), v.Z.GetData() };
+        double* Range = range.GetData(); double* Az = az.GetData(); double* El = el.GetData();
+        double* DRange = rangeRate.GetData(); double* DAz = azRate.GetData(); double* DEl = elRate.GetData();
+
+        ForEachChunk(Num, [&](int32 First, int32 Last)
+        {
+            double mm[6][6];
+            FMemory::Memcpy(mm, _m, sizeof(mm));
+            const double ox = _o[0], oy = _o[1], oz = _o[2];
+
+            for (int32 i = First; i < Last; ++i)
+            {
+                // The target relative to the station, topocentric
+                const double s[6] = { R[0][i], R[1][i], R[2][i], V[0][i], V[1][i], V[2][i] };
+                double t[6];
+                for (int32 j = 0; j < 6; ++j)
+                {
+                    t[j] = mm[j][0] * s[0] + mm[j][1] * s[1] + mm[j][2] * s[2] + mm[j][3] * s[3] + mm[j][4] * s[4] + mm[j][5] * s[5];
+                }
+                const double x = t[0] - ox, y = t[1] - oy, z = t[2] - oz;
+                const double vx = t[3], vy = t[4], vz = t[5];
+
+                const double p2 = x * x + y * y;
+                const double r2 = p2 + z * z;
+                const double p = sqrt(p2);
+                const double rr = sqrt(r2);
+
+                double a = p2 == 0. ? 0. : atan2(y, x);
+                a = a < 0. ? a + twopi : a;
+                Range[i] = rr;
+                Az[i] = (azccw || a == 0.) ? a : FMath::Max(twopi - a, 0.);
+                El[i] = rr == 0. ? 0. : elsense * atan2(z, p);
+
+                // dazldr's Jacobian, times the velocity
+                DRange[i] = rr == 0. ? 0. : (x * vx + y * vy + z * vz) / rr;
+                if (p2 == 0.)
+                {
+                    DAz[i] = 0.;
+                    DEl[i] = 0.;
+                }
+                else
+                {
+                    DAz[i] = azsense * (x * vy - y * vx) / p2;
+                    DEl[i] = elsense * (p2 * vz - z * (x * vx + y * vy)) / (r2 * p);
+                }
+            }
+        });
+    }
+
+
+    namespace
+    {
+        // Row-major 3x3, optionally transposed
+        struct FMatrix3
+        {
+            double m00, m01, m02, m10, m11, m12, m20, m21, m22;
+
+            FMatrix3(const FSRotationMatrix& m, bool bTranspose)
+            {
+                double _m[3][3]; m.CopyTo(_m);
+                if (bTranspose)
+                {
+                    m00 = _m[0][0]; m01 = _m[1][0]; m02 = _m[2][0];
+                    m10 = _m[0][1]; m11 = _m[1][1]; m12 = _m[2][1];
+                    m20 = _m[0][2]; m21 = _m[1][2]; m22 = _m[2][2];
+                }
+                else
+                {
+                    m00 = _m[0][0]; m01 = _m[0][1]; m02 = _m[0][2];
+                    m10 = _m[1][0]; m11 = _m[1][1]; m12 = _m[1][2];
+                    m20 = _m[2][0]; m21 = _m[2][1]; m22 = _m[2][2];
+                }
+            }
+        };
+
+        void RotateBatch(const FMatrix3 m, const FConstVectorBatch& v, const FVectorBatch& vout)
+        {
+            const int32 Num = v.Num();
+            check(v.Y.Num() >= Num && v.Z.Num() >= Num);
+            check(vout.X.Num() >= Num && vout.Y.Num() >= Num && vout.Z.Num() >= Num);
+
+            const double* X = v.X.GetData(); const double* Y = v.Y.GetData(); const double* Z = v.Z.GetData();
+            double* XO = vout.X.GetData(); double* YO = vout.Y.GetData(); double* ZO = vout.Z.GetData();
+
+            ForEachChunk(Num, [=](int32 First, int32 Last)
+            {
+                for (int32 i = First; i < Last; ++i)
+                {
+                    const double x = X[i], y = Y[i], z = Z[i];
+                    XO[i] = m.m00 * x + m.m01 * y + m.m02 * z;
+                    YO[i] = m.m10 * x + m.m11 * y + m.m12 * z;
+                    ZO[i] = m.m20 * x + m.m21 * y + m.m22 * z;
+                }
+            });
+        }
+
+        void RotateInterleaved(const FMatrix3 m, TArrayView<const double> xyz, TArrayView<double> xyzout)
+        {
+            check(xyz.Num() % 3 == 0);
+            check(xyzout.Num() >= xyz.Num());
+
+            const int32 Num = xyz.Num() / 3;
+            const double* In = xyz.GetData();
+            double* Out = xyzout.GetData();
+
+            ForEachChunk(Num, [=](int32 First, int32 Last)
+            {
+                for (int32 i = First; i < Last; ++i)
+                {
+                    const double x = In[3 * i], y = In[3 * i + 1], z = In[3 * i + 2];
+                    Out[3 * i] = m.m00 * x + m.m01 * y + m.m02 * z;
+                    Out[3 * i + 1] = m.m10 * x + m.m11 * y + m.m12 * z;
+                    Out[3 * i + 2] = m.m20 * x + m.m21 * y + m.m22 * z;
+                }
+            });
+        }
+    }
+
+
+    void MxV(const FSRotationMatrix& m, const FConstVectorBatch& v, const FVectorBatch& vout)
+    {
+        RotateBatch(FMatrix3(m, false), v, vout);
+    }
+
+
+    void MTxV(const FSRotationMatrix& m, const FConstVectorBatch& v, const FVectorBatch& vout)
+    {
+        RotateBatch(FMatrix3(m, true), v, vout);
+    }
+
+
+    void MxV(const FSRotationMatrix& m, TArrayView<const double> xyz, TArrayView<double> xyzout)
+    {
+        RotateInterleaved(FMatrix3(m, false), xyz, xyzout);
+    }
+
+
+    void MTxV(const FSRotationMatrix& m, TArrayView<const double> xyz, TArrayView<double> xyzout)
+    {
+        RotateInterleaved(FMatrix3(m, true), xyz, xyzout);
+    }
+
+
+    void MxV(const FSRotationMatrix& m, TArrayView<const FSDistanceVector> v, TArrayView<FSDistanceVector> vout)
+    {
+        check(vout.Num() >= v.Num());
+
+        const FMatrix3 mm(m, false);
+        const FSDistanceVector* In = v.GetData();
+        FSDistanceVector* Out = vout.GetData();
+
+        ForEachChunk(v.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double x = In[i].x.km, y = In[i].y.km, z = In[i].z.km;
+                Out[i].x.km = mm.m00 * x + mm.m01 * y + mm.m02 * z;
+                Out[i].y.km = mm.m10 * x + mm.m11 * y + mm.m12 * z;
+                Out[i].z.km = mm.m20 * x + mm.m21 * y + mm.m22 * z;
+            }
+        });
+    }
+
+
+    void MxV(const FSStateTransform& m, const FConstVectorBatch& r, const FConstVectorBatch& v, const FVectorBatch& rout, const FVectorBatch& vout)
+    {
+        const int32 Num = r.Num();
+        check(v.Num() >= Num && rout.Num() >= Num && vout.Num() >= Num);
+
+        double _m[6][6]; m.CopyTo(_m);
+        const double* R[3] = { r.X.GetData(), r.Y.GetData(), r.Z.GetData() };
+        const double* V[3] = { v.X.GetData(), v.Y.GetData(), v.Z.GetData() };
+        double* RO[3] = { rout.X.GetData(), rout.Y.GetData(), rout.Z.GetData() };
+        double* VO[3] = { vout.X.GetData(), vout.Y.GetData(), vout.Z.GetData() };
+
+        ForEachChunk(Num, [&](int32 First, int32 Last)
+        {
+            double mm[6][6];
+            FMemory::Memcpy(mm, _m, sizeof(mm));
+
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double s[6] = { R[0][i], R[1][i], R[2][i], V[0][i], V[1][i], V[2][i] };
+                double o[6];
+                for (int32 j = 0; j < 6; ++j)
+                {
+                    o[j] = mm[j][0] * s[0] + mm[j][1] * s[1] + mm[j][2] * s[2] + mm[j][3] * s[3] + mm[j][4] * s[4] + mm[j][5] * s[5];
+                }
+                RO[0][i] = o[0]; RO[1][i] = o[1]; RO[2][i] = o[2];
+                VO[0][i] = o[3]; VO[1][i] = o[4]; VO[2][i] = o[5];
+            }
+        });
+    }
+
+
+    void MxV(const FSStateTransform& m, TArrayView<const FSStateVector> states, TArrayView<FSStateVector> statesout)
+    {
+        check(statesout.Num() >= states.Num());
+
+        double _m[6][6]; m.CopyTo(_m);
+        const FSStateVector* In = states.GetData();
+        FSStateVector* Out = statesout.GetData();
+
+        ForEachChunk(states.Num(), [&](int32 First, int32 Last)
+        {
+            double mm[6][6];
+            FMemory::Memcpy(mm, _m, sizeof(mm));
+
+            for (int32 i = First; i < Last; ++i)
+            {
+                double s[6]; In[i].CopyTo(s);
+                double o[6];
+                for (int32 j = 0; j < 6; ++j)
+                {
+                    o[j] = mm[j][0] * s[0] + mm[j][1] * s[1] + mm[j][2] * s[2] + mm[j][3] * s[3] + mm[j][4] * s[4] + mm[j][5] * s[5];
+                }
+                Out[i] = FSStateVector(o);
+            }
+        });
+    }
+
+
+    void MxV(const FSRotationMatrix& m, TArrayView<const FSDimensionlessVector> v, TArrayView<FSDimensionlessVector> vout)
+    {
+        check(vout.Num() >= v.Num());
+
+        const FMatrix3 mm(m, false);
+        const FSDimensionlessVector* In = v.GetData();
+        FSDimensionlessVector* Out = vout.GetData();
+
+        ForEachChunk(v.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double x = In[i].x, y = In[i].y, z = In[i].z;
+                Out[i].x = mm.m00 * x + mm.m01 * y + mm.m02 * z;
+                Out[i].y = mm.m10 * x + mm.m11 * y + mm.m12 * z;
+                Out[i].z = mm.m20 * x + mm.m21 * y + mm.m22 * z;
+            }
+        });
+    }
+
+
+    void MxV(const FSStateTransform& m, TArrayView<const FSDimensionlessStateVector> states, TArrayView<FSDimensionlessStateVector> statesout)
+    {
+        check(statesout.Num() >= states.Num());
+
+        double _m[6][6]; m.CopyTo(_m);
+        const FSDimensionlessStateVector* In = states.GetData();
+        FSDimensionlessStateVector* Out = statesout.GetData();
+
+        ForEachChunk(states.Num(), [&](int32 First, int32 Last)
+        {
+            double mm[6][6];
+            FMemory::Memcpy(mm, _m, sizeof(mm));
+
+            for (int32 i = First; i < Last; ++i)
+            {
+                double s[6]; In[i].CopyTo(s);
+                double o[6];
+                for (int32 j = 0; j < 6; ++j)
+                {
+                    o[j] = mm[j][0] * s[0] + mm[j][1] * s[1] + mm[j][2] * s[2] + mm[j][3] * s[3] + mm[j][4] * s[4] + mm[j][5] * s[5];
+                }
+                Out[i] = FSDimensionlessStateVector(o);
+            }
+        });
+    }
+
+
+    bool Stelab(const FConstVectorBatch& pobj, const FSVelocityVector& vobs, const FVectorBatch& appobj)
+    {
+        const int32 Num = pobj.Num();
+        CheckSizes(Num, appobj.X, appobj.Y, appobj.Z);
+
+        const double bx = vobs.dx.AsKilometersPerSecond() / clight;
+        const double by = vobs.dy.AsKilometersPerSecond() / clight;
+        const double bz = vobs.dz.AsKilometersPerSecond() / clight;
+        if (bx * bx + by * by + bz * bz >= 1.)
+        {
+            return false;
+        }
+
+        const double* X = pobj.X.GetData(); const double* Y = pobj.Y.GetData(); const double* Z = pobj.Z.GetData();
+        double* Xout = appobj.X.GetData(); double* Yout = appobj.Y.GetData(); double* Zout = appobj.Z.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double x = X[i], y = Y[i], z = Z[i];
+                const double r = sqrt(x * x + y * y + z * z);
+                const double s = r > 0. ? 1. / r : 0.;
+
+                // h = u x v/c, |h| = sin(phi).  h is normal to pobj, so
+                // rotating pobj by phi about h (vrotv) is
+                // pobj cos(phi) + h x pobj.
+                const double hx = s * (y * bz - z * by);
+                const double hy = s * (z * bx - x * bz);
+                const double hz = s * (x * by - y * bx);
+                const double cosphi = sqrt(FMath::Max(0., 1. - (hx * hx + hy * hy + hz * hz)));
+
+                Xout[i] = x * cosphi + (hy * z - hz * y);
+                Yout[i] = y * cosphi + (hz * x - hx * z);
+                Zout[i] = z * cosphi + (hx * y - hy * x);
+            }
+        });
+
+        return true;
+    }
+
+
+    namespace
+    {
+        // A SPICE style quaternion (w is the scalar), in locals
+        struct FQ
+        {
+            double w, x, y, z;
+
+            FQ(double _w, double _x, double _y, double _z) : w(_w), x(_x), y(_y), z(_z) {}
+            explicit FQ(const FSQuaternion& q) : w(q.w), x(q.x), y(q.y), z(q.z) {}
+
+            FSQuaternion ToSpice() const { return FSQuaternion(w, x, y, z); }
+            FQ operator-() const { return FQ(-w, -x, -y, -z); }
+            FQ operator*(double k) const { return FQ(k * w, k * x, k * y, k * z); }
+            FQ operator+(const FQ& b) const { return FQ(w + b.w, x + b.x, y + b.y, z + b.z); }
+        };
+
+        inline double Dot(const FQ& a, const FQ& b)
+        {
+            return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+        }
+
+        // qxq
+        inline FQ Mul(const FQ& a, const FQ& b)
+        {
+            return FQ(
+                a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+                a.w * b.x + b.w * a.x + a.y * b.z - a.z * b.y,
+                a.w * b.y + b.w * a.y + a.z * b.x - a.x * b.z,
+                a.w * b.z + b.w * a.z + a.x * b.y - a.y * b.x
+            );
+        }
+
+        inline FQ Conj(const FQ& a)
+        {
+            return FQ(a.w, -a.x, -a.y, -a.z);
+        }
+
+        inline FQ Normalized(const FQ& a)
+        {
+            const double l = sqrt(Dot(a, a));
+            return l > 0. ? a * (1. / l) : FQ(1., 0., 0., 0.);
+        }
+
+        // Of a unit quaternion (a pure quaternion:  half the rotation vector)
+        inline FQ Log(const FQ& a)
+        {
+            const double s = sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+            if (s == 0.)
+            {
+                return FQ(0., 0., 0., 0.);
+            }
+            const double k = atan2(s, a.w) / s;
+            return FQ(0., k * a.x, k * a.y, k * a.z);
+        }
+
+        // Of a pure quaternion
+        inline FQ Exp(const FQ& a)
+        {
+            const double theta = sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+            if (theta == 0.)
+            {
+                return FQ(1., 0., 0., 0.);
+            }
+            const double k = sin(theta) / theta;
+            return FQ(cos(theta), k * a.x, k * a.y, k * a.z);
+        }
+
+        // Along the arc from a to b, whichever way that is
+        inline FQ SlerpArc(const FQ& a, const FQ& b, double t)
+        {
+            const double d = FMath::Clamp(Dot(a, b), -1., 1.);
+            const double theta = acos(d);
+            const double s = sin(theta);
+
+            // Nearly the same attitude:  the chord is the arc
+            if (s < 1e-6)
+            {
+                return Normalized(a * (1. - t) + b * t);
+            }
+
+            return Normalized(a * (sin((1. - t) * theta) / s) + b * (sin(t * theta) / s));
+        }
+
+        inline FQ Slerp(const FQ& a, const FQ& b, double t)
+        {
+            return SlerpArc(a, Dot(a, b) < 0. ? -b : b, t);
+        }
+    }
+
+
+    void M2q(TArrayView<const double> m, TArrayView<FSQuaternion> q)
+    {
+        check(m.Num() % 9 == 0);
+        const int32 Num = m.Num() / 9;
+        check(q.Num() >= Num);
+
+        const double* In = m.GetData();
+        FSQuaternion* Out = q.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double* mi = In + 9 * i;
+                const double _m[3][3] = { { mi[0], mi[1], mi[2] }, { mi[3], mi[4], mi[5] }, { mi[6], mi[7], mi[8] } };
+                double _q[4];
+                MaxQ::Private::M2q(_m, _q);
+                Out[i] = FSQuaternion(_q);
+            }
+        });
+    }
+
+
+    void M2q(TArrayView<const FSRotationMatrix> m, TArrayView<FSQuaternion> q)
+    {
+        const int32 Num = m.Num();
+        check(q.Num() >= Num);
+
+        const FSRotationMatrix* In = m.GetData();
+        FSQuaternion* Out = q.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                double _m[3][3]; In[i].CopyTo(_m);
+                double _q[4];
+                MaxQ::Private::M2q(_m, _q);
+                Out[i] = FSQuaternion(_q);
+            }
+        });
+    }
+
+
+    void Q2m(TArrayView<const FSQuaternion> q, TArrayView<double> m)
+    {
+        const int32 Num = q.Num();
+        check(m.Num() >= 9 * Num);
+
+        const FSQuaternion* In = q.GetData();
+        double* Out = m.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double q0 = In[i].w, q1 = In[i].x, q2 = In[i].y, q3 = In[i].z;
+                const double l2 = q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3;
+                // (q2m's sharpening, for non-unit quaternions)
+                const double k = (l2 != 1. && l2 != 0.) ? 2. / l2 : 2.;
+
+                double* mi = Out + 9 * i;
+                mi[0] = 1. - k * (q2 * q2 + q3 * q3);
+                mi[1] = k * (q1 * q2 - q0 * q3);
+                mi[2] = k * (q1 * q3 + q0 * q2);
+                mi[3] = k * (q1 * q2 + q0 * q3);
+                mi[4] = 1. - k * (q1 * q1 + q3 * q3);
+                mi[5] = k * (q2 * q3 - q0 * q1);
+                mi[6] = k * (q1 * q3 - q0 * q2);
+                mi[7] = k * (q2 * q3 + q0 * q1);
+                mi[8] = 1. - k * (q1 * q1 + q2 * q2);
+            }
+        });
+    }
+
+
+    void Qxq(TArrayView<const FSQuaternion> q1, TArrayView<const FSQuaternion> q2, TArrayView<FSQuaternion> qout)
+    {
+        const int32 Num = q1.Num();
+        check(q2.Num() >= Num && qout.Num() >= Num);
+
+        const FSQuaternion* A = q1.GetData();
+        const FSQuaternion* B = q2.GetData();
+        FSQuaternion* Out = qout.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Out[i] = Mul(FQ(A[i]), FQ(B[i])).ToSpice();
+            }
+        });
+    }
+
+
+    void Slerp(TArrayView<const FSQuaternion> q0, TArrayView<const FSQuaternion> q1, TArrayView<const double> t, TArrayView<FSQuaternion> qout)
+    {
+        const int32 Num = q0.Num();
+        check(q1.Num() >= Num && t.Num() >= Num && qout.Num() >= Num);
+
+        const FSQuaternion* A = q0.GetData();
+        const FSQuaternion* B = q1.GetData();
+        const double* T = t.GetData();
+        FSQuaternion* Out = qout.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Out[i] = Slerp(FQ(A[i]), FQ(B[i]), T[i]).ToSpice();
+            }
+        });
+    }
+
+
+    void SquadTangents(TArrayView<const FSQuaternion> samples, TArrayView<FSQuaternion> tangents)
+    {
+        const int32 Num = samples.Num();
+        check(tangents.Num() >= Num);
+
+        const FSQuaternion* Q = samples.GetData();
+        FSQuaternion* Out = tangents.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                // The ends don't curve
+                if (i == 0 || i == Num - 1)
+                {
+                    Out[i] = Q[i];
+                    continue;
+                }
+
+                // s = q exp(-(log(q^-1 next) + log(q^-1 prev)) / 4), with the
+                // neighbors on q's side
+                const FQ q(Q[i]);
+                FQ prev(Q[i - 1]), next(Q[i + 1]);
+                if (Dot(q, prev) < 0.) prev = -prev;
+                if (Dot(q, next) < 0.) next = -next;
+
+                const FQ inv = Conj(q);
+                const FQ l = Log(Mul(inv, next)) + Log(Mul(inv, prev));
+                Out[i] = Normalized(Mul(q, Exp(l * -.25))).ToSpice();
+            }
+        });
+    }
+
+
+    void InterpolateAttitude(
+        TArrayView<const double> times,
+        TArrayView<const FSQuaternion> samples,
+        TArrayView<const FSQuaternion> tangents,
+        TArrayView<const double> et,
+        TArrayView<FSQuaternion> qout
+    )
+    {
+        const int32 NumSamples = times.Num();
+        const int32 Num = et.Num();
+        check(samples.Num() >= NumSamples && qout.Num() >= Num);
+        check(tangents.Num() == 0 || tangents.Num() >= NumSamples);
+
+        if (NumSamples == 0)
+        {
+            return;
+        }
+
+        const bool bSquad = tangents.Num() > 0;
+        const double* Times = times.GetData();
+        const FSQuaternion* Q = samples.GetData();
+        const FSQuaternion* S = tangents.GetData();
+        const double* ET = et.GetData();
+        FSQuaternion* Out = qout.GetData();
+
+        ForEachChunk(Num, [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                if (ET[i] <= Times[0])
+                {
+                    Out[i] = Q[0];
+                    continue;
+                }
+                if (ET[i] >= Times[NumSamples - 1])
+                {
+                    Out[i] = Q[NumSamples - 1];
+                    continue;
+                }
+
+                // Times[j] <= ET[i] < Times[j + 1]
+                const int32 j = Algo::UpperBound(TArrayView<const double>(Times, NumSamples), ET[i]) - 1;
+                const double h = (ET[i] - Times[j]) / (Times[j + 1] - Times[j]);
+
+                const FQ a(Q[j]);
+                FQ b(Q[j + 1]);
+                const bool bFlip = Dot(a, b) < 0.;
+                if (bFlip) b = -b;
+
+                if (!bSquad)
+                {
+                    Out[i] = SlerpArc(a, b, h).ToSpice();
+                    continue;
+                }
+
+                const FQ sa(S[j]);
+                const FQ sb = bFlip ? -FQ(S[j + 1]) : FQ(S[j + 1]);
+                Out[i] = SlerpArc(SlerpArc(a, b, h), SlerpArc(sa, sb, h), 2. * h * (1. - h)).ToSpice();
+            }
+        });
+    }
+
+
+    void Vadd(TArrayView<const FSDimensionlessVector> v1, TArrayView<const FSDimensionlessVector> v2, TArrayView<FSDimensionlessVector> vout)
+    {
+        check(v2.Num() >= v1.Num() && vout.Num() >= v1.Num());
+
+        const FSDimensionlessVector* A = v1.GetData();
+        const FSDimensionlessVector* B = v2.GetData();
+        FSDimensionlessVector* Out = vout.GetData();
+
+        ForEachChunk(v1.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Out[i] = FSDimensionlessVector(A[i].x + B[i].x, A[i].y + B[i].y, A[i].z + B[i].z);
+            }
+        });
+    }
+
+
+    void Vsub(TArrayView<const FSDimensionlessVector> v1, TArrayView<const FSDimensionlessVector> v2, TArrayView<FSDimensionlessVector> vout)
+    {
+        check(v2.Num() >= v1.Num() && vout.Num() >= v1.Num());
+
+        const FSDimensionlessVector* A = v1.GetData();
+        const FSDimensionlessVector* B = v2.GetData();
+        FSDimensionlessVector* Out = vout.GetData();
+
+        ForEachChunk(v1.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Out[i] = FSDimensionlessVector(A[i].x - B[i].x, A[i].y - B[i].y, A[i].z - B[i].z);
+            }
+        });
+    }
+
+
+    void Vadd(TArrayView<const FSDimensionlessStateVector> v1, TArrayView<const FSDimensionlessStateVector> v2, TArrayView<FSDimensionlessStateVector> vout)
+    {
+        check(v2.Num() >= v1.Num() && vout.Num() >= v1.Num());
+
+        const FSDimensionlessStateVector* A = v1.GetData();
+        const FSDimensionlessStateVector* B = v2.GetData();
+        FSDimensionlessStateVector* Out = vout.GetData();
+
+        ForEachChunk(v1.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Out[i] = FSDimensionlessStateVector(
+                    FSDimensionlessVector(A[i].r.x + B[i].r.x, A[i].r.y + B[i].r.y, A[i].r.z + B[i].r.z),
+                    FSDimensionlessVector(A[i].dr.x + B[i].dr.x, A[i].dr.y + B[i].dr.y, A[i].dr.z + B[i].dr.z)
+                );
+            }
+        });
+    }
+
+
+    void Vsub(TArrayView<const FSDimensionlessStateVector> v1, TArrayView<const FSDimensionlessStateVector> v2, TArrayView<FSDimensionlessStateVector> vout)
+    {
+        check(v2.Num() >= v1.Num() && vout.Num() >= v1.Num());
+
+        const FSDimensionlessStateVector* A = v1.GetData();
+        const FSDimensionlessStateVector* B = v2.GetData();
+        FSDimensionlessStateVector* Out = vout.GetData();
+
+        ForEachChunk(v1.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Out[i] = FSDimensionlessStateVector(
+                    FSDimensionlessVector(A[i].r.x - B[i].r.x, A[i].r.y - B[i].r.y, A[i].r.z - B[i].r.z),
+                    FSDimensionlessVector(A[i].dr.x - B[i].dr.x, A[i].dr.y - B[i].dr.y, A[i].dr.z - B[i].dr.z)
+                );
+            }
+        });
+    }
+
+
+    void Vnorm(TArrayView<const FSDimensionlessVector> v, TArrayView<double> vmag)
+    {
+        check(vmag.Num() >= v.Num());
+
+        const FSDimensionlessVector* In = v.GetData();
+        double* Mag = vmag.GetData();
+
+        ForEachChunk(v.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Mag[i] = FMath::Sqrt(In[i].x * In[i].x + In[i].y * In[i].y + In[i].z * In[i].z);
+            }
+        });
+    }
+
+
+    void Unorm(TArrayView<const FSDimensionlessVector> v, TArrayView<FSDimensionlessVector> vout, TArrayView<double> vmag)
+    {
+        check(vout.Num() >= v.Num() && vmag.Num() >= v.Num());
+
+        const FSDimensionlessVector* In = v.GetData();
+        FSDimensionlessVector* Out = vout.GetData();
+        double* Mag = vmag.GetData();
+
+        ForEachChunk(v.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double x = In[i].x, y = In[i].y, z = In[i].z;
+                const double Norm = FMath::Sqrt(x * x + y * y + z * z);
+                const double Scale = Norm > 0. ? 1. / Norm : 0.;
+                Out[i] = FSDimensionlessVector(x * Scale, y * Scale, z * Scale);
+                Mag[i] = Norm;
+            }
+        });
+    }
+
+
+    namespace
+    {
+        bool ValidRadii(double a, double b, double c)
+        {
+            return a > 0. && b > 0. && c > 0.;
+        }
+
+        inline double RobustLength(double v0, double v1, double v2 = 0.)
+        {
+            const double m = FMath::Max3(FMath::Abs(v0), FMath::Abs(v1), FMath::Abs(v2));
+            if (m == 0.)
+            {
+                return 0.;
+            }
+            v0 /= m; v1 /= m; v2 /= m;
+            return m * sqrt(v0 * v0 + v1 * v1 + v2 * v2);
+        }
+
+        // Bisect g(s) = sum((r_i z_i / (s + r_i))^2) - 1 to the last bit.
+        // The last term's r is 1.
+        template<int32 N>
+        double EllipseRoot(const double(&r)[N], const double(&z)[N], double g)
+        {
+            double n[N];
+            for (int32 i = 0; i < N; ++i)
+            {
+                n[i] = r[i] * z[i];
+            }
+            double s0 = z[N - 1] - 1.;
+            double s1 = g < 0. ? 0. : (N == 3 ? RobustLength(n[0], n[1], n[N - 1]) : RobustLength(n[0], n[N - 1])) - 1.;
+            double s = 0.;
+            for (int32 i = 0; i < 2100; ++i)
+            {
+                s = 0.5 * (s0 + s1);
+                if (s == s0 || s == s1)
+                {
+                    break;
+                }
+                double sum = 0.;
+                for (int32 k = 0; k < N; ++k)
+                {
+                    const double ratio = n[k] / (s + r[k]);
+                    sum += ratio * ratio;
+                }
+                g = sum - 1.;
+                if (g > 0.) s0 = s; else if (g < 0.) s1 = s; else break;
+            }
+            return s;
+        }
+
+        // Nearest point on an ellipse, e0 >= e1 > 0, y0, y1 >= 0
+        void NearestOnEllipse(double e0, double e1, double y0, double y1, double& x0, double& x1)
+        {
+            if (y1 > 0.)
+            {
+                if (y0 > 0.)
+                {
+                    const double z[2] = { y0 / e0, y1 / e1 };
+                    const double g = z[0] * z[0] + z[1] * z[1] - 1.;
+                    if (g != 0.)
+                    {
+                        const double r[2] = { (e0 / e1) * (e0 / e1), 1. };
+                        const double s = EllipseRoot(r, z, g);
+                        x0 = r[0] * y0 / (s + r[0]);
+                        x1 = y1 / (s + 1.);
+                    }
+                    else
+                    {
+                        x0 = y0; x1 = y1;
+                    }
+                }
+                else
+                {
+                    x0 = 0.; x1 = e1;
+                }
+            }
+            else
+            {
+                const double numer0 = e0 * y0, denom0 = e0 * e0 - e1 * e1;
+                if (numer0 < denom0)
+                {
+                    const double xde0 = numer0 / denom0;
+                    x0 = e0 * xde0;
+                    x1 = e1 * sqrt(1. - xde0 * xde0);
+                }
+                else
+                {
+                    x0 = e0; x1 = 0.;
+                }
+            }
+        }
+
+        // Nearest point on an ellipsoid, e0 >= e1 >= e2 > 0, y >= 0
+        void NearestOnEllipsoid(const double(&e)[3], const double(&y)[3], double(&x)[3])
+        {
+            if (y[2] > 0.)
+            {
+                if (y[1] > 0.)
+                {
+                    if (y[0] > 0.)
+                    {
+                        const double z[3] = { y[0] / e[0], y[1] / e[1], y[2] / e[2] };
+                        const double g = z[0] * z[0] + z[1] * z[1] + z[2] * z[2] - 1.;
+                        if (g != 0.)
+                        {
+                            const double r[3] = { (e[0] / e[2]) * (e[0] / e[2]), (e[1] / e[2]) * (e[1] / e[2]), 1. };
+                            const double s = EllipseRoot(r, z, g);
+                            x[0] = r[0] * y[0] / (s + r[0]);
+                            x[1] = r[1] * y[1] / (s + r[1]);
+                            x[2] = y[2] / (s + 1.);
+                        }
+                        else
+                        {
+                            x[0] = y[0]; x[1] = y[1]; x[2] = y[2];
+                        }
+                    }
+                    else
+                    {
+                        x[0] = 0.;
+                        NearestOnEllipse(e[1], e[2], y[1], y[2], x[1], x[2]);
+                    }
+                }
+                else if (y[0] > 0.)
+                {
+                    x[1] = 0.;
+                    NearestOnEllipse(e[0], e[2], y[0], y[2], x[0], x[2]);
+                }
+                else
+                {
+                    x[0] = 0.; x[1] = 0.; x[2] = e[2];
+                }
+            }
+            else
+            {
+                const double denom0 = e[0] * e[0] - e[2] * e[2], denom1 = e[1] * e[1] - e[2] * e[2];
+                const double numer0 = e[0] * y[0], numer1 = e[1] * y[1];
+                if (numer0 < denom0 && numer1 < denom1)
+                {
+                    const double xde0 = numer0 / denom0, xde1 = numer1 / denom1;
+                    const double discr = 1. - xde0 * xde0 - xde1 * xde1;
+                    if (discr > 0.)
+                    {
+                        x[0] = e[0] * xde0; x[1] = e[1] * xde1; x[2] = e[2] * sqrt(discr);
+                        return;
+                    }
+                }
+                x[2] = 0.;
+                NearestOnEllipse(e[0], e[1], y[0], y[1], x[0], x[1]);
+            }
+        }
+
+        // Radii, and the axes in decreasing order of radius
+        struct FEllipsoid
+        {
+            double r[3];
+            double Sorted[3];
+            int32 Axis[3];
+
+            FEllipsoid(double a, double b, double c) : r{ a, b, c }, Axis{ 0, 1, 2 }
+            {
+                if (r[Axis[0]] < r[Axis[1]]) Swap(Axis[0], Axis[1]);
+                if (r[Axis[1]] < r[Axis[2]]) Swap(Axis[1], Axis[2]);
+                if (r[Axis[0]] < r[Axis[1]]) Swap(Axis[0], Axis[1]);
+                for (int32 k = 0; k < 3; ++k) Sorted[k] = r[Axis[k]];
+            }
+
+            // (nearpt_)  alt is negative inside.
+            void Nearest(const double(&p)[3], double(&x)[3], double& alt) const
+            {
+                const double y[3] = { FMath::Abs(p[Axis[0]]), FMath::Abs(p[Axis[1]]), FMath::Abs(p[Axis[2]]) };
+                double s[3];
+                NearestOnEllipsoid(Sorted, y, s);
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    x[Axis[k]] = p[Axis[k]] < 0. ? -s[k] : s[k];
+                }
+                const double l = RobustLength(p[0] - x[0], p[1] - x[1], p[2] - x[2]);
+                const double q = (p[0] / r[0]) * (p[0] / r[0]) + (p[1] / r[1]) * (p[1] / r[1]) + (p[2] / r[2]) * (p[2] / r[2]);
+                alt = q < 1. ? -l : l;
+            }
+
+            // (surfpt_)  From inside, the exit point;  from the surface,
+            // the vertex.
+            bool Intercept(const double(&p)[3], const double(&u)[3], double(&x)[3]) const
+            {
+                const double o[3] = { p[0] / r[0], p[1] / r[1], p[2] / r[2] };
+                const double d[3] = { u[0] / r[0], u[1] / r[1], u[2] / r[2] };
+                const double qa = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+                const double qb = 2. * (o[0] * d[0] + o[1] * d[1] + o[2] * d[2]);
+                const double qc = o[0] * o[0] + o[1] * o[1] + o[2] * o[2] - 1.;
+                if (qa == 0.)
+                {
+                    return false;
+                }
+
+                double t;
+                if (qc > 0.)
+                {
+                    const double disc = qb * qb - 4. * qa * qc;
+                    if (qb >= 0. || disc < 0.)
+                    {
+                        return false;
+                    }
+                    // The near root, without cancellation
+                    t = 2. * qc / (-qb + sqrt(disc));
+                }
+                else if (qc == 0.)
+                {
+                    t = 0.;
+                }
+                else
+                {
+                    // The far root (qc < 0, so the roots straddle 0)
+                    const double disc = qb * qb - 4. * qa * qc;
+                    t = qb <= 0. ? (-qb + sqrt(disc)) / (2. * qa) : 2. * qc / (-qb - sqrt(disc));
+                }
+
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    x[k] = p[k] + t * u[k];
+                }
+                return true;
+            }
+
+            // (surfnm_)
+            void Normal(const double(&p)[3], double(&n)[3]) const
+            {
+                // Scaled by the smallest radius, for range
+                const double m = Sorted[2];
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    n[k] = p[k] * ((m / r[k]) * (m / r[k]));
+                }
+                const double l = RobustLength(n[0], n[1], n[2]);
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    n[k] = l > 0. ? n[k] / l : 0.;
+                }
+            }
+
+            // (npedln_)
+            void NearestToLine(const double(&p)[3], const double(&u)[3], double(&x)[3], double& dist) const
+            {
+                const double ul = RobustLength(u[0], u[1], u[2]);
+                if (ul == 0.)
+                {
+                    Nearest(p, x, dist);
+                    dist = FMath::Max(dist, 0.);
+                    return;
+                }
+
+                const double minus[3] = { -u[0], -u[1], -u[2] };
+                if (Intercept(p, u, x) || Intercept(p, minus, x))
+                {
+                    dist = 0.;
+                    return;
+                }
+
+                const double uh[3] = { u[0] / ul, u[1] / ul, u[2] / ul };
+
+                // Where the normal is orthogonal to u:  a great circle of the
+                // unit sphere (in the ellipsoid's scaled space), orthogonal
+                // to u scaled
+                const double us[3] = { u[0] / r[0], u[1] / r[1], u[2] / r[2] };
+                const double usl = RobustLength(us[0], us[1], us[2]);
+                const double w[3] = { us[0] / usl, us[1] / usl, us[2] / usl };
+                const int32 k0 = FMath::Abs(w[0]) < FMath::Abs(w[1]) ? (FMath::Abs(w[0]) < FMath::Abs(w[2]) ? 0 : 2) : (FMath::Abs(w[1]) < FMath::Abs(w[2]) ? 1 : 2);
+                double e[3] = { 0., 0., 0. };
+                e[k0] = 1.;
+                double c1[3] = { w[1] * e[2] - w[2] * e[1], w[2] * e[0] - w[0] * e[2], w[0] * e[1] - w[1] * e[0] };
+                const double c1l = RobustLength(c1[0], c1[1], c1[2]);
+                for (int32 k = 0; k < 3; ++k) c1[k] /= c1l;
+                const double c2[3] = { w[1] * c1[2] - w[2] * c1[1], w[2] * c1[0] - w[0] * c1[2], w[0] * c1[1] - w[1] * c1[0] };
+
+                // The limb's generating vectors, then everything projected
+                // onto the plane orthogonal to u
+                auto Project = [&uh](const double(&v)[3], double(&o)[3])
+                {
+                    const double dot = v[0] * uh[0] + v[1] * uh[1] + v[2] * uh[2];
+                    for (int32 k = 0; k < 3; ++k) o[k] = v[k] - dot * uh[k];
+                };
+                const double g1[3] = { r[0] * c1[0], r[1] * c1[1], r[2] * c1[2] };
+                const double g2[3] = { r[0] * c2[0], r[1] * c2[1], r[2] * c2[2] };
+                double v1[3], v2[3], q[3];
+                Project(g1, v1);
+                Project(g2, v2);
+                Project(p, q);
+
+                // (saelgv_)  The projected ellipse's semi-axes are at
+                // parameter theta0, theta0 + pi/2
+                const double v11 = v1[0] * v1[0] + v1[1] * v1[1] + v1[2] * v1[2];
+                const double v22 = v2[0] * v2[0] + v2[1] * v2[1] + v2[2] * v2[2];
+                const double v12 = v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+                const double theta0 = 0.5 * atan2(2. * v12, v11 - v22);
+                const double ct = cos(theta0), st = sin(theta0);
+                double smajor[3], sminor[3];
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    smajor[k] = ct * v1[k] + st * v2[k];
+                    sminor[k] = -st * v1[k] + ct * v2[k];
+                }
+                const double e0 = RobustLength(smajor[0], smajor[1], smajor[2]);
+                const double e1 = RobustLength(sminor[0], sminor[1], sminor[2]);
+
+                const double y0 = (q[0] * smajor[0] + q[1] * smajor[1] + q[2] * smajor[2]) / e0;
+                const double y1 = (q[0] * sminor[0] + q[1] * sminor[1] + q[2] * sminor[2]) / e1;
+
+                // e1 > 0:  u isn't in the great circle's plane, so the
+                // projection doesn't flatten it
+                double x0, x1;
+                NearestOnEllipse(e0, e1, FMath::Abs(y0), FMath::Abs(y1), x0, x1);
+                const double phi = atan2(y1 < 0. ? -x1 / e1 : x1 / e1, y0 < 0. ? -x0 / e0 : x0 / e0);
+
+                const double cp = cos(theta0 + phi), sp = sin(theta0 + phi);
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    x[k] = cp * g1[k] + sp * g2[k];
+                }
+                const double dx[3] = { x[0] - p[0], x[1] - p[1], x[2] - p[2] };
+                double dp[3];
+                Project(dx, dp);
+                dist = RobustLength(dp[0], dp[1], dp[2]);
+            }
+        };
+
+        void CheckBatch(int32 Num, const FConstVectorBatch& v)
+        {
+            check(v.X.Num() >= Num && v.Y.Num() >= Num && v.Z.Num() >= Num);
+        }
+    }
+
+
+    bool Surfpt(const FConstVectorBatch& positn, const FConstVectorBatch& u, double a, double b, double c, const FVectorBatch& point, TArrayView<uint8> found)
+    {
+        if (!ValidRadii(a, b, c))
+        {
+            return false;
+        }
+
+        const int32 Num = positn.Num();
+        CheckBatch(Num, positn);
+        CheckBatch(Num, u);
+        CheckSizes(Num, point.X, point.Y, point.Z);
+        check(found.Num() >= Num);
+
+        const FEllipsoid Ellipsoid(a, b, c);
+        ForEachChunk(Num, [&](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double p[3] = { positn.X[i], positn.Y[i], positn.Z[i] };
+                const double d[3] = { u.X[i], u.Y[i], u.Z[i] };
+                double x[3] = { 0., 0., 0. };
+                found[i] = Ellipsoid.Intercept(p, d, x) ? 1 : 0;
+                point.X[i] = x[0]; point.Y[i] = x[1]; point.Z[i] = x[2];
+            }
+        });
+
+        return true;
+    }
+
+
+    bool Surfnm(double a, double b, double c, const FConstVectorBatch& point, const FVectorBatch& normal)
+    {
+        if (!ValidRadii(a, b, c))
+        {
+            return false;
+        }
+
+        const int32 Num = point.Num();
+        CheckBatch(Num, point);
+        CheckSizes(Num, normal.X, normal.Y, normal.Z);
+
+        const FEllipsoid Ellipsoid(a, b, c);
+        ForEachChunk(Num, [&](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double p[3] = { point.X[i], point.Y[i], point.Z[i] };
+                double n[3];
+                Ellipsoid.Normal(p, n);
+                normal.X[i] = n[0]; normal.Y[i] = n[1]; normal.Z[i] = n[2];
+            }
+        });
+
+        return true;
+    }
+
+
+    bool Nearpt(const FConstVectorBatch& positn, double a, double b, double c, const FVectorBatch& npoint, TArrayView<double> alt)
+    {
+        if (!ValidRadii(a, b, c))
+        {
+            return false;
+        }
+
+        const int32 Num = positn.Num();
+        CheckBatch(Num, positn);
+        CheckSizes(Num, npoint.X, npoint.Y, npoint.Z);
+        check(alt.Num() >= Num);
+
+        const FEllipsoid Ellipsoid(a, b, c);
+        ForEachChunk(Num, [&](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double p[3] = { positn.X[i], positn.Y[i], positn.Z[i] };
+                double x[3];
+                Ellipsoid.Nearest(p, x, alt[i]);
+                npoint.X[i] = x[0]; npoint.Y[i] = x[1]; npoint.Z[i] = x[2];
+            }
+        });
+
+        return true;
+    }
+
+
+    bool Npedln(double a, double b, double c, const FConstVectorBatch& linept, const FConstVectorBatch& linedr, const FVectorBatch& pnear, TArrayView<double> dist)
+    {
+        if (!ValidRadii(a, b, c))
+        {
+            return false;
+        }
+
+        const int32 Num = linept.Num();
+        CheckBatch(Num, linept);
+        CheckBatch(Num, linedr);
+        CheckSizes(Num, pnear.X, pnear.Y, pnear.Z);
+        check(dist.Num() >= Num);
+
+        const FEllipsoid Ellipsoid(a, b, c);
+        ForEachChunk(Num, [&](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double p[3] = { linept.X[i], linept.Y[i], linept.Z[i] };
+                const double d[3] = { linedr.X[i], linedr.Y[i], linedr.Z[i] };
+                double x[3];
+                Ellipsoid.NearestToLine(p, d, x, dist[i]);
+                pnear.X[i] = x[0]; pnear.Y[i] = x[1]; pnear.Z[i] = x[2];
+            }
+        });
+
+        return true;
+    }
+}
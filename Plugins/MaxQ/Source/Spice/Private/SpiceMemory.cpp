@@ -0,0 +1,195 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceMemory.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Accounting for MaxQ's and CSPICE's memory.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceMemory.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceMemory.h"
+#include "HAL/IConsoleManager.h"
+#include "SpiceLock.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+#include "zzalloc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+LLM_DEFINE_TAG(MaxQ);
+
+DEFINE_STAT(STAT_MaxQ_PoolMemory);
+DEFINE_STAT(STAT_MaxQ_MappedKernelMemory);
+
+namespace
+{
+    using MaxQ::Data::FSpiceStaticModule;
+
+    // Static storage of the toolkit's sources (N0067), summed over every
+    // module:  all of it is resident once touched, loaded kernels or not.
+    constexpr int64 CspiceStaticBytes = 105736320;
+
+    const FSpiceStaticModule LargestStaticModules[] =
+    {
+        { TEXT("pool (kernel pool)"), 27587578 },
+        { TEXT("zzekjsrt (EK join/sort)"), 12250000 },
+        { TEXT("spkbsr (SPK segment tables)"), 10520048 },
+        { TEXT("daffa (DAF search)"), 10305315 },
+        { TEXT("zzeksca (EK scratch area)"), 10000000 },
+        { TEXT("ckbsr (CK segment tables)"), 9900088 },
+        { TEXT("dskx02 (DSK type 2 ray intercepts)"), 5077944 },
+        { TEXT("zzdsksbf (DSK segment buffers)"), 2840128 },
+        { TEXT("sc01 (SCLK type 1)"), 2566943 },
+        { TEXT("zzdskbsr (DSK segment tables)"), 2402096 },
+        { TEXT("zzbodtrn (body names/codes)"), 2213816 },
+        { TEXT("tisbod (PCK orientation)"), 1796696 },
+        { TEXT("keeper (loaded kernels)"), 1436396 },
+        { TEXT("zzddhman (file handles)"), 1435464 },
+    };
+
+    // From pool.c (MAXVAR, MAXVAL, MAXLIN, and its string length)
+    constexpr int32 PoolVariableCapacity = 26003;
+    constexpr int32 PoolNumberCapacity = 400000;
+    constexpr int32 PoolStringCapacity = 15000;
+    constexpr int32 PoolStringLength = 80;
+
+    constexpr SpiceInt NameLength = 33;
+
+    void TallyPool(MaxQ::Data::FSpiceMemoryReport& Report)
+    {
+        TArray<FString> Names;
+        {
+            constexpr SpiceInt Room = 128;
+            SpiceChar _kvars[Room][NameLength];
+            SpiceInt _n = 0;
+            SpiceBoolean _found = SPICEFALSE;
+
+            for (SpiceInt _start = 0; !failed_c(); _start += _n)
+            {
+                gnpool_c("*", _start, Room, NameLength, &_n, _kvars, &_found);
+                if (!_found || _n <= 0)
+                {
+                    break;
+                }
+                for (SpiceInt i = 0; i < _n; ++i)
+                {
+                    Names.Add(FString(_kvars[i]));
+                }
+            }
+        }
+
+        for (const FString& Name : Names)
+        {
+            SpiceBoolean _found = SPICEFALSE;
+            SpiceInt _n = 0;
+            SpiceChar _type[1] = { 'X' };
+            dtpool_c(TCHAR_TO_ANSI(*Name), &_found, &_n, _type);
+            if (failed_c() || !_found)
+            {
+                continue;
+            }
+
+            ++Report.PoolVariables;
+            if (_type[0] == 'N')
+            {
+                Report.PoolNumbers += _n;
+            }
+            else
+            {
+                Report.PoolStrings += _n;
+            }
+        }
+
+        Report.PoolBytes = (int64)Report.PoolNumbers * sizeof(SpiceDouble) + (int64)Report.PoolStrings * PoolStringLength;
+    }
+
+    FAutoConsoleCommand MemReportCommand(
+        TEXT("MaxQ.MemReport"),
+        TEXT("Logs MaxQ's accounting of CSPICE's memory:  static storage, kernel pool, allocations, mapped kernels."),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            MaxQ::Data::FSpiceMemoryReport Report;
+            FString ErrorMessage;
+            if (!MaxQ::Data::GetMemoryReport(Report, nullptr, &ErrorMessage))
+            {
+                UE_LOG(LogSpice, Warning, TEXT("MaxQ.MemReport failed: %s"), *ErrorMessage);
+                return;
+            }
+            MaxQ::Data::LogMemoryReport(Report);
+        })
+    );
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API bool GetMemoryReport(FSpiceMemoryReport& Report, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Report = FSpiceMemoryReport();
+        Report.StaticBytes = CspiceStaticBytes;
+        Report.LargestModules = LargestStaticModules;
+        Report.PoolVariableCapacity = PoolVariableCapacity;
+        Report.PoolNumberCapacity = PoolNumberCapacity;
+        Report.PoolStringCapacity = PoolStringCapacity;
+
+        {
+            MaxQ::Core::FSpiceScope Scope;
+
+            TallyPool(Report);
+            Report.Allocations = alloc_count();
+
+            if (ErrorCheck(ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+        }
+
+        Report.MappedKernels = NumMappedKernels();
+        Report.MappedBytes = MappedKernelBytes();
+
+        SET_MEMORY_STAT(STAT_MaxQ_PoolMemory, Report.PoolBytes);
+        SET_MEMORY_STAT(STAT_MaxQ_MappedKernelMemory, Report.MappedBytes);
+
+        return true;
+    }
+
+
+    SPICE_API void LogMemoryReport(const FSpiceMemoryReport& Report)
+    {
+        auto MiB = [](int64 Bytes) { return (double)Bytes / (1024. * 1024.); };
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE memory"));
+        UE_LOG(LogSpice, Log, TEXT("  CSPICE static storage: %.1f MiB"), MiB(Report.StaticBytes));
+        for (const FSpiceStaticModule& Module : Report.LargestModules)
+        {
+            UE_LOG(LogSpice, Log, TEXT("    %-40s %8.1f MiB"), Module.Name, MiB(Module.Bytes));
+        }
+        UE_LOG(LogSpice, Log, TEXT("  Kernel pool: %d/%d variables, %d/%d numbers, %d/%d strings (%.1f MiB of values)"),
+            Report.PoolVariables, Report.PoolVariableCapacity,
+            Report.PoolNumbers, Report.PoolNumberCapacity,
+            Report.PoolStrings, Report.PoolStringCapacity,
+            MiB(Report.PoolBytes));
+        UE_LOG(LogSpice, Log, TEXT("  CSPICE allocations outstanding: %d"), Report.Allocations);
+        UE_LOG(LogSpice, Log, TEXT("  Mapped kernels: %d (%.1f MiB)"), Report.MappedKernels, MiB(Report.MappedBytes));
+        UE_LOG(LogSpice, Log, TEXT("  MaxQ's own allocations are under the \"MaxQ\" LLM tag (-llm)"));
+    }
+}
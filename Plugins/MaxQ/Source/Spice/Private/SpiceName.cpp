@@ -0,0 +1,179 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceName.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Interned body and frame names.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceName.cpp is part of the "refined C++ API".
+//
+// The table only grows, so entries can be handed out as raw pointers.  The
+// name and its ANSI spelling are immutable once interned;  only the cached
+// IDs change, and only on the SPICE thread.
+//------------------------------------------------------------------------------
+
+#include "SpiceName.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+#include "Misc/ScopeRWLock.h"
+#include <atomic>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+struct FSpiceName::FEntry
+{
+    static constexpr uint64 Unresolved = ~0ull;
+
+    FString Name;
+    TArray<ANSICHAR> Ansi;
+
+    // Pool generation each ID was resolved at
+    mutable std::atomic<uint64> BodyGeneration { Unresolved };
+    mutable std::atomic<uint64> FrameGeneration { Unresolved };
+    mutable int BodyCode = 0;
+    mutable int FrameCode = 0;
+};
+
+
+FSpiceName::FSpiceName(const FString& Name)
+    : Entry(Intern(Name))
+{
+}
+
+FSpiceName::FSpiceName(const TCHAR* Name)
+    : Entry(Intern(FString(Name)))
+{
+}
+
+
+const FSpiceName::FEntry* FSpiceName::Intern(const FString& Name)
+{
+    // SPICE ignores leading and trailing blanks
+    const FString Key = Name.TrimStartAndEnd();
+    if (Key.IsEmpty())
+    {
+        return nullptr;
+    }
+
+    // FString keys hash and compare case-insensitively
+    static FRWLock NameTableLock;
+    static TMap<FString, FEntry*> NameTable;
+
+    {
+        FReadScopeLock Lock(NameTableLock);
+        if (FEntry* const* Found = NameTable.Find(Key))
+        {
+            return *Found;
+        }
+    }
+
+    FWriteScopeLock Lock(NameTableLock);
+    FEntry*& Slot = NameTable.FindOrAdd(Key, nullptr);
+    if (!Slot)
+    {
+        Slot = new FEntry();
+        Slot->Name = Key;
+        auto _name = StringCast<ANSICHAR>(*Key);
+        Slot->Ansi.Append(_name.Get(), _name.Length() + 1);
+    }
+    return Slot;
+}
+
+
+const FString& FSpiceName::ToString() const
+{
+    static const FString None;
+    return Entry ? Entry->Name : None;
+}
+
+const ANSICHAR* FSpiceName::Ansi() const
+{
+    return Entry ? Entry->Ansi.GetData() : "";
+}
+
+
+bool FSpiceName::BodyId(int& Id) const
+{
+    if (failed_c())
+    {
+        return false;
+    }
+
+    const uint64 Generation = PoolGeneration();
+    if (Entry && Entry->BodyGeneration.load(std::memory_order_acquire) == Generation)
+    {
+        Id = Entry->BodyCode;
+        return true;
+    }
+
+    SpiceInt _code = 0;
+    if (!ResolveBody(Ansi(), _code))
+    {
+        return false;
+    }
+
+    Id = _code;
+    if (Entry)
+    {
+        Entry->BodyCode = _code;
+        Entry->BodyGeneration.store(Generation, std::memory_order_release);
+    }
+    return true;
+}
+
+
+bool FSpiceName::FrameId(int& Id) const
+{
+    if (failed_c())
+    {
+        return false;
+    }
+
+    const uint64 Generation = PoolGeneration();
+    if (Entry && Entry->FrameGeneration.load(std::memory_order_acquire) == Generation)
+    {
+        Id = Entry->FrameCode;
+        return true;
+    }
+
+    SpiceInt _frcode = 0;
+    namfrm_c(Ansi(), &_frcode);
+    if (_frcode == 0)
+    {
+        if (!failed_c())
+        {
+            setmsg_c("The reference frame # is not recognized.");
+            errch_c("#", Ansi());
+            sigerr_c("SPICE(UNKNOWNFRAME)");
+        }
+        return false;
+    }
+
+    Id = _frcode;
+    if (Entry)
+    {
+        Entry->FrameCode = _frcode;
+        Entry->FrameGeneration.store(Generation, std::memory_order_release);
+    }
+    return true;
+}
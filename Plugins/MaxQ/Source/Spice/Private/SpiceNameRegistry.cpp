@@ -0,0 +1,349 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceNameRegistry.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Thread-safe snapshots of the NAIF body and frame name mappings.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceNameRegistry.cpp is part of the "refined C++ API".
+//
+// Candidate body names come from three places:  CSPICE's built in list
+// (zzbodget), the pool's NAIF_BODY_NAME, and every name given to Boddef.
+// Each is then put to bods2c, and each code it yields to bodc2n, so
+// precedence (pool over boddef over built in, later over earlier) is
+// CSPICE's, not reimplemented.  Frames are bltfrm + kplfrm, through frmnam.
+//------------------------------------------------------------------------------
+
+#include "SpiceNameRegistry.h"
+#include "SpiceUtilities.h"
+#include "Misc/ScopeLock.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+
+// for zzbodget_
+#include "SpiceZfc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // zzbodtrn.inc
+    constexpr int32 MaxNameLength = 36;
+    constexpr int32 MaxBuiltIn = 2000;
+    constexpr SpiceInt MaxFrames = 10000;
+    constexpr int32 MaxFrameNameLength = 32;
+
+    FCriticalSection RegistryLock;
+
+    TSharedRef<const MaxQ::Data::FNameRegistry, ESPMode::ThreadSafe>& CurrentRegistry()
+    {
+        static TSharedRef<const MaxQ::Data::FNameRegistry, ESPMode::ThreadSafe> Current = MakeShared<MaxQ::Data::FNameRegistry, ESPMode::ThreadSafe>();
+        return Current;
+    }
+
+    // Names given to boddef, which CSPICE has no way to list
+    FCriticalSection BoddefLock;
+    TSet<FString>& BoddefNames()
+    {
+        static TSet<FString> Names;
+        return Names;
+    }
+
+    // As ljucrs:  upper case, no leading/trailing blanks, single blanks
+    FString Normalize(const FString& Name)
+    {
+        FString Result;
+        Result.Reserve(Name.Len());
+
+        bool bBlank = false;
+        for (TCHAR c : Name)
+        {
+            if (FChar::IsWhitespace(c))
+            {
+                bBlank = Result.Len() > 0;
+            }
+            else
+            {
+                if (bBlank)
+                {
+                    Result.AppendChar(TEXT(' '));
+                    bBlank = false;
+                }
+                Result.AppendChar(FChar::ToUpper(c));
+            }
+        }
+        return Result;
+    }
+
+    FName Key(const FString& Name)
+    {
+        return FName(*Normalize(Name));
+    }
+
+    void AddBody(TMap<FName, int32>& BodyCodes, TMap<int32, FString>& BodyNames, const ANSICHAR* Name)
+    {
+        SpiceInt _code = 0;
+        SpiceBoolean _found = SPICEFALSE;
+        bodn2c_c(Name, &_code, &_found);
+        if (!_found || failed_c())
+        {
+            return;
+        }
+
+        BodyCodes.Add(Key(FString(Name)), _code);
+
+        if (!BodyNames.Contains(_code))
+        {
+            SpiceChar _name[MaxNameLength + 1];
+            bodc2n_c(_code, sizeof(_name), _name, &_found);
+            if (_found && !failed_c())
+            {
+                BodyNames.Add(_code, FString(_name));
+            }
+        }
+    }
+
+    void AddFrames(SpiceCell* _ids, TMap<FName, int32>& FrameIds, TMap<int32, FString>& FrameNames)
+    {
+        for (SpiceInt i = 0; i < card_c(_ids) && !failed_c(); ++i)
+        {
+            const SpiceInt _id = SPICE_CELL_ELEM_I(_ids, i);
+            SpiceChar _name[MaxFrameNameLength + 1];
+            frmnam_c(_id, sizeof(_name), _name);
+            if (_name[0])
+            {
+                const FString Name(_name);
+                FrameIds.Add(Key(Name), _id);
+                FrameNames.Add(_id, Name);
+            }
+        }
+    }
+
+    bool ParseCode(const FString& Name, int32& Code)
+    {
+        const FString Trimmed = Name.TrimStartAndEnd();
+        int32 Start = Trimmed.StartsWith(TEXT("-")) || Trimmed.StartsWith(TEXT("+")) ? 1 : 0;
+        if (Trimmed.Len() <= Start || Trimmed.Len() > 11)
+        {
+            return false;
+        }
+        for (int32 i = Start; i < Trimmed.Len(); ++i)
+        {
+            if (!FChar::IsDigit(Trimmed[i]))
+            {
+                return false;
+            }
+        }
+
+        const int64 Value = FCString::Atoi64(*Trimmed);
+        if (Value < MIN_int32 || Value > MAX_int32)
+        {
+            return false;
+        }
+        Code = (int32)Value;
+        return true;
+    }
+}
+
+namespace MaxQ::Data
+{
+    TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> FNameRegistry::FromKernelPool()
+    {
+        MAXQ_LLM_SCOPE();
+
+        TSharedRef<FNameRegistry, ESPMode::ThreadSafe> Registry = MakeShared<FNameRegistry, ESPMode::ThreadSafe>();
+        Registry->PoolGeneration = MaxQ::Private::PoolGeneration();
+
+        // Built in
+        {
+            TArray<ANSICHAR> Names, Normalized;
+            Names.SetNumZeroed(MaxBuiltIn * MaxNameLength);
+            Normalized.SetNumZeroed(MaxBuiltIn * MaxNameLength);
+            TArray<integer> Codes;
+            Codes.SetNumZeroed(MaxBuiltIn);
+            integer _room = MaxBuiltIn, _n = 0;
+            zzbodget_(&_room, Names.GetData(), Normalized.GetData(), Codes.GetData(), &_n, (ftnlen)MaxNameLength, (ftnlen)MaxNameLength);
+
+            // Fortran strings:  blank padded, not terminated
+            for (int32 i = 0; i < (int32)_n && !failed_c(); ++i)
+            {
+                ANSICHAR Name[MaxNameLength + 1];
+                FMemory::Memcpy(Name, &Names[i * MaxNameLength], MaxNameLength);
+                Name[MaxNameLength] = 0;
+                AddBody(Registry->BodyCodes, Registry->BodyNames, Name);
+            }
+        }
+
+        // Text kernels
+        {
+            SpiceInt _n = 0;
+            SpiceChar _type = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            dtpool_c("NAIF_BODY_NAME", &_found, &_n, &_type);
+            for (SpiceInt i = 0; _found && _type == 'C' && i < _n && !failed_c(); ++i)
+            {
+                SpiceChar _name[MaxNameLength + 1];
+                SpiceInt _got = 0;
+                SpiceBoolean _gotOne = SPICEFALSE;
+                gcpool_c("NAIF_BODY_NAME", i, 1, sizeof(_name), &_got, _name, &_gotOne);
+                if (_gotOne && _got == 1)
+                {
+                    AddBody(Registry->BodyCodes, Registry->BodyNames, _name);
+                }
+            }
+        }
+
+        // boddef
+        {
+            TArray<FString> Defined;
+            {
+                FScopeLock Lock(&BoddefLock);
+                Defined = BoddefNames().Array();
+            }
+            for (const FString& Name : Defined)
+            {
+                AddBody(Registry->BodyCodes, Registry->BodyNames, TCHAR_TO_ANSI(*Name));
+            }
+        }
+
+        // Frames
+        {
+            SPICEINT_CELL(_ids, MaxFrames);
+            scard_c(0, &_ids);
+            bltfrm_c(SPICE_FRMTYP_ALL, &_ids);
+            AddFrames(&_ids, Registry->FrameIds, Registry->FrameNames);
+
+            scard_c(0, &_ids);
+            kplfrm_c(SPICE_FRMTYP_ALL, &_ids);
+            AddFrames(&_ids, Registry->FrameIds, Registry->FrameNames);
+        }
+
+        // Whatever went wrong, the snapshot has what was read before it
+        UnexpectedErrorCheck(true);
+
+        return Registry;
+    }
+
+
+    bool FNameRegistry::BodyCode(const FString& Name, int32& Code) const
+    {
+        return BodyCode(Key(Name), Code) || ParseCode(Name, Code);
+    }
+
+
+    bool FNameRegistry::BodyCode(FName Name, int32& Code) const
+    {
+        if (const int32* Found = BodyCodes.Find(Name))
+        {
+            Code = *Found;
+            return true;
+        }
+        return false;
+    }
+
+
+    bool FNameRegistry::BodyName(int32 Code, FString& Name) const
+    {
+        if (const FString* Found = BodyNames.Find(Code))
+        {
+            Name = *Found;
+            return true;
+        }
+        return false;
+    }
+
+
+    bool FNameRegistry::FrameId(const FString& Name, int32& Id) const
+    {
+        return FrameId(Key(Name), Id);
+    }
+
+
+    bool FNameRegistry::FrameId(FName Name, int32& Id) const
+    {
+        if (const int32* Found = FrameIds.Find(Name))
+        {
+            Id = *Found;
+            return true;
+        }
+        return false;
+    }
+
+
+    bool FNameRegistry::FrameName(int32 Id, FString& Name) const
+    {
+        if (const FString* Found = FrameNames.Find(Id))
+        {
+            Name = *Found;
+            return true;
+        }
+        return false;
+    }
+
+
+    bool FNameRegistry::IsCurrent() const
+    {
+        return PoolGeneration == MaxQ::Private::PoolGeneration();
+    }
+
+
+    SPICE_API TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> GetNameRegistry()
+    {
+        FScopeLock Lock(&RegistryLock);
+        return CurrentRegistry();
+    }
+
+
+    SPICE_API TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> UpdateNameRegistry()
+    {
+        TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> Registry = GetNameRegistry();
+
+        // Don't bury an error that's on its way to someone
+        if (Registry->IsCurrent() || failed_c())
+        {
+            MAXQ_CACHE_EVENT(PoolCacheHits);
+            return Registry;
+        }
+
+        MAXQ_CACHE_EVENT(PoolCacheRebuilds);
+        Registry = FNameRegistry::FromKernelPool();
+
+        FScopeLock Lock(&RegistryLock);
+        CurrentRegistry() = Registry;
+        return Registry;
+    }
+}
+
+namespace MaxQ::Private
+{
+    void RecordBoddef(const FString& Name)
+    {
+        FScopeLock Lock(&BoddefLock);
+        BoddefNames().Add(Normalize(Name));
+    }
+
+
+    TArray<FString> GetBoddefNames()
+    {
+        FScopeLock Lock(&BoddefLock);
+        return BoddefNames().Array();
+    }
+}
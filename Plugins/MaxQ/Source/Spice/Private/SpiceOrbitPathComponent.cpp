@@ -0,0 +1,432 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceOrbitPathComponent.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Orbit paths, sampled off the game thread and drawn from a cache.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceOrbitPathComponent.cpp is part of the "Blueprints API".
+//
+// Conics are sampled in true anomaly rather than with ComputeConic's
+// ellipse/hyperbola axes, so one parameterization covers every eccentricity,
+// parabolas included.  The orientation is the same ZXZ rotation ComputeConic
+// uses.
+//
+// Refinement is breadth first:  each pass halves every segment that's still
+// out of tolerance, so when MaxSegments runs out the vertices are spread
+// over the worst of the path rather than spent on its first bend.
+//------------------------------------------------------------------------------
+
+#include "SpiceOrbitPathComponent.h"
+#include "SpiceUtilities.h"
+#include "SpiceExecutor.h"
+#include "SpiceLog.h"
+#include "Async/Async.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // Stops short of a hyperbola's asymptote
+    constexpr double AsymptoteMargin = 1.e-3;
+
+    struct FPathRequest
+    {
+        int32 Generation = 0;
+        EMaxQOrbitPathSource Source = EMaxQOrbitPathSource::ConicElements;
+        FString Frame;
+
+        FSConicElements Elements;
+        FString ElementsFrame;
+        double HyperbolicRange = 0.;
+
+        FString Target;
+        FString Observer;
+        const ANSICHAR* AberrationCorrection = "NONE";
+        double Et = 0.;
+        double Before = 0.;
+        double After = 0.;
+
+        double Tolerance = 0.;
+        int32 MinSegments = 0;
+        int32 MaxSegments = 0;
+        double Scale = 1.;
+    };
+
+    // Samples Position over [t0, t1], halving segments whose midpoint is
+    // further than Tolerance from their chord.  False if Position failed.
+    template<typename PositionType>
+    bool Sample(PositionType&& Position, double t0, double t1, const FPathRequest& Request, TArray<FVector>& OutPoints)
+    {
+        const int32 MinSegments = FMath::Max(Request.MinSegments, 4);
+        const int32 MaxSegments = FMath::Max(Request.MaxSegments, MinSegments);
+
+        TArray<double> t;
+        TArray<FVector> p;
+        TArray<bool> Converged;
+        t.SetNumUninitialized(MinSegments + 1);
+        p.SetNumUninitialized(MinSegments + 1);
+        Converged.Init(false, MinSegments);
+
+        for (int32 i = 0; i <= MinSegments; ++i)
+        {
+            t[i] = FMath::Lerp(t0, t1, double(i) / MinSegments);
+            if (!Position(t[i], p[i]))
+            {
+                return false;
+            }
+        }
+
+        TArray<double> NextT;
+        TArray<FVector> NextP;
+        TArray<bool> NextConverged;
+        bool bRefined = true;
+        while (bRefined && Converged.Num() < MaxSegments)
+        {
+            bRefined = false;
+            int32 Budget = MaxSegments - Converged.Num();
+
+            NextT.Reset();
+            NextP.Reset();
+            NextConverged.Reset();
+            NextT.Add(t[0]);
+            NextP.Add(p[0]);
+
+            for (int32 i = 0; i < Converged.Num(); ++i)
+            {
+                bool bSplit = false;
+                if (!Converged[i] && Budget > 0)
+                {
+                    const double tm = 0.5 * (t[i] + t[i + 1]);
+                    FVector pm;
+                    if (!Position(tm, pm))
+                    {
+                        return false;
+                    }
+
+                    if (FVector::Dist(pm, 0.5 * (p[i] + p[i + 1])) > Request.Tolerance)
+                    {
+                        NextT.Add(tm);
+                        NextP.Add(pm);
+                        NextConverged.Add(false);
+                        --Budget;
+                        bSplit = bRefined = true;
+                    }
+                }
+
+                NextT.Add(t[i + 1]);
+                NextP.Add(p[i + 1]);
+                NextConverged.Add(!bSplit && (Converged[i] || Budget > 0));
+            }
+
+            Swap(t, NextT);
+            Swap(p, NextP);
+            Swap(Converged, NextConverged);
+        }
+
+        OutPoints.Reset(p.Num());
+        for (const FVector& km : p)
+        {
+            // Swizzle
+            OutPoints.Add(FVector(km.Y, km.X, km.Z) * Request.Scale);
+        }
+        return true;
+    }
+
+    bool SampleConic(const FPathRequest& Request, TArray<FVector>& OutPoints, bool& bClosed)
+    {
+        const FSConicElements& o = Request.Elements;
+        const double q = o.PerifocalDistance.AsSpiceDouble();
+        const double ecc = o.Eccentricity;
+        if (q <= 0. || ecc < 0.)
+        {
+            setmsg_c("Conic elements need a positive perifocal distance and a non-negative eccentricity; got q = #, e = #.");
+            errdp_c("#", q);
+            errdp_c("#", ecc);
+            sigerr_c("SPICE(INVALIDELEMENTS)");
+            return false;
+        }
+
+        // Rows 0 and 1:  periapsis and the in-plane normal to it
+        SpiceDouble r[3][3];
+        eul2m_c(o.ArgumentOfPeriapse.AsSpiceDouble(), o.Inclination.AsSpiceDouble(), o.LongitudeOfAscendingNode.AsSpiceDouble(), 3, 1, 3, r);
+
+        if (!Request.ElementsFrame.Equals(Request.Frame, ESearchCase::IgnoreCase))
+        {
+            SpiceDouble m[3][3];
+            MAXQ_FRAME_LOOKUP_SCOPE();
+            pxform_c(TCHAR_TO_ANSI(*Request.ElementsFrame), TCHAR_TO_ANSI(*Request.Frame), o.Epoch.AsSpiceDouble(), m);
+            if (failed_c())
+            {
+                return false;
+            }
+            mxmt_c(r, m, r);
+        }
+
+        const double p = q * (1. + ecc);
+        bClosed = ecc < 1.;
+
+        double MaxAnomaly = PI;
+        if (!bClosed)
+        {
+            // Out to HyperbolicRange, and short of the asymptote
+            const double Range = FMath::Max(Request.HyperbolicRange, q);
+            const double cosv = FMath::Clamp((p / Range - 1.) / ecc, -1., 1.);
+            MaxAnomaly = FMath::Min(FMath::Acos(cosv), FMath::Acos(-1. / ecc) - AsymptoteMargin);
+        }
+
+        auto Position = [&](double v, FVector& km)
+        {
+            const double Radius = p / (1. + ecc * FMath::Cos(v));
+            const double x = Radius * FMath::Cos(v), y = Radius * FMath::Sin(v);
+            km = FVector(x * r[0][0] + y * r[1][0], x * r[0][1] + y * r[1][1], x * r[0][2] + y * r[1][2]);
+            return true;
+        };
+
+        return Sample(Position, -MaxAnomaly, MaxAnomaly, Request, OutPoints);
+    }
+
+    bool SampleTrajectory(const FPathRequest& Request, TArray<FVector>& OutPoints)
+    {
+        auto _targ = StringCast<ANSICHAR>(*Request.Target);
+        auto _obs = StringCast<ANSICHAR>(*Request.Observer);
+        auto _ref = StringCast<ANSICHAR>(*Request.Frame);
+
+        auto Position = [&](double et, FVector& km)
+        {
+            SpiceDouble _pos[3], _lt;
+            spkpos_c(_targ.Get(), et, _ref.Get(), Request.AberrationCorrection, _obs.Get(), _pos, &_lt);
+            km = FVector(_pos[0], _pos[1], _pos[2]);
+            return !failed_c();
+        };
+
+        return Sample(Position, Request.Et - Request.Before, Request.Et + Request.After, Request, OutPoints);
+    }
+}
+
+
+struct UMaxQOrbitPathComponent::FPathResult
+{
+    bool bSuccess = false;
+    int32 Generation = 0;
+    EMaxQOrbitPathSource Source = EMaxQOrbitPathSource::ConicElements;
+    FSConicElements Elements;
+    FSEphemerisTime Epoch;
+    TArray<FVector> Points;
+    bool bClosed = false;
+    FString ErrorMessage;
+};
+
+
+UMaxQOrbitPathComponent::UMaxQOrbitPathComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+}
+
+
+void UMaxQOrbitPathComponent::Invalidate()
+{
+    ++Generation;
+    // Check at the next tick
+    SinceCheck = UpdateInterval;
+}
+
+
+#if WITH_EDITOR
+void UMaxQOrbitPathComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+    Invalidate();
+}
+#endif
+
+
+void UMaxQOrbitPathComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    SinceCheck += DeltaTime;
+    if (bInFlight || SinceCheck < UpdateInterval)
+    {
+        return;
+    }
+    SinceCheck = 0.f;
+
+    if (!NeedsRebuild())
+    {
+        return;
+    }
+    bInFlight = true;
+
+    FPathRequest Request;
+    Request.Generation = Generation;
+    Request.Source = Source;
+    Request.Frame = Frame;
+    Request.Elements = Elements;
+    Request.ElementsFrame = ElementsFrame;
+    Request.HyperbolicRange = HyperbolicRange.AsSpiceDouble();
+    Request.Target = Target;
+    Request.Observer = Observer;
+    Request.AberrationCorrection = MaxQ::Core::ToANSIString(AberrationCorrection);
+    Request.Et = Epoch.AsSpiceDouble();
+    Request.Before = Before.AsSeconds();
+    Request.After = After.AsSeconds();
+    Request.Tolerance = FMath::Max(Tolerance, 1.e-6);
+    Request.MinSegments = MinSegments;
+    Request.MaxSegments = MaxSegments;
+    Request.Scale = Scale;
+
+    TWeakObjectPtr<UMaxQOrbitPathComponent> WeakThis(this);
+
+    FSpiceExecutor::Get().EnqueueCommand([WeakThis, Request = MoveTemp(Request)]()
+    {
+        FPathResult Result;
+        Result.Generation = Request.Generation;
+        Result.Source = Request.Source;
+        Result.Elements = Request.Elements;
+        Result.Epoch = FSEphemerisTime(Request.Et);
+
+        if (Request.Source == EMaxQOrbitPathSource::ConicElements)
+        {
+            Result.bSuccess = SampleConic(Request, Result.Points, Result.bClosed);
+        }
+        else
+        {
+            Result.bSuccess = SampleTrajectory(Request, Result.Points);
+        }
+
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        if (ErrorCheck(ResultCode, Result.ErrorMessage))
+        {
+            Result.bSuccess = false;
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, Result = MoveTemp(Result)]()
+        {
+            if (UMaxQOrbitPathComponent* This = WeakThis.Get())
+            {
+                This->Completed(Result);
+            }
+        });
+    });
+}
+
+
+bool UMaxQOrbitPathComponent::NeedsRebuild() const
+{
+    if (BuiltGeneration != Generation || BuiltSource != Source)
+    {
+        return true;
+    }
+
+    if (Source == EMaxQOrbitPathSource::Trajectory)
+    {
+        return FMath::Abs(Epoch.AsSpiceDouble() - BuiltEpoch.AsSpiceDouble()) > MaxAge.AsSeconds();
+    }
+
+    // The mean anomaly, epoch and GM don't change the path
+    const double q = Elements.PerifocalDistance.AsSpiceDouble();
+    const double q0 = BuiltElements.PerifocalDistance.AsSpiceDouble();
+    if (FMath::Abs(q - q0) > ElementTolerance * FMath::Abs(q0) || FMath::Abs(Elements.Eccentricity - BuiltElements.Eccentricity) > ElementTolerance)
+    {
+        return true;
+    }
+
+    auto Moved = [&](const FSAngle& Now, const FSAngle& Then)
+    {
+        return FMath::Abs(FMath::FindDeltaAngleRadians(Now.AsSpiceDouble(), Then.AsSpiceDouble())) > AngleTolerance.AsSpiceDouble();
+    };
+    return Moved(Elements.Inclination, BuiltElements.Inclination)
+        || Moved(Elements.LongitudeOfAscendingNode, BuiltElements.LongitudeOfAscendingNode)
+        || Moved(Elements.ArgumentOfPeriapse, BuiltElements.ArgumentOfPeriapse);
+}
+
+
+void UMaxQOrbitPathComponent::Completed(const FPathResult& Result)
+{
+    bInFlight = false;
+
+    if (!Result.bSuccess)
+    {
+        // Don't retry until something changes
+        BuiltGeneration = Result.Generation;
+        BuiltSource = Result.Source;
+        BuiltElements = Result.Elements;
+        BuiltEpoch = Result.Epoch;
+
+        UE_LOG(LogSpice, Warning, TEXT("UMaxQOrbitPathComponent %s: %s"), *GetName(), *Result.ErrorMessage);
+        OnError.Broadcast(Result.ErrorMessage);
+        return;
+    }
+
+    if (Result.Generation != Generation)
+    {
+        // Invalidated while sampling:  the next check starts another
+        return;
+    }
+
+    BuiltGeneration = Result.Generation;
+    BuiltSource = Result.Source;
+    BuiltElements = Result.Elements;
+    BuiltEpoch = Result.Epoch;
+    Points = Result.Points;
+    bClosed = Result.bClosed;
+
+    Redraw();
+    OnUpdated.Broadcast();
+}
+
+
+void UMaxQOrbitPathComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+    Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+    // The batched lines are in world space
+    Redraw();
+}
+
+
+void UMaxQOrbitPathComponent::Redraw()
+{
+    Flush();
+
+    if (Points.Num() < 2)
+    {
+        return;
+    }
+
+    const FTransform& Transform = GetComponentTransform();
+
+    TArray<FBatchedLine> Lines;
+    Lines.Reserve(Points.Num() - 1);
+    FVector Start = Transform.TransformPosition(Points[0]);
+    for (int32 i = 1; i < Points.Num(); ++i)
+    {
+        const FVector End = Transform.TransformPosition(Points[i]);
+        // Zero lifetime:  kept until the next Flush
+        Lines.Emplace(Start, End, Color, 0.f, Thickness, SDPG_World);
+        Start = End;
+    }
+
+    DrawLines(Lines);
+}
@@ -0,0 +1,272 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceOrbitalPhysics.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Orbital gravity on Chaos rigid bodies, from the physics thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceOrbitalPhysics.cpp is part of the "Blueprints API".
+//
+// The game thread writes one input per frame (GetProducerInputData_External),
+// which Chaos hands to every step simulated for that frame.  The callback
+// starts the epoch over at each new input, and advances it across the
+// steps, so the epoch never drifts from the game thread's.
+//
+// Forces are applied as m * a, through the physics thread handle, at the
+// start of the step.  The force models list is immutable once it's handed
+// over (SetForces makes a new one), so the physics thread reads it without
+// a lock.
+//------------------------------------------------------------------------------
+
+#include "SpiceOrbitalPhysics.h"
+#include "SpiceIntegrator.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Chaos/SimCallbackInput.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+
+struct FMaxQOrbitalPhysicsInput : public Chaos::FSimCallbackInput
+{
+    TArray<Chaos::FSingleParticlePhysicsProxy*> Proxies;
+    TSharedPtr<const UMaxQOrbitalPhysicsSubsystem::FForceModels, ESPMode::ThreadSafe> Forces;
+    double GM = 0.;
+    double Epoch = 0.;
+    double TimeScale = 1.;
+    double Scale = 1.;
+    double Origin[3] = { 0., 0., 0. };
+
+    void Reset()
+    {
+        Proxies.Reset();
+        Forces.Reset();
+    }
+};
+
+
+class FMaxQOrbitalPhysicsCallback : public Chaos::TSimCallbackObject<FMaxQOrbitalPhysicsInput>
+{
+private:
+    virtual void OnPreSimulate_Internal() override;
+
+    const FMaxQOrbitalPhysicsInput* LastInput = nullptr;
+    double Et = 0.;
+};
+
+
+void FMaxQOrbitalPhysicsCallback::OnPreSimulate_Internal()
+{
+    const FMaxQOrbitalPhysicsInput* Input = GetConsumerInput_Internal();
+    if (!Input)
+    {
+        return;
+    }
+
+    if (Input != LastInput)
+    {
+        LastInput = Input;
+        Et = Input->Epoch;
+    }
+    const double et = Et;
+    Et += GetDeltaTime_Internal() * Input->TimeScale;
+
+    if (Input->Scale <= 0.)
+    {
+        return;
+    }
+    const double Scale = Input->Scale;
+
+    for (int32 i = 0; i < Input->Proxies.Num(); ++i)
+    {
+        Chaos::FSingleParticlePhysicsProxy* Proxy = Input->Proxies[i];
+        Chaos::FRigidBodyHandle_Internal* Handle = Proxy ? Proxy->GetPhysicsThreadAPI() : nullptr;
+        if (!Handle || Handle->ObjectState() != Chaos::EObjectStateType::Dynamic)
+        {
+            continue;
+        }
+
+        // To SPICE (km, km/s, relative to the central body)
+        const Chaos::FVec3 X = Handle->X();
+        const Chaos::FVec3 V = Handle->V();
+        const double state[6] = {
+            Input->Origin[0] + X.Y / Scale, Input->Origin[1] + X.X / Scale, Input->Origin[2] + X.Z / Scale,
+            V.Y / Scale, V.X / Scale, V.Z / Scale
+        };
+
+        const double r2 = state[0] * state[0] + state[1] * state[1] + state[2] * state[2];
+        if (r2 == 0.)
+        {
+            continue;
+        }
+
+        const double k = -Input->GM / (r2 * sqrt(r2));
+        double a[3] = { k * state[0], k * state[1], k * state[2] };
+
+        bool bValid = true;
+        if (Input->Forces.IsValid())
+        {
+            for (const TSharedRef<const MaxQ::Orbits::IForceModel, ESPMode::ThreadSafe>& Force : *Input->Forces)
+            {
+                bValid = bValid && Force->AddAcceleration(i, et, state, a);
+            }
+        }
+        if (!bValid)
+        {
+            continue;
+        }
+
+        // ...and back
+        const Chaos::FVec3 Acceleration(a[1] * Scale, a[0] * Scale, a[2] * Scale);
+        Handle->AddForce(Acceleration * Handle->M());
+    }
+}
+
+
+void FMaxQOrbitalPhysicsTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+    if (Subsystem && TickType != LEVELTICK_ViewportsOnly)
+    {
+        Subsystem->Update(DeltaTime);
+    }
+}
+
+
+FString FMaxQOrbitalPhysicsTickFunction::DiagnosticMessage()
+{
+    return TEXT("FMaxQOrbitalPhysicsTickFunction");
+}
+
+
+FName FMaxQOrbitalPhysicsTickFunction::DiagnosticContext(bool bDetailed)
+{
+    return FName(TEXT("MaxQOrbitalPhysicsSubsystem"));
+}
+
+
+void UMaxQOrbitalPhysicsSubsystem::SetForces(const FForceModels& _Forces)
+{
+    Forces = MakeShared<const FForceModels, ESPMode::ThreadSafe>(_Forces);
+}
+
+
+void UMaxQOrbitalPhysicsSubsystem::RegisterBody(UPrimitiveComponent* Component)
+{
+    if (Component && !Bodies.Contains(Component))
+    {
+        Component->SetEnableGravity(false);
+        Bodies.Add(Component);
+    }
+}
+
+
+void UMaxQOrbitalPhysicsSubsystem::UnregisterBody(UPrimitiveComponent* Component)
+{
+    Bodies.Remove(Component);
+}
+
+
+void UMaxQOrbitalPhysicsSubsystem::Update(float DeltaTime)
+{
+    if (bFollowEphemerisSubsystem)
+    {
+        if (const UMaxQEphemerisSubsystem* Ephemeris = GetWorld()->GetSubsystem<UMaxQEphemerisSubsystem>())
+        {
+            Epoch = Ephemeris->Epoch;
+            Scale = Ephemeris->Scale;
+            Origin = Ephemeris->Origin;
+        }
+    }
+    else
+    {
+        Epoch = Epoch + FSEphemerisPeriod(DeltaTime * TimeScale);
+    }
+
+    // (Components that are gone drop out)
+    Bodies.RemoveAll([](const TWeakObjectPtr<UPrimitiveComponent>& Body) { return !Body.IsValid(); });
+
+    FMaxQOrbitalPhysicsInput* Input = Callback ? Callback->GetProducerInputData_External() : nullptr;
+    if (!Input)
+    {
+        return;
+    }
+
+    Input->Proxies.Reset();
+    for (const TWeakObjectPtr<UPrimitiveComponent>& Body : Bodies)
+    {
+        const FBodyInstance* Instance = Body->GetBodyInstance();
+        Input->Proxies.Add(Instance ? Instance->GetPhysicsActorHandle() : nullptr);
+    }
+    Input->Forces = Forces;
+    Input->GM = GM;
+    Input->Epoch = Epoch.AsSpiceDouble();
+    Input->TimeScale = TimeScale;
+    Input->Scale = Scale;
+    Origin.CopyTo(Input->Origin);
+}
+
+
+bool UMaxQOrbitalPhysicsSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+
+void UMaxQOrbitalPhysicsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    if (FPhysScene* Scene = InWorld.GetPhysicsScene())
+    {
+        if (Chaos::FPhysicsSolver* Solver = Scene->GetSolver())
+        {
+            Callback = Solver->CreateAndRegisterSimCallbackObject_External<FMaxQOrbitalPhysicsCallback>();
+        }
+    }
+
+    TickFunction.Subsystem = this;
+    TickFunction.bCanEverTick = true;
+    TickFunction.bStartWithTickEnabled = true;
+    TickFunction.bTickEvenWhenPaused = false;
+    TickFunction.TickGroup = TG_PrePhysics;
+    TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+
+void UMaxQOrbitalPhysicsSubsystem::Deinitialize()
+{
+    if (TickFunction.IsTickFunctionRegistered())
+    {
+        TickFunction.UnRegisterTickFunction();
+    }
+    TickFunction.Subsystem = nullptr;
+
+    if (Callback)
+    {
+        if (FPhysScene* Scene = GetWorld() ? GetWorld()->GetPhysicsScene() : nullptr)
+        {
+            if (Chaos::FPhysicsSolver* Solver = Scene->GetSolver())
+            {
+                Solver->UnregisterAndFreeSimCallbackObject_External(Callback);
+            }
+        }
+        Callback = nullptr;
+    }
+
+    Super::Deinitialize();
+}
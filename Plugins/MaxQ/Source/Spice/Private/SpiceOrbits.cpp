@@ -51,6 +51,7 @@ void USpiceOrbits::EvaluateOrbit(
         double m[3][3];
         auto _orbitReferenceFrame = StringCast<ANSICHAR>(*orbitReferenceFrame);
         auto _observerReferenceFrame = StringCast<ANSICHAR>(*observerReferenceFrame);
+        MAXQ_FRAME_LOOKUP_SCOPE();
         pxform_c(_orbitReferenceFrame.Get(), _observerReferenceFrame.Get(), et.AsSpiceDouble(), m);
 
         // Clear any errors if necessary
@@ -145,6 +146,7 @@ void USpiceOrbits::ComputeConic(
         double m[3][3];
         auto _orbitReferenceFrame = StringCast<ANSICHAR>(*orbitReferenceFrame);
         auto _observerReferenceFrame = StringCast<ANSICHAR>(*observerReferenceFrame);
+        MAXQ_FRAME_LOOKUP_SCOPE();
         pxform_c(_orbitReferenceFrame.Get(), _observerReferenceFrame.Get(), et.AsSpiceDouble(), m);
 
         // Clear any errors if necessary
@@ -0,0 +1,348 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceOutlineComponent.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Limb and terminator outlines, computed off the game thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceOutlineComponent.cpp is part of the "Blueprints API".
+//
+// At most one check is in flight.  The tick snapshots the properties into a
+// request, the executor decides if anything moved enough (against state only
+// it touches), and the result comes back to the game thread.  An outline
+// from before an Invalidate is dropped.
+//
+// The observer and source are tested with geometric positions:  light time
+// changes far slower than the tolerances, and the outline itself is still
+// computed with AberrationCorrection.
+//------------------------------------------------------------------------------
+
+#include "SpiceOutlineComponent.h"
+#include "SpiceUtilities.h"
+#include "SpiceExecutor.h"
+#include "SpiceLog.h"
+#include "Async/Async.h"
+#include "Components/SplineComponent.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // Points per cut SPICE can return (DSK limbs can have several)
+    constexpr int32 MaxPointsPerCut = 8;
+
+    struct FOutlineRequest
+    {
+        int32 Generation = 0;
+        double Et = 0.;
+
+        FString Target;
+        FString FixRef;
+        FString Observer;
+        FString IlluminationSource;
+
+        bool bLimb = true;
+        bool bTerminator = true;
+        FString LimbMethod;
+        FString TerminatorMethod;
+        const ANSICHAR* AberrationCorrection = "NONE";
+        const ANSICHAR* LimbLocus = "CENTER";
+        const ANSICHAR* TerminatorLocus = "CENTER";
+
+        int32 NumCuts = 0;
+        double SearchStep = 0.;
+        double SolutionTolerance = 0.;
+
+        double AngleTolerance = 0.;
+        double RangeTolerance = 0.;
+        double MaxAge = 0.;
+
+        double Scale = 1.;
+    };
+
+    // Moved further than the tolerances?
+    bool HasMoved(const double(&Now)[3], const double(&Then)[3], const FOutlineRequest& Request)
+    {
+        const double Range = vnorm_c(Now), Previous = vnorm_c(Then);
+        if (Previous <= 0. || FMath::Abs(Range / Previous - 1.) > Request.RangeTolerance)
+        {
+            return true;
+        }
+        return vsep_c(Now, Then) > Request.AngleTolerance;
+    }
+
+    // The cuts roll about Axis from refvec, which mustn't be near Axis.  The
+    // last one is kept while it's usable, so the points stay in order.
+    void PickReference(const double(&Axis)[3], bool bHaveReference, double(&refvec)[3])
+    {
+        const double Limit = 0.99 * vnorm_c(Axis);
+        if (bHaveReference && FMath::Abs(vdot_c(Axis, refvec)) < Limit)
+        {
+            return;
+        }
+        const double z[3] = { 0., 0., 1. }, x[3] = { 1., 0., 0. };
+        vequ_c(FMath::Abs(vdot_c(Axis, z)) < Limit ? z : x, refvec);
+    }
+
+    void Bundle(SpiceInt _ncuts, const TArray<SpiceInt>& _npts, const TArray<SpiceDouble>& _points, double Scale, TArray<FVector>& Outline)
+    {
+        Outline.Reset(_ncuts);
+        int32 First = 0;
+        for (SpiceInt cut = 0; cut < _ncuts; ++cut)
+        {
+            if (_npts[cut] > 0)
+            {
+                // Swizzle
+                const SpiceDouble* p = &_points[3 * First];
+                Outline.Add(FVector(p[1] * Scale, p[0] * Scale, p[2] * Scale));
+            }
+            First += _npts[cut];
+        }
+    }
+}
+
+
+struct USpiceOutlineComponent::FOutlineState
+{
+    bool bValid = false;
+    int32 Generation = -1;
+    double Et = 0.;
+    double Observer[3] = {};
+    double Source[3] = {};
+
+    bool bHaveReferences = false;
+    double LimbReference[3] = {};
+    double TerminatorReference[3] = {};
+};
+
+
+struct USpiceOutlineComponent::FOutlineResult
+{
+    enum class EStatus { Unchanged, Updated, Failed };
+
+    EStatus Status = EStatus::Unchanged;
+    int32 Generation = 0;
+    double Et = 0.;
+    TArray<FVector> Limb;
+    TArray<FVector> Terminator;
+    FString ErrorMessage;
+};
+
+
+USpiceOutlineComponent::USpiceOutlineComponent()
+    : State(MakeShared<FOutlineState, ESPMode::ThreadSafe>())
+{
+    PrimaryComponentTick.bCanEverTick = true;
+}
+
+
+void USpiceOutlineComponent::Invalidate()
+{
+    ++Generation;
+    // Check at the next tick
+    SinceCheck = UpdateInterval;
+}
+
+
+#if WITH_EDITOR
+void USpiceOutlineComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+    Invalidate();
+}
+#endif
+
+
+void USpiceOutlineComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    SinceCheck += DeltaTime;
+    if (bInFlight || SinceCheck < UpdateInterval || !(bLimb || bTerminator))
+    {
+        return;
+    }
+    SinceCheck = 0.f;
+    bInFlight = true;
+
+    FOutlineRequest Request;
+    Request.Generation = Generation;
+    Request.Et = Epoch.AsSpiceDouble();
+    Request.Target = Target;
+    Request.FixRef = FixRef;
+    Request.Observer = Observer;
+    Request.IlluminationSource = IlluminationSource;
+    Request.bLimb = bLimb;
+    Request.bTerminator = bTerminator;
+    Request.LimbMethod = MaxQ::Core::ToString(LimbMethod, ShapeSurfaces);
+    Request.TerminatorMethod = MaxQ::Core::ToString(Shadow, CurveType, TerminatorMethod, ShapeSurfaces);
+    Request.AberrationCorrection = MaxQ::Core::ToANSIString(AberrationCorrection);
+    Request.LimbLocus = MaxQ::Core::ToANSIString(LimbLocus);
+    Request.TerminatorLocus = MaxQ::Core::ToANSIString(TerminatorLocus);
+    Request.NumCuts = FMath::Max(3, NumCuts);
+    Request.SearchStep = SearchStep.AsSpiceDouble();
+    Request.SolutionTolerance = SolutionTolerance.AsSpiceDouble();
+    Request.AngleTolerance = AngleTolerance.AsSpiceDouble();
+    Request.RangeTolerance = RangeTolerance;
+    Request.MaxAge = MaxAge.AsSeconds();
+    Request.Scale = Scale;
+
+    TWeakObjectPtr<USpiceOutlineComponent> WeakThis(this);
+    TSharedPtr<FOutlineState, ESPMode::ThreadSafe> OutlineState = State;
+
+    FSpiceExecutor::Get().EnqueueCommand([WeakThis, OutlineState, Request = MoveTemp(Request)]()
+    {
+        FOutlineState& S = *OutlineState;
+        FOutlineResult Result;
+        Result.Generation = Request.Generation;
+        Result.Et = Request.Et;
+
+        auto _target = StringCast<ANSICHAR>(*Request.Target);
+        auto _fixref = StringCast<ANSICHAR>(*Request.FixRef);
+        auto _obsrvr = StringCast<ANSICHAR>(*Request.Observer);
+        auto _ilusrc = StringCast<ANSICHAR>(*Request.IlluminationSource);
+
+        SpiceDouble _obspos[3] = {}, _srcpos[3] = {}, _lt = 0.;
+        spkpos_c(_obsrvr.Get(), Request.Et, _fixref.Get(), "NONE", _target.Get(), _obspos, &_lt);
+        if (Request.bTerminator)
+        {
+            spkpos_c(_ilusrc.Get(), Request.Et, _fixref.Get(), "NONE", _target.Get(), _srcpos, &_lt);
+        }
+
+        bool bRecompute = !S.bValid || S.Generation != Request.Generation || FMath::Abs(Request.Et - S.Et) > Request.MaxAge;
+        bRecompute = bRecompute || HasMoved(_obspos, S.Observer, Request);
+        bRecompute = bRecompute || (Request.bTerminator && HasMoved(_srcpos, S.Source, Request));
+
+        if (!failed_c() && bRecompute)
+        {
+            PickReference(_obspos, S.bHaveReferences, S.LimbReference);
+            PickReference(Request.bTerminator ? _srcpos : _obspos, S.bHaveReferences, S.TerminatorReference);
+            S.bHaveReferences = true;
+
+            const SpiceInt _ncuts = Request.NumCuts;
+            const SpiceInt _maxn = _ncuts * MaxPointsPerCut;
+            const SpiceDouble _rolstp = twopi_c() / _ncuts;
+
+            TArray<SpiceInt> _npts;
+            TArray<SpiceDouble> _points, _epochs, _vectors;
+            _npts.SetNumZeroed(_ncuts);
+            _points.SetNumUninitialized(3 * _maxn);
+            _epochs.SetNumUninitialized(_maxn);
+            _vectors.SetNumUninitialized(3 * _maxn);
+
+            if (Request.bLimb)
+            {
+                limbpt_c(
+                    StringCast<ANSICHAR>(*Request.LimbMethod).Get(), _target.Get(), Request.Et, _fixref.Get(),
+                    Request.AberrationCorrection, Request.LimbLocus, _obsrvr.Get(), S.LimbReference,
+                    _rolstp, _ncuts, Request.SearchStep, Request.SolutionTolerance, _maxn,
+                    _npts.GetData(), (SpiceDouble(*)[3])_points.GetData(), _epochs.GetData(), (SpiceDouble(*)[3])_vectors.GetData()
+                );
+                if (!failed_c())
+                {
+                    Bundle(_ncuts, _npts, _points, Request.Scale, Result.Limb);
+                }
+            }
+
+            if (Request.bTerminator && !failed_c())
+            {
+                termpt_c(
+                    StringCast<ANSICHAR>(*Request.TerminatorMethod).Get(), _ilusrc.Get(), _target.Get(), Request.Et, _fixref.Get(),
+                    Request.AberrationCorrection, Request.TerminatorLocus, _obsrvr.Get(), S.TerminatorReference,
+                    _rolstp, _ncuts, Request.SearchStep, Request.SolutionTolerance, _maxn,
+                    _npts.GetData(), (SpiceDouble(*)[3])_points.GetData(), _epochs.GetData(), (SpiceDouble(*)[3])_vectors.GetData()
+                );
+                if (!failed_c())
+                {
+                    Bundle(_ncuts, _npts, _points, Request.Scale, Result.Terminator);
+                }
+            }
+
+            if (!failed_c())
+            {
+                S.bValid = true;
+                S.Generation = Request.Generation;
+                S.Et = Request.Et;
+                vequ_c(_obspos, S.Observer);
+                vequ_c(_srcpos, S.Source);
+                Result.Status = FOutlineResult::EStatus::Updated;
+            }
+        }
+
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        if (ErrorCheck(ResultCode, Result.ErrorMessage))
+        {
+            // Try again at the next check
+            S.bValid = false;
+            Result.Status = FOutlineResult::EStatus::Failed;
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, Result = MoveTemp(Result)]()
+        {
+            if (USpiceOutlineComponent* This = WeakThis.Get())
+            {
+                This->Completed(Result);
+            }
+        });
+    });
+}
+
+
+void USpiceOutlineComponent::Completed(const FOutlineResult& Result)
+{
+    bInFlight = false;
+
+    switch (Result.Status)
+    {
+    case FOutlineResult::EStatus::Updated:
+        if (Result.Generation == Generation)
+        {
+            Limb = Result.Limb;
+            Terminator = Result.Terminator;
+            OutlineEpoch = FSEphemerisTime(Result.Et);
+            OnUpdated.Broadcast();
+        }
+        break;
+
+    case FOutlineResult::EStatus::Failed:
+        UE_LOG(LogSpice, Warning, TEXT("USpiceOutlineComponent %s: %s"), *GetName(), *Result.ErrorMessage);
+        OnError.Broadcast(Result.ErrorMessage);
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void USpiceOutlineComponent::UpdateSpline(USplineComponent* Spline, bool bTerminatorOutline) const
+{
+    if (!Spline)
+    {
+        return;
+    }
+
+    Spline->SetSplinePoints(bTerminatorOutline ? Terminator : Limb, ESplineCoordinateSpace::Local, false);
+    Spline->SetClosedLoop(true, false);
+    Spline->UpdateSpline();
+}
@@ -0,0 +1,351 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePassPrediction.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Ground station pass prediction for whole SGP4 catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePassPrediction.cpp is part of the "refined C++ API".
+//
+// The work is split by satellite:  each ParallelFor task propagates its
+// satellite over the whole sweep once, then scans every station against
+// those positions.  Stations' Earth fixed positions and zenith directions
+// are computed once, up front.  Refinement propagates the satellite again
+// wherever the root finder (Illinois false position) or golden section
+// search asks for it.
+//------------------------------------------------------------------------------
+
+#include "SpicePassPrediction.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Orbits;
+
+    // WGS-84
+    constexpr double EarthRadius = 6378.137;
+    constexpr double EarthFlattening = 1. / 298.257223563;
+
+    constexpr double NotInView = -PI;
+    constexpr int32 MaxIterations = 100;
+
+    struct FStationFrame
+    {
+        double Position[3];
+        double Zenith[3];
+        double MinElevation;
+    };
+
+    struct FSweepPosition
+    {
+        double r[3];
+        bool bValid;
+    };
+
+    FStationFrame MakeStationFrame(const FGroundStation& Station)
+    {
+        const double e2 = EarthFlattening * (2. - EarthFlattening);
+        const double sinlat = FMath::Sin(Station.Latitude), coslat = FMath::Cos(Station.Latitude);
+        const double sinlon = FMath::Sin(Station.Longitude), coslon = FMath::Cos(Station.Longitude);
+        const double N = EarthRadius / FMath::Sqrt(1. - e2 * sinlat * sinlat);
+
+        FStationFrame Frame;
+        Frame.Position[0] = (N + Station.Altitude) * coslat * coslon;
+        Frame.Position[1] = (N + Station.Altitude) * coslat * sinlon;
+        Frame.Position[2] = (N * (1. - e2) + Station.Altitude) * sinlat;
+        Frame.Zenith[0] = coslat * coslon;
+        Frame.Zenith[1] = coslat * sinlon;
+        Frame.Zenith[2] = sinlat;
+        Frame.MinElevation = Station.MinElevation;
+        return Frame;
+    }
+
+    // TEME -> pseudo Earth fixed
+    bool EarthFixedPosition(const FSGP4Propagator& Satellite, double et, double DeltaUtc, double(&r)[3])
+    {
+        double state[6];
+        if (Satellite.Propagate(et, state) != ESGP4Status::Ok)
+        {
+            return false;
+        }
+
+        const double gmst = GreenwichMeanSiderealTime(et - DeltaUtc);
+        const double c = FMath::Cos(gmst), s = FMath::Sin(gmst);
+        r[0] = c * state[0] + s * state[1];
+        r[1] = -s * state[0] + c * state[1];
+        r[2] = state[2];
+        return true;
+    }
+
+    // recazl's elevation, from a station's zenith
+    double Elevation(const FStationFrame& Station, const double(&r)[3])
+    {
+        const double d[3] = { r[0] - Station.Position[0], r[1] - Station.Position[1], r[2] - Station.Position[2] };
+        const double Range = FMath::Sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        if (Range <= 0.)
+        {
+            return PI / 2.;
+        }
+        const double sinel = (d[0] * Station.Zenith[0] + d[1] * Station.Zenith[1] + d[2] * Station.Zenith[2]) / Range;
+        return FMath::Asin(FMath::Clamp(sinel, -1., 1.));
+    }
+
+    struct FPairSearch
+    {
+        const FSGP4Propagator& Satellite;
+        const FStationFrame& Station;
+        double DeltaUtc;
+        double Tolerance;
+
+        // Elevation above the mask
+        double operator()(double et) const
+        {
+            double r[3];
+            return EarthFixedPosition(Satellite, et, DeltaUtc, r) ? Elevation(Station, r) - Station.MinElevation : NotInView;
+        }
+
+        // f(a) and f(b) have opposite signs.  Returns the first time that's
+        // above the mask (rising) or the last (setting), to within Tolerance.
+        double Root(double a, double b, double fa, double fb) const
+        {
+            const bool bRising = fa <= 0.;
+            int32 Side = 0;
+            for (int32 i = 0; i < MaxIterations && b - a > Tolerance; ++i)
+            {
+                double c = (a * fb - b * fa) / (fb - fa);
+                if (!(c > a && c < b))
+                {
+                    c = 0.5 * (a + b);
+                }
+                const double fc = (*this)(c);
+
+                if ((fc > 0.) == (fb > 0.))
+                {
+                    b = c; fb = fc;
+                    if (Side == -1) fa *= 0.5;
+                    Side = -1;
+                }
+                else
+                {
+                    a = c; fa = fc;
+                    if (Side == 1) fb *= 0.5;
+                    Side = 1;
+                }
+            }
+            return bRising ? b : a;
+        }
+
+        // Golden section search for the highest point in [a, b]
+        double Peak(double a, double b, double& fPeak) const
+        {
+            constexpr double InvPhi = 0.6180339887498949;
+            double c = b - InvPhi * (b - a), d = a + InvPhi * (b - a);
+            double fc = (*this)(c), fd = (*this)(d);
+            for (int32 i = 0; i < MaxIterations && b - a > Tolerance; ++i)
+            {
+                if (fc > fd)
+                {
+                    b = d; d = c; fd = fc;
+                    c = b - InvPhi * (b - a); fc = (*this)(c);
+                }
+                else
+                {
+                    a = c; c = d; fc = fd;
+                    d = a + InvPhi * (b - a); fd = (*this)(d);
+                }
+            }
+            const double Mid = 0.5 * (a + b);
+            fPeak = (*this)(Mid);
+            return Mid;
+        }
+    };
+
+    void AddPass(const FPairSearch& Search, int32 Satellite, int32 Station, double AOS, double LOS, MaxQ::GeometryFinder::FSWindow& Window, TArray<FPass>& Passes)
+    {
+        FPass& Pass = Passes.AddDefaulted_GetRef();
+        Pass.Satellite = Satellite;
+        Pass.Station = Station;
+        Pass.AOS = AOS;
+        Pass.LOS = LOS;
+
+        double fPeak = 0.;
+        Pass.MaxElevationTime = Search.Peak(AOS, LOS, fPeak);
+
+        // A pass cut off by the window's ends may peak there
+        for (double et : { AOS, LOS })
+        {
+            const double f = Search(et);
+            if (f > fPeak)
+            {
+                fPeak = f;
+                Pass.MaxElevationTime = et;
+            }
+        }
+        Pass.MaxElevation = fPeak + Search.Station.MinElevation;
+
+        Window.Insert(AOS, LOS);
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    bool PredictPasses(
+        TArrayView<const FSGP4Propagator> Catalog,
+        TArrayView<const FGroundStation> Stations,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        FPassPredictions& Predictions,
+        const FPassPredictionSettings& Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Predictions = FPassPredictions();
+
+        const double Begin = Start.AsSpiceDouble();
+        const double End = Stop.AsSpiceDouble();
+        if (!(End >= Begin) || !(Settings.Step > 0.) || !(Settings.Tolerance > 0.))
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("PredictPasses: bad window [%f, %f], step %f or tolerance %f"), Begin, End, Settings.Step, Settings.Tolerance);
+            return false;
+        }
+
+        // One leapsecond, mid-window, misplaces the sky by ~15 arcseconds
+        SpiceDouble DeltaUtc = 0.;
+        deltet_c(Begin, "ET", &DeltaUtc);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        const int32 NumSatellites = Catalog.Num();
+        const int32 NumStations = Stations.Num();
+
+        TArray<FStationFrame> Frames;
+        Frames.Reserve(NumStations);
+        for (const FGroundStation& Station : Stations)
+        {
+            Frames.Add(MakeStationFrame(Station));
+        }
+
+        const int32 NumSteps = FMath::Max(1, FMath::CeilToInt((End - Begin) / Settings.Step));
+        const double Step = (End - Begin) / NumSteps;
+
+        Predictions.NumSatellites = NumSatellites;
+        Predictions.NumStations = NumStations;
+        Predictions.Windows.SetNum(NumSatellites * NumStations);
+
+        TArray<TArray<FPass>> SatellitePasses;
+        SatellitePasses.SetNum(NumSatellites);
+
+        ParallelFor(NumSatellites, [&](int32 Satellite)
+        {
+            const FSGP4Propagator& Propagator = Catalog[Satellite];
+            if (!Propagator.IsValid())
+            {
+                return;
+            }
+
+            // The sweep's positions, shared by every station
+            TArray<FSweepPosition> Positions;
+            Positions.SetNumUninitialized(NumSteps + 1);
+            for (int32 k = 0; k <= NumSteps; ++k)
+            {
+                Positions[k].bValid = EarthFixedPosition(Propagator, Begin + k * Step, DeltaUtc, Positions[k].r);
+            }
+
+            TArray<double> f;
+            f.SetNumUninitialized(NumSteps + 1);
+
+            for (int32 Station = 0; Station < NumStations; ++Station)
+            {
+                const FStationFrame& Frame = Frames[Station];
+                const FPairSearch Search { Propagator, Frame, DeltaUtc, Settings.Tolerance };
+                MaxQ::GeometryFinder::FSWindow& Window = Predictions.Windows[Satellite * NumStations + Station];
+                TArray<FPass>& Passes = SatellitePasses[Satellite];
+
+                for (int32 k = 0; k <= NumSteps; ++k)
+                {
+                    f[k] = Positions[k].bValid ? Elevation(Frame, Positions[k].r) - Frame.MinElevation : NotInView;
+                }
+
+                bool bUp = f[0] > 0.;
+                double AOS = Begin;
+                for (int32 k = 1; k <= NumSteps; ++k)
+                {
+                    const double t0 = Begin + (k - 1) * Step, t1 = Begin + k * Step;
+                    if (!bUp && f[k] > 0.)
+                    {
+                        AOS = Search.Root(t0, t1, f[k - 1], f[k]);
+                        bUp = true;
+                    }
+                    else if (bUp && f[k] <= 0.)
+                    {
+                        AddPass(Search, Satellite, Station, AOS, Search.Root(t0, t1, f[k - 1], f[k]), Window, Passes);
+                        bUp = false;
+                    }
+                    else if (!bUp && k < NumSteps && f[k] >= f[k - 1] && f[k] >= f[k + 1] && f[k] > NotInView)
+                    {
+                        // A local maximum below the mask:  the pass may have
+                        // peaked above it, between samples
+                        const double t2 = t1 + Step;
+                        double fPeak = 0.;
+                        const double tPeak = Search.Peak(t0, t2, fPeak);
+                        if (fPeak > 0.)
+                        {
+                            const double Rise = Search.Root(t0, tPeak, f[k - 1], fPeak);
+                            const double Set = Search.Root(tPeak, t2, fPeak, f[k + 1]);
+                            AddPass(Search, Satellite, Station, Rise, Set, Window, Passes);
+                        }
+                    }
+                }
+
+                if (bUp)
+                {
+                    AddPass(Search, Satellite, Station, AOS, End, Window, Passes);
+                }
+            }
+        });
+
+        for (TArray<FPass>& Passes : SatellitePasses)
+        {
+            Predictions.Passes.Append(MoveTemp(Passes));
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    double StationElevation(const FSGP4Propagator& Satellite, const FGroundStation& Station, double et, double DeltaUtc)
+    {
+        double r[3];
+        return EarthFixedPosition(Satellite, et, DeltaUtc, r) ? Elevation(MakeStationFrame(Station), r) : NotInView;
+    }
+}
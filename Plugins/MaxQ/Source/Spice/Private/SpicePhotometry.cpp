@@ -0,0 +1,113 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePhotometry.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Phase angles, ranges and visual magnitudes for whole catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePhotometry.cpp is part of the "refined C++ API".
+//
+// The phase angle is atan2(|a x b|, a . b) rather than acos of the
+// normalized dot product (as vsep takes care to be):  it's accurate near 0
+// and pi, where objects are nearly full or nearly new.
+//------------------------------------------------------------------------------
+
+#include "SpicePhotometry.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    // Shadow fractions this close to 1 are unlit
+    constexpr double MinLitFraction = 1.e-6;
+
+    template<typename ArrayType>
+    bool Matches(const ArrayType& Array, int32 Num)
+    {
+        return Array.Num() == 0 || Array.Num() == Num;
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    float VisualMagnitude(float StandardMagnitude, double Range, double Phase, float Shadow)
+    {
+        const double Lit = 1. - FMath::Clamp((double)Shadow, 0., 1.);
+        const double Diffuse = FMath::Sin(Phase) + (pi - Phase) * FMath::Cos(Phase);
+        if (!(Range > 0.) || Lit < MinLitFraction || !(Diffuse > 0.))
+        {
+            return UnlitMagnitude;
+        }
+
+        // pi F(phase) is Diffuse
+        const double m = StandardMagnitude + 5. * FMath::LogX(10., Range / 1000.) - 2.5 * FMath::LogX(10., Diffuse * Lit);
+        return (float)FMath::Min(m, (double)UnlitMagnitude);
+    }
+
+
+    bool Photometry(
+        const FSDistanceVector& Sun,
+        const FSDistanceVector& Observer,
+        const FConstVectorBatch& Positions,
+        const FPhotometryBatch& Out,
+        float StandardMagnitude,
+        TArrayView<const float> StandardMagnitudes,
+        TArrayView<const float> Shadows
+    )
+    {
+        const int32 Num = Positions.Num();
+        if (Positions.Y.Num() != Num || Positions.Z.Num() != Num || !Matches(Out.Phase, Num) || !Matches(Out.Range, Num) || !Matches(Out.Magnitude, Num)
+            || !Matches(StandardMagnitudes, Num) || !Matches(Shadows, Num))
+        {
+            return false;
+        }
+
+        double s[3], o[3];
+        Sun.CopyTo(s);
+        Observer.CopyTo(o);
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const double px = Positions.X[i], py = Positions.Y[i], pz = Positions.Z[i];
+
+                // Object to Sun, object to observer
+                const double ax = s[0] - px, ay = s[1] - py, az = s[2] - pz;
+                const double bx = o[0] - px, by = o[1] - py, bz = o[2] - pz;
+                const double cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+                const double Phase = FMath::Atan2(FMath::Sqrt(cx * cx + cy * cy + cz * cz), ax * bx + ay * by + az * bz);
+                const double Range = FMath::Sqrt(bx * bx + by * by + bz * bz);
+
+                if (Out.Phase.Num() > 0) Out.Phase[i] = (float)Phase;
+                if (Out.Range.Num() > 0) Out.Range[i] = (float)Range;
+                if (Out.Magnitude.Num() > 0)
+                {
+                    const float Standard = StandardMagnitudes.Num() > 0 ? StandardMagnitudes[i] : StandardMagnitude;
+                    Out.Magnitude[i] = VisualMagnitude(Standard, Range, Phase, Shadows.Num() > 0 ? Shadows[i] : 0.f);
+                }
+            }
+        }, Num <= ChunkSize);
+
+        return true;
+    }
+}
@@ -0,0 +1,433 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePoolSnapshot.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Binary snapshots of the kernel pool.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePoolSnapshot.cpp is part of the "refined C++ API".
+//
+// FurnshWithSnapshot only snapshots what its text kernels changed (the pool
+// is read before and after loading them), so variables that were already in
+// the pool aren't baked into the snapshot.
+//------------------------------------------------------------------------------
+
+#include "SpicePoolSnapshot.h"
+#include "SpiceData.h"
+#include "SpiceNameRegistry.h"
+#include "SpicePoolWatch.h"
+#include "SpiceUtilities.h"
+#include "HAL/FileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr uint32 SnapshotMagic = 0x4C4F4F50;  // "POOL"
+    constexpr int32 SnapshotVersion = 1;
+
+    // Kernel pool limits (MAXLEN, MAXCHR), plus the terminator
+    constexpr SpiceInt NameLength = 33;
+    constexpr SpiceInt ValueLength = 81;
+
+    struct FPoolVariable
+    {
+        FString Name;
+        bool bNumeric = true;
+        TArray<double> Numbers;
+        TArray<FString> Strings;
+
+        bool operator==(const FPoolVariable& Other) const
+        {
+            return bNumeric == Other.bNumeric && Numbers == Other.Numbers && Strings == Other.Strings;
+        }
+
+        friend FArchive& operator<<(FArchive& Ar, FPoolVariable& Variable)
+        {
+            Ar << Variable.Name;
+            Ar << Variable.bNumeric;
+            if (Variable.bNumeric)
+            {
+                Ar << Variable.Numbers;
+            }
+            else
+            {
+                Ar << Variable.Strings;
+            }
+            return Ar;
+        }
+    };
+
+    // Every variable in the pool
+    void ReadPool(TArray<FPoolVariable>& Variables)
+    {
+        TArray<FString> Names;
+        {
+            constexpr SpiceInt Room = 128;
+            SpiceChar _kvars[Room][NameLength];
+            SpiceInt _n = 0;
+            SpiceBoolean _found = SPICEFALSE;
+
+            for (SpiceInt _start = 0; !failed_c(); _start += _n)
+            {
+                gnpool_c("*", _start, Room, NameLength, &_n, _kvars, &_found);
+                if (!_found || _n <= 0)
+                {
+                    break;
+                }
+                for (SpiceInt i = 0; i < _n; ++i)
+                {
+                    Names.Add(FString(_kvars[i]));
+                }
+            }
+        }
+
+        Variables.Reset(Names.Num());
+        for (const FString& Name : Names)
+        {
+            auto _name = StringCast<ANSICHAR>(*Name);
+            SpiceBoolean _found = SPICEFALSE;
+            SpiceInt _n = 0;
+            SpiceChar _type[1] = { 'X' };
+            dtpool_c(_name.Get(), &_found, &_n, _type);
+            if (failed_c() || !_found)
+            {
+                continue;
+            }
+
+            FPoolVariable& Variable = Variables.AddDefaulted_GetRef();
+            Variable.Name = Name;
+            Variable.bNumeric = _type[0] == 'N';
+
+            SpiceInt _count = 0;
+            if (Variable.bNumeric)
+            {
+                Variable.Numbers.SetNumUninitialized(_n);
+                gdpool_c(_name.Get(), 0, _n, &_count, Variable.Numbers.GetData(), &_found);
+                Variable.Numbers.SetNum(_count);
+            }
+            else
+            {
+                TArray<SpiceChar> _cvals;
+                _cvals.SetNumZeroed(_n * ValueLength);
+                gcpool_c(_name.Get(), 0, _n, ValueLength, &_count, _cvals.GetData(), &_found);
+                for (SpiceInt i = 0; i < _count; ++i)
+                {
+                    Variable.Strings.Add(FString(&_cvals[i * ValueLength]));
+                }
+            }
+        }
+    }
+
+    void WritePool(TArrayView<const FPoolVariable> Variables)
+    {
+        TArray<SpiceChar> _cvals;
+        for (const FPoolVariable& Variable : Variables)
+        {
+            auto _name = StringCast<ANSICHAR>(*Variable.Name);
+            if (Variable.bNumeric)
+            {
+                pdpool_c(_name.Get(), Variable.Numbers.Num(), Variable.Numbers.GetData());
+            }
+            else
+            {
+                _cvals.SetNumZeroed(Variable.Strings.Num() * ValueLength);
+                for (int32 i = 0; i < Variable.Strings.Num(); ++i)
+                {
+                    FCStringAnsi::Strncpy(&_cvals[i * ValueLength], StringCast<ANSICHAR>(*Variable.Strings[i]).Get(), ValueLength);
+                }
+                pcpool_c(_name.Get(), Variable.Strings.Num(), ValueLength, _cvals.GetData());
+            }
+
+            if (failed_c())
+            {
+                break;
+            }
+        }
+
+        BumpPoolGeneration();
+        MaxQ::Data::NotifyPoolWatchers();
+    }
+
+    void Serialize(FArchive& Ar, TArray<FPoolVariable>& Variables)
+    {
+        uint32 Magic = SnapshotMagic;
+        int32 Version = SnapshotVersion;
+        Ar << Magic;
+        Ar << Version;
+        if (Ar.IsLoading() && (Magic != SnapshotMagic || Version != SnapshotVersion))
+        {
+            Ar.SetError();
+            return;
+        }
+        Ar << Variables;
+    }
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    // Text kernels (but not meta-kernels, which load other kernels)
+    bool IsSnapshotKernel(TArrayView<const uint8> Contents)
+    {
+        return Contents.Num() >= 4 && FMemory::Memcmp(Contents.GetData(), "KPL/", 4) == 0
+            && !(Contents.Num() >= 6 && FMemory::Memcmp(Contents.GetData(), "KPL/MK", 6) == 0);
+    }
+
+    // Loads Paths, and serializes the variables they changed
+    bool FurnshAndDiff(const TArray<FString>& Paths, TArray<uint8>& Snapshot, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        TArray<FPoolVariable> Before;
+        ReadPool(Before);
+
+        if (!MaxQ::Data::Furnsh(Paths, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        // Only what the text kernels changed
+        TArray<FPoolVariable> After;
+        ReadPool(After);
+        TMap<FString, const FPoolVariable*> Existing;
+        for (const FPoolVariable& Variable : Before)
+        {
+            Existing.Add(Variable.Name, &Variable);
+        }
+        After.RemoveAll([&Existing](const FPoolVariable& Variable)
+        {
+            const FPoolVariable* const* Found = Existing.Find(Variable.Name);
+            return Found && **Found == Variable;
+        });
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        Snapshot.Reset();
+        FMemoryWriter Writer(Snapshot);
+        Serialize(Writer, After);
+        return true;
+    }
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API bool SavePoolSnapshot(
+        TArray<uint8>& Snapshot,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        TArray<FPoolVariable> Variables;
+        ReadPool(Variables);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        Snapshot.Reset();
+        FMemoryWriter Writer(Snapshot);
+        Serialize(Writer, Variables);
+        return true;
+    }
+
+
+    SPICE_API bool LoadPoolSnapshot(
+        TArrayView<const uint8> Snapshot,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        TArray<FPoolVariable> Variables;
+        FMemoryReaderView Reader(Snapshot);
+        Serialize(Reader, Variables);
+        if (Reader.IsError())
+        {
+            return Fail(TEXT("LoadPoolSnapshot: not a pool snapshot, or from another version"), ResultCode, ErrorMessage);
+        }
+
+        WritePool(Variables);
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API bool FurnshWithSnapshot(
+        const TArray<FString>& relativePaths,
+        const FString& snapshotDirectory,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        // Sort the text kernels from everything else, and hash them (names
+        // and contents, in load order).
+        TArray<FString> TextKernels;
+        TArray<FString> OtherKernels;
+        uint64 Hash = SnapshotVersion;
+
+        for (const FString& relativePath : relativePaths)
+        {
+            const FString Path = toPath(relativePath);
+            TArray<uint8> Contents;
+            if (!FFileHelper::LoadFileToArray(Contents, *Path, FILEREAD_Silent))
+            {
+                return Fail(FString::Printf(TEXT("FurnshWithSnapshot: could not read %s"), *Path), ResultCode, ErrorMessage);
+            }
+
+            if (IsSnapshotKernel(Contents))
+            {
+                auto _path = StringCast<ANSICHAR>(*Path);
+                Hash = CityHash64WithSeed(_path.Get(), _path.Length(), Hash);
+                Hash = CityHash64WithSeed((const char*)Contents.GetData(), Contents.Num(), Hash);
+                TextKernels.Add(Path);
+            }
+            else
+            {
+                OtherKernels.Add(Path);
+            }
+        }
+
+        const FString Directory = snapshotDirectory.IsEmpty()
+            ? SavedPath(TEXT("PoolSnapshots"))
+            : toPath(snapshotDirectory);
+        const FString SnapshotPath = FPaths::Combine(Directory, FString::Printf(TEXT("%016llx.pool"), Hash));
+
+        bool bRestored = false;
+        TArray<uint8> Snapshot;
+        if (TextKernels.Num() > 0 && FFileHelper::LoadFileToArray(Snapshot, *SnapshotPath, FILEREAD_Silent))
+        {
+            bRestored = LoadPoolSnapshot(Snapshot, nullptr, nullptr);
+            if (bRestored)
+            {
+                UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE restored %d text kernels from pool snapshot %s"), TextKernels.Num(), *SnapshotPath);
+                for (const FString& Path : TextKernels)
+                {
+                    RecordKernelOperation(FKernelHistoryEntry::EOperation::Furnsh, Path);
+                }
+            }
+        }
+
+        if (!bRestored && TextKernels.Num() > 0)
+        {
+            if (!FurnshAndDiff(TextKernels, Snapshot, ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+
+            // Write, then move into place (another process may be reading it)
+            const FString TempPath = FString::Printf(TEXT("%s.%u.tmp"), *SnapshotPath, FPlatformProcess::GetCurrentProcessId());
+            if (FFileHelper::SaveArrayToFile(Snapshot, *TempPath))
+            {
+                IFileManager::Get().Move(*SnapshotPath, *TempPath, true, true);
+                IFileManager::Get().Delete(*TempPath, false, false, true);
+            }
+        }
+
+        if (OtherKernels.Num() > 0 && !Furnsh(OtherKernels, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API bool BakePoolSnapshot(
+        const TArray<FString>& textKernelPaths,
+        const FString& outputPath,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        for (const FString& relativePath : textKernelPaths)
+        {
+            TArray<uint8> Contents;
+            if (!FFileHelper::LoadFileToArray(Contents, *toPath(relativePath), FILEREAD_Silent) || !IsSnapshotKernel(Contents))
+            {
+                return Fail(FString::Printf(TEXT("BakePoolSnapshot: %s is not a text kernel (or a meta-kernel)"), *relativePath), ResultCode, ErrorMessage);
+            }
+        }
+
+        TArray<uint8> Snapshot;
+        const bool bBaked = FurnshAndDiff(textKernelPaths, Snapshot, ResultCode, ErrorMessage);
+
+        // Whether or not that worked, leave the pool as it was
+        for (int32 i = textKernelPaths.Num() - 1; i >= 0; --i)
+        {
+            Unload(textKernelPaths[i]);
+        }
+        UnexpectedErrorCheck(true);
+
+        if (!bBaked)
+        {
+            return false;
+        }
+
+        const FString Path = toPath(outputPath);
+        if (!FFileHelper::SaveArrayToFile(Snapshot, *Path))
+        {
+            return Fail(FString::Printf(TEXT("BakePoolSnapshot: could not write %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE baked %d text kernels into pool snapshot %s"), textKernelPaths.Num(), *Path);
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API bool FurnshPoolSnapshot(
+        const FString& relativePath,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const FString Path = toPath(relativePath);
+        TArray<uint8> Snapshot;
+        if (!FFileHelper::LoadFileToArray(Snapshot, *Path, FILEREAD_Silent))
+        {
+            return Fail(FString::Printf(TEXT("FurnshPoolSnapshot: could not read %s"), *Path), ResultCode, ErrorMessage);
+        }
+
+        if (!LoadPoolSnapshot(Snapshot, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        // (Body names may have come with it)
+        UpdateNameRegistry();
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE restored pool snapshot %s"), *Path);
+        return true;
+    }
+}
@@ -0,0 +1,219 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePoolWatch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Kernel pool change notifications, as delegates.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePoolWatch.cpp is part of the "refined C++ API".
+//
+// The watch list lives in CSPICE;  MaxQ only keeps the delegates.  A
+// delegate can change the pool (or the watch list) itself, which asks again
+// from inside a broadcast.  That's deferred, and done once the outer pass
+// finishes.
+//------------------------------------------------------------------------------
+
+#include "SpicePoolWatch.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // A delegate that changes the pool every time it's told the pool
+    // changed would go on forever
+    constexpr int32 MaxPasses = 8;
+
+    struct FPoolWatchers
+    {
+        TMap<FString, MaxQ::Data::FOnPoolChanged> Agents;
+        bool bNotifying = false;
+        bool bAgain = false;
+    };
+
+    FPoolWatchers& PoolWatchers()
+    {
+        static FPoolWatchers Instance;
+        return Instance;
+    }
+
+    FString AgentKey(const FString& Agent)
+    {
+        // swpool_c ignores trailing blanks
+        return Agent.TrimEnd();
+    }
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API FDelegateHandle WatchPool(
+        const FString& Agent,
+        const TArray<FString>& Variables,
+        const FOnPoolChanged::FDelegate& Delegate,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FDelegateHandle Handle;
+
+        if (Variables.Num() > 0)
+        {
+            int32 MaxLength = 0;
+            for (const FString& Variable : Variables)
+            {
+                MaxLength = FMath::Max(MaxLength, Variable.Len());
+            }
+
+            const int32 Length = MaxLength + 1;
+            TArray<ANSICHAR> _names;
+            _names.SetNumZeroed(Variables.Num() * Length);
+            for (int32 i = 0; i < Variables.Num(); ++i)
+            {
+                FCStringAnsi::Strncpy(&_names[i * Length], TCHAR_TO_ANSI(*Variables[i]), Length);
+            }
+
+            const FString Key = AgentKey(Agent);
+            auto _agent = StringCast<ANSICHAR>(*Key);
+            swpool_c(_agent.Get(), Variables.Num(), Length, _names.GetData());
+
+            // A new watch always reports an update.  Nothing has changed yet,
+            // as far as this subscriber knows.
+            SpiceBoolean _update = SPICEFALSE;
+            cvpool_c(_agent.Get(), &_update);
+
+            if (!failed_c())
+            {
+                Handle = PoolWatchers().Agents.FindOrAdd(Key).Add(Delegate);
+            }
+        }
+        else
+        {
+            setmsg_c("Agent # must watch at least one variable.");
+            errch_c("#", TCHAR_TO_ANSI(*Agent));
+            sigerr_c("SPICE(INVALIDCOUNT)");
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+
+        return Handle;
+    }
+
+
+    SPICE_API FDelegateHandle WatchPoolVariable(
+        const FString& Variable,
+        const FOnPoolChanged::FDelegate& Delegate,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        return WatchPool(Variable, { Variable }, Delegate, ResultCode, ErrorMessage);
+    }
+
+
+    SPICE_API void UnwatchPool(const FString& Agent, FDelegateHandle Handle)
+    {
+        const FString Key = AgentKey(Agent);
+
+        FPoolWatchers& Watchers = PoolWatchers();
+        FOnPoolChanged* Delegates = Watchers.Agents.Find(Key);
+        if (!Delegates)
+        {
+            return;
+        }
+
+        Delegates->Remove(Handle);
+        if (Delegates->IsBound())
+        {
+            return;
+        }
+
+        Watchers.Agents.Remove(Key);
+
+        // dwpool_c won't delete an agent with an update pending
+        auto _agent = StringCast<ANSICHAR>(*Key);
+        SpiceBoolean _update = SPICEFALSE;
+        cvpool_c(_agent.Get(), &_update);
+        dwpool_c(_agent.Get());
+
+        UnexpectedErrorCheck(true);
+    }
+
+
+    SPICE_API void NotifyPoolWatchers()
+    {
+        FPoolWatchers& Watchers = PoolWatchers();
+
+        // Let an error get to whoever's waiting for it.  The agents' flags
+        // stay set until the next time.
+        if (Watchers.Agents.Num() == 0 || failed_c())
+        {
+            return;
+        }
+
+        if (Watchers.bNotifying)
+        {
+            Watchers.bAgain = true;
+            return;
+        }
+
+        Watchers.bNotifying = true;
+
+        for (int32 Pass = 0; Pass < MaxPasses; ++Pass)
+        {
+            Watchers.bAgain = false;
+
+            TArray<FString> Changed;
+            for (const auto& Agent : Watchers.Agents)
+            {
+                SpiceBoolean _update = SPICEFALSE;
+                cvpool_c(TCHAR_TO_ANSI(*Agent.Key), &_update);
+                if (_update)
+                {
+                    Changed.Add(Agent.Key);
+                }
+            }
+
+            if (UnexpectedErrorCheck(true))
+            {
+                break;
+            }
+
+            for (const FString& Agent : Changed)
+            {
+                // A delegate may unwatch (or watch) while it's being called
+                if (const FOnPoolChanged* Delegates = Watchers.Agents.Find(Agent))
+                {
+                    const FOnPoolChanged Broadcast = *Delegates;
+                    Broadcast.Broadcast(Agent);
+                }
+            }
+
+            if (!Watchers.bAgain || failed_c())
+            {
+                break;
+            }
+        }
+
+        Watchers.bNotifying = false;
+    }
+}
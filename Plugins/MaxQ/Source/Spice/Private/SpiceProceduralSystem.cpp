@@ -0,0 +1,556 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceProceduralSystem.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Generates kernels (SPK, PCK, FK) for procedural star systems.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceProceduralSystem.cpp is part of the "refined C++ API".
+//
+// N-body states are integrated relative to the star, so each body feels
+//     -(GM_star + GM_i) r_i / |r_i|^3
+//     + sum over j != i of GM_j ((r_j - r_i) / |r_j - r_i|^3 - r_j / |r_j|^3)
+// (the second term of the sum is the star's acceleration toward body j).
+// Bodies orbiting other bodies start at the sum of their chain of Center
+// states, and are written relative to their Center again.
+//
+// The text kernels are written by hand, as the rest of MaxQ writes its
+// reports.  Frame names are IAU_ and the body's name, upper case, with
+// spaces as underscores.
+//------------------------------------------------------------------------------
+
+#include "SpiceProceduralSystem.h"
+#include "SpiceTwoBody.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Ephemeris;
+
+    // DAF internal file names are 60 characters at most
+    constexpr int32 MaxInternalFileName = 60;
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    FString FrameName(const FProceduralBody& Body)
+    {
+        return TEXT("IAU_") + Body.Name.ToUpper().Replace(TEXT(" "), TEXT("_"));
+    }
+
+    // Index of each body's Center in Bodies, or INDEX_NONE for the star.
+    // False if a Center is neither the star nor an earlier body.
+    bool ResolveCenters(const FProceduralSystem& System, TArray<int32>& Parents, FString& Message)
+    {
+        Parents.SetNum(System.Bodies.Num());
+        for (int32 i = 0; i < System.Bodies.Num(); ++i)
+        {
+            const int32 Center = System.Bodies[i].Center;
+            Parents[i] = INDEX_NONE;
+            if (Center == System.Star.Id)
+            {
+                continue;
+            }
+
+            for (int32 j = 0; j < i; ++j)
+            {
+                if (System.Bodies[j].Id == Center)
+                {
+                    Parents[i] = j;
+                    break;
+                }
+            }
+
+            if (Parents[i] == INDEX_NONE)
+            {
+                Message = FString::Printf(TEXT("PropagateSystem: %s's center %d is neither the star nor an earlier body"), *System.Bodies[i].Name, Center);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Start, every Step after it, and Stop
+    void SampleEpochs(const FProceduralSystemSettings& Settings, TArray<double>& Epochs)
+    {
+        Epochs.Reset();
+        const int32 Steps = FMath::CeilToInt((Settings.Stop - Settings.Start) / Settings.Step);
+        for (int32 i = 0; i < Steps; ++i)
+        {
+            Epochs.Add(Settings.Start + i * Settings.Step);
+        }
+        Epochs.Add(Settings.Stop);
+    }
+
+    bool PropagateConics(const FProceduralSystem& System, FProceduralSystemStates& States, FString& Message)
+    {
+        TArray<FSConicElements> Elements;
+        for (const FProceduralBody& Body : System.Bodies)
+        {
+            Elements.Add(Body.Elements);
+        }
+
+        MaxQ::Orbits::FTwoBodyBatchPropagator Propagator;
+        Propagator.Build(Elements);
+        for (int32 i = 0; i < Elements.Num(); ++i)
+        {
+            if (!Propagator.IsValid(i))
+            {
+                Message = FString::Printf(TEXT("PropagateSystem: %s's conic elements are invalid"), *System.Bodies[i].Name);
+                return false;
+            }
+        }
+
+        const int32 NumBodies = System.Bodies.Num();
+        const int32 NumEpochs = States.Epochs.Num();
+
+        // Propagate writes one epoch's states for every body
+        ParallelFor(NumEpochs, [&](int32 e)
+        {
+            TArray<FSStateVector> Epoch;
+            Epoch.SetNum(NumBodies);
+            Propagator.Propagate(States.Epochs[e], Epoch);
+            for (int32 b = 0; b < NumBodies; ++b)
+            {
+                States.States[b][e] = Epoch[b];
+            }
+        });
+
+        return true;
+    }
+
+    // dy/dt of every body's star-relative state
+    void NBodyDerivative(const double* y, const double* gm, double gmStar, int32 Num, double* dy)
+    {
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const double* ri = &y[i * 6];
+            double a[3];
+            const double r2 = ri[0] * ri[0] + ri[1] * ri[1] + ri[2] * ri[2];
+            const double k = -(gmStar + gm[i]) / (r2 * sqrt(r2));
+            a[0] = k * ri[0];
+            a[1] = k * ri[1];
+            a[2] = k * ri[2];
+
+            for (int32 j = 0; j < Num; ++j)
+            {
+                if (j == i || gm[j] <= 0.)
+                {
+                    continue;
+                }
+
+                const double* rj = &y[j * 6];
+                const double d[3] = { rj[0] - ri[0], rj[1] - ri[1], rj[2] - ri[2] };
+                const double d2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+                const double j2 = rj[0] * rj[0] + rj[1] * rj[1] + rj[2] * rj[2];
+                const double kd = gm[j] / (d2 * sqrt(d2));
+                const double kj = gm[j] / (j2 * sqrt(j2));
+                a[0] += kd * d[0] - kj * rj[0];
+                a[1] += kd * d[1] - kj * rj[1];
+                a[2] += kd * d[2] - kj * rj[2];
+            }
+
+            double* dyi = &dy[i * 6];
+            dyi[0] = ri[3];
+            dyi[1] = ri[4];
+            dyi[2] = ri[5];
+            dyi[3] = a[0];
+            dyi[4] = a[1];
+            dyi[5] = a[2];
+        }
+    }
+
+    bool PropagateNBody(const FProceduralSystem& System, const FProceduralSystemSettings& Settings, const TArray<int32>& Parents, FProceduralSystemStates& States, FString& Message)
+    {
+        const int32 Num = System.Bodies.Num();
+        const int32 N = Num * 6;
+
+        // Star-relative initial states, down each body's chain of Centers
+        TArray<double> y, gm;
+        y.SetNumZeroed(N);
+        gm.SetNumZeroed(Num);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            double s[6];
+            System.Bodies[i].State.CopyTo(s);
+            for (int32 c = 0; c < 6; ++c)
+            {
+                y[i * 6 + c] = s[c] + (Parents[i] != INDEX_NONE ? y[Parents[i] * 6 + c] : 0.);
+            }
+            gm[i] = System.Bodies[i].GM;
+
+            if (s[0] == 0. && s[1] == 0. && s[2] == 0.)
+            {
+                Message = FString::Printf(TEXT("PropagateSystem: %s has no initial position"), *System.Bodies[i].Name);
+                return false;
+            }
+        }
+
+        TArray<double> k1, k2, k3, k4, t;
+        for (TArray<double>* a : { &k1, &k2, &k3, &k4, &t })
+        {
+            a->SetNumUninitialized(N);
+        }
+
+        const int32 Substeps = FMath::Max(1, Settings.Substeps);
+        const double gmStar = System.Star.GM;
+
+        auto Record = [&](int32 e)
+        {
+            for (int32 i = 0; i < Num; ++i)
+            {
+                double s[6];
+                for (int32 c = 0; c < 6; ++c)
+                {
+                    s[c] = y[i * 6 + c] - (Parents[i] != INDEX_NONE ? y[Parents[i] * 6 + c] : 0.);
+                }
+                States.States[i][e] = FSStateVector(s);
+            }
+        };
+
+        Record(0);
+        for (int32 e = 1; e < States.Epochs.Num(); ++e)
+        {
+            const double h = (States.Epochs[e] - States.Epochs[e - 1]) / Substeps;
+            for (int32 s = 0; s < Substeps; ++s)
+            {
+                NBodyDerivative(y.GetData(), gm.GetData(), gmStar, Num, k1.GetData());
+                for (int32 c = 0; c < N; ++c) t[c] = y[c] + 0.5 * h * k1[c];
+                NBodyDerivative(t.GetData(), gm.GetData(), gmStar, Num, k2.GetData());
+                for (int32 c = 0; c < N; ++c) t[c] = y[c] + 0.5 * h * k2[c];
+                NBodyDerivative(t.GetData(), gm.GetData(), gmStar, Num, k3.GetData());
+                for (int32 c = 0; c < N; ++c) t[c] = y[c] + h * k3[c];
+                NBodyDerivative(t.GetData(), gm.GetData(), gmStar, Num, k4.GetData());
+                for (int32 c = 0; c < N; ++c) y[c] += h / 6. * (k1[c] + 2. * k2[c] + 2. * k3[c] + k4[c]);
+            }
+
+            for (int32 c = 0; c < N; ++c)
+            {
+                if (!FMath::IsFinite(y[c]))
+                {
+                    Message = FString::Printf(TEXT("PropagateSystem: %s's integration diverged (a collision?)"), *System.Name);
+                    return false;
+                }
+            }
+            Record(e);
+        }
+
+        return true;
+    }
+
+    FString Comments(const FProceduralSystem& System)
+    {
+        return FString::Printf(TEXT("Procedural system %s, generated by MaxQ.\n"), *System.Name);
+    }
+
+    FString PckText(const FProceduralSystem& System)
+    {
+        FString Text = TEXT("KPL/PCK\n\n") + Comments(System) + TEXT("\n\\begindata\n\n");
+
+        auto Body = [&Text](const FProceduralBody& b)
+        {
+            const double a = b.Radii.x.km, bb = b.Radii.y.km, c = b.Radii.z.km;
+            if (a > 0. || bb > 0. || c > 0.)
+            {
+                Text += FString::Printf(TEXT("BODY%d_RADII     = ( %.17g %.17g %.17g )\n"), b.Id, a, bb, c);
+            }
+            if (b.GM > 0.)
+            {
+                Text += FString::Printf(TEXT("BODY%d_GM        = ( %.17g )\n"), b.Id, b.GM);
+            }
+            if (b.bRotates)
+            {
+                Text += FString::Printf(TEXT("BODY%d_POLE_RA   = ( %.17g 0. 0. )\n"), b.Id, b.PoleRA);
+                Text += FString::Printf(TEXT("BODY%d_POLE_DEC  = ( %.17g 0. 0. )\n"), b.Id, b.PoleDec);
+                Text += FString::Printf(TEXT("BODY%d_PM        = ( %.17g %.17g 0. )\n"), b.Id, b.PrimeMeridian, b.RotationRate);
+            }
+        };
+
+        Body(System.Star);
+        for (const FProceduralBody& b : System.Bodies)
+        {
+            Body(b);
+        }
+
+        Text += TEXT("\n\\begintext\n");
+        return Text;
+    }
+
+    FString FkText(const FProceduralSystem& System, const FProceduralSystemSettings& Settings)
+    {
+        FString Text = TEXT("KPL/FK\n\n") + Comments(System) + TEXT("\n\\begindata\n\n");
+
+        auto Body = [&Text](const FProceduralBody& b, int32 FrameId)
+        {
+            Text += FString::Printf(TEXT("NAIF_BODY_NAME += ( '%s' )\n"), *b.Name.ToUpper());
+            Text += FString::Printf(TEXT("NAIF_BODY_CODE += ( %d )\n"), b.Id);
+            if (b.bRotates)
+            {
+                const FString Frame = FrameName(b);
+                Text += FString::Printf(TEXT("FRAME_%s = %d\n"), *Frame, FrameId);
+                Text += FString::Printf(TEXT("FRAME_%d_NAME = '%s'\n"), FrameId, *Frame);
+                Text += FString::Printf(TEXT("FRAME_%d_CLASS = 2\n"), FrameId);
+                Text += FString::Printf(TEXT("FRAME_%d_CLASS_ID = %d\n"), FrameId, b.Id);
+                Text += FString::Printf(TEXT("FRAME_%d_CENTER = %d\n"), FrameId, b.Id);
+                Text += FString::Printf(TEXT("OBJECT_%d_FRAME = '%s'\n"), b.Id, *Frame);
+            }
+            Text += TEXT("\n");
+        };
+
+        Body(System.Star, Settings.FirstFrameId - 1);
+        for (int32 i = 0; i < System.Bodies.Num(); ++i)
+        {
+            Body(System.Bodies[i], Settings.FirstFrameId + i);
+        }
+
+        Text += TEXT("\\begintext\n");
+        return Text;
+    }
+}
+
+
+namespace MaxQ::Ephemeris
+{
+    bool PropagateSystem(
+        const FProceduralSystem& System,
+        const FProceduralSystemSettings& Settings,
+        FProceduralSystemStates& States,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        States = FProceduralSystemStates();
+
+        if (!(Settings.Stop > Settings.Start) || !(Settings.Step > 0.))
+        {
+            return Fail(TEXT("PropagateSystem: the span is empty, or Step isn't positive"), ResultCode, ErrorMessage);
+        }
+
+        FString Message;
+        TArray<int32> Parents;
+        if (!ResolveCenters(System, Parents, Message))
+        {
+            return Fail(Message, ResultCode, ErrorMessage);
+        }
+
+        SampleEpochs(Settings, States.Epochs);
+        States.States.SetNum(System.Bodies.Num());
+        for (TArray<FSStateVector>& Body : States.States)
+        {
+            Body.SetNum(States.Epochs.Num());
+        }
+
+        if (System.Propagation == EProceduralPropagation::NBody)
+        {
+            if (!(System.Star.GM > 0.))
+            {
+                return Fail(FString::Printf(TEXT("PropagateSystem: %s's star needs a GM"), *System.Name), ResultCode, ErrorMessage);
+            }
+            if (!PropagateNBody(System, Settings, Parents, States, Message))
+            {
+                return Fail(Message, ResultCode, ErrorMessage);
+            }
+        }
+        else if (!PropagateConics(System, States, Message))
+        {
+            return Fail(Message, ResultCode, ErrorMessage);
+        }
+
+        if (Settings.bChebyshev)
+        {
+            const int32 Num = System.Bodies.Num();
+            States.Segments.SetNum(Num);
+            TArray<FString> Messages;
+            Messages.SetNum(Num);
+
+            // Each fit is parallel too
+            ParallelFor(Num, [&](int32 i)
+            {
+                ES_ResultCode Result = ES_ResultCode::Success;
+                FitChebyshevSegments(States.Epochs, States.States[i], States.Segments[i], Settings.FitSettings, &Result, &Messages[i]);
+                if (Result != ES_ResultCode::Success && Messages[i].IsEmpty())
+                {
+                    Messages[i] = FString::Printf(TEXT("PropagateSystem: fitting %s failed"), *System.Bodies[i].Name);
+                }
+            });
+
+            for (const FString& Fit : Messages)
+            {
+                if (!Fit.IsEmpty())
+                {
+                    return Fail(Fit, ResultCode, ErrorMessage);
+                }
+            }
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        return true;
+    }
+
+
+    bool WriteSystemKernels(
+        const FProceduralSystem& System,
+        const FProceduralSystemSettings& Settings,
+        const FProceduralSystemStates& States,
+        const FString& SpkPath,
+        const FString& PckPath,
+        const FString& FkPath,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (States.States.Num() != System.Bodies.Num() || (Settings.bChebyshev && States.Segments.Num() != System.Bodies.Num()))
+        {
+            return Fail(FString::Printf(TEXT("WriteSystemKernels: %s's states weren't propagated with these settings"), *System.Name), ResultCode, ErrorMessage);
+        }
+
+        if (!PckPath.IsEmpty() && !FFileHelper::SaveStringToFile(PckText(System), *toPath(PckPath)))
+        {
+            return Fail(FString::Printf(TEXT("WriteSystemKernels: could not write %s"), *PckPath), ResultCode, ErrorMessage);
+        }
+
+        if (!FkPath.IsEmpty() && !FFileHelper::SaveStringToFile(FkText(System, Settings), *toPath(FkPath)))
+        {
+            return Fail(FString::Printf(TEXT("WriteSystemKernels: could not write %s"), *FkPath), ResultCode, ErrorMessage);
+        }
+
+        if (SpkPath.IsEmpty())
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Success;
+            return true;
+        }
+
+        const FString Destination = toPath(SpkPath);
+        IFileManager::Get().Delete(*Destination, false, true, true);
+        IFileManager::Get().MakeDirectory(*FPaths::GetPath(Destination), true);
+
+        auto _destination = StringCast<ANSICHAR>(*Destination);
+        auto _ifname = StringCast<ANSICHAR>(*System.Name.Left(MaxInternalFileName));
+        SpiceInt _handle = 0;
+        spkopn_c(_destination.Get(), _ifname.Get(), 0, &_handle);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        const FString SegId = System.Name.Left(40);
+        bool bOk = true;
+        for (int32 i = 0; i < System.Bodies.Num() && bOk; ++i)
+        {
+            const FProceduralBody& Body = System.Bodies[i];
+            if (Settings.bChebyshev)
+            {
+                bOk = WriteChebyshevSegments(_handle, Body.Id, Body.Center, Settings.Frame, SegId, States.Segments[i], ResultCode, ErrorMessage);
+            }
+            else
+            {
+                FSpkSegmentWriterSettings SegmentSettings = Settings.SegmentSettings;
+                if (SegmentSettings.Type == ESpkSegmentType::Type05 && SegmentSettings.GM <= 0.)
+                {
+                    SegmentSettings.GM = System.Propagation == EProceduralPropagation::Conics ? Body.Elements.GravitationalParameter.GM : System.Star.GM;
+                }
+
+                FSpkSegmentWriter Writer;
+                bOk = Writer.Begin(_handle, Body.Id, Body.Center, Settings.Frame, SegId, SegmentSettings, ResultCode, ErrorMessage)
+                    && Writer.Add(States.Epochs, States.States[i], ResultCode, ErrorMessage);
+                bOk = Writer.End(ResultCode, ErrorMessage) && bOk;
+            }
+        }
+
+        // Closed even after a failure (ErrorCheck has reset it), without
+        // losing its message
+        FString Message;
+        const ES_ResultCode Result = ResultCode ? *ResultCode : ES_ResultCode::Success;
+        if (ErrorMessage) Message = *ErrorMessage;
+        spkcls_c(_handle);
+        const bool bClosed = !ErrorCheck(ResultCode, ErrorMessage);
+
+        if (!bOk)
+        {
+            if (ResultCode) *ResultCode = Result;
+            if (ErrorMessage) *ErrorMessage = Message;
+            return false;
+        }
+        return bClosed;
+    }
+
+
+    int32 GenerateSystems(
+        TArrayView<const FProceduralSystem> Systems,
+        const FProceduralSystemSettings& Settings,
+        const FString& Directory,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const int32 Num = Systems.Num();
+        TArray<FProceduralSystemStates> States;
+        TArray<ES_ResultCode> Results;
+        TArray<FString> Messages;
+        States.SetNum(Num);
+        Results.Init(ES_ResultCode::Success, Num);
+        Messages.SetNum(Num);
+
+        ParallelFor(Num, [&](int32 i)
+        {
+            PropagateSystem(Systems[i], Settings, States[i], &Results[i], &Messages[i]);
+        });
+
+        int32 Written = 0;
+        bool bReported = false;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            ES_ResultCode Result = Results[i];
+            FString Message = Messages[i];
+            if (Result == ES_ResultCode::Success)
+            {
+                const FString Base = FPaths::Combine(Directory, Systems[i].Name);
+                if (WriteSystemKernels(Systems[i], Settings, States[i], Base + TEXT(".bsp"), Base + TEXT(".tpc"), Base + TEXT(".tf"), &Result, &Message))
+                {
+                    ++Written;
+                    continue;
+                }
+            }
+
+            if (!bReported)
+            {
+                if (ResultCode) *ResultCode = ES_ResultCode::Error;
+                if (ErrorMessage) *ErrorMessage = Message;
+                bReported = true;
+            }
+        }
+
+        if (!bReported && ResultCode) *ResultCode = ES_ResultCode::Success;
+        return Written;
+    }
+}
@@ -0,0 +1,509 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceProcessPool.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A pool of worker processes, each with its own CSPICE image.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceProcessPool.cpp is part of the "refined C++ API".
+//
+// Protocol (per worker):
+//   Parent writes a request to the mailbox, unlocks RequestReady.
+//   Worker locks RequestReady, runs the job, writes the response to the
+//   mailbox, unlocks ResponseReady.
+//   Parent locks ResponseReady & reads the response.
+// Only one request is ever outstanding per worker, so the mailbox needs no
+// other synchronization.  The parent waits on ResponseReady in slices, so
+// it notices a worker that has exited (or run past the job timeout).
+// The response payload is the error message, the response, and whether the
+// worker's kernel sync (if it was asked for one) succeeded.
+//------------------------------------------------------------------------------
+
+#include "SpiceProcessPool.h"
+#include "Async/Async.h"
+#include "HAL/Event.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+using namespace MaxQ::Private;
+
+std::atomic<FSpiceProcessPool*> FSpiceProcessPool::Instance { nullptr };
+
+namespace MaxQ::Private
+{
+    FString MailboxName(const FString& BaseName, const TCHAR* Suffix)
+    {
+#if PLATFORM_WINDOWS
+        return FString::Printf(TEXT("Local\\%s_%s"), *BaseName, Suffix);
+#else
+        // POSIX shm/sem names must begin with a slash
+        return FString::Printf(TEXT("/%s_%s"), *BaseName, Suffix);
+#endif
+    }
+}
+
+
+TMap<FName, FSpiceJobHandler>& FSpiceProcessPool::Jobs()
+{
+    // Function-local, so static FSpiceJobRegistrations in other TUs are safe.
+    static TMap<FName, FSpiceJobHandler> Registry;
+    return Registry;
+}
+
+
+void FSpiceProcessPool::RegisterJob(FName JobName, FSpiceJobHandler Handler)
+{
+    Jobs().Add(JobName, MoveTemp(Handler));
+}
+
+
+const FSpiceJobHandler* FSpiceProcessPool::FindJob(FName JobName)
+{
+    return Jobs().Find(JobName);
+}
+
+
+FSpiceProcessPool& FSpiceProcessPool::Get()
+{
+    FSpiceProcessPool* Pool = Instance.load(std::memory_order_acquire);
+    if (Pool == nullptr)
+    {
+        check(IsInGameThread());
+        Pool = new FSpiceProcessPool();
+        Instance.store(Pool, std::memory_order_release);
+    }
+    return *Pool;
+}
+
+
+FSpiceProcessPool* FSpiceProcessPool::GetStarted()
+{
+    FSpiceProcessPool* Pool = Instance.load(std::memory_order_acquire);
+    return Pool && Pool->bStarted.load(std::memory_order_acquire) ? Pool : nullptr;
+}
+
+
+void FSpiceProcessPool::Shutdown()
+{
+    if (FSpiceProcessPool* Pool = Instance.exchange(nullptr, std::memory_order_acq_rel))
+    {
+        delete Pool;
+    }
+}
+
+
+FSpiceProcessPool::~FSpiceProcessPool()
+{
+    Stop();
+}
+
+
+bool FSpiceProcessPool::Start(int32 NumWorkers, uint32 InMailboxSize)
+{
+    check(IsInGameThread());
+
+    if (IsStarted())
+    {
+        return true;
+    }
+
+    if (NumWorkers <= 0)
+    {
+        NumWorkers = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 1);
+    }
+
+    MailboxSize = InMailboxSize;
+    WorkerFreed = FPlatformProcess::GetSynchEventFromPool(false);
+
+    const uint32 ParentProcessId = FPlatformProcess::GetCurrentProcessId();
+
+    for (int32 i = 0; i < NumWorkers; ++i)
+    {
+        TUniquePtr<FWorker> Worker = MakeUnique<FWorker>();
+        Worker->BaseName = FString::Printf(TEXT("MaxQSpice_%u_%d"), ParentProcessId, i);
+
+        if (!LaunchWorker(*Worker))
+        {
+            DestroyWorker(*Worker);
+            continue;
+        }
+
+        FreeWorkers.Add(Workers.Num());
+        Workers.Add(MoveTemp(Worker));
+    }
+
+    NumLive.store(Workers.Num());
+
+    UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE Process Pool: started %d of %d worker processes"), Workers.Num(), NumWorkers);
+
+    if (!IsStarted())
+    {
+        FPlatformProcess::ReturnSynchEventToPool(WorkerFreed);
+        WorkerFreed = nullptr;
+    }
+
+    bStarted.store(IsStarted(), std::memory_order_release);
+    return IsStarted();
+}
+
+
+bool FSpiceProcessPool::LaunchWorker(FWorker& Worker)
+{
+    const FString& BaseName = Worker.BaseName;
+
+    Worker.Mailbox = FPlatformMemory::MapNamedSharedMemoryRegion(
+        MailboxName(BaseName, TEXT("mailbox")),
+        true,
+        FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write,
+        sizeof(FSpiceMailboxHeader) + MailboxSize
+    );
+
+    Worker.RequestReady = FPlatformProcess::NewInterprocessSynchObject(MailboxName(BaseName, TEXT("request")), true);
+    Worker.ResponseReady = FPlatformProcess::NewInterprocessSynchObject(MailboxName(BaseName, TEXT("response")), true);
+
+    if (!Worker.Mailbox || !Worker.RequestReady || !Worker.ResponseReady)
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Process Pool: could not create mailbox %s"), *BaseName);
+        return false;
+    }
+
+    // Semaphores are created signaled.  Take them, so the first Unlock is
+    // the first signal.
+    Worker.RequestReady->Lock();
+    Worker.ResponseReady->Lock();
+
+    const FString ExecutablePath = FPlatformProcess::ExecutablePath();
+
+    FString Params;
+    if (FPaths::IsProjectFilePathSet())
+    {
+        Params = FString::Printf(TEXT("\"%s\" "), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+    }
+    Params += FString::Printf(
+        TEXT("-run=SpiceWorker -MaxQMailbox=%s -MaxQMailboxSize=%u -ParentPID=%u -unattended -nullrhi -nosplash -nosound -nopause"),
+        *BaseName, MailboxSize, FPlatformProcess::GetCurrentProcessId()
+    );
+
+    Worker.Process = FPlatformProcess::CreateProc(*ExecutablePath, *Params, false, true, true, nullptr, -1, nullptr, nullptr);
+
+    if (!Worker.Process.IsValid())
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Process Pool: could not launch worker %s %s"), *ExecutablePath, *Params);
+        return false;
+    }
+
+    // A new process has no kernels
+    Worker.KernelSource = 0;
+    Worker.KernelGeneration = MAX_uint64;
+    return true;
+}
+
+
+void FSpiceProcessPool::RestartWorker(FWorker& Worker)
+{
+    if (Worker.Process.IsValid() && FPlatformProcess::IsProcRunning(Worker.Process))
+    {
+        FPlatformProcess::TerminateProc(Worker.Process, true);
+        FPlatformProcess::WaitForProc(Worker.Process);
+    }
+
+    // New semaphores and mailbox, so nothing the old process signalled (or
+    // didn't take) carries over
+    DestroyWorker(Worker);
+
+    if (!LaunchWorker(Worker))
+    {
+        DestroyWorker(Worker);
+        Worker.bRetired = true;
+        const int32 Live = --NumLive;
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Process Pool: retired worker %s (%d left)"), *Worker.BaseName, Live);
+    }
+    else
+    {
+        UE_LOG(LogSpice, Warning, TEXT("MaxQ SPICE Process Pool: relaunched worker %s"), *Worker.BaseName);
+    }
+}
+
+
+void FSpiceProcessPool::Stop()
+{
+    if (!IsStarted())
+    {
+        return;
+    }
+
+    // Dispatch counts a job before it checks bStarted, so once this is
+    // cleared every job is either counted below or turned away.  Jobs
+    // waiting for a worker see it and fail.
+    bStarted.store(false);
+
+    while (NumInFlight.load() > 0)
+    {
+        WorkerFreed->Wait(10);
+    }
+
+    for (TUniquePtr<FWorker>& Worker : Workers)
+    {
+        if (Worker->bRetired)
+        {
+            continue;
+        }
+
+        FSpiceMailboxHeader* Header = static_cast<FSpiceMailboxHeader*>(Worker->Mailbox->GetAddress());
+        Header->Magic = FSpiceMailboxHeader::MagicValue;
+        Header->Command = FSpiceMailboxHeader::Quit;
+        Header->PayloadSize = 0;
+        FPlatformMisc::MemoryBarrier();
+        Worker->RequestReady->Unlock();
+
+        FPlatformProcess::WaitForProc(Worker->Process);
+        DestroyWorker(*Worker);
+    }
+
+    Workers.Empty();
+    FreeWorkers.Empty();
+    NumLive.store(0);
+
+    FPlatformProcess::ReturnSynchEventToPool(WorkerFreed);
+    WorkerFreed = nullptr;
+}
+
+
+void FSpiceProcessPool::DestroyWorker(FWorker& Worker)
+{
+    if (Worker.Process.IsValid())
+    {
+        FPlatformProcess::CloseProc(Worker.Process);
+        Worker.Process = FProcHandle();
+    }
+    if (Worker.RequestReady)
+    {
+        FPlatformProcess::DeleteInterprocessSynchObject(Worker.RequestReady);
+        Worker.RequestReady = nullptr;
+    }
+    if (Worker.ResponseReady)
+    {
+        FPlatformProcess::DeleteInterprocessSynchObject(Worker.ResponseReady);
+        Worker.ResponseReady = nullptr;
+    }
+    if (Worker.Mailbox)
+    {
+        FPlatformMemory::UnmapNamedSharedMemoryRegion(Worker.Mailbox);
+        Worker.Mailbox = nullptr;
+    }
+}
+
+
+int32 FSpiceProcessPool::AcquireWorker()
+{
+    while (true)
+    {
+        if (!bStarted.load() || NumLive.load() == 0)
+        {
+            return INDEX_NONE;
+        }
+
+        {
+            FScopeLock Lock(&FreeWorkersLock);
+            if (FreeWorkers.Num() > 0)
+            {
+                return FreeWorkers.Pop(false);
+            }
+        }
+
+        // Timed, so a Stop (or the last worker retiring) is noticed
+        WorkerFreed->Wait(100);
+    }
+}
+
+
+void FSpiceProcessPool::ReleaseWorker(int32 WorkerIndex)
+{
+    if (!Workers[WorkerIndex]->bRetired)
+    {
+        FScopeLock Lock(&FreeWorkersLock);
+        FreeWorkers.Push(WorkerIndex);
+    }
+    WorkerFreed->Trigger();
+}
+
+
+namespace
+{
+    TFuture<FSpiceJobResult> FailedJob(const TCHAR* ErrorMessage)
+    {
+        TPromise<FSpiceJobResult> Failed;
+        Failed.SetValue(FSpiceJobResult{ false, ErrorMessage, {} });
+        return Failed.GetFuture();
+    }
+}
+
+
+TFuture<FSpiceJobResult> FSpiceProcessPool::Dispatch(FName JobName, TArray<uint8>&& Request)
+{
+    ++NumInFlight;
+    if (!bStarted.load())
+    {
+        --NumInFlight;
+        return FailedJob(TEXT("MaxQ SPICE Process Pool is not started"));
+    }
+
+    // Jobs run for seconds to minutes, and the dispatching thread just waits
+    // on the worker.  Give each dispatch its own thread rather than starving
+    // the task graph.
+    return Async(EAsyncExecution::Thread, [this, JobName, Request = MoveTemp(Request)]()
+    {
+        return RunDispatched(JobName, Request, nullptr);
+    });
+}
+
+
+TFuture<FSpiceJobResult> FSpiceProcessPool::Dispatch(FName JobName, TArray<uint8>&& Request, uint64 KernelSource, TArray<MaxQ::Data::FKernelHistoryEntry>&& KernelHistory, uint64 KernelGeneration)
+{
+    ++NumInFlight;
+    if (!bStarted.load())
+    {
+        --NumInFlight;
+        return FailedJob(TEXT("MaxQ SPICE Process Pool is not started"));
+    }
+
+    FKernelSet Kernels{ KernelSource, KernelGeneration, MoveTemp(KernelHistory) };
+    return Async(EAsyncExecution::Thread, [this, JobName, Request = MoveTemp(Request), Kernels = MoveTemp(Kernels)]()
+    {
+        return RunDispatched(JobName, Request, &Kernels);
+    });
+}
+
+
+FSpiceJobResult FSpiceProcessPool::RunDispatched(FName JobName, const TArray<uint8>& Request, const FKernelSet* Kernels)
+{
+    FSpiceJobResult Result;
+
+    const int32 WorkerIndex = AcquireWorker();
+    if (WorkerIndex == INDEX_NONE)
+    {
+        Result.ErrorMessage = NumLive.load() == 0 ? TEXT("MaxQ SPICE Process Pool has no live workers") : TEXT("MaxQ SPICE Process Pool is stopping");
+    }
+    else
+    {
+        Result = Run(*Workers[WorkerIndex], JobName, Request, Kernels);
+        ReleaseWorker(WorkerIndex);
+    }
+
+    // Last:  Stop may tear the pool down as soon as this reaches 0
+    --NumInFlight;
+    return Result;
+}
+
+
+FSpiceJobResult FSpiceProcessPool::Run(FWorker& Worker, FName JobName, const TArray<uint8>& Request, const FKernelSet* Kernels)
+{
+    FSpiceJobResult Result;
+
+    TArray<MaxQ::Data::FKernelHistoryEntry> KernelHistory;
+    const uint64 KernelSource = Kernels ? Kernels->Source : 0;
+    uint64 KernelGeneration = 0;
+    if (Kernels)
+    {
+        KernelHistory = Kernels->History;
+        KernelGeneration = Kernels->Generation;
+    }
+    else
+    {
+        KernelGeneration = MaxQ::Data::GetKernelHistory(KernelHistory);
+    }
+
+    // Only send the kernel history when the worker hasn't seen it yet
+    bool bSyncKernels = KernelSource != Worker.KernelSource || KernelGeneration != Worker.KernelGeneration;
+    if (!bSyncKernels)
+    {
+        KernelHistory.Empty();
+    }
+
+    TArray<uint8> Payload;
+    FMemoryWriter Writer(Payload);
+    FString JobNameString = JobName.ToString();
+    TArray<uint8>& RequestBytes = const_cast<TArray<uint8>&>(Request);
+    Writer << bSyncKernels;
+    Writer << KernelHistory;
+    Writer << JobNameString;
+    Writer << RequestBytes;
+
+    if ((uint32)Payload.Num() > MailboxSize)
+    {
+        Result.ErrorMessage = FString::Printf(TEXT("MaxQ SPICE Process Pool: request (%d bytes) exceeds mailbox size (%u bytes)"), Payload.Num(), MailboxSize);
+        return Result;
+    }
+
+    uint8* Mailbox = static_cast<uint8*>(Worker.Mailbox->GetAddress());
+    FSpiceMailboxHeader* Header = reinterpret_cast<FSpiceMailboxHeader*>(Mailbox);
+    Header->Magic = FSpiceMailboxHeader::MagicValue;
+    Header->Command = FSpiceMailboxHeader::RunJob;
+    Header->PayloadSize = Payload.Num();
+    Header->bSuccess = 0;
+    FMemory::Memcpy(Mailbox + sizeof(FSpiceMailboxHeader), Payload.GetData(), Payload.Num());
+    FPlatformMisc::MemoryBarrier();
+
+    Worker.RequestReady->Unlock();
+
+    // In slices, checking the worker is still there
+    constexpr uint64 SliceNanoseconds = 100ull * 1000 * 1000;
+    const double Started = FPlatformTime::Seconds();
+    while (!Worker.ResponseReady->TryLock(SliceNanoseconds))
+    {
+        const bool bExited = !FPlatformProcess::IsProcRunning(Worker.Process);
+        const bool bTimedOut = JobTimeout > 0. && FPlatformTime::Seconds() - Started > JobTimeout;
+        if (bExited || bTimedOut)
+        {
+            Result.ErrorMessage = FString::Printf(TEXT("MaxQ SPICE Process Pool: worker %s %s running %s"),
+                *Worker.BaseName, bExited ? TEXT("exited while") : TEXT("timed out"), *JobName.ToString());
+            UE_LOG(LogSpice, Error, TEXT("%s"), *Result.ErrorMessage);
+
+            RestartWorker(Worker);
+            return Result;
+        }
+    }
+    FPlatformMisc::MemoryBarrier();
+
+    if (Header->Magic != FSpiceMailboxHeader::MagicValue || Header->PayloadSize > MailboxSize)
+    {
+        Result.ErrorMessage = TEXT("MaxQ SPICE Process Pool: corrupt response from worker");
+        return Result;
+    }
+
+    TArray<uint8> ResponsePayload(Mailbox + sizeof(FSpiceMailboxHeader), Header->PayloadSize);
+    FMemoryReader Reader(ResponsePayload);
+    bool bKernelsSynced = false;
+    Reader << Result.ErrorMessage;
+    Reader << Result.Response;
+    Reader << bKernelsSynced;
+    Result.bSuccess = Header->bSuccess != 0;
+
+    if (bSyncKernels)
+    {
+        // A failed sync left the worker with some unknown part of the set:
+        // sync it again next time, whatever's asked for
+        Worker.KernelSource = bKernelsSynced ? KernelSource : 0;
+        Worker.KernelGeneration = bKernelsSynced ? KernelGeneration : MAX_uint64;
+    }
+
+    return Result;
+}
@@ -0,0 +1,460 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceProfiling.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Live counters for SPICE work, and the console commands that
+// show them.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceProfiling.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceProfiling.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "SpiceLock.h"
+#include "SpiceQueryMemo.h"
+#include "SpiceUtilities.h"
+#include <atomic>
+
+using namespace MaxQ::Data;
+using namespace MaxQ::Private;
+
+namespace
+{
+#if MAXQ_COUNTERS_ENABLED
+    std::atomic<uint64> Counts[(int32)ESpiceCounter::Count];
+    std::atomic<uint64> Cycles[(int32)ESpiceTimer::Count];
+#endif
+    std::atomic<uint64> ResetFrame { 0 };
+
+#if MAXQ_COUNTERS_ENABLED
+    // Startup loads a few dozen kernels;  anything past this is dropped
+    constexpr int32 MaxKernelLoadRecords = 4096;
+
+    FCriticalSection KernelLoadLock;
+    TArray<FKernelLoadRecord> KernelLoads;
+    int32 DroppedKernelLoads = 0;
+#endif
+
+    // Not MaxQ::Core::ToString, which isn't thread safe
+    const TCHAR* KernelTypeName(ES_KernelType Type)
+    {
+        switch (Type)
+        {
+        case ES_KernelType::SPK: return TEXT("SPK");
+        case ES_KernelType::CK: return TEXT("CK");
+        case ES_KernelType::PCK: return TEXT("PCK");
+        case ES_KernelType::DSK: return TEXT("DSK");
+        case ES_KernelType::EK: return TEXT("EK");
+        case ES_KernelType::TEXT: return TEXT("TEXT");
+        case ES_KernelType::META: return TEXT("META");
+        default: return TEXT("?");
+        }
+    }
+
+    constexpr double BytesPerMB = 1024. * 1024.;
+
+    const TCHAR* TimerNames[] = { TEXT("SPK lookups"), TEXT("Frame/CK lookups"), TEXT("GF searches"), TEXT("Kernel loads"), TEXT("SGP4") };
+    const ESpiceCounter TimerCounters[] = { ESpiceCounter::SpkLookups, ESpiceCounter::FrameLookups, ESpiceCounter::GfSearches, ESpiceCounter::KernelLoads, ESpiceCounter::Sgp4Evaluations };
+    static_assert(UE_ARRAY_COUNT(TimerNames) == (int32)ESpiceTimer::Count, "one name per timer");
+
+    void LogStats(const TArray<FString>& Args)
+    {
+        if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+        {
+            ResetSpiceCounters();
+            {
+                MaxQ::Core::FSpiceScope Scope;
+                ResetFileUnitUsage();
+            }
+            UE_LOG(LogSpice, Log, TEXT("MaxQ counters reset"));
+            return;
+        }
+
+        const FSpiceCounters Counters = GetSpiceCounters();
+        const double Frames = (double)FMath::Max<uint64>(Counters.Frames, 1);
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE work over %llu frames (per frame: calls, ms)"), Counters.Frames);
+        for (int32 i = 0; i < (int32)ESpiceTimer::Count; ++i)
+        {
+            const uint64 Calls = Counters[TimerCounters[i]];
+            const double Seconds = Counters[(ESpiceTimer)i];
+            UE_LOG(LogSpice, Log, TEXT("  %-18s %10llu total %10.1f %8.3f ms"), TimerNames[i], Calls, Calls / Frames, 1000. * Seconds / Frames);
+        }
+        UE_LOG(LogSpice, Log, TEXT("  %-18s %10llu total %10.1f"), TEXT("Failed calls"), Counters[ESpiceCounter::Failures], Counters[ESpiceCounter::Failures] / Frames);
+#if !MAXQ_COUNTERS_ENABLED
+        UE_LOG(LogSpice, Log, TEXT("  (counters are compiled out of this build)"));
+#endif
+    }
+
+    void LogCache()
+    {
+        const FSpiceCounters Counters = GetSpiceCounters();
+
+        auto LogRate = [](const TCHAR* Name, uint64 Hits, uint64 Misses, const TCHAR* MissName)
+        {
+            UE_LOG(LogSpice, Log, TEXT("  %-24s %5.1f%%  (%llu hits, %llu %s)"), Name, 100. * FSpiceCounters::Rate(Hits, Misses), Hits, Misses, MissName);
+        };
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ cache hit rates over %llu frames"), Counters.Frames);
+        LogRate(TEXT("Query memo"), Counters[ESpiceCounter::MemoHits], Counters[ESpiceCounter::MemoMisses], TEXT("misses"));
+        LogRate(TEXT("Chebyshev caches"), Counters[ESpiceCounter::ChebyshevHits], Counters[ESpiceCounter::ChebyshevMisses], TEXT("misses"));
+        LogRate(TEXT("Frame chains"), Counters[ESpiceCounter::FrameChainHits], Counters[ESpiceCounter::FrameChainRecompiles], TEXT("recompiles"));
+        LogRate(TEXT("Dynamic frames"), Counters[ESpiceCounter::DynamicFrameHits], Counters[ESpiceCounter::DynamicFrameMisses], TEXT("misses"));
+        LogRate(TEXT("Pool snapshots"), Counters[ESpiceCounter::PoolCacheHits], Counters[ESpiceCounter::PoolCacheRebuilds], TEXT("rebuilds"));
+
+        const FQueryMemoStats Memo = GetQueryMemoStats();
+        UE_LOG(LogSpice, Log, TEXT("  Query memo is %s, %d entries"), IsQueryMemoEnabled() ? TEXT("on") : TEXT("off"), Memo.Entries);
+    }
+
+    void LogKernels()
+    {
+        TMap<FString, TArray<FString>> ByType;
+        FSegmentBufferReport Report;
+        FString ErrorMessage;
+        bool bReport = false;
+        FFileUnitUsage Units;
+        bool bUnits = false;
+        {
+            MaxQ::Core::FSpiceScope Scope;
+
+            SpiceInt _count = 0;
+            ktotal_c("ALL", &_count);
+            for (SpiceInt i = 0; i < _count && !failed_c(); ++i)
+            {
+                SpiceChar _file[SPICE_MAX_PATH];
+                SpiceChar _filtyp[32];
+                SpiceChar _source[SPICE_MAX_PATH];
+                SpiceInt _handle = 0;
+                SpiceBoolean _found = SPICEFALSE;
+                kdata_c(i, "ALL", sizeof(_file), sizeof(_filtyp), sizeof(_source), _file, _filtyp, _source, &_handle, &_found);
+                if (_found)
+                {
+                    ByType.FindOrAdd(FString(_filtyp)).Add(FString(_file));
+                }
+            }
+            UnexpectedErrorCheck(true);
+
+            bReport = GetSegmentBufferReport(Report, nullptr, &ErrorMessage);
+            bUnits = GetFileUnitUsage(Units);
+        }
+
+        int32 Total = 0;
+        for (const auto& Type : ByType)
+        {
+            Total += Type.Value.Num();
+        }
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ loaded kernels: %d (%d mapped)"), Total, NumMappedKernels());
+        ByType.KeySort(TLess<FString>());
+        for (const auto& Type : ByType)
+        {
+            UE_LOG(LogSpice, Log, TEXT("  %s: %d"), *Type.Key, Type.Value.Num());
+            for (const FString& File : Type.Value)
+            {
+                UE_LOG(LogSpice, Log, TEXT("    %s"), *File);
+            }
+        }
+
+        if (bUnits && !Units.bCounted)
+        {
+            UE_LOG(LogSpice, Log, TEXT("  File units: %d for %d binary kernels (not counted by this CSPICE build)%s"),
+                Units.Capacity, Units.BinaryKernels, Units.MayThrash() ? TEXT(":  may thrash") : TEXT(""));
+        }
+        else if (bUnits)
+        {
+            UE_LOG(LogSpice, Log, TEXT("  File units: %d/%d in use (peak %d) for %d binary kernels, %lld requests, %lld reopened a file (%.1f%%)%s"),
+                Units.Units, Units.Capacity, Units.PeakUnits, Units.BinaryKernels, Units.Requests, Units.Reopens, 100. * Units.ReopenRate(),
+                Units.MayThrash() ? TEXT(":  may thrash") : TEXT(""));
+        }
+
+        if (!bReport)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("  No segment table report: %s"), *ErrorMessage);
+            return;
+        }
+
+        auto LogTable = [](const TCHAR* Kind, const FSegmentTableUsage& Usage)
+        {
+            UE_LOG(LogSpice, Log, TEXT("  %s segment table: %d/%d files, %d/%d segments, %d/%d ids, busiest %d (%d segments)%s"),
+                Kind, Usage.Files, Usage.FileCapacity, Usage.Segments, Usage.SegmentCapacity, Usage.Ids, Usage.IdCapacity,
+                Usage.BusiestId, Usage.BusiestIdSegments,
+                Usage.IsUnbuffered() ? TEXT(":  UNBUFFERED") : Usage.MayThrash() ? TEXT(":  may thrash") : TEXT(""));
+        };
+        LogTable(TEXT("SPK"), Report.Spk);
+        LogTable(TEXT("CK"), Report.Ck);
+    }
+
+    void LogKernelLoads(const TArray<FString>& Args)
+    {
+        if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+        {
+            ResetKernelLoadTimeline();
+            UE_LOG(LogSpice, Log, TEXT("MaxQ kernel load timeline reset"));
+            return;
+        }
+
+        TArray<FString> Lines;
+        GetKernelLoadReport().ParseIntoArrayLines(Lines, false);
+        for (const FString& Line : Lines)
+        {
+            UE_LOG(LogSpice, Log, TEXT("%s"), *Line);
+        }
+    }
+
+    FAutoConsoleCommand StatsCommand(
+        TEXT("MaxQ.Stats"),
+        TEXT("Logs SPICE calls and time per family, per frame since the last reset.  \"MaxQ.Stats reset\" starts over."),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&LogStats)
+    );
+
+    FAutoConsoleCommand CacheCommand(
+        TEXT("MaxQ.Cache"),
+        TEXT("Logs hit rates of MaxQ's caches (query memo, Chebyshev, frame chains, kernel pool snapshots)."),
+        FConsoleCommandDelegate::CreateStatic(&LogCache)
+    );
+
+    FAutoConsoleCommand KernelsCommand(
+        TEXT("MaxQ.Kernels"),
+        TEXT("Logs the loaded kernels by type, the load on CSPICE's SPK/CK segment tables, and its file unit pool."),
+        FConsoleCommandDelegate::CreateStatic(&LogKernels)
+    );
+
+    FAutoConsoleCommand KernelLoadsCommand(
+        TEXT("MaxQ.KernelLoads"),
+        TEXT("Logs furnsh/unload time by phase and kernel type, and the slowest kernels.  \"MaxQ.KernelLoads reset\" starts over."),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&LogKernelLoads)
+    );
+}
+
+namespace MaxQ::Private
+{
+#if MAXQ_COUNTERS_ENABLED
+    void Count(ESpiceCounter Counter, uint64 N)
+    {
+        Counts[(int32)Counter].fetch_add(N, std::memory_order_relaxed);
+    }
+
+
+    FTimedScope::~FTimedScope()
+    {
+        Cycles[(int32)Timer].fetch_add(FPlatformTime::Cycles64() - StartCycles, std::memory_order_relaxed);
+    }
+#endif
+
+
+    ES_KernelType KernelTypeOf(const uint8* Head, int64 Num)
+    {
+        auto IdWord = [Head, Num](const ANSICHAR* Id)
+        {
+            const int32 Length = FCStringAnsi::Strlen(Id);
+            return Num >= Length && !FMemory::Memcmp(Head, Id, Length);
+        };
+
+        if (IdWord("DAF/SPK")) return ES_KernelType::SPK;
+        if (IdWord("DAF/CK")) return ES_KernelType::CK;
+        if (IdWord("DAF/PCK")) return ES_KernelType::PCK;
+        if (IdWord("DAS/DSK")) return ES_KernelType::DSK;
+        if (IdWord("DAS/EK")) return ES_KernelType::EK;
+        if (IdWord("KPL/MK")) return ES_KernelType::META;
+        if (IdWord("DAF/") || IdWord("DAS/") || IdWord("NAIF/")) return ES_KernelType::NONE;
+        return ES_KernelType::TEXT;
+    }
+
+
+    FKernelLoadTiming::FKernelLoadTiming(const FString& AbsolutePath, bool bUnload, const FKernelLoadRecord* Prepared)
+    {
+        if (Prepared)
+        {
+            Record = *Prepared;
+        }
+#if MAXQ_COUNTERS_ENABLED
+        else
+        {
+            // Just the ID word:  the type and size are worth an open, not a read
+            TUniquePtr<IFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*AbsolutePath));
+            uint8 Head[8] {};
+            if (Handle.IsValid())
+            {
+                Record.Size = Handle->Size();
+                if (Handle->Read(Head, FMath::Min<int64>(Record.Size, sizeof(Head))))
+                {
+                    Record.Type = KernelTypeOf(Head, FMath::Min<int64>(Record.Size, sizeof(Head)));
+                }
+            }
+        }
+#endif
+        Record.Path = AbsolutePath;
+        Record.bUnload = bUnload;
+        Record.Start = FPlatformTime::Seconds();
+    }
+
+
+    FString FKernelLoadTiming::Describe() const
+    {
+        return FString::Printf(TEXT("%s (%s, %.1f MB)"), *FPaths::GetCleanFilename(Record.Path), KernelTypeName(Record.Type), Record.Size / BytesPerMB);
+    }
+
+
+    void FKernelLoadTiming::Finish(bool bSuccess)
+    {
+#if MAXQ_COUNTERS_ENABLED
+        Record.Load = FPlatformTime::Seconds() - Record.Start;
+        Record.bSuccess = bSuccess;
+
+        FScopeLock Lock(&KernelLoadLock);
+        if (KernelLoads.Num() < MaxKernelLoadRecords)
+        {
+            KernelLoads.Add(MoveTemp(Record));
+        }
+        else
+        {
+            ++DroppedKernelLoads;
+        }
+#endif
+    }
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API FSpiceCounters GetSpiceCounters()
+    {
+        FSpiceCounters Counters;
+#if MAXQ_COUNTERS_ENABLED
+        for (int32 i = 0; i < (int32)ESpiceCounter::Count; ++i)
+        {
+            Counters.Counts[i] = Counts[i].load(std::memory_order_relaxed);
+        }
+        for (int32 i = 0; i < (int32)ESpiceTimer::Count; ++i)
+        {
+            Counters.Seconds[i] = FPlatformTime::ToSeconds64(Cycles[i].load(std::memory_order_relaxed));
+        }
+#endif
+        Counters.Frames = GFrameCounter - ResetFrame.load(std::memory_order_relaxed);
+        return Counters;
+    }
+
+
+    SPICE_API void ResetSpiceCounters()
+    {
+#if MAXQ_COUNTERS_ENABLED
+        for (std::atomic<uint64>& Count : Counts)
+        {
+            Count.store(0, std::memory_order_relaxed);
+        }
+        for (std::atomic<uint64>& Count : Cycles)
+        {
+            Count.store(0, std::memory_order_relaxed);
+        }
+#endif
+        ResetFrame.store(GFrameCounter, std::memory_order_relaxed);
+    }
+
+
+    SPICE_API TArray<FKernelLoadRecord> GetKernelLoadTimeline()
+    {
+#if MAXQ_COUNTERS_ENABLED
+        FScopeLock Lock(&KernelLoadLock);
+        return KernelLoads;
+#else
+        return {};
+#endif
+    }
+
+
+    SPICE_API void ResetKernelLoadTimeline()
+    {
+#if MAXQ_COUNTERS_ENABLED
+        FScopeLock Lock(&KernelLoadLock);
+        KernelLoads.Reset();
+        DroppedKernelLoads = 0;
+#endif
+    }
+
+
+    SPICE_API FString GetKernelLoadReport(int32 Slowest)
+    {
+        TArray<FKernelLoadRecord> Timeline = GetKernelLoadTimeline();
+
+        struct FTotals
+        {
+            int32 Count = 0;
+            int64 Bytes = 0;
+            double Open = 0., Validate = 0., Load = 0.;
+
+            void Add(const FKernelLoadRecord& Record)
+            {
+                ++Count;
+                Bytes += Record.Size;
+                Open += Record.Open;
+                Validate += Record.Validate;
+                Load += Record.Load;
+            }
+        };
+
+        FTotals Loads, Unloads;
+        TSortedMap<ES_KernelType, FTotals> ByType;
+        for (const FKernelLoadRecord& Record : Timeline)
+        {
+            (Record.bUnload ? Unloads : Loads).Add(Record);
+            if (!Record.bUnload)
+            {
+                ByType.FindOrAdd(Record.Type).Add(Record);
+            }
+        }
+
+        TStringBuilder<4096> Report;
+        Report.Appendf(TEXT("MaxQ kernel loads: %d furnsh (%.1f MB) in %.1f ms:  open %.1f ms, validate %.1f ms, load %.1f ms;  %d unloads in %.1f ms\n"),
+            Loads.Count, Loads.Bytes / BytesPerMB, 1000. * (Loads.Open + Loads.Validate + Loads.Load), 1000. * Loads.Open, 1000. * Loads.Validate, 1000. * Loads.Load,
+            Unloads.Count, 1000. * Unloads.Load);
+#if MAXQ_COUNTERS_ENABLED
+        {
+            FScopeLock Lock(&KernelLoadLock);
+            if (DroppedKernelLoads > 0)
+            {
+                Report.Appendf(TEXT("  (%d more weren't recorded)\n"), DroppedKernelLoads);
+            }
+        }
+#else
+        Report.Append(TEXT("  (the timeline is compiled out of this build)\n"));
+#endif
+
+        for (const auto& Type : ByType)
+        {
+            Report.Appendf(TEXT("  %-5s %4d files %9.1f MB %9.1f ms  (open %.1f, validate %.1f, load %.1f)\n"),
+                KernelTypeName(Type.Key), Type.Value.Count, Type.Value.Bytes / BytesPerMB, 1000. * (Type.Value.Open + Type.Value.Validate + Type.Value.Load),
+                1000. * Type.Value.Open, 1000. * Type.Value.Validate, 1000. * Type.Value.Load);
+        }
+
+        Timeline.Sort([](const FKernelLoadRecord& a, const FKernelLoadRecord& b) { return a.Total() > b.Total(); });
+        const int32 Num = FMath::Min(Slowest, Timeline.Num());
+        if (Num > 0)
+        {
+            Report.Appendf(TEXT("  Slowest %d:\n"), Num);
+        }
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const FKernelLoadRecord& Record = Timeline[i];
+            Report.Appendf(TEXT("    %9.2f ms  %-6s %-5s %9.1f MB  (open %.2f, validate %.2f, load %.2f)%s  %s\n"),
+                1000. * Record.Total(), Record.bUnload ? TEXT("unload") : TEXT("furnsh"), KernelTypeName(Record.Type), Record.Size / BytesPerMB,
+                1000. * Record.Open, 1000. * Record.Validate, 1000. * Record.Load, Record.bSuccess ? TEXT("") : TEXT(" FAILED"), *Record.Path);
+        }
+
+        return Report.ToString();
+    }
+}
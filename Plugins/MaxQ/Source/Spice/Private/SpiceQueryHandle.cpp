@@ -0,0 +1,356 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceQueryHandle.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Precompiled (targ, obs, ref, abcorr) ephemeris queries.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceQueryHandle.cpp is part of the "refined C++ API".
+//
+// ConvergedLightTime is spkltc's reception case, with the first guess
+// replaced:  the same iteration limit and convergence test, and the same
+// light time derivative for the velocity.  It works in the handle's frame
+// rather than J2000 (spkez's frame, rotated afterwards), which is the same
+// to rounding since both are inertial.
+//------------------------------------------------------------------------------
+
+#include "SpiceQueryHandle.h"
+#include "SpiceData.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // spkltc's:  at most 5 iterations for CN, converged when the light time
+    // changes by less than 1e-17 of the epoch
+    constexpr int32 MaxLightTimeIterations = 5;
+    constexpr double LightTimeTolerance = 1e-17;
+
+    // km/s, clight_c
+    constexpr double SpeedOfLight = 299792.458;
+
+    bool IsConvergedNewtonian(ES_AberrationCorrectionWithNewtonians abcorr)
+    {
+        return abcorr == ES_AberrationCorrectionWithNewtonians::CN || abcorr == ES_AberrationCorrectionWithNewtonians::CN_S;
+    }
+}
+
+
+FSpiceQueryHandle FSpiceQueryHandle::Compile(
+    const FString& targ,
+    const FString& obs,
+    const FString& ref,
+    ES_AberrationCorrectionWithNewtonians abcorr,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+)
+{
+    FSpiceQueryHandle Handle;
+    Handle.Target = targ;
+    Handle.Observer = obs;
+    Handle.Frame = ref;
+    Handle.AberrationCorrection = abcorr;
+
+    auto _ref = StringCast<ANSICHAR>(*ref);
+    Handle.FrameANSI.Append(_ref.Get(), _ref.Length() + 1);
+
+    Handle.Resolve();
+
+    ErrorCheck(ResultCode, ErrorMessage);
+    return Handle;
+}
+
+
+bool FSpiceQueryHandle::Resolve() const
+{
+    bValid = false;
+    bInertialFrame = false;
+    LastLightTime = FLightTimeGuess();
+    KernelGeneration = MaxQ::Data::GetKernelHistoryGeneration();
+
+    auto _targ = StringCast<ANSICHAR>(*Target);
+    auto _obs = StringCast<ANSICHAR>(*Observer);
+
+    SpiceInt _targid = 0, _obsid = 0, _frcode = 0;
+    if (!ResolveBody(_targ.Get(), _targid) || !ResolveBody(_obs.Get(), _obsid))
+    {
+        return false;
+    }
+
+    namfrm_c(FrameANSI.GetData(), &_frcode);
+    if (_frcode == 0)
+    {
+        setmsg_c("The reference frame # is not recognized.");
+        errch_c("#", FrameANSI.GetData());
+        sigerr_c("SPICE(UNKNOWNFRAME)");
+        return false;
+    }
+
+    TargetId = _targid;
+    ObserverId = _obsid;
+    FrameId = _frcode;
+    bInertialFrame = IsInertialFrame(FrameANSI.GetData());
+    bValid = !failed_c();
+
+    return bValid;
+}
+
+
+bool FSpiceQueryHandle::RefreshIfStale() const
+{
+    if (failed_c())
+    {
+        return false;
+    }
+
+    // Kernels changed, the names may map to different IDs now
+    if (KernelGeneration != MaxQ::Data::GetKernelHistoryGeneration())
+    {
+        return Resolve();
+    }
+
+    if (!bValid)
+    {
+        setmsg_c("Ephemeris query for target # was not successfully compiled.");
+        errch_c("#", StringCast<ANSICHAR>(*Target).Get());
+        sigerr_c("SPICE(INVALIDQUERY)");
+    }
+
+    return bValid;
+}
+
+
+bool FSpiceQueryHandle::ConvergedLightTime(double et, double(&state)[6], double& lt, double(&vobs)[3]) const
+{
+    ConstSpiceChar* _ref = FrameANSI.GetData();
+
+    SpiceDouble _sobs[6];
+    {
+        MAXQ_SPK_LOOKUP_SCOPE();
+        spkssb_c(ObserverId, et, _ref, _sobs);
+    }
+
+    SpiceDouble _ssbtrg[6];
+    SpiceDouble _starg[6];
+    SpiceDouble _lt;
+    const bool bWarm = LastLightTime.bValid;
+
+    if (bWarm)
+    {
+        _lt = FMath::Max(0., LastLightTime.Lt + LastLightTime.Dlt * (et - LastLightTime.Et));
+    }
+    else
+    {
+        // Cold, as spkltc:  the geometric light time
+        MAXQ_SPK_LOOKUP_SCOPE();
+        spkssb_c(TargetId, et, _ref, _ssbtrg);
+        vsubg_c(_ssbtrg, _sobs, 6, _starg);
+        _lt = vnorm_c(_starg) / SpeedOfLight;
+    }
+
+    if (failed_c())
+    {
+        return false;
+    }
+
+    if (!bWarm && _lt == 0.)
+    {
+        // The observer is the target:  nothing to iterate
+        return false;
+    }
+
+    bool bConverged = false;
+    for (int32 i = 0; i < MaxLightTimeIterations && !bConverged; ++i)
+    {
+        const SpiceDouble _epoch = et - _lt;
+        {
+            MAXQ_SPK_LOOKUP_SCOPE();
+            spkssb_c(TargetId, _epoch, _ref, _ssbtrg);
+        }
+        if (failed_c())
+        {
+            return false;
+        }
+
+        vsubg_c(_ssbtrg, _sobs, 6, _starg);
+        const SpiceDouble _prvlt = _lt;
+        _lt = vnorm_c(_starg) / SpeedOfLight;
+        bConverged = FMath::Abs(_lt - _prvlt) / FMath::Max(1., FMath::Abs(_epoch)) <= LightTimeTolerance;
+    }
+
+    if (!bConverged && bWarm)
+    {
+        // A bad guess.  spkltc accepts its fifth iterate from a cold start,
+        // so that's the reference to match.
+        LastLightTime.bValid = false;
+        return ConvergedLightTime(et, state, lt, vobs);
+    }
+
+    // dlt/dt, and the velocity, as spkltc:
+    //   dlt = A*B / (1 + A*C),  A = 1/(c*|r|), B = <r, v>, C = <r, vtarg>
+    //   v' = vtarg * (1 - dlt) - vobs
+    const SpiceDouble _dist = vnorm_c(_starg);
+    SpiceDouble _dlt = 0.;
+    if (_dist > 0.)
+    {
+        const SpiceDouble A = 1. / (SpeedOfLight * _dist);
+        const SpiceDouble B = vdot_c(_starg, &_starg[3]);
+        const SpiceDouble C = vdot_c(_starg, &_ssbtrg[3]);
+        if (-A * C >= 1.)
+        {
+            // The target approaches at c or faster:  leave the error to spkez
+            return false;
+        }
+        _dlt = A * B / (1. + A * C);
+    }
+
+    state[0] = _starg[0];
+    state[1] = _starg[1];
+    state[2] = _starg[2];
+    state[3] = _ssbtrg[3] * (1. - _dlt) - _sobs[3];
+    state[4] = _ssbtrg[4] * (1. - _dlt) - _sobs[4];
+    state[5] = _ssbtrg[5] * (1. - _dlt) - _sobs[5];
+    lt = _lt;
+    vobs[0] = _sobs[3];
+    vobs[1] = _sobs[4];
+    vobs[2] = _sobs[5];
+
+    LastLightTime.Et = et;
+    LastLightTime.Lt = _lt;
+    LastLightTime.Dlt = _dlt;
+    LastLightTime.bValid = true;
+
+    return true;
+}
+
+
+void FSpiceQueryHandle::Spkezr(double et, double(&state)[6], double& lt) const
+{
+    if (!RefreshIfStale())
+    {
+        return;
+    }
+
+    if (AberrationCorrection == ES_AberrationCorrectionWithNewtonians::None)
+    {
+        // Geometric states don't need abcorr parsing at all
+        MAXQ_SPK_LOOKUP_SCOPE();
+        spkgeo_c(TargetId, et, FrameANSI.GetData(), ObserverId, state, &lt);
+    }
+    else
+    {
+        SpiceDouble _vobs[3];
+        if (AberrationCorrection == ES_AberrationCorrectionWithNewtonians::CN && bInertialFrame && ConvergedLightTime(et, state, lt, _vobs))
+        {
+            return;
+        }
+
+        if (!failed_c())
+        {
+            ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(AberrationCorrection);
+            MAXQ_SPK_LOOKUP_SCOPE();
+            spkez_c(TargetId, et, FrameANSI.GetData(), _abcorr, ObserverId, state, &lt);
+        }
+    }
+}
+
+
+void FSpiceQueryHandle::Spkpos(double et, double(&ptarg)[3], double& lt) const
+{
+    if (!RefreshIfStale())
+    {
+        return;
+    }
+
+    if (AberrationCorrection == ES_AberrationCorrectionWithNewtonians::None)
+    {
+        MAXQ_SPK_LOOKUP_SCOPE();
+        spkgps_c(TargetId, et, FrameANSI.GetData(), ObserverId, ptarg, &lt);
+    }
+    else
+    {
+        SpiceDouble _state[6], _vobs[3];
+        if (IsConvergedNewtonian(AberrationCorrection) && bInertialFrame && ConvergedLightTime(et, _state, lt, _vobs))
+        {
+            if (AberrationCorrection == ES_AberrationCorrectionWithNewtonians::CN_S)
+            {
+                // Positions only need the observer's velocity
+                stelab_c(_state, _vobs, ptarg);
+            }
+            else
+            {
+                vequ_c(_state, ptarg);
+            }
+            return;
+        }
+
+        if (!failed_c())
+        {
+            ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(AberrationCorrection);
+            spkezp_c(TargetId, et, FrameANSI.GetData(), _abcorr, ObserverId, ptarg, &lt);
+        }
+    }
+}
+
+
+void FSpiceQueryHandle::Spkezr(
+    const FSEphemerisTime& et,
+    FSStateVector& state,
+    FSEphemerisPeriod& lt,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+) const
+{
+    SpiceDouble _state[6];
+    SpiceDouble _lt = 0.;
+    ZeroOut(_state);
+
+    Spkezr(et.seconds, _state, _lt);
+
+    state = FSStateVector(_state);
+    lt = FSEphemerisPeriod(_lt);
+
+    ErrorCheck(ResultCode, ErrorMessage);
+}
+
+
+void FSpiceQueryHandle::Spkpos(
+    const FSEphemerisTime& et,
+    FSDistanceVector& ptarg,
+    FSEphemerisPeriod& lt,
+    ES_ResultCode* ResultCode,
+    FString* ErrorMessage
+) const
+{
+    SpiceDouble _ptarg[3];
+    SpiceDouble _lt = 0.;
+    ZeroOut(_ptarg);
+
+    Spkpos(et.seconds, _ptarg, _lt);
+
+    ptarg = FSDistanceVector(_ptarg);
+    lt = FSEphemerisPeriod(_lt);
+
+    ErrorCheck(ResultCode, ErrorMessage);
+}
@@ -0,0 +1,166 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceQueryMemo.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Per-frame memoization of frame transforms and body states.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceQueryMemo.cpp is part of the "refined C++ API".
+//
+// The memo is checked for staleness (frame number, pool generation) as keys
+// are made, so a stale entry is never found.  Entries hold up to a 6x6
+// matrix;  pxform uses 9 values, spkezr 6 plus the light time.
+//------------------------------------------------------------------------------
+
+#include "SpiceQueryMemo.h"
+#include "SpiceUtilities.h"
+#include "SpiceTime.h"
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // About 1.3MB of entries.  An orbit line sampling every frame at new ETs
+    // shouldn't grow the memo without bound.
+    constexpr int32 MaxEntries = 4096;
+
+    struct FMemoValue
+    {
+        double Values[36];
+        double Lt = 0.;
+    };
+
+    struct FMemo
+    {
+        bool bEnabled = false;
+        uint64 PoolGeneration = 0;
+        uint64 FrameNumber = 0;
+        TMap<FQueryMemoKey, FMemoValue> Entries;
+        MaxQ::Data::FQueryMemoStats Stats;
+    };
+
+    FMemo& Memo()
+    {
+        static FMemo Instance;
+        return Instance;
+    }
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API void SetQueryMemoEnabled(bool bEnable)
+    {
+        FMemo& State = Memo();
+        if (bEnable != State.bEnabled)
+        {
+            State.bEnabled = bEnable;
+            State.Entries.Empty();
+            State.Stats = FQueryMemoStats();
+        }
+    }
+
+
+    SPICE_API bool IsQueryMemoEnabled()
+    {
+        return Memo().bEnabled;
+    }
+
+
+    SPICE_API void ClearQueryMemo()
+    {
+        Memo().Entries.Reset();
+    }
+
+
+    SPICE_API FQueryMemoStats GetQueryMemoStats()
+    {
+        FMemo& State = Memo();
+        State.Stats.Entries = State.Entries.Num();
+        return State.Stats;
+    }
+}
+
+namespace MaxQ::Private
+{
+    bool MakeQueryMemoKey(EQueryMemo Query, const FString& A, const FString& B, const FString& C, uint8 Abcorr, double et, FQueryMemoKey& Key)
+    {
+        FMemo& State = Memo();
+        if (!State.bEnabled)
+        {
+            return false;
+        }
+
+        const uint64 PoolGeneration = MaxQ::Private::PoolGeneration();
+        const uint64 FrameNumber = MaxQ::Time::GetEtClock().GetFrameNumber();
+        if (PoolGeneration != State.PoolGeneration || FrameNumber != State.FrameNumber)
+        {
+            State.Entries.Reset();
+            State.PoolGeneration = PoolGeneration;
+            State.FrameNumber = FrameNumber;
+        }
+
+        Key.Query = Query;
+        Key.Abcorr = Abcorr;
+        Key.A = FSpiceName(A);
+        Key.B = FSpiceName(B);
+        Key.C = C.IsEmpty() ? FSpiceName() : FSpiceName(C);
+        // -0. and 0. are the same ET, but don't hash the same
+        Key.Et = et + 0.;
+        return true;
+    }
+
+
+    bool FindMemoizedQuery(const FQueryMemoKey& Key, double* Values, int32 Num, double* Lt)
+    {
+        check(Num <= 36);
+
+        // A pending error has to come out of the real call
+        FMemo& State = Memo();
+        const FMemoValue* Found = failed_c() ? nullptr : State.Entries.Find(Key);
+        if (!Found)
+        {
+            ++State.Stats.Misses;
+            MAXQ_CACHE_EVENT(MemoMisses);
+            return false;
+        }
+
+        ++State.Stats.Hits;
+        MAXQ_CACHE_EVENT(MemoHits);
+
+        FMemory::Memcpy(Values, Found->Values, Num * sizeof(double));
+        if (Lt)
+        {
+            *Lt = Found->Lt;
+        }
+        return true;
+    }
+
+
+    void MemoizeQuery(const FQueryMemoKey& Key, const double* Values, int32 Num, double Lt)
+    {
+        check(Num <= 36);
+
+        FMemo& State = Memo();
+        if (State.Entries.Num() >= MaxEntries)
+        {
+            State.Entries.Reset();
+        }
+
+        FMemoValue& Value = State.Entries.Add(Key);
+        FMemory::Memcpy(Value.Values, Values, Num * sizeof(double));
+        Value.Lt = Lt;
+    }
+}
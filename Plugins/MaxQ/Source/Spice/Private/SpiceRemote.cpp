@@ -0,0 +1,807 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceRemote.cpp
+//
+// Implementation Comments
+//
+// Purpose:  SPICE queries answered by another machine, for clients that
+// can't carry kernels.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceRemote.cpp is part of the "refined C++ API".
+//
+// Everything that arrives is checked before anything is allocated for it
+// (frame size, epoch counts, enums), since it comes off the wire.  A
+// connection that sends a malformed frame is closed;  a well formed request
+// that fails gets an error response, and the connection carries on.
+//
+// Once a frame has started arriving, the rest of it has to follow within
+// IoTimeoutSeconds, so one stalled client can't hold the server.  The client
+// waits for responses without a limit:  a geometry finder search can take
+// minutes.
+//------------------------------------------------------------------------------
+
+#include "SpiceRemote.h"
+#include "SpiceLock.h"
+#include "SpiceUtilities.h"
+#include "HAL/Event.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Common/TcpSocketBuilder.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Ephemeris;
+
+    constexpr uint32 FrameMagic = 'M' | ('X' << 8) | ('Q' << 16) | ('R' << 24);
+    constexpr uint16 FrameVersion = 1;
+    constexpr int32 FrameHeaderSize = 2 * sizeof(uint32) + 2 * sizeof(uint16);
+
+    // Limits on what's accepted off the wire
+    constexpr uint32 MaxFrameSize = 64 * 1024 * 1024;
+    constexpr int32 MaxEpochs = 1024 * 1024;
+
+    constexpr double IoTimeoutSeconds = 30.;
+    const FTimespan PollInterval = FTimespan::FromMilliseconds(100);
+
+    // A fetch on a miss starts this fraction of a window before et
+    constexpr double Behind = 0.1;
+
+    enum ERemoteKind : uint16
+    {
+        FitKind = 1,
+        PxformKind = 2,
+        JobKind = 3
+    };
+
+    enum class ERecv
+    {
+        Ok,
+        Closed,
+        Malformed
+    };
+
+    bool SendAll(FSocket* Socket, const uint8* Data, int32 Size)
+    {
+        while (Size > 0)
+        {
+            int32 Sent = 0;
+            if (!Socket->Send(Data, Size, Sent) || Sent <= 0)
+            {
+                return false;
+            }
+            Data += Sent;
+            Size -= Sent;
+        }
+        return true;
+    }
+
+    // bWaitForever:  until data arrives, or bStopping.  Otherwise no more than
+    // IoTimeoutSeconds between pieces.
+    bool RecvAll(FSocket* Socket, uint8* Data, int32 Size, const std::atomic<bool>& bStopping, bool bWaitForever)
+    {
+        double Deadline = FPlatformTime::Seconds() + IoTimeoutSeconds;
+        while (Size > 0)
+        {
+            if (bStopping.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (!Socket->Wait(ESocketWaitConditions::WaitForRead, PollInterval))
+            {
+                if (!bWaitForever && FPlatformTime::Seconds() > Deadline)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            int32 Read = 0;
+            if (!Socket->Recv(Data, Size, Read) || Read <= 0)
+            {
+                return false;
+            }
+            Data += Read;
+            Size -= Read;
+            Deadline = FPlatformTime::Seconds() + IoTimeoutSeconds;
+        }
+        return true;
+    }
+
+    bool SendFrame(FSocket* Socket, uint16 Kind, const TArray<uint8>& Payload)
+    {
+        TArray<uint8> Frame;
+        Frame.Reserve(FrameHeaderSize + Payload.Num());
+        FMemoryWriter Writer(Frame);
+
+        uint32 Magic = FrameMagic;
+        uint16 Version = FrameVersion;
+        uint32 Size = Payload.Num();
+        Writer << Magic << Version << Kind << Size;
+        Frame.Append(Payload);
+
+        return SendAll(Socket, Frame.GetData(), Frame.Num());
+    }
+
+    ERecv RecvFrame(FSocket* Socket, uint16& Kind, TArray<uint8>& Payload, const std::atomic<bool>& bStopping, bool bWaitForever)
+    {
+        uint8 Header[FrameHeaderSize];
+        if (!RecvAll(Socket, Header, FrameHeaderSize, bStopping, bWaitForever))
+        {
+            return ERecv::Closed;
+        }
+
+        TArray<uint8> HeaderBytes(Header, FrameHeaderSize);
+        FMemoryReader Reader(HeaderBytes);
+        uint32 Magic = 0, Size = 0;
+        uint16 Version = 0;
+        Reader << Magic << Version << Kind << Size;
+
+        if (Magic != FrameMagic || Version != FrameVersion || Size > MaxFrameSize)
+        {
+            return ERecv::Malformed;
+        }
+
+        Payload.SetNumUninitialized(Size);
+        return RecvAll(Socket, Payload.GetData(), Size, bStopping, false) ? ERecv::Ok : ERecv::Closed;
+    }
+
+
+    // Server side.  Caller holds an FSpiceScope.  False with bMalformed set
+    // if the request can't be read.
+    bool HandleFit(const TArray<uint8>& Request, TArray<uint8>& Response, FString& ErrorMessage, bool& bMalformed)
+    {
+        FMemoryReader Reader(Request);
+        FString targ, obs, ref;
+        uint8 abcorr = 0;
+        double Start = 0., Stop = 0., ToleranceKm = 0.;
+        int32 Degree = 0;
+        Reader << targ << obs << ref << abcorr << Start << Stop << ToleranceKm << Degree;
+
+        if (Reader.IsError() || abcorr > (uint8)ES_AberrationCorrectionWithNewtonians::CN_S || !(Stop > Start) || !(ToleranceKm > 0.))
+        {
+            bMalformed = true;
+            return false;
+        }
+
+        FMaxQEphemerisWindow Window;
+        if (!Window.Fit(targ, obs, ref, (ES_AberrationCorrectionWithNewtonians)abcorr, Start, Stop, ToleranceKm, Degree, ErrorMessage))
+        {
+            return false;
+        }
+
+        FMemoryWriter Writer(Response);
+        bool bSuccess = false;
+        Window.NetSerialize(Writer, nullptr, bSuccess);
+        return bSuccess;
+    }
+
+    bool HandlePxform(const TArray<uint8>& Request, TArray<uint8>& Response, FString& ErrorMessage, bool& bMalformed)
+    {
+        FMemoryReader Reader(Request);
+        FString from, to;
+        int32 Count = 0;
+        Reader << from << to << Count;
+
+        if (Reader.IsError() || Count < 0 || Count > MaxEpochs || Reader.TotalSize() - Reader.Tell() != (int64)Count * sizeof(double))
+        {
+            bMalformed = true;
+            return false;
+        }
+
+        TArray<double> ets;
+        ets.SetNumUninitialized(Count);
+        Reader.Serialize(ets.GetData(), Count * sizeof(double));
+
+        TArray<double> Matrices;
+        Matrices.SetNumUninitialized(Count * 9);
+        for (int32 i = 0; i < Count; ++i)
+        {
+            pxform_c(TCHAR_TO_ANSI(*from), TCHAR_TO_ANSI(*to), ets[i], reinterpret_cast<SpiceDouble(*)[3]>(&Matrices[i * 9]));
+            if (ErrorCheck(nullptr, &ErrorMessage))
+            {
+                return false;
+            }
+        }
+
+        Response.Append(reinterpret_cast<const uint8*>(Matrices.GetData()), Matrices.Num() * sizeof(double));
+        return true;
+    }
+
+    bool HandleJob(const TArray<uint8>& Request, TArray<uint8>& Response, FString& ErrorMessage, bool& bMalformed)
+    {
+        FMemoryReader Reader(Request);
+        FString JobName;
+        TArray<uint8> JobRequest;
+        Reader << JobName << JobRequest;
+
+        if (Reader.IsError())
+        {
+            bMalformed = true;
+            return false;
+        }
+
+        const FSpiceJobHandler* Handler = FSpiceProcessPool::FindJob(FName(*JobName));
+        if (!Handler)
+        {
+            ErrorMessage = FString::Printf(TEXT("FRemoteEphemerisServer: unknown job %s"), *JobName);
+            return false;
+        }
+
+        return (*Handler)(JobRequest, Response, ErrorMessage);
+    }
+
+    // The response frame's payload
+    TArray<uint8> MakeResponse(bool bSuccess, const FString& ErrorMessage, const TArray<uint8>& Body)
+    {
+        TArray<uint8> Payload;
+        FMemoryWriter Writer(Payload);
+        Writer << bSuccess;
+        if (bSuccess)
+        {
+            Payload.Append(Body);
+        }
+        else
+        {
+            FString Message = ErrorMessage.IsEmpty() ? FString(TEXT("failed")) : ErrorMessage;
+            Writer << Message;
+        }
+        return Payload;
+    }
+
+    void DestroySocket(FSocket*& Socket)
+    {
+        if (Socket)
+        {
+            Socket->Close();
+            ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+            Socket = nullptr;
+        }
+    }
+}
+
+
+namespace MaxQ::Ephemeris
+{
+    FRemoteEphemerisServer::FRemoteEphemerisServer() = default;
+
+    FRemoteEphemerisServer::~FRemoteEphemerisServer()
+    {
+        Stop();
+    }
+
+
+    bool FRemoteEphemerisServer::Start(int32 Port, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Stop();
+
+        Listener = FTcpSocketBuilder(TEXT("MaxQRemoteServer"))
+            .AsReusable()
+            .BoundToPort(Port)
+            .Listening(16)
+            .Build();
+
+        if (!Listener)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("FRemoteEphemerisServer::Start: could not listen on TCP port %d"), Port);
+            return false;
+        }
+
+        bStopping.store(false, std::memory_order_release);
+        Thread = MakeUnique<FThread>(TEXT("MaxQRemoteServer"), [this]() { Run(); });
+
+        UE_LOG(LogSpice, Log, TEXT("FRemoteEphemerisServer listening on port %d"), Port);
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    void FRemoteEphemerisServer::Stop()
+    {
+        bStopping.store(true, std::memory_order_release);
+        if (Thread.IsValid())
+        {
+            Thread->Join();
+            Thread.Reset();
+        }
+
+        DestroySocket(Listener);
+    }
+
+
+    void FRemoteEphemerisServer::Run()
+    {
+        TArray<FSocket*> Clients;
+
+        while (!bStopping.load(std::memory_order_acquire))
+        {
+            bool bIdle = true;
+
+            bool bPending = false;
+            if (Listener->HasPendingConnection(bPending) && bPending)
+            {
+                if (FSocket* Client = Listener->Accept(TEXT("MaxQRemoteConnection")))
+                {
+                    Clients.Add(Client);
+                    bIdle = false;
+                }
+            }
+
+            for (int32 i = Clients.Num() - 1; i >= 0; --i)
+            {
+                FSocket* Client = Clients[i];
+                if (!Client->Wait(ESocketWaitConditions::WaitForRead, FTimespan::Zero()))
+                {
+                    continue;
+                }
+                bIdle = false;
+
+                uint16 Kind = 0;
+                TArray<uint8> Request;
+                const ERecv Received = RecvFrame(Client, Kind, Request, bStopping, false);
+
+                bool bKeep = Received == ERecv::Ok;
+                if (bKeep)
+                {
+                    Requests.fetch_add(1, std::memory_order_relaxed);
+
+                    bool bMalformed = false;
+                    bool bSuccess = false;
+                    FString ErrorMessage;
+                    TArray<uint8> Body;
+                    {
+                        MaxQ::Core::FSpiceScope Scope;
+                        switch (Kind)
+                        {
+                        case FitKind: bSuccess = HandleFit(Request, Body, ErrorMessage, bMalformed); break;
+                        case PxformKind: bSuccess = HandlePxform(Request, Body, ErrorMessage, bMalformed); break;
+                        case JobKind: bSuccess = HandleJob(Request, Body, ErrorMessage, bMalformed); break;
+                        default: bMalformed = true; break;
+                        }
+                    }
+
+                    bKeep = !bMalformed && SendFrame(Client, Kind, MakeResponse(bSuccess, ErrorMessage, Body));
+                    if (bMalformed)
+                    {
+                        Malformed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                else if (Received == ERecv::Malformed)
+                {
+                    Malformed.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                if (!bKeep)
+                {
+                    DestroySocket(Client);
+                    Clients.RemoveAtSwap(i);
+                }
+            }
+
+            Connections.store(Clients.Num(), std::memory_order_relaxed);
+
+            if (bIdle)
+            {
+                FPlatformProcess::Sleep(0.005f);
+            }
+        }
+
+        for (FSocket* Client : Clients)
+        {
+            DestroySocket(Client);
+        }
+        Connections.store(0, std::memory_order_relaxed);
+    }
+
+
+    FRemoteEphemerisClient::FRemoteEphemerisClient(const FRemoteEphemerisSettings& _Settings)
+        : Settings(_Settings)
+    {
+        Settings.MaxWindows = FMath::Max(Settings.MaxWindows, 1);
+    }
+
+    FRemoteEphemerisClient::~FRemoteEphemerisClient()
+    {
+        Disconnect();
+    }
+
+
+    bool FRemoteEphemerisClient::Connect(const FString& Host, int32 Port, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Disconnect();
+
+        ISocketSubsystem* Sockets = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+        FAddressInfoResult Found = Sockets->GetAddressInfo(*Host, nullptr, EAddressInfoFlags::Default, NAME_None, ESocketType::SOCKTYPE_Streaming);
+        if (Found.ReturnCode != SE_NO_ERROR || Found.Results.Num() == 0)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("FRemoteEphemerisClient::Connect: could not resolve %s"), *Host);
+            return false;
+        }
+
+        TSharedRef<FInternetAddr> Address = Found.Results[0].Address;
+        Address->SetPort(Port);
+
+        Socket = Sockets->CreateSocket(NAME_Stream, TEXT("MaxQRemoteClient"), Address->GetProtocolType());
+        if (!Socket || !Socket->Connect(*Address))
+        {
+            DestroySocket(Socket);
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("FRemoteEphemerisClient::Connect: could not connect to %s:%d"), *Host, Port);
+            return false;
+        }
+
+        Wake = FPlatformProcess::GetSynchEventFromPool();
+        bStopping.store(false, std::memory_order_release);
+        bConnected.store(true, std::memory_order_release);
+        Thread = MakeUnique<FThread>(TEXT("MaxQRemoteClient"), [this]() { Run(); });
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    void FRemoteEphemerisClient::Disconnect()
+    {
+        bConnected.store(false, std::memory_order_release);
+        bStopping.store(true, std::memory_order_release);
+        if (Wake)
+        {
+            Wake->Trigger();
+        }
+        if (Thread.IsValid())
+        {
+            Thread->Join();
+            Thread.Reset();
+        }
+
+        DestroySocket(Socket);
+        FailQueued(TEXT("FRemoteEphemerisClient: disconnected"));
+
+        if (Wake)
+        {
+            FPlatformProcess::ReturnSynchEventToPool(Wake);
+            Wake = nullptr;
+        }
+    }
+
+
+    void FRemoteEphemerisClient::Run()
+    {
+        while (!bStopping.load(std::memory_order_acquire))
+        {
+            TUniquePtr<FPending> Pending;
+            if (!Queue.Dequeue(Pending))
+            {
+                Wake->Wait(PollInterval);
+                continue;
+            }
+
+            uint16 Kind = 0;
+            TArray<uint8> Response;
+            if (!SendFrame(Socket, Pending->Kind, Pending->Request)
+                || RecvFrame(Socket, Kind, Response, bStopping, true) != ERecv::Ok
+                || Kind != Pending->Kind)
+            {
+                TArray<uint8> None;
+                Pending->OnResponse(false, TEXT("FRemoteEphemerisClient: lost the connection"), None);
+
+                // Nothing more will get through
+                bConnected.store(false, std::memory_order_release);
+                FailQueued(TEXT("FRemoteEphemerisClient: lost the connection"));
+                return;
+            }
+
+            FMemoryReader Reader(Response);
+            bool bSuccess = false;
+            FString ErrorMessage;
+            Reader << bSuccess;
+            if (!bSuccess)
+            {
+                Reader << ErrorMessage;
+            }
+
+            TArray<uint8> Body;
+            if (bSuccess && !Reader.IsError())
+            {
+                Body.Append(Response.GetData() + Reader.Tell(), Response.Num() - (int32)Reader.Tell());
+            }
+            Pending->OnResponse(bSuccess && !Reader.IsError(), ErrorMessage, Body);
+        }
+    }
+
+
+    void FRemoteEphemerisClient::FailQueued(const FString& ErrorMessage)
+    {
+        TUniquePtr<FPending> Pending;
+        while (Queue.Dequeue(Pending))
+        {
+            TArray<uint8> None;
+            Pending->OnResponse(false, ErrorMessage, None);
+        }
+    }
+
+
+    void FRemoteEphemerisClient::Send(uint16 Kind, TArray<uint8>&& Request, FOnResponse&& OnResponse)
+    {
+        if (!IsConnected())
+        {
+            TArray<uint8> None;
+            OnResponse(false, TEXT("FRemoteEphemerisClient: not connected"), None);
+            return;
+        }
+
+        TUniquePtr<FPending> Pending = MakeUnique<FPending>();
+        Pending->Kind = Kind;
+        Pending->Request = MoveTemp(Request);
+        Pending->OnResponse = MoveTemp(OnResponse);
+        Queue.Enqueue(MoveTemp(Pending));
+        Wake->Trigger();
+    }
+
+
+    FString FRemoteEphemerisClient::Key(const FString& targ, const FString& obs, const FString& ref, ES_AberrationCorrectionWithNewtonians abcorr)
+    {
+        return FString::Printf(TEXT("%s|%s|%s|%d"), *targ.ToUpper(), *obs.ToUpper(), *ref.ToUpper(), (int32)abcorr);
+    }
+
+
+    bool FRemoteEphemerisClient::Evaluate(const FString& WindowKey, double et, double (&r)[3], double (&v)[3]) const
+    {
+        FRWScopeLock ScopeLock(WindowsLock, SLT_ReadOnly);
+        if (const TArray<FMaxQEphemerisWindow>* Found = Windows.Find(WindowKey))
+        {
+            // Newest first
+            for (int32 i = Found->Num() - 1; i >= 0; --i)
+            {
+                if ((*Found)[i].Evaluate(et, r, v))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+
+    void FRemoteEphemerisClient::AddWindow(const FString& WindowKey, FMaxQEphemerisWindow&& Window)
+    {
+        FRWScopeLock ScopeLock(WindowsLock, SLT_Write);
+        TArray<FMaxQEphemerisWindow>& Kept = Windows.FindOrAdd(WindowKey);
+        Kept.Add(MoveTemp(Window));
+        if (Kept.Num() > Settings.MaxWindows)
+        {
+            Kept.RemoveAt(0, Kept.Num() - Settings.MaxWindows);
+        }
+    }
+
+
+    bool FRemoteEphemerisClient::State(const FSEphemerisTime& et, const FString& targ, const FString& obs, const FString& ref, ES_AberrationCorrectionWithNewtonians abcorr, FSStateVector& state) const
+    {
+        double r[3], v[3];
+        if (!Evaluate(Key(targ, obs, ref, abcorr), et.AsSpiceDouble(), r, v))
+        {
+            return false;
+        }
+
+        const double _state[6] = { r[0], r[1], r[2], v[0], v[1], v[2] };
+        state = FSStateVector(_state);
+        return true;
+    }
+
+
+    bool FRemoteEphemerisClient::Position(const FSEphemerisTime& et, const FString& targ, const FString& obs, const FString& ref, ES_AberrationCorrectionWithNewtonians abcorr, FSDistanceVector& r) const
+    {
+        double _r[3], _v[3];
+        if (!Evaluate(Key(targ, obs, ref, abcorr), et.AsSpiceDouble(), _r, _v))
+        {
+            return false;
+        }
+
+        r = FSDistanceVector(_r);
+        return true;
+    }
+
+
+    TFuture<FSpiceJobResult> FRemoteEphemerisClient::Fetch(double Start, const FString& targ, const FString& obs, const FString& ref, ES_AberrationCorrectionWithNewtonians abcorr)
+    {
+        TArray<uint8> Request;
+        FMemoryWriter Writer(Request);
+        FString _targ = targ, _obs = obs, _ref = ref;
+        uint8 _abcorr = (uint8)abcorr;
+        double Stop = Start + Settings.WindowSeconds;
+        double ToleranceKm = Settings.ToleranceKm;
+        int32 Degree = Settings.Degree;
+        Writer << _targ << _obs << _ref << _abcorr << Start << Stop << ToleranceKm << Degree;
+
+        TPromise<FSpiceJobResult> Promise;
+        TFuture<FSpiceJobResult> Future = Promise.GetFuture();
+
+        Send(FitKind, MoveTemp(Request), [this, WindowKey = Key(targ, obs, ref, abcorr), Promise = MoveTemp(Promise)](bool bSuccess, const FString& ErrorMessage, TArray<uint8>& Response) mutable
+        {
+            FSpiceJobResult Result;
+            Result.bSuccess = bSuccess;
+            Result.ErrorMessage = ErrorMessage;
+
+            if (bSuccess)
+            {
+                FMemoryReader Reader(Response);
+                FMaxQEphemerisWindow Window;
+                bool bValid = false;
+                Window.NetSerialize(Reader, nullptr, bValid);
+                if (bValid && !Window.IsEmpty())
+                {
+                    AddWindow(WindowKey, MoveTemp(Window));
+                }
+                else
+                {
+                    Result.bSuccess = false;
+                    Result.ErrorMessage = TEXT("FRemoteEphemerisClient: malformed window");
+                }
+            }
+
+            Promise.SetValue(MoveTemp(Result));
+        });
+
+        return Future;
+    }
+
+
+    TFuture<FSpiceJobResult> FRemoteEphemerisClient::Prefetch(const FSEphemerisTime& et, const FString& targ, const FString& obs, const FString& ref, ES_AberrationCorrectionWithNewtonians abcorr)
+    {
+        const FString WindowKey = Key(targ, obs, ref, abcorr);
+        const double Start = et.AsSpiceDouble();
+
+        double r[3], v[3];
+        if (Evaluate(WindowKey, Start, r, v) && Evaluate(WindowKey, Start + Settings.WindowSeconds, r, v))
+        {
+            FSpiceJobResult Result;
+            Result.bSuccess = true;
+            return MakeFulfilledPromise<FSpiceJobResult>(MoveTemp(Result)).GetFuture();
+        }
+
+        return Fetch(Start, targ, obs, ref, abcorr);
+    }
+
+
+    TFuture<FRemoteStateResult> FRemoteEphemerisClient::StateAsync(const FSEphemerisTime& et, const FString& targ, const FString& obs, const FString& ref, ES_AberrationCorrectionWithNewtonians abcorr)
+    {
+        FRemoteStateResult Result;
+        if (State(et, targ, obs, ref, abcorr, Result.State))
+        {
+            Result.bSuccess = true;
+            return MakeFulfilledPromise<FRemoteStateResult>(MoveTemp(Result)).GetFuture();
+        }
+
+        return Fetch(et.AsSpiceDouble() - Behind * Settings.WindowSeconds, targ, obs, ref, abcorr)
+            .Next([this, et, targ, obs, ref, abcorr](FSpiceJobResult Fetched)
+            {
+                FRemoteStateResult Evaluated;
+                Evaluated.ErrorMessage = MoveTemp(Fetched.ErrorMessage);
+                if (Fetched.bSuccess)
+                {
+                    Evaluated.bSuccess = State(et, targ, obs, ref, abcorr, Evaluated.State);
+                    if (!Evaluated.bSuccess)
+                    {
+                        Evaluated.ErrorMessage = TEXT("FRemoteEphemerisClient: the window doesn't cover et");
+                    }
+                }
+                return Evaluated;
+            });
+    }
+
+
+    TFuture<FRemoteFrameResult> FRemoteEphemerisClient::Pxform(const FString& from, const FString& to, const TArray<FSEphemerisTime>& ets)
+    {
+        TArray<uint8> Request;
+        FMemoryWriter Writer(Request);
+        FString _from = from, _to = to;
+        int32 Count = ets.Num();
+        Writer << _from << _to << Count;
+        for (const FSEphemerisTime& et : ets)
+        {
+            double _et = et.AsSpiceDouble();
+            Writer << _et;
+        }
+
+        TPromise<FRemoteFrameResult> Promise;
+        TFuture<FRemoteFrameResult> Future = Promise.GetFuture();
+
+        Send(PxformKind, MoveTemp(Request), [Count, Promise = MoveTemp(Promise)](bool bSuccess, const FString& ErrorMessage, TArray<uint8>& Response) mutable
+        {
+            FRemoteFrameResult Result;
+            Result.bSuccess = bSuccess;
+            Result.ErrorMessage = ErrorMessage;
+
+            if (bSuccess)
+            {
+                if (Response.Num() == Count * 9 * (int32)sizeof(double))
+                {
+                    const double* m = reinterpret_cast<const double*>(Response.GetData());
+                    Result.Matrices.Reserve(Count);
+                    for (int32 i = 0; i < Count; ++i, m += 9)
+                    {
+                        Result.Matrices.Emplace(*reinterpret_cast<const double(*)[3][3]>(m));
+                    }
+                }
+                else
+                {
+                    Result.bSuccess = false;
+                    Result.ErrorMessage = TEXT("FRemoteEphemerisClient: malformed matrices");
+                }
+            }
+
+            Promise.SetValue(MoveTemp(Result));
+        });
+
+        return Future;
+    }
+
+
+    TFuture<FSpiceJobResult> FRemoteEphemerisClient::RunJob(FName JobName, TArray<uint8>&& Request)
+    {
+        TArray<uint8> Wrapped;
+        FMemoryWriter Writer(Wrapped);
+        FString _JobName = JobName.ToString();
+        Writer << _JobName << Request;
+
+        TPromise<FSpiceJobResult> Promise;
+        TFuture<FSpiceJobResult> Future = Promise.GetFuture();
+
+        Send(JobKind, MoveTemp(Wrapped), [Promise = MoveTemp(Promise)](bool bSuccess, const FString& ErrorMessage, TArray<uint8>& Response) mutable
+        {
+            FSpiceJobResult Result;
+            Result.bSuccess = bSuccess;
+            Result.ErrorMessage = ErrorMessage;
+            Result.Response = MoveTemp(Response);
+            Promise.SetValue(MoveTemp(Result));
+        });
+
+        return Future;
+    }
+
+
+    void FRemoteEphemerisClient::Flush()
+    {
+        FRWScopeLock ScopeLock(WindowsLock, SLT_Write);
+        Windows.Reset();
+    }
+
+
+    int32 FRemoteEphemerisClient::NumWindows() const
+    {
+        FRWScopeLock ScopeLock(WindowsLock, SLT_ReadOnly);
+        int32 Count = 0;
+        for (const auto& Kept : Windows)
+        {
+            Count += Kept.Value.Num();
+        }
+        return Count;
+    }
+}
@@ -0,0 +1,80 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceRemoteServerCommandlet.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A headless FRemoteEphemerisServer (SpiceRemote.h).
+//------------------------------------------------------------------------------
+
+#include "SpiceRemoteServerCommandlet.h"
+#include "Misc/Parse.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceRemote.h"
+#include "SpiceUtilities.h"
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr int32 DefaultPort = 7782;
+}
+
+
+USpiceRemoteServerCommandlet::USpiceRemoteServerCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+
+int32 USpiceRemoteServerCommandlet::Main(const FString& Params)
+{
+    FString Kernels;
+    if (!FParse::Value(*Params, TEXT("Kernels="), Kernels, false))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Remote Server: missing -Kernels"));
+        return 1;
+    }
+
+    int32 Port = DefaultPort;
+    FParse::Value(*Params, TEXT("Port="), Port);
+
+    MaxQ::Core::InitAll();
+
+    TArray<FString> KernelPaths;
+    Kernels.ParseIntoArray(KernelPaths, TEXT("+"));
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    if (!MaxQ::Data::Furnsh(KernelPaths, &ResultCode, &ErrorMessage))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Remote Server: %s"), *ErrorMessage);
+        return 1;
+    }
+
+    MaxQ::Ephemeris::FRemoteEphemerisServer Server;
+    if (!Server.Start(Port, &ResultCode, &ErrorMessage))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Remote Server: %s"), *ErrorMessage);
+        return 1;
+    }
+
+    while (!IsEngineExitRequested())
+    {
+        FPlatformProcess::Sleep(0.1f);
+    }
+
+    UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE Remote Server: %llu requests (%llu malformed)"), Server.NumRequests(), Server.NumMalformed());
+    Server.Stop();
+    return 0;
+}
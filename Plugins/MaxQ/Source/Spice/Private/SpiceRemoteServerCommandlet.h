@@ -0,0 +1,34 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceRemoteServerCommandlet.h
+//
+// Private API Comments
+//
+// Purpose:  A headless FRemoteEphemerisServer (SpiceRemote.h).
+//    <exe> [project] -run=SpiceRemoteServer -Kernels=<a>+<b>+... [-Port=<n>]
+// Kernels are loaded as Furnsh (meta-kernels are fine).  Serves until the
+// process is asked to exit.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SpiceRemoteServerCommandlet.generated.h"
+
+UCLASS()
+class USpiceRemoteServerCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    USpiceRemoteServerCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
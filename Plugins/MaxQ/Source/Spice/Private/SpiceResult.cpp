@@ -0,0 +1,85 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceResult.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Error results for native callers, without FString traffic.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceResult.cpp is part of the "refined C++ API".
+//
+// The long message has to be copied out before reset_c, but not converted.
+// Each thread keeps the last one, tagged with a sequence number, so an
+// FSpiceError can tell whether it's still its own.
+//------------------------------------------------------------------------------
+
+#include "SpiceResult.h"
+#include "SpiceUtilities.h"
+#include "SpicePlatformDefs.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    thread_local ANSICHAR LastLongMessage[SpiceLongMessageMaxLength];
+    thread_local uint32 LastSequence = 0;
+}
+
+namespace MaxQ::Core
+{
+    SPICE_API bool TakeError(FSpiceError& Error)
+    {
+        if (!failed_c())
+        {
+            return false;
+        }
+
+        CountFailure();
+
+        getmsg_c("SHORT", sizeof(Error.ShortMessage), Error.ShortMessage);
+
+        LastLongMessage[0] = '\0';
+        getmsg_c("LONG", sizeof(LastLongMessage), LastLongMessage);
+
+        // Zero is never a valid sequence
+        if (++LastSequence == 0)
+        {
+            ++LastSequence;
+        }
+        Error.Sequence = LastSequence;
+
+        reset_c();
+
+        return true;
+    }
+
+
+    FString FSpiceError::GetMessage() const
+    {
+        if (Sequence == LastSequence && SpiceStringLengthN(LastLongMessage, sizeof(LastLongMessage)))
+        {
+            return FString(LastLongMessage);
+        }
+
+        return FString(ShortMessage);
+    }
+}
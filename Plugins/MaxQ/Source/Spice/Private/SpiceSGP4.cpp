@@ -0,0 +1,1197 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSGP4.cpp
+//
+// Implementation Comments
+//
+// Purpose:  SGP4 propagation of two-line elements, one model per satellite.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSGP4.cpp is part of the "refined C++ API".
+//
+// Ported from CSPICE's zzsgp4.c (xxsgp4i/xxsgp4e), zzinil.c, zzdscm.c,
+// zzdspr.c, zzdsin.c and zzdspc.c.  Variable names are kept the same as the
+// CSPICE/Vallado sources so the two can be compared side by side.
+// The differences:
+//  * The model lives in FSGP4Model instead of static variables.
+//  * Evaluation never writes to the model.  The deep space resonance
+//    integrator always starts at epoch, which is what evsgp4 does too
+//    (it re-initializes on every call).
+//  * Errors are returned as ESGP4Status instead of being signalled.
+//  * Only AFSPC mode (OPMODE = 1) is supported, since that's what evsgp4 uses.
+//------------------------------------------------------------------------------
+
+#include "SpiceSGP4.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+
+// for ttrans_
+#include "SpiceZfc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double twopi = 2. * pi;
+    constexpr double x2o3 = .66666666666666663;
+    constexpr double temp4 = 1.5e-12;
+
+    // Fortran MOD (as f2c's d_mod), not std::fmod
+    inline double d_mod(double x, double y)
+    {
+        double quotient = x / y;
+        quotient = quotient >= 0 ? floor(quotient) : -floor(-quotient);
+        return x - y * quotient;
+    }
+
+    inline double d_int(double x)
+    {
+        return x >= 0 ? floor(x) : -floor(-x);
+    }
+
+
+    // zzdscm outputs
+    struct FDeepCommon
+    {
+        double snodm, cnodm, sinim, cosim, sinomm, cosomm, day, e3, ee2, eccm, emsq, gam;
+        double peo, pgho, pho, pinco, plo, rtemsq, se2, se3, sgh2, sgh3, sgh4, sh2, sh3;
+        double si2, si3, sl2, sl3, sl4, s1, s2, s3, s4, s5, s6, s7, ss1, ss2, ss3, ss4;
+        double ss5, ss6, ss7, sz1, sz2, sz3, sz11, sz12, sz13, sz21, sz22, sz23, sz31;
+        double sz32, sz33, xgh2, xgh3, xgh4, xh2, xh3, xi2, xi3, xl2, xl3, xl4, xn;
+        double z1, z2, z3, z11, z12, z13, z21, z22, z23, z31, z32, z33, zmol, zmos;
+    };
+
+
+    // ZZDSCM:  deep space common terms (lunar & solar)
+    void zzdscm(double epoch, double eccp, double argpp, double tc, double inclp, double nodep, double np, FDeepCommon& o)
+    {
+        const double zes = .01675;
+        const double zel = .0549;
+        const double c1ss = 2.9864797e-6;
+        const double c1l = 4.7968065e-7;
+        const double zsinis = .39785416;
+        const double zcosis = .91744867;
+        const double zcosgs = .1945905;
+        const double zsings = -.98088458;
+
+        o.xn = np;
+        o.eccm = eccp;
+        o.snodm = sin(nodep);
+        o.cnodm = cos(nodep);
+        o.sinomm = sin(argpp);
+        o.cosomm = cos(argpp);
+        o.sinim = sin(inclp);
+        o.cosim = cos(inclp);
+        o.emsq = o.eccm * o.eccm;
+        const double betasq = 1. - o.emsq;
+        o.rtemsq = sqrt(betasq);
+
+        o.peo = 0.;
+        o.pinco = 0.;
+        o.plo = 0.;
+        o.pgho = 0.;
+        o.pho = 0.;
+        o.day = epoch + 18261.5 + tc / 1440.;
+
+        const double xnodce = d_mod(4.523602 - o.day * 9.2422029e-4, twopi);
+        const double stem = sin(xnodce);
+        const double ctem = cos(xnodce);
+        const double zcosil = .91375164 - ctem * .03568096;
+        const double zsinil = sqrt(1. - zcosil * zcosil);
+        const double zsinhl = stem * .089683511 / zsinil;
+        const double zcoshl = sqrt(1. - zsinhl * zsinhl);
+        o.gam = o.day * .001944368 + 5.8351514;
+        double zx = stem * .39785416 / zsinil;
+        double zy = zcoshl * ctem + zsinhl * .91744867 * stem;
+        zx = atan2(zx, zy);
+        zx = o.gam + zx - xnodce;
+        const double zcosgl = cos(zx);
+        const double zsingl = sin(zx);
+
+        double zcosg = zcosgs;
+        double zsing = zsings;
+        double zcosi = zcosis;
+        double zsini = zsinis;
+        double zcosh = o.cnodm;
+        double zsinh = o.snodm;
+        double cc = c1ss;
+        const double xnoi = 1. / o.xn;
+
+        for (int lsflg = 1; lsflg <= 2; ++lsflg)
+        {
+            const double a1 = zcosg * zcosh + zsing * zcosi * zsinh;
+            const double a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
+            const double a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
+            const double a8 = zsing * zsini;
+            const double a9 = zsing * zsinh + zcosg * zcosi * zcosh;
+            const double a10 = zcosg * zsini;
+            const double a2 = o.cosim * a7 + o.sinim * a8;
+            const double a4 = o.cosim * a9 + o.sinim * a10;
+            const double a5 = -o.sinim * a7 + o.cosim * a8;
+            const double a6 = -o.sinim * a9 + o.cosim * a10;
+
+            const double x1 = a1 * o.cosomm + a2 * o.sinomm;
+            const double x2 = a3 * o.cosomm + a4 * o.sinomm;
+            const double x3 = -a1 * o.sinomm + a2 * o.cosomm;
+            const double x4 = -a3 * o.sinomm + a4 * o.cosomm;
+            const double x5 = a5 * o.sinomm;
+            const double x6 = a6 * o.sinomm;
+            const double x7 = a5 * o.cosomm;
+            const double x8 = a6 * o.cosomm;
+
+            o.z31 = x1 * 12. * x1 - x3 * 3. * x3;
+            o.z32 = x1 * 24. * x2 - x3 * 6. * x4;
+            o.z33 = x2 * 12. * x2 - x4 * 3. * x4;
+            o.z1 = (a1 * a1 + a2 * a2) * 3. + o.z31 * o.emsq;
+            o.z2 = (a1 * a3 + a2 * a4) * 6. + o.z32 * o.emsq;
+            o.z3 = (a3 * a3 + a4 * a4) * 3. + o.z33 * o.emsq;
+            o.z11 = a1 * -6. * a5 + o.emsq * (x1 * -24. * x7 - x3 * 6. * x5);
+            o.z12 = (a1 * a6 + a3 * a5) * -6. + o.emsq * ((x2 * x7 + x1 * x8) * -24. - (x3 * x6 + x4 * x5) * 6.);
+            o.z13 = a3 * -6. * a6 + o.emsq * (x2 * -24. * x8 - x4 * 6. * x6);
+            o.z21 = a2 * 6. * a5 + o.emsq * (x1 * 24. * x5 - x3 * 6. * x7);
+            o.z22 = (a4 * a5 + a2 * a6) * 6. + o.emsq * ((x2 * x5 + x1 * x6) * 24. - (x4 * x7 + x3 * x8) * 6.);
+            o.z23 = a4 * 6. * a6 + o.emsq * (x2 * 24. * x6 - x4 * 6. * x8);
+            o.z1 = o.z1 + o.z1 + betasq * o.z31;
+            o.z2 = o.z2 + o.z2 + betasq * o.z32;
+            o.z3 = o.z3 + o.z3 + betasq * o.z33;
+            o.s3 = cc * xnoi;
+            o.s2 = o.s3 * -.5 / o.rtemsq;
+            o.s4 = o.s3 * o.rtemsq;
+            o.s1 = o.eccm * -15. * o.s4;
+            o.s5 = x1 * x3 + x2 * x4;
+            o.s6 = x2 * x3 + x1 * x4;
+            o.s7 = x2 * x4 - x1 * x3;
+
+            if (lsflg == 1)
+            {
+                o.ss1 = o.s1;
+                o.ss2 = o.s2;
+                o.ss3 = o.s3;
+                o.ss4 = o.s4;
+                o.ss5 = o.s5;
+                o.ss6 = o.s6;
+                o.ss7 = o.s7;
+                o.sz1 = o.z1;
+                o.sz2 = o.z2;
+                o.sz3 = o.z3;
+                o.sz11 = o.z11;
+                o.sz12 = o.z12;
+                o.sz13 = o.z13;
+                o.sz21 = o.z21;
+                o.sz22 = o.z22;
+                o.sz23 = o.z23;
+                o.sz31 = o.z31;
+                o.sz32 = o.z32;
+                o.sz33 = o.z33;
+                zcosg = zcosgl;
+                zsing = zsingl;
+                zcosi = zcosil;
+                zsini = zsinil;
+                zcosh = zcoshl * o.cnodm + zsinhl * o.snodm;
+                zsinh = o.snodm * zcoshl - o.cnodm * zsinhl;
+                cc = c1l;
+            }
+        }
+
+        o.zmol = d_mod(o.day * .2299715 + 4.7199672 - o.gam, twopi);
+        o.zmos = d_mod(o.day * .017201977 + 6.2565837, twopi);
+
+        o.se2 = o.ss1 * 2. * o.ss6;
+        o.se3 = o.ss1 * 2. * o.ss7;
+        o.si2 = o.ss2 * 2. * o.sz12;
+        o.si3 = o.ss2 * 2. * (o.sz13 - o.sz11);
+        o.sl2 = o.ss3 * -2. * o.sz2;
+        o.sl3 = o.ss3 * -2. * (o.sz3 - o.sz1);
+        o.sl4 = o.ss3 * -2. * (-21. - o.emsq * 9.) * zes;
+        o.sgh2 = o.ss4 * 2. * o.sz32;
+        o.sgh3 = o.ss4 * 2. * (o.sz33 - o.sz31);
+        o.sgh4 = o.ss4 * -18. * zes;
+        o.sh2 = o.ss2 * -2. * o.sz22;
+        o.sh3 = o.ss2 * -2. * (o.sz23 - o.sz21);
+
+        o.ee2 = o.s1 * 2. * o.s6;
+        o.e3 = o.s1 * 2. * o.s7;
+        o.xi2 = o.s2 * 2. * o.z12;
+        o.xi3 = o.s2 * 2. * (o.z13 - o.z11);
+        o.xl2 = o.s3 * -2. * o.z2;
+        o.xl3 = o.s3 * -2. * (o.z3 - o.z1);
+        o.xl4 = o.s3 * -2. * (-21. - o.emsq * 9.) * zel;
+        o.xgh2 = o.s4 * 2. * o.z32;
+        o.xgh3 = o.s4 * 2. * (o.z33 - o.z31);
+        o.xgh4 = o.s4 * -18. * zel;
+        o.xh2 = o.s2 * -2. * o.z22;
+        o.xh3 = o.s2 * -2. * (o.z23 - o.z21);
+    }
+
+
+    // ZZDSPR:  deep space long period periodics (propagation only, DOINIT = false)
+    void zzdspr(const MaxQ::Orbits::FSGP4Model& m, double t, double& eccp, double& inclp, double& nodep, double& argpp, double& mp)
+    {
+        const double zes = .01675;
+        const double zel = .0549;
+        const double zns = 1.19459e-5;
+        const double znl = 1.5835218e-4;
+
+        double zm = m.zmos + zns * t;
+        double zf = zm + zes * 2. * sin(zm);
+        double sinzf = sin(zf);
+        double f2 = sinzf * .5 * sinzf - .25;
+        double f3 = sinzf * -.5 * cos(zf);
+        const double ses = m.se2 * f2 + m.se3 * f3;
+        const double sis = m.si2 * f2 + m.si3 * f3;
+        const double sls = m.sl2 * f2 + m.sl3 * f3 + m.sl4 * sinzf;
+        const double sghs = m.sgh2 * f2 + m.sgh3 * f3 + m.sgh4 * sinzf;
+        const double shs = m.sh2 * f2 + m.sh3 * f3;
+
+        zm = m.zmol + znl * t;
+        zf = zm + zel * 2. * sin(zm);
+        sinzf = sin(zf);
+        f2 = sinzf * .5 * sinzf - .25;
+        f3 = sinzf * -.5 * cos(zf);
+        const double sel = m.ee2 * f2 + m.e3 * f3;
+        const double sil = m.xi2 * f2 + m.xi3 * f3;
+        const double sll = m.xl2 * f2 + m.xl3 * f3 + m.xl4 * sinzf;
+        const double sghl = m.xgh2 * f2 + m.xgh3 * f3 + m.xgh4 * sinzf;
+        const double shl = m.xh2 * f2 + m.xh3 * f3;
+
+        double pe = ses + sel;
+        double pinc = sis + sil;
+        double pl = sls + sll;
+        double pgh = sghs + sghl;
+        double ph = shs + shl;
+
+        pe -= m.peo;
+        pinc -= m.pinco;
+        pl -= m.plo;
+        pgh -= m.pgho;
+        ph -= m.pho;
+        inclp += pinc;
+        eccp += pe;
+
+        const double sinip = sin(inclp);
+        const double cosip = cos(inclp);
+
+        if (inclp >= .2)
+        {
+            ph /= sinip;
+            pgh -= cosip * ph;
+            argpp += pgh;
+            nodep += ph;
+            mp += pl;
+        }
+        else
+        {
+            const double sinop = sin(nodep);
+            const double cosop = cos(nodep);
+            double alfdp = sinip * sinop;
+            double betdp = sinip * cosop;
+            const double dalf = ph * cosop + pinc * cosip * sinop;
+            const double dbet = -ph * sinop + pinc * cosip * cosop;
+            alfdp += dalf;
+            betdp += dbet;
+
+            // (OPMODE = 1)
+            nodep = d_mod(nodep, twopi);
+            if (nodep < 0.)
+            {
+                nodep += twopi;
+            }
+
+            double xls = mp + argpp + cosip * nodep;
+            const double dls = pl + pgh - pinc * nodep * sinip;
+            xls += dls;
+            const double xnoh = nodep;
+            nodep = atan2(alfdp, betdp);
+            if (nodep < 0.)
+            {
+                nodep += twopi;
+            }
+            if (fabs(xnoh - nodep) > pi)
+            {
+                nodep += nodep < xnoh ? twopi : -twopi;
+            }
+            mp += pl;
+            argpp = xls - mp - cosip * nodep;
+        }
+    }
+
+
+    // ZZDSIN:  deep space initialization (resonance terms)
+    void zzdsin(MaxQ::Orbits::FSGP4Model& m, const FDeepCommon& c, double eccsq, double inclm)
+    {
+        const double q22 = 1.7891679e-6;
+        const double q31 = 2.1460748e-6;
+        const double q33 = 2.2123015e-7;
+        const double root22 = 1.7891679e-6;
+        const double root44 = 7.3636953e-9;
+        const double root54 = 2.1765803e-9;
+        const double rptim = .00437526908801129966;
+        const double root32 = 3.7393792e-7;
+        const double root52 = 1.1428639e-7;
+        const double znl = 1.5835218e-4;
+        const double zns = 1.19459e-5;
+
+        // t = tc = 0 at initialization
+        const double cosim = c.cosim;
+        const double sinim = c.sinim;
+        const double xn = c.xn;
+        double eccm = c.eccm;
+        double emsq = c.emsq;
+
+        m.irez = 0;
+        if (xn < .0052359877 && xn > .0034906585)
+        {
+            m.irez = 1;
+        }
+        if (xn >= .00826 && xn <= .00924 && eccm >= .5)
+        {
+            m.irez = 2;
+        }
+
+        const double ses = c.ss1 * zns * c.ss5;
+        const double sis = c.ss2 * zns * (c.sz11 + c.sz13);
+        const double sls = -zns * c.ss3 * (c.sz1 + c.sz3 - 14. - emsq * 6.);
+        const double sghs = c.ss4 * zns * (c.sz31 + c.sz33 - 6.);
+        double shs = -zns * c.ss2 * (c.sz21 + c.sz23);
+        if (inclm < .052359877 || inclm > pi - .052359877)
+        {
+            shs = 0.;
+        }
+        if (sinim != 0.)
+        {
+            shs /= sinim;
+        }
+        const double sgs = sghs - cosim * shs;
+
+        m.dedt = ses + c.s1 * znl * c.s5;
+        m.didt = sis + c.s2 * znl * (c.z11 + c.z13);
+        m.dmdt = sls - znl * c.s3 * (c.z1 + c.z3 - 14. - emsq * 6.);
+        const double sghl = c.s4 * znl * (c.z31 + c.z33 - 6.);
+        double shl = -znl * c.s2 * (c.z21 + c.z23);
+        if (inclm < .052359877 || inclm > pi - .052359877)
+        {
+            shl = 0.;
+        }
+        m.domdt = sgs + sghl;
+        m.dnodt = shs;
+        if (sinim != 0.)
+        {
+            m.domdt -= cosim / sinim * shl;
+            m.dnodt += shl / sinim;
+        }
+
+        const double theta = d_mod(m.gsto, twopi);
+
+        if (m.irez != 0)
+        {
+            const double aonv = pow(xn / m.xke, x2o3);
+
+            if (m.irez == 2)
+            {
+                const double cosisq = cosim * cosim;
+                const double emo = eccm;
+                const double emsqo = emsq;
+                eccm = m.ecco;
+                emsq = eccsq;
+                const double eoc = eccm * emsq;
+                const double g201 = -.306 - (eccm - .64) * .44;
+
+                double g211, g310, g322, g410, g422, g520;
+                if (eccm <= .65)
+                {
+                    g211 = 3.616 - eccm * 13.247 + emsq * 16.29;
+                    g310 = eccm * 117.39 - 19.302 - emsq * 228.419 + eoc * 156.591;
+                    g322 = eccm * 109.7927 - 18.9068 - emsq * 214.6334 + eoc * 146.5816;
+                    g410 = eccm * 242.694 - 41.122 - emsq * 471.094 + eoc * 313.953;
+                    g422 = eccm * 841.88 - 146.407 - emsq * 1629.014 + eoc * 1083.435;
+                    g520 = eccm * 3017.977 - 532.114 - emsq * 5740.032 + eoc * 3708.276;
+                }
+                else
+                {
+                    g211 = eccm * 331.819 - 72.099 - emsq * 508.738 + eoc * 266.724;
+                    g310 = eccm * 1582.851 - 346.844 - emsq * 2415.925 + eoc * 1246.113;
+                    g322 = eccm * 1554.908 - 342.585 - emsq * 2366.899 + eoc * 1215.972;
+                    g410 = eccm * 4758.686 - 1052.797 - emsq * 7193.992 + eoc * 3651.957;
+                    g422 = eccm * 16178.11 - 3581.69 - emsq * 24462.77 + eoc * 12422.52;
+                    if (eccm > .715)
+                    {
+                        g520 = eccm * 29936.92 - 5149.66 - emsq * 54087.36 + eoc * 31324.56;
+                    }
+                    else
+                    {
+                        g520 = 1464.74 - eccm * 4664.75 + emsq * 3763.64;
+                    }
+                }
+
+                double g533, g521, g532;
+                if (eccm < .7)
+                {
+                    g533 = eccm * 4988.61 - 919.2277 - emsq * 9064.77 + eoc * 5542.21;
+                    g521 = eccm * 4568.6173 - 822.71072 - emsq * 8491.4146 + eoc * 5337.524;
+                    g532 = eccm * 4690.25 - 853.666 - emsq * 8624.77 + eoc * 5341.4;
+                }
+                else
+                {
+                    g533 = eccm * 161616.52 - 37995.78 - emsq * 229838.2 + eoc * 109377.94;
+                    g521 = eccm * 218913.95 - 51752.104 - emsq * 309468.16 + eoc * 146349.42;
+                    g532 = eccm * 170470.89 - 40023.88 - emsq * 242699.48 + eoc * 115605.82;
+                }
+
+                const double sini2 = sinim * sinim;
+                const double f220 = (cosim * 2. + 1. + cosisq) * .75;
+                const double f221 = sini2 * 1.5;
+                const double f321 = sinim * 1.875 * (1. - cosim * 2. - cosisq * 3.);
+                const double f322 = sinim * -1.875 * (cosim * 2. + 1. - cosisq * 3.);
+                const double f441 = sini2 * 35. * f220;
+                const double f442 = sini2 * 39.375 * sini2;
+                const double f522 = sinim * 9.84375 * (sini2 * (1. - cosim * 2. - cosisq * 5.) + (cosim * 4. - 2. + cosisq * 6.) * .33333333);
+                const double f523 = sinim * (sini2 * 4.92187512 * (-2. - cosim * 4. + cosisq * 10.) + (cosim * 2. + 1. - cosisq * 3.) * 6.56250012);
+                const double f542 = sinim * 29.53125 * (2. - cosim * 8. + cosisq * (cosim * 8. - 12. + cosisq * 10.));
+                const double f543 = sinim * 29.53125 * (-2. - cosim * 8. + cosisq * (cosim * 8. + 12. - cosisq * 10.));
+
+                const double xno2 = xn * xn;
+                const double ainv2 = aonv * aonv;
+                double temp1 = xno2 * 3. * ainv2;
+                double temp = temp1 * root22;
+                m.d2201 = temp * f220 * g201;
+                m.d2211 = temp * f221 * g211;
+                temp1 *= aonv;
+                temp = temp1 * root32;
+                m.d3210 = temp * f321 * g310;
+                m.d3222 = temp * f322 * g322;
+                temp1 *= aonv;
+                temp = temp1 * 2. * root44;
+                m.d4410 = temp * f441 * g410;
+                m.d4422 = temp * f442 * g422;
+                temp1 *= aonv;
+                temp = temp1 * root52;
+                m.d5220 = temp * f522 * g520;
+                m.d5232 = temp * f523 * g532;
+                temp = temp1 * 2. * root54;
+                m.d5421 = temp * f542 * g521;
+                m.d5433 = temp * f543 * g533;
+                m.xlamo = d_mod(m.mo + m.nodeo + m.nodeo - theta - theta, twopi);
+                m.xfact = m.mdot + m.dmdt + (m.nodedot + m.dnodt - rptim) * 2. - m.no;
+
+                eccm = emo;
+                emsq = emsqo;
+            }
+
+            if (m.irez == 1)
+            {
+                const double g200 = emsq * (emsq * .8125 - 2.5) + 1.;
+                const double g310 = emsq * 2. + 1.;
+                const double g300 = emsq * (emsq * 6.60937 - 6.) + 1.;
+                const double f220 = (cosim + 1.) * .75 * (cosim + 1.);
+                const double f311 = sinim * .9375 * sinim * (cosim * 3. + 1.) - (cosim + 1.) * .75;
+                double f330 = cosim + 1.;
+                f330 = f330 * 1.875 * f330 * f330;
+                m.del1 = xn * 3. * xn * aonv * aonv;
+                m.del2 = m.del1 * 2. * f220 * g200 * q22;
+                m.del3 = m.del1 * 3. * f330 * g300 * q33 * aonv;
+                m.del1 = m.del1 * f311 * g310 * q31 * aonv;
+                m.xlamo = d_mod(m.mo + m.nodeo + m.argpo - theta, twopi);
+                m.xfact = m.mdot + (m.argpdot + m.nodedot) - rptim + m.dmdt + m.domdt + m.dnodt - m.no;
+            }
+        }
+    }
+
+
+    // ZZDSPC:  deep space secular effects & resonance integration.
+    // The integrator restarts at epoch on every call (as it does in evsgp4).
+    void zzdspc(const MaxQ::Orbits::FSGP4Model& m, double t, double& eccm, double& argpm, double& inclm, double& mm, double& nodem, double& xn)
+    {
+        const double fasx2 = .13130908;
+        const double fasx4 = 2.8843198;
+        const double fasx6 = .37448087;
+        const double g22 = 5.7686396;
+        const double g32 = .95240898;
+        const double g44 = 1.8014998;
+        const double g52 = 1.050833;
+        const double g54 = 4.4108898;
+        const double rptim = .00437526908801129966;
+        const double stepp = 720.;
+        const double stepn = -720.;
+        const double step2 = 259200.;
+
+        double dndt = 0.;
+        const double theta = d_mod(m.gsto + t * rptim, twopi);
+        eccm += m.dedt * t;
+        inclm += m.didt * t;
+        argpm += m.domdt * t;
+        nodem += m.dnodt * t;
+        mm += m.dmdt * t;
+
+        if (m.irez != 0)
+        {
+            double atime = 0.;
+            double xni = m.no;
+            double xli = m.xlamo;
+            const double delt = t > 0. ? stepp : stepn;
+
+            double ft = 0.;
+            double xndt = 0., xldot = 0., xnddt = 0.;
+
+            while (true)
+            {
+                if (m.irez != 2)
+                {
+                    xndt = m.del1 * sin(xli - fasx2) + m.del2 * sin((xli - fasx4) * 2.) + m.del3 * sin((xli - fasx6) * 3.);
+                    xldot = xni + m.xfact;
+                    xnddt = m.del1 * cos(xli - fasx2) + m.del2 * 2. * cos((xli - fasx4) * 2.) + m.del3 * 3. * cos((xli - fasx6) * 3.);
+                    xnddt *= xldot;
+                }
+                else
+                {
+                    const double xomi = m.argpo + m.argpdot * atime;
+                    const double x2omi = xomi + xomi;
+                    const double x2li = xli + xli;
+                    xndt = m.d2201 * sin(x2omi + xli - g22) + m.d2211 * sin(xli - g22) + m.d3210 * sin(xomi + xli - g32)
+                        + m.d3222 * sin(-xomi + xli - g32) + m.d4410 * sin(x2omi + x2li - g44) + m.d4422 * sin(x2li - g44)
+                        + m.d5220 * sin(xomi + xli - g52) + m.d5232 * sin(-xomi + xli - g52) + m.d5421 * sin(xomi + x2li - g54)
+                        + m.d5433 * sin(-xomi + x2li - g54);
+                    xldot = xni + m.xfact;
+                    xnddt = m.d2201 * cos(x2omi + xli - g22) + m.d2211 * cos(xli - g22) + m.d3210 * cos(xomi + xli - g32)
+                        + m.d3222 * cos(-xomi + xli - g32) + m.d5220 * cos(xomi + xli - g52) + m.d5232 * cos(-xomi + xli - g52)
+                        + (m.d4410 * cos(x2omi + x2li - g44) + m.d4422 * cos(x2li - g44) + m.d5421 * cos(xomi + x2li - g54)
+                        + m.d5433 * cos(-xomi + x2li - g54)) * 2.;
+                    xnddt *= xldot;
+                }
+
+                if (fabs(t - atime) < stepp)
+                {
+                    ft = t - atime;
+                    break;
+                }
+
+                xli = xli + xldot * delt + xndt * step2;
+                xni = xni + xndt * delt + xnddt * step2;
+                atime += delt;
+            }
+
+            xn = xni + xndt * ft + xnddt * ft * ft * .5;
+            const double xl = xli + xldot * ft + xndt * ft * ft * .5;
+            if (m.irez != 1)
+            {
+                mm = xl - nodem * 2. + theta * 2.;
+            }
+            else
+            {
+                mm = xl - nodem - argpm + theta;
+            }
+            dndt = xn - m.no;
+            xn = m.no + dndt;
+        }
+    }
+
+
+    // ZZINIL outputs
+    struct FInitL
+    {
+        double ainv, ao, con41, con42, cosio, cosio2, eccsq, omeosq, posq, rp, rteosq, sinio, gsto;
+    };
+
+
+    // ZZINIL:  SGP4 initialization (OPMODE = 1).  Un-Kozai's no.
+    void zzinil(double j2, double xke, double ecco, double epoch, double inclo, double& no, FInitL& o)
+    {
+        o.eccsq = ecco * ecco;
+        o.omeosq = 1. - o.eccsq;
+        o.rteosq = sqrt(o.omeosq);
+        o.cosio = cos(inclo);
+        o.cosio2 = o.cosio * o.cosio;
+
+        const double ak = pow(xke / no, x2o3);
+        const double d1 = j2 * .75 * (o.cosio2 * 3. - 1.) / (o.rteosq * o.omeosq);
+        double del = d1 / (ak * ak);
+        const double adel = ak * (1. - del * del - del * (del * 134. * del / 81. + .33333333333333331));
+        del = d1 / (adel * adel);
+        no /= del + 1.;
+
+        o.ao = pow(xke / no, x2o3);
+        o.sinio = sin(inclo);
+        const double po = o.ao * o.omeosq;
+        o.con42 = 1. - o.cosio2 * 5.;
+        o.con41 = -o.con42 - o.cosio2 - o.cosio2;
+        o.ainv = 1. / o.ao;
+        o.posq = po * po;
+        o.rp = o.ao * (1. - ecco);
+
+        // AFSPC mode sidereal time
+        const double ts70 = epoch - 7305.;
+        const double ids70 = (double)(int32)(ts70 + 1e-8);
+        const double tfrac = ts70 - ids70;
+        const double c1 = .0172027916940703639;
+        const double thgr70 = 1.7321343856509374;
+        const double fk5r = 5.07551419432269442e-15;
+        const double c1p2p = c1 + twopi;
+        o.gsto = thgr70 + c1 * ids70 + c1p2p * tfrac + ts70 * ts70 * fk5r;
+
+        o.gsto = d_mod(o.gsto, twopi);
+        if (o.gsto < 0.)
+        {
+            o.gsto += twopi;
+        }
+    }
+
+
+    const ANSICHAR* ShortMessage(MaxQ::Orbits::ESGP4Status Status)
+    {
+        using MaxQ::Orbits::ESGP4Status;
+        switch (Status)
+        {
+        case ESGP4Status::NotInitialized: return "SPICE(NOTINITIALIZED)";
+        case ESGP4Status::BadMeanMotion: return "SPICE(BADMEANMOTION)";
+        case ESGP4Status::BadMeanEccentricity: return "SPICE(BADMECCENTRICITY)";
+        case ESGP4Status::BadMeanSemiMajor: return "SPICE(BADMSEMIMAJOR)";
+        case ESGP4Status::BadPerturbedEccentricity: return "SPICE(BADPECCENTRICITY)";
+        case ESGP4Status::BadSemiLatus: return "SPICE(BADSEMILATUS)";
+        case ESGP4Status::Decayed: return "SPICE(ORBITDECAY)";
+        default: return nullptr;
+        }
+    }
+
+    const ANSICHAR* LongMessage(MaxQ::Orbits::ESGP4Status Status)
+    {
+        using MaxQ::Orbits::ESGP4Status;
+        switch (Status)
+        {
+        case ESGP4Status::NotInitialized: return "The SGP4 propagator has not been initialized.";
+        case ESGP4Status::BadMeanMotion: return "Mean motion less-than zero. This error may indicate a bad TLE set.";
+        case ESGP4Status::BadMeanEccentricity: return "Mean eccentricity value beyond allowed bounds [-0.001,1.0). This error may indicate a bad TLE set.";
+        case ESGP4Status::BadMeanSemiMajor: return "Mean semi-major axis value below allowed minimum of 0.95. This error may indicate a bad TLE set or a decayed orbit.";
+        case ESGP4Status::BadPerturbedEccentricity: return "Perturbed eccentricity value beyond allowed bounds [0,1]. This error may indicate a bad TLE set.";
+        case ESGP4Status::BadSemiLatus: return "Semi-latus rectum less-than zero.";
+        case ESGP4Status::Decayed: return "Satellite has decayed.";
+        default: return nullptr;
+        }
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    FSGP4Propagator::FSGP4Propagator(
+        const FSTLEGeophysicalConstants& geophs,
+        const FSTwoLineElements& elems,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Init(geophs, elems, ResultCode, ErrorMessage);
+    }
+
+
+    // XXSGP4I
+    bool FSGP4Propagator::Init(
+        const FSTLEGeophysicalConstants& geophs,
+        const FSTwoLineElements& elems,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        bValid = false;
+        Model = {};
+
+        SpiceDouble _geophs[8]; geophs.CopyTo(_geophs);
+        SpiceDouble _elems[10]; elems.CopyTo(_elems);
+
+        FSGP4Model& m = Model;
+        m.dodeep = false;
+        m.dosimp = false;
+        m.bstar = _elems[2];
+        m.inclo = _elems[3];
+        m.nodeo = _elems[4];
+        m.ecco = _elems[5];
+        m.argpo = _elems[6];
+        m.mo = _elems[7];
+        m.no = _elems[8];
+        m.Epoch = _elems[9];
+
+        // Days since 1950 Jan 0, UTC
+        SpiceDouble tvec[8] = { _elems[9] };
+        ttrans_((char*)"TDB", (char*)"JDUTC", tvec, 3, 5);
+        const double epoch = tvec[0] - 2433281.5;
+
+        if (failed_c())
+        {
+            ErrorCheck(ResultCode, ErrorMessage);
+            return false;
+        }
+
+        m.j2 = _geophs[0];
+        const double j3 = _geophs[1];
+        const double j4 = _geophs[2];
+        m.er = _geophs[6];
+        m.xke = _geophs[3];
+        m.j3oj2 = j3 / m.j2;
+
+        const double ss = 78. / m.er + 1.;
+        double qzms2t = 42. / m.er;
+        qzms2t *= qzms2t;
+        qzms2t *= qzms2t;
+
+        FInitL l;
+        zzinil(m.j2, m.xke, m.ecco, epoch, m.inclo, m.no, l);
+        m.gsto = l.gsto;
+        m.con41 = l.con41;
+
+        if (l.rp < 1.)
+        {
+            setmsg_c("TLE elements suborbital.");
+            sigerr_c("SPICE(SUBORBITAL)");
+            ErrorCheck(ResultCode, ErrorMessage);
+            return false;
+        }
+
+        if (l.omeosq >= 0. || m.no >= 0.)
+        {
+            m.dosimp = l.rp < 220. / m.er + 1.;
+
+            double sfour = ss;
+            double qzms24 = qzms2t;
+            const double perige = (l.rp - 1.) * m.er;
+
+            if (perige < 156.)
+            {
+                sfour = perige - 78.;
+                if (perige <= 98.)
+                {
+                    sfour = 20.;
+                }
+                qzms24 = (120. - sfour) / m.er;
+                qzms24 *= qzms24;
+                qzms24 *= qzms24;
+                sfour = sfour / m.er + 1.;
+            }
+
+            const double pinvsq = 1. / l.posq;
+            const double tsi = 1. / (l.ao - sfour);
+            m.eta = l.ao * m.ecco * tsi;
+            const double etasq = m.eta * m.eta;
+            const double eeta = m.ecco * m.eta;
+            const double psisq = fabs(1. - etasq);
+            const double coef = qzms24 * (tsi * tsi) * (tsi * tsi);
+            const double coef1 = coef / pow(psisq, 3.5);
+            const double cc2 = coef1 * m.no * (l.ao * (etasq * 1.5 + 1. + eeta * (etasq + 4.)) + m.j2 * .375 * tsi / psisq * m.con41 * (etasq * 3. * (etasq + 8.) + 8.));
+            m.cc1 = m.bstar * cc2;
+
+            double cc3 = 0.;
+            if (m.ecco > 1e-4)
+            {
+                cc3 = coef * -2. * tsi * m.j3oj2 * m.no * l.sinio / m.ecco;
+            }
+
+            m.x1mth2 = 1. - l.cosio2;
+            m.cc4 = m.no * 2. * coef1 * l.ao * l.omeosq * (m.eta * (etasq * .5 + 2.) + m.ecco * (etasq * 2. + .5) - m.j2 * tsi / (l.ao * psisq) * (m.con41 * -3. * (1. - eeta * 2. + etasq * (1.5 - eeta * .5)) + m.x1mth2 * .75 * (etasq * 2. - eeta * (etasq + 1.)) * cos(m.argpo * 2.)));
+            m.cc5 = coef1 * 2. * l.ao * l.omeosq * ((etasq + eeta) * 2.75 + 1. + eeta * etasq);
+
+            const double cosio4 = l.cosio2 * l.cosio2;
+            const double temp1 = m.j2 * 1.5 * pinvsq * m.no;
+            const double temp2 = temp1 * .5 * m.j2 * pinvsq;
+            const double temp3 = j4 * -.46875 * pinvsq * pinvsq * m.no;
+            m.mdot = m.no + temp1 * .5 * l.rteosq * m.con41 + temp2 * .0625 * l.rteosq * (13. - l.cosio2 * 78. + cosio4 * 137.);
+            m.argpdot = temp1 * -.5 * l.con42 + temp2 * .0625 * (7. - l.cosio2 * 114. + cosio4 * 395.) + temp3 * (3. - l.cosio2 * 36. + cosio4 * 49.);
+            const double xhdot1 = -temp1 * l.cosio;
+            m.nodedot = xhdot1 + (temp2 * .5 * (4. - l.cosio2 * 19.) + temp3 * 2. * (3. - l.cosio2 * 7.)) * l.cosio;
+            const double xpidot = m.argpdot + m.nodedot;
+            m.omgcof = m.bstar * cc3 * cos(m.argpo);
+
+            m.xmcof = 0.;
+            if (m.ecco > 1e-4)
+            {
+                m.xmcof = -x2o3 * coef * m.bstar / eeta;
+            }
+
+            m.xnodcf = l.omeosq * 3.5 * xhdot1 * m.cc1;
+            m.t2cof = m.cc1 * 1.5;
+
+            if (fabs(l.cosio + 1.) > 1.5e-12)
+            {
+                m.xlcof = m.j3oj2 * -.25 * l.sinio * (l.cosio * 5. + 3.) / (l.cosio + 1.);
+            }
+            else
+            {
+                m.xlcof = m.j3oj2 * -.25 * l.sinio * (l.cosio * 5. + 3.) / temp4;
+            }
+
+            m.aycof = m.j3oj2 * -.5 * l.sinio;
+            const double delmotemp = m.eta * cos(m.mo) + 1.;
+            m.delmo = delmotemp * (delmotemp * delmotemp);
+            m.sinmao = sin(m.mo);
+            m.x7thm1 = l.cosio2 * 7. - 1.;
+
+            if (twopi / m.no >= 225.)
+            {
+                m.dodeep = true;
+                m.dosimp = true;
+
+                FDeepCommon c;
+                zzdscm(epoch, m.ecco, m.argpo, 0., m.inclo, m.nodeo, m.no, c);
+
+                m.e3 = c.e3; m.ee2 = c.ee2;
+                m.peo = c.peo; m.pgho = c.pgho; m.pho = c.pho; m.pinco = c.pinco; m.plo = c.plo;
+                m.se2 = c.se2; m.se3 = c.se3;
+                m.sgh2 = c.sgh2; m.sgh3 = c.sgh3; m.sgh4 = c.sgh4;
+                m.sh2 = c.sh2; m.sh3 = c.sh3;
+                m.si2 = c.si2; m.si3 = c.si3;
+                m.sl2 = c.sl2; m.sl3 = c.sl3; m.sl4 = c.sl4;
+                m.xgh2 = c.xgh2; m.xgh3 = c.xgh3; m.xgh4 = c.xgh4;
+                m.xh2 = c.xh2; m.xh3 = c.xh3;
+                m.xi2 = c.xi2; m.xi3 = c.xi3;
+                m.xl2 = c.xl2; m.xl3 = c.xl3; m.xl4 = c.xl4;
+                m.zmol = c.zmol; m.zmos = c.zmos;
+
+                // (zzdspr with DOINIT = true changes nothing, so it's skipped)
+
+                zzdsin(m, c, l.eccsq, m.inclo);
+            }
+
+            if (!m.dosimp)
+            {
+                const double cc1sq = m.cc1 * m.cc1;
+                m.d2 = l.ao * 4. * tsi * cc1sq;
+                const double temp = m.d2 * tsi * m.cc1 / 3.;
+                m.d3 = (l.ao * 17. + sfour) * temp;
+                m.d4 = temp * .5 * l.ao * tsi * (l.ao * 221. + sfour * 31.) * m.cc1;
+                m.t3cof = m.d2 + cc1sq * 2.;
+                m.t4cof = (m.d3 * 3. + m.cc1 * (m.d2 * 12. + cc1sq * 10.)) * .25;
+                m.t5cof = (m.d4 * 3. + m.cc1 * 12. * m.d3 + m.d2 * 6. * m.d2 + cc1sq * 15. * (m.d2 * 2. + cc1sq)) * .2;
+            }
+        }
+
+        bValid = true;
+        ErrorCheck(ResultCode, ErrorMessage);
+        return bValid;
+    }
+
+
+    // XXSGP4E
+    ESGP4Status FSGP4Propagator::Evaluate(const FSGP4Model& m, double t, double (&state)[6])
+    {
+        const double kps = m.er * m.xke / 60.;
+
+        const double xmdf = m.mo + m.mdot * t;
+        const double omgadf = m.argpo + m.argpdot * t;
+        const double xnoddf = m.nodeo + m.nodedot * t;
+        double argpm = omgadf;
+        double mm = xmdf;
+        const double t2 = t * t;
+        double nodem = xnoddf + m.xnodcf * t2;
+        double tempa = 1. - m.cc1 * t;
+        double tempe = m.bstar * m.cc4 * t;
+        double templ = m.t2cof * t2;
+
+        if (!m.dosimp)
+        {
+            const double delomg = m.omgcof * t;
+            const double delmtemp = m.eta * cos(xmdf) + 1.;
+            const double delm = m.xmcof * (delmtemp * (delmtemp * delmtemp) - m.delmo);
+            const double temp = delomg + delm;
+            mm = xmdf + temp;
+            argpm = omgadf - temp;
+            const double t3 = t2 * t;
+            const double t4 = t3 * t;
+            tempa = tempa - m.d2 * t2 - m.d3 * t3 - m.d4 * t4;
+            tempe += m.bstar * m.cc5 * (sin(mm) - m.sinmao);
+            templ = templ + m.t3cof * t3 + t4 * (m.t4cof + t * m.t5cof);
+        }
+
+        double xn = m.no;
+        double eccm = m.ecco;
+        double inclm = m.inclo;
+
+        if (m.dodeep)
+        {
+            zzdspc(m, t, eccm, argpm, inclm, mm, nodem, xn);
+        }
+
+        if (xn <= 0.)
+        {
+            return ESGP4Status::BadMeanMotion;
+        }
+
+        const double am = pow(m.xke / xn, x2o3) * (tempa * tempa);
+        xn = m.xke / pow(am, 1.5);
+        eccm -= tempe;
+
+        if (eccm >= 1. || eccm < -.001)
+        {
+            return ESGP4Status::BadMeanEccentricity;
+        }
+        if (am < .95)
+        {
+            return ESGP4Status::BadMeanSemiMajor;
+        }
+        if (eccm < 1e-6)
+        {
+            eccm = 1e-6;
+        }
+
+        mm += m.no * templ;
+        double xlm = mm + argpm + nodem;
+        nodem = d_mod(nodem, twopi);
+        argpm = d_mod(argpm, twopi);
+        xlm = d_mod(xlm, twopi);
+        mm = d_mod(xlm - argpm - nodem, twopi);
+
+        const double sinim = sin(inclm);
+        const double cosim = cos(inclm);
+
+        double eccp = eccm;
+        double xincp = inclm;
+        double argpp = argpm;
+        double nodep = nodem;
+        double mp = mm;
+        double sinip = sinim;
+        double cosip = cosim;
+
+        // Can't write these back to the model, like CSPICE does
+        double aycof = m.aycof;
+        double xlcof = m.xlcof;
+        double con41 = m.con41;
+        double x1mth2 = m.x1mth2;
+        double x7thm1 = m.x7thm1;
+
+        if (m.dodeep)
+        {
+            zzdspr(m, t, eccp, xincp, nodep, argpp, mp);
+
+            if (xincp < 0.)
+            {
+                xincp = -xincp;
+                nodep += pi;
+                argpp -= pi;
+            }
+
+            if (eccp < 0. || eccp > 1.)
+            {
+                return ESGP4Status::BadPerturbedEccentricity;
+            }
+
+            sinip = sin(xincp);
+            cosip = cos(xincp);
+            aycof = m.j3oj2 * -.5 * sinip;
+
+            if (fabs(cosip + 1.) > 1.5e-12)
+            {
+                xlcof = m.j3oj2 * -.25 * sinip * (cosip * 5. + 3.) / (cosip + 1.);
+            }
+            else
+            {
+                xlcof = m.j3oj2 * -.25 * sinip * (cosip * 5. + 3.) / temp4;
+            }
+        }
+
+        const double axnl = eccp * cos(argpp);
+        double temp = 1. / (am * (1. - eccp * eccp));
+        const double aynl = eccp * sin(argpp) + temp * aycof;
+        const double xl = mp + argpp + nodep + temp * xlcof * axnl;
+
+        // Kepler's equation
+        const double u = d_mod(xl - nodep, twopi);
+        double eo1 = u;
+        double sineo1 = 0.;
+        double coseo1 = 1.;
+        int iter = 0;
+        temp = 9999.9;
+        while (temp >= 1e-12 && iter < 10)
+        {
+            ++iter;
+            sineo1 = sin(eo1);
+            coseo1 = cos(eo1);
+            double tem5 = 1. - coseo1 * axnl - sineo1 * aynl;
+            tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+            temp = fabs(tem5);
+            if (temp > 1.)
+            {
+                tem5 /= temp;
+            }
+            eo1 += tem5;
+        }
+
+        const double ecose = axnl * coseo1 + aynl * sineo1;
+        const double esine = axnl * sineo1 - aynl * coseo1;
+        const double el2 = axnl * axnl + aynl * aynl;
+        const double pl = am * (1. - el2);
+
+        if (pl < 0.)
+        {
+            return ESGP4Status::BadSemiLatus;
+        }
+
+        const double rl = am * (1. - ecose);
+        const double rdotl = sqrt(am) * esine / rl;
+        const double rvdotl = sqrt(pl) / rl;
+        const double betal = sqrt(1. - el2);
+        temp = esine / (betal + 1.);
+        const double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+        const double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+        double su = atan2(sinu, cosu);
+        const double sin2u = (cosu + cosu) * sinu;
+        const double cos2u = 1. - sinu * 2. * sinu;
+        temp = 1. / pl;
+        const double temp1 = m.j2 * .5 * temp;
+        const double temp2 = temp1 * temp;
+
+        if (m.dodeep)
+        {
+            const double cosisq = cosip * cosip;
+            con41 = cosisq * 3. - 1.;
+            x1mth2 = 1. - cosisq;
+            x7thm1 = cosisq * 7. - 1.;
+        }
+
+        const double mr = rl * (1. - temp2 * 1.5 * betal * con41) + temp1 * .5 * x1mth2 * cos2u;
+        su -= temp2 * .25 * x7thm1 * sin2u;
+        const double xnode = nodep + temp2 * 1.5 * cosip * sin2u;
+        const double xinc = xincp + temp2 * 1.5 * cosip * sinip * cos2u;
+        const double mv = rdotl - xn * temp1 * x1mth2 * sin2u / m.xke;
+        const double rvdot = rvdotl + xn * temp1 * (x1mth2 * cos2u + con41 * 1.5) / m.xke;
+
+        const double sinsu = sin(su);
+        const double cossu = cos(su);
+        const double snod = sin(xnode);
+        const double cnod = cos(xnode);
+        const double sini = sin(xinc);
+        const double cosi = cos(xinc);
+        const double xmx = -snod * cosi;
+        const double xmy = cnod * cosi;
+        const double ux = xmx * sinsu + cnod * cossu;
+        const double uy = xmy * sinsu + snod * cossu;
+        const double uz = sini * sinsu;
+        const double vx = xmx * cossu - cnod * sinsu;
+        const double vy = xmy * cossu - snod * sinsu;
+        const double vz = sini * cossu;
+
+        state[0] = mr * ux * m.er;
+        state[1] = mr * uy * m.er;
+        state[2] = mr * uz * m.er;
+        state[3] = (mv * ux + rvdot * vx) * kps;
+        state[4] = (mv * uy + rvdot * vy) * kps;
+        state[5] = (mv * uz + rvdot * vz) * kps;
+
+        if (mr < 1.)
+        {
+            return ESGP4Status::Decayed;
+        }
+
+        return ESGP4Status::Ok;
+    }
+
+
+    ESGP4Status FSGP4Propagator::Propagate(double et, double (&state)[6]) const
+    {
+        if (!bValid)
+        {
+            return ESGP4Status::NotInitialized;
+        }
+
+        return Evaluate(Model, (et - Model.Epoch) / 60., state);
+    }
+
+
+    void FSGP4Propagator::Propagate(
+        const FSEphemerisTime& et,
+        FSStateVector& state,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    ) const
+    {
+        MAXQ_SGP4_SCOPE(1);
+
+        double _state[6];
+        state.CopyTo(_state);
+
+        ESGP4Status Status = Propagate(et.AsSpiceDouble(), _state);
+        state = FSStateVector(_state);
+
+        if (Status != ESGP4Status::Ok)
+        {
+            setmsg_c(LongMessage(Status));
+            sigerr_c(ShortMessage(Status));
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    int32 PropagateCatalog(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FSEphemerisTime& et,
+        FSGP4CatalogStates& OutStates,
+        bool bVelocities
+    )
+    {
+        // Enough work per task to amortize the scheduling
+        constexpr int32 BatchSize = 256;
+
+        const int32 Num = Catalog.Num();
+        MAXQ_SGP4_SCOPE(Num);
+
+        OutStates.X.SetNumUninitialized(Num);
+        OutStates.Y.SetNumUninitialized(Num);
+        OutStates.Z.SetNumUninitialized(Num);
+        OutStates.Status.SetNumUninitialized(Num);
+        OutStates.VX.SetNumUninitialized(bVelocities ? Num : 0);
+        OutStates.VY.SetNumUninitialized(bVelocities ? Num : 0);
+        OutStates.VZ.SetNumUninitialized(bVelocities ? Num : 0);
+
+        const double _et = et.AsSpiceDouble();
+        const int32 NumBatches = (Num + BatchSize - 1) / BatchSize;
+        TArray<int32> Succeeded;
+        Succeeded.SetNumZeroed(NumBatches);
+
+        ParallelFor(NumBatches, [&](int32 Batch)
+        {
+            const int32 First = Batch * BatchSize;
+            const int32 Last = FMath::Min(First + BatchSize, Num);
+
+            int32 Count = 0;
+            for (int32 i = First; i < Last; ++i)
+            {
+                double state[6] = { 0., 0., 0., 0., 0., 0. };
+                const ESGP4Status Status = Catalog[i].Propagate(_et, state);
+
+                OutStates.X[i] = state[0];
+                OutStates.Y[i] = state[1];
+                OutStates.Z[i] = state[2];
+                if (bVelocities)
+                {
+                    OutStates.VX[i] = state[3];
+                    OutStates.VY[i] = state[4];
+                    OutStates.VZ[i] = state[5];
+                }
+                OutStates.Status[i] = Status;
+                Count += Status == ESGP4Status::Ok;
+            }
+            Succeeded[Batch] = Count;
+        });
+
+        int32 Total = 0;
+        for (int32 Count : Succeeded)
+        {
+            Total += Count;
+        }
+        return Total;
+    }
+}
@@ -0,0 +1,506 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSGP4Batch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  SGP4 propagation of whole catalogs, several satellites per lane.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSGP4Batch.cpp is part of the "refined C++ API".
+//
+// EvaluateLanes is FSGP4Propagator::Evaluate (near earth branch only), with
+// every statement turned into a loop over the lanes.  Keep the two in sync.
+// Branches become selects, so each lane computes exactly what the scalar code
+// would have.  The only real loop, Kepler's equation, freezes lanes as they
+// converge.
+//------------------------------------------------------------------------------
+
+#include "SpiceSGP4Batch.h"
+#include "SpiceMemory.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    using namespace MaxQ::Orbits;
+
+    constexpr int32 W = FSGP4BatchPropagator::Lanes;
+    constexpr double twopi = 2. * 3.14159265358979323846;
+    constexpr double x2o3 = .66666666666666663;
+
+    // Rows per ParallelFor task
+    constexpr int32 BatchRows = 256;
+    static_assert(BatchRows % W == 0, "BatchRows must be a multiple of the lane width");
+
+    // Fortran MOD (as f2c's d_mod)
+    inline double d_mod(double x, double y)
+    {
+        double quotient = x / y;
+        quotient = quotient >= 0 ? floor(quotient) : -floor(-quotient);
+        return x - y * quotient;
+    }
+
+    // Pointers to one lane-group's worth of each column
+    struct FLaneModel
+    {
+        const double *Epoch, *mo, *mdot, *argpo, *argpdot, *nodeo, *nodedot, *xnodcf, *cc1, *cc4, *cc5;
+        const double *bstar, *t2cof, *t3cof, *t4cof, *t5cof, *omgcof, *eta, *xmcof, *delmo, *sinmao;
+        const double *d2, *d3, *d4, *no, *ecco, *inclo, *sinio, *cosio, *aycof, *xlcof, *con41, *x1mth2;
+        const double *x7thm1, *j2, *xke, *er, *simp;
+    };
+
+    // XXSGP4E, near earth, W satellites at a time
+    void EvaluateLanes(const FLaneModel& m, double et, double (&state)[6][W], ESGP4Status (&status)[W])
+    {
+        double t[W], xmdf[W], omgadf[W], argpm[W], mm[W], nodem[W], tempa[W], tempe[W], templ[W];
+
+        for (int32 l = 0; l < W; ++l)
+        {
+            t[l] = (et - m.Epoch[l]) / 60.;
+            xmdf[l] = m.mo[l] + m.mdot[l] * t[l];
+            omgadf[l] = m.argpo[l] + m.argpdot[l] * t[l];
+            const double xnoddf = m.nodeo[l] + m.nodedot[l] * t[l];
+            const double t2 = t[l] * t[l];
+            nodem[l] = xnoddf + m.xnodcf[l] * t2;
+            tempa[l] = 1. - m.cc1[l] * t[l];
+            tempe[l] = m.bstar[l] * m.cc4[l] * t[l];
+            templ[l] = m.t2cof[l] * t2;
+        }
+
+        // (!dosimp)
+        for (int32 l = 0; l < W; ++l)
+        {
+            const double t2 = t[l] * t[l];
+            const double delomg = m.omgcof[l] * t[l];
+            const double delmtemp = m.eta[l] * cos(xmdf[l]) + 1.;
+            const double delm = m.xmcof[l] * (delmtemp * (delmtemp * delmtemp) - m.delmo[l]);
+            const double temp = delomg + delm;
+            const double mmfull = xmdf[l] + temp;
+            const double t3 = t2 * t[l];
+            const double t4 = t3 * t[l];
+            const double tempafull = tempa[l] - m.d2[l] * t2 - m.d3[l] * t3 - m.d4[l] * t4;
+            const double tempefull = tempe[l] + m.bstar[l] * m.cc5[l] * (sin(mmfull) - m.sinmao[l]);
+            const double templfull = templ[l] + m.t3cof[l] * t3 + t4 * (m.t4cof[l] + t[l] * m.t5cof[l]);
+
+            const bool bSimp = m.simp[l] != 0.;
+            mm[l] = bSimp ? xmdf[l] : mmfull;
+            argpm[l] = bSimp ? omgadf[l] : omgadf[l] - temp;
+            tempa[l] = bSimp ? tempa[l] : tempafull;
+            tempe[l] = bSimp ? tempe[l] : tempefull;
+            templ[l] = bSimp ? templ[l] : templfull;
+        }
+
+        double am[W], xn[W], eccm[W];
+        for (int32 l = 0; l < W; ++l)
+        {
+            status[l] = m.no[l] <= 0. ? ESGP4Status::BadMeanMotion : ESGP4Status::Ok;
+
+            am[l] = pow(m.xke[l] / m.no[l], x2o3) * (tempa[l] * tempa[l]);
+            xn[l] = m.xke[l] / pow(am[l], 1.5);
+            eccm[l] = m.ecco[l] - tempe[l];
+
+            if (status[l] == ESGP4Status::Ok && (eccm[l] >= 1. || eccm[l] < -.001))
+            {
+                status[l] = ESGP4Status::BadMeanEccentricity;
+            }
+            if (status[l] == ESGP4Status::Ok && am[l] < .95)
+            {
+                status[l] = ESGP4Status::BadMeanSemiMajor;
+            }
+            eccm[l] = eccm[l] < 1e-6 ? 1e-6 : eccm[l];
+        }
+
+        double axnl[W], aynl[W], u[W];
+        for (int32 l = 0; l < W; ++l)
+        {
+            mm[l] += m.no[l] * templ[l];
+            double xlm = mm[l] + argpm[l] + nodem[l];
+            nodem[l] = d_mod(nodem[l], twopi);
+            argpm[l] = d_mod(argpm[l], twopi);
+            xlm = d_mod(xlm, twopi);
+            mm[l] = d_mod(xlm - argpm[l] - nodem[l], twopi);
+
+            // (eccp = eccm, etc, near earth)
+            axnl[l] = eccm[l] * cos(argpm[l]);
+            const double temp = 1. / (am[l] * (1. - eccm[l] * eccm[l]));
+            aynl[l] = eccm[l] * sin(argpm[l]) + temp * m.aycof[l];
+            const double xl = mm[l] + argpm[l] + nodem[l] + temp * m.xlcof[l] * axnl[l];
+            u[l] = d_mod(xl - nodem[l], twopi);
+        }
+
+        // Kepler's equation
+        double eo1[W], sineo1[W], coseo1[W];
+        bool bActive[W];
+        for (int32 l = 0; l < W; ++l)
+        {
+            eo1[l] = u[l];
+            sineo1[l] = 0.;
+            coseo1[l] = 1.;
+            bActive[l] = true;
+        }
+
+        for (int32 iter = 0; iter < 10; ++iter)
+        {
+            bool bAny = false;
+            for (int32 l = 0; l < W; ++l)
+            {
+                const double s = sin(eo1[l]);
+                const double c = cos(eo1[l]);
+                double tem5 = 1. - c * axnl[l] - s * aynl[l];
+                tem5 = (u[l] - aynl[l] * c + axnl[l] * s - eo1[l]) / tem5;
+                const double temp = fabs(tem5);
+                tem5 = temp > 1. ? tem5 / temp : tem5;
+
+                eo1[l] = bActive[l] ? eo1[l] + tem5 : eo1[l];
+                sineo1[l] = bActive[l] ? s : sineo1[l];
+                coseo1[l] = bActive[l] ? c : coseo1[l];
+                bActive[l] = bActive[l] && temp >= 1e-12;
+                bAny |= bActive[l];
+            }
+
+            if (!bAny)
+            {
+                break;
+            }
+        }
+
+        for (int32 l = 0; l < W; ++l)
+        {
+            const double ecose = axnl[l] * coseo1[l] + aynl[l] * sineo1[l];
+            const double esine = axnl[l] * sineo1[l] - aynl[l] * coseo1[l];
+            const double el2 = axnl[l] * axnl[l] + aynl[l] * aynl[l];
+            const double pl = am[l] * (1. - el2);
+
+            if (status[l] == ESGP4Status::Ok && pl < 0.)
+            {
+                status[l] = ESGP4Status::BadSemiLatus;
+            }
+
+            const double rl = am[l] * (1. - ecose);
+            const double rdotl = sqrt(am[l]) * esine / rl;
+            const double rvdotl = sqrt(pl) / rl;
+            const double betal = sqrt(1. - el2);
+            double temp = esine / (betal + 1.);
+            const double sinu = am[l] / rl * (sineo1[l] - aynl[l] - axnl[l] * temp);
+            const double cosu = am[l] / rl * (coseo1[l] - axnl[l] + aynl[l] * temp);
+            double su = atan2(sinu, cosu);
+            const double sin2u = (cosu + cosu) * sinu;
+            const double cos2u = 1. - sinu * 2. * sinu;
+            temp = 1. / pl;
+            const double temp1 = m.j2[l] * .5 * temp;
+            const double temp2 = temp1 * temp;
+
+            const double cosip = m.cosio[l];
+            const double sinip = m.sinio[l];
+            const double mr = rl * (1. - temp2 * 1.5 * betal * m.con41[l]) + temp1 * .5 * m.x1mth2[l] * cos2u;
+            su -= temp2 * .25 * m.x7thm1[l] * sin2u;
+            const double xnode = nodem[l] + temp2 * 1.5 * cosip * sin2u;
+            const double xinc = m.inclo[l] + temp2 * 1.5 * cosip * sinip * cos2u;
+            const double mv = rdotl - xn[l] * temp1 * m.x1mth2[l] * sin2u / m.xke[l];
+            const double rvdot = rvdotl + xn[l] * temp1 * (m.x1mth2[l] * cos2u + m.con41[l] * 1.5) / m.xke[l];
+
+            const double sinsu = sin(su);
+            const double cossu = cos(su);
+            const double snod = sin(xnode);
+            const double cnod = cos(xnode);
+            const double sini = sin(xinc);
+            const double cosi = cos(xinc);
+            const double xmx = -snod * cosi;
+            const double xmy = cnod * cosi;
+            const double ux = xmx * sinsu + cnod * cossu;
+            const double uy = xmy * sinsu + snod * cossu;
+            const double uz = sini * sinsu;
+            const double vx = xmx * cossu - cnod * sinsu;
+            const double vy = xmy * cossu - snod * sinsu;
+            const double vz = sini * cossu;
+
+            const double kps = m.er[l] * m.xke[l] / 60.;
+
+            // Lanes that failed before the state was computed get zeros (as the
+            // scalar version leaves them).  Decayed lanes still get a state.
+            const bool bWrite = status[l] == ESGP4Status::Ok;
+            state[0][l] = bWrite ? mr * ux * m.er[l] : 0.;
+            state[1][l] = bWrite ? mr * uy * m.er[l] : 0.;
+            state[2][l] = bWrite ? mr * uz * m.er[l] : 0.;
+            state[3][l] = bWrite ? (mv * ux + rvdot * vx) * kps : 0.;
+            state[4][l] = bWrite ? (mv * uy + rvdot * vy) * kps : 0.;
+            state[5][l] = bWrite ? (mv * uz + rvdot * vz) * kps : 0.;
+
+            if (bWrite && mr < 1.)
+            {
+                status[l] = ESGP4Status::Decayed;
+            }
+        }
+    }
+
+    inline void Store(FSGP4CatalogStates& Out, int32 i, const double (&state)[6], ESGP4Status Status, bool bVelocities)
+    {
+        Out.X[i] = state[0];
+        Out.Y[i] = state[1];
+        Out.Z[i] = state[2];
+        if (bVelocities)
+        {
+            Out.VX[i] = state[3];
+            Out.VY[i] = state[4];
+            Out.VZ[i] = state[5];
+        }
+        Out.Status[i] = Status;
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    void FSGP4BatchPropagator::Build(TArrayView<const FSGP4Propagator> Catalog)
+    {
+        TArray<FSGP4Model> Models;
+        TArray<bool> Valid;
+        Models.Reserve(Catalog.Num());
+        Valid.Reserve(Catalog.Num());
+        for (const FSGP4Propagator& Propagator : Catalog)
+        {
+            Models.Add(Propagator.GetModel());
+            Valid.Add(Propagator.IsValid());
+        }
+
+        Build(Models, Valid);
+    }
+
+
+    void FSGP4BatchPropagator::Build(TArrayView<const FSGP4Model> Models)
+    {
+        TArray<bool> Valid;
+        Valid.Init(true, Models.Num());
+
+        Build(Models, Valid);
+    }
+
+
+    void FSGP4BatchPropagator::Build(TArrayView<const FSGP4Model> Models, TArrayView<const bool> Valid)
+    {
+        MAXQ_LLM_SCOPE();
+
+        Reset();
+
+        NumObjects = Models.Num();
+
+        TArray<int32> Batched;
+        for (int32 i = 0; i < NumObjects; ++i)
+        {
+            if (Valid[i] && !Models[i].dodeep)
+            {
+                Batched.Add(i);
+            }
+            else
+            {
+                ScalarModels.Add(Models[i]);
+                ScalarIndex.Add(i);
+                ScalarValid.Add(Valid[i]);
+            }
+        }
+
+        if (Batched.Num() == 0)
+        {
+            return;
+        }
+
+        Rows = Align(Batched.Num(), W);
+        NumPadding = Rows - Batched.Num();
+        Columns.SetNumZeroed(NumColumns * Rows);
+        Index.SetNumUninitialized(Rows);
+
+        for (int32 Row = 0; Row < Rows; ++Row)
+        {
+            // Padding lanes repeat the last model, so they don't produce NaNs
+            const bool bPadding = Row >= Batched.Num();
+            const int32 i = Batched[bPadding ? Batched.Num() - 1 : Row];
+            AddRow(Models[i], Row);
+            Index[Row] = bPadding ? INDEX_NONE : i;
+        }
+    }
+
+
+    void FSGP4BatchPropagator::AddRow(const FSGP4Model& m, int32 Row)
+    {
+        Column(EColumn::Epoch)[Row] = m.Epoch;
+        Column(EColumn::mo)[Row] = m.mo;
+        Column(EColumn::mdot)[Row] = m.mdot;
+        Column(EColumn::argpo)[Row] = m.argpo;
+        Column(EColumn::argpdot)[Row] = m.argpdot;
+        Column(EColumn::nodeo)[Row] = m.nodeo;
+        Column(EColumn::nodedot)[Row] = m.nodedot;
+        Column(EColumn::xnodcf)[Row] = m.xnodcf;
+        Column(EColumn::cc1)[Row] = m.cc1;
+        Column(EColumn::cc4)[Row] = m.cc4;
+        Column(EColumn::cc5)[Row] = m.cc5;
+        Column(EColumn::bstar)[Row] = m.bstar;
+        Column(EColumn::t2cof)[Row] = m.t2cof;
+        Column(EColumn::t3cof)[Row] = m.t3cof;
+        Column(EColumn::t4cof)[Row] = m.t4cof;
+        Column(EColumn::t5cof)[Row] = m.t5cof;
+        Column(EColumn::omgcof)[Row] = m.omgcof;
+        Column(EColumn::eta)[Row] = m.eta;
+        Column(EColumn::xmcof)[Row] = m.xmcof;
+        Column(EColumn::delmo)[Row] = m.delmo;
+        Column(EColumn::sinmao)[Row] = m.sinmao;
+        Column(EColumn::d2)[Row] = m.d2;
+        Column(EColumn::d3)[Row] = m.d3;
+        Column(EColumn::d4)[Row] = m.d4;
+        Column(EColumn::no)[Row] = m.no;
+        Column(EColumn::ecco)[Row] = m.ecco;
+        Column(EColumn::inclo)[Row] = m.inclo;
+        Column(EColumn::sinio)[Row] = sin(m.inclo);
+        Column(EColumn::cosio)[Row] = cos(m.inclo);
+        Column(EColumn::aycof)[Row] = m.aycof;
+        Column(EColumn::xlcof)[Row] = m.xlcof;
+        Column(EColumn::con41)[Row] = m.con41;
+        Column(EColumn::x1mth2)[Row] = m.x1mth2;
+        Column(EColumn::x7thm1)[Row] = m.x7thm1;
+        Column(EColumn::j2)[Row] = m.j2;
+        Column(EColumn::xke)[Row] = m.xke;
+        Column(EColumn::er)[Row] = m.er;
+        Column(EColumn::simp)[Row] = m.dosimp ? 1. : 0.;
+    }
+
+
+    void FSGP4BatchPropagator::Reset()
+    {
+        Columns.Empty();
+        Rows = 0;
+        Index.Empty();
+        NumPadding = 0;
+        ScalarModels.Empty();
+        ScalarIndex.Empty();
+        ScalarValid.Empty();
+        NumObjects = 0;
+    }
+
+
+    SIZE_T FSGP4BatchPropagator::GetAllocatedSize() const
+    {
+        return Columns.GetAllocatedSize() + Index.GetAllocatedSize() + ScalarModels.GetAllocatedSize() + ScalarIndex.GetAllocatedSize() + ScalarValid.GetAllocatedSize();
+    }
+
+
+    int32 FSGP4BatchPropagator::Propagate(const FSEphemerisTime& et, FSGP4CatalogStates& OutStates, bool bVelocities) const
+    {
+        OutStates.X.SetNumUninitialized(NumObjects);
+        OutStates.Y.SetNumUninitialized(NumObjects);
+        OutStates.Z.SetNumUninitialized(NumObjects);
+        OutStates.Status.SetNumUninitialized(NumObjects);
+        OutStates.VX.SetNumUninitialized(bVelocities ? NumObjects : 0);
+        OutStates.VY.SetNumUninitialized(bVelocities ? NumObjects : 0);
+        OutStates.VZ.SetNumUninitialized(bVelocities ? NumObjects : 0);
+
+        const double _et = et.AsSpiceDouble();
+        const int32 NumRowTasks = (Rows + BatchRows - 1) / BatchRows;
+        const int32 NumScalarTasks = (ScalarModels.Num() + BatchRows - 1) / BatchRows;
+
+        TArray<int32> Succeeded;
+        Succeeded.SetNumZeroed(NumRowTasks + NumScalarTasks);
+
+        ParallelFor(NumRowTasks + NumScalarTasks, [&](int32 Task)
+        {
+            int32 Count = 0;
+
+            if (Task < NumRowTasks)
+            {
+                const int32 First = Task * BatchRows;
+                const int32 Last = FMath::Min(First + BatchRows, Rows);
+
+                for (int32 Row = First; Row < Last; Row += W)
+                {
+                    FLaneModel m;
+                    m.Epoch = Column(EColumn::Epoch) + Row;
+                    m.mo = Column(EColumn::mo) + Row;
+                    m.mdot = Column(EColumn::mdot) + Row;
+                    m.argpo = Column(EColumn::argpo) + Row;
+                    m.argpdot = Column(EColumn::argpdot) + Row;
+                    m.nodeo = Column(EColumn::nodeo) + Row;
+                    m.nodedot = Column(EColumn::nodedot) + Row;
+                    m.xnodcf = Column(EColumn::xnodcf) + Row;
+                    m.cc1 = Column(EColumn::cc1) + Row;
+                    m.cc4 = Column(EColumn::cc4) + Row;
+                    m.cc5 = Column(EColumn::cc5) + Row;
+                    m.bstar = Column(EColumn::bstar) + Row;
+                    m.t2cof = Column(EColumn::t2cof) + Row;
+                    m.t3cof = Column(EColumn::t3cof) + Row;
+                    m.t4cof = Column(EColumn::t4cof) + Row;
+                    m.t5cof = Column(EColumn::t5cof) + Row;
+                    m.omgcof = Column(EColumn::omgcof) + Row;
+                    m.eta = Column(EColumn::eta) + Row;
+                    m.xmcof = Column(EColumn::xmcof) + Row;
+                    m.delmo = Column(EColumn::delmo) + Row;
+                    m.sinmao = Column(EColumn::sinmao) + Row;
+                    m.d2 = Column(EColumn::d2) + Row;
+                    m.d3 = Column(EColumn::d3) + Row;
+                    m.d4 = Column(EColumn::d4) + Row;
+                    m.no = Column(EColumn::no) + Row;
+                    m.ecco = Column(EColumn::ecco) + Row;
+                    m.inclo = Column(EColumn::inclo) + Row;
+                    m.sinio = Column(EColumn::sinio) + Row;
+                    m.cosio = Column(EColumn::cosio) + Row;
+                    m.aycof = Column(EColumn::aycof) + Row;
+                    m.xlcof = Column(EColumn::xlcof) + Row;
+                    m.con41 = Column(EColumn::con41) + Row;
+                    m.x1mth2 = Column(EColumn::x1mth2) + Row;
+                    m.x7thm1 = Column(EColumn::x7thm1) + Row;
+                    m.j2 = Column(EColumn::j2) + Row;
+                    m.xke = Column(EColumn::xke) + Row;
+                    m.er = Column(EColumn::er) + Row;
+                    m.simp = Column(EColumn::simp) + Row;
+
+                    double state[6][W];
+                    ESGP4Status status[W];
+                    EvaluateLanes(m, _et, state, status);
+
+                    for (int32 l = 0; l < W; ++l)
+                    {
+                        const int32 i = Index[Row + l];
+                        if (i == INDEX_NONE) continue;
+
+                        const double s[6] = { state[0][l], state[1][l], state[2][l], state[3][l], state[4][l], state[5][l] };
+                        Store(OutStates, i, s, status[l], bVelocities);
+                        Count += status[l] == ESGP4Status::Ok;
+                    }
+                }
+            }
+            else
+            {
+                const int32 First = (Task - NumRowTasks) * BatchRows;
+                const int32 Last = FMath::Min(First + BatchRows, ScalarModels.Num());
+
+                for (int32 j = First; j < Last; ++j)
+                {
+                    double state[6] = { 0., 0., 0., 0., 0., 0. };
+                    const ESGP4Status Status = ScalarValid[j]
+                        ? FSGP4Propagator::Evaluate(ScalarModels[j], (_et - ScalarModels[j].Epoch) / 60., state)
+                        : ESGP4Status::NotInitialized;
+
+                    Store(OutStates, ScalarIndex[j], state, Status, bVelocities);
+                    Count += Status == ESGP4Status::Ok;
+                }
+            }
+
+            Succeeded[Task] = Count;
+        });
+
+        int32 Total = 0;
+        for (int32 Count : Succeeded)
+        {
+            Total += Count;
+        }
+        return Total;
+    }
+}
@@ -0,0 +1,302 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceScheduler.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Prioritized MaxQ jobs, with per-class core budgets.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceScheduler.cpp is part of the "refined C++ API".
+//
+// The scheduler only decides what may start.  Everything it starts is
+// handed straight to the UE task system (or a process pool dispatch), so
+// there's no thread of its own:  queues are pumped when a job's added and
+// when one finishes, under one lock, and jobs are started outside it.
+// Queues are short (jobs are coarse), so picking the next job is a scan.
+//------------------------------------------------------------------------------
+
+#include "SpiceScheduler.h"
+#include "SpiceLock.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/Event.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
+
+FSpiceScheduler* FSpiceScheduler::Instance = nullptr;
+FCriticalSection FSpiceScheduler::InstanceLock;
+
+namespace
+{
+    UE::Tasks::ETaskPriority TaskPriority(int32 Class)
+    {
+        switch ((ESpiceJobClass)Class)
+        {
+        case ESpiceJobClass::FrameCritical:
+            return UE::Tasks::ETaskPriority::High;
+        case ESpiceJobClass::Interactive:
+            return UE::Tasks::ETaskPriority::Normal;
+        default:
+            return UE::Tasks::ETaskPriority::BackgroundNormal;
+        }
+    }
+}
+
+
+FSpiceScheduler& FSpiceScheduler::Get()
+{
+    // Double checked, so the common case doesn't take the lock.
+    FSpiceScheduler* Scheduler = Instance;
+    if (Scheduler == nullptr)
+    {
+        FScopeLock ScopeLock(&InstanceLock);
+        if (Instance == nullptr)
+        {
+            Scheduler = new FSpiceScheduler();
+            FPlatformMisc::MemoryBarrier();
+            Instance = Scheduler;
+        }
+        Scheduler = Instance;
+    }
+
+    return *Scheduler;
+}
+
+
+void FSpiceScheduler::Shutdown()
+{
+    FScopeLock ScopeLock(&InstanceLock);
+
+    if (Instance != nullptr)
+    {
+        delete Instance;
+        Instance = nullptr;
+    }
+}
+
+
+FSpiceScheduler::FSpiceScheduler()
+{
+    const int32 Workers = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+    Budgets[(int32)ESpiceJobClass::FrameCritical] = Workers;
+    Budgets[(int32)ESpiceJobClass::Interactive] = Workers;
+    Budgets[(int32)ESpiceJobClass::Background] = FMath::Max(1, Workers / 2);
+
+    Idle = FPlatformProcess::GetSynchEventFromPool(true);
+    Idle->Trigger();
+}
+
+
+FSpiceScheduler::~FSpiceScheduler()
+{
+    Idle->Wait();
+    FPlatformProcess::ReturnSynchEventToPool(Idle);
+}
+
+
+void FSpiceScheduler::SetBudget(ESpiceJobClass Class, int32 Budget)
+{
+    {
+        FScopeLock ScopeLock(&Lock);
+        Budgets[(int32)Class] = FMath::Max(1, Budget);
+    }
+
+    Pump();
+}
+
+
+int32 FSpiceScheduler::GetBudget(ESpiceJobClass Class) const
+{
+    FScopeLock ScopeLock(&Lock);
+    return Budgets[(int32)Class];
+}
+
+
+int32 FSpiceScheduler::NumQueued(ESpiceJobClass Class) const
+{
+    FScopeLock ScopeLock(&Lock);
+    return Queues[(int32)Class].Num();
+}
+
+
+int32 FSpiceScheduler::NumRunning(ESpiceJobClass Class) const
+{
+    FScopeLock ScopeLock(&Lock);
+    return Running[(int32)Class];
+}
+
+
+TFuture<FSpiceJobResult> FSpiceScheduler::Dispatch(ESpiceJobClass Class, FName JobName, TArray<uint8>&& Request)
+{
+    if (!FSpiceProcessPool::Get().IsStarted())
+    {
+        return Launch(Class, [JobName, Request = MoveTemp(Request)]()
+        {
+            FSpiceJobResult Result;
+            if (const FSpiceJobHandler* Handler = FSpiceProcessPool::FindJob(JobName))
+            {
+                Result.bSuccess = (*Handler)(Request, Result.Response, Result.ErrorMessage);
+            }
+            else
+            {
+                Result.ErrorMessage = FString::Printf(TEXT("MaxQ job %s is not registered"), *JobName.ToString());
+            }
+            return Result;
+        }, ESpiceJobResource::Spice);
+    }
+
+    TSharedRef<TPromise<FSpiceJobResult>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<FSpiceJobResult>, ESPMode::ThreadSafe>();
+    TFuture<FSpiceJobResult> Future = Promise->GetFuture();
+
+    EnqueueAsync(Class, ESpiceJobResource::ProcessPool,
+        [Promise, JobName, Request = MoveTemp(Request)](FFinished&& Finished) mutable
+        {
+            FSpiceProcessPool::Get().Dispatch(JobName, MoveTemp(Request)).Then(
+                [Promise, Finished = MoveTemp(Finished)](TFuture<FSpiceJobResult> Result) mutable
+                {
+                    // Free the worker before the caller hears, so its next
+                    // dispatch can have it
+                    Finished();
+                    Promise->SetValue(Result.Get());
+                }
+            );
+        }
+    );
+
+    return Future;
+}
+
+
+void FSpiceScheduler::Enqueue(ESpiceJobClass Class, ESpiceJobResource Resource, TUniqueFunction<void()>&& Work)
+{
+    Add(Class, FJob{ Resource, MoveTemp(Work), FStart() });
+}
+
+
+void FSpiceScheduler::EnqueueAsync(ESpiceJobClass Class, ESpiceJobResource Resource, FStart&& Start)
+{
+    Add(Class, FJob{ Resource, TUniqueFunction<void()>(), MoveTemp(Start) });
+}
+
+
+void FSpiceScheduler::Add(ESpiceJobClass Class, FJob&& Job)
+{
+    {
+        FScopeLock ScopeLock(&Lock);
+
+        if (Outstanding++ == 0)
+        {
+            Idle->Reset();
+        }
+        Queues[(int32)Class].Add(MoveTemp(Job));
+    }
+
+    Pump();
+}
+
+
+int32 FSpiceScheduler::Capacity(ESpiceJobResource Resource) const
+{
+    switch (Resource)
+    {
+    case ESpiceJobResource::Spice:
+        return 1;
+    case ESpiceJobResource::ProcessPool:
+        return FMath::Max(1, FSpiceProcessPool::Get().NumWorkers());
+    default:
+        return MAX_int32;
+    }
+}
+
+
+void FSpiceScheduler::Pump()
+{
+    TArray<TTuple<int32, FJob>, TInlineAllocator<8>> Ready;
+
+    {
+        FScopeLock ScopeLock(&Lock);
+
+        // Highest class first, so it has first claim on the resources
+        for (int32 Class = 0; Class < (int32)ESpiceJobClass::Num; ++Class)
+        {
+            TArray<FJob>& Queue = Queues[Class];
+            for (int32 i = 0; i < Queue.Num() && Running[Class] < Budgets[Class];)
+            {
+                const int32 Resource = (int32)Queue[i].Resource;
+                if (InUse[Resource] < Capacity(Queue[i].Resource))
+                {
+                    ++Running[Class];
+                    ++InUse[Resource];
+                    Ready.Emplace(Class, MoveTemp(Queue[i]));
+                    Queue.RemoveAt(i);
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+    }
+
+    for (TTuple<int32, FJob>& Entry : Ready)
+    {
+        const int32 Class = Entry.Get<0>();
+        FJob& Job = Entry.Get<1>();
+        const int32 Resource = (int32)Job.Resource;
+
+        if (Job.Work)
+        {
+            UE::Tasks::Launch(TEXT("MaxQ Job"), [this, Class, Resource, Work = MoveTemp(Job.Work)]() mutable
+            {
+                if (Resource == (int32)ESpiceJobResource::Spice)
+                {
+                    MaxQ::Core::FSpiceScope Scope;
+                    Work();
+                }
+                else
+                {
+                    Work();
+                }
+
+                Finish(Class, Resource);
+            }, TaskPriority(Class));
+        }
+        else
+        {
+            Job.Start([this, Class, Resource]() { Finish(Class, Resource); });
+        }
+    }
+}
+
+
+void FSpiceScheduler::Finish(int32 Class, int32 Resource)
+{
+    bool bIdle = false;
+    {
+        FScopeLock ScopeLock(&Lock);
+
+        --Running[Class];
+        --InUse[Resource];
+        bIdle = --Outstanding == 0;
+    }
+
+    Pump();
+
+    // Last:  Shutdown may delete the scheduler as soon as it's idle
+    if (bIdle)
+    {
+        Idle->Trigger();
+    }
+}
@@ -0,0 +1,313 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSecularPropagator.cpp
+//
+// Implementation Comments
+//
+// Purpose:  J2/J4 secular (precessing conic) propagation of many objects at
+// once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSecularPropagator.cpp is part of the "refined C++ API".
+//
+// Rates are Vallado's (Fundamentals of Astrodynamics, 9-41), less the J2^2
+// terms.  With p = a (1 - e^2), k = (R/p)^2, s = sin(i):
+//    dNode/dt = -3/2 n J2 k cos(i)
+//               + 15/32 n J4 k^2 cos(i) (8 + 12e^2 - (14 + 21e^2) s^2)
+//    dArgp/dt = 3/4 n J2 k (4 - 5s^2)
+//               - 15/128 n J4 k^2 (64 + 72e^2 - (248 + 252e^2) s^2
+//                                  + (196 + 189e^2) s^4)
+//    dM/dt    = n + 3/4 n J2 k sqrt(1-e^2) (2 - 3s^2)
+//               - 45/128 n J4 k^2 e^2 sqrt(1-e^2) (8 - 40s^2 + 35s^4)
+//
+// Kepler's equation is solved by Newton's method, lanes freezing as they
+// converge, as FTwoBodyBatchPropagator does for the universal one.
+//------------------------------------------------------------------------------
+
+#include "SpiceSecularPropagator.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Orbits;
+
+    constexpr int32 W = FSecularBatchPropagator::Lanes;
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double twopi = 2. * pi;
+
+    // Rows per ParallelFor task
+    constexpr int32 BatchRows = 256;
+    static_assert(BatchRows % W == 0, "BatchRows must be a multiple of the lane width");
+
+    constexpr int32 MaxIterations = 32;
+
+    // To [-pi, pi)
+    inline double WrapAngle(double x)
+    {
+        return x - twopi * floor((x + pi) / twopi);
+    }
+}
+
+namespace MaxQ::Orbits
+{
+    bool FZonalHarmonics::FromKernelPool(
+        int32 Body,
+        FZonalHarmonics& Zonals,
+        bool bJ4,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Zonals = FZonalHarmonics();
+
+        SpiceInt _n = 0;
+        SpiceDouble _radii[3] = { 0. };
+        bodvcd_c(Body, "RADII", 3, &_n, _radii);
+        Zonals.Radius = _radii[0];
+
+        bodvcd_c(Body, "J2", 1, &_n, &Zonals.J2);
+
+        if (bJ4 && bodfnd_c(Body, "J4"))
+        {
+            bodvcd_c(Body, "J4", 1, &_n, &Zonals.J4);
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+
+
+    void FSecularBatchPropagator::Reset()
+    {
+        Columns.Empty();
+        Valid.Empty();
+        Rows = 0;
+        NumObjects = 0;
+    }
+
+
+    SIZE_T FSecularBatchPropagator::GetAllocatedSize() const
+    {
+        return Columns.GetAllocatedSize() + Valid.GetAllocatedSize();
+    }
+
+
+    void FSecularBatchPropagator::Build(TArrayView<const FSConicElements> Orbits, const FZonalHarmonics& Zonals)
+    {
+        MAXQ_LLM_SCOPE();
+
+        NumObjects = Orbits.Num();
+        Rows = (NumObjects + W - 1) / W * W;
+        Columns.SetNumZeroed(NumColumns * Rows);
+        Valid.SetNumZeroed(NumObjects);
+
+        for (int32 Row = 0; Row < Rows; ++Row)
+        {
+            double elts[8] = { 0. };
+            if (Row < NumObjects)
+            {
+                Orbits[Row].CopyTo(elts);
+            }
+            const double rp = elts[0], e = elts[1], inc = elts[2], mu = elts[7];
+
+            // (as conics_c, plus closed orbits only)
+            const bool bValid = Row < NumObjects && e >= 0. && e < 1. && rp > 0. && mu > 0.;
+            if (!bValid)
+            {
+                // Padding (and invalid entries) get a harmless unit circular orbit
+                Column(EColumn::sma)[Row] = 1.;
+                Column(EColumn::rootome2)[Row] = 1.;
+                Column(EColumn::sqrtmua)[Row] = 1.;
+                Column(EColumn::cosinc)[Row] = 1.;
+                Column(EColumn::meanrate)[Row] = 1.;
+                continue;
+            }
+
+            const double _a = rp / (1. - e);
+            const double _b = sqrt(1. - e * e);
+            const double n = sqrt(mu / _a) / _a;
+            const double p = _a * (1. - e * e);
+            const double k = Zonals.Radius > 0. ? (Zonals.Radius / p) * (Zonals.Radius / p) : 0.;
+            const double c = cos(inc), s = sin(inc);
+            const double s2 = s * s, s4 = s2 * s2, e2 = e * e;
+
+            const double j2n = 1.5 * n * Zonals.J2 * k;
+            const double j4n = n * Zonals.J4 * k * k;
+
+            Column(EColumn::sma)[Row] = _a;
+            Column(EColumn::ecc)[Row] = e;
+            Column(EColumn::rootome2)[Row] = _b;
+            Column(EColumn::sqrtmua)[Row] = sqrt(mu * _a);
+            Column(EColumn::cosinc)[Row] = c;
+            Column(EColumn::sininc)[Row] = s;
+            Column(EColumn::epoch)[Row] = elts[6];
+            Column(EColumn::node0)[Row] = elts[3];
+            Column(EColumn::argp0)[Row] = elts[4];
+            Column(EColumn::mean0)[Row] = elts[5];
+            Column(EColumn::noderate)[Row] = -j2n * c
+                + 15. / 32. * j4n * c * (8. + 12. * e2 - (14. + 21. * e2) * s2);
+            Column(EColumn::argprate)[Row] = .5 * j2n * (4. - 5. * s2)
+                - 15. / 128. * j4n * (64. + 72. * e2 - (248. + 252. * e2) * s2 + (196. + 189. * e2) * s4);
+            Column(EColumn::meanrate)[Row] = n + .5 * j2n * _b * (2. - 3. * s2)
+                - 45. / 128. * j4n * e2 * _b * (8. - 40. * s2 + 35. * s4);
+
+            Valid[Row] = true;
+        }
+    }
+
+
+    void FSecularBatchPropagator::GetRates(int32 i, double& NodeRate, double& PeriapsisRate, double& MeanAnomalyRate) const
+    {
+        NodeRate = Column(EColumn::noderate)[i];
+        PeriapsisRate = Column(EColumn::argprate)[i];
+        MeanAnomalyRate = Column(EColumn::meanrate)[i];
+    }
+
+
+    int32 FSecularBatchPropagator::Propagate(const FSEphemerisTime& et, TArrayView<FSStateVector> OutStates, const FSRotationMatrix* Rotation) const
+    {
+        check(OutStates.Num() >= NumObjects);
+
+        double m[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+        if (Rotation)
+        {
+            Rotation->CopyTo(m);
+        }
+
+        const double _et = et.AsSpiceDouble();
+        const int32 NumTasks = (Rows + BatchRows - 1) / BatchRows;
+
+        TArray<int32> Succeeded;
+        Succeeded.SetNumZeroed(NumTasks);
+
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 First = Task * BatchRows;
+            const int32 Last = FMath::Min(First + BatchRows, Rows);
+            int32 Count = 0;
+
+            for (int32 Row = First; Row < Last; Row += W)
+            {
+                const double* a = Column(EColumn::sma) + Row;
+                const double* e = Column(EColumn::ecc) + Row;
+                const double* b = Column(EColumn::rootome2) + Row;
+                const double* rootmua = Column(EColumn::sqrtmua) + Row;
+                const double* ci = Column(EColumn::cosinc) + Row;
+                const double* si = Column(EColumn::sininc) + Row;
+                const double* tp = Column(EColumn::epoch) + Row;
+                const double* n0 = Column(EColumn::node0) + Row;
+                const double* w0 = Column(EColumn::argp0) + Row;
+                const double* mm0 = Column(EColumn::mean0) + Row;
+                const double* dn = Column(EColumn::noderate) + Row;
+                const double* dw = Column(EColumn::argprate) + Row;
+                const double* dmm = Column(EColumn::meanrate) + Row;
+
+                // Mean anomaly, and Kepler's equation
+                double M[W], E[W];
+                bool done[W];
+                for (int32 l = 0; l < W; ++l)
+                {
+                    M[l] = WrapAngle(mm0[l] + dmm[l] * (_et - tp[l]));
+                    E[l] = e[l] < .8 ? M[l] + e[l] * sin(M[l]) : (M[l] < 0. ? -pi : pi);
+                    done[l] = false;
+                }
+
+                for (int32 Iteration = 0; Iteration < MaxIterations; ++Iteration)
+                {
+                    bool bAllDone = true;
+
+                    for (int32 l = 0; l < W; ++l)
+                    {
+                        const double step = (E[l] - e[l] * sin(E[l]) - M[l]) / (1. - e[l] * cos(E[l]));
+                        const bool bConverged = done[l] || FMath::Abs(step) <= 1e-14 * FMath::Max(1., FMath::Abs(E[l]));
+                        E[l] = done[l] ? E[l] : E[l] - step;
+                        done[l] = bConverged;
+                        bAllDone &= bConverged;
+                    }
+
+                    if (bAllDone)
+                    {
+                        break;
+                    }
+                }
+
+                double state[6][W];
+                for (int32 l = 0; l < W; ++l)
+                {
+                    const double dt = _et - tp[l];
+                    const double node = n0[l] + dn[l] * dt;
+                    const double w = w0[l] + dw[l] * dt;
+                    const double cosn = cos(node), sinn = sin(node);
+                    const double cosw = cos(w), sinw = sin(w);
+                    const double snci = sinn * ci[l];
+                    const double cnci = cosn * ci[l];
+                    const double P[3] = { cosn * cosw - snci * sinw, sinn * cosw + cnci * sinw, si[l] * sinw };
+                    const double Q[3] = { -cosn * sinw - snci * cosw, -sinn * sinw + cnci * cosw, si[l] * cosw };
+
+                    const double cosE = cos(E[l]), sinE = sin(E[l]);
+                    const double r = a[l] * (1. - e[l] * cosE);
+                    const double x = a[l] * (cosE - e[l]);
+                    const double y = a[l] * b[l] * sinE;
+                    const double vx = -rootmua[l] * sinE / r;
+                    const double vy = rootmua[l] * b[l] * cosE / r;
+
+                    for (int32 j = 0; j < 3; ++j)
+                    {
+                        state[j][l] = x * P[j] + y * Q[j];
+                        state[j + 3][l] = vx * P[j] + vy * Q[j];
+                    }
+                }
+
+                for (int32 l = 0; l < W && Row + l < NumObjects; ++l)
+                {
+                    const int32 i = Row + l;
+                    if (!Valid[i])
+                    {
+                        OutStates[i] = FSStateVector();
+                        continue;
+                    }
+
+                    // (mxv, twice)
+                    double s[6];
+                    for (int32 j = 0; j < 3; ++j)
+                    {
+                        s[j] = m[j][0] * state[0][l] + m[j][1] * state[1][l] + m[j][2] * state[2][l];
+                        s[j + 3] = m[j][0] * state[3][l] + m[j][1] * state[4][l] + m[j][2] * state[5][l];
+                    }
+
+                    OutStates[i] = FSStateVector(s);
+                    ++Count;
+                }
+            }
+
+            Succeeded[Task] = Count;
+        });
+
+        int32 Total = 0;
+        for (int32 Count : Succeeded)
+        {
+            Total += Count;
+        }
+        return Total;
+    }
+}
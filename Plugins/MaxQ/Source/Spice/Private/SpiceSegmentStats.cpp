@@ -0,0 +1,239 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSegmentStats.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Visibility into CSPICE's SPK/CK segment buffers.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSegmentStats.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceSegmentStats.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "SpiceCoverageIndex.h"
+#include "SpiceUtilities.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+#include "MaxQUnits.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+// The unit pool counters are in MaxQ's CSPICE build only (MaxQUnits.h)
+#ifndef MAXQ_CSPICE_UNIT_STATS
+#define MAXQ_CSPICE_UNIT_STATS 0
+#endif
+
+using namespace MaxQ::Private;
+
+DEFINE_STAT(STAT_MaxQ_SpkLookup);
+DEFINE_STAT(STAT_MaxQ_FrameLookup);
+DEFINE_STAT(STAT_MaxQ_SpkLookups);
+DEFINE_STAT(STAT_MaxQ_FrameLookups);
+DEFINE_STAT(STAT_MaxQ_GfSearch);
+DEFINE_STAT(STAT_MaxQ_Furnsh);
+DEFINE_STAT(STAT_MaxQ_Sgp4);
+DEFINE_STAT(STAT_MaxQ_ErrorCheck);
+DEFINE_STAT(STAT_MaxQ_GfSearches);
+DEFINE_STAT(STAT_MaxQ_Furnshes);
+DEFINE_STAT(STAT_MaxQ_Sgp4Evaluations);
+DEFINE_STAT(STAT_MaxQ_Failures);
+DEFINE_STAT(STAT_MaxQ_MemoHits);
+DEFINE_STAT(STAT_MaxQ_MemoMisses);
+DEFINE_STAT(STAT_MaxQ_ChebyshevHits);
+DEFINE_STAT(STAT_MaxQ_ChebyshevMisses);
+DEFINE_STAT(STAT_MaxQ_FrameChainHits);
+DEFINE_STAT(STAT_MaxQ_FrameChainRecompiles);
+DEFINE_STAT(STAT_MaxQ_DynamicFrameHits);
+DEFINE_STAT(STAT_MaxQ_DynamicFrameMisses);
+DEFINE_STAT(STAT_MaxQ_PoolCacheHits);
+DEFINE_STAT(STAT_MaxQ_PoolCacheRebuilds);
+DEFINE_STAT(STAT_MaxQ_LoadedKernels);
+DEFINE_STAT(STAT_MaxQ_SpkFiles);
+DEFINE_STAT(STAT_MaxQ_SpkSegments);
+DEFINE_STAT(STAT_MaxQ_SpkBodies);
+DEFINE_STAT(STAT_MaxQ_CkFiles);
+DEFINE_STAT(STAT_MaxQ_CkSegments);
+DEFINE_STAT(STAT_MaxQ_CkInstruments);
+DEFINE_STAT(STAT_MaxQ_FileUnits);
+DEFINE_STAT(STAT_MaxQ_FileUnitRequests);
+DEFINE_STAT(STAT_MaxQ_FileUnitReopens);
+
+TRACE_DECLARE_INT_COUNTER(MaxQ_SpkSegments, TEXT("MaxQ/SPK Segments"));
+TRACE_DECLARE_INT_COUNTER(MaxQ_CkSegments, TEXT("MaxQ/CK Segments"));
+TRACE_DECLARE_INT_COUNTER(MaxQ_Failures, TEXT("MaxQ/Failures"));
+TRACE_DECLARE_INT_COUNTER(MaxQ_FileUnits, TEXT("MaxQ/File Units"));
+TRACE_DECLARE_INT_COUNTER(MaxQ_FileUnitReopens, TEXT("MaxQ/File Unit Reopens"));
+
+#if MAXQ_TRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(MaxQChannel)
+#endif
+
+namespace MaxQ::Private
+{
+    void CountFailure()
+    {
+        INC_DWORD_STAT(STAT_MaxQ_Failures);
+        MAXQ_COUNT(Failures);
+        TRACE_COUNTER_INCREMENT(MaxQ_Failures);
+    }
+}
+
+namespace
+{
+    // From the toolkit's spkbsr.c and ckbsr.c (N0067)
+    constexpr int32 SpkFtsize = 5000;
+    constexpr int32 SpkStsize = 100000;
+    constexpr int32 SpkBtsize = 10000;
+    constexpr int32 CkFtsize = 5000;
+    constexpr int32 CkStsize = 100000;
+    constexpr int32 CkItsize = 5000;
+
+    void Tally(const MaxQ::Data::FKernelCoverageIndex& Index, MaxQ::Data::EKernelCoverageType Type, MaxQ::Data::FSegmentTableUsage& Usage)
+    {
+        for (int32 File = 0; File < Index.NumFiles(); ++File)
+        {
+            Usage.Files += Index.FileType(File) == Type ? 1 : 0;
+        }
+
+        const TArray<int32> Ids = Index.Ids(Type);
+        Usage.Ids = Ids.Num();
+        for (int32 Id : Ids)
+        {
+            const int32 Segments = Index.Segments(Type, Id).Num();
+            Usage.Segments += Segments;
+            if (Segments > Usage.BusiestIdSegments)
+            {
+                Usage.BusiestId = Id;
+                Usage.BusiestIdSegments = Segments;
+            }
+        }
+    }
+
+    void Warn(const TCHAR* Kind, const TCHAR* Object, const MaxQ::Data::FSegmentTableUsage& Usage)
+    {
+        if (Usage.IsUnbuffered())
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ SPICE %s %s %d has %d segments, more than the segment table holds (%d):  every lookup searches the files"), Kind, Object, Usage.BusiestId, Usage.BusiestIdSegments, Usage.SegmentCapacity);
+        }
+        else if (Usage.MayThrash())
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ SPICE %s segment table may thrash:  %d segments (capacity %d), %d %ss (capacity %d)"), Kind, Usage.Segments, Usage.SegmentCapacity, Usage.Ids, Object, Usage.IdCapacity);
+        }
+    }
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API bool GetSegmentBufferReport(FSegmentBufferReport& Report, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Report = FSegmentBufferReport();
+        Report.Spk.FileCapacity = SpkFtsize;
+        Report.Spk.SegmentCapacity = SpkStsize;
+        Report.Spk.IdCapacity = SpkBtsize;
+        Report.Ck.FileCapacity = CkFtsize;
+        Report.Ck.SegmentCapacity = CkStsize;
+        Report.Ck.IdCapacity = CkItsize;
+
+        FKernelCoverageIndex Index;
+        if (!Index.AddLoaded(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        Tally(Index, EKernelCoverageType::SPK, Report.Spk);
+        Tally(Index, EKernelCoverageType::CK, Report.Ck);
+
+        SET_DWORD_STAT(STAT_MaxQ_SpkFiles, Report.Spk.Files);
+        SET_DWORD_STAT(STAT_MaxQ_SpkSegments, Report.Spk.Segments);
+        SET_DWORD_STAT(STAT_MaxQ_SpkBodies, Report.Spk.Ids);
+        SET_DWORD_STAT(STAT_MaxQ_CkFiles, Report.Ck.Files);
+        SET_DWORD_STAT(STAT_MaxQ_CkSegments, Report.Ck.Segments);
+        SET_DWORD_STAT(STAT_MaxQ_CkInstruments, Report.Ck.Ids);
+        TRACE_COUNTER_SET(MaxQ_SpkSegments, Report.Spk.Segments);
+        TRACE_COUNTER_SET(MaxQ_CkSegments, Report.Ck.Segments);
+
+        Warn(TEXT("SPK"), TEXT("body"), Report.Spk);
+        Warn(TEXT("CK"), TEXT("instrument"), Report.Ck);
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API bool GetFileUnitUsage(FFileUnitUsage& Usage, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Usage = FFileUnitUsage();
+
+#if MAXQ_CSPICE_UNIT_STATS
+        MaxQUnitStats Stats;
+        maxq_unitstats(&Stats);
+        Usage.bCounted = true;
+        Usage.Requests = Stats.requests;
+        Usage.Reopens = Stats.reopens;
+        Usage.Evictions = Stats.evictions;
+        Usage.Units = Stats.units;
+        Usage.PeakUnits = Stats.peak;
+        Usage.Capacity = Stats.capacity;
+        Usage.MaxUnitNumber = Stats.maxlun;
+#else
+        // The toolkit's sizes
+        Usage.Capacity = MAXQ_CSPICE_UTSIZE;
+        Usage.MaxUnitNumber = MAXQ_CSPICE_MAXLUN;
+#endif
+
+        SpiceInt _count = 0;
+        ktotal_c("SPK CK PCK DSK EK", &_count);
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        Usage.BinaryKernels = _count;
+
+        if (!Usage.bCounted)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Success;
+            if (ErrorMessage) ErrorMessage->Empty();
+            return true;
+        }
+
+        SET_DWORD_STAT(STAT_MaxQ_FileUnits, Usage.Units);
+        SET_DWORD_STAT(STAT_MaxQ_FileUnitRequests, (uint32)FMath::Min<int64>(Usage.Requests, MAX_uint32));
+        SET_DWORD_STAT(STAT_MaxQ_FileUnitReopens, (uint32)FMath::Min<int64>(Usage.Reopens, MAX_uint32));
+        TRACE_COUNTER_SET(MaxQ_FileUnits, Usage.Units);
+        TRACE_COUNTER_SET(MaxQ_FileUnitReopens, Usage.Reopens);
+
+        if (Usage.MayThrash() && Usage.Reopens > 0)
+        {
+            UE_LOG(LogSpice, Warning, TEXT("MaxQ SPICE file units thrash:  %d binary kernels, %d units, %lld of %lld requests reopened a file (rebuild CSPICE with a larger MAXQ_CSPICE_UTSIZE)"), Usage.BinaryKernels, Usage.Capacity, Usage.Reopens, Usage.Requests);
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API void ResetFileUnitUsage()
+    {
+#if MAXQ_CSPICE_UNIT_STATS
+        maxq_resetunitstats();
+#endif
+    }
+}
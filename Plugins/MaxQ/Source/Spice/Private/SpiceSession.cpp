@@ -0,0 +1,325 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSession.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Saving and restoring MaxQ's whole SPICE state at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSession.cpp is part of the "refined C++ API".
+//
+// The kernel list is the history replayed:  a Furnsh moves the kernel to
+// the end (CSPICE's precedence is the last load), an Unload drops it.
+// Kernels are sorted text/binary when the session is saved, so restoring
+// doesn't read them.
+//------------------------------------------------------------------------------
+
+#include "SpiceSession.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceNameRegistry.h"
+#include "SpicePoolSnapshot.h"
+#include "SpiceTime.h"
+#include "SpiceUtilities.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr uint32 SessionMagic = 0x53534553;  // "SESS"
+    constexpr int32 SessionVersion = 1;
+
+    struct FSessionKernel
+    {
+        FString AbsolutePath;
+        // Restored from the pool, rather than loaded
+        bool bText = false;
+
+        friend FArchive& operator<<(FArchive& Ar, FSessionKernel& Kernel)
+        {
+            Ar << Kernel.AbsolutePath;
+            Ar << Kernel.bText;
+            return Ar;
+        }
+    };
+
+    struct FSessionBoddef
+    {
+        FString Name;
+        int32 Code = 0;
+
+        friend FArchive& operator<<(FArchive& Ar, FSessionBoddef& Boddef)
+        {
+            Ar << Boddef.Name;
+            Ar << Boddef.Code;
+            return Ar;
+        }
+    };
+
+    struct FSession
+    {
+        TArray<FSessionKernel> Kernels;
+        TArray<uint8> Pool;
+        TArray<FSessionBoddef> Boddefs;
+        bool bClockAnchored = false;
+        double ClockEt = 0.;
+        double ClockRate = 1.;
+
+        friend FArchive& operator<<(FArchive& Ar, FSession& Session)
+        {
+            Ar << Session.Kernels;
+            Ar << Session.Pool;
+            Ar << Session.Boddefs;
+            Ar << Session.bClockAnchored;
+            Ar << Session.ClockEt;
+            Ar << Session.ClockRate;
+            return Ar;
+        }
+    };
+
+    void Serialize(FArchive& Ar, FSession& Session)
+    {
+        uint32 Magic = SessionMagic;
+        int32 Version = SessionVersion;
+        Ar << Magic;
+        Ar << Version;
+        if (Ar.IsLoading() && (Magic != SessionMagic || Version != SessionVersion))
+        {
+            Ar.SetError();
+            return;
+        }
+        Ar << Session;
+    }
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    // Text kernels (but not meta-kernels, which load other kernels), from
+    // the first few bytes
+    bool IsTextKernel(const FString& Path)
+    {
+        TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path, FILEREAD_Silent));
+        if (!Reader)
+        {
+            return false;
+        }
+
+        uint8 Header[6] = { 0 };
+        const int64 Num = FMath::Min<int64>(Reader->TotalSize(), sizeof(Header));
+        Reader->Serialize(Header, Num);
+
+        return Num >= 4 && FMemory::Memcmp(Header, "KPL/", 4) == 0
+            && !(Num >= 6 && FMemory::Memcmp(Header, "KPL/MK", 6) == 0);
+    }
+
+    // What's loaded, lowest precedence first
+    TArray<FString> LoadedKernels()
+    {
+        TArray<MaxQ::Data::FKernelHistoryEntry> History;
+        MaxQ::Data::GetKernelHistory(History);
+
+        TArray<FString> Kernels;
+        for (const MaxQ::Data::FKernelHistoryEntry& Entry : History)
+        {
+            Kernels.Remove(Entry.AbsolutePath);
+            if (Entry.Operation == MaxQ::Data::FKernelHistoryEntry::EOperation::Furnsh)
+            {
+                Kernels.Add(Entry.AbsolutePath);
+            }
+        }
+        return Kernels;
+    }
+
+    FString SessionPath(const FString& path)
+    {
+        return FPaths::IsRelative(path) ? FPaths::Combine(SavedPath(TEXT("Sessions")), path) : path;
+    }
+}
+
+namespace MaxQ::Data
+{
+    SPICE_API bool SaveSession(
+        TArray<uint8>& Session,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FSession Contents;
+
+        for (const FString& Path : LoadedKernels())
+        {
+            Contents.Kernels.Add({ Path, IsTextKernel(Path) });
+        }
+
+        if (!SavePoolSnapshot(Contents.Pool, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        // A name boddef'd more than once maps to its last code
+        for (const FString& Name : GetBoddefNames())
+        {
+            SpiceInt _code = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            bodn2c_c(TCHAR_TO_ANSI(*Name), &_code, &_found);
+            if (_found)
+            {
+                Contents.Boddefs.Add({ Name, (int32)_code });
+            }
+        }
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        const MaxQ::Time::FEtClock& Clock = MaxQ::Time::GetEtClock();
+        Contents.bClockAnchored = Clock.IsAnchored();
+        Contents.ClockEt = Clock.Now();
+        Contents.ClockRate = Clock.GetRate();
+
+        Session.Reset();
+        FMemoryWriter Writer(Session);
+        Serialize(Writer, Contents);
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API bool RestoreSession(
+        TArrayView<const uint8> Session,
+        bool bRestoreClock,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FSession Contents;
+        FMemoryReaderView Reader(Session);
+        Serialize(Reader, Contents);
+        if (Reader.IsError())
+        {
+            return Fail(TEXT("RestoreSession: not a session, or from another version"), ResultCode, ErrorMessage);
+        }
+
+        MaxQ::Core::ClearAll();
+
+        TArray<FString> Binary;
+        for (const FSessionKernel& Kernel : Contents.Kernels)
+        {
+            if (!Kernel.bText)
+            {
+                Binary.Add(Kernel.AbsolutePath);
+            }
+        }
+        if (Binary.Num() > 0 && !Furnsh(Binary, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        // After the meta-kernels, which put their own variables back
+        if (!LoadPoolSnapshot(Contents.Pool, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+        for (const FSessionKernel& Kernel : Contents.Kernels)
+        {
+            if (Kernel.bText)
+            {
+                RecordKernelOperation(FKernelHistoryEntry::EOperation::Furnsh, Kernel.AbsolutePath);
+            }
+        }
+
+        for (const FSessionBoddef& Boddef : Contents.Boddefs)
+        {
+            boddef_c(TCHAR_TO_ANSI(*Boddef.Name), (SpiceInt)Boddef.Code);
+            RecordBoddef(Boddef.Name);
+        }
+        InvalidatePoolCache();
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        MaxQ::Core::WarmUp(false);
+
+        if (bRestoreClock && Contents.bClockAnchored)
+        {
+            MaxQ::Time::FEtClock& Clock = MaxQ::Time::GetEtClock();
+            Clock.Anchor(Contents.ClockEt);
+            Clock.SetRate(Contents.ClockRate);
+        }
+
+        UE_LOG(LogSpice, Log, TEXT("MaxQ SPICE restored a session:  %d kernels, %d boddefs"), Contents.Kernels.Num(), Contents.Boddefs.Num());
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API bool SaveSessionFile(
+        const FString& path,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        TArray<uint8> Session;
+        if (!SaveSession(Session, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        const FString Path = SessionPath(path);
+        if (!FFileHelper::SaveArrayToFile(Session, *Path))
+        {
+            return Fail(FString::Printf(TEXT("SaveSessionFile: could not write %s"), *Path), ResultCode, ErrorMessage);
+        }
+        return true;
+    }
+
+
+    SPICE_API bool RestoreSessionFile(
+        const FString& path,
+        bool bRestoreClock,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const FString Path = SessionPath(path);
+        TArray<uint8> Session;
+        if (!FFileHelper::LoadFileToArray(Session, *Path, FILEREAD_Silent))
+        {
+            return Fail(FString::Printf(TEXT("RestoreSessionFile: could not read %s"), *Path), ResultCode, ErrorMessage);
+        }
+        return RestoreSession(Session, bRestoreClock, ResultCode, ErrorMessage);
+    }
+}
@@ -0,0 +1,166 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSimulationClock.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A deterministic, fixed step simulation clock.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSimulationClock.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceSimulationClock.h"
+#include "Engine/World.h"
+
+namespace MaxQ::Time
+{
+    void FSimulationClock::Reset(double _Start, double _Step)
+    {
+        check(_Step > 0.);
+        Start = _Start;
+        StepSize = _Step;
+        Current = 0;
+        Fraction = 0.;
+    }
+
+
+    int32 FSimulationClock::Advance(double DeltaSeconds, int32 MaxSteps)
+    {
+        const double Elapsed = Fraction + DeltaSeconds * TimeScale;
+        int64 Steps = (int64)FMath::FloorToDouble(Elapsed / StepSize);
+        Fraction = Elapsed - (double)Steps * StepSize;
+
+        // Rounding can leave the fraction a hair outside [0, StepSize)
+        if (Fraction >= StepSize)
+        {
+            ++Steps;
+            Fraction -= StepSize;
+        }
+        Fraction = FMath::Max(Fraction, 0.);
+
+        if (Steps > MaxSteps || Steps < -MaxSteps)
+        {
+            Steps = Steps > 0 ? MaxSteps : -MaxSteps;
+            Fraction = 0.;
+        }
+
+        Current += Steps;
+        return (int32)Steps;
+    }
+
+
+    void FSimulationClock::Seek(int64 n)
+    {
+        Current = n;
+        Fraction = 0.;
+    }
+
+
+    int64 FSimulationClock::Quantize(double et) const
+    {
+        int64 n = (int64)FMath::FloorToDouble((et - Start) / StepSize);
+
+        // StepEpoch is what counts:  make sure it's at or before et, and the
+        // next one isn't
+        if (StepEpoch(n) > et)
+        {
+            --n;
+        }
+        else if (StepEpoch(n + 1) <= et)
+        {
+            ++n;
+        }
+        return n;
+    }
+}
+
+
+void FMaxQSimulationClockTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+    if (Subsystem && TickType != LEVELTICK_ViewportsOnly)
+    {
+        Subsystem->Update(DeltaTime);
+    }
+}
+
+
+FString FMaxQSimulationClockTickFunction::DiagnosticMessage()
+{
+    return TEXT("FMaxQSimulationClockTickFunction");
+}
+
+
+FName FMaxQSimulationClockTickFunction::DiagnosticContext(bool bDetailed)
+{
+    return FName(TEXT("MaxQSimulationClockSubsystem"));
+}
+
+
+void UMaxQSimulationClockSubsystem::Reset(const FSEphemerisTime& Start, const FSEphemerisPeriod& Step)
+{
+    Clock.Reset(Start.AsSpiceDouble(), Step.AsSeconds());
+}
+
+
+void UMaxQSimulationClockSubsystem::Seek(int64 Step)
+{
+    Clock.Seek(Step);
+}
+
+
+void UMaxQSimulationClockSubsystem::Update(float DeltaTime)
+{
+    const int64 Before = Clock.GetStep();
+    Clock.SetTimeScale(TimeScale);
+    const int32 Steps = Clock.Advance(DeltaTime, MaxStepsPerFrame);
+
+    const int32 Direction = Steps > 0 ? 1 : -1;
+    for (int32 i = 1; i <= FMath::Abs(Steps); ++i)
+    {
+        const int64 Step = Before + i * Direction;
+        OnStep.Broadcast(Step, FSEphemerisTime(Clock.StepEpoch(Step)));
+    }
+}
+
+
+bool UMaxQSimulationClockSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+
+void UMaxQSimulationClockSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    TickFunction.Subsystem = this;
+    TickFunction.bCanEverTick = true;
+    TickFunction.bStartWithTickEnabled = true;
+    TickFunction.bTickEvenWhenPaused = false;
+    TickFunction.TickGroup = TG_PrePhysics;
+    TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+
+void UMaxQSimulationClockSubsystem::Deinitialize()
+{
+    if (TickFunction.IsTickFunctionRegistered())
+    {
+        TickFunction.UnRegisterTickFunction();
+    }
+    TickFunction.Subsystem = nullptr;
+
+    Super::Deinitialize();
+}
@@ -0,0 +1,337 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSincptBatch.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Surface intercepts for many rays from one observer, one epoch.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSincptBatch.cpp is part of the "refined C++ API".
+//
+// sincpt removes stellar aberration from the ray by applying the usual
+// correction (stelab, or stlabx for transmission) and subtracting it twice:
+// d - (stelab(d) - d).  Aberration() is stelab's rotation, natively.
+//
+// The ellipsoid intercept is surfpt's:  scale to the unit sphere, then take
+// the near root of the quadratic, in the form that doesn't cancel.
+//------------------------------------------------------------------------------
+
+#include "SpiceSincptBatch.h"
+#include "SpiceDskBvh.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // km/s, clight_c
+    constexpr double SpeedOfLight = 299792.458;
+
+    // Elements per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    inline void Mxv(const double(&m)[3][3], const double(&v)[3], double(&r)[3])
+    {
+        r[0] = m[0][0] * v[0] + m[0][1] * v[1] + m[0][2] * v[2];
+        r[1] = m[1][0] * v[0] + m[1][1] * v[1] + m[1][2] * v[2];
+        r[2] = m[2][0] * v[0] + m[2][1] * v[1] + m[2][2] * v[2];
+    }
+
+    inline void Cross(const double(&a)[3], const double(&b)[3], double(&r)[3])
+    {
+        r[0] = a[1] * b[2] - a[2] * b[1];
+        r[1] = a[2] * b[0] - a[0] * b[2];
+        r[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    inline double Dot(const double(&a)[3], const double(&b)[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    // stelab:  rotate d toward vbyc (observer velocity / c) about d x vbyc,
+    // by asin(|u x vbyc|)
+    void Aberration(const double(&d)[3], const double(&vbyc)[3], double(&r)[3])
+    {
+        const double Length = sqrt(Dot(d, d));
+        const double u[3] = { d[0] / Length, d[1] / Length, d[2] / Length };
+        double h[3];
+        Cross(u, vbyc, h);
+        const double SinPhi = sqrt(Dot(h, h));
+        if (SinPhi == 0.)
+        {
+            r[0] = d[0]; r[1] = d[1]; r[2] = d[2];
+            return;
+        }
+
+        // vrotv, about the unit axis x
+        const double x[3] = { h[0] / SinPhi, h[1] / SinPhi, h[2] / SinPhi };
+        const double CosPhi = sqrt(FMath::Max(0., 1. - SinPhi * SinPhi));
+        const double p = Dot(d, x);
+        const double v1[3] = { d[0] - p * x[0], d[1] - p * x[1], d[2] - p * x[2] };
+        double v2[3];
+        Cross(x, v1, v2);
+        for (int32 i = 0; i < 3; ++i)
+        {
+            r[i] = p * x[i] + CosPhi * v1[i] + SinPhi * v2[i];
+        }
+    }
+
+    // Nearest t >= 0 where o + t d meets the unit sphere (o, d already
+    // scaled).  False if the ray misses, or starts inside.
+    bool UnitSphere(const double(&o)[3], const double(&d)[3], double& t)
+    {
+        const double a = Dot(d, d);
+        const double b = 2. * Dot(o, d);
+        const double c = Dot(o, o) - 1.;
+        if (a == 0. || c < 0. || b >= 0.)
+        {
+            return false;
+        }
+        const double Discriminant = b * b - 4. * a * c;
+        if (Discriminant < 0.)
+        {
+            return false;
+        }
+        // b < 0, so q > 0, and the near root is c / q
+        const double q = -0.5 * (b - sqrt(Discriminant));
+        t = c / q;
+        return true;
+    }
+
+    bool ValidBatch(const MaxQ::Math::FConstVectorBatch& v, int32 Num)
+    {
+        return v.X.Num() == Num && v.Y.Num() == Num && v.Z.Num() == Num;
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    bool InterceptGeometry(
+        const FSEphemerisTime& et,
+        FInterceptGeometry& Geometry,
+        const FString& dref,
+        const FString& target,
+        const FString& fixref,
+        const FString& obsrvr,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto            _dref = StringCast<ANSICHAR>(*dref);
+        auto            _target = StringCast<ANSICHAR>(*target);
+        auto            _fixref = StringCast<ANSICHAR>(*fixref);
+        auto            _obsrvr = StringCast<ANSICHAR>(*obsrvr);
+        ConstSpiceChar* _abcorr = MaxQ::Core::ToANSIString(abcorr);
+        SpiceDouble     _et = et.AsSpiceDouble();
+
+        const bool bTransmission = _abcorr[0] == 'X';
+        const bool bStellar = abcorr != ES_AberrationCorrectionWithTransmissions::None && FCStringAnsi::Strstr(_abcorr, "+S") != nullptr;
+
+        // spkpos returns the geometric light time even for NONE
+        SpiceDouble _ptarg[3] = {}, _lt = 0.;
+        spkpos_c(_target.Get(), _et, _fixref.Get(), _abcorr, _obsrvr.Get(), _ptarg, &_lt);
+        const SpiceDouble _trgepc = abcorr == ES_AberrationCorrectionWithTransmissions::None ? _et : bTransmission ? _et + _lt : _et - _lt;
+
+        SpiceDouble _toj2000[3][3], _fromj2000[3][3];
+        pxform_c(_dref.Get(), "J2000", _et, _toj2000);
+        pxform_c("J2000", _fixref.Get(), _trgepc, _fromj2000);
+
+        SpiceDouble _stobs[6] = {};
+        SpiceInt _obscode = 0;
+        if (bStellar && !failed_c() && ResolveBody(_obsrvr.Get(), _obscode))
+        {
+            spkssb_c(_obscode, _et, "J2000", _stobs);
+        }
+
+        SpiceInt _frcode = 0;
+        namfrm_c(_fixref.Get(), &_frcode);
+
+        SpiceDouble _radii[3] = {};
+        SpiceInt _code = 0;
+        if (!failed_c() && ResolveBody(_target.Get(), _code) && bodfnd_c(_code, "RADII"))
+        {
+            SpiceInt _dim = 0;
+            CachedBodvcd(_code, "RADII", 3, &_dim, _radii);
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        vminus_c(_ptarg, _ptarg);
+        Geometry.TargetEpoch = FSEphemerisTime(_trgepc);
+        Geometry.Observer = FSDistanceVector(_ptarg);
+        Geometry.ToJ2000 = FSRotationMatrix(_toj2000);
+        Geometry.FromJ2000 = FSRotationMatrix(_fromj2000);
+        Geometry.ObserverVelocity = FSVelocityVector(_stobs[3], _stobs[4], _stobs[5]);
+        Geometry.bStellarAberration = bStellar;
+        Geometry.bTransmission = bTransmission;
+        Geometry.Radii = FSDistanceVector(_radii);
+        Geometry.FixRefCode = _frcode;
+        return true;
+    }
+
+
+    bool SurfaceIntercepts(
+        const FInterceptGeometry& Geometry,
+        const FConstVectorBatch& Directions,
+        const FInterceptBatch& Intercepts,
+        const MaxQ::Dsk::FDskShapeModel* Shape
+    )
+    {
+        const int32 Num = Directions.Num();
+        if (!ValidBatch(Directions, Num) || !ValidBatch(Intercepts.Points, Num))
+        {
+            return false;
+        }
+        if ((Intercepts.Found.Num() != 0 && Intercepts.Found.Num() != Num) || (Intercepts.SurfaceVectors && !ValidBatch(*Intercepts.SurfaceVectors, Num)))
+        {
+            return false;
+        }
+
+        double Radii[3];
+        Geometry.Radii.CopyTo(Radii);
+        if (Shape ? Shape->Frame() != Geometry.FixRefCode : !(Radii[0] > 0. && Radii[1] > 0. && Radii[2] > 0.))
+        {
+            return false;
+        }
+
+        double ToJ2000[3][3], FromJ2000[3][3], Observer[3];
+        Geometry.ToJ2000.CopyTo(ToJ2000);
+        Geometry.FromJ2000.CopyTo(FromJ2000);
+        Geometry.Observer.CopyTo(Observer);
+
+        // stlabx is stelab with the velocity reversed
+        const double Sign = Geometry.bTransmission ? -1. : 1.;
+        const FSDimensionlessVector v = Geometry.ObserverVelocity.AsKilometersPerSecond();
+        const double vbyc[3] = { Sign * v.x / SpeedOfLight, Sign * v.y / SpeedOfLight, Sign * v.z / SpeedOfLight };
+
+        const double ScaledObserver[3] = { Observer[0] / Radii[0], Observer[1] / Radii[1], Observer[2] / Radii[2] };
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            FSRay Ray;
+            MaxQ::Dsk::FDskHit Hit;
+
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const double dvec[3] = { Directions.X[i], Directions.Y[i], Directions.Z[i] };
+                double j2dir[3], d[3];
+                Mxv(ToJ2000, dvec, j2dir);
+
+                bool bFound = Dot(j2dir, j2dir) > 0.;
+                if (bFound && Geometry.bStellarAberration)
+                {
+                    double j2app[3];
+                    Aberration(j2dir, vbyc, j2app);
+                    for (int32 k = 0; k < 3; ++k)
+                    {
+                        j2dir[k] -= j2app[k] - j2dir[k];
+                    }
+                }
+                Mxv(FromJ2000, j2dir, d);
+
+                double Point[3] = {};
+                if (bFound && Shape)
+                {
+                    Ray.point = FSDistanceVector(Observer);
+                    Ray.direction = FSDimensionlessVector(d);
+                    bFound = Shape->Intersect(Ray, Hit);
+                    if (bFound)
+                    {
+                        Hit.Point.CopyTo(Point);
+                    }
+                }
+                else if (bFound)
+                {
+                    const double ScaledDirection[3] = { d[0] / Radii[0], d[1] / Radii[1], d[2] / Radii[2] };
+                    double t = 0.;
+                    bFound = UnitSphere(ScaledObserver, ScaledDirection, t);
+                    if (bFound)
+                    {
+                        for (int32 k = 0; k < 3; ++k)
+                        {
+                            Point[k] = Observer[k] + t * d[k];
+                        }
+                    }
+                }
+
+                Intercepts.Points.X[i] = Point[0];
+                Intercepts.Points.Y[i] = Point[1];
+                Intercepts.Points.Z[i] = Point[2];
+                if (Intercepts.SurfaceVectors)
+                {
+                    Intercepts.SurfaceVectors->X[i] = bFound ? Point[0] - Observer[0] : 0.;
+                    Intercepts.SurfaceVectors->Y[i] = bFound ? Point[1] - Observer[1] : 0.;
+                    Intercepts.SurfaceVectors->Z[i] = bFound ? Point[2] - Observer[2] : 0.;
+                }
+                if (Intercepts.Found.Num() > 0)
+                {
+                    Intercepts.Found[i] = bFound ? 1 : 0;
+                }
+            }
+        }, Num <= ChunkSize);
+
+        return true;
+    }
+
+
+    bool SincptBatch(
+        const FSEphemerisTime& et,
+        const FString& dref,
+        const FConstVectorBatch& Directions,
+        const FInterceptBatch& Intercepts,
+        FSEphemerisTime& trgepc,
+        const MaxQ::Dsk::FDskShapeModel* Shape,
+        const FString& target,
+        const FString& fixref,
+        const FString& obsrvr,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        FInterceptGeometry Geometry;
+        if (!InterceptGeometry(et, Geometry, dref, target, fixref, obsrvr, abcorr, ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        if (!SurfaceIntercepts(Geometry, Directions, Intercepts, Shape))
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = Shape && Shape->Frame() != Geometry.FixRefCode
+                ? TEXT("SincptBatch: the shape model's frame isn't fixref")
+                : TEXT("SincptBatch: batch lengths differ, or the target has no RADII");
+            return false;
+        }
+
+        trgepc = Geometry.TargetEpoch;
+        return true;
+    }
+}
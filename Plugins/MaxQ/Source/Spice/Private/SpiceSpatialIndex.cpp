@@ -0,0 +1,464 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSpatialIndex.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A spatial index over a catalog's positions, for picking and
+// proximity queries.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSpatialIndex.cpp is part of the "refined C++ API".
+//
+// Morton codes are 21 bits per axis, over the positions' bounding box.
+// Consecutive leaves along the curve are near each other, so splitting the
+// sorted order in halves, recursively, is a serviceable (if not SAH) tree,
+// and the tree needs no pointers:  the leaves are padded to a power of two
+// (empty ones have inverted bounds, and are never entered), and each level's
+// bounds are the union of the level below's.
+//
+// Nearest prunes against the Kth nearest so far, which tightens as it goes;
+// Raycast against the nearest hit along the ray so far.
+//------------------------------------------------------------------------------
+
+#include "SpiceSpatialIndex.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Points per leaf
+    constexpr int32 LeafSize = 8;
+    // Points (or nodes) per ParallelFor task
+    constexpr int32 PerTask = 1024;
+
+    constexpr uint64 MortonMax = (1 << 21) - 1;
+
+    // 21 bits, to every third bit
+    uint64 Spread(uint64 v)
+    {
+        v &= MortonMax;
+        v = (v | v << 32) & 0x1f00000000ffffull;
+        v = (v | v << 16) & 0x1f0000ff0000ffull;
+        v = (v | v << 8) & 0x100f00f00f00f00full;
+        v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+        v = (v | v << 2) & 0x1249249249249249ull;
+        return v;
+    }
+
+    template<typename BodyType>
+    void ParallelChunks(int32 Num, BodyType&& Body)
+    {
+        const int32 NumTasks = FMath::DivideAndRoundUp(Num, PerTask);
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 End = FMath::Min(Num, (Task + 1) * PerTask);
+            for (int32 i = Task * PerTask; i < End; ++i)
+            {
+                Body(i);
+            }
+        }, NumTasks < 2);
+    }
+
+    // Squared distance from a point to a box (0 inside)
+    template<typename BoundsType>
+    double DistanceSquared(const BoundsType& Bounds, const double(&p)[3])
+    {
+        double d2 = 0.;
+        for (int32 k = 0; k < 3; ++k)
+        {
+            const double d = p[k] < Bounds.Min[k] ? Bounds.Min[k] - p[k] : p[k] > Bounds.Max[k] ? p[k] - Bounds.Max[k] : 0.;
+            d2 += d * d;
+        }
+        return d2;
+    }
+}
+
+
+namespace MaxQ::Math
+{
+    void FSpatialIndex::Reset()
+    {
+        X.Reset();
+        Y.Reset();
+        Z.Reset();
+        Ids.Reset();
+        Nodes.Reset();
+        NumLeaves = 0;
+    }
+
+
+    void FSpatialIndex::Build(const FConstVectorBatch& Positions, TArrayView<const uint8> Valid)
+    {
+        Reset();
+
+        const int32 Count = Positions.X.Num();
+        check(Positions.Y.Num() == Count && Positions.Z.Num() == Count);
+        check(Valid.Num() == 0 || Valid.Num() == Count);
+
+        double Lo[3] = { TNumericLimits<double>::Max(), TNumericLimits<double>::Max(), TNumericLimits<double>::Max() };
+        double Hi[3] = { TNumericLimits<double>::Lowest(), TNumericLimits<double>::Lowest(), TNumericLimits<double>::Lowest() };
+
+        TArray<int32> Included;
+        Included.Reserve(Count);
+        for (int32 i = 0; i < Count; ++i)
+        {
+            const double p[3] = { Positions.X[i], Positions.Y[i], Positions.Z[i] };
+            if ((Valid.Num() > 0 && !Valid[i]) || !FMath::IsFinite(p[0]) || !FMath::IsFinite(p[1]) || !FMath::IsFinite(p[2]))
+            {
+                continue;
+            }
+            Included.Add(i);
+            for (int32 k = 0; k < 3; ++k)
+            {
+                Lo[k] = FMath::Min(Lo[k], p[k]);
+                Hi[k] = FMath::Max(Hi[k], p[k]);
+            }
+        }
+
+        const int32 N = Included.Num();
+        if (N == 0)
+        {
+            return;
+        }
+
+        double Quantize[3];
+        for (int32 k = 0; k < 3; ++k)
+        {
+            Quantize[k] = Hi[k] > Lo[k] ? double(MortonMax) / (Hi[k] - Lo[k]) : 0.;
+        }
+
+        TArray<TPair<uint64, int32>> Keys;
+        Keys.SetNumUninitialized(N);
+        ParallelChunks(N, [&](int32 i)
+        {
+            const int32 Id = Included[i];
+            const uint64 qx = (uint64)((Positions.X[Id] - Lo[0]) * Quantize[0]);
+            const uint64 qy = (uint64)((Positions.Y[Id] - Lo[1]) * Quantize[1]);
+            const uint64 qz = (uint64)((Positions.Z[Id] - Lo[2]) * Quantize[2]);
+            Keys[i] = TPair<uint64, int32>(Spread(qx) | Spread(qy) << 1 | Spread(qz) << 2, Id);
+        });
+
+        Keys.Sort([](const TPair<uint64, int32>& a, const TPair<uint64, int32>& b)
+        {
+            return a.Key != b.Key ? a.Key < b.Key : a.Value < b.Value;
+        });
+
+        X.SetNumUninitialized(N);
+        Y.SetNumUninitialized(N);
+        Z.SetNumUninitialized(N);
+        Ids.SetNumUninitialized(N);
+        ParallelChunks(N, [&](int32 i)
+        {
+            const int32 Id = Keys[i].Value;
+            X[i] = Positions.X[Id];
+            Y[i] = Positions.Y[Id];
+            Z[i] = Positions.Z[Id];
+            Ids[i] = Id;
+        });
+
+        NumLeaves = (int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::DivideAndRoundUp(N, LeafSize));
+        Nodes.SetNumUninitialized(2 * NumLeaves - 1);
+
+        const int32 FirstLeaf = NumLeaves - 1;
+        ParallelChunks(NumLeaves, [&](int32 Leaf)
+        {
+            FBounds& Bounds = Nodes[FirstLeaf + Leaf];
+            for (int32 k = 0; k < 3; ++k)
+            {
+                Bounds.Min[k] = TNumericLimits<double>::Max();
+                Bounds.Max[k] = TNumericLimits<double>::Lowest();
+            }
+
+            const int32 End = FMath::Min(N, (Leaf + 1) * LeafSize);
+            for (int32 p = Leaf * LeafSize; p < End; ++p)
+            {
+                const double v[3] = { X[p], Y[p], Z[p] };
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    Bounds.Min[k] = FMath::Min(Bounds.Min[k], v[k]);
+                    Bounds.Max[k] = FMath::Max(Bounds.Max[k], v[k]);
+                }
+            }
+        });
+
+        // A level at a time, up from the leaves
+        for (int32 LevelSize = NumLeaves / 2; LevelSize >= 1; LevelSize /= 2)
+        {
+            const int32 First = LevelSize - 1;
+            ParallelChunks(LevelSize, [&](int32 i)
+            {
+                const int32 Node = First + i;
+                const FBounds& Left = Nodes[2 * Node + 1];
+                const FBounds& Right = Nodes[2 * Node + 2];
+                FBounds& Bounds = Nodes[Node];
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    Bounds.Min[k] = FMath::Min(Left.Min[k], Right.Min[k]);
+                    Bounds.Max[k] = FMath::Max(Left.Max[k], Right.Max[k]);
+                }
+            });
+        }
+    }
+
+
+    template<typename OverlapsType, typename VisitType>
+    void FSpatialIndex::Traverse(OverlapsType&& Overlaps, VisitType&& Visit) const
+    {
+        if (Nodes.Num() == 0)
+        {
+            return;
+        }
+
+        const int32 FirstLeaf = NumLeaves - 1;
+
+        TArray<int32, TInlineAllocator<64>> Stack;
+        Stack.Add(0);
+        while (Stack.Num() > 0)
+        {
+            const int32 Node = Stack.Pop(false);
+            const FBounds& Bounds = Nodes[Node];
+
+            // Empty (padding)
+            if (Bounds.Min[0] > Bounds.Max[0] || !Overlaps(Bounds))
+            {
+                continue;
+            }
+
+            if (Node >= FirstLeaf)
+            {
+                const int32 End = FMath::Min(Ids.Num(), (Node - FirstLeaf + 1) * LeafSize);
+                for (int32 p = (Node - FirstLeaf) * LeafSize; p < End; ++p)
+                {
+                    Visit(p);
+                }
+            }
+            else
+            {
+                Stack.Add(2 * Node + 2);
+                Stack.Add(2 * Node + 1);
+            }
+        }
+    }
+
+
+    bool FSpatialIndex::Raycast(const FSRay& Ray, double Radius, double Angle, FSpatialHit& Hit, double MaxDistance) const
+    {
+        Hit = FSpatialHit();
+
+        double o[3], d[3];
+        Ray.CopyTo(o, d);
+        const double Length = FMath::Sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        if (Length <= 0.)
+        {
+            return false;
+        }
+        for (int32 k = 0; k < 3; ++k)
+        {
+            d[k] /= Length;
+        }
+
+        const double Tan = FMath::Tan(FMath::Clamp(Angle, 0., 0.5 * UE_DOUBLE_PI - 1.e-6));
+        Radius = FMath::Max(Radius, 0.);
+
+        double Best = MaxDistance;
+        int32 BestPoint = INDEX_NONE;
+
+        Traverse(
+            [&](const FBounds& Bounds)
+            {
+                // The cone's widest inside the box is at its far corner
+                double Far2 = 0.;
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    const double Corner = FMath::Max(FMath::Abs(o[k] - Bounds.Min[k]), FMath::Abs(o[k] - Bounds.Max[k]));
+                    Far2 += Corner * Corner;
+                }
+                const double Grow = Radius + Tan * FMath::Sqrt(Far2);
+
+                // Slabs of the grown box, entered before the best hit
+                double tEnter = 0., tExit = Best + Grow;
+                for (int32 k = 0; k < 3; ++k)
+                {
+                    const double Min = Bounds.Min[k] - Grow, Max = Bounds.Max[k] + Grow;
+                    if (FMath::Abs(d[k]) < 1.e-300)
+                    {
+                        if (o[k] < Min || o[k] > Max)
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+                    double t0 = (Min - o[k]) / d[k], t1 = (Max - o[k]) / d[k];
+                    if (t0 > t1)
+                    {
+                        Swap(t0, t1);
+                    }
+                    tEnter = FMath::Max(tEnter, t0);
+                    tExit = FMath::Min(tExit, t1);
+                    if (tEnter > tExit)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            },
+            [&](int32 p)
+            {
+                const double v[3] = { X[p] - o[0], Y[p] - o[1], Z[p] - o[2] };
+                const double t = v[0] * d[0] + v[1] * d[1] + v[2] * d[2];
+                if (t < 0. || t > Best)
+                {
+                    return;
+                }
+                const double Perpendicular2 = FMath::Max(0., v[0] * v[0] + v[1] * v[1] + v[2] * v[2] - t * t);
+                const double Limit = Radius + Tan * t;
+                if (Perpendicular2 <= Limit * Limit && (t < Best || (t == Best && BestPoint != INDEX_NONE && Ids[p] < Ids[BestPoint])))
+                {
+                    Best = t;
+                    BestPoint = p;
+                }
+            }
+        );
+
+        if (BestPoint == INDEX_NONE)
+        {
+            return false;
+        }
+
+        Hit.Index = Ids[BestPoint];
+        Hit.Distance = Best;
+        return true;
+    }
+
+
+    void FSpatialIndex::Within(const FSDistanceVector& Center, double Radius, TArray<FSpatialHit>& Hits) const
+    {
+        Hits.Reset();
+
+        double c[3];
+        Center.CopyTo(c);
+        const double Radius2 = Radius * Radius;
+
+        Traverse(
+            [&](const FBounds& Bounds) { return DistanceSquared(Bounds, c) <= Radius2; },
+            [&](int32 p)
+            {
+                const double d2 = FMath::Square(X[p] - c[0]) + FMath::Square(Y[p] - c[1]) + FMath::Square(Z[p] - c[2]);
+                if (d2 <= Radius2)
+                {
+                    Hits.Add({ Ids[p], FMath::Sqrt(d2) });
+                }
+            }
+        );
+
+        Hits.Sort([](const FSpatialHit& a, const FSpatialHit& b)
+        {
+            return a.Distance != b.Distance ? a.Distance < b.Distance : a.Index < b.Index;
+        });
+    }
+
+
+    void FSpatialIndex::Nearest(const FSDistanceVector& Center, int32 K, TArray<FSpatialHit>& Hits, double MaxDistance) const
+    {
+        Hits.Reset();
+        if (K <= 0)
+        {
+            return;
+        }
+
+        double c[3];
+        Center.CopyTo(c);
+
+        // Max-heap of the K best (squared distances, for now)
+        auto Farther = [](const FSpatialHit& a, const FSpatialHit& b) { return a.Distance != b.Distance ? a.Distance > b.Distance : a.Index > b.Index; };
+        const double Max2 = MaxDistance < TNumericLimits<double>::Max() ? MaxDistance * MaxDistance : MaxDistance;
+        auto Bound = [&]() { return Hits.Num() < K ? Max2 : Hits.HeapTop().Distance; };
+
+        Traverse(
+            [&](const FBounds& Bounds) { return DistanceSquared(Bounds, c) <= Bound(); },
+            [&](int32 p)
+            {
+                const FSpatialHit Candidate{ Ids[p], FMath::Square(X[p] - c[0]) + FMath::Square(Y[p] - c[1]) + FMath::Square(Z[p] - c[2]) };
+                if (Candidate.Distance > Max2)
+                {
+                    return;
+                }
+                if (Hits.Num() < K)
+                {
+                    Hits.HeapPush(Candidate, Farther);
+                }
+                else if (Farther(Hits.HeapTop(), Candidate))
+                {
+                    FSpatialHit Dropped;
+                    Hits.HeapPop(Dropped, Farther, false);
+                    Hits.HeapPush(Candidate, Farther);
+                }
+            }
+        );
+
+        for (FSpatialHit& Hit : Hits)
+        {
+            Hit.Distance = FMath::Sqrt(Hit.Distance);
+        }
+        Hits.Sort([&Farther](const FSpatialHit& a, const FSpatialHit& b) { return Farther(b, a); });
+    }
+
+
+    void FSpatialIndex::Pairs(double Distance, TArray<TPair<int32, int32>>& Pairs) const
+    {
+        Pairs.Reset();
+
+        const int32 N = Ids.Num();
+        const double Distance2 = Distance * Distance;
+
+        // Each point looks for partners after it in the sorted order, so
+        // every pair is found once
+        const int32 NumTasks = FMath::DivideAndRoundUp(N, PerTask);
+        TArray<TArray<TPair<int32, int32>>> Found;
+        Found.SetNum(NumTasks);
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 End = FMath::Min(N, (Task + 1) * PerTask);
+            for (int32 p = Task * PerTask; p < End; ++p)
+            {
+                const double c[3] = { X[p], Y[p], Z[p] };
+                Traverse(
+                    [&](const FBounds& Bounds) { return DistanceSquared(Bounds, c) < Distance2; },
+                    [&](int32 q)
+                    {
+                        if (q > p && FMath::Square(X[q] - c[0]) + FMath::Square(Y[q] - c[1]) + FMath::Square(Z[q] - c[2]) < Distance2)
+                        {
+                            Found[Task].Emplace(FMath::Min(Ids[p], Ids[q]), FMath::Max(Ids[p], Ids[q]));
+                        }
+                    }
+                );
+            }
+        }, NumTasks < 2);
+
+        for (const TArray<TPair<int32, int32>>& TaskPairs : Found)
+        {
+            Pairs.Append(TaskPairs);
+        }
+        Pairs.Sort([](const TPair<int32, int32>& a, const TPair<int32, int32>& b)
+        {
+            return a.Key != b.Key ? a.Key < b.Key : a.Value < b.Value;
+        });
+    }
+
+
+    SIZE_T FSpatialIndex::GetAllocatedSize() const
+    {
+        return X.GetAllocatedSize() + Y.GetAllocatedSize() + Z.GetAllocatedSize() + Ids.GetAllocatedSize() + Nodes.GetAllocatedSize();
+    }
+}
@@ -0,0 +1,734 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSpkWriter.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Writes discrete-state SPK segments incrementally, and fits
+// sampled trajectories with Chebyshev (type 02/03) segments.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSpkWriter.cpp is part of the "refined C++ API".
+//
+// When a segment is flushed, the last Window-1 states (Window = the number
+// of states an interpolation uses) stay in the buffer, and start the next
+// segment.  That way the last segment always has at least Window states,
+// even if only a single state was added after the previous flush.
+//
+// A flushed segment's buffers are moved (not copied) into an FSegment, which
+// is written either right away or by the executor.  Nothing in an FSegment
+// refers back to the writer, so the writer can be destroyed while they're in
+// flight.
+//
+// Chebyshev fits interpolate the samples (degree 7 Lagrange, as type 09 would
+// for positions and velocities separately), evaluate that at the Chebyshev
+// nodes, and take the coefficients from the discrete cosine sums (as
+// FChebyshevCache does).  Cubic Hermite interpolation isn't good enough here:
+// its velocity error at typical sample spacings is bigger than the velocity
+// tolerances people ask for.  Each record is checked against the samples it
+// spans, and against the interpolant halfway between its nodes.
+//------------------------------------------------------------------------------
+
+#include "SpiceSpkWriter.h"
+#include "SpiceUtilities.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include <cmath>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    using namespace MaxQ::Ephemeris;
+
+    // spkw02/spkw03 limit
+    constexpr int32 MaxChebyshevDegree = 27;
+    constexpr int32 MaxChebyshevN = MaxChebyshevDegree + 1;
+
+    inline int32 NumComponents(ESpkChebyshevType Type)
+    {
+        return Type == ESpkChebyshevType::Type03 ? 6 : 3;
+    }
+
+    // Lagrange interpolation of the samples (as type 09):  each component
+    // from the Window samples nearest et
+    struct FSampleInterpolant
+    {
+        static constexpr int32 Window = 8;
+
+        TArrayView<const double> Ets;
+        TArrayView<const FSStateVector> States;
+
+        void Evaluate(double et, double(&r)[3], double(&v)[3]) const
+        {
+            const int32 W = FMath::Min(Window, Ets.Num());
+            const int32 First = FMath::Clamp(Algo::UpperBound(Ets, et) - W / 2, 0, Ets.Num() - W);
+
+            double y[6] = {};
+            for (int32 j = First; j < First + W; ++j)
+            {
+                double L = 1.;
+                for (int32 m = First; m < First + W; ++m)
+                {
+                    if (m != j) L *= (et - Ets[m]) / (Ets[j] - Ets[m]);
+                }
+
+                const auto& State = States[j].AsSpiceDoubleArray();
+                for (int32 c = 0; c < 6; ++c)
+                {
+                    y[c] += L * State[c];
+                }
+            }
+
+            for (int32 c = 0; c < 3; ++c)
+            {
+                r[c] = y[c];
+                v[c] = y[3 + c];
+            }
+        }
+    };
+
+    struct FChebyshevBasis
+    {
+        int32 N = 0;
+        // Fit nodes, and the points halfway between them (plus the ends)
+        TArray<double> Nodes, Checks;
+        // cos(pi j (k + 1/2) / N), row j
+        TArray<double> Cosines;
+
+        explicit FChebyshevBasis(int32 _N) : N(_N)
+        {
+            for (int32 k = 0; k < N; ++k)
+            {
+                Nodes.Add(FMath::Cos(PI * (k + 0.5) / N));
+            }
+            Checks.Add(1.);
+            for (int32 k = 1; k < N; ++k)
+            {
+                Checks.Add(FMath::Cos(PI * k / N));
+            }
+            Checks.Add(-1.);
+
+            Cosines.SetNumUninitialized(N * N);
+            for (int32 j = 0; j < N; ++j)
+            {
+                for (int32 k = 0; k < N; ++k)
+                {
+                    Cosines[j * N + k] = FMath::Cos(PI * j * (k + 0.5) / N);
+                }
+            }
+        }
+    };
+
+    // Record coefficients c (NumComponents x N) -> position, velocity
+    inline void EvaluateRecord(ESpkChebyshevType Type, const double* c, int32 N, double Radius, double x, double(&r)[3], double(&v)[3])
+    {
+        for (int32 i = 0; i < 3; ++i)
+        {
+            r[i] = Clenshaw(c + i * N, N, x);
+        }
+
+        if (Type == ESpkChebyshevType::Type03)
+        {
+            for (int32 i = 0; i < 3; ++i)
+            {
+                v[i] = Clenshaw(c + (3 + i) * N, N, x);
+            }
+        }
+        else
+        {
+            double d[MaxChebyshevN];
+            for (int32 i = 0; i < 3; ++i)
+            {
+                Differentiate(c + i * N, d, N);
+                v[i] = Clenshaw(d, N, x) / Radius;
+            }
+        }
+    }
+
+    // Fits [a, b] with NumRecords records.  True if every record is within
+    // tolerance.
+    bool FitSegment(
+        const FSampleInterpolant& Samples,
+        const FChebyshevBasis& Basis,
+        const FSpkChebyshevFitSettings& Settings,
+        double a,
+        double b,
+        int32 NumRecords,
+        FSpkChebyshevSegment& Segment
+    )
+    {
+        const int32 N = Basis.N;
+        const int32 Components = NumComponents(Settings.Type);
+        const int32 Stride = Components * N;
+
+        Segment.Type = Settings.Type;
+        Segment.First = a;
+        Segment.Last = b;
+        Segment.Degree = N - 1;
+        Segment.Intlen = (b - a) / NumRecords;
+        // The records have to reach Last
+        while (a + NumRecords * Segment.Intlen < b)
+        {
+            Segment.Intlen = std::nextafter(Segment.Intlen, TNumericLimits<double>::Max());
+        }
+        Segment.Coefficients.SetNumUninitialized(NumRecords * Stride);
+
+        TArray<double> PositionErrors, VelocityErrors;
+        PositionErrors.SetNumZeroed(NumRecords);
+        VelocityErrors.SetNumZeroed(NumRecords);
+
+        ParallelFor(NumRecords, [&](int32 Record)
+        {
+            const double Radius = 0.5 * Segment.Intlen;
+            const double Mid = a + (Record + 0.5) * Segment.Intlen;
+            double* c = &Segment.Coefficients[Record * Stride];
+
+            // Samples, component-major
+            double Values[6][MaxChebyshevN];
+            for (int32 k = 0; k < N; ++k)
+            {
+                double r[3], v[3];
+                Samples.Evaluate(Mid + Radius * Basis.Nodes[k], r, v);
+                for (int32 i = 0; i < 3; ++i)
+                {
+                    Values[i][k] = r[i];
+                    Values[3 + i][k] = v[i];
+                }
+            }
+
+            for (int32 i = 0; i < Components; ++i)
+            {
+                for (int32 j = 0; j < N; ++j)
+                {
+                    double Sum = 0.;
+                    for (int32 k = 0; k < N; ++k)
+                    {
+                        Sum += Values[i][k] * Basis.Cosines[j * N + k];
+                    }
+                    c[i * N + j] = 2. * Sum / N;
+                }
+                c[i * N] *= 0.5;
+            }
+
+            double MaxPosition = 0., MaxVelocity = 0.;
+            auto Check = [&](double et, const double* r, const double* v)
+            {
+                double fr[3], fv[3];
+                EvaluateRecord(Settings.Type, c, N, Radius, (et - Mid) / Radius, fr, fv);
+                MaxPosition = FMath::Max(MaxPosition, FMath::Sqrt(FMath::Square(fr[0] - r[0]) + FMath::Square(fr[1] - r[1]) + FMath::Square(fr[2] - r[2])));
+                MaxVelocity = FMath::Max(MaxVelocity, FMath::Sqrt(FMath::Square(fv[0] - v[0]) + FMath::Square(fv[1] - v[1]) + FMath::Square(fv[2] - v[2])));
+            };
+
+            for (double x : Basis.Checks)
+            {
+                const double et = FMath::Clamp(Mid + Radius * x, a, b);
+                double r[3], v[3];
+                Samples.Evaluate(et, r, v);
+                Check(et, r, v);
+            }
+
+            const double RecordStart = Mid - Radius;
+            const double RecordStop = FMath::Min(Mid + Radius, b);
+            for (int32 i = Algo::LowerBound(Samples.Ets, RecordStart); i < Samples.Ets.Num() && Samples.Ets[i] <= RecordStop; ++i)
+            {
+                const auto& State = Samples.States[i].AsSpiceDoubleArray();
+                Check(Samples.Ets[i], &State[0], &State[3]);
+            }
+
+            PositionErrors[Record] = MaxPosition;
+            VelocityErrors[Record] = MaxVelocity;
+        });
+
+        Segment.MaxPositionErrorKm = FMath::Max(PositionErrors);
+        Segment.MaxVelocityErrorKmps = FMath::Max(VelocityErrors);
+
+        return Segment.MaxPositionErrorKm <= Settings.PositionToleranceKm && Segment.MaxVelocityErrorKmps <= Settings.VelocityToleranceKmps;
+    }
+}
+
+namespace MaxQ::Ephemeris
+{
+    struct FSpkSegmentWriter::FSegment
+    {
+        FSpkSegmentWriterSettings Settings;
+        int Handle = 0;
+        int Body = 0;
+        int Center = 0;
+        FString Frame;
+        FString SegId;
+        double First = 0.;
+        double Last = 0.;
+        TArray<double> Epochs;
+        TArray<double> States;
+
+        bool Write(ES_ResultCode* ResultCode, FString* ErrorMessage) const
+        {
+            auto _frame = StringCast<ANSICHAR>(*Frame);
+            auto _segid = StringCast<ANSICHAR>(*SegId);
+            SpiceInt _n = Epochs.Num();
+            ConstSpiceDouble(*_states)[6] = (ConstSpiceDouble(*)[6])States.GetData();
+
+            switch (Settings.Type)
+            {
+            case ESpkSegmentType::Type05:
+                spkw05_c(Handle, Body, Center, _frame.Get(), First, Last, _segid.Get(), Settings.GM, _n, _states, Epochs.GetData());
+                break;
+            case ESpkSegmentType::Type09:
+                spkw09_c(Handle, Body, Center, _frame.Get(), First, Last, _segid.Get(), Settings.Degree, _n, _states, Epochs.GetData());
+                break;
+            case ESpkSegmentType::Type13:
+                spkw13_c(Handle, Body, Center, _frame.Get(), First, Last, _segid.Get(), Settings.Degree, _n, _states, Epochs.GetData());
+                break;
+            }
+
+            return !ErrorCheck(ResultCode, ErrorMessage);
+        }
+    };
+
+
+    FSpkSegmentWriter::FSpkSegmentWriter()
+    {
+    }
+
+    FSpkSegmentWriter::~FSpkSegmentWriter()
+    {
+        // Anything still buffered is discarded; End() writes it.  The write
+        // queue waits for anything in flight.
+    }
+
+
+    bool FSpkSegmentWriter::Begin(
+        int handle,
+        int body,
+        int center,
+        const FString& frame,
+        const FString& segid,
+        const FSpkSegmentWriterSettings& _Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (bOpen)
+        {
+            return Fail(TEXT("FSpkSegmentWriter::Begin: already open; call End() first"), ResultCode, ErrorMessage);
+        }
+
+        // Checked here, so failures aren't first noticed on the executor
+        switch (_Settings.Type)
+        {
+        case ESpkSegmentType::Type05:
+            if (_Settings.GM <= 0.)
+            {
+                return Fail(FString::Printf(TEXT("FSpkSegmentWriter::Begin: type 05 needs GM > 0, not %f"), _Settings.GM), ResultCode, ErrorMessage);
+            }
+            break;
+        case ESpkSegmentType::Type09:
+        case ESpkSegmentType::Type13:
+            if (_Settings.Degree < 1 || _Settings.Degree > 27)
+            {
+                return Fail(FString::Printf(TEXT("FSpkSegmentWriter::Begin: degree %d is outside [1, 27]"), _Settings.Degree), ResultCode, ErrorMessage);
+            }
+            if (_Settings.Type == ESpkSegmentType::Type13 && (_Settings.Degree % 2) == 0)
+            {
+                return Fail(FString::Printf(TEXT("FSpkSegmentWriter::Begin: type 13 needs an odd degree, not %d"), _Settings.Degree), ResultCode, ErrorMessage);
+            }
+            break;
+        default:
+            return Fail(TEXT("FSpkSegmentWriter::Begin: unsupported segment type"), ResultCode, ErrorMessage);
+        }
+
+        if (segid.Len() > 40)
+        {
+            return Fail(FString::Printf(TEXT("FSpkSegmentWriter::Begin: segment id '%s' is longer than 40 characters"), *segid), ResultCode, ErrorMessage);
+        }
+
+        Settings = _Settings;
+        Settings.MaxStatesPerSegment = FMath::Max(Settings.MaxStatesPerSegment, 2 * MinStates());
+
+        Handle = handle;
+        Body = body;
+        Center = center;
+        Frame = frame;
+        SegId = segid;
+
+        Epochs.Reset(Settings.MaxStatesPerSegment);
+        States.Reset(6 * Settings.MaxStatesPerSegment);
+        CoverageStart = 0.;
+        bHaveCoverageStart = false;
+        SegmentsWritten = 0;
+
+        WriteQueue.Reset();
+        if (Settings.bUseExecutor)
+        {
+            WriteQueue = MakeUnique<FSegmentWriteQueue>();
+        }
+
+        bOpen = true;
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FSpkSegmentWriter::Add(
+        TArrayView<const double> ets,
+        TArrayView<const FSStateVector> states,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (!bOpen)
+        {
+            return Fail(TEXT("FSpkSegmentWriter::Add: not open; call Begin() first"), ResultCode, ErrorMessage);
+        }
+
+        if (ets.Num() != states.Num())
+        {
+            return Fail(FString::Printf(TEXT("FSpkSegmentWriter::Add: %d epochs, but %d states"), ets.Num(), states.Num()), ResultCode, ErrorMessage);
+        }
+
+        FString AsyncError;
+        if (WriteQueue.IsValid() && WriteQueue->Failed(&AsyncError))
+        {
+            return Fail(AsyncError, ResultCode, ErrorMessage);
+        }
+
+        // Validate everything before buffering anything, so a failed Add
+        // leaves the writer as it was.
+        double Previous = Epochs.Num() > 0 ? Epochs.Last() : (bHaveCoverageStart ? CoverageStart : TNumericLimits<double>::Lowest());
+        for (int32 i = 0; i < ets.Num(); ++i)
+        {
+            if (!(ets[i] > Previous))
+            {
+                return Fail(FString::Printf(TEXT("FSpkSegmentWriter::Add: epoch %d (%.17g) does not follow %.17g"), i, ets[i], Previous), ResultCode, ErrorMessage);
+            }
+            Previous = ets[i];
+        }
+
+        for (int32 i = 0; i < ets.Num(); ++i)
+        {
+            Epochs.Add(ets[i]);
+            States.Append(states[i].AsSpiceDoubleArray(), 6);
+
+            if (Epochs.Num() >= Settings.MaxStatesPerSegment)
+            {
+                if (!Flush(false, ResultCode, ErrorMessage))
+                {
+                    return false;
+                }
+            }
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool FSpkSegmentWriter::Add(
+        const FSEphemerisTime& et,
+        const FSStateVector& state,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        double _et = et.AsSpiceDouble();
+        return Add(TArrayView<const double>(&_et, 1), TArrayView<const FSStateVector>(&state, 1), ResultCode, ErrorMessage);
+    }
+
+
+    bool FSpkSegmentWriter::End(
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        if (!bOpen)
+        {
+            return Fail(TEXT("FSpkSegmentWriter::End: not open"), ResultCode, ErrorMessage);
+        }
+
+        bool bSuccess = Flush(true, ResultCode, ErrorMessage);
+
+        FString AsyncError;
+        if (WriteQueue.IsValid())
+        {
+            WriteQueue->Wait();
+            if (bSuccess && WriteQueue->Failed(&AsyncError))
+            {
+                bSuccess = Fail(AsyncError, ResultCode, ErrorMessage);
+            }
+        }
+
+        Epochs.Empty();
+        States.Empty();
+        WriteQueue.Reset();
+        bOpen = false;
+
+        if (bSuccess)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Success;
+            if (ErrorMessage) ErrorMessage->Empty();
+        }
+        return bSuccess;
+    }
+
+
+    bool FSpkSegmentWriter::Flush(bool bFinal, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        const int32 Carried = bHaveCoverageStart ? Carry() : 0;
+
+        // Nothing new since the last segment
+        if (Epochs.Num() <= Carried)
+        {
+            return true;
+        }
+
+        if (Epochs.Num() < MinStates())
+        {
+            return Fail(FString::Printf(TEXT("FSpkSegmentWriter: %d states is too few for a segment; %d are needed"), Epochs.Num(), MinStates()), ResultCode, ErrorMessage);
+        }
+
+        TUniquePtr<FSegment> Segment = MakeUnique<FSegment>();
+        Segment->Settings = Settings;
+        Segment->Handle = Handle;
+        Segment->Body = Body;
+        Segment->Center = Center;
+        Segment->Frame = Frame;
+        Segment->SegId = SegId;
+        Segment->First = bHaveCoverageStart ? CoverageStart : Epochs[0];
+        Segment->Last = Epochs.Last();
+
+        CoverageStart = Segment->Last;
+        bHaveCoverageStart = true;
+
+        // Start the next buffer with the tail of this one
+        if (!bFinal)
+        {
+            const int32 Keep = Carry();
+            TArray<double> NextEpochs, NextStates;
+            NextEpochs.Reserve(Settings.MaxStatesPerSegment);
+            NextStates.Reserve(6 * Settings.MaxStatesPerSegment);
+            NextEpochs.Append(Epochs.GetData() + Epochs.Num() - Keep, Keep);
+            NextStates.Append(States.GetData() + States.Num() - 6 * Keep, 6 * Keep);
+
+            Segment->Epochs = MoveTemp(Epochs);
+            Segment->States = MoveTemp(States);
+            Epochs = MoveTemp(NextEpochs);
+            States = MoveTemp(NextStates);
+        }
+        else
+        {
+            Segment->Epochs = MoveTemp(Epochs);
+            Segment->States = MoveTemp(States);
+            Epochs.Reset();
+            States.Reset();
+        }
+
+        if (!WriteQueue.IsValid())
+        {
+            if (!Segment->Write(ResultCode, ErrorMessage))
+            {
+                return false;
+            }
+
+            ++SegmentsWritten;
+            return true;
+        }
+
+        WriteQueue->Submit(
+            [Segment = MoveTemp(Segment)](ES_ResultCode* SegmentResult, FString* SegmentError)
+            {
+                return Segment->Write(SegmentResult, SegmentError);
+            }
+        );
+
+        ++SegmentsWritten;
+        return true;
+    }
+
+
+    bool FSpkSegmentWriter::Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+
+    int32 FSpkSegmentWriter::MinStates() const
+    {
+        // The number of states one interpolation uses
+        switch (Settings.Type)
+        {
+        case ESpkSegmentType::Type09:
+            return Settings.Degree + 1;
+        case ESpkSegmentType::Type13:
+            return (Settings.Degree + 1) / 2;
+        default:
+            return 2;
+        }
+    }
+
+
+    int32 FSpkSegmentWriter::Carry() const
+    {
+        return FMath::Max(1, MinStates() - 1);
+    }
+
+
+    int32 FSpkChebyshevSegment::NumRecords() const
+    {
+        return Coefficients.Num() / (NumComponents(Type) * (Degree + 1));
+    }
+
+
+    bool FSpkChebyshevSegment::Evaluate(double et, double(&r)[3], double(&v)[3]) const
+    {
+        const int32 n = NumRecords();
+        if (n == 0 || et < First || et > Last)
+        {
+            return false;
+        }
+
+        const int32 N = Degree + 1;
+        const int32 Record = FMath::Clamp(FMath::FloorToInt((et - First) / Intlen), 0, n - 1);
+        const double Radius = 0.5 * Intlen;
+        const double Mid = First + (Record + 0.5) * Intlen;
+
+        EvaluateRecord(Type, &Coefficients[Record * NumComponents(Type) * N], N, Radius, (et - Mid) / Radius, r, v);
+        return true;
+    }
+
+
+    bool FitChebyshevSegments(
+        TArrayView<const double> ets,
+        TArrayView<const FSStateVector> states,
+        TArray<FSpkChebyshevSegment>& Segments,
+        const FSpkChebyshevFitSettings& Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Segments.Empty();
+
+        auto Fail = [&](const FString& Message)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = Message;
+            return false;
+        };
+
+        if (ets.Num() != states.Num())
+        {
+            return Fail(FString::Printf(TEXT("FitChebyshevSegments: %d epochs, but %d states"), ets.Num(), states.Num()));
+        }
+        if (ets.Num() < 2)
+        {
+            return Fail(TEXT("FitChebyshevSegments: at least 2 states are needed"));
+        }
+        for (int32 i = 1; i < ets.Num(); ++i)
+        {
+            if (!(ets[i] > ets[i - 1]))
+            {
+                return Fail(FString::Printf(TEXT("FitChebyshevSegments: epoch %d (%.17g) does not follow %.17g"), i, ets[i], ets[i - 1]));
+            }
+        }
+
+        FSpkChebyshevFitSettings _Settings = Settings;
+        _Settings.Degree = FMath::Clamp(Settings.Degree, 1, MaxChebyshevDegree);
+        const double MinRecord = FMath::Max(Settings.MinRecordSeconds, 1.);
+        const double MaxRecord = FMath::Max(Settings.MaxRecordSeconds, MinRecord);
+
+        const FSampleInterpolant Samples{ ets, states };
+        const FChebyshevBasis Basis(_Settings.Degree + 1);
+
+        const double Start = ets[0];
+        const double Stop = ets.Last();
+        const int32 NumSegments = FMath::Max(1, FMath::CeilToInt((Stop - Start) / FMath::Max(Settings.MaxSegmentSeconds, MaxRecord)));
+        const double SegmentLength = (Stop - Start) / NumSegments;
+
+        for (int32 i = 0; i < NumSegments; ++i)
+        {
+            const double a = Start + i * SegmentLength;
+            const double b = i == NumSegments - 1 ? Stop : a + SegmentLength;
+
+            FSpkChebyshevSegment& Segment = Segments.AddDefaulted_GetRef();
+            int32 NumRecords = FMath::Max(1, FMath::CeilToInt((b - a) / MaxRecord));
+            while (!FitSegment(Samples, Basis, _Settings, a, b, NumRecords, Segment))
+            {
+                if ((b - a) / (2. * NumRecords) < MinRecord)
+                {
+                    UE_LOG(LogSpice, Verbose, TEXT("MaxQ Chebyshev SPK fit: segment %d misses tolerance (%f km, %f km/s) at the minimum record length"), i, Segment.MaxPositionErrorKm, Segment.MaxVelocityErrorKmps);
+                    break;
+                }
+                NumRecords *= 2;
+            }
+        }
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    bool WriteChebyshevSegments(
+        int handle,
+        int body,
+        int center,
+        const FString& frame,
+        const FString& segid,
+        TArrayView<const FSpkChebyshevSegment> Segments,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        auto _frame = StringCast<ANSICHAR>(*frame);
+        auto _segid = StringCast<ANSICHAR>(*segid);
+
+        for (const FSpkChebyshevSegment& Segment : Segments)
+        {
+            auto spkw = Segment.Type == ESpkChebyshevType::Type03 ? spkw03_c : spkw02_c;
+            spkw(
+                handle,
+                body,
+                center,
+                _frame.Get(),
+                Segment.First,
+                Segment.Last,
+                _segid.Get(),
+                Segment.Intlen,
+                Segment.NumRecords(),
+                Segment.Degree,
+                Segment.Coefficients.GetData(),
+                Segment.First
+            );
+
+            if (failed_c())
+            {
+                break;
+            }
+        }
+
+        return !ErrorCheck(ResultCode, ErrorMessage);
+    }
+}
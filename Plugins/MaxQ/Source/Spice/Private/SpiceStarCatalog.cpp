@@ -0,0 +1,515 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStarCatalog.cpp
+//
+// Implementation Comments
+//
+// Purpose:  SPICE type 1 star catalogs (Hipparcos, Tycho-2...), in bulk.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStarCatalog.cpp is part of the "refined C++ API".
+//
+// Tycho-2 gives RA and Dec separate mean epochs.  The loader moves Dec to
+// the RA epoch (along its proper motion), so each star has one epoch.
+//
+// The index is built from directions with proper motion, but without
+// aberration, and rebuilt once proper motion has moved a star more than
+// RebuildSlack from them.  Queries widen each cell's test by the slack
+// (proper motion since the build, plus the largest aberration angle for the
+// observer's speed), then test the stars themselves.
+//------------------------------------------------------------------------------
+
+#include "SpiceStarCatalog.h"
+#include "SpiceUtilities.h"
+#include "SpiceMemory.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+
+// for stcl01_
+#include "SpiceZfc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double halfpi = pi / 2.;
+    constexpr double rpd = pi / 180.;
+
+    // km/s (clight_c)
+    constexpr double clight = 299792.458;
+
+    constexpr double JulianYearSeconds = 365.25 * 86400.;
+
+    // Stars per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    // Radians of proper motion before the index is rebuilt
+    constexpr double RebuildSlack = 1e-3;
+
+    template<typename Fn>
+    void ForEachChunk(int32 Num, Fn&& Body)
+    {
+        const int32 NumChunks = (Num + ChunkSize - 1) / ChunkSize;
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            const int32 First = Chunk * ChunkSize;
+            Body(First, FMath::Min(First + ChunkSize, Num));
+        }, NumChunks <= 1);
+    }
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    // Face 0..5 (+X, -X, +Y, -Y, +Z, -Z), and the coordinates on it in
+    // [-1, 1]
+    inline int32 CubeFace(double x, double y, double z, double& u, double& v)
+    {
+        const double ax = FMath::Abs(x), ay = FMath::Abs(y), az = FMath::Abs(z);
+        if (ax >= ay && ax >= az && ax > 0.)
+        {
+            u = y / ax; v = z / ax;
+            return x > 0. ? 0 : 1;
+        }
+        if (ay >= az)
+        {
+            u = ay > 0. ? z / ay : 0.; v = ay > 0. ? x / ay : 0.;
+            return y > 0. ? 2 : 3;
+        }
+        u = x / az; v = y / az;
+        return z > 0. ? 4 : 5;
+    }
+
+    inline FVector3d CubeDirection(int32 Face, double u, double v)
+    {
+        switch (Face)
+        {
+        case 0: return FVector3d(1., u, v).GetUnsafeNormal();
+        case 1: return FVector3d(-1., u, v).GetUnsafeNormal();
+        case 2: return FVector3d(v, 1., u).GetUnsafeNormal();
+        case 3: return FVector3d(v, -1., u).GetUnsafeNormal();
+        case 4: return FVector3d(u, v, 1.).GetUnsafeNormal();
+        default: return FVector3d(u, v, -1.).GetUnsafeNormal();
+        }
+    }
+
+    inline int32 CellIndex(int32 Resolution, double x, double y, double z)
+    {
+        double u, v;
+        const int32 Face = CubeFace(x, y, z, u, v);
+        const int32 i = FMath::Clamp(int32((u + 1.) * 0.5 * Resolution), 0, Resolution - 1);
+        const int32 j = FMath::Clamp(int32((v + 1.) * 0.5 * Resolution), 0, Resolution - 1);
+        return (Face * Resolution + j) * Resolution + i;
+    }
+
+    inline double Angle(const FVector3d& a, const FVector3d& b)
+    {
+        return FMath::Atan2(FVector3d::CrossProduct(a, b).Size(), FVector3d::DotProduct(a, b));
+    }
+}
+
+
+namespace MaxQ::Data
+{
+    void FStarCatalog::Reset()
+    {
+        Ra.Reset();
+        Dec.Reset();
+        RaPm.Reset();
+        DecPm.Reset();
+        Epoch.Reset();
+        CatalogNumber.Reset();
+        VisualMagnitude.Reset();
+        SpectralClass.Reset();
+    }
+
+
+    void FStarCatalog::SetNum(int32 Num)
+    {
+        Ra.SetNumZeroed(Num);
+        Dec.SetNumZeroed(Num);
+        RaPm.SetNumZeroed(Num);
+        DecPm.SetNumZeroed(Num);
+        Epoch.SetNumZeroed(Num);
+        CatalogNumber.SetNumZeroed(Num);
+        VisualMagnitude.SetNumZeroed(Num);
+        SpectralClass.Init(EStarSpectralClass::Unknown, Num);
+    }
+
+
+    double FStarCatalog::MaxProperMotion() const
+    {
+        double Max = 0.;
+        for (int32 i = 0; i < Num(); ++i)
+        {
+            const double mu = RaPm[i] * FMath::Cos(Dec[i]);
+            Max = FMath::Max(Max, FMath::Sqrt(mu * mu + DecPm[i] * DecPm[i]));
+        }
+        return Max;
+    }
+
+
+    SPICE_API EStarSpectralClass StarSpectralClass(const FString& SpectralType)
+    {
+        // The first class letter (so "kA2hA5mA7V" is an A, and "sdB" a B)
+        static const TCHAR Classes[] = TEXT("OBAFGKM");
+        for (TCHAR c : SpectralType)
+        {
+            for (int32 i = 0; i < (int32)UE_ARRAY_COUNT(Classes) - 1; ++i)
+            {
+                if (c == Classes[i])
+                {
+                    return (EStarSpectralClass)i;
+                }
+            }
+        }
+        return EStarSpectralClass::Unknown;
+    }
+
+
+    SPICE_API int32 LoadStarCatalog(
+        const FString& Path,
+        FStarCatalog& Catalog,
+        const FStarCatalogLoadSettings& Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_LLM_SCOPE();
+
+        Catalog.Reset();
+
+        auto        _catfnm = StringCast<ANSICHAR>(*toPath(Path));
+        SpiceChar   _tabnam[SPICE_EK_TSTRLN];
+        integer     _handle = 0;
+        FMemory::Memset(_tabnam, ' ', sizeof(_tabnam));
+
+        stcl01_((char*)_catfnm.Get(), _tabnam, &_handle, (ftnlen)_catfnm.Length(), (ftnlen)(sizeof(_tabnam) - 1));
+        _tabnam[sizeof(_tabnam) - 1] = '\0';
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return 0;
+        }
+        const FString Table = FString(ANSI_TO_TCHAR(_tabnam)).TrimEnd();
+
+        // Every star at once, with proper motions if the catalog has them
+        SpiceInt        _nmrows = 0;
+        SpiceBoolean    _error = SPICEFALSE;
+        SpiceChar       _errmsg[SPICE_EK_MAXQRY];
+        bool bProperMotion = true;
+        for (;;)
+        {
+            const FString Query = FString::Printf(
+                TEXT("SELECT RA, DEC, CATALOG_NUMBER, VISUAL_MAGNITUDE, SPECTRAL_TYPE%s FROM %s WHERE VISUAL_MAGNITUDE <= %.6f"),
+                bProperMotion ? TEXT(", RA_PM, DEC_PM, RA_EPOCH, DEC_EPOCH") : TEXT(""),
+                *Table,
+                Settings.MaxMagnitude
+            );
+            ekfind_c(TCHAR_TO_ANSI(*Query), sizeof(_errmsg), &_nmrows, &_error, _errmsg);
+            if (!_error || !bProperMotion || failed_c())
+            {
+                break;
+            }
+            bProperMotion = false;
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            ekuef_c((SpiceInt)_handle);
+            UnexpectedErrorCheck();
+            return 0;
+        }
+        if (_error)
+        {
+            ekuef_c((SpiceInt)_handle);
+            UnexpectedErrorCheck();
+            Fail(FString::Printf(TEXT("LoadStarCatalog: %s (%s)"), ANSI_TO_TCHAR(_errmsg), *Path), ResultCode, ErrorMessage);
+            return 0;
+        }
+
+        Catalog.SetNum(_nmrows);
+
+        int32 n = 0;
+        for (SpiceInt _row = 0; _row < _nmrows && !failed_c(); ++_row)
+        {
+            SpiceBoolean _null = SPICEFALSE, _found = SPICEFALSE;
+            SpiceBoolean _rnull = SPICEFALSE, _dnull = SPICEFALSE;
+            SpiceDouble _ra = 0., _dec = 0.;
+            ekgd_c(0, _row, 0, &_ra, &_rnull, &_found);
+            ekgd_c(1, _row, 0, &_dec, &_dnull, &_found);
+            if (_rnull || _dnull)
+            {
+                continue;
+            }
+
+            SpiceInt _catnum = 0;
+            SpiceDouble _vmag = 0.;
+            SpiceChar _sptype[64];
+            ekgi_c(2, _row, 0, &_catnum, &_null, &_found);
+            ekgd_c(3, _row, 0, &_vmag, &_null, &_found);
+            _sptype[0] = '\0';
+            ekgc_c(4, _row, 0, sizeof(_sptype), _sptype, &_null, &_found);
+            if (_null)
+            {
+                _sptype[0] = '\0';
+            }
+
+            // Julian years and degrees/year, to seconds past J2000 and
+            // radians/year
+            double Epoch = 0., RaPm = 0., DecPm = 0.;
+            double dec = _dec * rpd;
+            if (bProperMotion)
+            {
+                SpiceDouble _rapm = 0., _decpm = 0., _raepoch = 2000., _decepoch = 2000.;
+                SpiceBoolean _pmnull = SPICEFALSE;
+                ekgd_c(5, _row, 0, &_rapm, &_pmnull, &_found);
+                ekgd_c(6, _row, 0, &_decpm, &_null, &_found);
+                _pmnull = _pmnull || _null;
+                ekgd_c(7, _row, 0, &_raepoch, &_null, &_found);
+                if (_null) _raepoch = 2000.;
+                ekgd_c(8, _row, 0, &_decepoch, &_null, &_found);
+                if (_null) _decepoch = _raepoch;
+
+                if (!_pmnull)
+                {
+                    DecPm = _decpm * rpd;
+                    RaPm = _rapm * rpd;
+                    if (Settings.bRaPmTimesCosDec)
+                    {
+                        const double cosdec = FMath::Cos(dec);
+                        RaPm = cosdec > 1e-9 ? RaPm / cosdec : 0.;
+                    }
+                    dec += DecPm * (_raepoch - _decepoch);
+                }
+                Epoch = (_raepoch - 2000.) * JulianYearSeconds;
+            }
+
+            Catalog.Ra[n] = _ra * rpd;
+            Catalog.Dec[n] = FMath::Clamp(dec, -halfpi, halfpi);
+            Catalog.RaPm[n] = RaPm;
+            Catalog.DecPm[n] = DecPm;
+            Catalog.Epoch[n] = Epoch;
+            Catalog.CatalogNumber[n] = (int32)_catnum;
+            Catalog.VisualMagnitude[n] = (float)_vmag;
+            Catalog.SpectralClass[n] = StarSpectralClass(ANSI_TO_TCHAR(_sptype));
+            ++n;
+        }
+
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            Catalog.Reset();
+            ekuef_c((SpiceInt)_handle);
+            UnexpectedErrorCheck();
+            return 0;
+        }
+
+        ekuef_c((SpiceInt)_handle);
+        Catalog.SetNum(n);
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return n;
+    }
+
+
+    void FStarIndex::Build(const MaxQ::Math::FConstVectorBatch& Directions, int32 _Resolution)
+    {
+        MAXQ_LLM_SCOPE();
+
+        const int32 NumCells = 6 * FMath::Square(FMath::Max(_Resolution, 1));
+        const int32 Num = Directions.Num();
+
+        if (Resolution != FMath::Max(_Resolution, 1) || CellAxis.Num() != NumCells)
+        {
+            Resolution = FMath::Max(_Resolution, 1);
+            CellAxis.SetNumUninitialized(NumCells);
+            CellRadius.SetNumUninitialized(NumCells);
+
+            // Each cell's center, and its farthest corner
+            const double CellSize = 2. / Resolution;
+            for (int32 Face = 0; Face < 6; ++Face)
+            {
+                for (int32 j = 0; j < Resolution; ++j)
+                {
+                    for (int32 i = 0; i < Resolution; ++i)
+                    {
+                        const int32 Cell = (Face * Resolution + j) * Resolution + i;
+                        const double u0 = -1. + i * CellSize, v0 = -1. + j * CellSize;
+                        const FVector3d Center = CubeDirection(Face, u0 + 0.5 * CellSize, v0 + 0.5 * CellSize);
+                        CellAxis[Cell] = Center;
+                        CellRadius[Cell] = FMath::Max(
+                            FMath::Max(Angle(Center, CubeDirection(Face, u0, v0)), Angle(Center, CubeDirection(Face, u0 + CellSize, v0))),
+                            FMath::Max(Angle(Center, CubeDirection(Face, u0, v0 + CellSize)), Angle(Center, CubeDirection(Face, u0 + CellSize, v0 + CellSize)))
+                        );
+                    }
+                }
+            }
+        }
+
+        TArray<int32> Cells;
+        Cells.SetNumUninitialized(Num);
+        const double* X = Directions.X.GetData(); const double* Y = Directions.Y.GetData(); const double* Z = Directions.Z.GetData();
+        ForEachChunk(Num, [&](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                Cells[i] = CellIndex(Resolution, X[i], Y[i], Z[i]);
+            }
+        });
+
+        // Counting sort, by cell
+        CellStart.Init(0, NumCells + 1);
+        for (int32 Cell : Cells)
+        {
+            ++CellStart[Cell + 1];
+        }
+        for (int32 c = 0; c < NumCells; ++c)
+        {
+            CellStart[c + 1] += CellStart[c];
+        }
+
+        TArray<int32> Next(CellStart.GetData(), NumCells);
+        CellStars.SetNumUninitialized(Num);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            CellStars[Next[Cells[i]]++] = i;
+        }
+    }
+
+
+    void FStarIndex::Reset()
+    {
+        Resolution = 0;
+        CellAxis.Reset();
+        CellRadius.Reset();
+        CellStart.Reset();
+        CellStars.Reset();
+    }
+
+
+    int32 FStarIndex::QueryCone(
+        const MaxQ::Math::FConstVectorBatch& Directions,
+        const FSDimensionlessVector& Axis,
+        double HalfAngle,
+        double Slack,
+        TArray<int32>& Stars
+    ) const
+    {
+        const FVector3d a = FVector3d(Axis.x, Axis.y, Axis.z).GetSafeNormal();
+        if (Resolution == 0 || Directions.Num() != CellStars.Num() || a.IsZero() || HalfAngle < 0.)
+        {
+            return 0;
+        }
+
+        const double* X = Directions.X.GetData(); const double* Y = Directions.Y.GetData(); const double* Z = Directions.Z.GetData();
+        const double CosHalfAngle = FMath::Cos(FMath::Min(HalfAngle, pi));
+        const double Reach = HalfAngle + Slack;
+
+        const int32 First = Stars.Num();
+        for (int32 Cell = 0; Cell < CellAxis.Num(); ++Cell)
+        {
+            if (CellStart[Cell] == CellStart[Cell + 1] || Angle(a, CellAxis[Cell]) > Reach + CellRadius[Cell])
+            {
+                continue;
+            }
+
+            for (int32 k = CellStart[Cell]; k < CellStart[Cell + 1]; ++k)
+            {
+                const int32 Star = CellStars[k];
+                if (X[Star] * a.X + Y[Star] * a.Y + Z[Star] * a.Z >= CosHalfAngle)
+                {
+                    Stars.Add(Star);
+                }
+            }
+        }
+
+        return Stars.Num() - First;
+    }
+
+
+    void FStarField::SetCatalog(FStarCatalog&& _Catalog)
+    {
+        Catalog = MoveTemp(_Catalog);
+        MaxProperMotion = Catalog.MaxProperMotion();
+        X.SetNumZeroed(Catalog.Num());
+        Y.SetNumZeroed(Catalog.Num());
+        Z.SetNumZeroed(Catalog.Num());
+        Index.Reset();
+        bIndexValid = false;
+        Slack = 0.;
+    }
+
+
+    bool FStarField::Update(const FSEphemerisTime& et, const FSVelocityVector& vobs)
+    {
+        MAXQ_LLM_SCOPE();
+
+        const double _et = et.AsSpiceDouble();
+        Epoch = et;
+
+        const double* Ra = Catalog.Ra.GetData(); const double* Dec = Catalog.Dec.GetData();
+        const double* RaPm = Catalog.RaPm.GetData(); const double* DecPm = Catalog.DecPm.GetData();
+        const double* StarEpoch = Catalog.Epoch.GetData();
+        double* _X = X.GetData(); double* _Y = Y.GetData(); double* _Z = Z.GetData();
+
+        ForEachChunk(Catalog.Num(), [=](int32 First, int32 Last)
+        {
+            for (int32 i = First; i < Last; ++i)
+            {
+                const double dt = (_et - StarEpoch[i]) / JulianYearSeconds;
+                const double ra = Ra[i] + RaPm[i] * dt;
+                const double dec = FMath::Clamp(Dec[i] + DecPm[i] * dt, -halfpi, halfpi);
+                const double cosdec = cos(dec);
+                _X[i] = cos(ra) * cosdec;
+                _Y[i] = sin(ra) * cosdec;
+                _Z[i] = sin(dec);
+            }
+        });
+
+        double ProperMotionSlack = MaxProperMotion * FMath::Abs(_et - IndexEpoch) / JulianYearSeconds;
+        if (!bIndexValid || ProperMotionSlack > RebuildSlack)
+        {
+            Index.Build(Directions());
+            IndexEpoch = _et;
+            bIndexValid = true;
+            ProperMotionSlack = 0.;
+        }
+
+        // The aberration angle is at most asin(v / c)
+        const double Speed = vobs.AsKilometersPerSecond().Magnitude();
+        if (!MaxQ::Math::Stelab(Directions(), vobs, MaxQ::Math::FVectorBatch{ X, Y, Z }))
+        {
+            Slack = ProperMotionSlack;
+            return false;
+        }
+
+        Slack = ProperMotionSlack + FMath::Asin(FMath::Min(Speed / clight, 1.));
+        return true;
+    }
+
+
+    int32 FStarField::QueryCone(const FSDimensionlessVector& Axis, double HalfAngle, TArray<int32>& Stars) const
+    {
+        return Index.QueryCone(Directions(), Axis, HalfAngle, Slack, Stars);
+    }
+}
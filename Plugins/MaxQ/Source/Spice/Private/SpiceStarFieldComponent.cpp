@@ -0,0 +1,288 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStarFieldComponent.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A star catalog, drawn as instanced sprites.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStarFieldComponent.cpp is part of the "Blueprints API".
+//
+// The worker owns the field and the transforms while an update is in
+// flight.  Anything else that touches them (a new catalog, a query) waits
+// for it first, and leaves the result for the next tick to apply.  The
+// observer's velocity needs CSPICE, so it's looked up on the game thread
+// when the update is launched, and copied into the job.
+//
+// Magnitudes and classes don't change between updates, so custom data is
+// written once, when the instances are created.
+//------------------------------------------------------------------------------
+
+#include "SpiceStarFieldComponent.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceExecutor.h"
+#include "SpiceMath.h"
+#include "Spice.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+namespace
+{
+    // Instances per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    enum ECustomData : int32
+    {
+        Magnitude,
+        SpectralClass,
+        NumCustomData
+    };
+}
+
+
+UMaxQStarFieldComponent::UMaxQStarFieldComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    // After the ephemeris subsystem has advanced its Epoch
+    PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+    Mobility = EComponentMobility::Movable;
+    NumCustomDataFloats = NumCustomData;
+    SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    SetGenerateOverlapEvents(false);
+    CastShadow = false;
+}
+
+
+void UMaxQStarFieldComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (bLoadOnBeginPlay && !CatalogPath.IsEmpty())
+    {
+        LoadCatalog();
+    }
+}
+
+
+void UMaxQStarFieldComponent::LoadCatalog()
+{
+    check(IsInGameThread());
+
+    MaxQ::Data::FStarCatalogLoadSettings Settings;
+    Settings.MaxMagnitude = MaxMagnitude;
+
+    Loading = FSpiceExecutor::Get().Enqueue([Path = CatalogPath, Settings]()
+    {
+        TSharedPtr<FLoaded, ESPMode::ThreadSafe> Loaded = MakeShared<FLoaded, ESPMode::ThreadSafe>();
+        MaxQ::Data::LoadStarCatalog(Path, Loaded->Catalog, Settings, &Loaded->ResultCode, &Loaded->ErrorMessage);
+        return Loaded;
+    });
+}
+
+
+int32 UMaxQStarFieldComponent::SetStarCatalog(MaxQ::Data::FStarCatalog&& Catalog)
+{
+    check(IsInGameThread());
+
+    Wait();
+    InFlight.Reset();
+
+    Field.SetCatalog(MoveTemp(Catalog));
+    const MaxQ::Data::FStarCatalog& Stars = Field.GetCatalog();
+    const int32 Num = Stars.Num();
+
+    ClearInstances();
+    SetNumCustomDataFloats(NumCustomData);
+
+    TArray<FTransform> Hidden;
+    Hidden.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), Num);
+    AddInstances(Hidden, false);
+
+    TArray<float> CustomData;
+    CustomData.SetNumZeroed(NumCustomData);
+    for (int32 i = 0; i < Num; ++i)
+    {
+        CustomData[Magnitude] = Stars.VisualMagnitude[i];
+        CustomData[SpectralClass] = (float)Stars.SpectralClass[i];
+        SetCustomData(i, CustomData, false);
+    }
+
+    MarkRenderStateDirty();
+    bStale = true;
+
+    return Num;
+}
+
+
+int32 UMaxQStarFieldComponent::QueryCone(const FSDimensionlessVector& Axis, const FSAngle& HalfAngle, TArray<int32>& Stars)
+{
+    Wait();
+
+    Stars.Reset();
+    return Field.QueryCone(Axis, HalfAngle.AsSpiceDouble(), Stars);
+}
+
+
+bool UMaxQStarFieldComponent::GetStar(int32 Index, FSDimensionlessVector& Direction, int32& CatalogNumber, float& VisualMagnitude)
+{
+    Wait();
+
+    if (Index < 0 || Index >= Field.Num())
+    {
+        return false;
+    }
+
+    const MaxQ::Math::FConstVectorBatch Directions = Field.Directions();
+    Direction = FSDimensionlessVector(Directions.X[Index], Directions.Y[Index], Directions.Z[Index]);
+    CatalogNumber = Field.GetCatalog().CatalogNumber[Index];
+    VisualMagnitude = Field.GetCatalog().VisualMagnitude[Index];
+    return true;
+}
+
+
+void UMaxQStarFieldComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (Loading.IsValid() && Loading.IsReady())
+    {
+        TSharedPtr<FLoaded, ESPMode::ThreadSafe> Loaded = Loading.Get();
+        Loading.Reset();
+
+        if (Loaded->ResultCode != ES_ResultCode::Success)
+        {
+            OnError.Broadcast(Loaded->ErrorMessage);
+        }
+        else
+        {
+            OnLoaded.Broadcast(SetStarCatalog(MoveTemp(Loaded->Catalog)));
+        }
+    }
+
+    if (InFlight.IsValid())
+    {
+        if (!InFlight.IsReady())
+        {
+            return;
+        }
+        InFlight.Reset();
+        Apply();
+    }
+
+    if (Field.Num() == 0)
+    {
+        return;
+    }
+
+    FSEphemerisTime et = Epoch;
+    if (bFollowSubsystem)
+    {
+        if (const UMaxQEphemerisSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr)
+        {
+            et = Subsystem->Epoch;
+        }
+    }
+
+    if (bStale || FMath::Abs(et.AsSpiceDouble() - DisplayedEpoch.AsSpiceDouble()) >= RefreshSeconds)
+    {
+        Launch(et);
+    }
+}
+
+
+void UMaxQStarFieldComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    Wait();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+void UMaxQStarFieldComponent::BeginDestroy()
+{
+    Wait();
+
+    Super::BeginDestroy();
+}
+
+
+void UMaxQStarFieldComponent::Launch(const FSEphemerisTime& et)
+{
+    FSVelocityVector vobs;
+    if (bAberration)
+    {
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        FSStateVector State;
+        FSEphemerisPeriod lt;
+        USpice::spkezr(ResultCode, ErrorMessage, et, State, lt, Observer, TEXT("SOLAR SYSTEM BARYCENTER"), TEXT("J2000"));
+        if (ResultCode == ES_ResultCode::Success)
+        {
+            vobs = State.v;
+        }
+        else
+        {
+            OnError.Broadcast(ErrorMessage);
+        }
+    }
+
+    bStale = false;
+
+    InFlight = Async(EAsyncExecution::TaskGraph, [this, et, vobs, _Radius = Radius, _InstanceScale = InstanceScale, _ReferenceMagnitude = ReferenceMagnitude, _MinScale = MinScale]()
+    {
+        Field.Update(et, vobs);
+
+        const MaxQ::Math::FConstVectorBatch Directions = Field.Directions();
+        const TArray<float>& Magnitudes = Field.GetCatalog().VisualMagnitude;
+        const int32 Num = Field.Num();
+        Transforms.SetNum(Num, false);
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const FVector Location = MaxQ::Math::Swizzle(FSDimensionlessVector(Directions.X[i], Directions.Y[i], Directions.Z[i])) * _Radius;
+                const double Brightness = FMath::Max(FMath::Pow(10., -0.2 * (Magnitudes[i] - _ReferenceMagnitude)), _MinScale);
+                Transforms[i] = FTransform(FQuat::Identity, Location, _InstanceScale * Brightness);
+            }
+        }, Num <= ChunkSize);
+    });
+}
+
+
+void UMaxQStarFieldComponent::Apply()
+{
+    DisplayedEpoch = Field.GetEpoch();
+
+    if (Transforms.Num() != GetInstanceCount())
+    {
+        return;
+    }
+
+    BatchUpdateInstancesTransforms(0, Transforms, false, false, true);
+    MarkRenderStateDirty();
+}
+
+
+void UMaxQStarFieldComponent::Wait()
+{
+    // Left for the next tick to apply
+    if (InFlight.IsValid())
+    {
+        InFlight.Wait();
+    }
+}
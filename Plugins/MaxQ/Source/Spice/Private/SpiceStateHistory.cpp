@@ -0,0 +1,410 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStateHistory.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A compressed history of many objects' states, for scrubbing.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStateHistory.cpp is part of the "refined C++ API".
+//
+// Quantized residuals are clamped to +/-32767, so -32768 in an object's first
+// component is free to mark the ones that aren't residuals:  its second
+// component says whether the object was invalid (zero) or escaped (see the
+// slice's escapes).  Escapes are found by binary search, so the decode's
+// chunks don't need to know where each other's start.
+//
+// Record's predictions and the decode's come from FTwoBodyBatchPropagators
+// built from the same key states, so they agree to the bit.
+//------------------------------------------------------------------------------
+
+#include "SpiceStateHistory.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Objects per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    constexpr int16 Marker = -32768;
+    constexpr int16 MarkerInvalid = 0;
+    constexpr int16 MarkerEscape = 1;
+    constexpr double MaxQuanta = 32767.;
+
+    // Hermite basis on [0, 1], and its derivative
+    inline void Hermite(double s, double (&h)[4], double (&dh)[4])
+    {
+        const double s2 = s * s, s3 = s2 * s;
+        h[0] = 2. * s3 - 3. * s2 + 1.;
+        h[1] = s3 - 2. * s2 + s;
+        h[2] = -2. * s3 + 3. * s2;
+        h[3] = s3 - s2;
+        dh[0] = 6. * s2 - 6. * s;
+        dh[1] = 3. * s2 - 4. * s + 1.;
+        dh[2] = -6. * s2 + 6. * s;
+        dh[3] = 3. * s2 - 2. * s;
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    struct FStateHistory::FBlock
+    {
+        struct FEscape
+        {
+            int32 Object;
+            FSStateVector State;
+        };
+
+        TArray<double> Times;
+        TArray<FSStateVector> Key;
+
+        // Slice-major:  (Times.Num() - 1) * Num * 6
+        TArray<int16> Residuals;
+
+        // Per slice after the key, sorted by object
+        TArray<TArray<FEscape>> Escapes;
+
+        SIZE_T GetAllocatedSize() const
+        {
+            SIZE_T Size = sizeof(*this) + Times.GetAllocatedSize() + Key.GetAllocatedSize() + Residuals.GetAllocatedSize() + Escapes.GetAllocatedSize();
+            for (const TArray<FEscape>& Slice : Escapes)
+            {
+                Size += Slice.GetAllocatedSize();
+            }
+            return Size;
+        }
+    };
+
+
+    FStateHistory::FStateHistory(const FStateHistorySettings& _Settings)
+        : Settings(_Settings)
+    {
+        Settings.BlockLength = FMath::Max(Settings.BlockLength, 1);
+        Settings.PositionQuantum = FMath::Max(Settings.PositionQuantum, UE_DOUBLE_SMALL_NUMBER);
+        Settings.VelocityQuantum = FMath::Max(Settings.VelocityQuantum, UE_DOUBLE_SMALL_NUMBER);
+    }
+
+
+    FStateHistory::~FStateHistory() = default;
+
+
+    void FStateHistory::Reset()
+    {
+        Blocks.Reset();
+        Predictor.Reset();
+        Predicted.Reset();
+        NumObjects = 0;
+        TotalSlices = 0;
+        Escapes = 0;
+    }
+
+
+    bool FStateHistory::IsDue(double et) const
+    {
+        return TotalSlices == 0 || et >= GetEnd() + Settings.Interval;
+    }
+
+
+    bool FStateHistory::Record(double et, TArrayView<const FSStateVector> States, TArrayView<const bool> Valid)
+    {
+        if (States.Num() == 0 || (NumObjects > 0 && States.Num() != NumObjects) || (Valid.Num() > 0 && Valid.Num() != States.Num()) || (TotalSlices > 0 && et <= GetEnd()))
+        {
+            return false;
+        }
+        NumObjects = States.Num();
+        const int32 Num = NumObjects;
+
+        // A new key
+        if (Blocks.Num() == 0 || Blocks.Last()->Times.Num() >= Settings.BlockLength)
+        {
+            FBlock& Block = *Blocks.Add_GetRef(MakeUnique<FBlock>());
+            Block.Times.Add(et);
+            Block.Key.Append(States.GetData(), States.Num());
+            Block.Residuals.Reserve((Settings.BlockLength - 1) * Num * 6);
+            Block.Escapes.Reserve(Settings.BlockLength - 1);
+            for (int32 i = 0; i < Valid.Num(); ++i)
+            {
+                if (!Valid[i])
+                {
+                    Block.Key[i] = FSStateVector();
+                }
+            }
+            Predictor.Build(FSMassConstant(Settings.GM), Block.Key, FSEphemerisTime(et));
+            ++TotalSlices;
+            Trim();
+            return true;
+        }
+
+        FBlock& Block = *Blocks.Last();
+        Predicted.SetNumUninitialized(Num, false);
+        Predictor.Propagate(FSEphemerisTime(et), Predicted);
+
+        const int32 First = Block.Residuals.Num();
+        Block.Residuals.AddUninitialized(Num * 6);
+
+        const int32 Chunks = (Num + ChunkSize - 1) / ChunkSize;
+        TArray<TArray<FBlock::FEscape>> ChunkEscapes;
+        ChunkEscapes.SetNum(Chunks);
+
+        const double Quanta[6] = {
+            1. / Settings.PositionQuantum, 1. / Settings.PositionQuantum, 1. / Settings.PositionQuantum,
+            1. / Settings.VelocityQuantum, 1. / Settings.VelocityQuantum, 1. / Settings.VelocityQuantum
+        };
+
+        ParallelFor(Chunks, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                int16* Out = &Block.Residuals[First + i * 6];
+                if (Valid.Num() > 0 && !Valid[i])
+                {
+                    Out[0] = Marker;
+                    Out[1] = MarkerInvalid;
+                    continue;
+                }
+
+                double Actual[6], Prediction[6];
+                States[i].CopyTo(Actual);
+                Predicted[i].CopyTo(Prediction);
+
+                bool bFits = Predictor.IsValid(i);
+                double q[6];
+                for (int32 c = 0; c < 6 && bFits; ++c)
+                {
+                    q[c] = FMath::RoundHalfFromZero((Actual[c] - Prediction[c]) * Quanta[c]);
+                    bFits = FMath::Abs(q[c]) <= MaxQuanta;
+                }
+
+                if (bFits)
+                {
+                    for (int32 c = 0; c < 6; ++c)
+                    {
+                        Out[c] = (int16)q[c];
+                    }
+                }
+                else
+                {
+                    Out[0] = Marker;
+                    Out[1] = MarkerEscape;
+                    ChunkEscapes[Chunk].Add({ i, States[i] });
+                }
+            }
+        }, Num <= ChunkSize);
+
+        // Chunk order is object order
+        TArray<FBlock::FEscape>& SliceEscapes = Block.Escapes.AddDefaulted_GetRef();
+        for (const TArray<FBlock::FEscape>& Chunk : ChunkEscapes)
+        {
+            SliceEscapes.Append(Chunk);
+        }
+        SliceEscapes.Shrink();
+        Escapes += SliceEscapes.Num();
+
+        Block.Times.Add(et);
+        ++TotalSlices;
+        Trim();
+        return true;
+    }
+
+
+    void FStateHistory::Trim()
+    {
+        // Never the block being recorded
+        if (Settings.MaxSlices > 0)
+        {
+            while (Blocks.Num() > 1 && TotalSlices > Settings.MaxSlices)
+            {
+                TotalSlices -= Blocks[0]->Times.Num();
+                Blocks.RemoveAt(0);
+            }
+        }
+    }
+
+
+    void FStateHistory::DecodeBlockSlice(const FBlock& Block, const FTwoBodyBatchPropagator& BlockPredictor, int32 Index, TArrayView<FSStateVector> OutStates) const
+    {
+        const int32 Num = NumObjects;
+        if (Index == 0)
+        {
+            FMemory::Memcpy(OutStates.GetData(), Block.Key.GetData(), Num * sizeof(FSStateVector));
+            return;
+        }
+
+        BlockPredictor.Propagate(FSEphemerisTime(Block.Times[Index]), OutStates);
+
+        const int16* Residuals = &Block.Residuals[(Index - 1) * Num * 6];
+        const TArray<FBlock::FEscape>& SliceEscapes = Block.Escapes[Index - 1];
+        const double Quanta[6] = {
+            Settings.PositionQuantum, Settings.PositionQuantum, Settings.PositionQuantum,
+            Settings.VelocityQuantum, Settings.VelocityQuantum, Settings.VelocityQuantum
+        };
+
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                const int16* In = &Residuals[i * 6];
+                if (In[0] == Marker)
+                {
+                    if (In[1] == MarkerEscape)
+                    {
+                        const int32 At = Algo::LowerBoundBy(SliceEscapes, i, &FBlock::FEscape::Object);
+                        check(SliceEscapes.IsValidIndex(At) && SliceEscapes[At].Object == i);
+                        OutStates[i] = SliceEscapes[At].State;
+                    }
+                    else
+                    {
+                        OutStates[i] = FSStateVector();
+                    }
+                    continue;
+                }
+
+                double State[6];
+                OutStates[i].CopyTo(State);
+                for (int32 c = 0; c < 6; ++c)
+                {
+                    State[c] += In[c] * Quanta[c];
+                }
+                OutStates[i] = FSStateVector(State);
+            }
+        }, Num <= ChunkSize);
+    }
+
+
+    bool FStateHistory::DecodeSlice(int32 Slice, TArrayView<FSStateVector> OutStates) const
+    {
+        if (Slice < 0 || Slice >= TotalSlices || OutStates.Num() != NumObjects)
+        {
+            return false;
+        }
+
+        // Every block but the last is full (blocks are only ever dropped whole)
+        const int32 Block = Slice / Settings.BlockLength;
+        const int32 Index = Slice % Settings.BlockLength;
+
+        FTwoBodyBatchPropagator BlockPredictor;
+        if (Index > 0)
+        {
+            BlockPredictor.Build(FSMassConstant(Settings.GM), Blocks[Block]->Key, FSEphemerisTime(Blocks[Block]->Times[0]));
+        }
+        DecodeBlockSlice(*Blocks[Block], BlockPredictor, Index, OutStates);
+        return true;
+    }
+
+
+    bool FStateHistory::Sample(double et, TArrayView<FSStateVector> OutStates) const
+    {
+        if (TotalSlices == 0 || OutStates.Num() != NumObjects || et < GetStart() || et > GetEnd())
+        {
+            return false;
+        }
+
+        // The last slice at or before et
+        const int32 Block = FMath::Max(0, Algo::UpperBoundBy(Blocks, et, [](const TUniquePtr<FBlock>& b) { return b->Times[0]; }) - 1);
+        const FBlock& Before = *Blocks[Block];
+        const int32 Index = FMath::Max(0, Algo::UpperBound(Before.Times, et) - 1);
+
+        FTwoBodyBatchPropagator BeforePredictor;
+        BeforePredictor.Build(FSMassConstant(Settings.GM), Before.Key, FSEphemerisTime(Before.Times[0]));
+
+        const double t0 = Before.Times[Index];
+        const bool bLast = Block == Blocks.Num() - 1 && Index == Before.Times.Num() - 1;
+        if (et == t0 || bLast)
+        {
+            DecodeBlockSlice(Before, BeforePredictor, Index, OutStates);
+            return true;
+        }
+
+        // The slice after it, which may start the next block
+        TArray<FSStateVector> Next;
+        Next.SetNumUninitialized(NumObjects);
+        double t1;
+        DecodeBlockSlice(Before, BeforePredictor, Index, OutStates);
+        if (Index + 1 < Before.Times.Num())
+        {
+            t1 = Before.Times[Index + 1];
+            DecodeBlockSlice(Before, BeforePredictor, Index + 1, Next);
+        }
+        else
+        {
+            const FBlock& After = *Blocks[Block + 1];
+            t1 = After.Times[0];
+            DecodeBlockSlice(After, BeforePredictor, 0, Next);
+        }
+
+        const double h = t1 - t0;
+        double b[4], db[4];
+        Hermite((et - t0) / h, b, db);
+
+        const int32 Num = NumObjects;
+        ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                double s0[6], s1[6], s[6];
+                OutStates[i].CopyTo(s0);
+                Next[i].CopyTo(s1);
+                for (int32 c = 0; c < 3; ++c)
+                {
+                    s[c] = b[0] * s0[c] + b[1] * h * s0[c + 3] + b[2] * s1[c] + b[3] * h * s1[c + 3];
+                    s[c + 3] = (db[0] * s0[c] + db[1] * h * s0[c + 3] + db[2] * s1[c] + db[3] * h * s1[c + 3]) / h;
+                }
+                OutStates[i] = FSStateVector(s);
+            }
+        }, Num <= ChunkSize);
+
+        return true;
+    }
+
+
+    double FStateHistory::GetSliceTime(int32 Slice) const
+    {
+        if (Slice < 0 || Slice >= TotalSlices)
+        {
+            return 0.;
+        }
+
+        return Blocks[Slice / Settings.BlockLength]->Times[Slice % Settings.BlockLength];
+    }
+
+
+    double FStateHistory::GetStart() const
+    {
+        return Blocks.Num() > 0 ? Blocks[0]->Times[0] : 0.;
+    }
+
+
+    double FStateHistory::GetEnd() const
+    {
+        return Blocks.Num() > 0 ? Blocks.Last()->Times.Last() : 0.;
+    }
+
+
+    SIZE_T FStateHistory::GetAllocatedSize() const
+    {
+        SIZE_T Size = Blocks.GetAllocatedSize() + Predictor.GetAllocatedSize() + Predicted.GetAllocatedSize();
+        for (const TUniquePtr<FBlock>& Block : Blocks)
+        {
+            Size += Block->GetAllocatedSize();
+        }
+        return Size;
+    }
+}
@@ -0,0 +1,445 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStateStream.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Live state vector telemetry, interpolated at render rate.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStateStream.cpp is part of the "refined C++ API".
+//
+// The ring buffers are a seqlock over a range of samples, rather than one
+// sample:  the writer bumps Claimed before it overwrites a slot, and Head
+// after.  A reader reads Head, copies what it needs (binary searching the
+// published range), and then checks Claimed.  If the slot being written
+// (or any written since) was one it read from, it retries.  One slot is
+// never read, so a reader keeps up with a writer that's mid-sample.
+//
+// The interpolation is hrmint's:  Newton divided differences over the
+// samples, each one doubled (so the first divided difference at a sample is
+// its velocity).  Positions come from the polynomial, velocities from its
+// derivative, as SPK type 13 evaluates them.
+//------------------------------------------------------------------------------
+
+#include "SpiceStateStream.h"
+#include "SpiceSpkWriter.h"
+#include "Common/UdpSocketBuilder.h"
+#include "Common/UdpSocketReceiver.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace
+{
+    using namespace MaxQ::Ephemeris;
+
+    constexpr int32 MaxWindow = 8;
+    constexpr int32 MaxSnapshotAttempts = 8;
+
+    constexpr uint32 PacketMagic = 'M' | ('X' << 8) | ('Q' << 16) | ('S' << 24);
+    constexpr uint16 PacketVersion = 1;
+    constexpr int32 PacketHeaderSize = sizeof(uint32) + 2 * sizeof(uint16);
+    constexpr int32 PacketRecordSize = sizeof(int32) + 7 * sizeof(double);
+
+    template<typename T>
+    inline T Read(const uint8*& Cursor)
+    {
+        T Value;
+        FMemory::Memcpy(&Value, Cursor, sizeof(T));
+        Cursor += sizeof(T);
+        return Value;
+    }
+
+    // hrmint_c, without the work array.  x[i] are distinct;  f[i] and df[i]
+    // the value and derivative at x[i].
+    void Hermite(int32 n, const double* x, const double* f, const double* df, double t, double& p, double& dp)
+    {
+        const int32 m = 2 * n;
+        double z[2 * MaxWindow];
+        double c[2 * MaxWindow];
+        for (int32 i = 0; i < n; ++i)
+        {
+            z[2 * i] = z[2 * i + 1] = x[i];
+            c[2 * i] = c[2 * i + 1] = f[i];
+        }
+
+        for (int32 j = m - 1; j >= 1; --j)
+        {
+            c[j] = (j & 1) ? df[j / 2] : (c[j] - c[j - 1]) / (z[j] - z[j - 1]);
+        }
+        for (int32 k = 2; k < m; ++k)
+        {
+            for (int32 j = m - 1; j >= k; --j)
+            {
+                c[j] = (c[j] - c[j - 1]) / (z[j] - z[j - k]);
+            }
+        }
+
+        p = c[m - 1];
+        dp = 0.;
+        for (int32 j = m - 2; j >= 0; --j)
+        {
+            dp = dp * (t - z[j]) + p;
+            p = p * (t - z[j]) + c[j];
+        }
+    }
+
+    FStateStreamSettings Sanitize(FStateStreamSettings Settings)
+    {
+        Settings.Window = FMath::Clamp(Settings.Window, 1, MaxWindow);
+        Settings.Capacity = (int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::Max(Settings.Capacity, Settings.Window + 1));
+        Settings.MaxExtrapolationSeconds = FMath::Max(Settings.MaxExtrapolationSeconds, 0.);
+        return Settings;
+    }
+}
+
+
+namespace MaxQ::Ephemeris
+{
+    FStateRingBuffer::FStateRingBuffer(const FStateStreamSettings& _Settings)
+        : Settings(Sanitize(_Settings))
+    {
+        Samples.SetNumZeroed(Settings.Capacity);
+        Mask = (uint64)Settings.Capacity - 1;
+    }
+
+
+    bool FStateRingBuffer::Push(double et, const double(&state)[6])
+    {
+        if (!(et > NewestEt))
+        {
+            Dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const uint64 h = Head.load(std::memory_order_relaxed);
+        Claimed.store(h + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        FSample& Sample = Samples[h & Mask];
+        Sample.et = et;
+        FMemory::Memcpy(Sample.state, state, sizeof(Sample.state));
+
+        Head.store(h + 1, std::memory_order_release);
+        NewestEt = et;
+        return true;
+    }
+
+
+    int32 FStateRingBuffer::Snapshot(FSample* Out, int32 Count, double et) const
+    {
+        const uint64 Slack = (uint64)Samples.Num() - 1;
+
+        for (int32 Attempt = 0; Attempt < MaxSnapshotAttempts; ++Attempt)
+        {
+            const uint64 h = Head.load(std::memory_order_acquire);
+            if (h == 0)
+            {
+                return 0;
+            }
+            const uint64 Oldest = h > Slack ? h - Slack : 0;
+
+            // First sample after et
+            uint64 Lo = Oldest, Hi = h;
+            while (Lo < Hi)
+            {
+                const uint64 Mid = Lo + (Hi - Lo) / 2;
+                if (Samples[Mid & Mask].et <= et) Lo = Mid + 1; else Hi = Mid;
+            }
+
+            const int32 n = (int32)FMath::Min<uint64>(Count, h - Oldest);
+            const uint64 First = FMath::Clamp<uint64>(Lo > (uint64)(n / 2) ? Lo - n / 2 : 0, Oldest, h - n);
+            for (int32 i = 0; i < n; ++i)
+            {
+                Out[i] = Samples[(First + i) & Mask];
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Claimed.load(std::memory_order_relaxed) <= Oldest + Samples.Num())
+            {
+                return n;
+            }
+        }
+
+        return 0;
+    }
+
+
+    bool FStateRingBuffer::Interpolate(double et, double(&state)[6], bool* bExtrapolated) const
+    {
+        if (bExtrapolated) *bExtrapolated = false;
+
+        FSample Window[MaxWindow];
+        const int32 n = Snapshot(Window, Settings.Window, et);
+        if (n == 0 || et < Window[0].et)
+        {
+            return false;
+        }
+
+        const FSample& Newest = Window[n - 1];
+        if (et >= Newest.et)
+        {
+            const double dt = et - Newest.et;
+            if (dt > Settings.MaxExtrapolationSeconds)
+            {
+                return false;
+            }
+            for (int32 c = 0; c < 3; ++c)
+            {
+                state[c] = Newest.state[c] + dt * Newest.state[3 + c];
+                state[3 + c] = Newest.state[3 + c];
+            }
+            if (bExtrapolated) *bExtrapolated = dt > 0.;
+            return true;
+        }
+
+        double x[MaxWindow], f[MaxWindow], df[MaxWindow];
+        for (int32 i = 0; i < n; ++i)
+        {
+            x[i] = Window[i].et;
+        }
+        for (int32 c = 0; c < 3; ++c)
+        {
+            for (int32 i = 0; i < n; ++i)
+            {
+                f[i] = Window[i].state[c];
+                df[i] = Window[i].state[3 + c];
+            }
+            Hermite(n, x, f, df, et, state[c], state[3 + c]);
+        }
+        return true;
+    }
+
+
+    bool FStateRingBuffer::Interpolate(const FSEphemerisTime& et, FSStateVector& state, bool* bExtrapolated) const
+    {
+        double _state[6];
+        if (!Interpolate(et.AsSpiceDouble(), _state, bExtrapolated))
+        {
+            return false;
+        }
+        state = FSStateVector(_state);
+        return true;
+    }
+
+
+    bool FStateRingBuffer::Latest(double& et, double(&state)[6]) const
+    {
+        FSample Sample;
+        if (Snapshot(&Sample, 1, TNumericLimits<double>::Max()) == 0)
+        {
+            return false;
+        }
+        et = Sample.et;
+        FMemory::Memcpy(state, Sample.state, sizeof(Sample.state));
+        return true;
+    }
+
+
+    FStateStream::FStateStream(const FStateStreamSettings& _Settings)
+        : Settings(Sanitize(_Settings))
+    {
+    }
+
+    FStateStream::~FStateStream() = default;
+
+
+    bool FStateStream::Push(int32 ObjectId, double et, const double(&state)[6])
+    {
+        FObject Object;
+        {
+            FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+            if (const FObject* Found = Objects.Find(ObjectId))
+            {
+                Object = *Found;
+            }
+        }
+
+        if (!Object.Buffer.IsValid())
+        {
+            FRWScopeLock ScopeLock(Lock, SLT_Write);
+            FObject& Added = Objects.FindOrAdd(ObjectId);
+            if (!Added.Buffer.IsValid())
+            {
+                Added.Buffer = MakeShared<FStateRingBuffer, ESPMode::ThreadSafe>(Settings);
+            }
+            Object = Added;
+        }
+
+        if (!Object.Buffer->Push(et, state))
+        {
+            return false;
+        }
+
+        if (Object.Recorder.IsValid())
+        {
+            Object.Recorder->Add(FSEphemerisTime(et), FSStateVector(state));
+        }
+        return true;
+    }
+
+
+    bool FStateStream::Push(int32 ObjectId, const FSEphemerisTime& et, const FSStateVector& state)
+    {
+        double _state[6];
+        state.CopyTo(_state);
+        return Push(ObjectId, et.AsSpiceDouble(), _state);
+    }
+
+
+    int32 FStateStream::Ingest(TArrayView<const uint8> Packet)
+    {
+        if (Packet.Num() < PacketHeaderSize)
+        {
+            return INDEX_NONE;
+        }
+
+        const uint8* Cursor = Packet.GetData();
+        const uint32 Magic = Read<uint32>(Cursor);
+        const uint16 Version = Read<uint16>(Cursor);
+        const uint16 Count = Read<uint16>(Cursor);
+
+        if (Magic != PacketMagic || Version != PacketVersion || Packet.Num() != PacketHeaderSize + Count * PacketRecordSize)
+        {
+            return INDEX_NONE;
+        }
+
+        int32 Accepted = 0;
+        for (int32 i = 0; i < Count; ++i)
+        {
+            const int32 ObjectId = Read<int32>(Cursor);
+            const double et = Read<double>(Cursor);
+            double state[6];
+            for (double& Component : state)
+            {
+                Component = Read<double>(Cursor);
+            }
+            Accepted += Push(ObjectId, et, state) ? 1 : 0;
+        }
+        return Accepted;
+    }
+
+
+    TSharedPtr<const FStateRingBuffer, ESPMode::ThreadSafe> FStateStream::Find(int32 ObjectId) const
+    {
+        FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+        const FObject* Object = Objects.Find(ObjectId);
+        return Object ? Object->Buffer : nullptr;
+    }
+
+
+    bool FStateStream::Interpolate(int32 ObjectId, double et, double(&state)[6], bool* bExtrapolated) const
+    {
+        TSharedPtr<const FStateRingBuffer, ESPMode::ThreadSafe> Buffer = Find(ObjectId);
+        if (!Buffer.IsValid())
+        {
+            if (bExtrapolated) *bExtrapolated = false;
+            return false;
+        }
+        return Buffer->Interpolate(et, state, bExtrapolated);
+    }
+
+
+    bool FStateStream::Interpolate(int32 ObjectId, const FSEphemerisTime& et, FSStateVector& state, bool* bExtrapolated) const
+    {
+        TSharedPtr<const FStateRingBuffer, ESPMode::ThreadSafe> Buffer = Find(ObjectId);
+        if (!Buffer.IsValid())
+        {
+            if (bExtrapolated) *bExtrapolated = false;
+            return false;
+        }
+        return Buffer->Interpolate(et, state, bExtrapolated);
+    }
+
+
+    TArray<int32> FStateStream::ObjectIds() const
+    {
+        FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+        TArray<int32> Ids;
+        Objects.GetKeys(Ids);
+        return Ids;
+    }
+
+
+    void FStateStream::Record(int32 ObjectId, TSharedPtr<FSpkSegmentWriter, ESPMode::ThreadSafe> Writer)
+    {
+        FRWScopeLock ScopeLock(Lock, SLT_Write);
+        FObject& Object = Objects.FindOrAdd(ObjectId);
+        if (!Object.Buffer.IsValid())
+        {
+            Object.Buffer = MakeShared<FStateRingBuffer, ESPMode::ThreadSafe>(Settings);
+        }
+        Object.Recorder = MoveTemp(Writer);
+    }
+
+
+    FStateStreamReceiver::FStateStreamReceiver(FStateStream& _Stream)
+        : Stream(_Stream)
+    {
+    }
+
+    FStateStreamReceiver::~FStateStreamReceiver()
+    {
+        Stop();
+    }
+
+
+    bool FStateStreamReceiver::Start(int32 Port, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Stop();
+
+        Socket = FUdpSocketBuilder(TEXT("MaxQStateStream"))
+            .AsNonBlocking()
+            .AsReusable()
+            .BoundToPort(Port)
+            .WithReceiveBufferSize(2 * 1024 * 1024)
+            .Build();
+
+        if (!Socket)
+        {
+            if (ResultCode) *ResultCode = ES_ResultCode::Error;
+            if (ErrorMessage) *ErrorMessage = FString::Printf(TEXT("FStateStreamReceiver::Start: could not bind UDP port %d"), Port);
+            return false;
+        }
+
+        Receiver = MakeUnique<FUdpSocketReceiver>(Socket, FTimespan::FromMilliseconds(100), TEXT("MaxQStateStreamReceiver"));
+        Receiver->OnDataReceived().BindLambda([this](const FArrayReaderPtr& Data, const FIPv4Endpoint&)
+        {
+            Packets.fetch_add(1, std::memory_order_relaxed);
+            if (Stream.Ingest(TArrayView<const uint8>(Data->GetData(), Data->Num())) == INDEX_NONE)
+            {
+                Malformed.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        Receiver->Start();
+
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    void FStateStreamReceiver::Stop()
+    {
+        // Joins the receiver thread
+        Receiver.Reset();
+
+        if (Socket)
+        {
+            Socket->Close();
+            ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+            Socket = nullptr;
+        }
+    }
+}
@@ -20,6 +20,8 @@
 #include "Containers/StringFwd.h"
 #include "Spice.h"
 #include "SpiceUtilities.h"
+#include "SpiceTime.h"
+#include "SpiceFormat.h"
 
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
@@ -89,7 +91,9 @@ double FSDistanceVector::f() const
 
 FString FSDistanceVector::ToString() const
 {
-    return FString::Printf(TEXT("(%s, %s, %s)"), *USpiceTypes::FormatDouble(x.km), *USpiceTypes::FormatDouble(y.km), *USpiceTypes::FormatDouble(z.km));
+    TStringBuilder<128> sb;
+    MaxQ::Format::Append(sb, *this);
+    return sb.ToString();
 }
 
 
@@ -105,7 +109,9 @@ FString FSDistance::ToString(ES_Units Units, int precision /*= 12*/) const
 
 FString FSDimensionlessVector::ToString() const
 {
-    return FString::Printf(TEXT("(%s, %s, %s)"), *USpiceTypes::FormatDouble(x), *USpiceTypes::FormatDouble(y), *USpiceTypes::FormatDouble(z));
+    TStringBuilder<128> sb;
+    MaxQ::Format::Append(sb, *this);
+    return sb.ToString();
 }
 
 
@@ -142,6 +148,17 @@ FString FSComplexScalar::ToString() const
 
 FString FSEphemerisTime::ToString() const
 {
+    if (MaxQ::Time::UpdateTimeSystem())
+    {
+        TCHAR Buffer[64];
+        const int32 Len = MaxQ::Time::GetTimeSystem()->Format(AsSpiceDouble(), ES_UTCTimeFormat::Calendar, 4, Buffer, UE_ARRAY_COUNT(Buffer) - 4);
+        if (Len)
+        {
+            FCString::Strcpy(Buffer + Len, 5, TEXT(" UTC"));
+            return FString(Len + 4, Buffer);
+        }
+    }
+
     SpiceChar sz[SPICE_MAX_PATH];
     memset(sz, 0, sizeof(sz));
 
@@ -164,6 +181,11 @@ FString FSEphemerisTime::ToString(ES_UTCTimeFormat TimeFormat, int precision /*=
 FSEphemerisTime FSEphemerisTime::FromString(const FString& Str)
 {
     double et = 0.;
+    if (MaxQ::Time::UpdateTimeSystem() && MaxQ::Time::GetTimeSystem()->Parse(*Str, et))
+    {
+        return FSEphemerisTime(et);
+    }
+
     str2et_c(TCHAR_TO_ANSI(*Str), &et);
 
     // Do not reset any error state, the downstream computation will detect the signal if the string failed to convert.
@@ -184,7 +206,9 @@ FString FSEphemerisPeriod::ToString(ES_Units Units, int precision /*= 12*/) cons
 
 FString FSVelocityVector::ToString() const
 {
-    return FString::Printf(TEXT("(%s, %s, %s)"), *USpiceTypes::FormatDouble(dx.kmps), *USpiceTypes::FormatDouble(dy.kmps), *USpiceTypes::FormatDouble(dz.kmps));
+    TStringBuilder<128> sb;
+    MaxQ::Format::Append(sb, *this);
+    return sb.ToString();
 }
 
 FString FSLonLat::ToString() const
@@ -227,7 +251,9 @@ FString FSDimensionlessStateVector::ToString() const
 
 FString FSStateVector::ToString() const
 {
-    return FString::Printf(TEXT("[(%s, %s, %s); (%s, %s, %s)]"), *USpiceTypes::FormatDouble(r.x.km), *USpiceTypes::FormatDouble(r.y.km), *USpiceTypes::FormatDouble(r.z.km), *USpiceTypes::FormatDouble(v.dx.kmps), *USpiceTypes::FormatDouble(v.dy.kmps), *USpiceTypes::FormatDouble(v.dz.kmps));
+    TStringBuilder<256> sb;
+    MaxQ::Format::Append(sb, *this);
+    return sb.ToString();
 }
 
 FString FSCylindricalVector::ToString() const
@@ -973,3 +999,73 @@ FSAngularRate FSAngularVelocity::Magnitude() const
 
 
 
+
+
+void FSTLECatalog::Reset()
+{
+    ObjectIds.Reset();
+    ObjectNames.Reset();
+    for (auto& Column : Columns)
+    {
+        Column.Reset();
+    }
+}
+
+void FSTLECatalog::Reserve(int32 Number)
+{
+    ObjectIds.Reserve(Number);
+    ObjectNames.Reserve(Number);
+    for (auto& Column : Columns)
+    {
+        Column.Reserve(Number);
+    }
+}
+
+SIZE_T FSTLECatalog::GetAllocatedSize() const
+{
+    SIZE_T Size = ObjectIds.GetAllocatedSize() + ObjectNames.GetAllocatedSize();
+    for (int32 i = 0; i < ObjectIds.Num(); ++i)
+    {
+        Size += ObjectIds[i].GetAllocatedSize() + ObjectNames[i].GetAllocatedSize();
+    }
+    for (const auto& Column : Columns)
+    {
+        Size += Column.GetAllocatedSize();
+    }
+    return Size;
+}
+
+int32 FSTLECatalog::Add(const FString& ObjectId, const FString& ObjectName, const double(&_elems)[10])
+{
+    ObjectNames.Add(ObjectName);
+    for (int32 i = 0; i < 10; ++i)
+    {
+        Columns[i].Add(_elems[i]);
+    }
+    return ObjectIds.Add(ObjectId);
+}
+
+void FSTLECatalog::Append(const FSTLECatalog& Other)
+{
+    ObjectIds.Append(Other.ObjectIds);
+    ObjectNames.Append(Other.ObjectNames);
+    for (int32 i = 0; i < 10; ++i)
+    {
+        Columns[i].Append(Other.Columns[i]);
+    }
+}
+
+void FSTLECatalog::CopyTo(int32 Index, double(&_elems)[10]) const
+{
+    for (int32 i = 0; i < 10; ++i)
+    {
+        _elems[i] = Columns[i][Index];
+    }
+}
+
+FSTwoLineElements FSTLECatalog::GetElements(int32 Index) const
+{
+    double _elems[10];
+    CopyTo(Index, _elems);
+    return FSTwoLineElements(_elems);
+}
@@ -0,0 +1,349 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTLEBake.cpp
+//
+// Implementation Comments
+//
+// Purpose:  TLE catalogs baked into SPK files, for replay.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTLEBake.cpp is part of the "refined C++ API".
+//
+// The TEME to J2000 transformation depends only on the epoch, so it's taken
+// from zzteme once per sample epoch (on the calling thread), and every
+// object's samples are rotated with it natively.  SGP4 itself is the native
+// FSGP4Propagator, which matches evsgp4 (and spke10's xxsgp4e).
+//------------------------------------------------------------------------------
+
+#include "SpiceTLEBake.h"
+#include "SpiceSGP4.h"
+#include "SpiceUtilities.h"
+#include "Spice.h"
+#include "Async/ParallelFor.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+
+// for zzteme_
+#include "SpiceZfc.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    // NAIF's TLE body IDs are -100000 - NORAD number
+    constexpr int32 TLEBodyBase = -100000;
+
+    // spkw.. segment identifiers
+    constexpr int32 MaxSegmentIdLength = 40;
+
+    bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        if (ResultCode) *ResultCode = ES_ResultCode::Error;
+        if (ErrorMessage) *ErrorMessage = Message;
+        return false;
+    }
+
+    FSTLEGeophysicalConstants EarthConstants(const FSTLEGeophysicalConstants& geophs)
+    {
+        FSTLEGeophysicalConstants _geophs = geophs;
+        if (_geophs.geophs.Num() != 8)
+        {
+            USpice::getgeophs(_geophs, TEXT("EARTH"));
+        }
+        return _geophs;
+    }
+}
+
+namespace MaxQ::Orbits
+{
+    SPICE_API int32 TLEBodyId(const FString& ObjectId)
+    {
+        const FString Trimmed = ObjectId.TrimStartAndEnd();
+        if (Trimmed.IsEmpty() || Trimmed.Len() > 9)
+        {
+            return 0;
+        }
+        for (TCHAR c : Trimmed)
+        {
+            if (!FChar::IsDigit(c))
+            {
+                return 0;
+            }
+        }
+        return TLEBodyBase - FCString::Atoi(*Trimmed);
+    }
+
+
+    SPICE_API void GroupTLEObjects(const FSTLECatalog& Catalog, TArray<FTLEBakedObject>& Objects, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        Objects.Reset();
+
+        FString FirstError;
+        TMap<int32, int32> ObjectMap;
+        for (int32 i = 0; i < Catalog.Num(); ++i)
+        {
+            const int32 Body = TLEBodyId(Catalog.ObjectIds[i]);
+            if (Body == 0)
+            {
+                if (FirstError.IsEmpty())
+                {
+                    FirstError = FString::Printf(TEXT("GroupTLEObjects: object id '%s' is not a NORAD catalog number"), *Catalog.ObjectIds[i]);
+                }
+                continue;
+            }
+
+            int32* Object = ObjectMap.Find(Body);
+            if (!Object)
+            {
+                Object = &ObjectMap.Add(Body, Objects.Num());
+                FTLEBakedObject& NewObject = Objects.AddDefaulted_GetRef();
+                NewObject.Body = Body;
+                const FString& Name = Catalog.ObjectNames.IsValidIndex(i) && !Catalog.ObjectNames[i].IsEmpty() ? Catalog.ObjectNames[i] : Catalog.ObjectIds[i];
+                NewObject.SegmentId = Name.Left(MaxSegmentIdLength);
+            }
+            Objects[*Object].Entries.Add(i);
+        }
+
+        for (FTLEBakedObject& Object : Objects)
+        {
+            Object.Entries.StableSort([&Catalog](int32 a, int32 b) { return Catalog.GetEpoch(a).seconds < Catalog.GetEpoch(b).seconds; });
+        }
+
+        if (!FirstError.IsEmpty())
+        {
+            Fail(FirstError, ResultCode, ErrorMessage);
+            return;
+        }
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+    }
+
+
+    SPICE_API bool FitTLEObjects(
+        const FSTLECatalog& Catalog,
+        const FSTLEGeophysicalConstants& geophs,
+        TArrayView<FTLEBakedObject> Objects,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        const FTLEBakeSettings& Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        const double a = Start.AsSpiceDouble();
+        const double b = Stop.AsSpiceDouble();
+        if (Settings.Type == ETLEBakeType::Type10)
+        {
+            return Fail(TEXT("FitTLEObjects: type 10 segments aren't fit"), ResultCode, ErrorMessage);
+        }
+        if (!(b > a) || !(Settings.SampleSeconds > 0.))
+        {
+            return Fail(TEXT("FitTLEObjects: needs Start < Stop, and SampleSeconds > 0"), ResultCode, ErrorMessage);
+        }
+
+        const FSTLEGeophysicalConstants _geophs = EarthConstants(geophs);
+
+        // Every entry's propagator, in the objects' order
+        TArray<int32> FirstPropagator;
+        TArray<FSGP4Propagator> Propagators;
+        FString FirstError;
+        for (const FTLEBakedObject& Object : Objects)
+        {
+            FirstPropagator.Add(Propagators.Num());
+            for (int32 Entry : Object.Entries)
+            {
+                ES_ResultCode _ResultCode;
+                FString _ErrorMessage;
+                FSGP4Propagator& Propagator = Propagators.AddDefaulted_GetRef();
+                if (!Propagator.Init(_geophs, Catalog.GetElements(Entry), &_ResultCode, &_ErrorMessage) && FirstError.IsEmpty())
+                {
+                    FirstError = FString::Printf(TEXT("%s (%s)"), *_ErrorMessage, *Catalog.ObjectIds[Entry]);
+                }
+            }
+        }
+
+        // Sample epochs, and TEME -> J2000 at each
+        const int32 NumSamples = FMath::CeilToInt((b - a) / Settings.SampleSeconds) + 1;
+        TArray<double> ets;
+        TArray<double> Transforms;
+        ets.SetNumUninitialized(NumSamples);
+        Transforms.SetNumUninitialized(NumSamples * 36);
+        for (int32 k = 0; k < NumSamples; ++k)
+        {
+            ets[k] = FMath::Min(a + k * Settings.SampleSeconds, b);
+
+            double j2tm[36];
+            zzteme_(&ets[k], j2tm, &Transforms[k * 36]);
+        }
+        if (ErrorCheck(ResultCode, ErrorMessage))
+        {
+            return false;
+        }
+
+        MaxQ::Ephemeris::FSpkChebyshevFitSettings Fit = Settings.Fit;
+        Fit.Type = Settings.Type == ETLEBakeType::Type02 ? MaxQ::Ephemeris::ESpkChebyshevType::Type02 : MaxQ::Ephemeris::ESpkChebyshevType::Type03;
+
+        FCriticalSection ErrorLock;
+        ParallelFor(Objects.Num(), [&](int32 i)
+        {
+            FTLEBakedObject& Object = Objects[i];
+            Object.Segments.Reset();
+
+            TArray<double> Epochs;
+            TArray<FSStateVector> States;
+            Epochs.Reserve(NumSamples);
+            States.Reserve(NumSamples);
+
+            for (int32 k = 0; k < NumSamples; ++k)
+            {
+                // The element set with the closest epoch
+                int32 Closest = 0;
+                for (int32 e = 1; e < Object.Entries.Num(); ++e)
+                {
+                    if (FMath::Abs(ets[k] - Catalog.GetEpoch(Object.Entries[e]).seconds) < FMath::Abs(ets[k] - Catalog.GetEpoch(Object.Entries[Closest]).seconds))
+                    {
+                        Closest = e;
+                    }
+                }
+
+                double teme[6];
+                if (Propagators[FirstPropagator[i] + Closest].Propagate(ets[k], teme) != ESGP4Status::Ok)
+                {
+                    break;
+                }
+
+                // Column major, as mxvg
+                const double* m = &Transforms[k * 36];
+                double j2000[6];
+                for (int32 r = 0; r < 6; ++r)
+                {
+                    double Sum = 0.;
+                    for (int32 c = 0; c < 6; ++c)
+                    {
+                        Sum += m[r + 6 * c] * teme[c];
+                    }
+                    j2000[r] = Sum;
+                }
+
+                Epochs.Add(ets[k]);
+                States.Add(FSStateVector(j2000));
+            }
+
+            if (Epochs.Num() < 2)
+            {
+                return;
+            }
+
+            ES_ResultCode _ResultCode;
+            FString _ErrorMessage;
+            if (!MaxQ::Ephemeris::FitChebyshevSegments(Epochs, States, Object.Segments, Fit, &_ResultCode, &_ErrorMessage))
+            {
+                FScopeLock Lock(&ErrorLock);
+                if (FirstError.IsEmpty())
+                {
+                    FirstError = FString::Printf(TEXT("%s (%d)"), *_ErrorMessage, Object.Body);
+                }
+            }
+        });
+
+        if (!FirstError.IsEmpty())
+        {
+            return Fail(FirstError, ResultCode, ErrorMessage);
+        }
+        if (ResultCode) *ResultCode = ES_ResultCode::Success;
+        if (ErrorMessage) ErrorMessage->Empty();
+        return true;
+    }
+
+
+    SPICE_API int32 BakeTLECatalog(
+        int handle,
+        const FSTLECatalog& Catalog,
+        const FSTLEGeophysicalConstants& geophs,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        const FTLEBakeSettings& Settings,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        ES_ResultCode FirstResult = ES_ResultCode::Success;
+        FString FirstError;
+        auto Keep = [&](ES_ResultCode _ResultCode, const FString& _ErrorMessage)
+        {
+            if (_ResultCode != ES_ResultCode::Success && FirstResult == ES_ResultCode::Success)
+            {
+                FirstResult = _ResultCode;
+                FirstError = _ErrorMessage;
+            }
+            return _ResultCode == ES_ResultCode::Success;
+        };
+
+        ES_ResultCode _ResultCode = ES_ResultCode::Success;
+        FString _ErrorMessage;
+
+        TArray<FTLEBakedObject> Objects;
+        GroupTLEObjects(Catalog, Objects, &_ResultCode, &_ErrorMessage);
+        Keep(_ResultCode, _ErrorMessage);
+
+        int32 Written = 0;
+        if (Settings.Type == ETLEBakeType::Type10)
+        {
+            const FSTLEGeophysicalConstants _geophs = EarthConstants(geophs);
+
+            TArray<FSTwoLineElements> Elements;
+            for (const FTLEBakedObject& Object : Objects)
+            {
+                Elements.Reset();
+                for (int32 Entry : Object.Entries)
+                {
+                    Elements.Add(Catalog.GetElements(Entry));
+                }
+
+                USpice::spkw10(_ResultCode, _ErrorMessage, handle, Object.Body, 399, TEXT("J2000"), Start, Stop, Object.SegmentId, _geophs, Elements);
+                Written += Keep(_ResultCode, _ErrorMessage) ? 1 : 0;
+            }
+        }
+        else
+        {
+            const int32 BatchSize = FMath::Max(Settings.BatchSize, 1);
+            for (int32 First = 0; First < Objects.Num(); First += BatchSize)
+            {
+                TArrayView<FTLEBakedObject> Batch = TArrayView<FTLEBakedObject>(Objects).Slice(First, FMath::Min(BatchSize, Objects.Num() - First));
+
+                FitTLEObjects(Catalog, geophs, Batch, Start, Stop, Settings, &_ResultCode, &_ErrorMessage);
+                Keep(_ResultCode, _ErrorMessage);
+
+                for (FTLEBakedObject& Object : Batch)
+                {
+                    if (Object.Segments.Num() > 0)
+                    {
+                        MaxQ::Ephemeris::WriteChebyshevSegments(handle, Object.Body, 399, TEXT("J2000"), Object.SegmentId, Object.Segments, &_ResultCode, &_ErrorMessage);
+                        Written += Keep(_ResultCode, _ErrorMessage) ? 1 : 0;
+                    }
+                    Object.Segments.Empty();
+                }
+            }
+        }
+
+        if (ResultCode) *ResultCode = FirstResult;
+        if (ErrorMessage) *ErrorMessage = FirstError;
+        return Written;
+    }
+}
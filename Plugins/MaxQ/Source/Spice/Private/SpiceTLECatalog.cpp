@@ -0,0 +1,552 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTLECatalog.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Bulk parsing of Celestrak/Space-Track element sets into a
+// FSTLECatalog.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTLECatalog.cpp is part of the "refined C++ API".
+//
+// Three passes:
+//  1. Split the text into records (line triplets, or JSON objects).  Serial,
+//     but it only looks for line breaks and braces.
+//  2. Parse the records, in parallel.  Epochs come out as UTC seconds past
+//     J2000 (formal calendar, no leapseconds).
+//  3. Convert the epochs to TDB with deltet_c and append to the catalog, in
+//     order, on the calling thread.
+// Field positions and the unit conversions follow zzgetelm.
+//------------------------------------------------------------------------------
+
+#include "SpiceTLECatalog.h"
+#include "SpiceUtilities.h"
+#include "Async/ParallelFor.h"
+#include "String/Find.h"
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double d2r = pi / 180.;
+
+    // Records per ParallelFor task
+    constexpr int32 BatchSize = 512;
+
+    struct FRecord
+    {
+        // TLE:  line views.  JSON:  Line1 is the object's text.
+        FStringView Name;
+        FStringView Line1;
+        FStringView Line2;
+        int32 LineNumber = 0;
+    };
+
+    struct FParsed
+    {
+        FString ObjectId;
+        FString ObjectName;
+        // elems[0..8] as getelm, and the UTC epoch (seconds past J2000)
+        double elems[10] = {};
+        FString Error;
+    };
+
+    // Days from 1970-01-01 to y-m-d, proleptic Gregorian (Hinnant's days_from_civil)
+    int64 DaysFromCivil(int64 y, int64 m, int64 d)
+    {
+        y -= m <= 2;
+        const int64 era = (y >= 0 ? y : y - 399) / 400;
+        const int64 yoe = y - era * 400;
+        const int64 doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        const int64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    // UTC seconds past J2000 (2000-01-01T12:00:00), no leapseconds
+    double UTCSeconds(int64 y, int64 m, int64 d, double SecondsOfDay)
+    {
+        const int64 Days = DaysFromCivil(y, m, d) - DaysFromCivil(2000, 1, 1);
+        return Days * 86400. + SecondsOfDay - 43200.;
+    }
+
+    // Parse [Start, Start + Len) of Line as a double.  Blank fields fail.
+    bool ParseField(FStringView Line, int32 Start, int32 Len, double& Value)
+    {
+        ANSICHAR Buffer[64];
+        int32 n = 0;
+        for (int32 i = Start; i < Start + Len && i < Line.Len() && n < UE_ARRAY_COUNT(Buffer) - 1; ++i)
+        {
+            if (Line[i] != TCHAR(' '))
+            {
+                Buffer[n++] = (ANSICHAR)Line[i];
+            }
+        }
+        Buffer[n] = '\0';
+
+        if (n == 0)
+        {
+            return false;
+        }
+
+        ANSICHAR* End = nullptr;
+        Value = FCStringAnsi::Strtod(Buffer, &End);
+        return End == Buffer + n;
+    }
+
+    // "Implied decimal point" exponential fields, eg " 34965-4" = 0.34965e-4
+    bool ParseImplied(FStringView Line, int32 Start, double& Value)
+    {
+        if (Start + 8 > Line.Len())
+        {
+            return false;
+        }
+
+        const TCHAR Sign = Line[Start];
+        double Mantissa = 0.;
+        for (int32 i = 1; i <= 5; ++i)
+        {
+            TCHAR c = Line[Start + i];
+            if (c == TCHAR(' ')) c = TCHAR('0');
+            if (c < TCHAR('0') || c > TCHAR('9')) return false;
+            Mantissa = Mantissa * 10. + (c - TCHAR('0'));
+        }
+
+        const TCHAR ExpSign = Line[Start + 6];
+        const TCHAR ExpDigit = Line[Start + 7];
+        if (ExpDigit < TCHAR('0') || ExpDigit > TCHAR('9')) return false;
+        if (ExpSign != TCHAR('-') && ExpSign != TCHAR('+') && ExpSign != TCHAR(' ')) return false;
+
+        int32 Exponent = ExpDigit - TCHAR('0');
+        if (ExpSign == TCHAR('-')) Exponent = -Exponent;
+
+        Value = Mantissa * 1e-5 * FMath::Pow(10., (double)Exponent);
+        if (Sign == TCHAR('-')) Value = -Value;
+        return Sign == TCHAR('-') || Sign == TCHAR('+') || Sign == TCHAR(' ');
+    }
+
+    // Mean elements as read (degrees, revs/day, ...) -> getelm's elems
+    bool Convert(double(&elems)[10], double ndt20, double ndd60, double bstar, double incl, double node0, double ecc, double omega, double mo, double no, FString& Error)
+    {
+        if (mo < 0. || mo >= 360.)
+        {
+            Error = FString::Printf(TEXT("MO (mean anomoly) expected bounds [0,360). Actual value %f"), mo);
+            return false;
+        }
+        if (incl < 0. || incl > 180.)
+        {
+            Error = FString::Printf(TEXT("INCL (inclination) expected bounds [0,180). Actual value %f"), incl);
+            return false;
+        }
+        if (no > 20. || no < 0.)
+        {
+            Error = FString::Printf(TEXT("NO (mean motion) expected bounds (0,20). Actual value %f"), no);
+            return false;
+        }
+        if (ecc < 0. || ecc >= 1.)
+        {
+            Error = FString::Printf(TEXT("ECC (eccentricity) expected bounds [0,1). Actual value %f"), ecc);
+            return false;
+        }
+        if (node0 < 0. || node0 >= 360. || omega < 0. || omega >= 360.)
+        {
+            Error = FString::Printf(TEXT("NODE0/OMEGA expected bounds [0,360). Actual values %f, %f"), node0, omega);
+            return false;
+        }
+
+        const double pi2 = 2. * pi;
+        elems[0] = ndt20 * pi2 / 1440. / 1440.;
+        elems[1] = ndd60 * pi2 / 1440. / 1440. / 1440.;
+        elems[2] = bstar;
+        elems[3] = incl * d2r;
+        elems[4] = node0 * d2r;
+        elems[5] = ecc;
+        elems[6] = omega * d2r;
+        elems[7] = mo * d2r;
+        elems[8] = no * pi2 / 1440.;
+        return true;
+    }
+
+    void ParseTLE(const FRecord& Record, int32 frstyr, FParsed& Out)
+    {
+        const FStringView l1 = Record.Line1;
+        const FStringView l2 = Record.Line2;
+
+        Out.ObjectId = FString(l1.Mid(2, 5)).TrimStartAndEnd();
+        Out.ObjectName = Record.Name.Len() > 0 ? FString(Record.Name).TrimStartAndEnd() : Out.ObjectId;
+        if (Out.ObjectName.StartsWith(TEXT("0 ")))
+        {
+            // 3LE name lines
+            Out.ObjectName.RightChopInline(2);
+        }
+
+        double yr, day, ndt20, ndd60, bstar, incl, node0, ecc, omega, mo, no;
+        if (l1.Len() < 61 || l2.Len() < 63)
+        {
+            Out.Error = TEXT("Element set lines are too short");
+            return;
+        }
+
+        // ecc has an implied leading decimal point
+        TStringBuilder<16> eccText;
+        eccText.Append(TEXT("."));
+        eccText.Append(l2.Mid(26, 7));
+
+        if (!ParseField(l1, 18, 2, yr) || !ParseField(l1, 20, 12, day) || !ParseField(l1, 33, 10, ndt20)
+            || !ParseImplied(l1, 44, ndd60) || !ParseImplied(l1, 53, bstar)
+            || !ParseField(l2, 8, 8, incl) || !ParseField(l2, 17, 8, node0) || !ParseField(eccText.ToView(), 0, 8, ecc)
+            || !ParseField(l2, 34, 8, omega) || !ParseField(l2, 43, 8, mo) || !ParseField(l2, 52, 11, no))
+        {
+            Out.Error = TEXT("An element set field could not be parsed");
+            return;
+        }
+
+        if (!Convert(Out.elems, ndt20, ndd60, bstar, incl, node0, ecc, omega, mo, no, Out.Error))
+        {
+            return;
+        }
+
+        // (as getelm)
+        int32 year = frstyr / 100 * 100 + (int32)yr;
+        if (year < frstyr)
+        {
+            year += 100;
+        }
+
+        Out.elems[9] = UTCSeconds(year, 1, 1, (day - 1.) * 86400.);
+    }
+
+    // Finds "Key": in a flat JSON object; returns the value (unquoted)
+    bool FindValue(FStringView Object, const TCHAR* Key, FStringView& Value)
+    {
+        const int32 KeyLen = FCString::Strlen(Key);
+        int32 From = 0;
+        while (true)
+        {
+            const int32 At = UE::String::FindFirst(Object.Mid(From), Key);
+            if (At == INDEX_NONE)
+            {
+                return false;
+            }
+
+            int32 i = From + At;
+            From = i + KeyLen;
+
+            // Must be a whole, quoted key followed by ':'
+            if (i == 0 || Object[i - 1] != TCHAR('"') || From >= Object.Len() || Object[From] != TCHAR('"'))
+            {
+                continue;
+            }
+
+            i = From + 1;
+            while (i < Object.Len() && FChar::IsWhitespace(Object[i])) ++i;
+            if (i >= Object.Len() || Object[i] != TCHAR(':')) continue;
+            ++i;
+            while (i < Object.Len() && FChar::IsWhitespace(Object[i])) ++i;
+            if (i >= Object.Len()) return false;
+
+            if (Object[i] == TCHAR('"'))
+            {
+                const int32 Start = ++i;
+                while (i < Object.Len() && Object[i] != TCHAR('"'))
+                {
+                    i += Object[i] == TCHAR('\\') ? 2 : 1;
+                }
+                Value = Object.Mid(Start, i - Start);
+            }
+            else
+            {
+                const int32 Start = i;
+                while (i < Object.Len() && Object[i] != TCHAR(',') && Object[i] != TCHAR('}') && !FChar::IsWhitespace(Object[i])) ++i;
+                Value = Object.Mid(Start, i - Start);
+            }
+            return true;
+        }
+    }
+
+    bool FindDouble(FStringView Object, const TCHAR* Key, double& Value)
+    {
+        FStringView Text;
+        return FindValue(Object, Key, Text) && ParseField(Text, 0, Text.Len(), Value);
+    }
+
+    void ParseOMM(const FRecord& Record, FParsed& Out)
+    {
+        const FStringView Object = Record.Line1;
+
+        FStringView Id, Name, Epoch;
+        if (!FindValue(Object, TEXT("NORAD_CAT_ID"), Id) || !FindValue(Object, TEXT("EPOCH"), Epoch))
+        {
+            Out.Error = TEXT("OMM object has no NORAD_CAT_ID or EPOCH");
+            return;
+        }
+
+        Out.ObjectId = FString(Id);
+        Out.ObjectName = FindValue(Object, TEXT("OBJECT_NAME"), Name) ? FString(Name) : Out.ObjectId;
+
+        double ndt20 = 0., ndd60 = 0., bstar = 0., incl, node0, ecc, omega, mo, no;
+        FindDouble(Object, TEXT("MEAN_MOTION_DOT"), ndt20);
+        FindDouble(Object, TEXT("MEAN_MOTION_DDOT"), ndd60);
+        FindDouble(Object, TEXT("BSTAR"), bstar);
+
+        if (!FindDouble(Object, TEXT("INCLINATION"), incl) || !FindDouble(Object, TEXT("RA_OF_ASC_NODE"), node0)
+            || !FindDouble(Object, TEXT("ECCENTRICITY"), ecc) || !FindDouble(Object, TEXT("ARG_OF_PERICENTER"), omega)
+            || !FindDouble(Object, TEXT("MEAN_ANOMALY"), mo) || !FindDouble(Object, TEXT("MEAN_MOTION"), no))
+        {
+            Out.Error = TEXT("OMM object is missing mean elements");
+            return;
+        }
+
+        if (!Convert(Out.elems, ndt20, ndd60, bstar, incl, node0, ecc, omega, mo, no, Out.Error))
+        {
+            return;
+        }
+
+        // YYYY-MM-DDTHH:MM:SS[.ffffff]
+        int32 y = 0, m = 0, d = 0, hh = 0, mm = 0;
+        double ss = 0.;
+        const FString EpochString(Epoch);
+        if (EpochString.Len() < 19
+            || !LexTryParseString(y, *EpochString.Mid(0, 4)) || !LexTryParseString(m, *EpochString.Mid(5, 2))
+            || !LexTryParseString(d, *EpochString.Mid(8, 2)) || !LexTryParseString(hh, *EpochString.Mid(11, 2))
+            || !LexTryParseString(mm, *EpochString.Mid(14, 2)) || !LexTryParseString(ss, *EpochString.Mid(17).Replace(TEXT("Z"), TEXT(""))))
+        {
+            Out.Error = FString::Printf(TEXT("OMM EPOCH %s could not be parsed"), *EpochString);
+            return;
+        }
+
+        Out.elems[9] = UTCSeconds(y, m, d, hh * 3600. + mm * 60. + ss);
+    }
+
+    void SplitLines(const FString& Text, TArray<FStringView>& Lines)
+    {
+        const FStringView View(Text);
+        int32 Start = 0;
+        for (int32 i = 0; i <= View.Len(); ++i)
+        {
+            if (i == View.Len() || View[i] == TCHAR('\n'))
+            {
+                int32 End = i;
+                if (End > Start && View[End - 1] == TCHAR('\r')) --End;
+                Lines.Add(View.Mid(Start, End - Start));
+                Start = i + 1;
+            }
+        }
+    }
+
+    void SplitTLE(const FString& Text, TArray<FRecord>& Records)
+    {
+        TArray<FStringView> Lines;
+        SplitLines(Text, Lines);
+
+        auto IsLine = [](FStringView Line, TCHAR Number)
+        {
+            return Line.Len() >= 2 && Line[0] == Number && Line[1] == TCHAR(' ');
+        };
+
+        for (int32 i = 0; i + 1 < Lines.Num(); ++i)
+        {
+            if (IsLine(Lines[i], TCHAR('1')) && IsLine(Lines[i + 1], TCHAR('2')))
+            {
+                FRecord& Record = Records.AddDefaulted_GetRef();
+                Record.Line1 = Lines[i];
+                Record.Line2 = Lines[i + 1];
+                Record.LineNumber = i + 1;
+
+                // Previous line is the name, unless it's part of another set
+                if (i > 0 && !IsLine(Lines[i - 1], TCHAR('2')) && !Lines[i - 1].TrimStartAndEnd().IsEmpty())
+                {
+                    Record.Name = Lines[i - 1];
+                }
+                ++i;
+            }
+        }
+    }
+
+    void SplitJson(const FString& Text, TArray<FRecord>& Records)
+    {
+        const FStringView View(Text);
+        int32 Depth = 0;
+        int32 Start = 0;
+        int32 Line = 1;
+        int32 StartLine = 1;
+        bool bInString = false;
+
+        for (int32 i = 0; i < View.Len(); ++i)
+        {
+            const TCHAR c = View[i];
+            if (c == TCHAR('\n')) ++Line;
+
+            if (bInString)
+            {
+                if (c == TCHAR('\\')) ++i;
+                else if (c == TCHAR('"')) bInString = false;
+                continue;
+            }
+
+            if (c == TCHAR('"'))
+            {
+                bInString = true;
+            }
+            else if (c == TCHAR('{'))
+            {
+                if (Depth++ == 0)
+                {
+                    Start = i;
+                    StartLine = Line;
+                }
+            }
+            else if (c == TCHAR('}') && Depth > 0)
+            {
+                if (--Depth == 0)
+                {
+                    FRecord& Record = Records.AddDefaulted_GetRef();
+                    Record.Line1 = View.Mid(Start, i + 1 - Start);
+                    Record.LineNumber = StartLine;
+                }
+            }
+        }
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    int32 ParseTLECatalog(
+        const FString& Text,
+        FSTLECatalog& Catalog,
+        ETLECatalogFormat Format,
+        int32 frstyr,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        MAXQ_LLM_SCOPE();
+
+        if (Format == ETLECatalogFormat::Auto)
+        {
+            const FString Start = Text.Left(64).TrimStart();
+            Format = Start.StartsWith(TEXT("[")) || Start.StartsWith(TEXT("{")) ? ETLECatalogFormat::OMMJson : ETLECatalogFormat::TLE;
+        }
+
+        TArray<FRecord> Records;
+        if (Format == ETLECatalogFormat::OMMJson)
+        {
+            SplitJson(Text, Records);
+        }
+        else
+        {
+            SplitTLE(Text, Records);
+        }
+
+        TArray<FParsed> Parsed;
+        Parsed.SetNum(Records.Num());
+
+        const int32 NumBatches = (Records.Num() + BatchSize - 1) / BatchSize;
+        ParallelFor(NumBatches, [&](int32 Batch)
+        {
+            const int32 Last = FMath::Min((Batch + 1) * BatchSize, Records.Num());
+            for (int32 i = Batch * BatchSize; i < Last; ++i)
+            {
+                if (Format == ETLECatalogFormat::OMMJson)
+                {
+                    ParseOMM(Records[i], Parsed[i]);
+                }
+                else
+                {
+                    ParseTLE(Records[i], frstyr, Parsed[i]);
+                }
+            }
+        });
+
+        Catalog.Reserve(Catalog.Num() + Records.Num());
+
+        int32 Added = 0;
+        int32 NumFailed = 0;
+        int32 FirstFailed = INDEX_NONE;
+        for (int32 i = 0; i < Parsed.Num(); ++i)
+        {
+            FParsed& p = Parsed[i];
+            if (!p.Error.IsEmpty())
+            {
+                if (NumFailed++ == 0) FirstFailed = i;
+                continue;
+            }
+
+            // UTC -> TDB
+            SpiceDouble delta = 0.;
+            deltet_c(p.elems[9], "UTC", &delta);
+            if (failed_c())
+            {
+                break;
+            }
+            p.elems[9] += delta;
+
+            Catalog.Add(p.ObjectId, p.ObjectName, p.elems);
+            ++Added;
+        }
+
+        if (!failed_c() && NumFailed > 0)
+        {
+            auto _error = StringCast<ANSICHAR>(*Parsed[FirstFailed].Error);
+            setmsg_c("# of # element sets could not be parsed.  The first (line #): #");
+            errint_c("#", NumFailed);
+            errint_c("#", Records.Num());
+            errint_c("#", Records[FirstFailed].LineNumber);
+            errch_c("#", _error.Get());
+            sigerr_c("SPICE(BADTLE)");
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+        return Added;
+    }
+
+
+    void InitPropagators(
+        const FSTLECatalog& Catalog,
+        const FSTLEGeophysicalConstants& geophs,
+        TArray<FSGP4Propagator>& Propagators,
+        ES_ResultCode* ResultCode,
+        FString* ErrorMessage
+    )
+    {
+        Propagators.SetNum(Catalog.Num());
+
+        // Invalid (suborbital, etc) entries are left uninitialized.  Init
+        // resets the SPICE error each time, so keep the first one to report.
+        ES_ResultCode FirstResult = ES_ResultCode::Success;
+        FString FirstError;
+        for (int32 i = 0; i < Catalog.Num(); ++i)
+        {
+            ES_ResultCode _ResultCode;
+            FString _ErrorMessage;
+            if (!Propagators[i].Init(geophs, Catalog.GetElements(i), &_ResultCode, &_ErrorMessage) && FirstResult == ES_ResultCode::Success)
+            {
+                FirstResult = _ResultCode;
+                FirstError = FString::Printf(TEXT("%s (%s)"), *_ErrorMessage, *Catalog.ObjectIds[i]);
+            }
+        }
+
+        if (ResultCode) *ResultCode = FirstResult;
+        if (ErrorMessage) *ErrorMessage = FirstError;
+    }
+}
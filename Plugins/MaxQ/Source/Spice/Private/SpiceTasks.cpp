@@ -0,0 +1,69 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTasks.cpp
+//
+// Implementation Comments
+//
+// Purpose:  FSpiceExecutor commands as UE tasks, and as C++20 awaitables.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTasks.cpp is part of the "refined C++ API".
+//------------------------------------------------------------------------------
+
+#include "SpiceTasks.h"
+#include "SpiceData.h"
+#include "SpiceEphemeris.h"
+#include "SpiceMath.h"
+
+
+TSpiceTask<bool> MaxQ::Async::Furnsh(const FString& relativePath, TArrayView<const UE::Tasks::FTask> Prerequisites)
+{
+    return Spice([relativePath]() { return MaxQ::Data::Furnsh(relativePath); }, TArray<UE::Tasks::FTask>(Prerequisites));
+}
+
+
+TSpiceTask<bool> MaxQ::Async::Furnsh(const TArray<FString>& relativePaths, TArrayView<const UE::Tasks::FTask> Prerequisites)
+{
+    return Spice([relativePaths]() { return MaxQ::Data::Furnsh(relativePaths); }, TArray<UE::Tasks::FTask>(Prerequisites));
+}
+
+
+TSpiceTask<MaxQ::Core::TSpiceResult<FSStateVector>> MaxQ::Async::Spkezr(
+    const FSEphemerisTime& et,
+    const FSpiceName& targ,
+    const FSpiceName& obs,
+    const FSpiceName& ref,
+    ES_AberrationCorrectionWithNewtonians abcorr,
+    TArrayView<const UE::Tasks::FTask> Prerequisites
+)
+{
+    return Spice([et, targ, obs, ref, abcorr]()
+    {
+        return MaxQ::Ephemeris::TrySpkezr(et, targ, obs, ref, abcorr);
+    }, TArray<UE::Tasks::FTask>(Prerequisites));
+}
+
+
+TSpiceTask<MaxQ::Core::TSpiceResult<FSRotationMatrix>> MaxQ::Async::Pxform(
+    const FSEphemerisTime& et,
+    const FSpiceName& from,
+    const FSpiceName& to,
+    TArrayView<const UE::Tasks::FTask> Prerequisites
+)
+{
+    return Spice([et, from, to]()
+    {
+        return MaxQ::Math::TryPxform(et, from, to);
+    }, TArray<UE::Tasks::FTask>(Prerequisites));
+}
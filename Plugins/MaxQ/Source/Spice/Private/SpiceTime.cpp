@@ -0,0 +1,1351 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTime.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Native ET/UTC/TAI/TT conversion, formatting and parsing.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTime.cpp is part of the "refined C++ API".
+//
+// DeltaEt follows deltet_c line for line, so EtToUtc/UtcToEt agree with
+// CSPICE to the last bit or so.  Decompose finds leap seconds on the TAI
+// scale instead (as et2utc_c does), since "UTC" seconds can't tell the leap
+// second from the one before it.
+//
+// Dates are proleptic Gregorian day counts (days_from_civil, H. Hinnant).
+//
+// Type 1 SCLK coefficients are (encoded SCLK, parallel time, rate) records,
+// with the rate in parallel seconds per count of the first field.  Between
+// records time is linear in ticks at the earlier record's rate.
+//
+// FEtClock's wall clock anchor brackets FDateTime::UtcNow between two
+// FPlatformTime::Seconds samples and takes their midpoint.
+//------------------------------------------------------------------------------
+
+#include "SpiceTime.h"
+#include "SpiceCore.h"
+#include "SpiceUtilities.h"
+#include "Misc/ScopeLock.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformProcess.h"
+#include <atomic>
+
+PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
+extern "C"
+{
+#include "SpiceUsr.h"
+}
+PRAGMA_POP_PLATFORM_DEFAULT_PACKING
+
+using namespace MaxQ::Private;
+
+namespace
+{
+    constexpr double SecondsPerDay = 86400.;
+    constexpr double J2000JulianDate = 2451545.;
+
+    // 2000-01-01, in days past 1970-01-01
+    constexpr int64 J2000Day = 10957;
+
+    constexpr int32 MinYear = 1583;
+    constexpr int32 MaxYear = 9999;
+    constexpr int32 MaxPrecision = 14;
+
+    constexpr int64 Pow10[MaxPrecision + 1] =
+    {
+        1ll, 10ll, 100ll, 1000ll, 10000ll, 100000ll, 1000000ll, 10000000ll, 100000000ll, 1000000000ll,
+        10000000000ll, 100000000000ll, 1000000000000ll, 10000000000000ll, 100000000000000ll
+    };
+
+    const TCHAR* MonthNames[12] =
+    {
+        TEXT("JAN"), TEXT("FEB"), TEXT("MAR"), TEXT("APR"), TEXT("MAY"), TEXT("JUN"),
+        TEXT("JUL"), TEXT("AUG"), TEXT("SEP"), TEXT("OCT"), TEXT("NOV"), TEXT("DEC")
+    };
+
+    int64 FloorDiv(int64 a, int64 b)
+    {
+        return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+
+    // Days past 1970-01-01
+    int64 DaysFromCivil(int32 y, int32 m, int32 d)
+    {
+        y -= m <= 2;
+        const int64 era = (y >= 0 ? y : y - 399) / 400;
+        const int64 yoe = y - era * 400;
+        const int64 doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        const int64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    void CivilFromDays(int64 z, int32& y, int32& m, int32& d)
+    {
+        z += 719468;
+        const int64 era = (z >= 0 ? z : z - 146096) / 146097;
+        const int64 doe = z - era * 146097;
+        const int64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int64 mp = (5 * doy + 2) / 153;
+        d = (int32)(doy - (153 * mp + 2) / 5 + 1);
+        m = (int32)(mp < 10 ? mp + 3 : mp - 9);
+        y = (int32)(yoe + era * 400 + (m <= 2));
+    }
+
+    bool IsLeapYear(int32 y)
+    {
+        return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    }
+
+    int32 DaysInMonth(int32 y, int32 m)
+    {
+        static const int32 Days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        return m == 2 && IsLeapYear(y) ? 29 : Days[m - 1];
+    }
+
+    TCHAR* PutDigits(TCHAR* p, int64 Value, int32 Width)
+    {
+        for (int32 i = Width - 1; i >= 0; --i)
+        {
+            p[i] = TEXT('0') + (TCHAR)(Value % 10);
+            Value /= 10;
+        }
+        return p + Width;
+    }
+
+    // Splits UTC seconds into whole seconds and ticks of 10^-Precision, as
+    // Decompose rounds them (away from a leap second)
+    void RoundUtc(double utc, int32 Precision, int64& Seconds, int64& Ticks)
+    {
+        const double Whole = FMath::FloorToDouble(utc);
+        Seconds = (int64)Whole;
+        Ticks = (int64)((utc - Whole) * Pow10[Precision] + 0.5);
+        if (Ticks >= Pow10[Precision])
+        {
+            Ticks -= Pow10[Precision];
+            ++Seconds;
+        }
+    }
+
+    TCHAR* PutString(TCHAR* p, const TCHAR* s)
+    {
+        while (*s)
+        {
+            *p++ = *s++;
+        }
+        return p;
+    }
+
+    struct FCursor
+    {
+        const TCHAR* p;
+
+        void SkipSpaces()
+        {
+            while (*p == TEXT(' ') || *p == TEXT('\t'))
+            {
+                ++p;
+            }
+        }
+
+        bool Match(TCHAR c)
+        {
+            if (*p == c)
+            {
+                ++p;
+                return true;
+            }
+            return false;
+        }
+
+        // Between MinDigits and MaxDigits digits
+        bool Digits(int32 MinDigits, int32 MaxDigits, int32& Value, int32& NumDigits)
+        {
+            Value = 0;
+            NumDigits = 0;
+            while (NumDigits < MaxDigits && FChar::IsDigit(*p))
+            {
+                Value = Value * 10 + (*p++ - TEXT('0'));
+                ++NumDigits;
+            }
+            return NumDigits >= MinDigits;
+        }
+
+        bool Digits(int32 MinDigits, int32 MaxDigits, int32& Value)
+        {
+            int32 NumDigits;
+            return Digits(MinDigits, MaxDigits, Value, NumDigits);
+        }
+    };
+
+    TSharedRef<const MaxQ::Time::FTimeSystem, ESPMode::ThreadSafe>& CurrentTimeSystem()
+    {
+        static TSharedRef<const MaxQ::Time::FTimeSystem, ESPMode::ThreadSafe> Current = MakeShared<MaxQ::Time::FTimeSystem, ESPMode::ThreadSafe>();
+        return Current;
+    }
+
+    FCriticalSection TimeSystemLock;
+    std::atomic<uint64> TimeSystemGeneration{ 0 };
+
+    FCriticalSection SclkLock;
+
+    TMap<int32, TSharedRef<const MaxQ::Time::FSclkConverter, ESPMode::ThreadSafe>>& SclkConverters()
+    {
+        static TMap<int32, TSharedRef<const MaxQ::Time::FSclkConverter, ESPMode::ThreadSafe>> Converters;
+        return Converters;
+    }
+
+    // The last of Keys (ascending) at or before Key, or 0.  Hint and its
+    // successor are tried before searching.
+    int32 FindRecord(const TArray<double>& Keys, double Key, int32 Hint)
+    {
+        const int32 Num = Keys.Num();
+        for (int32 i = Hint; i <= Hint + 1 && i < Num; ++i)
+        {
+            if (i >= 0 && Keys[i] <= Key && (i + 1 == Num || Key < Keys[i + 1]))
+            {
+                return i;
+            }
+        }
+
+        return FMath::Max(0, Algo::UpperBound(Keys, Key) - 1);
+    }
+}
+
+namespace MaxQ::Time
+{
+    TSharedRef<const FTimeSystem, ESPMode::ThreadSafe> FTimeSystem::FromKernelPool()
+    {
+        MAXQ_LLM_SCOPE();
+
+        TSharedRef<FTimeSystem, ESPMode::ThreadSafe> System = MakeShared<FTimeSystem, ESPMode::ThreadSafe>();
+        System->PoolGeneration = MaxQ::Private::PoolGeneration();
+
+        auto Scalar = [](ConstSpiceChar* name, double& Value)
+        {
+            SpiceInt n = 0;
+            SpiceBoolean found = SPICEFALSE;
+            gdpool_c(name, 0, 1, &n, &Value, &found);
+            return found && n == 1;
+        };
+
+        double DeltaTA, K, EB, M[2];
+        SpiceInt n = 0;
+        SpiceBoolean found = SPICEFALSE;
+        SpiceChar type = 0;
+
+        bool bFound = Scalar("DELTET/DELTA_T_A", DeltaTA) && Scalar("DELTET/K", K) && Scalar("DELTET/EB", EB);
+        if (bFound)
+        {
+            gdpool_c("DELTET/M", 0, 2, &n, M, &found);
+            bFound = found && n == 2;
+        }
+
+        TArray<double> Values;
+        if (bFound)
+        {
+            dtpool_c("DELTET/DELTA_AT", &found, &n, &type);
+            bFound = found && type == 'N' && n >= 2 && n % 2 == 0;
+        }
+        if (bFound)
+        {
+            Values.SetNumUninitialized(n);
+            gdpool_c("DELTET/DELTA_AT", 0, n, &n, Values.GetData(), &found);
+            bFound = found && n == Values.Num();
+        }
+
+        if (UnexpectedErrorCheck() || !bFound)
+        {
+            return System;
+        }
+
+        System->DeltaTA = DeltaTA;
+        System->K = K;
+        System->EB = EB;
+        System->M[0] = M[0];
+        System->M[1] = M[1];
+
+        // (DELTA_AT, epoch) pairs
+        for (int32 i = 0; i + 1 < Values.Num(); i += 2)
+        {
+            System->DeltaAts.Add(Values[i]);
+            System->LeapEpochs.Add(Values[i + 1]);
+        }
+
+        return System;
+    }
+
+
+    double FTimeSystem::DeltaEt(double epoch, bool bEpochIsEt) const
+    {
+        if (!IsValid())
+        {
+            return 0.;
+        }
+
+        const int32 Num = LeapEpochs.Num();
+        double dta = DeltaAts[0];
+        double aet;
+
+        if (bEpochIsEt)
+        {
+            // The leap epochs, converted to ET (without the periodic term)
+            for (int32 i = Num - 1; i >= 0; --i)
+            {
+                if (epoch >= LeapEpochs[i] + DeltaAts[i] + DeltaTA)
+                {
+                    dta = DeltaAts[i];
+                    break;
+                }
+            }
+            aet = epoch;
+        }
+        else
+        {
+            dta = DeltaAt(epoch);
+            aet = epoch + dta + DeltaTA;
+        }
+
+        const double m = M[0] + M[1] * aet;
+        const double ea = m + EB * FMath::Sin(m);
+        return DeltaTA + dta + K * FMath::Sin(ea);
+    }
+
+
+    double FTimeSystem::DeltaAt(double utc) const
+    {
+        if (!IsValid())
+        {
+            return 0.;
+        }
+
+        for (int32 i = LeapEpochs.Num() - 1; i > 0; --i)
+        {
+            if (utc >= LeapEpochs[i])
+            {
+                return DeltaAts[i];
+            }
+        }
+        return DeltaAts[0];
+    }
+
+
+    double FTimeSystem::EtToTt(double et) const
+    {
+        const double m = M[0] + M[1] * et;
+        const double ea = m + EB * FMath::Sin(m);
+        return et - K * FMath::Sin(ea);
+    }
+
+
+    double FTimeSystem::TtToEt(double tt) const
+    {
+        const double m = M[0] + M[1] * tt;
+        const double ea = m + EB * FMath::Sin(m);
+        return tt + K * FMath::Sin(ea);
+    }
+
+
+    bool FTimeSystem::Decompose(double et, int32 Precision, FUtcCalendar& Out) const
+    {
+        if (!IsValid())
+        {
+            return false;
+        }
+
+        Precision = FMath::Clamp(Precision, 0, MaxPrecision);
+
+        const double tai = EtToTai(et);
+        const int32 Num = LeapEpochs.Num();
+
+        // The DELTA_AT entry in effect
+        int32 i = Num - 1;
+        while (i > 0 && tai < LeapEpochs[i] + DeltaAts[i])
+        {
+            --i;
+        }
+
+        // Is a leap second coming (or here)?
+        const int32 Next = i + 1;
+        const bool bLeapNext = Next < Num && DeltaAts[Next] - DeltaAts[i] == 1.;
+
+        bool bLeap = false;
+        double utc;
+        if (bLeapNext && tai >= LeapEpochs[Next] + DeltaAts[i])
+        {
+            // 23:59:60.  Counted as 23:59:59, for now.
+            bLeap = true;
+            utc = LeapEpochs[Next] - 1. + (tai - (LeapEpochs[Next] + DeltaAts[i]));
+        }
+        else
+        {
+            utc = tai - DeltaAts[i];
+        }
+
+        const double Whole = FMath::FloorToDouble(utc);
+        int64 Seconds = (int64)Whole;
+        int64 Ticks = (int64)((utc - Whole) * Pow10[Precision] + 0.5);
+
+        if (Ticks >= Pow10[Precision])
+        {
+            Ticks -= Pow10[Precision];
+            if (bLeap)
+            {
+                bLeap = false;
+                ++Seconds;
+            }
+            else if (bLeapNext && Seconds + 1 == (int64)LeapEpochs[Next])
+            {
+                // 23:59:59.99... rounds to 23:59:60
+                bLeap = true;
+            }
+            else
+            {
+                ++Seconds;
+            }
+        }
+
+        // Seconds past 2000-01-01 00:00:00
+        const int64 Midnight = Seconds + 43200;
+        const int64 Day = FloorDiv(Midnight, 86400);
+        const int64 SecondOfDay = Midnight - Day * 86400;
+
+        int32 Year, Month, DayOfMonth;
+        CivilFromDays(Day + J2000Day, Year, Month, DayOfMonth);
+        if (Year < MinYear || Year > MaxYear)
+        {
+            return false;
+        }
+
+        Out.Year = Year;
+        Out.Month = Month;
+        Out.Day = DayOfMonth;
+        Out.DayOfYear = (int32)(Day + J2000Day - DaysFromCivil(Year, 1, 1)) + 1;
+        Out.Hour = (int32)(SecondOfDay / 3600);
+        Out.Minute = (int32)(SecondOfDay % 3600 / 60);
+        Out.Second = bLeap ? 60 : (int32)(SecondOfDay % 60);
+        Out.Fraction = Ticks;
+        Out.Precision = Precision;
+
+        return true;
+    }
+
+
+    int32 FTimeSystem::Format(const FUtcCalendar& Calendar, ES_UTCTimeFormat TimeFormat, TCHAR* Buffer, int32 BufferLen)
+    {
+        // Longest:  "YYYY-DDD // HH:MM:SS." + 14 digits
+        TCHAR Text[48];
+        TCHAR* p = Text;
+
+        switch (TimeFormat)
+        {
+        case ES_UTCTimeFormat::Calendar:
+            p = PutDigits(p, Calendar.Year, 4);
+            *p++ = TEXT(' ');
+            p = PutString(p, MonthNames[Calendar.Month - 1]);
+            *p++ = TEXT(' ');
+            p = PutDigits(p, Calendar.Day, 2);
+            *p++ = TEXT(' ');
+            break;
+        case ES_UTCTimeFormat::DayOfYear:
+            p = PutDigits(p, Calendar.Year, 4);
+            *p++ = TEXT('-');
+            p = PutDigits(p, Calendar.DayOfYear, 3);
+            p = PutString(p, TEXT(" // "));
+            break;
+        case ES_UTCTimeFormat::ISOCalendar:
+            p = PutDigits(p, Calendar.Year, 4);
+            *p++ = TEXT('-');
+            p = PutDigits(p, Calendar.Month, 2);
+            *p++ = TEXT('-');
+            p = PutDigits(p, Calendar.Day, 2);
+            *p++ = TEXT('T');
+            break;
+        case ES_UTCTimeFormat::ISODayOfYear:
+            p = PutDigits(p, Calendar.Year, 4);
+            *p++ = TEXT('-');
+            p = PutDigits(p, Calendar.DayOfYear, 3);
+            *p++ = TEXT('T');
+            break;
+        default:
+            return 0;
+        }
+
+        p = PutDigits(p, Calendar.Hour, 2);
+        *p++ = TEXT(':');
+        p = PutDigits(p, Calendar.Minute, 2);
+        *p++ = TEXT(':');
+        p = PutDigits(p, Calendar.Second, 2);
+        if (Calendar.Precision > 0)
+        {
+            *p++ = TEXT('.');
+            p = PutDigits(p, Calendar.Fraction, Calendar.Precision);
+        }
+
+        const int32 Len = (int32)(p - Text);
+        if (Len >= BufferLen)
+        {
+            return 0;
+        }
+
+        FMemory::Memcpy(Buffer, Text, Len * sizeof(TCHAR));
+        Buffer[Len] = 0;
+        return Len;
+    }
+
+
+    int32 FTimeSystem::Format(double et, ES_UTCTimeFormat TimeFormat, int32 Precision, TCHAR* Buffer, int32 BufferLen) const
+    {
+        if (TimeFormat == ES_UTCTimeFormat::JulianDate)
+        {
+            if (!IsValid())
+            {
+                return 0;
+            }
+
+            const double jd = J2000JulianDate + EtToUtc(et) / SecondsPerDay;
+            const int32 Len = FCString::Snprintf(Buffer, BufferLen, TEXT("JD %.*f"), FMath::Clamp(Precision, 0, MaxPrecision), jd);
+            return Len > 0 && Len < BufferLen ? Len : 0;
+        }
+
+        FUtcCalendar Calendar;
+        if (!Decompose(et, Precision, Calendar))
+        {
+            return 0;
+        }
+
+        return Format(Calendar, TimeFormat, Buffer, BufferLen);
+    }
+
+
+    bool FTimeSystem::Format(double et, ES_UTCTimeFormat TimeFormat, int32 Precision, FString& Out) const
+    {
+        TCHAR Buffer[64];
+        const int32 Len = Format(et, TimeFormat, Precision, Buffer, UE_ARRAY_COUNT(Buffer));
+        if (Len)
+        {
+            Out = FString(Len, Buffer);
+        }
+        return Len > 0;
+    }
+
+
+    bool FTimeSystem::Parse(const TCHAR* Str, double& et) const
+    {
+        if (!IsValid() || !Str)
+        {
+            return false;
+        }
+
+        // Exactly the forms in SpiceTime.h.  Anything else (lower case,
+        // extra spaces, missing fields, other time systems) is str2et_c's.
+        FCursor Cursor{ Str };
+
+        int32 Year, Month = 1, Day = 1, DayOfYear = 0, Value, NumDigits;
+        if (!Cursor.Digits(4, 4, Year) || Year < MinYear || Year > MaxYear)
+        {
+            return false;
+        }
+
+        if (Cursor.Match(TEXT('-')))
+        {
+            if (!Cursor.Digits(2, 3, Value, NumDigits))
+            {
+                return false;
+            }
+
+            if (NumDigits == 2)
+            {
+                Month = Value;
+                if (!Cursor.Match(TEXT('-')) || !Cursor.Digits(2, 2, Day))
+                {
+                    return false;
+                }
+            }
+            else if (Value > 0)
+            {
+                DayOfYear = Value;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (!Cursor.Match(TEXT('T')))
+            {
+                return false;
+            }
+        }
+        else if (Cursor.Match(TEXT(' ')))
+        {
+            Month = 0;
+            for (int32 i = 0; i < 12; ++i)
+            {
+                if (FCString::Strncmp(Cursor.p, MonthNames[i], 3) == 0)
+                {
+                    Month = i + 1;
+                    Cursor.p += 3;
+                    break;
+                }
+            }
+
+            if (!Month || !Cursor.Match(TEXT(' ')) || !Cursor.Digits(2, 2, Day) || !Cursor.Match(TEXT(' ')))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        if (Month < 1 || Month > 12 || Day < 1 || Day > DaysInMonth(Year, Month) || DayOfYear > (IsLeapYear(Year) ? 366 : 365))
+        {
+            return false;
+        }
+
+        int32 Hour, Minute, Second;
+        if (!Cursor.Digits(2, 2, Hour) || !Cursor.Match(TEXT(':')) || !Cursor.Digits(2, 2, Minute) || !Cursor.Match(TEXT(':')) || !Cursor.Digits(2, 2, Second))
+        {
+            return false;
+        }
+
+        if (Hour > 23 || Minute > 59 || Second > 60)
+        {
+            return false;
+        }
+
+        // The fraction as an integer, so it's exact up to MaxPrecision digits
+        int64 Ticks = 0;
+        int32 Precision = 0;
+        if (Cursor.Match(TEXT('.')))
+        {
+            while (FChar::IsDigit(*Cursor.p))
+            {
+                if (Precision == MaxPrecision)
+                {
+                    return false;
+                }
+                Ticks = Ticks * 10 + (*Cursor.p++ - TEXT('0'));
+                ++Precision;
+            }
+
+            if (!Precision)
+            {
+                return false;
+            }
+        }
+
+        // As ToString writes it
+        if (Cursor.Match(TEXT(' ')) && !(Cursor.Match(TEXT('U')) && Cursor.Match(TEXT('T')) && Cursor.Match(TEXT('C'))))
+        {
+            return false;
+        }
+
+        if (*Cursor.p)
+        {
+            return false;
+        }
+
+        const int64 Days = (DayOfYear ? DaysFromCivil(Year, 1, 1) + DayOfYear - 1 : DaysFromCivil(Year, Month, Day)) - J2000Day;
+
+        // A leap second is counted as the second before it;  see below
+        const double Fraction = (double)Ticks / (double)Pow10[Precision];
+        const double Seconds = (double)(Days * 86400 + Hour * 3600 + Minute * 60 + FMath::Min(Second, 59) - 43200) + Fraction;
+
+        if (Second < 60)
+        {
+            et = UtcToEt(Seconds);
+            return true;
+        }
+
+        // 23:59:60 only exists right before a leap second
+        const double Next = FMath::FloorToDouble(Seconds) + 1.;
+        for (int32 i = 1; i < LeapEpochs.Num(); ++i)
+        {
+            if (LeapEpochs[i] == Next && DeltaAts[i] - DeltaAts[i - 1] == 1.)
+            {
+                et = TaiToEt(Seconds + DeltaAts[i - 1] + 1.);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    SPICE_API TSharedRef<const FTimeSystem, ESPMode::ThreadSafe> GetTimeSystem()
+    {
+        FScopeLock Lock(&TimeSystemLock);
+        return CurrentTimeSystem();
+    }
+
+
+    SPICE_API bool UpdateTimeSystem()
+    {
+        const uint64 Generation = MaxQ::Private::PoolGeneration();
+        if (Generation != TimeSystemGeneration.load(std::memory_order_acquire))
+        {
+            MAXQ_CACHE_EVENT(PoolCacheRebuilds);
+            TSharedRef<const FTimeSystem, ESPMode::ThreadSafe> System = FTimeSystem::FromKernelPool();
+
+            FScopeLock Lock(&TimeSystemLock);
+            CurrentTimeSystem() = System;
+            TimeSystemGeneration.store(Generation, std::memory_order_release);
+            return System->IsValid();
+        }
+
+        MAXQ_CACHE_EVENT(PoolCacheHits);
+        return GetTimeSystem()->IsValid();
+    }
+
+
+    FUtcClock::FUtcClock(ES_UTCTimeFormat InTimeFormat, int32 InPrecision)
+        : TimeFormat(InTimeFormat)
+        , Precision(FMath::Clamp(InPrecision, 0, MaxPrecision))
+    {
+    }
+
+
+    void FUtcClock::SetFormat(ES_UTCTimeFormat InTimeFormat, int32 InPrecision)
+    {
+        TimeFormat = InTimeFormat;
+        Precision = FMath::Clamp(InPrecision, 0, MaxPrecision);
+        bSpan = false;
+        SetText(TEXT(""), 0);
+    }
+
+
+    bool FUtcClock::Update(double et)
+    {
+        if (!TimeSystem.IsValid() || TimeSystem->GetPoolGeneration() != MaxQ::Private::PoolGeneration())
+        {
+            UpdateTimeSystem();
+            TimeSystem = GetTimeSystem();
+            bSpan = false;
+        }
+
+        if (bSpan)
+        {
+            const double tai = TimeSystem->EtToTai(et);
+            if (tai >= SpanBegin && tai < SpanEnd)
+            {
+                int64 NewSecond, Ticks;
+                RoundUtc(tai - Offset, Precision, NewSecond, Ticks);
+
+                if (FloorDiv(NewSecond + 43200, 86400) == Day)
+                {
+                    bool bChanged = false;
+
+                    if (NewSecond != Second)
+                    {
+                        const int64 SecondOfDay = NewSecond + 43200 - Day * 86400;
+                        const int32 Hour = (int32)(SecondOfDay / 3600);
+                        const int32 Minute = (int32)(SecondOfDay % 3600 / 60);
+                        const int32 Sec = (int32)(SecondOfDay % 60);
+
+                        if (Hour != Calendar.Hour)
+                        {
+                            PutDigits(Text + TimeStart, Hour, 2);
+                            Calendar.Hour = Hour;
+                        }
+                        if (Minute != Calendar.Minute)
+                        {
+                            PutDigits(Text + TimeStart + 3, Minute, 2);
+                            Calendar.Minute = Minute;
+                        }
+                        PutDigits(Text + TimeStart + 6, Sec, 2);
+                        Calendar.Second = Sec;
+
+                        Second = NewSecond;
+                        bChanged = true;
+                    }
+
+                    if (Ticks != Calendar.Fraction)
+                    {
+                        PutDigits(Text + TimeStart + 9, Ticks, Precision);
+                        Calendar.Fraction = Ticks;
+                        bChanged = true;
+                    }
+
+                    return bChanged;
+                }
+            }
+        }
+
+        return Render(et);
+    }
+
+
+    bool FUtcClock::Render(double et)
+    {
+        bSpan = false;
+
+        TCHAR NewText[UE_ARRAY_COUNT(Text)];
+        int32 NewLen = 0;
+
+        if (TimeFormat == ES_UTCTimeFormat::JulianDate)
+        {
+            NewLen = TimeSystem->Format(et, TimeFormat, Precision, NewText, UE_ARRAY_COUNT(NewText));
+        }
+        else if (TimeSystem->Decompose(et, Precision, Calendar))
+        {
+            NewLen = FTimeSystem::Format(Calendar, TimeFormat, NewText, UE_ARRAY_COUNT(NewText));
+            TimeStart = NewLen - 8 - (Precision > 0 ? Precision + 1 : 0);
+
+            // The DELTA_AT entry in effect, as Decompose finds it
+            const FTimeSystem& System = *TimeSystem;
+            const double tai = System.EtToTai(et);
+            const int32 Num = System.LeapEpochs.Num();
+
+            int32 i = Num - 1;
+            while (i > 0 && tai < System.LeapEpochs[i] + System.DeltaAts[i])
+            {
+                --i;
+            }
+
+            // The span ends a second short of the next entry, so nothing in
+            // it can round up into a leap second.
+            SpanBegin = i > 0 ? System.LeapEpochs[i] + System.DeltaAts[i] : TNumericLimits<double>::Lowest();
+            SpanEnd = i + 1 < Num ? System.LeapEpochs[i + 1] + System.DeltaAts[i] - 1. : TNumericLimits<double>::Max();
+            Offset = System.DeltaAts[i];
+
+            if (NewLen > 0 && tai >= SpanBegin && tai < SpanEnd)
+            {
+                int64 Ticks;
+                RoundUtc(tai - Offset, Precision, Second, Ticks);
+                Day = FloorDiv(Second + 43200, 86400);
+                bSpan = true;
+            }
+        }
+
+        const bool bChanged = NewLen != TextLen || FMemory::Memcmp(NewText, Text, NewLen * sizeof(TCHAR)) != 0;
+        SetText(NewText, NewLen);
+        return bChanged;
+    }
+
+
+    void FUtcClock::SetText(const TCHAR* NewText, int32 NewLen)
+    {
+        FMemory::Memcpy(Text, NewText, NewLen * sizeof(TCHAR));
+        Text[NewLen] = 0;
+        TextLen = NewLen;
+    }
+
+
+    TSharedRef<const FSclkConverter, ESPMode::ThreadSafe> FSclkConverter::FromKernelPool(int32 Sc, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        TSharedRef<FSclkConverter, ESPMode::ThreadSafe> Clock = MakeShared<FSclkConverter, ESPMode::ThreadSafe>();
+        Clock->Spacecraft = Sc;
+        Clock->PoolGeneration = MaxQ::Private::PoolGeneration();
+
+        // The pool variables are named with the ID's magnitude
+        ANSICHAR Name[64];
+        auto Read = [&Name, Sc](const ANSICHAR* Variable, TArray<double>& Values, bool bRequired)
+        {
+            FCStringAnsi::Snprintf(Name, sizeof(Name), "%s_%d", Variable, FMath::Abs(Sc));
+
+            SpiceBoolean found = SPICEFALSE;
+            SpiceInt n = 0;
+            SpiceChar type = 0;
+            dtpool_c(Name, &found, &n, &type);
+            if (found && type == 'N' && n > 0)
+            {
+                Values.SetNumUninitialized(n);
+                gdpool_c(Name, 0, n, &n, Values.GetData(), &found);
+                return found && !failed_c();
+            }
+
+            if (bRequired && !failed_c())
+            {
+                setmsg_c("SCLK kernel variable # is missing or isn't numeric.");
+                errch_c("#", Name);
+                sigerr_c("SPICE(KERNELVARNOTFOUND)");
+            }
+            return false;
+        };
+
+        TArray<double> DataType, NumFields, Moduli, Offsets, Starts, Ends, Coefficients, TimeSystem;
+
+        bool bOk = Read("SCLK_DATA_TYPE", DataType, true);
+        if (bOk && DataType[0] != 1.)
+        {
+            setmsg_c("Spacecraft # has a type # clock.  Only type 1 is supported.");
+            errint_c("#", Sc);
+            errdp_c("#", DataType[0]);
+            sigerr_c("SPICE(NOTSUPPORTED)");
+            bOk = false;
+        }
+
+        bOk = bOk
+            && Read("SCLK01_N_FIELDS", NumFields, true)
+            && Read("SCLK01_MODULI", Moduli, true)
+            && Read("SCLK01_OFFSETS", Offsets, true)
+            && Read("SCLK_PARTITION_START", Starts, true)
+            && Read("SCLK_PARTITION_END", Ends, true)
+            && Read("SCLK01_COEFFICIENTS", Coefficients, true);
+
+        if (bOk)
+        {
+            const int32 N = (int32)NumFields[0];
+            bool bConsistent = N >= 1 && Moduli.Num() == N && Offsets.Num() == N && Starts.Num() == Ends.Num() && Coefficients.Num() % 3 == 0;
+            for (int32 i = 2; bConsistent && i < Coefficients.Num(); i += 3)
+            {
+                bConsistent = Coefficients[i] > 0.;
+            }
+
+            if (!bConsistent)
+            {
+                setmsg_c("The SCLK kernel data for spacecraft # is inconsistent.");
+                errint_c("#", Sc);
+                sigerr_c("SPICE(INVALIDSCLKDATA)");
+                bOk = false;
+            }
+        }
+
+        // Parallel time is TDB (1, the default) or TDT (2)
+        if (bOk && Read("SCLK01_TIME_SYSTEM", TimeSystem, false) && TimeSystem[0] != 1.)
+        {
+            if (TimeSystem[0] != 2.)
+            {
+                setmsg_c("Spacecraft # clock has unknown time system #.");
+                errint_c("#", Sc);
+                errdp_c("#", TimeSystem[0]);
+                sigerr_c("SPICE(VALUEOUTOFRANGE)");
+                bOk = false;
+            }
+            else if (UpdateTimeSystem())
+            {
+                Clock->TimeSystem = GetTimeSystem();
+            }
+            else if (!failed_c())
+            {
+                setmsg_c("Spacecraft # clock runs on TDT, which needs a leapseconds kernel.");
+                errint_c("#", Sc);
+                sigerr_c("SPICE(NOLEAPSECONDS)");
+                bOk = false;
+            }
+        }
+
+        if (bOk && !failed_c())
+        {
+            const int32 N = Moduli.Num();
+            Clock->Moduli = MoveTemp(Moduli);
+            Clock->Offsets = MoveTemp(Offsets);
+            Clock->Weights.SetNumUninitialized(N);
+            Clock->Weights[N - 1] = 1.;
+            for (int32 i = N - 2; i >= 0; --i)
+            {
+                Clock->Weights[i] = Clock->Weights[i + 1] * Clock->Moduli[i + 1];
+            }
+
+            double PartitionTicks = 0.;
+            for (int32 i = 0; i < Starts.Num(); ++i)
+            {
+                Clock->PartitionTicks.Add(PartitionTicks);
+                PartitionTicks += Ends[i] - Starts[i];
+            }
+            Clock->PartitionStarts = MoveTemp(Starts);
+            Clock->PartitionEnds = MoveTemp(Ends);
+            Clock->MaxTicks = PartitionTicks;
+
+            // Rates are parallel seconds per count of the first field
+            const int32 NumRecords = Coefficients.Num() / 3;
+            Clock->RecordTicks.Reserve(NumRecords);
+            Clock->RecordTimes.Reserve(NumRecords);
+            Clock->RecordRates.Reserve(NumRecords);
+            for (int32 i = 0; i < NumRecords; ++i)
+            {
+                Clock->RecordTicks.Add(Coefficients[3 * i]);
+                Clock->RecordTimes.Add(Coefficients[3 * i + 1]);
+                Clock->RecordRates.Add(Coefficients[3 * i + 2] / Clock->Weights[0]);
+            }
+        }
+
+        ErrorCheck(ResultCode, ErrorMessage);
+
+        return Clock;
+    }
+
+
+    double FSclkConverter::ToEt(double Ticks, int32& Hint) const
+    {
+        Hint = FindRecord(RecordTicks, Ticks, Hint);
+        const double Time = RecordTimes[Hint] + (Ticks - RecordTicks[Hint]) * RecordRates[Hint];
+        return TimeSystem.IsValid() ? TimeSystem->TtToEt(Time) : Time;
+    }
+
+
+    double FSclkConverter::ToTicks(double et, int32& Hint) const
+    {
+        const double Time = TimeSystem.IsValid() ? TimeSystem->EtToTt(et) : et;
+        Hint = FindRecord(RecordTimes, Time, Hint);
+        return RecordTicks[Hint] + (Time - RecordTimes[Hint]) / RecordRates[Hint];
+    }
+
+
+    bool FSclkConverter::TicksToEt(double Ticks, double& et) const
+    {
+        if (!IsValid() || !(Ticks >= 0. && Ticks <= MaxTicks))
+        {
+            return false;
+        }
+
+        int32 Hint = 0;
+        et = ToEt(Ticks, Hint);
+        return true;
+    }
+
+
+    bool FSclkConverter::EtToTicks(double et, double& Ticks) const
+    {
+        if (!IsValid())
+        {
+            return false;
+        }
+
+        int32 Hint = 0;
+        const double Result = ToTicks(et, Hint);
+        if (!(Result >= 0. && Result <= MaxTicks))
+        {
+            return false;
+        }
+
+        Ticks = Result;
+        return true;
+    }
+
+
+    int32 FSclkConverter::TicksToEt(TArrayView<const double> Ticks, TArrayView<double> Ets) const
+    {
+        check(Ets.Num() >= Ticks.Num());
+
+        if (!IsValid())
+        {
+            return 0;
+        }
+
+        int32 Hint = 0;
+        int32 Converted = 0;
+        for (int32 i = 0; i < Ticks.Num(); ++i)
+        {
+            if (Ticks[i] >= 0. && Ticks[i] <= MaxTicks)
+            {
+                Ets[i] = ToEt(Ticks[i], Hint);
+                ++Converted;
+            }
+        }
+        return Converted;
+    }
+
+
+    int32 FSclkConverter::EtToTicks(TArrayView<const double> Ets, TArrayView<double> Ticks) const
+    {
+        check(Ticks.Num() >= Ets.Num());
+
+        if (!IsValid())
+        {
+            return 0;
+        }
+
+        int32 Hint = 0;
+        int32 Converted = 0;
+        for (int32 i = 0; i < Ets.Num(); ++i)
+        {
+            const double Result = ToTicks(Ets[i], Hint);
+            if (Result >= 0. && Result <= MaxTicks)
+            {
+                Ticks[i] = Result;
+                ++Converted;
+            }
+        }
+        return Converted;
+    }
+
+
+    bool FSclkConverter::Encode(const TCHAR* Clock, double& Ticks) const
+    {
+        if (!IsValid() || !Clock)
+        {
+            return false;
+        }
+
+        FCursor Cursor{ Clock };
+
+        // Fields can be longer than an int32
+        auto Number = [&Cursor](double& Value)
+        {
+            if (!FChar::IsDigit(*Cursor.p))
+            {
+                return false;
+            }
+            Value = 0.;
+            while (FChar::IsDigit(*Cursor.p))
+            {
+                Value = Value * 10. + (*Cursor.p++ - TEXT('0'));
+            }
+            return true;
+        };
+
+        double Value;
+        int32 Partition = 0;
+
+        Cursor.SkipSpaces();
+        const TCHAR* Start = Cursor.p;
+        if (Number(Value))
+        {
+            Cursor.SkipSpaces();
+            if (Cursor.Match(TEXT('/')))
+            {
+                Partition = (int32)Value;
+                if (Partition < 1 || Partition > NumPartitions())
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                Cursor.p = Start;
+            }
+        }
+
+        // The count, in ticks past clock zero
+        double Count = 0.;
+        int32 NumFields = 0;
+        for (;;)
+        {
+            Cursor.SkipSpaces();
+            if (!Number(Value))
+            {
+                break;
+            }
+            if (NumFields == Moduli.Num() || Value < Offsets[NumFields])
+            {
+                return false;
+            }
+
+            Count += (Value - Offsets[NumFields]) * Weights[NumFields];
+            ++NumFields;
+
+            Cursor.SkipSpaces();
+            if (!Cursor.Match(TEXT('.')) && !Cursor.Match(TEXT(':')) && !Cursor.Match(TEXT('-')))
+            {
+                Cursor.Match(TEXT(','));
+            }
+        }
+
+        Cursor.SkipSpaces();
+        if (*Cursor.p || !NumFields)
+        {
+            return false;
+        }
+
+        int32 First = 0, Last = NumPartitions() - 1;
+        if (Partition)
+        {
+            First = Last = Partition - 1;
+        }
+
+        for (int32 i = First; i <= Last; ++i)
+        {
+            if (Count >= PartitionStarts[i] && Count <= PartitionEnds[i])
+            {
+                Ticks = PartitionTicks[i] + Count - PartitionStarts[i];
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    bool FSclkConverter::ClockToEt(const TCHAR* Clock, double& et) const
+    {
+        double Ticks;
+        return Encode(Clock, Ticks) && TicksToEt(Ticks, et);
+    }
+
+
+    SPICE_API TSharedRef<const FSclkConverter, ESPMode::ThreadSafe> GetSclkConverter(int32 Sc, ES_ResultCode* ResultCode, FString* ErrorMessage)
+    {
+        {
+            FScopeLock Lock(&SclkLock);
+            const TSharedRef<const FSclkConverter, ESPMode::ThreadSafe>* Found = SclkConverters().Find(Sc);
+            if (Found && (*Found)->GetPoolGeneration() == MaxQ::Private::PoolGeneration())
+            {
+                if (ResultCode) *ResultCode = ES_ResultCode::Success;
+                if (ErrorMessage) ErrorMessage->Empty();
+                return *Found;
+            }
+        }
+
+        TSharedRef<const FSclkConverter, ESPMode::ThreadSafe> Clock = FSclkConverter::FromKernelPool(Sc, ResultCode, ErrorMessage);
+
+        FScopeLock Lock(&SclkLock);
+        if (Clock->IsValid())
+        {
+            SclkConverters().Add(Sc, Clock);
+        }
+        else
+        {
+            SclkConverters().Remove(Sc);
+        }
+        return Clock;
+    }
+
+
+    void FEtClock::AnchorToNow()
+    {
+        UpdateTimeSystem();
+        AnchorToNow(*GetTimeSystem());
+    }
+
+
+    void FEtClock::AnchorToNow(const FTimeSystem& TimeSystem)
+    {
+        static const FDateTime J2000 = FDateTime::FromJulianDay(J2000JulianDate);
+
+        FScopeLock Lock(&WriteLock);
+
+        const double Before = FPlatformTime::Seconds();
+        const FDateTime UtcNow = FDateTime::UtcNow();
+        const double After = FPlatformTime::Seconds();
+
+        // Without an LSK, UtcToEt is the identity
+        const double utc = (UtcNow - J2000).GetTotalSeconds();
+
+        FAnchor NewAnchor;
+        NewAnchor.Et = TimeSystem.UtcToEt(utc);
+        NewAnchor.Seconds = 0.5 * (Before + After);
+        NewAnchor.Rate = GetRate();
+        Publish(NewAnchor);
+
+        bAnchored.store(true, std::memory_order_release);
+        bNeedsLeapSeconds.store(!TimeSystem.IsValid(), std::memory_order_release);
+    }
+
+
+    void FEtClock::Anchor(double et)
+    {
+        FScopeLock Lock(&WriteLock);
+
+        FAnchor NewAnchor;
+        NewAnchor.Et = et;
+        NewAnchor.Seconds = FPlatformTime::Seconds();
+        NewAnchor.Rate = GetRate();
+        Publish(NewAnchor);
+
+        bAnchored.store(true, std::memory_order_release);
+        bNeedsLeapSeconds.store(false, std::memory_order_release);
+    }
+
+
+    void FEtClock::SetRate(double Rate)
+    {
+        FScopeLock Lock(&WriteLock);
+
+        // Re-anchored where it is now, so it carries on from there
+        FAnchor NewAnchor = Read();
+        const double Seconds = FPlatformTime::Seconds();
+        NewAnchor.Et += (Seconds - NewAnchor.Seconds) * NewAnchor.Rate;
+        NewAnchor.Seconds = Seconds;
+        NewAnchor.Rate = Rate;
+        Publish(NewAnchor);
+    }
+
+
+    double FEtClock::GetRate() const
+    {
+        return Read().Rate;
+    }
+
+
+    double FEtClock::Now() const
+    {
+        if (!IsAnchored())
+        {
+            return 0.;
+        }
+
+        const FAnchor Anchor = Read();
+        return Anchor.Et + (FPlatformTime::Seconds() - Anchor.Seconds) * Anchor.Rate;
+    }
+
+
+    void FEtClock::BeginFrame()
+    {
+        // An LSK has turned up since the wall clock anchor.  GetTimeSystem
+        // only sees it once something has called UpdateTimeSystem, but it
+        // doesn't touch CSPICE.
+        if (bNeedsLeapSeconds.load(std::memory_order_acquire))
+        {
+            TSharedRef<const FTimeSystem, ESPMode::ThreadSafe> TimeSystem = GetTimeSystem();
+            if (TimeSystem->IsValid())
+            {
+                AnchorToNow(*TimeSystem);
+            }
+        }
+
+        FrameEt.store(Now(), std::memory_order_release);
+        FrameNumber.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+
+    // Caller holds WriteLock
+    void FEtClock::Publish(const FAnchor& Anchor)
+    {
+        Sequence.fetch_add(1, std::memory_order_acq_rel);
+        AnchorEt.store(Anchor.Et, std::memory_order_relaxed);
+        AnchorSeconds.store(Anchor.Seconds, std::memory_order_relaxed);
+        AnchorRate.store(Anchor.Rate, std::memory_order_relaxed);
+        Sequence.fetch_add(1, std::memory_order_release);
+    }
+
+
+    FEtClock::FAnchor FEtClock::Read() const
+    {
+        FAnchor Anchor;
+        for (;;)
+        {
+            const uint32 Before = Sequence.load(std::memory_order_acquire);
+            if (Before & 1)
+            {
+                FPlatformProcess::Yield();
+                continue;
+            }
+
+            Anchor.Et = AnchorEt.load(std::memory_order_relaxed);
+            Anchor.Seconds = AnchorSeconds.load(std::memory_order_relaxed);
+            Anchor.Rate = AnchorRate.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Sequence.load(std::memory_order_relaxed) == Before)
+            {
+                return Anchor;
+            }
+        }
+    }
+
+
+    SPICE_API FEtClock& GetEtClock()
+    {
+        static FEtClock Clock;
+        // Anchors it, on first use
+        MaxQ::Core::EnsureInitialized();
+        return Clock;
+    }
+}
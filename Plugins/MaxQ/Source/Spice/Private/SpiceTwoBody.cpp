@@ -0,0 +1,977 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTwoBody.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Two-body (Keplerian) propagation and osculating elements of many
+// objects at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTwoBody.cpp is part of the "refined C++ API".
+//
+// Universal variables (Bate, Mueller & White 4.3; as prop2b).  The universal
+// Kepler equation F(x) = 0 has F'(x) = r > 0, so it's monotonic.  Its root
+// is bracketed by [0, sqrt(mu) dt / q] (q = periapsis distance), and Newton
+// steps that leave the bracket are replaced by bisection.  Lanes freeze as
+// they converge.
+//
+// conics_c is handled the same way it handles it:  the elements are turned
+// into the state at periapsis, which is then propagated by prop2b.
+//
+// Oscltx is oscelt_ and oscltx_, statement for statement, with the SPICELIB
+// vector routines inlined.  It's too branchy to be worth laning, so the
+// batches are just parallel.
+//------------------------------------------------------------------------------
+
+#include "SpiceTwoBody.h"
+#include "SpiceMemory.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    using namespace MaxQ::Orbits;
+
+    constexpr int32 W = FTwoBodyBatchPropagator::Lanes;
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double twopi = 2. * pi;
+
+    // Rows per ParallelFor task
+    constexpr int32 BatchRows = 256;
+    static_assert(BatchRows % W == 0, "BatchRows must be a multiple of the lane width");
+
+    constexpr int32 MaxIterations = 64;
+
+    // Fortran MOD (as f2c's d_mod)
+    inline double d_mod(double x, double y)
+    {
+        double quotient = x / y;
+        quotient = quotient >= 0 ? floor(quotient) : -floor(-quotient);
+        return x - y * quotient;
+    }
+
+    inline double ReducedOffset(double dt, double period)
+    {
+        return period > 0. ? d_mod(dt, period) : dt;
+    }
+
+    inline double Value(double x)
+    {
+        return x;
+    }
+
+    // Forward-mode derivatives, with respect to the six components of an
+    // initial state
+    namespace Dual
+    {
+        struct FDual
+        {
+            double v = 0.;
+            double d[6] = { 0. };
+
+            FDual() {}
+            FDual(double _v) : v(_v) {}
+        };
+
+        inline double Value(const FDual& a)
+        {
+            return a.v;
+        }
+
+        // f(a), given f(a.v) and f'(a.v)
+        inline FDual Chain(const FDual& a, double f, double df)
+        {
+            FDual c(f);
+            for (int32 k = 0; k < 6; ++k) c.d[k] = df * a.d[k];
+            return c;
+        }
+
+        inline FDual operator-(const FDual& a)
+        {
+            return Chain(a, -a.v, -1.);
+        }
+
+        inline FDual operator+(const FDual& a, const FDual& b)
+        {
+            FDual c(a.v + b.v);
+            for (int32 k = 0; k < 6; ++k) c.d[k] = a.d[k] + b.d[k];
+            return c;
+        }
+
+        inline FDual operator-(const FDual& a, const FDual& b)
+        {
+            FDual c(a.v - b.v);
+            for (int32 k = 0; k < 6; ++k) c.d[k] = a.d[k] - b.d[k];
+            return c;
+        }
+
+        inline FDual operator*(const FDual& a, const FDual& b)
+        {
+            FDual c(a.v * b.v);
+            for (int32 k = 0; k < 6; ++k) c.d[k] = a.d[k] * b.v + a.v * b.d[k];
+            return c;
+        }
+
+        inline FDual operator/(const FDual& a, const FDual& b)
+        {
+            FDual c(a.v / b.v);
+            for (int32 k = 0; k < 6; ++k) c.d[k] = (a.d[k] - c.v * b.d[k]) / b.v;
+            return c;
+        }
+
+        inline FDual sqrt(const FDual& a) { const double s = ::sqrt(a.v); return Chain(a, s, .5 / s); }
+        inline FDual sin(const FDual& a) { return Chain(a, ::sin(a.v), ::cos(a.v)); }
+        inline FDual cos(const FDual& a) { return Chain(a, ::cos(a.v), -::sin(a.v)); }
+        inline FDual sinh(const FDual& a) { return Chain(a, ::sinh(a.v), ::cosh(a.v)); }
+        inline FDual cosh(const FDual& a) { return Chain(a, ::cosh(a.v), ::sinh(a.v)); }
+    }
+
+    // Stumpff functions c2(z), c3(z)
+    template<typename T>
+    inline void Stumpff(const T& z, T& c2, T& c3)
+    {
+        if (Value(z) > 1e-2)
+        {
+            const T s = sqrt(z);
+            c2 = (1. - cos(s)) / z;
+            c3 = (s - sin(s)) / (z * s);
+        }
+        else if (Value(z) < -1e-2)
+        {
+            const T s = sqrt(-z);
+            c2 = (cosh(s) - 1.) / -z;
+            c3 = (sinh(s) - s) / (-z * s);
+        }
+        else
+        {
+            // Series, to z^4 (|error| < 1e-17)
+            c2 = 1. / 2. - z * (1. / 24. - z * (1. / 720. - z * (1. / 40320. - z / 3628800.)));
+            c3 = 1. / 6. - z * (1. / 120. - z * (1. / 5040. - z * (1. / 362880. - z / 39916800.)));
+        }
+    }
+
+    inline double Dot(const double* a, const double* b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    inline void Cross(const double* a, const double* b, double* c)
+    {
+        c[0] = a[1] * b[2] - a[2] * b[1];
+        c[1] = a[2] * b[0] - a[0] * b[2];
+        c[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    inline double Vnorm(const double* v)
+    {
+        return sqrt(Dot(v, v));
+    }
+
+    // vsep_
+    double Vsep(const double* v1, const double* v2)
+    {
+        const double m1 = Vnorm(v1), m2 = Vnorm(v2);
+        if (m1 == 0. || m2 == 0.)
+        {
+            return 0.;
+        }
+
+        const double u1[3] = { v1[0] / m1, v1[1] / m1, v1[2] / m1 };
+        const double u2[3] = { v2[0] / m2, v2[1] / m2, v2[2] / m2 };
+        const double d = Dot(u1, u2);
+        if (d > 0.)
+        {
+            const double t[3] = { u1[0] - u2[0], u1[1] - u2[1], u1[2] - u2[2] };
+            return asin(Vnorm(t) * .5) * 2.;
+        }
+        if (d < 0.)
+        {
+            const double t[3] = { u1[0] + u2[0], u1[1] + u2[1], u1[2] + u2[2] };
+            return pi - asin(Vnorm(t) * .5) * 2.;
+        }
+        return pi / 2.;
+    }
+
+    // ucrss_
+    inline void Ucrss(const double* a, const double* b, double* c)
+    {
+        Cross(a, b, c);
+        const double m = Vnorm(c);
+        if (m > 0.)
+        {
+            c[0] /= m; c[1] /= m; c[2] /= m;
+        }
+    }
+
+    // oscelt_ (elts[0..7]) and, if bExtended, oscltx_ (elts[8..10])
+    bool Oscltx(const double(&state)[6], double et, double mu, double(&elts)[11], bool bExtended)
+    {
+        FMemory::Memzero(elts);
+
+        const double* r = state;
+        const double* v = state + 3;
+        const double rmag = Vnorm(r);
+        const double vmag = Vnorm(v);
+        if (rmag == 0. || vmag == 0.)
+        {
+            return false;
+        }
+
+        double h[3];
+        Cross(r, v, h);
+        if (h[0] == 0. && h[1] == 0. && h[2] == 0.)
+        {
+            return false;
+        }
+
+        double n[3] = { -h[1], h[0], 0. };
+
+        const double c1 = vmag * vmag - mu / rmag;
+        const double c2 = -Dot(r, v);
+        double e[3] = { (c1 * r[0] + c2 * v[0]) / mu, (c1 * r[1] + c2 * v[1]) / mu, (c1 * r[2] + c2 * v[2]) / mu };
+
+        double ecc = Vnorm(e);
+        ecc = FMath::Abs(ecc - 1.) <= 1e-10 ? 1. : ecc;
+
+        const double p = Dot(h, h) / mu;
+        const double rp = p / (ecc + 1.);
+
+        const double zvec[3] = { 0., 0., 1. };
+        double inc = Vsep(h, zvec);
+        if (FMath::Abs(inc) < 1e-10)
+        {
+            inc = 0.;
+            n[0] = 1.; n[1] = 0.; n[2] = 0.;
+        }
+        else if (FMath::Abs(inc - pi) < 1e-10)
+        {
+            inc = pi;
+            n[0] = 1.; n[1] = 0.; n[2] = 0.;
+        }
+
+        double lnode = atan2(n[1], n[0]);
+        lnode = lnode < 0. ? lnode + twopi : lnode;
+
+        double argp = 0.;
+        if (ecc != 0.)
+        {
+            argp = Vsep(n, e);
+            if (argp != 0.)
+            {
+                if (inc == 0. || inc == pi)
+                {
+                    double xprod[3];
+                    Ucrss(h, n, xprod);
+                    argp = Dot(e, xprod) < 0. ? twopi - argp : argp;
+                }
+                else if (e[2] < 0.)
+                {
+                    argp = twopi - argp;
+                }
+            }
+        }
+
+        double perix[3], periy[3];
+        const double* px = ecc == 0. ? n : e;
+        const double pxmag = Vnorm(px);
+        perix[0] = px[0] / pxmag; perix[1] = px[1] / pxmag; perix[2] = px[2] / pxmag;
+        Ucrss(h, perix, periy);
+
+        const double nu = atan2(Dot(r, periy), Dot(r, perix));
+
+        double m0;
+        if (ecc < 1.)
+        {
+            const double cosea = (ecc + cos(nu)) / (ecc * cos(nu) + 1.);
+            const double sinea = rmag / rp * sqrt((1. - ecc) / (ecc + 1.)) * sin(nu);
+            const double ea = atan2(sinea, cosea);
+            m0 = FMath::Abs(ea - ecc * sin(ea));
+            m0 = nu >= 0. ? m0 : -m0;
+            m0 = m0 < 0. ? m0 + twopi : m0;
+        }
+        else if (ecc > 1.)
+        {
+            const double coshf = (ecc + cos(nu)) / (ecc * cos(nu) + 1.);
+            const double ea = acosh(FMath::Max(1., coshf));
+            m0 = FMath::Abs(ecc * sinh(ea) - ea);
+            m0 = nu >= 0. ? m0 : -m0;
+        }
+        else
+        {
+            const double ea = tan(nu / 2.);
+            m0 = FMath::Abs(ea + ea * (ea * ea) / 3.);
+            m0 = nu >= 0. ? m0 : -m0;
+        }
+
+        elts[0] = rp;
+        elts[1] = ecc;
+        elts[2] = inc;
+        elts[3] = lnode;
+        elts[4] = argp;
+        elts[5] = m0;
+        elts[6] = et;
+        elts[7] = mu;
+
+        if (!bExtended)
+        {
+            return true;
+        }
+
+        // (oscltx_)
+        constexpr double limit = DBL_MAX / 200.;
+
+        if (FMath::Abs(elts[1]) > 1e-10)
+        {
+            const double rhat[3] = { r[0] / rmag, r[1] / rmag, r[2] / rmag };
+            const double k1 = 1. / mu * (rmag * (vmag * vmag) - mu);
+            const double k2 = -(1. / mu) * Dot(r, v);
+            const double eccvec[3] = { k1 * rhat[0] + k2 * v[0], k1 * rhat[1] + k2 * v[1], k1 * rhat[2] + k2 * v[2] };
+
+            // twovec_ (x along eccvec, z toward the pole), then recrad_
+            double pole[3], x[3], y[3];
+            Ucrss(r, v, pole);
+            const double emag = Vnorm(eccvec);
+            x[0] = eccvec[0] / emag; x[1] = eccvec[1] / emag; x[2] = eccvec[2] / emag;
+            Ucrss(pole, x, y);
+
+            const double px_ = Dot(x, r), py_ = Dot(y, r);
+            double ra = px_ == 0. && py_ == 0. ? 0. : atan2(py_, px_);
+            elts[8] = ra < 0. ? ra + twopi : ra;
+        }
+        else
+        {
+            elts[8] = elts[5];
+        }
+
+        if (elts[1] == 1. || rmag <= mu / limit)
+        {
+            return true;
+        }
+
+        const double energy = vmag * vmag * .5 - mu / rmag;
+        if (FMath::Abs(energy) < FMath::Abs(mu) / limit)
+        {
+            return true;
+        }
+
+        const double sma = -mu / (energy * 2.);
+        elts[9] = sma;
+
+        if (ecc < 1.)
+        {
+            const double b = pow(limit / twopi, .66666666666666663);
+            const double mucubr = pow(mu, .33333333333333331);
+            const bool bComputeTau = mu >= 1. ? sma / mucubr < b : sma < b * mucubr;
+            if (bComputeTau)
+            {
+                elts[10] = twopi * pow(sma / mucubr, 1.5);
+            }
+        }
+
+        return true;
+    }
+
+    int32 OscltxBatchImpl(
+        TArrayView<const FSStateVector> states,
+        double et,
+        double mu,
+        TArrayView<FSConicElements> elts,
+        TArrayView<FSAngle> nu,
+        TArrayView<FSDistance> a,
+        TArrayView<FSEphemerisPeriod> tau,
+        TArrayView<bool> valid,
+        bool bExtended
+    )
+    {
+        const int32 Num = states.Num();
+        check(elts.Num() >= Num);
+        check(nu.Num() == 0 || nu.Num() >= Num);
+        check(a.Num() == 0 || a.Num() >= Num);
+        check(tau.Num() == 0 || tau.Num() >= Num);
+        check(valid.Num() == 0 || valid.Num() >= Num);
+
+        const int32 NumTasks = (Num + BatchRows - 1) / BatchRows;
+        TArray<int32> Succeeded;
+        Succeeded.SetNumZeroed(NumTasks);
+
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 Last = FMath::Min((Task + 1) * BatchRows, Num);
+            int32 Count = 0;
+
+            for (int32 i = Task * BatchRows; i < Last; ++i)
+            {
+                double state[6]; states[i].CopyTo(state);
+                double _elts[11];
+                const bool bValid = mu > 0. && Oscltx(state, et, mu, _elts, bExtended);
+                if (!bValid)
+                {
+                    FMemory::Memzero(_elts);
+                }
+
+                elts[i] = FSConicElements(
+                    FSDistance(_elts[0]), _elts[1], FSAngle(_elts[2]), FSAngle(_elts[3]),
+                    FSAngle(_elts[4]), FSAngle(_elts[5]), FSEphemerisTime(_elts[6]), FSMassConstant(_elts[7])
+                );
+                if (nu.Num()) nu[i] = FSAngle(_elts[8]);
+                if (a.Num()) a[i] = FSDistance(_elts[9]);
+                if (tau.Num()) tau[i] = FSEphemerisPeriod(_elts[10]);
+                if (valid.Num()) valid[i] = bValid;
+                Count += bValid;
+            }
+
+            Succeeded[Task] = Count;
+        });
+
+        int32 Total = 0;
+        for (int32 Count : Succeeded)
+        {
+            Total += Count;
+        }
+        return Total;
+    }
+
+    // Pointers to one lane-group's worth of each column
+    struct FLaneModel
+    {
+        const double *rx, *ry, *rz, *vx, *vy, *vz;
+        const double *sqrtmu, *alpha, *r0, *rv, *q;
+    };
+
+    // dt:  offsets from the lanes' states, reduced modulo period if elliptic.
+    // x gets the universal anomalies.
+    void EvaluateLanes(const FLaneModel& m, const double(&dt)[W], double(&state)[6][W], double(&x)[W])
+    {
+        double lo[W], hi[W];
+        bool done[W];
+
+        for (int32 l = 0; l < W; ++l)
+        {
+            const double bound = m.sqrtmu[l] * dt[l] / m.q[l];
+            lo[l] = dt[l] >= 0. ? 0. : bound;
+            hi[l] = dt[l] >= 0. ? bound : 0.;
+            done[l] = dt[l] == 0.;
+        }
+
+        // Initial guesses (Vallado, Algorithm 8)
+        for (int32 l = 0; l < W; ++l)
+        {
+            double guess = m.sqrtmu[l] * dt[l] / m.r0[l];
+            if (m.alpha[l] > 1e-12)
+            {
+                guess = m.sqrtmu[l] * dt[l] * m.alpha[l];
+            }
+            else if (m.alpha[l] < -1e-12)
+            {
+                const double a = 1. / m.alpha[l];
+                const double sign = dt[l] >= 0. ? 1. : -1.;
+                const double mu = m.sqrtmu[l] * m.sqrtmu[l];
+                const double h = log((-2. * mu * m.alpha[l] * dt[l]) / (m.rv[l] + sign * sqrt(-mu * a) * (1. - m.r0[l] * m.alpha[l])));
+                guess = FMath::IsFinite(h) ? sign * sqrt(-a) * h : guess;
+            }
+            x[l] = guess > lo[l] && guess < hi[l] ? guess : .5 * (lo[l] + hi[l]);
+            x[l] = done[l] ? 0. : x[l];
+        }
+
+        double c2[W], c3[W], r[W];
+        for (int32 Iteration = 0; Iteration < MaxIterations; ++Iteration)
+        {
+            bool bAllDone = true;
+
+            for (int32 l = 0; l < W; ++l)
+            {
+                const double x2 = x[l] * x[l];
+                Stumpff(m.alpha[l] * x2, c2[l], c3[l]);
+
+                const double rvs = m.rv[l] / m.sqrtmu[l];
+                const double k = 1. - m.alpha[l] * m.r0[l];
+                const double F = rvs * x2 * c2[l] + k * x2 * x[l] * c3[l] + m.r0[l] * x[l] - m.sqrtmu[l] * dt[l];
+                r[l] = rvs * x[l] * (1. - m.alpha[l] * x2 * c3[l]) + k * x2 * c2[l] + m.r0[l];
+
+                lo[l] = F < 0. ? x[l] : lo[l];
+                hi[l] = F < 0. ? hi[l] : x[l];
+
+                double next = x[l] - F / r[l];
+                next = next > lo[l] && next < hi[l] ? next : .5 * (lo[l] + hi[l]);
+
+                const bool bConverged = done[l] || FMath::Abs(next - x[l]) <= 1e-14 * FMath::Max(1., FMath::Abs(x[l]));
+                x[l] = done[l] ? x[l] : next;
+                done[l] = bConverged;
+                bAllDone &= bConverged;
+            }
+
+            if (bAllDone)
+            {
+                break;
+            }
+        }
+
+        // f and g (with the final x)
+        for (int32 l = 0; l < W; ++l)
+        {
+            const double x2 = x[l] * x[l];
+            const double z = m.alpha[l] * x2;
+            Stumpff(z, c2[l], c3[l]);
+
+            const double rvs = m.rv[l] / m.sqrtmu[l];
+            const double k = 1. - m.alpha[l] * m.r0[l];
+            const double rr = rvs * x[l] * (1. - z * c3[l]) + k * x2 * c2[l] + m.r0[l];
+
+            const double f = 1. - x2 * c2[l] / m.r0[l];
+            const double g = dt[l] - x2 * x[l] * c3[l] / m.sqrtmu[l];
+            const double fdot = m.sqrtmu[l] / (rr * m.r0[l]) * x[l] * (z * c3[l] - 1.);
+            const double gdot = 1. - x2 * c2[l] / rr;
+
+            state[0][l] = f * m.rx[l] + g * m.vx[l];
+            state[1][l] = f * m.ry[l] + g * m.vy[l];
+            state[2][l] = f * m.rz[l] + g * m.vz[l];
+            state[3][l] = fdot * m.rx[l] + gdot * m.vx[l];
+            state[4][l] = fdot * m.ry[l] + gdot * m.vy[l];
+            state[5][l] = fdot * m.rz[l] + gdot * m.vz[l];
+        }
+    }
+
+    // Periapsis distance and period (zero if not elliptic) of a state.  False
+    // for states prop2b_c would signal an error for (zero position, velocity
+    // or angular momentum).
+    bool PeriapsisAndPeriod(const double(&state)[6], double mu, double& q, double& period)
+    {
+        double h[3];
+        Cross(state, state + 3, h);
+        const double h2 = Dot(h, h);
+        const double r0 = sqrt(Dot(state, state));
+        if (r0 == 0. || Dot(state + 3, state + 3) == 0. || h2 == 0.)
+        {
+            return false;
+        }
+
+        // Eccentricity vector:  (v x h) / mu - r / |r|
+        double vxh[3];
+        Cross(state + 3, h, vxh);
+        const double e[3] = { vxh[0] / mu - state[0] / r0, vxh[1] / mu - state[1] / r0, vxh[2] / mu - state[2] / r0 };
+        const double ecc = sqrt(Dot(e, e));
+
+        const double alpha = 2. / r0 - Dot(state + 3, state + 3) / mu;
+        period = alpha > 0. ? twopi / (sqrt(mu * alpha) * alpha) : 0.;
+        q = h2 / (mu * (1. + ecc));
+        return true;
+    }
+
+    // d(state)/d(s0) for s0 propagated by dt (unreduced), given the universal
+    // anomaly x EvaluateLanes found.  With F(x) = 0 at the root and dF/dx = r,
+    // one Newton step taken in dual numbers gives dx/d(s0) = -dF/d(s0) / r,
+    // and f, g, fdot and gdot follow by the chain rule.
+    void StateTransition(const double(&s0)[6], double mu, double dt, double period, double x, double(&stm)[6][6])
+    {
+        using Dual::FDual;
+
+        FDual s[6];
+        for (int32 k = 0; k < 6; ++k)
+        {
+            s[k].v = s0[k];
+            s[k].d[k] = 1.;
+        }
+
+        const double sqrtmu = sqrt(mu);
+        const FDual r0 = Dual::sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+        const FDual rvs = (s[0] * s[3] + s[1] * s[4] + s[2] * s[5]) / sqrtmu;
+        const FDual alpha = 2. / r0 - (s[3] * s[3] + s[4] * s[4] + s[5] * s[5]) / mu;
+        const FDual k = 1. - alpha * r0;
+
+        // dt was reduced by whole periods, which depend on the state
+        FDual dtr = dt;
+        if (period > 0.)
+        {
+            const double n = FMath::TruncToDouble(dt / period);
+            dtr = dt - n * (twopi / (sqrtmu * alpha * Dual::sqrt(alpha)));
+        }
+
+        const double x2 = x * x;
+        FDual c2, c3;
+        Stumpff(alpha * x2, c2, c3);
+        const FDual F = rvs * x2 * c2 + k * x2 * x * c3 + r0 * x - sqrtmu * dtr;
+        const FDual r = rvs * x * (1. - alpha * x2 * c3) + k * x2 * c2 + r0;
+
+        FDual X(x);
+        for (int32 c = 0; c < 6; ++c)
+        {
+            X.d[c] = -F.d[c] / r.v;
+        }
+
+        const FDual X2 = X * X;
+        const FDual z = alpha * X2;
+        Stumpff(z, c2, c3);
+        const FDual rr = rvs * X * (1. - z * c3) + k * X2 * c2 + r0;
+        const FDual f = 1. - X2 * c2 / r0;
+        const FDual g = dtr - X2 * X * c3 / sqrtmu;
+        const FDual fdot = sqrtmu / (rr * r0) * X * (z * c3 - 1.);
+        const FDual gdot = 1. - X2 * c2 / rr;
+
+        for (int32 j = 0; j < 3; ++j)
+        {
+            const FDual p = f * s[j] + g * s[j + 3];
+            const FDual v = fdot * s[j] + gdot * s[j + 3];
+            for (int32 c = 0; c < 6; ++c)
+            {
+                stm[j][c] = p.d[c];
+                stm[j + 3][c] = v.d[c];
+            }
+        }
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    void FTwoBodyBatchPropagator::Reset()
+    {
+        Columns.Empty();
+        Valid.Empty();
+        Rows = 0;
+        NumObjects = 0;
+    }
+
+
+    SIZE_T FTwoBodyBatchPropagator::GetAllocatedSize() const
+    {
+        return Columns.GetAllocatedSize() + Valid.GetAllocatedSize();
+    }
+
+
+    void FTwoBodyBatchPropagator::Allocate(int32 Num)
+    {
+        NumObjects = Num;
+        Rows = (Num + W - 1) / W * W;
+        Columns.SetNumUninitialized(NumColumns * Rows);
+        Valid.SetNumZeroed(Num);
+
+        // Padding (and invalid entries) get a harmless unit circular orbit
+        const double unit[6] = { 1., 0., 0., 0., 1., 0. };
+        for (int32 Row = 0; Row < Rows; ++Row)
+        {
+            SetRow(Row, unit, 1., 1., 0., 0., twopi);
+        }
+    }
+
+
+    void FTwoBodyBatchPropagator::SetRow(int32 Row, const double(&state)[6], double mu, double q, double t0, double dt0, double period)
+    {
+        const double r0 = sqrt(Dot(state, state));
+        const double v2 = Dot(state + 3, state + 3);
+
+        Column(EColumn::rx)[Row] = state[0];
+        Column(EColumn::ry)[Row] = state[1];
+        Column(EColumn::rz)[Row] = state[2];
+        Column(EColumn::vx)[Row] = state[3];
+        Column(EColumn::vy)[Row] = state[4];
+        Column(EColumn::vz)[Row] = state[5];
+        Column(EColumn::sqrtmu)[Row] = sqrt(mu);
+        Column(EColumn::alpha)[Row] = 2. / r0 - v2 / mu;
+        Column(EColumn::r0)[Row] = r0;
+        Column(EColumn::rv)[Row] = Dot(state, state + 3);
+        Column(EColumn::q)[Row] = q;
+        Column(EColumn::t0)[Row] = t0;
+        Column(EColumn::dt0)[Row] = dt0;
+        Column(EColumn::period)[Row] = period;
+    }
+
+
+    void FTwoBodyBatchPropagator::Build(TArrayView<const FSConicElements> Orbits)
+    {
+        MAXQ_LLM_SCOPE();
+
+        Allocate(Orbits.Num());
+
+        for (int32 i = 0; i < Orbits.Num(); ++i)
+        {
+            double elts[8]; Orbits[i].CopyTo(elts);
+            const double rp = elts[0], ecc = elts[1], inc = elts[2], lnode = elts[3];
+            const double argp = elts[4], m0 = elts[5], t0 = elts[6], mu = elts[7];
+
+            // (as conics_c)
+            if (ecc < 0. || rp <= 0. || mu <= 0.)
+            {
+                continue;
+            }
+
+            const double cosi = cos(inc), sini = sin(inc);
+            const double cosn = cos(lnode), sinn = sin(lnode);
+            const double cosw = cos(argp), sinw = sin(argp);
+            const double snci = sinn * cosi;
+            const double cnci = cosn * cosi;
+            const double basisp[3] = { cosn * cosw - snci * sinw, sinn * cosw + cnci * sinw, sini * sinw };
+            const double basisq[3] = { -cosn * sinw - snci * cosw, -sinn * sinw + cnci * cosw, sini * cosw };
+            const double v = sqrt(mu * (ecc + 1.) / rp);
+            const double pstate[6] = { rp * basisp[0], rp * basisp[1], rp * basisp[2], v * basisq[0], v * basisq[1], v * basisq[2] };
+
+            double n, period = 0.;
+            if (ecc < 1.)
+            {
+                const double ainvrs = (1. - ecc) / rp;
+                n = sqrt(mu * ainvrs) * ainvrs;
+                period = twopi / n;
+            }
+            else if (ecc > 1.)
+            {
+                const double ainvrs = (ecc - 1.) / rp;
+                n = sqrt(mu * ainvrs) * ainvrs;
+            }
+            else
+            {
+                n = sqrt(mu / (rp * 2.)) / rp;
+            }
+
+            SetRow(i, pstate, mu, rp, t0, m0 / n, period);
+            Valid[i] = true;
+        }
+    }
+
+
+    void FTwoBodyBatchPropagator::Build(const FSMassConstant& gm, TArrayView<const FSStateVector> States, const FSEphemerisTime& Epoch)
+    {
+        MAXQ_LLM_SCOPE();
+
+        Allocate(States.Num());
+
+        const double mu = gm.GM;
+        if (mu <= 0.)
+        {
+            return;
+        }
+
+        for (int32 i = 0; i < States.Num(); ++i)
+        {
+            double state[6]; States[i].CopyTo(state);
+
+            double q, period;
+            if (PeriapsisAndPeriod(state, mu, q, period))
+            {
+                SetRow(i, state, mu, q, Epoch.seconds, 0., period);
+                Valid[i] = true;
+            }
+        }
+    }
+
+
+    int32 FTwoBodyBatchPropagator::Propagate(const FSEphemerisTime& et, TArrayView<FSStateVector> OutStates, const FSRotationMatrix* Rotation) const
+    {
+        check(OutStates.Num() >= NumObjects);
+
+        double m[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+        if (Rotation)
+        {
+            Rotation->CopyTo(m);
+        }
+
+        const double _et = et.AsSpiceDouble();
+        const int32 NumTasks = (Rows + BatchRows - 1) / BatchRows;
+
+        TArray<int32> Succeeded;
+        Succeeded.SetNumZeroed(NumTasks);
+
+        ParallelFor(NumTasks, [&](int32 Task)
+        {
+            const int32 First = Task * BatchRows;
+            const int32 Last = FMath::Min(First + BatchRows, Rows);
+            int32 Count = 0;
+
+            for (int32 Row = First; Row < Last; Row += W)
+            {
+                FLaneModel lm;
+                lm.rx = Column(EColumn::rx) + Row;
+                lm.ry = Column(EColumn::ry) + Row;
+                lm.rz = Column(EColumn::rz) + Row;
+                lm.vx = Column(EColumn::vx) + Row;
+                lm.vy = Column(EColumn::vy) + Row;
+                lm.vz = Column(EColumn::vz) + Row;
+                lm.sqrtmu = Column(EColumn::sqrtmu) + Row;
+                lm.alpha = Column(EColumn::alpha) + Row;
+                lm.r0 = Column(EColumn::r0) + Row;
+                lm.rv = Column(EColumn::rv) + Row;
+                lm.q = Column(EColumn::q) + Row;
+
+                // (locals named apart from the columns)
+                const double* epochs = Column(EColumn::t0) + Row;
+                const double* offsets = Column(EColumn::dt0) + Row;
+                const double* periods = Column(EColumn::period) + Row;
+
+                double dt[W];
+                for (int32 l = 0; l < W; ++l)
+                {
+                    dt[l] = ReducedOffset((_et - epochs[l]) + offsets[l], periods[l]);
+                }
+
+                double state[6][W], x[W];
+                EvaluateLanes(lm, dt, state, x);
+
+                for (int32 l = 0; l < W && Row + l < NumObjects; ++l)
+                {
+                    const int32 i = Row + l;
+                    if (!Valid[i])
+                    {
+                        OutStates[i] = FSStateVector();
+                        continue;
+                    }
+
+                    // (mxv, twice)
+                    double s[6];
+                    for (int32 j = 0; j < 3; ++j)
+                    {
+                        s[j] = m[j][0] * state[0][l] + m[j][1] * state[1][l] + m[j][2] * state[2][l];
+                        s[j + 3] = m[j][0] * state[3][l] + m[j][1] * state[4][l] + m[j][2] * state[5][l];
+                    }
+
+                    OutStates[i] = FSStateVector(s);
+                    ++Count;
+                }
+            }
+
+            Succeeded[Task] = Count;
+        });
+
+        int32 Total = 0;
+        for (int32 Count : Succeeded)
+        {
+            Total += Count;
+        }
+        return Total;
+    }
+
+
+    int32 OsceltBatch(
+        TArrayView<const FSStateVector> states,
+        const FSEphemerisTime& et,
+        const FSMassConstant& gm,
+        TArrayView<FSConicElements> elts,
+        TArrayView<bool> valid
+    )
+    {
+        return OscltxBatchImpl(states, et.seconds, gm.GM, elts, {}, {}, {}, valid, false);
+    }
+
+
+    int32 OscltxBatch(
+        TArrayView<const FSStateVector> states,
+        const FSEphemerisTime& et,
+        const FSMassConstant& gm,
+        TArrayView<FSConicElements> elts,
+        TArrayView<FSAngle> nu,
+        TArrayView<FSDistance> a,
+        TArrayView<FSEphemerisPeriod> tau,
+        TArrayView<bool> valid
+    )
+    {
+        return OscltxBatchImpl(states, et.seconds, gm.GM, elts, nu, a, tau, valid, true);
+    }
+
+
+    int32 Prop2bBatch(
+        const FSMassConstant& gm,
+        TArrayView<const FSStateVector> states,
+        TArrayView<const FSEphemerisPeriod> offsets,
+        TArrayView<FSStateVector> propagated,
+        TArrayView<FSStateTransform> stm,
+        TArrayView<bool> valid
+    )
+    {
+        const int32 NumStates = states.Num();
+        const int32 NumOffsets = offsets.Num();
+        check(propagated.Num() >= NumStates * NumOffsets);
+        check(stm.Num() == 0 || stm.Num() >= NumStates * NumOffsets);
+        check(valid.Num() == 0 || valid.Num() >= NumStates);
+
+        const double mu = gm.GM;
+
+        // A task is one state and up to BatchRows of its offsets, so a few
+        // states with many offsets still spread across threads
+        const int32 NumChunks = FMath::Max(1, (NumOffsets + BatchRows - 1) / BatchRows);
+        TArray<int32> Succeeded;
+        Succeeded.SetNumZeroed(NumStates);
+
+        ParallelFor(NumStates * NumChunks, [&](int32 Task)
+        {
+            const int32 i = Task / NumChunks;
+            const int32 First = (Task % NumChunks) * BatchRows;
+            const int32 Last = FMath::Min(First + BatchRows, NumOffsets);
+
+            double s0[6]; states[i].CopyTo(s0);
+            double q = 0., period = 0.;
+            const bool bValid = mu > 0. && PeriapsisAndPeriod(s0, mu, q, period);
+
+            if (First == 0)
+            {
+                if (valid.Num()) valid[i] = bValid;
+                Succeeded[i] = bValid;
+            }
+
+            if (!bValid)
+            {
+                const double zero[6][6] = { { 0. } };
+                for (int32 j = First; j < Last; ++j)
+                {
+                    propagated[i * NumOffsets + j] = FSStateVector();
+                    if (stm.Num()) stm[i * NumOffsets + j] = FSStateTransform(zero);
+                }
+                return;
+            }
+
+            // The same state in every lane;  the lanes are offsets
+            double rx[W], ry[W], rz[W], vx[W], vy[W], vz[W], sqrtmu[W], alpha[W], r0[W], rv[W], qs[W];
+            for (int32 l = 0; l < W; ++l)
+            {
+                rx[l] = s0[0]; ry[l] = s0[1]; rz[l] = s0[2];
+                vx[l] = s0[3]; vy[l] = s0[4]; vz[l] = s0[5];
+                sqrtmu[l] = sqrt(mu);
+                r0[l] = sqrt(Dot(s0, s0));
+                alpha[l] = 2. / r0[l] - Dot(s0 + 3, s0 + 3) / mu;
+                rv[l] = Dot(s0, s0 + 3);
+                qs[l] = q;
+            }
+            const FLaneModel lm{ rx, ry, rz, vx, vy, vz, sqrtmu, alpha, r0, rv, qs };
+
+            for (int32 j = First; j < Last; j += W)
+            {
+                double dt[W];
+                for (int32 l = 0; l < W; ++l)
+                {
+                    dt[l] = ReducedOffset(offsets[FMath::Min(j + l, Last - 1)].seconds, period);
+                }
+
+                double state[6][W], x[W];
+                EvaluateLanes(lm, dt, state, x);
+
+                for (int32 l = 0; l < W && j + l < Last; ++l)
+                {
+                    const int32 Out = i * NumOffsets + j + l;
+                    const double s[6] = { state[0][l], state[1][l], state[2][l], state[3][l], state[4][l], state[5][l] };
+                    propagated[Out] = FSStateVector(s);
+
+                    if (stm.Num())
+                    {
+                        double phi[6][6];
+                        StateTransition(s0, mu, offsets[j + l].seconds, period, x[l], phi);
+                        stm[Out] = FSStateTransform(phi);
+                    }
+                }
+            }
+        });
+
+        int32 Total = 0;
+        for (int32 Count : Succeeded)
+        {
+            Total += Count;
+        }
+        return Total;
+    }
+}
@@ -53,10 +53,9 @@
 #include "Containers/StringFwd.h"
 #include "Spice.h"
 #include "SpiceUtilities.h"
+#include "SpiceTime.h"
+#include "SpiceFormat.h"
 
-#include <iomanip>
-#include <sstream>
-#include <string>
 #include <cmath>
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
@@ -68,19 +67,6 @@ PRAGMA_POP_PLATFORM_DEFAULT_PACKING
 
 using namespace MaxQ::Private;
 
-// Create a future regret:
-//  1 platform differentiation
-//  2 using std::basic_ostringstream at all
-// ostringstream supports prettier angle formating in formatAngle
-#if PLATFORM_WIDECHAR_IS_CHAR16
-// Mac supports WIDECHAR as char16_t, which has no std::basic_ostringstream implementation
-#define EXTENDED_CHAR(x) x
-#define EXTENDED_CHAR_TYPE ANSICHAR
-#else
-#define EXTENDED_CHAR(x) L ## x
-#define EXTENDED_CHAR_TYPE WIDECHAR
-#endif
-
 
 void FSTwoLineElements::CopyTo(double(&_elems)[10]) const
 {
@@ -1345,137 +1331,19 @@ FString USpiceTypes::FormatDouble(double value)
 
 FString USpiceTypes::FormatDoublePrecisely(double value, int precision)
 {
-    // Create an output string stream
-    std::ostringstream streamObj;
-
-    // Set precision
-    streamObj << std::setprecision(FloatFormatPrecision);
-    
-    // Add double to stream
-    streamObj << value;
-
-    // And finally, as an Unreal-Engine FString
-    return FString(streamObj.str().c_str());
+    // (precision isn't used:  this has always printed FloatFormatPrecision
+    // digits.  MaxQ::Format::AppendDouble honors it.)
+    TStringBuilder<64> sb;
+    MaxQ::Format::AppendDouble(sb, value, FloatFormatPrecision);
+    return sb.ToString();
 }
 
 
 FString USpiceTypes::formatAngle(double degrees, ES_AngleFormat format)
 {
-    // UE displays degrees incorrectly
-    bool useDegreeSymbol = false;
-
-    std::basic_ostringstream<EXTENDED_CHAR_TYPE> streamObj;
-    int floatFormatPrecision = USpiceTypes::FloatFormatPrecision;
-    streamObj << std::setprecision(USpiceTypes::FloatFormatPrecision);
-
-    if (format == ES_AngleFormat::DD)
-    {
-        // note there's no ANSICHAR implementation for wostringstream::setfill...
-        streamObj << std::setfill(EXTENDED_CHAR_TYPE('0')) << std::setw(floatFormatPrecision + 2) << std::fixed << std::setprecision(floatFormatPrecision);
-        streamObj << degrees;
-#if !PLATFORM_WIDECHAR_IS_CHAR16
-        if(useDegreeSymbol) streamObj << EXTENDED_CHAR('\370');
-#endif
-    }
-    else if (format == ES_AngleFormat::DD_180)
-    {
-        streamObj << std::setfill(EXTENDED_CHAR_TYPE('0')) << std::setw(floatFormatPrecision + 2) << std::fixed << std::setprecision(floatFormatPrecision);
-        streamObj << normalize180to180(degrees);
-#if !PLATFORM_WIDECHAR_IS_CHAR16
-        if (useDegreeSymbol) streamObj << EXTENDED_CHAR('\370');
-#endif
-    }
-    else if (format == ES_AngleFormat::DD_360)
-    {
-        streamObj << std::setfill(EXTENDED_CHAR_TYPE('0')) << std::setw(floatFormatPrecision + 2) << std::fixed << std::setprecision(floatFormatPrecision);
-        streamObj << normalize0to360(degrees);
-#if !PLATFORM_WIDECHAR_IS_CHAR16
-        if (useDegreeSymbol) streamObj << EXTENDED_CHAR('\370');
-#endif
-    }
-    else if (format == ES_AngleFormat::DMS)
-    {
-        int frac_precision = floatFormatPrecision - 7;
-        double frac = abs(degrees);
-        
-        long deg = floorl(frac);
-
-        frac -= (double)deg;
-        if (degrees < 0.) deg *= -1;
-        streamObj << deg;
-#if !PLATFORM_WIDECHAR_IS_CHAR16
-        if (useDegreeSymbol) streamObj << EXTENDED_CHAR('\370');
-#endif
-        streamObj << ' ';
-
-        frac *= 60.;
-        long amin = floorl(frac);
-        frac -= (double)amin;
-        streamObj << std::setw(2) << std::setfill(EXTENDED_CHAR_TYPE('0')) << amin << '\'';
-
-        frac *= 60;
-
-        if (frac_precision <= 0)
-        {
-            long asec = lround(frac);
-            streamObj << std::setw(2) << std::setfill(EXTENDED_CHAR_TYPE('0')) << asec << '"';
-        }
-        else
-        {
-            double asec = frac;
-            streamObj << std::fixed << std::setprecision(frac_precision+2) << asec << '"';
-        }
-    }
-    else if (format == ES_AngleFormat::HMS)
-    {
-        int frac_precision = floatFormatPrecision - 7;
-        double frac = abs(degrees / 360. * 24);
-
-        long hour = floorl(frac);
-        frac -= (double)hour;
-
-        if (degrees < 0.) hour *= -1;
-        streamObj << hour << "h ";
-
-        frac *= 60.;
-        long min = floorl(frac);
-        frac -= (double)min;
-        streamObj << std::setw(2) << std::setfill(EXTENDED_CHAR('0')) << min << "m ";
-
-        frac *= 60;
-
-        if (frac_precision <= 0)
-        {
-            long sec = lround(frac);
-            streamObj << std::setw(2) << std::setfill(EXTENDED_CHAR('0')) << sec << "s ";
-        }
-        else
-        {
-            double sec = frac;
-            streamObj << std::fixed << std::setprecision(frac_precision + 2) << sec << "s";
-        }
-    }
-    else if (format == ES_AngleFormat::DR_PI)
-    {
-        streamObj << std::setfill(EXTENDED_CHAR('0')) << std::setfill(EXTENDED_CHAR('0')) << std::setw(floatFormatPrecision+2) << std::fixed << std::setprecision(floatFormatPrecision);
-        streamObj << normalizePiToPi(degrees / 360. * twopi_c());
-    }
-    else if (format == ES_AngleFormat::DR_2PI)
-    {
-        streamObj << std::setw(floatFormatPrecision + 2) << std::fixed << std::setprecision(floatFormatPrecision);
-        streamObj << normalizeZeroToTwoPi(degrees / 360. * twopi_c());
-    }
-    else
-    {
-        streamObj << std::setfill(EXTENDED_CHAR('0')) << std::setw(floatFormatPrecision + 2) << std::fixed << std::setprecision(floatFormatPrecision);
-        streamObj << (degrees / 360. * twopi_c());
-    }
-    
-    // Collapsing this into `FString(streamObj.str().c_str())` causes the str() to go out of scope,
-    // which would free the string buffer.  Bad.
-    // A const ref 'pins' the string returned by str() while it stays in scope.
-    const std::basic_string<EXTENDED_CHAR_TYPE>& ecstr = streamObj.str();
-    return FString(ecstr.c_str());
+    TStringBuilder<64> sb;
+    MaxQ::Format::AppendAngle(sb, FSAngle::FromDegrees(degrees), format, FloatFormatPrecision);
+    return sb.ToString();
 }
 
 
@@ -1533,115 +1401,55 @@ double USpiceTypes::normalizePiToPi(double radians)
 
 FString USpiceTypes::FormatAngle(const FSAngle& value, ES_AngleFormat format)
 {
-    return formatAngle(value.degrees, format);
+    TStringBuilder<64> sb;
+    MaxQ::Format::AppendAngle(sb, value, format, FloatFormatPrecision);
+    return sb.ToString();
 }
 
 FString USpiceTypes::FormatLonLat(const FSLonLat& value, const FString& separator, ES_AngleFormat format)
 {
-    double longitude = value.longitude.degrees;
-
-    // First, normalize the latitude
-    double latitude = normalize180to180(value.latitude.degrees);
-    
-    // Deal with latitudes that wrap past the poles...
-    if (latitude > 90.)
-    {
-        // Spin longitude to the other side
-        longitude += 180.;
-        // Wrap around the pole
-        latitude = 180. - latitude;
-    }
-    else if (latitude < -90.)
-    {
-        // As above
-        longitude -= 180.;
-        latitude = -180. + latitude;
-    }
-
-    // NOW, we can normalize the longitude
-    longitude = normalize180to180(longitude);
-
-    return formatAngle(abs(longitude), format) + (longitude < 0 ? "W" : "E") + separator + formatAngle(abs(latitude), format) + (latitude < 0 ? "S" : "N");
+    TStringBuilder<128> sb;
+    MaxQ::Format::AppendLonLat(sb, value, separator, format, FloatFormatPrecision);
+    return sb.ToString();
 }
 
 FString USpiceTypes::FormatRADec(const FSAngle& rightAscension, const FSAngle& declination, const FString& separator)
 {
-    double ra = rightAscension.degrees;
-
-    // First, normalize the declination
-    double dec = normalize180to180(declination.degrees);
-
-    // Deal with dec's that wrap past the poles...
-    if (dec > 90.)
-    {
-        // Spin ra to the other side
-        ra += 180.;
-        // Wrap around the pole
-        dec = 180 - dec;
-    }
-    else if (dec < -90.)
-    {
-        // As above
-        ra -= 180.;
-        dec = -180 + dec;
-    }
-
-    // NOW, we can normalize the ra
-    ra = normalize0to360(ra);
-
-    return formatAngle(ra, ES_AngleFormat::HMS) + separator + formatAngle(dec, ES_AngleFormat::DMS);
+    TStringBuilder<128> sb;
+    MaxQ::Format::AppendRADec(sb, rightAscension, declination, separator, FloatFormatPrecision);
+    return sb.ToString();
 }
 
+// (As FormatDoublePrecisely, precision isn't used.)
 FString USpiceTypes::FormatDistance(const FSDistance& distance, ES_Units Units /*= ES_Units::KILOMETERS*/, int precision)
 {
-    double value = distance.AsKilometers();
-
-    if(Units != ES_Units::KILOMETERS)
-    {
-        convrt_c(value, MaxQ::Core::ToANSIString(ES_Units::KILOMETERS), MaxQ::Core::ToANSIString(Units), &value);
-        UnexpectedErrorCheck(false);
-    }
-
-    return FormatDoublePrecisely(value, precision);
+    TStringBuilder<64> sb;
+    MaxQ::Format::AppendDistance(sb, distance, Units, FloatFormatPrecision);
+    return sb.ToString();
 }
 
 FString USpiceTypes::FormatPeriod(const FSEphemerisPeriod& period, ES_Units Units /*= ES_Units::SECONDS*/, int precision)
 {
-    double value = period.AsSeconds();
-
-    if(Units != ES_Units::SECONDS)
-    {
-        convrt_c(value, MaxQ::Core::ToANSIString(ES_Units::SECONDS), MaxQ::Core::ToANSIString(Units), &value);
-
-        UnexpectedErrorCheck(false);
-    }
-
-    return FormatDoublePrecisely(value, precision);
+    TStringBuilder<64> sb;
+    MaxQ::Format::AppendPeriod(sb, period, Units, FloatFormatPrecision);
+    return sb.ToString();
 }
 
 FString USpiceTypes::FormatSpeed(const FSSpeed& speed, ES_Units NumeratorUnits /*= ES_Units::KILOMETERS*/, ES_Units DenominatorUnits /*= ES_Units::SECONDS*/, int precision)
 {
-    double value = speed.AsKilometersPerSecond();
-
-    if(NumeratorUnits != ES_Units::KILOMETERS)
-    {
-        convrt_c(value, MaxQ::Core::ToANSIString(ES_Units::KILOMETERS), MaxQ::Core::ToANSIString(NumeratorUnits), &value);
-        UnexpectedErrorCheck(false);
-    }
-
-    if(DenominatorUnits != ES_Units::SECONDS)
-    {
-        double denominator = 1.;
-        convrt_c(denominator, MaxQ::Core::ToANSIString(ES_Units::SECONDS), MaxQ::Core::ToANSIString(DenominatorUnits), &denominator);
-        value *= denominator;
-    }
-
-    return FormatDoublePrecisely(value, precision);
+    TStringBuilder<64> sb;
+    MaxQ::Format::AppendSpeed(sb, speed, NumeratorUnits, DenominatorUnits, FloatFormatPrecision);
+    return sb.ToString();
 }
 
 FString USpiceTypes::FormatUtcTime(const FSEphemerisTime& time, ES_UTCTimeFormat TimeFormat, int precision)
 {
     FString Result = TEXT("Time Format Error");
+    if (MaxQ::Time::UpdateTimeSystem() && MaxQ::Time::GetTimeSystem()->Format(time.AsSpiceDouble(), TimeFormat, precision, Result))
+    {
+        return Result;
+    }
+
     ES_ResultCode ResultCode;
     FString ErrorMessage;
     USpice::et2utc(ResultCode, ErrorMessage, time, TimeFormat, Result, precision);
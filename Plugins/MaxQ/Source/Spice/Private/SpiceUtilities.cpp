@@ -37,10 +37,16 @@
 //------------------------------------------------------------------------------
 
 #include "SpiceUtilities.h"
+#include "SpiceErrorBatch.h"
 #include "Misc/AssertionMacros.h"
 #include "CoreMinimal.h"
 #include "Misc/Paths.h"
+#include "Misc/CommandLine.h"
 #include "SpicePlatformDefs.h"
+#include "SpiceExecutor.h"
+#include "SpiceData.h"
+#include "SpiceGeometryFinder.h"
+#include <atomic>
 
 namespace MaxQ::Private
 {
@@ -60,8 +66,11 @@ namespace MaxQ::Private
 
         if(FPaths::IsRelative(path))
         {
-            auto gameDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
-            path = FPaths::Combine(gameDir, path);
+            const FString Root = MaxQ::Data::GetKernelRoot();
+            if (!Root.IsEmpty())
+            {
+                path = FPaths::Combine(Root, path);
+            }
         }
 
         const TCHAR* PathDelimiter = FPlatformMisc::GetDefaultPathSeparator();
@@ -76,6 +85,12 @@ namespace MaxQ::Private
         return path;
     }
 
+    FString SavedPath(const TCHAR* Subdirectory)
+    {
+        const FString Saved = FCommandLine::IsInitialized() ? FPaths::ProjectSavedDir() : FPlatformProcess::UserTempDir();
+        return FPaths::ConvertRelativePathToFull(FPaths::Combine(Saved, TEXT("MaxQ"), Subdirectory));
+    }
+
     void CopyFrom(const SpicePlane& _plane, FSPlane& dest)
     {
         SpiceDouble _planeNormal[3] = { 0, 0, 0 }, _planeConstant = 0;
@@ -134,13 +149,26 @@ namespace MaxQ::Private
 
     uint8 ErrorCheck(ES_ResultCode& ResultCode, FString& ErrorMessage, bool BeQuiet)
     {
+        SCOPE_CYCLE_COUNTER(STAT_MaxQ_ErrorCheck);
+
         uint8 failed = failed_c();
 
+        if (failed)
+        {
+            CountFailure();
+        }
+
         if (!failed)
         {
             ResultCode = ES_ResultCode::Success;
             ErrorMessage.Empty();
         }
+        else if (MaxQ::Core::FSpiceErrorBatch* Batch = MaxQ::Core::FSpiceErrorBatch::Current())
+        {
+            // In a batch, formatting and logging are rationed
+            ResultCode = ES_ResultCode::Error;
+            Batch->Record(ErrorMessage, BeQuiet);
+        }
         else
         {
             ResultCode = ES_ResultCode::Error;
@@ -193,6 +221,8 @@ namespace MaxQ::Private
 
         if (failed)
         {
+            CountFailure();
+
             char szBuffer[SpiceLongMessageMaxLength];
 
             szBuffer[0] = '\0';
@@ -217,4 +247,1104 @@ namespace MaxQ::Private
 
         return failed;
     }
+
+
+    namespace
+    {
+        // Past this, memory is handed back when the outermost scope ends
+        // (a one-off million ray dskxv shouldn't pin its buffers forever).
+        // Cells and search results are held to the same cap.
+        constexpr SIZE_T MaxRetainedScratch = 64 * 1024 * 1024;
+
+        struct FCellArena
+        {
+            TArray<SpiceDouble> Storage[(int)ECellSlot::Count];
+            bool bInUse[(int)ECellSlot::Count] = {};
+        };
+
+        FCellArena& CellArena()
+        {
+            static thread_local FCellArena Arena;
+            return Arena;
+        }
+    }
+
+
+    FDoubleCell::FDoubleCell(ECellSlot _Slot, SpiceInt Size)
+        : Storage(CellArena().bInUse[(int)_Slot] ? Owned : CellArena().Storage[(int)_Slot])
+        , Slot(_Slot)
+        , bArena(&Storage != &Owned)
+    {
+        if (bArena)
+        {
+            CellArena().bInUse[(int)Slot] = true;
+        }
+
+        FMemory::Memzero(Cell);
+        Reserve(Size);
+    }
+
+
+    FDoubleCell::~FDoubleCell()
+    {
+        if (bArena)
+        {
+            CellArena().bInUse[(int)Slot] = false;
+
+            if (Storage.GetAllocatedSize() > MaxRetainedScratch)
+            {
+                Storage.Empty();
+            }
+        }
+    }
+
+
+    void FDoubleCell::Reserve(SpiceInt Size)
+    {
+        MAXQ_LLM_SCOPE();
+
+        // Windows need an even size, and at least one interval
+        Size = FMath::Max(2, Size + (Size & 1));
+
+        if (Storage.Num() < SPICE_CELL_CTRLSZ + Size)
+        {
+            Storage.SetNumUninitialized(SPICE_CELL_CTRLSZ + Size);
+        }
+
+        // Same as SPICEDOUBLE_CELL, except the data is on the heap.
+        // init = SPICEFALSE makes CSPICE re-sync the control area on first use.
+        Cell.dtype = SPICE_DP;
+        Cell.length = 0;
+        Cell.size = Size;
+        Cell.card = 0;
+        Cell.isSet = SPICETRUE;
+        Cell.adjust = SPICEFALSE;
+        Cell.init = SPICEFALSE;
+        Cell.base = (void*)Storage.GetData();
+        Cell.data = (void*)(Storage.GetData() + SPICE_CELL_CTRLSZ);
+    }
+
+
+    namespace
+    {
+        struct FScratchArena
+        {
+            struct FBlock
+            {
+                uint8* Data = nullptr;
+                SIZE_T Size = 0;
+            };
+
+            // Blocks are never moved once allocated, so outstanding
+            // allocations stay valid as the arena grows.
+            TArray<FBlock> Blocks;
+            int32 Current = 0;
+            SIZE_T Used = 0;
+            int32 Depth = 0;
+
+            ~FScratchArena()
+            {
+                Release(0);
+            }
+
+            void Release(int32 FirstBlock)
+            {
+                for (int32 i = FirstBlock; i < Blocks.Num(); ++i)
+                {
+                    FMemory::Free(Blocks[i].Data);
+                }
+                Blocks.SetNum(FirstBlock);
+            }
+
+            SIZE_T Reserved() const
+            {
+                SIZE_T Total = 0;
+                for (const FBlock& Block : Blocks) Total += Block.Size;
+                return Total;
+            }
+        };
+
+        constexpr SIZE_T ScratchAlignment = 16;
+        constexpr SIZE_T MinScratchBlockSize = 64 * 1024;
+
+        FScratchArena& ScratchArena()
+        {
+            static thread_local FScratchArena Arena;
+            return Arena;
+        }
+    }
+
+
+    FScratchScope::FScratchScope()
+    {
+        FScratchArena& Arena = ScratchArena();
+        Block = Arena.Current;
+        Used = Arena.Used;
+        ++Arena.Depth;
+    }
+
+
+    FScratchScope::~FScratchScope()
+    {
+        FScratchArena& Arena = ScratchArena();
+        Arena.Current = Block;
+        Arena.Used = Used;
+
+        if (--Arena.Depth == 0 && Arena.Reserved() > MaxRetainedScratch)
+        {
+            Arena.Release(0);
+            Arena.Current = 0;
+            Arena.Used = 0;
+        }
+    }
+
+
+    void* FScratchScope::Alloc(SIZE_T Bytes)
+    {
+        MAXQ_LLM_SCOPE();
+
+        FScratchArena& Arena = ScratchArena();
+        Bytes = Align(FMath::Max<SIZE_T>(Bytes, 1), ScratchAlignment);
+
+        if (Arena.Current < Arena.Blocks.Num() && Arena.Used + Bytes > Arena.Blocks[Arena.Current].Size && Arena.Used > 0)
+        {
+            // Doesn't fit in what's left of this block, move on to the next
+            ++Arena.Current;
+            Arena.Used = 0;
+        }
+
+        if (Arena.Current == Arena.Blocks.Num())
+        {
+            const SIZE_T Previous = Arena.Blocks.Num() > 0 ? Arena.Blocks.Last().Size : 0;
+            Arena.Blocks.AddDefaulted();
+            Arena.Blocks.Last().Size = FMath::Max3(Bytes, MinScratchBlockSize, 2 * Previous);
+            Arena.Blocks.Last().Data = (uint8*)FMemory::Malloc(Arena.Blocks.Last().Size, ScratchAlignment);
+        }
+        else if (Arena.Blocks[Arena.Current].Size < Bytes)
+        {
+            // An empty block that's too small.  Nothing in it is live.
+            FScratchArena::FBlock& Small = Arena.Blocks[Arena.Current];
+            FMemory::Free(Small.Data);
+            Small.Size = FMath::Max(Bytes, 2 * Small.Size);
+            Small.Data = (uint8*)FMemory::Malloc(Small.Size, ScratchAlignment);
+        }
+
+        void* Result = Arena.Blocks[Arena.Current].Data + Arena.Used;
+        Arena.Used += Bytes;
+        return Result;
+    }
+
+
+    FWindowCell::FWindowCell(MaxQ::GeometryFinder::FSWindow& _Window, int32 Capacity)
+        : Window(_Window)
+    {
+        FMemory::Memzero(Cell);
+        Reserve(Capacity);
+    }
+
+    FWindowCell::~FWindowCell()
+    {
+        Sync();
+    }
+
+    void FWindowCell::Reserve(int32 Capacity)
+    {
+        using MaxQ::GeometryFinder::FSWindow;
+        TArray<double>& Storage = Window.Storage;
+
+        Sync();
+        const int32 Card = Storage.Num() - FSWindow::CellControlSize;
+
+        Capacity = FMath::Max3(Capacity, 1, (Storage.Max() - FSWindow::CellControlSize) / 2);
+        Storage.SetNumUninitialized(FSWindow::CellControlSize + 2 * Capacity, false);
+
+        // As FDoubleCell:  init = SPICEFALSE makes CSPICE re-sync the control
+        // area on first use.
+        Cell.dtype = SPICE_DP;
+        Cell.length = 0;
+        Cell.size = 2 * Capacity;
+        Cell.card = Card;
+        Cell.isSet = SPICETRUE;
+        Cell.adjust = SPICEFALSE;
+        Cell.init = SPICEFALSE;
+        Cell.base = (void*)Storage.GetData();
+        Cell.data = (void*)(Storage.GetData() + FSWindow::CellControlSize);
+    }
+
+    bool FWindowCell::IsFull() const
+    {
+        // The cardinality in the control area, which CSPICE keeps current.
+        // Cell.card is only copied back from it when a call succeeds.
+        const SpiceDouble* Control = (const SpiceDouble*)Cell.base;
+        return Control && (SpiceInt)Control[MaxQ::GeometryFinder::FSWindow::CellControlSize - 1] >= Cell.size;
+    }
+
+    void FWindowCell::Sync()
+    {
+        if (Cell.base)
+        {
+            const int32 Card = FMath::Clamp<int32>(Cell.card & ~1, 0, Cell.size);
+            Window.Storage.SetNum(MaxQ::GeometryFinder::FSWindow::CellControlSize + Card, false);
+            Cell.base = nullptr;
+            Cell.data = nullptr;
+        }
+    }
+
+
+    void FillWindow(FDoubleCell& Cell, const MaxQ::GeometryFinder::FSWindow& Window)
+    {
+        const TArrayView<const double> Endpoints = Window.Endpoints();
+
+        Cell.Reserve(Endpoints.Num());
+        FMemory::Memcpy(Cell.Get()->data, Endpoints.GetData(), Endpoints.Num() * sizeof(SpiceDouble));
+        scard_c(Endpoints.Num(), Cell.Get());
+    }
+
+
+    static bool IsWindowOverflow()
+    {
+        if (!failed_c())
+        {
+            return false;
+        }
+
+        char szBuffer[SpiceLongMessageMaxLength];
+        szBuffer[0] = '\0';
+        getmsg_c("SHORT", sizeof(szBuffer), szBuffer);
+
+        return
+            !SpiceStringCompare(szBuffer, "SPICE(WINDOWEXCESS)") ||
+            !SpiceStringCompare(szBuffer, "SPICE(WINDOWTOOSMALL)") ||
+            !SpiceStringCompare(szBuffer, "SPICE(WINDOWSTOOSMALL)") ||
+            !SpiceStringCompare(szBuffer, "SPICE(OUTOFROOM)");
+    }
+
+
+    namespace
+    {
+        thread_local bool bInGfSearch = false;
+    }
+
+    static bool IsNestedGfSearch()
+    {
+        if (!bInGfSearch)
+        {
+            return false;
+        }
+
+        setmsg_c("A geometry finder search was started while another search was running on the same thread. The GF subsystem is not re-entrant.");
+        sigerr_c("SPICE(NESTEDGFSEARCH)");
+        return true;
+    }
+
+
+    void GfSearch(
+        const MaxQ::GeometryFinder::FSWindow& cnfine,
+        MaxQ::GeometryFinder::FSWindow& results,
+        TFunctionRef<void(SpiceCell* _cnfine, SpiceCell* _result)> Search
+    )
+    {
+        // Largest result we're willing to grow to (in intervals)...
+        // Anything bigger than this is almost certainly a bad step size.
+        constexpr int32 MaxResultIntervals = 16 * 1024 * 1024;
+        constexpr int32 DefaultResultIntervals = 100;
+
+        if (IsNestedGfSearch())
+        {
+            results.Reset();
+            return;
+        }
+
+        MAXQ_GF_SEARCH_SCOPE();
+        TGuardValue<bool> Searching(bInGfSearch, true);
+
+        FDoubleCell _cnfine(ECellSlot::Confinement, 2 * cnfine.Num());
+        FillWindow(_cnfine, cnfine);
+
+        results.Reset();
+        if (failed_c())
+        {
+            return;
+        }
+
+        FWindowCell _result(results, DefaultResultIntervals);
+
+        while (true)
+        {
+            scard_c(0, _result.Get());
+            Search(_cnfine.Get(), _result.Get());
+
+            // Only a full result is worth growing.  A search that ran out of
+            // its own workspace (nintvls) would fail again at any size.
+            if (!IsWindowOverflow() || !_result.IsFull() || _result.Size() >= 2 * MaxResultIntervals)
+            {
+                break;
+            }
+
+            // The search ran out of room.  Grow and go again.
+            // (Size() is in doubles, so this doubles the capacity)
+            reset_c();
+            _result.Reserve(_result.Size());
+
+            // The search may have consumed the confinement window...
+            FillWindow(_cnfine, cnfine);
+        }
+
+        _result.Sync();
+
+        if (failed_c())
+        {
+            results.Reset();
+        }
+    }
+
+
+    void GfSearch(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        TFunctionRef<void(SpiceCell* _cnfine, SpiceCell* _result)> Search
+    )
+    {
+        results.Reset();
+
+        // Before Results, which the outer search is writing to
+        if (IsNestedGfSearch())
+        {
+            return;
+        }
+
+        for (const FSEphemerisTimeWindowSegment& Segment : cnfine)
+        {
+            if (Segment.start.seconds > Segment.stop.seconds)
+            {
+                setmsg_c("Left endpoint was #. Right endpoint was #.");
+                errdp_c("#", Segment.start.seconds);
+                errdp_c("#", Segment.stop.seconds);
+                sigerr_c("SPICE(BADENDPOINTS)");
+                return;
+            }
+        }
+
+        // Per-thread, so it keeps its allocation (as the cell arena does)
+        static thread_local MaxQ::GeometryFinder::FSWindow Results;
+        GfSearch(MaxQ::GeometryFinder::FSWindow(cnfine), Results, Search);
+        Results.ToSegments(results);
+
+        if (Results.GetAllocatedSize() > MaxRetainedScratch)
+        {
+            Results = MaxQ::GeometryFinder::FSWindow();
+        }
+    }
+
+    namespace
+    {
+        std::atomic<double> GfTolerance { SPICE_GF_CNVTOL };
+
+        // The search in progress on this thread
+        struct FGfProgress
+        {
+            const MaxQ::GeometryFinder::FGfSearchControl* Control = nullptr;
+            double Total = 0.;
+            double Done = 0.;
+            double IntervalStart = 0.;
+            double IntervalStop = 0.;
+            int32 Pass = 1;
+            int32 Passes = 1;
+            float Reported = -1.f;
+            bool bCancelled = false;
+        };
+        thread_local FGfProgress GfProgress;
+
+        void Report(double PassFraction)
+        {
+            // Searches that make more than one pass say so ("... pass 1 of 2")
+            const float Fraction = (float)FMath::Clamp(((GfProgress.Pass - 1) + PassFraction) / GfProgress.Passes, 0., 1.);
+
+            // Monotonic, and no more often than every 0.1%
+            if (Fraction >= GfProgress.Reported + 1.e-3f || (Fraction >= 1.f && GfProgress.Reported < 1.f))
+            {
+                GfProgress.Reported = Fraction;
+                GfProgress.Control->OnProgress(Fraction);
+            }
+        }
+
+        void GfReportInit(SpiceCell* cnfine, ConstSpiceChar* srcpre, ConstSpiceChar* srcsuf)
+        {
+            GfProgress.Total = 0.;
+            GfProgress.Done = 0.;
+            GfProgress.IntervalStart = GfProgress.IntervalStop = 0.;
+            for (SpiceInt i = 0; i + 1 < card_c(cnfine); i += 2)
+            {
+                GfProgress.Total += SPICE_CELL_ELEM_D(cnfine, i + 1) - SPICE_CELL_ELEM_D(cnfine, i);
+            }
+
+            int Pass = 1, Passes = 1;
+            const ANSICHAR* PassText = srcpre ? FCStringAnsi::Strifind(srcpre, "pass ") : nullptr;
+            if (PassText && sscanf(PassText + 5, "%d of %d", &Pass, &Passes) == 2 && Pass >= 1 && Passes >= Pass)
+            {
+                GfProgress.Pass = Pass;
+                GfProgress.Passes = Passes;
+            }
+            Report(0.);
+        }
+
+        void GfReportUpdate(SpiceDouble ivbeg, SpiceDouble ivend, SpiceDouble time)
+        {
+            if (ivbeg != GfProgress.IntervalStart || ivend != GfProgress.IntervalStop)
+            {
+                GfProgress.Done += GfProgress.IntervalStop - GfProgress.IntervalStart;
+                GfProgress.IntervalStart = ivbeg;
+                GfProgress.IntervalStop = ivend;
+            }
+            if (GfProgress.Total > 0.)
+            {
+                Report((GfProgress.Done + (time - ivbeg)) / GfProgress.Total);
+            }
+        }
+
+        void GfReportFinish()
+        {
+            Report(1.);
+        }
+
+        SpiceBoolean GfBail()
+        {
+            if (!GfProgress.bCancelled && GfProgress.Control->ShouldCancel())
+            {
+                GfProgress.bCancelled = true;
+            }
+            return GfProgress.bCancelled ? SPICETRUE : SPICEFALSE;
+        }
+
+        // Sets up the step and the progress, then Search(tol, rpt, bail)
+        template<typename SearchType>
+        void ControlledSearch(SpiceDouble _step, SearchType&& Search)
+        {
+            const MaxQ::GeometryFinder::FGfSearchControl* Control = MaxQ::GeometryFinder::FGfSearchControlScope::Current();
+            check(Control);
+
+            gfsstp_c(_step);
+            if (failed_c())
+            {
+                return;
+            }
+
+            GfProgress = FGfProgress();
+            GfProgress.Control = Control;
+            Search(GfTolerance.load(std::memory_order_relaxed), Control->OnProgress ? SPICETRUE : SPICEFALSE, Control->ShouldCancel ? SPICETRUE : SPICEFALSE);
+
+            const bool bCancelled = GfProgress.bCancelled;
+            GfProgress = FGfProgress();
+
+            if (bCancelled && !failed_c())
+            {
+                setmsg_c("The search was cancelled.");
+                sigerr_c("SPICE(CANCELLED)");
+            }
+        }
+    }
+
+
+    bool IsGfSearchControlled()
+    {
+        return MaxQ::GeometryFinder::FGfSearchControlScope::Current() != nullptr;
+    }
+
+
+    void SetGfTolerance(double Tolerance)
+    {
+        GfTolerance.store(Tolerance, std::memory_order_relaxed);
+    }
+
+
+    double GetGfTolerance()
+    {
+        return GfTolerance.load(std::memory_order_relaxed);
+    }
+
+
+    FGfQuantity& FGfQuantity::Param(ConstSpiceChar* _Name, ConstSpiceChar* _Value)
+    {
+        check(Num < MaxParams);
+        FCStringAnsi::Strncpy(Names[Num], _Name, ValueLength);
+        FCStringAnsi::Strncpy(Values[Num], _Value, ValueLength);
+        ++Num;
+        return *this;
+    }
+
+
+    FGfQuantity& FGfQuantity::Param(ConstSpiceChar* _Name, const SpiceDouble (&_Value)[3])
+    {
+        FMemory::Memcpy(Doubles, _Value, sizeof(_Value));
+        return Param(_Name, " ");
+    }
+
+
+    void GfEvent(
+        const FGfQuantity& Quantity,
+        ConstSpiceChar* _relate,
+        SpiceDouble _refval,
+        SpiceDouble _adjust,
+        SpiceDouble _step,
+        SpiceInt _nintvls,
+        SpiceCell* _cnfine,
+        SpiceCell* _result
+    )
+    {
+        ControlledSearch(_step, [&](SpiceDouble _tol, SpiceBoolean _rpt, SpiceBoolean _bail)
+        {
+            gfevnt_c(
+                gfstep_c,
+                gfrefn_c,
+                Quantity.Name,
+                Quantity.Num,
+                FGfQuantity::ValueLength,
+                Quantity.Names,
+                Quantity.Values,
+                Quantity.Doubles,
+                Quantity.Ints,
+                Quantity.Bools,
+                _relate,
+                _refval,
+                _tol,
+                _adjust,
+                _rpt,
+                GfReportInit,
+                GfReportUpdate,
+                GfReportFinish,
+                _nintvls,
+                _bail,
+                GfBail,
+                _cnfine,
+                _result
+            );
+        });
+    }
+
+
+    void GfOccultation(
+        ConstSpiceChar* _occtyp,
+        ConstSpiceChar* _front,
+        ConstSpiceChar* _fshape,
+        ConstSpiceChar* _fframe,
+        ConstSpiceChar* _back,
+        ConstSpiceChar* _bshape,
+        ConstSpiceChar* _bframe,
+        ConstSpiceChar* _abcorr,
+        ConstSpiceChar* _obsrvr,
+        SpiceDouble _step,
+        SpiceCell* _cnfine,
+        SpiceCell* _result
+    )
+    {
+        ControlledSearch(_step, [&](SpiceDouble _tol, SpiceBoolean _rpt, SpiceBoolean _bail)
+        {
+            gfocce_c(
+                _occtyp,
+                _front,
+                _fshape,
+                _fframe,
+                _back,
+                _bshape,
+                _bframe,
+                _abcorr,
+                _obsrvr,
+                _tol,
+                gfstep_c,
+                gfrefn_c,
+                _rpt,
+                GfReportInit,
+                GfReportUpdate,
+                GfReportFinish,
+                _bail,
+                GfBail,
+                _cnfine,
+                _result
+            );
+        });
+    }
+
+
+    void GfFieldOfView(
+        ConstSpiceChar* _inst,
+        ConstSpiceChar* _tshape,
+        const SpiceDouble (&_raydir)[3],
+        ConstSpiceChar* _target,
+        ConstSpiceChar* _tframe,
+        ConstSpiceChar* _abcorr,
+        ConstSpiceChar* _obsrvr,
+        SpiceDouble _step,
+        SpiceCell* _cnfine,
+        SpiceCell* _result
+    )
+    {
+        ControlledSearch(_step, [&](SpiceDouble _tol, SpiceBoolean _rpt, SpiceBoolean _bail)
+        {
+            gffove_c(
+                _inst,
+                _tshape,
+                _raydir,
+                _target,
+                _tframe,
+                _abcorr,
+                _obsrvr,
+                _tol,
+                gfstep_c,
+                gfrefn_c,
+                _rpt,
+                GfReportInit,
+                GfReportUpdate,
+                GfReportFinish,
+                _bail,
+                GfBail,
+                _cnfine,
+                _result
+            );
+        });
+    }
+
+
+    bool ResolveBody(ConstSpiceChar* _name, SpiceInt& _code)
+    {
+        SpiceBoolean _found = SPICEFALSE;
+        bods2c_c(_name, &_code, &_found);
+
+        if (!failed_c() && !_found)
+        {
+            setmsg_c("The body name # could not be translated to a NAIF ID code.");
+            errch_c("#", _name);
+            sigerr_c("SPICE(IDCODENOTFOUND)");
+        }
+
+        return !failed_c();
+    }
+
+    // spkapo/spkltc need the observer state in an inertial frame
+    bool IsInertialFrame(ConstSpiceChar* _ref)
+    {
+        SpiceInt _frcode = 0;
+        namfrm_c(_ref, &_frcode);
+        if (_frcode == 0)
+        {
+            return false;
+        }
+
+        SpiceInt _cent, _frclss, _clssid;
+        SpiceBoolean _found = SPICEFALSE;
+        frinfo_c(_frcode, &_cent, &_frclss, &_clssid, &_found);
+
+        // Frame class 1 == inertial
+        return _found && _frclss == 1;
+    }
+
+
+    void CloseDaf(SpiceInt _handle)
+    {
+        if (!failed_c())
+        {
+            dafcls_c(_handle);
+            return;
+        }
+
+        char szShort[SpiceLongMessageMaxLength];
+        char szLong[SpiceLongMessageMaxLength];
+        getmsg_c("SHORT", sizeof(szShort), szShort);
+        getmsg_c("LONG", sizeof(szLong), szLong);
+        reset_c();
+
+        dafcls_c(_handle);
+
+        setmsg_c(szLong);
+        sigerr_c(szShort);
+    }
+
+
+    void CloseDas(SpiceInt _handle)
+    {
+        if (!failed_c())
+        {
+            dascls_c(_handle);
+            return;
+        }
+
+        char szShort[SpiceLongMessageMaxLength];
+        char szLong[SpiceLongMessageMaxLength];
+        getmsg_c("SHORT", sizeof(szShort), szShort);
+        getmsg_c("LONG", sizeof(szLong), szLong);
+        reset_c();
+
+        dascls_c(_handle);
+
+        setmsg_c(szLong);
+        sigerr_c(szShort);
+    }
+
+
+    bool ReadDskType2Segments(SpiceInt _handle, SpiceInt _body, TArrayView<const int32> Surfaces, FDskSegmentVisitor OnSegment)
+    {
+        // dskv02/dskp02 return at most "room" items per call
+        constexpr SpiceInt ReadChunk = 65536;
+        static_assert(sizeof(SpiceInt) == sizeof(int32), "plates are read in place");
+
+        SpiceDLADescr _dladsc;
+        SpiceBoolean _found = SPICEFALSE;
+        dlabfs_c(_handle, &_dladsc, &_found);
+
+        TArray<double> Vertices;
+        TArray<int32> Plates;
+
+        while (_found && !failed_c())
+        {
+            SpiceDSKDescr _dskdsc;
+            dskgd_c(_handle, &_dladsc, &_dskdsc);
+
+            if (!failed_c() && _dskdsc.dtype == 2 && (_body == 0 || _dskdsc.center == _body) && (Surfaces.Num() == 0 || Surfaces.Contains(_dskdsc.surfce)))
+            {
+                SpiceInt _nv = 0, _np = 0;
+                dskz02_c(_handle, &_dladsc, &_nv, &_np);
+
+                Vertices.SetNumUninitialized(3 * _nv);
+                Plates.SetNumUninitialized(3 * _np);
+
+                for (SpiceInt start = 1; start <= _nv && !failed_c(); start += ReadChunk)
+                {
+                    SpiceInt _n = 0;
+                    dskv02_c(_handle, &_dladsc, start, FMath::Min<SpiceInt>(ReadChunk, _nv - start + 1), &_n, (SpiceDouble(*)[3]) &Vertices[3 * (start - 1)]);
+                }
+                for (SpiceInt start = 1; start <= _np && !failed_c(); start += ReadChunk)
+                {
+                    SpiceInt _n = 0;
+                    dskp02_c(_handle, &_dladsc, start, FMath::Min<SpiceInt>(ReadChunk, _np - start + 1), &_n, (SpiceInt(*)[3]) &Plates[3 * (start - 1)]);
+                }
+
+                if (failed_c() || !OnSegment(_dskdsc, Vertices, Plates))
+                {
+                    break;
+                }
+            }
+
+            SpiceDLADescr _nxtdsc;
+            dlafns_c(_handle, &_dladsc, &_nxtdsc, &_found);
+            _dladsc = _nxtdsc;
+        }
+
+        return !failed_c();
+    }
+
+
+    void LoadedDskHandles(TArray<SpiceInt>& Handles)
+    {
+        Handles.Reset();
+
+        ConstSpiceChar* _kinds = "DSK";
+        SpiceInt _count = 0;
+        ktotal_c(_kinds, &_count);
+
+        for (SpiceInt i = 0; i < _count && !failed_c(); ++i)
+        {
+            SpiceChar _file[SPICE_MAX_PATH];
+            SpiceChar _filtyp[32];
+            SpiceChar _source[SPICE_MAX_PATH];
+            SpiceInt _handle = 0;
+            SpiceBoolean _found = SPICEFALSE;
+            kdata_c(i, _kinds, sizeof(_file), sizeof(_filtyp), sizeof(_source), _file, _filtyp, _source, &_handle, &_found);
+            if (_found)
+            {
+                Handles.Add(_handle);
+            }
+        }
+    }
+
+
+    namespace
+    {
+        ConstSpiceChar* PoolCacheAgent = "MAXQ_POOL_VALUE_CACHE";
+
+        // Pool variable names are case-sensitive, and so are the keys
+        template<typename ValueType>
+        struct TCaseSensitiveKeyFuncs : BaseKeyFuncs<TPair<FString, ValueType>, FString, false>
+        {
+            static const FString& GetSetKey(const TPair<FString, ValueType>& Element) { return Element.Key; }
+            static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+            static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+        };
+
+        struct FPoolValue
+        {
+            // The room the values were fetched with.  Overflow is an error
+            // for bodvrd/bodvcd, and truncates for gdpool, so a lookup with
+            // different room is a miss.
+            SpiceInt Room = 0;
+            TArray<SpiceDouble, TInlineAllocator<6>> Values;
+        };
+
+        struct FPoolCache
+        {
+            FCriticalSection Lock;
+            TMap<FString, FPoolValue, FDefaultSetAllocator, TCaseSensitiveKeyFuncs<FPoolValue>> Values;
+            bool bWatching = false;
+        };
+
+        FPoolCache& PoolCache()
+        {
+            static FPoolCache Cache;
+            return Cache;
+        }
+
+        void WatchPoolVariable(ConstSpiceChar* _name)
+        {
+            swpool_c(PoolCacheAgent, 1, (SpiceInt)FCStringAnsi::Strlen(_name) + 1, _name);
+
+            // A new watch always reports an update.  Nothing has changed yet.
+            SpiceBoolean _update = SPICEFALSE;
+            cvpool_c(PoolCacheAgent, &_update);
+        }
+
+        // Caller holds the lock.  SPICE has not failed.
+        void ValidatePoolCache(FPoolCache& Cache)
+        {
+            if (!Cache.bWatching)
+            {
+                // Kernels can redefine body names, which changes what
+                // bodvrd looks up
+                WatchPoolVariable("NAIF_BODY_NAME");
+                WatchPoolVariable("NAIF_BODY_CODE");
+                Cache.bWatching = !failed_c();
+            }
+
+            SpiceBoolean _update = SPICEFALSE;
+            cvpool_c(PoolCacheAgent, &_update);
+            if (_update)
+            {
+                Cache.Values.Reset();
+            }
+        }
+
+        bool FindPoolValue(FPoolCache& Cache, const FString& Key, SpiceInt _room, SpiceInt* _n, SpiceDouble* _values)
+        {
+            ValidatePoolCache(Cache);
+
+            const FPoolValue* Value = Cache.Values.Find(Key);
+            if (!Value || Value->Room != _room)
+            {
+                return false;
+            }
+
+            *_n = Value->Values.Num();
+            FMemory::Memcpy(_values, Value->Values.GetData(), Value->Values.Num() * sizeof(SpiceDouble));
+            return true;
+        }
+
+        void AddPoolValue(FPoolCache& Cache, const FString& Key, ConstSpiceChar* _variable, SpiceInt _room, SpiceInt _n, const SpiceDouble* _values)
+        {
+            WatchPoolVariable(_variable);
+            if (failed_c())
+            {
+                return;
+            }
+
+            FPoolValue& Value = Cache.Values.FindOrAdd(Key);
+            Value.Room = _room;
+            Value.Values.Reset();
+            Value.Values.Append(_values, _n);
+        }
+    }
+
+
+    void CachedBodvrd(ConstSpiceChar* _bodynm, ConstSpiceChar* _item, SpiceInt _maxn, SpiceInt* _dim, SpiceDouble* _values)
+    {
+        if (failed_c())
+        {
+            bodvrd_c(_bodynm, _item, _maxn, _dim, _values);
+            return;
+        }
+
+        FPoolCache& Cache = PoolCache();
+        FScopeLock Lock(&Cache.Lock);
+
+        const FString Key = FString(TEXT("R|")) + FString(_bodynm) + TEXT("|") + FString(_item);
+        if (FindPoolValue(Cache, Key, _maxn, _dim, _values))
+        {
+            return;
+        }
+
+        bodvrd_c(_bodynm, _item, _maxn, _dim, _values);
+
+        // bodvrd reads BODY<id>_<item>
+        SpiceInt _code = 0;
+        SpiceBoolean _found = SPICEFALSE;
+        if (!failed_c())
+        {
+            bods2c_c(_bodynm, &_code, &_found);
+        }
+
+        if (!failed_c() && _found)
+        {
+            char _variable[128];
+            FCStringAnsi::Snprintf(_variable, sizeof(_variable), "BODY%d_%s", (int)_code, _item);
+            AddPoolValue(Cache, Key, _variable, _maxn, *_dim, _values);
+        }
+    }
+
+
+    void CachedBodvcd(SpiceInt _bodyid, ConstSpiceChar* _item, SpiceInt _maxn, SpiceInt* _dim, SpiceDouble* _values)
+    {
+        if (failed_c())
+        {
+            bodvcd_c(_bodyid, _item, _maxn, _dim, _values);
+            return;
+        }
+
+        FPoolCache& Cache = PoolCache();
+        FScopeLock Lock(&Cache.Lock);
+
+        const FString Key = FString::Printf(TEXT("C|%d|"), (int)_bodyid) + FString(_item);
+        if (FindPoolValue(Cache, Key, _maxn, _dim, _values))
+        {
+            return;
+        }
+
+        bodvcd_c(_bodyid, _item, _maxn, _dim, _values);
+
+        if (!failed_c())
+        {
+            char _variable[128];
+            FCStringAnsi::Snprintf(_variable, sizeof(_variable), "BODY%d_%s", (int)_bodyid, _item);
+            AddPoolValue(Cache, Key, _variable, _maxn, *_dim, _values);
+        }
+    }
+
+
+    void CachedGdpool(ConstSpiceChar* _name, SpiceInt _start, SpiceInt _room, SpiceInt* _n, SpiceDouble* _values, SpiceBoolean* _found)
+    {
+        // Whole values only
+        if (failed_c() || _start != 0)
+        {
+            gdpool_c(_name, _start, _room, _n, _values, _found);
+            return;
+        }
+
+        FPoolCache& Cache = PoolCache();
+        FScopeLock Lock(&Cache.Lock);
+
+        const FString Key = FString(TEXT("G|")) + FString(_name);
+        if (FindPoolValue(Cache, Key, _room, _n, _values))
+        {
+            *_found = SPICETRUE;
+            return;
+        }
+
+        gdpool_c(_name, _start, _room, _n, _values, _found);
+
+        if (!failed_c() && *_found)
+        {
+            AddPoolValue(Cache, Key, _name, _room, *_n, _values);
+        }
+    }
+
+
+    void InvalidatePoolCache()
+    {
+        FPoolCache& Cache = PoolCache();
+        FScopeLock Lock(&Cache.Lock);
+        Cache.Values.Reset();
+        BumpPoolGeneration();
+    }
+
+
+    namespace
+    {
+        // Starts at 1, so a zeroed generation is never current
+        std::atomic<uint64> PoolGenerationCounter{ 1 };
+    }
+
+    uint64 PoolGeneration()
+    {
+        return PoolGenerationCounter.load(std::memory_order_acquire);
+    }
+
+    void BumpPoolGeneration()
+    {
+        PoolGenerationCounter.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+
+    struct FSegmentWriteQueue::FStatus
+    {
+        mutable FCriticalSection Lock;
+        bool bFailed = false;
+        FString ErrorMessage;
+
+        bool Failed(FString* Message) const
+        {
+            FScopeLock ScopeLock(&Lock);
+            if (bFailed && Message) *Message = ErrorMessage;
+            return bFailed;
+        }
+
+        void Run(const FWrite& Write)
+        {
+            if (Failed(nullptr))
+            {
+                return;
+            }
+
+            ES_ResultCode WriteResult = ES_ResultCode::Success;
+            FString WriteError;
+            if (!Write(&WriteResult, &WriteError))
+            {
+                FScopeLock ScopeLock(&Lock);
+                bFailed = true;
+                ErrorMessage = WriteError;
+            }
+        }
+    };
+
+    FSegmentWriteQueue::FSegmentWriteQueue(int32 _MaxInFlight)
+        : Status(MakeShared<FStatus, ESPMode::ThreadSafe>())
+        , MaxInFlight(FMath::Max(_MaxInFlight, 1))
+    {
+    }
+
+    FSegmentWriteQueue::~FSegmentWriteQueue()
+    {
+        Wait();
+    }
+
+    void FSegmentWriteQueue::Submit(FWrite&& Write)
+    {
+        if (FSpiceExecutor::IsInExecutorThread())
+        {
+            Status->Run(Write);
+            return;
+        }
+
+        WaitForInFlight(MaxInFlight - 1);
+
+        InFlight.Add(FSpiceExecutor::Get().Enqueue(
+            [Status = Status, Write = MoveTemp(Write)]()
+            {
+                Status->Run(Write);
+            }
+        ));
+    }
+
+    void FSegmentWriteQueue::Wait()
+    {
+        WaitForInFlight(0);
+    }
+
+    bool FSegmentWriteQueue::Failed(FString* ErrorMessage) const
+    {
+        return Status->Failed(ErrorMessage);
+    }
+
+    void FSegmentWriteQueue::WaitForInFlight(int32 Max)
+    {
+        while (InFlight.Num() > Max)
+        {
+            InFlight[0].Wait();
+            InFlight.RemoveAt(0);
+        }
+    }
 }
@@ -25,6 +25,13 @@
 
 #include "CoreMinimal.h"
 #include "SpiceTypes.h"
+#include "SpiceData.h"
+#include "SpiceWindow.h"
+#include "SpiceSegmentStats.h"
+#include "SpiceMemory.h"
+#include "SpiceProfiling.h"
+#include "SpiceName.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 PRAGMA_PUSH_PLATFORM_DEFAULT_PACKING
 extern "C"
@@ -33,9 +40,51 @@ extern "C"
 }
 PRAGMA_POP_PLATFORM_DEFAULT_PACKING
 
+// The "MaxQ" Insights channel (SpiceSegmentStats.h).  Compiled out with the
+// CPU profiler trace, and in shipping builds.
+#define MAXQ_TRACE_ENABLED (CPUPROFILERTRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+#if MAXQ_TRACE_ENABLED
+UE_TRACE_CHANNEL_EXTERN(MaxQChannel)
+#define MAXQ_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, MaxQChannel)
+// Names the scope from its arguments (target, frame...).  The name is only
+// formatted while the channel is enabled.
+#define MAXQ_TRACE_SCOPE_TEXT(Format, ...) TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(*(UE_TRACE_CHANNELEXPR_IS_ENABLED(MaxQChannel) ? FString::Printf(Format, ##__VA_ARGS__) : FString()), MaxQChannel)
+#else
+#define MAXQ_TRACE_SCOPE(Name)
+#define MAXQ_TRACE_SCOPE_TEXT(Format, ...)
+#endif
+
+#if MAXQ_COUNTERS_ENABLED
+// Running totals for the MaxQ.Stats/MaxQ.Cache console commands
+// (SpiceProfiling.h)
+#define MAXQ_COUNT(Counter) MaxQ::Private::Count(MaxQ::Data::ESpiceCounter::Counter)
+#define MAXQ_COUNT_BY(Counter, N) MaxQ::Private::Count(MaxQ::Data::ESpiceCounter::Counter, N)
+#define MAXQ_TIME_SCOPE(Timer) MaxQ::Private::FTimedScope ANONYMOUS_VARIABLE(MaxQTimedScope)(MaxQ::Data::ESpiceTimer::Timer)
+#else
+#define MAXQ_COUNT(Counter)
+#define MAXQ_COUNT_BY(Counter, N)
+#define MAXQ_TIME_SCOPE(Timer)
+#endif
+
+// Scoped around the CSPICE calls that search the segment tables
+// (SpiceSegmentStats.h).  One per scope.
+#define MAXQ_SPK_LOOKUP_SCOPE() SCOPE_CYCLE_COUNTER(STAT_MaxQ_SpkLookup); INC_DWORD_STAT(STAT_MaxQ_SpkLookups); MAXQ_COUNT(SpkLookups); MAXQ_TIME_SCOPE(SpkLookup); MAXQ_TRACE_SCOPE("MaxQ SPK lookup")
+#define MAXQ_FRAME_LOOKUP_SCOPE() SCOPE_CYCLE_COUNTER(STAT_MaxQ_FrameLookup); INC_DWORD_STAT(STAT_MaxQ_FrameLookups); MAXQ_COUNT(FrameLookups); MAXQ_TIME_SCOPE(FrameLookup); MAXQ_TRACE_SCOPE("MaxQ frame lookup")
+#define MAXQ_GF_SEARCH_SCOPE() SCOPE_CYCLE_COUNTER(STAT_MaxQ_GfSearch); INC_DWORD_STAT(STAT_MaxQ_GfSearches); MAXQ_COUNT(GfSearches); MAXQ_TIME_SCOPE(GfSearch); MAXQ_TRACE_SCOPE("MaxQ GF search")
+#define MAXQ_FURNSH_SCOPE() SCOPE_CYCLE_COUNTER(STAT_MaxQ_Furnsh); INC_DWORD_STAT(STAT_MaxQ_Furnshes); MAXQ_COUNT(KernelLoads); MAXQ_TIME_SCOPE(KernelLoad); MAXQ_TRACE_SCOPE("MaxQ furnsh")
+#define MAXQ_SGP4_SCOPE(Evaluations) SCOPE_CYCLE_COUNTER(STAT_MaxQ_Sgp4); INC_DWORD_STAT_BY(STAT_MaxQ_Sgp4Evaluations, Evaluations); MAXQ_COUNT_BY(Sgp4Evaluations, Evaluations); MAXQ_TIME_SCOPE(Sgp4); MAXQ_TRACE_SCOPE("MaxQ SGP4")
+
+// A cache answered (ChebyshevHits, ...) or had to go to CSPICE
+// (ChebyshevMisses, ...):  counted in "stat MaxQ" and for MaxQ.Cache
+#define MAXQ_CACHE_EVENT(Event) INC_DWORD_STAT(STAT_MaxQ_##Event); MAXQ_COUNT(Event)
+
 namespace MaxQ::Private
 {
     FString toPath(const FString& file);
+    // Saved/MaxQ/<Subdirectory>, absolute.  Without the engine (no project),
+    // under the user's temp directory instead.
+    FString SavedPath(const TCHAR* Subdirectory);
 
     template<class T>
     inline void ZeroOut(T(&value)[3][3])
@@ -61,8 +110,459 @@ namespace MaxQ::Private
     void CopyFrom(const SpiceEllipse& _ellipse, FSEllipse& dest);
     void CopyTo(const FSEllipse& src, SpiceEllipse& _ellipse);
 
+    // m2q_c, without the rotation check or the error system (the batches):
+    // Shepperd's method, the same branches, and q[0] > 0.
+    inline void M2q(const double (&m)[3][3], double (&q)[4])
+    {
+        const double trace = m[0][0] + m[1][1] + m[2][2];
+        const double mtrace = 1. - trace;
+        const double cc4 = trace + 1.;
+        const double s114 = mtrace + 2. * m[0][0];
+        const double s224 = mtrace + 2. * m[1][1];
+        const double s334 = mtrace + 2. * m[2][2];
+
+        double c, s0, s1, s2;
+        if (1. <= cc4)
+        {
+            c = sqrt(cc4 * .25);
+            const double f = 1. / (4. * c);
+            s0 = (m[2][1] - m[1][2]) * f;
+            s1 = (m[0][2] - m[2][0]) * f;
+            s2 = (m[1][0] - m[0][1]) * f;
+        }
+        else if (1. <= s114)
+        {
+            s0 = sqrt(s114 * .25);
+            const double f = 1. / (4. * s0);
+            c = (m[2][1] - m[1][2]) * f;
+            s1 = (m[0][1] + m[1][0]) * f;
+            s2 = (m[0][2] + m[2][0]) * f;
+        }
+        else if (1. <= s224)
+        {
+            s1 = sqrt(s224 * .25);
+            const double f = 1. / (4. * s1);
+            c = (m[0][2] - m[2][0]) * f;
+            s0 = (m[0][1] + m[1][0]) * f;
+            s2 = (m[1][2] + m[2][1]) * f;
+        }
+        else
+        {
+            s2 = sqrt(s334 * .25);
+            const double f = 1. / (4. * s2);
+            c = (m[1][0] - m[0][1]) * f;
+            s0 = (m[0][2] + m[2][0]) * f;
+            s1 = (m[1][2] + m[2][1]) * f;
+        }
+
+        const double l2 = c * c + s0 * s0 + s1 * s1 + s2 * s2;
+        const double polish = (l2 != 1. ? 1. / sqrt(l2) : 1.) * (c > 0. ? 1. : -1.);
+        q[0] = c * polish; q[1] = s0 * polish; q[2] = s1 * polish; q[3] = s2 * polish;
+    }
+
     uint8 ErrorCheck(ES_ResultCode& ResultCode, FString& ErrorMessage, bool BeQuiet = false);
     uint8 ErrorCheck(ES_ResultCode* ResultCode, FString* ErrorMessage, bool BeQuiet = false);
     uint8 UnexpectedErrorCheck(bool bReset = true);
+    // Counts a failed call in "stat MaxQ" and the MaxQ/Failures trace counter
+    void CountFailure();
+
+#if MAXQ_COUNTERS_ENABLED
+    void Count(MaxQ::Data::ESpiceCounter Counter, uint64 N = 1);
+
+    // Adds its lifetime to a timer
+    class FTimedScope
+    {
+    public:
+        explicit FTimedScope(MaxQ::Data::ESpiceTimer _Timer) : Timer(_Timer), StartCycles(FPlatformTime::Cycles64()) {}
+        ~FTimedScope();
+
+    private:
+        MaxQ::Data::ESpiceTimer Timer;
+        uint64 StartCycles;
+    };
+#endif
     void MakeErrorGutter(ES_ResultCode*& pResultCode, FString*& pErrorMessage);
+
+    // The kernel type from a file's first bytes (its ID word).  Files with
+    // no ID word that aren't DAF/DAS are taken to be text kernels.
+    ES_KernelType KernelTypeOf(const uint8* Head, int64 Num);
+
+    // One furnsh or unload, for the kernel load timeline (SpiceProfiling.h).
+    // Prepared:  what Furnsh's parallel pass learned of the file (type, size,
+    // open and validate times), or null to read the file's ID word here.
+    // Constructed just before CSPICE's call, finished just after.
+    class FKernelLoadTiming
+    {
+    public:
+        FKernelLoadTiming(const FString& AbsolutePath, bool bUnload, const MaxQ::Data::FKernelLoadRecord* Prepared = nullptr);
+
+        // "de440.bsp (SPK, 114 MB)", for the Insights scope
+        FString Describe() const;
+
+        void Finish(bool bSuccess);
+
+    private:
+        MaxQ::Data::FKernelLoadRecord Record;
+    };
+
+    // Heap-backed double precision cells, for windows (gf*, *cov, etc).
+    // SPICEDOUBLE_CELL declares static arrays, fixed at compile time.
+    // These are backed by a per-thread arena, so steady state use doesn't
+    // allocate.  One arena buffer per slot, so a cnfine and result cell can
+    // be live at once.  A slot that's already in use on this thread gets a
+    // buffer of its own, and a buffer that's grown past the scratch arena's
+    // cap (FScratchScope) is freed when its cell goes out of scope.
+    enum class ECellSlot : uint8
+    {
+        Confinement,
+        Result,
+        Scratch,
+        Count
+    };
+
+    class FDoubleCell
+    {
+    public:
+        FDoubleCell(ECellSlot Slot, SpiceInt Size);
+        ~FDoubleCell();
+
+        // Capacity is in doubles (2 per window interval)
+        void Reserve(SpiceInt Size);
+        SpiceInt Size() const { return Cell.size; }
+
+        SpiceCell* Get() { return &Cell; }
+
+        FDoubleCell(const FDoubleCell&) = delete;
+        FDoubleCell& operator=(const FDoubleCell&) = delete;
+
+    private:
+        TArray<SpiceDouble> Owned;
+        TArray<SpiceDouble>& Storage;
+        ECellSlot Slot;
+        bool bArena;
+        SpiceCell Cell;
+    };
+
+    // Call-scoped scratch memory, for buffers sized by the caller (record
+    // counts, ray counts, pool buffer sizes).  StackAlloc'ing those overflows
+    // the stack for large inputs.
+    // Allocations come from a per-thread linear arena, and are released when
+    // the scope that made them ends.  The arena keeps its memory for the next
+    // call, so steady state use doesn't allocate.  Scopes nest.
+    class FScratchScope
+    {
+    public:
+        FScratchScope();
+        ~FScratchScope();
+
+        // 16 byte aligned, uninitialized
+        void* Alloc(SIZE_T Bytes);
+
+        FScratchScope(const FScratchScope&) = delete;
+        FScratchScope& operator=(const FScratchScope&) = delete;
+
+    private:
+        int32 Block;
+        SIZE_T Used;
+    };
+
+    // Sizes a wrapper's output array for this call, keeping its allocation:
+    // a caller that passes the same array every frame stops allocating once
+    // it's grown to fit.  Existing elements aren't reset, so write them all.
+    template<typename T>
+    inline void ReuseOutput(TArray<T>& Out, int32 Num)
+    {
+        Out.SetNum(Num, false);
+    }
+
+    // Kernel segment writes (spkw*, ckw*) queued on the FSpiceExecutor, in
+    // order, with no more than MaxInFlight outstanding (Submit blocks until
+    // one finishes).  Once a write fails, the ones after it are skipped, and
+    // the first error is kept.  Writes submitted from the executor thread run
+    // right away.
+    class FSegmentWriteQueue
+    {
+    public:
+        typedef TUniqueFunction<bool(ES_ResultCode*, FString*)> FWrite;
+
+        explicit FSegmentWriteQueue(int32 MaxInFlight = 2);
+        // Waits for everything in flight
+        ~FSegmentWriteQueue();
+
+        void Submit(FWrite&& Write);
+        void Wait();
+
+        // True (with the first error) if any write has failed
+        bool Failed(FString* ErrorMessage = nullptr) const;
+
+        FSegmentWriteQueue(const FSegmentWriteQueue&) = delete;
+        FSegmentWriteQueue& operator=(const FSegmentWriteQueue&) = delete;
+
+    private:
+        struct FStatus;
+
+        void WaitForInFlight(int32 Max);
+
+        TSharedRef<FStatus, ESPMode::ThreadSafe> Status;
+        TArray<TFuture<void>> InFlight;
+        int32 MaxInFlight;
+    };
+
+    // IAU-82 GMST (Vallado's gstime), radians in [0, 2pi).  utc:  seconds
+    // past J2000 (UT1 taken to be UTC).
+    inline double GreenwichMeanSiderealTime(double utc)
+    {
+        const double tut1 = utc / (86400. * 36525.);
+        double gmst = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 + (876600.0 * 3600. + 8640184.812866) * tut1 + 67310.54841;
+        gmst = FMath::Fmod(gmst * (PI / 180.) / 240., 2. * PI);
+        return gmst < 0. ? gmst + 2. * PI : gmst;
+    }
+
+    // Chebyshev series:  sum c[j] * T_j(x), j = 0...n-1
+    inline double Clenshaw(const double* c, int32 n, double x)
+    {
+        double b1 = 0., b2 = 0.;
+        const double x2 = 2. * x;
+        for (int32 j = n - 1; j >= 1; --j)
+        {
+            const double t = x2 * b1 - b2 + c[j];
+            b2 = b1;
+            b1 = t;
+        }
+        return c[0] + x * b1 - b2;
+    }
+
+    // Chebyshev coefficients of the derivative, d/dx
+    inline void Differentiate(const double* c, double* d, int32 n)
+    {
+        d[n - 1] = 0.;
+        if (n < 2) return;
+
+        d[n - 2] = 2. * (n - 1) * c[n - 1];
+        for (int32 j = n - 3; j >= 0; --j)
+        {
+            d[j] = d[j + 2] + 2. * (j + 1) * c[j + 1];
+        }
+        d[0] *= 0.5;
+    }
+
+    // A SpiceCell over an FSWindow's own storage (no copy), for CSPICE to
+    // write results into.  Capacity is in intervals.  Until Sync() (or the
+    // destructor), the window itself must not be used.
+    class FWindowCell
+    {
+    public:
+        explicit FWindowCell(MaxQ::GeometryFinder::FSWindow& Window, int32 Capacity = 0);
+        ~FWindowCell();
+
+        // Grows the cell, keeping its contents.  At least the window's
+        // existing allocation is used.
+        void Reserve(int32 Capacity);
+        SpiceInt Size() const { return Cell.size; }
+        SpiceCell* Get() { return &Cell; }
+
+        // True if CSPICE filled the cell.  Valid after a failed call, too.
+        bool IsFull() const;
+
+        // Sizes the window to the cell's cardinality
+        void Sync();
+
+        FWindowCell(const FWindowCell&) = delete;
+        FWindowCell& operator=(const FWindowCell&) = delete;
+
+    private:
+        MaxQ::GeometryFinder::FSWindow& Window;
+        SpiceCell Cell;
+    };
+
+    // Copies the window's endpoints into the cell (one memcpy; the window is
+    // already a valid SPICE window).
+    void FillWindow(FDoubleCell& Cell, const MaxQ::GeometryFinder::FSWindow& Window);
+
+    // Run a geometry finder search into an unbounded result window.
+    // If the result doesn't fit, the result cell grows & the search reruns.
+    // (Results reuse the window's allocation, so reusing a window across
+    // searches makes the rerun a one-time cost.)  Any other overflow (a
+    // search's own workspace, nintvls) is left signalled.
+    // CSPICE's searches aren't re-entrant:  a search started from inside
+    // another on the same thread (from a gfudb_c callback, say) signals
+    // SPICE(NESTEDGFSEARCH) and leaves the outer search alone.
+    void GfSearch(
+        const MaxQ::GeometryFinder::FSWindow& cnfine,
+        MaxQ::GeometryFinder::FSWindow& results,
+        TFunctionRef<void(SpiceCell* _cnfine, SpiceCell* _result)> Search
+    );
+
+    // As above, for the TArray windows the USpice API uses.  Signals
+    // SPICE(BADENDPOINTS) for an interval with start > stop, as wninsd_c.
+    void GfSearch(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        TFunctionRef<void(SpiceCell* _cnfine, SpiceCell* _result)> Search
+    );
+
+    // Inside an FGfSearchControlScope (SpiceGeometryFinder.h) the gf*
+    // wrappers call the mid-level routines (gfevnt_c, gfocce_c, gffove_c)
+    // instead, which report progress and poll for a cancel.  A cancelled
+    // search signals SPICE(CANCELLED).
+    bool IsGfSearchControlled();
+
+    // gfstol_c's value, which the mid-level routines take as an argument
+    void SetGfTolerance(double Tolerance);
+    double GetGfTolerance();
+
+    // gfevnt_c's quantity and its parameters, by name (gfevnt_c's docs)
+    struct FGfQuantity
+    {
+        static constexpr int32 MaxParams = SPICE_GFEVNT_MAXPAR;
+        static constexpr int32 ValueLength = 81;
+
+        explicit FGfQuantity(ConstSpiceChar* _Name) : Name(_Name) {}
+
+        FGfQuantity& Param(ConstSpiceChar* _Name, ConstSpiceChar* _Value);
+        // DVEC, SPOINT:  the name, and the vector in the double parameters
+        FGfQuantity& Param(ConstSpiceChar* _Name, const SpiceDouble (&_Value)[3]);
+
+        ConstSpiceChar* Name;
+        SpiceInt Num = 0;
+        SpiceChar Names[MaxParams][ValueLength] = {};
+        SpiceChar Values[MaxParams][ValueLength] = {};
+        SpiceDouble Doubles[MaxParams] = {};
+        SpiceInt Ints[MaxParams] = {};
+        SpiceBoolean Bools[MaxParams] = {};
+    };
+
+    void GfEvent(
+        const FGfQuantity& Quantity,
+        ConstSpiceChar* _relate,
+        SpiceDouble _refval,
+        SpiceDouble _adjust,
+        SpiceDouble _step,
+        SpiceInt _nintvls,
+        SpiceCell* _cnfine,
+        SpiceCell* _result
+    );
+
+    void GfOccultation(
+        ConstSpiceChar* _occtyp,
+        ConstSpiceChar* _front,
+        ConstSpiceChar* _fshape,
+        ConstSpiceChar* _fframe,
+        ConstSpiceChar* _back,
+        ConstSpiceChar* _bshape,
+        ConstSpiceChar* _bframe,
+        ConstSpiceChar* _abcorr,
+        ConstSpiceChar* _obsrvr,
+        SpiceDouble _step,
+        SpiceCell* _cnfine,
+        SpiceCell* _result
+    );
+
+    // Targets ("ELLIPSOID", "POINT") or rays ("RAY", raydir, target " ")
+    void GfFieldOfView(
+        ConstSpiceChar* _inst,
+        ConstSpiceChar* _tshape,
+        const SpiceDouble (&_raydir)[3],
+        ConstSpiceChar* _target,
+        ConstSpiceChar* _tframe,
+        ConstSpiceChar* _abcorr,
+        ConstSpiceChar* _obsrvr,
+        SpiceDouble _step,
+        SpiceCell* _cnfine,
+        SpiceCell* _result
+    );
+
+    // bods2c, but signals SPICE(IDCODENOTFOUND) if the name isn't known.
+    // Returns false if SPICE has failed.
+    bool ResolveBody(ConstSpiceChar* _name, SpiceInt& _code);
+
+    // True if the frame is known and of class 1 (inertial)
+    bool IsInertialFrame(ConstSpiceChar* _ref);
+
+    // dafcls_c, even if SPICE has failed (it would return without closing
+    // the file).  The failure is signalled again afterwards.
+    void CloseDaf(SpiceInt _handle);
+
+    // ...and the same for DAS files (DSKs)
+    void CloseDas(SpiceInt _handle);
+
+    // Walks the type 2 segments of a DSK for _body (0:  any) and Surfaces
+    // (empty:  all).  OnSegment gets each segment's vertices and (1-based)
+    // plates, read in chunks straight into the arrays, which are reused
+    // between segments.  Returning false, or SPICE failing, ends the walk.
+    typedef TFunctionRef<bool(const SpiceDSKDescr& _dskdsc, TArray<double>& Vertices, TArray<int32>& Plates)> FDskSegmentVisitor;
+    bool ReadDskType2Segments(SpiceInt _handle, SpiceInt _body, TArrayView<const int32> Surfaces, FDskSegmentVisitor OnSegment);
+
+    // Handles of every loaded DSK, in load order
+    void LoadedDskHandles(TArray<SpiceInt>& Handles);
+
+    // bodvrd_c, bodvcd_c and gdpool_c, memoized.  Same arguments and results
+    // (and errors), but repeated lookups of the same values don't search the
+    // kernel pool.  The variables are watched (swpool_c), and the whole cache
+    // is dropped as soon as any of them changes (cvpool_c);  furnsh, unload,
+    // pdpool, clpool etc all notify watchers.
+    void CachedBodvrd(ConstSpiceChar* _bodynm, ConstSpiceChar* _item, SpiceInt _maxn, SpiceInt* _dim, SpiceDouble* _values);
+    void CachedBodvcd(SpiceInt _bodyid, ConstSpiceChar* _item, SpiceInt _maxn, SpiceInt* _dim, SpiceDouble* _values);
+    void CachedGdpool(ConstSpiceChar* _name, SpiceInt _start, SpiceInt _room, SpiceInt* _n, SpiceDouble* _values, SpiceBoolean* _found);
+
+    // For changes the pool doesn't see (boddef changes name->ID mappings)
+    void InvalidatePoolCache();
+
+    // Names given to boddef, for the name registry (SpiceNameRegistry.h)
+    void RecordBoddef(const FString& Name);
+    // ...and all of them (normalized), for session snapshots (SpiceSession.h)
+    TArray<FString> GetBoddefNames();
+
+    // The kernel pool generation (MaxQ::Data::GetPoolGeneration).  Everything
+    // in MaxQ that writes the pool bumps it:  kernel loads, unloads and
+    // clears, pdpool/pcpool/pipool, snapshot restores, and InvalidatePoolCache.
+    uint64 PoolGeneration();
+    void BumpPoolGeneration();
+
+    // Per-frame query memo (SpiceQueryMemo.h).  MakeQueryMemoKey is false
+    // while the memo is off;  otherwise Find the key before the CSPICE call,
+    // and Memoize the result after it if it succeeded.
+    enum class EQueryMemo : uint8
+    {
+        Pxform,
+        Sxform,
+        Spkezr,
+        Spkpos
+    };
+
+    struct FQueryMemoKey
+    {
+        EQueryMemo Query = EQueryMemo::Pxform;
+        uint8 Abcorr = 0;
+        FSpiceName A;
+        FSpiceName B;
+        FSpiceName C;
+        double Et = 0.;
+
+        bool operator==(const FQueryMemoKey& Other) const
+        {
+            return Query == Other.Query && Abcorr == Other.Abcorr && A == Other.A && B == Other.B && C == Other.C && Et == Other.Et;
+        }
+
+        friend uint32 GetTypeHash(const FQueryMemoKey& Key)
+        {
+            uint32 Hash = HashCombine(GetTypeHash(Key.A), GetTypeHash(Key.B));
+            Hash = HashCombine(Hash, GetTypeHash(Key.C));
+            Hash = HashCombine(Hash, GetTypeHash(Key.Et));
+            return HashCombine(Hash, ((uint32)Key.Query << 8) | Key.Abcorr);
+        }
+    };
+
+    bool MakeQueryMemoKey(EQueryMemo Query, const FString& A, const FString& B, const FString& C, uint8 Abcorr, double et, FQueryMemoKey& Key);
+    bool FindMemoizedQuery(const FQueryMemoKey& Key, double* Values, int32 Num, double* Lt = nullptr);
+    void MemoizeQuery(const FQueryMemoKey& Key, const double* Values, int32 Num, double Lt = 0.);
+
+    // Kernel history bookkeeping (see MaxQ::Data::GetKernelHistory)
+    // bSyncMappedKernels:  false when a batch of operations syncs once at
+    // the end (the sync walks every loaded kernel)
+    void RecordKernelOperation(MaxQ::Data::FKernelHistoryEntry::EOperation Operation, const FString& AbsolutePath, bool bSyncMappedKernels = true);
+    void ClearKernelHistory();
+
+    // A global ClearAll:  every FSpiceContext's kernels are gone
+    void ForgetContextKernels();
 }
@@ -0,0 +1,381 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceWindow.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Native SPICE windows (sorted sets of disjoint time intervals).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceWindow.cpp is part of the "refined C++ API".
+//
+// Every operation is a single merge-style pass over sorted endpoints, so
+// they're all linear in the number of intervals (wninsd is the exception, as
+// it is in SPICE:  inserting in the middle shifts everything after it).
+//------------------------------------------------------------------------------
+
+#include "SpiceWindow.h"
+#include "SpiceUtilities.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+
+static_assert(MaxQ::GeometryFinder::FSWindow::CellControlSize == SPICE_CELL_CTRLSZ, "FSWindow storage must match the SPICE cell layout");
+
+namespace
+{
+    struct FInterval
+    {
+        double Start, Stop;
+    };
+    static_assert(sizeof(FInterval) == 2 * sizeof(double), "FInterval must overlay a pair of endpoints");
+}
+
+namespace MaxQ::GeometryFinder
+{
+    FSWindow::FSWindow()
+    {
+        Storage.SetNumZeroed(CellControlSize);
+    }
+
+    FSWindow::FSWindow(TArrayView<const FSEphemerisTimeWindowSegment> Segments)
+        : FSWindow()
+    {
+        Reserve(Segments.Num());
+        bool bSorted = true;
+        for (const FSEphemerisTimeWindowSegment& Segment : Segments)
+        {
+            if (Segment.start.seconds > Segment.stop.seconds)
+            {
+                continue;
+            }
+            bSorted = bSorted && (IsEmpty() || Segment.start.seconds >= Start(Num() - 1));
+            Storage.Add(Segment.start.seconds);
+            Storage.Add(Segment.stop.seconds);
+        }
+
+        if (!bSorted)
+        {
+            TArrayView<FInterval> Intervals((FInterval*)MutableEndpoints(), Num());
+            Algo::Sort(Intervals, [](const FInterval& A, const FInterval& B) { return A.Start < B.Start; });
+        }
+
+        MergeSorted();
+    }
+
+    FSWindow::FSWindow(double Start, double Stop)
+        : FSWindow()
+    {
+        Insert(Start, Stop);
+    }
+
+
+    void FSWindow::Reset()
+    {
+        Storage.SetNum(CellControlSize, false);
+    }
+
+    void FSWindow::Reserve(int32 Intervals)
+    {
+        Storage.Reserve(CellControlSize + 2 * Intervals);
+    }
+
+
+    TArray<FSEphemerisTimeWindowSegment> FSWindow::ToSegments() const
+    {
+        TArray<FSEphemerisTimeWindowSegment> Segments;
+        ToSegments(Segments);
+        return Segments;
+    }
+
+
+    void FSWindow::ToSegments(TArray<FSEphemerisTimeWindowSegment>& Segments) const
+    {
+        Segments.SetNum(Num(), false);
+        for (int32 i = 0; i < Num(); ++i)
+        {
+            Segments[i] = (*this)[i];
+        }
+    }
+
+
+    void FSWindow::Insert(double _Start, double _Stop)
+    {
+        if (_Start > _Stop)
+        {
+            return;
+        }
+
+        // The intervals that overlap or abut [_Start, _Stop] are [First, Last)
+        const FInterval* Intervals = (const FInterval*)Endpoints().GetData();
+        const int32 First = Algo::LowerBound(TArrayView<const FInterval>(Intervals, Num()), _Start, [](const FInterval& Interval, double et) { return Interval.Stop < et; });
+        const int32 Last = Algo::UpperBound(TArrayView<const FInterval>(Intervals, Num()), _Stop, [](double et, const FInterval& Interval) { return et < Interval.Start; });
+
+        if (First < Last)
+        {
+            _Start = FMath::Min(_Start, Start(First));
+            _Stop = FMath::Max(_Stop, Stop(Last - 1));
+            Storage.RemoveAt(CellControlSize + 2 * First, 2 * (Last - First), false);
+        }
+
+        Storage.Insert(_Start, CellControlSize + 2 * First);
+        Storage.Insert(_Stop, CellControlSize + 2 * First + 1);
+    }
+
+
+    double FSWindow::Measure() const
+    {
+        double Sum = 0.;
+        for (int32 i = 0; i < Num(); ++i)
+        {
+            Sum += Stop(i) - Start(i);
+        }
+        return Sum;
+    }
+
+    bool FSWindow::Contains(double et) const
+    {
+        return Contains(et, et);
+    }
+
+    bool FSWindow::Contains(double _Start, double _Stop) const
+    {
+        // The last interval that starts at or before _Start
+        const FInterval* Intervals = (const FInterval*)Endpoints().GetData();
+        const int32 i = Algo::UpperBound(TArrayView<const FInterval>(Intervals, Num()), _Start, [](double et, const FInterval& Interval) { return et < Interval.Start; }) - 1;
+        return i >= 0 && _Start <= _Stop && _Stop <= Intervals[i].Stop;
+    }
+
+
+    FSWindow FSWindow::Union(const FSWindow& a, const FSWindow& b)
+    {
+        FSWindow Result;
+        Result.Reserve(a.Num() + b.Num());
+
+        int32 i = 0, j = 0;
+        while (i < a.Num() || j < b.Num())
+        {
+            if (j >= b.Num() || (i < a.Num() && a.Start(i) <= b.Start(j)))
+            {
+                Result.Push(a.Start(i), a.Stop(i));
+                ++i;
+            }
+            else
+            {
+                Result.Push(b.Start(j), b.Stop(j));
+                ++j;
+            }
+        }
+
+        return Result;
+    }
+
+    FSWindow FSWindow::Intersection(const FSWindow& a, const FSWindow& b)
+    {
+        FSWindow Result;
+        Result.Reserve(FMath::Max(a.Num(), b.Num()));
+
+        int32 i = 0, j = 0;
+        while (i < a.Num() && j < b.Num())
+        {
+            const double Lo = FMath::Max(a.Start(i), b.Start(j));
+            const double Hi = FMath::Min(a.Stop(i), b.Stop(j));
+            if (Lo <= Hi)
+            {
+                Result.Push(Lo, Hi);
+            }
+
+            if (a.Stop(i) < b.Stop(j)) ++i; else ++j;
+        }
+
+        return Result;
+    }
+
+    FSWindow FSWindow::Difference(const FSWindow& a, const FSWindow& b)
+    {
+        // Pieces are pushed (merging), so removing a singleton removes
+        // nothing, as with wndifd.
+        FSWindow Result;
+        Result.Reserve(a.Num() + b.Num());
+
+        int32 j = 0;
+        for (int32 i = 0; i < a.Num(); ++i)
+        {
+            double Lo = a.Start(i);
+            const double Hi = a.Stop(i);
+
+            // Skip what ends before this interval
+            while (j < b.Num() && b.Stop(j) < Lo) ++j;
+
+            bool bRemains = true;
+            for (int32 k = j; k < b.Num() && b.Start(k) <= Hi; ++k)
+            {
+                if (b.Start(k) > Lo)
+                {
+                    Result.Push(Lo, b.Start(k));
+                }
+
+                if (b.Stop(k) >= Hi)
+                {
+                    bRemains = false;
+                    break;
+                }
+                Lo = FMath::Max(Lo, b.Stop(k));
+            }
+
+            if (bRemains && Lo <= Hi)
+            {
+                Result.Push(Lo, Hi);
+            }
+        }
+
+        return Result;
+    }
+
+
+    FSWindow FSWindow::Complement(double Left, double Right) const
+    {
+        FSWindow Result;
+        if (Left > Right)
+        {
+            return Result;
+        }
+
+        double Cursor = Left;
+        for (int32 i = 0; i < Num() && Start(i) <= Right; ++i)
+        {
+            if (Stop(i) < Left)
+            {
+                continue;
+            }
+            if (Start(i) > Cursor)
+            {
+                Result.Storage.Add(Cursor);
+                Result.Storage.Add(Start(i));
+            }
+            Cursor = FMath::Max(Cursor, Stop(i));
+        }
+
+        if (Cursor < Right || (IsEmpty() && Cursor == Right))
+        {
+            Result.Storage.Add(Cursor);
+            Result.Storage.Add(Right);
+        }
+
+        return Result;
+    }
+
+
+    void FSWindow::Contract(double Left, double Right)
+    {
+        double* e = MutableEndpoints();
+        int32 Out = 0;
+        for (int32 i = 0; i < Num(); ++i)
+        {
+            const double Lo = e[2 * i] + Left;
+            const double Hi = e[2 * i + 1] - Right;
+            if (Lo <= Hi)
+            {
+                e[2 * Out] = Lo;
+                e[2 * Out + 1] = Hi;
+                ++Out;
+            }
+        }
+        Storage.SetNum(CellControlSize + 2 * Out, false);
+
+        // (A negative contraction is an expansion)
+        MergeSorted();
+    }
+
+    void FSWindow::Expand(double Left, double Right)
+    {
+        Contract(-Left, -Right);
+    }
+
+
+    void FSWindow::FilterSmall(double Small)
+    {
+        double* e = MutableEndpoints();
+        int32 Out = 0;
+        for (int32 i = 0; i < Num(); ++i)
+        {
+            if (e[2 * i + 1] - e[2 * i] > Small)
+            {
+                e[2 * Out] = e[2 * i];
+                e[2 * Out + 1] = e[2 * i + 1];
+                ++Out;
+            }
+        }
+        Storage.SetNum(CellControlSize + 2 * Out, false);
+    }
+
+    void FSWindow::FillSmall(double Small)
+    {
+        double* e = MutableEndpoints();
+        int32 Out = 0;
+        for (int32 i = 0; i < Num(); ++i)
+        {
+            if (Out > 0 && e[2 * i] - e[2 * Out - 1] <= Small)
+            {
+                e[2 * Out - 1] = FMath::Max(e[2 * Out - 1], e[2 * i + 1]);
+            }
+            else
+            {
+                e[2 * Out] = e[2 * i];
+                e[2 * Out + 1] = e[2 * i + 1];
+                ++Out;
+            }
+        }
+        Storage.SetNum(CellControlSize + 2 * Out, false);
+    }
+
+
+    bool FSWindow::operator==(const FSWindow& b) const
+    {
+        return Num() == b.Num() && FMemory::Memcmp(Endpoints().GetData(), b.Endpoints().GetData(), Endpoints().Num() * sizeof(double)) == 0;
+    }
+
+
+    void FSWindow::Push(double _Start, double _Stop)
+    {
+        if (!IsEmpty() && _Start <= Stop(Num() - 1))
+        {
+            Storage.Last() = FMath::Max(Storage.Last(), _Stop);
+        }
+        else
+        {
+            Storage.Add(_Start);
+            Storage.Add(_Stop);
+        }
+    }
+
+    void FSWindow::MergeSorted()
+    {
+        double* e = MutableEndpoints();
+        int32 Out = 0;
+        for (int32 i = 0; i < Num(); ++i)
+        {
+            if (Out > 0 && e[2 * i] <= e[2 * Out - 1])
+            {
+                e[2 * Out - 1] = FMath::Max(e[2 * Out - 1], e[2 * i + 1]);
+            }
+            else
+            {
+                e[2 * Out] = e[2 * i];
+                e[2 * Out + 1] = e[2 * i + 1];
+                ++Out;
+            }
+        }
+        Storage.SetNum(CellControlSize + 2 * Out, false);
+    }
+}
@@ -0,0 +1,174 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceWorkerCommandlet.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Worker process main loop for FSpiceProcessPool.
+//------------------------------------------------------------------------------
+
+#include "SpiceWorkerCommandlet.h"
+#include "Misc/Parse.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SpiceCore.h"
+#include "SpiceData.h"
+#include "SpiceProcessPool.h"
+#include "SpiceUtilities.h"
+
+using namespace MaxQ::Private;
+
+USpiceWorkerCommandlet::USpiceWorkerCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+
+// Stops at the first kernel that fails, since the rest of the set may
+// depend on it
+static bool SyncKernels(const TArray<MaxQ::Data::FKernelHistoryEntry>& History, FString& ErrorMessage)
+{
+    MaxQ::Core::InitAll();
+
+    for (const MaxQ::Data::FKernelHistoryEntry& Entry : History)
+    {
+        bool bOk = true;
+        switch (Entry.Operation)
+        {
+        case MaxQ::Data::FKernelHistoryEntry::EOperation::Furnsh:
+            bOk = MaxQ::Data::Furnsh(Entry.AbsolutePath, nullptr, &ErrorMessage);
+            break;
+        case MaxQ::Data::FKernelHistoryEntry::EOperation::Unload:
+            bOk = MaxQ::Data::Unload(Entry.AbsolutePath, nullptr, &ErrorMessage);
+            break;
+        }
+
+        if (!bOk)
+        {
+            ErrorMessage = FString::Printf(TEXT("MaxQ SPICE Worker: kernel sync failed at %s: %s"), *Entry.AbsolutePath, *ErrorMessage);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int32 USpiceWorkerCommandlet::Main(const FString& Params)
+{
+    FString BaseName;
+    uint32 MailboxSize = 0;
+
+    if (!FParse::Value(*Params, TEXT("MaxQMailbox="), BaseName) || !FParse::Value(*Params, TEXT("MaxQMailboxSize="), MailboxSize))
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Worker: missing -MaxQMailbox/-MaxQMailboxSize"));
+        return 1;
+    }
+
+    FPlatformMemory::FSharedMemoryRegion* Region = FPlatformMemory::MapNamedSharedMemoryRegion(
+        MailboxName(BaseName, TEXT("mailbox")),
+        false,
+        FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write,
+        sizeof(FSpiceMailboxHeader) + MailboxSize
+    );
+    FPlatformProcess::FSemaphore* RequestReady = FPlatformProcess::NewInterprocessSynchObject(MailboxName(BaseName, TEXT("request")), false);
+    FPlatformProcess::FSemaphore* ResponseReady = FPlatformProcess::NewInterprocessSynchObject(MailboxName(BaseName, TEXT("response")), false);
+
+    if (!Region || !RequestReady || !ResponseReady)
+    {
+        UE_LOG(LogSpice, Error, TEXT("MaxQ SPICE Worker: could not open mailbox %s"), *BaseName);
+        return 1;
+    }
+
+    MaxQ::Core::InitAll();
+
+    uint8* Mailbox = static_cast<uint8*>(Region->GetAddress());
+    FSpiceMailboxHeader* Header = reinterpret_cast<FSpiceMailboxHeader*>(Mailbox);
+
+    while (true)
+    {
+        RequestReady->Lock();
+        FPlatformMisc::MemoryBarrier();
+
+        if (Header->Magic != FSpiceMailboxHeader::MagicValue || Header->Command == FSpiceMailboxHeader::Quit)
+        {
+            break;
+        }
+
+        bool bSyncKernels = false;
+        TArray<MaxQ::Data::FKernelHistoryEntry> KernelHistory;
+        FString JobName;
+        TArray<uint8> Request;
+        {
+            TArray<uint8> Payload(Mailbox + sizeof(FSpiceMailboxHeader), FMath::Min(Header->PayloadSize, MailboxSize));
+            FMemoryReader Reader(Payload);
+            Reader << bSyncKernels;
+            Reader << KernelHistory;
+            Reader << JobName;
+            Reader << Request;
+        }
+
+        bool bSuccess = false;
+        FString ErrorMessage;
+        TArray<uint8> Response;
+
+        // Don't run a job against a partial kernel set
+        bool bKernelsSynced = !bSyncKernels || SyncKernels(KernelHistory, ErrorMessage);
+
+        if (!bKernelsSynced)
+        {
+            UE_LOG(LogSpice, Error, TEXT("%s"), *ErrorMessage);
+        }
+        else if (const FSpiceJobHandler* Handler = FSpiceProcessPool::FindJob(FName(*JobName)))
+        {
+            bSuccess = (*Handler)(Request, Response, ErrorMessage);
+        }
+        else
+        {
+            ErrorMessage = FString::Printf(TEXT("MaxQ SPICE Worker: unknown job %s"), *JobName);
+        }
+
+        // Don't let one job's error state leak into the next
+        UnexpectedErrorCheck(true);
+
+        TArray<uint8> Payload;
+        FMemoryWriter Writer(Payload);
+        Writer << ErrorMessage;
+        Writer << Response;
+        Writer << bKernelsSynced;
+
+        if ((uint32)Payload.Num() > MailboxSize)
+        {
+            Payload.Empty();
+            FMemoryWriter OverflowWriter(Payload);
+            ErrorMessage = FString::Printf(TEXT("MaxQ SPICE Worker: response for %s exceeds mailbox size (%u bytes)"), *JobName, MailboxSize);
+            Response.Empty();
+            OverflowWriter << ErrorMessage;
+            OverflowWriter << Response;
+            OverflowWriter << bKernelsSynced;
+            bSuccess = false;
+        }
+
+        FMemory::Memcpy(Mailbox + sizeof(FSpiceMailboxHeader), Payload.GetData(), Payload.Num());
+        Header->PayloadSize = Payload.Num();
+        Header->bSuccess = bSuccess ? 1 : 0;
+        FPlatformMisc::MemoryBarrier();
+
+        ResponseReady->Unlock();
+    }
+
+    FPlatformProcess::DeleteInterprocessSynchObject(RequestReady);
+    FPlatformProcess::DeleteInterprocessSynchObject(ResponseReady);
+    FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+
+    return 0;
+}
@@ -0,0 +1,33 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceWorkerCommandlet.h
+//
+// Private API Comments
+//
+// Purpose:  Worker process main loop for FSpiceProcessPool.
+// Launched by the pool as:
+//    <exe> [project] -run=SpiceWorker -MaxQMailbox=<name> -MaxQMailboxSize=<n>
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SpiceWorkerCommandlet.generated.h"
+
+UCLASS()
+class USpiceWorkerCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    USpiceWorkerCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
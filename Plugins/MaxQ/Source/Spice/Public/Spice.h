@@ -4651,6 +4651,200 @@ public:
     );
 
 
+    /// <summary>S/P Kernel, easier reader, many epochs</summary>
+    /// <param name="ets">[in] Observer epochs</param>
+    /// <param name="targ">[in] Target body name</param>
+    /// <param name="obs">[in] Observing body name</param>
+    /// <param name="ref">[in] Reference frame of output state vectors</param>
+    /// <param name="abcorr">[in] Aberration correction flag ["NONE"]</param>
+    /// <param name="states">[out] State of target, per epoch</param>
+    /// <param name="lts">[out] One way light time between observer and target, per epoch</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|SPK",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS, BATCH",
+            ShortToolTip = "S/P Kernel, easier reader, many epochs",
+            ToolTip = "Return the states of a target body relative to an observing body at many epochs.  Equivalent to calling spkezr per epoch, but marshals the inputs only once."
+            ))
+    static void spkezr_batch(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const TArray<FSEphemerisTime>& ets,
+        TArray<FSStateVector>& states,
+        TArray<FSEphemerisPeriod>& lts,
+        const FString& targ = TEXT("MOON"),
+        const FString& obs = TEXT("EARTH BARYCENTER"),
+        const FString& ref = TEXT("ECLIPJ2000"),
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    );
+
+
+    /// <summary>S/P Kernel, position, many epochs</summary>
+    /// <param name="ets">[in] Target epochs</param>
+    /// <param name="targ">[in] Target body name</param>
+    /// <param name="obs">[in] Observing body</param>
+    /// <param name="ref">[in] Target reference frame</param>
+    /// <param name="abcorr">[in] Aberration correction flag ["NONE"]</param>
+    /// <param name="ptargs">[out] Position of target, per epoch</param>
+    /// <param name="lts">[out] Light time, per epoch</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|SPK",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS, BATCH",
+            ShortToolTip = "S/P Kernel, position, many epochs",
+            ToolTip = "Return the positions of a target body relative to an observing body at many epochs.  Equivalent to calling spkpos per epoch, but marshals the inputs only once."
+            ))
+    static void spkpos_batch(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const TArray<FSEphemerisTime>& ets,
+        TArray<FSDistanceVector>& ptargs,
+        TArray<FSEphemerisPeriod>& lts,
+        const FString& targ = TEXT("EARTH"),
+        const FString& obs = TEXT("SSB"),
+        const FString& ref = TEXT("ECLIPJ2000"),
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    );
+
+
+    /// <summary>S/P Kernel, easier reader, many targets</summary>
+    /// <param name="et">[in] Observer epoch</param>
+    /// <param name="targs">[in] Target body names</param>
+    /// <param name="obs">[in] Observing body</param>
+    /// <param name="ref">[in] Reference frame of output state vectors</param>
+    /// <param name="abcorr">[in] Aberration correction flag</param>
+    /// <param name="states">[out] State of each target</param>
+    /// <param name="lts">[out] One way light time between observer and each target</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|SPK",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS, BATCH",
+            ShortToolTip = "S/P Kernel, easier reader, many targets",
+            ToolTip = "Return the states of many target bodies relative to one observing body at one epoch.  The observer's state is only computed once."
+            ))
+    static void spkezr_multi(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FSEphemerisTime& et,
+        const TArray<FString>& targs,
+        TArray<FSStateVector>& states,
+        TArray<FSEphemerisPeriod>& lts,
+        const FString& obs = TEXT("SSB"),
+        const FString& ref = TEXT("ECLIPJ2000"),
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    );
+
+
+    /// <summary>S/P Kernel, position, many targets</summary>
+    /// <param name="et">[in] Observer epoch</param>
+    /// <param name="targs">[in] Target body names</param>
+    /// <param name="obs">[in] Observing body</param>
+    /// <param name="ref">[in] Reference frame of output position vectors</param>
+    /// <param name="abcorr">[in] Aberration correction flag</param>
+    /// <param name="ptargs">[out] Position of each target</param>
+    /// <param name="lts">[out] Light time, per target</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|SPK",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS, BATCH",
+            ShortToolTip = "S/P Kernel, position, many targets",
+            ToolTip = "Return the positions of many target bodies relative to one observing body at one epoch.  The observer's state is only computed once."
+            ))
+    static void spkpos_multi(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FSEphemerisTime& et,
+        const TArray<FString>& targs,
+        TArray<FSDistanceVector>& ptargs,
+        TArray<FSEphemerisPeriod>& lts,
+        const FString& obs = TEXT("SSB"),
+        const FString& ref = TEXT("ECLIPJ2000"),
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    );
+
+
+    /// <summary>S/P Kernel, compile ephemeris query</summary>
+    /// <param name="targ">[in] Target body name</param>
+    /// <param name="obs">[in] Observing body</param>
+    /// <param name="ref">[in] Reference frame of output state vectors</param>
+    /// <param name="abcorr">[in] Aberration correction flag</param>
+    /// <param name="query">[out] Query, with names resolved to NAIF IDs</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|SPK",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS",
+            ShortToolTip = "S/P Kernel, compile ephemeris query",
+            ToolTip = "Resolve target/observer/frame names once, for repeated use by spkezr_query and spkpos_query"
+            ))
+    static void spk_compile_query(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        FSEphemerisQuery& query,
+        const FString& targ = TEXT("MOON"),
+        const FString& obs = TEXT("EARTH BARYCENTER"),
+        const FString& ref = TEXT("ECLIPJ2000"),
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    );
+
+
+    /// <summary>S/P Kernel, easier reader, compiled query</summary>
+    /// <param name="query">[in] Query from spk_compile_query</param>
+    /// <param name="et">[in] Observer epoch</param>
+    /// <param name="state">[out] State of target</param>
+    /// <param name="lt">[out] One way light time between observer and target</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|SPK",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS",
+            ShortToolTip = "S/P Kernel, easier reader, compiled query",
+            ToolTip = "Return the state of a target body relative to an observing body, as spkezr, using a precompiled query"
+            ))
+    static void spkezr_query(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FSEphemerisQuery& query,
+        const FSEphemerisTime& et,
+        FSStateVector& state,
+        FSEphemerisPeriod& lt
+    );
+
+
+    /// <summary>S/P Kernel, position, compiled query</summary>
+    /// <param name="query">[in] Query from spk_compile_query</param>
+    /// <param name="et">[in] Observer epoch</param>
+    /// <param name="ptarg">[out] Position of target</param>
+    /// <param name="lt">[out] One way light time between observer and target</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|SPK",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS",
+            ShortToolTip = "S/P Kernel, position, compiled query",
+            ToolTip = "Return the position of a target body relative to an observing body, as spkpos, using a precompiled query"
+            ))
+    static void spkpos_query(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FSEphemerisQuery& query,
+        const FSEphemerisTime& et,
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt
+    );
+
+
     /// <summary>S/P Kernel, Load ephemeris file</summary>
     /// <param name="filename">[in] Name of the file to be loade</param>
     /// <param name="handle">[out] Loaded file's handle</param>
@@ -4783,6 +4977,39 @@ public:
         const TArray<FSPKType5Observation>& states
     );
 
+    /// <summary>Write SPK segment, type 10</summary>
+    /// <param name="handle">[in] Handle of an SPK file open for writing</param>
+    /// <param name="body">[in] Body code (-100000 - NORAD number, by convention)</param>
+    /// <param name="center">[in] Body code for the center of motion of the body (399)</param>
+    /// <param name="frame">[in] The reference frame of the states ("J2000")</param>
+    /// <param name="first">[in] First valid time for which states can be computed</param>
+    /// <param name="last">[in] Last valid time for which states can be computed</param>
+    /// <param name="segid">[in] Segment identifier</param>
+    /// <param name="consts">[in] Geophysical constants (getgeophs)</param>
+    /// <param name="elems">[in] Two-line element sets, in increasing order of epoch</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|SPK",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS, TLE",
+            ShortToolTip = "Write SPK segment, type 10",
+            ToolTip = "Write an SPK segment of type 10 (NORAD two-line element sets) given a time-ordered set of element sets and the geophysical constants"
+            ))
+    static void spkw10(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        int handle,
+        int body,
+        int center,
+        const FString& frame,
+        const FSEphemerisTime& first,
+        const FSEphemerisTime& last,
+        const FString& segid,
+        const FSTLEGeophysicalConstants& consts,
+        const TArray<FSTwoLineElements>& elems
+    );
+
     UFUNCTION(BlueprintCallable,
         Category = "MaxQ|SPK",
         meta = (
@@ -4963,6 +5190,106 @@ public:
     );
 
 
+    /// <summary>STAR catalog type 1, find stars in RA-DEC box</summary>
+    /// <param name="catnam">[in] Catalog table name (from stcl01)</param>
+    /// <param name="westra">[in] Western most right ascension in radians</param>
+    /// <param name="eastra">[in] Eastern most right ascension in radians</param>
+    /// <param name="sthdec">[in] Southern most declination in radians</param>
+    /// <param name="nthdec">[in] Northern most declination in radians</param>
+    /// <param name="nstars">[out] Number of stars found</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Stars",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "CATALOG, FILES, SEARCH",
+            ShortToolTip = "STAR catalog type 1, find stars in RA-DEC box",
+            ToolTip = "Search through a type 1 star catalog and return the number of stars within a specified RA - DEC rectangle"
+            ))
+    static void stcf01(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FString& catnam,
+        const FSAngle& westra,
+        const FSAngle& eastra,
+        const FSAngle& sthdec,
+        const FSAngle& nthdec,
+        int& nstars
+    );
+
+    /// <summary>STAR catalog type 1, get star data</summary>
+    /// <param name="index">[in] Star index, from 0 to the last stcf01's nstars - 1</param>
+    /// <param name="ra">[out] Right ascension in radians (J2000, at the catalog epoch)</param>
+    /// <param name="dec">[out] Declination in radians (J2000, at the catalog epoch)</param>
+    /// <param name="rasig">[out] Right ascension uncertainty in radians</param>
+    /// <param name="decsig">[out] Declination uncertainty in radians</param>
+    /// <param name="catnum">[out] Catalog number</param>
+    /// <param name="sptype">[out] Spectral type</param>
+    /// <param name="vmag">[out] Visual magnitude</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Stars",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "CATALOG, FILES",
+            ShortToolTip = "STAR catalog type 1, get star data",
+            ToolTip = "Get data for a single star from a SPICE type 1 star catalog, among those found by the last stcf01 search"
+            ))
+    static void stcg01(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        int index,
+        FSAngle& ra,
+        FSAngle& dec,
+        FSAngle& rasig,
+        FSAngle& decsig,
+        int& catnum,
+        FString& sptype,
+        double& vmag
+    );
+
+    /// <summary>STAR catalog type 1, load catalog file</summary>
+    /// <param name="relativePath">[in] Catalog file (an EK), relative to the project directory</param>
+    /// <param name="tabnam">[out] Catalog table name</param>
+    /// <param name="handle">[out] Catalog file handle</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Stars",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "CATALOG, FILES",
+            ShortToolTip = "STAR catalog type 1, load catalog file",
+            ToolTip = "Load SPICE type 1 star catalog and return the catalog's table name"
+            ))
+    static void stcl01(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FString& relativePath,
+        FString& tabnam,
+        int& handle
+    );
+
+    /// <summary>Stellar aberration</summary>
+    /// <param name="pobj">[in] Position of an object with respect to the observer</param>
+    /// <param name="vobs">[in] Velocity of the observer with respect to the Solar System barycenter</param>
+    /// <param name="appobj">[out] Apparent position of the object with respect to the observer, corrected for stellar aberration</param>
+    /// <returns></returns>
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Ephemeris",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            Keywords = "EPHEMERIS",
+            ShortToolTip = "Stellar aberration",
+            ToolTip = "Correct the apparent position of an object for stellar aberration"
+            ))
+    static void stelab(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FSDistanceVector& pobj,
+        const FSVelocityVector& vobs,
+        FSDistanceVector& appobj
+    );
+
     /// <summary>String to ET</summary>
     /// <param name="str">[in] A string representing an epoch</param>
     /// <param name="et">[out] The equivalent value in seconds past J2000</param>
@@ -0,0 +1,88 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceAttitudeBatch.h
+//
+// API Comments
+//
+// Purpose:  Pointing-constrained attitudes for many objects at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceAttitudeBatch.h is part of the "refined C++ API".
+//
+// A nadir pointing satellite's attitude is MaxQ::Math::TwoVec (twovec_c),
+// then M2q, then Swizzle:  three calls, two through CSPICE's error system,
+// per object per frame.  These do the same for a whole structure-of-arrays
+// batch, natively, in parallel chunks, from any thread, and write UE
+// quaternions directly (as USpice::m2q then Swizzle, the way
+// FCkPointingCursor and BodyPoses convert a rotation).
+//
+// The matrix is twovec's:  it rotates vectors from the frame the inputs are
+// in (J2000, say) to the object's body frame.  TwoVec takes any pair of
+// directions;  the attitude laws build them from the objects' states:
+//
+// * NadirVelocity:  one axis at the central body, another in the plane of
+//   the velocity (LVLH, for positions and velocities in an inertial frame).
+// * SunNadir:  one axis at the sun, another in the plane of nadir (solar
+//   arrays on the sun, instruments toward the ground, as much as possible).
+// * InertialFixed:  every object holds the same attitude.
+//
+// Where twovec would signal an error for one element (its two directions
+// are parallel, or one is zero) that element gets FQuat::Identity, and
+// counts in the return value.  Invalid axes (NONE, or the same axis twice)
+// compute nothing and return INDEX_NONE.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Math
+{
+    // twovec for every element:  axdef[i] along axisa, plndef[i] in the
+    // axisa/axisp plane, on the +axisp side.  Returns the number of
+    // degenerate elements.
+    SPICE_API int32 TwoVec(
+        ES_Axis axisa,
+        const FConstVectorBatch& axdef,
+        ES_Axis axisp,
+        const FConstVectorBatch& plndef,
+        TArrayView<FQuat> q
+    );
+
+    // r, v:  states relative to the central body.  nadirAxis points at it,
+    // velocityAxis is in the plane of the velocity.  (The default is LVLH:
+    // +Z down, +X forward.)
+    SPICE_API int32 NadirVelocity(
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        TArrayView<FQuat> q,
+        ES_Axis nadirAxis = ES_Axis::Z,
+        ES_Axis velocityAxis = ES_Axis::X
+    );
+
+    // r:  positions relative to the central body.  sun:  the sun's position,
+    // relative to the central body, in the same frame (one epoch for every
+    // object).
+    SPICE_API int32 SunNadir(
+        const FConstVectorBatch& r,
+        const FSDistanceVector& sun,
+        TArrayView<FQuat> q,
+        ES_Axis sunAxis = ES_Axis::Z,
+        ES_Axis nadirAxis = ES_Axis::X
+    );
+
+    // m (inputs' frame -> body frame) for every element
+    SPICE_API void InertialFixed(const FSRotationMatrix& m, TArrayView<FQuat> q);
+}
@@ -0,0 +1,155 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceBenchmark.h
+//
+// API Comments
+//
+// Purpose:  Catalog scale benchmark scenarios, and what they measure.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceBenchmark.h is part of the "refined C++ API".
+//
+// A scenario is a synthetic population (SGP4, two body or SPK driven, 1k to
+// 100k objects) with the expensive extras toggled:  eclipse states, labels
+// and orbit paths.  AMaxQBenchmarkActor (SpiceBenchmarkActor.h) spawns one
+// into any map and records it;  the SpiceBenchmark commandlet runs a matrix
+// of them headless (see SpiceBenchmarkCommandlet.h).
+//
+// FBenchmarkRecorder takes a sample per frame:  the frame time, the game
+// thread's time, the SPICE time and calls in the frame (the MaxQ counters,
+// SpiceProfiling.h, so zero in shipping builds), and the process's physical
+// memory.  It writes the frames as CSV and summaries (means, percentiles,
+// peak memory) as JSON, under Saved/MaxQBenchmarks by default, so runs on
+// different versions, configurations and machines can be diffed.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceProfiling.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceBenchmark.generated.h"
+
+
+USTRUCT(BlueprintType)
+struct SPICE_API FMaxQBenchmarkScenario
+{
+    GENERATED_BODY()
+
+    // Empty:  made from the settings (see GetName)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") FString Name;
+
+    // SGP4:  a UMaxQCatalogComponent.  Two body, SPK:  ephemeris subsystem
+    // subscriptions.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") EMaxQPropagation Propagation = EMaxQPropagation::SGP4;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") int32 Objects = 1000;
+    // Random orbits in a low Earth orbit shell, the same ones every run
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") int32 Seed = 1;
+
+    // Eclipse states every frame (needs the Sun and Earth in the kernels)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") bool bEclipse = false;
+    // A catalog label per object
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") bool bLabels = false;
+    // Orbit paths, up to MaxOrbits (each is a line batch)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") bool bOrbits = false;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") int32 MaxOrbits = 1000;
+    // Two body, SPK:  a scene component per object for the subsystem to place
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") bool bComponents = true;
+
+    // SPK:  objects cycle through the targets, as seen from Observer in Frame
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") TArray<FString> SpkTargets = { TEXT("MOON"), TEXT("SUN") };
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") FString Observer = TEXT("EARTH");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") FString Frame = TEXT("J2000");
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") FSEphemerisTime Epoch;
+    // Ephemeris seconds per second of game time
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") double TimeScale = 60.;
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") double Scale = 1.;
+
+    // Frames run before recording starts, and recorded
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") int32 WarmupFrames = 60;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") int32 Frames = 600;
+
+    // "SGP4_10000", plus "_Eclipse", "_Labels", "_Orbits" for what's on
+    FString GetName() const;
+};
+
+
+USTRUCT(BlueprintType)
+struct SPICE_API FMaxQBenchmarkSummary
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") FString Name;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") int32 Objects = 0;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") int32 Frames = 0;
+
+    // Milliseconds per frame
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double FrameMean = 0.;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double FrameP50 = 0.;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double FrameP95 = 0.;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double FrameP99 = 0.;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double FrameMax = 0.;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double GameThreadMean = 0.;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double SpiceMean = 0.;
+
+    // SPICE calls (SPK, frame, SGP4...) per frame
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double SpiceCallsPerFrame = 0.;
+
+    // MB:  the most used while recording, and the growth from the first frame
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double PeakMemory = 0.;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Benchmark") double MemoryGrowth = 0.;
+};
+
+
+namespace MaxQ::Data
+{
+    class SPICE_API FBenchmarkRecorder
+    {
+    public:
+        // Forget the frames so far, and start counting from now
+        void Begin();
+
+        // Seconds:  the frame, and the game thread's part of it
+        void Sample(double FrameSeconds, double GameThreadSeconds);
+
+        int32 Num() const { return Frames.Num(); }
+
+        FMaxQBenchmarkSummary Summarize(const FMaxQBenchmarkScenario& Scenario) const;
+
+        // One row per frame
+        bool WriteCsv(const FString& Path) const;
+
+        // The summaries, and the build they came from
+        static bool WriteJson(const FString& Path, TArrayView<const FMaxQBenchmarkSummary> Summaries);
+
+        // Saved/MaxQBenchmarks
+        static FString DefaultDirectory();
+
+    private:
+        struct FFrame
+        {
+            double FrameSeconds = 0.;
+            double GameThreadSeconds = 0.;
+            double SpiceSeconds = 0.;
+            uint64 SpiceCalls = 0;
+            uint64 UsedPhysical = 0;
+        };
+
+        TArray<FFrame> Frames;
+        FSpiceCounters Last;
+    };
+}
@@ -0,0 +1,117 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceBenchmarkActor.h
+//
+// API Comments
+//
+// Purpose:  Spawns a benchmark scenario into a map, and records it.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceBenchmarkActor.h is part of the "Blueprints API".
+//
+// Drop one into an empty map (with a camera looking at the origin, for the
+// labels and orbits to be drawn) and play.  On BeginPlay it furnishes
+// Kernels, builds its scenario's population, and points the world's
+// UMaxQEphemerisSubsystem at the scenario's epoch and time scale.  After
+// WarmupFrames it records Frames frames, then writes <Name>.csv and
+// <Name>.json to OutputDirectory and broadcasts OnFinished.  A map per
+// configuration (1k/10k/100k, with and without the extras) is a reference
+// map:  run them on each version and machine to be compared.
+//
+// -MaxQBenchmarkQuit on the command line (or bQuitWhenDone) quits when the
+// recording's done, for unattended runs.
+//
+// Population:
+// * SGP4:  a UMaxQCatalogComponent (instances of Mesh), with its shadows if
+//   bEclipse.
+// * Two body and SPK:  subsystem subscriptions, each with a scene component
+//   to place (bComponents).  With bEclipse, the subsystem's snapshot's
+//   eclipse states are computed every frame.
+// Labels (UMaxQCatalogLabelsComponent) and orbit paths
+// (UMaxQOrbitPathComponent) are added on top, if they're on.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SpiceBenchmark.h"
+#include "SpiceBenchmarkActor.generated.h"
+
+class UStaticMesh;
+class UMaxQCatalogComponent;
+class UMaxQCatalogLabelsComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQBenchmarkFinishedDelegate, const FMaxQBenchmarkSummary&, Summary);
+
+
+UCLASS(Blueprintable)
+class SPICE_API AMaxQBenchmarkActor : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AMaxQBenchmarkActor();
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") FMaxQBenchmarkScenario Scenario;
+
+    // Furnished on BeginPlay (SGP4 needs a leapseconds kernel, SPK and
+    // eclipses an SPK with the bodies)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") TArray<FString> Kernels;
+
+    // SGP4 instances.  Null:  the engine's sphere.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") TObjectPtr<UStaticMesh> Mesh;
+
+    // Empty:  Saved/MaxQBenchmarks
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") FString OutputDirectory;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") bool bQuitWhenDone = false;
+
+    // Something else (the commandlet) calls Record each frame
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Benchmark") bool bExternalClock = false;
+
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Benchmark") FMaxQBenchmarkFinishedDelegate OnFinished;
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Benchmark")
+    bool IsFinished() const { return bFinished; }
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Benchmark")
+    FMaxQBenchmarkSummary GetSummary() const { return Summary; }
+
+    // One frame:  warming up, recording, or (after the last) writing the
+    // results
+    void Record(double FrameSeconds, double GameThreadSeconds);
+
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void Tick(float DeltaSeconds) override;
+
+private:
+    void Populate();
+    void UpdateEphemerisExtras();
+    void Finish();
+
+    UPROPERTY(Transient) TObjectPtr<UMaxQCatalogComponent> Catalog;
+    UPROPERTY(Transient) TObjectPtr<UMaxQCatalogLabelsComponent> Labels;
+    UPROPERTY(Transient) TArray<TObjectPtr<USceneComponent>> Placed;
+
+    TArray<FMaxQEphemerisHandle> Handles;
+    TArray<FVector> LabelPositions;
+    TArray<uint8> LabelValid;
+    TArray<float> Shadows;
+
+    MaxQ::Data::FBenchmarkRecorder Recorder;
+    FMaxQBenchmarkSummary Summary;
+    int32 Frame = 0;
+    bool bFinished = false;
+};
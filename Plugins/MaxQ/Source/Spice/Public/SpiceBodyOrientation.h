@@ -0,0 +1,104 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceBodyOrientation.h
+//
+// API Comments
+//
+// Purpose:  Native evaluation of text PCK body orientation (IAU_ frames).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceBodyOrientation.h is part of the "refined C++ API".
+//
+// A text PCK gives a body's orientation as its north pole's right ascension
+// and declination and its prime meridian, each a polynomial in time plus
+// nutation/precession terms:
+//    RA  = ra0  + ra1 T + ra2 T^2  + Sum ra_i  sin(theta_i)
+//    DEC = dec0 + dec1 T + dec2 T^2 + Sum dec_i cos(theta_i)
+//    W   = w0   + w1 d  + w2 d^2   + Sum w_i   sin(theta_i)
+// (T in centuries, d in days, theta_i polynomials in T from the system
+// barycenter's BODYnnn_NUT_PREC_ANGLES).  tipbod_c/tisbod_c look all of it up
+// in the kernel pool on every call.
+//
+// FPckOrientation reads a body's coefficients once.  Evaluating it is a
+// handful of trig calls, doesn't use CSPICE, and (being immutable) is safe
+// from any thread.  Results are tipbod_c's and tisbod_c's:  J2000 to
+// body-fixed.
+//
+// CSPICE uses binary PCK data for a body when it has any, so a body that's
+// in a loaded binary PCK (ITRF93, MOON_PA, ...) has no native model.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Frames
+{
+    class SPICE_API FPckOrientation
+    {
+    public:
+        // Reads body's constants from the kernel pool.  Uses CSPICE.  The
+        // result is invalid (with an error) if the body has no orientation
+        // constants, and invalid (without one) if it has binary PCK data.
+        static TSharedRef<const FPckOrientation, ESPMode::ThreadSafe> FromKernelPool(int32 Body, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        bool IsValid() const { return bValid; }
+        int32 GetBody() const { return Body; }
+
+        // As tipbod_c("J2000", Body, et)
+        void Rotation(double et, double (&tipm)[3][3]) const;
+
+        // As tisbod_c("J2000", Body, et)
+        void StateTransform(double et, double (&tsipm)[6][6]) const;
+
+        void Rotation(const FSEphemerisTime& et, FSRotationMatrix& tipm) const;
+        void StateTransform(const FSEphemerisTime& et, FSStateTransform& tsipm) const;
+
+        // RA, DEC, W (radians) and their rates (radians/second)
+        void Angles(double et, double& Ra, double& Dec, double& W) const;
+        void Angles(double et, double& Ra, double& Dec, double& W, double& dRa, double& dDec, double& dW) const;
+
+        // The pool generation this was read at (MaxQ::Data::GetPoolGeneration)
+        uint64 GetPoolGeneration() const { return PoolGeneration; }
+
+    private:
+        // Degrees;  T (or d) polynomials, lowest order first
+        double RaCoefficients[3] = { 0. };
+        double DecCoefficients[3] = { 0. };
+        double PmCoefficients[3] = { 0. };
+
+        // Per nutation/precession angle:  its polynomial in T (degrees),
+        // PhaseDegree + 1 coefficients each, and the RA, DEC and W amplitudes
+        TArray<double> Phases;
+        int32 PhaseDegree = 1;
+        TArray<double> RaAmplitudes;
+        TArray<double> DecAmplitudes;
+        TArray<double> PmAmplitudes;
+
+        // Seconds past J2000 of the constants' epoch
+        double Epoch = 0.;
+
+        // J2000 to the constants' frame, if it isn't J2000
+        bool bRotated = false;
+        double ToReference[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+
+        int32 Body = 0;
+        bool bValid = false;
+        uint64 PoolGeneration = 0;
+    };
+
+    // The model for Body, read again if the kernel pool has changed since it
+    // was.  Uses CSPICE (only when it reads the pool).
+    SPICE_API TSharedRef<const FPckOrientation, ESPMode::ThreadSafe> GetPckOrientation(int32 Body, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+}
@@ -0,0 +1,155 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCatalogComponent.h
+//
+// API Comments
+//
+// Purpose:  A whole TLE catalog, drawn as instances of one mesh.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCatalogComponent.h is part of the "Blueprints API".
+//
+// An actor per satellite costs a component, a tick and a transform update
+// each, and runs out of headroom at a few thousand.  UMaxQCatalogComponent
+// draws the catalog as instances of one static mesh instead.  A worker
+// propagates every object with FSGP4BatchPropagator, straight into
+// structure-of-arrays states, and turns them into instance transforms (and
+// shadow fractions) in parallel.  That's the back buffer.  When it's done,
+// the game thread swaps it to the front, hands the transforms to the
+// instance buffer in one batch, and starts the next.  So the game thread
+// never waits for propagation:  with bPredict, the worker propagates for the
+// epoch the frame after will display, which hides the one frame of latency.
+//
+// Every instance moves every frame, so it's an ISM rather than an HISM:  the
+// HISM's cluster tree would be rebuilt each frame for nothing.
+//
+// Per instance custom data (for the material's PerInstanceCustomData):
+// 0:  the fraction of the Sun's disk the Earth hides (0 lit, 1 umbra), if
+//     bShadows.  1:  the object's class (SetObjectClass, default 0).
+// 2:  the object's estimated visual magnitude from the first player's
+//     camera, if bPhotometry (MaxQ::Math::Photometry, dimmed by the shadow
+//     if bShadows).  0 without a player camera.
+//
+// States are Earth centered TEME, placed relative to the component.  The
+// shadows treat TEME as J2000, which moves the shadow's edge by the
+// precession since J2000 (a fraction of a degree):  fine for display.
+// Objects that fail to propagate (decayed, bad elements) are scaled to zero.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Async/Future.h"
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+#include "SpiceSGP4Batch.h"
+#include "SpiceCatalogComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FMaxQCatalogUpdatedDelegate);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQCatalogErrorDelegate, const FString&, ErrorMessage);
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API UMaxQCatalogComponent : public UInstancedStaticMeshComponent
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQCatalogComponent();
+
+    // The epoch to propagate to, unless bFollowSubsystem
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Catalog") FSEphemerisTime Epoch;
+    // Use the world's UMaxQEphemerisSubsystem's Epoch
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Catalog") bool bFollowSubsystem = true;
+    // Propagate for the next frame's epoch (this one plus its DeltaTime, at
+    // the subsystem's TimeScale), since it's drawn a frame late
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Catalog") bool bPredict = true;
+
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Catalog") double Scale = 1.;
+    // Instance scale for objects that propagated
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Catalog") FVector InstanceScale = FVector::OneVector;
+
+    // The Earth's shadow, to custom data 0
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Catalog") bool bShadows = true;
+
+    // Visual magnitudes, to custom data 2
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Catalog") bool bPhotometry = false;
+    // At 1000 km and 90 degrees phase, unless SetStandardMagnitude
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Catalog") float StandardMagnitude = 4.f;
+
+    // The epoch of what's on screen
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Catalog") FSEphemerisTime DisplayedEpoch;
+
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Catalog") FMaxQCatalogUpdatedDelegate OnUpdated;
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Catalog") FMaxQCatalogErrorDelegate OnError;
+
+    // Replaces the catalog (and the instances).  Empty geophs:
+    // getgeophs("EARTH").  Returns the number of objects.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Catalog")
+    int32 SetCatalog(const FSTLECatalog& Catalog, const FSTLEGeophysicalConstants& geophs);
+
+    int32 SetPropagators(TArrayView<const MaxQ::Orbits::FSGP4Propagator> Propagators);
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Catalog")
+    void SetObjectClass(int32 Index, float ObjectClass);
+
+    // The object's own standard magnitude (the ISS's is about -1.8)
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Catalog")
+    void SetStandardMagnitude(int32 Index, float NewMagnitude);
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Catalog")
+    int32 NumObjects() const { return Batch.Num(); }
+
+    // The states on screen (km, km/s, TEME), until the next swap
+    const MaxQ::Orbits::FSGP4CatalogStates& GetStates() const { return Front->States; }
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void BeginDestroy() override;
+
+private:
+    struct FBuffer
+    {
+        FSEphemerisTime Epoch;
+        MaxQ::Orbits::FSGP4CatalogStates States;
+        TArray<FTransform> Transforms;
+        // Empty without shadows
+        TArray<float> Shadows;
+        // Empty without photometry
+        TArray<float> Magnitudes;
+        // The game thread's, when launched
+        TArray<float> StandardMagnitudes;
+    };
+
+    void Launch(const FSEphemerisTime& et);
+    void Apply();
+    void Wait();
+
+    MaxQ::Orbits::FSGP4BatchPropagator Batch;
+    TArray<float> Classes;
+    // Empty until SetStandardMagnitude
+    TArray<float> StandardMagnitudes;
+
+    // Front:  on screen (game thread).  Back:  the worker's, while InFlight.
+    TSharedPtr<FBuffer, ESPMode::ThreadSafe> Front;
+    TSharedPtr<FBuffer, ESPMode::ThreadSafe> Back;
+    TFuture<void> InFlight;
+
+    // What custom data was last written, per instance
+    TArray<float> WrittenShadows;
+    TArray<float> WrittenClasses;
+    TArray<float> WrittenMagnitudes;
+};
@@ -0,0 +1,129 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCatalogLabelsComponent.h
+//
+// API Comments
+//
+// Purpose:  Labels for a whole catalog, decluttered and drawn in one batch.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCatalogLabelsComponent.h is part of the "Blueprints API".
+//
+// A name tag widget per object is a UMG element per object, each with its
+// own layout, tick and projection, and a screen full of them overlapping
+// each other.  UMaxQCatalogLabelsComponent labels a whole catalog instead:
+// each frame, in every game view, it projects every position to the screen
+// in parallel, drops the ones behind the camera, off screen or too far, and
+// keeps the rest in priority order while they don't overlap a label already
+// kept (up to MaxLabels).  The survivors are drawn as canvas text, which the
+// canvas batches by font page, so however many there are it's a draw or
+// two.
+//
+// Positions come from a UMaxQCatalogComponent (its states on screen, placed
+// as it places them) or are set directly, in world space.  Labels and
+// priorities are one per position, by index; ties go to the nearer object.
+//
+// The projection and the culling run across all cores.  Declutter is greedy,
+// in priority order, against a grid of screen cells (CellSize pixels), so
+// it's linear in the labels that survive culling.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SpiceCatalogLabelsComponent.generated.h"
+
+class UCanvas;
+class UFont;
+class APlayerController;
+class UMaxQCatalogComponent;
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API UMaxQCatalogLabelsComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQCatalogLabelsComponent();
+
+    // Null:  the engine's small font
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Labels") TObjectPtr<UFont> Font;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Labels") FLinearColor Color = FLinearColor::White;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Labels") bool bShadow = true;
+    // Pixels from the object's screen position to the label's top left
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Labels") FVector2D Offset = FVector2D(6., -6.);
+
+    // Labels drawn per view, at most
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Labels") int32 MaxLabels = 500;
+    // Labels further than this from the camera (UE units) aren't drawn.
+    // 0:  no limit.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Labels") double MaxDistance = 0.;
+    // Labels below this priority aren't drawn
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Labels") float MinPriority = 0.f;
+    // Declutter's grid (pixels).  Smaller packs labels tighter, for more
+    // cells.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Labels") float CellSize = 8.f;
+
+    // Positions from Catalog, if it's set (held weakly)
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Labels")
+    void SetCatalog(UMaxQCatalogComponent* NewCatalog);
+
+    // Replaces the labels.  Priorities (optional) are one per label; higher
+    // is kept first.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Labels")
+    void SetLabels(const TArray<FString>& NewLabels, const TArray<float>& NewPriorities);
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Labels")
+    void SetPriority(int32 Index, float Priority);
+
+    // Positions (UE world space), when there's no catalog.  Valid, if it's
+    // not empty, is one per position:  0 hides the label.
+    void SetWorldPositions(TArrayView<const FVector> Positions, TArrayView<const uint8> Valid = TArrayView<const uint8>());
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Labels", meta = (DisplayName = "Set World Positions"))
+    void K2_SetWorldPositions(const TArray<FVector>& Positions) { SetWorldPositions(Positions); }
+
+    // Labels drawn in the last view
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Labels")
+    int32 NumDrawn() const { return Drawn; }
+
+    virtual void OnRegister() override;
+    virtual void OnUnregister() override;
+
+private:
+    void Draw(UCanvas* Canvas, APlayerController* PlayerController);
+
+    FDelegateHandle DrawHandle;
+    TWeakObjectPtr<UMaxQCatalogComponent> Catalog;
+
+    TArray<FString> Labels;
+    TArray<float> Priorities;
+    // Each label's size in pixels, in MeasuredFont
+    TArray<FVector2f> Sizes;
+    TWeakObjectPtr<const UFont> MeasuredFont;
+
+    TArray<FVector> WorldPositions;
+    TArray<uint8> WorldValid;
+
+    // Per draw, kept to avoid reallocating:  one per label, then the ones
+    // that survive culling, and the declutter grid
+    TArray<FVector2f> Screen;
+    TArray<float> Depths;
+    TArray<uint8> Visible;
+    TArray<int32> Candidates;
+    TBitArray<> Occupied;
+    int32 Drawn = 0;
+};
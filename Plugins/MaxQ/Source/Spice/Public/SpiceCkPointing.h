@@ -0,0 +1,152 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCkPointing.h
+//
+// API Comments
+//
+// Purpose:  Batched CK attitude lookups (ckgp/ckgpav over many epochs and
+// instruments).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCkPointing.h is part of the "refined C++ API".
+//
+// ckgp_c/ckgpav_c resolve the reference frame, search the loaded CKs for the
+// instrument's segments, and convert frames, once per epoch.  A spacecraft
+// with many articulated instruments, or a scrubbed timeline, asks for the same
+// instruments' pointing over and over at nearby times.
+//
+// FCkPointingCursor reads an instrument's segments (from the CKs loaded
+// through furnsh) once, in CSPICE's priority order, and keeps a cursor on the
+// segment that last answered.  While the times asked for stay where that
+// segment has priority, nothing is searched.  Rotations between inertial
+// frames are computed once per segment.  Results are FQuats (and angular
+// velocities) in UE's coordinates, as USpice::m2q + Swizzle would give them.
+//
+// Results are ckgp_c's and ckgpav_c's.  A cursor opens its segments again
+// before the next call if the kernel pool has changed.  Like the calls it
+// batches, only use it from the thread that makes SPICE calls.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Frames
+{
+    class SPICE_API FCkPointingCursor
+    {
+    public:
+        FCkPointingCursor() = default;
+
+        // Reads inst's segments and resolves ref.  On failure the returned
+        // cursor is !IsValid().  An instrument with no segments is valid;
+        // nothing is ever found for it.
+        static FCkPointingCursor Open(
+            int32 inst,
+            const FString& ref,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        bool IsValid() const { return bValid; }
+
+        int32 GetInstrument() const { return Instrument; }
+        const FString& GetReference() const { return Reference; }
+        // The instrument's spacecraft clock (ckmeta_c "SCLK")
+        int32 GetSclk() const { return Sclk; }
+        int32 NumSegments() const { return Segments.Num(); }
+
+        // As ckgp_c(inst, sclkdp[i], tol, ref) for each i, or, when
+        // AngularVelocities isn't empty, ckgpav_c.  Times in the order they'll
+        // be asked for (sorted, or nearly) reuse the cursor the most.  Output
+        // views are either empty or as long as sclkdp;  rotations not found
+        // are identity (velocities zero).  Stops at the first failure.
+        // Returns the number found.
+        int32 Pointing(
+            TArrayView<const double> sclkdp,
+            double tol,
+            TArrayView<FQuat> Rotations,
+            TArrayView<FVector> AngularVelocities = TArrayView<FVector>(),
+            TArrayView<double> clkout = TArrayView<double>(),
+            TArrayView<bool> found = TArrayView<bool>(),
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Raw version, for inner loops:  ckgp_c's cmat (and, with av,
+        // ckgpav_c's av).  No error check;  the caller checks once afterwards.
+        bool Pointing(double sclkdp, double tol, double (&cmat)[3][3], double& clkout, double* av = nullptr);
+
+        // Opens the segments again if the kernel pool has changed since they
+        // were.  The Pointing calls do this themselves.
+        bool Refresh();
+
+        // Forget the last segment used
+        void ResetCursor() { Cursor = INDEX_NONE; }
+
+    private:
+        struct FSegment
+        {
+            int32 Handle = 0;
+            double Descriptor[5] = { 0. };
+            // Ticks
+            double Start = 0.;
+            double Stop = 0.;
+            int32 Frame = 0;
+            bool bHasAv = false;
+            // Frame isn't the reference;  if both are inertial, Rotation is
+            // reference to Frame at any time.
+            bool bRotated = false;
+            bool bConstant = false;
+            double Rotation[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+        };
+
+        bool Resolve();
+        bool Evaluate(int32 Index, double sclkdp, double tol, double (&cmat)[3][3], double& clkout, double* av) const;
+        void MoveCursor(int32 Index, double sclkdp, bool bNeedAv);
+
+        int32 Instrument = 0;
+        FString Reference;
+        int32 ReferenceId = 0;
+        int32 Sclk = 0;
+
+        // Highest priority first
+        TArray<FSegment> Segments;
+
+        // Cursor is the highest priority segment for any time whose
+        // tolerance window lies strictly inside (CursorLo, CursorHi)
+        int32 Cursor = INDEX_NONE;
+        double CursorLo = 0.;
+        double CursorHi = 0.;
+        bool bCursorAv = false;
+
+        uint64 PoolGeneration = 0;
+        bool bValid = false;
+    };
+
+    // Many instruments at one epoch:  output i is Cursors[i]'s pointing at
+    // et, with tol in seconds (each instrument's clock converts et and tol to
+    // ticks).  AngularVelocities and found are either empty or as long as
+    // Cursors.  Returns the number found.
+    SPICE_API int32 Pointing(
+        TArrayView<FCkPointingCursor> Cursors,
+        double et,
+        double tol,
+        TArrayView<FQuat> Rotations,
+        TArrayView<FVector> AngularVelocities = TArrayView<FVector>(),
+        TArrayView<bool> found = TArrayView<bool>(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,149 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCkWriter.h
+//
+// API Comments
+//
+// Purpose:  Writes C-kernel (attitude) segments incrementally.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCkWriter.h is part of the "refined C++ API".
+//
+// ckw01/ckw03 take every pointing record of a segment in one call, so
+// telemetry has to be held until the session ends.  FCkSegmentWriter takes
+// records as they arrive, and writes a segment each time RecordsPerSegment
+// have accumulated.  Memory use stays constant however long the session is.
+//
+// Type 03 segments carry their last record over into the next segment, so
+// pointing can be interpolated across the boundary, and coverage has no
+// holes.  Within a segment, a gap of more than MaxGapTicks between records
+// starts a new interpolation interval (no pointing is interpolated across a
+// telemetry dropout).
+//
+// As with FSpkSegmentWriter, bUseExecutor writes the segments on the
+// FSpiceExecutor thread, and Add() never calls CSPICE.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Private
+{
+    class FSegmentWriteQueue;
+}
+
+namespace MaxQ::Data
+{
+    enum class ECkSegmentType : uint8
+    {
+        // Discrete pointing
+        Type01 = 1,
+        // Linearly interpolated pointing
+        Type03 = 3
+    };
+
+    struct FCkSegmentWriterSettings
+    {
+        ECkSegmentType Type = ECkSegmentType::Type03;
+
+        // Write angular velocities (avflag)
+        bool bAngularVelocity = true;
+
+        // Records per segment (including the one carried over, for type 03)
+        int32 RecordsPerSegment = 10000;
+
+        // Type 03:  a gap longer than this (in encoded SCLK ticks) starts a
+        // new interpolation interval.  0 interpolates across any gap.
+        double MaxGapTicks = 0.;
+
+        // Write segments on the FSpiceExecutor thread
+        bool bUseExecutor = false;
+    };
+
+    class SPICE_API FCkSegmentWriter
+    {
+    public:
+        FCkSegmentWriter();
+        ~FCkSegmentWriter();
+
+        // handle is a CK open for writing (ckopn).  inst, ref and segid are
+        // as ckw01/ckw03.
+        bool Begin(
+            int handle,
+            int inst,
+            const FString& ref,
+            const FString& segid,
+            const FCkSegmentWriterSettings& Settings = FCkSegmentWriterSettings(),
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Encoded SCLK times (sclkdp) must increase, within and across calls.
+        bool Add(
+            TArrayView<const FSPointingType1Observation> records,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        bool Add(
+            const FSPointingType1Observation& record,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Writes what's left, and waits for any segments still in flight.
+        bool End(
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        bool IsOpen() const { return bOpen; }
+        // Segments written (or queued, with bUseExecutor)
+        int32 NumSegments() const { return SegmentsWritten; }
+        int32 NumBuffered() const { return Sclkdp.Num(); }
+
+        FCkSegmentWriter(const FCkSegmentWriter&) = delete;
+        FCkSegmentWriter& operator=(const FCkSegmentWriter&) = delete;
+
+    private:
+        struct FSegment;
+
+        bool Flush(bool bFinal, ES_ResultCode* ResultCode, FString* ErrorMessage);
+        bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage);
+        void Reserve();
+
+        FCkSegmentWriterSettings Settings;
+        int Handle = 0;
+        int Inst = 0;
+        FString Ref;
+        FString SegId;
+
+        // Buffered, not yet written.  For type 03, after the first segment,
+        // the first record was already written (at the end of the previous
+        // one).
+        TArray<double> Sclkdp;
+        TArray<double> Quats;
+        TArray<double> Avvs;
+        // Type 03 interpolation interval start times
+        TArray<double> Starts;
+        bool bCarried = false;
+
+        // Only with bUseExecutor
+        TUniquePtr<MaxQ::Private::FSegmentWriteQueue> WriteQueue;
+
+        int32 SegmentsWritten = 0;
+        bool bOpen = false;
+    };
+}
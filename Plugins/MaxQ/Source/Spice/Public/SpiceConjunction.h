@@ -0,0 +1,188 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceConjunction.h
+//
+// API Comments
+//
+// Purpose:  Close approach (conjunction) screening of whole SGP4 catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceConjunction.h is part of the "refined C++ API".
+//
+// Checking every pair of a catalog at every step (vdist, gfdist) is O(N^2)
+// per step, which rules out the public catalog.  ScreenConjunctions finds
+// every close approach below a threshold in O(N log N) per step:
+//
+// 1. Perigee/apogee filter:  pairs whose radial shells (plus a pad for
+//    perturbations) are further apart than the threshold never meet, and
+//    are rejected before anything else is looked at.
+// 2. At each step the catalog is batch propagated (FSGP4BatchPropagator)
+//    and hashed into cubic cells as big as the screening distance:  the
+//    threshold, plus as far as two objects can close in half a step.  Only
+//    objects in neighboring cells are compared.
+// 3. Pairs within the screening distance whose linearized closest approach
+//    falls within half a step, and within the threshold (with a margin for
+//    curvature), are refined:  TCA is the root of the range rate, by false
+//    position, on the scalar propagators.
+//
+// Steps are screened one after another, each across all cores, and
+// refinement runs across all cores.  Nothing calls CSPICE, so it's
+// thread-safe.  An approach whose TCA would be outside [Start, Stop] (still
+// closing at the end, say) isn't reported.
+//
+// A screening too big for one machine is split into shards:  slices of the
+// window (each padded by a step, so approaches at the edges are found by
+// both neighbors and merged), times ranges of primaries.  A shard propagates
+// the whole catalog over its slice, since a primary's neighbors can be any
+// objects, so time slices split the propagation and object ranges split the
+// pair tests and refinement.  ScreenConjunctionsSharded runs the shards as
+// FSpiceProcessPool jobs, or through any dispatcher with the same contract
+// (FRemoteEphemerisClient::RunJob, to run them on other machines), and
+// merges what comes back.  The catalog travels as SGP4 models, so the nodes
+// don't need a leapseconds kernel, but do need the same build.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+#include "SpiceProcessPool.h"
+
+namespace MaxQ::Orbits
+{
+    struct FConjunctionSettings
+    {
+        // Miss distance, km
+        double Threshold = 5.;
+
+        // Screening step, seconds.  The hash cells grow with it (see
+        // MaxRelativeSpeed), so shorter steps mean fewer candidates.
+        double Step = 20.;
+
+        // TCA, seconds
+        double Tolerance = 1.e-3;
+
+        // Fastest two objects close, km/s (16:  head on, in LEO)
+        double MaxRelativeSpeed = 16.;
+
+        // Added to perigee/apogee shells, km (J2, drag)
+        double ShellPad = 30.;
+    };
+
+    struct FConjunction
+    {
+        // Primary < Secondary (catalog indices)
+        int32 Primary = INDEX_NONE;
+        int32 Secondary = INDEX_NONE;
+        // TDB
+        double TCA = 0.;
+        // km, km/s
+        double MissDistance = 0.;
+        double RelativeSpeed = 0.;
+    };
+
+    struct FConjunctionStats
+    {
+        int32 Steps = 0;
+        // After the perigee/apogee filter
+        int64 Candidates = 0;
+        int64 Refined = 0;
+    };
+
+    // Part of a screening
+    struct FConjunctionShard
+    {
+        // Only pairs whose Primary is in [PrimaryBegin, PrimaryEnd)
+        int32 PrimaryBegin = 0;
+        int32 PrimaryEnd = MAX_int32;
+        // TDB
+        double Start = 0.;
+        double Stop = 0.;
+    };
+
+    // Runs a shard's job:  Job(JobName, Request) as FSpiceProcessPool::Dispatch
+    typedef TFunction<TFuture<FSpiceJobResult>(FName JobName, TArray<uint8>&& Request)> FConjunctionDispatcher;
+
+    // Approaches that became final, sorted by TCA, and the time every
+    // approach before has been streamed by
+    typedef TFunction<void(const TArray<FConjunction>& Conjunctions, const FSEphemerisTime& Through)> FConjunctionPartial;
+
+    // Conjunctions, sorted by TCA.  Invalid propagators, and times SGP4
+    // fails at, are skipped.
+    SPICE_API bool ScreenConjunctions(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        TArray<FConjunction>& Conjunctions,
+        const FConjunctionSettings& Settings = FConjunctionSettings(),
+        FConjunctionStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // One shard of a screening (Shard.Start/Stop are the window).  The
+    // approaches it finds aren't merged with other shards'.
+    SPICE_API bool ScreenConjunctions(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FConjunctionShard& Shard,
+        TArray<FConjunction>& Conjunctions,
+        const FConjunctionSettings& Settings = FConjunctionSettings(),
+        FConjunctionStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // TimeSlices x ObjectRanges shards of [Start, Stop].  Object ranges are
+    // sized so each has about as many pairs to test (a primary is only
+    // paired with higher indices).
+    SPICE_API TArray<FConjunctionShard> MakeConjunctionShards(
+        int32 NumObjects,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        int32 TimeSlices,
+        int32 ObjectRanges,
+        const FConjunctionSettings& Settings = FConjunctionSettings()
+    );
+
+    // Shards' conjunctions as one screening of [Start, Stop]'s:  the same
+    // approach found by two shards (the same pair, TCAs within a step) is
+    // kept once, TCAs outside the window are dropped, sorted by TCA.
+    SPICE_API void MergeConjunctions(
+        TArray<FConjunction>& Conjunctions,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        const FConjunctionSettings& Settings = FConjunctionSettings()
+    );
+
+    // As ScreenConjunctions, in shards.  Dispatch defaults to the process
+    // pool if it's started, and to running the shards here, one after
+    // another, if it isn't.  OnPartial (on the calling thread) streams each
+    // time slice's approaches as soon as its shards are in, holding back
+    // those within a step of the next slice, which may find them too.  Every
+    // approach is streamed once, and together they're Conjunctions.
+    SPICE_API bool ScreenConjunctionsSharded(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        TArray<FConjunction>& Conjunctions,
+        int32 TimeSlices,
+        int32 ObjectRanges,
+        const FConjunctionSettings& Settings = FConjunctionSettings(),
+        FConjunctionDispatcher Dispatch = nullptr,
+        FConjunctionStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr,
+        FConjunctionPartial OnPartial = nullptr
+    );
+}
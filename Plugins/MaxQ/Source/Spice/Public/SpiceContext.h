@@ -0,0 +1,125 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceContext.h
+//
+// API Comments
+//
+// Purpose:  Kernel sets that share one CSPICE image without interfering.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceContext.h is part of the "refined C++ API".
+//
+// Every world in an editor process (PIE clients, a listen server, the editor
+// world) shares CSPICE's one set of static state.  When one PIE client calls
+// Init All on BeginPlay, every other client loses its kernels.
+//
+// An FSpiceContext is one client's view of that state:  the kernels it
+// furnished.  Kernels are reference counted across contexts, so a context's
+// Unload or ClearAll only unloads kernels no other context still holds, and
+// a kernel two contexts furnish is only loaded once (keeping the precedence
+// it had when it was first loaded).  Pool variables set directly (pdpool,
+// boddef...) aren't tracked, and stay until a global ClearAll.
+//
+// While an FSpiceContextScope is held, the Blueprint kernel functions
+// (USpice::furnsh, furnsh_list, unload, clear_all, init_all) go to its
+// context rather than to CSPICE's global state, and so does anything they're
+// called from.  UMaxQSpiceContextSubsystem holds one around each PIE world's
+// tick.  The MaxQ::Data and MaxQ::Core functions stay global.
+//
+// Error state is already per FSpiceScope (SpiceLock.h), so one context's
+// failed call can't leave another's failed_c() set.  That leaves the lock:
+// in-process SPICE calls from every context still take turns.  Dispatch runs
+// a job in an FSpiceProcessPool worker loaded with this context's kernels
+// only, so long queries from different contexts run in parallel, in
+// separate CSPICE images.
+//
+// A context is used from one thread at a time.  A global ClearAll (or Init
+// All outside any context) empties every context.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SpiceTypes.h"
+#include "SpiceData.h"
+#include "SpiceProcessPool.h"
+
+namespace MaxQ::Core
+{
+    class SPICE_API FSpiceContext
+    {
+    public:
+        explicit FSpiceContext(const FString& Name);
+        // Unloads what it still holds
+        ~FSpiceContext();
+
+        FSpiceContext(const FSpiceContext&) = delete;
+        FSpiceContext& operator=(const FSpiceContext&) = delete;
+
+        const FString& GetName() const { return Name; }
+
+        // Relative paths are resolved as MaxQ::Data::Furnsh would
+        bool Furnsh(const FString& RelativePath, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+        bool Furnsh(const TArray<FString>& RelativePaths, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+        bool Unload(const FString& RelativePath, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        // Unloads every kernel this context holds (that no other holds)
+        void ClearAll();
+        // ClearAll, and resets the error state
+        void InitAll();
+
+        // Absolute paths, in load order
+        TArray<FString> GetKernels() const;
+
+        // The kernels as a history a worker can replay (MaxQ::Data), and its
+        // generation, which moves whenever they change
+        uint64 GetKernelHistory(TArray<MaxQ::Data::FKernelHistoryEntry>& History) const;
+
+        // Runs a job in a process pool worker that has this context's kernels
+        // (and nothing else) loaded
+        TFuture<FSpiceJobResult> Dispatch(FName JobName, TArray<uint8>&& Request) const;
+
+        // The calling thread's context (see FSpiceContextScope), or null
+        static FSpiceContext* Current();
+        // For owners that switch contexts on events rather than around a
+        // call (UMaxQSpiceContextSubsystem);  prefer FSpiceContextScope
+        static void SetCurrent(FSpiceContext* Context);
+
+    private:
+        void Forget(const FString& AbsolutePath);
+        // Drops the kernels a global ClearAll took
+        void Sync() const;
+
+        FString Name;
+        uint64 Id = 0;
+        mutable TArray<FString> Kernels;
+        mutable uint64 Generation = 0;
+        mutable uint64 ClearGeneration = 0;
+    };
+
+    // Makes Context the calling thread's current context until it ends.
+    // Scopes nest;  null means none.
+    class SPICE_API FSpiceContextScope
+    {
+    public:
+        explicit FSpiceContextScope(FSpiceContext* Context);
+        ~FSpiceContextScope();
+
+        FSpiceContextScope(const FSpiceContextScope&) = delete;
+        FSpiceContextScope& operator=(const FSpiceContextScope&) = delete;
+
+    private:
+        FSpiceContext* Previous;
+    };
+}
@@ -0,0 +1,76 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceContextSubsystem.h
+//
+// API Comments
+//
+// Purpose:  A SPICE context (kernel set) per PIE world.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceContextSubsystem.h is part of the "Blueprints API".
+//
+// With several PIE clients (and a server) in one editor process, each
+// world gets its own MaxQ::Core::FSpiceContext (see SpiceContext.h).  The
+// context is the game thread's current one from the world's BeginPlay, and
+// from the start of each of its ticks until another world's tick starts, so
+// the Init All, Furnsh and Unload nodes its Blueprints call only touch its
+// kernels.  When the world ends, its kernels are unloaded (unless another
+// world still holds them).
+//
+// Work a world sends to other threads doesn't carry its context;  pass
+// GetContext() along, or Dispatch long queries to the process pool through
+// it, which also lets several worlds' queries run in parallel.
+//
+// On in PIE by default (bInPIE).  In a packaged game there's one world at a
+// time, and a level's kernels usually outlive it, so it's off (bInGame).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SpiceContextSubsystem.generated.h"
+
+namespace MaxQ::Core { class FSpiceContext; }
+
+
+UCLASS(Config = Game)
+class SPICE_API UMaxQSpiceContextSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQSpiceContextSubsystem();
+    virtual ~UMaxQSpiceContextSubsystem();
+
+    UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "MaxQ|Context") bool bInPIE = true;
+    UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "MaxQ|Context") bool bInGame = false;
+
+    // Absolute paths, in load order
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Context")
+    TArray<FString> GetKernels() const;
+
+    MaxQ::Core::FSpiceContext* GetContext() const { return Context.Get(); }
+
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+
+private:
+    void OnWorldTickStart(UWorld* TickingWorld, ELevelTick TickType, float DeltaSeconds);
+
+    TUniquePtr<MaxQ::Core::FSpiceContext> Context;
+    FDelegateHandle TickStartHandle;
+};
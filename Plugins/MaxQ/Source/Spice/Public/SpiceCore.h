@@ -19,6 +19,19 @@
 //    * Blueprints
 //
 // SpiceCore.h is part of the "refined C++ API".
+//
+// MaxQ sets itself up on first use, not when the module loads:  the first
+// FSpiceScope (which every refined-API SPICE call takes) or GetEtClock sets
+// CSPICE's error output and anchors the engine-wide ET clock.  Levels and
+// editor sessions that never touch SPICE never pay for it.  The executor,
+// process pool, registries and caches were already made on demand.
+//
+// Only the error *action* is set at module startup:  CSPICE's default is to
+// exit the process, and base-API (USpice::) calls can come before any scope.
+//
+// WarmUp pays for first use up front, behind a loading screen.  InitAll is
+// only needed to clear what's loaded and reset the error state;  it isn't
+// needed to make MaxQ usable.
 //------------------------------------------------------------------------------
 
 #pragma once
@@ -30,4 +43,14 @@ namespace MaxQ::Core
     SPICE_API void InitAll(bool bPrintCallstack = false);
     SPICE_API void Reset();
     SPICE_API void ClearAll();
+
+    // Any thread, any number of times.  Cheap once it's been done.
+    SPICE_API void EnsureInitialized();
+    SPICE_API bool IsInitialized();
+
+    // EnsureInitialized, then the time system and name registry from the
+    // current kernel pool, and (if bStartExecutor) the executor thread.  Call
+    // after loading kernels, so the first frame that uses them doesn't read
+    // the pool.
+    SPICE_API void WarmUp(bool bStartExecutor = true);
 };
\ No newline at end of file
@@ -0,0 +1,119 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCovariance.h
+//
+// API Comments
+//
+// Purpose:  State covariance propagation and collision probability.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCovariance.h is part of the "refined C++ API".
+//
+// FCovarianceBatch holds the 6x6 covariances (km, km/s) of a whole catalog
+// as structure-of-arrays:  each of the 21 elements of the upper triangle is
+// a column over the objects.  Transform maps every covariance through a
+// state transform, P' = Phi P Phi^T, MAXQ_TWOBODY_LANES objects at a time
+// with ParallelFor across the batch.  Phi is:
+//    * a state transition matrix per object, from Prop2bBatch, to move the
+//      covariances through time:
+//         Prop2bBatch(gm, States, { dt }, Propagated, Stm);
+//         Covariances.Transform(Stm);
+//    * one sxform for every object, to change frames.
+//
+// CollisionProbability is the short-encounter (Foster/Alfano) probability:
+// the combined position covariance, projected onto the encounter plane
+// (normal to the relative velocity), integrated over the hard body circle
+// around the miss vector.  It's done as a 1D integral (Alfano) of the
+// integral across the circle, which is an erf pair in the covariance's
+// principal axes.
+//
+// ConjunctionProbabilities does that for every conjunction
+// ScreenConjunctions found, with the catalog's covariances given at each
+// TLE's epoch and carried to TCA by the two-body state transition matrix
+// (linearized about the SGP4 state at epoch).
+//
+// None of it calls CSPICE, so it's all thread-safe.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceTwoBody.h"
+
+namespace MaxQ::Orbits
+{
+    class FSGP4Propagator;
+    struct FConjunction;
+
+    class SPICE_API FCovarianceBatch
+    {
+    public:
+        static constexpr int32 Lanes = MAXQ_TWOBODY_LANES;
+        static constexpr int32 NumElements = 21;
+
+        // Replaces anything already here with Num zero covariances
+        void SetNum(int32 Num);
+        void Reset();
+
+        int32 Num() const { return NumObjects; }
+        SIZE_T GetAllocatedSize() const;
+
+        // Covariances are symmetric:  only the upper triangle is read
+        void Set(int32 i, const double(&P)[6][6]);
+        void Get(int32 i, double(&P)[6][6]) const;
+
+        // Element (row, col) of every object, Num() long
+        const double* Column(int32 row, int32 col) const { return &Columns[Element(row, col) * Rows]; }
+
+        // P = Phi P Phi^T.  Phi:  one per object, or one for all of them.
+        void Transform(TArrayView<const FSStateTransform> Phi);
+
+    private:
+        // Upper triangle, row by row
+        static int32 Element(int32 row, int32 col)
+        {
+            if (row > col) Swap(row, col);
+            return row * 6 - row * (row - 1) / 2 + (col - row);
+        }
+
+        // NumElements x Rows, column-major.  Rows is a multiple of Lanes.
+        TArray<double> Columns;
+        int32 Rows = 0;
+        int32 NumObjects = 0;
+    };
+
+    // Probability that two objects, r and v apart (secondary less primary,
+    // km and km/s) at closest approach, with a combined position covariance
+    // P (km^2, the sum of both objects'), come within HardBodyRadius (km).
+    // False (with Pc zero) if the covariance is singular or v is zero.
+    SPICE_API bool CollisionProbability(
+        const double(&r)[3],
+        const double(&v)[3],
+        const double(&P)[3][3],
+        double HardBodyRadius,
+        double& Pc
+    );
+
+    // Pc[i] for Conjunctions[i], which index Catalog.  Covariances has one
+    // per catalog entry, at its TLE's epoch, in TEME.  Conjunctions that
+    // couldn't be evaluated (invalid propagators, SGP4 failures, singular
+    // covariances) get zero.  Returns the number evaluated.
+    SPICE_API int32 ConjunctionProbabilities(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FCovarianceBatch& Covariances,
+        TArrayView<const FConjunction> Conjunctions,
+        double HardBodyRadius,
+        TArrayView<double> Pc
+    );
+}
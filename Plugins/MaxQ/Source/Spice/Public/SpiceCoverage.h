@@ -0,0 +1,162 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCoverage.h
+//
+// API Comments
+//
+// Purpose:  Constellation coverage statistics over a ground grid.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCoverage.h is part of the "refined C++ API".
+//
+// "What fraction of the time is each cell seen by at least K satellites,
+// and how long are its gaps" takes azlcpo/recazl per cell, per satellite,
+// per step.  FCoverageAnalysis sets up a longitude/latitude grid once (cell
+// centers on the ellipsoid, as georec, and their zenith directions), then
+// takes one step at a time:  every satellite's body fixed position.  Each
+// step counts, for every cell, the satellites above the elevation mask
+// (natively, in parallel across cells, the inner loop over structure-of-
+// arrays positions so it vectorizes), and accumulates:
+// * the time seen by at least K satellites, for K = 1...MaxFold
+// * gaps (no satellite in view):  how many, their total and the longest.
+//   The mean revisit time is the mean gap.
+//
+// A step's counts hold until the next step (or End), so coverage and gap
+// edges are resolved to the step.  Gaps open at Begin's first step or still
+// open at End are cut off there, and counted.
+//
+// AnalyzeCoverage drives it for an SGP4 catalog, rotating TEME to a pseudo
+// Earth fixed frame as PredictPasses does (SpicePassPrediction.h).  Other
+// sources (SPK, two body batches) call AddStep with their own positions.
+//
+// CreateCoverageTexture puts the statistics in an RGBA32F heatmap (game
+// thread).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+
+class UTexture2D;
+
+namespace MaxQ::Orbits
+{
+    struct FCoverageGrid
+    {
+        // Cells, in longitude and latitude
+        int32 Width = 360;
+        int32 Height = 180;
+
+        // Radians.  Cell (x, y) is centered at MinLongitude + (x + .5) *
+        // (MaxLongitude - MinLongitude) / Width, likewise for latitude.
+        double MinLongitude = -PI;
+        double MaxLongitude = PI;
+        double MinLatitude = -HALF_PI;
+        double MaxLatitude = HALF_PI;
+
+        // The ellipsoid (default:  WGS-84), km
+        double Re = 6378.137;
+        double F = 1. / 298.257223563;
+        double Altitude = 0.;
+    };
+
+    struct FCoverageSettings
+    {
+        // Radians
+        double MinElevation = 0.;
+        // K-fold coverage is tracked for K = 1...MaxFold
+        int32 MaxFold = 4;
+    };
+
+    class SPICE_API FCoverageAnalysis
+    {
+    public:
+        // False (and nothing to add steps to) if the grid or the settings are
+        // invalid
+        bool Begin(const FCoverageGrid& Grid, const FCoverageSettings& Settings = FCoverageSettings());
+
+        // Satellite positions at et (later than the last step), body fixed,
+        // km.  Valid (optional) excludes satellites that failed to
+        // propagate.  Native;  any thread, one at a time.
+        bool AddStep(double et, TArrayView<const FSDistanceVector> Positions, TArrayView<const bool> Valid = {});
+
+        // Closes the last step at et
+        void End(double et);
+
+        int32 Num() const { return Zenith.Num(); }
+        int32 GetWidth() const { return Grid.Width; }
+        int32 GetHeight() const { return Grid.Height; }
+        int32 GetMaxFold() const { return Settings.MaxFold; }
+        double GetDuration() const { return Duration; }
+
+        // Cell y * Width + x
+        FSDistanceVector GetCellPosition(int32 Cell) const;
+
+        // The fraction of the time seen by at least K satellites (1 <= K <=
+        // MaxFold)
+        double FoldFraction(int32 Cell, int32 K) const;
+        int32 NumGaps(int32 Cell) const { return Gaps[Cell]; }
+        double MaxGap(int32 Cell) const { return LongestGap[Cell]; }
+        // Mean gap, seconds (0 without gaps)
+        double MeanRevisit(int32 Cell) const { return Gaps[Cell] > 0 ? GapSeconds[Cell] / Gaps[Cell] : 0.; }
+
+        SIZE_T GetAllocatedSize() const;
+
+    private:
+        // Credits the last step's counts up to et
+        void Accumulate(double et);
+
+        FCoverageGrid Grid;
+        FCoverageSettings Settings;
+
+        // Per cell (structure of arrays)
+        TArray<double> X, Y, Z;
+        TArray<FVector3d> Zenith;
+        TArray<uint16> Counts;
+        // Cell * MaxFold + K - 1
+        TArray<double> FoldSeconds;
+        TArray<double> GapStart;
+        TArray<double> GapSeconds;
+        TArray<double> LongestGap;
+        TArray<int32> Gaps;
+
+        // The step's satellites
+        TArray<double> SatX, SatY, SatZ;
+
+        double LastStep = 0.;
+        double Duration = 0.;
+        bool bHasStep = false;
+        bool bEnded = false;
+    };
+
+    // Steps an SGP4 catalog through [Start, Stop] (TDB) every Step seconds.
+    // Needs a leapseconds kernel (deltet_c, once), so call it from the SPICE
+    // thread.  Analysis must have been begun.
+    SPICE_API bool AnalyzeCoverage(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        double Step,
+        FCoverageAnalysis& Analysis,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Game thread.  Texel (x, y) is cell y * Width + x (row 0 is
+    // MinLatitude).  R:  fraction seen by at least one satellite, G:  by at
+    // least Fold, B:  mean revisit (s), A:  longest gap (s).  Filtering is
+    // bilinear;  x wraps, y clamps.
+    SPICE_API UTexture2D* CreateCoverageTexture(const FCoverageAnalysis& Analysis, int32 Fold = 1);
+}
@@ -0,0 +1,174 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceCoverageIndex.h
+//
+// API Comments
+//
+// Purpose:  A queryable index of binary kernel coverage.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceCoverageIndex.h is part of the "refined C++ API".
+//
+// Answers "is (body, et) covered?" without calling spkezr and seeing if it
+// fails.  The index is built from each file's DAF segment summaries (one
+// pass per file, no fixed size cells) and can be saved, so a kernel set is
+// only scanned when it changes.
+//
+// Per object (SPK:  body, CK:  instrument/structure, PCK:  frame class ID)
+// it keeps the merged coverage window, for O(log n) coverage checks, and
+// every segment, so a query can be traced to the file and segment that
+// would serve it.
+//
+// SPK and PCK coverage is what spkcov/pckcov report.  CK coverage is in TDB
+// and at the interval level (ckcov "INTERVAL"), so indexing CKs needs an
+// LSK and their SCLK kernels loaded.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceWindow.h"
+
+namespace MaxQ::Data
+{
+    enum class EKernelCoverageType : uint8
+    {
+        SPK,
+        CK,
+        PCK,
+        Count
+    };
+
+    struct SPICE_API FCoverageSegment
+    {
+        // TDB
+        double Start = 0.;
+        double Stop = 0.;
+        // SPK:  body, CK:  instrument/structure, PCK:  frame class ID
+        int32 Id = 0;
+        // SPK only
+        int32 Center = 0;
+        // Reference frame ID
+        int32 Frame = 0;
+        int32 DataType = 0;
+        // DAF addresses (doubles, 1-based) of the segment's first and last
+        // words;  byte offset (Address - 1) * 8
+        int32 Begin = 0;
+        int32 End = 0;
+        // Into the index's files, and the segment's order in its file
+        int32 File = INDEX_NONE;
+        int32 Segment = 0;
+    };
+
+    class SPICE_API FKernelCoverageIndex
+    {
+    public:
+        // Files are given priority in the order they're added (the last has
+        // the highest), as CSPICE gives kernels in the order they're loaded.
+        // A file that's already indexed is only rescanned if its size or
+        // timestamp changed, and it keeps its place.  Paths as Furnsh.
+        bool Add(
+            const TArray<FString>& relativePaths,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Every loaded SPK, CK and PCK, in load order
+        bool AddLoaded(
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        void Reset();
+
+        bool Save(
+            const FString& relativePath,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        ) const;
+
+        // Replaces the index.  Files that changed since it was saved are
+        // rescanned, and missing ones are dropped.
+        bool Load(
+            const FString& relativePath,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Add, through a cache file keyed by the files' paths, sizes and
+        // timestamps (default directory:  Saved/MaxQ/CoverageIndex).
+        bool AddCached(
+            const TArray<FString>& relativePaths,
+            const FString& cacheDirectory = FString(),
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // O(log n) in the number of coverage intervals
+        bool IsCovered(EKernelCoverageType Type, int Id, double et) const;
+        bool IsCovered(EKernelCoverageType Type, int Id, double Start, double Stop) const;
+
+        // The covered time closest to et (et itself, if it's covered).
+        // False if Id has no coverage at all.
+        bool Clamp(EKernelCoverageType Type, int Id, double et, double& Clamped) const;
+
+        // The segment a query at et would be served from (the highest
+        // priority one that covers it), or nullptr
+        const FCoverageSegment* FindSegment(EKernelCoverageType Type, int Id, double et) const;
+
+        // Empty if Id isn't covered by any indexed file
+        const MaxQ::GeometryFinder::FSWindow& Coverage(EKernelCoverageType Type, int Id) const;
+        TArray<int32> Ids(EKernelCoverageType Type) const;
+        // Id's segments, lowest priority first
+        TArray<const FCoverageSegment*> Segments(EKernelCoverageType Type, int Id) const;
+
+        int32 NumFiles() const { return Files.Num(); }
+        const FString& FilePath(int32 File) const { return Files[File].Path; }
+        EKernelCoverageType FileType(int32 File) const { return Files[File].Type; }
+        int32 FindFile(const FString& relativePath) const;
+
+    private:
+        struct FObjectWindow
+        {
+            int32 Id = 0;
+            MaxQ::GeometryFinder::FSWindow Window;
+        };
+
+        struct FIndexedFile
+        {
+            FString Path;
+            EKernelCoverageType Type = EKernelCoverageType::SPK;
+            int64 Size = 0;
+            FDateTime Timestamp;
+            TArray<FCoverageSegment> Segments;
+            // CK only, ckcov's interval level coverage
+            TArray<FObjectWindow> Intervals;
+        };
+
+        struct FObject
+        {
+            // (file, segment) pairs, lowest priority first
+            TArray<TPair<int32, int32>> Segments;
+            MaxQ::GeometryFinder::FSWindow Coverage;
+        };
+
+        static bool Scan(FIndexedFile& File, ES_ResultCode* ResultCode, FString* ErrorMessage);
+        static void Serialize(FArchive& Ar, TArray<FIndexedFile>& Files);
+        void RebuildObjects();
+        const FObject* FindObject(EKernelCoverageType Type, int Id) const;
+
+        TArray<FIndexedFile> Files;
+        TMap<int32, FObject> Objects[(int32)EKernelCoverageType::Count];
+    };
+}
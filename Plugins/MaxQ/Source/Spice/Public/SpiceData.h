@@ -48,6 +48,10 @@ namespace MaxQ::Data
         FString* ErrorMessage = nullptr
     );
 
+    // The files are opened and checked (DAF headers, text kernel syntax) in
+    // parallel, then loaded one by one in the order given, so precedence is
+    // the same as Furnsh-ing them in turn.  A file that fails is reported
+    // and skipped, and the rest are still loaded.
     SPICE_API bool Furnsh(
         const TArray<FString>& relativePaths,
         ES_ResultCode* ResultCode = nullptr,
@@ -60,8 +64,102 @@ namespace MaxQ::Data
         FString* ErrorMessage = nullptr
     );
 
+    // Kernels from packaged content, or from memory
+    // CSPICE only reads kernels from files, so Furnsh needs them staged as
+    // loose files (DirectoriesToAlwaysStageAsNonUFS).  These take the
+    // kernel's contents instead, and extract them once to a content-named
+    // file under Saved/MaxQ/Kernels (reused while the contents don't change).
+    // Name identifies the kernel for UnloadBuffer;  its extension is kept.
+    SPICE_API bool FurnshBuffer(
+        const FString& Name,
+        TArrayView<const uint8> Contents,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Reads through the platform file layer (pak files, IoStore), relative
+    // to /Content as Furnsh is.  So kernels can be packaged (and
+    // compressed) with the rest of the content.
+    SPICE_API bool FurnshPackaged(
+        const FString& relativePath,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API bool UnloadBuffer(
+        const FString& Name,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // The system clock, as ET.  Leap second corrected once an LSK is loaded
+    // (MaxQ::Time), plain UTC seconds until then.  It's read once, and
+    // advanced with FPlatformTime::Seconds after that (MaxQ::Time::FEtClock),
+    // so it doesn't jump when the system clock is adjusted.
     SPICE_API FSEphemerisTime Now();
 
+    // Kernel history
+    // Every successful Furnsh/Unload/ClearAll is recorded, so the same kernel
+    // state can be rebuilt elsewhere (e.g. in a FSpiceProcessPool worker).
+    // Generation increments on every change.
+    struct FKernelHistoryEntry
+    {
+        enum class EOperation : uint8
+        {
+            Furnsh,
+            Unload
+        };
+
+        EOperation Operation;
+        FString AbsolutePath;
+
+        friend FArchive& operator<<(FArchive& Ar, FKernelHistoryEntry& Entry)
+        {
+            Ar << Entry.Operation;
+            Ar << Entry.AbsolutePath;
+            return Ar;
+        }
+    };
+
+    SPICE_API uint64 GetKernelHistory(TArray<FKernelHistoryEntry>& History);
+    SPICE_API uint64 GetKernelHistoryGeneration();
+
+    // Kernel pool generation
+    // Increments whenever MaxQ changes the kernel pool (loading, unloading or
+    // clearing kernels, pdpool/pcpool/pipool, boddef, restoring a pool
+    // snapshot), so a value read from the pool stays good for as long as the
+    // generation doesn't move.  Pool writes made by calling CSPICE directly
+    // aren't counted.
+    SPICE_API uint64 GetPoolGeneration();
+
+    // Kernel root directory
+    // Relative kernel paths are relative to this.  By default it's the
+    // project's Content directory, which only exists while the engine is
+    // running;  without it (command line tools, batch servers, ExternalTests)
+    // relative paths are left to CSPICE, which resolves them against the
+    // working directory.  Setting a root overrides both.  Empty resets it.
+    SPICE_API void SetKernelRoot(const FString& AbsoluteDirectory);
+    SPICE_API FString GetKernelRoot();
+
+    // Memory mapped binary kernels
+    // CSPICE reads binary kernels (SPK, CK, PCK, DSK, EK) a record at a time,
+    // through its own file I/O.  With mapping on, every loaded binary kernel
+    // is also mapped read-only, with a hint to page it in, for as long as it
+    // stays loaded.  CSPICE's reads are then served from the page cache,
+    // which is shared by every process that has the kernel loaded.
+    // Off by default.
+    SPICE_API void SetMapBinaryKernels(bool bEnable);
+    SPICE_API bool GetMapBinaryKernels();
+    SPICE_API int32 NumMappedKernels();
+    SPICE_API int64 MappedKernelBytes();
+
+    // Asks for a byte range of a binary kernel to be made resident ahead of
+    // CSPICE reading it.  Path:  as loaded (FKernelCoverageIndex::FilePath).
+    // A mapped kernel's range gets a preload hint (madvise/
+    // PrefetchVirtualMemory), anything else is read on a worker thread, into
+    // the OS file cache.  Doesn't wait either way.  False if Bytes <= 0.
+    SPICE_API bool PrefetchKernelRange(const FString& Path, int64 Offset, int64 Bytes);
+
     SPICE_API void Bodvrd(
         double& Value,
         const FString& bodynm,
@@ -0,0 +1,194 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskBvh.h
+//
+// API Comments
+//
+// Purpose:  Native, multithreaded ray casting against DSK type 2 shape models.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskBvh.h is part of the "refined C++ API".
+//
+// dskxv_c casts rays one at a time through the segment's voxel grid, on the
+// one thread CSPICE can be called from.  LIDAR simulation and terrain
+// occlusion want millions of rays a frame.
+//
+// FDskShapeModel reads the plates and vertices of type 2 segments once
+// (dskz02/dskv02/dskp02), and builds a bounding volume hierarchy per
+// segment (binned SAH).  Casting never touches CSPICE, so it's thread-safe,
+// and the batched Intersect spreads rays across all cores with ParallelFor.
+//
+// Results are dskxv's and dskxsi's:  the hit nearest the ray's vertex over
+// all segments, the plate ID (dskxsi's ic[0]), and the plate's outward unit
+// normal (dskn02).  Plates are expanded by the same tiny fraction as
+// CSPICE's (1e-10), so rays through edges and vertices aren't lost between
+// neighboring plates.
+//
+// Rays are in the segments' body fixed frame, as dskxv's fixref, with the
+// target at the origin.  Every segment of a model must be in one frame.
+//
+// A sensor simulation wants every pixel's plate and surface (to look up an
+// albedo, say), a frame at a time.  An FDskHitBatch holds a batch's hits as
+// arrays, kept between frames so they're only reallocated when a frame has
+// more rays than any before.  Dskxsi fills one from a model if it's given
+// one, or from dskxsi_c, ray by ray, if not.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Dsk
+{
+    struct FDskHit
+    {
+        bool bFound = false;
+        // km, in the segments' frame
+        FSDistanceVector Point;
+        // Outward, unit
+        FSDimensionlessVector Normal;
+        // 1-based, as dskxsi
+        int32 Plate = 0;
+        // Into the model's segments
+        int32 Segment = INDEX_NONE;
+        int32 Surface = 0;
+    };
+
+    // One element per ray
+    struct SPICE_API FDskHitBatch
+    {
+        // 1 if the ray hit
+        TArray<uint8> Found;
+        // km, in the segments' frame (zero for misses)
+        TArray<double> X, Y, Z;
+        // 1-based, as dskxsi (0 for misses)
+        TArray<int32> Plates;
+        // Into Sources (INDEX_NONE for misses)
+        TArray<int32> Segments;
+
+        struct FSource
+        {
+            int32 Surface = 0;
+            int32 Frame = 0;
+            // dskxsi_c's hits:  the DSK and the segment.  (A model's segments
+            // needn't come from a file, so these are zero for them.)
+            int32 Handle = 0;
+            FSDLADescr Dla;
+        };
+        // The segments hit.  From a model:  one per model segment, in order.
+        TArray<FSource> Sources;
+
+        // Keeps the arrays' allocations
+        void SetNum(int32 NumRays);
+        int32 Num() const { return Found.Num(); }
+        MaxQ::Math::FVectorBatch Points() { return { X, Y, Z }; }
+    };
+
+    class SPICE_API FDskShapeModel
+    {
+    public:
+        // One type 2 segment's data:  vertices (x, y, z), and plates (three
+        // 1-based vertex indices each, as dskp02).  Frame:  the frame ID.
+        bool AddSegment(
+            TArrayView<const double> Vertices,
+            TArrayView<const int32> Plates,
+            int32 Frame,
+            int32 Surface = 0,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Type 2 segments for Body (0:  any) in a DSK file.  Surfaces:  the
+        // surface IDs to read (empty:  all).  Paths as Furnsh.
+        bool AddFile(
+            const FString& relativePath,
+            int Body,
+            TArrayView<const int32> Surfaces = TArrayView<const int32>(),
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // ...in every loaded DSK
+        bool AddLoaded(
+            int Body,
+            TArrayView<const int32> Surfaces = TArrayView<const int32>(),
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        void Reset();
+
+        // Thread-safe
+        bool Intersect(const FSRay& Ray, FDskHit& Hit) const;
+
+        // Across all cores.  Hits[i] is Rays[i]'s.
+        void Intersect(TArrayView<const FSRay> Rays, TArray<FDskHit>& Hits) const;
+        void Intersect(TArrayView<const FSRay> Rays, FDskHitBatch& Hits) const;
+
+        int32 NumSegments() const { return Segments.Num(); }
+        int32 NumPlates() const;
+        int32 Frame() const { return FrameCode; }
+        int32 SegmentSurface(int32 Segment) const { return Segments[Segment].Surface; }
+        // The farthest vertex from the origin (km)
+        double BoundingRadius() const;
+        SIZE_T GetAllocatedSize() const;
+
+    private:
+        struct FNode
+        {
+            double Min[3];
+            double Max[3];
+            // Leaf:  Count plates, from Order[Start].  Interior (Count = 0):
+            // the left child follows, and Start is the right child.
+            int32 Start;
+            int32 Count;
+        };
+
+        struct FSegment
+        {
+            TArray<double> Vertices;
+            // 0-based
+            TArray<int32> Plates;
+            TArray<FNode> Nodes;
+            // Plate indices, in leaf order
+            TArray<int32> Order;
+            int32 Surface = 0;
+        };
+
+        static void Build(FSegment& Segment);
+        static bool Intersect(const FSegment& Segment, const double(&Origin)[3], const double(&Direction)[3], double& tBest, int32& BestPlate);
+        // Nearest hit over all segments (Plate 0-based)
+        bool Cast(const double(&Origin)[3], const double(&Direction)[3], double& t, int32& Segment, int32& Plate) const;
+
+        TArray<FSegment> Segments;
+        int32 FrameCode = 0;
+    };
+
+    // dskxsi for every ray (vertex and direction in fixref, target centered).
+    // With a Model (target's, in fixref):  native, across all cores.
+    // Without:  dskxsi_c, ray by ray, with Surfaces as its srflst (empty:
+    // all).  A model has the surfaces it was built with.
+    SPICE_API bool Dskxsi(
+        FDskHitBatch& Hits,
+        TArrayView<const FSRay> Rays,
+        const FSEphemerisTime& et,
+        const FString& target,
+        const FString& fixref,
+        const FDskShapeModel* Model = nullptr,
+        TArrayView<const int32> Surfaces = TArrayView<const int32>(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,114 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskHorizon.h
+//
+// API Comments
+//
+// Purpose:  Horizon maps baked from DSK shape models, for surface shadowing.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskHorizon.h is part of the "refined C++ API".
+//
+// Whether a point near the lunar poles is lit depends on the terrain around
+// it, so shadowing it means a ray toward the sun (dskxv) per pixel, per
+// frame.  But the terrain doesn't move:  each point's horizon, the elevation
+// the terrain reaches in each direction, can be found once.  After that the
+// sun is lit where its elevation is above the horizon at its azimuth.
+//
+// BakeHorizonMap finds the horizon of every texel of a terrain tile (see
+// SpiceDskTerrain.h), in NumAzimuths bins, by bisecting each bin's
+// elevation with rays cast through an FDskShapeModel:  native, across all
+// cores, any thread (a background bake).  FDskTerrain bakes them with its
+// tiles, with bHorizons.
+//
+// At runtime, HorizonVisibility is the visible fraction of the source's disk
+// per texel, from the source's body fixed position (FPlanetLighting's
+// Source, say), and CreateHorizonTexture hands the map to a material, which
+// can do the same lookup per pixel.
+//
+// Elevations are radians above the local horizontal (perpendicular to the
+// radial through the texel), and azimuths are radians from the local north
+// (toward the body's +Z), through east.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceDskBvh.h"
+
+class UTexture2D;
+
+namespace MaxQ::Dsk
+{
+    struct FDskTerrainTile;
+
+    struct FDskHorizonSettings
+    {
+        // Azimuth bins, centered on 0, 2 pi / NumAzimuths, ...  Rounded up to
+        // a multiple of 4 (a texture's channels).
+        int32 NumAzimuths = 32;
+
+        // Bisection steps per bin.  Each halves the uncertainty in the
+        // elevation, from (pi/2 - MinElevation).
+        int32 Iterations = 10;
+
+        // The lowest horizon looked for (radians).  Lower is reported as this.
+        double MinElevation = -0.25;
+
+        // km.  Rays start this far above the texel (along the radial), so
+        // they don't hit its own plate.
+        double Offset = 1.e-3;
+    };
+
+    struct SPICE_API FDskHorizonMap
+    {
+        // The tile's
+        int32 Size = 0;
+        int32 NumAzimuths = 0;
+        // Per texel (the tile's order), per azimuth bin:  the horizon's
+        // elevation (radians).  MinElevation where the tile missed.
+        TArray<float> Elevations;
+
+        bool IsEmpty() const { return Elevations.Num() == 0; }
+
+        // Interpolated between the bins on either side of Azimuth (radians)
+        float Elevation(int32 Texel, double Azimuth) const;
+    };
+
+    // Native, any thread (across all cores).  False if the model has no
+    // plates, or the tile no texels.
+    SPICE_API bool BakeHorizonMap(
+        const FDskShapeModel& Model,
+        const FDskTerrainTile& Tile,
+        const FDskHorizonSettings& Settings,
+        FDskHorizonMap& Map
+    );
+
+    // Native, across all cores.  Per texel, the fraction of a source of
+    // AngularRadius (radians) at Source (km, body fixed) that's above the
+    // horizon:  0 in shadow, 1 lit.  Linear across the disk's diameter (0:  a
+    // step).  False if the map isn't the tile's, or Visibility is too short.
+    SPICE_API bool HorizonVisibility(
+        const FDskTerrainTile& Tile,
+        const FDskHorizonMap& Map,
+        const FSDistanceVector& Source,
+        double AngularRadius,
+        TArrayView<float> Visibility
+    );
+
+    // Game thread.  RGBA32F, Size wide and Size * NumAzimuths / 4 high:  page
+    // p (rows p * Size...) holds bins 4p...4p+3 in R, G, B and A.  Nearest
+    // filtering, clamped.
+    SPICE_API UTexture2D* CreateHorizonTexture(const FDskHorizonMap& Map);
+}
@@ -0,0 +1,165 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskMesh.h
+//
+// API Comments
+//
+// Purpose:  DSK shape models as UE static meshes, with generated LODs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskMesh.h is part of the "refined C++ API".
+//
+// Rendering a shape model through USpice::dskv02/dskp02 means a USTRUCT per
+// vertex and plate, and a Swizzle each.  FDskMesh reads type 2 segments in
+// bulk, straight into UE ready buffers (swizzled, scaled positions, area
+// weighted normals, and 32 bit indices wound for UE), and generates LODs by
+// vertex clustering.
+//
+// Only reading touches CSPICE.  LOD generation is native and any thread can
+// run it, and CreateStaticMesh (game thread) builds the UStaticMesh right
+// from the buffers.  LoadDskMeshAsync does all three without blocking the
+// game thread.
+//
+// A multi-million plate model shouldn't be reimported every run:  in the
+// editor CreateStaticMeshAsset saves the mesh, LODs and all, as a regular
+// asset, which is cooked with the project and loads as any other mesh.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "SpiceTypes.h"
+
+class UStaticMesh;
+class UMaterialInterface;
+
+namespace MaxQ::Dsk
+{
+    struct FDskMeshSettings
+    {
+        // UE units per km
+        double Scale = 1.;
+
+        // Including LOD 0, the DSK's own plates (at most MAX_STATIC_MESH_LODS)
+        int32 NumLODs = 4;
+
+        // Each LOD's triangles, as a fraction of the one before
+        double Reduction = 0.25;
+
+        // LOD 1's screen size.  Each LOD after it is smaller by the square
+        // root of Reduction (its triangles are that much bigger).
+        float LOD1ScreenSize = 0.5f;
+    };
+
+    struct FDskMeshLOD
+    {
+        // UE coordinates (Swizzle, times Scale)
+        TArray<FVector3f> Positions;
+        // Outward, unit, one per position
+        TArray<FVector3f> Normals;
+        // Three per triangle, wound for UE
+        TArray<uint32> Indices;
+
+        int32 NumTriangles() const { return Indices.Num() / 3; }
+    };
+
+    class SPICE_API FDskMesh
+    {
+    public:
+        explicit FDskMesh(const FDskMeshSettings& _Settings = FDskMeshSettings()) : Settings(_Settings) {}
+
+        // Appended to LOD 0.  Vertices (x, y, z, km), and plates (three 1-based
+        // vertex indices each, as dskp02).  Frame:  the frame ID.
+        bool AddSegment(
+            TArrayView<const double> Vertices,
+            TArrayView<const int32> Plates,
+            int32 Frame,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Type 2 segments for Body (0:  any) in a DSK file.  Surfaces:  the
+        // surface IDs to read (empty:  all).  Paths as Furnsh.
+        bool AddFile(
+            const FString& relativePath,
+            int Body,
+            TArrayView<const int32> Surfaces = TArrayView<const int32>(),
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // ...in every loaded DSK
+        bool AddLoaded(
+            int Body,
+            TArrayView<const int32> Surfaces = TArrayView<const int32>(),
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Replaces LODs 1... with LOD 0 clustered down.  Stops early once a
+        // LOD wouldn't be smaller than the one before.  Any thread.
+        void GenerateLODs();
+
+        // Game thread.  One material slot (Material may be null).
+        UStaticMesh* CreateStaticMesh(
+            UObject* Outer,
+            FName Name,
+            UMaterialInterface* Material = nullptr,
+            EObjectFlags Flags = RF_NoFlags
+        ) const;
+
+#if WITH_EDITOR
+        // Game thread.  Creates and saves the asset (e.g. "/Game/Dsk/Bennu").
+        UStaticMesh* CreateStaticMeshAsset(
+            const FString& PackageName,
+            UMaterialInterface* Material = nullptr,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        ) const;
+#endif
+
+        void Reset();
+
+        const TArray<FDskMeshLOD>& GetLODs() const { return LODs; }
+        const FDskMeshSettings& GetSettings() const { return Settings; }
+        int32 Frame() const { return FrameCode; }
+        SIZE_T GetAllocatedSize() const;
+
+    private:
+        UStaticMesh* Build(UObject* Outer, FName Name, UMaterialInterface* Material, EObjectFlags Flags, bool bCommitMeshDescription) const;
+
+        FDskMeshSettings Settings;
+        TArray<FDskMeshLOD> LODs;
+        int32 FrameCode = 0;
+    };
+
+    struct FDskMeshAsyncResult
+    {
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        // Null on error
+        TSharedPtr<FDskMesh, ESPMode::ThreadSafe> Mesh;
+    };
+
+    // Reads the file on the FSpiceExecutor thread, then generates LODs on the
+    // thread pool, where the future is fulfilled.  Pass the mesh back to the
+    // game thread for CreateStaticMesh.
+    SPICE_API TFuture<FDskMeshAsyncResult> LoadDskMeshAsync(
+        const FString& relativePath,
+        int Body,
+        const FDskMeshSettings& Settings = FDskMeshSettings(),
+        const TArray<int32>& Surfaces = TArray<int32>()
+    );
+}
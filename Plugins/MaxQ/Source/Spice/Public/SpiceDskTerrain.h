@@ -0,0 +1,192 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskTerrain.h
+//
+// API Comments
+//
+// Purpose:  DSK shape models baked into tiled height and normal maps, at
+// levels of detail streamed around a camera.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskTerrain.h is part of the "refined C++ API".
+//
+// Drawing a body's surface from latsrf/srfnrm means a CSPICE call per point,
+// on one thread.  A close approach wants the surface under the camera in
+// detail, and the rest of the body coarsely, every frame.
+//
+// Tiles are a longitude/latitude quadtree:  level 0 is two tiles (west and
+// east hemispheres), and each level splits a tile in four.  A tile is baked
+// from an FDskShapeModel as latsrf would find the surface (a ray from outside
+// the body toward its center, per texel) across all cores, never touching
+// CSPICE.  Texels sample the tile's edges, too, so neighboring tiles agree
+// along them.
+//
+// FDskTerrain keeps the tiles near a camera:  Update picks the quadtree's
+// leaves (refining tiles the camera is close to, relative to their size),
+// and bakes the missing ones, coarse levels first, in the thread pool.  Until
+// a tile is baked, its nearest baked ancestor stands in.  The least recently
+// wanted tiles are dropped beyond MaxTiles.
+//
+// With bHorizons, each bake also finds the tile's horizon map (see
+// SpiceDskHorizon.h), in the same thread pool task.
+//
+// CreateTerrainTextures turns a tile into textures (game thread), for a
+// landscape material, or a runtime virtual texture's writer, to sample.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceDskBvh.h"
+#include "SpiceDskHorizon.h"
+#include "Async/Future.h"
+
+class UTexture2D;
+
+namespace MaxQ::Dsk
+{
+    struct FDskTerrainTileKey
+    {
+        int32 Level = 0;
+        // 0...2^(Level+1)-1, west to east from longitude -pi
+        int32 X = 0;
+        // 0...2^Level-1, north to south from latitude pi/2
+        int32 Y = 0;
+
+        // Radians
+        double West() const;
+        double North() const;
+        // Of longitude and of latitude (the same)
+        double Span() const;
+
+        FDskTerrainTileKey Parent() const { return { Level - 1, X / 2, Y / 2 }; }
+
+        bool operator==(const FDskTerrainTileKey& Other) const { return Level == Other.Level && X == Other.X && Y == Other.Y; }
+        friend uint32 GetTypeHash(const FDskTerrainTileKey& Key) { return HashCombine(HashCombine(GetTypeHash(Key.Level), GetTypeHash(Key.X)), GetTypeHash(Key.Y)); }
+    };
+
+    struct FDskTerrainTile
+    {
+        FDskTerrainTileKey Key;
+        // Texels on a side.  Texel (i, j) (row j, north first) is at
+        // longitude West + Span * i / (Size - 1), latitude
+        // North - Span * j / (Size - 1).
+        int32 Size = 0;
+        // km from the body's center (0 where the ray missed)
+        TArray<float> Radii;
+        // Outward, unit, in the model's frame (the ray's direction reversed
+        // where it missed)
+        TArray<FVector3f> Normals;
+        float MinRadius = 0.f;
+        float MaxRadius = 0.f;
+        int32 Misses = 0;
+        // Empty unless it was baked with one
+        FDskHorizonMap Horizon;
+    };
+
+    // Native, any thread (across all cores).  False if the model has no
+    // plates, or Size < 2.
+    SPICE_API bool BakeTerrainTile(
+        const FDskShapeModel& Model,
+        const FDskTerrainTileKey& Key,
+        int32 Size,
+        FDskTerrainTile& Tile
+    );
+
+
+    struct FDskTerrainSettings
+    {
+        // Texels on a side
+        int32 TileSize = 129;
+
+        int32 MaxLevel = 10;
+
+        // A tile is split while the camera is closer to it than this many of
+        // its widths
+        double SplitDistance = 2.;
+
+        // Tiles kept (beyond the ones wanted)
+        int32 MaxTiles = 256;
+
+        // Bakes running at once
+        int32 MaxBakes = 4;
+
+        // km.  Tiles' distances are measured to this sphere (0:  the model's
+        // bounding radius).
+        double Radius = 0.;
+
+        // Bake each tile's horizon map too
+        bool bHorizons = false;
+        FDskHorizonSettings HorizonSettings;
+    };
+
+    class SPICE_API FDskTerrain
+    {
+    public:
+        typedef TSharedPtr<const FDskTerrainTile, ESPMode::ThreadSafe> FTilePtr;
+
+        explicit FDskTerrain(TSharedRef<const FDskShapeModel, ESPMode::ThreadSafe> _Model, const FDskTerrainSettings& _Settings = FDskTerrainSettings());
+        ~FDskTerrain();
+
+        // Camera:  km, in the model's frame.  Collects finished bakes, picks
+        // the tiles wanted and starts baking the missing ones.  One thread
+        // (the game thread, say) calls Update, Find and Flush.
+        void Update(const FSDistanceVector& Camera);
+
+        // The leaves Update picked, coarse to fine
+        const TArray<FDskTerrainTileKey>& GetWanted() const { return Wanted; }
+
+        // Baked, or null
+        FTilePtr Find(const FDskTerrainTileKey& Key) const;
+        // ...or its nearest baked ancestor
+        FTilePtr FindOrAncestor(const FDskTerrainTileKey& Key) const;
+
+        // Waits for the bakes running, and collects them
+        void Flush();
+
+        int32 NumBaking() const { return Bakes.Num(); }
+        int32 NumTiles() const { return Tiles.Num(); }
+
+        FDskTerrain(const FDskTerrain&) = delete;
+        FDskTerrain& operator=(const FDskTerrain&) = delete;
+
+    private:
+        struct FEntry
+        {
+            FTilePtr Tile;
+            uint64 LastWanted = 0;
+        };
+
+        void Select(const double(&Camera)[3], const FDskTerrainTileKey& Key, TArray<FDskTerrainTileKey>& Leaves) const;
+        void Collect(bool bWait);
+
+        TSharedRef<const FDskShapeModel, ESPMode::ThreadSafe> Model;
+        FDskTerrainSettings Settings;
+        double Radius = 0.;
+
+        TMap<FDskTerrainTileKey, FEntry> Tiles;
+        TMap<FDskTerrainTileKey, TFuture<FTilePtr>> Bakes;
+        TArray<FDskTerrainTileKey> Wanted;
+        uint64 Updates = 0;
+    };
+
+    // Game thread.  Heights:  R32 float, the radii (km).  Normals:  BGRA8,
+    // unit normals in UE's coordinates (Swizzle) mapped to 0...255.  Both
+    // clamp, with bilinear filtering.
+    SPICE_API bool CreateTerrainTextures(
+        const FDskTerrainTile& Tile,
+        UTexture2D*& Heights,
+        UTexture2D*& Normals
+    );
+}
@@ -0,0 +1,147 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskTileCatalog.h
+//
+// API Comments
+//
+// Purpose:  Region-indexed, on demand loading of tiled DSK kernels.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskTileCatalog.h is part of the "refined C++ API".
+//
+// Lunar and Martian DSK products are hundreds of tiles, each a file.
+// Loading them all runs out of CSPICE's file table, and every dskxv/latsrf
+// call then picks through every segment.  A tile catalog indexes each file's
+// segment descriptors once (the index can be persisted, as
+// FKernelCoverageIndex's can), and loads only the files whose coverage is
+// near the points asked about:  the camera's sub-point, or a ray's target.
+// Once more than MaxLoaded catalogued files are loaded, the least recently
+// used ones are unloaded, as FKernelCatalog does.
+//
+// Positions are in each segment's (body-fixed) frame;  the catalog doesn't
+// transform them.  Only the files the catalog loaded itself are ever
+// unloaded by it.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceStructs.h"
+
+namespace MaxQ::Data
+{
+    class SPICE_API FDskTileCatalog
+    {
+    public:
+        // MaxLoaded = 0:  no limit
+        explicit FDskTileCatalog(int32 MaxLoaded = 32);
+        // Unloads what the catalog loaded
+        ~FDskTileCatalog();
+
+        // DSK files.  Files already catalogued are only rescanned if their
+        // size or timestamp changed.
+        bool Add(
+            const TArray<FString>& relativePaths,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // The descriptors, so later sessions can skip the scan.  Load
+        // rescans files changed since, and drops ones that are gone.
+        bool Save(
+            const FString& relativePath,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        ) const;
+
+        bool Load(
+            const FString& relativePath,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Loads the files with Body's (0:  any body's) segments within
+        // AngularRadius (radians) of Position's direction from the body's
+        // center.  For a camera, the radius of the view's footprint;  files
+        // outside it stay where they are until evicted.
+        bool EnsureAround(
+            int Body,
+            const FSDistanceVector& Position,
+            double AngularRadius,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // ...every point's (ray targets, say) files, kept together
+        bool EnsurePoints(
+            int Body,
+            TArrayView<const FSDistanceVector> Points,
+            double AngularRadius = 0.,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // The catalogued files covering longitude/latitude (planetocentric,
+        // radians), whether loaded or not
+        void FindFiles(int Body, double Longitude, double Latitude, double AngularRadius, TArray<int32>& Found) const;
+
+        // Whether a segment may have surface within AngularRadius of
+        // longitude/latitude.  Conservative:  rectangular segments always
+        // may, and planetodetic bounds are widened by the flattening.
+        static bool Covers(const FSDSKDescr& Descr, double Longitude, double Latitude, double AngularRadius);
+
+        void SetMaxLoaded(int32 MaxLoaded);
+        int32 GetMaxLoaded() const { return MaxLoaded; }
+
+        int32 NumFiles() const { return Files.Num(); }
+        int32 NumLoaded() const;
+        const FString& FilePath(int32 File) const { return Files[File].Path; }
+        const TArray<FSDSKDescr>& FileSegments(int32 File) const { return Files[File].Segments; }
+        int32 FindFile(const FString& relativePath) const;
+        bool IsLoaded(const FString& relativePath) const;
+
+        void UnloadAll();
+
+        FDskTileCatalog(const FDskTileCatalog&) = delete;
+        FDskTileCatalog& operator=(const FDskTileCatalog&) = delete;
+
+    private:
+        struct FTileFile
+        {
+            FString Path;
+            int64 Size = 0;
+            FDateTime Timestamp;
+            TArray<FSDSKDescr> Segments;
+
+            // Loaded by the catalog (and not unloaded since)
+            bool bLoaded = false;
+            uint64 LastUsed = 0;
+        };
+
+        static bool Scan(FTileFile& File, ES_ResultCode* ResultCode, FString* ErrorMessage);
+        static void Serialize(FArchive& Ar, TArray<FTileFile>& TileFiles);
+
+        // Loads the files, then unloads cold ones (never one of these)
+        bool EnsureFiles(TArrayView<const int32> Needed, ES_ResultCode* ResultCode, FString* ErrorMessage);
+        // Picks up Unload/ClearAll calls made behind the catalog's back
+        void SyncLoaded();
+        bool Evict(TArrayView<const int32> Keep, ES_ResultCode* ResultCode, FString* ErrorMessage);
+
+        TArray<FTileFile> Files;
+
+        int32 MaxLoaded;
+        uint64 UseCount = 0;
+        uint64 KernelGeneration = 0;
+    };
+}
@@ -0,0 +1,166 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceDskWriter.h
+//
+// API Comments
+//
+// Purpose:  Writes DSK type 2 segments from procedural meshes, with the
+// spatial index built across all cores.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceDskWriter.h is part of the "refined C++ API".
+//
+// A type 2 segment carries a voxel spatial index, which dskmi2_c builds on
+// one thread, with a work array the caller has to size.  For terrain made at
+// runtime (millions of plates) building the index takes longer than writing
+// the file.
+//
+// BuildSpatialIndex makes the same index natively:  the same voxel grid,
+// coarse grid, pointer arrays and plate lists, in the same order, as
+// dskmi2_c (with the vertex-plate lists).  Only the extents (a pass in plate
+// order, so the sums round the same way) and the coarse grid's pointers are
+// serial; binning plates into voxels and vertices is spread with ParallelFor.
+// It never touches CSPICE, so any thread can build one.
+//
+// WriteDskType2 writes a mesh as one or more segments of at most
+// MaxPlatesPerSegment plates, each with the vertices its plates use.  While
+// CSPICE writes a segment (dskw02_c, on the calling thread), the next one's
+// index is built in the thread pool, so a mesh too large for one segment is
+// streamed out a chunk at a time.  Meshes in UE's coordinates (as
+// FDskMesh's:  swizzled, scaled, 0-based indices) are converted first.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Dsk
+{
+    // dskmi2_c's spatial index, as dskw02_c takes it
+    struct FDskSpatialIndex
+    {
+        // spaixd (voxel grid extents, origin and voxel size)
+        TArray<double> Doubles;
+        // spaixi (grid sizes, coarse grid, voxel and vertex plate lists)
+        TArray<int32> Integers;
+
+        int32 NumFineVoxels() const;
+        int32 NumCoarseVoxels() const;
+    };
+
+    // As dskmi2_c (makvtl true).  Vertices (x, y, z, km), and plates (three
+    // 1-based vertex indices each).  Fine voxels are FineVoxelScale times the
+    // average plate extent, coarse voxels CoarseVoxelScale fine voxels on a
+    // side.  Any thread.
+    SPICE_API bool BuildSpatialIndex(
+        TArrayView<const double> Vertices,
+        TArrayView<const int32> Plates,
+        FDskSpatialIndex& Index,
+        double FineVoxelScale = 5.,
+        int32 CoarseVoxelScale = 4,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // A UE mesh (positions in UE units, Scale per km, 0-based triangle
+    // indices, wound for UE) as DSK vertices and plates.  The inverse of
+    // FDskMesh's.
+    SPICE_API void MeshToVerticesAndPlates(
+        TArrayView<const FVector3f> Positions,
+        TArrayView<const uint32> Indices,
+        double Scale,
+        TArray<double>& Vertices,
+        TArray<int32>& Plates
+    );
+
+
+    struct FDskWriterSettings
+    {
+        // SPICE_DSK_LATSYS (1), SPICE_DSK_CYLSYS (2), SPICE_DSK_RECSYS (3) or
+        // SPICE_DSK_PDTSYS (4), and its parameters (planetodetic:  equatorial
+        // radius, flattening)
+        int32 CoordinateSystem = 1;
+        double CoordinateParameters[10] = {};
+
+        // Coordinates 1 and 2's bounds (latitudinal:  longitude, latitude,
+        // radians).  Ignored for rectangular segments, which get their
+        // plates' x and y extents.  Coordinate 3's bounds are always the
+        // plates' (dskrb2_c).
+        double MinCoordinate1 = -PI;
+        double MaxCoordinate1 = PI;
+        double MinCoordinate2 = -HALF_PI;
+        double MaxCoordinate2 = HALF_PI;
+
+        // 1:  single-valued surface, 2:  general
+        int32 DataClass = 2;
+
+        // Coverage, TDB seconds past J2000
+        double First = -100. * 365.25 * 86400.;
+        double Last = 100. * 365.25 * 86400.;
+
+        double FineVoxelScale = 5.;
+        int32 CoarseVoxelScale = 4;
+
+        // Larger meshes are written as several segments
+        int32 MaxPlatesPerSegment = 2000000;
+    };
+
+    // dskopn_c.  Paths as Furnsh.
+    SPICE_API bool DskOpen(
+        const FString& relativePath,
+        const FString& ifname,
+        int ncomch,
+        int& handle,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // dskcls_c (bOptimize:  segregate the DAS, which readers want)
+    SPICE_API bool DskClose(
+        int handle,
+        bool bOptimize = true,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // handle is a DSK open for writing (DskOpen).  center, surfid and frame
+    // as dskw02_c; plates 1-based.  Calls CSPICE, from the calling thread.
+    SPICE_API bool WriteDskType2(
+        int handle,
+        int center,
+        int surfid,
+        const FString& frame,
+        TArrayView<const double> Vertices,
+        TArrayView<const int32> Plates,
+        const FDskWriterSettings& Settings = FDskWriterSettings(),
+        int32* SegmentsWritten = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // ...a UE mesh (MeshToVerticesAndPlates)
+    SPICE_API bool WriteDskType2(
+        int handle,
+        int center,
+        int surfid,
+        const FString& frame,
+        TArrayView<const FVector3f> Positions,
+        TArrayView<const uint32> Indices,
+        double Scale,
+        const FDskWriterSettings& Settings = FDskWriterSettings(),
+        int32* SegmentsWritten = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
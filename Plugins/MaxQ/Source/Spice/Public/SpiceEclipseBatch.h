@@ -0,0 +1,83 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEclipseBatch.h
+//
+// API Comments
+//
+// Purpose:  Eclipse state and shadow fraction for whole catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEclipseBatch.h is part of the "refined C++ API".
+//
+// Calling USpice::occult per satellite, per frame, looks up the sun's and the
+// occulting body's states (with light time) again for every satellite.
+// EclipseGeometry does that once per epoch (CSPICE):  the source's apparent
+// position as seen from the occulting body's center, its radius, and the
+// occulting body's RADII and orientation.  EclipseStates then classifies
+// every position as occult does (none, total, annular, partial), and
+// computes how much of the source's disk is hidden (native, in parallel,
+// any thread).
+//
+// The occulting ellipsoid is scaled to a sphere along its axes, which takes
+// care of the Earth's oblateness at eclipse entry and exit.  The source is a
+// uniform disk (no limb darkening), and the source's direction is the same
+// for every position:  the difference from each satellite's own light time
+// is far below the penumbra's width for anything near the occulting body.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Math
+{
+    struct FEclipseGeometry
+    {
+        FSEphemerisTime Epoch;
+        // Relative to the occulting body's center, in the caller's frame
+        FSDistanceVector Source;
+        FSDistance SourceRadius;
+        // The caller's frame to the occulting body's body fixed frame, and
+        // its RADII there
+        FSRotationMatrix ToBodyFixed;
+        FSDistanceVector OccultingRadii;
+    };
+
+    // Uses CSPICE.  The source's radius is its largest RADII.
+    SPICE_API bool EclipseGeometry(
+        const FSEphemerisTime& et,
+        FEclipseGeometry& Geometry,
+        const FString& frame = TEXT("J2000"),
+        const FString& source = TEXT("SUN"),
+        const FString& occulter = TEXT("EARTH"),
+        const FString& fixref = TEXT("IAU_EARTH"),
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::LT_S,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Native.  Positions:  relative to the occulting body's center, in the
+    // frame Geometry was made for, km.  States:  NONE, FULL, ANNULAR or
+    // PARTIAL, per position.  ShadowFraction:  the fraction of the source's
+    // disk that's hidden, 0 (sunlit) to 1 (umbra).  Either may be empty.
+    // Positions inside the occulting body are FULL.  False if any lengths
+    // differ, or Geometry has no radii.
+    SPICE_API bool EclipseStates(
+        const FEclipseGeometry& Geometry,
+        const FConstVectorBatch& Positions,
+        TArrayView<ES_OccultationType> States,
+        TArrayView<float> ShadowFraction
+    );
+}
@@ -0,0 +1,378 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemeris.h
+//
+// API Comments
+//
+// Purpose:  C++ Ephemeris queries (SPK) for many epochs/targets at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemeris.h is part of the "refined C++ API".
+//
+// Sampling a trajectory one spkezr call at a time spends most of its time
+// marshalling the same strings over and over.  The batch versions convert the
+// names once and write into caller owned structure-of-arrays buffers, so the
+// caller can lay out the data however it's going to consume it.
+//
+// The FSpiceName overloads skip the conversions, and the bods2c lookups,
+// entirely (see SpiceName.h).
+//
+// The batches don't pass an abcorr string, either:  CSPICE parses it on every
+// spkez call (and every spkltc call under that), and remembers only the last
+// one, so a workload mixing corrections pays for it each time.  The
+// correction is picked once per batch (or at compile time, with the
+// templated overloads), and in an inertial frame the light time (and stellar
+// aberration of positions) is corrected here, as spkltc and stelab do, with
+// spkssb lookups.  States with stellar aberration, and frames whose
+// orientation depends on the light time (IAU_EARTH...), still go to spkez.
+//
+// Constant position/velocity points (spkcpo, spkcvo, spkcpt, spkcvt) model
+// ground stations and surface targets.  Each of those calls looks up the
+// point's frame (sxform) and its center's state again.  The Multi versions
+// take a whole network in one frame about one center, and look those up
+// once per epoch;  the Batch versions take one point over many epochs.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceResult.h"
+
+class FSpiceName;
+
+namespace MaxQ::Ephemeris
+{
+    // Caller owned, structure-of-arrays output for state batches.
+    // Every view must be at least as long as the ET array.
+    // Units are SPICE units (km, km/s).
+    struct FStateVectorBatch
+    {
+        TArrayView<double> X, Y, Z;
+        TArrayView<double> DX, DY, DZ;
+    };
+
+    struct FPositionBatch
+    {
+        TArrayView<double> X, Y, Z;
+    };
+
+    // Returns the number of epochs computed.  On error, stops at the first
+    // epoch that failed (so the return value is the index of that epoch).
+    // lt may be empty, if the caller doesn't need light times.
+    SPICE_API int32 SpkezrBatch(
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FString& targ,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API int32 SpkposBatch(
+        TArrayView<const double> ets,
+        const FPositionBatch& positions,
+        TArrayView<double> lt,
+        const FString& targ,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API int32 SpkezrBatch(
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API int32 SpkposBatch(
+        TArrayView<const double> ets,
+        const FPositionBatch& positions,
+        TArrayView<double> lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // The same, with the correction as a template argument, e.g.
+    // SpkezrBatch<ES_AberrationCorrectionWithNewtonians::CN>(...), for code
+    // that always uses one.  (The overloads above dispatch to these.)
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    SPICE_API int32 SpkezrBatch(
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    template<ES_AberrationCorrectionWithNewtonians Abcorr>
+    SPICE_API int32 SpkposBatch(
+        TArrayView<const double> ets,
+        const FPositionBatch& positions,
+        TArrayView<double> lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // spkezr/spkpos, one epoch
+    SPICE_API void Spkezr(
+        const FSEphemerisTime& et,
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void Spkpos(
+        const FSEphemerisTime& et,
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // The same, returning a TSpiceResult instead of a ResultCode and
+    // ErrorMessage (see SpiceResult.h)
+    SPICE_API MaxQ::Core::TSpiceResult<void> TrySpkezr(
+        const FSEphemerisTime& et,
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    );
+
+    SPICE_API MaxQ::Core::TSpiceResult<void> TrySpkpos(
+        const FSEphemerisTime& et,
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    );
+
+    // ...and without the light time
+    FORCEINLINE MaxQ::Core::TSpiceResult<FSStateVector> TrySpkezr(
+        const FSEphemerisTime& et,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    )
+    {
+        FSStateVector state;
+        FSEphemerisPeriod lt;
+        MaxQ::Core::TSpiceResult<void> Result = TrySpkezr(et, state, lt, targ, obs, ref, abcorr);
+        if (Result.HasError()) return MakeError(Result.StealError());
+        return MakeValue(state);
+    }
+
+    FORCEINLINE MaxQ::Core::TSpiceResult<FSDistanceVector> TrySpkpos(
+        const FSEphemerisTime& et,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+    )
+    {
+        FSDistanceVector ptarg;
+        FSEphemerisPeriod lt;
+        MaxQ::Core::TSpiceResult<void> Result = TrySpkpos(et, ptarg, lt, targ, obs, ref, abcorr);
+        if (Result.HasError()) return MakeError(Result.StealError());
+        return MakeValue(ptarg);
+    }
+
+    // Many targets, one epoch/observer/frame.
+    // The observer's barycentric state is computed once and shared by all of
+    // the targets (for inertial frames;  non-inertial frames fall back to one
+    // spkpos/spkezr per target, but still only marshal the strings once).
+    // Same error convention as the batch versions:  returns the number of
+    // targets computed, stopping at the first target that fails.
+    SPICE_API int32 SpkposMulti(
+        const FSEphemerisTime& et,
+        TArrayView<const FString> targs,
+        TArrayView<FSDistanceVector> ptargs,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API int32 SpkezrMulti(
+        const FSEphemerisTime& et,
+        TArrayView<const FString> targs,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Scene poses:  each target's position (as SpkposMulti) and its body
+    // frame's orientation (pxform from frames[i] to ref, at et), in one pass,
+    // as UE transforms.  Translations are the swizzled positions divided by
+    // DistanceScale (km per UE unit);  rotations are m2q + Swizzle.  A target
+    // with an empty frame name gets the identity rotation.  frames is as long
+    // as targs.  Same error convention as SpkposMulti.
+    SPICE_API int32 BodyPoses(
+        const FSEphemerisTime& et,
+        TArrayView<const FString> targs,
+        TArrayView<const FString> frames,
+        TArrayView<FTransform> Poses,
+        const FString& obs,
+        const FString& ref,
+        double DistanceScale = 1.,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Constant velocity/position observers (spkcvo/spkcpo):  the state of
+    // target relative to each point in obssta/obspos, at one epoch.  The
+    // points are all in obsref, relative to obsctr (obssta are their states
+    // at obsepc).  Geometric states, and LT/CN corrected states in inertial
+    // frames, share the frame transform and obsctr's state;  other
+    // corrections take spkcvo per point.  Same error convention as
+    // SpkposMulti.
+    SPICE_API int32 SpkcvoMulti(
+        const FSEphemerisTime& et,
+        TArrayView<const FSStateVector> obssta,
+        const FSEphemerisTime& obsepc,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& target,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsctr,
+        const FString& obsref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API int32 SpkcpoMulti(
+        const FSEphemerisTime& et,
+        TArrayView<const FSDistanceVector> obspos,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& target,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsctr,
+        const FString& obsref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Constant velocity/position targets (spkcvt/spkcpt):  the state of each
+    // point relative to obsrvr.  Geometric states share the frame transform
+    // and trgctr's state;  corrected states take spkcvt per point.
+    SPICE_API int32 SpkcvtMulti(
+        TArrayView<const FSStateVector> trgsta,
+        const FSEphemerisTime& trgepc,
+        const FSEphemerisTime& et,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& trgctr,
+        const FString& trgref,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsrvr,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API int32 SpkcptMulti(
+        TArrayView<const FSDistanceVector> trgpos,
+        const FSEphemerisTime& et,
+        TArrayView<FSStateVector> states,
+        TArrayView<FSEphemerisPeriod> lts,
+        const FString& trgctr,
+        const FString& trgref,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsrvr,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // One observer/target point, many epochs.  Same conventions as
+    // SpkezrBatch.
+    SPICE_API int32 SpkcpoBatch(
+        TArrayView<const double> ets,
+        const FSDistanceVector& obspos,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FString& target,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsctr,
+        const FString& obsref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API int32 SpkcptBatch(
+        const FSDistanceVector& trgpos,
+        TArrayView<const double> ets,
+        const FStateVectorBatch& states,
+        TArrayView<double> lt,
+        const FString& trgctr,
+        const FString& trgref,
+        const FString& outref,
+        ES_ReferenceFrameLocus refloc,
+        const FString& obsrvr,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
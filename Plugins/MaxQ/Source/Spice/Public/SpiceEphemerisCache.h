@@ -0,0 +1,125 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisCache.h
+//
+// API Comments
+//
+// Purpose:  Native Chebyshev fits of SPK positions, for frame-rate queries.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisCache.h is part of the "refined C++ API".
+//
+// Rendering asks for the same handful of bodies over and over.  Each spkpos
+// goes back through CSPICE's segment buffer and re-evaluates the SPK record.
+//
+// FChebyshevCache samples spkpos once over a span of time, fits each body with
+// Chebyshev blocks (subdividing until each block is within tolerance), and
+// then answers queries in plain C++.  Velocities come from the derivative of
+// the position fit, so they're smooth but less accurate than the positions.
+//
+// Building the cache calls CSPICE (so, do it on the SPICE thread).  Once it's
+// built, the cache is read-only and queries never touch CSPICE:  it's safe to
+// query from any number of threads (ParallelFor, etc) at once.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Ephemeris
+{
+    struct FChebyshevCacheSettings
+    {
+        // Maximum position error, per block, measured between fit nodes
+        double ToleranceKm = 1.;
+
+        // Polynomial degree for every block
+        int32 Degree = 12;
+
+        // Blocks start out this long, and halve until they meet the tolerance
+        double MaxBlockSeconds = 16. * 86400.;
+
+        // ...but never get shorter than this (even if they miss the tolerance)
+        double MinBlockSeconds = 60.;
+    };
+
+    class SPICE_API FChebyshevCache
+    {
+    public:
+        // Sample and fit.  Replaces anything already in the cache.
+        // Requires SPK coverage for every body over [start, stop].
+        bool Build(
+            const TArray<FString>& bodies,
+            const FString& obs,
+            const FString& ref,
+            const FSEphemerisTime& start,
+            const FSEphemerisTime& stop,
+            const FChebyshevCacheSettings& Settings = FChebyshevCacheSettings(),
+            ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        void Reset();
+
+        bool IsEmpty() const { return Bodies.Num() == 0; }
+        int32 NumBodies() const { return Bodies.Num(); }
+        FSEphemerisTime GetStart() const { return FSEphemerisTime(Start); }
+        FSEphemerisTime GetStop() const { return FSEphemerisTime(Stop); }
+        SIZE_T GetAllocatedSize() const;
+
+        // INDEX_NONE if the body isn't cached
+        int32 FindBody(const FString& body) const;
+
+        // Thread-safe.  False if et is outside [start, stop].
+        // (km, km/s, in the frame/observer the cache was built with)
+        bool Evaluate(int32 BodyIndex, double et, double (&r)[3]) const;
+        bool Evaluate(int32 BodyIndex, double et, double (&r)[3], double (&v)[3]) const;
+
+        bool Position(const FString& body, const FSEphemerisTime& et, FSDistanceVector& r) const;
+        bool State(const FString& body, const FSEphemerisTime& et, FSStateVector& state) const;
+
+        // The fit itself, to hand to something else (replication, say).  Each
+        // block covers [Mid - Radius, Mid + Radius] with 3 * (GetDegree() + 1)
+        // coefficients:  x's, then y's, then z's.
+        int32 GetDegree() const { return Stride / 3 - 1; }
+        int32 NumBlocks(int32 BodyIndex) const;
+        bool GetBlock(int32 BodyIndex, int32 Block, double& Mid, double& Radius, TArrayView<const double>& Coefficients) const;
+
+    private:
+        struct FBody
+        {
+            FString Name;
+
+            // Per block, sorted by start time
+            TArray<double> BlockStart;
+            TArray<double> BlockMid;
+            TArray<double> BlockRadius;
+
+            // Per block, per component (x, y, z):  Degree+1 coefficients.
+            // Coefficients of the derivative (wrt the normalized time) have
+            // the same layout.
+            TArray<double> Coefficients;
+            TArray<double> Derivatives;
+        };
+
+        int32 FindBlock(const FBody& Body, double et) const;
+
+        TArray<FBody> Bodies;
+        TMap<FString, int32> BodyIndex;
+        double Start = 0.;
+        double Stop = 0.;
+        int32 Stride = 0;
+    };
+}
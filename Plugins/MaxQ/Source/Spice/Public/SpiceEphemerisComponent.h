@@ -0,0 +1,85 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisComponent.h
+//
+// API Comments
+//
+// Purpose:  A scene component placed by the ephemeris subsystem.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisComponent.h is part of the "Blueprints API".
+//
+// Placing an actor from an ephemeris is always the same glue:  compute the
+// state, Swizzle it, scale it, SetActorLocation.  UMaxQEphemerisComponent
+// declares what it is instead (a body or spacecraft by NAIF name or ID, a
+// TLE, or conic elements), the frame, and how to scale, and subscribes to
+// the world's UMaxQEphemerisSubsystem from BeginPlay to EndPlay.  It doesn't
+// tick:  the subsystem moves it, with everything else, once per frame.
+//
+// The component is placed relative to its attach parent, so attach it (or
+// make it the root of an actor attached) to whatever represents Observer.
+// Its children move with it.
+//
+// In an editor world, where nothing begins play, it subscribes when it's
+// registered instead, for the subsystem's preview (see
+// SpiceEphemerisSubsystem.h).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceEphemerisComponent.generated.h"
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API UMaxQEphemerisComponent : public USceneComponent
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQEphemerisComponent();
+
+    // Target may be a NAIF name or ID ("EARTH", "399")
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris", meta = (ShowOnlyInnerProperties)) FMaxQEphemerisSubscription Ephemeris;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris", meta = (ShowOnlyInnerProperties)) FMaxQEphemerisPlacement Placement;
+
+    // Subscribe again, after changing Ephemeris or Placement at runtime
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void Refresh();
+
+    // The state (SPICE units, RHS) from the subsystem's last pass
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool GetState(FSStateVector& State) const;
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Ephemeris")
+    FMaxQEphemerisHandle GetHandle() const { return Handle; }
+
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void OnRegister() override;
+    virtual void OnUnregister() override;
+
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+    void Subscribe();
+    void Unsubscribe();
+    bool IsInEditorWorld() const;
+
+    FMaxQEphemerisHandle Handle;
+};
@@ -0,0 +1,137 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisPrefetch.h
+//
+// API Comments
+//
+// Purpose:  Chebyshev cache windows, built ahead of time-warped playback.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisPrefetch.h is part of the "refined C++ API".
+//
+// At a time scale of 10^7 every frame jumps weeks, so every spkpos lands in
+// a different SPK record, and CSPICE's segment and record buffers stop
+// helping.  FEphemerisPrefetcher watches the playback epoch and rate, and
+// keeps an FChebyshevCache window built over where playback is going:  the
+// next LookaheadSeconds of real time at the current rate (forwards or
+// backwards), clamped to [MinWindowSeconds, MaxWindowSeconds].  When
+// RefillFraction of the current window is left, the next window is built
+// on the FSpiceExecutor thread, starting where the current one ends, so it's
+// ready before playback gets there.
+//
+// Evaluate only reads windows that are finished:  it never calls CSPICE and
+// never waits.  If playback outruns the prefetch (a jump, a reversal, a rate
+// change the lookahead can't cover), Evaluate returns false until a window
+// covering the epoch is ready; a window for the epoch itself is started
+// straight away.
+//
+// The builds call CSPICE on the executor, so the executor rule applies (see
+// SpiceExecutor.h):  don't call CSPICE from the game thread while a prefetch
+// is in flight.  Update, Evaluate, State and Position are game thread calls
+// (Evaluate may be called from worker threads between Updates).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "SpiceTypes.h"
+#include "SpiceEphemerisCache.h"
+
+namespace MaxQ::Ephemeris
+{
+    struct FEphemerisPrefetchSettings
+    {
+        // Each window covers this much playback (real seconds at the rate)...
+        double LookaheadSeconds = 8.;
+
+        // ...but at least this much ephemeris time...
+        double MinWindowSeconds = 86400.;
+
+        // ...and at most this much
+        double MaxWindowSeconds = 10. * 365.25 * 86400.;
+
+        // Start building the next window when this fraction of the current
+        // one is left ahead of playback
+        double RefillFraction = 0.5;
+
+        FChebyshevCacheSettings Cache;
+    };
+
+    class SPICE_API FEphemerisPrefetcher
+    {
+    public:
+        // Drops any windows (an in-flight build is discarded when it lands)
+        void Configure(
+            const TArray<FString>& bodies,
+            const FString& obs,
+            const FString& ref,
+            ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+            const FEphemerisPrefetchSettings& Settings = FEphemerisPrefetchSettings()
+        );
+
+        void Reset();
+
+        // Once per frame.  et:  the playback epoch.  Rate:  ephemeris seconds
+        // per real second (negative plays backwards).  Picks up finished
+        // windows and starts the next one if it's time.
+        // Returns false if a build failed since the last Update (ErrorMessage
+        // says why); the same window isn't retried until playback leaves it.
+        bool Update(const FSEphemerisTime& et, double Rate, FString* ErrorMessage = nullptr);
+
+        // False if no finished window covers et
+        bool IsReady(double et) const;
+        bool IsBuilding() const { return InFlight.IsValid(); }
+
+        int32 NumBodies() const { return Bodies.Num(); }
+        // INDEX_NONE if the body isn't prefetched
+        int32 FindBody(const FString& body) const { return Bodies.IndexOfByKey(body); }
+
+        // (km, km/s, in the frame/observer configured)
+        bool Evaluate(int32 BodyIndex, double et, double (&r)[3], double (&v)[3]) const;
+        bool Position(const FString& body, const FSEphemerisTime& et, FSDistanceVector& r) const;
+        bool State(const FString& body, const FSEphemerisTime& et, FSStateVector& state) const;
+
+    private:
+        struct FBuildResult
+        {
+            int32 Generation = 0;
+            TSharedPtr<const FChebyshevCache, ESPMode::ThreadSafe> Cache;
+            FString ErrorMessage;
+        };
+
+        typedef TSharedPtr<const FChebyshevCache, ESPMode::ThreadSafe> FWindow;
+
+        static bool Covers(const FWindow& Window, double et);
+        const FChebyshevCache* Find(double et) const;
+        void Launch(double Start, double Stop);
+
+        TArray<FString> Bodies;
+        FString Observer;
+        FString Frame;
+        ES_AberrationCorrectionWithNewtonians AberrationCorrection = ES_AberrationCorrectionWithNewtonians::None;
+        FEphemerisPrefetchSettings Settings;
+
+        // Current:  covers playback.  Next:  built ahead of it.
+        FWindow Current;
+        FWindow Next;
+
+        TFuture<FBuildResult> InFlight;
+        int32 Generation = 0;
+
+        // The last window that failed, so it isn't rebuilt every frame
+        double FailedStart = 0.;
+        double FailedStop = -1.;
+    };
+}
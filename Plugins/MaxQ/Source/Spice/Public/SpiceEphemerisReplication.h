@@ -0,0 +1,195 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisReplication.h
+//
+// API Comments
+//
+// Purpose:  Server-fitted ephemerides, replicated to clients as Chebyshev
+//           blocks.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisReplication.h is part of the "Blueprints API".
+//
+// When every client loads the kernels and calls spkpos itself, every client
+// has to have the same kernels, and agree on the time, or the objects are in
+// different places on different machines.  UMaxQEphemerisReplicationComponent
+// computes on the server only.  The server fits the owner's trajectory
+// (FChebyshevCache, to ToleranceKm) over a window of WindowSeconds of
+// ephemeris time around the server's epoch, and replicates the fit:  the
+// block edges, and each block's coefficients, quantized to a multiple of a
+// quantum (ToleranceKm / (Degree + 1), so quantizing adds at most half the
+// tolerance) and sent as zigzag variable-length integers.  High order
+// coefficients are tiny, so most of them cost a byte or two.  Clients evaluate
+// the blocks natively:  no kernels, no CSPICE.  The server places its own
+// copy from the same quantized blocks, so every machine computes the same
+// position.
+//
+// The window is refit (on the server's game thread, like the ephemeris
+// subsystem's CSPICE calls) once less than RefillFraction of it is left ahead
+// of the epoch, starting a little behind the epoch, so clients keep the old
+// window's coverage while the new one is in flight.  A jump refits straight
+// away.
+//
+// The epoch itself is replicated as a clock:  an epoch, the server world time
+// it was taken at, and the time scale.  Clients run it against the game
+// state's server world time, so it's only resent when the server's
+// UMaxQEphemerisSubsystem Epoch or TimeScale jumps.
+//
+// Each component replicates with its actor, so it's filtered by the actor's
+// relevancy (NetCullDistanceSquared, bOnlyRelevantToOwner, etc):  clients only
+// receive fits for the objects that are relevant to them.  With bPlaceOwner,
+// the owner's root component goes at the state's position (relative to its
+// parent, times Scale), so turn off the actor's ReplicateMovement.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SpiceTypes.h"
+#include "SpiceEphemerisReplication.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQEphemerisReplicationErrorDelegate, const FString&, ErrorMessage);
+
+
+// Chebyshev blocks over [Edges[0], Edges.Last()], quantized for the wire
+USTRUCT()
+struct SPICE_API FMaxQEphemerisWindow
+{
+    GENERATED_BODY()
+
+    // Block i covers [Edges[i], Edges[i + 1]]
+    TArray<double> Edges;
+    // Per block, per component (x, y, z):  Degree + 1 coefficients, each a
+    // multiple of Quantum
+    TArray<double> Coefficients;
+    int32 Degree = 0;
+    double Quantum = 0.;
+
+    // Changes with each fit, so replication knows to resend
+    int32 Serial = 0;
+
+    bool IsEmpty() const { return Edges.Num() < 2; }
+    bool Covers(double et) const { return !IsEmpty() && et >= Edges[0] && et <= Edges.Last(); }
+
+    // Rounds the coefficients to Quantum (what NetSerialize sends)
+    void Quantize();
+
+    // Fits one target over [Start, Stop] to within ToleranceKm (half for the
+    // fit, half for the quantization), and quantizes it.  Uses CSPICE.  False,
+    // with the reason, if it can't be fit or needs more blocks than a window
+    // may have.  Serial is left as it was.
+    bool Fit(
+        const FString& Target,
+        const FString& Observer,
+        const FString& Frame,
+        ES_AberrationCorrectionWithNewtonians AberrationCorrection,
+        double Start,
+        double Stop,
+        double ToleranceKm,
+        int32 FitDegree,
+        FString& ErrorMessage
+    );
+
+    // (km, km/s).  False if et isn't covered.
+    bool Evaluate(double et, double (&r)[3], double (&v)[3]) const;
+
+    bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+    bool Identical(const FMaxQEphemerisWindow* Other, uint32 PortFlags) const { return Serial == Other->Serial; }
+};
+
+template<>
+struct TStructOpsTypeTraits<FMaxQEphemerisWindow> : public TStructOpsTypeTraitsBase2<FMaxQEphemerisWindow>
+{
+    enum
+    {
+        WithNetSerializer = true,
+        WithIdentical = true
+    };
+};
+
+
+// et = Epoch + (server world time - WorldTime) * TimeScale
+USTRUCT()
+struct SPICE_API FMaxQEphemerisClock
+{
+    GENERATED_BODY()
+
+    UPROPERTY() double Epoch = 0.;
+    UPROPERTY() double WorldTime = 0.;
+    UPROPERTY() double TimeScale = 0.;
+
+    double At(double ServerWorldTime) const { return Epoch + (ServerWorldTime - WorldTime) * TimeScale; }
+};
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API UMaxQEphemerisReplicationComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQEphemerisReplicationComponent();
+
+    // Server:  spkpos's targ, obs, ref and abcorr
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") FString Target = TEXT("MOON");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") FString Observer = TEXT("EARTH");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") FString Frame = TEXT("ECLIPJ2000");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") ES_AberrationCorrectionWithNewtonians AberrationCorrection = ES_AberrationCorrectionWithNewtonians::None;
+
+    // Server:  the fit.  Each window covers this much ephemeris time...
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") FSEphemerisPeriod WindowSeconds = FSEphemerisPeriod(86400.);
+    // ...to within this (fit plus quantization)...
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") double ToleranceKm = 1.e-3;
+    // ...with blocks of this degree
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication", meta = (ClampMin = "1", ClampMax = "31")) int32 Degree = 12;
+    // Refit when this fraction of the window is left ahead of the epoch
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") double RefillFraction = 0.5;
+
+    // Everywhere:  place the owner's root component at the state's position
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") bool bPlaceOwner = true;
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Replication") double Scale = 1.;
+
+    // Server:  a fit failed
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Replication") FMaxQEphemerisReplicationErrorDelegate OnError;
+
+    // The server's epoch, now
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Replication")
+    FSEphemerisTime GetEpoch() const;
+
+    // The state at GetEpoch() (km, km/s, SPICE's RHS).  False until a window
+    // covering it has arrived.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Replication")
+    bool GetState(FSStateVector& State) const;
+
+    // Server:  refit at the next tick (after changing the target, say)
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Replication")
+    void Invalidate();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+    double GetServerWorldTime() const;
+    void Publish();
+    void Fit(double Start, double Stop);
+
+    UPROPERTY(Replicated) FMaxQEphemerisWindow Window;
+    UPROPERTY(Replicated) FMaxQEphemerisClock Clock;
+
+    // Server:  the last window that failed, so it isn't refit every tick
+    double FailedStart = 0.;
+    double FailedStop = -1.;
+};
@@ -0,0 +1,723 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEphemerisSubsystem.h
+//
+// API Comments
+//
+// Purpose:  One batched ephemeris pass per frame, for everything in the world.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEphemerisSubsystem.h is part of the "Blueprints API".
+//
+// When every actor computes its own state in its own Tick, each one marshals
+// its strings, resolves its names and pays for the observer's state again,
+// one at a time on the game thread.  UMaxQEphemerisSubsystem takes
+// subscriptions instead (what to compute, and optionally a scene component
+// to place), and once per frame computes all of them together:
+//
+// * SPK subscriptions sharing an observer, frame and aberration correction
+//   are one SpkposMulti/SpkezrMulti call (the observer's state once).
+// * SGP4 (TLE) subscriptions are one FSGP4BatchPropagator pass, and two body
+//   (conic elements) subscriptions one FTwoBodyBatchPropagator pass.  Both
+//   are native, so they run on worker threads while the game thread does the
+//   SPK groups.
+//
+// * SPK subscriptions with an Interval aren't evaluated every pass.  Exact
+//   states (with velocities) are fetched at knots Interval apart, and the
+//   pass interpolates between the two bracketing the epoch with a cubic
+//   Hermite (hrmint's scheme, on two points).  The interval adapts:  the
+//   change in the interpolant's third derivative from one knot interval to
+//   the next estimates the fourth, and so the error (h^4/384 of it).  The
+//   interval is halved while that's over Tolerance, and doubled back (up to
+//   Interval) once it's well under.  With a minute's interval, that's one
+//   spkezr per object per minute of ephemeris time instead of per frame.
+//
+// Then the components are placed.  The new transforms are worked out in
+// parallel, and only the ones that moved more than the placement's tolerance
+// are written, parents before children.  Writes go straight to the relative
+// transform and UpdateComponentToWorld, skipping MoveComponent's overlap
+// tests and (with SkipPhysicsUpdate) the physics state, unless the placement
+// asks for them.  That's most of what SetActorLocation costs, per object.
+//
+// Significance:  with an UpdateBudget (microseconds of ephemeris work per
+// frame), not everything is updated every frame.  Each pass scores every
+// slot by significance times staleness and updates the best of them, as
+// many as the budget buys at the measured cost per update;  the rest keep
+// their last state and transform.  A placement with a Radius is fully
+// significant while it subtends SignificantAngle (radius over distance from
+// the viewer) or more, proportionally less below that, and HiddenSignificance
+// while it isn't being rendered.  Whatever's been waiting MaxStaleness goes
+// ahead of everything else, so a debris field of sub-pixel objects is still
+// updated, at a few hertz, while the few on screen update every frame.  The
+// budget gates CSPICE calls (SPK, interpolated knots, orientations) and
+// component writes.  The native SGP4 and two body batches still propagate
+// whole (the worker's lanes cost the same either way), so their states are
+// always fresh for GetState.
+//
+// States are kept in one array, each group's contiguous, in the order they're
+// computed.  The groups (and the scatter order) are only rebuilt when a
+// subscription is added or removed.
+//
+// SGP4 states are Earth centered TEME, and two body states are relative to
+// the elements' center in the elements' frame:  their Observer isn't used,
+// and Frame only names the frame for OrientationFrame.
+//
+// Floating origin:  positions are kilometers in doubles, but everything
+// downstream of the transform (rendering, physics, shaders) works in floats
+// relative to the world origin, which is why scenes end up over-scaled to
+// hide the jitter.  Placements with bFloatingOrigin are placed relative to
+// Origin instead (in their subscription's observer and frame, which they're
+// assumed to share):  (r - Origin) is taken in double precision before it's
+// scaled.  With an origin anchor (the camera, or the pawn carrying it) the
+// origin follows the anchor:  once the anchor is further than RebaseDistance
+// from the world origin, Origin moves to it, the anchor's actor moves back by
+// the same amount, and every floating placement is rewritten in that frame's
+// ordinary batched scatter.  OnOriginRebased says by how much, for anything
+// else placed in world space.  ToWorld and FromWorld convert with the same
+// origin and Scale.
+//
+// Light source:  SetLightSource makes the sun (or any source) one more SPK
+// subscription, so it rides along in its group's SpkposMulti call and is
+// never skipped by the budget.  Each pass points the directional light given
+// (if any) along the light's travel toward the observer;  a point light is
+// an ordinary registration with the source as its target.  GetLightDirection
+// reads the direction light travels at any SPK subscription sharing the
+// source's observer and frame (a subtraction, no SPICE call), so lighting,
+// HUDs and shadows all share the one lookup.  With LT+S as the correction,
+// it's the apparent sun.
+//
+// The pass runs in TickGroup (config, default TG_PrePhysics), at Epoch.
+// Epoch advances by TimeScale ephemeris seconds per second of game time, or,
+// with bFollowSimulationClock, is the simulation clock's step epoch (see
+// SpiceSimulationClock.h), so passes are at quantized epochs that repeat
+// exactly from run to run.
+// CSPICE is called on the game thread.
+//
+// Async (bAsync, config):  each frame's states are computed during the frame
+// before, on the FSpiceExecutor thread, so the CSPICE time overlaps physics,
+// game logic and rendering instead of adding to them.  For that, Epoch runs a
+// frame behind the game clock (it advances by the last frame's DeltaTime), so
+// the next frame's epoch is known as soon as this frame's pass is done:  the
+// tick places this frame's components from the pass started last frame, then
+// starts the next one.  States are double buffered:  GetState, GetOrientation
+// and the placements read the finished pass while the next is written.  If
+// Epoch or TimeScale is changed between frames, the pass in flight is for
+// the wrong epoch:  it's dropped, and that frame's pass runs on the game
+// thread as it would without bAsync.  Register and Unregister wait for the
+// pass in flight.  Since the executor calls CSPICE, the executor rule applies
+// (see SpiceExecutor.h):  nothing else should call CSPICE from the game thread
+// outside the tick.
+//
+// Snapshots:  each pass is also published as an FMaxQEphemerisSnapshot,
+// which is never written again once it's published:  positions (SoA),
+// orientations, validity and the epoch, one per slot, ref counted.  Anything
+// can hold one, on any thread, for as long as it likes (a worker, an RDG
+// pass lambda) without a lock or a copy, and without ever waiting for a pass
+// in flight:  GetSnapshot is the last one presented.  Render proxies take
+// the snapshot channel (GetSnapshotChannel) on the game thread, and read
+// GetRenderThreadSnapshot on the render thread:  each snapshot is handed to
+// the render thread by a render command, so it's the one for the frame
+// being rendered, not the frame the game thread is on.  Snapshots nothing
+// holds any more are reused, so publishing doesn't allocate once the slot
+// count settles.
+//
+// Spatial index:  with SpatialIndexInterval, every that many frames a worker
+// builds an FSpatialIndex (SpiceSpatialIndex.h) over the latest snapshot's
+// positions, and it replaces the last one when it's done.  PickRay,
+// FindWithin and FindNearest query it instead of scanning every object, and
+// GetSpatialIndex hands it to anything else (a conjunction screen's
+// candidate pairs, say).  It's as fresh as the snapshot it was built from,
+// a frame or a few behind.  Positions are taken as they are, so it only
+// makes sense if the subscriptions share an observer and frame (as floating
+// placements already assume).  It needs bPublishSnapshots.
+//
+// Preview:  BeginPreview fits every SPK subscription's target over a span
+// (an FChebyshevCache per observer, frame and correction, to within
+// PreviewTolerance), and from then on SPK states come from the fits, natively
+// and in parallel, instead of from CSPICE.  The kernels are only needed while
+// the fits are built:  after that, any epoch in the span is a few polynomial
+// evaluations per object, so SetPreviewTime (a 0..1 slider over the span) can
+// scrub years of motion.  Subscriptions added since (or outside the fits)
+// still go to CSPICE, as do orientations.  EndPreview drops the fits.
+//
+// Editor worlds get the subsystem too, and UMaxQEphemerisComponents in them
+// subscribe when they're registered.  Nothing is computed there until a
+// preview begins, which registers the tick function in the editor world (it
+// ticks in the viewports-only editor tick while previewing).  So layout can
+// be checked against real positions without PIE:  "MaxQ.Preview <start>
+// <stop>" in the editor's console, then "MaxQ.Preview <0..1>" (or
+// SetPreviewTime from an editor utility widget's slider).  Components are
+// placed as they'd be in game, so the level is saved wherever the preview
+// left them;  play places them again anyway.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Async/Future.h"
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+#include "SpiceSGP4Batch.h"
+#include "SpiceTwoBody.h"
+#include "SpiceName.h"
+#include "SpiceMathBatch.h"
+#include "SpiceSpatialIndex.h"
+#include "SpiceEphemerisCache.h"
+#include "SpiceEphemerisSubsystem.generated.h"
+
+class UMaxQEphemerisSubsystem;
+class USceneComponent;
+class UDirectionalLightComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FMaxQEphemerisUpdatedDelegate);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQEphemerisErrorDelegate, const FString&, ErrorMessage);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQOriginRebasedDelegate, const FVector&, Shift);
+
+
+UENUM(BlueprintType)
+enum class EMaxQPropagation : uint8
+{
+    Spk UMETA(DisplayName = "SPK"),
+    SGP4 UMETA(DisplayName = "SGP4 (Two Line Elements)"),
+    TwoBody UMETA(DisplayName = "Two Body (Conic Elements)")
+};
+
+
+USTRUCT(BlueprintType)
+struct SPICE_API FMaxQEphemerisSubscription
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") EMaxQPropagation Propagation = EMaxQPropagation::Spk;
+
+    // SPK:  spkezr's targ, obs, ref and abcorr
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FString Target = TEXT("EARTH");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FString Observer = TEXT("SSB");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FString Frame = TEXT("ECLIPJ2000");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") ES_AberrationCorrectionWithNewtonians AberrationCorrection = ES_AberrationCorrectionWithNewtonians::None;
+
+    // SPK:  compute velocities too (spkezr instead of spkpos).  SGP4 and two
+    // body states always have them.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") bool bVelocity = false;
+
+    // SPK:  exact states at most this often (ephemeris time), interpolated
+    // between.  0:  exact every pass.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSEphemerisPeriod Interval;
+    // The interpolation error (estimated) the interval shrinks to stay under
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSDistance Tolerance = FSDistance(1.e-3);
+
+    // If set, the component is also rotated by pxform(OrientationFrame, Frame)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FString OrientationFrame;
+
+    // SGP4.  Empty geophysical constants:  getgeophs("EARTH").
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSTwoLineElements TwoLineElements;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSTLEGeophysicalConstants GeophysicalConstants;
+
+    // Two body
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSConicElements ConicElements;
+};
+
+
+UENUM(BlueprintType)
+enum class EMaxQScalePolicy : uint8
+{
+    // The subsystem's Scale
+    Subsystem,
+    // The placement's own Scale
+    Linear,
+    // Scale * ReferenceDistance * ln(1 + distance / ReferenceDistance):
+    // linear close in, compressed far out
+    Logarithmic
+};
+
+
+// How a subscription's component is placed
+USTRUCT(BlueprintType)
+struct SPICE_API FMaxQEphemerisPlacement
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") EMaxQScalePolicy ScalePolicy = EMaxQScalePolicy::Subsystem;
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double Scale = 1.;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSDistance ReferenceDistance = FSDistance(1.e6);
+
+    // Relative to the subsystem's Origin, rather than the observer.  Rebases
+    // convert with the subsystem's Scale, so use the Subsystem policy.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") bool bFloatingOrigin = false;
+
+    // The object's radius, for its significance (how large it is on screen).
+    // 0:  always fully significant.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSDistance Radius;
+
+    // Moves skip overlap and physics updates unless these are set
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") bool bUpdateOverlaps = false;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") bool bUpdatePhysics = false;
+
+    // Moves smaller than this (UE units) aren't written
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double LocationTolerance = 1.e-3;
+};
+
+
+USTRUCT(BlueprintType)
+struct SPICE_API FMaxQEphemerisHandle
+{
+    GENERATED_BODY()
+
+    UPROPERTY() int32 Id = INDEX_NONE;
+
+    bool IsValid() const { return Id != INDEX_NONE; }
+    void Reset() { Id = INDEX_NONE; }
+
+    bool operator==(const FMaxQEphemerisHandle& Other) const { return Id == Other.Id; }
+    bool operator!=(const FMaxQEphemerisHandle& Other) const { return Id != Other.Id; }
+};
+
+
+// One pass, as published.  Immutable:  safe to read from any thread.
+struct SPICE_API FMaxQEphemerisSnapshot
+{
+    // The pass's epoch, and the frame (GFrameCounter) it was presented in
+    FSEphemerisTime Epoch;
+    uint64 Frame = 0;
+
+    // The subsystem's Origin and Scale when it was published (floating
+    // placements are (r - Origin) * Scale)
+    FSDistanceVector Origin;
+    double Scale = 1.;
+
+    // One per slot:  positions (km, in each subscription's observer and
+    // frame), orientations (UE, Identity without an OrientationFrame), and
+    // whether the slot has a state
+    TArray<double> X, Y, Z;
+    TArray<FQuat> Orientations;
+    TArray<uint8> Valid;
+
+    int32 Num() const { return X.Num(); }
+    MaxQ::Math::FConstVectorBatch Positions() const { return MaxQ::Math::FConstVectorBatch(X, Y, Z); }
+
+    // Handle's slot in this snapshot (INDEX_NONE if it isn't in it)
+    int32 Find(const FMaxQEphemerisHandle& Handle) const;
+    // False if Handle isn't in the snapshot, or has no state
+    bool GetPosition(const FMaxQEphemerisHandle& Handle, FSDistanceVector& Position) const;
+
+private:
+    friend class UMaxQEphemerisSubsystem;
+
+    // Handle id -> slot, shared by every snapshot between rebuilds
+    TSharedPtr<const TMap<int32, int32>, ESPMode::ThreadSafe> Slots;
+};
+
+using FMaxQEphemerisSnapshotPtr = TSharedPtr<const FMaxQEphemerisSnapshot, ESPMode::ThreadSafe>;
+
+
+// A spatial index over one snapshot's positions.  Immutable, like the
+// snapshot.
+struct SPICE_API FMaxQEphemerisSpatialIndex
+{
+    FMaxQEphemerisSnapshotPtr Snapshot;
+    // Over Snapshot's valid slots:  hits' indices are slots
+    MaxQ::Math::FSpatialIndex Index;
+    // Slot -> handle id
+    TArray<int32> HandleIds;
+
+    FMaxQEphemerisHandle GetHandle(int32 Slot) const;
+};
+
+using FMaxQEphemerisSpatialIndexPtr = TSharedPtr<const FMaxQEphemerisSpatialIndex, ESPMode::ThreadSafe>;
+
+
+// Carries snapshots to the render thread, in frame order.  Outlives the
+// subsystem, for proxies that do.
+class SPICE_API FMaxQEphemerisSnapshotChannel
+{
+public:
+    // Render thread only.  Null before the first pass, and after the
+    // subsystem is deinitialized.
+    FMaxQEphemerisSnapshotPtr GetRenderThreadSnapshot() const;
+
+private:
+    friend class UMaxQEphemerisSubsystem;
+
+    FMaxQEphemerisSnapshotPtr RenderThreadSnapshot;
+};
+
+
+USTRUCT()
+struct FMaxQEphemerisTickFunction : public FTickFunction
+{
+    GENERATED_BODY()
+
+    UMaxQEphemerisSubsystem* Subsystem = nullptr;
+
+    virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+    virtual FString DiagnosticMessage() override;
+    virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMaxQEphemerisTickFunction> : public TStructOpsTypeTraitsBase2<FMaxQEphemerisTickFunction>
+{
+    enum
+    {
+        WithCopy = false
+    };
+};
+
+
+UCLASS(Config = Game)
+class SPICE_API UMaxQEphemerisSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // The epoch states are computed for
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSEphemerisTime Epoch;
+    // Ephemeris seconds per second of game time (0:  Epoch only changes when set)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double TimeScale = 0.;
+    // Epoch is UMaxQSimulationClockSubsystem's step epoch (TimeScale unused)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") bool bFollowSimulationClock = false;
+
+    // UE units per km, for placing components
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double Scale = 1.;
+
+    // Subtracted (km, double precision) from floating placements' positions
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSDistanceVector Origin;
+    // Rebase when the origin anchor is further than this (UE units) from the
+    // world origin.  0:  never.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double RebaseDistance = 1.e6;
+
+    // Microseconds per frame of ephemeris work (CSPICE and component writes)
+    // for exact updates.  0:  everything, every frame.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double UpdateBudget = 0.;
+    // Placements subtending this (radians, radius over distance) or more are
+    // fully significant
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double SignificantAngle = 5.e-3;
+    // The significance of a placement that isn't being rendered
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double HiddenSignificance = 0.05;
+    // Anything this stale (seconds of game time) is updated first
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") double MaxStaleness = 5.;
+
+    // Compute each frame's states during the frame before, on the executor
+    UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") bool bAsync = false;
+    // Publish each pass as a snapshot (GetSnapshot, and the render thread)
+    UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") bool bPublishSnapshots = true;
+    // Frames between spatial index builds (PickRay, FindWithin, FindNearest).
+    // 0:  no index.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") int32 SpatialIndexInterval = 0;
+
+    // The preview fits' position tolerance, per block
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Ephemeris") FSDistance PreviewTolerance = FSDistance(1.);
+
+    // Takes effect when the world begins play, or through SetTickGroup
+    UPROPERTY(Config, EditAnywhere, BlueprintReadOnly, Category = "MaxQ|Ephemeris") TEnumAsByte<ETickingGroup> TickGroup = TG_PrePhysics;
+
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Ephemeris") FMaxQEphemerisUpdatedDelegate OnUpdated;
+    // At most once per frame, with the first error of the pass
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Ephemeris") FMaxQEphemerisErrorDelegate OnError;
+    // After a rebase moved the world by -Shift (UE units)
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Ephemeris") FMaxQOriginRebasedDelegate OnOriginRebased;
+
+    // Component (optional) is placed at the state's position, relative to its
+    // parent, so attach it to whatever sits at the observer in Frame.  It's
+    // held weakly:  a destroyed component just stops being placed.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris", meta = (AutoCreateRefTerm = "Placement"))
+    FMaxQEphemerisHandle Register(const FMaxQEphemerisSubscription& Subscription, USceneComponent* Component, const FMaxQEphemerisPlacement& Placement);
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void Unregister(UPARAM(ref) FMaxQEphemerisHandle& Handle);
+
+    // The state from the last pass (SPICE units, RHS).  False if it hasn't
+    // been computed yet, or failed.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool GetState(const FMaxQEphemerisHandle& Handle, FSStateVector& State) const;
+
+    // Identity without an OrientationFrame
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool GetOrientation(const FMaxQEphemerisHandle& Handle, FSRotationMatrix& Orientation) const;
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void SetTickGroup(ETickingGroup NewTickGroup);
+
+    // Source as seen from Observer, in Frame.  Light (optional, held weakly)
+    // is pointed from the source toward the observer each pass.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void SetLightSource(const FString& Source, const FString& Observer, const FString& Frame, ES_AberrationCorrectionWithNewtonians AberrationCorrection, UDirectionalLightComponent* Light);
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void ClearLightSource();
+
+    // The source's position relative to its observer, from the last pass
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool GetLightSourcePosition(FSDistanceVector& Position) const;
+
+    // The direction light travels (from the source, UE coordinates, unit) at
+    // Handle's object, and its distance from the source.  An invalid Handle
+    // means the observer.  False unless Handle is an SPK subscription with
+    // the source's observer and frame, and both have states.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool GetLightDirection(const FMaxQEphemerisHandle& Handle, FVector& Direction, FSDistance& Distance) const;
+
+    // The origin follows Anchor (held weakly; null:  Origin only changes
+    // when set)
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void SetOriginAnchor(USceneComponent* Anchor);
+
+    // Moves Origin to the world location Location, now.  The anchor's actor
+    // (if any) moves with the world.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void Rebase(const FVector& Location);
+
+    // Significance is measured from Viewer (held weakly; null:  the first
+    // player's camera)
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void SetSignificanceViewer(USceneComponent* Viewer);
+
+    // A position (km, floating placements' frame) to UE, and back
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Ephemeris")
+    FVector ToWorld(const FSDistanceVector& Position) const;
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Ephemeris")
+    FSDistanceVector FromWorld(const FVector& Location) const;
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Ephemeris")
+    int32 Num() const { return Subscriptions.Num(); }
+
+    // The object nearest the ray's origin (UE) within AngleTolerance
+    // (radians) of it:  the one under the cursor, for a pixel's angle.  False
+    // without an index, or a hit.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool PickRay(const FVector& WorldOrigin, const FVector& WorldDirection, double AngleTolerance, FMaxQEphemerisHandle& Handle, FSDistance& Distance) const;
+
+    // Everything within Radius of Center (km, the subscriptions' observer
+    // and frame), nearest first
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool FindWithin(const FSDistanceVector& Center, const FSDistance& Radius, TArray<FMaxQEphemerisHandle>& Handles) const;
+
+    // The Count objects nearest Center, nearest first
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool FindNearest(const FSDistanceVector& Center, int32 Count, TArray<FMaxQEphemerisHandle>& Handles) const;
+
+    // Fits every SPK subscription over [Start, Stop] (CSPICE, on the game
+    // thread), and computes them from the fits from then on.  Epoch moves
+    // into the span.  False (with OnError) if any fit fails:  nothing is
+    // previewed.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    bool BeginPreview(const FSEphemerisTime& Start, const FSEphemerisTime& Stop);
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void EndPreview();
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Ephemeris")
+    bool IsPreviewing() const { return bPreviewing; }
+
+    // The time slider:  Epoch = Start + Alpha (Stop - Start), Alpha clamped
+    // to [0, 1]
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Ephemeris")
+    void SetPreviewTime(double Alpha);
+
+    // The last pass presented (null before the first).  Hold it as long as
+    // you like, on any thread.
+    FMaxQEphemerisSnapshotPtr GetSnapshot() const { return Snapshot; }
+
+    // Take it on the game thread (creating a scene proxy, say), then read
+    // GetRenderThreadSnapshot from the render thread
+    TSharedRef<FMaxQEphemerisSnapshotChannel, ESPMode::ThreadSafe> GetSnapshotChannel() const { return SnapshotChannel; }
+
+    // The last spatial index built (null without SpatialIndexInterval, or
+    // before the first is done).  Holding it holds its snapshot.
+    FMaxQEphemerisSpatialIndexPtr GetSpatialIndex() const { return SpatialIndex; }
+
+    // Computes and places everything now, whatever the tick group
+    void Update(float DeltaTime = 0.f);
+
+    virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+
+private:
+    // An interpolated SPK subscription's knots
+    struct FDecimation
+    {
+        FSpiceName Target;
+        FSpiceName Observer;
+        FSpiceName Frame;
+
+        // The current knot spacing (adapts, up to the subscription's Interval)
+        double Interval = 0.;
+
+        bool bKnots = false;
+        double t0 = 0.;
+        double t1 = 0.;
+        FSStateVector s0;
+        FSStateVector s1;
+
+        // The last knot interval's third derivative (km/s^3)
+        bool bJerk = false;
+        double Jerk[3] = {};
+    };
+
+    struct FEntry
+    {
+        FMaxQEphemerisSubscription Subscription;
+        TWeakObjectPtr<USceneComponent> Component;
+        FMaxQEphemerisPlacement Placement;
+        // SGP4:  initialized once, at registration
+        MaxQ::Orbits::FSGP4Propagator Propagator;
+        // SPK with an Interval
+        FDecimation Decimation;
+        int32 Slot = INDEX_NONE;
+    };
+
+    // SPK subscriptions sharing an observer, frame and correction:
+    // slots [Begin, Begin + Targets.Num())
+    struct FSpkGroup
+    {
+        FString Observer;
+        FString Frame;
+        ES_AberrationCorrectionWithNewtonians AberrationCorrection = ES_AberrationCorrectionWithNewtonians::None;
+        bool bVelocity = false;
+        TArray<FString> Targets;
+        int32 Begin = 0;
+    };
+
+    // A previewed slot's fit
+    struct FPreviewSlot
+    {
+        int32 Slot = INDEX_NONE;
+        const MaxQ::Ephemeris::FChebyshevCache* Cache = nullptr;
+        int32 Body = INDEX_NONE;
+    };
+
+    struct FOrientation
+    {
+        int32 Slot = INDEX_NONE;
+        FString From;
+        FString To;
+    };
+
+    // What a pass writes, one per slot (the back buffer of States etc)
+    struct FPass
+    {
+        TArray<FSStateVector> States;
+        TArray<FSRotationMatrix> Rotations;
+        TArray<FQuat> Quats;
+        TArray<bool> Valid;
+        FString Error;
+        // How long it took (wherever it ran)
+        double Seconds = 0.;
+    };
+
+    void RegisterTickFunction(UWorld& InWorld);
+    void Rebuild();
+    void Schedule();
+    bool GetViewLocation(FVector& Location) const;
+    void Propagate(const FSEphemerisTime& et);
+    void Present();
+    void WaitForPass();
+    void Scatter();
+    bool Interpolate(FEntry& Entry, double et, FString& ErrorMessage);
+    void FollowAnchor();
+    void AimLight();
+    void Publish();
+    void UpdateSpatialIndex();
+    void ReportError(const FString& ErrorMessage);
+
+    FMaxQEphemerisTickFunction TickFunction;
+    TWeakObjectPtr<USceneComponent> OriginAnchor;
+    TWeakObjectPtr<USceneComponent> SignificanceViewer;
+
+    FMaxQEphemerisHandle LightSource;
+    TWeakObjectPtr<UDirectionalLightComponent> DirectionalLight;
+
+    TMap<int32, FEntry> Subscriptions;
+    int32 NextId = 0;
+    bool bDirty = false;
+
+    // Rebuilt with the subscriptions (slot order)
+    TArray<FSpkGroup> SpkGroups;
+    TArray<FEntry*> Interpolated;
+    TArray<FPreviewSlot> PreviewSlots;
+    int32 SGP4Begin = 0;
+    int32 TwoBodyBegin = 0;
+    MaxQ::Orbits::FSGP4BatchPropagator SGP4;
+    MaxQ::Orbits::FTwoBodyBatchPropagator TwoBody;
+    TArray<FOrientation> Orientations;
+    TArray<TWeakObjectPtr<USceneComponent>> Components;
+    TArray<FMaxQEphemerisPlacement> Placements;
+    TArray<bool> Oriented;
+    TArray<uint8> Previewed;
+    // Slots with components, parents before children
+    TArray<int32> ScatterOrder;
+
+    // One per ScatterOrder entry:  what was last written, and what's next
+    TArray<FVector> WrittenLocations;
+    TArray<FQuat> WrittenRotations;
+    TArray<FVector> PendingLocations;
+    TArray<FQuat> PendingRotations;
+    TArray<uint8> Pending;
+
+    // One per slot, from the last pass
+    TArray<FSStateVector> States;
+    TArray<FSRotationMatrix> Rotations;
+    TArray<FQuat> Quats;
+    TArray<bool> Valid;
+
+    // Scheduling, one per slot:  when each was last updated (Clock), its
+    // priority bucket, and whether it's updated this pass
+    TArray<double> LastUpdated;
+    TArray<uint8> Buckets;
+    TArray<uint8> Due;
+    int32 NumDue = 0;
+    // Game seconds, and game thread microseconds per update (smoothed)
+    double Clock = 0.;
+    double CostPerUpdate = 2.;
+    // Rebased since the last scatter:  every floating placement is rewritten
+    bool bRebased = false;
+
+    // A group's due targets
+    TArray<FString> DueTargets;
+    TArray<int32> DueSlots;
+    TArray<FSStateVector> DueStates;
+
+    // The pass being computed, and (bAsync) the future it's computed in
+    FPass Back;
+    TFuture<void> InFlight;
+    bool bAhead = false;
+    FSEphemerisTime AheadEpoch;
+    float LastDeltaTime = 0.f;
+
+    MaxQ::Orbits::FSGP4CatalogStates SGP4States;
+    FString PassError;
+
+    // Published snapshots:  the last one, the handle -> slot map (rebuilt with
+    // the slots), and the ones that can be reused once nothing else holds them
+    FMaxQEphemerisSnapshotPtr Snapshot;
+    TSharedPtr<const TMap<int32, int32>, ESPMode::ThreadSafe> SnapshotSlots;
+    TArray<TSharedPtr<FMaxQEphemerisSnapshot, ESPMode::ThreadSafe>> SnapshotPool;
+    TSharedRef<FMaxQEphemerisSnapshotChannel, ESPMode::ThreadSafe> SnapshotChannel = MakeShared<FMaxQEphemerisSnapshotChannel, ESPMode::ThreadSafe>();
+
+    // The last spatial index, the one being built, and frames since the last
+    // build started
+    FMaxQEphemerisSpatialIndexPtr SpatialIndex;
+    TFuture<FMaxQEphemerisSpatialIndexPtr> SpatialIndexInFlight;
+    int32 FramesSinceSpatialIndex = 0;
+
+    // The preview's fits, by SPK group key, and its span
+    TMap<FString, MaxQ::Ephemeris::FChebyshevCache> PreviewCaches;
+    bool bPreviewing = false;
+    FSEphemerisTime PreviewStart;
+    FSEphemerisTime PreviewStop;
+};
@@ -0,0 +1,95 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceEquinoctialPropagator.h
+//
+// API Comments
+//
+// Purpose:  eqncpv (equinoctial element) propagation of many objects at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceEquinoctialPropagator.h is part of the "refined C++ API".
+//
+// Equinoctial elements stay well defined for the near circular, near
+// equatorial orbits of the GEO belt, where conics' node and periapsis
+// don't.  USpice::eqncpv evaluates one set per call, through CSPICE's error
+// system.  FEquinoctialBatchPropagator evaluates eqncpv's model for a whole
+// catalog, natively:  the elements are kept in structure-of-arrays columns
+// and evaluated MAXQ_TWOBODY_LANES at a time, with ParallelFor across the
+// batch, as FSecularBatchPropagator does.  Every object shares one pole
+// (eqncpv's rapol/decpol), and each has its own epoch.
+//
+// Kepler's equation is solved as kepleq/kpsolv solve it (bisection, then
+// five Newton steps), so states match eqncpv's to rounding.  Propagate
+// doesn't touch CSPICE, so it's safe from any thread.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceTwoBody.h"
+
+namespace MaxQ::Orbits
+{
+    class SPICE_API FEquinoctialBatchPropagator
+    {
+    public:
+        static constexpr int32 Lanes = MAXQ_TWOBODY_LANES;
+
+        // Replaces anything already built.  Entry i of Elements (and of
+        // Epochs, which is as long) is entry i of the propagation outputs.
+        // rapol/decpol:  the right ascension and declination of the pole
+        // the elements are referenced to, as eqncpv.
+        void Build(
+            TArrayView<const FSEquinoctialElements> Elements,
+            TArrayView<const FSEphemerisTime> Epochs,
+            const FSAngle& rapol,
+            const FSAngle& decpol
+        );
+        void Reset();
+
+        int32 Num() const { return NumObjects; }
+        // False for elements eqncpv would signal an error for (a
+        // non-positive semi-major axis, or an eccentricity of 0.9 or more)
+        bool IsValid(int32 i) const { return Valid[i]; }
+        SIZE_T GetAllocatedSize() const;
+
+        // OutStates must have Num() entries, in the frame of the pole.
+        // Invalid entries are zeroed.  Returns the number of objects
+        // propagated.
+        int32 Propagate(const FSEphemerisTime& et, TArrayView<FSStateVector> OutStates) const;
+
+    private:
+        enum EColumn : int32
+        {
+            sma, h0, k0, meanlong0, p0, q0,
+            // dargp/dt + dnode/dt, dmeanlong/dt, dnode/dt
+            lprate, mlrate, noderate,
+            epoch,
+            NumColumns
+        };
+
+        double* Column(EColumn c) { return &Columns[c * Rows]; }
+        const double* Column(EColumn c) const { return &Columns[c * Rows]; }
+
+        // NumColumns x Rows, column-major.  Rows is a multiple of Lanes.
+        TArray<double> Columns;
+        int32 Rows = 0;
+
+        // The pole's frame (eqncpv's TRANS), row-major
+        double Trans[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+
+        TArray<bool> Valid;
+        int32 NumObjects = 0;
+    };
+}
@@ -0,0 +1,109 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceErrorBatch.h
+//
+// API Comments
+//
+// Purpose:  Scoped error accumulation for loops over many SPICE calls.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceErrorBatch.h is part of the "refined C++ API".
+//
+// Every failed call fetches and formats SPICE's long message, logs a warning,
+// and prints the script callstack.  That's what you want for one call, but a
+// loop over thousands of epochs that fall outside of coverage can spend
+// seconds doing it.
+//
+// While an FSpiceErrorBatch is in scope (on the thread that makes the SPICE
+// calls), failures are recorded per item (see SetItem) instead.  Only the
+// first MaxMessages failures get the long message;  after that, the
+// ErrorMessage a call returns is the short message (e.g.
+// "SPICE(SPKINSUFFDATA)"), which costs a fraction as much.  Only the first
+// MaxLogged failures are logged, and, when the batch goes out of scope, one
+// line summarizes the rest.
+//
+// ResultCodes are unaffected:  every call still reports whether it failed.
+// Batches nest;  the innermost one records.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "Containers/BitArray.h"
+
+namespace MaxQ::Private
+{
+    uint8 ErrorCheck(ES_ResultCode& ResultCode, FString& ErrorMessage, bool BeQuiet);
+}
+
+namespace MaxQ::Core
+{
+    struct FSpiceErrorBatchSettings
+    {
+        // Failures that get SPICE's long message
+        int32 MaxMessages = 8;
+        // Failures that are logged (the first also logs the script callstack)
+        int32 MaxLogged = 1;
+    };
+
+    class SPICE_API FSpiceErrorBatch
+    {
+    public:
+        struct FFailure
+        {
+            // INDEX_NONE if no item was set
+            int32 Item;
+            FString Message;
+        };
+
+        // NumItems presizes the per-item record;  it grows as needed.
+        FSpiceErrorBatch(int32 NumItems = 0, const FSpiceErrorBatchSettings& Settings = FSpiceErrorBatchSettings());
+        ~FSpiceErrorBatch();
+
+        // Failures from here on are attributed to item Index
+        void SetItem(int32 Index);
+
+        // Failed calls (an item can fail more than once)
+        int32 NumFailures() const { return FailureCount; }
+        // Items with at least one failure.
+        int32 NumFailedItems() const { return FailedItems.CountSetBits(); }
+        bool Failed(int32 Index) const { return FailedItems.IsValidIndex(Index) && FailedItems[Index]; }
+        const TBitArray<>& Failures() const { return FailedItems; }
+
+        // The first MaxMessages failures, with their long messages
+        const TArray<FFailure>& Messages() const { return FirstFailures; }
+
+        // The innermost batch on this thread, if any
+        static FSpiceErrorBatch* Current();
+
+        FSpiceErrorBatch(const FSpiceErrorBatch&) = delete;
+        FSpiceErrorBatch& operator=(const FSpiceErrorBatch&) = delete;
+
+    private:
+        friend uint8 MaxQ::Private::ErrorCheck(ES_ResultCode& ResultCode, FString& ErrorMessage, bool BeQuiet);
+
+        // With SPICE in the failed state:  record, and fill in ErrorMessage
+        void Record(FString& ErrorMessage, bool BeQuiet);
+
+        FSpiceErrorBatchSettings Settings;
+        FSpiceErrorBatch* Outer = nullptr;
+
+        int32 Item = INDEX_NONE;
+        TBitArray<> FailedItems;
+        TArray<FFailure> FirstFailures;
+        int32 FailureCount = 0;
+        int32 LoggedCount = 0;
+        int32 UnloggedCount = 0;
+    };
+}
@@ -0,0 +1,122 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceExecutor.h
+//
+// API Comments
+//
+// Purpose:  Runs CSPICE work on one dedicated worker thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceExecutor.h is part of the "refined C++ API".
+//
+// CSPICE is not re-entrant.  It keeps global state (the error subsystem,
+// the kernel pool, DAF/DAS file tables, etc), so all CSPICE calls must come
+// from one thread at a time.  Each command runs inside an FSpiceScope
+// (SpiceLock.h), so workers that take one are excluded while it runs.
+//
+// FSpiceExecutor gives CSPICE a thread of its own.  Any thread may enqueue
+// commands (the queue is lock-free, multiple producers/single consumer), and
+// each command's result comes back as a TFuture.
+//
+// Rule of thumb:  once you use the executor, *all* SPICE calls should go
+// through it (including furnsh/unload, etc).  Calling USpice:: directly from
+// the game thread while the executor is busy is a race.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Async.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FRunnableThread;
+class FEvent;
+
+class SPICE_API FSpiceExecutor : public FRunnable
+{
+public:
+    typedef TUniqueFunction<void()> FCommand;
+
+    // Lazily starts the executor thread on first use.
+    static FSpiceExecutor& Get();
+
+    // Stops the executor thread (after draining queued commands, which
+    // still run as on the executor thread).  Called by the Spice module at
+    // shutdown.  Commands enqueued while it's stopping run inline, on the
+    // enqueuing thread.
+    // Must not race producers:  it deletes the executor, so every thread
+    // that may still hold a reference from Get() must be done with it first.
+    static void Shutdown();
+
+    static bool IsRunning();
+
+    // True if the caller is running on the executor's thread.
+    static bool IsInExecutorThread();
+
+    // Enqueue a single command.  The future is fulfilled with the command's
+    // return value after it executes on the executor thread.
+    template<typename CommandType>
+    auto Enqueue(CommandType&& Command) -> TFuture<decltype(Command())>
+    {
+        typedef decltype(Command()) ResultType;
+
+        TSharedRef<TPromise<ResultType>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<ResultType>, ESPMode::ThreadSafe>();
+        TFuture<ResultType> Future = Promise->GetFuture();
+
+        EnqueueCommand(
+            [Promise, Command = Forward<CommandType>(Command)]() mutable
+            {
+                SetPromiseValue(*Promise, Command);
+            }
+        );
+
+        return Future;
+    }
+
+    // Enqueue a batch of commands.  The batch is executed back-to-back,
+    // in order, without interleaving commands from other producers.
+    // The future is fulfilled after the last command in the batch executes.
+    TFuture<void> EnqueueBatch(TArray<FCommand>&& Commands);
+
+    // Fire-and-forget.
+    void EnqueueCommand(FCommand&& Command);
+
+    // FRunnable
+    virtual bool Init() override;
+    virtual uint32 Run() override;
+    virtual void Stop() override;
+    virtual void Exit() override;
+
+    virtual ~FSpiceExecutor();
+
+private:
+    FSpiceExecutor();
+
+    void Start();
+    void StopThread();
+    void DrainQueue();
+
+    TQueue<FCommand, EQueueMode::Mpsc> CommandQueue;
+    FEvent* WorkAvailable;
+    FRunnableThread* Thread;
+    TAtomic<bool> bStopRequested;
+    // Set by the executor thread itself, in Init, before it can dequeue
+    std::atomic<uint32> ThreadId;
+
+    static std::atomic<FSpiceExecutor*> Instance;
+    static FCriticalSection InstanceLock;
+};
@@ -0,0 +1,173 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFlightRecorderComponent.h
+//
+// API Comments
+//
+// Purpose:  Records an actor's trajectory and attitude to SPK and CK files.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFlightRecorderComponent.h is part of the "Blueprints API".
+//
+// Gameplay objects (a player's ship, Sample05's bumped objects) have no
+// kernels.  To replay one, or look at it afterwards with SPICE tools, its
+// states have to be collected and written with spkopn/spkw../spkcls.
+// UMaxQFlightRecorderComponent does that while the game runs.
+//
+// Samples go into a ring buffer on the game thread, either the owner's
+// (every SampleInterval of ephemeris time, from its transform relative to
+// its attach parent, as UMaxQEphemerisComponent places it) or whatever
+// Record is given.  Every FlushSamples samples, the new ones are copied out
+// and written by FSpkSegmentWriter and FCkSegmentWriter on the
+// FSpiceExecutor thread, which also opens and closes the files.  The game
+// thread never calls CSPICE for the recording, and never waits for it.  The
+// last RingCapacity samples stay in the ring, for replays that don't need
+// the files.
+//
+// Owner samples get their velocities from the previous sample (the first
+// has none), so the default SPK type is 09, which interpolates positions
+// from positions alone.  States given to Record are written as they are.
+//
+// The CK's encoded SCLK times come from sce2c(SclkId), so the spacecraft
+// clock's SCLK kernel has to be loaded.  Empty CkPath records no attitude.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SpiceTypes.h"
+#include "SpiceFlightRecorderComponent.generated.h"
+
+USTRUCT(BlueprintType)
+struct SPICE_API FMaxQFlightSample
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") FSEphemerisTime et;
+    // Relative to Center, in Frame
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") FSStateVector State;
+    // Frame to the spacecraft (a C-matrix)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") FSQuaternion Orientation;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FMaxQRecorderFinishedDelegate);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQRecorderErrorDelegate, const FString&, ErrorMessage);
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API UMaxQFlightRecorderComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQFlightRecorderComponent();
+
+    // Project-relative paths, as Furnsh.  Empty CkPath:  no attitude.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") FString SpkPath;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") FString CkPath;
+    // Replace existing files (spkopn/ckopn won't)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") bool bOverwrite = true;
+
+    // The recorded object, and what its states are relative to
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") int32 Body = -999;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") int32 Center = 399;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") FString Frame = TEXT("J2000");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") FString SegmentId = TEXT("MAXQ FLIGHT RECORDER");
+
+    // SPK type 13 (Hermite:  uses the velocities) rather than 09 (Lagrange)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") bool bHermite = false;
+    // Interpolation degree (odd, for type 13)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") int32 Degree = 7;
+
+    // The CK's structure ID, and the spacecraft clock's
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") int32 Instrument = -999000;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") int32 SclkId = -999;
+
+    // Sample the owner's transform each SampleInterval (ephemeris seconds)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") bool bSampleOwner = true;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") double SampleInterval = 60.;
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") double Scale = 1.;
+
+    // The epoch to sample at, unless bFollowSubsystem
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") FSEphemerisTime Epoch;
+    // Use the world's UMaxQEphemerisSubsystem's Epoch
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") bool bFollowSubsystem = true;
+
+    // Samples kept on the game thread
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") int32 RingCapacity = 4096;
+    // Samples handed to the writers at a time (at most RingCapacity)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") int32 FlushSamples = 1024;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Recorder") bool bRecordOnBeginPlay = false;
+
+    // Once the files are closed
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Recorder") FMaxQRecorderFinishedDelegate OnFinished;
+    // The first failure of a recording (which stops writing it)
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Recorder") FMaxQRecorderErrorDelegate OnError;
+
+    // Opens the files (on the executor).  False if already recording.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder")
+    bool StartRecording();
+
+    // Writes what's left, and closes the files (on the executor)
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder")
+    void StopRecording();
+
+    // Epochs must increase.  Samples that don't are dropped (false).
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder")
+    bool Record(const FSEphemerisTime& et, const FSStateVector& State, const FSQuaternion& Orientation);
+
+    // Hands the samples not yet written to the writers
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder")
+    void Flush();
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Recorder")
+    bool IsRecording() const { return bRecording; }
+
+    // Samples recorded since StartRecording
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Recorder")
+    int32 NumRecorded() const { return Recorded; }
+
+    // The ring, oldest first
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Recorder")
+    void GetRecentSamples(TArray<FMaxQFlightSample>& Samples) const;
+
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+    struct FSession;
+
+    void SampleOwner(const FSEphemerisTime& et);
+    void Send();
+    void Poll();
+
+    // Only touched on the executor (but for its status), once queued
+    TSharedPtr<FSession, ESPMode::ThreadSafe> Session;
+    // Stopped, and waiting for the files to close
+    TArray<TSharedPtr<FSession, ESPMode::ThreadSafe>> Closing;
+
+    TArray<FMaxQFlightSample> Ring;
+    // The oldest sample's slot
+    int32 RingStart = 0;
+    int32 RingNum = 0;
+    // How many of the newest samples haven't been sent
+    int32 Unsent = 0;
+
+    int32 Recorded = 0;
+    bool bRecording = false;
+};
@@ -0,0 +1,70 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFormat.h
+//
+// API Comments
+//
+// Purpose:  Formatting values into caller owned string builders.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFormat.h is part of the "refined C++ API".
+//
+// USpiceTypes::FormatDistance, FormatAngle etc return a new FString each,
+// built through a string stream and a temporary or two:  fine for a log
+// line, but a telemetry panel showing hundreds of values churns the
+// allocator every frame.  These append to an FStringBuilderBase instead (a
+// TStringBuilder on the stack, or one kept between frames), so formatting
+// doesn't allocate once the builder has room.
+//
+// The output is the FString versions' (they're implemented with these), with
+// one difference:  precision is honored.  It defaults to
+// USpiceTypes::FloatFormatPrecision, which is what the FString versions have
+// always printed, whatever precision they were given.
+//
+// AppendFixed formats in integer arithmetic when the value fits, rather than
+// through printf, with printf's result.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/StringBuilder.h"
+#include "SpiceTypes.h"
+
+namespace MaxQ::Format
+{
+    // As a stream with setprecision(precision) (printf's %.*g)
+    SPICE_API void AppendDouble(FStringBuilderBase& sb, double value, int32 precision = USpiceTypes::FloatFormatPrecision);
+
+    // decimals digits after the point (printf's %.*f)
+    SPICE_API void AppendFixed(FStringBuilderBase& sb, double value, int32 decimals);
+
+    SPICE_API void AppendAngle(FStringBuilderBase& sb, const FSAngle& value, ES_AngleFormat format = ES_AngleFormat::DD, int32 precision = USpiceTypes::FloatFormatPrecision);
+    SPICE_API void AppendLonLat(FStringBuilderBase& sb, const FSLonLat& value, FStringView separator = TEXT(", "), ES_AngleFormat format = ES_AngleFormat::DD, int32 precision = USpiceTypes::FloatFormatPrecision);
+    SPICE_API void AppendRADec(FStringBuilderBase& sb, const FSAngle& rightAscension, const FSAngle& declination, FStringView separator = TEXT(", "), int32 precision = USpiceTypes::FloatFormatPrecision);
+
+    // Units other than the defaults are converted with convrt_c
+    SPICE_API void AppendDistance(FStringBuilderBase& sb, const FSDistance& distance, ES_Units Units = ES_Units::KILOMETERS, int32 precision = USpiceTypes::FloatFormatPrecision);
+    SPICE_API void AppendPeriod(FStringBuilderBase& sb, const FSEphemerisPeriod& period, ES_Units Units = ES_Units::SECONDS, int32 precision = USpiceTypes::FloatFormatPrecision);
+    SPICE_API void AppendSpeed(FStringBuilderBase& sb, const FSSpeed& speed, ES_Units NumeratorUnits = ES_Units::KILOMETERS, ES_Units DenominatorUnits = ES_Units::SECONDS, int32 precision = USpiceTypes::FloatFormatPrecision);
+
+    // As USpiceTypes::FormatUtcTime
+    SPICE_API void AppendUtcTime(FStringBuilderBase& sb, const FSEphemerisTime& et, ES_UTCTimeFormat TimeFormat = ES_UTCTimeFormat::Calendar, int32 precision = 4);
+
+    // As the structs' ToString:  "(x, y, z)", and "[(x, y, z); (dx, dy, dz)]"
+    SPICE_API void Append(FStringBuilderBase& sb, const FSDistanceVector& value);
+    SPICE_API void Append(FStringBuilderBase& sb, const FSVelocityVector& value);
+    SPICE_API void Append(FStringBuilderBase& sb, const FSDimensionlessVector& value);
+    SPICE_API void Append(FStringBuilderBase& sb, const FSStateVector& value);
+}
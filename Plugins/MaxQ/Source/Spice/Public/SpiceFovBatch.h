@@ -0,0 +1,128 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFovBatch.h
+//
+// API Comments
+//
+// Purpose:  Field of view tests for many targets, against many instruments.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFovBatch.h is part of the "refined C++ API".
+//
+// USpice::fovray and fovtrg read the instrument's FOV from the kernel pool
+// (getfov), and set it up, on every call.  FInstrumentFov does that once:
+// Load reads getfov's shape and boundary (CSPICE), and keeps what the test
+// needs.  Circles are a cone angle, ellipses their semi-axes in the FOV
+// plane, and convex polygons (and rectangles) a half-space per edge.
+// Non-convex polygons use fovray's winding number test instead.
+//
+// After that, Visible tests any number of directions, or target positions,
+// natively, in parallel, from any thread.  FovVisibility tests one batch of
+// targets against up to 64 instruments and returns a bit per instrument.
+//
+// The targets are points (fovtrg's POINT shape), geometric:  correct the
+// positions (or the instrument's attitude) for light time first, if that
+// matters at the ranges involved.  The test is fovray's:  a direction is in
+// a FOV if it's within the FOV's bounding cone, and then within its shape.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Math
+{
+    class SPICE_API FInstrumentFov
+    {
+    public:
+        // getfov, for the instrument's ID, or name.  Uses CSPICE.
+        bool Load(int instid, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+        bool Load(const FString& inst, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        // getfov's outputs, from anywhere.  Native.
+        bool Set(
+            const FString& shape,
+            const FString& frame,
+            const FSDimensionlessVector& bsight,
+            TArrayView<const FSDimensionlessVector> bounds,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Direction in the instrument's frame
+        bool Contains(double x, double y, double z) const;
+        bool Contains(const FSDimensionlessVector& dir) const { return Contains(dir.x, dir.y, dir.z); }
+
+        // Directions in the instrument's frame.  bVisible[i] is 1 if
+        // Directions[i] is in the FOV.
+        void Visible(const FConstVectorBatch& Directions, TArrayView<uint8> bVisible) const;
+
+        // Target positions, relative to anything, in any frame.  Observer:
+        // the instrument's position relative to the same thing, same frame.
+        // ToInstrument:  that frame to the instrument's (pxform/ck result).
+        void Visible(
+            const FSDistanceVector& Observer,
+            const FSRotationMatrix& ToInstrument,
+            const FConstVectorBatch& Targets,
+            TArrayView<uint8> bVisible
+        ) const;
+
+        bool IsValid() const { return Shape != EShape::None; }
+        const FString& Frame() const { return FrameName; }
+
+    private:
+        enum class EShape : uint8
+        {
+            None,
+            Circle,
+            Ellipse,
+            ConvexPolygon,
+            Polygon
+        };
+
+        EShape Shape = EShape::None;
+        FString FrameName;
+
+        // fovray's FOV axis (unit), and cosine of its bounding cone's angle
+        double Axis[3] = { 0., 0., 1. };
+        double CosRadius = 1.;
+
+        // FOV plane basis:  unit vectors orthogonal to Axis.  For ellipses,
+        // along the semi-axes, with their lengths (at unit distance).
+        double U[3] = { 1., 0., 0. };
+        double V[3] = { 0., 1., 0. };
+        double SemiU = 0., SemiV = 0.;
+
+        // ConvexPolygon:  inward edge normals, x, y, z per edge
+        TArray<double> Planes;
+        // Polygon:  vertices in the FOV plane, u, v per vertex
+        TArray<double> Vertices;
+    };
+
+    struct FFovSensor
+    {
+        const FInstrumentFov* Fov = nullptr;
+        FSDistanceVector Observer;
+        FSRotationMatrix ToInstrument;
+    };
+
+    // Masks[i] bit s is set if target i is in Sensors[s]'s FOV.  False (and
+    // no masks) if there are more than 64 sensors, or a sensor has no FOV.
+    SPICE_API bool FovVisibility(
+        TArrayView<const FFovSensor> Sensors,
+        const FConstVectorBatch& Targets,
+        TArrayView<uint64> Masks
+    );
+}
@@ -0,0 +1,164 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFrameHandle.h
+//
+// API Comments
+//
+// Purpose:  Precompiled (from, to) frame transformations.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFrameHandle.h is part of the "refined C++ API".
+//
+// pxform/sxform resolve both frame names and walk the frame tree on every
+// call.  A frame handle walks it once, into a chain of links per side:
+//    * fixed rotations (inertial and TK frames), multiplied together
+//    * PCK frames (FPckOrientation for text PCKs, else tipbod/tisbod)
+//    * CK frames (ckfrot/ckfxfm)
+//    * anything else (dynamic, switch frames), through pxform/sxform, with
+//      the result remembered for the epoch (shared by every handle)
+// The chains stop at the first frame both sides share, so two instruments
+// mounted on the same bus never look at the bus's attitude.  Evaluating the
+// handle only computes the time-varying links;  a handle with none is a
+// constant.
+//
+// A CK's base frame comes with its data, so a chain ends at a CK link, and
+// the base's chain is compiled when it's first seen.
+//
+// Frame definitions come from kernels.  If the kernel pool has changed since
+// the handle was compiled, it compiles again before the next call.  Like
+// FSpiceQueryHandle, only use a handle from the thread that makes SPICE
+// calls.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceName.h"
+#include "SpiceBodyOrientation.h"
+
+class SPICE_API FSpiceFrameHandle
+{
+public:
+    FSpiceFrameHandle() = default;
+
+    // Resolve the names and compile the chains.  On failure the returned
+    // handle is !IsValid().
+    static FSpiceFrameHandle Compile(
+        const FString& from,
+        const FString& to,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    bool IsValid() const { return bValid; }
+
+    const FString& GetFrom() const { return From; }
+    const FString& GetTo() const { return To; }
+    int32 GetFromId() const { return FromId; }
+    int32 GetToId() const { return ToId; }
+
+    // Links evaluated per call.  0:  the transformation is constant.
+    int32 NumVaryingLinks() const { return NumVarying; }
+    bool IsConstant() const { return bValid && NumVarying == 0; }
+
+    // Equivalent to pxform(from, to, et)
+    void Pxform(
+        const FSEphemerisTime& et,
+        FSRotationMatrix& rotate,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    ) const;
+
+    // Equivalent to sxform(from, to, et)
+    void Sxform(
+        const FSEphemerisTime& et,
+        FSStateTransform& xform,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    ) const;
+
+    // Many epochs.  Output i is for epoch i;  Out must be at least as long
+    // as ets.  Stops at the first failure.
+    void Pxform(
+        TArrayView<const FSEphemerisTime> ets,
+        TArrayView<FSRotationMatrix> rotate,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    ) const;
+
+    void Sxform(
+        TArrayView<const FSEphemerisTime> ets,
+        TArrayView<FSStateTransform> xform,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    ) const;
+
+    // Raw versions, for inner loops.  No error check per call; the caller
+    // checks once afterwards (USpice::get_implied_result, etc).
+    void Pxform(double et, double (&rotate)[3][3]) const;
+    void Sxform(double et, double (&xform)[6][6]) const;
+
+private:
+    enum class ELinkType : uint8
+    {
+        Fixed,
+        Pck,
+        Ck,
+        Other
+    };
+
+    struct FLink
+    {
+        ELinkType Type = ELinkType::Fixed;
+        // The frame the link transforms from
+        int32 Frame = 0;
+        // Pck:  the PCK class ID.  Ck:  the CK class ID.
+        int32 Id = 0;
+        // Fixed:  to the next link's frame
+        double Rotation[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+        // Other:  to J2000, by name
+        FSpiceName Name;
+        // Pck:  the native model, if it has one
+        TSharedPtr<const MaxQ::Frames::FPckOrientation, ESPMode::ThreadSafe> Orientation;
+    };
+
+    // Links from a frame towards J2000.  Ends at J2000, at the frame the
+    // other side shares, or after a CK link.
+    typedef TArray<FLink, TInlineAllocator<4>> FChain;
+
+    bool Resolve() const;
+    bool RefreshIfStale() const;
+
+    static bool CompileChain(int32 Frame, FChain& Chain);
+    static void MergeFixedLinks(FChain& Chain);
+    const FChain* BaseChain(int32 Frame) const;
+
+    // To the chain's end (J2000 past a CK link).  Depth guards CK bases.
+    bool Rotate(const FChain& Chain, double et, double (&m)[3][3], int32 Depth) const;
+    bool Transform(const FChain& Chain, double et, double (&r)[3][3], double (&d)[3][3], int32 Depth) const;
+
+    FString From;
+    FString To;
+
+    mutable int32 FromId = 0;
+    mutable int32 ToId = 0;
+    mutable FChain FromChain;
+    mutable FChain ToChain;
+    // Chains from CK base frames to J2000, compiled as they're found
+    mutable TMap<int32, FChain> BaseChains;
+    mutable int32 NumVarying = 0;
+    mutable double Constant[3][3] = { { 1., 0., 0. }, { 0., 1., 0. }, { 0., 0., 1. } };
+    mutable uint64 PoolGeneration = 0;
+    mutable bool bValid = false;
+};
@@ -0,0 +1,133 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceFurnshAsync.h
+//
+// API Comments
+//
+// Purpose:  Kernel loading off the game thread, with progress and cancel.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceFurnshAsync.h is part of the "refined C++ API" and "Blueprints API".
+//
+// Furnsh blocks until every file is loaded, so a big kernel set loaded in
+// BeginPlay hitches the first frame.  FurnshAsync loads the files on the
+// FSpiceExecutor thread instead, one command per file, in order (so
+// precedence is as Furnsh).  Between files other executor commands can
+// run, and a cancel is noticed.
+//
+// As with everything on the executor:  until the future is ready, don't
+// call CSPICE from other threads (USpice:: included).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "SpiceTypes.h"
+#include <atomic>
+#include "SpiceFurnshAsync.generated.h"
+
+namespace MaxQ::Data
+{
+    struct SPICE_API FFurnshAsyncResult
+    {
+        // Error if any file failed (the rest are still loaded, as Furnsh)
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        // Files loaded.  A cancelled load keeps the files loaded so far.
+        int32 NumLoaded = 0;
+        bool bCancelled = false;
+    };
+
+    // Shared by the caller and the load.  Thread-safe.
+    class SPICE_API FFurnshAsyncHandle
+    {
+    public:
+        explicit FFurnshAsyncHandle(int32 _Num) : Num(_Num) {}
+
+        // Files not started yet are skipped
+        void Cancel() { bCancelRequested = true; }
+        bool IsCancelRequested() const { return bCancelRequested; }
+
+        // Files done (loaded or failed) of Num()
+        int32 NumDone() const { return Done; }
+        int32 NumFiles() const { return Num; }
+        float Progress() const { return Num > 0 ? float(Done) / float(Num) : 1.f; }
+
+    private:
+        friend struct FFurnshAsyncLoad;
+
+        const int32 Num;
+        std::atomic<int32> Done { 0 };
+        std::atomic<bool> bCancelRequested { false };
+    };
+
+    typedef TFunction<void(int32 Done, int32 Num, const FString& relativePath)> FFurnshAsyncProgress;
+
+    // Paths as Furnsh.  OnProgress is called on the game thread after each
+    // file.  The future is fulfilled on the executor thread.
+    SPICE_API TFuture<FFurnshAsyncResult> FurnshAsync(
+        const TArray<FString>& relativePaths,
+        TSharedPtr<FFurnshAsyncHandle, ESPMode::ThreadSafe>* Handle = nullptr,
+        FFurnshAsyncProgress&& OnProgress = FFurnshAsyncProgress()
+    );
+}
+
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FFurnshAsyncProgressDelegate, int, Done, int, Num, const FString&, relativePath);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFurnshAsyncCompletedDelegate, int, Loaded, const FString&, ErrorMessage);
+
+
+UCLASS()
+class SPICE_API USpiceFurnshAsync : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Activate() override;
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Kernel",
+        meta = (
+            BlueprintInternalUseOnly = "true",
+            WorldContext = "WorldContextObject",
+            Keywords = "UTILITY",
+            ShortToolTip = "Load kernel file list (async)",
+            ToolTip = "Load a list of kernel files (paths relative to /Content directory) on the SPICE executor thread, without blocking the game thread"
+            ))
+    static USpiceFurnshAsync* furnsh_list_async(UObject* WorldContextObject, const TArray<FString>& files);
+
+    // Files not started yet are skipped, and OnCancelled fires
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Kernel")
+    void Cancel();
+
+    UPROPERTY(BlueprintAssignable)
+    FFurnshAsyncProgressDelegate OnProgress;
+
+    UPROPERTY(BlueprintAssignable)
+    FFurnshAsyncCompletedDelegate OnSuccess;
+
+    UPROPERTY(BlueprintAssignable)
+    FFurnshAsyncCompletedDelegate OnError;
+
+    UPROPERTY(BlueprintAssignable)
+    FFurnshAsyncCompletedDelegate OnCancelled;
+
+    // Args from furnsh_list_async (to be used by Activate)
+    TArray<FString> FilesArg;
+
+private:
+    TSharedPtr<MaxQ::Data::FFurnshAsyncHandle, ESPMode::ThreadSafe> Handle;
+};
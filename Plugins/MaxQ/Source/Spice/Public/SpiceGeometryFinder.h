@@ -0,0 +1,720 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGeometryFinder.h
+//
+// API Comments
+//
+// Purpose:  Geometry Finder (gf*) helpers: parallel searches, window math.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGeometryFinder.h is part of the "refined C++ API".
+//
+// The parallel variants split the confinement window into overlapping
+// sub-windows, run each piece on a FSpiceProcessPool worker, and stitch the
+// intervals back together (union, as wnunid_c would).
+// The overlap is one search step, so an event that straddles a partition
+// boundary is found by both neighbors and merges back into one interval.
+// A local extremum in the overlap is found by both, too, and kept once.
+// Absolute extremum searches (ABSMAX, ABSMIN) aren't split:  a piece's
+// extremum isn't the window's.
+// The pool is used from any thread.  If it isn't started the pieces run
+// serially, in-process.
+// The cached variants are the parallel ones, looked up in FGfResultCache
+// first (SpiceGfResultCache.h).
+//
+// ChooseGfStep picks a step from the geometry:  the shortest time scale
+// among the targets' motion relative to the observer (2 pi r / v), their
+// osculating orbits about it (oscelt, if the observer has a GM), and the
+// frame's rotation, sampled across the window.  The step is a fraction of
+// it (half that for extrema), so it suits events lasting at least a tenth or
+// so of that time scale;  anything shorter needs a step of its own.  It can
+// then be halved until no target's direction moves more than that fraction
+// of a turn per step, checked step by step (an eccentric orbit's periapsis,
+// say).  The parallel, cached and async variants choose one when given a
+// step <= 0, and log it (LogSpice).
+//
+// gfoclt with DSK shapes tests plates at every step, and most steps of a
+// long eclipse search are nowhere near an event.  GfocltPrefiltered first
+// compares bounding spheres (an ellipsoid's largest radius, or the radius a
+// DSK's segments are bounded by) on a cheap sampled pass:  a stretch between
+// samples is skipped when the spheres' angular separation, less their
+// angular radii, can't close to zero at the fastest rate the samples allow.
+// gfoclt runs only over what's left, so events are found exactly as before.
+//
+// An FGfIncrementalSearch keeps what it's found, and the window it's
+// searched.  Extending the window (a timeline scrolled forward) searches
+// just the new part, grown by a step into the old so that an interval
+// crossing the old boundary is found whole and merges with its first half.
+//
+// The async variants return immediately.  Their pieces go to the process
+// pool (a few per worker, as workers free up) or, if it isn't started, to the
+// FSpiceExecutor thread, one command per piece.  Either way progress is
+// reported as pieces finish, and a cancel skips the pieces not started yet.
+// The Blueprint nodes are in SpiceGeometryFinderAsync.h.
+//
+// Absolute extrema (ABSMAX, ABSMIN) of one piece aren't the window's, so
+// those searches are never split.
+//
+// The USpice gf* searches run inside an FGfSearchControlScope report their
+// progress and can be cancelled part way.  (They go through CSPICE's
+// mid-level routines, gfevnt_c, gfocce_c and gffove_c, which take the
+// reporting and interrupt callbacks the high-level ones don't.)  A search
+// superseded by a newer one (a timeline slider being dragged, say) can be
+// abandoned rather than waited for:
+//
+//    FGfCancellationToken Token;              // kept, to cancel from anywhere
+//    FGfSearchControl Control;
+//    Control.ShouldCancel = Token.AsPredicate();
+//    Control.OnProgress = [](float Fraction) { ... };
+//    {
+//        FGfSearchControlScope Scope(Control);
+//        USpice::gfdist(...);                 // SPICE(CANCELLED) if cancelled
+//    }
+//
+// The async variants' executor pieces are cancelled this way, too.
+//
+// GfUserScalar and GfUserCondition search quantities the gf* routines don't
+// know, written as C++ functions of et (gfuds_c and gfudb_c do the stepping
+// and root finding).  CSPICE calls them many times per step, so they're best
+// kept native:  an FChebyshevCache evaluates without touching CSPICE, and
+// CachedDistance/CachedRangeRate build quantities on one.  Conditions compose
+// the same way ("range rate below X while sunlit" is one condition, or the
+// intersection of two searches' windows).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceWindow.h"
+#include "Async/Future.h"
+#include <atomic>
+
+namespace MaxQ::Ephemeris
+{
+    class FChebyshevCache;
+}
+
+namespace MaxQ::GeometryFinder
+{
+    struct SPICE_API FGeometryFinderAsyncResult
+    {
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+        // Empty unless the search succeeded and wasn't cancelled
+        TArray<FSEphemerisTimeWindowSegment> results;
+        bool bCancelled = false;
+    };
+
+    // Shared by the caller and the search.  Thread-safe.
+    class SPICE_API FGeometryFinderAsyncHandle
+    {
+    public:
+        explicit FGeometryFinderAsyncHandle(int32 _Num) : Num(_Num) {}
+
+        // Pieces not started yet are skipped
+        void Cancel() { bCancelRequested = true; }
+        bool IsCancelRequested() const { return bCancelRequested; }
+
+        // Pieces searched of NumPieces()
+        int32 NumDone() const { return Done; }
+        int32 NumPieces() const { return Num; }
+        float Progress() const { return Num > 0 ? float(Done) / float(Num) : 1.f; }
+
+    private:
+        friend struct FGeometryFinderSearch;
+
+        const int32 Num;
+        std::atomic<int32> Done { 0 };
+        std::atomic<bool> bCancelRequested { false };
+    };
+
+    typedef TFunction<void(int32 Done, int32 Num)> FGeometryFinderAsyncProgress;
+
+    // Segments that became final, in time order and merged across pieces,
+    // and the time the search's results are now final through.  Every
+    // segment is streamed once, and together they're the search's results.
+    typedef TFunction<void(const TArray<FSEphemerisTimeWindowSegment>& Segments, const FSEphemerisTime& Through)> FGeometryFinderAsyncPartial;
+
+    // Progress and cancel for the searches in an FGfSearchControlScope.  Both
+    // are called on the searching thread, from inside CSPICE:  don't call
+    // SPICE from them.
+    struct SPICE_API FGfSearchControl
+    {
+        // Polled as the search steps.  True stops it, and it fails with
+        // SPICE(CANCELLED).
+        TFunction<bool()> ShouldCancel;
+        // Fraction of the confinement window searched, 0 to 1
+        TFunction<void(float Fraction)> OnProgress;
+    };
+
+    // USpice gf* searches made on this thread while it's in scope use
+    // Control (which must outlive it).  Scopes nest.
+    class SPICE_API FGfSearchControlScope
+    {
+    public:
+        explicit FGfSearchControlScope(const FGfSearchControl& Control);
+        ~FGfSearchControlScope();
+
+        // The innermost scope's control on this thread, or null
+        static const FGfSearchControl* Current();
+
+        FGfSearchControlScope(const FGfSearchControlScope&) = delete;
+        FGfSearchControlScope& operator=(const FGfSearchControlScope&) = delete;
+
+    private:
+        const FGfSearchControl* Previous;
+    };
+
+    // Cancel from any thread.  Copies share the same state.
+    class FGfCancellationToken
+    {
+    public:
+        void Cancel() { *bCancelled = true; }
+        bool IsCancelled() const { return *bCancelled; }
+
+        // For FGfSearchControl::ShouldCancel
+        TFunction<bool()> AsPredicate() const
+        {
+            return [State = bCancelled]() { return State->load(std::memory_order_relaxed); };
+        }
+
+    private:
+        TSharedRef<std::atomic<bool>, ESPMode::ThreadSafe> bCancelled = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+    };
+
+    struct FGfStepSettings
+    {
+        // Epochs sampled, spread across the window
+        int32 Samples = 8;
+        // Steps per time scale (twice as many for extrema)
+        double StepsPerCycle = 20.;
+        double MinSeconds = 1.;
+        // Halvings allowed, and the steps checked for each
+        int32 MaxRefinements = 0;
+        int32 MaxRefineSteps = 1000;
+    };
+
+    struct FGfStepChoice
+    {
+        FSEphemerisPeriod Step;
+        // The shortest time scale found, and what it was
+        FSEphemerisPeriod TimeScale;
+        FString Basis;
+        int32 Refinements = 0;
+    };
+
+    // frame may be empty (or inertial), for searches that don't use one
+    SPICE_API bool ChooseGfStep(
+        FGfStepChoice& Choice,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const TArray<FString>& targets,
+        const FString& obsrvr,
+        const FString& frame,
+        ES_RelationalOperator relate,
+        const FGfStepSettings& Settings = FGfStepSettings(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Split a window into (up to) Partitions pieces of roughly equal measure.
+    // Each piece is grown by Overlap on each side (but kept inside Window).
+    SPICE_API TArray<TArray<FSEphemerisTimeWindowSegment>> PartitionWindow(
+        const TArray<FSEphemerisTimeWindowSegment>& Window,
+        int32 Partitions,
+        const FSEphemerisPeriod& Overlap
+    );
+
+    // Union of windows.  Overlapping or abutting intervals merge.  A point
+    // (a local extremum) within PointTolerance of the one before it is the
+    // same point, found by two overlapping pieces, and is dropped.
+    // (Native, does not touch CSPICE, so it's safe from any thread.)
+    SPICE_API TArray<FSEphemerisTimeWindowSegment> UnionWindows(
+        const TArray<TArray<FSEphemerisTimeWindowSegment>>& Windows,
+        double PointTolerance = 0.
+    );
+
+    // A partitioned search's results in time order, as its pieces (from
+    // PartitionWindow) finish in any order.  A piece's segments are final
+    // once every earlier piece is in, except those reaching the next piece's
+    // start:  the next piece may find them too, so they're held until it's
+    // in, and merged with its.
+    // (Native, does not touch CSPICE.  Not thread-safe.)
+    class SPICE_API FGfPartialResults
+    {
+    public:
+        // PointTolerance:  as UnionWindows
+        explicit FGfPartialResults(const TArray<TArray<FSEphemerisTimeWindowSegment>>& Pieces, double PointTolerance = 0.);
+
+        // Appends the segments that became final to Final.  True if results
+        // are final through a later time than they were.
+        bool Add(int32 Piece, TArray<FSEphemerisTimeWindowSegment>&& Results, TArray<FSEphemerisTimeWindowSegment>& Final);
+
+        // No segment that isn't final yet starts before Through
+        FSEphemerisTime Through() const;
+        bool IsComplete() const { return Next == Received.Num(); }
+
+    private:
+        // Where each piece's segments stop being final (the next piece's start)
+        TArray<double> Cutoffs;
+        TArray<TOptional<TArray<FSEphemerisTimeWindowSegment>>> Received;
+        TArray<FSEphemerisTimeWindowSegment> Held;
+        double Begin = 0.;
+        double End = 0.;
+        double PointTolerance = 0.;
+        int32 Next = 0;
+    };
+
+    // Partitions <= 0 means one per process pool worker.  A step <= 0 is
+    // chosen by ChooseGfStep.
+    SPICE_API void GfdistParallel(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FSDistance& refval,
+        const FSDistance& adjust,
+        const FString& target,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void GfocltParallel(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        int32 Partitions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void GfposcParallel(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const FSEphemerisPeriod& step,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FString& target,
+        const FString& frame,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_CoordinateSystemInclRadec crdsys,
+        ES_CoordinateName coord,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust,
+        int nintvls,
+        int32 Partitions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void GfsepParallel(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSAngle& refval,
+        const FSAngle& adjust,
+        const FSEphemerisPeriod& step,
+        const FString& targ1,
+        ES_OtherGeometricModel shape1,
+        const FString& targ2,
+        ES_OtherGeometricModel shape2,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+
+    // As the parallel variants, unless FGfResultCache (SpiceGfResultCache.h)
+    // has the result.
+    SPICE_API void GfdistCached(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FSDistance& refval,
+        const FSDistance& adjust,
+        const FString& target,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void GfocltCached(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        int32 Partitions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void GfposcCached(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const FSEphemerisPeriod& step,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FString& target,
+        const FString& frame,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_CoordinateSystemInclRadec crdsys,
+        ES_CoordinateName coord,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust,
+        int nintvls,
+        int32 Partitions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void GfsepCached(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSAngle& refval,
+        const FSAngle& adjust,
+        const FSEphemerisPeriod& step,
+        const FString& targ1,
+        ES_OtherGeometricModel shape1,
+        const FString& targ2,
+        ES_OtherGeometricModel shape2,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+
+    // Bounding sphere radius (km) of body's shape, for the occultation
+    // pre-filter.  POINT:  0.  ELLIPSOID:  its largest radius (RADII).  DSK:
+    // the largest radius any loaded segment for the body can reach, from its
+    // descriptor's coordinate bounds (dskgd_c, every surface's).
+    SPICE_API bool BoundingRadius(
+        double& Radius,
+        const FString& body,
+        ES_GeometricModel shape,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    struct FGfOccultationPrefilter
+    {
+        // Bounding spheres are compared this often (<= 0:  the search's step)
+        FSEphemerisPeriod SampleStep = FSEphemerisPeriod::Zero;
+        // Multiplies the bound on how fast the spheres' separation closes
+        // between samples
+        double Safety = 2.;
+    };
+
+    struct FGfOccultationPrefilterStats
+    {
+        double FrontRadius = 0.;
+        double BackRadius = 0.;
+        int32 Samples = 0;
+        // Of the confinement window, and of it left to search exactly
+        double WindowSeconds = 0.;
+        double CandidateSeconds = 0.;
+    };
+
+    // The parts of cnfine where front and back's bounding spheres may
+    // overlap, as seen by obsrvr:  occultations of any type can only be
+    // found there.
+    SPICE_API bool OccultationCandidates(
+        TArray<FSEphemerisTimeWindowSegment>& candidates,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& back,
+        ES_GeometricModel backShape,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        const FGfOccultationPrefilter& Prefilter = FGfOccultationPrefilter(),
+        FGfOccultationPrefilterStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // USpice::gfoclt, searching only OccultationCandidates' window
+    SPICE_API bool GfocltPrefiltered(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        const FGfOccultationPrefilter& Prefilter = FGfOccultationPrefilter(),
+        FGfOccultationPrefilterStats* Stats = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+
+    // Async variants.  Partitions <= 0 means a few pieces per process pool
+    // worker, or enough executor pieces for progress and cancel to be
+    // responsive.  OnProgress is called on the game thread after each piece.
+    // OnPartial streams the results (FGfPartialResults) on the game thread,
+    // as soon as the pieces before them are done, so the start of a long
+    // window can be shown while the rest is searched.  A failure or cancel
+    // stops the stream.  The future is fulfilled on a worker thread.
+    SPICE_API TFuture<FGeometryFinderAsyncResult> GfdistAsync(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FSDistance& refval,
+        const FSDistance& adjust,
+        const FString& target,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions = 0,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle = nullptr,
+        FGeometryFinderAsyncProgress&& OnProgress = FGeometryFinderAsyncProgress(),
+        FGeometryFinderAsyncPartial&& OnPartial = FGeometryFinderAsyncPartial()
+    );
+
+    SPICE_API TFuture<FGeometryFinderAsyncResult> GfocltAsync(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp,
+        const FString& front,
+        ES_GeometricModel frontShape,
+        const FString& frontframe,
+        const FString& back,
+        ES_GeometricModel backShape,
+        const FString& backFrame,
+        ES_AberrationCorrectionForOccultation abcorr,
+        const FString& obsrvr,
+        int32 Partitions = 0,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle = nullptr,
+        FGeometryFinderAsyncProgress&& OnProgress = FGeometryFinderAsyncProgress(),
+        FGeometryFinderAsyncPartial&& OnPartial = FGeometryFinderAsyncPartial()
+    );
+
+    SPICE_API TFuture<FGeometryFinderAsyncResult> GfposcAsync(
+        const FSEphemerisPeriod& step,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FString& target,
+        const FString& frame,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_CoordinateSystemInclRadec crdsys,
+        ES_CoordinateName coord,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust,
+        int nintvls,
+        int32 Partitions = 0,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle = nullptr,
+        FGeometryFinderAsyncProgress&& OnProgress = FGeometryFinderAsyncProgress(),
+        FGeometryFinderAsyncPartial&& OnPartial = FGeometryFinderAsyncPartial()
+    );
+
+    SPICE_API TFuture<FGeometryFinderAsyncResult> GfsepAsync(
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSAngle& refval,
+        const FSAngle& adjust,
+        const FSEphemerisPeriod& step,
+        const FString& targ1,
+        ES_OtherGeometricModel shape1,
+        const FString& targ2,
+        ES_OtherGeometricModel shape2,
+        ES_AberrationCorrectionWithTransmissions abcorr,
+        const FString& obsrvr,
+        ES_RelationalOperator relate,
+        int32 Partitions = 0,
+        TSharedPtr<FGeometryFinderAsyncHandle, ESPMode::ThreadSafe>* Handle = nullptr,
+        FGeometryFinderAsyncProgress&& OnProgress = FGeometryFinderAsyncProgress(),
+        FGeometryFinderAsyncPartial&& OnPartial = FGeometryFinderAsyncPartial()
+    );
+
+
+    class SPICE_API FGfIncrementalSearch
+    {
+    public:
+        // Searches cnfine (always within the window Extend was given)
+        typedef TFunction<void(ES_ResultCode& ResultCode, FString& ErrorMessage, TArray<FSEphemerisTimeWindowSegment>& results, const TArray<FSEphemerisTimeWindowSegment>& cnfine)> FSearch;
+
+        // bIncremental false (absolute extrema, which depend on the whole
+        // window):  each Extend searches everything again.
+        FGfIncrementalSearch(FSearch&& _Search, const FSEphemerisPeriod& _Step, bool _bIncremental = true);
+
+        static FGfIncrementalSearch Gfdist(
+            const FSEphemerisPeriod& step,
+            const FSDistance& refval,
+            const FSDistance& adjust,
+            const FString& target,
+            ES_AberrationCorrectionWithTransmissions abcorr,
+            const FString& obsrvr,
+            ES_RelationalOperator relate
+        );
+
+        static FGfIncrementalSearch Gfoclt(
+            const FSEphemerisPeriod& step,
+            const TArray<FString>& frontShapeSurfaces,
+            const TArray<FString>& backShapeSurfaces,
+            ES_OccultationType occtyp,
+            const FString& front,
+            ES_GeometricModel frontShape,
+            const FString& frontframe,
+            const FString& back,
+            ES_GeometricModel backShape,
+            const FString& backFrame,
+            ES_AberrationCorrectionForOccultation abcorr,
+            const FString& obsrvr
+        );
+
+        static FGfIncrementalSearch Gfposc(
+            const FSEphemerisPeriod& step,
+            const FString& target,
+            const FString& frame,
+            ES_AberrationCorrectionWithTransmissions abcorr,
+            const FString& obsrvr,
+            ES_CoordinateSystemInclRadec crdsys,
+            ES_CoordinateName coord,
+            ES_RelationalOperator relate,
+            double refval,
+            double adjust,
+            int nintvls
+        );
+
+        static FGfIncrementalSearch Gfsep(
+            const FSAngle& refval,
+            const FSAngle& adjust,
+            const FSEphemerisPeriod& step,
+            const FString& targ1,
+            ES_OtherGeometricModel shape1,
+            const FString& targ2,
+            ES_OtherGeometricModel shape2,
+            ES_AberrationCorrectionWithTransmissions abcorr,
+            const FString& obsrvr,
+            ES_RelationalOperator relate
+        );
+
+        // Adds cnfine to the window searched, searching only what's new.
+        // On failure nothing changes.
+        bool Extend(
+            const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Forget everything found (after a kernel change, say)
+        void Reset();
+
+        // Everything searched so far, and what was found in it
+        const FSWindow& GetCoverage() const { return Coverage; }
+        const FSWindow& GetResults() const { return Results; }
+        TArray<FSEphemerisTimeWindowSegment> ToSegments() const { return Results.ToSegments(); }
+
+        // Time searched by the last Extend (grown pieces included)
+        double LastSearchedSeconds() const { return LastSearched; }
+
+    private:
+        FSearch Search;
+        double Step = 0.;
+        bool bIncremental = true;
+
+        FSWindow Coverage;
+        FSWindow Results;
+        double LastSearched = 0.;
+    };
+
+
+    // A quantity for GfUserScalar.  Its functions are called from inside
+    // CSPICE, on the searching thread:  don't call SPICE from them.
+    struct SPICE_API FGfUserScalar
+    {
+        // The quantity at et (TDB seconds past J2000).  NaN fails the search.
+        TFunction<double(double et)> Value;
+        // Optional, its time derivative (only the sign is used)...
+        TFunction<double(double et)> Derivative;
+        // ...or, optionally, whether it's decreasing at et
+        TFunction<bool(double et)> IsDecreasing;
+        // With neither, the sign comes from Value, differenced over this many
+        // seconds (uddc_c)
+        double DerivativeStep = 1.;
+    };
+
+    // gfuds_c.  refval and adjust as gfdist's.  Inside an
+    // FGfSearchControlScope the search can be cancelled (it doesn't report
+    // progress).
+    SPICE_API bool GfUserScalar(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FGfUserScalar& Quantity,
+        ES_RelationalOperator relate,
+        double refval,
+        double adjust = 0.,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // gfudb_c:  the intervals where Condition holds.  step must be shorter
+    // than any interval where it does (or doesn't).
+    SPICE_API bool GfUserCondition(
+        TArray<FSEphemerisTimeWindowSegment>& results,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        TFunction<bool(double et)> Condition,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Quantities evaluated from a cache (which must outlive the search).  NaN
+    // outside the cache's span, so a search outside it fails.
+    // Distance (km) from the cache's observer to the body
+    SPICE_API FGfUserScalar CachedDistance(const MaxQ::Ephemeris::FChebyshevCache& Cache, int32 BodyIndex);
+    // Its rate of change (km/s), positive when receding
+    SPICE_API FGfUserScalar CachedRangeRate(const MaxQ::Ephemeris::FChebyshevCache& Cache, int32 BodyIndex);
+}
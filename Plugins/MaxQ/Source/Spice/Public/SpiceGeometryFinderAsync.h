@@ -0,0 +1,186 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGeometryFinderAsync.h
+//
+// API Comments
+//
+// Purpose:  Blueprint nodes for geometry finder searches that don't block
+// the game thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGeometryFinderAsync.h is part of the "Blueprints API".
+//
+// USpice::gfdist and friends block for the whole search, which can be
+// seconds to minutes.  These nodes run the same search with
+// MaxQ::GeometryFinder::GfdistAsync etc (SpiceGeometryFinder.h), and fire
+// OnProgress as pieces finish, then one of OnSuccess, OnFailure or
+// OnCancelled.  OnPartial streams the results in time order as they become
+// final, so a timeline can draw the first weeks while the rest of the window
+// is searched.
+//
+// Without a process pool the search runs on the FSpiceExecutor thread, so
+// the executor's rule applies:  until it completes, don't call CSPICE from
+// other threads (USpice:: included).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "SpiceGeometryFinder.h"
+#include "SpiceGeometryFinderAsync.generated.h"
+
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGeometryFinderAsyncProgressDelegate, int, Done, int, Num);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGeometryFinderAsyncPartialDelegate, const TArray<FSEphemerisTimeWindowSegment>&, segments, const FSEphemerisTime&, through);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGeometryFinderAsyncCompletedDelegate, const TArray<FSEphemerisTimeWindowSegment>&, results, const FString&, ErrorMessage);
+
+
+UCLASS()
+class SPICE_API USpiceGeometryFinderAsync : public UBlueprintAsyncActionBase
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Activate() override;
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Geometry Finder",
+        meta = (
+            BlueprintInternalUseOnly = "true",
+            WorldContext = "WorldContextObject",
+            Keywords = "EPHEMERIS, EVENT, GEOMETRY, SEARCH, WINDOW",
+            AutoCreateRefTerm = "adjust, refval",
+            ShortToolTip = "GF, distance search (async)",
+            ToolTip = "Return the time window over which a specified constraint on observer - target distance is met, without blocking the game thread"
+            ))
+    static USpiceGeometryFinderAsync* gfdist_async(
+        UObject* WorldContextObject,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const FSDistance& refval,
+        const FSDistance& adjust,
+        const FString& target = TEXT("MOON"),
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::None,
+        const FString& obsrvr = TEXT("EARTH"),
+        ES_RelationalOperator relate = ES_RelationalOperator::GreaterThan
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Geometry Finder",
+        meta = (
+            BlueprintInternalUseOnly = "true",
+            WorldContext = "WorldContextObject",
+            Keywords = "EVENT, GEOMETRY, SEARCH, WINDOW",
+            AutoCreateRefTerm = "frontShapeSurfaces, backShapeSurfaces",
+            ShortToolTip = "GF, find occultation (async)",
+            ToolTip = "Determine time intervals when an observer sees one target occulted by, or in transit across, another, without blocking the game thread"
+            ))
+    static USpiceGeometryFinderAsync* gfoclt_async(
+        UObject* WorldContextObject,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSEphemerisPeriod& step,
+        const TArray<FString>& frontShapeSurfaces,
+        const TArray<FString>& backShapeSurfaces,
+        ES_OccultationType occtyp = ES_OccultationType::ANY,
+        const FString& front = TEXT("MOON"),
+        ES_GeometricModel frontShape = ES_GeometricModel::ELLIPSOID,
+        const FString& frontframe = TEXT("IAU_MOON"),
+        const FString& back = TEXT("SUN"),
+        ES_GeometricModel backShape = ES_GeometricModel::ELLIPSOID,
+        const FString& backFrame = TEXT("IAU_SUN"),
+        ES_AberrationCorrectionForOccultation abcorr = ES_AberrationCorrectionForOccultation::CN,
+        const FString& obsrvr = TEXT("EARTH")
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Geometry Finder",
+        meta = (
+            BlueprintInternalUseOnly = "true",
+            WorldContext = "WorldContextObject",
+            Keywords = "EVENT, GEOMETRY, SEARCH, SEPARATION",
+            ShortToolTip = "GF, observer-target vector coordinate search (async)",
+            ToolTip = "Determine time intervals for which a coordinate of an observer - target position vector satisfies a numerical constraint, without blocking the game thread"
+            ))
+    static USpiceGeometryFinderAsync* gfposc_async(
+        UObject* WorldContextObject,
+        const FSEphemerisPeriod& step,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FString& target = TEXT("SUN"),
+        const FString& frame = TEXT("IAU_EARTH"),
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::None,
+        const FString& obsrvr = TEXT("EARTH"),
+        ES_CoordinateSystemInclRadec crdsys = ES_CoordinateSystemInclRadec::LATITUDINAL,
+        ES_CoordinateName coord = ES_CoordinateName::LATITUDE,
+        ES_RelationalOperator relate = ES_RelationalOperator::ABSMAX,
+        double refval = 0.,
+        double adjust = 0.,
+        int nintvls = 750
+    );
+
+    UFUNCTION(BlueprintCallable,
+        Category = "MaxQ|Geometry Finder",
+        meta = (
+            BlueprintInternalUseOnly = "true",
+            WorldContext = "WorldContextObject",
+            Keywords = "EVENT, GEOMETRY, SEARCH, SEPARATION",
+            AutoCreateRefTerm = "adjust, refval",
+            ShortToolTip = "GF, angular separation search (async)",
+            ToolTip = "Determine time intervals when the angular separation between the position vectors of two target bodies relative to an observer satisfies a numerical relationship, without blocking the game thread"
+            ))
+    static USpiceGeometryFinderAsync* gfsep_async(
+        UObject* WorldContextObject,
+        const TArray<FSEphemerisTimeWindowSegment>& cnfine,
+        const FSAngle& refval,
+        const FSAngle& adjust,
+        const FSEphemerisPeriod& step,
+        const FString& targ1 = TEXT("SUN"),
+        ES_OtherGeometricModel shape1 = ES_OtherGeometricModel::POINT,
+        const FString& targ2 = TEXT("MOON"),
+        ES_OtherGeometricModel shape2 = ES_OtherGeometricModel::POINT,
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::LT,
+        const FString& obsrvr = TEXT("EARTH"),
+        ES_RelationalOperator relate = ES_RelationalOperator::LessThan
+    );
+
+    // Pieces not started yet are skipped, and OnCancelled fires
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Geometry Finder")
+    void Cancel();
+
+    UPROPERTY(BlueprintAssignable)
+    FGeometryFinderAsyncProgressDelegate OnProgress;
+
+    // Segments that became final, and the time results are final through
+    UPROPERTY(BlueprintAssignable)
+    FGeometryFinderAsyncPartialDelegate OnPartial;
+
+    UPROPERTY(BlueprintAssignable)
+    FGeometryFinderAsyncCompletedDelegate OnSuccess;
+
+    UPROPERTY(BlueprintAssignable)
+    FGeometryFinderAsyncCompletedDelegate OnFailure;
+
+    UPROPERTY(BlueprintAssignable)
+    FGeometryFinderAsyncCompletedDelegate OnCancelled;
+
+private:
+    typedef TSharedPtr<MaxQ::GeometryFinder::FGeometryFinderAsyncHandle, ESPMode::ThreadSafe> FHandle;
+    typedef TFunction<TFuture<MaxQ::GeometryFinder::FGeometryFinderAsyncResult>(FHandle*, MaxQ::GeometryFinder::FGeometryFinderAsyncProgress&&, MaxQ::GeometryFinder::FGeometryFinderAsyncPartial&&)> FSearch;
+
+    static USpiceGeometryFinderAsync* Create(UObject* WorldContextObject, FSearch&& Search);
+
+    // From the factory (to be used by Activate)
+    FSearch Search;
+    FHandle Handle;
+};
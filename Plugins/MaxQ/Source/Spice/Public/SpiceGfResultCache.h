@@ -0,0 +1,101 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGfResultCache.h
+//
+// API Comments
+//
+// Purpose:  Geometry finder results, kept for searches made again.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGfResultCache.h is part of the "refined C++ API".
+//
+// An eclipse or visibility report re-run with the same targets, window,
+// step and kernels gets the same intervals, so the cached searches
+// (GfocltCached etc, SpiceGeometryFinder.h) look them up first.  A result is
+// keyed by the search's full parameter set (the same bytes the process pool
+// sends a worker, plus gfstol's tolerance) and the kernel fingerprint:  the
+// loaded kernels' paths, sizes and timestamps, in load order.
+//
+// In memory, results last until the kernel pool changes (anything that moves
+// MaxQ::Data::GetPoolGeneration:  loads, unloads, hot reloads, pdpool...).
+// Results kept on disk (SetDirectory) outlast the session, and are found
+// again whenever the same kernels are loaded.  Pool writes that don't come
+// from a kernel (pdpool, boddef) aren't part of the fingerprint, though:
+// after one that changes what a search finds, Invalidate.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::GeometryFinder
+{
+    struct FGfResultCacheStats
+    {
+        int64 Hits = 0;
+        // (Of the hits)
+        int64 DiskHits = 0;
+        int64 Misses = 0;
+        int32 Entries = 0;
+    };
+
+    class SPICE_API FGfResultCache
+    {
+    public:
+        static FGfResultCache& Get();
+
+        // Results are also saved to (and found in) this directory.  Paths as
+        // Furnsh.  Empty (the default):  memory only.
+        void SetDirectory(const FString& relativeDirectory);
+        FString GetDirectory() const;
+
+        // In memory, the oldest are dropped beyond this many
+        void SetMaxEntries(int32 _MaxEntries);
+
+        // Request:  the search's name and parameters, as bytes.  Both read
+        // the loaded kernels (kdata_c) when the pool has changed, so call
+        // them where SPICE calls are made.
+        bool Find(const TArray<uint8>& Request, TArray<FSEphemerisTimeWindowSegment>& results);
+        void Add(const TArray<uint8>& Request, const TArray<FSEphemerisTimeWindowSegment>& results);
+
+        // Drops every result, in memory and in the directory
+        void Invalidate();
+
+        FGfResultCacheStats GetStats() const;
+
+        // The loaded kernels' paths, sizes and timestamps, hashed
+        uint64 KernelFingerprint();
+
+    private:
+        FGfResultCache() = default;
+
+        uint64 Key(const TArray<uint8>& Request);
+        FString EntryPath(uint64 EntryKey) const;
+        void Remember(uint64 EntryKey, const TArray<FSEphemerisTimeWindowSegment>& results);
+
+        mutable FCriticalSection Lock;
+        FString Directory;
+        int32 MaxEntries = 1024;
+
+        uint64 PoolGeneration = 0;
+        uint64 Fingerprint = 0;
+        bool bFingerprinted = false;
+
+        TMap<uint64, TArray<FSEphemerisTimeWindowSegment>> Entries;
+        // Oldest first
+        TArray<uint64> Order;
+
+        FGfResultCacheStats Stats;
+    };
+}
@@ -0,0 +1,139 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGravityField.h
+//
+// API Comments
+//
+// Purpose:  Spherical harmonic gravity fields (EGM, GRAIL, etc).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGravityField.h is part of the "refined C++ API".
+//
+// SPICE kernels carry a body's GM and, at most, the J2 of an spkw15
+// segment.  High fidelity LEO and lunar orbits need the full field.
+// FGravityField holds a fully normalized coefficient set, as the ICGEM
+// (.gfc) and PDS SHADR (.tab, GRAIL's and LRO's) files publish them, and
+// evaluates the acceleration with Cunningham's recursion, in its normalized
+// form.  Accelerations evaluates many positions at once, MAXQ_TWOBODY_LANES
+// at a time, with ParallelFor across the batch.  Nothing here touches CSPICE
+// once the field is loaded, so evaluation is safe from any thread (a physics
+// callback, for one).
+//
+// FSphericalHarmonicGravityForce plugs a field into FNumericalPropagator.
+// The body-fixed frame is approximated as uniform rotation about its pole,
+// from a pxform taken at an epoch:  fine over days for the Earth (which
+// precesses and nutates) and the Moon (which librates).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceTwoBody.h"
+#include "SpiceIntegrator.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Orbits
+{
+    class SPICE_API FGravityField
+    {
+    public:
+        static constexpr int32 Lanes = MAXQ_TWOBODY_LANES;
+
+        // Coefficients are stored by degree then order:  C[Index(n, m)].
+        static int32 Index(int32 n, int32 m) { return n * (n + 1) / 2 + m; }
+        static int32 NumCoefficients(int32 degree) { return Index(degree, degree) + 1; }
+
+        // Replaces anything already built.  gm (km^3/s^2) and radius (km)
+        // are the ones the coefficients are normalized to.  C and S are
+        // fully normalized, NumCoefficients(degree) long.  C[0] is normally
+        // 1.
+        void Build(double gm, double radius, int32 degree, TArrayView<const double> C, TArrayView<const double> S);
+        void Reset();
+
+        bool IsEmpty() const { return Degree < 0; }
+        int32 GetDegree() const { return Degree; }
+        double GetGM() const { return GM; }
+        double GetRadius() const { return Radius; }
+        double GetC(int32 n, int32 m) const { return C[Index(n, m)]; }
+        double GetS(int32 n, int32 m) const { return S[Index(n, m)]; }
+        SIZE_T GetAllocatedSize() const;
+
+        // The acceleration (km/s^2) at a body-fixed position (km), from the
+        // terms of degree MinDegree and up.  MinDegree 0 is the whole
+        // field;  2 leaves out the point mass (and degree 1, which is zero
+        // when the origin is the center of mass).  False at the origin.
+        bool Acceleration(const double(&r)[3], double(&a)[3], int32 MinDegree = 0) const;
+        bool Acceleration(const FSDistanceVector& r, FSDimensionlessVector& a, int32 MinDegree = 0) const;
+
+        // Acceleration for many positions.  Positions at the origin get zero.
+        // Returns the number evaluated.
+        int32 Accelerations(const MaxQ::Math::FConstVectorBatch& r, const MaxQ::Math::FVectorBatch& a, int32 MinDegree = 0) const;
+
+        // The potential (km^2/s^2, positive), for checks and energy
+        bool Potential(const double(&r)[3], double& U, int32 MinDegree = 0) const;
+
+    private:
+        template<int32 W>
+        void Evaluate(const double* x, const double* y, const double* z, double* ax, double* ay, double* az, double* U, int32 MinDegree) const;
+
+        double GM = 0.;
+        double Radius = 0.;
+        int32 Degree = -1;
+
+        // To Degree
+        TArray<double> C, S;
+        // The acceleration's factors, to Degree:  for the V(n+1, m+1),
+        // V(n+1, m-1) and V(n+1, m) terms
+        TArray<double> KPlus, KMinus, KZero;
+        // The recursion's, to Degree + 1:  down the columns, and along the
+        // diagonal
+        TArray<double> Alpha, Beta;
+        TArray<double> Diagonal;
+    };
+
+    // Reads an ICGEM (.gfc) or PDS SHADR (.tab) coefficient file.  Path is
+    // relative to the kernel root, as furnsh's.  Coefficients past maxDegree
+    // are dropped (0 keeps them all).  Unnormalized files are normalized.
+    // ICGEM's time variable terms are left out.
+    SPICE_API bool LoadGravityField(
+        const FString& Path,
+        FGravityField& Field,
+        int32 maxDegree = 0,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // The field, less its point mass (which FNumericalPropagator applies
+    // itself), as a force model.  The integration frame is rotated into the
+    // body-fixed frame by InertialToFixed at epoch, and by a further
+    // rotationRate (rad/s) about the body's +Z after.
+    class SPICE_API FSphericalHarmonicGravityForce : public IForceModel
+    {
+    public:
+        FSphericalHarmonicGravityForce(
+            TSharedRef<const FGravityField, ESPMode::ThreadSafe> Field,
+            const FSRotationMatrix& InertialToFixed,
+            const FSEphemerisTime& epoch,
+            double rotationRate
+        );
+
+        virtual bool AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const override;
+
+    private:
+        TSharedRef<const FGravityField, ESPMode::ThreadSafe> Field;
+        double Rotation[3][3];
+        double Epoch = 0.;
+        double RotationRate = 0.;
+    };
+}
@@ -0,0 +1,123 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceGroundTrack.h
+//
+// API Comments
+//
+// Purpose:  Incrementally extended ground tracks for satellite catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceGroundTrack.h is part of the "refined C++ API".
+//
+// A ground track drawn from subpnt (or spkpos + recgeo) per sample costs the
+// whole track every frame, for every satellite.  FGroundTrackCache keeps each
+// catalog object's sub-satellite points, split into revolutions (ascending
+// node to ascending node), and Update only computes the samples a new time
+// span adds.  Revolutions that fall wholly outside the span are dropped, so a
+// track that advances with time costs O(new samples) per frame.
+//
+// Samples are at multiples of the step (TDB seconds past J2000), so extending
+// a track backwards or forwards never resamples what's there, and every
+// object's samples line up in time.  Sub-points are geodetic (WGS-84) near
+// points, as subpnt's "NEAR POINT/ELLIPSOID" gives them, from SGP4 states
+// rotated to a pseudo Earth fixed frame the way PredictPasses does it
+// (SpicePassPrediction.h):  no SPK or PCK is needed.
+//
+// Objects are propagated in parallel.  Update uses CSPICE once (deltet_c, for
+// TDB - UTC), so it needs a leapseconds kernel and the SPICE thread.  Times
+// SGP4 fails at have no point.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+
+namespace MaxQ::Orbits
+{
+    struct FGroundTrackSettings
+    {
+        // Seconds between samples
+        double Step = 30.;
+    };
+
+    struct FGroundTrackPoint
+    {
+        // TDB
+        double et = 0.;
+        // Geodetic (WGS-84), radians & km
+        double Latitude = 0.;
+        double Longitude = 0.;
+        double Altitude = 0.;
+    };
+
+    struct FGroundTrackRevolution
+    {
+        // Counted from the first revolution the track was built with;
+        // revolutions added before it are negative.
+        int32 Number = 0;
+        // In time order.  The first and last revolutions of a track are
+        // usually partial.
+        TArray<FGroundTrackPoint> Points;
+    };
+
+    class SPICE_API FGroundTrackCache
+    {
+    public:
+        FGroundTrackCache() = default;
+
+        // Forgets every track.  The catalog is copied.
+        void Reset(TArrayView<const FSGP4Propagator> Catalog, const FGroundTrackSettings& _Settings = FGroundTrackSettings());
+
+        // Brings every track to cover [Start, Stop], computing only samples
+        // it doesn't have.  Requires a leapseconds kernel.
+        bool Update(
+            const FSEphemerisTime& Start,
+            const FSEphemerisTime& Stop,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        int32 Num() const { return Tracks.Num(); }
+
+        // Everything kept for Object, which may reach a little past the span
+        // (to the ends of the first and last revolutions)
+        TArrayView<const FGroundTrackRevolution> Revolutions(int32 Object) const { return Tracks[Object].Revolutions; }
+
+        // Object's points within the last Update's span, appended to Points
+        void Track(int32 Object, TArray<FGroundTrackPoint>& Points) const;
+
+        double GetStart() const { return SpanStart; }
+        double GetStop() const { return SpanStop; }
+
+        // Samples the last Update computed, over all objects
+        int32 NumComputed() const { return Computed; }
+
+    private:
+        struct FTrack
+        {
+            TArray<FGroundTrackRevolution> Revolutions;
+            // Sample indices (et / Step) computed;  empty if First > Last
+            int64 First = 0;
+            int64 Last = -1;
+        };
+
+        TArray<FSGP4Propagator> Propagators;
+        TArray<FTrack> Tracks;
+        FGroundTrackSettings Settings;
+        double SpanStart = 0.;
+        double SpanStop = 0.;
+        int32 Computed = 0;
+    };
+}
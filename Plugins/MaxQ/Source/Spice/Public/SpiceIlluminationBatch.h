@@ -0,0 +1,176 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceIlluminationBatch.h
+//
+// API Comments
+//
+// Purpose:  Illumination angles over whole surface grids.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceIlluminationBatch.h is part of the "refined C++ API".
+//
+// USpice::illumf works out the observer's and the source's aberration
+// corrected positions again for every surface point.  For a latsrf grid
+// that's almost all of the cost, and it's the same for every point.
+//
+// IlluminationGeometry does that part once per epoch (CSPICE), corrected to
+// the target's center.  IlluminationAngles then computes phase, incidence and
+// emission, and illumf's visible and lit flags, for every point (native, in
+// parallel, any thread).  Using the target center's light time for every
+// point, instead of each point's own, differs from illumf by about the
+// target's rotation during the light time across it:  well below a
+// microradian for planets.
+//
+// Points (and normals) are in the target's body fixed frame, km.  Without
+// normals, the points are taken to be on the target's RADII ellipsoid (as
+// illumf's ELLIPSOID method).  For DSK shapes, pass srfnrm's normals:  they
+// don't change with time, so look them up once per grid.
+//
+// The angles are floats, because they're headed for textures:
+// CreateIlluminationTexture/UpdateIlluminationTexture write them to an
+// RGBA32F texture (game thread).
+//
+// PlanetLighting is the per-frame version for whole scenes:  for every
+// target at once, the source direction and the sub-source (subslr) and
+// sub-observer (subpnt) near points, which planet and atmosphere shaders
+// want.  The observer's state is looked up once for all of them, and the
+// near points are native, instead of subslr and subpnt each redoing the
+// target's and the source's positions.  SetPlanetLightingParameters puts the
+// results into a material parameter collection (game thread).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+class UTexture2D;
+class UMaterialParameterCollection;
+
+namespace MaxQ::Math
+{
+    struct FIlluminationGeometry
+    {
+        // Target center's epoch (illumf's trgepc)
+        FSEphemerisTime TargetEpoch;
+        // Target centered, in the body fixed frame at TargetEpoch
+        FSDistanceVector Observer;
+        FSDistanceVector Source;
+        // The target's RADII, if it has them (zero otherwise)
+        FSDistanceVector Radii;
+    };
+
+    // Caller owned, one element per point.  Radians.  Flags may be empty.
+    struct FIlluminationAngleBatch
+    {
+        enum EFlags : uint8
+        {
+            Visible = 1 << 0,
+            Lit = 1 << 1
+        };
+
+        TArrayView<float> Phase, Incidence, Emission;
+        TArrayView<uint8> Flags;
+        int32 Num() const { return Phase.Num(); }
+    };
+
+    // Uses CSPICE.  abcorr:  corrections for the observer, as illumf.  The
+    // source is corrected as light received at the target.
+    SPICE_API bool IlluminationGeometry(
+        const FSEphemerisTime& et,
+        FIlluminationGeometry& Geometry,
+        const FString& target = TEXT("MARS"),
+        const FString& ilusrc = TEXT("SUN"),
+        const FString& fixref = TEXT("IAU_MARS"),
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::CN_S,
+        const FString& obsrvr = TEXT("MGS"),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Native.  Normals:  outward unit normals, or null for ellipsoid normals
+    // (false if Geometry has no radii).  False if any lengths differ.
+    SPICE_API bool IlluminationAngles(
+        const FIlluminationGeometry& Geometry,
+        const FConstVectorBatch& Points,
+        const FIlluminationAngleBatch& Angles,
+        const FConstVectorBatch* Normals = nullptr
+    );
+
+    // Game thread.  Texel (x, y) is point y * Width + x.  R:  phase,
+    // G:  incidence, B:  emission (radians), A:  the flags (0...3, or 3 with
+    // no flags).  Filtering is bilinear;  x wraps, y clamps.
+    SPICE_API UTexture2D* CreateIlluminationTexture(
+        int32 Width,
+        int32 Height,
+        const FIlluminationAngleBatch& Angles
+    );
+
+    // Game thread.  Replaces the texels of a texture made by
+    // CreateIlluminationTexture, of the same size.
+    SPICE_API bool UpdateIlluminationTexture(
+        UTexture2D* Texture,
+        const FIlluminationAngleBatch& Angles
+    );
+
+    struct FPlanetLighting
+    {
+        // Target center's epoch (subslr's/subpnt's trgepc)
+        FSEphemerisTime TargetEpoch;
+        // Target centered, in the body fixed frame at TargetEpoch
+        FSDistanceVector Observer;
+        FSDistanceVector Source;
+        // Nearest points on the RADII ellipsoid to the observer and the
+        // source (subpnt/subslr "NEAR POINT/ELLIPSOID"), body fixed.  Zero
+        // if the target has no radii.
+        FSDistanceVector SubObserver;
+        FSDistanceVector SubSource;
+        bool bHasRadii = false;
+        // Unit vector from the target to the source, in ref
+        FSDimensionlessVector SourceDirection;
+        // Body fixed to ref, at TargetEpoch
+        FSRotationMatrix BodyToRef;
+    };
+
+    // Uses CSPICE.  One entry per target.  Each target's body fixed frame is
+    // its cidfrm_c frame (IAU_<name>, unless a frame kernel says otherwise).
+    // ref must be inertial.  abcorr is as IlluminationGeometry's.  Stops at
+    // the first failure.
+    SPICE_API bool PlanetLighting(
+        const FSEphemerisTime& et,
+        TArrayView<const FString> Targets,
+        TArray<FPlanetLighting>& Lighting,
+        const FString& ilusrc = TEXT("SUN"),
+        const FString& ref = TEXT("ECLIPJ2000"),
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::LT_S,
+        const FString& obsrvr = TEXT("EARTH"),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Game thread.  For each target i, sets these vector parameters of
+    // Collection's instance in WorldContextObject's world, where they exist:
+    //    <Prefixes[i]>SourceDirection:  SourceDirection, UE coordinates
+    //    <Prefixes[i]>SubSource:  (lon, lat, alt) of the sub-source point
+    //    <Prefixes[i]>SubObserver:  (lon, lat, alt) of the sub-observer point
+    // Longitudes and latitudes are planetocentric, radians;  altitudes are
+    // the source's and observer's above the point, km.  Returns the number
+    // of parameters set.
+    SPICE_API int32 SetPlanetLightingParameters(
+        const UObject* WorldContextObject,
+        UMaterialParameterCollection* Collection,
+        TArrayView<const FName> Prefixes,
+        TArrayView<const FPlanetLighting> Lighting
+    );
+}
@@ -0,0 +1,239 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceIntegrator.h
+//
+// API Comments
+//
+// Purpose:  Numerical orbit propagation of many objects at once, with
+// pluggable force models.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceIntegrator.h is part of the "refined C++ API".
+//
+// Spacecraft and debris that don't follow TLEs need real force models:  third
+// bodies, the central body's zonal harmonics, drag, solar radiation pressure.
+// Evaluating them with spkezr means every force evaluation of every step
+// goes through CSPICE, on one thread.
+//
+// FNumericalPropagator integrates the central body's point-mass gravity plus
+// any IForceModels with an adaptive Dormand-Prince 5(4) integrator, one
+// object per ParallelFor task.  Force models get the positions of other
+// bodies from an FChebyshevCache, so nothing touches CSPICE once the cache
+// is built:  Propagate is safe to call from any thread.  The cache has to be
+// built with the central body as observer, in the integration frame (which
+// must be inertial), over the whole span being integrated.
+//
+// Each object can produce an FTrajectory:  the integrator's own dense output
+// (a quartic per step, as DOPRI5's continuous extension), which can be
+// evaluated anywhere in the span or sampled into an FSpkSegmentWriter.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Ephemeris
+{
+    class FChebyshevCache;
+    class FSpkSegmentWriter;
+}
+
+namespace MaxQ::Orbits
+{
+    // A perturbing acceleration.  AddAcceleration is called concurrently,
+    // from worker threads, so it must be thread-safe, and must not call
+    // CSPICE.
+    class SPICE_API IForceModel
+    {
+    public:
+        virtual ~IForceModel() = default;
+
+        // Adds the acceleration (km/s^2) on Object at et, at state (km, km/s,
+        // relative to the central body) to a.  False fails the object's
+        // propagation.
+        virtual bool AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const = 0;
+    };
+
+    // Point mass third body, from a Chebyshev cache.  Its attraction on the
+    // object less its attraction on the central body.
+    class SPICE_API FThirdBodyForce : public IForceModel
+    {
+    public:
+        // body must be in Cache.  gm (km^3/s^2) as BODYnnn_GM.
+        FThirdBodyForce(TSharedRef<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> Cache, const FString& body, double gm);
+
+        bool IsValid() const { return BodyIndex != INDEX_NONE; }
+        virtual bool AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const override;
+
+    private:
+        TSharedRef<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> Cache;
+        int32 BodyIndex = INDEX_NONE;
+        double GM = 0.;
+    };
+
+    // The central body's zonal harmonics, J2 to Jn, about a fixed pole
+    class SPICE_API FZonalGravityForce : public IForceModel
+    {
+    public:
+        // J[0] is J2, J[1] is J3, and so on.  radius (km) is the radius
+        // they're normalized to.  pole is the body's north pole, in the
+        // integration frame.
+        FZonalGravityForce(double gm, double radius, TArrayView<const double> J, const FSDimensionlessVector& pole = FSDimensionlessVector(0., 0., 1.));
+
+        virtual bool AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const override;
+
+    private:
+        double GM = 0.;
+        double Radius = 0.;
+        TArray<double> J;
+        double Pole[3] = { 0., 0., 1. };
+    };
+
+    // Drag in an exponential atmosphere, which rotates with the body
+    class SPICE_API FExponentialDragForce : public IForceModel
+    {
+    public:
+        struct FAtmosphere
+        {
+            // Spherical body (km)
+            double Radius = 6378.137;
+            // Density (kg/m^3) at a reference altitude (km), and its scale
+            // height (km)
+            double ReferenceDensity = 3.614e-13;
+            double ReferenceAltitude = 700.;
+            double ScaleHeight = 88.667;
+            // Above this, no drag
+            double MaxAltitude = 2500.;
+            // The body's rotation (rad/s), in the integration frame
+            FSDimensionlessVector AngularVelocity = FSDimensionlessVector(0., 0., 7.292115e-5);
+        };
+
+        // Ballistic coefficients Cd * A / m (m^2/kg):  one for every object,
+        // or one per object
+        FExponentialDragForce(const FAtmosphere& Atmosphere, TArrayView<const double> BallisticCoefficients);
+
+        virtual bool AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const override;
+
+    private:
+        FAtmosphere Atmosphere;
+        TArray<double> Coefficients;
+    };
+
+    // Cannonball solar radiation pressure, with the central body's
+    // cylindrical shadow
+    class SPICE_API FSolarRadiationPressureForce : public IForceModel
+    {
+    public:
+        // The Sun must be in Cache.  Cr * A / m (m^2/kg):  one for every
+        // object, or one per object.  shadowRadius (km) of zero:  no
+        // shadow.
+        FSolarRadiationPressureForce(TSharedRef<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> Cache, const FString& sun, TArrayView<const double> ReflectivityCoefficients, double shadowRadius = 0.);
+
+        bool IsValid() const { return SunIndex != INDEX_NONE; }
+        virtual bool AddAcceleration(int32 Object, double et, const double(&state)[6], double(&a)[3]) const override;
+
+    private:
+        TSharedRef<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> Cache;
+        int32 SunIndex = INDEX_NONE;
+        TArray<double> Coefficients;
+        double ShadowRadius = 0.;
+    };
+
+
+    // One object's dense output
+    class SPICE_API FTrajectory
+    {
+    public:
+        bool IsEmpty() const { return Steps.Num() == 0; }
+        int32 NumSteps() const { return Steps.Num(); }
+        // The span integrated, whichever direction
+        double GetStart() const;
+        double GetStop() const;
+
+        // Thread-safe.  False if et is outside the span.
+        bool Evaluate(double et, double(&state)[6]) const;
+        bool State(const FSEphemerisTime& et, FSStateVector& state) const;
+
+        // States every step seconds across the span (and at its end), in
+        // increasing time, handed to Writer (which must have Begun).
+        bool Write(
+            MaxQ::Ephemeris::FSpkSegmentWriter& Writer,
+            double step,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        ) const;
+
+        void Reset() { Steps.Empty(); Coefficients.Empty(); }
+
+    private:
+        friend class FNumericalPropagator;
+
+        struct FStep
+        {
+            double Start = 0.;
+            double Length = 0.;
+        };
+
+        // Sorted by increasing time (whichever way it was integrated)
+        TArray<FStep> Steps;
+        // Per step, 5 x 6 interpolation coefficients
+        TArray<double> Coefficients;
+    };
+
+
+    struct FIntegratorSettings
+    {
+        // Per component:  atol + rtol * |y|  (km, km/s)
+        double RelativeTolerance = 1e-11;
+        double AbsoluteTolerance = 1e-9;
+        // Seconds
+        double InitialStep = 10.;
+        double MaxStep = 86400.;
+        double MinStep = 1e-6;
+        int32 MaxSteps = 1000000;
+    };
+
+    class SPICE_API FNumericalPropagator
+    {
+    public:
+        // gm (km^3/s^2) of the central body
+        explicit FNumericalPropagator(double gm, const FIntegratorSettings& Settings = FIntegratorSettings());
+
+        void AddForce(TSharedRef<const IForceModel, ESPMode::ThreadSafe> Force);
+        int32 NumForces() const { return Forces.Num(); }
+
+        // Integrates each of States (at et0) to et1, which can be before et0.
+        // OutStates, if not empty, gets the states at et1.  OutTrajectories,
+        // if not empty, gets each object's dense output.  valid[i] is false
+        // (and the outputs zeroed) if a force model failed, the step size
+        // underflowed, or MaxSteps ran out.  Returns the number propagated.
+        // Thread-safe (no CSPICE).
+        int32 Propagate(
+            TArrayView<const FSStateVector> States,
+            const FSEphemerisTime& et0,
+            const FSEphemerisTime& et1,
+            TArrayView<FSStateVector> OutStates,
+            TArrayView<FTrajectory> OutTrajectories = {},
+            TArrayView<bool> valid = {}
+        ) const;
+
+    private:
+        bool Derivative(int32 Object, double et, const double(&y)[6], double(&dy)[6]) const;
+        bool Integrate(int32 Object, double et0, const double(&y0)[6], double et1, double(&y1)[6], FTrajectory* Trajectory) const;
+
+        double GM = 0.;
+        FIntegratorSettings Settings;
+        TArray<TSharedRef<const IForceModel, ESPMode::ThreadSafe>> Forces;
+    };
+}
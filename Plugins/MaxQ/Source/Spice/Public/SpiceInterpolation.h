@@ -0,0 +1,80 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceInterpolation.h
+//
+// API Comments
+//
+// Purpose:  Lagrange and Hermite interpolation of many channels at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceInterpolation.h is part of the "refined C++ API".
+//
+// USpice::lgrind and hrmint build the interpolating polynomial from scratch
+// (CSPICE's Neville-style tableau) for one channel at one abscissa per call.
+// FPolynomialInterpolator builds each channel's divided differences (the
+// polynomial's Newton form) once, for any number of channels sharing the
+// same abscissas, then evaluates value and derivative for all of them at
+// any number of points:  O(n) per channel per point, instead of O(n^2).
+// Results are lgrind_c's and hrmint_c's, to rounding.
+//
+// Channels are structure-of-arrays:  channel c's data is a contiguous run of
+// the input, and its results a contiguous run of the output.  Evaluation is
+// native, const, and safe from any thread;  the many-points overload runs in
+// parallel chunks.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Math
+{
+    class SPICE_API FPolynomialInterpolator
+    {
+    public:
+        // As lgrind_c:  yvals is numChannels runs of xvals.Num() values.
+        // False (and nothing built) if the sizes don't agree or an abscissa
+        // is repeated.
+        bool BuildLagrange(TArrayView<const double> xvals, TArrayView<const double> yvals, int32 numChannels = 1);
+
+        // As hrmint_c:  yvals is numChannels runs of 2 * xvals.Num() values,
+        // each run the function and its derivative at each abscissa in turn.
+        bool BuildHermite(TArrayView<const double> xvals, TArrayView<const double> yvals, int32 numChannels = 1);
+
+        void Reset();
+
+        bool IsValid() const { return Channels > 0; }
+        int32 NumChannels() const { return Channels; }
+        // The polynomial's degree, plus one
+        int32 NumCoefficients() const { return Nodes.Num(); }
+
+        // Every channel at x.  p (and dp, if not empty) get NumChannels()
+        // values.
+        void Evaluate(double x, TArrayView<double> p, TArrayView<double> dp = {}) const;
+
+        // Every channel at every x.  Channel c at xs[i] is p[c * xs.Num() + i]
+        // (and dp's, if dp isn't empty).
+        void Evaluate(TArrayView<const double> xs, TArrayView<double> p, TArrayView<double> dp = {}) const;
+
+    private:
+        bool Allocate(TArrayView<const double> xvals, int32 NumNodes, int32 numChannels);
+
+        // The Newton form's nodes (Hermite repeats each abscissa)
+        TArray<double> Nodes;
+        // Coefficient k of channel c at k * Channels + c, so each step of the
+        // evaluation walks all the channels contiguously
+        TArray<double> Coefficients;
+        int32 Channels = 0;
+    };
+}
@@ -67,6 +67,22 @@
 #include "SpiceTypes.h"
 #include "SpiceK2.generated.h"
 
+// One bodvrd/bodvcd/gdpool node's last value.  The node keeps one as a
+// member of the Blueprint, so a repeated lookup is a compare against the
+// kernel pool generation (MaxQ::Data::GetPoolGeneration) and the inputs.
+// Transient:  nothing here is serialized.
+USTRUCT(BlueprintType)
+struct SPICE_API FSPoolValueCache
+{
+    GENERATED_BODY()
+
+    uint64 Generation = 0;
+    FString Name;
+    FString Item;
+    int32 Index = 0;
+    TArray<double> Values;
+};
+
 UCLASS(Category = "MaxQ")
 class SPICE_API USpiceK2 : public UBlueprintFunctionLibrary
 {
@@ -155,6 +171,98 @@ public:
     );
     static constexpr ANSICHAR gdpool_array[] = "gdpool_array_K2";
 
+    // The same, cached per node (see FSPoolValueCache).  Errors aren't
+    // cached.
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static double bodvrd_double_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FString& bodynm,
+        const FString& item,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR bodvrd_double_cached[] = "bodvrd_double_cached_K2";
+
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static FSDimensionlessVector bodvrd_vector_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FString& bodynm,
+        const FString& item,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR bodvrd_vector_cached[] = "bodvrd_vector_cached_K2";
+
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static TArray<double> bodvrd_array_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FString& bodynm,
+        const FString& item,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR bodvrd_array_cached[] = "bodvrd_array_cached_K2";
+
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static double bodvcd_double_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        int bodyid,
+        const FString& item,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR bodvcd_double_cached[] = "bodvcd_double_cached_K2";
+
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static FSDimensionlessVector bodvcd_vector_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        int bodyid,
+        const FString& item,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR bodvcd_vector_cached[] = "bodvcd_vector_cached_K2";
+
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static TArray<double> bodvcd_array_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        int bodyid,
+        const FString& item,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR bodvcd_array_cached[] = "bodvcd_array_cached_K2";
+
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static double gdpool_double_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FString& name,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR gdpool_double_cached[] = "gdpool_double_cached_K2";
+
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static FSDimensionlessVector gdpool_vector_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FString& name,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR gdpool_vector_cached[] = "gdpool_vector_cached_K2";
+
+    UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "MaxQ|Internal", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static TArray<double> gdpool_array_cached_K2(
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage,
+        const FString& name,
+        int start,
+        UPARAM(ref) FSPoolValueCache& cache
+    );
+    static constexpr ANSICHAR gdpool_array_cached[] = "gdpool_array_cached_K2";
+
+    static constexpr ANSICHAR pool_cache[] = "cache";
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static FSRotationMatrix mtxm_matrix_K2(
         const FSRotationMatrix& m1,
@@ -222,6 +330,50 @@ public:
     );
     static constexpr TCHAR mxv_state_vector[] = TEXT("mxv_state_vector_K2");
 
+    // Fused:  the same, on the unit types
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSDistanceVector mxv_SDistanceVector_K2(
+        const FSRotationMatrix& m,
+        const FSDistanceVector& v
+    );
+    static constexpr TCHAR mxv_SDistanceVector[] = TEXT("mxv_SDistanceVector_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSVelocityVector mxv_SVelocityVector_K2(
+        const FSRotationMatrix& m,
+        const FSVelocityVector& v
+    );
+    static constexpr TCHAR mxv_SVelocityVector[] = TEXT("mxv_SVelocityVector_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSAngularVelocity mxv_SAngularVelocity_K2(
+        const FSRotationMatrix& m,
+        const FSAngularVelocity& v
+    );
+    static constexpr TCHAR mxv_SAngularVelocity[] = TEXT("mxv_SAngularVelocity_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSStateVector mxv_SStateVector_K2(
+        const FSStateTransform& m,
+        const FSStateVector& v
+    );
+    static constexpr TCHAR mxv_SStateVector[] = TEXT("mxv_SStateVector_K2");
+
+    // Arrays:  one matrix, applied to every element (SpiceMathBatch)
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> mxv_vector_array_K2(
+        const FSRotationMatrix& m,
+        const TArray<FSDimensionlessVector>& v
+    );
+    static constexpr TCHAR mxv_vector_array[] = TEXT("mxv_vector_array_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessStateVector> mxv_state_vector_array_K2(
+        const FSStateTransform& m,
+        const TArray<FSDimensionlessStateVector>& v
+    );
+    static constexpr TCHAR mxv_state_vector_array[] = TEXT("mxv_state_vector_array_K2");
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static FSDimensionlessVector qderiv_vector_K2(
         const FSDimensionlessVector& f0,
@@ -264,6 +416,14 @@ public:
     static constexpr TCHAR unorm_vector_output_mag[] = TEXT("vmag");
     static constexpr TCHAR unorm_vector_output_direction[] = TEXT("vout");
 
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static void unorm_vector_array_K2(
+        const TArray<FSDimensionlessVector>& v,
+        TArray<FSDimensionlessVector>& vout,
+        TArray<double>& vmag
+    );
+    static constexpr TCHAR unorm_vector_array[] = TEXT("unorm_vector_array_K2");
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static FSDimensionlessVector vadd_vector_K2(
         const FSDimensionlessVector& v1,
@@ -282,6 +442,52 @@ public:
     );
     static constexpr TCHAR vadd_state_vector[] = TEXT("vadd_state_vector_K2");
 
+    // Fused:  the same, on the unit types, so a typed vadd is one call
+    // rather than a conversion on either side of the dimensionless one
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSDistanceVector vadd_SDistanceVector_K2(
+        const FSDistanceVector& v1,
+        const FSDistanceVector& v2
+    );
+    static constexpr TCHAR vadd_SDistanceVector[] = TEXT("vadd_SDistanceVector_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSVelocityVector vadd_SVelocityVector_K2(
+        const FSVelocityVector& v1,
+        const FSVelocityVector& v2
+    );
+    static constexpr TCHAR vadd_SVelocityVector[] = TEXT("vadd_SVelocityVector_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSAngularVelocity vadd_SAngularVelocity_K2(
+        const FSAngularVelocity& v1,
+        const FSAngularVelocity& v2
+    );
+    static constexpr TCHAR vadd_SAngularVelocity[] = TEXT("vadd_SAngularVelocity_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSStateVector vadd_SStateVector_K2(
+        const FSStateVector& v1,
+        const FSStateVector& v2
+    );
+    static constexpr TCHAR vadd_SStateVector[] = TEXT("vadd_SStateVector_K2");
+
+    // Arrays, element-wise.  If v1 and v2 differ in length, the result is as
+    // long as the shorter.
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> vadd_vector_array_K2(
+        const TArray<FSDimensionlessVector>& v1,
+        const TArray<FSDimensionlessVector>& v2
+    );
+    static constexpr TCHAR vadd_vector_array[] = TEXT("vadd_vector_array_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessStateVector> vadd_state_vector_array_K2(
+        const TArray<FSDimensionlessStateVector>& v1,
+        const TArray<FSDimensionlessStateVector>& v2
+    );
+    static constexpr TCHAR vadd_state_vector_array[] = TEXT("vadd_state_vector_array_K2");
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static FSDimensionlessVector vcrss_vector_K2(
         const FSDimensionlessVector& v1,
@@ -350,6 +556,31 @@ public:
     static constexpr ANSICHAR vnorm_vector[] = "vnorm_vector_K2";
     static constexpr ANSICHAR vnorm_in[] = "v";
 
+    // Fused:  the same, on the unit types
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSDistance vnorm_SDistanceVector_K2(
+        const FSDistanceVector& v
+    );
+    static constexpr ANSICHAR vnorm_SDistanceVector[] = "vnorm_SDistanceVector_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSSpeed vnorm_SVelocityVector_K2(
+        const FSVelocityVector& v
+    );
+    static constexpr ANSICHAR vnorm_SVelocityVector[] = "vnorm_SVelocityVector_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSAngularRate vnorm_SAngularVelocity_K2(
+        const FSAngularVelocity& v
+    );
+    static constexpr ANSICHAR vnorm_SAngularVelocity[] = "vnorm_SAngularVelocity_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<double> vnorm_vector_array_K2(
+        const TArray<FSDimensionlessVector>& v
+    );
+    static constexpr ANSICHAR vnorm_vector_array[] = "vnorm_vector_array_K2";
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static FSDimensionlessVector vpack_vector_K2(
         double x,
@@ -418,6 +649,51 @@ public:
     );
     static constexpr TCHAR vsub_state_vector[] = TEXT("vsub_state_vector_K2");
 
+    // Fused:  the same, on the unit types, so a typed vsub is one call
+    // rather than a conversion on either side of the dimensionless one
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSDistanceVector vsub_SDistanceVector_K2(
+        const FSDistanceVector& v1,
+        const FSDistanceVector& v2
+    );
+    static constexpr TCHAR vsub_SDistanceVector[] = TEXT("vsub_SDistanceVector_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSVelocityVector vsub_SVelocityVector_K2(
+        const FSVelocityVector& v1,
+        const FSVelocityVector& v2
+    );
+    static constexpr TCHAR vsub_SVelocityVector[] = TEXT("vsub_SVelocityVector_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSAngularVelocity vsub_SAngularVelocity_K2(
+        const FSAngularVelocity& v1,
+        const FSAngularVelocity& v2
+    );
+    static constexpr TCHAR vsub_SAngularVelocity[] = TEXT("vsub_SAngularVelocity_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static FSStateVector vsub_SStateVector_K2(
+        const FSStateVector& v1,
+        const FSStateVector& v2
+    );
+    static constexpr TCHAR vsub_SStateVector[] = TEXT("vsub_SStateVector_K2");
+
+    // Arrays, element-wise (as long as the shorter of v1 and v2)
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> vsub_vector_array_K2(
+        const TArray<FSDimensionlessVector>& v1,
+        const TArray<FSDimensionlessVector>& v2
+    );
+    static constexpr TCHAR vsub_vector_array[] = TEXT("vsub_vector_array_K2");
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessStateVector> vsub_state_vector_array_K2(
+        const TArray<FSDimensionlessStateVector>& v1,
+        const TArray<FSDimensionlessStateVector>& v2
+    );
+    static constexpr TCHAR vsub_state_vector_array[] = TEXT("vsub_state_vector_array_K2");
+
     UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
     static void vupack_vector_K2(
         const FSDimensionlessVector& v,
@@ -561,5 +837,50 @@ public:
     static FSDistance Conv_SDimensionlessVector_Z_ToSDistance_K2(const FSDimensionlessVector& value);
     static constexpr ANSICHAR Conv_SDimensionlessVector_Z_ToSDistance[] = "Conv_SDimensionlessVector_Z_ToSDistance_K2";
 
+    // Arrays, element by element
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDistance> Conv_DoubleArrayToSDistanceArray_K2(const TArray<double>& value);
+    static constexpr ANSICHAR Conv_DoubleArrayToSDistanceArray[] = "Conv_DoubleArrayToSDistanceArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSSpeed> Conv_DoubleArrayToSSpeedArray_K2(const TArray<double>& value);
+    static constexpr ANSICHAR Conv_DoubleArrayToSSpeedArray[] = "Conv_DoubleArrayToSSpeedArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSAngularRate> Conv_DoubleArrayToSAngularRateArray_K2(const TArray<double>& value);
+    static constexpr ANSICHAR Conv_DoubleArrayToSAngularRateArray[] = "Conv_DoubleArrayToSAngularRateArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDistanceVector> Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2(const TArray<FSDimensionlessVector>& value);
+    static constexpr ANSICHAR Conv_SDimensionlessVectorArrayToSDistanceVectorArray[] = "Conv_SDimensionlessVectorArrayToSDistanceVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSVelocityVector> Conv_SDimensionlessVectorArrayToSVelocityVectorArray_K2(const TArray<FSDimensionlessVector>& value);
+    static constexpr ANSICHAR Conv_SDimensionlessVectorArrayToSVelocityVectorArray[] = "Conv_SDimensionlessVectorArrayToSVelocityVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSAngularVelocity> Conv_SDimensionlessVectorArrayToSAngularVelocityArray_K2(const TArray<FSDimensionlessVector>& value);
+    static constexpr ANSICHAR Conv_SDimensionlessVectorArrayToSAngularVelocityArray[] = "Conv_SDimensionlessVectorArrayToSAngularVelocityArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> Conv_SDistanceVectorArrayToSDimensionlessVectorArray_K2(const TArray<FSDistanceVector>& value);
+    static constexpr ANSICHAR Conv_SDistanceVectorArrayToSDimensionlessVectorArray[] = "Conv_SDistanceVectorArrayToSDimensionlessVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> Conv_SVelocityVectorArrayToSDimensionlessVectorArray_K2(const TArray<FSVelocityVector>& value);
+    static constexpr ANSICHAR Conv_SVelocityVectorArrayToSDimensionlessVectorArray[] = "Conv_SVelocityVectorArrayToSDimensionlessVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessVector> Conv_SAngularVelocityArrayToSDimensionlessVectorArray_K2(const TArray<FSAngularVelocity>& value);
+    static constexpr ANSICHAR Conv_SAngularVelocityArrayToSDimensionlessVectorArray[] = "Conv_SAngularVelocityArrayToSDimensionlessVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSStateVector> Conv_SDimensionlessStateVectorArrayToSStateVectorArray_K2(const TArray<FSDimensionlessStateVector>& value);
+    static constexpr ANSICHAR Conv_SDimensionlessStateVectorArrayToSStateVectorArray[] = "Conv_SDimensionlessStateVectorArrayToSStateVectorArray_K2";
+
+    UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "MaxQ|Internal")
+    static TArray<FSDimensionlessStateVector> Conv_SStateVectorArrayToSDimensionlessStateVectorArray_K2(const TArray<FSStateVector>& value);
+    static constexpr ANSICHAR Conv_SStateVectorArrayToSDimensionlessStateVectorArray[] = "Conv_SStateVectorArrayToSDimensionlessStateVectorArray_K2";
+
     static constexpr TCHAR conv_input[] = TEXT("value");
 };
@@ -0,0 +1,157 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelAsset.h
+//
+// API Comments
+//
+// Purpose:  Kernels as assets, loaded with the levels that use them.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelAsset.h is part of the "refined C++ API" and "Blueprints API".
+//
+// Loose kernels under /Content/NonAssetData are staged whole, outside the
+// asset system:  nothing knows which level needs which, and they're read
+// with blocking IO.  USpiceKernelAsset holds a kernel's bytes as bulk data,
+// with its type and coverage (ids and windows, for binary SPK/CK/PCK) as
+// searchable metadata.  It cooks like any other asset (pak/IoStore
+// compression included), can be chunked by the Asset Manager (it's a
+// primary data asset), and loads asynchronously.
+//
+// CSPICE can only load files, so Furnsh hands the bytes to
+// MaxQ::Data::FurnshBuffer, which extracts them once to a content-named file
+// under Saved/MaxQ/Kernels.  Assets count their loads:  the kernel is
+// furnsh'ed on the first and unloaded after the last, so levels that share
+// one don't unload it from under each other.  Meta-kernels can't be assets
+// (the files they list aren't).
+//
+// Create one as a Data Asset (Miscellaneous > Data Asset >
+// SpiceKernelAsset), set SourceFile, and press Reimport.
+//
+// UMaxQKernelSetComponent streams a list of them in when its actor begins
+// play (through the Asset Manager's FStreamableManager), furnshes them in
+// order, and unloads them when it ends.  Placed in a streaming level, the
+// kernels come and go with the level.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Components/ActorComponent.h"
+#include "Serialization/BulkData.h"
+#include "SpiceTypes.h"
+#include "SpiceKernelAsset.generated.h"
+
+struct FStreamableHandle;
+
+
+USTRUCT(BlueprintType)
+struct SPICE_API FSpiceKernelAssetCoverage
+{
+    GENERATED_BODY()
+
+    // SPK:  body, CK:  instrument/structure, PCK:  frame class ID
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ|Kernel") int32 Id = 0;
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ|Kernel") TArray<FSEphemerisTimeWindowSegment> Intervals;
+};
+
+
+UCLASS(BlueprintType)
+class SPICE_API USpiceKernelAsset : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    // The kernel's file name (extension included)
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, AssetRegistrySearchable, Category = "MaxQ|Kernel") FString FileName;
+    // getfat:  "SPK", "CK", "PCK", "DSK", "LSK", "FK", "IK", "SCLK", "TEXT"...
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, AssetRegistrySearchable, Category = "MaxQ|Kernel") FString KernelType;
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ|Kernel") int64 Size = 0;
+    // Binary SPK, CK and PCK only
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ|Kernel") TArray<FSpiceKernelAssetCoverage> Coverage;
+
+#if WITH_EDITORONLY_DATA
+    UPROPERTY(EditAnywhere, Category = "MaxQ|Kernel", meta = (FilePathFilter = "Kernels (*.bsp;*.bc;*.bpc;*.bds;*.tls;*.tpc;*.tf;*.ti;*.tsc)|*.bsp;*.bc;*.bpc;*.bds;*.tls;*.tpc;*.tf;*.ti;*.tsc|All files (*.*)|*.*"))
+    FFilePath SourceFile;
+#endif
+
+    // Loads the kernel, or counts another load of it.  Call where SPICE calls
+    // are made.
+    bool Furnsh(ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+    // Unloads it after the last Furnsh is matched
+    bool Unload(ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Kernel")
+    bool IsFurnshed() const { return LoadCount > 0; }
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Kernel", meta = (ExpandEnumAsExecs = "ResultCode", DisplayName = "Furnsh Kernel Asset"))
+    void K2_Furnsh(ES_ResultCode& ResultCode, FString& ErrorMessage);
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Kernel", meta = (ExpandEnumAsExecs = "ResultCode", DisplayName = "Unload Kernel Asset"))
+    void K2_Unload(ES_ResultCode& ResultCode, FString& ErrorMessage);
+
+#if WITH_EDITOR
+    // Replaces the payload and metadata with the file's
+    bool ImportFile(const FString& AbsolutePath, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+    // Imports SourceFile again
+    UFUNCTION(CallInEditor, Category = "MaxQ|Kernel")
+    void Reimport();
+#endif
+
+    virtual void Serialize(FArchive& Ar) override;
+
+private:
+    // The name FurnshBuffer/UnloadBuffer know it by:  unique per asset, and
+    // ending with FileName
+    FString BufferName() const;
+
+    FByteBulkData Payload;
+    int32 LoadCount = 0;
+};
+
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FMaxQKernelSetLoadedDelegate);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQKernelSetErrorDelegate, const FString&, ErrorMessage);
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API UMaxQKernelSetComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    // Furnsh'ed in this order (the last has the highest precedence)
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "MaxQ|Kernel") TArray<TSoftObjectPtr<USpiceKernelAsset>> Kernels;
+
+    // After every kernel is loaded
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Kernel") FMaxQKernelSetLoadedDelegate OnLoaded;
+    // Once per kernel that fails (the rest are still loaded)
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Kernel") FMaxQKernelSetErrorDelegate OnError;
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Kernel")
+    bool IsLoaded() const { return bLoaded; }
+
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+    void OnStreamed();
+    void UnloadKernels();
+
+    TSharedPtr<FStreamableHandle> Handle;
+    // What this component furnsh'ed, to unload
+    UPROPERTY(Transient) TArray<TObjectPtr<USpiceKernelAsset>> Furnshed;
+    bool bLoaded = false;
+};
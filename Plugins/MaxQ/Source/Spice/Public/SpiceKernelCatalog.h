@@ -0,0 +1,168 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelCatalog.h
+//
+// API Comments
+//
+// Purpose:  Coverage-indexed, on demand kernel loading.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelCatalog.h is part of the "refined C++ API".
+//
+// Mission kernel sets (years of reconstructed SPKs and CKs) are far bigger
+// than what any one session looks at, and loading all of them costs launch
+// time, memory, and CSPICE's file table (FTSIZE).  A catalog scans each
+// binary kernel's coverage once (spkobj/spkcov, ckobj/ckcov, pckfrm/pckcov),
+// can persist the result, and loads a file only when a query needs it.
+// Once more than MaxLoaded catalogued files are loaded, the least recently
+// used ones are unloaded.
+//
+// Where files overlap, the one added last is the one loaded.  Only the files
+// the catalog loaded itself are ever unloaded by it.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceWindow.h"
+
+namespace MaxQ::Data
+{
+    enum class EKernelCatalogType : uint8
+    {
+        SPK,
+        CK,
+        PCK,
+        Count
+    };
+
+    class SPICE_API FKernelCatalog
+    {
+    public:
+        // MaxLoaded = 0:  no limit
+        explicit FKernelCatalog(int32 MaxLoaded = 16);
+        // Unloads what the catalog loaded
+        ~FKernelCatalog();
+
+        // Scans binary SPK, CK and PCK files (paths as Furnsh).  Files
+        // already in the catalog aren't rescanned unless their size or
+        // timestamp changed.  CK coverage is in TDB, so CK files need an
+        // LSK and their SCLK kernels loaded to be scanned.
+        bool Add(
+            const TArray<FString>& relativePaths,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // The scanned coverage, so later sessions can skip the scan.  Files
+        // that changed since it was saved are rescanned by Load.
+        bool Save(
+            const FString& relativePath,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        ) const;
+
+        bool Load(
+            const FString& relativePath,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Loads the catalogued file that covers Id at et (SPK:  a body, CK:
+        // an instrument/structure, PCK:  a frame class ID), if it isn't
+        // already loaded.  Nothing covering it isn't an error (other loaded
+        // kernels may), bCovered says whether the catalog did.
+        // The catalog only knows about the objects themselves:  an SPK
+        // query also needs the chain to its observer (centers, barycenters)
+        // ensured, or covered by kernels that are always loaded.
+        bool Ensure(
+            EKernelCatalogType Type,
+            int Id,
+            double et,
+            bool* bCovered = nullptr,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        bool EnsureSpk(int Body, double et, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr)
+        {
+            return Ensure(EKernelCatalogType::SPK, Body, et, nullptr, ResultCode, ErrorMessage);
+        }
+
+        // Both ends of an spkezr/spkpos query
+        bool EnsureSpk(int Target, int Observer, double et, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr)
+        {
+            return EnsureSpk(Target, et, ResultCode, ErrorMessage) && EnsureSpk(Observer, et, ResultCode, ErrorMessage);
+        }
+
+        bool EnsureCk(int Instrument, double et, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr)
+        {
+            return Ensure(EKernelCatalogType::CK, Instrument, et, nullptr, ResultCode, ErrorMessage);
+        }
+
+        bool EnsurePck(int FrameClassId, double et, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr)
+        {
+            return Ensure(EKernelCatalogType::PCK, FrameClassId, et, nullptr, ResultCode, ErrorMessage);
+        }
+
+        // Coverage of Id over every catalogued file of that type
+        MaxQ::GeometryFinder::FSWindow Coverage(EKernelCatalogType Type, int Id) const;
+
+        void SetMaxLoaded(int32 MaxLoaded);
+        int32 GetMaxLoaded() const { return MaxLoaded; }
+
+        int32 NumFiles() const { return Files.Num(); }
+        int32 NumLoaded() const;
+        bool IsLoaded(const FString& relativePath) const;
+
+        void UnloadAll();
+
+        FKernelCatalog(const FKernelCatalog&) = delete;
+        FKernelCatalog& operator=(const FKernelCatalog&) = delete;
+
+    private:
+        struct FObjectCoverage
+        {
+            int32 Id = 0;
+            MaxQ::GeometryFinder::FSWindow Window;
+        };
+
+        struct FFile
+        {
+            FString Path;
+            EKernelCatalogType Type = EKernelCatalogType::SPK;
+            int64 Size = 0;
+            FDateTime Timestamp;
+            TArray<FObjectCoverage> Objects;
+
+            // Loaded by the catalog (and not unloaded since)
+            bool bLoaded = false;
+            uint64 LastUsed = 0;
+        };
+
+        bool Scan(FFile& File, ES_ResultCode* ResultCode, FString* ErrorMessage);
+        void RebuildIndex();
+        // Picks up Unload/ClearAll calls made behind the catalog's back
+        void SyncLoaded();
+        bool Evict(int32 Keep, ES_ResultCode* ResultCode, FString* ErrorMessage);
+
+        TArray<FFile> Files;
+        // Id -> indices into Files, in the order they were added
+        TMap<int32, TArray<int32>> Index[(int32)EKernelCatalogType::Count];
+
+        int32 MaxLoaded;
+        uint64 UseCount = 0;
+        uint64 KernelGeneration = 0;
+    };
+}
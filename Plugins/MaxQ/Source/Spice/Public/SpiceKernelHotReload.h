@@ -0,0 +1,106 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelHotReload.h
+//
+// API Comments
+//
+// Purpose:  Reload kernels that change on disk, without a clear_all.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelHotReload.h is part of the "refined C++ API".
+//
+// When an updated SPK or FK lands in the kernel directory, only it needs
+// reloading...  almost.  CSPICE gives precedence by load order, so a file
+// that's re-furnsh'd jumps ahead of everything loaded after it.  To keep
+// the original order, the changed file and every later file it competes
+// with (the same kind of kernel:  SPK with SPK, text with text, etc) are
+// unloaded and re-furnsh'd in their original order.  Nothing before the
+// first changed file is touched.
+//
+// A file loaded by a meta-kernel is reloaded through its meta-kernel.
+//
+// OnKernelsReloaded says what was reloaded, so caches can invalidate only
+// what depends on it.  (The pool cache doesn't need it:  furnsh/unload
+// notify its watchers.  FKernelCoverageIndex::Add rescans changed files.)
+//
+// In the editor, changes to the directory are picked up automatically (on
+// the game thread).  Otherwise, call Poll.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "Delegates/Delegate.h"
+
+namespace MaxQ::Data
+{
+    struct SPICE_API FKernelReload
+    {
+        // Files whose contents changed (a missing file is unloaded)
+        TArray<FString> Changed;
+        // Files unloaded and furnsh'd again, in load order
+        TArray<FString> Reloaded;
+        // The kinds of kernel reloaded
+        ES_KernelType Kinds = ES_KernelType::NONE;
+    };
+
+    DECLARE_MULTICAST_DELEGATE_OneParam(FOnKernelsReloaded, const FKernelReload&);
+
+    class SPICE_API FKernelHotReload
+    {
+    public:
+        // Watches loaded kernels under relativeDirectory (as Furnsh).  An
+        // empty directory:  watch every loaded kernel (and no editor watcher).
+        explicit FKernelHotReload(const FString& relativeDirectory = TEXT("NonAssetData/kernels"));
+        ~FKernelHotReload();
+
+        // Checks the watched kernels, and reloads those that changed.  Calls
+        // CSPICE (so, on the SPICE thread).  Kernels loaded since the last
+        // Poll start being watched.
+        bool Poll(
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        FOnKernelsReloaded& OnKernelsReloaded() { return KernelsReloaded; }
+
+        int32 NumWatched() const { return Stamps.Num(); }
+
+        FKernelHotReload(const FKernelHotReload&) = delete;
+        FKernelHotReload& operator=(const FKernelHotReload&) = delete;
+
+    private:
+        struct FStamp
+        {
+            int64 Size = -1;
+            FDateTime Timestamp;
+
+            bool operator==(const FStamp& Other) const { return Size == Other.Size && Timestamp == Other.Timestamp; }
+        };
+
+        bool IsWatched(const FString& Path) const;
+        FStamp ReadStamp(const FString& Path) const;
+        void StampLoaded();
+
+        FString Directory;
+        TMap<FString, FStamp> Stamps;
+        // Files that failed to reload, retried when they change again
+        TMap<FString, FStamp> Pending;
+        FOnKernelsReloaded KernelsReloaded;
+
+#if WITH_EDITOR
+        FDelegateHandle WatcherHandle;
+#endif
+    };
+}
@@ -0,0 +1,112 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelPrefetch.h
+//
+// API Comments
+//
+// Purpose:  Binary kernel pages made resident ahead of playback.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelPrefetch.h is part of the "refined C++ API".
+//
+// Mapping kernels (SetMapBinaryKernels) keeps the OS from reading a kernel
+// twice, but a time warp jump still lands on record pages nobody has
+// touched, and spkezr waits on the page faults.  FKernelPagePrefetcher
+// turns the span of ephemeris time playback is heading into (forwards or
+// backwards, as FEphemerisPrefetcher's windows) into the byte ranges of the
+// segments that will serve it, from an FKernelCoverageIndex, and hands them
+// to PrefetchKernelRange.  Nothing waits:  the pages are hinted, or read on
+// a worker thread.
+//
+// Segments are assumed to spread their records evenly over their coverage,
+// which is exact for fixed-length records (SPK types 2 and 3, most CKs) and
+// close enough for the rest.  Each range is padded by a DAF record on either
+// side, and the segment's tail (where record directories, epochs and the
+// trailer live) is prefetched the first time a segment is.
+//
+// The prefetcher doesn't call CSPICE, so it's safe with an FSpiceExecutor
+// build in flight.  Update is a game thread call.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceWindow.h"
+#include "SpiceCoverageIndex.h"
+
+namespace MaxQ::Data
+{
+    struct FKernelPrefetchSettings
+    {
+        // Prefetch this much playback ahead (real seconds at the rate)...
+        double LookaheadSeconds = 8.;
+
+        // ...but at least this much ephemeris time...
+        double MinSpanSeconds = 3600.;
+
+        // ...and at most this much
+        double MaxSpanSeconds = 365.25 * 86400.;
+    };
+
+    // The file bytes of Segment's records for [Start, Stop] (TDB), padded
+    // by a DAF record either side and clamped to the segment.  False if the
+    // segment has no addresses (an index saved before they were kept) or
+    // doesn't overlap [Start, Stop].
+    SPICE_API bool GetSegmentRecordRange(const FCoverageSegment& Segment, double Start, double Stop, int64& Offset, int64& Bytes);
+
+    class SPICE_API FKernelPagePrefetcher
+    {
+    public:
+        // Copies the segments serving the SPK bodies (and the centers they're
+        // chained through), CK instruments/structures and PCK frame class
+        // IDs.  Only the part of each segment a higher priority segment
+        // doesn't mask is ever prefetched.
+        void Configure(
+            const FKernelCoverageIndex& Index,
+            const TArray<int>& SpkBodies,
+            const TArray<int>& CkIds = TArray<int>(),
+            const TArray<int>& PckFrames = TArray<int>(),
+            const FKernelPrefetchSettings& Settings = FKernelPrefetchSettings()
+        );
+
+        // Forgets what's been prefetched (and the segments)
+        void Reset();
+
+        // Once per frame.  et:  the playback epoch.  Rate:  ephemeris seconds
+        // per real second (negative plays backwards).  Prefetches the part
+        // of the span ahead that wasn't already.  Returns the bytes asked for.
+        int64 Update(const FSEphemerisTime& et, double Rate);
+
+        int32 NumSegments() const { return Segments.Num(); }
+        int64 BytesPrefetched() const { return TotalBytes; }
+
+    private:
+        struct FPrefetchSegment
+        {
+            int32 File = 0;
+            FCoverageSegment Segment;
+            // The time this segment serves
+            MaxQ::GeometryFinder::FSWindow Serves;
+            bool bTailDone = false;
+        };
+
+        TArray<FString> Paths;
+        TArray<FPrefetchSegment> Segments;
+        FKernelPrefetchSettings Settings;
+
+        // Already prefetched, near playback
+        MaxQ::GeometryFinder::FSWindow Done;
+        int64 TotalBytes = 0;
+    };
+}
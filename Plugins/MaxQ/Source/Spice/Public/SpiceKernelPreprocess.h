@@ -0,0 +1,109 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelPreprocess.h
+//
+// API Comments
+//
+// Purpose:  Getting kernels into the form that loads fastest, before they
+// ship.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelPreprocess.h is part of the "refined C++ API".
+//
+// What a kernel costs at load time depends on its form:
+// * Transfer files (.xsp, .xc, ... "DAFETF"/"DASETF") can't be loaded at all;
+//   they have to be converted to binary (NAIF's tobin).
+// * Binary DAFs written on a big-endian machine ("BIG-IEEE") load, but every
+//   record CSPICE reads is translated.  Converting them to the native format
+//   once (toxfr, then tobin) removes that.
+// * Text kernels are parsed on every load.  A baked pool snapshot
+//   (SpicePoolSnapshot.h) is loaded without parsing.
+//
+// The MaxQPreprocessKernels commandlet does all three to a directory of
+// kernels, typically before cooking:
+//
+//   UnrealEditor-Cmd <project> -run=MaxQPreprocessKernels
+//       [-Dir=NonAssetData/kernels]
+//       [-Text=a.tls,b.tpc,c.tf -Snapshot=NonAssetData/kernels/text.pool]
+//
+// Transfer files are converted next to themselves (the extension's leading
+// 'x' becomes 'b':  .xsp -> .bsp), non-native DAFs are converted in place,
+// and the text kernels (in load order, paths as Furnsh) are baked into the
+// snapshot, to load with MaxQ::Data::FurnshPoolSnapshot.  It fails (non-zero
+// exit) if any file couldn't be handled, so it can gate a build.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SpiceTypes.h"
+#include "SpiceKernelPreprocess.generated.h"
+
+namespace MaxQ::Data
+{
+    struct SPICE_API FKernelFormat
+    {
+        // getfat:  "DAF", "DAS", "KPL", "XFR", ...
+        FString Architecture;
+        // getfat:  "SPK", "CK", "LSK", ... ("DAF" or "DAS" for transfer files)
+        FString Type;
+        // DAF/DAS only:  "LTL-IEEE", "BIG-IEEE", or empty for files that
+        // predate the label (which CSPICE takes to be native)
+        FString BinaryFormat;
+
+        bool IsTransfer() const { return Architecture == TEXT("XFR"); }
+        bool IsBinary() const { return Architecture == TEXT("DAF") || Architecture == TEXT("DAS"); }
+        // Binary, and readable without translation
+        bool IsNative() const;
+    };
+
+    // Paths as Furnsh
+    SPICE_API bool GetKernelFormat(
+        const FString& relativePath,
+        FKernelFormat& Format,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // A DAF or DAS transfer file to a native binary kernel.  Replaces
+    // relativeDestination.
+    SPICE_API bool ConvertTransferKernel(
+        const FString& relativeSource,
+        const FString& relativeDestination,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // A DAF of any binary format to the native one (through a transfer
+    // file).  relativeDestination may be relativeSource.
+    SPICE_API bool ConvertDafToNative(
+        const FString& relativeSource,
+        const FString& relativeDestination,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
+
+
+UCLASS()
+class SPICE_API UMaxQPreprocessKernelsCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQPreprocessKernelsCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,82 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceKernelSubset.h
+//
+// API Comments
+//
+// Purpose:  Slim kernels for shipping, cut from bigger ones.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceKernelSubset.h is part of the "refined C++ API".
+//
+// A game that needs two years and ten bodies doesn't need to ship de440.bsp
+// or a mission's full CKs.  These write new kernels with only the segments
+// (and for SPKs, only the records) a time window and set of objects need.
+//
+// SPK segments are trimmed to the window by spksub, at record granularity:
+// the records are the source's own, so the subset evaluates to exactly the
+// same states (nothing is refit).  CK and PCK segments are copied whole.
+//
+// The USpiceKernelSubsetCommandlet does the same from the command line.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Data
+{
+    struct SPICE_API FKernelSubset
+    {
+        // TDB.  Segments that don't overlap [Start, Stop] are left out.
+        double Start = TNumericLimits<double>::Lowest();
+        double Stop = TNumericLimits<double>::Max();
+
+        // SPK bodies, CK instruments/structures, PCK frame class IDs.
+        // Empty:  all of them.
+        TArray<int32> Bodies;
+        TArray<int32> Instruments;
+        TArray<int32> Frames;
+
+        // Also keep the SPK segments the kept ones are relative to
+        // (barycenters, etc), as far as the source file has them
+        bool bIncludeCenters = true;
+
+        // Internal file name written to the new kernels
+        FString InternalFileName = TEXT("MaxQ kernel subset");
+    };
+
+    // One binary SPK, CK or PCK.  Nothing is written if the source has no
+    // segments in the subset (SegmentsWritten = 0), which isn't an error.
+    // An existing destination file is replaced.  CK windows are converted
+    // with the CK's SCLK, which must be loaded (as must an LSK).
+    SPICE_API bool SubsetKernel(
+        const FString& sourcePath,
+        const FString& destinationPath,
+        const FKernelSubset& Subset,
+        int32* SegmentsWritten = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Every loaded binary SPK, CK and PCK, each to a file of the same name
+    // in destinationDirectory.  WrittenPaths:  the files written.
+    SPICE_API bool SubsetLoadedKernels(
+        const FString& destinationDirectory,
+        const FKernelSubset& Subset,
+        TArray<FString>* WrittenPaths = nullptr,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
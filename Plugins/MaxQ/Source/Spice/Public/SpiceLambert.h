@@ -0,0 +1,127 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLambert.h
+//
+// API Comments
+//
+// Purpose:  Lambert's problem, and porkchop plots made of it.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLambert.h is part of the "refined C++ API".
+//
+// Lambert finds the conic that goes from r1 to r2 in a given time, by Izzo's
+// method (Izzo, "Revisiting Lambert's problem", 2015):  Householder
+// iterations on a single variable, from an initial guess that's usually
+// within a few percent.  Native, and safe from any thread.  Only
+// zero-revolution transfers (the short way or the long way round, by
+// bRetrograde) are solved.
+//
+// A porkchop plot is a Lambert transfer for every pair of departure and
+// arrival epochs.  Porkchop reads both bodies' states for every epoch up
+// front, in one batch each (CSPICE), then solves the grid in parallel
+// (native).  With the states already in hand, SolvePorkchop does just the
+// second part, from any thread.  CreatePorkchopTexture puts the result in a
+// texture for a material to color.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+class UTexture2D;
+
+namespace MaxQ::Orbits
+{
+    // Velocities (km/s) at r1 and r2 (km) of the transfer taking tof
+    // seconds, around a body of gm (km^3/s^2).  The transfer is prograde
+    // (angular momentum along +z) unless bRetrograde.  False if there's no
+    // solution:  tof isn't positive, r1 and r2 are collinear (the plane's
+    // undefined), or the iterations didn't converge.
+    SPICE_API bool Lambert(
+        double gm,
+        const double(&r1)[3],
+        const double(&r2)[3],
+        double tof,
+        double(&v1)[3],
+        double(&v2)[3],
+        bool bRetrograde = false
+    );
+
+    SPICE_API bool Lambert(
+        const FSMassConstant& gm,
+        const FSDistanceVector& r1,
+        const FSDistanceVector& r2,
+        const FSEphemerisPeriod& tof,
+        FSVelocityVector& v1,
+        FSVelocityVector& v2,
+        bool bRetrograde = false
+    );
+
+    struct FPorkchopSettings
+    {
+        FString Departure = TEXT("EARTH");
+        FString Arrival = TEXT("MARS");
+        // Central body, and an inertial frame
+        FString Center = TEXT("SUN");
+        FString Frame = TEXT("ECLIPJ2000");
+        // Center's GM (km^3/s^2)
+        double GM = 1.32712440041279419e11;
+        bool bRetrograde = false;
+    };
+
+    // Cell (x, y) is departure x, arrival y, at y * NumDepartures + x.
+    // Cells with no transfer (arrival not after departure, or no solution)
+    // are -1.
+    struct FPorkchopPlot
+    {
+        int32 NumDepartures = 0;
+        int32 NumArrivals = 0;
+        // Departure C3 (km^2/s^2):  the square of the departure v-infinity
+        TArray<float> C3;
+        // Arrival v-infinity (km/s)
+        TArray<float> ArrivalVInfinity;
+
+        int32 Num() const { return C3.Num(); }
+        int32 Index(int32 Departure, int32 Arrival) const { return Arrival * NumDepartures + Departure; }
+    };
+
+    // Uses CSPICE (for the states).  False, with an error, if any state
+    // couldn't be read.
+    SPICE_API bool Porkchop(
+        TArrayView<const double> DepartureEts,
+        TArrayView<const double> ArrivalEts,
+        const FPorkchopSettings& Settings,
+        FPorkchopPlot& Plot,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Native.  The departure body's states at DepartureEts, and the arrival
+    // body's at ArrivalEts, relative to the center, in an inertial frame.
+    // Returns the number of cells with a transfer.
+    SPICE_API int32 SolvePorkchop(
+        TArrayView<const double> DepartureEts,
+        TArrayView<const FSStateVector> DepartureStates,
+        TArrayView<const double> ArrivalEts,
+        TArrayView<const FSStateVector> ArrivalStates,
+        double gm,
+        FPorkchopPlot& Plot,
+        bool bRetrograde = false
+    );
+
+    // Game thread.  A NumDepartures x NumArrivals texture.  R:  C3, G:
+    // arrival v-infinity (-1 where there's no transfer).  Filtering is
+    // bilinear;  both axes clamp.
+    SPICE_API UTexture2D* CreatePorkchopTexture(const FPorkchopPlot& Plot);
+}
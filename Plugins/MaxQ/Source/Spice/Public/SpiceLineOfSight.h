@@ -0,0 +1,96 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLineOfSight.h
+//
+// API Comments
+//
+// Purpose:  Which satellites can see each other, for a whole catalog.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLineOfSight.h is part of the "refined C++ API".
+//
+// A comms network simulation wants, every frame, every pair of nodes with a
+// clear line of sight (the central body not in the way) and their ranges.
+// occult or vsep per pair is O(N^2) CSPICE calls.  BuildLineOfSightGraph is
+// native, and runs in parallel across nodes:
+// * With a MaxRange, each node's candidates come from an FSpatialIndex over
+//   the same positions (Within), so the work is the pairs in range rather
+//   than all of them.  Without one, every other node is a candidate.
+// * Each candidate's link is tested against the body's ellipsoid, grown by
+//   a grazing altitude (an atmosphere margin):  scaled so the ellipsoid is
+//   the unit sphere, a segment is blocked when its closest point to the
+//   center is inside.  The test has no branches and no square roots, and
+//   runs over structure-of-arrays candidates, so it vectorizes.
+//
+// The graph is a compressed sparse row adjacency list:  node i's neighbors
+// (nearest first) and ranges are [Offsets[i], Offsets[i + 1]).  Links are
+// symmetric, and each appears in both nodes' lists.
+//
+// Positions are body fixed for a triaxial body (the ellipsoid's axes are
+// the frame's), or any frame centered on the body if its radii are equal.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Math
+{
+    class FSpatialIndex;
+
+    struct FLineOfSightSettings
+    {
+        // The occluding body's radii, km (default:  WGS-84)
+        FSDistanceVector Radii = FSDistanceVector(6378.137, 6378.137, 6356.752314245);
+        // Added to every radius
+        double GrazingAltitude = 0.;
+        // Longest link, km (0:  no limit)
+        double MaxRange = 0.;
+    };
+
+    struct SPICE_API FLineOfSightGraph
+    {
+        // Num() + 1 entries
+        TArray<int32> Offsets;
+        TArray<int32> Neighbors;
+        // km
+        TArray<double> Ranges;
+
+        int32 Num() const { return FMath::Max(Offsets.Num() - 1, 0); }
+        // Each link is counted once
+        int32 NumLinks() const { return Neighbors.Num() / 2; }
+
+        TArrayView<const int32> GetNeighbors(int32 Node) const { return TArrayView<const int32>(Neighbors.GetData() + Offsets[Node], Offsets[Node + 1] - Offsets[Node]); }
+        TArrayView<const double> GetRanges(int32 Node) const { return TArrayView<const double>(Ranges.GetData() + Offsets[Node], Offsets[Node + 1] - Offsets[Node]); }
+
+        SIZE_T GetAllocatedSize() const { return Offsets.GetAllocatedSize() + Neighbors.GetAllocatedSize() + Ranges.GetAllocatedSize(); }
+    };
+
+    // Positions in km, relative to the body's center.  Valid (optional):  0
+    // leaves a node out (no links).  Index must have been built from the
+    // same Positions (and Valid) when Settings.MaxRange > 0;  it's unused
+    // (and may be null) otherwise.  False if the radii aren't positive, or
+    // an index is needed and missing.  Any thread.
+    SPICE_API bool BuildLineOfSightGraph(
+        const FConstVectorBatch& Positions,
+        const FSpatialIndex* Index,
+        FLineOfSightGraph& Graph,
+        const FLineOfSightSettings& Settings = FLineOfSightSettings(),
+        TArrayView<const uint8> Valid = TArrayView<const uint8>()
+    );
+
+    // One link, the same test.  True if nothing blocks it.
+    SPICE_API bool HasLineOfSight(const FSDistanceVector& a, const FSDistanceVector& b, const FLineOfSightSettings& Settings = FLineOfSightSettings());
+}
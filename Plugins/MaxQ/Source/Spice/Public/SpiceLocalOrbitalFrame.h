@@ -0,0 +1,74 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLocalOrbitalFrame.h
+//
+// API Comments
+//
+// Purpose:  Objects' local orbital frames (RIC, LVLH), from their states.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLocalOrbitalFrame.h is part of the "refined C++ API".
+//
+// A local orbital frame kernel (a two-vector dynamic frame per object) makes
+// every pxform into it a trip through CSPICE's dynamic frame machinery, and
+// needs a frame definition per object.  For a proximity operations display
+// the states are already at hand, and the frames follow from them directly.
+// These build them natively, in parallel chunks, from any thread.
+//
+// * RIC:  radial, in-track, cross-track.  X along r, Z along r x v, Y
+//   completes the frame (along v, for a circular orbit).
+// * LVLH:  the CCSDS local vertical, local horizontal frame.  Z at the
+//   central body (-r), Y along -(r x v), X completes it (along v, for a
+//   circular orbit).
+//
+// States are relative to the central body, in an inertial frame (J2000,
+// say).  The matrices rotate vectors from that frame to the local one (their
+// rows are the local axes).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Math
+{
+    enum class ELocalOrbitalFrame : uint8
+    {
+        RIC,
+        LVLH
+    };
+
+    // The local orbital frame of every element.  Where r or r x v is zero
+    // the element gets the identity, and counts in the return value.
+    SPICE_API int32 LocalOrbitalFrames(
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        TArrayView<FSRotationMatrix> m,
+        ELocalOrbitalFrame Frame = ELocalOrbitalFrame::RIC
+    );
+
+    // Deputies' states (r, v) relative to Chief, in Chief's local orbital
+    // frame.  Velocities are as seen from the rotating frame, which turns at
+    // (r x v) / |r|^2 (exact for Keplerian motion).  Outputs may alias the
+    // inputs.  False, writing nothing, if Chief's frame is degenerate.
+    SPICE_API bool RelativeStates(
+        const FSStateVector& Chief,
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        const FVectorBatch& OutR,
+        const FVectorBatch& OutV,
+        ELocalOrbitalFrame Frame = ELocalOrbitalFrame::RIC
+    );
+}
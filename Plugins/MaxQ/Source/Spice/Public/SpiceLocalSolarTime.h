@@ -0,0 +1,85 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLocalSolarTime.h
+//
+// API Comments
+//
+// Purpose:  Local solar time for many sites on a body, at one epoch.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLocalSolarTime.h is part of the "refined C++ API".
+//
+// USpice::et2lst converts one longitude per call, looks up the body's frame
+// and the Sun's state every time, and formats the time and AM/PM strings.
+// Every site on a body at one epoch shares the Sun's longitude, though, and
+// local solar time is just the site's angle from it.
+//
+// SunLongitude finds the Sun's longitude once, as et2lst_c does (LT+S, from
+// the body's center, in its body-fixed frame).  LocalSolarTime then converts
+// any number of longitudes natively, in parallel, without touching CSPICE,
+// so it can run on any thread.  The overload taking et and body does both.
+//
+// Times are et2lst_c's:  the hour angle of the Sun plus 12 hours, as seconds
+// of a 24 "hour" local day, with hours, minutes and seconds truncated.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Time
+{
+    struct FLocalSolarTime
+    {
+        // Seconds past local midnight, [0, 86400)
+        double Seconds = 0.;
+        int32 Hour = 0;
+        int32 Minute = 0;
+        int32 Second = 0;
+    };
+
+    // The Sun's planetocentric longitude (radians) in the body's body-fixed
+    // frame at et, as et2lst_c finds it.  Uses CSPICE.
+    SPICE_API bool SunLongitude(
+        double et,
+        int32 body,
+        double& SunLon,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Local solar time at each of Longitudes (radians), given the Sun's
+    // longitude.  Planetographic longitudes need the body's sense
+    // (MaxQ::Math::PlanetographicSense);  it's ignored for planetocentric
+    // ones.  Out must have as many elements as Longitudes.  No CSPICE.
+    SPICE_API void LocalSolarTime(
+        double SunLon,
+        TArrayView<const double> Longitudes,
+        TArrayView<FLocalSolarTime> Out,
+        ES_LongitudeType Type = ES_LongitudeType::Planetocentric,
+        bool bPositiveWest = false
+    );
+
+    // The Sun's longitude and the body's longitude sense once, then every
+    // site's local solar time.  Uses CSPICE (twice, at most).
+    SPICE_API bool LocalSolarTime(
+        double et,
+        int32 body,
+        TArrayView<const double> Longitudes,
+        TArrayView<FLocalSolarTime> Out,
+        ES_LongitudeType Type = ES_LongitudeType::Planetocentric,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,66 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceLock.h
+//
+// API Comments
+//
+// Purpose:  Exclusive access to CSPICE from any thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceLock.h is part of the "refined C++ API".
+//
+// CSPICE keeps its state in static storage:  the error subsystem, the kernel
+// pool, the DAF/DAS file tables, the SPK and CK segment buffers.  None of it
+// can be shared between threads without rewriting the f2c sources, so reads
+// can't run concurrently.  What can be done is to let any thread take turns.
+//
+// While an FSpiceScope is held, its thread is the only one in CSPICE that also
+// holds one.  FSpiceExecutor runs its commands inside one, and MaxQ's kernel
+// loading and unloading (Furnsh, Unload, clear_all) take one, so a ParallelFor
+// worker can make a SPICE call between native computations without going
+// through the executor or racing a kernel being loaded.
+//
+// The error state is per scope:  whatever a scope leaves failed_c() set to is
+// logged and reset when the outermost scope on a thread ends, so no thread
+// ever sees another's error.  Check errors (ErrorCheck, get_implied_result)
+// before the scope ends.
+//
+// Scopes nest on one thread.  Calls made without one (USpice:: from the game
+// thread, say) aren't excluded;  once any thread uses FSpiceScope, all SPICE
+// calls should.  Don't wait, while holding a scope, on workers that take one.
+//
+// For real concurrency, take immutable snapshots on the SPICE thread
+// (FEphemerisCache, FPckOrientation, FNameRegistry, ...) and read those from
+// the workers, or run separate CSPICE instances in FSpiceProcessPool.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace MaxQ::Core
+{
+    class SPICE_API FSpiceScope
+    {
+    public:
+        FSpiceScope();
+        ~FSpiceScope();
+
+        FSpiceScope(const FSpiceScope&) = delete;
+        FSpiceScope& operator=(const FSpiceScope&) = delete;
+
+        // True if the calling thread holds a scope
+        static bool IsHeld();
+    };
+}
@@ -21,11 +21,22 @@
 //    * Blueprints
 //
 // SpiceMath.h is part of the "refined C++ API".
+//
+// The trivial vector operations (add, subtract, negate, scale, dot and cross
+// products, linear combinations, and matrix times vector) are implemented
+// inline, here.  Routing them through CSPICE cost more in copies and an
+// un-inlinable call than the arithmetic itself, which hurts anything built on
+// SpiceOperators.h.  The operations where CSPICE's numerics matter (norms and
+// unit vectors, which scale to avoid overflow;  separation angles, projections,
+// etc) still call CSPICE.
 //------------------------------------------------------------------------------
 
 #pragma once
 
 #include "SpiceTypes.h"
+#include "SpiceResult.h"
+
+class FSpiceName;
 
 namespace MaxQ::Math
 {
@@ -37,9 +48,47 @@ namespace MaxQ::Math
     SPICE_API extern const double dpr;
     SPICE_API extern const double rpd;
 
+    namespace Inline
+    {
+        // Number of doubles in a vector type (3 or 6)
+        template<class VectorType>
+        constexpr int Dim = sizeof(VectorType) / sizeof(double);
+
+        template<int N>
+        inline void MxV(double(&vout)[N], const double(&m)[N][N], const double(&v)[N])
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                double sum = 0.;
+                for (int j = 0; j < N; ++j) sum += m[i][j] * v[j];
+                vout[i] = sum;
+            }
+        }
+
+        template<int N>
+        inline void MTxV(double(&vout)[N], const double(&m)[N][N], const double(&v)[N])
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                double sum = 0.;
+                for (int j = 0; j < N; ++j) sum += m[j][i] * v[j];
+                vout[i] = sum;
+            }
+        }
+    }
+
     // m * v
     template<class VectorType>
-    SPICE_API void MxV(VectorType& vout, const FSRotationMatrix& m, const VectorType& v);
+    inline void MxV(VectorType& vout, const FSRotationMatrix& m, const VectorType& v)
+    {
+        double _m[3][3];  m.CopyTo(_m);
+        double _v[3];     v.CopyTo(_v);
+        double _vout[3];
+
+        Inline::MxV(_vout, _m, _v);
+
+        vout = VectorType{ _vout };
+    }
 
     template<class VectorType>
     inline VectorType MxV(const FSRotationMatrix& m, const VectorType& v)
@@ -50,7 +99,16 @@ namespace MaxQ::Math
     }
 
     template<class VectorType>
-    SPICE_API void MxV(VectorType& vout, const FSStateTransform& m, const VectorType& v);
+    inline void MxV(VectorType& vout, const FSStateTransform& m, const VectorType& v)
+    {
+        double _m[6][6];  m.CopyTo(_m);
+        double _v[6];     v.CopyTo(_v);
+        double _vout[6];
+
+        Inline::MxV(_vout, _m, _v);
+
+        vout = VectorType{ _vout };
+    }
 
     template<class VectorType>
     inline VectorType MxV(const FSStateTransform& m, const VectorType& v)
@@ -62,7 +120,16 @@ namespace MaxQ::Math
 
     // m_transpose * v
     template<class VectorType>
-    SPICE_API void MTxV(VectorType& vout, const FSRotationMatrix& m, const VectorType& v);
+    inline void MTxV(VectorType& vout, const FSRotationMatrix& m, const VectorType& v)
+    {
+        double _m[3][3];  m.CopyTo(_m);
+        double _v[3];     v.CopyTo(_v);
+        double _vout[3];
+
+        Inline::MTxV(_vout, _m, _v);
+
+        vout = VectorType{ _vout };
+    }
 
     template<class VectorType>
     inline VectorType MTxV(const FSRotationMatrix& m, const VectorType& v)
@@ -73,7 +140,16 @@ namespace MaxQ::Math
     }
 
     template<class VectorType>
-    SPICE_API void MTxV(VectorType& vout, const FSStateTransform& m, const VectorType& v);
+    inline void MTxV(VectorType& vout, const FSStateTransform& m, const VectorType& v)
+    {
+        double _m[6][6];  m.CopyTo(_m);
+        double _v[6];     v.CopyTo(_v);
+        double _vout[6];
+
+        Inline::MTxV(_vout, _m, _v);
+
+        vout = VectorType{ _vout };
+    }
 
     template<class VectorType>
     inline VectorType MTxV(const FSStateTransform& m, const VectorType& v)
@@ -135,7 +211,17 @@ namespace MaxQ::Math
 
     // addition
     template<class VectorType>
-    SPICE_API void Vadd(VectorType& vsum, const VectorType& v1, const VectorType& v2);
+    inline void Vadd(VectorType& vsum, const VectorType& v1, const VectorType& v2)
+    {
+        constexpr int N = Inline::Dim<VectorType>;
+        double _v1[N];  v1.CopyTo(_v1);
+        double _v2[N];  v2.CopyTo(_v2);
+        double _vsum[N];
+
+        for (int i = 0; i < N; ++i) _vsum[i] = _v1[i] + _v2[i];
+
+        vsum = VectorType{ _vsum };
+    }
 
     template<class VectorType>
     inline VectorType Vadd(const VectorType& v1, const VectorType& v2)
@@ -170,7 +256,17 @@ namespace MaxQ::Math
 
     // subtraction
     template<class VectorType>
-    SPICE_API void Vsub(VectorType& vdifference, const VectorType& v1, const VectorType& v2);
+    inline void Vsub(VectorType& vdifference, const VectorType& v1, const VectorType& v2)
+    {
+        constexpr int N = Inline::Dim<VectorType>;
+        double _v1[N];  v1.CopyTo(_v1);
+        double _v2[N];  v2.CopyTo(_v2);
+        double _vdifference[N];
+
+        for (int i = 0; i < N; ++i) _vdifference[i] = _v1[i] - _v2[i];
+
+        vdifference = VectorType{ _vdifference };
+    }
 
     template<class VectorType>
     inline VectorType Vsub(const VectorType& v1, const VectorType& v2)
@@ -196,7 +292,16 @@ namespace MaxQ::Math
 
     // negation
     template<class VectorType>
-    SPICE_API void Vminus(VectorType& vminus, const VectorType& vin);
+    inline void Vminus(VectorType& vminus, const VectorType& vin)
+    {
+        constexpr int N = Inline::Dim<VectorType>;
+        double _vin[N];  vin.CopyTo(_vin);
+        double _vminus[N];
+
+        for (int i = 0; i < N; ++i) _vminus[i] = -_vin[i];
+
+        vminus = VectorType{ _vminus };
+    }
 
     template<class VectorType>
     inline VectorType Vminus(const VectorType& vin)
@@ -265,6 +370,38 @@ namespace MaxQ::Math
         return m;
     }
 
+    // pxform/sxform with interned frame names (see SpiceName.h)
+    SPICE_API void Pxform(
+        FSRotationMatrix& rotate,
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void Sxform(
+        FSStateTransform& xform,
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // The same, returning a TSpiceResult (see SpiceResult.h)
+    SPICE_API MaxQ::Core::TSpiceResult<FSRotationMatrix> TryPxform(
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to
+    );
+
+    SPICE_API MaxQ::Core::TSpiceResult<FSStateTransform> TrySxform(
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to
+    );
+
 
     // unit cross product
     template<class VectorType>
@@ -290,8 +427,29 @@ namespace MaxQ::Math
     inline FSDimensionlessVector Ucrss(const FSStateVector& state) { return Ucrss(state.r, state.v); }
 
     // vector cross product
+    namespace Inline
+    {
+        // vout may alias v1 or v2
+        inline void Vcrss(double(&vout)[3], const double(&v1)[3], const double(&v2)[3])
+        {
+            const double x = v1[1] * v2[2] - v1[2] * v2[1];
+            const double y = v1[2] * v2[0] - v1[0] * v2[2];
+            const double z = v1[0] * v2[1] - v1[1] * v2[0];
+            vout[0] = x; vout[1] = y; vout[2] = z;
+        }
+    }
+
     template<class VectorType>
-    SPICE_API void Vcrss(VectorType& vout, const VectorType& v1, const VectorType& v2);
+    inline void Vcrss(VectorType& vout, const VectorType& v1, const VectorType& v2)
+    {
+        double _v1[3];  v1.CopyTo(_v1);
+        double _v2[3];  v2.CopyTo(_v2);
+        double _vout[3];
+
+        Inline::Vcrss(_vout, _v1, _v2);
+
+        vout = VectorType{ _vout };
+    }
 
     template<class VectorType>
     inline VectorType Vcrss(const VectorType& v1, const VectorType& v2)
@@ -301,7 +459,16 @@ namespace MaxQ::Math
         return vout;
     }
 
-    SPICE_API void Vcrss(FSDimensionlessVector& vout, const FSDistanceVector& r, const FSVelocityVector& v);
+    inline void Vcrss(FSDimensionlessVector& vout, const FSDistanceVector& r, const FSVelocityVector& v)
+    {
+        double _r[3];  r.CopyTo(_r);
+        double _v[3];  v.CopyTo(_v);
+        double _vout[3];
+
+        Inline::Vcrss(_vout, _r, _v);
+
+        vout = FSDimensionlessVector{ _vout };
+    }
     inline FSDimensionlessVector Vcrss(const FSDistanceVector& r, const FSVelocityVector& v)
     {
         FSDimensionlessVector vout;
@@ -343,11 +510,14 @@ namespace MaxQ::Math
         return sout;
     }
 
-    SPICE_API void Vdot(
+    inline void Vdot(
         double& dot,
         const FSDimensionlessVector& v1,
         const FSDimensionlessVector& v2
-    );
+    )
+    {
+        dot = v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+    }
 
     inline double Vdot(
         const FSDimensionlessVector& v1,
@@ -360,11 +530,17 @@ namespace MaxQ::Math
     }
 
     template<class ScalarType, class VectorType>
-    SPICE_API void Vdot(
+    inline void Vdot(
         ScalarType& dot,
         const VectorType& v1,
         const VectorType& v2
-    );
+    )
+    {
+        double _v1[3];  v1.CopyTo(_v1);
+        double _v2[3];  v2.CopyTo(_v2);
+
+        dot = _v1[0] * _v2[0] + _v1[1] * _v2[1] + _v1[2] * _v2[2];
+    }
 
     template<class ScalarType, class VectorType>
     inline ScalarType Vdot(const VectorType& v1, const VectorType& v2)
@@ -409,7 +585,16 @@ namespace MaxQ::Math
 
     // scale
     template<class VectorType>
-    SPICE_API void Vscl(VectorType& vscaled, double s, const VectorType& v);
+    inline void Vscl(VectorType& vscaled, double s, const VectorType& v)
+    {
+        constexpr int N = Inline::Dim<VectorType>;
+        double _v[N];  v.CopyTo(_v);
+        double _vscaled[N];
+
+        for (int i = 0; i < N; ++i) _vscaled[i] = s * _v[i];
+
+        vscaled = VectorType{ _vscaled };
+    }
 
     template<class VectorType>
     inline VectorType Vscl(double s, const VectorType& v)
@@ -512,7 +697,17 @@ namespace MaxQ::Math
 
     // Vector linear combination
     template<class VectorType>
-    SPICE_API void Vlcom(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2);
+    inline void Vlcom(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2)
+    {
+        constexpr int N = Inline::Dim<VectorType>;
+        double _v1[N];  v1.CopyTo(_v1);
+        double _v2[N];  v2.CopyTo(_v2);
+        double _sum[N];
+
+        for (int i = 0; i < N; ++i) _sum[i] = a * _v1[i] + b * _v2[i];
+
+        sum = VectorType{ _sum };
+    }
 
     template<class VectorType>
     inline VectorType Vlcom(double a, const VectorType& v1, double b, const VectorType& v2)
@@ -524,7 +719,18 @@ namespace MaxQ::Math
 
     // Vector linear combination
     template<class VectorType>
-    SPICE_API void Vlcom3(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2, double c, const VectorType& v3);
+    inline void Vlcom3(VectorType& sum, double a, const VectorType& v1, double b, const VectorType& v2, double c, const VectorType& v3)
+    {
+        constexpr int N = Inline::Dim<VectorType>;
+        double _v1[N];  v1.CopyTo(_v1);
+        double _v2[N];  v2.CopyTo(_v2);
+        double _v3[N];  v3.CopyTo(_v3);
+        double _sum[N];
+
+        for (int i = 0; i < N; ++i) _sum[i] = a * _v1[i] + b * _v2[i] + c * _v3[i];
+
+        sum = VectorType{ _sum };
+    }
 
     template<class VectorType>
     inline VectorType Vlcom3(double a, const VectorType& v1, double b, const VectorType& v2, double c, const VectorType& v3)
@@ -0,0 +1,290 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceMathBatch.h
+//
+// API Comments
+//
+// Purpose:  Math over large arrays (coordinate conversions, etc).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceMathBatch.h is part of the "refined C++ API".
+//
+// The USpice/MaxQ::Math versions of these take one vector per call, and round
+// trip through CSPICE's error system each time.  These take structure-of-
+// arrays buffers (one array per coordinate), are native, and run in parallel
+// chunks for large inputs.  None of them touch CSPICE, so they can be called
+// from any thread.  Recpgr/Pgrrec are the exception in spirit:  they need the
+// body's longitude sense, which comes from the kernel pool (see
+// PlanetographicSense, which does use CSPICE).
+//
+// Units are SPICE units (km, radians).  Argument order and output ranges
+// follow the CSPICE routine each function is named for.  Invalid ellipsoids
+// (re <= 0 or f >= 1) convert nothing and return false.
+//
+// Surfpt, Surfnm, Nearpt and Npedln are the triaxial ellipsoid (a, b, c)
+// routines, for picking, shadow and limb tests over many rays.  They match
+// CSPICE to ~1e-13 relative.  Where CSPICE would signal an error for one
+// element (a zero direction), that element gets a result instead:  no
+// intercept for Surfpt, and Npedln treats the line as a point.  Invalid
+// radii (<= 0) compute nothing and return false.
+//
+// The MxV/MTxV overloads apply one pxform/sxform result to every vector of a
+// buffer.  The matrix is unpacked once, instead of once per vector.  Outputs
+// may alias the inputs (in-place rotation).
+//
+// The quaternion functions replace USpice::m2q/q2m/qxq (and MaxQ::Math::M2q)
+// per body, per frame.  SQUAD is continuous in angular velocity across
+// samples, where SLERP turns at each one;  it's smoothest when the samples
+// are evenly spaced.
+//
+// Recazl/Azlrec are recrad/radrec with recazl's azimuth and elevation sense
+// flags.  Azlcpo is azlcpo for a ground station and many targets:  the
+// station's topocentric frame is set up once per epoch (AzlObserver, which
+// uses CSPICE), then every target's az/el and rates are native.
+//
+// Xfmsta is xfmsta for whole buffers of states:  coordinates and their rates,
+// with the rates through the same Jacobians xfmsta uses (drdlat, dgeodr,
+// etc), written out in closed form.  The streaming overload converts a chunk
+// at a time into a scratch buffer and hands each chunk to a sink (a CSV or
+// Parquet writer), so an export of millions of states never holds more than
+// one chunk of converted output.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Math
+{
+    // Caller owned, structure-of-arrays 3-vectors.  X, Y and Z must be the
+    // same length.
+    struct FVectorBatch
+    {
+        TArrayView<double> X, Y, Z;
+        int32 Num() const { return X.Num(); }
+    };
+
+    struct FConstVectorBatch
+    {
+        TArrayView<const double> X, Y, Z;
+        int32 Num() const { return X.Num(); }
+
+        FConstVectorBatch() {}
+        FConstVectorBatch(TArrayView<const double> _X, TArrayView<const double> _Y, TArrayView<const double> _Z) : X(_X), Y(_Y), Z(_Z) {}
+        FConstVectorBatch(const FVectorBatch& v) : X(v.X), Y(v.Y), Z(v.Z) {}
+    };
+
+    // Rectangular <-> latitudinal (radius, lon, lat)
+    SPICE_API void Reclat(const FConstVectorBatch& rectan, TArrayView<double> radius, TArrayView<double> lon, TArrayView<double> lat);
+    SPICE_API void Latrec(TArrayView<const double> radius, TArrayView<const double> lon, TArrayView<const double> lat, const FVectorBatch& rectan);
+
+    // Rectangular <-> spherical (r, colat, lon)
+    SPICE_API void Recsph(const FConstVectorBatch& rectan, TArrayView<double> r, TArrayView<double> colat, TArrayView<double> lon);
+    SPICE_API void Sphrec(TArrayView<const double> r, TArrayView<const double> colat, TArrayView<const double> lon, const FVectorBatch& rectan);
+
+    // Rectangular <-> cylindrical (r, clon, z).  clon is in [0, 2pi).
+    SPICE_API void Reccyl(const FConstVectorBatch& rectan, TArrayView<double> r, TArrayView<double> clon, TArrayView<double> z);
+    SPICE_API void Cylrec(TArrayView<const double> r, TArrayView<const double> clon, TArrayView<const double> z, const FVectorBatch& rectan);
+
+    // Rectangular <-> range, right ascension, declination.  ra is in [0, 2pi).
+    SPICE_API void Recrad(const FConstVectorBatch& rectan, TArrayView<double> range, TArrayView<double> ra, TArrayView<double> dec);
+    SPICE_API void Radrec(TArrayView<const double> range, TArrayView<const double> ra, TArrayView<const double> dec, const FVectorBatch& rectan);
+
+    // Rectangular <-> range, azimuth, elevation, with recazl/azlrec's sense
+    // flags.  az is in [0, 2pi).
+    SPICE_API void Recazl(const FConstVectorBatch& rectan, bool azccw, bool elplsz, TArrayView<double> range, TArrayView<double> az, TArrayView<double> el);
+    SPICE_API void Azlrec(TArrayView<const double> range, TArrayView<const double> az, TArrayView<const double> el, bool azccw, bool elplsz, const FVectorBatch& rectan);
+
+    // Rectangular <-> geodetic (lon, lat, alt) on the ellipsoid (re, f)
+    SPICE_API bool Recgeo(const FConstVectorBatch& rectan, double re, double f, TArrayView<double> lon, TArrayView<double> lat, TArrayView<double> alt);
+    SPICE_API bool Georec(TArrayView<const double> lon, TArrayView<const double> lat, TArrayView<const double> alt, double re, double f, const FVectorBatch& rectan);
+
+    // Rectangular <-> planetographic (lon, lat, alt).  lon is in [0, 2pi).
+    // bPositiveWest is the body's planetographic longitude sense.
+    SPICE_API bool Recpgr(const FConstVectorBatch& rectan, double re, double f, bool bPositiveWest, TArrayView<double> lon, TArrayView<double> lat, TArrayView<double> alt);
+    SPICE_API bool Pgrrec(TArrayView<const double> lon, TArrayView<const double> lat, TArrayView<const double> alt, double re, double f, bool bPositiveWest, const FVectorBatch& rectan);
+
+    // Looks up the body's planetographic longitude sense as recpgr_c does
+    // (rotation direction, or BODY<id>_PGR_POSITIVE_LON).  Uses CSPICE.
+    SPICE_API bool PlanetographicSense(
+        const FString& body,
+        bool& bPositiveWest,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // States from one coordinate system to another, as xfmsta.  r holds the
+    // coordinates and v their rates, both in the system's order:  (x, y, z),
+    // (r, clon, z), (r, lon, lat), (r, colat, lon), and (lon, lat, alt) for
+    // geodetic and planetographic.  re, f and bPositiveWest are the body's
+    // (bodvrd RADII, and PlanetographicSense), needed only for geodetic and
+    // planetographic.  Outputs may alias the inputs.  A state on the z axis
+    // gets zero rates for the coordinates that are undefined there (lon, lat,
+    // colat, and the cylindrical radius), where xfmsta signals an error.
+    // Returns false (converting nothing) for NONE, or an invalid ellipsoid.
+    SPICE_API bool Xfmsta(
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        ES_CoordinateSystem input,
+        ES_CoordinateSystem output,
+        const FVectorBatch& rout,
+        const FVectorBatch& vout,
+        double re = 0.,
+        double f = 0.,
+        bool bPositiveWest = false
+    );
+
+    // Called with each converted chunk, in order.  First is the index (in
+    // the input) of the chunk's first state.  The views are only valid
+    // during the call.
+    typedef TFunctionRef<void(int32 First, const FConstVectorBatch& r, const FConstVectorBatch& v)> FStateBatchSink;
+
+    // Xfmsta, streamed through Sink a chunk at a time
+    SPICE_API bool Xfmsta(
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        ES_CoordinateSystem input,
+        ES_CoordinateSystem output,
+        FStateBatchSink Sink,
+        double re = 0.,
+        double f = 0.,
+        bool bPositiveWest = false
+    );
+
+    // A constant position observer (a ground station) at one epoch, as
+    // azlcpo sees it:  the topocentric frame's +Z is the ellipsoid normal at
+    // the station, +X points north.
+    struct FAzlObserver
+    {
+        // ref -> topocentric, for states relative to obsctr
+        FSStateTransform Transform;
+        // ref -> topocentric, for directions (stars)
+        FSRotationMatrix Rotation;
+        // The station, relative to obsctr, topocentric (it doesn't move
+        // there)
+        FSDistanceVector Position;
+        bool azccw = true;
+        bool elplsz = true;
+    };
+
+    // Sets up Observer for the station at obspos (obsref, body-fixed,
+    // relative to obsctr), for targets given in ref.  Uses CSPICE (sxform,
+    // the body's radii).
+    SPICE_API bool AzlObserver(
+        const FSEphemerisTime& et,
+        const FSDistanceVector& obspos,
+        const FString& obsctr,
+        const FString& obsref,
+        const FString& ref,
+        bool azccw,
+        bool elplsz,
+        FAzlObserver& Observer,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // azlcpo's azlsta for many targets at once:  range, az, el (km, rad)
+    // and their rates (km/s, rad/s).  r and v are geometric states relative
+    // to obsctr, in the ref frame the Observer was set up for (spkezr with
+    // abcorr "NONE", or propagated orbits).  A target at the zenith or nadir
+    // gets zero az/el rates, where azlcpo signals an error.
+    SPICE_API void Azlcpo(
+        const FAzlObserver& Observer,
+        const FConstVectorBatch& r,
+        const FConstVectorBatch& v,
+        TArrayView<double> range,
+        TArrayView<double> az,
+        TArrayView<double> el,
+        TArrayView<double> rangeRate,
+        TArrayView<double> azRate,
+        TArrayView<double> elRate
+    );
+
+    // Ray/ellipsoid intercepts.  found[i] is 1 if ray i hits.  From inside,
+    // the exit point;  from the surface, the vertex.
+    SPICE_API bool Surfpt(const FConstVectorBatch& positn, const FConstVectorBatch& u, double a, double b, double c, const FVectorBatch& point, TArrayView<uint8> found);
+
+    // Outward unit normals at points on the ellipsoid
+    SPICE_API bool Surfnm(double a, double b, double c, const FConstVectorBatch& point, const FVectorBatch& normal);
+
+    // Nearest points on the ellipsoid, and altitudes (negative inside)
+    SPICE_API bool Nearpt(const FConstVectorBatch& positn, double a, double b, double c, const FVectorBatch& npoint, TArrayView<double> alt);
+
+    // Nearest points on the ellipsoid to lines, and the distances.  Lines
+    // that hit get distance zero, and the intercept along linedr from
+    // linept (or along -linedr), as npedln.
+    SPICE_API bool Npedln(double a, double b, double c, const FConstVectorBatch& linept, const FConstVectorBatch& linedr, const FVectorBatch& pnear, TArrayView<double> dist);
+
+    // vout[i] = m * v[i], vout[i] = m^T * v[i]
+    SPICE_API void MxV(const FSRotationMatrix& m, const FConstVectorBatch& v, const FVectorBatch& vout);
+    SPICE_API void MTxV(const FSRotationMatrix& m, const FConstVectorBatch& v, const FVectorBatch& vout);
+
+    // Interleaved x, y, z (eg DSK vertex arrays, FVector3d buffers).  Lengths
+    // are multiples of 3.
+    SPICE_API void MxV(const FSRotationMatrix& m, TArrayView<const double> xyz, TArrayView<double> xyzout);
+    SPICE_API void MTxV(const FSRotationMatrix& m, TArrayView<const double> xyz, TArrayView<double> xyzout);
+
+    SPICE_API void MxV(const FSRotationMatrix& m, TArrayView<const FSDistanceVector> v, TArrayView<FSDistanceVector> vout);
+
+    // States:  [r', v'] = m * [r, v]
+    SPICE_API void MxV(const FSStateTransform& m, const FConstVectorBatch& r, const FConstVectorBatch& v, const FVectorBatch& rout, const FVectorBatch& vout);
+    SPICE_API void MxV(const FSStateTransform& m, TArrayView<const FSStateVector> states, TArrayView<FSStateVector> statesout);
+
+    // Dimensionless (the K2 array nodes convert to these).  Outputs may alias
+    // the inputs.
+    SPICE_API void MxV(const FSRotationMatrix& m, TArrayView<const FSDimensionlessVector> v, TArrayView<FSDimensionlessVector> vout);
+    SPICE_API void MxV(const FSStateTransform& m, TArrayView<const FSDimensionlessStateVector> states, TArrayView<FSDimensionlessStateVector> statesout);
+
+    // Stellar aberration, as stelab:  where an observer moving at vobs
+    // (relative to the solar system barycenter) sees each pobj.  appobj may
+    // alias pobj.  |vobs| >= c corrects nothing and returns false.
+    SPICE_API bool Stelab(const FConstVectorBatch& pobj, const FSVelocityVector& vobs, const FVectorBatch& appobj);
+
+    // SPICE style quaternions (m2q_c, q2m_c, qxq_c).  Matrices are row-major,
+    // 9 doubles each, pxform_c/ckgp_c's layout.  M2q doesn't check that the
+    // matrices are rotations, and Q2m accepts non-unit quaternions, as q2m.
+    SPICE_API void M2q(TArrayView<const double> m, TArrayView<FSQuaternion> q);
+    SPICE_API void M2q(TArrayView<const FSRotationMatrix> m, TArrayView<FSQuaternion> q);
+    SPICE_API void Q2m(TArrayView<const FSQuaternion> q, TArrayView<double> m);
+    SPICE_API void Qxq(TArrayView<const FSQuaternion> q1, TArrayView<const FSQuaternion> q2, TArrayView<FSQuaternion> qout);
+
+    // Element-wise:  t[i] of the way from q0[i] to q1[i], the short way
+    // around (q and -q are the same attitude).  Unit quaternions.
+    SPICE_API void Slerp(TArrayView<const FSQuaternion> q0, TArrayView<const FSQuaternion> q1, TArrayView<const double> t, TArrayView<FSQuaternion> qout);
+
+    // SQUAD's inner control points for a sequence of attitude samples
+    SPICE_API void SquadTangents(TArrayView<const FSQuaternion> samples, TArrayView<FSQuaternion> tangents);
+
+    // Attitude samples (eg CK pointing at increasing times) interpolated at
+    // each et:  SLERP between the samples around it, or SQUAD through
+    // tangents (from SquadTangents), if there are any.  Epochs outside the
+    // samples get the first or last one.
+    SPICE_API void InterpolateAttitude(
+        TArrayView<const double> times,
+        TArrayView<const FSQuaternion> samples,
+        TArrayView<const FSQuaternion> tangents,
+        TArrayView<const double> et,
+        TArrayView<FSQuaternion> qout
+    );
+
+    // Element-wise:  vout[i] = v1[i] + v2[i], vout[i] = v1[i] - v2[i]
+    SPICE_API void Vadd(TArrayView<const FSDimensionlessVector> v1, TArrayView<const FSDimensionlessVector> v2, TArrayView<FSDimensionlessVector> vout);
+    SPICE_API void Vsub(TArrayView<const FSDimensionlessVector> v1, TArrayView<const FSDimensionlessVector> v2, TArrayView<FSDimensionlessVector> vout);
+    SPICE_API void Vadd(TArrayView<const FSDimensionlessStateVector> v1, TArrayView<const FSDimensionlessStateVector> v2, TArrayView<FSDimensionlessStateVector> vout);
+    SPICE_API void Vsub(TArrayView<const FSDimensionlessStateVector> v1, TArrayView<const FSDimensionlessStateVector> v2, TArrayView<FSDimensionlessStateVector> vout);
+
+    // vnorm_c, unorm_c (a zero vector's unit vector is zero)
+    SPICE_API void Vnorm(TArrayView<const FSDimensionlessVector> v, TArrayView<double> vmag);
+    SPICE_API void Unorm(TArrayView<const FSDimensionlessVector> v, TArrayView<FSDimensionlessVector> vout, TArrayView<double> vmag);
+}
@@ -0,0 +1,97 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceMemory.h
+//
+// API Comments
+//
+// Purpose:  Accounting for MaxQ's and CSPICE's memory.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceMemory.h is part of the "refined C++ API".
+//
+// MaxQ's own allocations (caches, batch propagators, coverage indices, DSK
+// arrays, TLE catalogs, scratch arenas...) are made under the "MaxQ" LLM
+// tag, so -llm shows them as one line ("stat LLMFULL", LLM CSV, Insights).
+//
+// CSPICE can't be tagged that way.  Nearly all of its memory is static
+// storage (the kernel pool, the segment tables, the DAF/DAS buffers), fixed
+// in size when the toolkit is compiled, and its few mallocs bypass the
+// engine's allocator.  GetMemoryReport gives what can be known about it
+// instead:  the static footprint (measured from the toolkit's sources), how
+// full the kernel pool is, the toolkit's outstanding allocations, and the
+// binary kernels MaxQ maps (SetMapBinaryKernels).
+//
+// The "MaxQ.MemReport" console command logs the report.  Pool and mapped
+// bytes are also "stat MaxQ" memory stats, as of the last report.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Stats/Stats.h"
+#include "SpiceSegmentStats.h"
+
+LLM_DECLARE_TAG_API(MaxQ, SPICE_API);
+
+// Allocations in scope are charged to the "MaxQ" tag.  For anything that
+// builds a cache, an index, or a buffer that outlives the call.
+#define MAXQ_LLM_SCOPE() LLM_SCOPE_BYTAG(MaxQ)
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Kernel pool"), STAT_MaxQ_PoolMemory, STATGROUP_MaxQ, SPICE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Mapped kernels"), STAT_MaxQ_MappedKernelMemory, STATGROUP_MaxQ, SPICE_API);
+
+namespace MaxQ::Data
+{
+    struct SPICE_API FSpiceStaticModule
+    {
+        const TCHAR* Name = nullptr;
+        int64 Bytes = 0;
+    };
+
+    struct SPICE_API FSpiceMemoryReport
+    {
+        // CSPICE's static storage, all of it, whether used or not
+        int64 StaticBytes = 0;
+        // The biggest parts of it, largest first
+        TArrayView<const FSpiceStaticModule> LargestModules;
+
+        // Kernel pool contents, and the toolkit's limits on them
+        int32 PoolVariables = 0;
+        int32 PoolNumbers = 0;
+        int32 PoolStrings = 0;
+        // Values, as stored (8 bytes a number, 80 a string)
+        int64 PoolBytes = 0;
+        int32 PoolVariableCapacity = 0;
+        int32 PoolNumberCapacity = 0;
+        int32 PoolStringCapacity = 0;
+
+        // Blocks CSPICE has malloc'ed and not freed
+        int32 Allocations = 0;
+
+        // Binary kernels MaxQ has mapped (address space, not necessarily
+        // resident)
+        int32 MappedKernels = 0;
+        int64 MappedBytes = 0;
+    };
+
+    SPICE_API bool GetMemoryReport(
+        FSpiceMemoryReport& Report,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // The report, to LogSpice
+    SPICE_API void LogMemoryReport(const FSpiceMemoryReport& Report);
+}
@@ -0,0 +1,74 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceName.h
+//
+// API Comments
+//
+// Purpose:  Interned body and frame names.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceName.h is part of the "refined C++ API".
+//
+// Every call that takes an FString name pays for a TCHAR->ANSI conversion,
+// and usually a bods2c/namfrm lookup inside CSPICE, for names that hardly ever
+// change ("EARTH", "J2000"...).  An FSpiceName is a pointer to an interned
+// entry that holds the name's ANSI spelling, so constructing one costs a
+// lookup, and copying and passing one costs nothing.  Keep them around (as
+// members, or statics) instead of constructing them per call.
+//
+// Entries also cache the NAIF body ID and frame ID the name resolves to.
+// Entries are never freed, and resolved IDs are checked against the pool
+// generation (see MaxQ::Data::GetPoolGeneration), so a name that's
+// redefined by a kernel, boddef or a pool write re-resolves.
+//
+// Names are interned case-insensitively, as SPICE compares them.
+// Aberration corrections don't need interning:  MaxQ::Core::ToANSIString
+// maps the enums to static strings already.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+class SPICE_API FSpiceName
+{
+public:
+    FSpiceName() = default;
+    explicit FSpiceName(const FString& Name);
+    explicit FSpiceName(const TCHAR* Name);
+
+    bool IsNone() const { return Entry == nullptr; }
+
+    // The name, as it was first interned.  Empty if IsNone().
+    const FString& ToString() const;
+    // NUL terminated.  "" if IsNone().
+    const ANSICHAR* Ansi() const;
+
+    // bods2c.  Signals SPICE(IDCODENOTFOUND) if the name isn't a body.
+    // Like every CSPICE call, only from the thread that makes SPICE calls.
+    bool BodyId(int& Id) const;
+    // namfrm.  Signals SPICE(UNKNOWNFRAME) if the name isn't a frame.
+    bool FrameId(int& Id) const;
+
+    bool operator==(const FSpiceName& Other) const { return Entry == Other.Entry; }
+    bool operator!=(const FSpiceName& Other) const { return Entry != Other.Entry; }
+
+    friend uint32 GetTypeHash(const FSpiceName& Name) { return ::PointerHash(Name.Entry); }
+
+private:
+    struct FEntry;
+    static const FEntry* Intern(const FString& Name);
+
+    const FEntry* Entry = nullptr;
+};
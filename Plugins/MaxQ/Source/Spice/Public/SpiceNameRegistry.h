@@ -0,0 +1,90 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceNameRegistry.h
+//
+// API Comments
+//
+// Purpose:  Thread-safe snapshots of the NAIF body and frame name mappings.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceNameRegistry.h is part of the "refined C++ API".
+//
+// bodn2c/bodc2n/namfrm/frmnam go through CSPICE's hashes and string
+// normalization, and (like every CSPICE call) can only be made from the
+// thread that makes SPICE calls.  UI population and worker threads usually
+// just want to map a name.
+//
+// FNameRegistry holds every body name (built in, from text kernels, and from
+// MaxQ::Data::Boddef) and every frame (built in and from text kernels),
+// hashed both ways.  It's built on the SPICE thread, with CSPICE's own
+// answers, so the mappings are exactly bods2c's, bodc2n's, namfrm's and
+// frmnam's at that moment.  A snapshot is immutable:  any thread can hold
+// one and look things up without a lock.
+//
+// The registry is rebuilt when kernels are loaded, unloaded or cleared
+// through MaxQ and on Boddef.  Pool writes made another way (pdpool etc)
+// leave it stale until UpdateNameRegistry is called;  IsCurrent says so.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Data
+{
+    class SPICE_API FNameRegistry
+    {
+    public:
+        // Reads the mappings.  Uses CSPICE.
+        static TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> FromKernelPool();
+
+        // As bods2c:  names are compared as SPICE compares them (case,
+        // leading/trailing and repeated blanks don't matter), and a name
+        // that's an integer is that code.
+        bool BodyCode(const FString& Name, int32& Code) const;
+        bool BodyCode(FName Name, int32& Code) const;
+
+        // As bodc2n:  the name the code was most recently given
+        bool BodyName(int32 Code, FString& Name) const;
+
+        // As namfrm/frmnam
+        bool FrameId(const FString& Name, int32& Id) const;
+        bool FrameId(FName Name, int32& Id) const;
+        bool FrameName(int32 Id, FString& Name) const;
+
+        // Everything, for lists and pickers.  Keys are normalized names
+        // (upper case, single blanks).
+        const TMap<FName, int32>& GetBodyCodes() const { return BodyCodes; }
+        const TMap<int32, FString>& GetFrameNames() const { return FrameNames; }
+
+        // The pool generation this was read at (MaxQ::Data::GetPoolGeneration)
+        uint64 GetPoolGeneration() const { return PoolGeneration; }
+        bool IsCurrent() const;
+
+    private:
+        TMap<FName, int32> BodyCodes;
+        TMap<int32, FString> BodyNames;
+        TMap<FName, int32> FrameIds;
+        TMap<int32, FString> FrameNames;
+
+        uint64 PoolGeneration = 0;
+    };
+
+    // The latest snapshot.  Any thread;  doesn't use CSPICE.
+    SPICE_API TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> GetNameRegistry();
+
+    // Rebuilds the registry if the kernel pool has changed since it was
+    // built.  Uses CSPICE.  Returns the current snapshot.
+    SPICE_API TSharedRef<const FNameRegistry, ESPMode::ThreadSafe> UpdateNameRegistry();
+}
@@ -842,3 +842,120 @@ static inline bool operator!=(const FSStateVector& lhs, const FSStateVector& rhs
 
 SPICE_API FSQuaternion operator*(const FSQuaternion& lhs, const FSQuaternion& rhs);
 
+
+
+//------------------------------------------------------------------------------
+// Lazy vector expressions
+//
+// The operators above evaluate one operation at a time.  Wrapping an operand
+// in MaxQ::Math::Lazy() builds an expression instead, which is evaluated in a
+// single pass over the components when it's assigned to a vector:
+//
+//     FSDistanceVector r = Lazy(r1) + Lazy(v) * dt - r2;
+//
+// Units are checked at compile time:  only expressions of the same vector type
+// add or subtract, and a velocity expression times an FSEphemerisPeriod is a
+// distance expression.  Expressions hold their operands by value, so they stay
+// valid after the operands go away, but 'auto e = Lazy(a) + b' is an
+// expression, not a vector (use Eval(), or assign it to a vector).
+//------------------------------------------------------------------------------
+namespace MaxQ::Math
+{
+    namespace Expr
+    {
+        template<class VectorType, class Derived>
+        struct TVectorExpr
+        {
+            using Vector = VectorType;
+            static constexpr int N = Inline::Dim<VectorType>;
+
+            const Derived& Self() const { return static_cast<const Derived&>(*this); }
+
+            inline VectorType Eval() const
+            {
+                double v[N];
+                for (int i = 0; i < N; ++i) v[i] = Self()[i];
+                return VectorType{ v };
+            }
+
+            inline operator VectorType() const { return Eval(); }
+        };
+
+        template<class VectorType>
+        struct TLeaf : TVectorExpr<VectorType, TLeaf<VectorType>>
+        {
+            double v[Inline::Dim<VectorType>];
+
+            explicit TLeaf(const VectorType& vector) { vector.CopyTo(v); }
+            double operator[](int i) const { return v[i]; }
+        };
+
+        template<class VectorType, class L, class R>
+        struct TSum : TVectorExpr<VectorType, TSum<VectorType, L, R>>
+        {
+            L l; R r;
+
+            TSum(const L& _l, const R& _r) : l(_l), r(_r) {}
+            double operator[](int i) const { return l[i] + r[i]; }
+        };
+
+        template<class VectorType, class L, class R>
+        struct TDifference : TVectorExpr<VectorType, TDifference<VectorType, L, R>>
+        {
+            L l; R r;
+
+            TDifference(const L& _l, const R& _r) : l(_l), r(_r) {}
+            double operator[](int i) const { return l[i] - r[i]; }
+        };
+
+        // s * e, where the result may have different units than e
+        // (eg velocity * period = distance)
+        template<class VectorType, class E>
+        struct TScaled : TVectorExpr<VectorType, TScaled<VectorType, E>>
+        {
+            E e; double s;
+
+            TScaled(const E& _e, double _s) : e(_e), s(_s) {}
+            double operator[](int i) const { return s * e[i]; }
+        };
+
+        template<class V, class L, class R>
+        inline TSum<V, L, R> operator+(const TVectorExpr<V, L>& lhs, const TVectorExpr<V, R>& rhs) { return { lhs.Self(), rhs.Self() }; }
+        template<class V, class L>
+        inline TSum<V, L, TLeaf<V>> operator+(const TVectorExpr<V, L>& lhs, const V& rhs) { return { lhs.Self(), TLeaf<V>(rhs) }; }
+        template<class V, class R>
+        inline TSum<V, TLeaf<V>, R> operator+(const V& lhs, const TVectorExpr<V, R>& rhs) { return { TLeaf<V>(lhs), rhs.Self() }; }
+
+        template<class V, class L, class R>
+        inline TDifference<V, L, R> operator-(const TVectorExpr<V, L>& lhs, const TVectorExpr<V, R>& rhs) { return { lhs.Self(), rhs.Self() }; }
+        template<class V, class L>
+        inline TDifference<V, L, TLeaf<V>> operator-(const TVectorExpr<V, L>& lhs, const V& rhs) { return { lhs.Self(), TLeaf<V>(rhs) }; }
+        template<class V, class R>
+        inline TDifference<V, TLeaf<V>, R> operator-(const V& lhs, const TVectorExpr<V, R>& rhs) { return { TLeaf<V>(lhs), rhs.Self() }; }
+
+        template<class V, class E>
+        inline TScaled<V, E> operator-(const TVectorExpr<V, E>& e) { return { e.Self(), -1. }; }
+        template<class V, class E>
+        inline TScaled<V, E> operator*(double s, const TVectorExpr<V, E>& e) { return { e.Self(), s }; }
+        template<class V, class E>
+        inline TScaled<V, E> operator*(const TVectorExpr<V, E>& e, double s) { return { e.Self(), s }; }
+        template<class V, class E>
+        inline TScaled<V, E> operator/(const TVectorExpr<V, E>& e, double s) { return { e.Self(), 1. / s }; }
+
+        // Unit changes
+        template<class E>
+        inline TScaled<FSDistanceVector, E> operator*(const TVectorExpr<FSVelocityVector, E>& e, const FSEphemerisPeriod& dt) { return { e.Self(), dt.seconds }; }
+        template<class E>
+        inline TScaled<FSDistanceVector, E> operator*(const FSEphemerisPeriod& dt, const TVectorExpr<FSVelocityVector, E>& e) { return { e.Self(), dt.seconds }; }
+        template<class E>
+        inline TScaled<FSDistanceVector, E> operator*(const TVectorExpr<FSDimensionlessVector, E>& e, const FSDistance& d) { return { e.Self(), d.km }; }
+        template<class E>
+        inline TScaled<FSVelocityVector, E> operator*(const TVectorExpr<FSDimensionlessVector, E>& e, const FSSpeed& s) { return { e.Self(), s.kmps }; }
+    }
+
+    template<class VectorType>
+    inline Expr::TLeaf<VectorType> Lazy(const VectorType& v) { return Expr::TLeaf<VectorType>(v); }
+
+    template<class V, class E>
+    inline V Eval(const Expr::TVectorExpr<V, E>& e) { return e.Eval(); }
+}
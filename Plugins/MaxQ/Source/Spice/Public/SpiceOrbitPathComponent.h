@@ -0,0 +1,147 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceOrbitPathComponent.h
+//
+// API Comments
+//
+// Purpose:  Orbit paths, sampled off the game thread and drawn from a cache.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceOrbitPathComponent.h is part of the "Blueprints API".
+//
+// USpiceOrbits::RenderDebugOrbit recomputes the conic and redraws it in debug
+// lines every frame, and debug lines are compiled out of shipping builds.
+// UMaxQOrbitPathComponent samples the path once, on the FSpiceExecutor
+// thread, and keeps it as a line batch:  the render proxy holds the lines,
+// so nothing happens on the game thread between rebuilds, and it draws in
+// any build configuration.
+//
+// The path is either:
+// * a conic (Elements, in ElementsFrame, drawn in Frame):  the whole ellipse,
+//   or a hyperbola out to HyperbolicRange from the focus.  It's rebuilt when
+//   the elements change by more than ElementTolerance (perifocal distance,
+//   as a fraction, and eccentricity) or AngleTolerance (the orientation).
+// * an SPK trajectory (Target as seen by Observer, in Frame) over
+//   [Epoch - Before, Epoch + After].  It's rebuilt when Epoch has moved more
+//   than MaxAge since the last one.
+//
+// Vertices are placed where the path bends:  segments are halved until each
+// one's midpoint is within Tolerance (km) of its chord, so a tight periapsis
+// gets more vertices than a slow apoapsis.  MaxSegments caps the count.
+//
+// Points are swizzled to UE and scaled by Scale, relative to the component
+// (attach it to whatever sits at the central body or Observer, oriented in
+// Frame).  Moving the component moves the lines, without resampling.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/LineBatchComponent.h"
+#include "SpiceTypes.h"
+#include "SpiceOrbitPathComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FMaxQOrbitPathUpdatedDelegate);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQOrbitPathErrorDelegate, const FString&, ErrorMessage);
+
+
+UENUM(BlueprintType)
+enum class EMaxQOrbitPathSource : uint8
+{
+    ConicElements UMETA(DisplayName = "Conic Elements"),
+    Trajectory UMETA(DisplayName = "SPK Trajectory")
+};
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API UMaxQOrbitPathComponent : public ULineBatchComponent
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQOrbitPathComponent();
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") EMaxQOrbitPathSource Source = EMaxQOrbitPathSource::ConicElements;
+    // The frame the path is drawn in
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FString Frame = TEXT("ECLIPJ2000");
+
+    // ConicElements
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FSConicElements Elements;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FString ElementsFrame = TEXT("ECLIPJ2000");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FSDistance HyperbolicRange = FSDistance(1.e6);
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") double ElementTolerance = 1.e-4;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FSAngle AngleTolerance = FSAngle(0.01 * PI / 180.);
+
+    // Trajectory
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FString Target = TEXT("MOON");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FString Observer = TEXT("EARTH");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") ES_AberrationCorrectionWithNewtonians AberrationCorrection = ES_AberrationCorrectionWithNewtonians::None;
+    // The trajectory's center epoch.  Set it as time advances.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FSEphemerisTime Epoch;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FSEphemerisPeriod Before = FSEphemerisPeriod(14. * 86400.);
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FSEphemerisPeriod After = FSEphemerisPeriod(14. * 86400.);
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FSEphemerisPeriod MaxAge = FSEphemerisPeriod(3600.);
+
+    // Sampling:  max distance (km) from a segment's midpoint to its chord
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") double Tolerance = 10.;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath", meta = (ClampMin = "4")) int32 MinSegments = 64;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath", meta = (ClampMin = "4")) int32 MaxSegments = 4096;
+
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") double Scale = 1.;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") FLinearColor Color = FLinearColor::White;
+    // World units, 0:  one pixel
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") float Thickness = 0.f;
+
+    // How often (real time, seconds) to check if a rebuild's needed
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|OrbitPath") float UpdateInterval = 0.1f;
+
+    // Component space (UE units)
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|OrbitPath") TArray<FVector> Points;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|OrbitPath") bool bClosed = false;
+
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|OrbitPath") FMaxQOrbitPathUpdatedDelegate OnUpdated;
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|OrbitPath") FMaxQOrbitPathErrorDelegate OnError;
+
+    // Rebuild at the next check, whatever has (or hasn't) changed.  Needed
+    // after changing anything but Elements, Epoch and the appearance.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|OrbitPath")
+    void Invalidate();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+protected:
+    virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport) override;
+
+private:
+    struct FPathResult;
+
+    bool NeedsRebuild() const;
+    void Completed(const FPathResult& Result);
+    void Redraw();
+
+    // What the current path was built from
+    EMaxQOrbitPathSource BuiltSource = EMaxQOrbitPathSource::ConicElements;
+    FSConicElements BuiltElements;
+    FSEphemerisTime BuiltEpoch;
+
+    int32 Generation = 0;
+    int32 BuiltGeneration = -1;
+    float SinceCheck = 0.f;
+    bool bInFlight = false;
+};
@@ -0,0 +1,140 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceOrbitalPhysics.h
+//
+// API Comments
+//
+// Purpose:  Orbital gravity on Chaos rigid bodies, from the physics thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceOrbitalPhysics.h is part of the "Blueprints API".
+//
+// Spacecraft that collide and thrust are Chaos rigid bodies, but their
+// gravity comes from SPICE, which the physics thread can't call.
+// UMaxQOrbitalPhysicsSubsystem registers a Chaos sim callback that applies
+// orbital gravity to registered bodies every physics step (every substep,
+// with async physics), without touching CSPICE or the game thread:
+//
+// * The central body's point mass, from GM.
+// * Any MaxQ::Orbits::IForceModels (SpiceIntegrator.h, SpiceGravityField.h):
+//   third bodies from an FChebyshevCache, zonal or spherical harmonic
+//   gravity, drag.  They're the numerical integrator's force models, so
+//   they're already thread-safe and CSPICE free.  The cache has to be built
+//   with the central body as observer, in the frame the world is in, over
+//   the span being played.
+//
+// World positions map to SPICE as UMaxQEphemerisSubsystem's floating
+// placements do:  r = Origin + Swizzle(Location / Scale), with Origin
+// relative to the central body.  With bFollowEphemerisSubsystem, Epoch,
+// Scale and Origin are the ephemeris subsystem's, so physics and placements
+// agree, rebases included.
+//
+// Each game frame hands the physics thread the epoch, the settings and the
+// bodies' proxies.  The callback advances the epoch by TimeScale ET seconds
+// per physics second across the frame's steps.  A TimeScale other than 1
+// moves the ephemeris faster than the bodies integrate, so the third bodies
+// won't be where a real orbit would see them.  Registered bodies have UE's
+// own gravity turned off.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "SpiceTypes.h"
+#include "SpiceOrbitalPhysics.generated.h"
+
+class UPrimitiveComponent;
+class UMaxQOrbitalPhysicsSubsystem;
+class FMaxQOrbitalPhysicsCallback;
+
+namespace MaxQ::Orbits
+{
+    class IForceModel;
+}
+
+
+USTRUCT()
+struct FMaxQOrbitalPhysicsTickFunction : public FTickFunction
+{
+    GENERATED_BODY()
+
+    UMaxQOrbitalPhysicsSubsystem* Subsystem = nullptr;
+
+    virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+    virtual FString DiagnosticMessage() override;
+    virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMaxQOrbitalPhysicsTickFunction> : public TStructOpsTypeTraitsBase2<FMaxQOrbitalPhysicsTickFunction>
+{
+    enum
+    {
+        WithCopy = false
+    };
+};
+
+
+UCLASS(Config = Game)
+class SPICE_API UMaxQOrbitalPhysicsSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    typedef TArray<TSharedRef<const MaxQ::Orbits::IForceModel, ESPMode::ThreadSafe>> FForceModels;
+
+    // The central body's GM (km^3/s^2).  0:  no point mass.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Physics") double GM = 398600.4418;
+
+    // Epoch, Scale and Origin are UMaxQEphemerisSubsystem's
+    UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Physics") bool bFollowEphemerisSubsystem = true;
+
+    // The epoch of the next frame's physics
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Physics") FSEphemerisTime Epoch;
+    // Ephemeris seconds per second of physics
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Physics") double TimeScale = 1.;
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Physics") double Scale = 1.;
+    // The world origin, relative to the central body (km)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Physics") FSDistanceVector Origin;
+
+    // Perturbations, replacing any set before.  Object indices passed to
+    // them are registration order.
+    void SetForces(const FForceModels& Forces);
+
+    // Simulating components (gravity is turned off on them)
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Physics")
+    void RegisterBody(UPrimitiveComponent* Component);
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Physics")
+    void UnregisterBody(UPrimitiveComponent* Component);
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Physics")
+    int32 Num() const { return Bodies.Num(); }
+
+    // Hands this frame's epoch, settings and bodies to the physics thread
+    void Update(float DeltaTime);
+
+    virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+
+private:
+    TArray<TWeakObjectPtr<UPrimitiveComponent>> Bodies;
+    TSharedPtr<const FForceModels, ESPMode::ThreadSafe> Forces;
+
+    FMaxQOrbitalPhysicsCallback* Callback = nullptr;
+    FMaxQOrbitalPhysicsTickFunction TickFunction;
+};
@@ -86,6 +86,8 @@ public:
         );
 
     /// <summary>Renders an orbit in debug lines</summary>
+    // Recomputes the conic every call.  For something that also draws in
+    // shipping builds, see UMaxQOrbitPathComponent.
     UFUNCTION(BlueprintCallable,
         Category = "MaxQ|Debug|Orbits",
         meta = (
@@ -0,0 +1,140 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceOutlineComponent.h
+//
+// API Comments
+//
+// Purpose:  Limb and terminator outlines, computed off the game thread.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceOutlineComponent.h is part of the "Blueprints API".
+//
+// Redrawing a planet's limb or day/night terminator with USpice::limbpt and
+// termpt every frame runs a full ellipsoid or DSK search on the game thread.
+// USpiceOutlineComponent runs limbpt_c and termpt_c on the FSpiceExecutor
+// thread instead, and only when the geometry has changed enough to matter:
+// the observer (or the illumination source) has moved more than
+// AngleTolerance as seen from the target, or its range has changed by more
+// than RangeTolerance, or MaxAge has passed since the last outline.  Until
+// then the previous outline is kept, and the cheap check (an spkpos or two)
+// is all that runs.
+//
+// The cuts' reference vector stays the same between updates, so an outline's
+// points stay in the same order, and a spline made from it doesn't crawl.
+//
+// Outlines are closed loops, one point per cut, in the target's body fixed
+// frame (FixRef) swizzled to UE and scaled by Scale:  attach whatever draws
+// them to something oriented in FixRef, at the target's center.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SpiceTypes.h"
+#include "SpiceOutlineComponent.generated.h"
+
+class USplineComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FSpiceOutlineUpdatedDelegate);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FSpiceOutlineErrorDelegate, const FString&, ErrorMessage);
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API USpiceOutlineComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    USpiceOutlineComponent();
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FString Target = TEXT("MARS");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FString FixRef = TEXT("IAU_MARS");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FString Observer = TEXT("EARTH");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FString IlluminationSource = TEXT("SUN");
+
+    // The epoch outlines are computed for.  Set it as time advances.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FSEphemerisTime Epoch;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") bool bLimb = true;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") bool bTerminator = true;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") ES_LimbComputationMethod LimbMethod = ES_LimbComputationMethod::TANGENT_ELLIPSOID;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") ES_GeometricModel TerminatorMethod = ES_GeometricModel::ELLIPSOID;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") ES_Shadow Shadow = ES_Shadow::UMBRAL;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") ES_CurveType CurveType = ES_CurveType::TANGENT;
+    // DSK methods:  shape surfaces (empty:  all)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") TArray<FString> ShapeSurfaces;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") ES_AberrationCorrectionWithNewtonians AberrationCorrection = ES_AberrationCorrectionWithNewtonians::CN_S;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") ES_AberrationCorrectionLocus LimbLocus = ES_AberrationCorrectionLocus::CENTER;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") ES_AberrationCorrectionLocusTerminator TerminatorLocus = ES_AberrationCorrectionLocusTerminator::ELLIPSOID_TERMINATOR;
+
+    // Points per outline
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline", meta = (ClampMin = "3")) int NumCuts = 180;
+    // DSK methods:  limbpt/termpt's schstp and soltol
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FSAngle SearchStep = FSAngle(1.e-4);
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FSAngle SolutionTolerance = FSAngle(1.e-7);
+
+    // Recompute when the observer or source has moved further than this, as
+    // seen from the target...
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FSAngle AngleTolerance = FSAngle(0.1 * PI / 180.);
+    // ...or its range has changed by more than this fraction...
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") double RangeTolerance = 1.e-3;
+    // ...or the outline is older than this (ephemeris time)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") FSEphemerisPeriod MaxAge = FSEphemerisPeriod(3600.);
+
+    // How often (real time, seconds) to check
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") float UpdateInterval = 0.1f;
+
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Outline") double Scale = 1.;
+
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Outline") TArray<FVector> Limb;
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Outline") TArray<FVector> Terminator;
+    // The epoch Limb and Terminator are for
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Outline") FSEphemerisTime OutlineEpoch;
+
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Outline") FSpiceOutlineUpdatedDelegate OnUpdated;
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Outline") FSpiceOutlineErrorDelegate OnError;
+
+    // Recompute at the next check, whatever has (or hasn't) moved.  Needed
+    // after changing anything but Epoch and the tolerances.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Outline")
+    void Invalidate();
+
+    // Replaces Spline's points with the limb's (or the terminator's), as a
+    // closed loop in Spline's local space.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Outline")
+    void UpdateSpline(USplineComponent* Spline, bool bTerminatorOutline = false) const;
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+    struct FOutlineState;
+    struct FOutlineResult;
+
+    void Completed(const FOutlineResult& Result);
+
+    // Only touched on the executor thread
+    TSharedPtr<FOutlineState, ESPMode::ThreadSafe> State;
+
+    int32 Generation = 0;
+    float SinceCheck = 0.f;
+    bool bInFlight = false;
+};
@@ -0,0 +1,122 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePassPrediction.h
+//
+// API Comments
+//
+// Purpose:  Ground station pass prediction for whole SGP4 catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePassPrediction.h is part of the "refined C++ API".
+//
+// gfposc with an elevation constraint finds one satellite's passes over one
+// station, serially, recomputing the station's state (and the satellite's,
+// through an SPK) at every step.  PredictPasses finds the passes of every
+// (satellite, station) pair at once, from FSGP4Propagator models, in
+// parallel across satellites.
+//
+// Each satellite is propagated once per coarse step, and its elevation from
+// every station computed from that (as azlcpo/recazl would, natively).  Rises
+// and sets are bracketed by sign changes of (elevation - mask), and passes
+// that peak above the mask between two steps by local maxima.  AOS and LOS
+// are then refined by root finding, and max elevation by golden section
+// search.  A pass shorter than the step can only be missed if it also peaks
+// between two steps that are both below the mask by less than it rises:
+// keep the step below a third of the shortest pass of interest.
+//
+// SGP4 states are TEME.  They're rotated to a pseudo Earth fixed frame by
+// Greenwich mean sidereal time (IAU-82, as Vallado's teme2ecef, without
+// polar motion), and stations are WGS-84 geodetic, so nothing needs a PCK
+// or an SPK.  UT1 is taken to be UTC.  Only the TDB - UTC offset comes from
+// CSPICE (deltet_c, once per call), so an LSK must be loaded and
+// PredictPasses must be called from the SPICE thread.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+#include "SpiceWindow.h"
+
+namespace MaxQ::Orbits
+{
+    struct FGroundStation
+    {
+        FString Name;
+        // Geodetic (WGS-84), radians & km
+        double Latitude = 0.;
+        double Longitude = 0.;
+        double Altitude = 0.;
+        // Elevation mask, radians
+        double MinElevation = 0.;
+    };
+
+    struct FPassPredictionSettings
+    {
+        // Coarse sweep step, seconds
+        double Step = 60.;
+        // AOS, LOS and max elevation times, seconds
+        double Tolerance = 1.e-3;
+    };
+
+    struct FPass
+    {
+        int32 Satellite = INDEX_NONE;
+        int32 Station = INDEX_NONE;
+        // TDB.  Passes in progress at the start or the end of the prediction
+        // window are cut off there.
+        double AOS = 0.;
+        double LOS = 0.;
+        double MaxElevationTime = 0.;
+        // Radians
+        double MaxElevation = 0.;
+    };
+
+    struct SPICE_API FPassPredictions
+    {
+        int32 NumSatellites = 0;
+        int32 NumStations = 0;
+
+        // Satellite * NumStations + Station:  [AOS, LOS] intervals
+        TArray<MaxQ::GeometryFinder::FSWindow> Windows;
+
+        // Every pass, by satellite, then station, then AOS
+        TArray<FPass> Passes;
+
+        const MaxQ::GeometryFinder::FSWindow& Window(int32 Satellite, int32 Station) const { return Windows[Satellite * NumStations + Station]; }
+    };
+
+    // Passes of every catalog object over every station, within [Start,
+    // Stop] (TDB).  Invalid propagators, and times SGP4 fails at, are never
+    // in view.  Requires a leapseconds kernel.
+    SPICE_API bool PredictPasses(
+        TArrayView<const FSGP4Propagator> Catalog,
+        TArrayView<const FGroundStation> Stations,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        FPassPredictions& Predictions,
+        const FPassPredictionSettings& Settings = FPassPredictionSettings(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // A satellite's elevation from a station, as PredictPasses computes it.
+    // Thread-safe (no CSPICE).  DeltaUtc:  TDB - UTC, seconds (deltet_c).
+    SPICE_API double StationElevation(
+        const FSGP4Propagator& Satellite,
+        const FGroundStation& Station,
+        double et,
+        double DeltaUtc
+    );
+}
@@ -0,0 +1,81 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePhotometry.h
+//
+// API Comments
+//
+// Purpose:  Phase angles, ranges and visual magnitudes for whole catalogs.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePhotometry.h is part of the "refined C++ API".
+//
+// Drawing satellites as points of the right brightness needs each one's
+// phase angle (USpice::phaseq) and range from the observer:  a CSPICE call
+// per object, each redoing the Sun's and the observer's states.  Photometry
+// takes the Sun's and the observer's positions once, and computes every
+// object's phase angle, range and estimated visual magnitude natively, in
+// parallel, from any thread.
+//
+// Magnitudes use the standard (intrinsic) magnitude convention of visual
+// satellite observers:  an object's standard magnitude is its brightness at
+// 1000 km and 90 degrees phase, and it's scaled to other geometry as a
+// diffuse (Lambertian) sphere:
+//     m = std + 5 log10(range / 1000 km) - 2.5 log10(pi F(phase))
+//     F(phase) = (sin(phase) + (pi - phase) cos(phase)) / pi
+// Shadow fractions (EclipseStates) dim the object by the Sun's hidden
+// fraction;  a fully shadowed object is UnlitMagnitude.
+//
+// Positions are geometric:  phaseq's light time corrections move a LEO
+// object by well under a kilometer, far below what a magnitude estimate
+// resolves.  Angles, ranges and magnitudes are floats, for instance custom
+// data (UMaxQCatalogComponent).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Math
+{
+    // Caller owned, one element per object.  Any may be empty.
+    struct FPhotometryBatch
+    {
+        // Radians (phaseq's)
+        TArrayView<float> Phase;
+        // km, from the observer
+        TArrayView<float> Range;
+        TArrayView<float> Magnitude;
+    };
+
+    // A fully shadowed (or coincident) object's magnitude
+    constexpr float UnlitMagnitude = 99.f;
+
+    // Sun and Observer:  relative to the same center, in the same frame as
+    // Positions (km).  StandardMagnitudes (optional):  per object, instead of
+    // StandardMagnitude.  Shadows (optional):  EclipseStates' shadow
+    // fractions.  False if any lengths differ.
+    SPICE_API bool Photometry(
+        const FSDistanceVector& Sun,
+        const FSDistanceVector& Observer,
+        const FConstVectorBatch& Positions,
+        const FPhotometryBatch& Out,
+        float StandardMagnitude = 4.f,
+        TArrayView<const float> StandardMagnitudes = TArrayView<const float>(),
+        TArrayView<const float> Shadows = TArrayView<const float>()
+    );
+
+    // One object's magnitude, as Photometry computes it.  Phase:  radians.
+    SPICE_API float VisualMagnitude(float StandardMagnitude, double Range, double Phase, float Shadow = 0.f);
+}
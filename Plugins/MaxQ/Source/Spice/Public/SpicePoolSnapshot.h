@@ -0,0 +1,90 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePoolSnapshot.h
+//
+// API Comments
+//
+// Purpose:  Binary snapshots of the kernel pool.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePoolSnapshot.h is part of the "refined C++ API".
+//
+// Text kernels (.tls, .tpc, .tf, .tsc, ...) go through CSPICE's line-by-line
+// parser every time they're loaded, which for big PCKs and frame kernels is
+// measurable on every launch and every PIE session.  A snapshot holds the
+// parsed result (every pool variable's name, type and values), and restoring
+// it is one pdpool/pcpool per variable.
+//
+// FurnshWithSnapshot is the easy way to use them:  it loads the text kernels
+// from a snapshot keyed by a hash of their contents (so it's rebuilt when any
+// of them changes), and loads everything else (binary kernels, meta-kernels)
+// as Furnsh does.
+//
+// Variables restored from a snapshot are in the pool, but their kernels
+// aren't in CSPICE's list of loaded kernels:  unload can't remove them, but
+// ClearAll does.
+//
+// FurnshWithSnapshot's snapshots are keyed by absolute paths, so they're a
+// per-machine cache.  BakePoolSnapshot writes one to ship instead, and
+// FurnshPoolSnapshot loads it in place of its text kernels.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Data
+{
+    // The whole kernel pool
+    SPICE_API bool SavePoolSnapshot(
+        TArray<uint8>& Snapshot,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Adds the snapshot's variables to the pool (replacing any with the
+    // same names).
+    SPICE_API bool LoadPoolSnapshot(
+        TArrayView<const uint8> Snapshot,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // relativePaths are as Furnsh.  Snapshots are kept in
+    // snapshotDirectory (default:  Saved/MaxQ/PoolSnapshots).
+    SPICE_API bool FurnshWithSnapshot(
+        const TArray<FString>& relativePaths,
+        const FString& snapshotDirectory = FString(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // For shipping snapshots with the content (MaxQPreprocessKernels):
+    // loads the text kernels, writes what they changed to outputPath, and
+    // unloads them again.  Paths as Furnsh.
+    SPICE_API bool BakePoolSnapshot(
+        const TArray<FString>& textKernelPaths,
+        const FString& outputPath,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Restores a baked snapshot (path as Furnsh).  It isn't in the kernel
+    // history, so FSpiceProcessPool workers don't get it.
+    SPICE_API bool FurnshPoolSnapshot(
+        const FString& relativePath,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,80 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpicePoolWatch.h
+//
+// API Comments
+//
+// Purpose:  Kernel pool change notifications, as delegates.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpicePoolWatch.h is part of the "refined C++ API".
+//
+// CSPICE's watchers (swpool_c/cvpool_c) flag an "agent" whenever any of the
+// pool variables it watches is set, deleted, or loaded again.  Nobody is
+// told, though;  the agent has to ask.  WatchPool registers an agent and a
+// delegate, and MaxQ asks on everyone's behalf after each call that can
+// change the pool:  kernel loads and unloads (MaxQ::Data::Furnsh, Unload,
+// USpice::furnsh, ...), clear_all, pdpool/pcpool/pipool, and pool snapshot
+// restores.  Each agent whose variables changed is broadcast once.
+//
+// A cache of, say, BODY399_RADII can then drop just that value, instead of
+// everything whenever MaxQ::Data::GetPoolGeneration moves.
+//
+// Agent names are CSPICE's:  up to 32 characters, shared with every other
+// swpool_c caller, so pick distinct ones.  WatchPoolVariable uses the
+// variable's own name.  Pool writes made directly through CSPICE aren't
+// seen until the next MaxQ call that changes the pool (the agent's flag
+// stays set until then), or NotifyPoolWatchers.
+//
+// Delegates run on the thread that changed the pool, which (like every
+// CSPICE call) is the thread that makes SPICE calls, and only from there
+// can agents be added or removed.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "Delegates/Delegate.h"
+
+namespace MaxQ::Data
+{
+    // The agent whose variables changed
+    DECLARE_MULTICAST_DELEGATE_OneParam(FOnPoolChanged, const FString&);
+
+    // Calls Delegate whenever any of Variables changes.  Several delegates can
+    // share an agent;  watching more variables with an agent adds to its list.
+    SPICE_API FDelegateHandle WatchPool(
+        const FString& Agent,
+        const TArray<FString>& Variables,
+        const FOnPoolChanged::FDelegate& Delegate,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // WatchPool(Variable, { Variable }, Delegate)
+    SPICE_API FDelegateHandle WatchPoolVariable(
+        const FString& Variable,
+        const FOnPoolChanged::FDelegate& Delegate,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Removes the delegate.  The agent itself is deleted (dwpool_c) with its
+    // last delegate.
+    SPICE_API void UnwatchPool(const FString& Agent, FDelegateHandle Handle);
+
+    // Checks every agent now, and broadcasts those that changed.  MaxQ calls
+    // it itself;  only needed after changing the pool through CSPICE.
+    SPICE_API void NotifyPoolWatchers();
+}
@@ -0,0 +1,178 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceProceduralSystem.h
+//
+// API Comments
+//
+// Purpose:  Generates kernels (SPK, PCK, FK) for procedural star systems.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceProceduralSystem.h is part of the "refined C++ API".
+//
+// Sample06's TRAPPIST-1 kernel is built one conics call per body per day,
+// serially, and written with spkw05.  A game that makes up its star systems
+// needs many of them, quickly.
+//
+// An FProceduralSystem is a star and its bodies, each with either conic
+// elements (around the star, or another body:  moons) or an initial state
+// for an N-body integration.  Generation has two halves:
+//
+// * PropagateSystem samples every body over the span, natively:  conic
+//   elements through FTwoBodyBatchPropagator, parallel across epochs;
+//   N-body states with a fixed step RK4 integration of the whole system
+//   around the star (mutual point mass gravity, with the indirect terms).
+//   With bChebyshev, each body's samples are fit to type 03 segments here
+//   too.  No CSPICE, so any thread, and many systems at once.
+// * WriteSystemKernels writes the SPK (type 03 segments, or the streaming
+//   FSpkSegmentWriter's), which uses CSPICE, and the text kernels:  a PCK
+//   (BODYnnn_RADII, _GM, and IAU style _POLE_RA, _POLE_DEC, _PM) and an FK
+//   (the names, and an IAU_<name> body-fixed frame for each rotating body).
+//
+// GenerateSystems does both for a list of systems, propagating all of them
+// in parallel first, and writes <Directory>/<Name>.bsp, .tpc and .tf.
+//
+// Every body's segments are relative to its Center (N-body bodies are
+// integrated around the star, and their Center's states subtracted).  IDs
+// and names are the caller's to keep unique;  the FK maps them, so a
+// generated system loads as its three kernels.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceSpkWriter.h"
+
+namespace MaxQ::Ephemeris
+{
+    struct FProceduralBody
+    {
+        // NAIF ID and name, both written to the FK's name map
+        int32 Id = 0;
+        FString Name;
+
+        // The body it orbits:  the star's ID, or an earlier body's
+        int32 Center = 0;
+
+        // Conics:  elements around Center (as conics_c)
+        FSConicElements Elements;
+
+        // NBody:  the state relative to Center at the span's start (km,
+        // km/s, in the system's frame)
+        FSStateVector State;
+
+        // km^3/s^2.  NBody:  the body's pull on the others.  Written to the
+        // PCK if it's positive.
+        double GM = 0.;
+
+        // km.  Written to the PCK if any is positive.
+        FSDistanceVector Radii;
+
+        // IAU style rotation:  pole RA and DEC (degrees), prime meridian at
+        // J2000 (degrees) and its rate (degrees/day).  Only with bRotates,
+        // which also defines its IAU_<name> frame.
+        bool bRotates = false;
+        double PoleRA = 0.;
+        double PoleDec = 90.;
+        double PrimeMeridian = 0.;
+        double RotationRate = 360.;
+    };
+
+    enum class EProceduralPropagation : uint8
+    {
+        Conics,
+        NBody
+    };
+
+    struct FProceduralSystem
+    {
+        // Segment IDs, kernel comments and GenerateSystems' file names
+        FString Name;
+
+        // Its Center, Elements and State are ignored.  Its GM is the central
+        // attraction of the N-body integration.
+        FProceduralBody Star;
+        TArray<FProceduralBody> Bodies;
+
+        EProceduralPropagation Propagation = EProceduralPropagation::Conics;
+    };
+
+    struct FProceduralSystemSettings
+    {
+        // The SPK's (inertial) frame
+        FString Frame = TEXT("ECLIPJ2000");
+
+        // Span, ET
+        double Start = 0.;
+        double Stop = 30. * 86400.;
+
+        // Seconds between samples
+        double Step = 3600.;
+
+        // NBody:  RK4 steps per sample
+        int32 Substeps = 16;
+
+        // Fit type 03 segments;  otherwise the samples go to an
+        // FSpkSegmentWriter with SegmentSettings
+        bool bChebyshev = true;
+        FSpkChebyshevFitSettings FitSettings;
+        FSpkSegmentWriterSettings SegmentSettings;
+
+        // The FK's frame IDs:  FirstFrameId + the body's index (the star is
+        // -1)
+        int32 FirstFrameId = 1990000;
+    };
+
+    // One system's propagated samples, ready to write
+    struct FProceduralSystemStates
+    {
+        TArray<double> Epochs;
+        // Per body, per epoch, relative to the body's Center
+        TArray<TArray<FSStateVector>> States;
+        // Per body, with bChebyshev
+        TArray<TArray<FSpkChebyshevSegment>> Segments;
+    };
+
+    // Thread-safe (no CSPICE)
+    SPICE_API bool PropagateSystem(
+        const FProceduralSystem& System,
+        const FProceduralSystemSettings& Settings,
+        FProceduralSystemStates& States,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Any empty path isn't written.  An existing SPK is replaced.  Uses
+    // CSPICE (for the SPK).
+    SPICE_API bool WriteSystemKernels(
+        const FProceduralSystem& System,
+        const FProceduralSystemSettings& Settings,
+        const FProceduralSystemStates& States,
+        const FString& SpkPath,
+        const FString& PckPath,
+        const FString& FkPath,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Propagates every system in parallel, then writes each one's kernels
+    // to Directory.  Returns the number of systems written;  the first
+    // failure is reported.  Uses CSPICE.
+    SPICE_API int32 GenerateSystems(
+        TArrayView<const FProceduralSystem> Systems,
+        const FProceduralSystemSettings& Settings,
+        const FString& Directory,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,192 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceProcessPool.h
+//
+// API Comments
+//
+// Purpose:  A pool of worker processes, each with its own CSPICE image.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceProcessPool.h is part of the "refined C++ API".
+//
+// CSPICE is not re-entrant, so one process can only run one SPICE query at a
+// time (see FSpiceExecutor).  Long geometry finder searches can take minutes
+// on one core.  FSpiceProcessPool starts N child processes, re-running this
+// executable with -run=SpiceWorker.  Each worker replays the kernel history
+// recorded by MaxQ::Data::Furnsh/Unload before running a job, so workers see
+// the same kernels as the parent.
+//
+// Lambdas can't cross a process boundary.  So, jobs are registered by name
+// (in both parent and worker, via a static FSpiceJobRegistration), and the
+// request/response are byte arrays, serialized by the caller.  Requests and
+// responses travel through a shared memory mailbox per worker.
+//
+// Commandlets are only available where the engine can run them (editor,
+// development/server targets).  If workers can't be started, Start() fails
+// and the caller should fall back to running in-process.
+//
+// A worker that exits (or runs past the job timeout, and is killed) fails
+// its job, and is relaunched for the next one.  One that can't be
+// relaunched is retired; with none left, jobs fail rather than wait.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "HAL/PlatformProcess.h"
+#include "SpiceData.h"
+#include <atomic>
+
+// Serialized job handler.  Runs in the worker process.
+// Return false and set ErrorMessage on failure.
+typedef TFunction<bool(const TArray<uint8>& Request, TArray<uint8>& Response, FString& ErrorMessage)> FSpiceJobHandler;
+
+struct FSpiceJobResult
+{
+    bool bSuccess = false;
+    FString ErrorMessage;
+    TArray<uint8> Response;
+};
+
+class SPICE_API FSpiceProcessPool
+{
+public:
+    // Created on the game thread, then usable from any
+    static FSpiceProcessPool& Get();
+    static void Shutdown();
+
+    // Any thread, even before the pool exists.  Null unless it's started.
+    static FSpiceProcessPool* GetStarted();
+
+    // Register a job by name.  Must happen in both the parent and the worker,
+    // so register from static initialization (FSpiceJobRegistration).
+    static void RegisterJob(FName JobName, FSpiceJobHandler Handler);
+    static const FSpiceJobHandler* FindJob(FName JobName);
+
+    // Launch the worker processes.  NumWorkers <= 0 means "one per core,
+    // minus one for the parent".  MailboxSize bounds the size of a single
+    // request or response.
+    bool Start(int32 NumWorkers = 0, uint32 MailboxSize = 16 * 1024 * 1024);
+
+    // Waits for every dispatched job (running, or waiting for a worker) to
+    // finish.  Jobs still waiting for a worker fail.
+    void Stop();
+
+    // A job running longer than this has hung:  its worker is killed and
+    // relaunched, and the job fails.  0 (the default) means no limit, but a
+    // worker that exits is always caught.
+    void SetJobTimeout(double Seconds) { JobTimeout = FMath::Max(Seconds, 0.); }
+
+    bool IsStarted() const { return Workers.Num() > 0; }
+    int32 NumWorkers() const { return Workers.Num(); }
+
+    // Run a job on the next free worker.
+    // Blocks a (dedicated) background thread until a worker is available and
+    // the job is complete, then fulfills the future.
+    TFuture<FSpiceJobResult> Dispatch(FName JobName, TArray<uint8>&& Request);
+
+    // Run a job on a worker loaded with KernelHistory instead of this
+    // process's kernels (MaxQ::Core::FSpiceContext).  KernelSource
+    // identifies the set (0 is the process's own), and KernelGeneration
+    // must move whenever the set does, so workers resync.
+    TFuture<FSpiceJobResult> Dispatch(FName JobName, TArray<uint8>&& Request, uint64 KernelSource, TArray<MaxQ::Data::FKernelHistoryEntry>&& KernelHistory, uint64 KernelGeneration);
+
+    ~FSpiceProcessPool();
+
+private:
+    struct FWorker
+    {
+        FString BaseName;
+        FProcHandle Process;
+        FPlatformMemory::FSharedMemoryRegion* Mailbox = nullptr;
+        FPlatformProcess::FSemaphore* RequestReady = nullptr;
+        FPlatformProcess::FSemaphore* ResponseReady = nullptr;
+        uint64 KernelSource = 0;
+        uint64 KernelGeneration = MAX_uint64;
+        // Couldn't be relaunched.  Never handed out again.
+        bool bRetired = false;
+    };
+
+    // What a worker needs loaded
+    struct FKernelSet
+    {
+        uint64 Source = 0;
+        uint64 Generation = 0;
+        TArray<MaxQ::Data::FKernelHistoryEntry> History;
+    };
+
+    FSpiceProcessPool() = default;
+
+    // Kernels:  null for this process's own
+    FSpiceJobResult Run(FWorker& Worker, FName JobName, const TArray<uint8>& Request, const FKernelSet* Kernels = nullptr);
+    // On the dispatch thread:  acquire, run, release
+    FSpiceJobResult RunDispatched(FName JobName, const TArray<uint8>& Request, const FKernelSet* Kernels);
+    // INDEX_NONE once the pool is stopping, or has no live workers
+    int32 AcquireWorker();
+    void ReleaseWorker(int32 WorkerIndex);
+    bool LaunchWorker(FWorker& Worker);
+    // After the worker died or was killed
+    void RestartWorker(FWorker& Worker);
+    void DestroyWorker(FWorker& Worker);
+
+    TArray<TUniquePtr<FWorker>> Workers;
+    TArray<int32> FreeWorkers;
+    FCriticalSection FreeWorkersLock;
+    FEvent* WorkerFreed = nullptr;
+    uint32 MailboxSize = 0;
+    double JobTimeout = 0.;
+    // Start and Stop are game thread only.  GetStarted reads this instead.
+    std::atomic<bool> bStarted { false };
+    // Dispatched jobs that haven't finished, counted before bStarted is
+    // checked, so Stop can't miss one
+    std::atomic<int32> NumInFlight { 0 };
+    std::atomic<int32> NumLive { 0 };
+
+    static TMap<FName, FSpiceJobHandler>& Jobs();
+    static std::atomic<FSpiceProcessPool*> Instance;
+};
+
+// Usage (file scope, in a .cpp):
+//     static FSpiceJobRegistration GfocltJob(TEXT("gfoclt"), [](...){ ... });
+struct FSpiceJobRegistration
+{
+    FSpiceJobRegistration(FName JobName, FSpiceJobHandler Handler)
+    {
+        FSpiceProcessPool::RegisterJob(JobName, MoveTemp(Handler));
+    }
+};
+
+namespace MaxQ::Private
+{
+    // Shared memory mailbox layout.  Header, followed by the payload.
+    struct FSpiceMailboxHeader
+    {
+        static constexpr uint32 MagicValue = 0x4D617851; // 'MaxQ'
+
+        enum ECommand : uint32
+        {
+            RunJob = 1,
+            Quit = 2
+        };
+
+        uint32 Magic;
+        uint32 Command;
+        uint32 PayloadSize;
+        uint32 bSuccess;
+    };
+
+    // Names of the shared memory region & semaphores for a worker
+    FString MailboxName(const FString& BaseName, const TCHAR* Suffix);
+}
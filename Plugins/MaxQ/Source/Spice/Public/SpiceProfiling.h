@@ -0,0 +1,139 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceProfiling.h
+//
+// API Comments
+//
+// Purpose:  Live counters for SPICE work, and the console commands that
+// show them.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceProfiling.h is part of the "refined C++ API".
+//
+// "stat MaxQ" (SpiceSegmentStats.h) shows this frame's calls and time.  The
+// same events are also counted here, as running totals, so a build without
+// the stats system (or a console without the overlay) can still be asked:
+// * MaxQ.Stats [reset]:  calls and time per family (SPK lookups, frame/CK
+//   lookups, GF searches, kernel loads, SGP4), per frame since the last reset
+// * MaxQ.Cache:  hit rates of the query memo, Chebyshev caches, compiled
+//   frame chains, and the snapshots read from the kernel pool (PCK
+//   orientation, time system, name registry)
+// * MaxQ.Kernels:  what's loaded, by type, the segment tables' load
+//   (GetSegmentBufferReport), and file unit reopens (GetFileUnitUsage)
+// * MaxQ.KernelLoads [reset]:  the kernel load timeline's report
+//   (GetKernelLoadReport)
+//
+// The kernel load timeline is every furnsh and unload, with the kernel's
+// type and size, split into phases:  opening the file, validating it (Furnsh
+// of a list checks every kernel's header, or a text kernel's syntax, in
+// parallel first), and CSPICE's load (a text kernel parsed into the pool, a
+// binary kernel registered in its tables).  The same phases are scopes on
+// the "MaxQ" Insights channel, named with the kernel's type and size.
+// -MaxQKernelReport on the command line logs the report once the engine's
+// done starting up, to find the files worth repacking or snapshotting.
+//
+// CSPICE's own segment buffer hits and misses are local to the toolkit and
+// can't be counted;  MaxQ.Kernels says whether the tables can thrash.
+//
+// Counting is compiled out of shipping builds (MAXQ_COUNTERS_ENABLED).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+#define MAXQ_COUNTERS_ENABLED (!UE_BUILD_SHIPPING)
+
+namespace MaxQ::Data
+{
+    enum class ESpiceCounter : uint8
+    {
+        SpkLookups,
+        FrameLookups,
+        GfSearches,
+        KernelLoads,
+        Sgp4Evaluations,
+        Failures,
+        MemoHits,
+        MemoMisses,
+        ChebyshevHits,
+        ChebyshevMisses,
+        FrameChainHits,
+        FrameChainRecompiles,
+        DynamicFrameHits,
+        DynamicFrameMisses,
+        PoolCacheHits,
+        PoolCacheRebuilds,
+        Count
+    };
+
+    enum class ESpiceTimer : uint8
+    {
+        SpkLookup,
+        FrameLookup,
+        GfSearch,
+        KernelLoad,
+        Sgp4,
+        Count
+    };
+
+    struct SPICE_API FSpiceCounters
+    {
+        uint64 Counts[(int32)ESpiceCounter::Count] = {};
+        double Seconds[(int32)ESpiceTimer::Count] = {};
+        // Engine frames since the counters were reset
+        uint64 Frames = 0;
+
+        uint64 operator[](ESpiceCounter Counter) const { return Counts[(int32)Counter]; }
+        double operator[](ESpiceTimer Timer) const { return Seconds[(int32)Timer]; }
+
+        // Hits / (Hits + Misses), or 0 if neither
+        static double Rate(uint64 Hits, uint64 Misses) { return Hits + Misses > 0 ? (double)Hits / (double)(Hits + Misses) : 0.; }
+    };
+
+    // Totals since the last reset (all zero if MAXQ_COUNTERS_ENABLED is off)
+    SPICE_API FSpiceCounters GetSpiceCounters();
+    SPICE_API void ResetSpiceCounters();
+
+    // One furnsh or unload.  Times are seconds.
+    struct SPICE_API FKernelLoadRecord
+    {
+        FString Path;
+        // From the file's ID word ("DAF/SPK", "KPL/MK"...).  NONE if the
+        // file couldn't be read.
+        ES_KernelType Type = ES_KernelType::NONE;
+        int64 Size = 0;
+        bool bUnload = false;
+        bool bSuccess = true;
+        // FPlatformTime::Seconds when CSPICE's load started
+        double Start = 0.;
+
+        // Opening the file and reading its first record, and validating it
+        // (Furnsh of a list only)
+        double Open = 0.;
+        double Validate = 0.;
+        // furnsh_c/unload_c.  A meta-kernel's includes the kernels it loads.
+        double Load = 0.;
+
+        double Total() const { return Open + Validate + Load; }
+    };
+
+    // Every furnsh and unload since the last reset, in order (empty if
+    // MAXQ_COUNTERS_ENABLED is off)
+    SPICE_API TArray<FKernelLoadRecord> GetKernelLoadTimeline();
+    SPICE_API void ResetKernelLoadTimeline();
+
+    // Totals by phase and kernel type, then the Slowest files
+    SPICE_API FString GetKernelLoadReport(int32 Slowest = 20);
+}
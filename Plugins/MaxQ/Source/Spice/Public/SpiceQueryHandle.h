@@ -0,0 +1,135 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceQueryHandle.h
+//
+// API Comments
+//
+// Purpose:  Precompiled (targ, obs, ref, abcorr) ephemeris queries.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceQueryHandle.h is part of the "refined C++ API".
+//
+// spkezr/spkpos take names, so every call pays for TCHAR->ANSI conversions
+// and a bods2c lookup for the target and the observer.  A query handle does
+// that once, and then goes straight to the integer entry points (spkez/spkezp,
+// or spkgeo/spkgps when there's no aberration correction).
+//
+// CSPICE has no SPK reader that takes a frame ID, so the frame is passed as
+// its (pre-converted) name.  Frame names are validated up front.
+//
+// Name->ID mappings can come from kernels (NAIF_BODY_NAME, etc).  If kernels
+// have been loaded or unloaded since the handle was compiled, it re-resolves
+// its names before the next query.
+//
+// Converged Newtonian corrections (CN, CN+S) iterate the light time, and
+// spkez starts every call from the geometric light time:  one segment lookup
+// for that, and usually two or three more to converge.  A frame later the
+// answer has barely moved, so in an inertial frame a handle iterates it
+// itself, starting from its last light time carried forward at its rate.
+// That normally converges in a single lookup.  The iteration and the
+// convergence test are spkltc's, and a guess that doesn't converge (a jump
+// in time, say) starts over cold, so the results are spkez's to within its
+// own tolerance.  CN+S states (stellar aberration of the velocity needs the
+// observer's acceleration) and non-inertial frames still go to spkez.
+//
+// Handles are immutable aside from that refresh and the last light time,
+// and CSPICE is not re-entrant, so a handle should only be used from the
+// thread that makes SPICE calls (e.g. FSpiceExecutor).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+class SPICE_API FSpiceQueryHandle
+{
+public:
+    FSpiceQueryHandle() = default;
+
+    // Resolve the names.  On failure the returned handle is !IsValid().
+    static FSpiceQueryHandle Compile(
+        const FString& targ,
+        const FString& obs,
+        const FString& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    bool IsValid() const { return bValid; }
+
+    int32 GetTargetId() const { return TargetId; }
+    int32 GetObserverId() const { return ObserverId; }
+    int32 GetFrameId() const { return FrameId; }
+    const FString& GetTarget() const { return Target; }
+    const FString& GetObserver() const { return Observer; }
+    const FString& GetFrame() const { return Frame; }
+    ES_AberrationCorrectionWithNewtonians GetAberrationCorrection() const { return AberrationCorrection; }
+
+    // Equivalent to spkezr(targ, et, ref, abcorr, obs)
+    void Spkezr(
+        const FSEphemerisTime& et,
+        FSStateVector& state,
+        FSEphemerisPeriod& lt,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    ) const;
+
+    // Equivalent to spkpos(targ, et, ref, abcorr, obs)
+    void Spkpos(
+        const FSEphemerisTime& et,
+        FSDistanceVector& ptarg,
+        FSEphemerisPeriod& lt,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    ) const;
+
+    // Raw versions, for inner loops.  No error check per call; the caller
+    // checks once afterwards (USpice::get_implied_result, etc).
+    void Spkezr(double et, double (&state)[6], double& lt) const;
+    void Spkpos(double et, double (&ptarg)[3], double& lt) const;
+
+private:
+    bool Resolve() const;
+    bool RefreshIfStale() const;
+
+    // CN light time corrected state, natively.  False if it couldn't be
+    // computed here (the caller falls back to spkez).
+    bool ConvergedLightTime(double et, double (&state)[6], double& lt, double (&vobs)[3]) const;
+
+    FString Target;
+    FString Observer;
+    FString Frame;
+    ES_AberrationCorrectionWithNewtonians AberrationCorrection = ES_AberrationCorrectionWithNewtonians::None;
+
+    // Null terminated, converted once
+    TArray<ANSICHAR> FrameANSI;
+
+    mutable int32 TargetId = 0;
+    mutable int32 ObserverId = 0;
+    mutable int32 FrameId = 0;
+    mutable uint64 KernelGeneration = 0;
+    mutable bool bValid = false;
+    mutable bool bInertialFrame = false;
+
+    // The last converged light time, and its rate:  the next guess
+    struct FLightTimeGuess
+    {
+        double Et = 0.;
+        double Lt = 0.;
+        double Dlt = 0.;
+        bool bValid = false;
+    };
+    mutable FLightTimeGuess LastLightTime;
+};
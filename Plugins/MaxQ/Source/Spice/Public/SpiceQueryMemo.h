@@ -0,0 +1,63 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceQueryMemo.h
+//
+// API Comments
+//
+// Purpose:  Per-frame memoization of frame transforms and body states.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceQueryMemo.h is part of the "refined C++ API".
+//
+// Within a frame, loosely coupled code (an actor, its HUD, its orbit line)
+// asks for the same pxform/spkezr at the same ET independently.  With the
+// memo enabled, USpice::pxform, sxform, spkezr and spkpos remember their
+// successful results, keyed by (query, names, aberration correction, ET),
+// and answer repeats without calling CSPICE.  Failed calls aren't
+// remembered.
+//
+// Everything is forgotten when a new engine frame starts
+// (MaxQ::Time::GetEtClock's frame number moves), when the kernel pool
+// changes (MaxQ::Data::GetPoolGeneration), and when the memo fills up.
+// Without engine frames (commandlets, tests) only the last two apply;  call
+// ClearQueryMemo between steps.
+//
+// Off by default.  Names are compared as SPICE compares them (FSpiceName), so
+// "earth" and "EARTH" share an entry, but "EARTH" and "399" don't.  Like the
+// calls it memoizes, only use it from the thread that makes SPICE calls.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Data
+{
+    struct FQueryMemoStats
+    {
+        // Since the memo was enabled
+        uint64 Hits = 0;
+        uint64 Misses = 0;
+        // Right now
+        int32 Entries = 0;
+    };
+
+    SPICE_API void SetQueryMemoEnabled(bool bEnable);
+    SPICE_API bool IsQueryMemoEnabled();
+
+    // Forget everything remembered so far
+    SPICE_API void ClearQueryMemo();
+
+    SPICE_API FQueryMemoStats GetQueryMemoStats();
+}
@@ -0,0 +1,239 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceRemote.h
+//
+// API Comments
+//
+// Purpose:  SPICE queries answered by another machine, for clients that
+// can't carry kernels.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceRemote.h is part of the "refined C++ API".
+//
+// A standalone headset can't ship gigabytes of kernels, or afford CSPICE's
+// working set.  FRemoteEphemerisServer runs where the kernels are (a
+// dedicated server, a workstation, or headless with the SpiceRemoteServer
+// commandlet) and answers over TCP.  FRemoteEphemerisClient asks, and every
+// answer comes back as a TFuture.
+//
+// Ephemerides come back as fits, not states:  the server fits the target
+// over a window (FMaxQEphemerisWindow, exactly as replication does:
+// quantized Chebyshev blocks, mostly a byte or two per coefficient).  The
+// client keeps the windows and evaluates them natively, so State() answers
+// every frame with no round trip, and the next window is fetched ahead of
+// time (Prefetch) or on a miss (StateAsync).
+//
+// Frames come back as matrices, a batch of epochs at a time.  Anything
+// registered as an FSpiceProcessPool job (the geometry finder's, say) runs
+// on the server by name with RunJob, with the same request and response
+// bytes the process pool uses.
+//
+// The server is one thread, and serves its connections a request at a time,
+// each inside an FSpiceScope.  The client sends one request at a time, from
+// its own thread, in the order they were made.
+//
+// Frames (little endian), both ways:
+//    uint32 Magic ('MXQR') | uint16 Version (1) | uint16 Kind |
+//    uint32 Size | Size bytes of payload
+// Responses have the request's Kind, and start with a bool (success) and,
+// on failure, the error message (FString, as FArchive writes it).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceEphemerisReplication.h"
+#include "SpiceProcessPool.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "HAL/Thread.h"
+#include <atomic>
+
+class FSocket;
+class FEvent;
+
+namespace MaxQ::Ephemeris
+{
+    struct FRemoteStateResult
+    {
+        bool bSuccess = false;
+        FString ErrorMessage;
+        // km, km/s
+        FSStateVector State;
+    };
+
+    struct FRemoteFrameResult
+    {
+        bool bSuccess = false;
+        FString ErrorMessage;
+        // One per epoch requested
+        TArray<FSRotationMatrix> Matrices;
+    };
+
+
+    class SPICE_API FRemoteEphemerisServer
+    {
+    public:
+        FRemoteEphemerisServer();
+        ~FRemoteEphemerisServer();
+
+        // Listens on Port (all interfaces), until Stop
+        bool Start(
+            int32 Port,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+        void Stop();
+
+        bool IsRunning() const { return Thread.IsValid(); }
+        int32 NumConnections() const { return Connections.load(std::memory_order_relaxed); }
+        uint64 NumRequests() const { return Requests.load(std::memory_order_relaxed); }
+        uint64 NumMalformed() const { return Malformed.load(std::memory_order_relaxed); }
+
+        FRemoteEphemerisServer(const FRemoteEphemerisServer&) = delete;
+        FRemoteEphemerisServer& operator=(const FRemoteEphemerisServer&) = delete;
+
+    private:
+        void Run();
+
+        FSocket* Listener = nullptr;
+        TUniquePtr<FThread> Thread;
+        std::atomic<bool> bStopping { false };
+        std::atomic<int32> Connections { 0 };
+        std::atomic<uint64> Requests { 0 };
+        std::atomic<uint64> Malformed { 0 };
+    };
+
+
+    struct FRemoteEphemerisSettings
+    {
+        // Each fit the client asks for covers this much ephemeris time...
+        double WindowSeconds = 86400.;
+        // ...to within this...
+        double ToleranceKm = 1.e-3;
+        // ...with blocks of this degree
+        int32 Degree = 12;
+        // Windows kept per target/observer/frame/correction (oldest dropped)
+        int32 MaxWindows = 4;
+    };
+
+
+    class SPICE_API FRemoteEphemerisClient
+    {
+    public:
+        explicit FRemoteEphemerisClient(const FRemoteEphemerisSettings& Settings = FRemoteEphemerisSettings());
+        ~FRemoteEphemerisClient();
+
+        // Host is a name or an address
+        bool Connect(
+            const FString& Host,
+            int32 Port,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+        // Requests still queued fail
+        void Disconnect();
+
+        // False once the connection is lost
+        bool IsConnected() const { return bConnected.load(std::memory_order_acquire); }
+
+        // Any thread, no round trip.  False unless a window covering et has
+        // arrived.
+        bool State(
+            const FSEphemerisTime& et,
+            const FString& targ,
+            const FString& obs,
+            const FString& ref,
+            ES_AberrationCorrectionWithNewtonians abcorr,
+            FSStateVector& state
+        ) const;
+
+        bool Position(
+            const FSEphemerisTime& et,
+            const FString& targ,
+            const FString& obs,
+            const FString& ref,
+            ES_AberrationCorrectionWithNewtonians abcorr,
+            FSDistanceVector& r
+        ) const;
+
+        // Fetches a window starting at et (unless one already covers
+        // [et, et + WindowSeconds]).  ErrorMessage is set if it failed.
+        TFuture<FSpiceJobResult> Prefetch(
+            const FSEphemerisTime& et,
+            const FString& targ,
+            const FString& obs,
+            const FString& ref,
+            ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+        );
+
+        // From the windows kept if it can be, otherwise after fetching one
+        // around et
+        TFuture<FRemoteStateResult> StateAsync(
+            const FSEphemerisTime& et,
+            const FString& targ,
+            const FString& obs,
+            const FString& ref,
+            ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None
+        );
+
+        // pxform, for each of ets
+        TFuture<FRemoteFrameResult> Pxform(
+            const FString& from,
+            const FString& to,
+            const TArray<FSEphemerisTime>& ets
+        );
+
+        // An FSpiceProcessPool job, run by the server
+        TFuture<FSpiceJobResult> RunJob(FName JobName, TArray<uint8>&& Request);
+
+        // Drops every window kept
+        void Flush();
+        int32 NumWindows() const;
+
+        FRemoteEphemerisClient(const FRemoteEphemerisClient&) = delete;
+        FRemoteEphemerisClient& operator=(const FRemoteEphemerisClient&) = delete;
+
+    private:
+        typedef TUniqueFunction<void(bool bSuccess, const FString& ErrorMessage, TArray<uint8>& Response)> FOnResponse;
+
+        struct FPending
+        {
+            uint16 Kind = 0;
+            TArray<uint8> Request;
+            FOnResponse OnResponse;
+        };
+
+        static FString Key(const FString& targ, const FString& obs, const FString& ref, ES_AberrationCorrectionWithNewtonians abcorr);
+        bool Evaluate(const FString& WindowKey, double et, double (&r)[3], double (&v)[3]) const;
+        void AddWindow(const FString& WindowKey, FMaxQEphemerisWindow&& Window);
+
+        TFuture<FSpiceJobResult> Fetch(double Start, const FString& targ, const FString& obs, const FString& ref, ES_AberrationCorrectionWithNewtonians abcorr);
+        void Send(uint16 Kind, TArray<uint8>&& Request, FOnResponse&& OnResponse);
+        void Run();
+        void FailQueued(const FString& ErrorMessage);
+
+        FRemoteEphemerisSettings Settings;
+
+        mutable FRWLock WindowsLock;
+        TMap<FString, TArray<FMaxQEphemerisWindow>> Windows;
+
+        FSocket* Socket = nullptr;
+        TUniquePtr<FThread> Thread;
+        TQueue<TUniquePtr<FPending>, EQueueMode::Mpsc> Queue;
+        FEvent* Wake = nullptr;
+        std::atomic<bool> bStopping { false };
+        std::atomic<bool> bConnected { false };
+    };
+}
@@ -0,0 +1,92 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceResult.h
+//
+// API Comments
+//
+// Purpose:  Error results for native callers, without FString traffic.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceResult.h is part of the "refined C++ API".
+//
+// The ES_ResultCode/FString ErrorMessage convention suits Blueprints, but a
+// C++ loop pays for it on every call:  the message is emptied on success, and
+// on failure the long message is fetched, converted, logged, and the script
+// callstack printed.
+//
+// The Try* functions (MaxQ::Ephemeris::TrySpkezr, MaxQ::Math::TryPxform, ...)
+// return a TSpiceResult instead.  On success nothing is touched but the
+// value.  On failure the FSpiceError keeps SPICE's short message inline
+// ("SPICE(SPKINSUFFDATA)"), and the long message stays in a per-thread
+// buffer until GetMessage asks for it.  Nothing is logged;  the caller
+// decides what a failure is worth.  FSpiceErrorBatch isn't involved.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "Templates/ValueOrError.h"
+
+namespace MaxQ::Core
+{
+    class FSpiceError;
+
+    // If CSPICE is in the failed state, captures the error into Error, resets
+    // CSPICE, and returns true.
+    SPICE_API bool TakeError(FSpiceError& Error);
+
+    class SPICE_API FSpiceError
+    {
+    public:
+        // "SPICE(SPKINSUFFDATA)", etc
+        const ANSICHAR* GetShortMessage() const { return ShortMessage; }
+
+        // SPICE's long message.  It's kept, for the thread the error happened
+        // on, until that thread's next error.  After that (or on another
+        // thread) this returns the short message.
+        FString GetMessage() const;
+
+    private:
+        friend bool TakeError(FSpiceError& Error);
+
+        // Short messages are at most 25 characters
+        ANSICHAR ShortMessage[26] = { 0 };
+        uint32 Sequence = 0;
+    };
+
+    template<class ValueType>
+    using TSpiceResult = TValueOrError<ValueType, FSpiceError>;
+
+    // Whatever a call left in CSPICE's error state, as a result
+    FORCEINLINE TSpiceResult<void> TakeResult()
+    {
+        FSpiceError Error;
+        if (UNLIKELY(TakeError(Error)))
+        {
+            return MakeError(MoveTemp(Error));
+        }
+        return MakeValue();
+    }
+
+    template<class ValueType>
+    FORCEINLINE TSpiceResult<std::decay_t<ValueType>> TakeResult(ValueType&& Value)
+    {
+        FSpiceError Error;
+        if (UNLIKELY(TakeError(Error)))
+        {
+            return MakeError(MoveTemp(Error));
+        }
+        return MakeValue(Forward<ValueType>(Value));
+    }
+}
@@ -0,0 +1,164 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSGP4.h
+//
+// API Comments
+//
+// Purpose:  SGP4 propagation of two-line elements, one model per satellite.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSGP4.h is part of the "refined C++ API".
+//
+// evsgp4_c re-runs the whole SGP4 initialization on every call, and CSPICE
+// keeps the initialized model in static variables, so there's only ever one.
+// FSGP4Propagator initializes once per element set and keeps its own model.
+// Propagating is then just the SGP4 evaluation.
+//
+// The model is a C++ port of CSPICE's SGP4 (zzsgp4 & friends, which are in
+// turn Vallado's 2006 revision), in AFSPC compatibility mode, same as evsgp4.
+// Results match evsgp4.
+//
+// Initializing needs CSPICE (the TLE epoch is converted to UTC with the
+// loaded leapseconds kernel).  Propagating does not touch CSPICE at all:
+// the raw Propagate is safe to call from any thread, and a propagator can be
+// shared read-only between threads.
+//
+// PropagateCatalog propagates a whole catalog with ParallelFor, writing the
+// results into flat per-component arrays.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Orbits
+{
+    enum class ESGP4Status : uint8
+    {
+        Ok,
+        NotInitialized,
+        BadMeanMotion,
+        BadMeanEccentricity,
+        BadMeanSemiMajor,
+        BadPerturbedEccentricity,
+        BadSemiLatus,
+        Decayed
+    };
+
+    // The SGP4 model for one element set.
+    // Plain data, so catalogs can keep these in flat arrays.
+    struct FSGP4Model
+    {
+        // TLE epoch (TDB seconds past J2000)
+        double Epoch;
+
+        // Geophysical constants (Earth radii, etc)
+        double j2, j3oj2, xke, er;
+
+        // Mean elements at epoch (mean motion is un-Kozai'd, rad/min)
+        double bstar, inclo, nodeo, ecco, argpo, mo, no;
+
+        // Near earth
+        double aycof, con41, cc1, cc4, cc5, d2, d3, d4, delmo, eta, argpdot;
+        double omgcof, sinmao, t2cof, t3cof, t4cof, t5cof, x1mth2, x7thm1;
+        double mdot, nodedot, xlcof, xmcof, xnodcf;
+
+        // Deep space
+        double e3, ee2, peo, pgho, pho, pinco, plo, se2, se3, sgh2, sgh3, sgh4;
+        double sh2, sh3, si2, si3, sl2, sl3, sl4, gsto, xfact, xgh2, xgh3, xgh4;
+        double xh2, xh3, xi2, xi3, xl2, xl3, xl4, xlamo, zmol, zmos;
+        double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421, d5433;
+        double dedt, del1, del2, del3, didt, dmdt, dnodt, domdt;
+
+        int32 irez;
+        bool dosimp;
+        bool dodeep;
+    };
+
+    class SPICE_API FSGP4Propagator
+    {
+    public:
+        FSGP4Propagator() = default;
+
+        // Initialize from geophysical constants & elements (as evsgp4).
+        // Requires a leapseconds kernel.
+        FSGP4Propagator(
+            const FSTLEGeophysicalConstants& geophs,
+            const FSTwoLineElements& elems,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        bool Init(
+            const FSTLEGeophysicalConstants& geophs,
+            const FSTwoLineElements& elems,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // A model initialized elsewhere (by another process, say).  Native.
+        explicit FSGP4Propagator(const FSGP4Model& _Model) : Model(_Model), bValid(true) {}
+
+        bool IsValid() const { return bValid; }
+        const FSGP4Model& GetModel() const { return Model; }
+        FSEphemerisTime GetEpoch() const { return FSEphemerisTime(Model.Epoch); }
+
+        // Native:  thread-safe, never touches CSPICE.
+        // state is in the TEME frame, km & km/s.
+        ESGP4Status Propagate(double et, double (&state)[6]) const;
+
+        // As evsgp4.  SGP4 failures are signalled as SPICE errors, with the
+        // same short messages as evsgp4 (SPICE(BADMECCENTRICITY), etc).
+        void Propagate(
+            const FSEphemerisTime& et,
+            FSStateVector& state,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        ) const;
+
+        // Evaluate a model directly (minutes past the model's epoch)
+        static ESGP4Status Evaluate(const FSGP4Model& Model, double tsince, double (&state)[6]);
+
+    private:
+        FSGP4Model Model = {};
+        bool bValid = false;
+    };
+
+    // Catalog propagation output, structure-of-arrays:  entry i of each array
+    // belongs to catalog object i.  (km & km/s, TEME)
+    struct FSGP4CatalogStates
+    {
+        TArray<double> X, Y, Z;
+
+        // Empty unless velocities were requested
+        TArray<double> VX, VY, VZ;
+
+        TArray<ESGP4Status> Status;
+
+        int32 Num() const { return Status.Num(); }
+        bool HasVelocities() const { return VX.Num() == Status.Num(); }
+
+        FSDistanceVector Position(int32 i) const { return FSDistanceVector(X[i], Y[i], Z[i]); }
+    };
+
+    // Propagate every object in the catalog to et, across all cores.
+    // Thread-safe (no CSPICE calls).  Objects that fail (or were never
+    // initialized) get a non-Ok Status.  Returns the number that succeeded.
+    SPICE_API int32 PropagateCatalog(
+        TArrayView<const FSGP4Propagator> Catalog,
+        const FSEphemerisTime& et,
+        FSGP4CatalogStates& OutStates,
+        bool bVelocities = false
+    );
+}
@@ -0,0 +1,106 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSGP4Batch.h
+//
+// API Comments
+//
+// Purpose:  SGP4 propagation of whole catalogs, several satellites per lane.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSGP4Batch.h is part of the "refined C++ API".
+//
+// FSGP4BatchPropagator copies the near earth SGP4 models of a catalog into
+// structure-of-arrays columns, padded to a multiple of the lane width.  The
+// SGP4 evaluation then runs on MAXQ_SGP4_LANES satellites at a time, as
+// straight-line loops over the lanes that the compiler turns into AVX2
+// (4 doubles) or SSE2/NEON (2 doubles) code.  The lane width is picked at
+// compile time from the target's instruction set.
+//
+// Deep space models (periods >= 225 minutes) have the resonance integrator,
+// which doesn't batch, so they're evaluated one at a time with the scalar
+// FSGP4Propagator::Evaluate.  They're a small part of the public catalog.
+//
+// The batched math is the same sequence of operations as the scalar version,
+// so results agree with FSGP4Propagator (and therefore evsgp4_c) to within
+// 1e-6 km and 1e-9 km/s.  Any difference is from the compiler's choice of
+// fused multiply-adds.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+
+#ifndef MAXQ_SGP4_LANES
+#if defined(__AVX2__) || (defined(PLATFORM_ALWAYS_HAS_AVX_2) && PLATFORM_ALWAYS_HAS_AVX_2)
+#define MAXQ_SGP4_LANES 4
+#else
+// SSE2, NEON:  128 bit registers
+#define MAXQ_SGP4_LANES 2
+#endif
+#endif
+
+namespace MaxQ::Orbits
+{
+    class SPICE_API FSGP4BatchPropagator
+    {
+    public:
+        static constexpr int32 Lanes = MAXQ_SGP4_LANES;
+
+        // Replaces anything already built.  Entry i of the catalog is entry i
+        // of the propagation outputs.
+        void Build(TArrayView<const FSGP4Propagator> Catalog);
+        void Build(TArrayView<const FSGP4Model> Models);
+        void Reset();
+
+        int32 Num() const { return NumObjects; }
+        int32 NumBatched() const { return Index.Num() - NumPadding; }
+        SIZE_T GetAllocatedSize() const;
+
+        // Across all cores, with ParallelFor.  Thread-safe (no CSPICE).
+        // Returns the number of objects propagated without error.
+        int32 Propagate(const FSEphemerisTime& et, FSGP4CatalogStates& OutStates, bool bVelocities = false) const;
+
+    private:
+        // The columns of the near earth model that the evaluation reads
+        enum EColumn : int32
+        {
+            Epoch, mo, mdot, argpo, argpdot, nodeo, nodedot, xnodcf, cc1, cc4, cc5,
+            bstar, t2cof, t3cof, t4cof, t5cof, omgcof, eta, xmcof, delmo, sinmao,
+            d2, d3, d4, no, ecco, inclo, sinio, cosio, aycof, xlcof, con41, x1mth2,
+            x7thm1, j2, xke, er, simp, NumColumns
+        };
+
+        double* Column(EColumn c) { return &Columns[c * Rows]; }
+        const double* Column(EColumn c) const { return &Columns[c * Rows]; }
+
+        void Build(TArrayView<const FSGP4Model> Models, TArrayView<const bool> Valid);
+        void AddRow(const FSGP4Model& m, int32 Row);
+
+        // NumColumns x Rows, column-major.  Rows is a multiple of Lanes.
+        TArray<double> Columns;
+        int32 Rows = 0;
+
+        // Catalog index of each row (INDEX_NONE for padding)
+        TArray<int32> Index;
+        int32 NumPadding = 0;
+
+        // Deep space and invalid models, evaluated one at a time
+        TArray<FSGP4Model> ScalarModels;
+        TArray<int32> ScalarIndex;
+        TArray<bool> ScalarValid;
+
+        int32 NumObjects = 0;
+    };
+}
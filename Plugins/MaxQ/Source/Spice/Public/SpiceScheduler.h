@@ -0,0 +1,159 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceScheduler.h
+//
+// API Comments
+//
+// Purpose:  Prioritized MaxQ jobs, with per-class core budgets.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceScheduler.h is part of the "refined C++ API".
+//
+// Batches, geometry finder searches, bakes and prefetches all want cores,
+// and a per-frame query mustn't wait behind a ten minute occultation search.
+// FSpiceScheduler queues jobs by class:
+//
+// * FrameCritical:  needed this frame.
+// * Interactive:  needed soon (a UI query, a plot).
+// * Background:  searches, bakes, prefetches.
+//
+// Each class has a budget, the most of its jobs running at once, so
+// background work can't take every core.  Jobs run as UE tasks at their
+// class's task priority, so the task scheduler's work stealing spreads
+// them, and the higher classes' tasks go first on each worker.
+//
+// Jobs may also need a resource there's less of than cores:
+//
+// * Spice:  in-process CSPICE, one job at a time, inside an FSpiceScope
+//   (SpiceLock.h).
+// * ProcessPool:  a worker process (SpiceProcessPool.h), as many at once as
+//   there are workers.
+//
+// When a resource frees up, the highest class waiting for it gets it.  A
+// running job isn't preempted, so long CSPICE work belongs in the process
+// pool (Dispatch), which leaves in-process CSPICE free for the frame.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Async.h"
+#include "Async/Future.h"
+#include "SpiceProcessPool.h"
+
+enum class ESpiceJobClass : uint8
+{
+    FrameCritical,
+    Interactive,
+    Background,
+    Num
+};
+
+enum class ESpiceJobResource : uint8
+{
+    // Native only:  limited by the class budget alone
+    None,
+    Spice,
+    ProcessPool,
+    Num
+};
+
+
+class SPICE_API FSpiceScheduler
+{
+public:
+    // Called back when a started job is done (from any thread)
+    typedef TUniqueFunction<void()> FFinished;
+    // Starts a job, which calls Finished when it's done
+    typedef TUniqueFunction<void(FFinished&& Finished)> FStart;
+
+    static FSpiceScheduler& Get();
+
+    // Waits for every job, queued and running, then deletes the scheduler.
+    // Called by the Spice module at shutdown.
+    static void Shutdown();
+
+    // The most jobs of a class running at once (at least 1).  Defaults:
+    // every worker thread for FrameCritical and Interactive, half of them
+    // for Background.
+    void SetBudget(ESpiceJobClass Class, int32 Budget);
+    int32 GetBudget(ESpiceJobClass Class) const;
+
+    int32 NumQueued(ESpiceJobClass Class) const;
+    int32 NumRunning(ESpiceJobClass Class) const;
+
+    // Runs Job on a UE task when its class and resource allow.  The future
+    // is fulfilled with Job's return value.
+    template<typename JobType>
+    auto Launch(ESpiceJobClass Class, JobType&& Job, ESpiceJobResource Resource = ESpiceJobResource::None) -> TFuture<decltype(Job())>
+    {
+        typedef decltype(Job()) ResultType;
+
+        TSharedRef<TPromise<ResultType>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<ResultType>, ESPMode::ThreadSafe>();
+        TFuture<ResultType> Future = Promise->GetFuture();
+
+        Enqueue(Class, Resource,
+            [Promise, Job = Forward<JobType>(Job)]() mutable
+            {
+                SetPromiseValue(*Promise, Job);
+            }
+        );
+
+        return Future;
+    }
+
+    // A process pool job, on the next worker the class may have.  If the
+    // pool isn't started, the job's handler runs in-process instead, as a
+    // Spice job.
+    TFuture<FSpiceJobResult> Dispatch(ESpiceJobClass Class, FName JobName, TArray<uint8>&& Request);
+
+    // Fire-and-forget.  Work runs on a UE task (it may block), and holds its
+    // class slot and resource until it returns.
+    void Enqueue(ESpiceJobClass Class, ESpiceJobResource Resource, TUniqueFunction<void()>&& Work);
+
+    // For jobs that finish elsewhere (another thread, another process).
+    // Start is called on whichever thread schedules it and must return at
+    // once.  The job holds its class slot and resource until it calls
+    // Finished.
+    void EnqueueAsync(ESpiceJobClass Class, ESpiceJobResource Resource, FStart&& Start);
+
+    ~FSpiceScheduler();
+
+private:
+    FSpiceScheduler();
+
+    struct FJob
+    {
+        ESpiceJobResource Resource;
+        // One or the other
+        TUniqueFunction<void()> Work;
+        FStart Start;
+    };
+
+    int32 Capacity(ESpiceJobResource Resource) const;
+    void Add(ESpiceJobClass Class, FJob&& Job);
+    void Pump();
+    void Finish(int32 Class, int32 Resource);
+
+    mutable FCriticalSection Lock;
+    TArray<FJob> Queues[(int32)ESpiceJobClass::Num];
+    int32 Budgets[(int32)ESpiceJobClass::Num];
+    int32 Running[(int32)ESpiceJobClass::Num] = {};
+    int32 InUse[(int32)ESpiceJobResource::Num] = {};
+    int32 Outstanding = 0;
+    FEvent* Idle = nullptr;
+
+    static FSpiceScheduler* Instance;
+    static FCriticalSection InstanceLock;
+};
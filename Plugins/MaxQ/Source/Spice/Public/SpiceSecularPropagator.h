@@ -0,0 +1,116 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSecularPropagator.h
+//
+// API Comments
+//
+// Purpose:  J2/J4 secular (precessing conic) propagation of many objects at
+// once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSecularPropagator.h is part of the "refined C++ API".
+//
+// Between pure conics (FTwoBodyBatchPropagator) and SGP4 sits the precessing
+// conic SPK type 15 uses:  an ellipse whose node and periapsis drift, and
+// whose mean anomaly advances at a corrected rate, under the central body's
+// oblateness.  FSecularBatchPropagator applies those secular rates to
+// conics_c elements, first order in J2 and (optionally) J4, with no kernel
+// to write.  The J2^2 terms are left out;  for Earth they're about as large
+// as J4's.
+//
+// The elements are treated as mean elements.  States are the osculating
+// two-body states of the drifted ellipse (the drift rates aren't added to
+// the velocity).
+//
+// Like FTwoBodyBatchPropagator, objects are kept in structure-of-arrays
+// columns and evaluated MAXQ_TWOBODY_LANES at a time, with ParallelFor across
+// the batch.  Propagate doesn't touch CSPICE, so it's safe from any thread.
+// Only closed orbits (eccentricity < 1) are supported.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceTwoBody.h"
+
+namespace MaxQ::Orbits
+{
+    struct SPICE_API FZonalHarmonics
+    {
+        // Equatorial radius (km) the coefficients are normalized to
+        double Radius = 0.;
+        double J2 = 0.;
+        double J4 = 0.;
+
+        // BODYnnn_RADII (the first), BODYnnn_J2 and, if bJ4, BODYnnn_J4 (as
+        // in NAIF's geophysical.ker).  A missing J4 is zero.  Uses CSPICE.
+        static bool FromKernelPool(
+            int32 Body,
+            FZonalHarmonics& Zonals,
+            bool bJ4 = true,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+    };
+
+    class SPICE_API FSecularBatchPropagator
+    {
+    public:
+        static constexpr int32 Lanes = MAXQ_TWOBODY_LANES;
+
+        // Replaces anything already built.  Entry i of Orbits is entry i of
+        // the propagation outputs.  Conic elements as conics_c (each with its
+        // own epoch and GM), all around the body Zonals describes.
+        void Build(TArrayView<const FSConicElements> Orbits, const FZonalHarmonics& Zonals);
+        void Reset();
+
+        int32 Num() const { return NumObjects; }
+        // False for elements conics_c would signal an error for, and for
+        // orbits that aren't closed
+        bool IsValid(int32 i) const { return Valid[i]; }
+        SIZE_T GetAllocatedSize() const;
+
+        // Object i's secular rates (radians/second):  of the ascending node,
+        // of the argument of periapsis, and of the mean anomaly (mean motion
+        // included)
+        void GetRates(int32 i, double& NodeRate, double& PeriapsisRate, double& MeanAnomalyRate) const;
+
+        // OutStates must have Num() entries.  Invalid entries are zeroed.
+        // If Rotation is given, it's applied to each position and velocity.
+        // Returns the number of objects propagated.
+        int32 Propagate(const FSEphemerisTime& et, TArrayView<FSStateVector> OutStates, const FSRotationMatrix* Rotation = nullptr) const;
+
+    private:
+        enum EColumn : int32
+        {
+            // Semi-major axis, eccentricity, sqrt(1 - e^2), sqrt(mu a)
+            sma, ecc, rootome2, sqrtmua,
+            cosinc, sininc,
+            // Values at the epoch, and rates
+            epoch, node0, argp0, mean0,
+            noderate, argprate, meanrate,
+            NumColumns
+        };
+
+        double* Column(EColumn c) { return &Columns[c * Rows]; }
+        const double* Column(EColumn c) const { return &Columns[c * Rows]; }
+
+        // NumColumns x Rows, column-major.  Rows is a multiple of Lanes.
+        TArray<double> Columns;
+        int32 Rows = 0;
+
+        TArray<bool> Valid;
+        int32 NumObjects = 0;
+    };
+}
@@ -0,0 +1,177 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSegmentStats.h
+//
+// API Comments
+//
+// Purpose:  Visibility into CSPICE's SPK/CK segment buffers.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSegmentStats.h is part of the "refined C++ API".
+//
+// CSPICE buffers segment lists per body (spkbsr) and per instrument (ckbsr)
+// in fixed size tables.  When a kernel set overflows them, lists get evicted
+// and the files are searched again, and an object with more segments than
+// the table holds is searched unbuffered on every lookup.
+//
+// The tables' hit/miss bookkeeping is local to the toolkit, so it can't be
+// counted from outside.  What MaxQ can show:
+// * "stat MaxQ":  time and calls in the SPK and frame/CK lookups MaxQ makes
+//   (that's where the segment searches happen).  Also GF searches, kernel
+//   loads, SGP4, error checking, and failed calls.  Cache hits and misses,
+//   and the number of loaded kernels.  (Running totals of the same:
+//   SpiceProfiling.h.)
+// * The "MaxQ" Insights channel (-trace=cpu,MaxQ):  the same scopes on the
+//   timeline, the SPK and frame ones named with their target and frames.
+//   "MaxQ/Failures" counts failed calls, so its slope is failures/second.
+// * GetSegmentBufferReport:  the loaded kernels' demand on each table,
+//   against its capacity (also set as stats, and as Insights counters)
+//
+// The capacities are compile time parameters of the toolkit (FTSIZE,
+// STSIZE, BTSIZE/ITSIZE in spkbsr.c and ckbsr.c), so resizing them means
+// rebuilding CSPICE.  The report says whether that's worth doing.
+//
+// Binary kernels are read through a pool of logical units (OS file handles)
+// in the DAF/DAS handle manager (zzddhman.c).  With more files in use than
+// the pool holds, reads close the least recently used file and reopen the
+// one they need.  GetFileUnitUsage reports the pool's size against the
+// loaded binary kernels.
+//
+// MaxQ runs on the stock toolkit (the prebuilt library is NAIF's), and
+// changes to the toolkit's sources are optional.  Built from the sources
+// here, CSPICE also counts the pool's use (MaxQUnits.h), and defining
+// MAXQ_CSPICE_UTSIZE (and MAXQ_CSPICE_MAXLUN) resizes it.  With that
+// library, build MaxQ with MAXQ_CSPICE_UNIT_STATS=1 (Spice.Build.cs) and
+// GetFileUnitUsage also reports requests and reopens, and sets them as
+// stats and Insights counters ("MaxQ/File Unit Reopens", whose slope is
+// reopens/second).
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("MaxQ"), STATGROUP_MaxQ, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SPK lookups"), STAT_MaxQ_SpkLookup, STATGROUP_MaxQ, SPICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Frame/CK lookups"), STAT_MaxQ_FrameLookup, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("SPK lookup calls"), STAT_MaxQ_SpkLookups, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frame/CK lookup calls"), STAT_MaxQ_FrameLookups, STATGROUP_MaxQ, SPICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GF searches"), STAT_MaxQ_GfSearch, STATGROUP_MaxQ, SPICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Kernel loads"), STAT_MaxQ_Furnsh, STATGROUP_MaxQ, SPICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SGP4"), STAT_MaxQ_Sgp4, STATGROUP_MaxQ, SPICE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Error checks"), STAT_MaxQ_ErrorCheck, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("GF search calls"), STAT_MaxQ_GfSearches, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Kernel load calls"), STAT_MaxQ_Furnshes, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("SGP4 evaluations"), STAT_MaxQ_Sgp4Evaluations, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Failed calls"), STAT_MaxQ_Failures, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Memoized queries"), STAT_MaxQ_MemoHits, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Query memo misses"), STAT_MaxQ_MemoMisses, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chebyshev cache hits"), STAT_MaxQ_ChebyshevHits, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chebyshev cache misses"), STAT_MaxQ_ChebyshevMisses, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frame chain hits"), STAT_MaxQ_FrameChainHits, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frame chain recompiles"), STAT_MaxQ_FrameChainRecompiles, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dynamic frame hits"), STAT_MaxQ_DynamicFrameHits, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dynamic frame misses"), STAT_MaxQ_DynamicFrameMisses, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pool snapshot hits"), STAT_MaxQ_PoolCacheHits, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pool snapshot rebuilds"), STAT_MaxQ_PoolCacheRebuilds, STATGROUP_MaxQ, SPICE_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Loaded kernels"), STAT_MaxQ_LoadedKernels, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("SPK files"), STAT_MaxQ_SpkFiles, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("SPK segments"), STAT_MaxQ_SpkSegments, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("SPK bodies"), STAT_MaxQ_SpkBodies, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("CK files"), STAT_MaxQ_CkFiles, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("CK segments"), STAT_MaxQ_CkSegments, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("CK instruments"), STAT_MaxQ_CkInstruments, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("File units"), STAT_MaxQ_FileUnits, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("File unit requests"), STAT_MaxQ_FileUnitRequests, STATGROUP_MaxQ, SPICE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("File unit reopens"), STAT_MaxQ_FileUnitReopens, STATGROUP_MaxQ, SPICE_API);
+
+namespace MaxQ::Data
+{
+    struct SPICE_API FSegmentTableUsage
+    {
+        int32 Files = 0;
+        int32 Segments = 0;
+        // SPK:  bodies, CK:  instruments/structures
+        int32 Ids = 0;
+        // The object with the most segments, and how many
+        int32 BusiestId = 0;
+        int32 BusiestIdSegments = 0;
+
+        // The toolkit's table sizes
+        int32 FileCapacity = 0;
+        int32 SegmentCapacity = 0;
+        int32 IdCapacity = 0;
+
+        // Segment lists can't all stay buffered at once
+        bool MayThrash() const { return Segments > SegmentCapacity || Ids > IdCapacity; }
+        // The busiest object can't be buffered at all
+        bool IsUnbuffered() const { return BusiestIdSegments > SegmentCapacity; }
+    };
+
+    struct SPICE_API FSegmentBufferReport
+    {
+        FSegmentTableUsage Spk;
+        FSegmentTableUsage Ck;
+    };
+
+    struct SPICE_API FFileUnitUsage
+    {
+        // False with the stock toolkit:  only the sizes and BinaryKernels
+        // are known
+        bool bCounted = false;
+
+        // Since the last ResetFileUnitUsage:  reads and writes' requests
+        // for a file's unit, the ones whose file had to be reopened, and
+        // units taken from one file for another
+        int64 Requests = 0;
+        int64 Reopens = 0;
+        int64 Evictions = 0;
+
+        // Units in the pool now, and the most since the last reset
+        int32 Units = 0;
+        int32 PeakUnits = 0;
+
+        // The pool's size (MAXQ_CSPICE_UTSIZE), and the largest unit number
+        // (MAXQ_CSPICE_MAXLUN)
+        int32 Capacity = 0;
+        int32 MaxUnitNumber = 0;
+
+        // Loaded binary kernels (SPK, CK, PCK, DSK, EK)
+        int32 BinaryKernels = 0;
+
+        // More binary kernels than units:  reads may reopen files
+        bool MayThrash() const { return BinaryKernels > Capacity; }
+        double ReopenRate() const { return Requests > 0 ? (double)Reopens / (double)Requests : 0.; }
+    };
+
+    // The handle manager's counters, if the CSPICE build keeps them
+    SPICE_API bool GetFileUnitUsage(
+        FFileUnitUsage& Usage,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API void ResetFileUnitUsage();
+
+    // Scans the loaded SPKs and CKs' segment summaries.  (CKs need the LSK
+    // and their SCLKs loaded, as FKernelCoverageIndex does.)
+    SPICE_API bool GetSegmentBufferReport(
+        FSegmentBufferReport& Report,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,90 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSession.h
+//
+// API Comments
+//
+// Purpose:  Saving and restoring MaxQ's whole SPICE state at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSession.h is part of the "refined C++ API".
+//
+// Loading a saved game means getting SPICE back to where it was:  InitAll,
+// Furnsh every kernel again in the same order, redo whatever was pdpool'd
+// and boddef'd at runtime, and set the clock.  That's slow (every text kernel
+// is parsed again) and easy to get wrong (a pool edit forgotten, kernels in
+// another order).
+//
+// A session holds all of it:
+//
+// * The loaded kernels, in load order (precedence), from the kernel history,
+//   each marked text or binary.
+// * The kernel pool, as a pool snapshot (SpicePoolSnapshot.h):  the text
+//   kernels' variables and any runtime edits on top of them, as they are.
+// * The names given to Boddef, with their codes.
+// * The engine-wide ET clock (MaxQ::Time::GetEtClock):  its epoch and rate.
+//
+// RestoreSession clears everything (ClearAll), Furnshes the binary kernels
+// (and meta-kernels) in their order, then writes the pool back in one bulk
+// pass instead of parsing the text kernels, which are recorded in the kernel
+// history as loaded.  The pool goes last, so what a meta-kernel loads again
+// doesn't undo an edit.  Then the boddefs, WarmUp (the time system and the
+// name registry are built from the restored pool, rather than on the first
+// frame that needs them) and, optionally, the clock.
+//
+// The caches themselves aren't saved:  they're derived from the pool, and
+// rebuilt from it faster than they'd be read back.  Neither is anything a
+// world owns (UMaxQSimulationClockSubsystem's epoch, say), which belongs in
+// the game's own save.
+//
+// Kernel paths are absolute, as the history keeps them, so a session is
+// for the machine (and install) that saved it.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Data
+{
+    // Uses CSPICE (to read the pool and boddef codes)
+    SPICE_API bool SaveSession(
+        TArray<uint8>& Session,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Replaces everything loaded with the session's state.  On failure,
+    // what's loaded is whatever was restored before the failure.
+    SPICE_API bool RestoreSession(
+        TArrayView<const uint8> Session,
+        bool bRestoreClock = true,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Relative paths are under Saved/MaxQ/Sessions
+    SPICE_API bool SaveSessionFile(
+        const FString& path,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    SPICE_API bool RestoreSessionFile(
+        const FString& path,
+        bool bRestoreClock = true,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,182 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSimulationClock.h
+//
+// API Comments
+//
+// Purpose:  A deterministic, fixed step simulation clock.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSimulationClock.h is part of the "refined C++ API".
+//
+// Advancing an epoch by DeltaTime * TimeScale every frame samples ephemeris at
+// frame rate dependent epochs:  no two runs (or two machines) ask for the same
+// ones, so nothing keyed on the epoch is ever reused, and a replay can't
+// reproduce what was seen.
+//
+// FSimulationClock counts whole steps instead.  Step n's epoch is Start +
+// n * Step, computed (not accumulated), so it's bit-identical however the
+// frames fell, and going back to step n (Seek) is exact.  Real time only
+// decides how many steps have passed;  the remainder is kept as the fraction
+// of the next step.  The render epoch trails the simulation by one step, so
+// it always lies between two steps that have been computed (n - 1 and n),
+// and states there can be interpolated rather than extrapolated.  A negative
+// time scale runs the steps backwards.
+//
+// UMaxQSimulationClockSubsystem is one per world, ticked before physics.  It
+// broadcasts OnStep for every step taken.  UMaxQEphemerisSubsystem follows
+// its step epoch when bFollowSimulationClock is set.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "SpiceTypes.h"
+#include "SpiceSimulationClock.generated.h"
+
+class UMaxQSimulationClockSubsystem;
+
+namespace MaxQ::Time
+{
+    class SPICE_API FSimulationClock
+    {
+    public:
+        FSimulationClock() = default;
+        FSimulationClock(double _Start, double _Step) { Reset(_Start, _Step); }
+
+        // Step 0, at Start.  Step is ET seconds, > 0.
+        void Reset(double _Start, double _Step);
+
+        // Real seconds have passed.  Returns the steps taken (negative when
+        // running backwards), at most MaxSteps either way;  time beyond that
+        // is dropped, so a hitch can't snowball.
+        int32 Advance(double DeltaSeconds, int32 MaxSteps = 8);
+
+        // Jumps to step n, with nothing of the next step elapsed
+        void Seek(int64 n);
+
+        // ET seconds per real second
+        void SetTimeScale(double Scale) { TimeScale = Scale; }
+        double GetTimeScale() const { return TimeScale; }
+
+        double GetStart() const { return Start; }
+        double GetStepSize() const { return StepSize; }
+        int64 GetStep() const { return Current; }
+
+        // Start + n * Step
+        double StepEpoch(int64 n) const { return Start + (double)n * StepSize; }
+        double GetStepEpoch() const { return StepEpoch(Current); }
+
+        // How much of the next step has elapsed, [0, 1)
+        double GetAlpha() const { return Fraction / StepSize; }
+
+        // Between steps n - 1 and n:  StepEpoch(n - 1) + Alpha * Step
+        double GetRenderEpoch() const { return StepEpoch(Current - 1) + Fraction; }
+
+        // The last step at or before et, and its epoch
+        int64 Quantize(double et) const;
+        double QuantizeEpoch(double et) const { return StepEpoch(Quantize(et)); }
+
+    private:
+        double Start = 0.;
+        double StepSize = 1.;
+        double TimeScale = 1.;
+        int64 Current = 0;
+        // ET seconds past the current step, [0, StepSize)
+        double Fraction = 0.;
+    };
+}
+
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMaxQSimulationStepDelegate, int64, Step, const FSEphemerisTime&, Epoch);
+
+
+USTRUCT()
+struct FMaxQSimulationClockTickFunction : public FTickFunction
+{
+    GENERATED_BODY()
+
+    UMaxQSimulationClockSubsystem* Subsystem = nullptr;
+
+    virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+    virtual FString DiagnosticMessage() override;
+    virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMaxQSimulationClockTickFunction> : public TStructOpsTypeTraitsBase2<FMaxQSimulationClockTickFunction>
+{
+    enum
+    {
+        WithCopy = false
+    };
+};
+
+
+UCLASS(Config = Game)
+class SPICE_API UMaxQSimulationClockSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // ET seconds per second of game time (negative:  backwards, 0:  paused)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Time") double TimeScale = 1.;
+
+    // Steps per frame, at most (either way)
+    UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Time") int32 MaxStepsPerFrame = 8;
+
+    // Once per step taken, in order
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Time") FMaxQSimulationStepDelegate OnStep;
+
+    // Step 0 at Start
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Time")
+    void Reset(const FSEphemerisTime& Start, const FSEphemerisPeriod& Step);
+
+    // For rewinds and replays.  OnStep isn't broadcast.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Time")
+    void Seek(int64 Step);
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Time")
+    int64 GetStep() const { return Clock.GetStep(); }
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Time")
+    FSEphemerisTime GetStepEpoch() const { return FSEphemerisTime(Clock.GetStepEpoch()); }
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Time")
+    FSEphemerisTime GetRenderEpoch() const { return FSEphemerisTime(Clock.GetRenderEpoch()); }
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Time")
+    double GetAlpha() const { return Clock.GetAlpha(); }
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Time")
+    FSEphemerisTime Quantize(const FSEphemerisTime& et) const { return FSEphemerisTime(Clock.QuantizeEpoch(et.AsSpiceDouble())); }
+
+    const MaxQ::Time::FSimulationClock& GetClock() const { return Clock; }
+
+    // For tick prerequisites (anything reading the clock should tick after)
+    FTickFunction& GetTickFunction() { return TickFunction; }
+
+    // Advances the clock now, whatever the tick group
+    void Update(float DeltaTime);
+
+    virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+
+private:
+    FMaxQSimulationClockTickFunction TickFunction;
+    MaxQ::Time::FSimulationClock Clock;
+};
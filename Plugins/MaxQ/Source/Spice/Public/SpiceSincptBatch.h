@@ -0,0 +1,122 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSincptBatch.h
+//
+// API Comments
+//
+// Purpose:  Surface intercepts for many rays from one observer, one epoch.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSincptBatch.h is part of the "refined C++ API".
+//
+// Rasterizing a camera's or an instrument's footprint takes a sincpt per
+// pixel, and almost all of each one's work (the target's light time, the
+// frame transformations, the observer's velocity) is the same for every
+// pixel.
+//
+// InterceptGeometry does that part once (CSPICE), corrected to the target's
+// center.  SurfaceIntercepts then takes each direction to the body fixed
+// frame, removes stellar aberration from it if abcorr asks for that (as
+// sincpt does), and intersects it with the target's RADII ellipsoid, or with
+// a MaxQ::Dsk::FDskShapeModel (native, in parallel, any thread).  Using the
+// target center's light time for every ray, instead of each intercept's own,
+// differs from sincpt by about the target's rotation during the light time
+// across it, as SpiceIlluminationBatch.h's angles do.
+//
+// SincptBatch does both, for callers that only need one batch per epoch.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Dsk
+{
+    class FDskShapeModel;
+}
+
+namespace MaxQ::Math
+{
+    struct FInterceptGeometry
+    {
+        // Target center's epoch (sincpt's trgepc, for the center)
+        FSEphemerisTime TargetEpoch;
+        // Target centered, in the body fixed frame at TargetEpoch
+        FSDistanceVector Observer;
+        // dref -> J2000, at the observer's epoch
+        FSRotationMatrix ToJ2000;
+        // J2000 -> body fixed frame, at TargetEpoch
+        FSRotationMatrix FromJ2000;
+        // Observer's velocity relative to the SSB, J2000 (stellar aberration)
+        FSVelocityVector ObserverVelocity;
+        bool bStellarAberration = false;
+        bool bTransmission = false;
+        // The target's RADII, if it has them (zero otherwise)
+        FSDistanceVector Radii;
+        // The body fixed frame's ID, to check shape models against
+        int32 FixRefCode = 0;
+    };
+
+    // Caller owned, one element per ray.  Found may be empty, SurfaceVectors
+    // null, if the caller doesn't need them.  Missing rays' points are zero.
+    struct FInterceptBatch
+    {
+        FVectorBatch Points;
+        TArrayView<uint8> Found;
+        const FVectorBatch* SurfaceVectors = nullptr;
+        int32 Num() const { return Points.Num(); }
+    };
+
+    // Uses CSPICE.  Arguments as sincpt's.
+    SPICE_API bool InterceptGeometry(
+        const FSEphemerisTime& et,
+        FInterceptGeometry& Geometry,
+        const FString& dref,
+        const FString& target = TEXT("EARTH"),
+        const FString& fixref = TEXT("IAU_EARTH"),
+        const FString& obsrvr = TEXT("EARTH"),
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Native.  Directions:  in dref, any length (zero length rays miss).
+    // Shape:  intersect its plates instead of the ellipsoid;  its frame must
+    // be fixref.  False if any lengths differ, if Shape's frame isn't fixref,
+    // or if there's no Shape and Geometry has no radii.  Rays from inside the
+    // ellipsoid miss (sincpt signals an error).
+    SPICE_API bool SurfaceIntercepts(
+        const FInterceptGeometry& Geometry,
+        const FConstVectorBatch& Directions,
+        const FInterceptBatch& Intercepts,
+        const MaxQ::Dsk::FDskShapeModel* Shape = nullptr
+    );
+
+    // InterceptGeometry then SurfaceIntercepts.  trgepc:  the target center's.
+    SPICE_API bool SincptBatch(
+        const FSEphemerisTime& et,
+        const FString& dref,
+        const FConstVectorBatch& Directions,
+        const FInterceptBatch& Intercepts,
+        FSEphemerisTime& trgepc,
+        const MaxQ::Dsk::FDskShapeModel* Shape = nullptr,
+        const FString& target = TEXT("EARTH"),
+        const FString& fixref = TEXT("IAU_EARTH"),
+        const FString& obsrvr = TEXT("EARTH"),
+        ES_AberrationCorrectionWithTransmissions abcorr = ES_AberrationCorrectionWithTransmissions::None,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,105 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSpatialIndex.h
+//
+// API Comments
+//
+// Purpose:  A spatial index over a catalog's positions, for picking and
+// proximity queries.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSpatialIndex.h is part of the "refined C++ API".
+//
+// The satellite under the cursor, or everything within 100 km of a station,
+// is a scan over every object without an index.  FSpatialIndex is a bounding
+// volume hierarchy over a batch of positions (batch propagated, or from an
+// ephemeris snapshot), cheap enough to rebuild every frame:  the positions
+// are sorted along a Morton curve, and the tree over them is implicit
+// (a complete binary tree of small leaves), so building it is a sort and a
+// pass per level, each across all cores.
+//
+// Queries never modify the index, so any number of threads can query it at
+// once.  Indices in results are the positions' indices in the batch it was
+// built from.
+//
+// Pairs is a self-join (every pair closer than a distance), the candidate
+// search a conjunction screen makes at each step.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Math
+{
+    struct FSpatialHit
+    {
+        // Into the batch the index was built from
+        int32 Index = INDEX_NONE;
+        // km:  from the query point, or (Raycast) along the ray
+        double Distance = 0.;
+    };
+
+    class SPICE_API FSpatialIndex
+    {
+    public:
+        // Positions in km, all in one frame.  Valid (optional, one per
+        // position):  0 leaves a position out.
+        void Build(const FConstVectorBatch& Positions, TArrayView<const uint8> Valid = TArrayView<const uint8>());
+        void Reset();
+
+        // Positions indexed
+        int32 Num() const { return Ids.Num(); }
+
+        // The position nearest the ray's vertex, along the ray, within
+        // Radius + Distance * tan(Angle) of it:  a cone (a pixel's, say)
+        // grown by a radius.  Direction needn't be unit.
+        bool Raycast(const FSRay& Ray, double Radius, double Angle, FSpatialHit& Hit, double MaxDistance = TNumericLimits<double>::Max()) const;
+
+        // Every position within Radius of Center, nearest first
+        void Within(const FSDistanceVector& Center, double Radius, TArray<FSpatialHit>& Hits) const;
+
+        // The K positions nearest Center (within MaxDistance), nearest first
+        void Nearest(const FSDistanceVector& Center, int32 K, TArray<FSpatialHit>& Hits, double MaxDistance = TNumericLimits<double>::Max()) const;
+
+        // Every pair of positions closer than Distance (First < Second),
+        // sorted.  Across all cores.
+        void Pairs(double Distance, TArray<TPair<int32, int32>>& Pairs) const;
+
+        SIZE_T GetAllocatedSize() const;
+
+    private:
+        struct FBounds
+        {
+            double Min[3];
+            double Max[3];
+        };
+
+        // Calls Visit(Point) for the points of every leaf whose bounds
+        // Overlaps accepts, pruning subtrees it rejects
+        template<typename OverlapsType, typename VisitType>
+        void Traverse(OverlapsType&& Overlaps, VisitType&& Visit) const;
+
+        // Sorted positions, and their indices in the batch
+        TArray<double> X, Y, Z;
+        TArray<int32> Ids;
+
+        // Implicit tree:  node i's children are 2i + 1 and 2i + 2, and the
+        // NumLeaves leaves (a power of two) are the last nodes.  Leaf j holds
+        // points [j * LeafSize, (j + 1) * LeafSize).
+        TArray<FBounds> Nodes;
+        int32 NumLeaves = 0;
+    };
+}
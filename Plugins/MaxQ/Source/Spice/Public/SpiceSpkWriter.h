@@ -0,0 +1,249 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSpkWriter.h
+//
+// API Comments
+//
+// Purpose:  Writes discrete-state SPK segments incrementally, and fits
+// sampled trajectories with Chebyshev (type 02/03) segments.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSpkWriter.h is part of the "refined C++ API".
+//
+// spkw05/spkw09/spkw13 take every state of a segment in one call.  A
+// simulation that produces states for weeks of sim time would have to keep
+// all of them in memory until the end.
+//
+// FSpkSegmentWriter takes states in chunks, and writes a segment each time
+// MaxStatesPerSegment have accumulated.  Consecutive segments share the
+// states of one interpolation window (less one), and each segment's coverage
+// starts where the previous one's ended, so coverage is contiguous and
+// interpolation near the boundaries doesn't lose its neighbors.  Memory use
+// is bounded by MaxStatesPerSegment.
+//
+// CSPICE only has a begin/add/end interface for type 14 (Chebyshev) segments,
+// so discrete-state types are chunked into segments this way instead.
+//
+// With bUseExecutor, the segment writes go to the FSpiceExecutor thread, and
+// Add() never calls CSPICE (so it can be called from the game thread while
+// the executor owns CSPICE).  At most two segments are in flight.  End()
+// waits for them, and reports the first failure.
+//
+// FitChebyshevSegments compresses a sampled trajectory into type 02 or 03
+// segments, which are a small fraction of the size of discrete-state ones and
+// faster to evaluate.  The samples are interpolated (as type 09 would), and
+// each record is fit at the Chebyshev nodes.  spkw02/spkw03
+// records are all the same length within a segment, so the fitter keeps
+// doubling a segment's record count until every record is within tolerance.
+// Records are fit in parallel.  Fitting doesn't touch CSPICE;
+// WriteChebyshevSegments does.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Private
+{
+    class FSegmentWriteQueue;
+}
+
+namespace MaxQ::Ephemeris
+{
+    enum class ESpkSegmentType : uint8
+    {
+        // Two-body propagation between states (needs GM)
+        Type05 = 5,
+        // Lagrange interpolation of states
+        Type09 = 9,
+        // Hermite interpolation of positions and velocities
+        Type13 = 13
+    };
+
+    struct FSpkSegmentWriterSettings
+    {
+        ESpkSegmentType Type = ESpkSegmentType::Type13;
+
+        // Interpolation degree (types 09 and 13).  Type 13 requires an odd
+        // degree.
+        int32 Degree = 7;
+
+        // Type 05 only
+        double GM = 0.;
+
+        // States per segment (including the overlap with the previous one)
+        int32 MaxStatesPerSegment = 10000;
+
+        // Write segments on the FSpiceExecutor thread
+        bool bUseExecutor = false;
+    };
+
+    class SPICE_API FSpkSegmentWriter
+    {
+    public:
+        FSpkSegmentWriter();
+        ~FSpkSegmentWriter();
+
+        // handle is an SPK open for writing (spkopn, spkopa).
+        // body, center, frame and segid are as spkw05/09/13.
+        bool Begin(
+            int handle,
+            int body,
+            int center,
+            const FString& frame,
+            const FString& segid,
+            const FSpkSegmentWriterSettings& Settings = FSpkSegmentWriterSettings(),
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Epochs must increase, within and across calls.
+        bool Add(
+            TArrayView<const double> ets,
+            TArrayView<const FSStateVector> states,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        bool Add(
+            const FSEphemerisTime& et,
+            const FSStateVector& state,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        // Writes what's left, and waits for any segments still in flight.
+        bool End(
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+
+        bool IsOpen() const { return bOpen; }
+        // Segments written (or queued, with bUseExecutor)
+        int32 NumSegments() const { return SegmentsWritten; }
+        int32 NumBuffered() const { return Epochs.Num(); }
+
+        FSpkSegmentWriter(const FSpkSegmentWriter&) = delete;
+        FSpkSegmentWriter& operator=(const FSpkSegmentWriter&) = delete;
+
+    private:
+        struct FSegment;
+
+        bool Flush(bool bFinal, ES_ResultCode* ResultCode, FString* ErrorMessage);
+        bool Fail(const FString& Message, ES_ResultCode* ResultCode, FString* ErrorMessage);
+
+        int32 Carry() const;
+        int32 MinStates() const;
+
+        FSpkSegmentWriterSettings Settings;
+        int Handle = 0;
+        int Body = 0;
+        int Center = 0;
+        FString Frame;
+        FString SegId;
+
+        // Buffered, not yet written.  After the first segment, the first
+        // Carry() states were already written, at the end of the previous one.
+        TArray<double> Epochs;
+        TArray<double> States;
+        double CoverageStart = 0.;
+        bool bHaveCoverageStart = false;
+
+        // Only with bUseExecutor
+        TUniquePtr<MaxQ::Private::FSegmentWriteQueue> WriteQueue;
+
+        int32 SegmentsWritten = 0;
+        bool bOpen = false;
+    };
+
+
+    enum class ESpkChebyshevType : uint8
+    {
+        // Position only; velocity is the derivative
+        Type02 = 2,
+        // Position and velocity, fit separately
+        Type03 = 3
+    };
+
+    struct FSpkChebyshevFitSettings
+    {
+        ESpkChebyshevType Type = ESpkChebyshevType::Type03;
+
+        // Chebyshev polynomial degree of every record
+        int32 Degree = 11;
+
+        // Maximum error of any record, at the samples and halfway between
+        // its fit nodes
+        double PositionToleranceKm = 0.001;
+        double VelocityToleranceKmps = 0.000001;
+
+        // Segments are no longer than this (so each can pick its own
+        // record length)
+        double MaxSegmentSeconds = 30. * 86400.;
+
+        // Records start out as long as the segment, or this, whichever is
+        // shorter, and halve until every record meets the tolerance...
+        double MaxRecordSeconds = 86400.;
+
+        // ...but never get shorter than this (even if they miss it)
+        double MinRecordSeconds = 60.;
+    };
+
+    // The inputs to one spkw02/spkw03 call
+    struct SPICE_API FSpkChebyshevSegment
+    {
+        ESpkChebyshevType Type = ESpkChebyshevType::Type03;
+        double First = 0.;
+        double Last = 0.;
+        // Record i covers [First + i * Intlen, First + (i+1) * Intlen]
+        double Intlen = 0.;
+        int32 Degree = 0;
+
+        // Per record, per component (x, y, z[, vx, vy, vz]):  Degree+1
+        // coefficients, as cdata of spkw02/spkw03
+        TArray<double> Coefficients;
+
+        // Largest error found while fitting
+        double MaxPositionErrorKm = 0.;
+        double MaxVelocityErrorKmps = 0.;
+
+        int32 NumRecords() const;
+
+        // Thread-safe.  False if et is outside [First, Last].
+        bool Evaluate(double et, double(&r)[3], double(&v)[3]) const;
+    };
+
+    // Fits states sorted by increasing epoch (at least 2).  Thread-safe (no
+    // CSPICE).  Replaces the contents of Segments.
+    SPICE_API bool FitChebyshevSegments(
+        TArrayView<const double> ets,
+        TArrayView<const FSStateVector> states,
+        TArray<FSpkChebyshevSegment>& Segments,
+        const FSpkChebyshevFitSettings& Settings = FSpkChebyshevFitSettings(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // spkw02/spkw03, once per segment
+    SPICE_API bool WriteChebyshevSegments(
+        int handle,
+        int body,
+        int center,
+        const FString& frame,
+        const FString& segid,
+        TArrayView<const FSpkChebyshevSegment> Segments,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
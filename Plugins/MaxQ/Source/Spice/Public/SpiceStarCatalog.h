@@ -0,0 +1,173 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStarCatalog.h
+//
+// API Comments
+//
+// Purpose:  SPICE type 1 star catalogs (Hipparcos, Tycho-2...), in bulk.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStarCatalog.h is part of the "refined C++ API".
+//
+// stcf01/stcg01 fetch stars from a catalog one at a time, through an EK
+// query per star.  LoadStarCatalog instead loads the catalog (stcl01), runs
+// one query for every star up to a magnitude, copies the columns out into
+// structure-of-arrays buffers, and unloads it.
+//
+// FStarField turns a catalog into unit directions for an epoch:  proper
+// motion (linear in RA/Dec, from each star's epoch, as the catalogs give
+// it), then stellar aberration for the observer's velocity (stelab's).  The
+// directions are computed in parallel chunks, with no CSPICE, so Update can
+// run on any thread.  QueryCone finds the stars in an instrument's field of
+// view through a cube-map grid of the stars' directions, instead of testing
+// every star.
+//
+// Catalogs without the proper motion columns (RA_PM, DEC_PM, RA_EPOCH,
+// DEC_EPOCH) load without proper motion.  Those columns are read as the
+// catalogs hold the positions:  degrees, degrees per Julian year, and
+// Julian years (1991.25 for Hipparcos).  Parallax is ignored:  every star is
+// infinitely far away.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceMathBatch.h"
+
+namespace MaxQ::Data
+{
+    enum class EStarSpectralClass : uint8
+    {
+        O, B, A, F, G, K, M,
+        Unknown
+    };
+
+    // One entry per star, in the catalog's order
+    struct SPICE_API FStarCatalog
+    {
+        // Radians, J2000, at Epoch
+        TArray<double> Ra;
+        TArray<double> Dec;
+        // Radians per Julian year (dRA/dt, not times cos(Dec))
+        TArray<double> RaPm;
+        TArray<double> DecPm;
+        // Seconds past J2000 (TDB)
+        TArray<double> Epoch;
+
+        TArray<int32> CatalogNumber;
+        TArray<float> VisualMagnitude;
+        // The first letter of the spectral type (stcg01 has the rest)
+        TArray<EStarSpectralClass> SpectralClass;
+
+        int32 Num() const { return Ra.Num(); }
+        void Reset();
+        void SetNum(int32 Num);
+
+        // The largest total proper motion, radians per Julian year
+        double MaxProperMotion() const;
+    };
+
+    struct FStarCatalogLoadSettings
+    {
+        // Fainter stars are left out
+        double MaxMagnitude = 6.5;
+
+        // The catalog's RA_PM is mu_alpha* (times cos(Dec)), as Hipparcos and
+        // Tycho-2 publish it, rather than dRA/dt
+        bool bRaPmTimesCosDec = true;
+    };
+
+    SPICE_API EStarSpectralClass StarSpectralClass(const FString& SpectralType);
+
+    // Loads the catalog at Path (relative to the project directory), reads
+    // it into Catalog, and unloads it.  Returns the number of stars.  Uses
+    // CSPICE.
+    SPICE_API int32 LoadStarCatalog(
+        const FString& Path,
+        FStarCatalog& Catalog,
+        const FStarCatalogLoadSettings& Settings = FStarCatalogLoadSettings(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Stars binned by direction on the faces of a cube, for cone queries.
+    // Each face is Resolution x Resolution cells.
+    class SPICE_API FStarIndex
+    {
+    public:
+        void Build(const MaxQ::Math::FConstVectorBatch& Directions, int32 Resolution = 64);
+        void Reset();
+
+        // Appends the stars within HalfAngle (radians) of Axis (a unit
+        // vector), by testing Directions, which may have moved up to Slack
+        // radians from the ones the index was built with.  Returns the number
+        // appended.
+        int32 QueryCone(
+            const MaxQ::Math::FConstVectorBatch& Directions,
+            const FSDimensionlessVector& Axis,
+            double HalfAngle,
+            double Slack,
+            TArray<int32>& Stars
+        ) const;
+
+        int32 Num() const { return CellStars.Num(); }
+
+    private:
+        int32 Resolution = 0;
+        // Each cell's center, and the angle to its farthest corner
+        TArray<FVector3d> CellAxis;
+        TArray<double> CellRadius;
+        // Cell c's stars are CellStars[CellStart[c], CellStart[c+1])
+        TArray<int32> CellStart;
+        TArray<int32> CellStars;
+    };
+
+    // A catalog's directions at one epoch, for one observer
+    class SPICE_API FStarField
+    {
+    public:
+        void SetCatalog(FStarCatalog&& Catalog);
+        const FStarCatalog& GetCatalog() const { return Catalog; }
+
+        // vobs:  the observer's velocity relative to the solar system
+        // barycenter, J2000.  Thread-safe (no CSPICE), but not reentrant.
+        // False if |vobs| >= c (the directions have proper motion only).
+        bool Update(const FSEphemerisTime& et, const FSVelocityVector& vobs = FSVelocityVector());
+
+        // J2000 unit vectors, as of the last Update
+        MaxQ::Math::FConstVectorBatch Directions() const { return MaxQ::Math::FConstVectorBatch(X, Y, Z); }
+        const FSEphemerisTime& GetEpoch() const { return Epoch; }
+
+        // Stars within HalfAngle of Axis (J2000), as of the last Update
+        int32 QueryCone(const FSDimensionlessVector& Axis, double HalfAngle, TArray<int32>& Stars) const;
+
+        int32 Num() const { return Catalog.Num(); }
+
+    private:
+        FStarCatalog Catalog;
+        TArray<double> X, Y, Z;
+        FSEphemerisTime Epoch;
+
+        // Radians per Julian year
+        double MaxProperMotion = 0.;
+
+        FStarIndex Index;
+        // The epoch of the directions the index was built from (without
+        // aberration)
+        double IndexEpoch = 0.;
+        bool bIndexValid = false;
+        // How far the stars may be from where they're indexed
+        double Slack = 0.;
+    };
+}
@@ -0,0 +1,141 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStarFieldComponent.h
+//
+// API Comments
+//
+// Purpose:  A star catalog, drawn as instanced sprites.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStarFieldComponent.h is part of the "Blueprints API".
+//
+// A skybox texture is one epoch, seen from nowhere in particular.
+// UMaxQStarFieldComponent draws a SPICE star catalog instead:  one instance
+// of a (camera facing) sprite mesh per star, on a sphere of Radius around
+// the component, which is taken to be aligned with J2000.  Stars move with
+// their proper motion, and with the stellar aberration of the Observer's
+// velocity.
+//
+// LoadCatalog reads the catalog on the FSpiceExecutor thread.  Every
+// RefreshSeconds of ephemeris time, the directions are recomputed
+// (FStarField) and turned into instance transforms on a worker, and handed
+// to the instance buffer in one batch when they're done, as
+// UMaxQCatalogComponent does.  Stars hardly move, so the default refresh is
+// an hour.
+//
+// Per instance custom data (for the material's PerInstanceCustomData):
+// 0:  visual magnitude.  1:  spectral class (EStarSpectralClass:  O is 0,
+// M is 6, unknown 7).  Instances are scaled by brightness, relative to
+// ReferenceMagnitude, down to MinScale.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Async/Future.h"
+#include "SpiceTypes.h"
+#include "SpiceStarCatalog.h"
+#include "SpiceStarFieldComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQStarFieldLoadedDelegate, int32, NumStars);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMaxQStarFieldErrorDelegate, const FString&, ErrorMessage);
+
+
+UCLASS(ClassGroup = (MaxQ), meta = (BlueprintSpawnableComponent))
+class SPICE_API UMaxQStarFieldComponent : public UInstancedStaticMeshComponent
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQStarFieldComponent();
+
+    // A SPICE type 1 star catalog (EK), relative to the project directory
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") FString CatalogPath;
+    // Fainter stars aren't loaded
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") double MaxMagnitude = 6.5;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") bool bLoadOnBeginPlay = true;
+
+    // The epoch to place the stars at, unless bFollowSubsystem
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") FSEphemerisTime Epoch;
+    // Use the world's UMaxQEphemerisSubsystem's Epoch
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") bool bFollowSubsystem = true;
+    // Ephemeris seconds between updates
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") double RefreshSeconds = 3600.;
+
+    // Correct for the Observer's velocity relative to the solar system
+    // barycenter
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") bool bAberration = true;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") FString Observer = TEXT("EARTH");
+
+    // Distance of the sprites from the component (UE units)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") double Radius = 1000000.;
+    // Instance scale of a star of ReferenceMagnitude.  Each magnitude
+    // fainter is 10^-0.2 (about 0.63) times smaller, down to MinScale
+    // times InstanceScale.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") FVector InstanceScale = FVector::OneVector;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") double ReferenceMagnitude = 0.;
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Stars") double MinScale = 0.1;
+
+    // The epoch of what's on screen
+    UPROPERTY(BlueprintReadOnly, Category = "MaxQ|Stars") FSEphemerisTime DisplayedEpoch;
+
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Stars") FMaxQStarFieldLoadedDelegate OnLoaded;
+    UPROPERTY(BlueprintAssignable, Category = "MaxQ|Stars") FMaxQStarFieldErrorDelegate OnError;
+
+    // Reads CatalogPath on the executor (OnLoaded or OnError, later)
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Stars")
+    void LoadCatalog();
+
+    // Replaces the catalog (and the instances).  Returns the number of stars.
+    int32 SetStarCatalog(MaxQ::Data::FStarCatalog&& Catalog);
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Stars")
+    int32 NumStars() const { return Field.Num(); }
+
+    // The stars on screen within HalfAngle of Axis (J2000), eg in an
+    // instrument's field of view.  Waits for an update in flight.
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Stars")
+    int32 QueryCone(const FSDimensionlessVector& Axis, const FSAngle& HalfAngle, TArray<int32>& Stars);
+
+    // A star's apparent direction (J2000) and catalog number, as on screen
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Stars")
+    bool GetStar(int32 Index, FSDimensionlessVector& Direction, int32& CatalogNumber, float& VisualMagnitude);
+
+    virtual void BeginPlay() override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    virtual void BeginDestroy() override;
+
+private:
+    struct FLoaded
+    {
+        MaxQ::Data::FStarCatalog Catalog;
+        ES_ResultCode ResultCode = ES_ResultCode::Success;
+        FString ErrorMessage;
+    };
+
+    void Launch(const FSEphemerisTime& et);
+    void Apply();
+    void Wait();
+
+    // Only touched by the worker, while InFlight
+    MaxQ::Data::FStarField Field;
+    TArray<FTransform> Transforms;
+    TFuture<void> InFlight;
+
+    TFuture<TSharedPtr<FLoaded, ESPMode::ThreadSafe>> Loading;
+
+    bool bStale = true;
+};
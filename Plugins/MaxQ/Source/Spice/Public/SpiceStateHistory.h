@@ -0,0 +1,134 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStateHistory.h
+//
+// API Comments
+//
+// Purpose:  A compressed history of many objects' states, for scrubbing.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStateHistory.h is part of the "refined C++ API".
+//
+// Scrubbing a timeline backward means evaluating SPICE or SGP4 for every
+// object at every position the scrubber lands on.  FStateHistory records the
+// states of a batch (a catalog, a subsystem snapshot) as they're computed
+// going forward, and gives them back for any time it covers without
+// evaluating anything but a two-body prediction.
+//
+// Slices are grouped into blocks.  A block's first slice (its key) is kept
+// at full precision.  Its other slices are kept as each object's residual
+// from the two-body propagation (FTwoBodyBatchPropagator) of its key state:
+// six int16s, quantized by PositionQuantum and VelocityQuantum.  That's 12
+// bytes an object a slice instead of 48, and decoding a slice needs nothing
+// but its block's key:  any slice can be decoded independently, and each
+// decode is parallel across the objects.  Objects whose residuals don't fit
+// (maneuvers, a bad GM for them, a failed prediction) are kept at full
+// precision in that slice instead.
+//
+// Decoded states are within half a quantum of what was recorded.  Sample
+// interpolates between the two slices around a time with cubic Hermite
+// polynomials (positions and velocities), so scrubbing between slices is
+// smooth.
+//
+// Nothing here calls CSPICE.  Record from one thread;  any number of
+// threads may decode at once, but not while a Record is in progress.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceTwoBody.h"
+
+namespace MaxQ::Orbits
+{
+    struct FStateHistorySettings
+    {
+        // Ephemeris seconds between slices (see IsDue)
+        double Interval = 10.;
+
+        // Slices per block, including the key
+        int32 BlockLength = 32;
+
+        // Residual resolution, km and km/s.  A residual of more than 32767
+        // quanta is kept at full precision.
+        double PositionQuantum = 1.e-4;
+        double VelocityQuantum = 1.e-6;
+
+        // The predictions' central body, km^3/s^2 (default:  the Earth)
+        double GM = 398600.435436;
+
+        // Slices kept:  the oldest blocks are dropped to stay under it
+        // (0:  everything's kept)
+        int32 MaxSlices = 0;
+    };
+
+    class SPICE_API FStateHistory
+    {
+    public:
+        explicit FStateHistory(const FStateHistorySettings& Settings = FStateHistorySettings());
+        ~FStateHistory();
+
+        void Reset();
+
+        // True if et is at least Interval past the last slice (or there's
+        // none yet)
+        bool IsDue(double et) const;
+
+        // A slice at et, which must be later than the last.  Every slice has
+        // the same number of objects as the first.  States at et (km,
+        // km/s), and optionally which of them are valid:  invalid ones
+        // decode as zero.  Returns false if nothing was recorded.
+        bool Record(double et, TArrayView<const FSStateVector> States, TArrayView<const bool> Valid = {});
+
+        // The states at a recorded slice's time.  OutStates must have Num()
+        // entries.
+        bool DecodeSlice(int32 Slice, TArrayView<FSStateVector> OutStates) const;
+
+        // The states at et, interpolated between the slices around it.
+        // False if et isn't within [GetStart(), GetEnd()].
+        bool Sample(double et, TArrayView<FSStateVector> OutStates) const;
+
+        // Objects per slice
+        int32 Num() const { return NumObjects; }
+        int32 NumSlices() const { return TotalSlices; }
+        double GetSliceTime(int32 Slice) const;
+        double GetStart() const;
+        double GetEnd() const;
+
+        // Slices (since the last Reset) that fell back to full precision,
+        // summed over their objects
+        int64 NumEscapes() const { return Escapes; }
+
+        SIZE_T GetAllocatedSize() const;
+
+    private:
+        struct FBlock;
+
+        // Drops the oldest blocks, down to MaxSlices
+        void Trim();
+
+        // Predictor:  built from the block's key (unused for the key itself)
+        void DecodeBlockSlice(const FBlock& Block, const FTwoBodyBatchPropagator& Predictor, int32 Index, TArrayView<FSStateVector> OutStates) const;
+
+        FStateHistorySettings Settings;
+        TArray<TUniquePtr<FBlock>> Blocks;
+        int32 NumObjects = 0;
+        int32 TotalSlices = 0;
+        int64 Escapes = 0;
+
+        // The last block's, for Record
+        FTwoBodyBatchPropagator Predictor;
+        TArray<FSStateVector> Predicted;
+    };
+}
@@ -0,0 +1,191 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceStateStream.h
+//
+// API Comments
+//
+// Purpose:  Live state vector telemetry, interpolated at render rate.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceStateStream.h is part of the "refined C++ API".
+//
+// An external simulator (or a ground system) sends states at a few Hz, and
+// a game wants positions every frame.  FStateStream keeps the most recent
+// states of each object in a ring buffer, and interpolates them with the
+// Hermite polynomials hrmint_c (and SPK type 13) use, so velocities are
+// honored between samples.  Nothing here calls CSPICE, so states can be
+// ingested on a network thread, and interpolated on any thread, while the
+// executor owns CSPICE.
+//
+// Each object has one writer (the thread ingesting its states) and any
+// number of readers.  The ring buffers are lock-free:  a reader copies the
+// samples it needs and retries if the writer lapped it meanwhile.  Adding
+// an object takes a lock, pushing and interpolating don't.
+//
+// FStateStreamReceiver listens on a UDP port for the packet layout below,
+// and feeds an FStateStream from its own thread.  A stream can also tee an
+// object's states to an FSpkSegmentWriter (see SpiceSpkWriter.h) to record
+// them as an SPK.
+//
+// Packets (little endian):
+//    uint32 Magic ('MXQS') | uint16 Version (1) | uint16 Count |
+//    Count * { int32 ObjectId | double et (TDB) | double state[6] (km, km/s) }
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "HAL/CriticalSection.h"
+#include "Templates/SharedPointer.h"
+#include <atomic>
+
+class FSocket;
+class FUdpSocketReceiver;
+
+namespace MaxQ::Ephemeris
+{
+    class FSpkSegmentWriter;
+
+    struct FStateStreamSettings
+    {
+        // States kept per object (rounded up to a power of 2)
+        int32 Capacity = 64;
+
+        // Samples per interpolation.  The Hermite polynomial is of degree
+        // 2 * Window - 1 (Window = 4:  degree 7, as type 13's default).
+        int32 Window = 4;
+
+        // Past the newest state, positions follow its velocity for at most
+        // this long.  Interpolate fails after that.
+        double MaxExtrapolationSeconds = 1.;
+    };
+
+    // One object's states
+    class SPICE_API FStateRingBuffer
+    {
+    public:
+        explicit FStateRingBuffer(const FStateStreamSettings& Settings = FStateStreamSettings());
+
+        // Writer only.  Epochs must increase:  a state that isn't newer than
+        // the newest one (a duplicate or out of order datagram) is dropped.
+        bool Push(double et, const double(&state)[6]);
+
+        // Any thread.  False if et precedes the oldest state kept, or is
+        // past the newest one by more than MaxExtrapolationSeconds.
+        bool Interpolate(double et, double(&state)[6], bool* bExtrapolated = nullptr) const;
+        bool Interpolate(const FSEphemerisTime& et, FSStateVector& state, bool* bExtrapolated = nullptr) const;
+
+        // The newest state
+        bool Latest(double& et, double(&state)[6]) const;
+
+        uint64 NumPushed() const { return Head.load(std::memory_order_acquire); }
+        uint64 NumDropped() const { return Dropped.load(std::memory_order_relaxed); }
+        int32 Capacity() const { return Samples.Num(); }
+
+    private:
+        struct FSample
+        {
+            double et;
+            double state[6];
+        };
+
+        // Copies the newest Count samples (of those kept) into Out
+        int32 Snapshot(FSample* Out, int32 Count, double et) const;
+
+        FStateStreamSettings Settings;
+        TArray<FSample> Samples;
+        uint64 Mask = 0;
+
+        // Samples [Head - Capacity, Head) are published.  Claimed is one past
+        // the sample being written.
+        std::atomic<uint64> Head { 0 };
+        std::atomic<uint64> Claimed { 0 };
+        std::atomic<uint64> Dropped { 0 };
+        double NewestEt = TNumericLimits<double>::Lowest();
+    };
+
+
+    class SPICE_API FStateStream
+    {
+    public:
+        explicit FStateStream(const FStateStreamSettings& Settings = FStateStreamSettings());
+        ~FStateStream();
+
+        // The writer of ObjectId.  The first state of an object adds it.
+        bool Push(int32 ObjectId, double et, const double(&state)[6]);
+        bool Push(int32 ObjectId, const FSEphemerisTime& et, const FSStateVector& state);
+
+        // Every state in a packet (layout above).  Returns the number of
+        // states accepted, or INDEX_NONE if the packet is malformed.
+        int32 Ingest(TArrayView<const uint8> Packet);
+
+        // Any thread
+        bool Interpolate(int32 ObjectId, double et, double(&state)[6], bool* bExtrapolated = nullptr) const;
+        bool Interpolate(int32 ObjectId, const FSEphemerisTime& et, FSStateVector& state, bool* bExtrapolated = nullptr) const;
+
+        // A reader can keep an object's buffer, and skip the lookup
+        TSharedPtr<const FStateRingBuffer, ESPMode::ThreadSafe> Find(int32 ObjectId) const;
+        TArray<int32> ObjectIds() const;
+
+        // ObjectId's states also go to Writer, which must have been begun
+        // (with bUseExecutor, if CSPICE is owned by the executor).  Nullptr
+        // stops recording.  Writer->Add is called by ObjectId's writer
+        // thread;  End the writer after recording is stopped.
+        void Record(int32 ObjectId, TSharedPtr<FSpkSegmentWriter, ESPMode::ThreadSafe> Writer);
+
+        FStateStream(const FStateStream&) = delete;
+        FStateStream& operator=(const FStateStream&) = delete;
+
+    private:
+        struct FObject
+        {
+            TSharedPtr<FStateRingBuffer, ESPMode::ThreadSafe> Buffer;
+            TSharedPtr<FSpkSegmentWriter, ESPMode::ThreadSafe> Recorder;
+        };
+
+        FStateStreamSettings Settings;
+        mutable FRWLock Lock;
+        TMap<int32, FObject> Objects;
+    };
+
+
+    class SPICE_API FStateStreamReceiver
+    {
+    public:
+        explicit FStateStreamReceiver(FStateStream& Stream);
+        ~FStateStreamReceiver();
+
+        // Listens on Port (all interfaces), until Stop
+        bool Start(
+            int32 Port,
+            ES_ResultCode* ResultCode = nullptr,
+            FString* ErrorMessage = nullptr
+        );
+        void Stop();
+
+        bool IsRunning() const { return Receiver.IsValid(); }
+        uint64 NumPackets() const { return Packets.load(std::memory_order_relaxed); }
+        uint64 NumMalformed() const { return Malformed.load(std::memory_order_relaxed); }
+
+        FStateStreamReceiver(const FStateStreamReceiver&) = delete;
+        FStateStreamReceiver& operator=(const FStateStreamReceiver&) = delete;
+
+    private:
+        FStateStream& Stream;
+        FSocket* Socket = nullptr;
+        TUniquePtr<FUdpSocketReceiver> Receiver;
+        std::atomic<uint64> Packets { 0 };
+        std::atomic<uint64> Malformed { 0 };
+    };
+}
@@ -21,6 +21,7 @@
 #include "CoreMinimal.h"
 #include "SpicePlatformDefs.h"
 #include "SpiceEnums.h"
+#include <type_traits>
 #include "SpiceStructs.generated.h"
 
 USTRUCT(BlueprintType, Category = "MaxQ|DimensionlessVector")
@@ -91,6 +92,11 @@ struct SPICE_API FSDimensionlessVector
 
     double Magnitude() const;
 
+    // In-place view as SpiceDouble[3], to pass straight to CSPICE (see the
+    // layout checks at the end of this file)
+    inline auto& AsSpiceDoubleArray() { return *reinterpret_cast<double(*)[3]>(this); }
+    inline const auto& AsSpiceDoubleArray() const { return *reinterpret_cast<const double(*)[3]>(this); }
+
     FString ToString() const;
 
     static const FSDimensionlessVector Zero;
@@ -279,6 +285,11 @@ struct SPICE_API FSDistanceVector
 
     double f() const;
 
+    // In-place view as SpiceDouble[3], to pass straight to CSPICE (see the
+    // layout checks at the end of this file)
+    inline auto& AsSpiceDoubleArray() { return *reinterpret_cast<double(*)[3]>(this); }
+    inline const auto& AsSpiceDoubleArray() const { return *reinterpret_cast<const double(*)[3]>(this); }
+
     FString ToString() const;
 
     // IMPORTANT!:
@@ -680,6 +691,11 @@ struct SPICE_API FSVelocityVector
         return FSDimensionlessVector(dx.AsKilometersPerSecond(), dy.AsKilometersPerSecond(), dz.AsKilometersPerSecond());
     }
 
+    // In-place view as SpiceDouble[3], to pass straight to CSPICE (see the
+    // layout checks at the end of this file)
+    inline auto& AsSpiceDoubleArray() { return *reinterpret_cast<double(*)[3]>(this); }
+    inline const auto& AsSpiceDoubleArray() const { return *reinterpret_cast<const double(*)[3]>(this); }
+
     FString ToString() const;
 
     inline void CopyTo(double(&xyz)[3]) const
@@ -868,6 +884,11 @@ struct SPICE_API FSAngularVelocity
         return FSDimensionlessVector(x.AsRadiansPerSecond(), y.AsRadiansPerSecond(), z.AsRadiansPerSecond());
     }
 
+    // In-place view as SpiceDouble[3], to pass straight to CSPICE (see the
+    // layout checks at the end of this file)
+    inline auto& AsSpiceDoubleArray() { return *reinterpret_cast<double(*)[3]>(this); }
+    inline const auto& AsSpiceDoubleArray() const { return *reinterpret_cast<const double(*)[3]>(this); }
+
     FString ToString() const;
 
     static FSAngularVelocity FromRadiansPerSecond(const FSDimensionlessVector& RadsPerSec)
@@ -1052,6 +1073,11 @@ struct SPICE_API FSDimensionlessStateVector
         dr = FSDimensionlessVector(_dr);
     }
 
+    // In-place view as SpiceDouble[6], to pass straight to CSPICE (see the
+    // layout checks at the end of this file)
+    inline auto& AsSpiceDoubleArray() { return *reinterpret_cast<double(*)[6]>(this); }
+    inline const auto& AsSpiceDoubleArray() const { return *reinterpret_cast<const double(*)[6]>(this); }
+
     FString ToString() const;
 };
 
@@ -1120,6 +1146,11 @@ struct SPICE_API FSStateVector
         return vector;
     }
 
+    // In-place view as SpiceDouble[6], to pass straight to CSPICE (see the
+    // layout checks at the end of this file)
+    inline auto& AsSpiceDoubleArray() { return *reinterpret_cast<double(*)[6]>(this); }
+    inline const auto& AsSpiceDoubleArray() const { return *reinterpret_cast<const double(*)[6]>(this); }
+
     FString ToString() const;
 };
 
@@ -2002,6 +2033,10 @@ struct SPICE_API FSStateTransform
     }
 
     static const FSStateTransform Identity;
+    // In-place view of m's rows as SpiceDouble[6][6]
+    inline auto& AsSpiceDoubleArray() { check(m.Num() == 6); return *reinterpret_cast<double(*)[6][6]>(m.GetData()); }
+    inline const auto& AsSpiceDoubleArray() const { check(m.Num() == 6); return *reinterpret_cast<const double(*)[6][6]>(m.GetData()); }
+
     FString ToString() const;
 };
 
@@ -2056,6 +2091,10 @@ struct SPICE_API FSRotationMatrix
     }
 
     static const FSRotationMatrix Identity;
+    // In-place view of m's rows as SpiceDouble[3][3]
+    inline auto& AsSpiceDoubleArray() { check(m.Num() == 3); return *reinterpret_cast<double(*)[3][3]>(m.GetData()); }
+    inline const auto& AsSpiceDoubleArray() const { check(m.Num() == 3); return *reinterpret_cast<const double(*)[3][3]>(m.GetData()); }
+
     FString ToString() const;
 };
 
@@ -3427,3 +3466,124 @@ public:
     FString ToString() const;
 };
 
+
+
+class FSpiceQueryHandle;
+
+// Blueprint wrapper for FSpiceQueryHandle (see SpiceQueryHandle.h)
+// Create with USpice::spk_compile_query, then use with spkezr_query, etc.
+USTRUCT(BlueprintType)
+struct SPICE_API FSEphemerisQuery
+{
+    GENERATED_BODY()
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ") int targ;
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ") int obs;
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ") FString ref;
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ") ES_AberrationCorrectionWithNewtonians abcorr;
+
+    // Not serialized.  A query has to be recompiled after it's loaded.
+    TSharedPtr<const FSpiceQueryHandle> Handle;
+
+public:
+
+    FSEphemerisQuery()
+    {
+        targ = 0;
+        obs = 0;
+        ref = FString();
+        abcorr = ES_AberrationCorrectionWithNewtonians::None;
+    }
+
+    bool IsValid() const { return Handle.IsValid(); }
+};
+
+
+// A catalog of two-line element sets, stored by column (structure of arrays):
+// Columns[FSTwoLineElements::XNO] holds every object's mean motion, etc.
+// One allocation per column instead of one per object.
+// Filled by MaxQ::Orbits::ParseTLECatalog (see SpiceTLECatalog.h).
+USTRUCT(BlueprintType)
+struct SPICE_API FSTLECatalog
+{
+    GENERATED_BODY()
+
+    // NORAD catalog numbers
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ") TArray<FString> ObjectIds;
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MaxQ") TArray<FString> ObjectNames;
+
+    // Cache line aligned, for batched (SIMD) loads
+    TArray<double, TAlignedHeapAllocator<64>> Columns[10];
+
+public:
+
+    FSTLECatalog()
+    {
+    }
+
+    int32 Num() const { return ObjectIds.Num(); }
+    bool IsEmpty() const { return ObjectIds.Num() == 0; }
+    void Reset();
+    void Reserve(int32 Number);
+    SIZE_T GetAllocatedSize() const;
+
+    int32 Add(const FString& ObjectId, const FString& ObjectName, const double(&_elems)[10]);
+    void Append(const FSTLECatalog& Other);
+
+    const double* Column(int32 Element) const { return Columns[Element].GetData(); }
+    void CopyTo(int32 Index, double(&_elems)[10]) const;
+    FSTwoLineElements GetElements(int32 Index) const;
+    FSEphemerisTime GetEpoch(int32 Index) const { return FSEphemerisTime(Columns[FSTwoLineElements::EPOCH][Index]); }
+};
+
+
+// Layout guarantees
+// The vector structs are nothing but doubles, in SPICE order.  So, they can be
+// handed to CSPICE in place (AsSpiceDoubleArray), and arrays of them can be
+// viewed as SpiceDouble buffers (and vice versa) without copying.
+#define MAXQ_SPICE_DOUBLE_LAYOUT(Type, N) \
+    static_assert(std::is_standard_layout_v<Type> && sizeof(Type) == (N) * sizeof(double) && alignof(Type) == alignof(double), #Type " must be layout compatible with SpiceDouble[" #N "]");
+
+MAXQ_SPICE_DOUBLE_LAYOUT(FSDimensionlessVector, 3)
+MAXQ_SPICE_DOUBLE_LAYOUT(FSDistanceVector, 3)
+MAXQ_SPICE_DOUBLE_LAYOUT(FSVelocityVector, 3)
+MAXQ_SPICE_DOUBLE_LAYOUT(FSAngularVelocity, 3)
+MAXQ_SPICE_DOUBLE_LAYOUT(FSDimensionlessStateVector, 6)
+MAXQ_SPICE_DOUBLE_LAYOUT(FSStateVector, 6)
+
+#undef MAXQ_SPICE_DOUBLE_LAYOUT
+
+static_assert(offsetof(FSDimensionlessVector, z) == 2 * sizeof(double));
+static_assert(offsetof(FSDistanceVector, z) == 2 * sizeof(double));
+static_assert(offsetof(FSVelocityVector, dz) == 2 * sizeof(double));
+static_assert(offsetof(FSStateVector, v) == 3 * sizeof(double));
+static_assert(offsetof(FSDimensionlessStateVector, dr) == 3 * sizeof(double));
+
+namespace MaxQ::Core
+{
+    // Number of SpiceDoubles in one FS* vector
+    template<class SpiceStructType>
+    constexpr int32 SpiceDoubleCount = sizeof(SpiceStructType) / sizeof(double);
+
+    template<class SpiceStructType>
+    using TSpiceDoubleOf = std::conditional_t<std::is_const_v<SpiceStructType>, const double, double>;
+
+    // Views a SpiceDouble buffer (eg states[n][6] from CSPICE) as FS* vectors
+    // (ViewAs<FSStateVector>, or ViewAs<const FSStateVector> for a const
+    // buffer).  The buffer's length must be a multiple of the vector's.
+    template<class SpiceStructType>
+    inline TArrayView<SpiceStructType> ViewAs(TArrayView<TSpiceDoubleOf<SpiceStructType>> Buffer)
+    {
+        constexpr int32 N = SpiceDoubleCount<std::remove_const_t<SpiceStructType>>;
+        check(Buffer.Num() % N == 0);
+        return TArrayView<SpiceStructType>(reinterpret_cast<SpiceStructType*>(Buffer.GetData()), Buffer.Num() / N);
+    }
+
+    // ...and the reverse, FS* vectors as a flat SpiceDouble buffer
+    template<class SpiceStructType>
+    inline TArrayView<TSpiceDoubleOf<SpiceStructType>> AsSpiceDoubles(TArrayView<SpiceStructType> Vectors)
+    {
+        constexpr int32 N = SpiceDoubleCount<std::remove_const_t<SpiceStructType>>;
+        return TArrayView<TSpiceDoubleOf<SpiceStructType>>(reinterpret_cast<TSpiceDoubleOf<SpiceStructType>*>(Vectors.GetData()), Vectors.Num() * N);
+    }
+}
@@ -0,0 +1,127 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTLEBake.h
+//
+// API Comments
+//
+// Purpose:  TLE catalogs baked into SPK files, for replay.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTLEBake.h is part of the "refined C++ API".
+//
+// Replaying a catalog's history runs SGP4 for every object every frame,
+// when what's wanted is a fixed trajectory.  BakeTLECatalog writes the
+// catalog into an SPK instead, one body per object, so playback can use the
+// ephemeris batch and cache paths (SpkezrBatch, FChebyshevCache) like
+// any other SPK.
+//
+// Type 10 segments (spkw10) hold the element sets themselves, so they're
+// small and exact, but every evaluation still runs SGP4 (twice, between
+// element sets).  Type 02/03 segments are Chebyshev fits of SGP4 states
+// sampled every SampleSeconds, which take more room but evaluate with a
+// handful of multiplies.
+//
+// States are relative to the Earth (399), in J2000, as CSPICE's type 10
+// evaluator gives them:  the Chebyshev bake rotates SGP4's TEME states with
+// the same transformation (zzteme).  Objects are NAIF's TLE bodies,
+// -100000 - NORAD catalog number.  An object with several element sets in
+// the catalog gets them all in its type 10 segment (CSPICE blends between
+// them);  its Chebyshev fit uses whichever set's epoch is closest.
+//
+// Baking calls CSPICE (spkw.., and zzteme to sample), so call it from the
+// SPICE thread.  The fits run in parallel.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceSpkWriter.h"
+
+namespace MaxQ::Orbits
+{
+    enum class ETLEBakeType : uint8
+    {
+        // Element sets (spkw10)
+        Type10 = 10,
+        // Chebyshev fit, positions
+        Type02 = 2,
+        // Chebyshev fit, positions and velocities
+        Type03 = 3
+    };
+
+    struct FTLEBakeSettings
+    {
+        ETLEBakeType Type = ETLEBakeType::Type10;
+
+        // Chebyshev types:  SGP4 is sampled this often...
+        double SampleSeconds = 60.;
+
+        // ...and fit to this (Fit.Type follows Type)
+        MaxQ::Ephemeris::FSpkChebyshevFitSettings Fit;
+
+        // Objects fit at a time (bounds the memory the samples take)
+        int32 BatchSize = 256;
+    };
+
+    struct SPICE_API FTLEBakedObject
+    {
+        int32 Body = 0;
+        FString SegmentId;
+        // Catalog entries, by increasing epoch
+        TArray<int32> Entries;
+        // Chebyshev types only
+        TArray<MaxQ::Ephemeris::FSpkChebyshevSegment> Segments;
+    };
+
+    // -100000 - NORAD catalog number.  0 if ObjectId isn't a number.
+    SPICE_API int32 TLEBodyId(const FString& ObjectId);
+
+    // The catalog's entries, grouped by object.  Entries whose ObjectId
+    // isn't a number are skipped (with an error).
+    SPICE_API void GroupTLEObjects(
+        const FSTLECatalog& Catalog,
+        TArray<FTLEBakedObject>& Objects,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Fits Objects' Segments over [Start, Stop], without writing them.
+    // Objects that fail to propagate (decayed) are fit up to the failure,
+    // or left without segments.
+    SPICE_API bool FitTLEObjects(
+        const FSTLECatalog& Catalog,
+        const FSTLEGeophysicalConstants& geophs,
+        TArrayView<FTLEBakedObject> Objects,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        const FTLEBakeSettings& Settings = FTLEBakeSettings(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // Writes every object into handle (an SPK open for writing:  spkopn,
+    // spkopa), covering [Start, Stop].  Returns the number of objects
+    // written.  Objects that can't be written are skipped, and the first
+    // failure is reported.
+    SPICE_API int32 BakeTLECatalog(
+        int handle,
+        const FSTLECatalog& Catalog,
+        const FSTLEGeophysicalConstants& geophs,
+        const FSEphemerisTime& Start,
+        const FSEphemerisTime& Stop,
+        const FTLEBakeSettings& Settings = FTLEBakeSettings(),
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
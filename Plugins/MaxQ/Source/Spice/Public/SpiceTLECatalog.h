@@ -0,0 +1,71 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTLECatalog.h
+//
+// API Comments
+//
+// Purpose:  Bulk parsing of Celestrak/Space-Track element sets into a
+// FSTLECatalog.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTLECatalog.h is part of the "refined C++ API".
+//
+// getelm_c parses one element set per call, on the calling thread, and
+// converts the epoch with CSPICE as it goes.  ParseTLECatalog parses an
+// entire response (2 or 3 line TLE text, or OMM JSON as served by Celestrak's
+// GP queries) natively, in parallel chunks.  The elements are the same as
+// getelm's (units, ranges, etc).  Only the final UTC -> TDB epoch
+// conversion goes through CSPICE (deltet_c), so a leapseconds kernel must be
+// loaded, and ParseTLECatalog must be called from the SPICE thread.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+
+namespace MaxQ::Orbits
+{
+    enum class ETLECatalogFormat : uint8
+    {
+        // JSON if the text starts with '[' or '{', otherwise TLE
+        Auto,
+        // "1 ..." / "2 ..." line pairs, optionally preceded by a name line
+        TLE,
+        // Array of OMM objects (Celestrak FORMAT=JSON)
+        OMMJson
+    };
+
+    // Appends every element set in Text to Catalog.  Returns the number added.
+    // Element sets that don't parse are skipped; if there were any, an error
+    // is signalled naming the first of them, but the rest are still added.
+    // frstyr as getelm:  the first year two-digit years map to.
+    SPICE_API int32 ParseTLECatalog(
+        const FString& Text,
+        FSTLECatalog& Catalog,
+        ETLECatalogFormat Format = ETLECatalogFormat::Auto,
+        int32 frstyr = 1957,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+
+    // One SGP4 propagator per catalog entry (see SpiceSGP4.h)
+    SPICE_API void InitPropagators(
+        const FSTLECatalog& Catalog,
+        const FSTLEGeophysicalConstants& geophs,
+        TArray<FSGP4Propagator>& Propagators,
+        ES_ResultCode* ResultCode = nullptr,
+        FString* ErrorMessage = nullptr
+    );
+}
@@ -0,0 +1,206 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTasks.h
+//
+// API Comments
+//
+// Purpose:  FSpiceExecutor commands as UE tasks, and as C++20 awaitables.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTasks.h is part of the "refined C++ API".
+//
+// Load kernels, then check coverage, then search, then evaluate a batch,
+// then build a mesh:  with TFutures that's a callback inside a callback, or
+// a thread blocked on each Get().  MaxQ::Async::Spice runs a command on the
+// executor thread and returns a UE task, which can be a prerequisite of
+// other tasks (native stages on the task graph, or more SPICE commands).
+// Nothing blocks while waiting:  the command is queued when its
+// prerequisites complete, and its task completes when the executor has run
+// it.  Stages that don't depend on each other overlap.
+//
+// Where the compiler has coroutines (C++20, MAXQ_WITH_COROUTINES), a
+// TSpiceTask can also be co_awaited, from a coroutine returning
+// FSpiceCoroutine:
+//
+//     FSpiceCoroutine Pipeline()
+//     {
+//         bool bLoaded = co_await MaxQ::Async::Furnsh(Path);
+//         auto State = co_await MaxQ::Async::Spkezr(et, Target, Observer, Frame);
+//         ...
+//     }
+//
+// The coroutine resumes on a task graph worker after each co_await, never on
+// the executor thread.  As with everything on the executor:  once it's
+// used, don't call CSPICE from other threads.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+#include "SpiceTypes.h"
+#include "SpiceName.h"
+#include "SpiceResult.h"
+#include "SpiceExecutor.h"
+
+#ifndef MAXQ_WITH_COROUTINES
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define MAXQ_WITH_COROUTINES 1
+#else
+#define MAXQ_WITH_COROUTINES 0
+#endif
+#endif
+
+#if MAXQ_WITH_COROUTINES
+#include <coroutine>
+#endif
+
+// A UE task, which can be co_awaited where coroutines are available.  Any
+// TTask can be made one, to await it.
+template<typename ResultType>
+class TSpiceTask : public UE::Tasks::TTask<ResultType>
+{
+public:
+    TSpiceTask() = default;
+    TSpiceTask(const UE::Tasks::TTask<ResultType>& Task) : UE::Tasks::TTask<ResultType>(Task) {}
+
+#if MAXQ_WITH_COROUTINES
+    bool await_ready() const
+    {
+        return this->IsCompleted();
+    }
+
+    void await_suspend(std::coroutine_handle<> Continuation) const
+    {
+        const UE::Tasks::TTask<ResultType>& Task = *this;
+        UE::Tasks::Launch(TEXT("MaxQ Resume"), [Continuation]() { Continuation.resume(); }, UE::Tasks::Prerequisites(Task));
+    }
+
+    ResultType await_resume()
+    {
+        if constexpr (!std::is_void_v<ResultType>)
+        {
+            return this->GetResult();
+        }
+    }
+#endif
+};
+
+
+#if MAXQ_WITH_COROUTINES
+// The return type of coroutines that co_await TSpiceTasks.  It starts
+// running at once, and its completion is an event other tasks can take as a
+// prerequisite.
+class FSpiceCoroutine
+{
+public:
+    struct promise_type
+    {
+        UE::Tasks::FTaskEvent Done{ TEXT("MaxQ Coroutine") };
+
+        FSpiceCoroutine get_return_object() { return FSpiceCoroutine(Done); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { Done.Trigger(); }
+        void unhandled_exception() { checkNoEntry(); }
+    };
+
+    const UE::Tasks::FTaskEvent& GetCompletion() const { return Done; }
+    bool IsCompleted() const { return Done.IsCompleted(); }
+    void Wait() const { Done.Wait(); }
+
+private:
+    explicit FSpiceCoroutine(const UE::Tasks::FTaskEvent& InDone) : Done(InDone) {}
+
+    UE::Tasks::FTaskEvent Done;
+};
+#endif
+
+
+namespace MaxQ::Async
+{
+    // Command runs on the FSpiceExecutor thread once Prerequisites (UE tasks
+    // or task events) are complete.  The task's result is Command's.
+    template<typename CommandType, typename PrerequisitesType>
+    auto Spice(CommandType&& Command, PrerequisitesType&& Prerequisites) -> TSpiceTask<decltype(Command())>
+    {
+        typedef decltype(Command()) ResultType;
+        typedef std::conditional_t<std::is_void_v<ResultType>, bool, ResultType> StoredType;
+
+        TSharedRef<TOptional<StoredType>, ESPMode::ThreadSafe> Result = MakeShared<TOptional<StoredType>, ESPMode::ThreadSafe>();
+        UE::Tasks::FTaskEvent Done(TEXT("MaxQ SPICE Command"));
+
+        // Queued (not run) by a task, so nothing waits on the prerequisites
+        UE::Tasks::Launch(TEXT("MaxQ Queue SPICE Command"),
+            [Result, Done, Command = Forward<CommandType>(Command)]() mutable
+            {
+                FSpiceExecutor::Get().EnqueueCommand(
+                    [Result, Done, Command = MoveTemp(Command)]() mutable
+                    {
+                        if constexpr (std::is_void_v<ResultType>)
+                        {
+                            Command();
+                            Result->Emplace(true);
+                        }
+                        else
+                        {
+                            Result->Emplace(Command());
+                        }
+                        Done.Trigger();
+                    }
+                );
+            },
+            Forward<PrerequisitesType>(Prerequisites)
+        );
+
+        return UE::Tasks::Launch(TEXT("MaxQ SPICE Result"),
+            [Result]() -> ResultType
+            {
+                if constexpr (!std::is_void_v<ResultType>)
+                {
+                    return MoveTemp(Result->GetValue());
+                }
+            },
+            UE::Tasks::Prerequisites(Done)
+        );
+    }
+
+    template<typename CommandType>
+    auto Spice(CommandType&& Command) -> TSpiceTask<decltype(Command())>
+    {
+        return Spice(Forward<CommandType>(Command), TArray<UE::Tasks::FTask>());
+    }
+
+    // MaxQ::Data::Furnsh
+    SPICE_API TSpiceTask<bool> Furnsh(const FString& relativePath, TArrayView<const UE::Tasks::FTask> Prerequisites = {});
+    SPICE_API TSpiceTask<bool> Furnsh(const TArray<FString>& relativePaths, TArrayView<const UE::Tasks::FTask> Prerequisites = {});
+
+    // MaxQ::Ephemeris::TrySpkezr
+    SPICE_API TSpiceTask<MaxQ::Core::TSpiceResult<FSStateVector>> Spkezr(
+        const FSEphemerisTime& et,
+        const FSpiceName& targ,
+        const FSpiceName& obs,
+        const FSpiceName& ref,
+        ES_AberrationCorrectionWithNewtonians abcorr = ES_AberrationCorrectionWithNewtonians::None,
+        TArrayView<const UE::Tasks::FTask> Prerequisites = {}
+    );
+
+    // MaxQ::Math::TryPxform
+    SPICE_API TSpiceTask<MaxQ::Core::TSpiceResult<FSRotationMatrix>> Pxform(
+        const FSEphemerisTime& et,
+        const FSpiceName& from,
+        const FSpiceName& to,
+        TArrayView<const UE::Tasks::FTask> Prerequisites = {}
+    );
+}
@@ -0,0 +1,344 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTime.h
+//
+// API Comments
+//
+// Purpose:  Native ET/UTC/TAI/TT conversion, formatting and parsing.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTime.h is part of the "refined C++ API".
+//
+// et2utc_c and str2et_c go through CSPICE's whole string pipeline, and look
+// up the leapseconds kernel's constants from the pool, on every call.
+//
+// FTimeSystem holds the LSK's constants (DELTET/DELTA_AT, DELTA_T_A, K, EB
+// and M), read from the pool once.  Conversions, formatting and parsing are
+// then plain C++.  A snapshot is immutable, so it can be used from any
+// thread;  GetTimeSystem hands out the current one.  UpdateTimeSystem takes a
+// new snapshot when the kernel pool has changed (it uses CSPICE, so call it
+// where you'd call CSPICE).
+//
+// Conventions are SPICE's.  Times are seconds past J2000 on their own scale.
+// ET is TDB.  "UTC" is seconds past 2000 JAN 01 12:00:00 UTC without leap
+// seconds (as deltet_c):  a leap second repeats the second before it, and
+// only the calendar formats can name it (23:59:60).
+//
+// FUtcClock is for clocks that redraw every frame.  It keeps the last text
+// and its decomposition, and rewrites only the digits that changed.
+//
+// FSclkConverter does the same for a spacecraft clock:  sct2e_c, sce2c_c and
+// scs2e_c look the SCLK kernel's partitions and coefficients up in the pool
+// on every call, FSclkConverter reads them once.  Only type 1 clocks (the
+// only type SPICE has) are supported.
+//
+// FEtClock is a monotonic ET clock.  It's anchored to an ET once (the wall
+// clock, through the LSK, or any epoch), then advances with
+// FPlatformTime::Seconds, at a rate.  GetEtClock is the engine-wide one:
+// the module samples it at the start of every frame, and GetFrameEt hands
+// that sample to any thread, without a lock.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+#include "HAL/CriticalSection.h"
+#include <atomic>
+
+namespace MaxQ::Time
+{
+    class FUtcClock;
+
+    // A UTC calendar epoch, with seconds rounded to a precision
+    struct FUtcCalendar
+    {
+        int32 Year = 2000;
+        int32 Month = 1;
+        int32 Day = 1;
+        int32 DayOfYear = 1;
+        int32 Hour = 12;
+        int32 Minute = 0;
+        // 60 during a leap second
+        int32 Second = 0;
+        // Fraction of a second, in units of 10^-Precision
+        int64 Fraction = 0;
+        int32 Precision = 0;
+    };
+
+    class SPICE_API FTimeSystem
+    {
+    public:
+        // Reads the LSK constants from the kernel pool.  Uses CSPICE.  The
+        // result is invalid if no LSK is loaded.
+        static TSharedRef<const FTimeSystem, ESPMode::ThreadSafe> FromKernelPool();
+
+        bool IsValid() const { return LeapEpochs.Num() > 0; }
+
+        // ET - UTC, as deltet_c.  bEpochIsEt: epoch is ET, else it's UTC.
+        double DeltaEt(double epoch, bool bEpochIsEt) const;
+
+        double EtToUtc(double et) const { return et - DeltaEt(et, true); }
+        double UtcToEt(double utc) const { return utc + DeltaEt(utc, false); }
+        double EtToTt(double et) const;
+        double TtToEt(double tt) const;
+        double EtToTai(double et) const { return EtToTt(et) - DeltaTA; }
+        double TaiToEt(double tai) const { return TtToEt(tai + DeltaTA); }
+
+        // TAI - UTC at a UTC epoch
+        double DeltaAt(double utc) const;
+
+        // Calendar decomposition, leap seconds included.  Precision is
+        // digits after the decimal point, [0, 14].  False outside the years
+        // 1583-9999 (the Gregorian calendar, for et2utc_c's purposes).
+        bool Decompose(double et, int32 Precision, FUtcCalendar& Out) const;
+
+        // As et2utc_c.  Precision is digits after the decimal point (of the
+        // seconds, or of the day for JulianDate).  Writes a terminated string
+        // and returns its length, or 0 if it can't (see Decompose).
+        int32 Format(double et, ES_UTCTimeFormat TimeFormat, int32 Precision, TCHAR* Buffer, int32 BufferLen) const;
+        bool Format(double et, ES_UTCTimeFormat TimeFormat, int32 Precision, FString& Out) const;
+
+        // Formats a decomposed epoch (ISOCalendar, etc).  JulianDate isn't a
+        // calendar format:  returns 0.
+        static int32 Format(const FUtcCalendar& Calendar, ES_UTCTimeFormat TimeFormat, TCHAR* Buffer, int32 BufferLen);
+
+        // Parses UTC in exactly these forms (what Format and
+        // FSEphemerisTime::ToString write):
+        //    2022-09-23T18:45:01.500     (ISO calendar)
+        //    2022-266T18:45:01.500       (ISO day-of-year)
+        //    2022 SEP 23 18:45:01.500    (calendar, upper case)
+        // Two-digit fields, single spaces, seconds required, the fraction
+        // optional (up to 14 digits), and an optional trailing " UTC".
+        // False for anything else, to be handed to str2et_c.
+        bool Parse(const TCHAR* Str, double& et) const;
+
+        // The pool generation this was read at (MaxQ::Data::GetPoolGeneration)
+        uint64 GetPoolGeneration() const { return PoolGeneration; }
+
+    private:
+        friend class FUtcClock;
+
+        // Per DELTA_AT entry:  the UTC epoch it starts at, and TAI - UTC
+        // from then on.
+        TArray<double> LeapEpochs;
+        TArray<double> DeltaAts;
+
+        double DeltaTA = 32.184;
+        double K = 0.;
+        double EB = 0.;
+        double M[2] = { 0., 0. };
+
+        uint64 PoolGeneration = 0;
+    };
+
+    // The current snapshot.  Thread-safe, and never touches CSPICE.  Invalid
+    // until UpdateTimeSystem has found an LSK.
+    SPICE_API TSharedRef<const FTimeSystem, ESPMode::ThreadSafe> GetTimeSystem();
+
+    // Takes a new snapshot if the kernel pool has changed since the last one.
+    // Uses CSPICE (only when the pool has changed).  True if the current
+    // snapshot is valid.
+    SPICE_API bool UpdateTimeSystem();
+
+    // Formats a clock that's updated every frame, as FTimeSystem::Format
+    // would.  Within a second only the fraction's digits are rewritten,
+    // within a day only the time of day's.  Leap seconds, a new day, and
+    // the JulianDate format take the full path.
+    //
+    // Follows the current time system.  Update uses CSPICE (through
+    // UpdateTimeSystem) only when the kernel pool has changed, so use it
+    // where you'd use CSPICE.
+    class SPICE_API FUtcClock
+    {
+    public:
+        FUtcClock(ES_UTCTimeFormat InTimeFormat = ES_UTCTimeFormat::Calendar, int32 InPrecision = 4);
+
+        void SetFormat(ES_UTCTimeFormat InTimeFormat, int32 InPrecision);
+
+        // Renders et.  True if the text changed.  The text is empty if et
+        // can't be formatted, or no LSK is loaded.
+        bool Update(double et);
+
+        const TCHAR* GetText() const { return Text; }
+        int32 Len() const { return TextLen; }
+        FString ToString() const { return FString(TextLen, Text); }
+
+    private:
+        bool Render(double et);
+        void SetText(const TCHAR* NewText, int32 NewLen);
+
+        TSharedPtr<const FTimeSystem, ESPMode::ThreadSafe> TimeSystem;
+        ES_UTCTimeFormat TimeFormat;
+        int32 Precision;
+
+        // While TAI is in [SpanBegin, SpanEnd), UTC is TAI - Offset and no
+        // leap second is near.
+        bool bSpan = false;
+        double SpanBegin = 0.;
+        double SpanEnd = 0.;
+        double Offset = 0.;
+
+        // The displayed second, in UTC seconds past J2000, and its day
+        int64 Second = 0;
+        int64 Day = 0;
+        FUtcCalendar Calendar;
+
+        // Where "HH:MM:SS" starts in Text
+        int32 TimeStart = 0;
+
+        TCHAR Text[64] = { 0 };
+        int32 TextLen = 0;
+    };
+
+    // A spacecraft clock.  "Ticks" are encoded SCLK, as SPICE's:  ticks
+    // past the start of the first partition, counting only the partitions.
+    // Immutable, so it can be used from any thread.
+    class SPICE_API FSclkConverter
+    {
+    public:
+        // Reads clock Sc (the spacecraft ID, -82 etc) from the kernel pool.
+        // Uses CSPICE.  The result is invalid (with an error) if the clock
+        // isn't loaded, isn't type 1, or runs on TDT without an LSK.
+        static TSharedRef<const FSclkConverter, ESPMode::ThreadSafe> FromKernelPool(int32 Sc, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+        bool IsValid() const { return RecordTicks.Num() > 0; }
+        int32 GetSpacecraft() const { return Spacecraft; }
+        int32 NumPartitions() const { return PartitionStarts.Num(); }
+
+        // The last encoded SCLK of the last partition
+        double GetMaxTicks() const { return MaxTicks; }
+
+        // As sct2e_c and sce2c_c.  False outside [0, GetMaxTicks()].
+        bool TicksToEt(double Ticks, double& et) const;
+        bool EtToTicks(double et, double& Ticks) const;
+
+        // As scencd_c:  "[p/]f1.f2...", fields separated by any of . : - ,
+        // or spaces, missing trailing fields zero.  Without a partition,
+        // the first partition containing the count is used.
+        bool Encode(const TCHAR* Clock, double& Ticks) const;
+
+        // As scs2e_c
+        bool ClockToEt(const TCHAR* Clock, double& et) const;
+
+        // Whole arrays (Out must be at least as long as In).  Runs of
+        // increasing (or decreasing) times, as telemetry is, skip the record
+        // search.  Entries out of range are left as they were.  Returns the
+        // number converted.
+        int32 TicksToEt(TArrayView<const double> Ticks, TArrayView<double> Ets) const;
+        int32 EtToTicks(TArrayView<const double> Ets, TArrayView<double> Ticks) const;
+
+        // The pool generation this was read at (MaxQ::Data::GetPoolGeneration)
+        uint64 GetPoolGeneration() const { return PoolGeneration; }
+
+    private:
+        // Unchecked.  Hint is the coefficient record used last.
+        double ToEt(double Ticks, int32& Hint) const;
+        double ToTicks(double et, int32& Hint) const;
+
+        int32 Spacecraft = 0;
+
+        // Per field
+        TArray<double> Moduli;
+        TArray<double> Offsets;
+        // Weight of each field, in ticks
+        TArray<double> Weights;
+
+        // Per partition:  its first and last counts, and the encoded SCLK
+        // at its start
+        TArray<double> PartitionStarts;
+        TArray<double> PartitionEnds;
+        TArray<double> PartitionTicks;
+        double MaxTicks = 0.;
+
+        // Per coefficient record:  encoded SCLK, parallel time, and
+        // parallel seconds per tick
+        TArray<double> RecordTicks;
+        TArray<double> RecordTimes;
+        TArray<double> RecordRates;
+
+        // Set if parallel time is TDT
+        TSharedPtr<const FTimeSystem, ESPMode::ThreadSafe> TimeSystem;
+
+        uint64 PoolGeneration = 0;
+    };
+
+    // The converter for Sc, read again if the kernel pool has changed since
+    // it was.  Uses CSPICE (only when it reads the pool).
+    SPICE_API TSharedRef<const FSclkConverter, ESPMode::ThreadSafe> GetSclkConverter(int32 Sc, ES_ResultCode* ResultCode = nullptr, FString* ErrorMessage = nullptr);
+
+    class SPICE_API FEtClock
+    {
+    public:
+        // Anchors to FDateTime::UtcNow, converted with the LSK (through
+        // UpdateTimeSystem, so it uses CSPICE if the pool has changed).
+        // Without an LSK the anchor is UTC;  the engine-wide clock anchors
+        // again once one is loaded.
+        void AnchorToNow();
+
+        // Anchors to et, as of now
+        void Anchor(double et);
+
+        // ET seconds per second.  Takes effect from now, without a jump.
+        void SetRate(double Rate);
+        double GetRate() const;
+
+        bool IsAnchored() const { return bAnchored.load(std::memory_order_acquire); }
+
+        // False while anchored to the wall clock without an LSK
+        bool HasLeapSeconds() const { return !bNeedsLeapSeconds.load(std::memory_order_acquire); }
+
+        // The current ET.  Lock-free, any thread.  0 until anchored.
+        double Now() const;
+
+        // Samples Now as this frame's ET.  Once a frame, on the game
+        // thread;  the module does it for GetEtClock.
+        void BeginFrame();
+
+        // This frame's ET.  Lock-free, any thread, and the same all frame.
+        double GetFrameEt() const { return FrameEt.load(std::memory_order_acquire); }
+        uint64 GetFrameNumber() const { return FrameNumber.load(std::memory_order_acquire); }
+
+    private:
+        struct FAnchor
+        {
+            double Et = 0.;
+            double Seconds = 0.;
+            double Rate = 1.;
+        };
+
+        void AnchorToNow(const FTimeSystem& TimeSystem);
+
+        // A sequence lock:  writers serialize on WriteLock and make Sequence
+        // odd while they write, readers retry if it was odd or moved.
+        void Publish(const FAnchor& Anchor);
+        FAnchor Read() const;
+
+        FCriticalSection WriteLock;
+        std::atomic<uint32> Sequence{ 0 };
+        std::atomic<double> AnchorEt{ 0. };
+        std::atomic<double> AnchorSeconds{ 0. };
+        std::atomic<double> AnchorRate{ 1. };
+
+        std::atomic<bool> bAnchored{ false };
+        std::atomic<bool> bNeedsLeapSeconds{ false };
+
+        std::atomic<double> FrameEt{ 0. };
+        std::atomic<uint64> FrameNumber{ 0 };
+    };
+
+    // The engine-wide clock.  Anchored to the wall clock on MaxQ's first use
+    // (MaxQ::Core::EnsureInitialized);  from then on the Spice module calls
+    // BeginFrame at the start of every frame.
+    SPICE_API FEtClock& GetEtClock();
+}
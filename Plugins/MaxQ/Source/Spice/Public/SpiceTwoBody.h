@@ -0,0 +1,155 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceTwoBody.h
+//
+// API Comments
+//
+// Purpose:  Two-body (Keplerian) propagation and osculating elements of many
+// objects at once.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceTwoBody.h is part of the "refined C++ API".
+//
+// conics_c and prop2b_c propagate one object per call, through the SPICE
+// error system.  FTwoBodyBatchPropagator is a native universal-variable
+// propagator (the same formulation as prop2b) over structure-of-arrays
+// columns.  Objects are evaluated MAXQ_TWOBODY_LANES at a time, with
+// ParallelFor across the batch.  It doesn't touch CSPICE, so it's safe to call
+// from any thread.
+//
+// An optional rotation is applied to every output state, so a batch in one
+// frame can be viewed from another with a single pxform per frame instead of
+// one per object.
+//
+// Results agree with conics_c/prop2b_c to within 1e-6 km and 1e-9 km/s for
+// typical orbits.
+//
+// Prop2bBatch is prop2b_c for many states, each propagated by many offsets,
+// with the lanes across the offsets.  It can also return each propagation's
+// 6x6 state transition matrix (for covariance propagation, targeting, ...),
+// which is exact:  the universal Kepler equation's solution differentiated
+// with forward-mode dual numbers, not finite differences.
+//
+// OsceltBatch/OscltxBatch are oscelt_c/oscltx_c over arrays of states that
+// share an epoch and GM.  They're native ports, run in parallel chunks, with
+// no per-object error checking or message buffers.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+#ifndef MAXQ_TWOBODY_LANES
+#if defined(__AVX2__) || (defined(PLATFORM_ALWAYS_HAS_AVX_2) && PLATFORM_ALWAYS_HAS_AVX_2)
+#define MAXQ_TWOBODY_LANES 4
+#else
+// SSE2, NEON:  128 bit registers
+#define MAXQ_TWOBODY_LANES 2
+#endif
+#endif
+
+namespace MaxQ::Orbits
+{
+    class SPICE_API FTwoBodyBatchPropagator
+    {
+    public:
+        static constexpr int32 Lanes = MAXQ_TWOBODY_LANES;
+
+        // Replaces anything already built.  Entry i of the input is entry i
+        // of the propagation outputs.
+        // Conic elements as conics_c (each with its own epoch and GM).
+        void Build(TArrayView<const FSConicElements> Orbits);
+        // States as prop2b_c, all at the same epoch and around the same body.
+        void Build(const FSMassConstant& gm, TArrayView<const FSStateVector> States, const FSEphemerisTime& Epoch);
+        void Reset();
+
+        int32 Num() const { return NumObjects; }
+        // False for elements conics_c or prop2b_c would signal an error for
+        bool IsValid(int32 i) const { return Valid[i]; }
+        SIZE_T GetAllocatedSize() const;
+
+        // OutStates must have Num() entries.  Invalid entries are zeroed.
+        // If Rotation is given, it's applied to each position and velocity.
+        // Returns the number of objects propagated.
+        int32 Propagate(const FSEphemerisTime& et, TArrayView<FSStateVector> OutStates, const FSRotationMatrix* Rotation = nullptr) const;
+
+    private:
+        enum EColumn : int32
+        {
+            rx, ry, rz, vx, vy, vz,
+            // sqrt(mu), 1/a, |r0|, r0.v0, periapsis distance
+            sqrtmu, alpha, r0, rv, q,
+            // dt = (et - t0) + dt0, reduced modulo period if elliptic
+            t0, dt0, period,
+            NumColumns
+        };
+
+        double* Column(EColumn c) { return &Columns[c * Rows]; }
+        const double* Column(EColumn c) const { return &Columns[c * Rows]; }
+
+        void Allocate(int32 Num);
+        void SetRow(int32 Row, const double(&state)[6], double mu, double q, double t0, double dt0, double period);
+
+        // NumColumns x Rows, column-major.  Rows is a multiple of Lanes.
+        TArray<double> Columns;
+        int32 Rows = 0;
+
+        TArray<bool> Valid;
+        int32 NumObjects = 0;
+    };
+
+
+    // prop2b_c, for many states around one body, each propagated by many
+    // offsets.  Entry i * offsets.Num() + j of propagated (and stm) is
+    // states[i] propagated by offsets[j].  If stm isn't empty, it gets the
+    // state transition matrices d(propagated)/d(states[i]).  States prop2b_c
+    // would signal an error for get zeroed outputs;  valid[i] says which, if
+    // valid isn't empty.  Returns the number of states propagated.
+    // Thread-safe (no CSPICE).
+    SPICE_API int32 Prop2bBatch(
+        const FSMassConstant& gm,
+        TArrayView<const FSStateVector> states,
+        TArrayView<const FSEphemerisPeriod> offsets,
+        TArrayView<FSStateVector> propagated,
+        TArrayView<FSStateTransform> stm = {},
+        TArrayView<bool> valid = {}
+    );
+
+
+    // oscelt_c, for many states at one epoch around one body.  Returns the
+    // number converted.  States oscelt_c would signal an error for (zero
+    // position, velocity, or angular momentum) get zeroed elements; valid[i]
+    // says which, if valid isn't empty.  A non-positive gm converts nothing.
+    // Thread-safe (no CSPICE).
+    SPICE_API int32 OsceltBatch(
+        TArrayView<const FSStateVector> states,
+        const FSEphemerisTime& et,
+        const FSMassConstant& gm,
+        TArrayView<FSConicElements> elts,
+        TArrayView<bool> valid = {}
+    );
+
+    // oscltx_c:  as OsceltBatch, plus true anomaly, semi-major axis and period.
+    // nu, a and tau may each be empty, if the caller doesn't need them.
+    SPICE_API int32 OscltxBatch(
+        TArrayView<const FSStateVector> states,
+        const FSEphemerisTime& et,
+        const FSMassConstant& gm,
+        TArrayView<FSConicElements> elts,
+        TArrayView<FSAngle> nu,
+        TArrayView<FSDistance> a,
+        TArrayView<FSEphemerisPeriod> tau,
+        TArrayView<bool> valid = {}
+    );
+}
@@ -0,0 +1,125 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceWindow.h
+//
+// API Comments
+//
+// Purpose:  Native SPICE windows (sorted sets of disjoint time intervals).
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceWindow.h is part of the "refined C++ API".
+//
+// Window results are TArray<FSEphemerisTimeWindowSegment>, which have to be
+// rebuilt into a SPICE cell (one wninsd_c per interval) every time they're
+// passed to another gf search.  Chaining searches (visibility, then eclipse,
+// then elevation mask, for many stations) spends much of its time there.
+//
+// FSWindow stores its endpoints the way a SPICE double precision cell does:
+// one contiguous, sorted array, behind the cell's control area.  The gf
+// wrappers hand that storage straight to CSPICE (no copy), and the interval
+// algebra (the wn* routines) is native, so it's safe from any thread.
+//
+// Semantics follow the wn* routines they're named for:  intervals are
+// closed, and intervals that overlap or abut are merged.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpiceTypes.h"
+
+namespace MaxQ::Private
+{
+    class FWindowCell;
+}
+
+namespace MaxQ::GeometryFinder
+{
+    class SPICE_API FSWindow
+    {
+    public:
+        // Doubles ahead of the endpoints (SPICE_CELL_CTRLSZ)
+        static constexpr int32 CellControlSize = 6;
+
+        FSWindow();
+        // Intervals may be unsorted and overlapping (as wninsd_c)
+        FSWindow(TArrayView<const FSEphemerisTimeWindowSegment> Segments);
+        FSWindow(double Start, double Stop);
+
+        int32 Num() const { return (Storage.Num() - CellControlSize) / 2; }
+        bool IsEmpty() const { return Num() == 0; }
+        void Reset();
+        void Reserve(int32 Intervals);
+        SIZE_T GetAllocatedSize() const { return Storage.GetAllocatedSize(); }
+
+        double Start(int32 i) const { return Endpoints()[2 * i]; }
+        double Stop(int32 i) const { return Endpoints()[2 * i + 1]; }
+        FSEphemerisTimeWindowSegment operator[](int32 i) const { return FSEphemerisTimeWindowSegment(Start(i), Stop(i)); }
+
+        // [start0, stop0, start1, stop1, ...]
+        TArrayView<const double> Endpoints() const { return TArrayView<const double>(Storage.GetData() + CellControlSize, Storage.Num() - CellControlSize); }
+
+        TArray<FSEphemerisTimeWindowSegment> ToSegments() const;
+        // Into Segments, keeping its allocation
+        void ToSegments(TArray<FSEphemerisTimeWindowSegment>& Segments) const;
+
+        // wninsd.  Start > Stop inserts nothing.
+        void Insert(double Start, double Stop);
+
+        // wnsumd:  total measure
+        double Measure() const;
+        // wnelmd, wnincd
+        bool Contains(double et) const;
+        bool Contains(double Start, double Stop) const;
+
+        // wnunid, wnintd, wndifd
+        static FSWindow Union(const FSWindow& a, const FSWindow& b);
+        static FSWindow Intersection(const FSWindow& a, const FSWindow& b);
+        static FSWindow Difference(const FSWindow& a, const FSWindow& b);
+
+        // wncomd:  the gaps of the window within [Left, Right]
+        FSWindow Complement(double Left, double Right) const;
+
+        // wncond:  shrink each interval ([start + Left, stop - Right]).
+        // Intervals that vanish are removed.
+        void Contract(double Left, double Right);
+        // wnexpd:  grow each interval ([start - Left, stop + Right])
+        void Expand(double Left, double Right);
+
+        // wnfltd:  remove intervals of measure <= Small
+        void FilterSmall(double Small);
+        // wnfild:  fill gaps of measure <= Small
+        void FillSmall(double Small);
+
+        FSWindow operator|(const FSWindow& b) const { return Union(*this, b); }
+        FSWindow operator&(const FSWindow& b) const { return Intersection(*this, b); }
+        FSWindow operator-(const FSWindow& b) const { return Difference(*this, b); }
+
+        bool operator==(const FSWindow& b) const;
+        bool operator!=(const FSWindow& b) const { return !(*this == b); }
+
+    private:
+        friend class MaxQ::Private::FWindowCell;
+
+        // Appends an interval that starts at or after the last one, merging
+        // if they overlap or abut.
+        void Push(double Start, double Stop);
+        void MergeSorted();
+
+        double* MutableEndpoints() { return Storage.GetData() + CellControlSize; }
+
+        // CellControlSize doubles, then the endpoints.  It's kept that size:
+        // the capacity CSPICE sees is the TArray's slack.
+        TArray<double> Storage;
+    };
+}
@@ -17,6 +17,33 @@ public class Spice : ModuleRules
         PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine" });
         PrivateDependencyModuleNames.AddRange(new string[] { "CSpice_Library"});
 
+        // DSK shape models as static meshes (SpiceDskMesh.cpp)
+        PrivateDependencyModuleNames.AddRange(new string[] { "MeshDescription", "StaticMeshDescription" });
+
+        // Handing ephemeris snapshots to the render thread (SpiceEphemerisSubsystem.cpp)
+        PrivateDependencyModuleNames.Add("RenderCore");
+
+        // State vector telemetry over UDP (SpiceStateStream.cpp), remote queries
+        // over TCP (SpiceRemote.cpp)
+        PrivateDependencyModuleNames.AddRange(new string[] { "Sockets", "Networking" });
+
+        // Orbital gravity from a physics thread callback (SpiceOrbitalPhysics.cpp)
+        PrivateDependencyModuleNames.AddRange(new string[] { "Chaos", "PhysicsCore" });
+
+        if (Target.bBuildEditor)
+        {
+            // Kernel hot reload (SpiceKernelHotReload.cpp)
+            PrivateDependencyModuleNames.Add("DirectoryWatcher");
+
+            // Saving DSK meshes as assets (SpiceDskMesh.cpp)
+            PrivateDependencyModuleNames.Add("AssetRegistry");
+        }
+
         PublicDefinitions.Add("MAXQ_SPICE_MODULE=1");
+
+        // The prebuilt CSPICE is NAIF's toolkit.  Set to 1 when linking one
+        // built from ThirdParty's sources, which count file unit reopens
+        // (MaxQUnits.h, SpiceSegmentStats.cpp).
+        PrivateDefinitions.Add("MAXQ_CSPICE_UNIT_STATS=0");
     }
 }
\ No newline at end of file
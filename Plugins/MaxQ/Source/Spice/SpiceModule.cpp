@@ -8,6 +8,16 @@
 
 #include "SpiceModule.h"
 #include "Modules/ModuleManager.h"
+#include "SpiceCore.h"
+#include "SpiceExecutor.h"
+#include "SpiceLog.h"
+#include "SpiceProcessPool.h"
+#include "SpiceProfiling.h"
+#include "SpiceScheduler.h"
+#include "SpiceTime.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Parse.h"
 extern "C"
 {
 #include "SpiceUsr.h"
@@ -16,6 +26,9 @@ extern "C"
 
 // Ensure CSpice doesn't try to exit the process...
 // ...it's probably the UE editor, and that's just annoying.
+// At load, not in StartupModule, so anything linking the module without
+// starting it (e.g. the external tests) gets it too.  The rest of MaxQ's
+// setup waits for first use (MaxQ::Core::EnsureInitialized).
 class OnLoad
 {
 public:
@@ -27,5 +40,45 @@ public:
 };
 static OnLoad StaticInitializer;
 
+void FSpiceModule::StartupModule()
+{
+    // The engine-wide ET clock, sampled once at the start of every frame
+    // (once something has used it)
+    BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddLambda([]()
+    {
+        if (MaxQ::Core::IsInitialized())
+        {
+            MaxQ::Time::GetEtClock().BeginFrame();
+        }
+    });
+
+    // What the startup's kernel loads cost (SpiceProfiling.h)
+    if (FParse::Param(FCommandLine::Get(), TEXT("MaxQKernelReport")))
+    {
+        KernelReportHandle = FCoreDelegates::OnFEngineLoopInitComplete.AddLambda([]()
+        {
+            TArray<FString> Lines;
+            MaxQ::Data::GetKernelLoadReport().ParseIntoArrayLines(Lines, false);
+            for (const FString& Line : Lines)
+            {
+                UE_LOG(LogSpice, Display, TEXT("%s"), *Line);
+            }
+        });
+    }
+}
+
+void FSpiceModule::ShutdownModule()
+{
+    FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+    FCoreDelegates::OnFEngineLoopInitComplete.Remove(KernelReportHandle);
+
+    // Drain & join the executor thread and worker processes (if anyone
+    // started them) before CSPICE goes away with the module.  Scheduled jobs
+    // may be using either, so they finish first.
+    FSpiceScheduler::Shutdown();
+    FSpiceExecutor::Shutdown();
+    FSpiceProcessPool::Shutdown();
+}
+
 IMPLEMENT_MODULE(FSpiceModule, Spice);
 
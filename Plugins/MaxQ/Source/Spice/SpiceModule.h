@@ -25,5 +25,12 @@ public:
 	{
 		return FModuleManager::Get().IsModuleLoaded("Spice");
 	}
+
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+private:
+	FDelegateHandle BeginFrameHandle;
+	FDelegateHandle KernelReportHandle;
 };
 
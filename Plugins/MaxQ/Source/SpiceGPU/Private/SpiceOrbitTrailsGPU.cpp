@@ -0,0 +1,366 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceOrbitTrailsGPU.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Recent-history trails for thousands of objects, kept on the GPU.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceOrbitTrailsGPU.cpp is part of the "refined C++ API".
+//
+// The history is sample-major (slot * NumObjects + object), so a sample is
+// one contiguous copy into the ring.  The draw has no vertex buffer:  the
+// vertex shader (Shaders/Private/MaxQOrbitTrails.usf) finds its object from
+// the instance and its sample from the vertex id.
+//
+// Game thread calls queue their samples and settings for the render thread.
+// Queued samples are appended when the next view family starts rendering,
+// so each is appended once however many views there are, and drawn in each
+// view after motion blur, through the public post processing callbacks:  the
+// scene color there is still HDR, and its view rect comes with it.  Scene
+// depth is bound only when it matches scene color's extent (with temporal
+// upscaling, scene color is at output resolution by then, and depth isn't).
+//------------------------------------------------------------------------------
+
+#include "SpiceOrbitTrailsGPU.h"
+#include "CommonRenderResources.h"
+#include "GlobalShader.h"
+#include "PipelineStateCache.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "SceneView.h"
+#include "SceneViewExtension.h"
+#include "SceneTexturesConfig.h"
+#include "ScreenPass.h"
+#include "ShaderParameterStruct.h"
+#include "PostProcess/PostProcessMaterialInputs.h"
+
+namespace
+{
+    class FMaxQOrbitTrailsVS : public FGlobalShader
+    {
+    public:
+        DECLARE_GLOBAL_SHADER(FMaxQOrbitTrailsVS);
+        SHADER_USE_PARAMETER_STRUCT(FMaxQOrbitTrailsVS, FGlobalShader);
+
+        BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+            SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<float4>, History)
+            SHADER_PARAMETER(uint32, NumObjects)
+            SHADER_PARAMETER(uint32, NumSamples)
+            SHADER_PARAMETER(uint32, Head)
+            SHADER_PARAMETER(uint32, NumValid)
+            SHADER_PARAMETER(FVector3f, AnchorTranslated)
+            SHADER_PARAMETER(FMatrix44f, TranslatedWorldToClip)
+            SHADER_PARAMETER(FVector4f, Color)
+        END_SHADER_PARAMETER_STRUCT()
+
+        static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+        {
+            return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+        }
+    };
+
+    class FMaxQOrbitTrailsPS : public FGlobalShader
+    {
+    public:
+        DECLARE_GLOBAL_SHADER(FMaxQOrbitTrailsPS);
+
+        FMaxQOrbitTrailsPS() = default;
+        FMaxQOrbitTrailsPS(const ShaderMetaType::CompiledShaderInitializerType& Initializer) : FGlobalShader(Initializer) {}
+
+        static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+        {
+            return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+        }
+    };
+
+    IMPLEMENT_GLOBAL_SHADER(FMaxQOrbitTrailsVS, "/Plugin/MaxQ/Private/MaxQOrbitTrails.usf", "MainVS", SF_Vertex);
+    IMPLEMENT_GLOBAL_SHADER(FMaxQOrbitTrailsPS, "/Plugin/MaxQ/Private/MaxQOrbitTrails.usf", "MainPS", SF_Pixel);
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FMaxQOrbitTrailsPassParameters, )
+        SHADER_PARAMETER_STRUCT_INCLUDE(FMaxQOrbitTrailsVS::FParameters, VS)
+        RENDER_TARGET_BINDING_SLOTS()
+    END_SHADER_PARAMETER_STRUCT()
+}
+
+
+namespace MaxQ::Orbits
+{
+    FOrbitTrailHistoryGPU::FOrbitTrailHistoryGPU(int32 NumObjects, int32 NumSamples)
+        : Objects(FMath::Max(NumObjects, 1))
+        , Samples(FMath::Max(NumSamples, 2))
+    {
+    }
+
+
+    FRDGBufferRef FOrbitTrailHistoryGPU::Register(FRDGBuilder& GraphBuilder)
+    {
+        if (History.IsValid())
+        {
+            return GraphBuilder.RegisterExternalBuffer(History);
+        }
+
+        // Never read before it's written:  Valid counts what has been
+        FRDGBufferRef Buffer = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), Objects * Samples), TEXT("MaxQ.OrbitTrailHistory"));
+        History = GraphBuilder.ConvertToExternalBuffer(Buffer);
+        return Buffer;
+    }
+
+
+    void FOrbitTrailHistoryGPU::AddAppendPass(FRDGBuilder& GraphBuilder, FRDGBufferRef Positions)
+    {
+        check(IsInRenderingThread());
+
+        Head = (Head + 1) % Samples;
+        Valid = FMath::Min(Valid + 1, Samples);
+
+        const uint64 SampleBytes = uint64(Objects) * sizeof(FVector4f);
+        AddCopyBufferPass(GraphBuilder, Register(GraphBuilder), uint64(Head) * SampleBytes, Positions, 0, SampleBytes);
+    }
+
+
+    void FOrbitTrailHistoryGPU::AddUploadPass(FRDGBuilder& GraphBuilder, TArray<FVector4f>&& Positions)
+    {
+        check(Positions.Num() == Objects);
+
+        FRDGBufferRef Upload = CreateStructuredBuffer(GraphBuilder, TEXT("MaxQ.OrbitTrailSample"), sizeof(FVector4f), Positions.Num(), Positions.GetData(), Positions.Num() * sizeof(FVector4f));
+        AddAppendPass(GraphBuilder, Upload);
+    }
+
+
+    void FOrbitTrailHistoryGPU::AddDrawPass(
+        FRDGBuilder& GraphBuilder,
+        const FSceneView& View,
+        const FIntRect& ViewRect,
+        FRDGTextureRef SceneColor,
+        FRDGTextureRef SceneDepth,
+        const FVector& Anchor,
+        const FLinearColor& Color
+    )
+    {
+        check(IsInRenderingThread());
+
+        if (Valid < 2 || !History.IsValid())
+        {
+            return;
+        }
+
+        FMaxQOrbitTrailsPassParameters* PassParameters = GraphBuilder.AllocParameters<FMaxQOrbitTrailsPassParameters>();
+        PassParameters->VS.History = GraphBuilder.CreateSRV(Register(GraphBuilder));
+        PassParameters->VS.NumObjects = Objects;
+        PassParameters->VS.NumSamples = Samples;
+        PassParameters->VS.Head = Head;
+        PassParameters->VS.NumValid = Valid;
+        PassParameters->VS.AnchorTranslated = FVector3f(Anchor + View.ViewMatrices.GetPreViewTranslation());
+        PassParameters->VS.TranslatedWorldToClip = FMatrix44f(View.ViewMatrices.GetTranslatedViewProjectionMatrix());
+        PassParameters->VS.Color = FVector4f(Color);
+        PassParameters->RenderTargets[0] = FRenderTargetBinding(SceneColor, ERenderTargetLoadAction::ELoad);
+        if (SceneDepth)
+        {
+            PassParameters->RenderTargets.DepthStencil = FDepthStencilBinding(SceneDepth, ERenderTargetLoadAction::ELoad, FExclusiveDepthStencil::DepthRead_StencilNop);
+        }
+
+        TShaderMapRef<FMaxQOrbitTrailsVS> VertexShader(View.ShaderMap);
+        TShaderMapRef<FMaxQOrbitTrailsPS> PixelShader(View.ShaderMap);
+
+        const int32 NumObjects = Objects;
+        const int32 NumLines = Valid - 1;
+        const bool bDepthTest = SceneDepth != nullptr;
+
+        GraphBuilder.AddPass(
+            RDG_EVENT_NAME("MaxQ Orbit Trails (%d objects, %d samples)", NumObjects, Valid),
+            PassParameters,
+            ERDGPassFlags::Raster,
+            [PassParameters, VertexShader, PixelShader, ViewRect, NumObjects, NumLines, bDepthTest](FRHICommandList& RHICmdList)
+            {
+                RHICmdList.SetViewport(ViewRect.Min.X, ViewRect.Min.Y, 0.f, ViewRect.Max.X, ViewRect.Max.Y, 1.f);
+
+                FGraphicsPipelineStateInitializer GraphicsPSOInit;
+                RHICmdList.ApplyCachedRenderTargets(GraphicsPSOInit);
+                GraphicsPSOInit.BlendState = TStaticBlendState<CW_RGB, BO_Add, BF_SourceAlpha, BF_InverseSourceAlpha>::GetRHI();
+                GraphicsPSOInit.RasterizerState = TStaticRasterizerState<FM_Solid, CM_None>::GetRHI();
+                GraphicsPSOInit.DepthStencilState = bDepthTest ? TStaticDepthStencilState<false, CF_DepthNearOrEqual>::GetRHI() : TStaticDepthStencilState<false, CF_Always>::GetRHI();
+                GraphicsPSOInit.BoundShaderState.VertexDeclarationRHI = GEmptyVertexDeclaration.VertexDeclarationRHI;
+                GraphicsPSOInit.BoundShaderState.VertexShaderRHI = VertexShader.GetVertexShader();
+                GraphicsPSOInit.BoundShaderState.PixelShaderRHI = PixelShader.GetPixelShader();
+                GraphicsPSOInit.PrimitiveType = PT_LineList;
+                SetGraphicsPipelineState(RHICmdList, GraphicsPSOInit, 0);
+
+                SetShaderParameters(RHICmdList, VertexShader, VertexShader.GetVertexShader(), PassParameters->VS);
+
+                // An instance per object, a line per pair of samples
+                RHICmdList.DrawPrimitive(0, NumLines, NumObjects);
+            }
+        );
+    }
+
+
+    class FOrbitTrailsViewExtension : public FSceneViewExtensionBase
+    {
+    public:
+        FOrbitTrailsViewExtension(const FAutoRegister& AutoRegister, int32 NumObjects, int32 NumSamples, const FVector& _Anchor)
+            : FSceneViewExtensionBase(AutoRegister)
+            , History(NumObjects, NumSamples)
+            , Anchor(_Anchor)
+        {
+        }
+
+        virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override {}
+        virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override {}
+        virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override {}
+
+        virtual void PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override
+        {
+            for (FSample& Sample : Pending)
+            {
+                if (Sample.Catalog.IsValid())
+                {
+                    FRDGBufferRef Positions = Sample.Catalog->CreatePositionsBuffer(GraphBuilder, TEXT("MaxQ.OrbitTrailSample"));
+                    Sample.Catalog->AddPropagatePass(GraphBuilder, Sample.Parameters, GraphBuilder.CreateUAV(Positions));
+                    History.AddAppendPass(GraphBuilder, Positions);
+                }
+                else
+                {
+                    History.AddUploadPass(GraphBuilder, MoveTemp(Sample.Positions));
+                }
+            }
+            Pending.Reset();
+        }
+
+        virtual void SubscribeToPostProcessingPass(EPostProcessingPass Pass, FAfterPassCallbackDelegateArray& InOutPassCallbacks, bool bIsPassEnabled) override
+        {
+            if (Pass == EPostProcessingPass::MotionBlur)
+            {
+                InOutPassCallbacks.Add(FAfterPassCallbackDelegate::CreateRaw(this, &FOrbitTrailsViewExtension::AfterMotionBlur_RenderThread));
+            }
+        }
+
+        FScreenPassTexture AfterMotionBlur_RenderThread(FRDGBuilder& GraphBuilder, const FSceneView& View, const FPostProcessMaterialInputs& Inputs)
+        {
+            const FScreenPassTexture SceneColor(Inputs.GetInput(EPostProcessMaterialInput::SceneColor));
+
+            if (bVisible)
+            {
+                FRDGTextureRef SceneDepth = Inputs.SceneTextures.SceneTextures->GetParameters()->SceneDepthTexture;
+                if (SceneDepth && SceneDepth->Desc.Extent != SceneColor.Texture->Desc.Extent)
+                {
+                    SceneDepth = nullptr;
+                }
+                History.AddDrawPass(GraphBuilder, View, SceneColor.ViewRect, SceneColor.Texture, SceneDepth, Anchor, Color);
+            }
+
+            // The last pass in the chain has to write where it's told to
+            if (Inputs.OverrideOutput.IsValid())
+            {
+                AddDrawTexturePass(GraphBuilder, View, SceneColor, Inputs.OverrideOutput);
+                return Inputs.OverrideOutput;
+            }
+            return SceneColor;
+        }
+
+        struct FSample
+        {
+            TArray<FVector4f> Positions;
+            TSharedPtr<FSGP4GPUCatalog, ESPMode::ThreadSafe> Catalog;
+            FSGP4GPUParameters Parameters;
+        };
+
+        // Render thread
+        TArray<FSample> Pending;
+        FOrbitTrailHistoryGPU History;
+        FLinearColor Color = FLinearColor(0.3f, 0.6f, 1.f, 0.8f);
+        bool bVisible = true;
+
+    private:
+        const FVector Anchor;
+    };
+
+
+    FOrbitTrailsGPU::FOrbitTrailsGPU(int32 _NumObjects, int32 NumSamples, const FVector& _Anchor)
+        : NumObjects(FMath::Max(_NumObjects, 1))
+        , Anchor(_Anchor)
+    {
+        Extension = FSceneViewExtensions::NewExtension<FOrbitTrailsViewExtension>(NumObjects, NumSamples, Anchor);
+    }
+
+
+    FOrbitTrailsGPU::~FOrbitTrailsGPU()
+    {
+        // The last reference goes on the render thread, with the history
+        ENQUEUE_RENDER_COMMAND(MaxQOrbitTrailsRelease)([Extension = MoveTemp(Extension)](FRHICommandListImmediate&) mutable
+        {
+            Extension.Reset();
+        });
+    }
+
+
+    void FOrbitTrailsGPU::PushSample(TArrayView<const FVector> WorldPositions, TArrayView<const bool> Valid)
+    {
+        check(WorldPositions.Num() == NumObjects);
+        check(Valid.Num() == 0 || Valid.Num() == NumObjects);
+
+        TArray<FVector4f> Positions;
+        Positions.SetNumUninitialized(NumObjects);
+        for (int32 i = 0; i < NumObjects; ++i)
+        {
+            const bool bValid = Valid.Num() == 0 || Valid[i];
+            Positions[i] = FVector4f(FVector3f(WorldPositions[i] - Anchor), bValid ? 0.f : 1.f);
+        }
+
+        ENQUEUE_RENDER_COMMAND(MaxQOrbitTrailsPush)([Extension = Extension, Positions = MoveTemp(Positions)](FRHICommandListImmediate&) mutable
+        {
+            Extension->Pending.Add({ MoveTemp(Positions), nullptr, FSGP4GPUParameters() });
+        });
+    }
+
+
+    void FOrbitTrailsGPU::PushSample(const TSharedRef<FSGP4GPUCatalog, ESPMode::ThreadSafe>& Catalog, const FSGP4GPUParameters& Parameters)
+    {
+        check(Catalog->Num() == NumObjects);
+
+        ENQUEUE_RENDER_COMMAND(MaxQOrbitTrailsPushGPU)([Extension = Extension, Catalog = TSharedPtr<FSGP4GPUCatalog, ESPMode::ThreadSafe>(Catalog), Parameters](FRHICommandListImmediate&)
+        {
+            Extension->Pending.Add({ TArray<FVector4f>(), Catalog, Parameters });
+        });
+    }
+
+
+    void FOrbitTrailsGPU::Reset()
+    {
+        ENQUEUE_RENDER_COMMAND(MaxQOrbitTrailsReset)([Extension = Extension](FRHICommandListImmediate&)
+        {
+            Extension->Pending.Reset();
+            Extension->History.Reset();
+        });
+    }
+
+
+    void FOrbitTrailsGPU::SetColor(const FLinearColor& Color)
+    {
+        ENQUEUE_RENDER_COMMAND(MaxQOrbitTrailsColor)([Extension = Extension, Color](FRHICommandListImmediate&)
+        {
+            Extension->Color = Color;
+        });
+    }
+
+
+    void FOrbitTrailsGPU::SetVisible(bool bVisible)
+    {
+        ENQUEUE_RENDER_COMMAND(MaxQOrbitTrailsVisible)([Extension = Extension, bVisible](FRHICommandListImmediate&)
+        {
+            Extension->bVisible = bVisible;
+        });
+    }
+}
@@ -0,0 +1,172 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSGP4GPU.cpp
+//
+// Implementation Comments
+//
+// Purpose:  SGP4 propagation in a compute shader, for visualization.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSGP4GPU.cpp is part of the "refined C++ API".
+//
+// Each model is packed as ModelStride float4s, in the order the shader
+// (Shaders/Private/MaxQSGP4.usf) reads them.
+//------------------------------------------------------------------------------
+
+#include "SpiceSGP4GPU.h"
+#include "GlobalShader.h"
+#include "ShaderParameterStruct.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+
+namespace
+{
+    constexpr int32 ModelStride = 10;
+
+    class FMaxQSGP4CS : public FGlobalShader
+    {
+    public:
+        DECLARE_GLOBAL_SHADER(FMaxQSGP4CS);
+        SHADER_USE_PARAMETER_STRUCT(FMaxQSGP4CS, FGlobalShader);
+
+        static constexpr int32 ThreadGroupSize = 64;
+
+        BEGIN_SHADER_PARAMETER_STRUCT(FParameters, )
+            SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<float4>, Models)
+            SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<float4>, OutPositions)
+            SHADER_PARAMETER(uint32, NumObjects)
+            SHADER_PARAMETER(FVector2f, Time)
+            SHADER_PARAMETER(FVector3f, OriginHigh)
+            SHADER_PARAMETER(FVector3f, OriginLow)
+            SHADER_PARAMETER(FMatrix44f, Transform)
+            SHADER_PARAMETER(float, Scale)
+        END_SHADER_PARAMETER_STRUCT()
+
+        static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+        {
+            return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+        }
+
+        static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+        {
+            FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+            OutEnvironment.SetDefine(TEXT("THREADGROUP_SIZE"), ThreadGroupSize);
+            OutEnvironment.SetDefine(TEXT("MODEL_STRIDE"), ModelStride);
+        }
+    };
+
+    IMPLEMENT_GLOBAL_SHADER(FMaxQSGP4CS, "/Plugin/MaxQ/Private/MaxQSGP4.usf", "MainCS", SF_Compute);
+
+    // Whole minutes + fractional minutes, so differences of the whole parts are exact
+    inline FVector2f SplitMinutes(double Minutes)
+    {
+        const double Whole = FMath::FloorToDouble(Minutes);
+        return FVector2f((float)Whole, (float)(Minutes - Whole));
+    }
+}
+
+
+namespace MaxQ::Orbits
+{
+    void FSGP4GPUCatalog::Build(TArrayView<const FSGP4Propagator> Catalog)
+    {
+        NumObjects = Catalog.Num();
+        ModelBuffer.SafeRelease();
+
+        ReferenceEpoch = 0.;
+        for (const FSGP4Propagator& Propagator : Catalog)
+        {
+            if (Propagator.IsValid())
+            {
+                ReferenceEpoch = Propagator.GetModel().Epoch;
+                break;
+            }
+        }
+
+        Packed.SetNumZeroed(FMath::Max(NumObjects, 1) * ModelStride);
+
+        for (int32 i = 0; i < NumObjects; ++i)
+        {
+            const FSGP4Model& m = Catalog[i].GetModel();
+            const bool bValid = Catalog[i].IsValid() && !m.dodeep;
+
+            // (Invalid entries are left zeroed, the shader skips them)
+            if (!bValid) continue;
+
+            const FVector2f Epoch = SplitMinutes((m.Epoch - ReferenceEpoch) / 60.);
+
+            FVector4f* p = &Packed[i * ModelStride];
+            p[0] = FVector4f(Epoch.X, Epoch.Y, m.mo, m.mdot);
+            p[1] = FVector4f(m.argpo, m.argpdot, m.nodeo, m.nodedot);
+            p[2] = FVector4f(m.xnodcf, m.cc1, m.cc4, m.cc5);
+            p[3] = FVector4f(m.bstar, m.t2cof, m.t3cof, m.t4cof);
+            p[4] = FVector4f(m.t5cof, m.omgcof, m.eta, m.xmcof);
+            p[5] = FVector4f(m.delmo, m.sinmao, m.d2, m.d3);
+            p[6] = FVector4f(m.d4, m.no, m.ecco, m.inclo);
+            p[7] = FVector4f(FMath::Sin(m.inclo), FMath::Cos(m.inclo), m.aycof, m.xlcof);
+            p[8] = FVector4f(m.con41, m.x1mth2, m.x7thm1, m.j2);
+            p[9] = FVector4f(m.xke, m.er, m.dosimp ? 1.f : 0.f, 1.f);
+        }
+    }
+
+
+    FRDGBufferRef FSGP4GPUCatalog::CreatePositionsBuffer(FRDGBuilder& GraphBuilder, const TCHAR* Name) const
+    {
+        return GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateStructuredDesc(sizeof(FVector4f), FMath::Max(NumObjects, 1)), Name);
+    }
+
+
+    void FSGP4GPUCatalog::AddPropagatePass(FRDGBuilder& GraphBuilder, const FSGP4GPUParameters& Parameters, FRDGBufferUAVRef OutPositions)
+    {
+        check(IsInRenderingThread());
+
+        if (NumObjects == 0)
+        {
+            return;
+        }
+
+        FRDGBufferRef Models;
+        if (ModelBuffer.IsValid())
+        {
+            Models = GraphBuilder.RegisterExternalBuffer(ModelBuffer);
+        }
+        else
+        {
+            Models = CreateStructuredBuffer(GraphBuilder, TEXT("MaxQ.SGP4Models"), sizeof(FVector4f), Packed.Num(), Packed.GetData(), Packed.Num() * sizeof(FVector4f));
+            ModelBuffer = GraphBuilder.ConvertToExternalBuffer(Models);
+        }
+
+        const FVector3f OriginHigh(Parameters.Origin);
+        const FVector3f OriginLow(Parameters.Origin - FVector(OriginHigh));
+
+        FMaxQSGP4CS::FParameters* PassParameters = GraphBuilder.AllocParameters<FMaxQSGP4CS::FParameters>();
+        PassParameters->Models = GraphBuilder.CreateSRV(Models);
+        PassParameters->OutPositions = OutPositions;
+        PassParameters->NumObjects = NumObjects;
+        PassParameters->Time = SplitMinutes((Parameters.et - ReferenceEpoch) / 60.);
+        PassParameters->OriginHigh = OriginHigh;
+        PassParameters->OriginLow = OriginLow;
+        PassParameters->Transform = Parameters.Transform;
+        PassParameters->Scale = Parameters.Scale;
+
+        TShaderMapRef<FMaxQSGP4CS> ComputeShader(GetGlobalShaderMap(GMaxRHIFeatureLevel));
+        FComputeShaderUtils::AddPass(
+            GraphBuilder,
+            RDG_EVENT_NAME("MaxQ SGP4 (%d objects)", NumObjects),
+            ComputeShader,
+            PassParameters,
+            FComputeShaderUtils::GetGroupCount(NumObjects, FMaxQSGP4CS::ThreadGroupSize)
+        );
+    }
+}
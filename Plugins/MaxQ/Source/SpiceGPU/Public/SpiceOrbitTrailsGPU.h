@@ -0,0 +1,127 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceOrbitTrailsGPU.h
+//
+// API Comments
+//
+// Purpose:  Recent-history trails for thousands of objects, kept on the GPU.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceOrbitTrailsGPU.h is part of the "refined C++ API".
+//
+// Keeping each object's last N positions on the CPU, and re-submitting them
+// as lines every frame, costs N times the catalog per frame.  Here the
+// history is a ring buffer on the GPU, one slot per object per sample.  Each
+// frame's sample is appended (one upload of a float4 per object, or none, if
+// the positions come from FSGP4GPUCatalog), and the trails are drawn with one
+// instanced draw:  an instance per object, a line per pair of consecutive
+// samples, faded by age.
+//
+// Samples are stored relative to a fixed anchor, in single precision, so
+// they stay valid as the camera moves.  Pick an anchor near the objects (the
+// central body, in UE space).  Trails are drawn into scene color after
+// motion blur, depth tested against the scene (unless temporal upscaling has
+// already changed scene color's resolution) but not written to depth.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphResources.h"
+#include "SpiceSGP4GPU.h"
+
+class FRDGBuilder;
+class FSceneView;
+
+namespace MaxQ::Orbits
+{
+    class FOrbitTrailsViewExtension;
+
+    // The ring buffer, render thread only.  FOrbitTrailsGPU drives it from
+    // the game thread; use it directly to append from other GPU passes.
+    class SPICEGPU_API FOrbitTrailHistoryGPU
+    {
+    public:
+        FOrbitTrailHistoryGPU(int32 NumObjects, int32 NumSamples);
+
+        int32 NumObjects() const { return Objects; }
+        int32 NumSamples() const { return Samples; }
+        // Samples appended since the last Reset (up to NumSamples)
+        int32 NumValid() const { return Valid; }
+
+        void Reset() { Valid = 0; }
+
+        // Positions:  NumObjects float4s, xyz relative to the anchor, w != 0
+        // where an object has no position (as FSGP4GPUCatalog writes them).
+        void AddAppendPass(FRDGBuilder& GraphBuilder, FRDGBufferRef Positions);
+
+        // As above, from the CPU:  the one upload
+        void AddUploadPass(FRDGBuilder& GraphBuilder, TArray<FVector4f>&& Positions);
+
+        // Lines from each object's newest sample back, alpha falling to 0 at
+        // the oldest.  SceneDepth may be null:  no depth test.
+        void AddDrawPass(
+            FRDGBuilder& GraphBuilder,
+            const FSceneView& View,
+            const FIntRect& ViewRect,
+            FRDGTextureRef SceneColor,
+            FRDGTextureRef SceneDepth,
+            const FVector& Anchor,
+            const FLinearColor& Color
+        );
+
+    private:
+        FRDGBufferRef Register(FRDGBuilder& GraphBuilder);
+
+        const int32 Objects;
+        const int32 Samples;
+        int32 Head = -1;
+        int32 Valid = 0;
+
+        TRefCountPtr<FRDGPooledBuffer> History;
+    };
+
+
+    // Game thread.  Trails drawn in every view, until it's destroyed.
+    class SPICEGPU_API FOrbitTrailsGPU
+    {
+    public:
+        // Anchor is in UE world space
+        FOrbitTrailsGPU(int32 NumObjects, int32 NumSamples, const FVector& Anchor);
+        ~FOrbitTrailsGPU();
+
+        // One sample.  WorldPositions has NumObjects entries; Valid, if it's
+        // not empty, too.
+        void PushSample(TArrayView<const FVector> WorldPositions, TArrayView<const bool> Valid = {});
+
+        // One sample, propagated on the GPU:  nothing's uploaded.
+        // Parameters' output space must be world space relative to the
+        // anchor, and Catalog must have NumObjects entries.
+        void PushSample(const TSharedRef<FSGP4GPUCatalog, ESPMode::ThreadSafe>& Catalog, const FSGP4GPUParameters& Parameters);
+
+        // Forget the history (after a time jump, say)
+        void Reset();
+
+        void SetColor(const FLinearColor& Color);
+        void SetVisible(bool bVisible);
+
+        const FVector& GetAnchor() const { return Anchor; }
+
+    private:
+        const int32 NumObjects;
+        const FVector Anchor;
+
+        TSharedPtr<FOrbitTrailsViewExtension, ESPMode::ThreadSafe> Extension;
+    };
+}
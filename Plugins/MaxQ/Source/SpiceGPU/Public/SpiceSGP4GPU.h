@@ -0,0 +1,86 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSGP4GPU.h
+//
+// API Comments
+//
+// Purpose:  SGP4 propagation in a compute shader, for visualization.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSGP4GPU.h is part of the "refined C++ API".
+//
+// FSGP4GPUCatalog uploads the near earth SGP4 models of a catalog once, then
+// each frame a compute pass evaluates all of them and writes one float4 per
+// object into a UAV the caller provides... an instance buffer, a Niagara
+// buffer, whatever's going to draw them.  Nothing comes back to the CPU.
+//
+// The models come from FSGP4Propagator, which was initialized with the
+// geophysical constants from USpice::getgeophs, so the GPU uses the same
+// constants as evsgp4 does.
+//
+// The shader runs in single precision.  Times are split into whole and
+// fractional minutes so the time since epoch is exact, and positions are
+// written relative to a double precision origin (the camera, usually).
+// Expect errors of a few hundred meters within a few days of the TLE epoch:
+// good for drawing, not for analysis.  Deep space objects (periods >= 225
+// minutes) aren't propagated on the GPU; their outputs are flagged.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphResources.h"
+#include "SpiceSGP4.h"
+
+class FRDGBuilder;
+
+namespace MaxQ::Orbits
+{
+    struct FSGP4GPUParameters
+    {
+        // TDB seconds past J2000
+        double et = 0.;
+
+        // Output positions are (r - Origin) * Transform * Scale, r in km (TEME).
+        // Transform can swizzle into UE's left handed coordinates, etc.
+        FVector Origin = FVector::ZeroVector;
+        FMatrix44f Transform = FMatrix44f::Identity;
+        float Scale = 1.f;
+    };
+
+    class SPICEGPU_API FSGP4GPUCatalog
+    {
+    public:
+        // Game thread (or any thread).  Copies & packs the models.
+        void Build(TArrayView<const FSGP4Propagator> Catalog);
+
+        int32 Num() const { return NumObjects; }
+
+        // Render thread.  Writes Num() float4s to OutPositions:
+        //   xyz = position, w = 0 if ok, > 0 if SGP4 failed (the ESGP4Status),
+        //   w = -1 if the object isn't propagated on the GPU.
+        void AddPropagatePass(FRDGBuilder& GraphBuilder, const FSGP4GPUParameters& Parameters, FRDGBufferUAVRef OutPositions);
+
+        // Render thread.  A buffer that fits the output.
+        FRDGBufferRef CreatePositionsBuffer(FRDGBuilder& GraphBuilder, const TCHAR* Name) const;
+
+    private:
+        TArray<FVector4f> Packed;
+        double ReferenceEpoch = 0.;
+        int32 NumObjects = 0;
+
+        // Uploaded on first use
+        TRefCountPtr<FRDGPooledBuffer> ModelBuffer;
+    };
+}
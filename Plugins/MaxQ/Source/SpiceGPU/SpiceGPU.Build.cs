@@ -0,0 +1,22 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+
+using UnrealBuildTool;
+
+// Optional GPU propagation.  Registers global shaders, so this module must
+// load in the PostConfigInit phase (see MaxQ.uplugin).
+public class SpiceGPU : ModuleRules
+{
+    public SpiceGPU(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "RenderCore", "RHI", "Spice" });
+        PrivateDependencyModuleNames.AddRange(new string[] { "Projects", "Renderer" });
+    }
+}
@@ -0,0 +1,27 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+
+#include "SpiceGPUModule.h"
+#include "Modules/ModuleManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+#include "ShaderCore.h"
+
+
+void FSpiceGPUModule::StartupModule()
+{
+    // Shaders live in MaxQ/Shaders, as /Plugin/MaxQ/...
+    TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("MaxQ"));
+    if (Plugin.IsValid())
+    {
+        FString ShaderDirectory = FPaths::Combine(Plugin->GetBaseDir(), TEXT("Shaders"));
+        AddShaderSourceDirectoryMapping(TEXT("/Plugin/MaxQ"), ShaderDirectory);
+    }
+}
+
+IMPLEMENT_MODULE(FSpiceGPUModule, SpiceGPU);
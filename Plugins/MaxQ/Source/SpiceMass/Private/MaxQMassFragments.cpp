@@ -0,0 +1,110 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// MaxQMassFragments.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Mass fragments for orbiting objects.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// MaxQMassFragments.cpp is part of the "refined C++ API".
+//
+// Entities are made in one batch, so they're contiguous in their chunks in
+// population order, and the propagation processor's copies out of the
+// population's arrays run forward through memory.
+//------------------------------------------------------------------------------
+
+#include "MaxQMassFragments.h"
+#include "MaxQOrbitPopulation.h"
+#include "MassEntityManager.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+
+int32 MaxQ::Mass::SpawnOrbitEntities(
+    FMassEntityManager& EntityManager,
+    UMaxQOrbitPopulation* Population,
+    const FMaxQOrbitVisualizationFragment& Visualization,
+    bool bEclipse,
+    TArray<FMassEntityHandle>& OutEntities
+)
+{
+    OutEntities.Reset();
+
+    const int32 Num = Population ? Population->Num() : 0;
+    if (Num == 0)
+    {
+        return 0;
+    }
+
+    UInstancedStaticMeshComponent* Instances = Visualization.Instances.Get();
+
+    TArray<const UScriptStruct*> Composition = {
+        FMaxQOrbitFragment::StaticStruct(),
+        FMaxQOrbitStateFragment::StaticStruct(),
+        FMaxQOrbitPopulationFragment::StaticStruct()
+    };
+    if (bEclipse)
+    {
+        Composition.Add(FMaxQEclipseFragment::StaticStruct());
+    }
+    if (Instances)
+    {
+        Composition.Add(FMaxQOrbitLODFragment::StaticStruct());
+        Composition.Add(FMaxQOrbitInstanceFragment::StaticStruct());
+        Composition.Add(FMaxQOrbitVisualizationFragment::StaticStruct());
+    }
+    const FMassArchetypeHandle Archetype = EntityManager.CreateArchetype(Composition);
+
+    FMaxQOrbitPopulationFragment PopulationFragment;
+    PopulationFragment.Population = Population;
+
+    FMassArchetypeSharedFragmentValues SharedValues;
+    SharedValues.AddConstSharedFragment(EntityManager.GetOrCreateConstSharedFragment(PopulationFragment));
+    if (Instances)
+    {
+        SharedValues.AddConstSharedFragment(EntityManager.GetOrCreateConstSharedFragment(Visualization));
+    }
+    SharedValues.Sort();
+
+    // Observers hear about the entities when this goes out of scope, with
+    // the fragments filled in
+    TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext = EntityManager.BatchCreateEntities(Archetype, SharedValues, Num, OutEntities);
+
+    TArray<int32> InstanceIndices;
+    if (Instances)
+    {
+        if (bEclipse && Instances->NumCustomDataFloats < 1)
+        {
+            Instances->SetNumCustomDataFloats(1);
+        }
+
+        TArray<FTransform> Hidden;
+        Hidden.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), Num);
+        InstanceIndices = Instances->AddInstances(Hidden, true);
+    }
+
+    for (int32 i = 0; i < OutEntities.Num(); ++i)
+    {
+        EntityManager.GetFragmentDataChecked<FMaxQOrbitFragment>(OutEntities[i]).Index = i;
+
+        if (InstanceIndices.IsValidIndex(i))
+        {
+            FMaxQOrbitInstanceFragment& Instance = EntityManager.GetFragmentDataChecked<FMaxQOrbitInstanceFragment>(OutEntities[i]);
+            Instance.InstanceIndex = InstanceIndices[i];
+            Instance.bHidden = true;
+        }
+    }
+
+    return OutEntities.Num();
+}
@@ -0,0 +1,337 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// MaxQMassProcessors.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Mass processors for orbiting objects.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// MaxQMassProcessors.cpp is part of the "refined C++ API".
+//
+// Propagation and LOD don't touch CSPICE or components, so Mass may run them
+// off the game thread.  The populations parallelize themselves, so a chunk
+// at a time is enough here.  Eclipse (CSPICE) and visualization (component
+// writes) are game thread only.
+//------------------------------------------------------------------------------
+
+#include "MaxQMassProcessors.h"
+#include "MaxQMassFragments.h"
+#include "MaxQOrbitPopulation.h"
+#include "MassExecutionContext.h"
+#include "MassEntityManager.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceEclipseBatch.h"
+#include "SpiceMath.h"
+#include "SpiceLog.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+namespace
+{
+    const FName MaxQGroup(TEXT("MaxQ"));
+
+    double ScaleOf(const FMaxQOrbitVisualizationFragment& Visualization, const UMaxQEphemerisSubsystem* Subsystem)
+    {
+        return Visualization.Scale > 0. ? Visualization.Scale : Subsystem ? Subsystem->Scale : 1.;
+    }
+
+    const UMaxQEphemerisSubsystem* EphemerisSubsystem(const FMassEntityManager& EntityManager)
+    {
+        const UWorld* World = EntityManager.GetWorld();
+        return World ? World->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr;
+    }
+}
+
+
+UMaxQOrbitPropagationProcessor::UMaxQOrbitPropagationProcessor()
+{
+    ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+    ProcessingPhase = EMassProcessingPhase::PrePhysics;
+    ExecutionOrder.ExecuteInGroup = MaxQGroup;
+    bRequiresGameThreadExecution = false;
+
+    EntityQuery.RegisterWithProcessor(*this);
+}
+
+
+void UMaxQOrbitPropagationProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FMaxQOrbitFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FMaxQOrbitStateFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddConstSharedRequirement<FMaxQOrbitPopulationFragment>();
+}
+
+
+void UMaxQOrbitPropagationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    const UMaxQEphemerisSubsystem* Subsystem = EphemerisSubsystem(EntityManager);
+    if (!Subsystem)
+    {
+        return;
+    }
+    const FSEphemerisTime et = Subsystem->Epoch;
+
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [&et](FMassExecutionContext& Context)
+    {
+        UMaxQOrbitPopulation* Population = Context.GetConstSharedFragment<FMaxQOrbitPopulationFragment>().Population.Get();
+        const TConstArrayView<FMaxQOrbitFragment> Orbits = Context.GetFragmentView<FMaxQOrbitFragment>();
+        const TArrayView<FMaxQOrbitStateFragment> States = Context.GetMutableFragmentView<FMaxQOrbitStateFragment>();
+
+        // The population's first chunk propagates it, the rest find it done
+        if (Population)
+        {
+            Population->Propagate(et);
+        }
+
+        for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+        {
+            States[i].bValid = Population && Population->GetState(Orbits[i].Index, States[i].State);
+        }
+    });
+}
+
+
+UMaxQOrbitEclipseProcessor::UMaxQOrbitEclipseProcessor()
+{
+    ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+    ProcessingPhase = EMassProcessingPhase::PrePhysics;
+    ExecutionOrder.ExecuteInGroup = MaxQGroup;
+    ExecutionOrder.ExecuteAfter.Add(UMaxQOrbitPropagationProcessor::StaticClass()->GetFName());
+    bRequiresGameThreadExecution = true;
+
+    EntityQuery.RegisterWithProcessor(*this);
+}
+
+
+void UMaxQOrbitEclipseProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FMaxQOrbitStateFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FMaxQEclipseFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+
+void UMaxQOrbitEclipseProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    const UMaxQEphemerisSubsystem* Subsystem = EphemerisSubsystem(EntityManager);
+    if (!Subsystem)
+    {
+        return;
+    }
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+    MaxQ::Math::FEclipseGeometry Geometry;
+    if (!MaxQ::Math::EclipseGeometry(Subsystem->Epoch, Geometry, Frame, Source, Occulter, OcculterFrame, ES_AberrationCorrectionWithNewtonians::LT_S, &ResultCode, &ErrorMessage))
+    {
+        UE_LOG(LogSpice, Warning, TEXT("UMaxQOrbitEclipseProcessor: %s"), *ErrorMessage);
+        return;
+    }
+
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, &Geometry](FMassExecutionContext& Context)
+    {
+        const TConstArrayView<FMaxQOrbitStateFragment> States = Context.GetFragmentView<FMaxQOrbitStateFragment>();
+        const TArrayView<FMaxQEclipseFragment> Eclipses = Context.GetMutableFragmentView<FMaxQEclipseFragment>();
+        const int32 Num = Context.GetNumEntities();
+
+        X.SetNum(Num, false);
+        Y.SetNum(Num, false);
+        Z.SetNum(Num, false);
+        ShadowFraction.SetNum(Num, false);
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const FSDistanceVector& r = States[i].State.r;
+            X[i] = r.x.km;
+            Y[i] = r.y.km;
+            Z[i] = r.z.km;
+        }
+
+        MaxQ::Math::EclipseStates(Geometry, MaxQ::Math::FConstVectorBatch(X, Y, Z), {}, ShadowFraction);
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            Eclipses[i].ShadowFraction = States[i].bValid ? ShadowFraction[i] : 0.f;
+        }
+    });
+}
+
+
+UMaxQOrbitLODProcessor::UMaxQOrbitLODProcessor()
+{
+    ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+    ProcessingPhase = EMassProcessingPhase::PrePhysics;
+    ExecutionOrder.ExecuteInGroup = MaxQGroup;
+    ExecutionOrder.ExecuteAfter.Add(UMaxQOrbitPropagationProcessor::StaticClass()->GetFName());
+    bRequiresGameThreadExecution = false;
+
+    EntityQuery.RegisterWithProcessor(*this);
+}
+
+
+void UMaxQOrbitLODProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FMaxQOrbitStateFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FMaxQOrbitLODFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddConstSharedRequirement<FMaxQOrbitVisualizationFragment>();
+}
+
+
+void UMaxQOrbitLODProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    const UWorld* World = EntityManager.GetWorld();
+    const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+    if (!PlayerController || !PlayerController->PlayerCameraManager)
+    {
+        return;
+    }
+    const FVector Viewer = PlayerController->PlayerCameraManager->GetCameraLocation();
+    const UMaxQEphemerisSubsystem* Subsystem = World->GetSubsystem<UMaxQEphemerisSubsystem>();
+
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [&Viewer, Subsystem](FMassExecutionContext& Context)
+    {
+        const FMaxQOrbitVisualizationFragment& Visualization = Context.GetConstSharedFragment<FMaxQOrbitVisualizationFragment>();
+        const UInstancedStaticMeshComponent* Instances = Visualization.Instances.Get();
+        if (!Instances)
+        {
+            return;
+        }
+
+        const FTransform& ToWorld = Instances->GetComponentTransform();
+        const double Scale = ScaleOf(Visualization, Subsystem);
+        const TArray<double>& Distances = Visualization.LODDistances;
+
+        const TConstArrayView<FMaxQOrbitStateFragment> States = Context.GetFragmentView<FMaxQOrbitStateFragment>();
+        const TArrayView<FMaxQOrbitLODFragment> LODs = Context.GetMutableFragmentView<FMaxQOrbitLODFragment>();
+
+        for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+        {
+            const FVector Location = ToWorld.TransformPosition(MaxQ::Math::Swizzle(States[i].State.r) * Scale);
+            const double Distance = FVector::Distance(Location, Viewer);
+
+            int32 LOD = 0;
+            while (LOD < Distances.Num() && Distance > Distances[LOD])
+            {
+                ++LOD;
+            }
+
+            LODs[i].Distance = Distance;
+            LODs[i].LOD = (uint8)FMath::Min(LOD, 255);
+        }
+    });
+}
+
+
+UMaxQOrbitVisualizationProcessor::UMaxQOrbitVisualizationProcessor()
+{
+    ExecutionFlags = (int32)(EProcessorExecutionFlags::Client | EProcessorExecutionFlags::Standalone);
+    ProcessingPhase = EMassProcessingPhase::PrePhysics;
+    ExecutionOrder.ExecuteInGroup = MaxQGroup;
+    ExecutionOrder.ExecuteAfter.Add(UMaxQOrbitEclipseProcessor::StaticClass()->GetFName());
+    ExecutionOrder.ExecuteAfter.Add(UMaxQOrbitLODProcessor::StaticClass()->GetFName());
+    bRequiresGameThreadExecution = true;
+
+    EntityQuery.RegisterWithProcessor(*this);
+}
+
+
+void UMaxQOrbitVisualizationProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FMaxQOrbitStateFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FMaxQOrbitLODFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FMaxQOrbitInstanceFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddRequirement<FMaxQEclipseFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
+    EntityQuery.AddConstSharedRequirement<FMaxQOrbitVisualizationFragment>();
+}
+
+
+void UMaxQOrbitVisualizationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    const UMaxQEphemerisSubsystem* Subsystem = EphemerisSubsystem(EntityManager);
+    const uint64 Frame = GFrameCounter;
+
+    // Marked once each, at the end
+    TSet<UInstancedStaticMeshComponent*> Dirty;
+
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [Subsystem, Frame, &Dirty](FMassExecutionContext& Context)
+    {
+        const FMaxQOrbitVisualizationFragment& Visualization = Context.GetConstSharedFragment<FMaxQOrbitVisualizationFragment>();
+        UInstancedStaticMeshComponent* Instances = Visualization.Instances.Get();
+        if (!Instances)
+        {
+            return;
+        }
+
+        const double Scale = ScaleOf(Visualization, Subsystem);
+        const int32 NumLODs = Visualization.LODDistances.Num();
+        const bool bShadows = Instances->NumCustomDataFloats > 0;
+
+        const TConstArrayView<FMaxQOrbitStateFragment> States = Context.GetFragmentView<FMaxQOrbitStateFragment>();
+        const TConstArrayView<FMaxQOrbitLODFragment> LODs = Context.GetFragmentView<FMaxQOrbitLODFragment>();
+        const TConstArrayView<FMaxQEclipseFragment> Eclipses = Context.GetFragmentView<FMaxQEclipseFragment>();
+        const TArrayView<FMaxQOrbitInstanceFragment> InstanceFragments = Context.GetMutableFragmentView<FMaxQOrbitInstanceFragment>();
+
+        const FTransform Hidden(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+        bool bWritten = false;
+
+        for (int32 i = 0; i < Context.GetNumEntities(); ++i)
+        {
+            FMaxQOrbitInstanceFragment& Instance = InstanceFragments[i];
+            if (!Instances->IsValidInstance(Instance.InstanceIndex))
+            {
+                continue;
+            }
+
+            const int32 LOD = LODs[i].LOD;
+            if (!States[i].bValid || (NumLODs > 0 && LOD >= NumLODs))
+            {
+                if (!Instance.bHidden)
+                {
+                    Instances->UpdateInstanceTransform(Instance.InstanceIndex, Hidden, false, false, true);
+                    Instance.bHidden = true;
+                    bWritten = true;
+                }
+                continue;
+            }
+
+            // Far ones less often, staggered so each frame writes some
+            const uint64 Period = 1ull << FMath::Min(LOD, 16);
+            if (!Instance.bHidden && (Frame + Instance.InstanceIndex) % Period != 0)
+            {
+                continue;
+            }
+
+            const FVector Location = MaxQ::Math::Swizzle(States[i].State.r) * Scale;
+            Instances->UpdateInstanceTransform(Instance.InstanceIndex, FTransform(FQuat::Identity, Location, Visualization.InstanceScale), false, false, true);
+            if (bShadows && Eclipses.Num() > 0)
+            {
+                Instances->SetCustomDataValue(Instance.InstanceIndex, 0, Eclipses[i].ShadowFraction, false);
+            }
+            Instance.bHidden = false;
+            bWritten = true;
+        }
+
+        if (bWritten)
+        {
+            Dirty.Add(Instances);
+        }
+    });
+
+    for (UInstancedStaticMeshComponent* Instances : Dirty)
+    {
+        Instances->MarkRenderStateDirty();
+    }
+}
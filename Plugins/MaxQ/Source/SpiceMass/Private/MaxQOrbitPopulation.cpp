@@ -0,0 +1,201 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// MaxQOrbitPopulation.cpp
+//
+// Implementation Comments
+//
+// Purpose:  A set of orbits that Mass entities share, propagated in batches.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// MaxQOrbitPopulation.cpp is part of the "Blueprints API".
+//
+// TLEs and conics go through their batch propagators, which ParallelFor
+// themselves.  SPK bodies are cache lookups, chunked across cores here.
+//------------------------------------------------------------------------------
+
+#include "MaxQOrbitPopulation.h"
+#include "SpiceEphemerisCache.h"
+#include "SpiceTLECatalog.h"
+#include "Spice.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Bodies per ParallelFor task
+    constexpr int32 ChunkSize = 256;
+}
+
+
+void UMaxQOrbitPopulation::Reset(EMaxQPopulationSource NewSource)
+{
+    Source = NewSource;
+    NumObjects = 0;
+
+    SGP4.Reset();
+    TwoBody.Reset();
+    Cache.Reset();
+
+    SGP4States = MaxQ::Orbits::FSGP4CatalogStates();
+    States.Empty();
+    Valid.Empty();
+
+    bPropagated = false;
+    NumPropagated = 0;
+}
+
+
+int32 UMaxQOrbitPopulation::SetCatalog(const FSTLECatalog& Catalog, const FSTLEGeophysicalConstants& geophs)
+{
+    FSTLEGeophysicalConstants _geophs = geophs;
+    if (_geophs.geophs.Num() != 8)
+    {
+        USpice::getgeophs(_geophs, TEXT("EARTH"));
+    }
+
+    // Objects that failed are still objects, that never propagate
+    TArray<MaxQ::Orbits::FSGP4Propagator> Propagators;
+    MaxQ::Orbits::InitPropagators(Catalog, _geophs, Propagators);
+
+    return SetPropagators(Propagators);
+}
+
+
+int32 UMaxQOrbitPopulation::SetPropagators(TArrayView<const MaxQ::Orbits::FSGP4Propagator> Propagators)
+{
+    Reset(EMaxQPopulationSource::TwoLineElements);
+
+    SGP4.Build(Propagators);
+    NumObjects = SGP4.Num();
+
+    return NumObjects;
+}
+
+
+int32 UMaxQOrbitPopulation::SetConicElements(const TArray<FSConicElements>& ConicElements)
+{
+    Reset(EMaxQPopulationSource::ConicElements);
+
+    TwoBody.Build(ConicElements);
+    NumObjects = TwoBody.Num();
+    States.SetNum(NumObjects);
+
+    return NumObjects;
+}
+
+
+int32 UMaxQOrbitPopulation::SetBodies(TSharedRef<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> _Cache)
+{
+    Reset(EMaxQPopulationSource::Bodies);
+
+    Cache = _Cache;
+    NumObjects = Cache->NumBodies();
+    States.SetNum(NumObjects);
+    Valid.Init(false, NumObjects);
+
+    return NumObjects;
+}
+
+
+int32 UMaxQOrbitPopulation::Propagate(const FSEphemerisTime& et)
+{
+    if (bPropagated && PropagatedEpoch == et.AsSpiceDouble())
+    {
+        return NumPropagated;
+    }
+
+    switch (Source)
+    {
+    case EMaxQPopulationSource::TwoLineElements:
+        NumPropagated = SGP4.Propagate(et, SGP4States, true);
+        break;
+
+    case EMaxQPopulationSource::ConicElements:
+        NumPropagated = TwoBody.Propagate(et, States);
+        break;
+
+    case EMaxQPopulationSource::Bodies:
+    {
+        const double _et = et.AsSpiceDouble();
+        const int32 NumChunks = (NumObjects + ChunkSize - 1) / ChunkSize;
+
+        TArray<int32> Succeeded;
+        Succeeded.Init(0, NumChunks);
+
+        ParallelFor(NumChunks, [&](int32 Chunk)
+        {
+            const int32 End = FMath::Min((Chunk + 1) * ChunkSize, NumObjects);
+            for (int32 i = Chunk * ChunkSize; i < End; ++i)
+            {
+                double r[3] = {}, v[3] = {};
+                Valid[i] = Cache->Evaluate(i, _et, r, v);
+
+                const double state[6] = { r[0], r[1], r[2], v[0], v[1], v[2] };
+                States[i] = FSStateVector(state);
+                Succeeded[Chunk] += Valid[i] ? 1 : 0;
+            }
+        }, NumChunks <= 1);
+
+        NumPropagated = 0;
+        for (int32 n : Succeeded)
+        {
+            NumPropagated += n;
+        }
+        break;
+    }
+
+    default:
+        NumPropagated = 0;
+        break;
+    }
+
+    PropagatedEpoch = et.AsSpiceDouble();
+    bPropagated = true;
+
+    return NumPropagated;
+}
+
+
+bool UMaxQOrbitPopulation::GetState(int32 i, FSStateVector& State) const
+{
+    if (!bPropagated || i < 0 || i >= NumObjects)
+    {
+        return false;
+    }
+
+    switch (Source)
+    {
+    case EMaxQPopulationSource::TwoLineElements:
+    {
+        const MaxQ::Orbits::FSGP4CatalogStates& s = SGP4States;
+        if (s.Status[i] != MaxQ::Orbits::ESGP4Status::Ok)
+        {
+            return false;
+        }
+        const double state[6] = { s.X[i], s.Y[i], s.Z[i], s.VX[i], s.VY[i], s.VZ[i] };
+        State = FSStateVector(state);
+        return true;
+    }
+
+    case EMaxQPopulationSource::ConicElements:
+        State = States[i];
+        return TwoBody.IsValid(i);
+
+    case EMaxQPopulationSource::Bodies:
+        State = States[i];
+        return Valid[i];
+
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,150 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// MaxQMassFragments.h
+//
+// API Comments
+//
+// Purpose:  Mass fragments for orbiting objects.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// MaxQMassFragments.h is part of the "refined C++ API".
+//
+// An orbiting entity has:
+//
+// * FMaxQOrbitFragment, its index in its population
+//   (FMaxQOrbitPopulationFragment, shared).
+// * FMaxQOrbitStateFragment, its state, which UMaxQOrbitPropagationProcessor
+//   writes.
+// * Optionally FMaxQEclipseFragment, its shadow fraction
+//   (UMaxQOrbitEclipseProcessor).
+// * Optionally FMaxQOrbitLODFragment and FMaxQOrbitInstanceFragment, with a
+//   shared FMaxQOrbitVisualizationFragment:  an instance of an ISM, which
+//   UMaxQOrbitLODProcessor and UMaxQOrbitVisualizationProcessor place.
+//
+// SpawnOrbitEntities makes one entity per object of a population, with the
+// fragments the options call for.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "SpiceTypes.h"
+#include "MaxQMassFragments.generated.h"
+
+class UMaxQOrbitPopulation;
+class UInstancedStaticMeshComponent;
+struct FMassEntityManager;
+
+
+// The entity's object, in its population
+USTRUCT()
+struct SPICEMASS_API FMaxQOrbitFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    UPROPERTY() int32 Index = INDEX_NONE;
+};
+
+
+// As of the last propagation, in the population's frame (km, km/s)
+USTRUCT()
+struct SPICEMASS_API FMaxQOrbitStateFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    UPROPERTY() FSStateVector State;
+    // False if the object failed to propagate
+    UPROPERTY() bool bValid = false;
+};
+
+
+// The fraction of the Sun's disk that's hidden:  0 sunlit, 1 umbra
+USTRUCT()
+struct SPICEMASS_API FMaxQEclipseFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    UPROPERTY() float ShadowFraction = 0.f;
+};
+
+
+USTRUCT()
+struct SPICEMASS_API FMaxQOrbitLODFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    // From the viewer (UE units)
+    UPROPERTY() double Distance = 0.;
+    // LODDistances.Num():  culled
+    UPROPERTY() uint8 LOD = 0;
+};
+
+
+USTRUCT()
+struct SPICEMASS_API FMaxQOrbitInstanceFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    UPROPERTY() int32 InstanceIndex = INDEX_NONE;
+    // Last written at zero scale
+    UPROPERTY() bool bHidden = true;
+};
+
+
+USTRUCT()
+struct SPICEMASS_API FMaxQOrbitPopulationFragment : public FMassConstSharedFragment
+{
+    GENERATED_BODY()
+
+    // Keep a reference to it:  shared fragments don't
+    UPROPERTY() TWeakObjectPtr<UMaxQOrbitPopulation> Population;
+};
+
+
+USTRUCT()
+struct SPICEMASS_API FMaxQOrbitVisualizationFragment : public FMassConstSharedFragment
+{
+    GENERATED_BODY()
+
+    // Instances are placed relative to it, with (0, 0, 0) the population's
+    // center
+    UPROPERTY() TWeakObjectPtr<UInstancedStaticMeshComponent> Instances;
+
+    // UE units per km.  0:  the ephemeris subsystem's Scale.
+    UPROPERTY() double Scale = 0.;
+    UPROPERTY() FVector InstanceScale = FVector::OneVector;
+
+    // LOD n is out to LODDistances[n] (UE units, increasing) from the
+    // viewer, and beyond the last is culled.  LOD n's transforms are written
+    // every 2^n frames (staggered across instances).  Empty:  LOD 0
+    // everywhere.
+    UPROPERTY() TArray<double> LODDistances;
+};
+
+
+namespace MaxQ::Mass
+{
+    // One entity per object of Population, in order.  With Visualization's
+    // Instances, each gets an instance (hidden until it's first placed),
+    // and with bEclipse, custom data 0 is its shadow fraction.  Returns the
+    // number made.
+    SPICEMASS_API int32 SpawnOrbitEntities(
+        FMassEntityManager& EntityManager,
+        UMaxQOrbitPopulation* Population,
+        const FMaxQOrbitVisualizationFragment& Visualization,
+        bool bEclipse,
+        TArray<FMassEntityHandle>& OutEntities
+    );
+}
@@ -0,0 +1,129 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// MaxQMassProcessors.h
+//
+// API Comments
+//
+// Purpose:  Mass processors for orbiting objects.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// MaxQMassProcessors.h is part of the "refined C++ API".
+//
+// An actor per object (the samples' telemetry and body actors) costs a tick
+// and a transform each, and stops fitting in a frame at a few thousand.
+// These processors work over Mass chunks instead, in the "MaxQ" group,
+// before physics, in order:
+//
+// * Propagation:  each population is propagated once, with its batch
+//   propagator (across all cores), to the ephemeris subsystem's Epoch.
+//   Then each chunk's states are copied out, contiguously.
+// * Eclipse:  the Sun and the occulter are looked up once per frame
+//   (CSPICE, game thread), and each chunk's shadow fractions are computed
+//   from its positions in one EclipseStates batch.
+// * LOD:  distance from the first player's camera, binned by the
+//   visualization's LODDistances.
+// * Visualization:  instance transforms (and custom data 0, the shadow
+//   fraction), written every 2^LOD frames, culled instances once at zero
+//   scale.  The render state is marked dirty once per component.
+//
+// World placement is as UMaxQCatalogComponent's:  Swizzle(r) * Scale,
+// relative to the ISM component.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "SpiceTypes.h"
+#include "MaxQMassProcessors.generated.h"
+
+
+UCLASS()
+class SPICEMASS_API UMaxQOrbitPropagationProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQOrbitPropagationProcessor();
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+};
+
+
+UCLASS(Config = Game)
+class SPICEMASS_API UMaxQOrbitEclipseProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQOrbitEclipseProcessor();
+
+    // The frame the populations' states are in (TLEs:  TEME, taken as J2000)
+    UPROPERTY(Config, EditDefaultsOnly, Category = "MaxQ|Mass") FString Frame = TEXT("J2000");
+    UPROPERTY(Config, EditDefaultsOnly, Category = "MaxQ|Mass") FString Source = TEXT("SUN");
+    // The populations' center
+    UPROPERTY(Config, EditDefaultsOnly, Category = "MaxQ|Mass") FString Occulter = TEXT("EARTH");
+    UPROPERTY(Config, EditDefaultsOnly, Category = "MaxQ|Mass") FString OcculterFrame = TEXT("IAU_EARTH");
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+
+    // Per chunk scratch
+    TArray<double> X, Y, Z;
+    TArray<float> ShadowFraction;
+};
+
+
+UCLASS()
+class SPICEMASS_API UMaxQOrbitLODProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQOrbitLODProcessor();
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+};
+
+
+UCLASS()
+class SPICEMASS_API UMaxQOrbitVisualizationProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UMaxQOrbitVisualizationProcessor();
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+};
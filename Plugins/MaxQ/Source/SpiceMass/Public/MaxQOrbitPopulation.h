@@ -0,0 +1,115 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// MaxQOrbitPopulation.h
+//
+// API Comments
+//
+// Purpose:  A set of orbits that Mass entities share, propagated in batches.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// MaxQOrbitPopulation.h is part of the "Blueprints API".
+//
+// The batch propagators run a whole set of objects at a time, across all
+// cores.  Entities don't each carry their own propagator:  they share a
+// population (a const shared fragment), and carry their index in it.  The
+// propagation processor propagates each population once per epoch, however
+// many chunks its entities span, and then copies each chunk's states out.
+//
+// A population has one source:
+//
+// * TLEs, propagated by FSGP4BatchPropagator.  States are Earth centered
+//   TEME.
+// * Conic elements, propagated by FTwoBodyBatchPropagator, relative to the
+//   elements' center in the elements' frame.
+// * SPK bodies, from an FChebyshevCache (object i is the cache's body i),
+//   relative to the cache's observer in its frame.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "SpiceTypes.h"
+#include "SpiceSGP4.h"
+#include "SpiceSGP4Batch.h"
+#include "SpiceTwoBody.h"
+#include "MaxQOrbitPopulation.generated.h"
+
+namespace MaxQ::Ephemeris
+{
+    class FChebyshevCache;
+}
+
+
+UENUM(BlueprintType)
+enum class EMaxQPopulationSource : uint8
+{
+    None,
+    TwoLineElements UMETA(DisplayName = "Two Line Elements (SGP4)"),
+    ConicElements UMETA(DisplayName = "Conic Elements (Two Body)"),
+    Bodies UMETA(DisplayName = "SPK Bodies (Chebyshev Cache)")
+};
+
+
+UCLASS(BlueprintType)
+class SPICEMASS_API UMaxQOrbitPopulation : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    // Each replaces the population, and returns the number of objects.
+    // Empty geophs:  getgeophs("EARTH").
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Mass")
+    int32 SetCatalog(const FSTLECatalog& Catalog, const FSTLEGeophysicalConstants& geophs);
+    int32 SetPropagators(TArrayView<const MaxQ::Orbits::FSGP4Propagator> Propagators);
+
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Mass")
+    int32 SetConicElements(const TArray<FSConicElements>& ConicElements);
+
+    int32 SetBodies(TSharedRef<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> Cache);
+
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Mass")
+    int32 Num() const { return NumObjects; }
+    UFUNCTION(BlueprintPure, Category = "MaxQ|Mass")
+    EMaxQPopulationSource GetSource() const { return Source; }
+
+    // Every object, to et, across all cores.  Nothing to do if it's already
+    // there.  Thread-safe (no CSPICE), but not reentrant.  Returns the number
+    // propagated without error.
+    int32 Propagate(const FSEphemerisTime& et);
+
+    // As of the last Propagate.  False if object i failed (or there's no
+    // object i).
+    bool GetState(int32 i, FSStateVector& State) const;
+
+private:
+    void Reset(EMaxQPopulationSource NewSource);
+
+    EMaxQPopulationSource Source = EMaxQPopulationSource::None;
+    int32 NumObjects = 0;
+
+    MaxQ::Orbits::FSGP4BatchPropagator SGP4;
+    MaxQ::Orbits::FTwoBodyBatchPropagator TwoBody;
+    TSharedPtr<const MaxQ::Ephemeris::FChebyshevCache, ESPMode::ThreadSafe> Cache;
+
+    // TwoLineElements'
+    MaxQ::Orbits::FSGP4CatalogStates SGP4States;
+    // The others'
+    TArray<FSStateVector> States;
+    TArray<bool> Valid;
+
+    double PropagatedEpoch = 0.;
+    bool bPropagated = false;
+    int32 NumPropagated = 0;
+};
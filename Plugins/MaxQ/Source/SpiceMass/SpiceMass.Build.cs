@@ -0,0 +1,21 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+
+using UnrealBuildTool;
+
+// Optional Mass Entity fragments and processors.  Needs the MassEntity plugin
+// enabled (see MaxQ.uplugin's Plugins list).
+public class SpiceMass : ModuleRules
+{
+    public SpiceMass(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "MassEntity", "Spice" });
+    }
+}
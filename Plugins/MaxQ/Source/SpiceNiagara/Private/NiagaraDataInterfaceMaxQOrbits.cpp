@@ -0,0 +1,679 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// NiagaraDataInterfaceMaxQOrbits.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Orbital positions for Niagara particles, on the CPU VM or GPU.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// NiagaraDataInterfaceMaxQOrbits.cpp is part of the "Blueprints API".
+//
+// The snapshot is three float4s per object:  position (w:  1 if the object
+// was evaluated, 0 if not), velocity, acceleration, all in UE units.  The
+// game thread copies it to the render thread each tick, where it's written
+// into a buffer that only grows.
+//
+// Accelerations are central body gravity for SGP4 and two body objects
+// (-mu r / |r|^3) and the difference of the cache's velocities a minute
+// either side of the epoch for SPK bodies.
+//------------------------------------------------------------------------------
+
+#include "NiagaraDataInterfaceMaxQOrbits.h"
+#include "NiagaraShaderParametersBuilder.h"
+#include "NiagaraSystemInstance.h"
+#include "NiagaraRenderer.h"
+#include "NiagaraTypes.h"
+#include "VectorVM.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "RenderResource.h"
+#include "SpiceEphemerisSubsystem.h"
+#include "SpiceEphemerisCache.h"
+#include "SpiceSGP4.h"
+#include "SpiceSGP4Batch.h"
+#include "SpiceTLECatalog.h"
+#include "SpiceTwoBody.h"
+#include "SpiceLog.h"
+#include "Spice.h"
+
+namespace
+{
+    const FName GetNumObjectsName(TEXT("GetNumObjects"));
+    const FName GetPositionName(TEXT("GetPosition"));
+    const FName GetVelocityName(TEXT("GetVelocity"));
+
+    // Objects per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    // SPK bodies:  accelerations from velocities this far either side
+    constexpr double AccelerationStep = 60.;
+
+    struct FNDIMaxQOrbitsInstanceData
+    {
+        EMaxQOrbitSource Source = EMaxQOrbitSource::TwoLineElements;
+        int32 Num = 0;
+
+        MaxQ::Orbits::FSGP4BatchPropagator SGP4;
+        double SGP4Mu = 0.;
+        MaxQ::Orbits::FTwoBodyBatchPropagator TwoBody;
+        TArray<double> TwoBodyMu;
+        MaxQ::Ephemeris::FChebyshevCache Cache;
+
+        bool bFollowSubsystem = true;
+        FSEphemerisTime Epoch;
+        double Scale = 1.;
+        FVector Origin = FVector::ZeroVector;
+        TWeakObjectPtr<UWorld> World;
+
+        // Scratch
+        MaxQ::Orbits::FSGP4CatalogStates SGP4States;
+        TArray<FSStateVector> TwoBodyStates;
+
+        TArray<FVector4f> Snapshot;
+    };
+
+    struct FNDIMaxQOrbitsGameToRender
+    {
+        TArray<FVector4f> Snapshot;
+    };
+
+    struct FNDIMaxQOrbitsInstanceData_RT
+    {
+        FReadBuffer Buffer;
+        int32 Capacity = 0;
+        int32 NumObjects = 0;
+
+        ~FNDIMaxQOrbitsInstanceData_RT()
+        {
+            Buffer.Release();
+        }
+    };
+
+    struct FNDIMaxQOrbitsProxy : public FNiagaraDataInterfaceProxy
+    {
+        virtual int32 PerInstanceDataPassedToRenderThreadSize() const override
+        {
+            return sizeof(FNDIMaxQOrbitsGameToRender);
+        }
+
+        virtual void ConsumePerInstanceDataFromGameThread(void* PerInstanceData, const FNiagaraSystemInstanceID& Instance) override
+        {
+            check(IsInRenderingThread());
+
+            FNDIMaxQOrbitsGameToRender* Data = static_cast<FNDIMaxQOrbitsGameToRender*>(PerInstanceData);
+            FNDIMaxQOrbitsInstanceData_RT& InstanceData = SystemInstancesToData.FindOrAdd(Instance);
+
+            const int32 NumElements = Data->Snapshot.Num();
+            InstanceData.NumObjects = NumElements / 3;
+            if (NumElements > 0)
+            {
+                if (NumElements > InstanceData.Capacity)
+                {
+                    InstanceData.Buffer.Release();
+                    InstanceData.Buffer.Initialize(TEXT("MaxQOrbitsSnapshot"), sizeof(FVector4f), NumElements, PF_A32B32G32R32F, BUF_Dynamic);
+                    InstanceData.Capacity = NumElements;
+                }
+
+                const uint32 Bytes = NumElements * sizeof(FVector4f);
+                void* Dest = RHILockBuffer(InstanceData.Buffer.Buffer, 0, Bytes, RLM_WriteOnly);
+                FMemory::Memcpy(Dest, Data->Snapshot.GetData(), Bytes);
+                RHIUnlockBuffer(InstanceData.Buffer.Buffer);
+            }
+
+            Data->~FNDIMaxQOrbitsGameToRender();
+        }
+
+        TMap<FNiagaraSystemInstanceID, FNDIMaxQOrbitsInstanceData_RT> SystemInstancesToData;
+    };
+
+    inline FVector4f ToUE(const double(&v)[3], double Scale, const FVector& Origin, float w)
+    {
+        return FVector4f(float(v[1] * Scale - Origin.X), float(v[0] * Scale - Origin.Y), float(v[2] * Scale - Origin.Z), w);
+    }
+
+    inline void CentralAcceleration(const double(&r)[3], double mu, double(&a)[3])
+    {
+        const double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+        const double k = r2 > 0. ? -mu / (r2 * FMath::Sqrt(r2)) : 0.;
+        a[0] = k * r[0];
+        a[1] = k * r[1];
+        a[2] = k * r[2];
+    }
+
+    void AddSignature(TArray<FNiagaraFunctionSignature>& OutFunctions, UClass* Class, FName Name)
+    {
+        FNiagaraFunctionSignature Sig;
+        Sig.Name = Name;
+        Sig.bMemberFunction = true;
+        Sig.bRequiresContext = false;
+        Sig.bSupportsCPU = true;
+        Sig.bSupportsGPU = true;
+        Sig.Inputs.Add(FNiagaraVariable(FNiagaraTypeDefinition(Class), TEXT("Orbits")));
+
+        if (Name == GetNumObjectsName)
+        {
+            Sig.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("NumObjects")));
+        }
+        else
+        {
+            Sig.Inputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("Index")));
+            Sig.Inputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetFloatDef(), TEXT("TimeOffset")));
+            Sig.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetVec3Def(), Name == GetPositionName ? TEXT("Position") : TEXT("Velocity")));
+            Sig.Outputs.Add(FNiagaraVariable(FNiagaraTypeDefinition::GetBoolDef(), TEXT("Valid")));
+        }
+
+#if WITH_EDITORONLY_DATA
+        if (Name == GetNumObjectsName)
+        {
+            Sig.SetDescription(NSLOCTEXT("MaxQOrbits", "GetNumObjects", "The number of objects (valid or not)."));
+        }
+        else if (Name == GetPositionName)
+        {
+            Sig.SetDescription(NSLOCTEXT("MaxQOrbits", "GetPosition", "An object's position (UE units, relative to Origin), TimeOffset seconds from the epoch."));
+        }
+        else
+        {
+            Sig.SetDescription(NSLOCTEXT("MaxQOrbits", "GetVelocity", "An object's velocity (UE units / s), TimeOffset seconds from the epoch."));
+        }
+#endif
+        OutFunctions.Add(Sig);
+    }
+}
+
+
+UNiagaraDataInterfaceMaxQOrbits::UNiagaraDataInterfaceMaxQOrbits(FObjectInitializer const& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    Proxy.Reset(new FNDIMaxQOrbitsProxy());
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::PostInitProperties()
+{
+    Super::PostInitProperties();
+
+    if (HasAnyFlags(RF_ClassDefaultObject))
+    {
+        ENiagaraTypeRegistryFlags Flags = ENiagaraTypeRegistryFlags::AllowAnyVariable | ENiagaraTypeRegistryFlags::AllowParameter;
+        FNiagaraTypeRegistry::Register(FNiagaraTypeDefinition(GetClass()), Flags);
+    }
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::GetFunctions(TArray<FNiagaraFunctionSignature>& OutFunctions)
+{
+    AddSignature(OutFunctions, GetClass(), GetNumObjectsName);
+    AddSignature(OutFunctions, GetClass(), GetPositionName);
+    AddSignature(OutFunctions, GetClass(), GetVelocityName);
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::GetVMExternalFunction(const FVMExternalFunctionBindingInfo& BindingInfo, void* InstanceData, FVMExternalFunction& OutFunc)
+{
+    if (BindingInfo.Name == GetNumObjectsName)
+    {
+        OutFunc = FVMExternalFunction::CreateUObject(this, &UNiagaraDataInterfaceMaxQOrbits::VMGetNumObjects);
+    }
+    else if (BindingInfo.Name == GetPositionName)
+    {
+        OutFunc = FVMExternalFunction::CreateUObject(this, &UNiagaraDataInterfaceMaxQOrbits::VMGetPosition);
+    }
+    else if (BindingInfo.Name == GetVelocityName)
+    {
+        OutFunc = FVMExternalFunction::CreateUObject(this, &UNiagaraDataInterfaceMaxQOrbits::VMGetVelocity);
+    }
+}
+
+
+bool UNiagaraDataInterfaceMaxQOrbits::Equals(const UNiagaraDataInterface* Other) const
+{
+    if (!Super::Equals(Other))
+    {
+        return false;
+    }
+
+    const UNiagaraDataInterfaceMaxQOrbits* o = CastChecked<const UNiagaraDataInterfaceMaxQOrbits>(Other);
+    if (o->ConicElements.Num() != ConicElements.Num())
+    {
+        return false;
+    }
+    for (int32 i = 0; i < ConicElements.Num(); ++i)
+    {
+        if (FMemory::Memcmp(&o->ConicElements[i], &ConicElements[i], sizeof(FSConicElements)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return o->Source == Source
+        && o->TwoLineElements == TwoLineElements
+        && o->Bodies == Bodies
+        && o->Observer == Observer
+        && o->Frame == Frame
+        && o->CacheStart.seconds == CacheStart.seconds
+        && o->CacheStop.seconds == CacheStop.seconds
+        && o->bFollowSubsystem == bFollowSubsystem
+        && o->Epoch.seconds == Epoch.seconds
+        && o->Scale == Scale
+        && o->Origin == Origin;
+}
+
+
+bool UNiagaraDataInterfaceMaxQOrbits::CopyToInternal(UNiagaraDataInterface* Destination) const
+{
+    if (!Super::CopyToInternal(Destination))
+    {
+        return false;
+    }
+
+    UNiagaraDataInterfaceMaxQOrbits* d = CastChecked<UNiagaraDataInterfaceMaxQOrbits>(Destination);
+    d->Source = Source;
+    d->TwoLineElements = TwoLineElements;
+    d->ConicElements = ConicElements;
+    d->Bodies = Bodies;
+    d->Observer = Observer;
+    d->Frame = Frame;
+    d->CacheStart = CacheStart;
+    d->CacheStop = CacheStop;
+    d->bFollowSubsystem = bFollowSubsystem;
+    d->Epoch = Epoch;
+    d->Scale = Scale;
+    d->Origin = Origin;
+    return true;
+}
+
+
+bool UNiagaraDataInterfaceMaxQOrbits::InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+    FNDIMaxQOrbitsInstanceData* Instance = new (PerInstanceData) FNDIMaxQOrbitsInstanceData();
+    Instance->Source = Source;
+    Instance->bFollowSubsystem = bFollowSubsystem;
+    Instance->Epoch = Epoch;
+    Instance->Scale = Scale;
+    Instance->Origin = Origin;
+    Instance->World = SystemInstance->GetWorld();
+
+    ES_ResultCode ResultCode = ES_ResultCode::Success;
+    FString ErrorMessage;
+
+    switch (Source)
+    {
+    case EMaxQOrbitSource::TwoLineElements:
+    {
+        FSTLECatalog Catalog;
+        MaxQ::Orbits::ParseTLECatalog(TwoLineElements, Catalog, MaxQ::Orbits::ETLECatalogFormat::Auto, 1957, &ResultCode, &ErrorMessage);
+
+        FSTLEGeophysicalConstants geophs;
+        USpice::getgeophs(geophs, TEXT("EARTH"));
+
+        TArray<MaxQ::Orbits::FSGP4Propagator> Propagators;
+        ES_ResultCode InitResultCode = ES_ResultCode::Success;
+        FString InitErrorMessage;
+        MaxQ::Orbits::InitPropagators(Catalog, geophs, Propagators, &InitResultCode, &InitErrorMessage);
+        if (ResultCode == ES_ResultCode::Success && InitResultCode != ES_ResultCode::Success)
+        {
+            ResultCode = InitResultCode;
+            ErrorMessage = InitErrorMessage;
+        }
+
+        Instance->SGP4.Build(Propagators);
+
+        // KE is sqrt(GM) in earth radii^1.5 per minute
+        if (geophs.geophs.Num() == 8)
+        {
+            const double ke = geophs.geophs[3];
+            const double er = geophs.geophs[6];
+            Instance->SGP4Mu = FMath::Square(ke * er * FMath::Sqrt(er) / 60.);
+        }
+        Instance->Num = Instance->SGP4.Num();
+        break;
+    }
+
+    case EMaxQOrbitSource::ConicElements:
+        Instance->TwoBody.Build(ConicElements);
+        Instance->TwoBodyMu.Reserve(ConicElements.Num());
+        for (const FSConicElements& Elements : ConicElements)
+        {
+            Instance->TwoBodyMu.Add(Elements.GravitationalParameter.GM);
+        }
+        Instance->Num = Instance->TwoBody.Num();
+        break;
+
+    default:
+        Instance->Cache.Build(Bodies, Observer, Frame, CacheStart, CacheStop, MaxQ::Ephemeris::FChebyshevCacheSettings(), ES_AberrationCorrectionWithNewtonians::None, &ResultCode, &ErrorMessage);
+        Instance->Num = Instance->Cache.NumBodies();
+        break;
+    }
+
+    if (ResultCode != ES_ResultCode::Success)
+    {
+        // Keep going with whatever did load
+        UE_LOG(LogSpice, Warning, TEXT("MaxQ Orbits data interface: %s"), *ErrorMessage);
+    }
+
+    Instance->Snapshot.SetNumZeroed(3 * Instance->Num);
+    return true;
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+    FNDIMaxQOrbitsInstanceData* Instance = static_cast<FNDIMaxQOrbitsInstanceData*>(PerInstanceData);
+    Instance->~FNDIMaxQOrbitsInstanceData();
+
+    ENQUEUE_RENDER_COMMAND(FNDIMaxQOrbitsRemoveInstance)(
+        [RT_Proxy = GetProxyAs<FNDIMaxQOrbitsProxy>(), InstanceID = SystemInstance->GetId()](FRHICommandListImmediate&)
+        {
+            RT_Proxy->SystemInstancesToData.Remove(InstanceID);
+        });
+}
+
+
+int32 UNiagaraDataInterfaceMaxQOrbits::PerInstanceDataSize() const
+{
+    return sizeof(FNDIMaxQOrbitsInstanceData);
+}
+
+
+bool UNiagaraDataInterfaceMaxQOrbits::PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds)
+{
+    FNDIMaxQOrbitsInstanceData& d = *static_cast<FNDIMaxQOrbitsInstanceData*>(PerInstanceData);
+
+    double et = d.Epoch.AsSpiceDouble();
+    if (d.bFollowSubsystem)
+    {
+        UWorld* World = d.World.Get();
+        if (const UMaxQEphemerisSubsystem* Subsystem = World ? World->GetSubsystem<UMaxQEphemerisSubsystem>() : nullptr)
+        {
+            et = Subsystem->Epoch.AsSpiceDouble();
+        }
+    }
+
+    const int32 Num = d.Num;
+    if (Num == 0)
+    {
+        return false;
+    }
+
+    switch (d.Source)
+    {
+    case EMaxQOrbitSource::TwoLineElements:
+        d.SGP4.Propagate(FSEphemerisTime(et), d.SGP4States, true);
+        break;
+    case EMaxQOrbitSource::ConicElements:
+        d.TwoBodyStates.SetNum(Num, false);
+        d.TwoBody.Propagate(FSEphemerisTime(et), d.TwoBodyStates);
+        break;
+    default:
+        break;
+    }
+
+    const double Start = d.Cache.GetStart().AsSpiceDouble();
+    const double Stop = d.Cache.GetStop().AsSpiceDouble();
+    const double Before = FMath::Clamp(et - AccelerationStep, Start, Stop);
+    const double After = FMath::Clamp(et + AccelerationStep, Start, Stop);
+
+    ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+    {
+        const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+        for (int32 i = Chunk * ChunkSize; i < End; ++i)
+        {
+            double r[3] = {}, v[3] = {}, a[3] = {};
+            bool bValid = false;
+
+            switch (d.Source)
+            {
+            case EMaxQOrbitSource::TwoLineElements:
+                bValid = d.SGP4States.Status[i] == MaxQ::Orbits::ESGP4Status::Ok;
+                if (bValid)
+                {
+                    r[0] = d.SGP4States.X[i]; r[1] = d.SGP4States.Y[i]; r[2] = d.SGP4States.Z[i];
+                    v[0] = d.SGP4States.VX[i]; v[1] = d.SGP4States.VY[i]; v[2] = d.SGP4States.VZ[i];
+                    CentralAcceleration(r, d.SGP4Mu, a);
+                }
+                break;
+
+            case EMaxQOrbitSource::ConicElements:
+            {
+                bValid = d.TwoBody.IsValid(i);
+                double state[6];
+                d.TwoBodyStates[i].CopyTo(state);
+                r[0] = state[0]; r[1] = state[1]; r[2] = state[2];
+                v[0] = state[3]; v[1] = state[4]; v[2] = state[5];
+                CentralAcceleration(r, d.TwoBodyMu[i], a);
+                break;
+            }
+
+            default:
+            {
+                bValid = d.Cache.Evaluate(i, et, r, v);
+                double r0[3], v0[3], r1[3], v1[3];
+                if (bValid && After > Before && d.Cache.Evaluate(i, Before, r0, v0) && d.Cache.Evaluate(i, After, r1, v1))
+                {
+                    for (int32 k = 0; k < 3; ++k)
+                    {
+                        a[k] = (v1[k] - v0[k]) / (After - Before);
+                    }
+                }
+                break;
+            }
+            }
+
+            d.Snapshot[3 * i + 0] = ToUE(r, d.Scale, d.Origin, bValid ? 1.f : 0.f);
+            d.Snapshot[3 * i + 1] = ToUE(v, d.Scale, FVector::ZeroVector, 0.f);
+            d.Snapshot[3 * i + 2] = ToUE(a, d.Scale, FVector::ZeroVector, 0.f);
+        }
+    }, Num <= ChunkSize);
+
+    return false;
+}
+
+
+int32 UNiagaraDataInterfaceMaxQOrbits::PerInstanceDataPassedToRenderThreadSize() const
+{
+    return sizeof(FNDIMaxQOrbitsGameToRender);
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::ProvidePerInstanceDataForRenderThread(void* DataForRenderThread, void* PerInstanceData, const FNiagaraSystemInstanceID& SystemInstance)
+{
+    const FNDIMaxQOrbitsInstanceData* Instance = static_cast<const FNDIMaxQOrbitsInstanceData*>(PerInstanceData);
+    FNDIMaxQOrbitsGameToRender* Data = new (DataForRenderThread) FNDIMaxQOrbitsGameToRender();
+    Data->Snapshot = Instance->Snapshot;
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::VMGetNumObjects(FVectorVMExternalFunctionContext& Context)
+{
+    VectorVM::FUserPtrHandler<FNDIMaxQOrbitsInstanceData> InstData(Context);
+    FNDIOutputParam<int32> OutNum(Context);
+
+    const int32 Num = InstData->Num;
+    for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+    {
+        OutNum.SetAndAdvance(Num);
+    }
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::VMGetPosition(FVectorVMExternalFunctionContext& Context)
+{
+    VectorVM::FUserPtrHandler<FNDIMaxQOrbitsInstanceData> InstData(Context);
+    FNDIInputParam<int32> InIndex(Context);
+    FNDIInputParam<float> InTimeOffset(Context);
+    FNDIOutputParam<FVector3f> OutPosition(Context);
+    FNDIOutputParam<FNiagaraBool> OutValid(Context);
+
+    const TArray<FVector4f>& Snapshot = InstData->Snapshot;
+    const int32 Num = Snapshot.Num() / 3;
+    for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+    {
+        const int32 Index = InIndex.GetAndAdvance();
+        const float t = InTimeOffset.GetAndAdvance();
+        if (Index >= 0 && Index < Num)
+        {
+            const FVector4f& r = Snapshot[3 * Index];
+            const FVector3f v(Snapshot[3 * Index + 1]);
+            const FVector3f a(Snapshot[3 * Index + 2]);
+            OutPosition.SetAndAdvance(FVector3f(r) + v * t + a * (0.5f * t * t));
+            OutValid.SetAndAdvance(r.W > 0.f);
+        }
+        else
+        {
+            OutPosition.SetAndAdvance(FVector3f::ZeroVector);
+            OutValid.SetAndAdvance(false);
+        }
+    }
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::VMGetVelocity(FVectorVMExternalFunctionContext& Context)
+{
+    VectorVM::FUserPtrHandler<FNDIMaxQOrbitsInstanceData> InstData(Context);
+    FNDIInputParam<int32> InIndex(Context);
+    FNDIInputParam<float> InTimeOffset(Context);
+    FNDIOutputParam<FVector3f> OutVelocity(Context);
+    FNDIOutputParam<FNiagaraBool> OutValid(Context);
+
+    const TArray<FVector4f>& Snapshot = InstData->Snapshot;
+    const int32 Num = Snapshot.Num() / 3;
+    for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+    {
+        const int32 Index = InIndex.GetAndAdvance();
+        const float t = InTimeOffset.GetAndAdvance();
+        if (Index >= 0 && Index < Num)
+        {
+            const FVector3f v(Snapshot[3 * Index + 1]);
+            const FVector3f a(Snapshot[3 * Index + 2]);
+            OutVelocity.SetAndAdvance(v + a * t);
+            OutValid.SetAndAdvance(Snapshot[3 * Index].W > 0.f);
+        }
+        else
+        {
+            OutVelocity.SetAndAdvance(FVector3f::ZeroVector);
+            OutValid.SetAndAdvance(false);
+        }
+    }
+}
+
+
+#if WITH_EDITORONLY_DATA
+bool UNiagaraDataInterfaceMaxQOrbits::AppendCompileHash(FNiagaraCompileHashVisitor* InVisitor) const
+{
+    bool bSuccess = Super::AppendCompileHash(InVisitor);
+    bSuccess &= InVisitor->UpdateShaderParameters<FShaderParameters>();
+    // Bump when the HLSL below changes
+    bSuccess &= InVisitor->UpdateString(TEXT("NiagaraDataInterfaceMaxQOrbitsHLSL"), TEXT("1"));
+    return bSuccess;
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::GetParameterDefinitionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, FString& OutHLSL)
+{
+    const TMap<FString, FStringFormatArg> Args = { { TEXT("Symbol"), ParamInfo.DataInterfaceHLSLSymbol } };
+    OutHLSL += FString::Format(TEXT(
+        "int {Symbol}_NumObjects;\n"
+        "Buffer<float4> {Symbol}_Snapshot;\n"
+    ), Args);
+}
+
+
+bool UNiagaraDataInterfaceMaxQOrbits::GetFunctionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, const FNiagaraDataInterfaceGeneratedFunction& FunctionInfo, int FunctionInstanceIndex, FString& OutHLSL)
+{
+    const TMap<FString, FStringFormatArg> Args = {
+        { TEXT("Function"), FunctionInfo.InstanceName },
+        { TEXT("Symbol"), ParamInfo.DataInterfaceHLSLSymbol }
+    };
+
+    if (FunctionInfo.DefinitionName == GetNumObjectsName)
+    {
+        OutHLSL += FString::Format(TEXT(
+            "void {Function}(out int OutNumObjects)\n"
+            "{\n"
+            "    OutNumObjects = {Symbol}_NumObjects;\n"
+            "}\n"
+        ), Args);
+        return true;
+    }
+
+    if (FunctionInfo.DefinitionName == GetPositionName)
+    {
+        OutHLSL += FString::Format(TEXT(
+            "void {Function}(int Index, float TimeOffset, out float3 OutPosition, out bool OutValid)\n"
+            "{\n"
+            "    if (Index < 0 || Index >= {Symbol}_NumObjects)\n"
+            "    {\n"
+            "        OutPosition = float3(0, 0, 0);\n"
+            "        OutValid = false;\n"
+            "        return;\n"
+            "    }\n"
+            "    const float4 r = {Symbol}_Snapshot[Index * 3];\n"
+            "    const float3 v = {Symbol}_Snapshot[Index * 3 + 1].xyz;\n"
+            "    const float3 a = {Symbol}_Snapshot[Index * 3 + 2].xyz;\n"
+            "    OutPosition = r.xyz + v * TimeOffset + a * (0.5f * TimeOffset * TimeOffset);\n"
+            "    OutValid = r.w > 0;\n"
+            "}\n"
+        ), Args);
+        return true;
+    }
+
+    if (FunctionInfo.DefinitionName == GetVelocityName)
+    {
+        OutHLSL += FString::Format(TEXT(
+            "void {Function}(int Index, float TimeOffset, out float3 OutVelocity, out bool OutValid)\n"
+            "{\n"
+            "    if (Index < 0 || Index >= {Symbol}_NumObjects)\n"
+            "    {\n"
+            "        OutVelocity = float3(0, 0, 0);\n"
+            "        OutValid = false;\n"
+            "        return;\n"
+            "    }\n"
+            "    const float3 v = {Symbol}_Snapshot[Index * 3 + 1].xyz;\n"
+            "    const float3 a = {Symbol}_Snapshot[Index * 3 + 2].xyz;\n"
+            "    OutVelocity = v + a * TimeOffset;\n"
+            "    OutValid = {Symbol}_Snapshot[Index * 3].w > 0;\n"
+            "}\n"
+        ), Args);
+        return true;
+    }
+
+    return false;
+}
+#endif
+
+
+void UNiagaraDataInterfaceMaxQOrbits::BuildShaderParameters(FNiagaraShaderParametersBuilder& ShaderParametersBuilder) const
+{
+    ShaderParametersBuilder.AddNestedStruct<FShaderParameters>();
+}
+
+
+void UNiagaraDataInterfaceMaxQOrbits::SetShaderParameters(const FNiagaraDataInterfaceSetShaderParametersContext& Context) const
+{
+    FNDIMaxQOrbitsProxy& DIProxy = Context.GetProxy<FNDIMaxQOrbitsProxy>();
+    const FNDIMaxQOrbitsInstanceData_RT* InstanceData = DIProxy.SystemInstancesToData.Find(Context.GetSystemInstanceID());
+
+    FShaderParameters* Parameters = Context.GetParameterNestedStruct<FShaderParameters>();
+    if (InstanceData && InstanceData->NumObjects > 0 && InstanceData->Buffer.SRV.IsValid())
+    {
+        Parameters->NumObjects = InstanceData->NumObjects;
+        Parameters->Snapshot = InstanceData->Buffer.SRV;
+    }
+    else
+    {
+        Parameters->NumObjects = 0;
+        Parameters->Snapshot = FNiagaraRenderer::GetDummyFloat4Buffer();
+    }
+}
@@ -0,0 +1,135 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// NiagaraDataInterfaceMaxQOrbits.h
+//
+// API Comments
+//
+// Purpose:  Orbital positions for Niagara particles, on the CPU VM or GPU.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// NiagaraDataInterfaceMaxQOrbits.h is part of the "Blueprints API".
+//
+// Particles look objects up by index:  GetPosition(Index, TimeOffset).  The
+// objects come from one of three sources, set up once when the system
+// instance starts:
+//
+// * TLE text (2/3 line or OMM JSON), propagated by FSGP4BatchPropagator.
+//   States are Earth centered TEME.
+// * Conic elements, propagated by FTwoBodyBatchPropagator, relative to the
+//   elements' center in the elements' frame.
+// * SPK bodies, fitted by FChebyshevCache over [CacheStart, CacheStop].
+//
+// Setting up parses the TLEs or builds the cache, which calls CSPICE (game
+// thread, once).  Every tick after that the whole set is evaluated natively,
+// in parallel, at the epoch (the ephemeris subsystem's, or Epoch):  position,
+// velocity and acceleration per object, swizzled to UE, scaled, and made
+// relative to Origin.  That snapshot is what both the CPU VM and the GPU
+// read, so the sim targets agree.
+//
+// Niagara only has floats, and an ephemeris time doesn't fit in one, so
+// particles give times as TimeOffset:  seconds from the tick's epoch.  The
+// offset is applied with the snapshot's second order expansion
+// (r + v t + a t^2 / 2).  That's what trails and motion blur need, to within
+// a few hundred meters over a minute for LEO.  For anything further out,
+// move the epoch instead.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NiagaraDataInterface.h"
+#include "NiagaraCommon.h"
+#include "SpiceTypes.h"
+#include "NiagaraDataInterfaceMaxQOrbits.generated.h"
+
+
+UENUM(BlueprintType)
+enum class EMaxQOrbitSource : uint8
+{
+    TwoLineElements UMETA(DisplayName = "Two Line Elements (SGP4)"),
+    ConicElements UMETA(DisplayName = "Conic Elements (Two Body)"),
+    Bodies UMETA(DisplayName = "SPK Bodies (Chebyshev Cache)")
+};
+
+
+UCLASS(EditInlineNew, Category = "MaxQ", meta = (DisplayName = "MaxQ Orbits"))
+class SPICENIAGARA_API UNiagaraDataInterfaceMaxQOrbits : public UNiagaraDataInterface
+{
+    GENERATED_UCLASS_BODY()
+
+    BEGIN_SHADER_PARAMETER_STRUCT(FShaderParameters, )
+        SHADER_PARAMETER(int32, NumObjects)
+        SHADER_PARAMETER_SRV(Buffer<float4>, Snapshot)
+    END_SHADER_PARAMETER_STRUCT()
+
+public:
+    UPROPERTY(EditAnywhere, Category = "Source") EMaxQOrbitSource Source = EMaxQOrbitSource::TwoLineElements;
+
+    // TwoLineElements:  TLE or OMM JSON text, as ParseTLECatalog takes
+    UPROPERTY(EditAnywhere, Category = "Source", meta = (MultiLine = true, EditCondition = "Source == EMaxQOrbitSource::TwoLineElements")) FString TwoLineElements;
+
+    // ConicElements
+    UPROPERTY(EditAnywhere, Category = "Source", meta = (EditCondition = "Source == EMaxQOrbitSource::ConicElements")) TArray<FSConicElements> ConicElements;
+
+    // Bodies:  cached over [CacheStart, CacheStop], as seen by Observer in Frame
+    UPROPERTY(EditAnywhere, Category = "Source", meta = (EditCondition = "Source == EMaxQOrbitSource::Bodies")) TArray<FString> Bodies;
+    UPROPERTY(EditAnywhere, Category = "Source", meta = (EditCondition = "Source == EMaxQOrbitSource::Bodies")) FString Observer = TEXT("SSB");
+    UPROPERTY(EditAnywhere, Category = "Source", meta = (EditCondition = "Source == EMaxQOrbitSource::Bodies")) FString Frame = TEXT("ECLIPJ2000");
+    UPROPERTY(EditAnywhere, Category = "Source", meta = (EditCondition = "Source == EMaxQOrbitSource::Bodies")) FSEphemerisTime CacheStart;
+    UPROPERTY(EditAnywhere, Category = "Source", meta = (EditCondition = "Source == EMaxQOrbitSource::Bodies")) FSEphemerisTime CacheStop = FSEphemerisTime(86400. * 365.25);
+
+    // The world's UMaxQEphemerisSubsystem's Epoch, or Epoch
+    UPROPERTY(EditAnywhere, Category = "Time") bool bFollowSubsystem = true;
+    UPROPERTY(EditAnywhere, Category = "Time", meta = (EditCondition = "!bFollowSubsystem")) FSEphemerisTime Epoch;
+
+    // UE units per km
+    UPROPERTY(EditAnywhere, Category = "Placement") double Scale = 1.;
+    // Subtracted (UE units) before positions are single precision
+    UPROPERTY(EditAnywhere, Category = "Placement") FVector Origin = FVector::ZeroVector;
+
+    //UObject Interface
+    virtual void PostInitProperties() override;
+    //UObject Interface End
+
+    //UNiagaraDataInterface Interface
+    virtual void GetFunctions(TArray<FNiagaraFunctionSignature>& OutFunctions) override;
+    virtual void GetVMExternalFunction(const FVMExternalFunctionBindingInfo& BindingInfo, void* InstanceData, FVMExternalFunction& OutFunc) override;
+    virtual bool CanExecuteOnTarget(ENiagaraSimTarget Target) const override { return true; }
+    virtual bool Equals(const UNiagaraDataInterface* Other) const override;
+
+    virtual bool InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance) override;
+    virtual void DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance) override;
+    virtual int32 PerInstanceDataSize() const override;
+    virtual bool PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds) override;
+    virtual bool HasPreSimulateTick() const override { return true; }
+
+    virtual int32 PerInstanceDataPassedToRenderThreadSize() const override;
+    virtual void ProvidePerInstanceDataForRenderThread(void* DataForRenderThread, void* PerInstanceData, const FNiagaraSystemInstanceID& SystemInstance) override;
+
+#if WITH_EDITORONLY_DATA
+    virtual bool AppendCompileHash(FNiagaraCompileHashVisitor* InVisitor) const override;
+    virtual void GetParameterDefinitionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, FString& OutHLSL) override;
+    virtual bool GetFunctionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo, const FNiagaraDataInterfaceGeneratedFunction& FunctionInfo, int FunctionInstanceIndex, FString& OutHLSL) override;
+#endif
+    virtual void BuildShaderParameters(FNiagaraShaderParametersBuilder& ShaderParametersBuilder) const override;
+    virtual void SetShaderParameters(const FNiagaraDataInterfaceSetShaderParametersContext& Context) const override;
+    //UNiagaraDataInterface Interface End
+
+    void VMGetNumObjects(FVectorVMExternalFunctionContext& Context);
+    void VMGetPosition(FVectorVMExternalFunctionContext& Context);
+    void VMGetVelocity(FVectorVMExternalFunctionContext& Context);
+
+protected:
+    virtual bool CopyToInternal(UNiagaraDataInterface* Destination) const override;
+};
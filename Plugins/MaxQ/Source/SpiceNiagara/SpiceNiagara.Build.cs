@@ -0,0 +1,22 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+
+using UnrealBuildTool;
+
+// Optional Niagara data interfaces.  Needs the Niagara plugin enabled (see
+// MaxQ.uplugin's Plugins list).
+public class SpiceNiagara : ModuleRules
+{
+    public SpiceNiagara(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "Niagara", "NiagaraCore", "Spice" });
+        PrivateDependencyModuleNames.AddRange(new string[] { "RenderCore", "RHI", "VectorVM" });
+    }
+}
@@ -0,0 +1,238 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSequencerBake.cpp
+//
+// Implementation Comments
+//
+// Purpose:  Bakes SPK trajectories and attitudes into Sequencer transforms.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSequencerBake.cpp is part of the "Blueprints API".
+//
+// Keys go on display frames (converted to tick resolution), since that's
+// what a render samples.  Every key is a cubic auto key, so the reduction
+// can drop the ones the neighbors' tangents already reproduce.
+//------------------------------------------------------------------------------
+
+#include "SpiceSequencerBake.h"
+#include "SpiceEphemerisCache.h"
+#include "SpiceMath.h"
+#include "SpiceName.h"
+#include "Async/ParallelFor.h"
+#include "Channels/MovieSceneDoubleChannel.h"
+#include "Channels/MovieSceneChannelProxy.h"
+#include "MovieScene.h"
+#include "Sections/MovieScene3DTransformSection.h"
+
+namespace
+{
+    // Frames per ParallelFor task
+    constexpr int32 ChunkSize = 4096;
+
+    // Channel order in a transform section
+    enum ETransformChannel : int32
+    {
+        LocationX, LocationY, LocationZ,
+        RotationX, RotationY, RotationZ,
+        NumTransformChannels = 9
+    };
+
+    void Fail(ES_ResultCode& ResultCode, FString& ErrorMessage, const FString& Message)
+    {
+        ResultCode = ES_ResultCode::Error;
+        ErrorMessage = Message;
+    }
+
+    void SetKeys(FMovieSceneDoubleChannel& Channel, const TArray<FFrameNumber>& Times, const TArray<double>& Values, bool bReduce, double Tolerance, const TRange<FFrameNumber>& Range)
+    {
+        TArray<FMovieSceneDoubleValue> Keys;
+        Keys.Reserve(Values.Num());
+        for (double Value : Values)
+        {
+            FMovieSceneDoubleValue& Key = Keys.Emplace_GetRef(Value);
+            Key.InterpMode = RCIM_Cubic;
+            Key.TangentMode = RCTM_Auto;
+        }
+
+        Channel.Reset();
+        Channel.Set(Times, MoveTemp(Keys));
+        Channel.AutoSetTangents();
+
+        if (bReduce)
+        {
+            FKeyDataOptimizationParams Params;
+            Params.Tolerance = Tolerance;
+            Params.bAutoSetInterpolation = true;
+            Params.Range = Range;
+            Channel.Optimize(Params);
+        }
+    }
+}
+
+
+int32 UMaxQSequencerLibrary::BakeEphemeris(
+    UMovieScene3DTransformSection* Section,
+    const FMaxQSequencerBakeSettings& Settings,
+    ES_ResultCode& ResultCode,
+    FString& ErrorMessage
+)
+{
+    ResultCode = ES_ResultCode::Success;
+    ErrorMessage.Empty();
+
+    const UMovieScene* MovieScene = Section ? Section->GetTypedOuter<UMovieScene>() : nullptr;
+    if (!MovieScene)
+    {
+        Fail(ResultCode, ErrorMessage, TEXT("BakeEphemeris: the section isn't in a movie scene"));
+        return 0;
+    }
+
+    const TRange<FFrameNumber> Range = Section->GetRange();
+    if (!Range.HasLowerBound() || !Range.HasUpperBound())
+    {
+        Fail(ResultCode, ErrorMessage, TEXT("BakeEphemeris: the section needs a bounded range"));
+        return 0;
+    }
+
+    TArrayView<FMovieSceneDoubleChannel*> Channels = Section->GetChannelProxy().GetChannels<FMovieSceneDoubleChannel>();
+    if (Channels.Num() < NumTransformChannels)
+    {
+        Fail(ResultCode, ErrorMessage, TEXT("BakeEphemeris: the section has no transform channels"));
+        return 0;
+    }
+
+    // Display frames over the section, in tick resolution
+    const FFrameRate TickResolution = MovieScene->GetTickResolution();
+    const FFrameRate DisplayRate = MovieScene->GetDisplayRate();
+    const FFrameNumber First = Range.GetLowerBoundValue();
+    const FFrameNumber Last = Range.GetUpperBoundValue();
+    const FFrameNumber FirstDisplay = FFrameRate::TransformTime(FFrameTime(First), TickResolution, DisplayRate).CeilToFrame();
+    const FFrameNumber LastDisplay = FFrameRate::TransformTime(FFrameTime(Last), TickResolution, DisplayRate).FloorToFrame();
+
+    TArray<FFrameNumber> Times;
+    TArray<double> Epochs;
+    for (FFrameNumber Frame = FirstDisplay; Frame <= LastDisplay; ++Frame)
+    {
+        const FFrameNumber Tick = FFrameRate::TransformTime(FFrameTime(Frame), DisplayRate, TickResolution).RoundToFrame();
+        Times.Add(Tick);
+        Epochs.Add(Settings.StartEpoch.AsSpiceDouble() + TickResolution.AsSeconds(Tick - First) * Settings.TimeScale);
+    }
+
+    const int32 Num = Times.Num();
+    if (Num < 2)
+    {
+        Fail(ResultCode, ErrorMessage, TEXT("BakeEphemeris: the section is shorter than two display frames"));
+        return 0;
+    }
+
+    // The trajectory, fitted once...
+    MaxQ::Ephemeris::FChebyshevCacheSettings CacheSettings;
+    CacheSettings.ToleranceKm = Settings.PositionToleranceKm;
+
+    MaxQ::Ephemeris::FChebyshevCache Cache;
+    const double Start = FMath::Min(Epochs[0], Epochs.Last());
+    const double Stop = FMath::Max(Epochs[0], Epochs.Last());
+    if (!Cache.Build({ Settings.Target }, Settings.Observer, Settings.Frame, FSEphemerisTime(Start), FSEphemerisTime(Stop), CacheSettings, Settings.AberrationCorrection, &ResultCode, &ErrorMessage))
+    {
+        return 0;
+    }
+
+    // ...and evaluated at every frame, in parallel
+    TArray<double> Location[3];
+    for (TArray<double>& Component : Location)
+    {
+        Component.SetNumUninitialized(Num);
+    }
+
+    TAtomic<bool> bEvaluated(true);
+    ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](int32 Chunk)
+    {
+        const int32 End = FMath::Min((Chunk + 1) * ChunkSize, Num);
+        for (int32 i = Chunk * ChunkSize; i < End; ++i)
+        {
+            double r[3];
+            if (!Cache.Evaluate(0, Epochs[i], r))
+            {
+                bEvaluated = false;
+                r[0] = r[1] = r[2] = 0.;
+            }
+
+            // Swizzle
+            Location[0][i] = r[1] * Settings.Scale;
+            Location[1][i] = r[0] * Settings.Scale;
+            Location[2][i] = r[2] * Settings.Scale;
+        }
+    }, Num <= ChunkSize);
+
+    if (!bEvaluated)
+    {
+        Fail(ResultCode, ErrorMessage, TEXT("BakeEphemeris: the trajectory fit doesn't cover the section"));
+        return 0;
+    }
+
+    // Attitudes, per frame (CSPICE)
+    const bool bRotation = !Settings.OrientationFrame.IsEmpty();
+    TArray<double> Rotation[3];
+    if (bRotation)
+    {
+        const FSpiceName From(Settings.OrientationFrame);
+        const FSpiceName To(Settings.Frame);
+
+        for (TArray<double>& Component : Rotation)
+        {
+            Component.SetNumUninitialized(Num);
+        }
+
+        FRotator Previous = FRotator::ZeroRotator;
+        for (int32 i = 0; i < Num; ++i)
+        {
+            FSRotationMatrix m;
+            MaxQ::Math::Pxform(m, FSEphemerisTime(Epochs[i]), From, To, &ResultCode, &ErrorMessage);
+            if (ResultCode != ES_ResultCode::Success)
+            {
+                return 0;
+            }
+
+            FSQuaternion q;
+            MaxQ::Math::M2q(q, m);
+            FRotator Rotator = q.Swizzle().Rotator();
+
+            // Unwound, so the channels don't jump at +/-180
+            if (i > 0)
+            {
+                Rotator.Roll = Previous.Roll + FMath::FindDeltaAngleDegrees(Previous.Roll, Rotator.Roll);
+                Rotator.Pitch = Previous.Pitch + FMath::FindDeltaAngleDegrees(Previous.Pitch, Rotator.Pitch);
+                Rotator.Yaw = Previous.Yaw + FMath::FindDeltaAngleDegrees(Previous.Yaw, Rotator.Yaw);
+            }
+            Previous = Rotator;
+
+            Rotation[0][i] = Rotator.Roll;
+            Rotation[1][i] = Rotator.Pitch;
+            Rotation[2][i] = Rotator.Yaw;
+        }
+    }
+
+    Section->Modify();
+
+    for (int32 Axis = 0; Axis < 3; ++Axis)
+    {
+        SetKeys(*Channels[LocationX + Axis], Times, Location[Axis], Settings.bReduceKeys, Settings.LocationTolerance, Range);
+        if (bRotation)
+        {
+            SetKeys(*Channels[RotationX + Axis], Times, Rotation[Axis], Settings.bReduceKeys, Settings.RotationTolerance, Range);
+        }
+    }
+
+    return Num;
+}
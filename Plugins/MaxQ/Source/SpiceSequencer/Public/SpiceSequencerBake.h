@@ -0,0 +1,103 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com|https://www.gamergenic.com
+//
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/
+
+//------------------------------------------------------------------------------
+// SpiceSequencerBake.h
+//
+// API Comments
+//
+// Purpose:  Bakes SPK trajectories and attitudes into Sequencer transforms.
+//
+// MaxQ:
+// * Base API
+// * Refined API
+//    * C++
+//    * Blueprints
+//
+// SpiceSequencerBake.h is part of the "Blueprints API".
+//
+// Calling spkezr from a Tick while Sequencer renders (or scrubs) costs CSPICE
+// time every frame, and the shot changes whenever the loaded kernels do.
+// Baking evaluates the ephemeris once, over the section's range, into the
+// section's own double-precision channels.  Playback and scrubbing are then
+// ordinary transform track evaluation:  native, and the same whatever's
+// loaded.
+//
+// The trajectory is fitted once (one FChebyshevCache build, to
+// PositionToleranceKm), then evaluated at every display frame in parallel.
+// The attitude (pxform(OrientationFrame, Frame)) is sampled per frame, and
+// unwound so the Euler channels don't jump at +/-180.  Then each channel is
+// reduced to the keys its cubic interpolation needs to stay within the
+// tolerances, which is most of the compression.
+//
+// Section time t (seconds from the section's start) is ephemeris time
+// StartEpoch + t * TimeScale.  Locations are swizzled to UE and scaled by
+// Scale, relative to whatever the bound object is attached to.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SpiceTypes.h"
+#include "SpiceSequencerBake.generated.h"
+
+class UMovieScene3DTransformSection;
+
+
+USTRUCT(BlueprintType)
+struct SPICESEQUENCER_API FMaxQSequencerBakeSettings
+{
+    GENERATED_BODY()
+
+    // spkezr's targ, obs, ref and abcorr
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") FString Target = TEXT("EARTH");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") FString Observer = TEXT("SSB");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") FString Frame = TEXT("ECLIPJ2000");
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") ES_AberrationCorrectionWithNewtonians AberrationCorrection = ES_AberrationCorrectionWithNewtonians::None;
+
+    // If set, rotations are baked too:  pxform(OrientationFrame, Frame)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") FString OrientationFrame;
+
+    // The epoch at the section's start
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") FSEphemerisTime StartEpoch;
+    // Ephemeris seconds per second of sequence time
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") double TimeScale = 1.;
+
+    // UE units per km
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") double Scale = 1.;
+
+    // The trajectory fit's tolerance
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") double PositionToleranceKm = 1.e-3;
+
+    // Key reduction:  keys are dropped while the curves stay within these
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") bool bReduceKeys = true;
+    // UE units
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") double LocationTolerance = 1.e-2;
+    // Degrees
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MaxQ|Sequencer") double RotationTolerance = 1.e-3;
+};
+
+
+UCLASS()
+class SPICESEQUENCER_API UMaxQSequencerLibrary : public UBlueprintFunctionLibrary
+{
+    GENERATED_BODY()
+
+public:
+    // Replaces Section's location (and, with an OrientationFrame, rotation)
+    // keys over its range.  Calls CSPICE:  editor time, from the thread that
+    // owns SPICE.  Returns the number of display frames sampled (0 on
+    // failure).
+    UFUNCTION(BlueprintCallable, Category = "MaxQ|Sequencer", meta = (ExpandEnumAsExecs = "ResultCode"))
+    static int32 BakeEphemeris(
+        UMovieScene3DTransformSection* Section,
+        const FMaxQSequencerBakeSettings& Settings,
+        ES_ResultCode& ResultCode,
+        FString& ErrorMessage
+    );
+};
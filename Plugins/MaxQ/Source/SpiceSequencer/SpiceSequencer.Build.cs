@@ -0,0 +1,22 @@
+// Copyright 2021 Gamergenic.  See full copyright notice in Spice.h.
+// Author: chucknoble@gamergenic.com | https://www.gamergenic.com
+// 
+// Project page:   https://www.gamergenic.com/project/maxq/
+// Documentation:  https://maxq.gamergenic.com/
+// GitHub:         https://github.com/Gamergenic1/MaxQ/ 
+
+
+using UnrealBuildTool;
+
+// Baking ephemerides into Sequencer transform tracks.  Runtime (the baked
+// sections play back with the engine's own transform tracks), but baking is
+// meant for editor time.
+public class SpiceSequencer : ModuleRules
+{
+    public SpiceSequencer(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "MovieScene", "MovieSceneTracks", "Spice" });
+    }
+}
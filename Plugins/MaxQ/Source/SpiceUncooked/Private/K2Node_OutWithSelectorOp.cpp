@@ -142,13 +142,13 @@ void UK2Node_OutWithSelectorOp::ExpandNode(FKismetCompilerContext& CompilerConte
             return;
         }
 
-        OperationFunctionName = CurrentOperation.K2NodeName;
+        OperationFunctionName = GetOperationFunctionName(CurrentOperation.K2NodeName);
         ConvFunctionName = CurrentOperation.Conversion.ConversionName;
     }
     else
     {
         // no output link, let's run the node anyways... and make it a double
-        OperationFunctionName = CurrentOperation.K2NodeName;
+        OperationFunctionName = GetOperationFunctionName(CurrentOperation.K2NodeName);
     }
 
 
@@ -74,6 +74,7 @@ public:
 
 protected:
     virtual void ExpandOperationNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph, UK2Node* operationNode) {}
+    virtual FName GetOperationFunctionName(FName K2NodeName) const { return K2NodeName; }
     virtual bool IsOutputCompatible(const UEdGraphPin* ThePin, EK2_ComponentSelector selector) const;
 
     EK2_ComponentSelector selectorPinValue() const;
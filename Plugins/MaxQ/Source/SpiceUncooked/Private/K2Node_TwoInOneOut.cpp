@@ -311,6 +311,48 @@ UEdGraphPin* UK2Node_TwoInOneOut::GetReturnValuePin(UEdGraphNode* Node) const
     return Pin;
 }
 
+bool UK2Node_TwoInOneOut::FoldLiterals(const OperationType& Operation, const TArray<UEdGraphPin*>& InputPins, UEdGraphPin* OutputPin) const
+{
+    if (InputPins.Num() < 2 || !CanFoldIntoLinkedPins(OutputPin))
+    {
+        return false;
+    }
+
+    // Same chain as the expansion:  ((v1 op v2) op v3) ...
+    FString Result;
+    for (int i = 0; i < InputPins.Num(); ++i)
+    {
+        FString Value;
+        if (!IsLiteralPin(InputPins[i]) || !EvaluateK2Conversion(Operation.OuterToInnerConversion, InputPins[i]->GetDefaultAsString(), Value))
+        {
+            return false;
+        }
+
+        if (i == 0)
+        {
+            Result = Value;
+            continue;
+        }
+
+        TMap<FName, FString> Outputs;
+        if (!EvaluatePureK2Call(Operation.K2NodeName, { { FName(USpiceK2::vadd_input1), Result }, { FName(USpiceK2::vadd_input2), Value } }, Outputs) || !Outputs.Contains(UEdGraphSchema_K2::PN_ReturnValue))
+        {
+            return false;
+        }
+        Result = Outputs[UEdGraphSchema_K2::PN_ReturnValue];
+    }
+
+    FString Folded;
+    if (!EvaluateK2Conversion(Operation.InnerToOuterConversion, Result, Folded))
+    {
+        return false;
+    }
+
+    FoldIntoLinkedPins(OutputPin, Folded);
+    return true;
+}
+
+
 void UK2Node_TwoInOneOut::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
 {
     Super::ExpandNode(CompilerContext, SourceGraph);
@@ -344,6 +386,17 @@ void UK2Node_TwoInOneOut::ExpandNode(FKismetCompilerContext& CompilerContext, UE
 
     UEdGraphPin* OutputPin { *ppOutputPin };
 
+    // Literals in, literal out:  no need to do the math on every execution
+    if (FoldLiterals(Operation, InputPins, OutputPin))
+    {
+        BreakAllNodeLinks();
+        return;
+    }
+
+    // A fused micro-op takes the outer type, so no conversions either side
+    const FName FusedName = FusedK2Function(Operation.K2NodeName, Operation.OuterType);
+    const bool bFused = !FusedName.IsNone();
+
     TArray<UEdGraphPin*> InternalInputPins;
     UEdGraphPin* InternalV1Pin{ nullptr };
     UEdGraphPin* InternalOutputPin{ nullptr };
@@ -351,7 +404,7 @@ void UK2Node_TwoInOneOut::ExpandNode(FKismetCompilerContext& CompilerContext, UE
     for (int i = 0; i < InputPins.Num() - 1; ++i)
     {
         auto InternalNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-        InternalNode->FunctionReference.SetExternalMember(Operation.K2NodeName, USpiceK2::StaticClass());
+        InternalNode->FunctionReference.SetExternalMember(bFused ? FusedName : Operation.K2NodeName, USpiceK2::StaticClass());
         InternalNode->AllocateDefaultPins();
         CompilerContext.MessageLog.NotifyIntermediateObjectCreation(InternalNode, this);
 
@@ -373,7 +426,7 @@ void UK2Node_TwoInOneOut::ExpandNode(FKismetCompilerContext& CompilerContext, UE
 
     check(InternalInputPins.Num() == InputPins.Num());
 
-    if (!Operation.OuterToInnerConversion.ConversionName.IsNone())
+    if (!bFused && !Operation.OuterToInnerConversion.ConversionName.IsNone())
     {
         for (int i = 0; i < InputPins.Num(); ++i)
         {
@@ -398,7 +451,7 @@ void UK2Node_TwoInOneOut::ExpandNode(FKismetCompilerContext& CompilerContext, UE
         }
     }
 
-    if (!Operation.InnerToOuterConversion.ConversionName.IsNone())
+    if (!bFused && !Operation.InnerToOuterConversion.ConversionName.IsNone())
     {
         auto ConversionNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
         ConversionNode->FunctionReference.SetExternalMember(Operation.InnerToOuterConversion.ConversionName, USpiceK2::StaticClass());
@@ -71,6 +71,7 @@ public:
     // end of UK2Node interface
 
     bool CheckForErrors(FKismetCompilerContext& CompilerContext, OperationType& Operation);
+    bool FoldLiterals(const OperationType& Operation, const TArray<UEdGraphPin*>& InputPins, UEdGraphPin* OutputPin) const;
     void CreateInputPin();
     void AllocateInputPin(FName& PinName);
     UEdGraphPin* GetReturnValuePin(UEdGraphNode* Node) const;
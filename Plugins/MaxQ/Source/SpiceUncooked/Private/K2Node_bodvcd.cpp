@@ -131,6 +131,13 @@ void UK2Node_bodvcd::ExpandOperationNode(FKismetCompilerContext& CompilerContext
 
     MovePinLinksOrCopyDefaults(CompilerContext, thisBody, thatBody);
     MovePinLinksOrCopyDefaults(CompilerContext, thisItem, thatItem);
+
+    ConnectPoolValueCache(CompilerContext, this, operationNode);
+}
+
+FName UK2Node_bodvcd::GetOperationFunctionName(FName K2NodeName) const
+{
+    return PoolValueCachedFunction(this, K2NodeName);
 }
 
 const UK2Node_bodvcd::OperationType& UK2Node_bodvcd::WildcardOp()
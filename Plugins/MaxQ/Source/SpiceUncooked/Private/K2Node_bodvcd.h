@@ -45,6 +45,7 @@ public:
 
 protected:
     void ExpandOperationNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph, UK2Node* operationNode);
+    FName GetOperationFunctionName(FName K2NodeName) const override;
 
 private:
     const FName body_Field = FName("bodyid");
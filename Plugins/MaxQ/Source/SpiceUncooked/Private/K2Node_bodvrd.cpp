@@ -130,6 +130,13 @@ void UK2Node_bodvrd::ExpandOperationNode(FKismetCompilerContext& CompilerContext
 
     MovePinLinksOrCopyDefaults(CompilerContext, thisBodynm, thatBodynm);
     MovePinLinksOrCopyDefaults(CompilerContext, thisItem, thatItem);
+
+    ConnectPoolValueCache(CompilerContext, this, operationNode);
+}
+
+FName UK2Node_bodvrd::GetOperationFunctionName(FName K2NodeName) const
+{
+    return PoolValueCachedFunction(this, K2NodeName);
 }
 
 const UK2Node_bodvrd::OperationType& UK2Node_bodvrd::WildcardOp()
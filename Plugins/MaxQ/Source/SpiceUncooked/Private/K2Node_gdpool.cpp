@@ -141,11 +141,18 @@ void UK2Node_gdpool::ExpandOperationNode(FKismetCompilerContext& CompilerContext
 
     MovePinLinksOrCopyDefaults(CompilerContext, thisItem, thatItem);
 
-    auto thatStartPin = FindPin(start_Field);
+    auto thatStartPin = operationNode->FindPin(start_Field);
     if (thatStartPin != nullptr)
     {
         MovePinLinksOrCopyDefaults(CompilerContext, startPin(), thatStartPin);
     }
+
+    ConnectPoolValueCache(CompilerContext, this, operationNode);
+}
+
+FName UK2Node_gdpool::GetOperationFunctionName(FName K2NodeName) const
+{
+    return PoolValueCachedFunction(this, K2NodeName);
 }
 
 const UK2Node_gdpool::OperationType& UK2Node_gdpool::WildcardOp()
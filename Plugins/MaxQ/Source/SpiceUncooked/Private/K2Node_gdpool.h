@@ -44,6 +44,7 @@ public:
 
 protected:
     void ExpandOperationNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph, UK2Node* operationNode);
+    FName GetOperationFunctionName(FName K2NodeName) const override;
 
 private:
     const FName item_Field = FName(TEXT("name"));
@@ -176,6 +176,40 @@ bool UK2Node_mxv::CheckForErrors(FKismetCompilerContext& CompilerContext, Operat
 }
 
 
+bool UK2Node_mxv::FoldLiterals(const OperationType& Operation) const
+{
+    UEdGraphPin* InputPin{ FindPinChecked(vin, EEdGraphPinDirection::EGPD_Input) };
+    UEdGraphPin* MatrixPin{ FindPinChecked(m, EEdGraphPinDirection::EGPD_Input) };
+    UEdGraphPin* OutputPin{ FindPinChecked(vout, EEdGraphPinDirection::EGPD_Output) };
+
+    if (!IsLiteralPin(InputPin) || !IsLiteralPin(MatrixPin) || !CanFoldIntoLinkedPins(OutputPin))
+    {
+        return false;
+    }
+
+    FString Value;
+    if (!EvaluateK2Conversion(Operation.OuterToInnerConversion, InputPin->GetDefaultAsString(), Value))
+    {
+        return false;
+    }
+
+    TMap<FName, FString> Outputs;
+    if (!EvaluatePureK2Call(Operation.K2NodeName, { { FName(USpiceK2::mxv_vin), Value }, { FName(USpiceK2::mxv_m), MatrixPin->GetDefaultAsString() } }, Outputs) || !Outputs.Contains(UEdGraphSchema_K2::PN_ReturnValue))
+    {
+        return false;
+    }
+
+    FString Folded;
+    if (!EvaluateK2Conversion(Operation.InnerToOuterConversion, Outputs[UEdGraphSchema_K2::PN_ReturnValue], Folded))
+    {
+        return false;
+    }
+
+    FoldIntoLinkedPins(OutputPin, Folded);
+    return true;
+}
+
+
 void UK2Node_mxv::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
 {
     Super::ExpandNode(CompilerContext, SourceGraph);
@@ -193,14 +227,25 @@ void UK2Node_mxv::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph*
     UEdGraphPin* MatrixPin{ FindPinChecked(m, EEdGraphPinDirection::EGPD_Input) };
     UEdGraphPin* OutputPin{ FindPinChecked(vout, EEdGraphPinDirection::EGPD_Output) };
 
+    // Literals in, literal out:  no need to do the math on every execution
+    if (FoldLiterals(Operation))
+    {
+        BreakAllNodeLinks();
+        return;
+    }
+
+    // A fused micro-op takes the outer type, so no conversions either side
+    const FName FusedName = FusedK2Function(Operation.K2NodeName, Operation.OuterType);
+    const bool bFused = !FusedName.IsNone();
+
     auto InternalNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-    InternalNode->FunctionReference.SetExternalMember(Operation.K2NodeName, USpiceK2::StaticClass());
+    InternalNode->FunctionReference.SetExternalMember(bFused ? FusedName : Operation.K2NodeName, USpiceK2::StaticClass());
     InternalNode->AllocateDefaultPins();
     CompilerContext.MessageLog.NotifyIntermediateObjectCreation(InternalNode, this);
 
     auto InternalIn = InternalNode->FindPinChecked(FName(USpiceK2::mxv_vin));
 
-    if (!Operation.OuterToInnerConversion.ConversionName.IsNone())
+    if (!bFused && !Operation.OuterToInnerConversion.ConversionName.IsNone())
     {
         auto ConversionNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
 
@@ -221,7 +266,7 @@ void UK2Node_mxv::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph*
 
     auto InternalOut = InternalNode->GetReturnValuePin();
 
-    if (!Operation.InnerToOuterConversion.ConversionName.IsNone())
+    if (!bFused && !Operation.InnerToOuterConversion.ConversionName.IsNone())
     {
         auto ConversionNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
 
@@ -321,7 +366,13 @@ const TArray<UK2Node_mxv::OperationType>& UK2Node_mxv::GetSupportedOperations()
         OperationType{ "mxv velocity vector",  USpiceK2::mxv_vector, FK2Type::SRotationMatrix(), FK2Conversion::SVelocityVectorToSDimensionlessVector(), FK2Conversion::SDimensionlessVectorToSVelocityVector() },
         OperationType{ "mxv angular velocity",  USpiceK2::mxv_vector, FK2Type::SRotationMatrix(), FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::SDimensionlessVectorToSAngularVelocity() },
         OperationType{ "mxv dimensionless state",  USpiceK2::mxv_state_vector, FK2Type::SStateTransform(), FK2Type::SDimensionlessStateVector() },
-        OperationType{ "mxv state vector",  USpiceK2::mxv_state_vector, FK2Type::SStateTransform(), FK2Conversion::SStateVectorToSDimensionlessStateVector(), FK2Conversion::SDimensionlessStateVectorToSStateVector() }
+        OperationType{ "mxv state vector",  USpiceK2::mxv_state_vector, FK2Type::SStateTransform(), FK2Conversion::SStateVectorToSDimensionlessStateVector(), FK2Conversion::SDimensionlessStateVectorToSStateVector() },
+        OperationType{ "mxv dimensionless vector array", USpiceK2::mxv_vector_array, FK2Type::SRotationMatrix(), FK2Type::SDimensionlessVectorArray() },
+        OperationType{ "mxv distance vector array",  USpiceK2::mxv_vector_array, FK2Type::SRotationMatrix(), FK2Conversion::SDistanceVectorArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSDistanceVectorArray() },
+        OperationType{ "mxv velocity vector array",  USpiceK2::mxv_vector_array, FK2Type::SRotationMatrix(), FK2Conversion::SVelocityVectorArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSVelocityVectorArray() },
+        OperationType{ "mxv angular velocity array",  USpiceK2::mxv_vector_array, FK2Type::SRotationMatrix(), FK2Conversion::SAngularVelocityArrayToSDimensionlessVectorArray(), FK2Conversion::SDimensionlessVectorArrayToSAngularVelocityArray() },
+        OperationType{ "mxv dimensionless state array",  USpiceK2::mxv_state_vector_array, FK2Type::SStateTransform(), FK2Type::SDimensionlessStateVectorArray() },
+        OperationType{ "mxv state vector array",  USpiceK2::mxv_state_vector_array, FK2Type::SStateTransform(), FK2Conversion::SStateVectorArrayToSDimensionlessStateVectorArray(), FK2Conversion::SDimensionlessStateVectorArrayToSStateVectorArray() }
     };
 
     return SupportedOperations;
@@ -181,6 +181,39 @@ FLinearColor UK2Node_norm::GetNodeTitleColor() const
 }
 
 
+bool UK2Node_norm::FoldLiterals(const OperationType& Operation) const
+{
+    UEdGraphPin* InputPin{ FindPinChecked(TEXT("vin"), EEdGraphPinDirection::EGPD_Input) };
+    UEdGraphPin* OutputPin{ FindPinChecked(TEXT("out"), EEdGraphPinDirection::EGPD_Output) };
+
+    if (!IsLiteralPin(InputPin) || !CanFoldIntoLinkedPins(OutputPin))
+    {
+        return false;
+    }
+
+    FString Value;
+    if (!EvaluateK2Conversion(Operation.InputToVectorConversion, InputPin->GetDefaultAsString(), Value))
+    {
+        return false;
+    }
+
+    TMap<FName, FString> Outputs;
+    if (!EvaluatePureK2Call(Operation.K2NodeName, { { FName(USpiceK2::vnorm_in), Value } }, Outputs) || !Outputs.Contains(UEdGraphSchema_K2::PN_ReturnValue))
+    {
+        return false;
+    }
+
+    FString Folded;
+    if (!EvaluateK2Conversion(Operation.ScalarToOutputConversion, Outputs[UEdGraphSchema_K2::PN_ReturnValue], Folded))
+    {
+        return false;
+    }
+
+    FoldIntoLinkedPins(OutputPin, Folded);
+    return true;
+}
+
+
 void UK2Node_norm::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
 {
     Super::ExpandNode(CompilerContext, SourceGraph);
@@ -197,14 +230,25 @@ void UK2Node_norm::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph*
     UEdGraphPin* InputPin{ FindPinChecked(TEXT("vin"), EEdGraphPinDirection::EGPD_Input) };
     UEdGraphPin* OutputPin{ FindPinChecked(TEXT("out"), EEdGraphPinDirection::EGPD_Output) };
 
+    // Literals in, literal out:  no need to do the math on every execution
+    if (FoldLiterals(Operation))
+    {
+        BreakAllNodeLinks();
+        return;
+    }
+
+    // A fused micro-op takes the outer type, so no conversions either side
+    const FName FusedName = FusedK2Function(Operation.K2NodeName, Operation.InputVectorType);
+    const bool bFused = !FusedName.IsNone();
+
     auto InternalNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
-    InternalNode->FunctionReference.SetExternalMember(Operation.K2NodeName, USpiceK2::StaticClass());
+    InternalNode->FunctionReference.SetExternalMember(bFused ? FusedName : Operation.K2NodeName, USpiceK2::StaticClass());
     InternalNode->AllocateDefaultPins();
     CompilerContext.MessageLog.NotifyIntermediateObjectCreation(InternalNode, this);
 
     auto InternalIn = InternalNode->FindPinChecked(FName(USpiceK2::vnorm_in));
 
-    if (!Operation.InputToVectorConversion.ConversionName.IsNone())
+    if (!bFused && !Operation.InputToVectorConversion.ConversionName.IsNone())
     {
         auto ConversionNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
 
@@ -225,7 +269,7 @@ void UK2Node_norm::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph*
 
     auto InternalOut = InternalNode->GetReturnValuePin();
 
-    if (!Operation.ScalarToOutputConversion.ConversionName.IsNone())
+    if (!bFused && !Operation.ScalarToOutputConversion.ConversionName.IsNone())
     {
         auto ConversionNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
 
@@ -307,7 +351,11 @@ const TArray<UK2Node_norm::OperationType>& UK2Node_norm::GetSupportedOperations(
         OperationType{ "vnorm dimensionless vector", FName(USpiceK2::vnorm_vector), FK2Type::SDimensionlessVector(), FK2Type::Double() },
         OperationType{ "vnorm distance vector",  USpiceK2::vnorm_vector, FK2Conversion::SDistanceVectorToSDimensionlessVector(), FK2Conversion::DoubleToSDistance() },
         OperationType{ "vnorm velocity vector",  USpiceK2::vnorm_vector, FK2Conversion::SVelocityVectorToSDimensionlessVector(), FK2Conversion::DoubleToSSpeed() },
-        OperationType{ "vnorm angular velocity",  USpiceK2::vnorm_vector, FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::DoubleToSAngularRate() }
+        OperationType{ "vnorm angular velocity",  USpiceK2::vnorm_vector, FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::DoubleToSAngularRate() },
+        OperationType{ "vnorm dimensionless vector array", FName(USpiceK2::vnorm_vector_array), FK2Type::SDimensionlessVectorArray(), FK2Type::DoubleArray() },
+        OperationType{ "vnorm distance vector array",  USpiceK2::vnorm_vector_array, FK2Conversion::SDistanceVectorArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSDistanceArray() },
+        OperationType{ "vnorm velocity vector array",  USpiceK2::vnorm_vector_array, FK2Conversion::SVelocityVectorArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSSpeedArray() },
+        OperationType{ "vnorm angular velocity array",  USpiceK2::vnorm_vector_array, FK2Conversion::SAngularVelocityArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSAngularRateArray() }
     };
 
     return SupportedOperations;
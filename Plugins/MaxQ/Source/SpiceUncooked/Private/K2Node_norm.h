@@ -196,6 +196,7 @@ public:
     // end of UK2Node interface
 
     bool CheckForErrors(FKismetCompilerContext& CompilerContext, OperationType& Operation);
+    bool FoldLiterals(const OperationType& Operation) const;
     void CreateInputPin();
     void AllocateInputPin(FName& PinName);
 
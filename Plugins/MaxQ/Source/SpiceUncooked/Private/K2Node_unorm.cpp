@@ -68,6 +68,7 @@ void UK2Node_unorm::AllocateDefaultPins()
     {
         SetPinType(this, InputPin, CurrentOperation.InputVectorType, FString::Printf(TEXT("Input vector (%s)"), *CurrentOperation.InputVectorType.TypeName.ToString()));
         SetPinType(this, OutputPin, CurrentOperation.OutputScalarType, FString::Printf(TEXT("Magnitude (%s)"), *CurrentOperation.OutputScalarType.TypeName.ToString()));
+        SetPinType(this, UnitVectorOutputPin, UnitVectorType(CurrentOperation), TEXT("Vector unit normal"));
     }
 }
 
@@ -91,7 +92,7 @@ bool UK2Node_unorm::IsConnectionDisallowed(const UEdGraphPin* MyPin, const UEdGr
     if (bIsOutput && MyPin == FindPinChecked(FName("vout")))
     {
         bool isokay = OtherPinType.PinCategory == UEdGraphSchema_K2::PC_Wildcard;
-        isokay |= OtherPinType.PinCategory == UEdGraphSchema_K2::PC_Struct &&  OtherPinType.PinSubCategoryObject == FSDimensionlessVector::StaticStruct() && OtherPinType.ContainerType == EPinContainerType::None;
+        isokay |= OtherPinType.PinCategory == UEdGraphSchema_K2::PC_Struct &&  OtherPinType.PinSubCategoryObject == FSDimensionlessVector::StaticStruct() && OtherPinType.ContainerType == MyPinType.ContainerType;
         return !isokay;
     }
 
@@ -131,6 +132,7 @@ void UK2Node_unorm::NodeConnectionListChanged()
 
     auto InputPin = FindPinChecked(FName("v"));
     auto OutputPin = FindPinChecked(FName("vmag"));
+    auto UnitVectorOutputPin = FindPinChecked(FName("vout"));
 
     CurrentOperation = OperationType();
     for (const auto& Op : GetSupportedOperations())
@@ -154,6 +156,9 @@ void UK2Node_unorm::NodeConnectionListChanged()
         SetPinType(this, InputPin, CurrentOperation.InputVectorType, FString::Printf(TEXT("Input vector (%s)"), *CurrentOperation.InputVectorType.TypeName.ToString()));
         SetPinType(this, OutputPin, CurrentOperation.OutputScalarType, FString::Printf(TEXT("Magnitude (%s)"), *CurrentOperation.OutputScalarType.TypeName.ToString()));
     }
+
+    // vout is an SDimensionlessVector, or an array of them when v is an array
+    SetPinType(this, UnitVectorOutputPin, UnitVectorType(CurrentOperation), TEXT("Vector unit normal"));
 }
 
 void UK2Node_unorm::PinTypeChanged(UEdGraphPin* Pin)
@@ -184,6 +189,12 @@ bool UK2Node_unorm::CheckForErrors(FKismetCompilerContext& CompilerContext, Oper
 }
 
 
+const FK2Type& UK2Node_unorm::UnitVectorType(const OperationType& Operation)
+{
+    return Operation.InputVectorType.Container == EPinContainerType::Array ? FK2Type::SDimensionlessVectorArray() : FK2Type::SDimensionlessVector();
+}
+
+
 FSlateIcon UK2Node_unorm::GetIconAndTint(FLinearColor& OutColor) const
 {
     OutColor = FColor::Emerald;
@@ -196,6 +207,43 @@ FLinearColor UK2Node_unorm::GetNodeTitleColor() const
 }
 
 
+bool UK2Node_unorm::FoldLiterals(const OperationType& Operation) const
+{
+    UEdGraphPin* InputPin{ FindPinChecked(TEXT("v"), EEdGraphPinDirection::EGPD_Input) };
+    UEdGraphPin* DirectionOutputPin{ FindPinChecked(TEXT("vout"), EEdGraphPinDirection::EGPD_Output) };
+    UEdGraphPin* MagnitudeOutputPin{ FindPinChecked(TEXT("vmag"), EEdGraphPinDirection::EGPD_Output) };
+
+    if (!IsLiteralPin(InputPin) || !CanFoldIntoLinkedPins(DirectionOutputPin) || !CanFoldIntoLinkedPins(MagnitudeOutputPin))
+    {
+        return false;
+    }
+
+    FString Value;
+    if (!EvaluateK2Conversion(Operation.InputToVectorConversion, InputPin->GetDefaultAsString(), Value))
+    {
+        return false;
+    }
+
+    TMap<FName, FString> Outputs;
+    const FName Direction{ USpiceK2::unorm_vector_output_direction };
+    const FName Magnitude{ USpiceK2::unorm_vector_output_mag };
+    if (!EvaluatePureK2Call(Operation.K2NodeName, { { FName(USpiceK2::unorm_vector_input), Value } }, Outputs) || !Outputs.Contains(Direction) || !Outputs.Contains(Magnitude))
+    {
+        return false;
+    }
+
+    FString FoldedMagnitude;
+    if (!EvaluateK2Conversion(Operation.ScalarToOutputConversion, Outputs[Magnitude], FoldedMagnitude))
+    {
+        return false;
+    }
+
+    FoldIntoLinkedPins(DirectionOutputPin, Outputs[Direction]);
+    FoldIntoLinkedPins(MagnitudeOutputPin, FoldedMagnitude);
+    return true;
+}
+
+
 void UK2Node_unorm::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph* SourceGraph)
 {
     Super::ExpandNode(CompilerContext, SourceGraph);
@@ -213,6 +261,13 @@ void UK2Node_unorm::ExpandNode(FKismetCompilerContext& CompilerContext, UEdGraph
     UEdGraphPin* DirectionOutputPin{ FindPinChecked(TEXT("vout"), EEdGraphPinDirection::EGPD_Output) };
     UEdGraphPin* MagnitudeOutputPin{ FindPinChecked(TEXT("vmag"), EEdGraphPinDirection::EGPD_Output) };
 
+    // Literals in, literals out:  no need to do the math on every execution
+    if (FoldLiterals(Operation))
+    {
+        BreakAllNodeLinks();
+        return;
+    }
+
     auto InternalNode = CompilerContext.SpawnIntermediateNode<UK2Node_CallFunction>(this, SourceGraph);
     InternalNode->FunctionReference.SetExternalMember(Operation.K2NodeName, USpiceK2::StaticClass());
     InternalNode->AllocateDefaultPins();
@@ -326,7 +381,11 @@ const TArray<UK2Node_unorm::OperationType>& UK2Node_unorm::GetSupportedOperation
         OperationType{ "unorm dimensionless vector", FName(USpiceK2::unorm_vector), FK2Type::SDimensionlessVector(), FK2Type::Double() },
         OperationType{ "unorm distance vector",  USpiceK2::unorm_vector, FK2Conversion::SDistanceVectorToSDimensionlessVector(), FK2Conversion::DoubleToSDistance() },
         OperationType{ "unorm velocity vector",  USpiceK2::unorm_vector, FK2Conversion::SVelocityVectorToSDimensionlessVector(), FK2Conversion::DoubleToSSpeed() },
-        OperationType{ "unorm angular velocity",  USpiceK2::unorm_vector, FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::DoubleToSAngularRate() }
+        OperationType{ "unorm angular velocity",  USpiceK2::unorm_vector, FK2Conversion::SAngularVelocityToSDimensionlessVector(), FK2Conversion::DoubleToSAngularRate() },
+        OperationType{ "unorm dimensionless vector array", FName(USpiceK2::unorm_vector_array), FK2Type::SDimensionlessVectorArray(), FK2Type::DoubleArray() },
+        OperationType{ "unorm distance vector array",  USpiceK2::unorm_vector_array, FK2Conversion::SDistanceVectorArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSDistanceArray() },
+        OperationType{ "unorm velocity vector array",  USpiceK2::unorm_vector_array, FK2Conversion::SVelocityVectorArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSSpeedArray() },
+        OperationType{ "unorm angular velocity array",  USpiceK2::unorm_vector_array, FK2Conversion::SAngularVelocityArrayToSDimensionlessVectorArray(), FK2Conversion::DoubleArrayToSAngularRateArray() }
     };
 
     return SupportedOperations;
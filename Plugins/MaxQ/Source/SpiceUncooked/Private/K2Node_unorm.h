@@ -66,10 +66,12 @@ public:
     // end of UK2Node interface
 
     bool CheckForErrors(FKismetCompilerContext& CompilerContext, OperationType& Operation);
+    bool FoldLiterals(const OperationType& Operation) const;
     void CreateInputPin();
     void AllocateInputPin(FName& PinName);
 
     void RefreshOperation();
+    static const FK2Type& UnitVectorType(const OperationType& Operation);
 
 protected:
     virtual const TArray<OperationType>& GetSupportedOperations() const;
@@ -124,6 +124,60 @@ const FK2Type& FK2Type::SRotationMatrix()
     return RotationMatrix;
 }
 
+const FK2Type& FK2Type::SDistanceArray()
+{
+    static FK2Type ArrayDistance = FK2Type(FSDistance::StaticStruct(), EPinContainerType::Array);
+    return ArrayDistance;
+}
+
+const FK2Type& FK2Type::SSpeedArray()
+{
+    static FK2Type ArraySpeed = FK2Type(FSSpeed::StaticStruct(), EPinContainerType::Array);
+    return ArraySpeed;
+}
+
+const FK2Type& FK2Type::SAngularRateArray()
+{
+    static FK2Type ArrayAngularRate = FK2Type(FSAngularRate::StaticStruct(), EPinContainerType::Array);
+    return ArrayAngularRate;
+}
+
+const FK2Type& FK2Type::SDimensionlessVectorArray()
+{
+    static FK2Type ArrayDimensionlessVector = FK2Type(FSDimensionlessVector::StaticStruct(), EPinContainerType::Array);
+    return ArrayDimensionlessVector;
+}
+
+const FK2Type& FK2Type::SDistanceVectorArray()
+{
+    static FK2Type ArrayDistanceVector = FK2Type(FSDistanceVector::StaticStruct(), EPinContainerType::Array);
+    return ArrayDistanceVector;
+}
+
+const FK2Type& FK2Type::SVelocityVectorArray()
+{
+    static FK2Type ArrayVelocityVector = FK2Type(FSVelocityVector::StaticStruct(), EPinContainerType::Array);
+    return ArrayVelocityVector;
+}
+
+const FK2Type& FK2Type::SAngularVelocityArray()
+{
+    static FK2Type ArrayAngularVelocity = FK2Type(FSAngularVelocity::StaticStruct(), EPinContainerType::Array);
+    return ArrayAngularVelocity;
+}
+
+const FK2Type& FK2Type::SStateVectorArray()
+{
+    static FK2Type ArrayStateVector = FK2Type(FSStateVector::StaticStruct(), EPinContainerType::Array);
+    return ArrayStateVector;
+}
+
+const FK2Type& FK2Type::SDimensionlessStateVectorArray()
+{
+    static FK2Type ArrayDimensionlessStateVector = FK2Type(FSDimensionlessStateVector::StaticStruct(), EPinContainerType::Array);
+    return ArrayDimensionlessStateVector;
+}
+
 
 
 TArray<FString> FK2Type::GetTypePinLabels(const UScriptStruct* WhatType)
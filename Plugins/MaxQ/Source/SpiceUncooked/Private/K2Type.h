@@ -49,6 +49,17 @@ struct SPICEUNCOOKED_API FK2Type
         Container = { EPinContainerType::None };
     }
 
+    FK2Type(
+        UScriptStruct* _type,
+        EPinContainerType _container
+    )
+    {
+        TypeName = { _container == EPinContainerType::Array ? FName(*FString::Printf(TEXT("Array(%s)"), *_type->GetName())) : _type->GetFName() };
+        Category = { UEdGraphSchema_K2::PC_Struct };
+        SubCategoryObject = { _type };
+        Container = { _container };
+    }
+
     FK2Type(
         FName _typename,
         FName _category,
@@ -184,6 +195,15 @@ struct SPICEUNCOOKED_API FK2Type
     static const FK2Type& SDimensionlessStateVector();
     static const FK2Type& SRotationMatrix();
     static const FK2Type& SStateTransform();
+    static const FK2Type& SDistanceArray();
+    static const FK2Type& SSpeedArray();
+    static const FK2Type& SAngularRateArray();
+    static const FK2Type& SDimensionlessVectorArray();
+    static const FK2Type& SDistanceVectorArray();
+    static const FK2Type& SVelocityVectorArray();
+    static const FK2Type& SAngularVelocityArray();
+    static const FK2Type& SStateVectorArray();
+    static const FK2Type& SDimensionlessStateVectorArray();
 
     static TArray<FString> GetTypePinLabels(const UScriptStruct* WhatType);
 
@@ -15,6 +15,11 @@
 #include "K2Utilities.h"
 #include "BlueprintActionDatabaseRegistrar.h"
 #include "K2Node_MathGenericInterface.h"
+#include "K2Node_Knot.h"
+#include "K2Node_TemporaryVariable.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "K2Conversion.h"
+#include "SpiceK2.h"
 
 void RegisterAction(class FBlueprintActionDatabaseRegistrar& ActionRegistrar, UClass* actionKey)
 {
@@ -117,4 +122,192 @@ void ThisPinTypeChanged(UEdGraphPin* Pin)
 
     const UEdGraphSchema_K2* K2Schema = GetDefault<UEdGraphSchema_K2>();
     K2Schema->ForceVisualizationCacheClear();
-}
\ No newline at end of file
+}
+
+
+bool IsLiteralPin(const UEdGraphPin* Pin)
+{
+    return Pin && Pin->LinkedTo.Num() == 0 && Pin->SubPins.Num() == 0 && !Pin->PinType.IsContainer() && !Pin->bOrphanedPin;
+}
+
+
+bool EvaluatePureK2Call(FName FunctionName, const TMap<FName, FString>& Inputs, TMap<FName, FString>& Outputs)
+{
+    UClass* Class = USpiceK2::StaticClass();
+    UFunction* Function = Class->FindFunctionByName(FunctionName);
+
+    // Only pure statics:  anything else may have side effects, or depend on
+    // state that's different at runtime (loaded kernels, etc)
+    if (!Function || !Function->HasAllFunctionFlags(FUNC_BlueprintPure | FUNC_Static))
+    {
+        return false;
+    }
+
+    uint8* Params = (uint8*)FMemory::Malloc(FMath::Max(Function->ParmsSize, 1), Function->GetMinAlignment());
+    Function->InitializeStruct(Params);
+
+    bool bSuccess = true;
+    for (TFieldIterator<FProperty> It(Function); bSuccess && It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+    {
+        const bool bIsInput = !It->HasAnyPropertyFlags(CPF_OutParm) || It->HasAnyPropertyFlags(CPF_ReferenceParm);
+        const FString* Value = bIsInput ? Inputs.Find(It->GetFName()) : nullptr;
+
+        // An empty default is a default-constructed value
+        if (Value && !Value->IsEmpty())
+        {
+            bSuccess = It->ImportText_InContainer(**Value, Params, nullptr, PPF_None) != nullptr;
+        }
+    }
+
+    if (bSuccess)
+    {
+        Class->GetDefaultObject()->ProcessEvent(Function, Params);
+
+        for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+        {
+            if (It->HasAnyPropertyFlags(CPF_ReturnParm) || (It->HasAnyPropertyFlags(CPF_OutParm) && !It->HasAnyPropertyFlags(CPF_ReferenceParm)))
+            {
+                FString& Value = Outputs.Add(It->GetFName());
+                It->ExportTextItem_InContainer(Value, Params, nullptr, nullptr, PPF_None);
+            }
+        }
+    }
+
+    Function->DestroyStruct(Params);
+    FMemory::Free(Params);
+
+    return bSuccess;
+}
+
+
+bool EvaluateK2Conversion(const FK2Conversion& Conversion, const FString& Value, FString& Result)
+{
+    if (Conversion.ConversionName.IsNone())
+    {
+        Result = Value;
+        return true;
+    }
+
+    TMap<FName, FString> Outputs;
+    if (!EvaluatePureK2Call(Conversion.ConversionName, { { FName(USpiceK2::conv_input), Value } }, Outputs))
+    {
+        return false;
+    }
+
+    const FString* Converted = Outputs.Find(UEdGraphSchema_K2::PN_ReturnValue);
+    if (!Converted)
+    {
+        return false;
+    }
+
+    Result = *Converted;
+    return true;
+}
+
+
+bool CanFoldIntoLinkedPins(const UEdGraphPin* Pin)
+{
+    if (!Pin || Pin->SubPins.Num() > 0)
+    {
+        return false;
+    }
+
+    for (const UEdGraphPin* Linked : Pin->LinkedTo)
+    {
+        // It has to be somewhere a literal can go
+        const bool bTakesLiteral =
+            Linked->Direction == EGPD_Input &&
+            !Linked->bDefaultValueIsIgnored &&
+            !Linked->PinType.bIsReference &&
+            !Linked->PinType.IsContainer() &&
+            Linked->PinType.PinCategory != UEdGraphSchema_K2::PC_Wildcard &&
+            !Cast<UK2Node_Knot>(Linked->GetOwningNode());
+
+        if (!bTakesLiteral)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void FoldIntoLinkedPins(UEdGraphPin* Pin, const FString& Value)
+{
+    for (UEdGraphPin* Linked : Pin->LinkedTo)
+    {
+        Linked->DefaultObject = nullptr;
+        Linked->DefaultValue = Value;
+        Linked->DefaultTextValue = FText::GetEmpty();
+    }
+
+    Pin->BreakAllPinLinks();
+}
+
+
+FName FusedK2Function(FName K2NodeName, const FK2Type& OuterType)
+{
+    static const TMap<TPair<FName, FName>, FName> FusedFunctions
+    {
+        { { USpiceK2::vadd_vector, FK2Type::SDistanceVector().TypeName }, USpiceK2::vadd_SDistanceVector },
+        { { USpiceK2::vadd_vector, FK2Type::SVelocityVector().TypeName }, USpiceK2::vadd_SVelocityVector },
+        { { USpiceK2::vadd_vector, FK2Type::SAngularVelocity().TypeName }, USpiceK2::vadd_SAngularVelocity },
+        { { USpiceK2::vadd_state_vector, FK2Type::SStateVector().TypeName }, USpiceK2::vadd_SStateVector },
+        { { USpiceK2::vsub_vector, FK2Type::SDistanceVector().TypeName }, USpiceK2::vsub_SDistanceVector },
+        { { USpiceK2::vsub_vector, FK2Type::SVelocityVector().TypeName }, USpiceK2::vsub_SVelocityVector },
+        { { USpiceK2::vsub_vector, FK2Type::SAngularVelocity().TypeName }, USpiceK2::vsub_SAngularVelocity },
+        { { USpiceK2::vsub_state_vector, FK2Type::SStateVector().TypeName }, USpiceK2::vsub_SStateVector },
+        { { USpiceK2::mxv_vector, FK2Type::SDistanceVector().TypeName }, USpiceK2::mxv_SDistanceVector },
+        { { USpiceK2::mxv_vector, FK2Type::SVelocityVector().TypeName }, USpiceK2::mxv_SVelocityVector },
+        { { USpiceK2::mxv_vector, FK2Type::SAngularVelocity().TypeName }, USpiceK2::mxv_SAngularVelocity },
+        { { USpiceK2::mxv_state_vector, FK2Type::SStateVector().TypeName }, USpiceK2::mxv_SStateVector },
+        { { USpiceK2::vnorm_vector, FK2Type::SDistanceVector().TypeName }, USpiceK2::vnorm_SDistanceVector },
+        { { USpiceK2::vnorm_vector, FK2Type::SVelocityVector().TypeName }, USpiceK2::vnorm_SVelocityVector },
+        { { USpiceK2::vnorm_vector, FK2Type::SAngularVelocity().TypeName }, USpiceK2::vnorm_SAngularVelocity }
+    };
+
+    const FName* Fused = FusedFunctions.Find(TPair<FName, FName>(K2NodeName, OuterType.TypeName));
+    return Fused ? *Fused : NAME_None;
+}
+
+
+FName PoolValueCachedFunction(const UEdGraphNode* Node, FName K2NodeName)
+{
+    const UBlueprint* Blueprint = FBlueprintEditorUtils::FindBlueprintForNode(Node);
+    if (!Blueprint || Blueprint->BlueprintType == BPTYPE_FunctionLibrary)
+    {
+        return K2NodeName;
+    }
+
+    static const TMap<FName, FName> CachedFunctions
+    {
+        { USpiceK2::bodvrd_double, USpiceK2::bodvrd_double_cached },
+        { USpiceK2::bodvrd_vector, USpiceK2::bodvrd_vector_cached },
+        { USpiceK2::bodvrd_array, USpiceK2::bodvrd_array_cached },
+        { USpiceK2::bodvcd_double, USpiceK2::bodvcd_double_cached },
+        { USpiceK2::bodvcd_vector, USpiceK2::bodvcd_vector_cached },
+        { USpiceK2::bodvcd_array, USpiceK2::bodvcd_array_cached },
+        { USpiceK2::gdpool_double, USpiceK2::gdpool_double_cached },
+        { USpiceK2::gdpool_vector, USpiceK2::gdpool_vector_cached },
+        { USpiceK2::gdpool_array, USpiceK2::gdpool_array_cached }
+    };
+
+    const FName* Cached = CachedFunctions.Find(K2NodeName);
+    return Cached ? *Cached : K2NodeName;
+}
+
+
+void ConnectPoolValueCache(FKismetCompilerContext& CompilerContext, UEdGraphNode* Node, UEdGraphNode* OperationNode)
+{
+    UEdGraphPin* CachePin = OperationNode->FindPin(USpiceK2::pool_cache);
+    if (!CachePin)
+    {
+        // The uncached operation
+        return;
+    }
+
+    // Persistent, so it's a member of the generated class and one per node
+    UK2Node_TemporaryVariable* CacheVariable = CompilerContext.SpawnInternalVariable(Node, UEdGraphSchema_K2::PC_Struct, NAME_None, FSPoolValueCache::StaticStruct());
+    CompilerContext.GetSchema()->TryCreateConnection(CacheVariable->GetVariablePin(), CachePin);
+}
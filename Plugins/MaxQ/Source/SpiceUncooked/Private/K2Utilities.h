@@ -30,6 +30,32 @@ bool SetPinType(UEdGraphNode* Node, UEdGraphPin* Pin, const FK2Type& K2Type, con
 bool SetPinTypeToWildcard(UEdGraphNode* Node, UEdGraphPin* Pin, const FString& ToolTip);
 void ThisPinTypeChanged(UEdGraphPin* Pin);
 
+// Compile-time constant folding.  A pure node whose inputs are all literals
+// (pin defaults, nothing linked) gets its result evaluated once, while
+// compiling, by calling the same USpiceK2 micro-ops through reflection.  The
+// result is written into the default values of the pins it was linked to,
+// so the VM doesn't repeat the math on every execution.
+bool IsLiteralPin(const UEdGraphPin* Pin);
+bool EvaluatePureK2Call(FName FunctionName, const TMap<FName, FString>& Inputs, TMap<FName, FString>& Outputs);
+bool EvaluateK2Conversion(const struct FK2Conversion& Conversion, const FString& Value, FString& Result);
+bool CanFoldIntoLinkedPins(const UEdGraphPin* Pin);
+void FoldIntoLinkedPins(UEdGraphPin* Pin, const FString& Value);
+
+// Fused micro-ops.  A typed operation (vadd on SDistanceVector, etc) would
+// otherwise expand to a conversion into the dimensionless type, the
+// operation, and a conversion back, each a separate VM call.  Where USpiceK2
+// has a micro-op taking the unit type directly, the node spawns that instead.
+// Returns NAME_None when there isn't one (dimensionless types, arrays).
+FName FusedK2Function(FName K2NodeName, const FK2Type& OuterType);
+
+// Kernel pool value caching.  bodvrd/bodvcd/gdpool nodes call the *_cached_K2
+// variant of their operation, which keeps the last value in a persistent
+// FSPoolValueCache member of the Blueprint and only searches the pool again
+// when the pool generation or the inputs change.  Function libraries have no
+// instance to keep it in, so they call the uncached operation.
+FName PoolValueCachedFunction(const UEdGraphNode* Node, FName K2NodeName);
+void ConnectPoolValueCache(FKismetCompilerContext& CompilerContext, UEdGraphNode* Node, UEdGraphNode* OperationNode);
+
 // We don't care about const, etc
 static inline bool IsExactPair(const FEdGraphPinType& lhs, const FEdGraphPinType& rhs)
 {
@@ -0,0 +1,102 @@
+/*
+
+-Header_File MaxQUnits.h ( MaxQ DAF/DAS unit pool options and counters )
+
+-Abstract
+
+   Not part of the NAIF toolkit.  MaxQ's build options for the size of the
+   DAF/DAS handle manager's logical unit pool (ZZDDHMAN), and counters of
+   how the pool is used.
+
+   ZZDDHMAN keeps at most UTSIZE files connected to logical units (OS file
+   handles) at once.  A read from a file that lost its unit closes the
+   least recently used file's unit and reopens the file on it.  With more
+   binary kernels in use than UTSIZE, reads can alternate between files and
+   reopen one on nearly every call.
+
+   Build options (define when compiling CSPICE, e.g. in mkprodct's "set cl"):
+
+      MAXQ_CSPICE_UTSIZE    Logical units the handle manager uses.  The
+                            toolkit's value is 23.  Larger values need
+                            MAXQ_CSPICE_MAXLUN, and the platform's limit on
+                            open files (Windows' C runtime:  512 streams,
+                            unless raised with _setmaxstdio), to allow it.
+
+      MAXQ_CSPICE_MAXLUN    The largest logical unit number (FNDLUN's
+                            MAXLUN, and libf2c's unit table).  The toolkit's
+                            value is 99.
+
+-Particulars
+
+   The counters are updated by CSPICE's single thread of use, and are
+   read (maxq_unitstats) on the same terms as any CSPICE call.
+
+   MaxQ runs on the toolkit as NAIF ships it, and the prebuilt CSPICE
+   library is NAIF's.  Changes to the toolkit's sources are optional:
+   they're confined to the files that include this header (fndlun.c,
+   zzddhgtu.c, zzddhman.c, zzddhrmu.c, and libf2c's fio.h), and with
+   neither option defined the pool is the toolkit's.  The plugin only
+   calls maxq_unitstats/maxq_resetunitstats when it's built with
+   MAXQ_CSPICE_UNIT_STATS=1 (Spice.Build.cs), for a library built from
+   these sources.
+
+   This is the only copy of the header.  The sources include it from
+   here, so the library and the plugin agree on the sizes.
+
+*/
+
+#ifndef MAXQ_UNITS_H
+#define MAXQ_UNITS_H
+
+#ifndef MAXQ_CSPICE_UTSIZE
+#define MAXQ_CSPICE_UTSIZE 23
+#endif
+
+#ifndef MAXQ_CSPICE_MAXLUN
+#define MAXQ_CSPICE_MAXLUN 99
+#endif
+
+#if MAXQ_CSPICE_UTSIZE < 4
+#error "MAXQ_CSPICE_UTSIZE must leave room for the handle manager's reserved units"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _MaxQUnitStats
+{
+   /* Handle to unit requests (ZZDDHHLU, a DAF/DAS record read or write) */
+   long long   requests;
+   /* ...whose file was still connected to a unit */
+   long long   hits;
+   /* ...whose file had to be reopened */
+   long long   reopens;
+   /* Units taken from one file for another (opens and reopens) */
+   long long   evictions;
+
+   /* Units in the pool now, and the most there have been */
+   int         units;
+   int         peak;
+
+   /* MAXQ_CSPICE_UTSIZE, MAXQ_CSPICE_MAXLUN */
+   int         capacity;
+   int         maxlun;
+
+} MaxQUnitStats;
+
+void maxq_unitstats      ( MaxQUnitStats * stats );
+
+/* Zeroes the counters (and sets the peak to the units in use) */
+void maxq_resetunitstats ( void );
+
+/* The handle manager's bookkeeping */
+extern MaxQUnitStats maxq_units;
+
+void maxq_noteunits      ( int units );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
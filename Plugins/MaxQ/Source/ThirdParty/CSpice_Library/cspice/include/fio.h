@@ -89,7 +89,8 @@ extern unit f__units[];
 #define errfl(f,m,s) return err__fl((int)f,m,s)
 
 /*Table sizes*/
-#define MXUNIT 100
+#include "MaxQUnits.h"
+#define MXUNIT (MAXQ_CSPICE_MAXLUN + 1)
 
 extern int f__recpos;	/*position in current record*/
 extern int f__cursor;	/* offset to move to */
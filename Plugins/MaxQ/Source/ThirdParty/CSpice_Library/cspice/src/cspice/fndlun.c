@@ -4,6 +4,7 @@
 */
 
 #include "f2c.h"
+#include "../../include/MaxQUnits.h"
 
 /* $Procedure FNDLUN ( Find a free logical unit ) */
 /* Subroutine */ int fndlun_0_(int n__, integer *unit)
@@ -23,7 +24,7 @@
 
     /* Local variables */
     static integer i__;
-    static logical resvd[99], opened;
+    static logical resvd[MAXQ_CSPICE_MAXLUN], opened;
     static integer iostat;
 
 /* $ Abstract */
@@ -532,13 +533,13 @@
 /*     Initialize RESVD if it hasn't already been done. */
 
     if (first) {
-	for (i__ = 1; i__ <= 99; ++i__) {
-	    resvd[(i__1 = i__ - 1) < 99 && 0 <= i__1 ? i__1 : s_rnge("resvd", 
+	for (i__ = 1; i__ <= MAXQ_CSPICE_MAXLUN; ++i__) {
+	    resvd[(i__1 = i__ - 1) < MAXQ_CSPICE_MAXLUN && 0 <= i__1 ? i__1 : s_rnge("resvd", 
 		    i__1, "fndlun_", (ftnlen)547)] = FALSE_;
 	}
 	for (i__ = 1; i__ <= 3; ++i__) {
 	    resvd[(i__2 = resnum[(i__1 = i__ - 1) < 3 && 0 <= i__1 ? i__1 : 
-		    s_rnge("resnum", i__1, "fndlun_", (ftnlen)551)] - 1) < 99 
+		    s_rnge("resnum", i__1, "fndlun_", (ftnlen)551)] - 1) < MAXQ_CSPICE_MAXLUN 
 		    && 0 <= i__2 ? i__2 : s_rnge("resvd", i__2, "fndlun_", (
 		    ftnlen)551)] = TRUE_;
 	}
@@ -549,8 +550,8 @@
 /*     Cycle through the available units. Skip reserved units, */
 /*     INQUIRE about others. */
 
-    for (i__ = last + 1; i__ <= 99; ++i__) {
-	if (resvd[(i__1 = i__ - 1) < 99 && 0 <= i__1 ? i__1 : s_rnge("resvd", 
+    for (i__ = last + 1; i__ <= MAXQ_CSPICE_MAXLUN; ++i__) {
+	if (resvd[(i__1 = i__ - 1) < MAXQ_CSPICE_MAXLUN && 0 <= i__1 ? i__1 : s_rnge("resvd", 
 		i__1, "fndlun_", (ftnlen)565)]) {
 	    opened = TRUE_;
 	} else {
@@ -590,7 +591,7 @@
 
     i__1 = last;
     for (i__ = 1; i__ <= i__1; ++i__) {
-	if (resvd[(i__2 = i__ - 1) < 99 && 0 <= i__2 ? i__2 : s_rnge("resvd", 
+	if (resvd[(i__2 = i__ - 1) < MAXQ_CSPICE_MAXLUN && 0 <= i__2 ? i__2 : s_rnge("resvd", 
 		i__2, "fndlun_", (ftnlen)592)]) {
 	    opened = TRUE_;
 	} else {
@@ -844,13 +845,13 @@ L_reslun:
 /*     Initialize RESVD if it hasn't already been done. */
 
     if (first) {
-	for (i__ = 1; i__ <= 99; ++i__) {
-	    resvd[(i__1 = i__ - 1) < 99 && 0 <= i__1 ? i__1 : s_rnge("resvd", 
+	for (i__ = 1; i__ <= MAXQ_CSPICE_MAXLUN; ++i__) {
+	    resvd[(i__1 = i__ - 1) < MAXQ_CSPICE_MAXLUN && 0 <= i__1 ? i__1 : s_rnge("resvd", 
 		    i__1, "fndlun_", (ftnlen)848)] = FALSE_;
 	}
 	for (i__ = 1; i__ <= 3; ++i__) {
 	    resvd[(i__2 = resnum[(i__1 = i__ - 1) < 3 && 0 <= i__1 ? i__1 : 
-		    s_rnge("resnum", i__1, "fndlun_", (ftnlen)852)] - 1) < 99 
+		    s_rnge("resnum", i__1, "fndlun_", (ftnlen)852)] - 1) < MAXQ_CSPICE_MAXLUN 
 		    && 0 <= i__2 ? i__2 : s_rnge("resvd", i__2, "fndlun_", (
 		    ftnlen)852)] = TRUE_;
 	}
@@ -860,8 +861,8 @@ L_reslun:
 /*     If UNIT is in the proper range, set the corresponding flag */
 /*     to TRUE. */
 
-    if (*unit >= 1 && *unit <= 99) {
-	resvd[(i__1 = *unit - 1) < 99 && 0 <= i__1 ? i__1 : s_rnge("resvd", 
+    if (*unit >= 1 && *unit <= MAXQ_CSPICE_MAXLUN) {
+	resvd[(i__1 = *unit - 1) < MAXQ_CSPICE_MAXLUN && 0 <= i__1 ? i__1 : s_rnge("resvd", 
 		i__1, "fndlun_", (ftnlen)864)] = TRUE_;
     }
     return 0;
@@ -1086,14 +1087,14 @@ L_frelun:
 /*     Initialize RESVD if it hasn't already been done. */
 
     if (first) {
-	for (i__ = 1; i__ <= 99; ++i__) {
-	    resvd[(i__1 = i__ - 1) < 99 && 0 <= i__1 ? i__1 : s_rnge("resvd", 
+	for (i__ = 1; i__ <= MAXQ_CSPICE_MAXLUN; ++i__) {
+	    resvd[(i__1 = i__ - 1) < MAXQ_CSPICE_MAXLUN && 0 <= i__1 ? i__1 : s_rnge("resvd", 
 		    i__1, "fndlun_", (ftnlen)1102)] = FALSE_;
 	}
 	for (i__ = 1; i__ <= 3; ++i__) {
 	    resvd[(i__2 = resnum[(i__1 = i__ - 1) < 3 && 0 <= i__1 ? i__1 : 
 		    s_rnge("resnum", i__1, "fndlun_", (ftnlen)1106)] - 1) < 
-		    99 && 0 <= i__2 ? i__2 : s_rnge("resvd", i__2, "fndlun_", 
+		    MAXQ_CSPICE_MAXLUN && 0 <= i__2 ? i__2 : s_rnge("resvd", i__2, "fndlun_", 
 		    (ftnlen)1106)] = TRUE_;
 	}
 	first = FALSE_;
@@ -1102,14 +1103,14 @@ L_frelun:
 /*     If UNIT is in the proper range and it has not been reserved by */
 /*     default, set the corresponding flag to FALSE. */
 
-    if (*unit >= 1 && *unit <= 99) {
+    if (*unit >= 1 && *unit <= MAXQ_CSPICE_MAXLUN) {
 	for (i__ = 1; i__ <= 3; ++i__) {
 	    if (*unit == resnum[(i__1 = i__ - 1) < 3 && 0 <= i__1 ? i__1 : 
 		    s_rnge("resnum", i__1, "fndlun_", (ftnlen)1120)]) {
 		return 0;
 	    }
 	}
-	resvd[(i__1 = *unit - 1) < 99 && 0 <= i__1 ? i__1 : s_rnge("resvd", 
+	resvd[(i__1 = *unit - 1) < MAXQ_CSPICE_MAXLUN && 0 <= i__1 ? i__1 : s_rnge("resvd", 
 		i__1, "fndlun_", (ftnlen)1125)] = FALSE_;
     }
     return 0;
@@ -4,6 +4,7 @@
 */
 
 #include "f2c.h"
+#include "../../include/MaxQUnits.h"
 
 /* $Procedure ZZDDHGTU ( Private --- DDH Get Unit ) */
 /* Subroutine */ int zzddhgtu_(integer *utcst, integer *uthan, logical *utlck,
@@ -24,7 +25,7 @@
     extern /* Subroutine */ int orderi_(integer *, integer *, integer *), 
 	    frelun_(integer *), sigerr_(char *, ftnlen), getlun_(integer *), 
 	    chkout_(char *, ftnlen);
-    integer orderv[23];
+    integer orderv[MAXQ_CSPICE_UTSIZE];
     extern /* Subroutine */ int setmsg_(char *, ftnlen);
     extern logical return_(void);
 
@@ -446,6 +447,7 @@
     if (*nut == 0) {
 	*nut = 1;
 	*uindex = 1;
+	maxq_noteunits(*nut);
 	utcst[*uindex - 1] = 0;
 	uthan[*uindex - 1] = 0;
 	utlck[*uindex - 1] = FALSE_;
@@ -490,12 +492,13 @@
 /*     Now if no '0' cost rows exist, check to see if we can */
 /*     expand the table. */
 
-    if (*nut < 23) {
+    if (*nut < MAXQ_CSPICE_UTSIZE) {
 
 /*        Now increment NUT and set UINDEX. */
 
 	++(*nut);
 	*uindex = *nut;
+	maxq_noteunits(*nut);
 
 /*        Prepare the default values for the new row. */
 
@@ -526,7 +529,7 @@
     done = FALSE_;
     while(! done && i__ != *nut) {
 	++i__;
-	done = ! utlck[orderv[(i__1 = i__ - 1) < 23 && 0 <= i__1 ? i__1 : 
+	done = ! utlck[orderv[(i__1 = i__ - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		s_rnge("orderv", i__1, "zzddhgtu_", (ftnlen)279)] - 1];
     }
 
@@ -546,18 +549,21 @@
 /*     Clear UTCST and UTHAN since we intend to disconnect */
 /*     the unit upon return. */
 
-    utcst[orderv[(i__1 = i__ - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("orderv", 
+    utcst[orderv[(i__1 = i__ - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("orderv", 
 	    i__1, "zzddhgtu_", (ftnlen)304)] - 1] = 0;
-    uthan[orderv[(i__1 = i__ - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("orderv", 
+    uthan[orderv[(i__1 = i__ - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("orderv", 
 	    i__1, "zzddhgtu_", (ftnlen)305)] - 1] = 0;
 
 /*     Set UINDEX and CLSLUN, then return. */
 
-    *uindex = orderv[(i__1 = i__ - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("ord"
+    *uindex = orderv[(i__1 = i__ - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("ord"
 	    "erv", i__1, "zzddhgtu_", (ftnlen)310)];
 
 /*     At this point we need to close the unit from the row of interest. */
+/*     (MaxQ:  counted, as it's what makes the next read of that file */
+/*     reopen it.) */
 
+    ++maxq_units.evictions;
     cl__1.cerr = 0;
     cl__1.cunit = utlun[*uindex - 1];
     cl__1.csta = 0;
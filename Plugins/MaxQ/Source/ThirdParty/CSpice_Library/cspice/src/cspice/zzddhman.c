@@ -4,6 +4,7 @@
 */
 
 #include "f2c.h"
+#include "../../include/MaxQUnits.h"
 
 /* Table of constant values */
 
@@ -61,14 +62,14 @@ static integer c__0 = 0;
     static char ftnam[255*5000];
     extern /* Subroutine */ int repmc_(char *, char *, char *, char *, ftnlen,
 	     ftnlen, ftnlen, ftnlen);
-    static integer uthan[23];
+    static integer uthan[MAXQ_CSPICE_UTSIZE];
     static doublereal ftmnm[5000];
-    static logical utlck[23];
+    static logical utlck[MAXQ_CSPICE_UTSIZE];
     logical error;
     static integer ftrtm[5000];
     extern integer rtrim_(char *, ftnlen);
     extern /* Subroutine */ int ljust_(char *, char *, ftnlen, ftnlen);
-    static integer utcst[23], utlun[23];
+    static integer utcst[MAXQ_CSPICE_UTSIZE], utlun[MAXQ_CSPICE_UTSIZE];
     extern logical failed_(void);
     integer accmet, filarc, locked;
     static integer natbff;
@@ -984,7 +985,7 @@ L_zzddhopn:
 /*        open with SCRTCH access must be locked to their units. */
 
 	locked = zzddhclu_(utlck, &nut);
-	if (locked >= 21) {
+	if (locked >= MAXQ_CSPICE_UTSIZE - 2) {
 
 /*           Recall HANDLE was initialized to 0, and this invalid */
 /*           value is returned to the caller. */
@@ -1243,10 +1244,10 @@ L_zzddhopn:
 /*     METHOD. */
 
     if (accmet == 1) {
-	uthan[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("uthan", 
+	uthan[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("uthan", 
 		i__1, "zzddhman_", (ftnlen)1051)] = next;
     } else {
-	uthan[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("uthan", 
+	uthan[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("uthan", 
 		i__1, "zzddhman_", (ftnlen)1053)] = -next;
     }
 
@@ -1297,7 +1298,7 @@ L_zzddhopn:
 
     if (accmet == 3) {
 	o__1.oerr = 1;
-	o__1.ounit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	o__1.ounit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1105)];
 	o__1.ofnm = 0;
 	o__1.orl = 1024;
@@ -1309,7 +1310,7 @@ L_zzddhopn:
 	bff = natbff;
     } else if (accmet == 4) {
 	o__1.oerr = 1;
-	o__1.ounit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	o__1.ounit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1115)];
 	o__1.ofnmlen = lchar;
 	o__1.ofnm = locfnm;
@@ -1322,7 +1323,7 @@ L_zzddhopn:
 	bff = natbff;
     } else if (accmet == 1) {
 	o__1.oerr = 1;
-	o__1.ounit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	o__1.ounit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1126)];
 	o__1.ofnmlen = lchar;
 	o__1.ofnm = locfnm;
@@ -1334,7 +1335,7 @@ L_zzddhopn:
 	iostat = f_open(&o__1);
     } else if (accmet == 2) {
 	o__1.oerr = 1;
-	o__1.ounit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	o__1.ounit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1135)];
 	o__1.ofnmlen = lchar;
 	o__1.ofnm = locfnm;
@@ -1389,7 +1390,7 @@ L_zzddhopn:
 		i__1 : s_rnge("strarc", i__1, "zzddhman_", (ftnlen)1187)) << 
 		3), locfnm, (ftnlen)255, (ftnlen)1, (ftnlen)8, (ftnlen)255);
 	ioin__1.inerr = 1;
-	ioin__1.inunit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	ioin__1.inunit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1189)];
 	ioin__1.infile = 0;
 	ioin__1.inex = 0;
@@ -1429,7 +1430,7 @@ L_zzddhopn:
 /*        and determine the binary file format of the preexisting */
 /*        file LOCFNM. */
 
-	zzddhppf_(&utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	zzddhppf_(&utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1217)], &filarc, &
 		bff);
 
@@ -1525,13 +1526,13 @@ L_zzddhopn:
 
 	if (accmet == 4) {
 	    cl__1.cerr = 0;
-	    cl__1.cunit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 :
+	    cl__1.cunit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 :
 		     s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1337)];
 	    cl__1.csta = "DELETE";
 	    f_clos(&cl__1);
 	} else {
 	    cl__1.cerr = 0;
-	    cl__1.cunit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 :
+	    cl__1.cunit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 :
 		     s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1339)];
 	    cl__1.csta = 0;
 	    f_clos(&cl__1);
@@ -1556,13 +1557,13 @@ L_zzddhopn:
 
 /*     Finish filling out the unit table. */
 
-    utcst[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("utcst", i__1,
+    utcst[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("utcst", i__1,
 	     "zzddhman_", (ftnlen)1367)] = reqcnt;
 
 /*     Only scratch files get the units locked to handles, this is */
 /*     because they only exist as long as they have a unit. */
 
-    utlck[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("utlck", i__1,
+    utlck[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("utlck", i__1,
 	     "zzddhman_", (ftnlen)1373)] = accmet == 3;
 
 /*     Now fill out the file table. */
@@ -1574,7 +1575,7 @@ L_zzddhopn:
 
     ftabs[(i__1 = nft - 1) < 5000 && 0 <= i__1 ? i__1 : s_rnge("ftabs", i__1, 
 	    "zzddhman_", (ftnlen)1384)] = (i__3 = uthan[(i__2 = uindex - 1) < 
-	    23 && 0 <= i__2 ? i__2 : s_rnge("uthan", i__2, "zzddhman_", (
+	    MAXQ_CSPICE_UTSIZE && 0 <= i__2 ? i__2 : s_rnge("uthan", i__2, "zzddhman_", (
 	    ftnlen)1384)], abs(i__3));
 
 /*     Assign access method, file architecture, and native binary file */
@@ -1591,7 +1592,7 @@ L_zzddhopn:
 /*     unique DP number as FTMNM. */
 
     fthan[(i__1 = nft - 1) < 5000 && 0 <= i__1 ? i__1 : s_rnge("fthan", i__1, 
-	    "zzddhman_", (ftnlen)1398)] = uthan[(i__2 = uindex - 1) < 23 && 0 
+	    "zzddhman_", (ftnlen)1398)] = uthan[(i__2 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 
 	    <= i__2 ? i__2 : s_rnge("uthan", i__2, "zzddhman_", (ftnlen)1398)]
 	    ;
     s_copy(ftnam + ((i__1 = nft - 1) < 5000 && 0 <= i__1 ? i__1 : s_rnge(
@@ -1924,13 +1925,13 @@ L_zzddhcls:
 
 	if (*kill && accmet != 3) {
 	    cl__1.cerr = 0;
-	    cl__1.cunit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 :
+	    cl__1.cunit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 :
 		     s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1713)];
 	    cl__1.csta = "DELETE";
 	    f_clos(&cl__1);
 	} else {
 	    cl__1.cerr = 0;
-	    cl__1.cunit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 :
+	    cl__1.cunit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 :
 		     s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1715)];
 	    cl__1.csta = 0;
 	    f_clos(&cl__1);
@@ -1976,28 +1977,28 @@ L_zzddhcls:
 
 /*           Free the unit. */
 
-	    frelun_(&utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	    frelun_(&utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		    s_rnge("utlun", i__1, "zzddhman_", (ftnlen)1767)]);
 
 /*           Compress the table. */
 
 	    i__1 = nut;
 	    for (i__ = uindex + 1; i__ <= i__1; ++i__) {
-		utcst[(i__2 = i__ - 2) < 23 && 0 <= i__2 ? i__2 : s_rnge(
+		utcst[(i__2 = i__ - 2) < MAXQ_CSPICE_UTSIZE && 0 <= i__2 ? i__2 : s_rnge(
 			"utcst", i__2, "zzddhman_", (ftnlen)1774)] = utcst[(
-			i__3 = i__ - 1) < 23 && 0 <= i__3 ? i__3 : s_rnge(
+			i__3 = i__ - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__3 ? i__3 : s_rnge(
 			"utcst", i__3, "zzddhman_", (ftnlen)1774)];
-		uthan[(i__2 = i__ - 2) < 23 && 0 <= i__2 ? i__2 : s_rnge(
+		uthan[(i__2 = i__ - 2) < MAXQ_CSPICE_UTSIZE && 0 <= i__2 ? i__2 : s_rnge(
 			"uthan", i__2, "zzddhman_", (ftnlen)1775)] = uthan[(
-			i__3 = i__ - 1) < 23 && 0 <= i__3 ? i__3 : s_rnge(
+			i__3 = i__ - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__3 ? i__3 : s_rnge(
 			"uthan", i__3, "zzddhman_", (ftnlen)1775)];
-		utlck[(i__2 = i__ - 2) < 23 && 0 <= i__2 ? i__2 : s_rnge(
+		utlck[(i__2 = i__ - 2) < MAXQ_CSPICE_UTSIZE && 0 <= i__2 ? i__2 : s_rnge(
 			"utlck", i__2, "zzddhman_", (ftnlen)1776)] = utlck[(
-			i__3 = i__ - 1) < 23 && 0 <= i__3 ? i__3 : s_rnge(
+			i__3 = i__ - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__3 ? i__3 : s_rnge(
 			"utlck", i__3, "zzddhman_", (ftnlen)1776)];
-		utlun[(i__2 = i__ - 2) < 23 && 0 <= i__2 ? i__2 : s_rnge(
+		utlun[(i__2 = i__ - 2) < MAXQ_CSPICE_UTSIZE && 0 <= i__2 ? i__2 : s_rnge(
 			"utlun", i__2, "zzddhman_", (ftnlen)1777)] = utlun[(
-			i__3 = i__ - 1) < 23 && 0 <= i__3 ? i__3 : s_rnge(
+			i__3 = i__ - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__3 ? i__3 : s_rnge(
 			"utlun", i__3, "zzddhman_", (ftnlen)1777)];
 	    }
 
@@ -2245,6 +2246,15 @@ L_zzddhhlu:
 
     uindex = isrchi_(handle, &nut, uthan);
 
+/*     MaxQ:  count the request, and whether it reopens the file. */
+
+    ++maxq_units.requests;
+    if (uindex == 0) {
+	++maxq_units.reopens;
+    } else {
+	++maxq_units.hits;
+    }
+
 /*     Check to see if we didn't locate the HANDLE in the table. */
 /*     If we didn't, open the file associated with HANDLE again, */
 /*     and get it into the unit table. */
@@ -2271,7 +2281,7 @@ L_zzddhhlu:
 		i__2 = findex - 1) < 5000 && 0 <= i__2 ? i__2 : s_rnge("ftamh"
 		, i__2, "zzddhman_", (ftnlen)2071)] == 2) {
 	    o__1.oerr = 1;
-	    o__1.ounit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	    o__1.ounit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		    s_rnge("utlun", i__1, "zzddhman_", (ftnlen)2074)];
 	    o__1.ofnmlen = ftrtm[(i__3 = findex - 1) < 5000 && 0 <= i__3 ? 
 		    i__3 : s_rnge("ftrtm", i__3, "zzddhman_", (ftnlen)2074)];
@@ -2287,7 +2297,7 @@ L_zzddhhlu:
 	} else if (ftamh[(i__1 = findex - 1) < 5000 && 0 <= i__1 ? i__1 : 
 		s_rnge("ftamh", i__1, "zzddhman_", (ftnlen)2081)] == 1) {
 	    o__1.oerr = 1;
-	    o__1.ounit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+	    o__1.ounit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 		    s_rnge("utlun", i__1, "zzddhman_", (ftnlen)2083)];
 	    o__1.ofnmlen = ftrtm[(i__3 = findex - 1) < 5000 && 0 <= i__3 ? 
 		    i__3 : s_rnge("ftrtm", i__3, "zzddhman_", (ftnlen)2083)];
@@ -2338,11 +2348,11 @@ L_zzddhhlu:
 
 /*        Lastly populate the unit table values. */
 
-	uthan[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("uthan", 
+	uthan[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("uthan", 
 		i__1, "zzddhman_", (ftnlen)2135)] = fthan[(i__2 = findex - 1) 
 		< 5000 && 0 <= i__2 ? i__2 : s_rnge("fthan", i__2, "zzddhman_"
 		, (ftnlen)2135)];
-	utlck[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("utlck", 
+	utlck[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("utlck", 
 		i__1, "zzddhman_", (ftnlen)2136)] = FALSE_;
     }
 
@@ -2351,16 +2361,16 @@ L_zzddhhlu:
 /*     row with the new value of REQCNT, and then set the lock row to */
 /*     TRUE if a lock request was made. */
 
-    utcst[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("utcst", i__1,
+    utcst[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("utcst", i__1,
 	     "zzddhman_", (ftnlen)2146)] = reqcnt;
-    if (*lock && ! utlck[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : 
+    if (*lock && ! utlck[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : 
 	    s_rnge("utlck", i__1, "zzddhman_", (ftnlen)2148)]) {
 
 /*        First check to see if we have enough lockable units */
 /*        left in the unit table. */
 
 	locked = zzddhclu_(utlck, &nut);
-	if (locked >= 20) {
+	if (locked >= MAXQ_CSPICE_UTSIZE - 3) {
 	    *unit = 0;
 	    setmsg_("Unable to lock handle for file '#' to a logical unit.  "
 		    "There are no rows available for locking in the unit tabl"
@@ -2372,13 +2382,13 @@ L_zzddhhlu:
 	    chkout_("ZZDDHHLU", (ftnlen)8);
 	    return 0;
 	}
-	utlck[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("utlck", 
+	utlck[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("utlck", 
 		i__1, "zzddhman_", (ftnlen)2170)] = TRUE_;
     }
 
 /*     Set the value of UNIT and return. */
 
-    *unit = utlun[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("utl"
+    *unit = utlun[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("utl"
 	    "un", i__1, "zzddhman_", (ftnlen)2177)];
     chkout_("ZZDDHHLU", (ftnlen)8);
     return 0;
@@ -2557,7 +2567,7 @@ L_zzddhunl:
 
     if (uindex == 0) {
 	return 0;
-    } else if (! utlck[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge(
+    } else if (! utlck[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge(
 	    "utlck", i__1, "zzddhman_", (ftnlen)2369)]) {
 	return 0;
     }
@@ -2631,7 +2641,7 @@ L_zzddhunl:
 	     i__1, "zzddhman_", (ftnlen)2442)] == 3) {
 	return 0;
     }
-    utlck[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge("utlck", i__1,
+    utlck[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge("utlck", i__1,
 	     "zzddhman_", (ftnlen)2446)] = FALSE_;
     return 0;
 /* $Procedure ZZDDHNFO ( Private --- Get information about a Handle ) */
@@ -3337,7 +3347,7 @@ L_zzddhluh:
 	*handle = 0;
 	*found = FALSE_;
 	return 0;
-    } else if (uthan[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge(
+    } else if (uthan[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge(
 	    "uthan", i__1, "zzddhman_", (ftnlen)3198)] == 0) {
 	*handle = 0;
 	*found = FALSE_;
@@ -3346,7 +3356,7 @@ L_zzddhluh:
 
 /*     We've got a handle, store the value and return. */
 
-    *handle = uthan[(i__1 = uindex - 1) < 23 && 0 <= i__1 ? i__1 : s_rnge(
+    *handle = uthan[(i__1 = uindex - 1) < MAXQ_CSPICE_UTSIZE && 0 <= i__1 ? i__1 : s_rnge(
 	    "uthan", i__1, "zzddhman_", (ftnlen)3207)];
     *found = TRUE_;
     return 0;
@@ -3424,3 +3434,29 @@ L_zzddhluh:
 	    )0, found, (logical *)0, (ftnint)0, (ftnint)0, (ftnint)0);
     }
 
+
+/*     MaxQ:  unit pool counters (MaxQUnits.h) */
+
+MaxQUnitStats maxq_units = { 0, 0, 0, 0, 0, 0, MAXQ_CSPICE_UTSIZE, MAXQ_CSPICE_MAXLUN };
+
+void maxq_noteunits ( int units )
+{
+    maxq_units.units = units;
+    if (units > maxq_units.peak) {
+	maxq_units.peak = units;
+    }
+}
+
+void maxq_unitstats ( MaxQUnitStats * stats )
+{
+    *stats = maxq_units;
+}
+
+void maxq_resetunitstats ( void )
+{
+    maxq_units.requests = 0;
+    maxq_units.hits = 0;
+    maxq_units.reopens = 0;
+    maxq_units.evictions = 0;
+    maxq_units.peak = maxq_units.units;
+}
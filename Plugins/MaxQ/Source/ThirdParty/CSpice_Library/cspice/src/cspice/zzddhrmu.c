@@ -4,6 +4,7 @@
 */
 
 #include "f2c.h"
+#include "../../include/MaxQUnits.h"
 
 /* $Procedure ZZDDHRMU ( Private --- DDH Remove Unit ) */
 /* Subroutine */ int zzddhrmu_(integer *uindex, integer *nft, integer *utcst, 
@@ -501,6 +502,7 @@
 /*     Decrement NUT. */
 
     --(*nut);
+    maxq_noteunits(*nut);
     return 0;
 } /* zzddhrmu_ */
 